@@ -0,0 +1,20 @@
+# - Try to find LV2
+# Once done this will define
+#  LV2_FOUND - System has LV2 headers
+#  LV2_INCLUDE_DIRS - The LV2 include directory
+
+find_package(PkgConfig)
+pkg_search_module(PC_LV2 QUIET lv2)
+
+find_path(LV2_INCLUDE_DIR lv2/core/lv2.h
+  HINTS ${PC_LV2_INCLUDEDIR} ${PC_LV2_INCLUDE_DIRS}
+)
+
+set(LV2_INCLUDE_DIRS ${LV2_INCLUDE_DIR})
+
+include(FindPackageHandleStandardArgs)
+# Handle the QUIETLY and REQUIRED arguments and set LV2_FOUND to TRUE
+# if all listed variables are TRUE
+find_package_handle_standard_args(LV2 DEFAULT_MSG LV2_INCLUDE_DIR)
+
+mark_as_advanced(LV2_INCLUDE_DIR)
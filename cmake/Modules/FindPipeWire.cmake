@@ -0,0 +1,32 @@
+# - Try to find PipeWire
+# Once done this will define
+#  PIPEWIRE_FOUND - System has PipeWire
+#  PIPEWIRE_INCLUDE_DIRS - The PipeWire and SPA include directories
+#  PIPEWIRE_LIBRARIES - Link these to use PipeWire
+
+find_package(PkgConfig)
+pkg_search_module(PC_PIPEWIRE QUIET libpipewire-0.3)
+
+find_path(PIPEWIRE_INCLUDE_DIR pipewire/pipewire.h
+  HINTS ${PC_PIPEWIRE_INCLUDEDIR} ${PC_PIPEWIRE_INCLUDE_DIRS}
+  PATH_SUFFIXES pipewire-0.3
+)
+
+find_path(SPA_INCLUDE_DIR spa/pod/pod.h
+  HINTS ${PC_PIPEWIRE_INCLUDEDIR} ${PC_PIPEWIRE_INCLUDE_DIRS}
+  PATH_SUFFIXES spa-0.2
+)
+
+find_library(PIPEWIRE_LIBRARY pipewire-0.3
+  HINTS ${PC_PIPEWIRE_LIBDIR} ${PC_PIPEWIRE_LIBRARY_DIRS}
+)
+
+set(PIPEWIRE_LIBRARIES ${PIPEWIRE_LIBRARY})
+set(PIPEWIRE_INCLUDE_DIRS ${PIPEWIRE_INCLUDE_DIR} ${SPA_INCLUDE_DIR})
+
+include(FindPackageHandleStandardArgs)
+# Handle the QUIETLY and REQUIRED arguments and set PIPEWIRE_FOUND to TRUE
+# if all listed variables are TRUE
+find_package_handle_standard_args(PipeWire DEFAULT_MSG PIPEWIRE_LIBRARY PIPEWIRE_INCLUDE_DIR SPA_INCLUDE_DIR)
+
+mark_as_advanced(PIPEWIRE_LIBRARY PIPEWIRE_INCLUDE_DIR SPA_INCLUDE_DIR)
@@ -20,7 +20,10 @@
 #include "internals.h"
 
 #include "Analog.h"
+#include "MemoryLock.h"
+#include "mmath.h"
 #include "Synth.h"
+#include "srchelper/srctools/include/IIR2xResampler.h"
 
 namespace MT32Emu {
 
@@ -101,6 +104,32 @@ static const unsigned int ACCURATE_LPF_PHASE_INCREMENT_OVERSAMPLED = 1; // No do
 static const Bit32u ACCURATE_LPF_DELTAS_REGULAR[][ACCURATE_LPF_NUMBER_OF_PHASES] = { { 0, 0, 0 }, { 1, 1, 0 }, { 1, 2, 1 } };
 static const Bit32u ACCURATE_LPF_DELTAS_OVERSAMPLED[][ACCURATE_LPF_NUMBER_OF_PHASES] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 0, 1 } };
 
+// Maximum number of output samples the filters process in one go when working on blocks
+static const Bit32u LPF_BLOCK_LENGTH = 192; // Must be a multiple of ACCURATE_LPF_NUMBER_OF_PHASES
+
+// The filters are minimum-phase, so the group delay varies with the frequency. The delay at DC equals to the centroid
+// of the impulse response, in samples at the rate the taps apply.
+// The delay lines only take the input samples, so they do not accumulate denormals by themselves. Flushing the inputs
+// let the delay lines settle to exact zeros after the reverb tails, which the activity checks rely upon.
+static inline IntSampleEx flushDenormal(IntSampleEx sample) {
+	return sample;
+}
+
+static inline FloatSample flushDenormal(FloatSample sample) {
+	return FLUSH_DENORMAL(sample);
+}
+
+template <class Tap>
+static double computeGroupDelay(const Tap *taps, const unsigned int tapCount) {
+	double tapSum = 0.0;
+	double weightedTapSum = 0.0;
+	for (unsigned int tapIx = 0; tapIx < tapCount; tapIx++) {
+		tapSum += double(taps[tapIx]);
+		weightedTapSum += double(tapIx) * double(taps[tapIx]);
+	}
+	return tapSum == 0.0 ? 0.0 : weightedTapSum / tapSum;
+}
+
 template <class SampleEx>
 class AbstractLowPassFilter {
 public:
@@ -108,6 +137,15 @@ public:
 
 	virtual ~AbstractLowPassFilter() {}
 	virtual SampleEx process(const SampleEx sample) = 0;
+	virtual size_t getMemoryUsage() const = 0;
+
+	// Produces a block of output samples, the number of input samples consumed is given by estimateInSampleCount().
+	// The results are exactly the same as when calling process() for each output sample.
+	virtual void processBlock(SampleEx *outSamples, const SampleEx *inSamples, Bit32u outLength) {
+		while (0 < (outLength--)) {
+			*(outSamples++) = hasNextSample() ? process(0) : process(*(inSamples++));
+		}
+	}
 
 	virtual bool hasNextSample() const {
 		return false;
@@ -122,6 +160,14 @@ public:
 	}
 
 	virtual void addPositionIncrement(const unsigned int) {}
+
+	virtual bool isSilent() const {
+		return true;
+	}
+
+	virtual double getGroupDelay() const {
+		return 0.0;
+	}
 };
 
 template <class SampleEx>
@@ -130,6 +176,14 @@ public:
 	SampleEx process(const SampleEx sample) {
 		return sample;
 	}
+
+	void processBlock(SampleEx *outSamples, const SampleEx *inSamples, Bit32u outLength) {
+		memcpy(outSamples, inSamples, outLength * sizeof(SampleEx));
+	}
+
+	size_t getMemoryUsage() const {
+		return sizeof(*this);
+	}
 };
 
 template <class SampleEx>
@@ -154,7 +208,7 @@ public:
 		static const unsigned int DELAY_LINE_MASK = COARSE_LPF_DELAY_LINE_LENGTH - 1;
 
 		SampleEx sample = lpfTaps[COARSE_LPF_DELAY_LINE_LENGTH] * ringBuffer[ringBufferPosition];
-		ringBuffer[ringBufferPosition] = Synth::clipSampleEx(inSample);
+		ringBuffer[ringBufferPosition] = flushDenormal(Synth::clipSampleEx(inSample));
 
 		for (unsigned int i = 0; i < COARSE_LPF_DELAY_LINE_LENGTH; i++) {
 			sample += lpfTaps[i] * ringBuffer[(i + ringBufferPosition) & DELAY_LINE_MASK];
@@ -164,6 +218,67 @@ public:
 
 		return normaliseSample(sample);
 	}
+
+	// Unrolls the delay line into a linear history, so that the FIR is computed across a block of output samples at once.
+	// The taps are still accumulated in the same order for each output sample.
+	void processBlock(SampleEx *outSamples, const SampleEx *inSamples, Bit32u outLength) {
+		static const unsigned int DELAY_LINE_MASK = COARSE_LPF_DELAY_LINE_LENGTH - 1;
+
+		// The oldest sample goes first, the sample at ringBufferPosition is the oldest one
+		SampleEx history[COARSE_LPF_DELAY_LINE_LENGTH + LPF_BLOCK_LENGTH];
+		for (unsigned int i = 0; i < COARSE_LPF_DELAY_LINE_LENGTH; i++) {
+			history[i] = ringBuffer[(ringBufferPosition - i) & DELAY_LINE_MASK];
+		}
+
+		while (outLength > 0) {
+			const Bit32u blockLength = outLength < LPF_BLOCK_LENGTH ? outLength : LPF_BLOCK_LENGTH;
+			SampleEx * const blockHistory = history + COARSE_LPF_DELAY_LINE_LENGTH;
+			for (Bit32u i = 0; i < blockLength; i++) {
+				blockHistory[i] = flushDenormal(Synth::clipSampleEx(inSamples[i]));
+			}
+
+			SampleEx sample[LPF_BLOCK_LENGTH];
+			for (Bit32u i = 0; i < blockLength; i++) {
+				sample[i] = lpfTaps[COARSE_LPF_DELAY_LINE_LENGTH] * history[i];
+			}
+			for (unsigned int tapIx = 0; tapIx < COARSE_LPF_DELAY_LINE_LENGTH; tapIx++) {
+				const SampleEx tap = lpfTaps[tapIx];
+				const SampleEx * const delayedSamples = blockHistory - tapIx;
+				for (Bit32u i = 0; i < blockLength; i++) {
+					sample[i] += tap * delayedSamples[i];
+				}
+			}
+			for (Bit32u i = 0; i < blockLength; i++) {
+				outSamples[i] = normaliseSample(sample[i]);
+			}
+
+			memmove(history, history + blockLength, COARSE_LPF_DELAY_LINE_LENGTH * sizeof(SampleEx));
+			inSamples += blockLength;
+			outSamples += blockLength;
+			outLength -= blockLength;
+		}
+
+		// Store the history back so that the newest sample precedes ringBufferPosition
+		ringBufferPosition = DELAY_LINE_MASK;
+		for (unsigned int i = 0; i < COARSE_LPF_DELAY_LINE_LENGTH; i++) {
+			ringBuffer[i] = history[DELAY_LINE_MASK - i];
+		}
+	}
+
+	bool isSilent() const {
+		for (unsigned int i = 0; i < COARSE_LPF_DELAY_LINE_LENGTH; i++) {
+			if (ringBuffer[i] != 0) return false;
+		}
+		return true;
+	}
+
+	double getGroupDelay() const {
+		return computeGroupDelay(lpfTaps, COARSE_LPF_DELAY_LINE_LENGTH + 1);
+	}
+
+	size_t getMemoryUsage() const {
+		return sizeof(*this);
+	}
 };
 
 class AccurateLowPassFilter : public AbstractLowPassFilter<IntSampleEx>, public AbstractLowPassFilter<FloatSample> {
@@ -181,10 +296,18 @@ public:
 	AccurateLowPassFilter(const bool oldMT32AnalogLPF, const bool oversample);
 	FloatSample process(const FloatSample sample);
 	IntSampleEx process(const IntSampleEx sample);
+	void processBlock(FloatSample *outSamples, const FloatSample *inSamples, Bit32u outLength);
+	void processBlock(IntSampleEx *outSamples, const IntSampleEx *inSamples, Bit32u outLength);
 	bool hasNextSample() const;
 	unsigned int getOutputSampleRate() const;
 	unsigned int estimateInSampleCount(const unsigned int outSamples) const;
 	void addPositionIncrement(const unsigned int positionIncrement);
+	bool isSilent() const;
+	double getGroupDelay() const;
+
+	size_t getMemoryUsage() const {
+		return sizeof(*this);
+	}
 };
 
 static inline IntSampleEx normaliseSample(const IntSampleEx sample) {
@@ -203,66 +326,149 @@ static inline IntSampleEx getIntOutputGain(const float outputGain) {
 	return IntSampleEx(((OUTPUT_GAIN_MULTIPLIER < outputGain) ? OUTPUT_GAIN_MULTIPLIER : outputGain) * OUTPUT_GAIN_MULTIPLIER);
 }
 
+// In AnalogOutputMode_DECIMATED mode, the oversampled output of the LPF is decimated with the sharpest half-band filter available.
+static inline SRCTools::IIR2xDecimator *createDecimator(const AnalogOutputMode mode) {
+	return mode == AnalogOutputMode_DECIMATED ? new SRCTools::IIR2xDecimator(SRCTools::IIRResampler::BEST) : NULL;
+}
+
 template <class SampleEx>
 class AnalogImpl : public Analog {
 public:
-	AbstractLowPassFilter<SampleEx> &leftChannelLPF;
-	AbstractLowPassFilter<SampleEx> &rightChannelLPF;
+	AbstractLowPassFilter<SampleEx> *leftChannelLPF;
+	AbstractLowPassFilter<SampleEx> *rightChannelLPF;
+	// Processes both channels of the LPF output at once, NULL unless the output is decimated.
+	SRCTools::IIR2xDecimator *decimator;
 	SampleEx synthGain;
 	SampleEx reverbGain;
 
 	AnalogImpl(const AnalogOutputMode mode, const bool oldMT32AnalogLPF) :
-		leftChannelLPF(AbstractLowPassFilter<SampleEx>::createLowPassFilter(mode, oldMT32AnalogLPF)),
-		rightChannelLPF(AbstractLowPassFilter<SampleEx>::createLowPassFilter(mode, oldMT32AnalogLPF)),
+		leftChannelLPF(&AbstractLowPassFilter<SampleEx>::createLowPassFilter(mode, oldMT32AnalogLPF)),
+		rightChannelLPF(&AbstractLowPassFilter<SampleEx>::createLowPassFilter(mode, oldMT32AnalogLPF)),
+		decimator(createDecimator(mode)),
 		synthGain(0),
 		reverbGain(0)
 	{}
 
 	~AnalogImpl() {
-		delete &leftChannelLPF;
-		delete &rightChannelLPF;
+		delete leftChannelLPF;
+		delete rightChannelLPF;
+		delete decimator;
+	}
+
+	void replaceLowPassFilter(const AnalogOutputMode mode, const bool oldMT32AnalogLPF) {
+		delete leftChannelLPF;
+		delete rightChannelLPF;
+		delete decimator;
+		leftChannelLPF = &AbstractLowPassFilter<SampleEx>::createLowPassFilter(mode, oldMT32AnalogLPF);
+		rightChannelLPF = &AbstractLowPassFilter<SampleEx>::createLowPassFilter(mode, oldMT32AnalogLPF);
+		decimator = createDecimator(mode);
 	}
 
 	unsigned int getOutputSampleRate() const {
-		return leftChannelLPF.getOutputSampleRate();
+		const unsigned int lpfOutputSampleRate = leftChannelLPF->getOutputSampleRate();
+		return decimator == NULL ? lpfOutputSampleRate : lpfOutputSampleRate >> 1;
 	}
 
 	Bit32u getDACStreamsLength(const Bit32u outputLength) const {
-		return leftChannelLPF.estimateInSampleCount(outputLength);
+		return leftChannelLPF->estimateInSampleCount(decimator == NULL ? outputLength : outputLength << 1);
 	}
 
 	void setSynthOutputGain(const float synthGain);
 	void setReverbOutputGain(const float reverbGain, const bool mt32ReverbCompatibilityMode);
 
+	bool isSilent() const {
+		return leftChannelLPF->isSilent() && rightChannelLPF->isSilent() && (decimator == NULL || decimator->isSilent());
+	}
+
+	double getLatency() const {
+		// The group delay of the decimator is measured at the LPF output sample rate
+		if (decimator == NULL) return leftChannelLPF->getGroupDelay();
+		return 0.5 * (leftChannelLPF->getGroupDelay() + decimator->getGroupDelay());
+	}
+
+	size_t getMemoryUsage() const {
+		const size_t memoryUsage = sizeof(*this) + leftChannelLPF->getMemoryUsage() + rightChannelLPF->getMemoryUsage();
+		return decimator == NULL ? memoryUsage : memoryUsage + decimator->getMemoryUsage();
+	}
+
+	// The state of the low-pass filters is kept within the objects.
+	void lockMemory(MemoryLock &memoryLock) const {
+		memoryLock.lock(this, sizeof(*this));
+		memoryLock.lock(leftChannelLPF, leftChannelLPF->getMemoryUsage());
+		memoryLock.lock(rightChannelLPF, rightChannelLPF->getMemoryUsage());
+		if (decimator != NULL) memoryLock.lock(decimator, sizeof(*decimator));
+	}
+
 	bool process(IntSample *outStream, const IntSample *nonReverbLeft, const IntSample *nonReverbRight, const IntSample *reverbDryLeft, const IntSample *reverbDryRight, const IntSample *reverbWetLeft, const IntSample *reverbWetRight, Bit32u outLength);
 	bool process(FloatSample *outStream, const FloatSample *nonReverbLeft, const FloatSample *nonReverbRight, const FloatSample *reverbDryLeft, const FloatSample *reverbDryRight, const FloatSample *reverbWetLeft, const FloatSample *reverbWetRight, Bit32u outLength);
 
 	template <class Sample>
 	void produceOutput(Sample *outStream, const Sample *nonReverbLeft, const Sample *nonReverbRight, const Sample *reverbDryLeft, const Sample *reverbDryRight, const Sample *reverbWetLeft, const Sample *reverbWetRight, Bit32u outLength) {
 		if (outStream == NULL) {
-			leftChannelLPF.addPositionIncrement(outLength);
-			rightChannelLPF.addPositionIncrement(outLength);
+			const Bit32u lpfOutLength = decimator == NULL ? outLength : outLength << 1;
+			leftChannelLPF->addPositionIncrement(lpfOutLength);
+			rightChannelLPF->addPositionIncrement(lpfOutLength);
 			return;
 		}
 
-		while (0 < (outLength--)) {
-			SampleEx outSampleL;
-			SampleEx outSampleR;
-
-			if (leftChannelLPF.hasNextSample()) {
-				outSampleL = leftChannelLPF.process(0);
-				outSampleR = rightChannelLPF.process(0);
+		// When decimated, each output sample takes two samples from the LPF
+		const Bit32u maxBlockLength = decimator == NULL ? LPF_BLOCK_LENGTH : LPF_BLOCK_LENGTH >> 1;
+		while (outLength > 0) {
+			const Bit32u blockLength = outLength < maxBlockLength ? outLength : maxBlockLength;
+			const Bit32u lpfOutLength = decimator == NULL ? blockLength : blockLength << 1;
+			// Both channels are in the same phase, so they consume the same number of input samples
+			const Bit32u inLength = leftChannelLPF->estimateInSampleCount(lpfOutLength);
+
+			SampleEx inSamplesL[LPF_BLOCK_LENGTH];
+			SampleEx inSamplesR[LPF_BLOCK_LENGTH];
+			for (Bit32u i = 0; i < inLength; i++) {
+				inSamplesL[i] = normaliseSample((SampleEx(nonReverbLeft[i]) + SampleEx(reverbDryLeft[i])) * synthGain + SampleEx(reverbWetLeft[i]) * reverbGain);
+				inSamplesR[i] = normaliseSample((SampleEx(nonReverbRight[i]) + SampleEx(reverbDryRight[i])) * synthGain + SampleEx(reverbWetRight[i]) * reverbGain);
+			}
+			nonReverbLeft += inLength;
+			nonReverbRight += inLength;
+			reverbDryLeft += inLength;
+			reverbDryRight += inLength;
+			reverbWetLeft += inLength;
+			reverbWetRight += inLength;
+
+			SampleEx outSamplesL[LPF_BLOCK_LENGTH];
+			SampleEx outSamplesR[LPF_BLOCK_LENGTH];
+			leftChannelLPF->processBlock(outSamplesL, inSamplesL, lpfOutLength);
+			rightChannelLPF->processBlock(outSamplesR, inSamplesR, lpfOutLength);
+
+			if (decimator == NULL) {
+				for (Bit32u i = 0; i < blockLength; i++) {
+					*(outStream++) = Synth::clipSampleEx(outSamplesL[i]);
+					*(outStream++) = Synth::clipSampleEx(outSamplesR[i]);
+				}
 			} else {
-				SampleEx inSampleL = (SampleEx(*(nonReverbLeft++)) + SampleEx(*(reverbDryLeft++))) * synthGain + SampleEx(*(reverbWetLeft++)) * reverbGain;
-				SampleEx inSampleR = (SampleEx(*(nonReverbRight++)) + SampleEx(*(reverbDryRight++))) * synthGain + SampleEx(*(reverbWetRight++)) * reverbGain;
-
-				outSampleL = leftChannelLPF.process(normaliseSample(inSampleL));
-				outSampleR = rightChannelLPF.process(normaliseSample(inSampleR));
+				outStream = decimate(outStream, outSamplesL, outSamplesR, blockLength);
 			}
+			outLength -= blockLength;
+		}
+	}
 
-			*(outStream++) = Synth::clipSampleEx(outSampleL);
-			*(outStream++) = Synth::clipSampleEx(outSampleR);
+	// The decimator processes interleaved float frames, so the integer samples are converted back and forth,
+	// the same way the accurate LPF does.
+	template <class Sample>
+	Sample *decimate(Sample *outStream, const SampleEx *lpfOutSamplesL, const SampleEx *lpfOutSamplesR, const Bit32u outLength) {
+		SRCTools::FloatSample inFrames[2 * LPF_BLOCK_LENGTH];
+		const Bit32u lpfOutLength = outLength << 1;
+		for (Bit32u i = 0; i < lpfOutLength; i++) {
+			inFrames[2 * i] = SRCTools::FloatSample(lpfOutSamplesL[i]);
+			inFrames[2 * i + 1] = SRCTools::FloatSample(lpfOutSamplesR[i]);
+		}
+		SRCTools::FloatSample outFrames[LPF_BLOCK_LENGTH];
+		const SRCTools::FloatSample *inPtr = inFrames;
+		SRCTools::FloatSample *outPtr = outFrames;
+		unsigned int inFrameCount = lpfOutLength;
+		unsigned int outFrameCount = outLength;
+		decimator->process(inPtr, inFrameCount, outPtr, outFrameCount);
+		for (Bit32u i = 0; i < 2 * outLength; i++) {
+			*(outStream++) = Synth::clipSampleEx(SampleEx(outFrames[i]));
 		}
+		return outStream;
 	}
 };
 
@@ -272,6 +478,7 @@ Analog *Analog::createAnalog(const AnalogOutputMode mode, const bool oldMT32Anal
 	case RendererType_BIT16S:
 		return new AnalogImpl<IntSampleEx>(mode, oldMT32AnalogLPF);
 	case RendererType_FLOAT:
+	case RendererType_FLOAT_WAVETABLE:
 		return new AnalogImpl<FloatSample>(mode, oldMT32AnalogLPF);
 	default:
 		break;
@@ -279,6 +486,12 @@ Analog *Analog::createAnalog(const AnalogOutputMode mode, const bool oldMT32Anal
 	return NULL;
 }
 
+const FloatSample *Analog::getAccurateLowPassFilterTaps(const bool oldMT32AnalogLPF, Bit32u &tapCount, Bit32u &upsampleFactor) {
+	tapCount = ACCURATE_LPF_DELAY_LINE_LENGTH * ACCURATE_LPF_NUMBER_OF_PHASES + 1;
+	upsampleFactor = ACCURATE_LPF_NUMBER_OF_PHASES;
+	return oldMT32AnalogLPF ? ACCURATE_LPF_TAPS_MT32 : ACCURATE_LPF_TAPS_CM32L;
+}
+
 template<>
 bool AnalogImpl<IntSampleEx>::process(IntSample *outStream, const IntSample *nonReverbLeft, const IntSample *nonReverbRight, const IntSample *reverbDryLeft, const IntSample *reverbDryRight, const IntSample *reverbWetLeft, const IntSample *reverbWetRight, Bit32u outLength) {
 	produceOutput(outStream, nonReverbLeft, nonReverbRight, reverbDryLeft, reverbDryRight, reverbWetLeft, reverbWetRight, outLength);
@@ -329,6 +542,7 @@ AbstractLowPassFilter<IntSampleEx> &AbstractLowPassFilter<IntSampleEx>::createLo
 	case AnalogOutputMode_ACCURATE:
 		return *new AccurateLowPassFilter(oldMT32AnalogLPF, false);
 	case AnalogOutputMode_OVERSAMPLED:
+	case AnalogOutputMode_DECIMATED:
 		return *new AccurateLowPassFilter(oldMT32AnalogLPF, true);
 	default:
 		return *new NullLowPassFilter<IntSampleEx>;
@@ -343,6 +557,7 @@ AbstractLowPassFilter<FloatSample> &AbstractLowPassFilter<FloatSample>::createLo
 		case AnalogOutputMode_ACCURATE:
 			return *new AccurateLowPassFilter(oldMT32AnalogLPF, false);
 		case AnalogOutputMode_OVERSAMPLED:
+		case AnalogOutputMode_DECIMATED:
 			return *new AccurateLowPassFilter(oldMT32AnalogLPF, true);
 		default:
 			return *new NullLowPassFilter<FloatSample>;
@@ -385,7 +600,7 @@ FloatSample AccurateLowPassFilter::process(const FloatSample inSample) {
 
 	FloatSample sample = (phase == 0) ? LPF_TAPS[ACCURATE_LPF_DELAY_LINE_LENGTH * ACCURATE_LPF_NUMBER_OF_PHASES] * ringBuffer[ringBufferPosition] : 0.0f;
 	if (!hasNextSample()) {
-		ringBuffer[ringBufferPosition] = inSample;
+		ringBuffer[ringBufferPosition] = FLUSH_DENORMAL(inSample);
 	}
 
 	for (unsigned int tapIx = phase, delaySampleIx = 0; delaySampleIx < ACCURATE_LPF_DELAY_LINE_LENGTH; delaySampleIx++, tapIx += ACCURATE_LPF_NUMBER_OF_PHASES) {
@@ -405,6 +620,114 @@ IntSampleEx AccurateLowPassFilter::process(const IntSampleEx sample) {
 	return IntSampleEx(process(FloatSample(sample)));
 }
 
+// Accumulates the contribution of a single tap to a sequence of output samples that share the same phase.
+// The newest input samples for consecutive outputs are phaseIncrement samples apart.
+template <unsigned int phaseIncrement>
+static inline void accumulateAccurateLPFTap(FloatSample *samples, const FloatSample tap, const FloatSample *delayedSamples, const Bit32u length) {
+	for (Bit32u i = 0; i < length; i++) {
+		samples[i] += tap * delayedSamples[i * phaseIncrement];
+	}
+}
+
+/* Polyphase implementation of the filter above. The output samples which lie in the same phase form interleaved sequences
+ * with a regular stride in the input stream, so each tap is applied to the whole sequence in turn rather than computing
+ * the full dot product for each output sample. The taps are accumulated in the same order, hence the results are identical.
+ */
+void AccurateLowPassFilter::processBlock(FloatSample *outSamples, const FloatSample *inSamples, Bit32u outLength) {
+	static const unsigned int DELAY_LINE_MASK = ACCURATE_LPF_DELAY_LINE_LENGTH - 1;
+	static const Bit32u MAX_PHASE_SAMPLE_COUNT = LPF_BLOCK_LENGTH / ACCURATE_LPF_NUMBER_OF_PHASES;
+
+	// Unroll the delay line into a linear history, the oldest sample goes first
+	FloatSample history[ACCURATE_LPF_DELAY_LINE_LENGTH + LPF_BLOCK_LENGTH];
+	const unsigned int newestSamplePosition = hasNextSample() ? ringBufferPosition : ringBufferPosition + 1;
+	for (unsigned int i = 0; i < ACCURATE_LPF_DELAY_LINE_LENGTH; i++) {
+		history[DELAY_LINE_MASK - i] = ringBuffer[(newestSamplePosition + i) & DELAY_LINE_MASK];
+	}
+	Bit32u newestSampleIx = DELAY_LINE_MASK;
+
+	while (outLength > 0) {
+		const Bit32u blockLength = outLength < LPF_BLOCK_LENGTH ? outLength : LPF_BLOCK_LENGTH;
+
+		// Walk through the phases to fetch the input samples and find where each output sequence starts
+		Bit32u startPhases[ACCURATE_LPF_NUMBER_OF_PHASES];
+		Bit32u startSampleIxs[ACCURATE_LPF_NUMBER_OF_PHASES];
+		for (Bit32u i = 0; i < blockLength; i++) {
+			if (!hasNextSample()) {
+				history[++newestSampleIx] = FLUSH_DENORMAL(*(inSamples++));
+			}
+			if (i < ACCURATE_LPF_NUMBER_OF_PHASES) {
+				startPhases[i] = phase;
+				startSampleIxs[i] = newestSampleIx;
+			}
+			phase += phaseIncrement;
+			if (ACCURATE_LPF_NUMBER_OF_PHASES <= phase) {
+				phase -= ACCURATE_LPF_NUMBER_OF_PHASES;
+			}
+		}
+
+		for (Bit32u sequenceIx = 0; sequenceIx < ACCURATE_LPF_NUMBER_OF_PHASES && sequenceIx < blockLength; sequenceIx++) {
+			const Bit32u sequencePhase = startPhases[sequenceIx];
+			const Bit32u sequenceLength = (blockLength - sequenceIx + ACCURATE_LPF_NUMBER_OF_PHASES - 1) / ACCURATE_LPF_NUMBER_OF_PHASES;
+			const FloatSample * const newestSamples = history + startSampleIxs[sequenceIx];
+
+			FloatSample samples[MAX_PHASE_SAMPLE_COUNT];
+			if (sequencePhase == 0) {
+				const FloatSample tap = LPF_TAPS[ACCURATE_LPF_DELAY_LINE_LENGTH * ACCURATE_LPF_NUMBER_OF_PHASES];
+				const FloatSample * const oldestSamples = newestSamples - ACCURATE_LPF_DELAY_LINE_LENGTH;
+				for (Bit32u i = 0; i < sequenceLength; i++) {
+					samples[i] = tap * oldestSamples[i * phaseIncrement];
+				}
+			} else {
+				Synth::muteSampleBuffer(samples, sequenceLength);
+			}
+
+			for (unsigned int tapIx = sequencePhase, delaySampleIx = 0; delaySampleIx < ACCURATE_LPF_DELAY_LINE_LENGTH; delaySampleIx++, tapIx += ACCURATE_LPF_NUMBER_OF_PHASES) {
+				if (phaseIncrement == ACCURATE_LPF_PHASE_INCREMENT_REGULAR) {
+					accumulateAccurateLPFTap<ACCURATE_LPF_PHASE_INCREMENT_REGULAR>(samples, LPF_TAPS[tapIx], newestSamples - delaySampleIx, sequenceLength);
+				} else {
+					accumulateAccurateLPFTap<ACCURATE_LPF_PHASE_INCREMENT_OVERSAMPLED>(samples, LPF_TAPS[tapIx], newestSamples - delaySampleIx, sequenceLength);
+				}
+			}
+
+			for (Bit32u i = 0; i < sequenceLength; i++) {
+				outSamples[sequenceIx + i * ACCURATE_LPF_NUMBER_OF_PHASES] = ACCURATE_LPF_NUMBER_OF_PHASES * samples[i];
+			}
+		}
+
+		memmove(history, history + newestSampleIx - DELAY_LINE_MASK, ACCURATE_LPF_DELAY_LINE_LENGTH * sizeof(FloatSample));
+		newestSampleIx = DELAY_LINE_MASK;
+		outSamples += blockLength;
+		outLength -= blockLength;
+	}
+
+	// Store the history back, the newest sample lands at ringBufferPosition unless the next output sample consumes a new input sample
+	ringBufferPosition = hasNextSample() ? 0 : DELAY_LINE_MASK;
+	for (unsigned int i = 0; i < ACCURATE_LPF_DELAY_LINE_LENGTH; i++) {
+		ringBuffer[i] = history[DELAY_LINE_MASK - i];
+	}
+}
+
+void AccurateLowPassFilter::processBlock(IntSampleEx *outSamples, const IntSampleEx *inSamples, Bit32u outLength) {
+	while (outLength > 0) {
+		const Bit32u blockLength = outLength < LPF_BLOCK_LENGTH ? outLength : LPF_BLOCK_LENGTH;
+		const Bit32u inLength = estimateInSampleCount(blockLength);
+
+		FloatSample floatInSamples[LPF_BLOCK_LENGTH];
+		for (Bit32u i = 0; i < inLength; i++) {
+			floatInSamples[i] = FloatSample(inSamples[i]);
+		}
+		FloatSample floatOutSamples[LPF_BLOCK_LENGTH];
+		processBlock(floatOutSamples, floatInSamples, blockLength);
+		for (Bit32u i = 0; i < blockLength; i++) {
+			outSamples[i] = IntSampleEx(floatOutSamples[i]);
+		}
+
+		inSamples += inLength;
+		outSamples += blockLength;
+		outLength -= blockLength;
+	}
+}
+
 bool AccurateLowPassFilter::hasNextSample() const {
 	return phaseIncrement <= phase;
 }
@@ -423,4 +746,16 @@ void AccurateLowPassFilter::addPositionIncrement(const unsigned int positionIncr
 	phase = (phase + positionIncrement * phaseIncrement) % ACCURATE_LPF_NUMBER_OF_PHASES;
 }
 
+bool AccurateLowPassFilter::isSilent() const {
+	for (unsigned int i = 0; i < ACCURATE_LPF_DELAY_LINE_LENGTH; i++) {
+		if (ringBuffer[i] != 0.0f) return false;
+	}
+	return true;
+}
+
+double AccurateLowPassFilter::getGroupDelay() const {
+	// The taps apply to the input upsampled by ACCURATE_LPF_NUMBER_OF_PHASES, the output is decimated by phaseIncrement
+	return computeGroupDelay(LPF_TAPS, ACCURATE_LPF_DELAY_LINE_LENGTH * ACCURATE_LPF_NUMBER_OF_PHASES + 1) / phaseIncrement;
+}
+
 } // namespace MT32Emu
@@ -18,6 +18,8 @@
 #ifndef MT32EMU_ANALOG_H
 #define MT32EMU_ANALOG_H
 
+#include <cstddef>
+
 #include "globals.h"
 #include "internals.h"
 #include "Enumerations.h"
@@ -25,6 +27,8 @@
 
 namespace MT32Emu {
 
+class MemoryLock;
+
 /* Analog class is dedicated to perform fair emulation of analogue circuitry of hardware units that is responsible
  * for processing output signal after the DAC. It appears that the analogue circuit labeled "LPF" on the schematic
  * also applies audible changes to the signal spectra. There is a significant boost of higher frequencies observed
@@ -37,12 +41,25 @@ namespace MT32Emu {
 class Analog {
 public:
 	static Analog *createAnalog(const AnalogOutputMode mode, const bool oldMT32AnalogLPF, const RendererType rendererType);
+	// Returns the FIR filter used in AnalogOutputMode_ACCURATE and AnalogOutputMode_OVERSAMPLED modes. The filter applies
+	// to the input upsampled by upsampleFactor with zero stuffing, the taps don't include the compensation of the upsampling gain.
+	static const FloatSample *getAccurateLowPassFilterTaps(const bool oldMT32AnalogLPF, Bit32u &tapCount, Bit32u &upsampleFactor);
 
 	virtual ~Analog() {}
 	virtual unsigned int getOutputSampleRate() const = 0;
 	virtual Bit32u getDACStreamsLength(const Bit32u outputLength) const = 0;
 	virtual void setSynthOutputGain(const float synthGain) = 0;
 	virtual void setReverbOutputGain(const float reverbGain, const bool mt32ReverbCompatibilityMode) = 0;
+	// Switches to the LPF of the given mode, the output gains and the renderer type remain intact. The new filter starts muted.
+	virtual void replaceLowPassFilter(const AnalogOutputMode mode, const bool oldMT32AnalogLPF) = 0;
+	// Returns true when the filter state contains nothing but zeros, so that processing silence yields exact silence.
+	virtual bool isSilent() const = 0;
+	// Returns the group delay of the LPF at DC in samples at the output sample rate.
+	virtual double getLatency() const = 0;
+	// Returns the number of bytes occupied by the analogue circuit emulation, including the low-pass filters.
+	virtual size_t getMemoryUsage() const = 0;
+	// Locks the state of the emulation, see MemoryLock. The filters replaced afterwards remain pageable.
+	virtual void lockMemory(MemoryLock &memoryLock) const = 0;
 
 	virtual bool process(IntSample *outStream, const IntSample *nonReverbLeft, const IntSample *nonReverbRight, const IntSample *reverbDryLeft, const IntSample *reverbDryRight, const IntSample *reverbWetLeft, const IntSample *reverbWetRight, Bit32u outLength) = 0;
 	virtual bool process(FloatSample *outStream, const FloatSample *nonReverbLeft, const FloatSample *nonReverbRight, const FloatSample *reverbDryLeft, const FloatSample *reverbDryRight, const FloatSample *reverbWetLeft, const FloatSample *reverbWetRight, Bit32u outLength) = 0;
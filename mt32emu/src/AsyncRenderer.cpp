@@ -0,0 +1,269 @@
+/* Copyright (C) 2021 Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <cstring>
+
+#include "internals.h"
+
+#include "AsyncRenderer.h"
+#include "SampleRateConverter.h"
+#include "Synth.h"
+
+namespace MT32Emu {
+
+// The ring buffer is filled in chunks of at most this many frames, so that the consumer side gets the rendered frames
+// without waiting for the entire buffer.
+static const Bit32u RENDER_AHEAD_CHUNK_LENGTH = 256;
+
+// Must be a power of 2. One entry is always kept free to tell a full queue from an empty one.
+static const Bit32u RENDER_REQUEST_QUEUE_SIZE = 16;
+
+struct AsyncRenderer::RenderRequest {
+	Bit16s *intStream;
+	float *floatStream;
+	Bit32u len;
+	RenderCallback *callback;
+
+	void setStream(Bit16s *stream) {
+		intStream = stream;
+	}
+
+	void setStream(float *stream) {
+		floatStream = stream;
+	}
+};
+
+static inline void convertSamples(const Bit16s *inBuffer, Bit16s *outBuffer, Bit32u sampleCount) {
+	memcpy(outBuffer, inBuffer, sampleCount * sizeof(Bit16s));
+}
+
+static inline void convertSamples(const float *inBuffer, float *outBuffer, Bit32u sampleCount) {
+	memcpy(outBuffer, inBuffer, sampleCount * sizeof(float));
+}
+
+template <class InSample, class OutSample>
+static inline void convertSamples(const InSample *inBuffer, OutSample *outBuffer, Bit32u sampleCount) {
+	const InSample *inBufferEnd = inBuffer + sampleCount;
+	while (inBuffer < inBufferEnd) {
+		*(outBuffer++) = Synth::convertSample(*(inBuffer++));
+	}
+}
+
+AsyncRenderer::AsyncRenderer(Synth &useSynth, Bit32u useBufferLength, Listener *useListener) :
+	synth(&useSynth),
+	converter(NULL),
+	listener(useListener),
+	bufferLength(useBufferLength > 0 ? useBufferLength : 1),
+	renderAheadLength(bufferLength),
+	intBuffer(useSynth.getSelectedRendererType() == RendererType_BIT16S ? new Bit16s[(bufferLength + 1) << 1] : NULL),
+	floatBuffer(intBuffer == NULL ? new float[(bufferLength + 1) << 1] : NULL),
+	readPosition(0),
+	writePosition(0),
+	underrunLength(0),
+	renderRequests(new RenderRequest[RENDER_REQUEST_QUEUE_SIZE]),
+	renderRequestsStart(0),
+	renderRequestsEnd(0)
+{}
+
+AsyncRenderer::AsyncRenderer(SampleRateConverter &useConverter, RendererType sampleFormat, Bit32u useBufferLength, Listener *useListener) :
+	synth(NULL),
+	converter(&useConverter),
+	listener(useListener),
+	bufferLength(useBufferLength > 0 ? useBufferLength : 1),
+	renderAheadLength(bufferLength),
+	intBuffer(sampleFormat == RendererType_BIT16S ? new Bit16s[(bufferLength + 1) << 1] : NULL),
+	floatBuffer(intBuffer == NULL ? new float[(bufferLength + 1) << 1] : NULL),
+	readPosition(0),
+	writePosition(0),
+	underrunLength(0),
+	renderRequests(new RenderRequest[RENDER_REQUEST_QUEUE_SIZE]),
+	renderRequestsStart(0),
+	renderRequestsEnd(0)
+{}
+
+AsyncRenderer::~AsyncRenderer() {
+	delete[] intBuffer;
+	delete[] floatBuffer;
+	delete[] renderRequests;
+}
+
+Bit32u AsyncRenderer::getBufferLength() const {
+	return bufferLength;
+}
+
+void AsyncRenderer::setRenderAheadLength(Bit32u newRenderAheadLength) {
+	renderAheadLength = newRenderAheadLength < bufferLength ? newRenderAheadLength : bufferLength;
+}
+
+Bit32u AsyncRenderer::getRenderAheadLength() const {
+	return renderAheadLength;
+}
+
+Bit32u AsyncRenderer::getAvailableLength() const {
+	const Bit32u myReadPosition = readPosition;
+	const Bit32u myWritePosition = writePosition;
+	return myWritePosition < myReadPosition ? myWritePosition + bufferLength + 1 - myReadPosition : myWritePosition - myReadPosition;
+}
+
+Bit32u AsyncRenderer::getUnderrunLength() const {
+	return underrunLength;
+}
+
+Bit32u AsyncRenderer::renderAhead() {
+	Bit32u renderedLength = 0;
+	while (renderRequestsStart != renderRequestsEnd) {
+		const RenderRequest &request = renderRequests[renderRequestsStart];
+		if (request.intStream != NULL) {
+			fulfillRenderRequest(request.intStream, request.len);
+			request.callback->onRenderComplete(request.intStream, request.len);
+		} else {
+			fulfillRenderRequest(request.floatStream, request.len);
+			request.callback->onRenderComplete(request.floatStream, request.len);
+		}
+		renderRequestsStart = (renderRequestsStart + 1) & (RENDER_REQUEST_QUEUE_SIZE - 1);
+	}
+
+	const Bit32u ringLength = bufferLength + 1;
+	Bit32u myWritePosition = writePosition;
+	for (;;) {
+		const Bit32u myReadPosition = readPosition;
+		// The frame before the read position is always kept free, as equal positions denote an empty ring buffer.
+		Bit32u freeLength;
+		if (myWritePosition < myReadPosition) {
+			freeLength = myReadPosition - myWritePosition - 1;
+		} else {
+			freeLength = ringLength - myWritePosition - (myReadPosition == 0 ? 1 : 0);
+		}
+		const Bit32u availableLength = myWritePosition < myReadPosition ? myWritePosition + ringLength - myReadPosition : myWritePosition - myReadPosition;
+		const Bit32u myRenderAheadLength = renderAheadLength;
+		if (availableLength >= myRenderAheadLength) break;
+		const Bit32u missingLength = myRenderAheadLength - availableLength;
+		if (freeLength > missingLength) freeLength = missingLength;
+		const Bit32u thisLength = freeLength < RENDER_AHEAD_CHUNK_LENGTH ? freeLength : RENDER_AHEAD_CHUNK_LENGTH;
+		if (intBuffer != NULL) {
+			renderSource(intBuffer + (myWritePosition << 1), thisLength);
+		} else {
+			renderSource(floatBuffer + (myWritePosition << 1), thisLength);
+		}
+		myWritePosition += thisLength;
+		if (myWritePosition == ringLength) myWritePosition = 0;
+		writePosition = myWritePosition;
+		renderedLength += thisLength;
+	}
+	return renderedLength;
+}
+
+Bit32u AsyncRenderer::read(Bit16s *stream, Bit32u len) {
+	const Bit32u takenLength = takeFrames(stream, len);
+	if (takenLength < len) {
+		memset(stream + (takenLength << 1), 0, ((len - takenLength) << 1) * sizeof(Bit16s));
+		underrunLength += len - takenLength;
+	}
+	notifyListener();
+	return takenLength;
+}
+
+Bit32u AsyncRenderer::read(float *stream, Bit32u len) {
+	const Bit32u takenLength = takeFrames(stream, len);
+	if (takenLength < len) {
+		memset(stream + (takenLength << 1), 0, ((len - takenLength) << 1) * sizeof(float));
+		underrunLength += len - takenLength;
+	}
+	notifyListener();
+	return takenLength;
+}
+
+bool AsyncRenderer::requestRender(Bit16s *stream, Bit32u len, RenderCallback *callback) {
+	return queueRenderRequest(stream, len, callback);
+}
+
+bool AsyncRenderer::requestRender(float *stream, Bit32u len, RenderCallback *callback) {
+	return queueRenderRequest(stream, len, callback);
+}
+
+template <class Sample>
+Bit32u AsyncRenderer::takeFrames(Sample *stream, Bit32u len) {
+	const Bit32u ringLength = bufferLength + 1;
+	Bit32u myReadPosition = readPosition;
+	const Bit32u availableLength = getAvailableLength();
+	const Bit32u takenLength = len < availableLength ? len : availableLength;
+	Bit32u remainingLength = takenLength;
+	while (remainingLength > 0) {
+		const Bit32u contiguousLength = ringLength - myReadPosition;
+		const Bit32u thisLength = remainingLength < contiguousLength ? remainingLength : contiguousLength;
+		if (intBuffer != NULL) {
+			convertSamples(intBuffer + (myReadPosition << 1), stream, thisLength << 1);
+		} else {
+			convertSamples(floatBuffer + (myReadPosition << 1), stream, thisLength << 1);
+		}
+		stream += thisLength << 1;
+		myReadPosition += thisLength;
+		if (myReadPosition == ringLength) myReadPosition = 0;
+		remainingLength -= thisLength;
+	}
+	readPosition = myReadPosition;
+	return takenLength;
+}
+
+template <class Sample>
+bool AsyncRenderer::queueRenderRequest(Sample *stream, Bit32u len, RenderCallback *callback) {
+	const Bit32u myRenderRequestsEnd = renderRequestsEnd;
+	const Bit32u newRenderRequestsEnd = (myRenderRequestsEnd + 1) & (RENDER_REQUEST_QUEUE_SIZE - 1);
+	if (newRenderRequestsEnd == renderRequestsStart) return false;
+	RenderRequest &request = renderRequests[myRenderRequestsEnd];
+	request.intStream = NULL;
+	request.floatStream = NULL;
+	request.setStream(stream);
+	request.len = len;
+	request.callback = callback;
+	renderRequestsEnd = newRenderRequestsEnd;
+	notifyListener();
+	return true;
+}
+
+// The frames rendered ahead go first, the shortfall is rendered right into the stream.
+template <class Sample>
+void AsyncRenderer::fulfillRenderRequest(Sample *stream, Bit32u len) {
+	const Bit32u takenLength = takeFrames(stream, len);
+	if (takenLength < len) {
+		renderSource(stream + (takenLength << 1), len - takenLength);
+	}
+}
+
+void AsyncRenderer::renderSource(Bit16s *stream, Bit32u len) {
+	if (converter != NULL) {
+		converter->getOutputSamples(stream, len);
+	} else {
+		synth->render(stream, len);
+	}
+}
+
+void AsyncRenderer::renderSource(float *stream, Bit32u len) {
+	if (converter != NULL) {
+		converter->getOutputSamples(stream, len);
+	} else {
+		synth->render(stream, len);
+	}
+}
+
+void AsyncRenderer::notifyListener() {
+	if (listener != NULL) {
+		listener->onRenderAheadNeeded();
+	}
+}
+
+} // namespace MT32Emu
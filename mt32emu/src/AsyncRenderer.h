@@ -0,0 +1,143 @@
+/* Copyright (C) 2021 Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MT32EMU_ASYNC_RENDERER_H
+#define MT32EMU_ASYNC_RENDERER_H
+
+#include <cstddef>
+
+#include "globals.h"
+#include "Types.h"
+#include "Enumerations.h"
+
+namespace MT32Emu {
+
+class Synth;
+class SampleRateConverter;
+
+/* AsyncRenderer decouples the audio output from the synthesis. A rendering thread renders the stereo output ahead
+ * into a ring buffer of a bounded length, so that the audio callback merely copies the rendered frames out, and thus
+ * returns quickly regardless of the synthesis load. As the library itself never creates threads, the client supplies
+ * the rendering thread, which is expected to invoke renderAhead() whenever the Listener requests so.
+ * The frames are consumed in either way, but not both:
+ * - read() copies the frames rendered ahead right away, which suits audio APIs that pull the data in a callback;
+ * - requestRender() queues a buffer to be filled on the rendering thread and completed with a RenderCallback,
+ *   which suits audio APIs that take the data in a queue of buffers.
+ * Functions of the consumer side never block, allocate memory or render, and may be invoked concurrently with
+ * the rendering thread. The rendering ring buffer is lock-free, in the same manner with MidiEventQueue.
+ * While the renderer is in use, the synth must not be rendered by other means.
+ */
+class MT32EMU_EXPORT_V(2.5) AsyncRenderer {
+public:
+	// Receives the notifications of the renderer on the consumer thread. The callbacks must not block.
+	class Listener {
+	public:
+		virtual ~Listener() {}
+
+		// Invoked when frames are taken out of the ring buffer or a render request is queued. The client should wake up
+		// the rendering thread to run renderAhead().
+		virtual void onRenderAheadNeeded() = 0;
+	};
+
+	// Completes the render requests on the rendering thread. The callbacks must not block.
+	class RenderCallback {
+	public:
+		virtual ~RenderCallback() {}
+
+		// Invoked when the buffer of a request is filled with the rendered frames. The length is in frames.
+		virtual void onRenderComplete(Bit16s * /* stream */, Bit32u /* len */) {}
+		virtual void onRenderComplete(float * /* stream */, Bit32u /* len */) {}
+	};
+
+	// Creates a renderer of the synth output at the native sample rate. The frames are kept in the ring buffer
+	// in the format of the renderer type selected in the synth. The buffer length in frames bounds the latency
+	// the renderer adds. The synth must remain valid while the renderer is in use.
+	AsyncRenderer(Synth &synth, Bit32u bufferLength, Listener *listener = NULL);
+	// Creates a renderer of the output of the synth attached to the converter at the target sample rate.
+	// The frames are kept in the ring buffer in the specified format, which should match the renderer type
+	// selected in the synth to avoid needless conversions. The converter must remain valid while the renderer is in use.
+	AsyncRenderer(SampleRateConverter &converter, RendererType sampleFormat, Bit32u bufferLength, Listener *listener = NULL);
+	~AsyncRenderer();
+
+	// Returns the maximum number of frames rendered ahead.
+	Bit32u getBufferLength() const;
+	// Limits the number of frames renderAhead() keeps rendered ahead to the specified length, which is clamped
+	// to the buffer length. This way, the latency may be adapted to the observed scheduling jitter while rendering,
+	// e.g. increased after an underrun and gradually decreased while the audio output runs smoothly.
+	// Zero disables rendering ahead, so that only the render requests are served. By default, the entire buffer is used.
+	// May be invoked concurrently with rendering.
+	void setRenderAheadLength(Bit32u renderAheadLength);
+	Bit32u getRenderAheadLength() const;
+	// Returns the number of frames rendered ahead and not yet consumed.
+	Bit32u getAvailableLength() const;
+	// Returns the total number of frames filled with silence by read() since the renderer was created, as the rendering
+	// thread failed to keep up with consuming.
+	Bit32u getUnderrunLength() const;
+
+	// To be invoked on the rendering thread. Fulfills the pending render requests, if any, and then renders frames
+	// until the render-ahead length is reached. Returns the number of frames rendered.
+	Bit32u renderAhead();
+
+	// Copies the frames rendered ahead into the interleaved stereo stream, filling up the rest of the stream with silence
+	// when fewer frames are available than requested. The length is in frames. Returns the number of frames actually
+	// taken from the ring buffer. The samples are converted when the stream format differs from the buffer format.
+	Bit32u read(Bit16s *stream, Bit32u len);
+	Bit32u read(float *stream, Bit32u len);
+
+	// Queues the interleaved stereo stream to be filled on the rendering thread, which invokes the callback afterwards.
+	// The length is in frames. The requests are fulfilled in the order they are queued. The stream and the callback
+	// must remain valid until the request is complete. Returns false if too many requests are pending already.
+	bool requestRender(Bit16s *stream, Bit32u len, RenderCallback *callback);
+	bool requestRender(float *stream, Bit32u len, RenderCallback *callback);
+
+private:
+	struct RenderRequest;
+
+	Synth * const synth;
+	SampleRateConverter * const converter;
+	Listener * const listener;
+	const Bit32u bufferLength;
+	volatile Bit32u renderAheadLength;
+	// Frames are kept in either buffer, depending on the format, while the other one is NULL.
+	Bit16s * const intBuffer;
+	float * const floatBuffer;
+	// Positions in frames, the ring buffer is empty when equal. The read position is only modified by the consumer side,
+	// whereas the write position is only modified by the rendering thread.
+	volatile Bit32u readPosition;
+	volatile Bit32u writePosition;
+	volatile Bit32u underrunLength;
+
+	RenderRequest * const renderRequests;
+	volatile Bit32u renderRequestsStart;
+	volatile Bit32u renderRequestsEnd;
+
+	template <class Sample>
+	Bit32u takeFrames(Sample *stream, Bit32u len);
+	template <class Sample>
+	bool queueRenderRequest(Sample *stream, Bit32u len, RenderCallback *callback);
+	template <class Sample>
+	void fulfillRenderRequest(Sample *stream, Bit32u len);
+	void renderSource(Bit16s *stream, Bit32u len);
+	void renderSource(float *stream, Bit32u len);
+	void notifyListener();
+
+	AsyncRenderer(const AsyncRenderer &);            // prevent copy-construction
+	AsyncRenderer &operator=(const AsyncRenderer &); // prevent assignment
+}; // class AsyncRenderer
+
+} // namespace MT32Emu
+
+#endif // #ifndef MT32EMU_ASYNC_RENDERER_H
@@ -20,6 +20,8 @@
 #include "internals.h"
 
 #include "BReverbModel.h"
+#include "MemoryLock.h"
+#include "mmath.h"
 #include "Synth.h"
 
 // Analysing of state of reverb RAM address lines gives exact sizes of the buffers of filters used. This also indicates that
@@ -37,8 +39,8 @@ static const Bit32u PROCESS_DELAY = 1;
 static const Bit32u MODE_3_ADDITIONAL_DELAY = 1;
 static const Bit32u MODE_3_FEEDBACK_DELAY = 1;
 
-// Avoid denormals degrading performance, using biased input
-static const FloatSample BIAS = 1e-20f;
+// The model is processed stage by stage in blocks of this many samples, so that the inner loops stay tight
+static const Bit32u PROCESS_BLOCK_LENGTH = 128;
 
 struct BReverbSettings {
 	const Bit32u numberOfAllpasses;
@@ -235,12 +237,13 @@ static inline FloatSample quarterSample(FloatSample sample) {
 	return 0.25f * sample;
 }
 
-static inline IntSample addDCBias(IntSample sample) {
+// The feedback loops decay to denormal values otherwise, which degrade performance unless the FPU flushes them.
+static inline IntSample flushDenormal(IntSample sample) {
 	return sample;
 }
 
-static inline FloatSample addDCBias(FloatSample sample) {
-	return sample + BIAS;
+static inline FloatSample flushDenormal(FloatSample sample) {
+	return FLUSH_DENORMAL(sample);
 }
 
 static inline IntSample addAllpassNoise(IntSample sample) {
@@ -292,6 +295,10 @@ public:
 		buffer = NULL;
 	}
 
+	void lockMemory(MemoryLock &memoryLock) const {
+		memoryLock.lock(buffer, size * sizeof(Sample));
+	}
+
 	Sample next() {
 		if (++index >= size) {
 			index = 0;
@@ -310,6 +317,15 @@ public:
 		return true;
 	}
 
+	bool isSilent() const {
+		if (buffer == NULL) return true;
+
+		for (Bit32u i = 0; i < size; i++) {
+			if (buffer[i] != 0) return false;
+		}
+		return true;
+	}
+
 	void mute() {
 		Synth::muteSampleBuffer(buffer, size);
 	}
@@ -336,11 +352,33 @@ public:
 		const Sample bufferOut = this->next();
 
 		// store input - feedback / 2
-		this->buffer[this->index] = in - halveSample(bufferOut);
+		this->buffer[this->index] = flushDenormal(Sample(in - halveSample(bufferOut)));
 
 		// return buffer output + feedforward / 2
 		return bufferOut + halveSample(this->buffer[this->index]);
 	}
+
+	// Same as above for a block of samples processed in place.
+	// Each output only depends on the respective input and the buffer content stored size samples earlier,
+	// so the iterations are independent within a contiguous stretch of the buffer and can be vectorised.
+	void process(Sample *samples, Bit32u length) {
+		while (length > 0) {
+			Bit32u start = this->index + 1;
+			if (start >= this->size) start = 0;
+			Bit32u stretchLength = this->size - start;
+			if (stretchLength > length) stretchLength = length;
+			Sample * const buf = this->buffer + start;
+			for (Bit32u i = 0; i < stretchLength; i++) {
+				const Sample bufferOut = buf[i];
+				const Sample bufferIn = flushDenormal(Sample(samples[i] - halveSample(bufferOut)));
+				buf[i] = bufferIn;
+				samples[i] = bufferOut + halveSample(bufferIn);
+			}
+			this->index = start + stretchLength - 1;
+			samples += stretchLength;
+			length -= stretchLength;
+		}
+	}
 };
 
 template <class Sample>
@@ -362,11 +400,14 @@ public:
 		const Sample filterIn = in + weirdMul(this->next(), feedbackFactor, 0xF0);
 
 		// store input + feedback processed by a low-pass filter
-		this->buffer[this->index] = weirdMul(last, filterFactor, 0xC0) - filterIn;
+		this->buffer[this->index] = flushDenormal(Sample(weirdMul(last, filterFactor, 0xC0) - filterIn));
 	}
 
+	// Output positions never exceed the buffer size, hence a single wrap check is sufficient
 	Sample getOutputAt(const Bit32u outIndex) const {
-		return this->buffer[(this->size + this->index - outIndex) % this->size];
+		Bit32u position = this->index + this->size - outIndex;
+		if (position >= this->size) position -= this->size;
+		return this->buffer[position];
 	}
 
 	void setFeedbackFactor(const Bit8u useFeedbackFactor) {
@@ -393,7 +434,7 @@ public:
 		Sample lpfOut = weirdMul(last, this->filterFactor, 0xFF) + in;
 
 		// store lpfOut multiplied by LPF amp factor
-		this->buffer[this->index] = weirdMul(lpfOut, amp, 0xFF);
+		this->buffer[this->index] = flushDenormal(weirdMul(lpfOut, amp, 0xFF));
 	}
 };
 
@@ -417,7 +458,7 @@ public:
 		const Sample filterIn = in + weirdMul(this->getOutputAt(outR + MODE_3_FEEDBACK_DELAY), this->feedbackFactor, 0xF0);
 
 		// store input + feedback processed by a low-pass filter
-		this->buffer[this->index] = weirdMul(last, this->filterFactor, 0xF0) - filterIn;
+		this->buffer[this->index] = flushDenormal(Sample(weirdMul(last, this->filterFactor, 0xF0) - filterIn));
 	}
 
 	Sample getLeftOutput() const {
@@ -479,6 +520,30 @@ public:
 		mute();
 	}
 
+	size_t getMemoryUsage() const {
+		size_t memoryUsage = sizeof(*this);
+		if (!isOpen()) return memoryUsage;
+		for (Bit32u i = 0; i < currentSettings.numberOfAllpasses; i++) {
+			memoryUsage += sizeof(*allpasses) + sizeof(AllpassFilter<Sample>) + currentSettings.allpassSizes[i] * sizeof(Sample);
+		}
+		for (Bit32u i = 0; i < currentSettings.numberOfCombs; i++) {
+			memoryUsage += sizeof(*combs) + currentSettings.combSizes[i] * sizeof(Sample);
+		}
+		if (tapDelayMode) return memoryUsage + sizeof(TapDelayCombFilter<Sample>);
+		return memoryUsage + sizeof(DelayWithLowPassFilter<Sample>) + (currentSettings.numberOfCombs - 1) * sizeof(CombFilter<Sample>);
+	}
+
+	void lockMemory(MemoryLock &memoryLock) const {
+		memoryLock.lock(this, sizeof(*this));
+		if (!isOpen()) return;
+		for (Bit32u i = 0; i < currentSettings.numberOfAllpasses; i++) {
+			allpasses[i]->lockMemory(memoryLock);
+		}
+		for (Bit32u i = 0; i < currentSettings.numberOfCombs; i++) {
+			combs[i]->lockMemory(memoryLock);
+		}
+	}
+
 	void close() {
 		if (allpasses != NULL) {
 			for (Bit32u i = 0; i < currentSettings.numberOfAllpasses; i++) {
@@ -553,6 +618,17 @@ public:
 		return false;
 	}
 
+	bool isSilent() const {
+		if (!isOpen()) return true;
+		for (Bit32u i = 0; i < currentSettings.numberOfAllpasses; i++) {
+			if (!allpasses[i]->isSilent()) return false;
+		}
+		for (Bit32u i = 0; i < currentSettings.numberOfCombs; i++) {
+			if (!combs[i]->isSilent()) return false;
+		}
+		return true;
+	}
+
 	bool isMT32Compatible(const ReverbMode mode) const {
 		return &currentSettings == &getMT32Settings(mode);
 	}
@@ -565,73 +641,236 @@ public:
 			return;
 		}
 
-		while ((numSamples--) > 0) {
-			Sample dry;
+		while (numSamples > 0) {
+			const Bit32u blockLength = numSamples < PROCESS_BLOCK_LENGTH ? numSamples : PROCESS_BLOCK_LENGTH;
+			Sample link[PROCESS_BLOCK_LENGTH];
 
+			// Looks like dryAmp doesn't change in MT-32 but it does in CM-32L / LAPC-I
 			if (tapDelayMode) {
-				dry = halveSample(*(inLeft++)) + halveSample(*(inRight++));
+				for (Bit32u i = 0; i < blockLength; i++) {
+					link[i] = weirdMul(Sample(halveSample(inLeft[i]) + halveSample(inRight[i])), dryAmp, 0xFF);
+				}
 			} else {
-				dry = quarterSample(*(inLeft++)) + quarterSample(*(inRight++));
+				for (Bit32u i = 0; i < blockLength; i++) {
+					link[i] = weirdMul(Sample(quarterSample(inLeft[i]) + quarterSample(inRight[i])), dryAmp, 0xFF);
+				}
 			}
-
-			// Looks like dryAmp doesn't change in MT-32 but it does in CM-32L / LAPC-I
-			dry = weirdMul(addDCBias(dry), dryAmp, 0xFF);
+			inLeft += blockLength;
+			inRight += blockLength;
 
 			if (tapDelayMode) {
-				TapDelayCombFilter<Sample> *comb = static_cast<TapDelayCombFilter<Sample> *>(*combs);
-				comb->process(dry);
-				if (outLeft != NULL) {
-					*(outLeft++) = weirdMul(comb->getLeftOutput(), wetLevel, 0xFF);
-				}
-				if (outRight != NULL) {
-					*(outRight++) = weirdMul(comb->getRightOutput(), wetLevel, 0xFF);
+				TapDelayCombFilter<Sample> * const comb = static_cast<TapDelayCombFilter<Sample> *>(*combs);
+				for (Bit32u i = 0; i < blockLength; i++) {
+					comb->process(link[i]);
+					if (outLeft != NULL) {
+						outLeft[i] = weirdMul(comb->getLeftOutput(), wetLevel, 0xFF);
+					}
+					if (outRight != NULL) {
+						outRight[i] = weirdMul(comb->getRightOutput(), wetLevel, 0xFF);
+					}
 				}
 			} else {
 				DelayWithLowPassFilter<Sample> * const entranceDelay = static_cast<DelayWithLowPassFilter<Sample> *>(combs[0]);
-				// If the output position is equal to the comb size, get it now in order not to loose it
-				Sample link = entranceDelay->getOutputAt(currentSettings.combSizes[0] - 1);
-
-				// Entrance LPF. Note, comb.process() differs a bit here.
-				entranceDelay->process(dry);
+				const Bit32u entranceOutPosition = currentSettings.combSizes[0] - 1;
+				for (Bit32u i = 0; i < blockLength; i++) {
+					const Sample dry = link[i];
+					// If the output position is equal to the comb size, get it now in order not to loose it
+					link[i] = addAllpassNoise(entranceDelay->getOutputAt(entranceOutPosition));
+
+					// Entrance LPF. Note, comb.process() differs a bit here.
+					entranceDelay->process(dry);
+				}
 
-				link = allpasses[0]->process(addAllpassNoise(link));
-				link = allpasses[1]->process(link);
-				link = allpasses[2]->process(link);
+				allpasses[0]->process(link, blockLength);
+				allpasses[1]->process(link, blockLength);
+				allpasses[2]->process(link, blockLength);
+
+				// The combs are independent of each other, so each one processes the whole block before the next one.
+				// The outputs are tapped at the same points relative to the comb processing as if it went sample by sample.
+				Sample outL1[PROCESS_BLOCK_LENGTH], outL2[PROCESS_BLOCK_LENGTH], outL3[PROCESS_BLOCK_LENGTH];
+				Sample outR1[PROCESS_BLOCK_LENGTH], outR2[PROCESS_BLOCK_LENGTH], outR3[PROCESS_BLOCK_LENGTH];
+				const Bit32u * const outLPositions = currentSettings.outLPositions;
+				const Bit32u * const outRPositions = currentSettings.outRPositions;
+
+				CombFilter<Sample> * const comb1 = combs[1];
+				for (Bit32u i = 0; i < blockLength; i++) {
+					// If the output position is equal to the comb size, get it now in order not to loose it
+					outL1[i] = comb1->getOutputAt(outLPositions[0] - 1);
+					comb1->process(link[i]);
+					outR1[i] = comb1->getOutputAt(outRPositions[0]);
+				}
 
-				// If the output position is equal to the comb size, get it now in order not to loose it
-				Sample outL1 = combs[1]->getOutputAt(currentSettings.outLPositions[0] - 1);
+				CombFilter<Sample> * const comb2 = combs[2];
+				for (Bit32u i = 0; i < blockLength; i++) {
+					comb2->process(link[i]);
+					outL2[i] = comb2->getOutputAt(outLPositions[1]);
+					outR2[i] = comb2->getOutputAt(outRPositions[1]);
+				}
 
-				combs[1]->process(link);
-				combs[2]->process(link);
-				combs[3]->process(link);
+				CombFilter<Sample> * const comb3 = combs[3];
+				for (Bit32u i = 0; i < blockLength; i++) {
+					comb3->process(link[i]);
+					outL3[i] = comb3->getOutputAt(outLPositions[2]);
+					outR3[i] = comb3->getOutputAt(outRPositions[2]);
+				}
 
 				if (outLeft != NULL) {
-					Sample outL2 = combs[2]->getOutputAt(currentSettings.outLPositions[1]);
-					Sample outL3 = combs[3]->getOutputAt(currentSettings.outLPositions[2]);
-					Sample outSample = mixCombs(outL1, outL2, outL3);
-					*(outLeft++) = weirdMul(outSample, wetLevel, 0xFF);
+					for (Bit32u i = 0; i < blockLength; i++) {
+						outLeft[i] = weirdMul(mixCombs(outL1[i], outL2[i], outL3[i]), wetLevel, 0xFF);
+					}
 				}
 				if (outRight != NULL) {
-					Sample outR1 = combs[1]->getOutputAt(currentSettings.outRPositions[0]);
-					Sample outR2 = combs[2]->getOutputAt(currentSettings.outRPositions[1]);
-					Sample outR3 = combs[3]->getOutputAt(currentSettings.outRPositions[2]);
-					Sample outSample = mixCombs(outR1, outR2, outR3);
-					*(outRight++) = weirdMul(outSample, wetLevel, 0xFF);
+					for (Bit32u i = 0; i < blockLength; i++) {
+						outRight[i] = weirdMul(mixCombs(outR1[i], outR2[i], outR3[i]), wetLevel, 0xFF);
+					}
 				}
 			} // if (tapDelayMode)
-		} // while ((numSamples--) > 0)
+
+			if (outLeft != NULL) outLeft += blockLength;
+			if (outRight != NULL) outRight += blockLength;
+			numSamples -= blockLength;
+		} // while (numSamples > 0)
 	} // produceOutput
 
 	bool process(const IntSample *inLeft, const IntSample *inRight, IntSample *outLeft, IntSample *outRight, Bit32u numSamples);
 	bool process(const FloatSample *inLeft, const FloatSample *inRight, FloatSample *outLeft, FloatSample *outRight, Bit32u numSamples);
 };
 
+// Adapts the client supplied ReverbEngine to the reverb model interface. The engine processes normalised float samples
+// in place, so the input is copied to the work buffers, converted as needed, and the wet output is taken from there.
+// The engine only tells whether it is active, so it is known to be silent once muted and inactive since.
+class ExternalReverbModel : public BReverbModel {
+	ReverbEngine &engine;
+	const ReverbMode mode;
+	const bool mt32CompatibleModel;
+	float *workBuffer;
+	bool muted;
+
+	template <class Sample>
+	void produceOutput(const Sample *inLeft, const Sample *inRight, Sample *outLeft, Sample *outRight, Bit32u numSamples) {
+		float * const workLeft = workBuffer;
+		float * const workRight = workBuffer + MAX_SAMPLES_PER_RUN;
+		while (numSamples > 0) {
+			const Bit32u blockLength = numSamples < MAX_SAMPLES_PER_RUN ? numSamples : MAX_SAMPLES_PER_RUN;
+			for (Bit32u i = 0; i < blockLength; i++) {
+				workLeft[i] = toFloat(inLeft[i]);
+				workRight[i] = toFloat(inRight[i]);
+			}
+			engine.process(workLeft, workRight, blockLength);
+			muted = false;
+			if (outLeft != NULL) {
+				for (Bit32u i = 0; i < blockLength; i++) {
+					fromFloat(workLeft[i], outLeft[i]);
+				}
+				outLeft += blockLength;
+			}
+			if (outRight != NULL) {
+				for (Bit32u i = 0; i < blockLength; i++) {
+					fromFloat(workRight[i], outRight[i]);
+				}
+				outRight += blockLength;
+			}
+			inLeft += blockLength;
+			inRight += blockLength;
+			numSamples -= blockLength;
+		}
+	}
+
+	static float toFloat(IntSample sample) {
+		return Synth::convertSample(sample);
+	}
+
+	static float toFloat(FloatSample sample) {
+		return sample;
+	}
+
+	static void fromFloat(float sample, IntSample &outSample) {
+		outSample = Synth::convertSample(sample);
+	}
+
+	static void fromFloat(float sample, FloatSample &outSample) {
+		outSample = sample;
+	}
+
+public:
+	ExternalReverbModel(ReverbEngine &useEngine, const ReverbMode useMode, const bool useMT32CompatibleModel) :
+		engine(useEngine), mode(useMode), mt32CompatibleModel(useMT32CompatibleModel), workBuffer(NULL), muted(false)
+	{}
+
+	~ExternalReverbModel() {
+		close();
+	}
+
+	bool isOpen() const {
+		return workBuffer != NULL;
+	}
+
+	void open() {
+		if (isOpen()) return;
+		workBuffer = new float[2 * MAX_SAMPLES_PER_RUN];
+		mute();
+	}
+
+	void close() {
+		delete[] workBuffer;
+		workBuffer = NULL;
+	}
+
+	void mute() {
+		engine.mute();
+		muted = true;
+	}
+
+	void setParameters(Bit8u time, Bit8u level) {
+		engine.setMode(Bit8u(mode), mt32CompatibleModel);
+		engine.setParameters(time, level);
+	}
+
+	bool isActive() const {
+		return engine.isActive();
+	}
+
+	bool isSilent() const {
+		return muted && !engine.isActive();
+	}
+
+	bool isMT32Compatible(const ReverbMode) const {
+		return mt32CompatibleModel;
+	}
+
+	size_t getMemoryUsage() const {
+		return sizeof(*this) + (isOpen() ? 2 * MAX_SAMPLES_PER_RUN * sizeof(float) : 0);
+	}
+
+	void lockMemory(MemoryLock &memoryLock) const {
+		memoryLock.lock(this, sizeof(*this));
+		if (isOpen()) memoryLock.lock(workBuffer, 2 * MAX_SAMPLES_PER_RUN * sizeof(float));
+	}
+
+	bool process(const IntSample *inLeft, const IntSample *inRight, IntSample *outLeft, IntSample *outRight, Bit32u numSamples) {
+		if (!isOpen()) return false;
+		produceOutput(inLeft, inRight, outLeft, outRight, numSamples);
+		return true;
+	}
+
+	bool process(const FloatSample *inLeft, const FloatSample *inRight, FloatSample *outLeft, FloatSample *outRight, Bit32u numSamples) {
+		if (!isOpen()) return false;
+		produceOutput(inLeft, inRight, outLeft, outRight, numSamples);
+		return true;
+	}
+}; // class ExternalReverbModel
+
+BReverbModel *BReverbModel::createExternalReverbModel(ReverbEngine &engine, const ReverbMode mode, const bool mt32CompatibleModel) {
+	return new ExternalReverbModel(engine, mode, mt32CompatibleModel);
+}
+
 BReverbModel *BReverbModel::createBReverbModel(const ReverbMode mode, const bool mt32CompatibleModel, const RendererType rendererType) {
 	switch (rendererType)
 	{
 	case RendererType_BIT16S:
 		return new BReverbModelImpl<IntSample>(mode, mt32CompatibleModel);
 	case RendererType_FLOAT:
+	case RendererType_FLOAT_WAVETABLE:
 		return new BReverbModelImpl<FloatSample>(mode, mt32CompatibleModel);
 	default:
 		break;
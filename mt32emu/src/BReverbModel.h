@@ -18,6 +18,8 @@
 #ifndef MT32EMU_B_REVERB_MODEL_H
 #define MT32EMU_B_REVERB_MODEL_H
 
+#include <cstddef>
+
 #include "globals.h"
 #include "internals.h"
 #include "Enumerations.h"
@@ -25,9 +27,14 @@
 
 namespace MT32Emu {
 
+class MemoryLock;
+class ReverbEngine;
+
 class BReverbModel {
 public:
 	static BReverbModel *createBReverbModel(const ReverbMode mode, const bool mt32CompatibleModel, const RendererType rendererType);
+	// Creates the model that forwards the processing of the mode to the client supplied engine, for any renderer type.
+	static BReverbModel *createExternalReverbModel(ReverbEngine &engine, const ReverbMode mode, const bool mt32CompatibleModel);
 
 	virtual ~BReverbModel() {}
 	virtual bool isOpen() const = 0;
@@ -38,7 +45,13 @@ public:
 	virtual void mute() = 0;
 	virtual void setParameters(Bit8u time, Bit8u level) = 0;
 	virtual bool isActive() const = 0;
+	// Returns true when the internal state contains nothing but zeros, so that processing silence yields exact silence.
+	virtual bool isSilent() const = 0;
 	virtual bool isMT32Compatible(const ReverbMode mode) const = 0;
+	// Returns the number of bytes occupied by the model, including the delay line buffers while open.
+	virtual size_t getMemoryUsage() const = 0;
+	// Locks the memory getMemoryUsage() accounts for, see MemoryLock.
+	virtual void lockMemory(MemoryLock &memoryLock) const = 0;
 	virtual bool process(const IntSample *inLeft, const IntSample *inRight, IntSample *outLeft, IntSample *outRight, Bit32u numSamples) = 0;
 	virtual bool process(const FloatSample *inLeft, const FloatSample *inRight, FloatSample *outLeft, FloatSample *outRight, Bit32u numSamples) = 0;
 };
@@ -41,6 +41,9 @@
 #define MT32EMU_RENDERER_TYPE_NAME mt32emu_renderer_type
 #define MT32EMU_RENDERER_TYPE(ident) MT32EMU_RT_##ident
 
+#define MT32EMU_CPU_FEATURE_NAME mt32emu_cpu_feature
+#define MT32EMU_CPU_FEATURE(ident) MT32EMU_CPUF_##ident
+
 #else /* #ifdef MT32EMU_C_ENUMERATIONS */
 
 #define MT32EMU_CPP_ENUMERATIONS_H
@@ -63,6 +66,9 @@
 #define MT32EMU_RENDERER_TYPE_NAME RendererType
 #define MT32EMU_RENDERER_TYPE(ident) RendererType_##ident
 
+#define MT32EMU_CPU_FEATURE_NAME CPUFeature
+#define MT32EMU_CPU_FEATURE(ident) CPUFeature_##ident
+
 namespace MT32Emu {
 
 #endif /* #ifdef MT32EMU_C_ENUMERATIONS */
@@ -135,7 +141,15 @@ enum MT32EMU_ANALOG_OUTPUT_MODE_NAME {
 	 * This makes subsequent resampling easier. Besides, due to nonlinear passband of the LPF emulated, it takes fewer number of MACs
 	 * compared to a regular LPF FIR implementations.
 	 */
-	MT32EMU_ANALOG_OUTPUT_MODE(OVERSAMPLED)
+	MT32EMU_ANALOG_OUTPUT_MODE(OVERSAMPLED),
+	/**
+	 * Same as AnalogOutputMode_OVERSAMPLED mode but the 96 kHz signal is then decimated to 48 kHz using a half-band elliptic
+	 * IIR filter, so the output sample rate is the same as in AnalogOutputMode_ACCURATE mode. The frequency response remains flat
+	 * up to about 22.8 kHz, and the spectral images above 24 kHz are suppressed rather than folded back. This costs about as much
+	 * as AnalogOutputMode_ACCURATE mode followed by the sample rate conversion to 48 kHz, while the output needs no further
+	 * resampling for a 48 kHz audio device.
+	 */
+	MT32EMU_ANALOG_OUTPUT_MODE(DECIMATED)
 };
 
 enum MT32EMU_PARTIAL_STATE_NAME {
@@ -150,14 +164,41 @@ enum MT32EMU_SAMPLERATE_CONVERSION_QUALITY_NAME {
 	MT32EMU_SAMPLERATE_CONVERSION_QUALITY(FASTEST),
 	MT32EMU_SAMPLERATE_CONVERSION_QUALITY(FAST),
 	MT32EMU_SAMPLERATE_CONVERSION_QUALITY(GOOD),
-	MT32EMU_SAMPLERATE_CONVERSION_QUALITY(BEST)
+	MT32EMU_SAMPLERATE_CONVERSION_QUALITY(BEST),
+	/**
+	 * Similar to BEST but minimises the delay introduced by the conversion, which is useful for live playing.
+	 * The phase response is not linear in this mode.
+	 */
+	MT32EMU_SAMPLERATE_CONVERSION_QUALITY(LOW_LATENCY)
 };
 
 enum MT32EMU_RENDERER_TYPE_NAME {
 	/** Use 16-bit signed samples in the renderer and the accurate wave generator model based on logarithmic fixed-point computations and LUTs. Maximum emulation accuracy and speed. */
 	MT32EMU_RENDERER_TYPE(BIT16S),
 	/** Use float samples in the renderer and simplified wave generator model. Maximum output quality and minimum noise. */
-	MT32EMU_RENDERER_TYPE(FLOAT)
+	MT32EMU_RENDERER_TYPE(FLOAT),
+	/**
+	 * Use float samples in the renderer like FLOAT, though the synth waves are looked up in precomputed band-limited wavetables
+	 * rather than computed after the wave generator model for each sample. Faster than FLOAT at the cost of timbre accuracy.
+	 * The wavetables take about 0.6 MB of memory, which is shared among all the synths in the process.
+	 */
+	MT32EMU_RENDERER_TYPE(FLOAT_WAVETABLE)
+};
+
+/**
+ * Instruction set extensions the optimised implementations of the rendering kernels may use. The values are bit flags,
+ * which are combined in a mask of the extensions.
+ */
+enum MT32EMU_CPU_FEATURE_NAME {
+	MT32EMU_CPU_FEATURE(SSE2) = 1,
+	MT32EMU_CPU_FEATURE(SSE4_1) = 2,
+	MT32EMU_CPU_FEATURE(AVX2) = 4,
+	MT32EMU_CPU_FEATURE(AVX512F) = 8,
+	MT32EMU_CPU_FEATURE(NEON) = 16,
+	/** The SHA extensions of x86 CPUs, only used to compute the SHA1 digests of the ROM files. */
+	MT32EMU_CPU_FEATURE(SHA) = 32,
+	/** The SHA1 instructions of the AArch64 cryptographic extension, used likewise. */
+	MT32EMU_CPU_FEATURE(SHA1) = 64
 };
 
 #ifndef MT32EMU_C_ENUMERATIONS
@@ -184,4 +225,7 @@ enum MT32EMU_RENDERER_TYPE_NAME {
 #undef MT32EMU_RENDERER_TYPE_NAME
 #undef MT32EMU_RENDERER_TYPE
 
+#undef MT32EMU_CPU_FEATURE_NAME
+#undef MT32EMU_CPU_FEATURE
+
 #endif /* #if (!defined MT32EMU_CPP_ENUMERATIONS_H && !defined MT32EMU_C_ENUMERATIONS) || (!defined MT32EMU_C_ENUMERATIONS_H && defined MT32EMU_C_ENUMERATIONS) */
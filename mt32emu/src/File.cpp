@@ -20,6 +20,7 @@
 #include "internals.h"
 
 #include "File.h"
+#include "Kernels.h"
 #include "sha1/sha1.h"
 
 namespace MT32Emu {
@@ -55,7 +56,7 @@ const File::SHA1Digest &AbstractFile::getSHA1() {
 
 	unsigned char fileDigest[20];
 
-	sha1::calc(data, int(size), fileDigest);
+	Kernels::calcSHA1(data, size, fileDigest);
 	sha1::toHexString(fileDigest, sha1Digest);
 	return sha1Digest;
 }
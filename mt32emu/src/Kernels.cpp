@@ -0,0 +1,865 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <cstring>
+
+#include "internals.h"
+
+#include "Kernels.h"
+#include "Enumerations.h"
+#include "Synth.h"
+#include "sha1/sha1.h"
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#define MT32EMU_KERNELS_X86
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#define MT32EMU_KERNELS_AVX2
+#define MT32EMU_KERNELS_SHA
+#define MT32EMU_TARGET_SSE2
+#define MT32EMU_TARGET_AVX2
+#define MT32EMU_TARGET_SHA
+#elif defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+// The implementations are compiled for the extension they use regardless of the compiler options, and they are only
+// invoked when the CPU supports it.
+#include <cpuid.h>
+#include <immintrin.h>
+#define MT32EMU_KERNELS_AVX2
+#define MT32EMU_KERNELS_SHA
+#define MT32EMU_TARGET_SSE2 __attribute__((target("sse2")))
+#define MT32EMU_TARGET_AVX2 __attribute__((target("avx2")))
+#define MT32EMU_TARGET_SHA __attribute__((target("sha,ssse3")))
+#else
+// Older compilers need the extension enabled in the compiler options to build the SSE2 implementations.
+#include <cpuid.h>
+#define MT32EMU_TARGET_SSE2
+#endif
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+// NEON is a mandatory part of AArch64.
+#define MT32EMU_KERNELS_NEON
+#include <arm_neon.h>
+#if defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2)
+// Unlike NEON, the SHA1 instructions are optional. The older compilers only declare the intrinsics when the compiler options
+// enable the cryptographic extension, so the implementation is only built then, and the CPU is bound to support it.
+#define MT32EMU_KERNELS_SHA1_ARMV8
+#endif
+#endif
+
+namespace MT32Emu {
+
+static const char *const KERNEL_NAMES[] = {
+	"convertFloatToInt",
+	"convertIntToFloat",
+	"panAndMixFloat",
+	"doubleAndWrapFloat",
+	"convertFloatToIntDithered",
+	"generatePCMFloat"
+};
+
+static const struct {
+	const char *name;
+	CPUFeature feature;
+} CPU_FEATURE_NAMES[] = {
+	{ "sse2", CPUFeature_SSE2 },
+	{ "sse4.1", CPUFeature_SSE4_1 },
+	{ "avx2", CPUFeature_AVX2 },
+	{ "avx512f", CPUFeature_AVX512F },
+	{ "neon", CPUFeature_NEON },
+	{ "sha", CPUFeature_SHA },
+	{ "sha1", CPUFeature_SHA1 }
+};
+
+static const char ENVIRONMENT_VARIABLE[] = "MT32EMU_CPU_FEATURES";
+
+static void convertFloatToIntPortable(const float *inBuffer, Bit16s *outBuffer, const Bit32u len) {
+	for (Bit32u i = 0; i < len; i++) {
+		outBuffer[i] = Synth::convertSample(inBuffer[i]);
+	}
+}
+
+static void convertIntToFloatPortable(const Bit16s *inBuffer, float *outBuffer, const Bit32u len) {
+	for (Bit32u i = 0; i < len; i++) {
+		outBuffer[i] = Synth::convertSample(inBuffer[i]);
+	}
+}
+
+static void panAndMixFloatPortable(const float *samples, float *leftBuf, float *rightBuf, const float leftPan, const float rightPan, const Bit32u len) {
+	for (Bit32u i = 0; i < len; i++) {
+		leftBuf[i] += (samples[i] * leftPan) / 14.0f;
+		rightBuf[i] += (samples[i] * rightPan) / 14.0f;
+	}
+}
+
+static void doubleAndWrapFloatPortable(float *buffer, const Bit32u len) {
+	for (Bit32u i = 0; i < len; i++) {
+		const float sample = 2.0f * buffer[i];
+		if (sample < -1.0f) {
+			buffer[i] = sample + 2.0f;
+		} else if (1.0f < sample) {
+			buffer[i] = sample - 2.0f;
+		} else {
+			buffer[i] = sample;
+		}
+	}
+}
+
+// Returns uniformly distributed bits for the dither at the position, see convertFloatToIntDitheredPortable().
+static inline Bit32u hashDitherPosition(Bit32u position) {
+	position ^= position >> 16;
+	position *= 0x7FEB352DU;
+	position ^= position >> 15;
+	position *= 0x846CA68BU;
+	position ^= position >> 16;
+	return position;
+}
+
+// The two halves of the hash make up a pair of independent uniform values, the sum of which has the triangular distribution.
+// The rounding works as truncation of an offset positive value, and the clamping follows the semantics of the SSE min / max
+// instructions, including NaNs which yield the lower limit, so that all the implementations are bit-exact.
+static void convertFloatToIntDitheredPortable(const float *inBuffer, Bit16s *outBuffer, const Bit32u len, const Bit32u ditherPosition) {
+	for (Bit32u i = 0; i < len; i++) {
+		const Bit32u hash = hashDitherPosition(ditherPosition + i);
+		const float dither = float(Bit32s(hash >> 16) + Bit32s(hash & 0xFFFF) - 65535) / 65536.0f;
+		float sample = inBuffer[i] * 32768.0f + dither;
+		sample = sample > -32768.0f ? sample : -32768.0f;
+		sample = sample < 32767.0f ? sample : 32767.0f;
+		outBuffer[i] = Bit16s(Bit32s(sample + 32768.5f) - 32768);
+	}
+}
+
+static void generatePCMFloatPortable(const float *wave, const Bit32u *positions, const float *fractions, const float *amps, float *outputs, const Bit32u len) {
+	for (Bit32u i = 0; i < len; i++) {
+		const float firstSample = wave[positions[i]];
+		if (fractions == NULL) {
+			outputs[i] = firstSample * amps[i];
+		} else {
+			outputs[i] = (firstSample + (wave[positions[i] + 1] - firstSample) * fractions[i]) * amps[i];
+		}
+	}
+}
+
+#ifdef MT32EMU_KERNELS_X86
+
+// The conversion truncates and saturates the same way as Synth::convertSample(). The scaling by a power of two is exact,
+// so multiplying by the reciprocal yields the same result as the division.
+MT32EMU_TARGET_SSE2 static void convertFloatToIntSSE2(const float *inBuffer, Bit16s *outBuffer, const Bit32u len) {
+	const __m128 scale = _mm_set1_ps(32768.0f);
+	Bit32u i = 0;
+	for (; i + 8 <= len; i += 8) {
+		const __m128i low = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(inBuffer + i), scale));
+		const __m128i high = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(inBuffer + i + 4), scale));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(outBuffer + i), _mm_packs_epi32(low, high));
+	}
+	convertFloatToIntPortable(inBuffer + i, outBuffer + i, len - i);
+}
+
+MT32EMU_TARGET_SSE2 static void convertIntToFloatSSE2(const Bit16s *inBuffer, float *outBuffer, const Bit32u len) {
+	const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+	Bit32u i = 0;
+	for (; i + 8 <= len; i += 8) {
+		const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(inBuffer + i));
+		const __m128i signs = _mm_srai_epi16(samples, 15);
+		_mm_storeu_ps(outBuffer + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(samples, signs)), scale));
+		_mm_storeu_ps(outBuffer + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(samples, signs)), scale));
+	}
+	convertIntToFloatPortable(inBuffer + i, outBuffer + i, len - i);
+}
+
+MT32EMU_TARGET_SSE2 static void panAndMixFloatSSE2(const float *samples, float *leftBuf, float *rightBuf, const float leftPan, const float rightPan, const Bit32u len) {
+	const __m128 leftPans = _mm_set1_ps(leftPan);
+	const __m128 rightPans = _mm_set1_ps(rightPan);
+	const __m128 divisor = _mm_set1_ps(14.0f);
+	Bit32u i = 0;
+	for (; i + 4 <= len; i += 4) {
+		const __m128 sample = _mm_loadu_ps(samples + i);
+		_mm_storeu_ps(leftBuf + i, _mm_add_ps(_mm_loadu_ps(leftBuf + i), _mm_div_ps(_mm_mul_ps(sample, leftPans), divisor)));
+		_mm_storeu_ps(rightBuf + i, _mm_add_ps(_mm_loadu_ps(rightBuf + i), _mm_div_ps(_mm_mul_ps(sample, rightPans), divisor)));
+	}
+	panAndMixFloatPortable(samples + i, leftBuf + i, rightBuf + i, leftPan, rightPan, len - i);
+}
+
+// The wrapped samples are selected by the comparison masks rather than adding a masked offset, so that the samples
+// in range are left intact, including the sign of zero.
+MT32EMU_TARGET_SSE2 static void doubleAndWrapFloatSSE2(float *buffer, const Bit32u len) {
+	const __m128 two = _mm_set1_ps(2.0f);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 minusOne = _mm_set1_ps(-1.0f);
+	Bit32u i = 0;
+	for (; i + 4 <= len; i += 4) {
+		const __m128 sample = _mm_mul_ps(_mm_loadu_ps(buffer + i), two);
+		const __m128 belowMask = _mm_cmplt_ps(sample, minusOne);
+		const __m128 aboveMask = _mm_cmplt_ps(one, sample);
+		__m128 result = _mm_or_ps(_mm_and_ps(belowMask, _mm_add_ps(sample, two)), _mm_andnot_ps(belowMask, sample));
+		result = _mm_or_ps(_mm_and_ps(aboveMask, _mm_sub_ps(sample, two)), _mm_andnot_ps(aboveMask, result));
+		_mm_storeu_ps(buffer + i, result);
+	}
+	doubleAndWrapFloatPortable(buffer + i, len - i);
+}
+
+// SSE2 lacks the 32-bit low multiplication, so it is made up of two 64-bit ones, for the even and the odd elements.
+MT32EMU_TARGET_SSE2 static inline __m128i multiplyLowSSE2(const __m128i a, const __m128i b) {
+	const __m128i even = _mm_mul_epu32(a, b);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+MT32EMU_TARGET_SSE2 static inline __m128i hashDitherPositionsSSE2(__m128i positions) {
+	positions = _mm_xor_si128(positions, _mm_srli_epi32(positions, 16));
+	positions = multiplyLowSSE2(positions, _mm_set1_epi32(0x7FEB352D));
+	positions = _mm_xor_si128(positions, _mm_srli_epi32(positions, 15));
+	positions = multiplyLowSSE2(positions, _mm_set1_epi32(int(0x846CA68BU)));
+	return _mm_xor_si128(positions, _mm_srli_epi32(positions, 16));
+}
+
+MT32EMU_TARGET_SSE2 static inline __m128i ditherAndConvertSSE2(const __m128 samples, const __m128i positions) {
+	const __m128i hash = hashDitherPositionsSSE2(positions);
+	const __m128i ditherSum = _mm_add_epi32(_mm_srli_epi32(hash, 16), _mm_and_si128(hash, _mm_set1_epi32(0xFFFF)));
+	const __m128 dither = _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(ditherSum, _mm_set1_epi32(65535))), _mm_set1_ps(1.0f / 65536.0f));
+	__m128 sample = _mm_add_ps(_mm_mul_ps(samples, _mm_set1_ps(32768.0f)), dither);
+	sample = _mm_min_ps(_mm_max_ps(sample, _mm_set1_ps(-32768.0f)), _mm_set1_ps(32767.0f));
+	return _mm_sub_epi32(_mm_cvttps_epi32(_mm_add_ps(sample, _mm_set1_ps(32768.5f))), _mm_set1_epi32(32768));
+}
+
+MT32EMU_TARGET_SSE2 static void convertFloatToIntDitheredSSE2(const float *inBuffer, Bit16s *outBuffer, const Bit32u len, const Bit32u ditherPosition) {
+	const __m128i step = _mm_set1_epi32(8);
+	__m128i positions = _mm_add_epi32(_mm_set1_epi32(int(ditherPosition)), _mm_set_epi32(3, 2, 1, 0));
+	Bit32u i = 0;
+	for (; i + 8 <= len; i += 8) {
+		const __m128i low = ditherAndConvertSSE2(_mm_loadu_ps(inBuffer + i), positions);
+		const __m128i high = ditherAndConvertSSE2(_mm_loadu_ps(inBuffer + i + 4), _mm_add_epi32(positions, _mm_set1_epi32(4)));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(outBuffer + i), _mm_packs_epi32(low, high));
+		positions = _mm_add_epi32(positions, step);
+	}
+	convertFloatToIntDitheredPortable(inBuffer + i, outBuffer + i, len - i, ditherPosition + i);
+}
+
+// SSE2 has no gather, so the samples are loaded one by one, and only the arithmetic is done in the vectors.
+MT32EMU_TARGET_SSE2 static void generatePCMFloatSSE2(const float *wave, const Bit32u *positions, const float *fractions, const float *amps, float *outputs, const Bit32u len) {
+	Bit32u i = 0;
+	if (fractions == NULL) {
+		for (; i + 4 <= len; i += 4) {
+			const __m128 samples = _mm_set_ps(wave[positions[i + 3]], wave[positions[i + 2]], wave[positions[i + 1]], wave[positions[i]]);
+			_mm_storeu_ps(outputs + i, _mm_mul_ps(samples, _mm_loadu_ps(amps + i)));
+		}
+		generatePCMFloatPortable(wave, positions + i, NULL, amps + i, outputs + i, len - i);
+		return;
+	}
+	for (; i + 4 <= len; i += 4) {
+		const __m128 firstSamples = _mm_set_ps(wave[positions[i + 3]], wave[positions[i + 2]], wave[positions[i + 1]], wave[positions[i]]);
+		const __m128 nextSamples = _mm_set_ps(wave[positions[i + 3] + 1], wave[positions[i + 2] + 1], wave[positions[i + 1] + 1], wave[positions[i] + 1]);
+		const __m128 deltas = _mm_mul_ps(_mm_sub_ps(nextSamples, firstSamples), _mm_loadu_ps(fractions + i));
+		_mm_storeu_ps(outputs + i, _mm_mul_ps(_mm_add_ps(firstSamples, deltas), _mm_loadu_ps(amps + i)));
+	}
+	generatePCMFloatPortable(wave, positions + i, fractions + i, amps + i, outputs + i, len - i);
+}
+
+#ifdef MT32EMU_KERNELS_AVX2
+
+// Each AVX2 implementation clears the upper halves of the registers before it falls back to the SSE2 or the portable code
+// for the remaining samples, and so before returning. The compilers may omit that on a tail call, and the SSE code that
+// runs afterwards with the upper halves dirty is several times slower.
+MT32EMU_TARGET_AVX2 static void convertFloatToIntAVX2(const float *inBuffer, Bit16s *outBuffer, const Bit32u len) {
+	const __m256 scale = _mm256_set1_ps(32768.0f);
+	Bit32u i = 0;
+	for (; i + 16 <= len; i += 16) {
+		const __m256i low = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_loadu_ps(inBuffer + i), scale));
+		const __m256i high = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_loadu_ps(inBuffer + i + 8), scale));
+		// The packing works within the 128-bit lanes, so the 64-bit halves need to be put back in order.
+		const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), 0xD8);
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(outBuffer + i), packed);
+	}
+	_mm256_zeroupper();
+	convertFloatToIntSSE2(inBuffer + i, outBuffer + i, len - i);
+}
+
+MT32EMU_TARGET_AVX2 static void convertIntToFloatAVX2(const Bit16s *inBuffer, float *outBuffer, const Bit32u len) {
+	const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+	Bit32u i = 0;
+	for (; i + 8 <= len; i += 8) {
+		const __m256i samples = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(inBuffer + i)));
+		_mm256_storeu_ps(outBuffer + i, _mm256_mul_ps(_mm256_cvtepi32_ps(samples), scale));
+	}
+	_mm256_zeroupper();
+	convertIntToFloatPortable(inBuffer + i, outBuffer + i, len - i);
+}
+
+MT32EMU_TARGET_AVX2 static void panAndMixFloatAVX2(const float *samples, float *leftBuf, float *rightBuf, const float leftPan, const float rightPan, const Bit32u len) {
+	const __m256 leftPans = _mm256_set1_ps(leftPan);
+	const __m256 rightPans = _mm256_set1_ps(rightPan);
+	const __m256 divisor = _mm256_set1_ps(14.0f);
+	Bit32u i = 0;
+	for (; i + 8 <= len; i += 8) {
+		const __m256 sample = _mm256_loadu_ps(samples + i);
+		_mm256_storeu_ps(leftBuf + i, _mm256_add_ps(_mm256_loadu_ps(leftBuf + i), _mm256_div_ps(_mm256_mul_ps(sample, leftPans), divisor)));
+		_mm256_storeu_ps(rightBuf + i, _mm256_add_ps(_mm256_loadu_ps(rightBuf + i), _mm256_div_ps(_mm256_mul_ps(sample, rightPans), divisor)));
+	}
+	_mm256_zeroupper();
+	panAndMixFloatSSE2(samples + i, leftBuf + i, rightBuf + i, leftPan, rightPan, len - i);
+}
+
+MT32EMU_TARGET_AVX2 static void doubleAndWrapFloatAVX2(float *buffer, const Bit32u len) {
+	const __m256 two = _mm256_set1_ps(2.0f);
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 minusOne = _mm256_set1_ps(-1.0f);
+	Bit32u i = 0;
+	for (; i + 8 <= len; i += 8) {
+		const __m256 sample = _mm256_mul_ps(_mm256_loadu_ps(buffer + i), two);
+		__m256 result = _mm256_blendv_ps(sample, _mm256_add_ps(sample, two), _mm256_cmp_ps(sample, minusOne, _CMP_LT_OQ));
+		result = _mm256_blendv_ps(result, _mm256_sub_ps(sample, two), _mm256_cmp_ps(one, sample, _CMP_LT_OQ));
+		_mm256_storeu_ps(buffer + i, result);
+	}
+	_mm256_zeroupper();
+	doubleAndWrapFloatSSE2(buffer + i, len - i);
+}
+
+MT32EMU_TARGET_AVX2 static inline __m256i ditherAndConvertAVX2(const __m256 samples, __m256i positions) {
+	positions = _mm256_xor_si256(positions, _mm256_srli_epi32(positions, 16));
+	positions = _mm256_mullo_epi32(positions, _mm256_set1_epi32(0x7FEB352D));
+	positions = _mm256_xor_si256(positions, _mm256_srli_epi32(positions, 15));
+	positions = _mm256_mullo_epi32(positions, _mm256_set1_epi32(int(0x846CA68BU)));
+	const __m256i hash = _mm256_xor_si256(positions, _mm256_srli_epi32(positions, 16));
+	const __m256i ditherSum = _mm256_add_epi32(_mm256_srli_epi32(hash, 16), _mm256_and_si256(hash, _mm256_set1_epi32(0xFFFF)));
+	const __m256 dither = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(ditherSum, _mm256_set1_epi32(65535))), _mm256_set1_ps(1.0f / 65536.0f));
+	__m256 sample = _mm256_add_ps(_mm256_mul_ps(samples, _mm256_set1_ps(32768.0f)), dither);
+	sample = _mm256_min_ps(_mm256_max_ps(sample, _mm256_set1_ps(-32768.0f)), _mm256_set1_ps(32767.0f));
+	return _mm256_sub_epi32(_mm256_cvttps_epi32(_mm256_add_ps(sample, _mm256_set1_ps(32768.5f))), _mm256_set1_epi32(32768));
+}
+
+MT32EMU_TARGET_AVX2 static void convertFloatToIntDitheredAVX2(const float *inBuffer, Bit16s *outBuffer, const Bit32u len, const Bit32u ditherPosition) {
+	__m256i positions = _mm256_add_epi32(_mm256_set1_epi32(int(ditherPosition)), _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+	Bit32u i = 0;
+	for (; i + 16 <= len; i += 16) {
+		const __m256i low = ditherAndConvertAVX2(_mm256_loadu_ps(inBuffer + i), positions);
+		const __m256i high = ditherAndConvertAVX2(_mm256_loadu_ps(inBuffer + i + 8), _mm256_add_epi32(positions, _mm256_set1_epi32(8)));
+		const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), 0xD8);
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(outBuffer + i), packed);
+		positions = _mm256_add_epi32(positions, _mm256_set1_epi32(16));
+	}
+	_mm256_zeroupper();
+	convertFloatToIntDitheredSSE2(inBuffer + i, outBuffer + i, len - i, ditherPosition + i);
+}
+
+// The positions never exceed the length of a PCM wave, so they fit in the signed indices the gathers take.
+MT32EMU_TARGET_AVX2 static void generatePCMFloatAVX2(const float *wave, const Bit32u *positions, const float *fractions, const float *amps, float *outputs, const Bit32u len) {
+	Bit32u i = 0;
+	if (fractions == NULL) {
+		for (; i + 8 <= len; i += 8) {
+			const __m256i indices = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(positions + i));
+			const __m256 samples = _mm256_i32gather_ps(wave, indices, 4);
+			_mm256_storeu_ps(outputs + i, _mm256_mul_ps(samples, _mm256_loadu_ps(amps + i)));
+		}
+		_mm256_zeroupper();
+		generatePCMFloatSSE2(wave, positions + i, NULL, amps + i, outputs + i, len - i);
+		return;
+	}
+	for (; i + 8 <= len; i += 8) {
+		const __m256i indices = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(positions + i));
+		const __m256 firstSamples = _mm256_i32gather_ps(wave, indices, 4);
+		const __m256 nextSamples = _mm256_i32gather_ps(wave + 1, indices, 4);
+		const __m256 deltas = _mm256_mul_ps(_mm256_sub_ps(nextSamples, firstSamples), _mm256_loadu_ps(fractions + i));
+		_mm256_storeu_ps(outputs + i, _mm256_mul_ps(_mm256_add_ps(firstSamples, deltas), _mm256_loadu_ps(amps + i)));
+	}
+	_mm256_zeroupper();
+	generatePCMFloatSSE2(wave, positions + i, fractions + i, amps + i, outputs + i, len - i);
+}
+
+#endif // #ifdef MT32EMU_KERNELS_AVX2
+
+#ifdef MT32EMU_KERNELS_SHA
+
+// Performs four rounds. The fifth word of the state for the rounds is derived from the state four rounds back.
+template <int roundGroup>
+MT32EMU_TARGET_SHA static inline void processSHA1StepSHA(__m128i &abcd, __m128i &previousABCD, const __m128i words) {
+	const __m128i e = _mm_sha1nexte_epu32(previousABCD, words);
+	previousABCD = abcd;
+	abcd = _mm_sha1rnds4_epu32(abcd, e, roundGroup);
+}
+
+// The message words for the steps past the first four are expanded in place from the words of the four preceding steps.
+template <int roundGroup>
+MT32EMU_TARGET_SHA static inline void expandAndProcessSHA1StepSHA(__m128i &abcd, __m128i &previousABCD, __m128i &words0, const __m128i words1, const __m128i words2, const __m128i words3) {
+	words0 = _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(words0, words1), words2), words3);
+	processSHA1StepSHA<roundGroup>(abcd, previousABCD, words0);
+}
+
+MT32EMU_TARGET_SHA static void processSHA1BlocksSHA(unsigned int *result, const unsigned char *blocks, int blockCount) {
+	const __m128i byteOrderMask = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+	__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(result)), 0x1B);
+	__m128i e = _mm_set_epi32(int(result[4]), 0, 0, 0);
+	for (; blockCount > 0; blockCount--) {
+		const __m128i savedABCD = abcd;
+		__m128i w0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks)), byteOrderMask);
+		__m128i w1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + 16)), byteOrderMask);
+		__m128i w2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + 32)), byteOrderMask);
+		__m128i w3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + 48)), byteOrderMask);
+		__m128i previousABCD = abcd;
+		abcd = _mm_sha1rnds4_epu32(abcd, _mm_add_epi32(e, w0), 0);
+		processSHA1StepSHA<0>(abcd, previousABCD, w1);
+		processSHA1StepSHA<0>(abcd, previousABCD, w2);
+		processSHA1StepSHA<0>(abcd, previousABCD, w3);
+		expandAndProcessSHA1StepSHA<0>(abcd, previousABCD, w0, w1, w2, w3);
+		expandAndProcessSHA1StepSHA<1>(abcd, previousABCD, w1, w2, w3, w0);
+		expandAndProcessSHA1StepSHA<1>(abcd, previousABCD, w2, w3, w0, w1);
+		expandAndProcessSHA1StepSHA<1>(abcd, previousABCD, w3, w0, w1, w2);
+		expandAndProcessSHA1StepSHA<1>(abcd, previousABCD, w0, w1, w2, w3);
+		expandAndProcessSHA1StepSHA<1>(abcd, previousABCD, w1, w2, w3, w0);
+		expandAndProcessSHA1StepSHA<2>(abcd, previousABCD, w2, w3, w0, w1);
+		expandAndProcessSHA1StepSHA<2>(abcd, previousABCD, w3, w0, w1, w2);
+		expandAndProcessSHA1StepSHA<2>(abcd, previousABCD, w0, w1, w2, w3);
+		expandAndProcessSHA1StepSHA<2>(abcd, previousABCD, w1, w2, w3, w0);
+		expandAndProcessSHA1StepSHA<2>(abcd, previousABCD, w2, w3, w0, w1);
+		expandAndProcessSHA1StepSHA<3>(abcd, previousABCD, w3, w0, w1, w2);
+		expandAndProcessSHA1StepSHA<3>(abcd, previousABCD, w0, w1, w2, w3);
+		expandAndProcessSHA1StepSHA<3>(abcd, previousABCD, w1, w2, w3, w0);
+		expandAndProcessSHA1StepSHA<3>(abcd, previousABCD, w2, w3, w0, w1);
+		expandAndProcessSHA1StepSHA<3>(abcd, previousABCD, w3, w0, w1, w2);
+		e = _mm_sha1nexte_epu32(previousABCD, e);
+		abcd = _mm_add_epi32(abcd, savedABCD);
+		blocks += 64;
+	}
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(result), _mm_shuffle_epi32(abcd, 0x1B));
+	result[4] = unsigned(_mm_cvtsi128_si32(_mm_srli_si128(e, 12)));
+}
+
+#endif // #ifdef MT32EMU_KERNELS_SHA
+
+static void getCPUID(Bit32u leaf, Bit32u regs[4]) {
+#if defined(_MSC_VER)
+	int cpuInfo[4];
+	__cpuidex(cpuInfo, int(leaf), 0);
+	for (int i = 0; i < 4; i++) regs[i] = Bit32u(cpuInfo[i]);
+#else
+	unsigned int eax, ebx, ecx, edx;
+	__cpuid_count(leaf, 0, eax, ebx, ecx, edx);
+	regs[0] = eax;
+	regs[1] = ebx;
+	regs[2] = ecx;
+	regs[3] = edx;
+#endif
+}
+
+// Returns the low half of XCR0, which tells what register state the OS preserves across context switches.
+static Bit32u getXCR0() {
+#if defined(_MSC_VER)
+	return Bit32u(_xgetbv(0));
+#else
+	unsigned int eax, edx;
+	__asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+	return eax;
+#endif
+}
+
+static Bit32u detectCPUFeatures() {
+	Bit32u regs[4];
+	getCPUID(0, regs);
+	const Bit32u maxLeaf = regs[0];
+	if (maxLeaf < 1) return 0;
+
+	Bit32u features = 0;
+	getCPUID(1, regs);
+	if (regs[3] & (1 << 26)) features |= CPUFeature_SSE2;
+	if (regs[2] & (1 << 19)) features |= CPUFeature_SSE4_1;
+
+	if (maxLeaf < 7) return features;
+	// The wider registers are only usable when the OS saves them, as indicated by OSXSAVE and XCR0.
+	const bool osxsave = (regs[2] & (1 << 27)) != 0;
+	getCPUID(7, regs);
+	if (regs[1] & (1 << 29)) features |= CPUFeature_SHA;
+	if (!osxsave) return features;
+	const Bit32u xcr0 = getXCR0();
+	if ((xcr0 & 0x06) == 0x06 && (regs[1] & (1 << 5))) features |= CPUFeature_AVX2;
+	if ((xcr0 & 0xE6) == 0xE6 && (regs[1] & (1 << 16))) features |= CPUFeature_AVX512F;
+	return features;
+}
+
+// Flush-to-zero and denormals-are-zero bits of MXCSR
+static const Bit32u MXCSR_FLUSH_TO_ZERO = 0x8000;
+static const Bit32u MXCSR_DENORMALS_ARE_ZERO = 0x0040;
+
+static Bit32u detectDenormalsFlushMode() {
+#if defined(__x86_64__) || defined(_M_X64)
+	return MXCSR_FLUSH_TO_ZERO | MXCSR_DENORMALS_ARE_ZERO;
+#else
+	Bit32u regs[4];
+	getCPUID(0, regs);
+	if (regs[0] < 1) return 0;
+	getCPUID(1, regs);
+	// MXCSR comes along with SSE. A few early SSE CPUs lack DAZ, while all the CPUs with SSE3 support it.
+	if ((regs[3] & (1 << 25)) == 0) return 0;
+	return (regs[2] & 1) != 0 ? MXCSR_FLUSH_TO_ZERO | MXCSR_DENORMALS_ARE_ZERO : MXCSR_FLUSH_TO_ZERO;
+#endif
+}
+
+// The bits to set in MXCSR are determined once when the library is loaded.
+static const Bit32u DENORMALS_FLUSH_MODE = detectDenormalsFlushMode();
+
+MT32EMU_TARGET_SSE2 static size_t getFloatingPointMode() {
+	return _mm_getcsr();
+}
+
+MT32EMU_TARGET_SSE2 static void setFloatingPointMode(size_t mode) {
+	_mm_setcsr(Bit32u(mode));
+}
+
+#elif defined(MT32EMU_KERNELS_NEON)
+
+static void convertFloatToIntNEON(const float *inBuffer, Bit16s *outBuffer, const Bit32u len) {
+	const float32x4_t scale = vdupq_n_f32(32768.0f);
+	Bit32u i = 0;
+	for (; i + 8 <= len; i += 8) {
+		const int32x4_t low = vcvtq_s32_f32(vmulq_f32(vld1q_f32(inBuffer + i), scale));
+		const int32x4_t high = vcvtq_s32_f32(vmulq_f32(vld1q_f32(inBuffer + i + 4), scale));
+		vst1q_s16(outBuffer + i, vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)));
+	}
+	convertFloatToIntPortable(inBuffer + i, outBuffer + i, len - i);
+}
+
+static void convertIntToFloatNEON(const Bit16s *inBuffer, float *outBuffer, const Bit32u len) {
+	const float32x4_t scale = vdupq_n_f32(1.0f / 32768.0f);
+	Bit32u i = 0;
+	for (; i + 8 <= len; i += 8) {
+		const int16x8_t samples = vld1q_s16(inBuffer + i);
+		vst1q_f32(outBuffer + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))), scale));
+		vst1q_f32(outBuffer + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples))), scale));
+	}
+	convertIntToFloatPortable(inBuffer + i, outBuffer + i, len - i);
+}
+
+static void panAndMixFloatNEON(const float *samples, float *leftBuf, float *rightBuf, const float leftPan, const float rightPan, const Bit32u len) {
+	const float32x4_t divisor = vdupq_n_f32(14.0f);
+	Bit32u i = 0;
+	for (; i + 4 <= len; i += 4) {
+		const float32x4_t sample = vld1q_f32(samples + i);
+		vst1q_f32(leftBuf + i, vaddq_f32(vld1q_f32(leftBuf + i), vdivq_f32(vmulq_n_f32(sample, leftPan), divisor)));
+		vst1q_f32(rightBuf + i, vaddq_f32(vld1q_f32(rightBuf + i), vdivq_f32(vmulq_n_f32(sample, rightPan), divisor)));
+	}
+	panAndMixFloatPortable(samples + i, leftBuf + i, rightBuf + i, leftPan, rightPan, len - i);
+}
+
+static void doubleAndWrapFloatNEON(float *buffer, const Bit32u len) {
+	const float32x4_t two = vdupq_n_f32(2.0f);
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	const float32x4_t minusOne = vdupq_n_f32(-1.0f);
+	Bit32u i = 0;
+	for (; i + 4 <= len; i += 4) {
+		const float32x4_t sample = vmulq_f32(vld1q_f32(buffer + i), two);
+		float32x4_t result = vbslq_f32(vcltq_f32(sample, minusOne), vaddq_f32(sample, two), sample);
+		result = vbslq_f32(vcltq_f32(one, sample), vsubq_f32(sample, two), result);
+		vst1q_f32(buffer + i, result);
+	}
+	doubleAndWrapFloatPortable(buffer + i, len - i);
+}
+
+// The clamping selects the limits by the comparisons, since the NEON min / max instructions propagate NaNs.
+static inline int32x4_t ditherAndConvertNEON(const float32x4_t samples, uint32x4_t positions) {
+	positions = veorq_u32(positions, vshrq_n_u32(positions, 16));
+	positions = vmulq_u32(positions, vdupq_n_u32(0x7FEB352DU));
+	positions = veorq_u32(positions, vshrq_n_u32(positions, 15));
+	positions = vmulq_u32(positions, vdupq_n_u32(0x846CA68BU));
+	const uint32x4_t hash = veorq_u32(positions, vshrq_n_u32(positions, 16));
+	const int32x4_t ditherSum = vreinterpretq_s32_u32(vaddq_u32(vshrq_n_u32(hash, 16), vandq_u32(hash, vdupq_n_u32(0xFFFF))));
+	const float32x4_t dither = vmulq_f32(vcvtq_f32_s32(vsubq_s32(ditherSum, vdupq_n_s32(65535))), vdupq_n_f32(1.0f / 65536.0f));
+	float32x4_t sample = vaddq_f32(vmulq_f32(samples, vdupq_n_f32(32768.0f)), dither);
+	const float32x4_t lowerLimit = vdupq_n_f32(-32768.0f);
+	const float32x4_t upperLimit = vdupq_n_f32(32767.0f);
+	sample = vbslq_f32(vcgtq_f32(sample, lowerLimit), sample, lowerLimit);
+	sample = vbslq_f32(vcltq_f32(sample, upperLimit), sample, upperLimit);
+	return vsubq_s32(vcvtq_s32_f32(vaddq_f32(sample, vdupq_n_f32(32768.5f))), vdupq_n_s32(32768));
+}
+
+static void convertFloatToIntDitheredNEON(const float *inBuffer, Bit16s *outBuffer, const Bit32u len, const Bit32u ditherPosition) {
+	static const Bit32u LANE_OFFSETS[] = {0, 1, 2, 3};
+	uint32x4_t positions = vaddq_u32(vdupq_n_u32(ditherPosition), vld1q_u32(LANE_OFFSETS));
+	Bit32u i = 0;
+	for (; i + 8 <= len; i += 8) {
+		const int32x4_t low = ditherAndConvertNEON(vld1q_f32(inBuffer + i), positions);
+		const int32x4_t high = ditherAndConvertNEON(vld1q_f32(inBuffer + i + 4), vaddq_u32(positions, vdupq_n_u32(4)));
+		vst1q_s16(outBuffer + i, vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)));
+		positions = vaddq_u32(positions, vdupq_n_u32(8));
+	}
+	convertFloatToIntDitheredPortable(inBuffer + i, outBuffer + i, len - i, ditherPosition + i);
+}
+
+// The multiplications and the additions are kept apart rather than fused, so that the results match the portable ones.
+static void generatePCMFloatNEON(const float *wave, const Bit32u *positions, const float *fractions, const float *amps, float *outputs, const Bit32u len) {
+	Bit32u i = 0;
+	if (fractions == NULL) {
+		for (; i + 4 <= len; i += 4) {
+			float32x4_t samples = vdupq_n_f32(wave[positions[i]]);
+			samples = vsetq_lane_f32(wave[positions[i + 1]], samples, 1);
+			samples = vsetq_lane_f32(wave[positions[i + 2]], samples, 2);
+			samples = vsetq_lane_f32(wave[positions[i + 3]], samples, 3);
+			vst1q_f32(outputs + i, vmulq_f32(samples, vld1q_f32(amps + i)));
+		}
+		generatePCMFloatPortable(wave, positions + i, NULL, amps + i, outputs + i, len - i);
+		return;
+	}
+	for (; i + 4 <= len; i += 4) {
+		float32x4_t firstSamples = vdupq_n_f32(wave[positions[i]]);
+		firstSamples = vsetq_lane_f32(wave[positions[i + 1]], firstSamples, 1);
+		firstSamples = vsetq_lane_f32(wave[positions[i + 2]], firstSamples, 2);
+		firstSamples = vsetq_lane_f32(wave[positions[i + 3]], firstSamples, 3);
+		float32x4_t nextSamples = vdupq_n_f32(wave[positions[i] + 1]);
+		nextSamples = vsetq_lane_f32(wave[positions[i + 1] + 1], nextSamples, 1);
+		nextSamples = vsetq_lane_f32(wave[positions[i + 2] + 1], nextSamples, 2);
+		nextSamples = vsetq_lane_f32(wave[positions[i + 3] + 1], nextSamples, 3);
+		const float32x4_t deltas = vmulq_f32(vsubq_f32(nextSamples, firstSamples), vld1q_f32(fractions + i));
+		vst1q_f32(outputs + i, vmulq_f32(vaddq_f32(firstSamples, deltas), vld1q_f32(amps + i)));
+	}
+	generatePCMFloatPortable(wave, positions + i, fractions + i, amps + i, outputs + i, len - i);
+}
+
+#ifdef MT32EMU_KERNELS_SHA1_ARMV8
+
+// Performs four rounds, same as processSHA1StepSHA(), though the instructions take the round constants added
+// to the message words, and the fifth word of the state is kept in a scalar.
+template <int roundGroup>
+static inline void processSHA1StepSHA1ARMv8(uint32x4_t &abcd, Bit32u &e, const uint32x4_t words) {
+	static const Bit32u ROUND_CONSTANT = roundGroup == 0 ? 0x5A827999 : roundGroup == 1 ? 0x6ED9EBA1 : roundGroup == 2 ? 0x8F1BBCDC : 0xCA62C1D6;
+	const uint32x4_t roundWords = vaddq_u32(words, vdupq_n_u32(ROUND_CONSTANT));
+	const Bit32u nextE = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+	if (roundGroup == 0) {
+		abcd = vsha1cq_u32(abcd, e, roundWords);
+	} else if (roundGroup == 2) {
+		abcd = vsha1mq_u32(abcd, e, roundWords);
+	} else {
+		abcd = vsha1pq_u32(abcd, e, roundWords);
+	}
+	e = nextE;
+}
+
+template <int roundGroup>
+static inline void expandAndProcessSHA1StepSHA1ARMv8(uint32x4_t &abcd, Bit32u &e, uint32x4_t &words0, const uint32x4_t words1, const uint32x4_t words2, const uint32x4_t words3) {
+	words0 = vsha1su1q_u32(vsha1su0q_u32(words0, words1, words2), words3);
+	processSHA1StepSHA1ARMv8<roundGroup>(abcd, e, words0);
+}
+
+static void processSHA1BlocksSHA1ARMv8(unsigned int *result, const unsigned char *blocks, int blockCount) {
+	uint32x4_t abcd = vld1q_u32(result);
+	Bit32u e = result[4];
+	for (; blockCount > 0; blockCount--) {
+		const uint32x4_t savedABCD = abcd;
+		const Bit32u savedE = e;
+		uint32x4_t w0 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks)));
+		uint32x4_t w1 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + 16)));
+		uint32x4_t w2 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + 32)));
+		uint32x4_t w3 = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(blocks + 48)));
+		processSHA1StepSHA1ARMv8<0>(abcd, e, w0);
+		processSHA1StepSHA1ARMv8<0>(abcd, e, w1);
+		processSHA1StepSHA1ARMv8<0>(abcd, e, w2);
+		processSHA1StepSHA1ARMv8<0>(abcd, e, w3);
+		expandAndProcessSHA1StepSHA1ARMv8<0>(abcd, e, w0, w1, w2, w3);
+		expandAndProcessSHA1StepSHA1ARMv8<1>(abcd, e, w1, w2, w3, w0);
+		expandAndProcessSHA1StepSHA1ARMv8<1>(abcd, e, w2, w3, w0, w1);
+		expandAndProcessSHA1StepSHA1ARMv8<1>(abcd, e, w3, w0, w1, w2);
+		expandAndProcessSHA1StepSHA1ARMv8<1>(abcd, e, w0, w1, w2, w3);
+		expandAndProcessSHA1StepSHA1ARMv8<1>(abcd, e, w1, w2, w3, w0);
+		expandAndProcessSHA1StepSHA1ARMv8<2>(abcd, e, w2, w3, w0, w1);
+		expandAndProcessSHA1StepSHA1ARMv8<2>(abcd, e, w3, w0, w1, w2);
+		expandAndProcessSHA1StepSHA1ARMv8<2>(abcd, e, w0, w1, w2, w3);
+		expandAndProcessSHA1StepSHA1ARMv8<2>(abcd, e, w1, w2, w3, w0);
+		expandAndProcessSHA1StepSHA1ARMv8<2>(abcd, e, w2, w3, w0, w1);
+		expandAndProcessSHA1StepSHA1ARMv8<3>(abcd, e, w3, w0, w1, w2);
+		expandAndProcessSHA1StepSHA1ARMv8<3>(abcd, e, w0, w1, w2, w3);
+		expandAndProcessSHA1StepSHA1ARMv8<3>(abcd, e, w1, w2, w3, w0);
+		expandAndProcessSHA1StepSHA1ARMv8<3>(abcd, e, w2, w3, w0, w1);
+		expandAndProcessSHA1StepSHA1ARMv8<3>(abcd, e, w3, w0, w1, w2);
+		abcd = vaddq_u32(abcd, savedABCD);
+		e += savedE;
+		blocks += 64;
+	}
+	vst1q_u32(result, abcd);
+	result[4] = e;
+}
+
+static Bit32u detectCPUFeatures() {
+	return CPUFeature_NEON | CPUFeature_SHA1;
+}
+
+#else
+
+static Bit32u detectCPUFeatures() {
+	return CPUFeature_NEON;
+}
+
+#endif // #ifdef MT32EMU_KERNELS_SHA1_ARMV8
+
+#if defined(__GNUC__) || defined(__clang__)
+// The flush-to-zero bit of FPCR, when set, denormal inputs are treated as zero as well.
+static const size_t DENORMALS_FLUSH_MODE = size_t(1) << 24;
+
+static size_t getFloatingPointMode() {
+	size_t fpcr;
+	__asm__ __volatile__ ("mrs %0, fpcr" : "=r" (fpcr));
+	return fpcr;
+}
+
+static void setFloatingPointMode(size_t mode) {
+	__asm__ __volatile__ ("msr fpcr, %0" : : "r" (mode));
+}
+#else
+static const size_t DENORMALS_FLUSH_MODE = 0;
+
+static size_t getFloatingPointMode() {
+	return 0;
+}
+
+static void setFloatingPointMode(size_t) {}
+#endif
+
+#else
+
+static Bit32u detectCPUFeatures() {
+	return 0;
+}
+
+static const size_t DENORMALS_FLUSH_MODE = 0;
+
+static size_t getFloatingPointMode() {
+	return 0;
+}
+
+static void setFloatingPointMode(size_t) {}
+
+#endif
+
+static Bit32u getEnvironmentCPUFeatures() {
+	const char *value = getenv(ENVIRONMENT_VARIABLE);
+	if (value == NULL) return ~Bit32u(0);
+
+	Bit32u features = 0;
+	while (*value != 0) {
+		const char *separator = strchr(value, ',');
+		const size_t nameLength = separator == NULL ? strlen(value) : size_t(separator - value);
+		for (size_t i = 0; i < sizeof(CPU_FEATURE_NAMES) / sizeof(*CPU_FEATURE_NAMES); i++) {
+			const char *name = CPU_FEATURE_NAMES[i].name;
+			if (strlen(name) == nameLength && strncmp(name, value, nameLength) == 0) {
+				features |= CPU_FEATURE_NAMES[i].feature;
+			}
+		}
+		value += separator == NULL ? nameLength : nameLength + 1;
+	}
+	return features;
+}
+
+Bit32u Kernels::getSupportedCPUFeatures() {
+	// The detection is cheap, and it's only done when a synth is opened, so the result isn't cached.
+	return detectCPUFeatures() & getEnvironmentCPUFeatures();
+}
+
+void Kernels::calcSHA1(const Bit8u *data, size_t size, Bit8u *digest) {
+	const Bit32u cpuFeatures = getSupportedCPUFeatures();
+	(void)cpuFeatures;
+#ifdef MT32EMU_KERNELS_SHA
+	if (cpuFeatures & CPUFeature_SHA) {
+		sha1::calc(data, int(size), digest, processSHA1BlocksSHA);
+		return;
+	}
+#endif
+#ifdef MT32EMU_KERNELS_SHA1_ARMV8
+	if (cpuFeatures & CPUFeature_SHA1) {
+		sha1::calc(data, int(size), digest, processSHA1BlocksSHA1ARMv8);
+		return;
+	}
+#endif
+	sha1::calc(data, int(size), digest);
+}
+
+const char *Kernels::getKernelName(Bit32u kernelIx) {
+	return kernelIx < KERNEL_COUNT ? KERNEL_NAMES[kernelIx] : NULL;
+}
+
+Kernels::Kernels() :
+	convertFloatToInt(convertFloatToIntPortable),
+	convertIntToFloat(convertIntToFloatPortable),
+	panAndMixFloat(panAndMixFloatPortable),
+	doubleAndWrapFloat(doubleAndWrapFloatPortable),
+	convertFloatToIntDithered(convertFloatToIntDitheredPortable),
+	generatePCMFloat(generatePCMFloatPortable)
+{
+	for (Bit32u i = 0; i < KERNEL_COUNT; i++) {
+		variantNames[i] = "portable";
+	}
+}
+
+void Kernels::select(Bit32u allowedCPUFeatures) {
+	*this = Kernels();
+	const Bit32u cpuFeatures = allowedCPUFeatures & getSupportedCPUFeatures();
+	(void)cpuFeatures;
+#ifdef MT32EMU_KERNELS_X86
+	if (cpuFeatures & CPUFeature_SSE2) {
+		convertFloatToInt = convertFloatToIntSSE2;
+		convertIntToFloat = convertIntToFloatSSE2;
+		panAndMixFloat = panAndMixFloatSSE2;
+		doubleAndWrapFloat = doubleAndWrapFloatSSE2;
+		convertFloatToIntDithered = convertFloatToIntDitheredSSE2;
+		generatePCMFloat = generatePCMFloatSSE2;
+		for (Bit32u i = 0; i < KERNEL_COUNT; i++) {
+			variantNames[i] = "sse2";
+		}
+	}
+#ifdef MT32EMU_KERNELS_AVX2
+	if (cpuFeatures & CPUFeature_AVX2) {
+		convertFloatToInt = convertFloatToIntAVX2;
+		convertIntToFloat = convertIntToFloatAVX2;
+		panAndMixFloat = panAndMixFloatAVX2;
+		doubleAndWrapFloat = doubleAndWrapFloatAVX2;
+		convertFloatToIntDithered = convertFloatToIntDitheredAVX2;
+		generatePCMFloat = generatePCMFloatAVX2;
+		for (Bit32u i = 0; i < KERNEL_COUNT; i++) {
+			variantNames[i] = "avx2";
+		}
+	}
+#endif
+#endif // #ifdef MT32EMU_KERNELS_X86
+#ifdef MT32EMU_KERNELS_NEON
+	if (cpuFeatures & CPUFeature_NEON) {
+		convertFloatToInt = convertFloatToIntNEON;
+		convertIntToFloat = convertIntToFloatNEON;
+		panAndMixFloat = panAndMixFloatNEON;
+		doubleAndWrapFloat = doubleAndWrapFloatNEON;
+		convertFloatToIntDithered = convertFloatToIntDitheredNEON;
+		generatePCMFloat = generatePCMFloatNEON;
+		for (Bit32u i = 0; i < KERNEL_COUNT; i++) {
+			variantNames[i] = "neon";
+		}
+	}
+#endif
+}
+
+const char *Kernels::getVariantName(Bit32u kernelIx) const {
+	return kernelIx < KERNEL_COUNT ? variantNames[kernelIx] : NULL;
+}
+
+DenormalsFlushScope::DenormalsFlushScope() : savedMode(0), modeChanged(false) {
+	if (DENORMALS_FLUSH_MODE == 0) return;
+	savedMode = getFloatingPointMode();
+	if ((savedMode & DENORMALS_FLUSH_MODE) == DENORMALS_FLUSH_MODE) return;
+	setFloatingPointMode(savedMode | DENORMALS_FLUSH_MODE);
+	modeChanged = true;
+}
+
+DenormalsFlushScope::~DenormalsFlushScope() {
+	if (modeChanged) setFloatingPointMode(savedMode);
+}
+
+} // namespace MT32Emu
@@ -0,0 +1,112 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MT32EMU_KERNELS_H
+#define MT32EMU_KERNELS_H
+
+#include <cstddef>
+
+#include "globals.h"
+#include "Types.h"
+
+namespace MT32Emu {
+
+/**
+ * Table of the implementations of the rendering kernels, which a synth selects when opening according to
+ * the instruction set extensions the CPU supports. This way, a single binary makes use of the extensions
+ * where available. Each kernel has a portable implementation, and all the implementations of a kernel
+ * produce bit-exact results.
+ */
+class Kernels {
+public:
+	enum KernelID {
+		KERNEL_CONVERT_FLOAT_TO_INT,
+		KERNEL_CONVERT_INT_TO_FLOAT,
+		KERNEL_PAN_AND_MIX_FLOAT,
+		KERNEL_DOUBLE_AND_WRAP_FLOAT,
+		KERNEL_CONVERT_FLOAT_TO_INT_DITHERED,
+		KERNEL_GENERATE_PCM_FLOAT,
+		KERNEL_COUNT
+	};
+
+	// Same as Synth::convertSample() applied to each sample.
+	void (*convertFloatToInt)(const float *inBuffer, Bit16s *outBuffer, const Bit32u len);
+	void (*convertIntToFloat)(const Bit16s *inBuffer, float *outBuffer, const Bit32u len);
+	// Adds the samples scaled by each pan value divided by 14 to the left and right buffers,
+	// same as Partial::produceAndMixSample() applied to each sample.
+	void (*panAndMixFloat)(const float *samples, float *leftBuf, float *rightBuf, const float leftPan, const float rightPan, const Bit32u len);
+	// Doubles each sample in place and wraps the result around into [-1, 1] the way the DAC bit shift overflows,
+	// as the DAC input modes GENERATION1 and GENERATION2 emulate in the float renderer.
+	void (*doubleAndWrapFloat)(float *buffer, const Bit32u len);
+	// Converts to integers with TPDF dither of 1 LSB peak amplitude, rounding to nearest and saturating. The dither noise
+	// is a function of the sample position in the sequence, which starts at ditherPosition and advances by one per sample,
+	// so a stream converted in several calls gets the same noise as if converted at once.
+	void (*convertFloatToIntDithered)(const float *inBuffer, Bit16s *outBuffer, const Bit32u len, const Bit32u ditherPosition);
+	// Reads the samples of a linear PCM wave at the positions, interpolates each one towards the next sample by the fraction
+	// unless fractions is NULL, and scales the result by the amp, same as LA32FloatWaveGenerator does for a PCM partial.
+	// The wave must be followed by the guard sample the interpolation needs at the last position.
+	void (*generatePCMFloat)(const float *wave, const Bit32u *positions, const float *fractions, const float *amps, float *outputs, const Bit32u len);
+
+	// Returns the instruction set extensions the CPU supports as a combination of CPUFeature flags, excluding those
+	// disabled with the environment variable MT32EMU_CPU_FEATURES. The variable holds a comma-separated list
+	// of the extensions to use, e.g. "sse2,avx2", or "none" to use the portable implementations only.
+	static Bit32u getSupportedCPUFeatures();
+
+	// Computes the SHA1 digest of the data into 20 bytes, making use of the SHA instructions where the CPU supports them.
+	// Unlike the rendering kernels, the implementation is selected on each call, since a file is only hashed once.
+	static void calcSHA1(const Bit8u *data, size_t size, Bit8u *digest);
+
+	// Returns the name of the kernel, or NULL if the index is out of range.
+	static const char *getKernelName(Bit32u kernelIx);
+
+	// Creates a table of the portable implementations.
+	Kernels();
+
+	// Selects the fastest implementation of each kernel that only uses the specified extensions,
+	// which are further limited to the supported ones.
+	void select(Bit32u allowedCPUFeatures);
+
+	// Returns the name of the selected implementation of the kernel, or NULL if the index is out of range.
+	const char *getVariantName(Bit32u kernelIx) const;
+
+private:
+	const char *variantNames[KERNEL_COUNT];
+}; // class Kernels
+
+/**
+ * Makes the floating-point unit of the calling thread flush denormal results to zero and treat denormal inputs as zero
+ * during the lifetime of the object, the previous modes are restored on destruction. Arithmetic on denormal numbers
+ * may be tens of times slower on some CPUs, and the decaying tails of the float filters tend to produce them.
+ * The modes are set in MXCSR on x86 CPUs with SSE, so the x87 arithmetic is unaffected, and in FPCR on AArch64.
+ * Does nothing on other platforms, where the filters still flush their state explicitly.
+ */
+class DenormalsFlushScope {
+public:
+	DenormalsFlushScope();
+	~DenormalsFlushScope();
+
+private:
+	size_t savedMode;
+	bool modeChanged;
+
+	DenormalsFlushScope(const DenormalsFlushScope &);
+	DenormalsFlushScope &operator=(const DenormalsFlushScope &);
+}; // class DenormalsFlushScope
+
+} // namespace MT32Emu
+
+#endif // #ifndef MT32EMU_KERNELS_H
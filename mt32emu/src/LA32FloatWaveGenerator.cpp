@@ -16,11 +16,15 @@
  */
 
 #include <cstddef>
+#include <cstring>
 
 #include "internals.h"
 
 #include "LA32FloatWaveGenerator.h"
+#include "Kernels.h"
+#include "LA32Wavetables.h"
 #include "mmath.h"
+#include "Structures.h"
 #include "Tables.h"
 
 namespace MT32Emu {
@@ -29,16 +33,110 @@ static const float MIDDLE_CUTOFF_VALUE = 128.0f;
 static const float RESONANCE_DECAY_THRESHOLD_CUTOFF_VALUE = 144.0f;
 static const float MAX_CUTOFF_VALUE = 240.0f;
 
-float LA32FloatWaveGenerator::getPCMSample(unsigned int position) {
-	if (position >= pcmWaveLength) {
-		if (!pcmWaveLooped) {
-			return 0;
+// Number of PCM samples the positions are collected for before the kernel produces them.
+static const Bit32u PCM_KERNEL_BLOCK_LENGTH = 128;
+
+static const Kernels PORTABLE_KERNELS;
+
+// Same as fmod() for a non-negative position. Since a position advances by less than the wave length most of the time,
+// it is wrapped by a subtraction, the result of which is exact, as is the remainder, provided the position is less
+// than twice the length.
+static inline float wrapPCMPosition(const float position, const float length) {
+	if (position < length) return position;
+	if (position < 2.0f * length) return position - length;
+	return fmod(position, length);
+}
+
+LA32FloatWaveGenerator::LA32FloatWaveGenerator() : active(false), pcmWaveAddress(NULL), wavetables(NULL), kernels(&PORTABLE_KERNELS) {}
+
+void LA32FloatWaveGenerator::setWavetables(const LA32Wavetables *useWavetables) {
+	wavetables = useWavetables;
+}
+
+void LA32FloatWaveGenerator::setKernels(const Kernels *useKernels) {
+	kernels = useKernels;
+}
+
+float LA32FloatWaveGenerator::getLinearPCMSample(const Bit16s logSample) {
+	float sampleValue = EXP2F(((logSample & 32767) - 32787.0f) / 2048.0f);
+	return ((logSample & 32768) == 0) ? sampleValue : -sampleValue;
+}
+
+void LA32FloatWaveGenerator::resetControlCache() {
+	// These values can never come from TVA, TVP and TVF respectively, so the first sample always updates the cache
+	lastAmpVal = 0xFFFFFFFF;
+	lastPitch = 0xFFFF;
+	lastCutoffRampVal = 0xFFFFFFFF;
+}
+
+void LA32FloatWaveGenerator::updateAmpAndPitch(const Bit32u ampVal, const Bit16u pitch) {
+	if (ampVal != lastAmpVal) {
+		lastAmpVal = ampVal;
+		amp = EXP2F(ampVal / -1024.0f / 4096.0f);
+	}
+	updatePitch(pitch);
+}
+
+void LA32FloatWaveGenerator::updatePitch(const Bit16u pitch) {
+	if (pitch != lastPitch) {
+		lastPitch = pitch;
+		freq = EXP2F(pitch / 4096.0f - 16.0f) * SAMPLE_RATE;
+		// Wave length in samples
+		waveLen = SAMPLE_RATE / freq;
+		if (wavetables != NULL) {
+			invWaveLen = 1.0f / waveLen;
+			mipmapLevel = LA32Wavetables::getMipmapLevel(waveLen);
+			tableLength = LA32Wavetables::getTableLength(mipmapLevel);
 		}
-		position = position % pcmWaveLength;
 	}
-	Bit16s pcmSample = pcmWaveAddress[position];
-	float sampleValue = EXP2F(((pcmSample & 32767) - 32787.0f) / 2048.0f);
-	return ((pcmSample & 32768) == 0) ? sampleValue : -sampleValue;
+}
+
+void LA32FloatWaveGenerator::updateCutoff(const Bit32u cutoffRampVal) {
+	if (cutoffRampVal == lastCutoffRampVal) {
+		return;
+	}
+	lastCutoffRampVal = cutoffRampVal;
+
+	// The cutoffModifier may not be supposed to be directly added to the cutoff -
+	// it may for example need to be multiplied in some way.
+	// The 240 cutoffVal limit was determined via sample analysis (internal Munt capture IDs: glop3, glop4).
+	// More research is needed to be sure that this is correct, however.
+	cutoffVal = cutoffRampVal / 262144.0f;
+	if (cutoffVal > MAX_CUTOFF_VALUE) {
+		cutoffVal = MAX_CUTOFF_VALUE;
+	}
+
+	if (cutoffVal > MIDDLE_CUTOFF_VALUE) {
+		cosineLenFactor = EXP2F((cutoffVal - MIDDLE_CUTOFF_VALUE) / -16.0f); // found from sample analysis
+	}
+
+	// Correct resAmp for cutoff in range 50..66
+	resAmp = baseResAmp;
+	if ((cutoffVal >= MIDDLE_CUTOFF_VALUE) && (cutoffVal < RESONANCE_DECAY_THRESHOLD_CUTOFF_VALUE)) {
+		resAmp *= sin(FLOAT_PI * (cutoffVal - MIDDLE_CUTOFF_VALUE) / 32.0f);
+	}
+
+	if (cutoffVal < MIDDLE_CUTOFF_VALUE) {
+		// Attenuate samples below cutoff 50
+		// Found by sample analysis
+		cutoffAttenuation = EXP2F(-0.125f * (MIDDLE_CUTOFF_VALUE - cutoffVal));
+	}
+
+	if (wavetables != NULL) {
+		relCosineLen = 0.5f;
+		float cutoffLevelPos = 0.0f;
+		if (cutoffVal > MIDDLE_CUTOFF_VALUE) {
+			relCosineLen *= cosineLenFactor;
+			cutoffLevelPos = (cutoffVal - MIDDLE_CUTOFF_VALUE) / float(LA32Wavetables::CUTOFF_LEVEL_STEP);
+		}
+		cutoffLevel = Bit32u(cutoffLevelPos);
+		if (cutoffLevel > LA32Wavetables::CUTOFF_LEVEL_COUNT - 2) {
+			cutoffLevel = LA32Wavetables::CUTOFF_LEVEL_COUNT - 2;
+		}
+		cutoffLevelFraction = cutoffLevelPos - float(cutoffLevel);
+		invRelCosineLen = 1.0f / relCosineLen;
+		fallingEdgePos = pulseLenFactor > relCosineLen ? pulseLenFactor : relCosineLen;
+	}
 }
 
 void LA32FloatWaveGenerator::initSynth(const bool useSawtoothWaveform, const Bit8u usePulseWidth, const Bit8u useResonance) {
@@ -49,224 +147,385 @@ void LA32FloatWaveGenerator::initSynth(const bool useSawtoothWaveform, const Bit
 	wavePos = 0.0f;
 	lastFreq = 0.0f;
 
+	baseResAmp = EXP2F(1.0f - (32 - resonance) / 4.0f);
+	{
+		//static const float resAmpFactor = EXP2F(-7);
+		//baseResAmp = EXP2I(resonance << 10) * resAmpFactor;
+	}
+
+	// Ratio of positive segment to wave length
+	pulseLenFactor = 0.5f;
+	if (pulseWidth > 128) {
+		pulseLenFactor = EXP2F((64 - pulseWidth) / 64.0f);
+		//static const float pulseLenFactor = EXP2F(-192 / 64);
+		//pulseLen = EXP2I((256 - pulseWidthVal) << 6) * pulseLenFactor;
+	}
+
+	// Resonance decay speed factor
+	resAmpDecayFactor = Tables::getInstance().resAmpDecayFactor[resonance >> 2];
+	resonanceDecayLevel = resonance >> 2;
+
+	resetControlCache();
 	pcmWaveAddress = NULL;
 	active = true;
 }
 
-void LA32FloatWaveGenerator::initPCM(const Bit16s * const usePCMWaveAddress, const Bit32u usePCMWaveLength, const bool usePCMWaveLooped, const bool usePCMWaveInterpolated) {
+void LA32FloatWaveGenerator::initPCM(const float * const usePCMWaveAddress, const Bit32u usePCMWaveLength, const bool usePCMWaveLooped, const bool usePCMWaveInterpolated) {
 	pcmWaveAddress = usePCMWaveAddress;
 	pcmWaveLength = usePCMWaveLength;
 	pcmWaveLooped = usePCMWaveLooped;
 	pcmWaveInterpolated = usePCMWaveInterpolated;
 
 	pcmPosition = 0.0f;
+	resetControlCache();
 	active = true;
 }
 
-// ampVal - Logarithmic amp of the wave generator
-// pitch - Logarithmic frequency of the resulting wave
-// cutoffRampVal - Composed of the base cutoff in range [78..178] left-shifted by 18 bits and the TVF modifier
-float LA32FloatWaveGenerator::generateNextSample(const Bit32u ampVal, const Bit16u pitch, const Bit32u cutoffRampVal) {
-	if (!active) {
-		return 0.0f;
+template <bool sawtooth>
+float LA32FloatWaveGenerator::generateNextSynthSample(const Bit32u ampVal, const Bit16u pitch, const Bit32u cutoffRampVal) {
+	// The control values tend to stay unchanged for many samples, so the derived values are only recomputed on change.
+	updateAmpAndPitch(ampVal, pitch);
+
+	// Render synthesised waveform
+	wavePos *= lastFreq / freq;
+	lastFreq = freq;
+
+	updateCutoff(cutoffRampVal);
+
+	// Init cosineLen
+	float cosineLen = 0.5f * waveLen;
+	if (cutoffVal > MIDDLE_CUTOFF_VALUE) {
+		cosineLen *= cosineLenFactor;
 	}
 
-	float sample = 0.0f;
+	// Start playing in center of first cosine segment
+	// relWavePos is shifted by a half of cosineLen
+	float relWavePos = wavePos + 0.5f * cosineLen;
+	if (relWavePos > waveLen) {
+		relWavePos -= waveLen;
+	}
 
-	// SEMI-CONFIRMED: From sample analysis:
-	// (1) Tested with a single partial playing PCM wave 77 with pitchCoarse 36 and no keyfollow, velocity follow, etc.
-	// This gives results within +/- 2 at the output (before any DAC bitshifting)
-	// when sustaining at levels 156 - 255 with no modifiers.
-	// (2) Tested with a special square wave partial (internal capture ID tva5) at TVA envelope levels 155-255.
-	// This gives deltas between -1 and 0 compared to the real output. Note that this special partial only produces
-	// positive amps, so negative still needs to be explored, as well as lower levels.
-	//
-	// Also still partially unconfirmed is the behaviour when ramping between levels, as well as the timing.
+	float pulseLen = pulseLenFactor * waveLen;
 
-	float amp = EXP2F(ampVal / -1024.0f / 4096.0f);
-	float freq = EXP2F(pitch / 4096.0f - 16.0f) * SAMPLE_RATE;
+	float hLen = pulseLen - cosineLen;
 
-	if (isPCMWave()) {
-		// Render PCM waveform
-		int len = pcmWaveLength;
-		int intPCMPosition = int(pcmPosition);
-		if (intPCMPosition >= len && !pcmWaveLooped) {
-			// We're now past the end of a non-looping PCM waveform so it's time to die.
-			deactivate();
-			return 0.0f;
-		}
-		float positionDelta = freq * 2048.0f / SAMPLE_RATE;
+	// Ignore pulsewidths too high for given freq
+	if (hLen < 0.0f) {
+		hLen = 0.0f;
+	}
 
-		// Linear interpolation
-		float firstSample = getPCMSample(intPCMPosition);
-		// We observe that for partial structures with ring modulation the interpolation is not applied to the slave PCM partial.
-		// It's assumed that the multiplication circuitry intended to perform the interpolation on the slave PCM partial
-		// is borrowed by the ring modulation circuit (or the LA32 chip has a similar lack of resources assigned to each partial pair).
-		if (pcmWaveInterpolated) {
-			sample = firstSample + (getPCMSample(intPCMPosition + 1) - firstSample) * (pcmPosition - intPCMPosition);
-		} else {
-			sample = firstSample;
-		}
+	// Produce filtered square wave with 2 cosine waves on slopes
+	float sample;
 
-		float newPCMPosition = pcmPosition + positionDelta;
-		if (pcmWaveLooped) {
-			newPCMPosition = fmod(newPCMPosition, float(pcmWaveLength));
-		}
-		pcmPosition = newPCMPosition;
+	// 1st cosine segment
+	if (relWavePos < cosineLen) {
+		sample = -cos(FLOAT_PI * relWavePos / cosineLen);
+	} else
+
+	// high linear segment
+	if (relWavePos < (cosineLen + hLen)) {
+		sample = 1.f;
+	} else
+
+	// 2nd cosine segment
+	if (relWavePos < (2 * cosineLen + hLen)) {
+		sample = cos(FLOAT_PI * (relWavePos - (cosineLen + hLen)) / cosineLen);
 	} else {
-		// Render synthesised waveform
-		wavePos *= lastFreq / freq;
-		lastFreq = freq;
 
-		float resAmp = EXP2F(1.0f - (32 - resonance) / 4.0f);
-		{
-			//static const float resAmpFactor = EXP2F(-7);
-			//resAmp = EXP2I(resonance << 10) * resAmpFactor;
-		}
+	// low linear segment
+		sample = -1.f;
+	}
 
-		// The cutoffModifier may not be supposed to be directly added to the cutoff -
-		// it may for example need to be multiplied in some way.
-		// The 240 cutoffVal limit was determined via sample analysis (internal Munt capture IDs: glop3, glop4).
-		// More research is needed to be sure that this is correct, however.
-		float cutoffVal = cutoffRampVal / 262144.0f;
-		if (cutoffVal > MAX_CUTOFF_VALUE) {
-			cutoffVal = MAX_CUTOFF_VALUE;
-		}
+	if (cutoffVal < MIDDLE_CUTOFF_VALUE) {
 
-		// Wave length in samples
-		float waveLen = SAMPLE_RATE / freq;
+		// Attenuate samples below cutoff 50
+		// Found by sample analysis
+		sample *= cutoffAttenuation;
+	} else {
 
-		// Init cosineLen
-		float cosineLen = 0.5f * waveLen;
-		if (cutoffVal > MIDDLE_CUTOFF_VALUE) {
-			cosineLen *= EXP2F((cutoffVal - MIDDLE_CUTOFF_VALUE) / -16.0f); // found from sample analysis
-		}
+		// Add resonance sine. Effective for cutoff > 50 only
+		float resSample = 1.0f;
 
-		// Start playing in center of first cosine segment
-		// relWavePos is shifted by a half of cosineLen
-		float relWavePos = wavePos + 0.5f * cosineLen;
-		if (relWavePos > waveLen) {
-			relWavePos -= waveLen;
-		}
+		// Resonance decay speed factor
+		float resAmpDecay = resAmpDecayFactor;
 
-		// Ratio of positive segment to wave length
-		float pulseLen = 0.5f;
-		if (pulseWidth > 128) {
-			pulseLen = EXP2F((64 - pulseWidth) / 64.0f);
-			//static const float pulseLenFactor = EXP2F(-192 / 64);
-			//pulseLen = EXP2I((256 - pulseWidthVal) << 6) * pulseLenFactor;
-		}
-		pulseLen *= waveLen;
+		// Now relWavePos counts from the middle of first cosine
+		relWavePos = wavePos;
 
-		float hLen = pulseLen - cosineLen;
+		// negative segments
+		if (!(relWavePos < (cosineLen + hLen))) {
+			resSample = -resSample;
+			relWavePos -= cosineLen + hLen;
 
-		// Ignore pulsewidths too high for given freq
-		if (hLen < 0.0f) {
-			hLen = 0.0f;
+			// From the digital captures, the decaying speed of the resonance sine is found a bit different for the positive and the negative segments
+			resAmpDecay += 0.25f;
 		}
 
-		// Correct resAmp for cutoff in range 50..66
-		if ((cutoffVal >= MIDDLE_CUTOFF_VALUE) && (cutoffVal < RESONANCE_DECAY_THRESHOLD_CUTOFF_VALUE)) {
-			resAmp *= sin(FLOAT_PI * (cutoffVal - MIDDLE_CUTOFF_VALUE) / 32.0f);
-		}
+		// Resonance sine WG
+		resSample *= sin(FLOAT_PI * relWavePos / cosineLen);
 
-		// Produce filtered square wave with 2 cosine waves on slopes
+		// Resonance sine amp
+		float resAmpFadeLog2 = -0.125f * resAmpDecay * (relWavePos / cosineLen); // seems to be exact
+		float resAmpFade = EXP2F(resAmpFadeLog2);
 
-		// 1st cosine segment
-		if (relWavePos < cosineLen) {
-			sample = -cos(FLOAT_PI * relWavePos / cosineLen);
-		} else
+		// Now relWavePos set negative to the left from center of any cosine
+		relWavePos = wavePos;
 
-		// high linear segment
-		if (relWavePos < (cosineLen + hLen)) {
-			sample = 1.f;
+		// negative segment
+		if (!(wavePos < (waveLen - 0.5f * cosineLen))) {
+			relWavePos -= waveLen;
 		} else
 
-		// 2nd cosine segment
-		if (relWavePos < (2 * cosineLen + hLen)) {
-			sample = cos(FLOAT_PI * (relWavePos - (cosineLen + hLen)) / cosineLen);
-		} else {
+		// positive segment
+		if (!(wavePos < (hLen + 0.5f * cosineLen))) {
+			relWavePos -= cosineLen + hLen;
+		}
 
-		// low linear segment
-			sample = -1.f;
+		// To ensure the output wave has no breaks, two different windows are appied to the beginning and the ending of the resonance sine segment
+		if (relWavePos < 0.5f * cosineLen) {
+			float syncSine = sin(FLOAT_PI * relWavePos / cosineLen);
+			if (relWavePos < 0.0f) {
+				// The window is synchronous square sine here
+				resAmpFade *= syncSine * syncSine;
+			} else {
+				// The window is synchronous sine here
+				resAmpFade *= syncSine;
+			}
 		}
 
-		if (cutoffVal < MIDDLE_CUTOFF_VALUE) {
+		sample += resSample * resAmp * resAmpFade;
+	}
 
-			// Attenuate samples below cutoff 50
-			// Found by sample analysis
-			sample *= EXP2F(-0.125f * (MIDDLE_CUTOFF_VALUE - cutoffVal));
-		} else {
+	// sawtooth waves
+	if (sawtooth) {
+		sample *= cos(FLOAT_2PI * wavePos / waveLen);
+	}
+
+	wavePos++;
 
-			// Add resonance sine. Effective for cutoff > 50 only
-			float resSample = 1.0f;
+	// wavePos isn't supposed to be > waveLen
+	if (wavePos > waveLen) {
+		wavePos -= waveLen;
+	}
+
+	// Multiply sample with current TVA value
+	return sample * amp;
+}
 
-			// Resonance decay speed factor
-			float resAmpDecayFactor = Tables::getInstance().resAmpDecayFactor[resonance >> 2];
+// Produces the same wave as generateNextSynthSample() out of the band-limited wavetables, the wave position is tracked
+// the same way, so that skipSynthSamples() applies as well. See LA32Wavetables for the decomposition of the wave.
+template <bool sawtooth>
+float LA32FloatWaveGenerator::generateNextWavetableSynthSample(const Bit32u ampVal, const Bit16u pitch, const Bit32u cutoffRampVal) {
+	updateAmpAndPitch(ampVal, pitch);
 
-			// Now relWavePos counts from the middle of first cosine
-			relWavePos = wavePos;
+	wavePos *= lastFreq / freq;
+	lastFreq = freq;
 
-			// negative segments
-			if (!(relWavePos < (cosineLen + hLen))) {
-				resSample = -resSample;
-				relWavePos -= cosineLen + hLen;
+	updateCutoff(cutoffRampVal);
 
-				// From the digital captures, the decaying speed of the resonance sine is found a bit different for the positive and the negative segments
-				resAmpDecayFactor += 0.25f;
-			}
+	const float phase = wavePos * invWaveLen;
+	float fallingEdgePhase = phase - fallingEdgePos;
+	if (fallingEdgePhase < 0.0f) {
+		fallingEdgePhase += 1.0f;
+	}
+
+	// Produce filtered square wave as the difference of the rising and the falling edge waves
+	const float *edgeTable = wavetables->getEdgeTable(cutoffLevel, mipmapLevel);
+	float edges = LA32Wavetables::lookup(edgeTable, tableLength, phase) - LA32Wavetables::lookup(edgeTable, tableLength, fallingEdgePhase);
+	if (cutoffLevelFraction > 0.0f) {
+		edgeTable = wavetables->getEdgeTable(cutoffLevel + 1, mipmapLevel);
+		float nextEdges = LA32Wavetables::lookup(edgeTable, tableLength, phase) - LA32Wavetables::lookup(edgeTable, tableLength, fallingEdgePhase);
+		edges += (nextEdges - edges) * cutoffLevelFraction;
+	}
+	float sample = 2.0f * (edges + fallingEdgePos) - 1.0f;
+
+	if (cutoffVal < MIDDLE_CUTOFF_VALUE) {
+		sample *= cutoffAttenuation;
+	} else if (resAmp != 0.0f) {
+		// Add resonance sine, the segment positions and the windows are the same as in generateNextSynthSample()
+		float resSample;
+		if (phase < fallingEdgePos) {
+			resSample = wavetables->getResonanceSample(resonanceDecayLevel, false, phase * invRelCosineLen);
+		} else {
+			resSample = -wavetables->getResonanceSample(resonanceDecayLevel, true, (phase - fallingEdgePos) * invRelCosineLen);
+		}
+
+		float relPhase = phase;
+		if (!(phase < (1.0f - 0.5f * relCosineLen))) {
+			relPhase -= 1.0f;
+		} else if (!(phase < (fallingEdgePos - 0.5f * relCosineLen))) {
+			relPhase -= fallingEdgePos;
+		}
+		if (relPhase < 0.5f * relCosineLen) {
+			float syncSine = wavetables->getSine(relPhase * invRelCosineLen);
+			resSample *= relPhase < 0.0f ? syncSine * syncSine : syncSine;
+		}
 
-			// Resonance sine WG
-			resSample *= sin(FLOAT_PI * relWavePos / cosineLen);
+		sample += resSample * resAmp;
+	}
 
-			// Resonance sine amp
-			float resAmpFadeLog2 = -0.125f * resAmpDecayFactor * (relWavePos / cosineLen); // seems to be exact
-			float resAmpFade = EXP2F(resAmpFadeLog2);
+	if (sawtooth) {
+		sample *= wavetables->getCosine(phase);
+	}
 
-			// Now relWavePos set negative to the left from center of any cosine
-			relWavePos = wavePos;
+	wavePos++;
+	if (wavePos > waveLen) {
+		wavePos -= waveLen;
+	}
 
-			// negative segment
-			if (!(wavePos < (waveLen - 0.5f * cosineLen))) {
-				relWavePos -= waveLen;
-			} else
+	return sample * amp;
+}
 
-			// positive segment
-			if (!(wavePos < (hLen + 0.5f * cosineLen))) {
-				relWavePos -= cosineLen + hLen;
+// The wave positions are advanced sample by sample, since each one depends on the previous. The positions, the fractions
+// to interpolate by and the amps are collected for a block of samples, which the kernel then reads from the wave at once.
+// The guard sample that follows the wave stands for the sample past the end, zero or the first one of a looped wave.
+template <bool looped, bool interpolated>
+void LA32FloatWaveGenerator::generatePCMSamples(const Bit32u length, const Bit32u *ampVals, const Bit16u *pitches, float *outputs) {
+	Bit32u positions[PCM_KERNEL_BLOCK_LENGTH];
+	float fractions[PCM_KERNEL_BLOCK_LENGTH];
+	float amps[PCM_KERNEL_BLOCK_LENGTH];
+	int len = pcmWaveLength;
+	for (Bit32u blockStart = 0; blockStart < length;) {
+		Bit32u blockLength = length - blockStart;
+		if (blockLength > PCM_KERNEL_BLOCK_LENGTH) blockLength = PCM_KERNEL_BLOCK_LENGTH;
+		for (Bit32u ix = 0; ix < blockLength; ix++) {
+			// The control values tend to stay unchanged for many samples, so the derived values are only recomputed on change.
+			updateAmpAndPitch(ampVals[blockStart + ix], pitches[blockStart + ix]);
+
+			int intPCMPosition = int(pcmPosition);
+			if (!looped && intPCMPosition >= len) {
+				// We're now past the end of a non-looping PCM waveform so it's time to die.
+				deactivate();
+				kernels->generatePCMFloat(pcmWaveAddress, positions, interpolated ? fractions : NULL, amps, outputs + blockStart, ix);
+				// It only remains silent from now on
+				memset(outputs + blockStart + ix, 0, (length - blockStart - ix) * sizeof(float));
+				return;
 			}
-
-			// To ensure the output wave has no breaks, two different windows are appied to the beginning and the ending of the resonance sine segment
-			if (relWavePos < 0.5f * cosineLen) {
-				float syncSine = sin(FLOAT_PI * relWavePos / cosineLen);
-				if (relWavePos < 0.0f) {
-					// The window is synchronous square sine here
-					resAmpFade *= syncSine * syncSine;
-				} else {
-					// The window is synchronous sine here
-					resAmpFade *= syncSine;
-				}
+			positions[ix] = Bit32u(intPCMPosition);
+			// We observe that for partial structures with ring modulation the interpolation is not applied to the slave PCM partial.
+			// It's assumed that the multiplication circuitry intended to perform the interpolation on the slave PCM partial
+			// is borrowed by the ring modulation circuit (or the LA32 chip has a similar lack of resources assigned to each partial pair).
+			if (interpolated) {
+				fractions[ix] = pcmPosition - intPCMPosition;
 			}
+			amps[ix] = amp;
 
-			sample += resSample * resAmp * resAmpFade;
+			float positionDelta = freq * 2048.0f / SAMPLE_RATE;
+			float newPCMPosition = pcmPosition + positionDelta;
+			if (looped) {
+				newPCMPosition = wrapPCMPosition(newPCMPosition, float(pcmWaveLength));
+			}
+			pcmPosition = newPCMPosition;
 		}
+		// Linear interpolation, then multiply samples with current TVA values
+		kernels->generatePCMFloat(pcmWaveAddress, positions, interpolated ? fractions : NULL, amps, outputs + blockStart, blockLength);
+		blockStart += blockLength;
+	}
+}
 
-		// sawtooth waves
-		if (sawtoothWaveform) {
-			sample *= cos(FLOAT_2PI * wavePos / waveLen);
+template <bool sawtooth>
+void LA32FloatWaveGenerator::generateSynthSamples(const Bit32u length, const Bit32u *ampVals, const Bit16u *pitches, const Bit32u *cutoffRampVals, float *outputs) {
+	for (Bit32u ix = 0; ix < length; ix++) {
+		outputs[ix] = generateNextSynthSample<sawtooth>(ampVals[ix], pitches[ix], cutoffRampVals[ix]);
+	}
+}
+
+template <bool sawtooth>
+void LA32FloatWaveGenerator::generateWavetableSynthSamples(const Bit32u length, const Bit32u *ampVals, const Bit16u *pitches, const Bit32u *cutoffRampVals, float *outputs) {
+	for (Bit32u ix = 0; ix < length; ix++) {
+		outputs[ix] = generateNextWavetableSynthSample<sawtooth>(ampVals[ix], pitches[ix], cutoffRampVals[ix]);
+	}
+}
+
+// The wave positions are advanced exactly as in generatePCMSamples() and generateNextSynthSample(), the amp is left
+// out of date in the cache, and it is recomputed once the generation resumes.
+template <bool looped>
+void LA32FloatWaveGenerator::skipPCMSamples(const Bit32u length, const Bit16u *pitches) {
+	int len = pcmWaveLength;
+	for (Bit32u ix = 0; ix < length; ix++) {
+		updatePitch(pitches[ix]);
+		if (!looped && int(pcmPosition) >= len) {
+			deactivate();
+			return;
 		}
+		float positionDelta = freq * 2048.0f / SAMPLE_RATE;
+		float newPCMPosition = pcmPosition + positionDelta;
+		if (looped) {
+			newPCMPosition = wrapPCMPosition(newPCMPosition, float(pcmWaveLength));
+		}
+		pcmPosition = newPCMPosition;
+	}
+}
 
+void LA32FloatWaveGenerator::skipSynthSamples(const Bit32u length, const Bit16u *pitches) {
+	for (Bit32u ix = 0; ix < length; ix++) {
+		updatePitch(pitches[ix]);
+		wavePos *= lastFreq / freq;
+		lastFreq = freq;
 		wavePos++;
-
-		// wavePos isn't supposed to be > waveLen
 		if (wavePos > waveLen) {
 			wavePos -= waveLen;
 		}
 	}
+}
 
-	// Multiply sample with current TVA value
-	sample *= amp;
-	return sample;
+void LA32FloatWaveGenerator::skipSamples(const Bit32u length, const Bit16u *pitches, const Bit32u *) {
+	if (!active) return;
+	if (isPCMWave()) {
+		if (pcmWaveLooped) {
+			skipPCMSamples<true>(length, pitches);
+		} else {
+			skipPCMSamples<false>(length, pitches);
+		}
+	} else {
+		skipSynthSamples(length, pitches);
+	}
+}
+
+// ampVals - Logarithmic amp of the wave generator for each sample
+// pitches - Logarithmic frequency of the resulting wave for each sample
+// cutoffRampVals - Composed of the base cutoff in range [78..178] left-shifted by 18 bits and the TVF modifier for each sample
+void LA32FloatWaveGenerator::generateSamples(const Bit32u length, const Bit32u *ampVals, const Bit16u *pitches, const Bit32u *cutoffRampVals, float *outputs) {
+	if (!active) {
+		memset(outputs, 0, length * sizeof(float));
+		return;
+	}
+
+	// SEMI-CONFIRMED: From sample analysis:
+	// (1) Tested with a single partial playing PCM wave 77 with pitchCoarse 36 and no keyfollow, velocity follow, etc.
+	// This gives results within +/- 2 at the output (before any DAC bitshifting)
+	// when sustaining at levels 156 - 255 with no modifiers.
+	// (2) Tested with a special square wave partial (internal capture ID tva5) at TVA envelope levels 155-255.
+	// This gives deltas between -1 and 0 compared to the real output. Note that this special partial only produces
+	// positive amps, so negative still needs to be explored, as well as lower levels.
+	//
+	// Also still partially unconfirmed is the behaviour when ramping between levels, as well as the timing.
+
+	if (isPCMWave()) {
+		if (pcmWaveLooped) {
+			if (pcmWaveInterpolated) {
+				generatePCMSamples<true, true>(length, ampVals, pitches, outputs);
+			} else {
+				generatePCMSamples<true, false>(length, ampVals, pitches, outputs);
+			}
+		} else {
+			if (pcmWaveInterpolated) {
+				generatePCMSamples<false, true>(length, ampVals, pitches, outputs);
+			} else {
+				generatePCMSamples<false, false>(length, ampVals, pitches, outputs);
+			}
+		}
+	} else if (wavetables != NULL) {
+		if (sawtoothWaveform) {
+			generateWavetableSynthSamples<true>(length, ampVals, pitches, cutoffRampVals, outputs);
+		} else {
+			generateWavetableSynthSamples<false>(length, ampVals, pitches, cutoffRampVals, outputs);
+		}
+	} else if (sawtoothWaveform) {
+		generateSynthSamples<true>(length, ampVals, pitches, cutoffRampVals, outputs);
+	} else {
+		generateSynthSamples<false>(length, ampVals, pitches, cutoffRampVals, outputs);
+	}
 }
 
 void LA32FloatWaveGenerator::deactivate() {
@@ -284,8 +543,16 @@ bool LA32FloatWaveGenerator::isPCMWave() const {
 void LA32FloatPartialPair::init(const bool useRingModulated, const bool useMixed) {
 	ringModulated = useRingModulated;
 	mixed = useMixed;
-	masterOutputSample = 0.0f;
-	slaveOutputSample = 0.0f;
+}
+
+void LA32FloatPartialPair::setWavetables(const LA32Wavetables *wavetables) {
+	master.setWavetables(wavetables);
+	slave.setWavetables(wavetables);
+}
+
+void LA32FloatPartialPair::setKernels(const Kernels *kernels) {
+	master.setKernels(kernels);
+	slave.setKernels(kernels);
 }
 
 void LA32FloatPartialPair::initSynth(const PairType useMaster, const bool sawtoothWaveform, const Bit8u pulseWidth, const Bit8u resonance) {
@@ -296,19 +563,32 @@ void LA32FloatPartialPair::initSynth(const PairType useMaster, const bool sawtoo
 	}
 }
 
-void LA32FloatPartialPair::initPCM(const PairType useMaster, const Bit16s *pcmWaveAddress, const Bit32u pcmWaveLength, const bool pcmWaveLooped) {
+void LA32FloatPartialPair::initPCM(const PairType useMaster, const PCMWaveEntry &pcmWave) {
+	if (useMaster == MASTER) {
+		master.initPCM(pcmWave.linearData, pcmWave.len, pcmWave.loop, true);
+	} else {
+		slave.initPCM(pcmWave.linearData, pcmWave.len, pcmWave.loop, !ringModulated);
+	}
+}
+
+LA32PartialPair::OutputMode LA32FloatPartialPair::getOutputMode() const {
+	if (!ringModulated) return OUTPUT_MODE_MIXED;
+	return mixed ? OUTPUT_MODE_RING_MODULATED_MIXED : OUTPUT_MODE_RING_MODULATED;
+}
+
+void LA32FloatPartialPair::generateSamples(const PairType useMaster, const Bit32u length, const Bit32u *amps, const Bit16u *pitches, const Bit32u *cutoffs, float *outputs) {
 	if (useMaster == MASTER) {
-		master.initPCM(pcmWaveAddress, pcmWaveLength, pcmWaveLooped, true);
+		master.generateSamples(length, amps, pitches, cutoffs, outputs);
 	} else {
-		slave.initPCM(pcmWaveAddress, pcmWaveLength, pcmWaveLooped, !ringModulated);
+		slave.generateSamples(length, amps, pitches, cutoffs, outputs);
 	}
 }
 
-void LA32FloatPartialPair::generateNextSample(const PairType useMaster, const Bit32u amp, const Bit16u pitch, const Bit32u cutoff) {
+void LA32FloatPartialPair::skipSamples(const PairType useMaster, const Bit32u length, const Bit16u *pitches, const Bit32u *cutoffs) {
 	if (useMaster == MASTER) {
-		masterOutputSample = master.generateNextSample(amp, pitch, cutoff);
+		master.skipSamples(length, pitches, cutoffs);
 	} else {
-		slaveOutputSample = slave.generateNextSample(amp, pitch, cutoff);
+		slave.skipSamples(length, pitches, cutoffs);
 	}
 }
 
@@ -321,34 +601,45 @@ static inline float produceDistortedSample(float sample) {
 	return sample;
 }
 
-float LA32FloatPartialPair::nextOutSample() {
+template <LA32PartialPair::OutputMode outputMode, bool withSlave>
+void LA32FloatPartialPair::mixOutputs(const Bit32u length, float *masterOutputs, const float *slaveOutputs) {
 	// Note, LA32FloatWaveGenerator produces each sample normalised in terms of a single playing partial,
 	// so the unity sample corresponds to the internal LA32 logarithmic fixed-point unity sample.
 	// However, each logarithmic sample is then unlogged to a 14-bit signed integer value, i.e. the max absolute value is 8192.
 	// Thus, considering that samples are further mapped to a 16-bit signed integer,
 	// we apply a conversion factor 0.25 to produce properly normalised float samples.
-	if (!ringModulated) {
-		return 0.25f * (masterOutputSample + slaveOutputSample);
+	for (Bit32u ix = 0; ix < length; ix++) {
+		float masterSample = masterOutputs[ix];
+		float slaveSample = withSlave ? slaveOutputs[ix] : 0.0f;
+		if (outputMode == OUTPUT_MODE_MIXED) {
+			masterOutputs[ix] = 0.25f * (masterSample + slaveSample);
+			continue;
+		}
+		/*
+		 * SEMI-CONFIRMED: Ring modulation model derived from sample analysis of specially constructed patches which exploit distortion.
+		 * LA32 ring modulator found to produce distorted output in case if the absolute value of maximal amplitude of one of the input partials exceeds 8191.
+		 * This is easy to reproduce using synth partials with resonance values close to the maximum. It looks like an integer overflow happens in this case.
+		 * As the distortion is strictly bound to the amplitude of the complete mixed square + resonance wave in the linear space,
+		 * it is reasonable to assume the ring modulation is performed also in the linear space by sample multiplication.
+		 * Most probably the overflow is caused by limited precision of the multiplication circuit as the very similar distortion occurs with panning.
+		 */
+		float ringModulatedSample = produceDistortedSample(masterSample) * produceDistortedSample(slaveSample);
+		masterOutputs[ix] = 0.25f * (outputMode == OUTPUT_MODE_RING_MODULATED_MIXED ? masterSample + ringModulatedSample : ringModulatedSample);
 	}
-	/*
-	 * SEMI-CONFIRMED: Ring modulation model derived from sample analysis of specially constructed patches which exploit distortion.
-	 * LA32 ring modulator found to produce distorted output in case if the absolute value of maximal amplitude of one of the input partials exceeds 8191.
-	 * This is easy to reproduce using synth partials with resonance values close to the maximum. It looks like an integer overflow happens in this case.
-	 * As the distortion is strictly bound to the amplitude of the complete mixed square + resonance wave in the linear space,
-	 * it is reasonable to assume the ring modulation is performed also in the linear space by sample multiplication.
-	 * Most probably the overflow is caused by limited precision of the multiplication circuit as the very similar distortion occurs with panning.
-	 */
-	float ringModulatedSample = produceDistortedSample(masterOutputSample) * produceDistortedSample(slaveOutputSample);
-	return 0.25f * (mixed ? masterOutputSample + ringModulatedSample : ringModulatedSample);
 }
 
+template void LA32FloatPartialPair::mixOutputs<LA32PartialPair::OUTPUT_MODE_MIXED, false>(const Bit32u length, float *masterOutputs, const float *slaveOutputs);
+template void LA32FloatPartialPair::mixOutputs<LA32PartialPair::OUTPUT_MODE_MIXED, true>(const Bit32u length, float *masterOutputs, const float *slaveOutputs);
+template void LA32FloatPartialPair::mixOutputs<LA32PartialPair::OUTPUT_MODE_RING_MODULATED, false>(const Bit32u length, float *masterOutputs, const float *slaveOutputs);
+template void LA32FloatPartialPair::mixOutputs<LA32PartialPair::OUTPUT_MODE_RING_MODULATED, true>(const Bit32u length, float *masterOutputs, const float *slaveOutputs);
+template void LA32FloatPartialPair::mixOutputs<LA32PartialPair::OUTPUT_MODE_RING_MODULATED_MIXED, false>(const Bit32u length, float *masterOutputs, const float *slaveOutputs);
+template void LA32FloatPartialPair::mixOutputs<LA32PartialPair::OUTPUT_MODE_RING_MODULATED_MIXED, true>(const Bit32u length, float *masterOutputs, const float *slaveOutputs);
+
 void LA32FloatPartialPair::deactivate(const PairType useMaster) {
 	if (useMaster == MASTER) {
 		master.deactivate();
-		masterOutputSample = 0.0f;
 	} else {
 		slave.deactivate();
-		slaveOutputSample = 0.0f;
 	}
 }
 
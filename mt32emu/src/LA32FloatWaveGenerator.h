@@ -25,6 +25,9 @@
 
 namespace MT32Emu {
 
+class Kernels;
+class LA32Wavetables;
+
 /**
  * LA32WaveGenerator is aimed to represent the exact model of LA32 wave generator.
  * The output square wave is created by adding high / low linear segments in-between
@@ -52,13 +55,13 @@ class LA32FloatWaveGenerator {
 	// Value 255 corresponds to the maximum possible asymmetric of the resulting wave
 	Bit8u pulseWidth;
 
-	// Logarithmic PCM sample start address
-	const Bit16s *pcmWaveAddress;
+	// Start address of the PCM samples converted to linear amplitudes, see Synth::initLinearPCMWaves()
+	const float *pcmWaveAddress;
 
-	// Logarithmic PCM sample length
+	// PCM sample length
 	Bit32u pcmWaveLength;
 
-	// true for looped logarithmic PCM samples
+	// true for looped PCM samples
 	bool pcmWaveLooped;
 
 	// false for slave PCM partials in the structures with the ring modulation
@@ -72,17 +75,86 @@ class LA32FloatWaveGenerator {
 	float lastFreq;
 	float pcmPosition;
 
-	float getPCMSample(unsigned int position);
+	// Values derived from the invariant parameters of synth partials
+	float baseResAmp;
+	float pulseLenFactor;
+	float resAmpDecayFactor;
+
+	// Values derived from the control inputs, updated only when the respective input changes
+	Bit32u lastAmpVal;
+	Bit16u lastPitch;
+	Bit32u lastCutoffRampVal;
+	float amp;
+	float freq;
+	float waveLen;
+	float cutoffVal;
+	float cosineLenFactor;
+	float resAmp;
+	float cutoffAttenuation;
+
+	// When set, the synth waves are looked up in the band-limited wavetables rather than computed after the model
+	const LA32Wavetables *wavetables;
+
+	// Implementations of the block kernels the PCM samples are produced with
+	const Kernels *kernels;
+
+	// Values to look the wavetables up with, derived from the invariant parameters and the control inputs as above
+	// The positions and lengths are relative to the wave length
+	Bit32u resonanceDecayLevel;
+	float invWaveLen;
+	Bit32u mipmapLevel;
+	Bit32u tableLength;
+	Bit32u cutoffLevel;
+	float cutoffLevelFraction;
+	float relCosineLen;
+	float invRelCosineLen;
+	float fallingEdgePos;
+
+	void resetControlCache();
+	void updateAmpAndPitch(const Bit32u ampVal, const Bit16u pitch);
+	void updatePitch(const Bit16u pitch);
+	void updateCutoff(const Bit32u cutoffRampVal);
+
+	// Specialised loops for each class of waves
+	template <bool sawtooth>
+	float generateNextSynthSample(const Bit32u ampVal, const Bit16u pitch, const Bit32u cutoffRampVal);
+	template <bool sawtooth>
+	float generateNextWavetableSynthSample(const Bit32u ampVal, const Bit16u pitch, const Bit32u cutoffRampVal);
+	template <bool looped, bool interpolated>
+	void generatePCMSamples(const Bit32u length, const Bit32u *ampVals, const Bit16u *pitches, float *outputs);
+	template <bool sawtooth>
+	void generateSynthSamples(const Bit32u length, const Bit32u *ampVals, const Bit16u *pitches, const Bit32u *cutoffRampVals, float *outputs);
+	template <bool sawtooth>
+	void generateWavetableSynthSamples(const Bit32u length, const Bit32u *ampVals, const Bit16u *pitches, const Bit32u *cutoffRampVals, float *outputs);
+	template <bool looped>
+	void skipPCMSamples(const Bit32u length, const Bit16u *pitches);
+	void skipSynthSamples(const Bit32u length, const Bit16u *pitches);
 
 public:
+	// Converts a logarithmic PCM sample from the ROM to the linear amplitude the wave generator interpolates
+	static float getLinearPCMSample(const Bit16s logSample);
+
+	LA32FloatWaveGenerator();
+
+	// Make the WG engine look the synth waves up in the wavetables, or compute them after the model when NULL
+	void setWavetables(const LA32Wavetables *wavetables);
+
+	// Make the WG engine use the kernels selected by the synth, the portable implementations are used by default
+	void setKernels(const Kernels *kernels);
+
 	// Initialise the WG engine for generation of synth partial samples and set up the invariant parameters
 	void initSynth(const bool sawtoothWaveform, const Bit8u pulseWidth, const Bit8u resonance);
 
 	// Initialise the WG engine for generation of PCM partial samples and set up the invariant parameters
-	void initPCM(const Bit16s * const pcmWaveAddress, const Bit32u pcmWaveLength, const bool pcmWaveLooped, const bool pcmWaveInterpolated);
+	void initPCM(const float * const pcmWaveAddress, const Bit32u pcmWaveLength, const bool pcmWaveLooped, const bool pcmWaveInterpolated);
 
-	// Update parameters with respect to TVP, TVA and TVF, and generate next sample
-	float generateNextSample(const Bit32u amp, const Bit16u pitch, const Bit32u cutoff);
+	// Update parameters with respect to TVP, TVA and TVF for each of the requested number of samples, and generate them
+	// The output of an inactive WG engine is silent.
+	void generateSamples(const Bit32u length, const Bit32u *amps, const Bit16u *pitches, const Bit32u *cutoffs, float *outputs);
+
+	// Advance the WG engine through the requested number of samples without generating them, the resulting state
+	// is the same as generateSamples() leaves, since the wave position does not depend on the amp
+	void skipSamples(const Bit32u length, const Bit16u *pitches, const Bit32u *cutoffs);
 
 	// Deactivate the WG engine
 	void deactivate();
@@ -99,8 +171,6 @@ class LA32FloatPartialPair : public LA32PartialPair {
 	LA32FloatWaveGenerator slave;
 	bool ringModulated;
 	bool mixed;
-	float masterOutputSample;
-	float slaveOutputSample;
 
 public:
 	// ringModulated should be set to false for the structures with mixing or stereo output
@@ -108,17 +178,31 @@ public:
 	// mixed is used for the structures with ring modulation and indicates whether the master partial output is mixed to the ring modulator output
 	void init(const bool ringModulated, const bool mixed);
 
+	// Make both WG engines look the synth waves up in the wavetables, or compute them after the model when NULL
+	void setWavetables(const LA32Wavetables *wavetables);
+
+	// Make both WG engines use the kernels selected by the synth
+	void setKernels(const Kernels *kernels);
+
 	// Initialise the WG engine for generation of synth partial samples and set up the invariant parameters
 	void initSynth(const PairType master, const bool sawtoothWaveform, const Bit8u pulseWidth, const Bit8u resonance);
 
 	// Initialise the WG engine for generation of PCM partial samples and set up the invariant parameters
-	void initPCM(const PairType master, const Bit16s * const pcmWaveAddress, const Bit32u pcmWaveLength, const bool pcmWaveLooped);
+	void initPCM(const PairType master, const PCMWaveEntry &pcmWave);
+
+	// Return the way the WG outputs are combined, which stays the same until the pair is re-initialised
+	OutputMode getOutputMode() const;
+
+	// Update parameters with respect to TVP, TVA and TVF, and generate the requested number of samples of a partial
+	void generateSamples(const PairType master, const Bit32u length, const Bit32u *amps, const Bit16u *pitches, const Bit32u *cutoffs, float *outputs);
 
-	// Update parameters with respect to TVP, TVA and TVF, and generate next sample
-	void generateNextSample(const PairType master, const Bit32u amp, const Bit16u pitch, const Bit32u cutoff);
+	// Advance a partial through the requested number of samples without generating them
+	void skipSamples(const PairType master, const Bit32u length, const Bit16u *pitches, const Bit32u *cutoffs);
 
-	// Perform mixing / ring modulation and return the result
-	float nextOutSample();
+	// Perform mixing / ring modulation of the generated WG outputs, the results replace the master outputs
+	// The output mode must be the one the pair is initialised with; unless withSlave is set, the slave is taken as silent
+	template <OutputMode outputMode, bool withSlave>
+	static void mixOutputs(const Bit32u length, float *masterOutputs, const float *slaveOutputs);
 
 	// Deactivate the WG engine
 	void deactivate(const PairType master);
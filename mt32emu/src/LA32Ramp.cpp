@@ -137,6 +137,64 @@ Bit32u LA32Ramp::nextValue() {
 	return current;
 }
 
+// Returns the number of nextValue() calls it takes to reach the target, the last one included.
+// The result is only meaningful when the increment is non-zero and no interrupt is pending.
+static Bit32u getRampLength(Bit32u current, Bit32u largeTarget, Bit32u largeIncrement, bool descending) {
+	// Note, an overflow of current is only possible when the target is exceeded, so there's no need to check.
+	if (descending) {
+		return current > largeTarget ? (current - largeTarget + largeIncrement - 1) / largeIncrement : 1;
+	}
+	return current < largeTarget ? (largeTarget - current + largeIncrement - 1) / largeIncrement : 1;
+}
+
+Bit32u LA32Ramp::samplesUntilInterrupt(Bit32u maxLength) const {
+	Bit32u length;
+	if (interruptCountdown > 0) {
+		length = Bit32u(interruptCountdown) - 1;
+	} else if (largeIncrement != 0) {
+		length = getRampLength(current, largeTarget, largeIncrement, descending) + INTERRUPT_TIME - 1;
+	} else {
+		return maxLength;
+	}
+	return length < maxLength ? length : maxLength;
+}
+
+void LA32Ramp::advance(Bit32u length, Bit32u *values) {
+	Bit32u *valuesEnd = values + length;
+	while (values < valuesEnd) {
+		if (interruptCountdown > 0) {
+			Bit32u countdownLength = Bit32u(valuesEnd - values);
+			if (Bit32u(interruptCountdown) <= countdownLength) {
+				countdownLength = Bit32u(interruptCountdown);
+				interruptRaised = true;
+			}
+			interruptCountdown -= int(countdownLength);
+			for (Bit32u *countdownEnd = values + countdownLength; values < countdownEnd; values++) {
+				*values = current;
+			}
+		} else if (largeIncrement != 0) {
+			// The values in between are computed in a row, then the target is set as nextValue() does.
+			Bit32u stepCount = getRampLength(current, largeTarget, largeIncrement, descending) - 1;
+			if (stepCount >= Bit32u(valuesEnd - values)) {
+				stepCount = Bit32u(valuesEnd - values);
+			}
+			Bit32u *stepsEnd = values + stepCount;
+			if (descending) {
+				while (values < stepsEnd) *(values++) = (current -= largeIncrement);
+			} else {
+				while (values < stepsEnd) *(values++) = (current += largeIncrement);
+			}
+			if (values < valuesEnd) {
+				current = largeTarget;
+				interruptCountdown = INTERRUPT_TIME;
+				*(values++) = current;
+			}
+		} else {
+			while (values < valuesEnd) *(values++) = current;
+		}
+	}
+}
+
 bool LA32Ramp::checkInterrupt() {
 	bool wasRaised = interruptRaised;
 	interruptRaised = false;
@@ -37,6 +37,10 @@ public:
 	LA32Ramp();
 	void startRamp(Bit8u target, Bit8u increment);
 	Bit32u nextValue();
+	// Returns the number of samples, up to maxLength, which can be generated before the one raising the interrupt.
+	Bit32u samplesUntilInterrupt(Bit32u maxLength) const;
+	// Fills the buffer with the values the next length calls of nextValue() would return, with the same effect.
+	void advance(Bit32u length, Bit32u *values);
 	bool checkInterrupt();
 	void reset();
 	bool isBelowCurrent(Bit8u target) const;
@@ -16,10 +16,12 @@
  */
 
 #include <cstddef>
+#include <cstring>
 
 #include "internals.h"
 
 #include "LA32WaveGenerator.h"
+#include "Structures.h"
 #include "Tables.h"
 
 namespace MT32Emu {
@@ -31,11 +33,7 @@ static const Bit32u MAX_CUTOFF_VALUE = 240 << 18;
 static const LogSample SILENCE = {65535, LogSample::POSITIVE};
 
 Bit16u LA32Utilites::interpolateExp(const Bit16u fract) {
-	Bit16u expTabIndex = fract >> 3;
-	Bit16u extraBits = ~fract & 7;
-	Bit16u expTabEntry2 = 8191 - Tables::getInstance().exp9[expTabIndex];
-	Bit16u expTabEntry1 = expTabIndex == 0 ? 8191 : (8191 - Tables::getInstance().exp9[expTabIndex - 1]);
-	return expTabEntry2 + (((expTabEntry1 - expTabEntry2) * extraBits) >> 3);
+	return Tables::getInstance().interpolatedExp[fract];
 }
 
 Bit16s LA32Utilites::unlog(const LogSample &logSample) {
@@ -52,13 +50,28 @@ void LA32Utilites::addLogSamples(LogSample &logSample1, const LogSample &logSamp
 	logSample1.sign = logSample1.sign == logSample2.sign ? LogSample::POSITIVE : LogSample::NEGATIVE;
 }
 
-Bit32u LA32WaveGenerator::getSampleStep() {
+Bit32u LA32WaveGenerator::getSampleStep() const {
 	// sampleStep = EXP2F(pitch / 4096.0f + 4.0f)
-	Bit32u sampleStep = LA32Utilites::interpolateExp(~pitch & 4095);
-	sampleStep <<= pitch >> 12;
-	sampleStep >>= 8;
-	sampleStep &= ~1;
-	return sampleStep;
+	Bit32u newSampleStep = LA32Utilites::interpolateExp(~pitch & 4095);
+	newSampleStep <<= pitch >> 12;
+	newSampleStep >>= 8;
+	newSampleStep &= ~1;
+	return newSampleStep;
+}
+
+Bit32u LA32WaveGenerator::getPCMSampleStep() const {
+	// pcmSampleStep = (Bit32u)EXP2F(pitch / 4096.0f + 3.0f);
+	Bit32u pcmSampleStep = LA32Utilites::interpolateExp(~pitch & 4095);
+	pcmSampleStep <<= pitch >> 12;
+	// Seeing the actual lengths of the PCM wave for pitches 00..12,
+	// the pcmPosition counter can be assumed to have 8-bit fractions
+	pcmSampleStep >>= 9;
+	return pcmSampleStep;
+}
+
+void LA32WaveGenerator::invalidateSampleStep() {
+	// This value can never come from TVP, so the first sample always computes the sample step
+	pitch = 0xFFFF;
 }
 
 Bit32u LA32WaveGenerator::getResonanceWaveLengthFactor(Bit32u effectiveCutoffValue) {
@@ -119,9 +132,13 @@ void LA32WaveGenerator::computePositions(Bit32u highLinearLength, Bit32u lowLine
 }
 
 void LA32WaveGenerator::advancePosition() {
-	wavePosition += getSampleStep();
+	wavePosition += sampleStep;
 	wavePosition %= 4 * SINE_SEGMENT_RELATIVE_LENGTH;
+	updatePositions();
+}
 
+// Derives the positions within the square and resonance waves from the wave position and the current cutoff value.
+void LA32WaveGenerator::updatePositions() {
 	Bit32u effectiveCutoffValue = (cutoffVal > MIDDLE_CUTOFF_VALUE) ? (cutoffVal - MIDDLE_CUTOFF_VALUE) >> 10 : 0;
 	Bit32u resonanceWaveLengthFactor = getResonanceWaveLengthFactor(effectiveCutoffValue);
 	Bit32u highLinearLength = getHighLinearLength(effectiveCutoffValue);
@@ -216,6 +233,7 @@ void LA32WaveGenerator::pcmSampleToLogSample(LogSample &logSample, const Bit16s
 	logSample.sign = pcmSample < 0 ? LogSample::NEGATIVE : LogSample::POSITIVE;
 }
 
+template <bool looped, bool interpolated>
 void LA32WaveGenerator::generateNextPCMWaveLogSamples() {
 	// This should emulate the ladder we see in the PCM captures for pitches 01, 02, 07, etc.
 	// The most probable cause is the factor in the interpolation formula is one bit less
@@ -223,30 +241,16 @@ void LA32WaveGenerator::generateNextPCMWaveLogSamples() {
 	pcmInterpolationFactor = (wavePosition & 255) >> 1;
 	Bit32u pcmWaveTableIx = wavePosition >> 8;
 	pcmSampleToLogSample(firstPCMLogSample, pcmWaveAddress[pcmWaveTableIx]);
-	if (pcmWaveInterpolated) {
-		pcmWaveTableIx++;
-		if (pcmWaveTableIx < pcmWaveLength) {
-			pcmSampleToLogSample(secondPCMLogSample, pcmWaveAddress[pcmWaveTableIx]);
-		} else {
-			if (pcmWaveLooped) {
-				pcmWaveTableIx -= pcmWaveLength;
-				pcmSampleToLogSample(secondPCMLogSample, pcmWaveAddress[pcmWaveTableIx]);
-			} else {
-				secondPCMLogSample = SILENCE;
-			}
-		}
+	if (interpolated) {
+		// The wave is followed by a guard sample, which repeats the first sample of a looped wave. Otherwise, it is zero,
+		// and that converts to SILENCE.
+		pcmSampleToLogSample(secondPCMLogSample, pcmWaveAddress[pcmWaveTableIx + 1]);
 	} else {
 		secondPCMLogSample = SILENCE;
 	}
-	// pcmSampleStep = (Bit32u)EXP2F(pitch / 4096.0f + 3.0f);
-	Bit32u pcmSampleStep = LA32Utilites::interpolateExp(~pitch & 4095);
-	pcmSampleStep <<= pitch >> 12;
-	// Seeing the actual lengths of the PCM wave for pitches 00..12,
-	// the pcmPosition counter can be assumed to have 8-bit fractions
-	pcmSampleStep >>= 9;
-	wavePosition += pcmSampleStep;
+	wavePosition += sampleStep;
 	if (wavePosition >= (pcmWaveLength << 8)) {
-		if (pcmWaveLooped) {
+		if (looped) {
 			wavePosition -= pcmWaveLength << 8;
 		} else {
 			deactivate();
@@ -270,6 +274,7 @@ void LA32WaveGenerator::initSynth(const bool useSawtoothWaveform, const Bit8u us
 	resAmpDecayFactor = Tables::getInstance().resAmpDecayFactor[resonance >> 2] << 2;
 
 	pcmWaveAddress = NULL;
+	invalidateSampleStep();
 	active = true;
 }
 
@@ -280,45 +285,136 @@ void LA32WaveGenerator::initPCM(const Bit16s * const usePCMWaveAddress, const Bi
 	pcmWaveInterpolated = usePCMWaveInterpolated;
 
 	wavePosition = 0;
+	invalidateSampleStep();
 	active = true;
 }
 
-void LA32WaveGenerator::generateNextSample(const Bit32u useAmp, const Bit16u usePitch, const Bit32u useCutoffVal) {
-	if (!active) {
-		return;
+template <bool looped, bool interpolated>
+void LA32WaveGenerator::generatePCMSamples(const Bit32u length, const Bit32u *amps, const Bit16u *pitches, Bit16s *outputs) {
+	for (Bit32u ix = 0; ix < length; ix++) {
+		amp = amps[ix];
+		if (pitches[ix] != pitch) {
+			pitch = pitches[ix];
+			sampleStep = getPCMSampleStep();
+		}
+		generateNextPCMWaveLogSamples<looped, interpolated>();
+		if (!looped && !active) {
+			// The end of the wave is reached, it only remains silent from now on
+			memset(outputs + ix, 0, (length - ix) * sizeof(Bit16s));
+			return;
+		}
+		Bit16s firstSample = LA32Utilites::unlog(firstPCMLogSample);
+		if (interpolated) {
+			Bit16s secondSample = LA32Utilites::unlog(secondPCMLogSample);
+			outputs[ix] = Bit16s(firstSample + (((Bit32s(secondSample) - Bit32s(firstSample)) * pcmInterpolationFactor) >> 7));
+		} else {
+			/* SEMI-CONFIRMED from sample analysis:
+			 * We observe that for partial structures with ring modulation the interpolation is not applied to the slave PCM partial.
+			 * It's assumed that the multiplication circuitry intended to perform the interpolation on the slave PCM partial
+			 * is borrowed by the ring modulation circuit (or the LA32 chip has a similar lack of resources assigned to each partial pair).
+			 */
+			outputs[ix] = firstSample;
+		}
 	}
+}
 
-	amp = useAmp;
-	pitch = usePitch;
+template <bool sawtooth>
+void LA32WaveGenerator::generateSynthSamples(const Bit32u length, const Bit32u *amps, const Bit16u *pitches, const Bit32u *cutoffs, Bit16s *outputs) {
+	for (Bit32u ix = 0; ix < length; ix++) {
+		amp = amps[ix];
+		if (pitches[ix] != pitch) {
+			pitch = pitches[ix];
+			sampleStep = getSampleStep();
+		}
 
-	if (isPCMWave()) {
-		generateNextPCMWaveLogSamples();
-		return;
+		// The 240 cutoffVal limit was determined via sample analysis (internal Munt capture IDs: glop3, glop4).
+		// More research is needed to be sure that this is correct, however.
+		cutoffVal = (cutoffs[ix] > MAX_CUTOFF_VALUE) ? MAX_CUTOFF_VALUE : cutoffs[ix];
+
+		generateNextSquareWaveLogSample();
+		generateNextResonanceWaveLogSample();
+		if (sawtooth) {
+			LogSample cosineLogSample;
+			generateNextSawtoothCosineLogSample(cosineLogSample);
+			LA32Utilites::addLogSamples(squareLogSample, cosineLogSample);
+			LA32Utilites::addLogSamples(resonanceLogSample, cosineLogSample);
+		}
+		advancePosition();
+		outputs[ix] = Bit16s(LA32Utilites::unlog(squareLogSample) + LA32Utilites::unlog(resonanceLogSample));
 	}
+}
 
-	// The 240 cutoffVal limit was determined via sample analysis (internal Munt capture IDs: glop3, glop4).
-	// More research is needed to be sure that this is correct, however.
-	cutoffVal = (useCutoffVal > MAX_CUTOFF_VALUE) ? MAX_CUTOFF_VALUE : useCutoffVal;
-
-	generateNextSquareWaveLogSample();
-	generateNextResonanceWaveLogSample();
-	if (sawtoothWaveform) {
-		LogSample cosineLogSample;
-		generateNextSawtoothCosineLogSample(cosineLogSample);
-		LA32Utilites::addLogSamples(squareLogSample, cosineLogSample);
-		LA32Utilites::addLogSamples(resonanceLogSample, cosineLogSample);
+template <bool looped>
+void LA32WaveGenerator::skipPCMSamples(const Bit32u length, const Bit16u *pitches) {
+	for (Bit32u ix = 0; ix < length; ix++) {
+		if (pitches[ix] != pitch) {
+			pitch = pitches[ix];
+			sampleStep = getPCMSampleStep();
+		}
+		// The same as generateNextPCMWaveLogSamples() does after the log samples are fetched.
+		wavePosition += sampleStep;
+		if (wavePosition >= (pcmWaveLength << 8)) {
+			if (looped) {
+				wavePosition -= pcmWaveLength << 8;
+			} else {
+				deactivate();
+				return;
+			}
+		}
+	}
+}
+
+void LA32WaveGenerator::skipSynthSamples(const Bit32u length, const Bit16u *pitches, const Bit32u *cutoffs) {
+	for (Bit32u ix = 0; ix < length; ix++) {
+		if (pitches[ix] != pitch) {
+			pitch = pitches[ix];
+			sampleStep = getSampleStep();
+		}
+		wavePosition += sampleStep;
+		wavePosition %= 4 * SINE_SEGMENT_RELATIVE_LENGTH;
+	}
+	// The positions within the waves only depend on the last wave position and cutoff value.
+	cutoffVal = (cutoffs[length - 1] > MAX_CUTOFF_VALUE) ? MAX_CUTOFF_VALUE : cutoffs[length - 1];
+	updatePositions();
+}
+
+void LA32WaveGenerator::skipSamples(const Bit32u length, const Bit16u *pitches, const Bit32u *cutoffs) {
+	if (!active) return;
+	if (isPCMWave()) {
+		if (pcmWaveLooped) {
+			skipPCMSamples<true>(length, pitches);
+		} else {
+			skipPCMSamples<false>(length, pitches);
+		}
+	} else {
+		skipSynthSamples(length, pitches, cutoffs);
 	}
-	advancePosition();
 }
 
-LogSample LA32WaveGenerator::getOutputLogSample(const bool first) const {
-	if (!isActive()) {
-		return SILENCE;
+void LA32WaveGenerator::generateSamples(const Bit32u length, const Bit32u *amps, const Bit16u *pitches, const Bit32u *cutoffs, Bit16s *outputs) {
+	if (!active) {
+		memset(outputs, 0, length * sizeof(Bit16s));
+		return;
 	}
 	if (isPCMWave()) {
-		return first ? firstPCMLogSample : secondPCMLogSample;
+		if (pcmWaveLooped) {
+			if (pcmWaveInterpolated) {
+				generatePCMSamples<true, true>(length, amps, pitches, outputs);
+			} else {
+				generatePCMSamples<true, false>(length, amps, pitches, outputs);
+			}
+		} else {
+			if (pcmWaveInterpolated) {
+				generatePCMSamples<false, true>(length, amps, pitches, outputs);
+			} else {
+				generatePCMSamples<false, false>(length, amps, pitches, outputs);
+			}
+		}
+	} else if (sawtoothWaveform) {
+		generateSynthSamples<true>(length, amps, pitches, cutoffs, outputs);
+	} else {
+		generateSynthSamples<false>(length, amps, pitches, cutoffs, outputs);
 	}
-	return first ? squareLogSample : resonanceLogSample;
 }
 
 void LA32WaveGenerator::deactivate() {
@@ -333,10 +429,6 @@ bool LA32WaveGenerator::isPCMWave() const {
 	return pcmWaveAddress != NULL;
 }
 
-Bit32u LA32WaveGenerator::getPCMInterpolationFactor() const {
-	return pcmInterpolationFactor;
-}
-
 void LA32IntPartialPair::init(const bool useRingModulated, const bool useMixed) {
 	ringModulated = useRingModulated;
 	mixed = useMixed;
@@ -350,64 +442,69 @@ void LA32IntPartialPair::initSynth(const PairType useMaster, const bool sawtooth
 	}
 }
 
-void LA32IntPartialPair::initPCM(const PairType useMaster, const Bit16s *pcmWaveAddress, const Bit32u pcmWaveLength, const bool pcmWaveLooped) {
+void LA32IntPartialPair::initPCM(const PairType useMaster, const PCMWaveEntry &pcmWave) {
 	if (useMaster == MASTER) {
-		master.initPCM(pcmWaveAddress, pcmWaveLength, pcmWaveLooped, true);
+		master.initPCM(pcmWave.data, pcmWave.len, pcmWave.loop, true);
 	} else {
-		slave.initPCM(pcmWaveAddress, pcmWaveLength, pcmWaveLooped, !ringModulated);
+		slave.initPCM(pcmWave.data, pcmWave.len, pcmWave.loop, !ringModulated);
 	}
 }
 
-void LA32IntPartialPair::generateNextSample(const PairType useMaster, const Bit32u amp, const Bit16u pitch, const Bit32u cutoff) {
+LA32PartialPair::OutputMode LA32IntPartialPair::getOutputMode() const {
+	if (!ringModulated) return OUTPUT_MODE_MIXED;
+	return mixed ? OUTPUT_MODE_RING_MODULATED_MIXED : OUTPUT_MODE_RING_MODULATED;
+}
+
+void LA32IntPartialPair::generateSamples(const PairType useMaster, const Bit32u length, const Bit32u *amps, const Bit16u *pitches, const Bit32u *cutoffs, Bit16s *outputs) {
 	if (useMaster == MASTER) {
-		master.generateNextSample(amp, pitch, cutoff);
+		master.generateSamples(length, amps, pitches, cutoffs, outputs);
 	} else {
-		slave.generateNextSample(amp, pitch, cutoff);
+		slave.generateSamples(length, amps, pitches, cutoffs, outputs);
 	}
 }
 
-Bit16s LA32IntPartialPair::unlogAndMixWGOutput(const LA32WaveGenerator &wg) {
-	if (!wg.isActive()) {
-		return 0;
-	}
-	Bit16s firstSample = LA32Utilites::unlog(wg.getOutputLogSample(true));
-	Bit16s secondSample = LA32Utilites::unlog(wg.getOutputLogSample(false));
-	if (wg.isPCMWave()) {
-		return Bit16s(firstSample + (((Bit32s(secondSample) - Bit32s(firstSample)) * wg.getPCMInterpolationFactor()) >> 7));
+void LA32IntPartialPair::skipSamples(const PairType useMaster, const Bit32u length, const Bit16u *pitches, const Bit32u *cutoffs) {
+	if (useMaster == MASTER) {
+		master.skipSamples(length, pitches, cutoffs);
+	} else {
+		slave.skipSamples(length, pitches, cutoffs);
 	}
-	return firstSample + secondSample;
 }
 
 static inline Bit16s produceDistortedSample(Bit16s sample) {
 	return ((sample & 0x2000) == 0) ? Bit16s(sample & 0x1fff) : Bit16s(sample | ~0x1fff);
 }
 
-Bit16s LA32IntPartialPair::nextOutSample() {
-	if (!ringModulated) {
-		return unlogAndMixWGOutput(master) + unlogAndMixWGOutput(slave);
-	}
-
-	Bit16s masterSample = unlogAndMixWGOutput(master); // Store master partial sample for further mixing
-
-	/* SEMI-CONFIRMED from sample analysis:
-	 * We observe that for partial structures with ring modulation the interpolation is not applied to the slave PCM partial.
-	 * It's assumed that the multiplication circuitry intended to perform the interpolation on the slave PCM partial
-	 * is borrowed by the ring modulation circuit (or the LA32 chip has a similar lack of resources assigned to each partial pair).
-	 */
-	Bit16s slaveSample = slave.isPCMWave() ? LA32Utilites::unlog(slave.getOutputLogSample(true)) : unlogAndMixWGOutput(slave);
+template <LA32PartialPair::OutputMode outputMode, bool withSlave>
+void LA32IntPartialPair::mixOutputs(const Bit32u length, Bit16s *masterOutputs, const Bit16s *slaveOutputs) {
+	for (Bit32u ix = 0; ix < length; ix++) {
+		Bit16s masterSample = masterOutputs[ix];
+		Bit16s slaveSample = withSlave ? slaveOutputs[ix] : 0;
+		if (outputMode == OUTPUT_MODE_MIXED) {
+			masterOutputs[ix] = masterSample + slaveSample;
+			continue;
+		}
 
-	/* SEMI-CONFIRMED: Ring modulation model derived from sample analysis of specially constructed patches which exploit distortion.
-	 * LA32 ring modulator found to produce distorted output in case if the absolute value of maximal amplitude of one of the input partials exceeds 8191.
-	 * This is easy to reproduce using synth partials with resonance values close to the maximum. It looks like an integer overflow happens in this case.
-	 * As the distortion is strictly bound to the amplitude of the complete mixed square + resonance wave in the linear space,
-	 * it is reasonable to assume the ring modulation is performed also in the linear space by sample multiplication.
-	 * Most probably the overflow is caused by limited precision of the multiplication circuit as the very similar distortion occurs with panning.
-	 */
-	Bit16s ringModulatedSample = Bit16s((Bit32s(produceDistortedSample(masterSample)) * Bit32s(produceDistortedSample(slaveSample))) >> 13);
+		/* SEMI-CONFIRMED: Ring modulation model derived from sample analysis of specially constructed patches which exploit distortion.
+		 * LA32 ring modulator found to produce distorted output in case if the absolute value of maximal amplitude of one of the input partials exceeds 8191.
+		 * This is easy to reproduce using synth partials with resonance values close to the maximum. It looks like an integer overflow happens in this case.
+		 * As the distortion is strictly bound to the amplitude of the complete mixed square + resonance wave in the linear space,
+		 * it is reasonable to assume the ring modulation is performed also in the linear space by sample multiplication.
+		 * Most probably the overflow is caused by limited precision of the multiplication circuit as the very similar distortion occurs with panning.
+		 */
+		Bit16s ringModulatedSample = Bit16s((Bit32s(produceDistortedSample(masterSample)) * Bit32s(produceDistortedSample(slaveSample))) >> 13);
 
-	return mixed ? masterSample + ringModulatedSample : ringModulatedSample;
+		masterOutputs[ix] = outputMode == OUTPUT_MODE_RING_MODULATED_MIXED ? masterSample + ringModulatedSample : ringModulatedSample;
+	}
 }
 
+template void LA32IntPartialPair::mixOutputs<LA32PartialPair::OUTPUT_MODE_MIXED, false>(const Bit32u length, Bit16s *masterOutputs, const Bit16s *slaveOutputs);
+template void LA32IntPartialPair::mixOutputs<LA32PartialPair::OUTPUT_MODE_MIXED, true>(const Bit32u length, Bit16s *masterOutputs, const Bit16s *slaveOutputs);
+template void LA32IntPartialPair::mixOutputs<LA32PartialPair::OUTPUT_MODE_RING_MODULATED, false>(const Bit32u length, Bit16s *masterOutputs, const Bit16s *slaveOutputs);
+template void LA32IntPartialPair::mixOutputs<LA32PartialPair::OUTPUT_MODE_RING_MODULATED, true>(const Bit32u length, Bit16s *masterOutputs, const Bit16s *slaveOutputs);
+template void LA32IntPartialPair::mixOutputs<LA32PartialPair::OUTPUT_MODE_RING_MODULATED_MIXED, false>(const Bit32u length, Bit16s *masterOutputs, const Bit16s *slaveOutputs);
+template void LA32IntPartialPair::mixOutputs<LA32PartialPair::OUTPUT_MODE_RING_MODULATED_MIXED, true>(const Bit32u length, Bit16s *masterOutputs, const Bit16s *slaveOutputs);
+
 void LA32IntPartialPair::deactivate(const PairType useMaster) {
 	if (useMaster == MASTER) {
 		master.deactivate();
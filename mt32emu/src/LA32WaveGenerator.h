@@ -24,6 +24,8 @@
 
 namespace MT32Emu {
 
+struct PCMWaveEntry;
+
 /**
  * LA32 performs wave generation in the log-space that allows replacing multiplications by cheap additions
  * It's assumed that only low-bit multiplications occur in a few places which are unavoidable like these:
@@ -88,7 +90,7 @@ class LA32WaveGenerator {
 	// Composed of the base cutoff in range [78..178] left-shifted by 18 bits and the TVF modifier
 	Bit32u cutoffVal;
 
-	// Logarithmic PCM sample start address
+	// Logarithmic PCM sample start address, the wave must be followed by a guard sample (see Synth::initPCMList())
 	const Bit16s *pcmWaveAddress;
 
 	// Logarithmic PCM sample length
@@ -132,6 +134,10 @@ class LA32WaveGenerator {
 	// Fractional part of the pcmPosition
 	Bit32u pcmInterpolationFactor;
 
+	// Increment of wavePosition per sample derived from the pitch, recomputed only when the pitch changes
+	// which happens at the TVP timer rate at most
+	Bit32u sampleStep;
+
 	// Current phase of the square wave
 	enum {
 		POSITIVE_RISING_SINE_SEGMENT,
@@ -162,20 +168,33 @@ class LA32WaveGenerator {
 	// Internal methods below
 	//***************************************************************************
 
-	Bit32u getSampleStep();
+	Bit32u getSampleStep() const;
+	Bit32u getPCMSampleStep() const;
+	void invalidateSampleStep();
 	Bit32u getResonanceWaveLengthFactor(Bit32u effectiveCutoffValue);
 	Bit32u getHighLinearLength(Bit32u effectiveCutoffValue);
 
 	void computePositions(Bit32u highLinearLength, Bit32u lowLinearLength, Bit32u resonanceWaveLengthFactor);
 	void advancePosition();
+	void updatePositions();
 
 	void generateNextSquareWaveLogSample();
 	void generateNextResonanceWaveLogSample();
 	void generateNextSawtoothCosineLogSample(LogSample &logSample) const;
 
 	void pcmSampleToLogSample(LogSample &logSample, const Bit16s pcmSample) const;
+	template <bool looped, bool interpolated>
 	void generateNextPCMWaveLogSamples();
 
+	// Specialised loops for each class of waves
+	template <bool looped, bool interpolated>
+	void generatePCMSamples(const Bit32u length, const Bit32u *amps, const Bit16u *pitches, Bit16s *outputs);
+	template <bool sawtooth>
+	void generateSynthSamples(const Bit32u length, const Bit32u *amps, const Bit16u *pitches, const Bit32u *cutoffs, Bit16s *outputs);
+	template <bool looped>
+	void skipPCMSamples(const Bit32u length, const Bit16u *pitches);
+	void skipSynthSamples(const Bit32u length, const Bit16u *pitches, const Bit32u *cutoffs);
+
 public:
 	// Initialise the WG engine for generation of synth partial samples and set up the invariant parameters
 	void initSynth(const bool sawtoothWaveform, const Bit8u pulseWidth, const Bit8u resonance);
@@ -183,11 +202,14 @@ public:
 	// Initialise the WG engine for generation of PCM partial samples and set up the invariant parameters
 	void initPCM(const Bit16s * const pcmWaveAddress, const Bit32u pcmWaveLength, const bool pcmWaveLooped, const bool pcmWaveInterpolated);
 
-	// Update parameters with respect to TVP, TVA and TVF, and generate next sample
-	void generateNextSample(const Bit32u amp, const Bit16u pitch, const Bit32u cutoff);
+	// Update parameters with respect to TVP, TVA and TVF for each of the requested number of samples, and generate them
+	// WG output in the log-space consists of two components which are added in the linear-space, so that the results
+	// can be mixed or ring modulated by the partial pair afterwards. The output of an inactive WG engine is silent.
+	void generateSamples(const Bit32u length, const Bit32u *amps, const Bit16u *pitches, const Bit32u *cutoffs, Bit16s *outputs);
 
-	// WG output in the log-space consists of two components which are to be added (or ring modulated) in the linear-space afterwards
-	LogSample getOutputLogSample(const bool first) const;
+	// Advance the WG engine through the requested number of samples without generating them, the resulting state
+	// is the same as generateSamples() leaves, since the wave position does not depend on the amp
+	void skipSamples(const Bit32u length, const Bit16u *pitches, const Bit32u *cutoffs);
 
 	// Deactivate the WG engine
 	void deactivate();
@@ -197,9 +219,6 @@ public:
 
 	// Return true if the WG engine generates PCM wave samples
 	bool isPCMWave() const;
-
-	// Return current PCM interpolation factor
-	Bit32u getPCMInterpolationFactor() const;
 }; // class LA32WaveGenerator
 
 // LA32PartialPair contains a structure of two partials being mixed / ring modulated
@@ -210,6 +229,16 @@ public:
 		SLAVE
 	};
 
+	// Determines how the outputs of the partials are combined, set up once the pair is initialised
+	enum OutputMode {
+		// The outputs of both partials are summed up
+		OUTPUT_MODE_MIXED,
+		// The output of the ring modulator is used alone
+		OUTPUT_MODE_RING_MODULATED,
+		// The master partial output is mixed to the ring modulator output
+		OUTPUT_MODE_RING_MODULATED_MIXED
+	};
+
 	virtual ~LA32PartialPair() {}
 
 	// ringModulated should be set to false for the structures with mixing or stereo output
@@ -221,7 +250,7 @@ public:
 	virtual void initSynth(const PairType master, const bool sawtoothWaveform, const Bit8u pulseWidth, const Bit8u resonance) = 0;
 
 	// Initialise the WG engine for generation of PCM partial samples and set up the invariant parameters
-	virtual void initPCM(const PairType master, const Bit16s * const pcmWaveAddress, const Bit32u pcmWaveLength, const bool pcmWaveLooped) = 0;
+	virtual void initPCM(const PairType master, const PCMWaveEntry &pcmWave) = 0;
 
 	// Deactivate the WG engine
 	virtual void deactivate(const PairType master) = 0;
@@ -233,8 +262,6 @@ class LA32IntPartialPair : public LA32PartialPair {
 	bool ringModulated;
 	bool mixed;
 
-	static Bit16s unlogAndMixWGOutput(const LA32WaveGenerator &wg);
-
 public:
 	// ringModulated should be set to false for the structures with mixing or stereo output
 	// ringModulated should be set to true for the structures with ring modulation
@@ -245,14 +272,22 @@ public:
 	void initSynth(const PairType master, const bool sawtoothWaveform, const Bit8u pulseWidth, const Bit8u resonance);
 
 	// Initialise the WG engine for generation of PCM partial samples and set up the invariant parameters
-	void initPCM(const PairType master, const Bit16s * const pcmWaveAddress, const Bit32u pcmWaveLength, const bool pcmWaveLooped);
+	void initPCM(const PairType master, const PCMWaveEntry &pcmWave);
+
+	// Return the way the WG outputs are combined, which stays the same until the pair is re-initialised
+	OutputMode getOutputMode() const;
+
+	// Update parameters with respect to TVP, TVA and TVF, and generate the requested number of samples of a partial
+	void generateSamples(const PairType master, const Bit32u length, const Bit32u *amps, const Bit16u *pitches, const Bit32u *cutoffs, Bit16s *outputs);
 
-	// Update parameters with respect to TVP, TVA and TVF, and generate next sample
-	void generateNextSample(const PairType master, const Bit32u amp, const Bit16u pitch, const Bit32u cutoff);
+	// Advance a partial through the requested number of samples without generating them
+	void skipSamples(const PairType master, const Bit32u length, const Bit16u *pitches, const Bit32u *cutoffs);
 
-	// Perform mixing / ring modulation of WG output and return the result
+	// Perform mixing / ring modulation of the generated WG outputs, the results replace the master outputs
+	// The output mode must be the one the pair is initialised with; unless withSlave is set, the slave is taken as silent
 	// Although, LA32 applies panning itself, we assume it is applied in the mixer, not within a pair
-	Bit16s nextOutSample();
+	template <OutputMode outputMode, bool withSlave>
+	static void mixOutputs(const Bit32u length, Bit16s *masterOutputs, const Bit16s *slaveOutputs);
 
 	// Deactivate the WG engine
 	void deactivate(const PairType master);
@@ -0,0 +1,270 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#if defined(_POSIX_THREADS) && _POSIX_THREADS > 0
+#define MT32EMU_USE_PTHREADS
+#include <pthread.h>
+#endif
+#endif
+
+#include "internals.h"
+
+#include "LA32Wavetables.h"
+#include "MemoryLock.h"
+#include "mmath.h"
+#include "Tables.h"
+
+namespace MT32Emu {
+
+namespace {
+
+// Guards the shared instance of the tables, the same way as the cache of the shared ROM data is guarded.
+class WavetablesLock {
+public:
+	WavetablesLock() {
+#if defined(_WIN32)
+		EnterCriticalSection(&criticalSection.handle);
+#elif defined(MT32EMU_USE_PTHREADS)
+		pthread_mutex_lock(&mutex);
+#endif
+	}
+
+	~WavetablesLock() {
+#if defined(_WIN32)
+		LeaveCriticalSection(&criticalSection.handle);
+#elif defined(MT32EMU_USE_PTHREADS)
+		pthread_mutex_unlock(&mutex);
+#endif
+	}
+
+private:
+#if defined(_WIN32)
+	static struct CriticalSection {
+		CRITICAL_SECTION handle;
+
+		CriticalSection() {
+			InitializeCriticalSection(&handle);
+		}
+
+		~CriticalSection() {
+			DeleteCriticalSection(&handle);
+		}
+	} criticalSection;
+#elif defined(MT32EMU_USE_PTHREADS)
+	static pthread_mutex_t mutex;
+#endif
+};
+
+#if defined(_WIN32)
+WavetablesLock::CriticalSection WavetablesLock::criticalSection;
+#elif defined(MT32EMU_USE_PTHREADS)
+pthread_mutex_t WavetablesLock::mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+// Number of samples per period the waves are evaluated at before band-limiting, which leaves the aliased harmonics
+// of the smooth waves negligible.
+const Bit32u SOURCE_LENGTH = 4096;
+
+// The edge wave is a function of the wave position in range [0..1) in the same coordinates LA32FloatWaveGenerator uses,
+// i.e. the position 0 is in the middle of the rising cosine segment. The cosine segment length is relative
+// to the wave length.
+// It is a sawtooth with the rising cosine slope, two of them make up the square wave:
+// square(pos) = 2 * (edge(pos) - edge(pos - fallingEdgePos)) + 2 * fallingEdgePos - 1,
+// where fallingEdgePos = cosineLen + hLen is the position in the middle of the falling cosine segment.
+double computeEdgeSample(double wavePos, double cosineLen) {
+	double relWavePos = wavePos + 0.5 * cosineLen;
+	if (relWavePos >= 1.0) {
+		relWavePos -= 1.0;
+	}
+	const double step = relWavePos < cosineLen ? 0.5 * (1.0 - cos(DOUBLE_PI * relWavePos / cosineLen)) : 1.0;
+	return step - relWavePos;
+}
+
+// Computes the discrete Fourier transform of the complex sequence in place, the length is a power of two up to
+// SOURCE_LENGTH. The inverse transform is not normalised. The twiddle factors are taken from the tables of
+// the cosine and sine of SOURCE_LENGTH / 2 angles evenly spaced over the half period.
+void transform(double *re, double *im, Bit32u length, const double *cosines, const double *sines, bool inverse) {
+	for (Bit32u i = 1, j = 0; i < length; i++) {
+		Bit32u bit = length >> 1;
+		for (; (j & bit) != 0; bit >>= 1) {
+			j ^= bit;
+		}
+		j ^= bit;
+		if (i < j) {
+			double t = re[i];
+			re[i] = re[j];
+			re[j] = t;
+			t = im[i];
+			im[i] = im[j];
+			im[j] = t;
+		}
+	}
+	for (Bit32u half = 1; half < length; half <<= 1) {
+		const Bit32u stride = SOURCE_LENGTH / (half << 1);
+		for (Bit32u start = 0; start < length; start += half << 1) {
+			for (Bit32u k = 0; k < half; k++) {
+				const double wr = cosines[k * stride];
+				const double wi = inverse ? sines[k * stride] : -sines[k * stride];
+				const Bit32u a = start + k;
+				const Bit32u b = a + half;
+				const double tr = re[b] * wr - im[b] * wi;
+				const double ti = re[b] * wi + im[b] * wr;
+				re[b] = re[a] - tr;
+				im[b] = im[a] - ti;
+				re[a] += tr;
+				im[a] += ti;
+			}
+		}
+	}
+}
+
+// Keeps the state of the generation of the tables, the waves are sampled into the source buffers beforehand.
+class WavetableGenerator {
+public:
+	double sourceRe[SOURCE_LENGTH];
+	double sourceIm[SOURCE_LENGTH];
+
+	WavetableGenerator() {
+		for (Bit32u i = 0; i < SOURCE_LENGTH / 2; i++) {
+			cosines[i] = cos(DOUBLE_PI * i / (SOURCE_LENGTH / 2));
+			sines[i] = sin(DOUBLE_PI * i / (SOURCE_LENGTH / 2));
+		}
+	}
+
+	// Band-limits the wave sampled in sourceRe and stores the chain of mipmap levels at the table index.
+	void generate(float * const *tables, Bit32u tableIx) {
+		for (Bit32u i = 0; i < SOURCE_LENGTH; i++) {
+			sourceIm[i] = 0.0;
+		}
+		transform(sourceRe, sourceIm, SOURCE_LENGTH, cosines, sines, false);
+		for (Bit32u mipmapLevel = 0; mipmapLevel < LA32Wavetables::MIPMAP_LEVEL_COUNT; mipmapLevel++) {
+			const Bit32u harmonicCount = LA32Wavetables::MAX_HARMONIC_COUNT >> mipmapLevel;
+			const Bit32u tableLength = LA32Wavetables::getTableLength(mipmapLevel);
+			for (Bit32u i = 0; i < tableLength; i++) {
+				re[i] = 0.0;
+				im[i] = 0.0;
+			}
+			re[0] = sourceRe[0] / SOURCE_LENGTH;
+			for (Bit32u i = 1; i <= harmonicCount; i++) {
+				re[i] = sourceRe[i] / SOURCE_LENGTH;
+				im[i] = sourceIm[i] / SOURCE_LENGTH;
+				re[tableLength - i] = re[i];
+				im[tableLength - i] = -im[i];
+			}
+			transform(re, im, tableLength, cosines, sines, true);
+			float *table = tables[mipmapLevel] + tableIx * (tableLength + 1);
+			for (Bit32u i = 0; i < tableLength; i++) {
+				table[i] = float(re[i]);
+			}
+			table[tableLength] = table[0];
+		}
+	}
+
+private:
+	double cosines[SOURCE_LENGTH / 2];
+	double sines[SOURCE_LENGTH / 2];
+	double re[SOURCE_LENGTH];
+	double im[SOURCE_LENGTH];
+};
+
+} // namespace
+
+LA32Wavetables *LA32Wavetables::instance = NULL;
+
+const LA32Wavetables &LA32Wavetables::acquire() {
+	WavetablesLock lock;
+	if (instance == NULL) {
+		instance = new LA32Wavetables;
+	} else {
+		instance->referenceCount++;
+	}
+	return *instance;
+}
+
+void LA32Wavetables::release() const {
+	WavetablesLock lock;
+	if (--referenceCount > 0) return;
+	instance = NULL;
+	delete this;
+}
+
+LA32Wavetables::LA32Wavetables() : referenceCount(1) {
+	for (Bit32u mipmapLevel = 0; mipmapLevel < MIPMAP_LEVEL_COUNT; mipmapLevel++) {
+		const Bit32u tableSize = getTableLength(mipmapLevel) + 1;
+		edgeTables[mipmapLevel] = new float[CUTOFF_LEVEL_COUNT * tableSize];
+	}
+	for (Bit32u i = 0; i <= COSINE_TABLE_LENGTH; i++) {
+		cosineTable[i] = float(cos(2.0 * DOUBLE_PI * i / COSINE_TABLE_LENGTH));
+	}
+
+	for (Bit32u resonanceDecayLevel = 0; resonanceDecayLevel < RESONANCE_DECAY_LEVEL_COUNT; resonanceDecayLevel++) {
+		// See LA32FloatWaveGenerator::generateNextSynthSample(), resAmpDecay.
+		const double resAmpDecayFactor = Tables::getInstance().resAmpDecayFactor[resonanceDecayLevel];
+		for (Bit32u i = 0; i <= RESONANCE_TABLE_LENGTH; i++) {
+			const double position = double(i) / RESONANCE_TABLE_RESOLUTION;
+			const double resSample = sin(DOUBLE_PI * position);
+			resonanceTables[resonanceDecayLevel << 1][i] = float(resSample * pow(2.0, -0.125 * resAmpDecayFactor * position));
+			resonanceTables[(resonanceDecayLevel << 1) | 1][i] = float(resSample * pow(2.0, -0.125 * (resAmpDecayFactor + 0.25) * position));
+		}
+	}
+
+	// The generator is rather large to be kept on stack.
+	WavetableGenerator *generator = new WavetableGenerator;
+	for (Bit32u cutoffLevel = 0; cutoffLevel < CUTOFF_LEVEL_COUNT; cutoffLevel++) {
+		// See LA32FloatWaveGenerator::updateCutoff(), cosineLenFactor, the cosine segment takes a half of the wave
+		// at the middle cutoff value.
+		const double cosineLen = 0.5 * pow(2.0, double(cutoffLevel * CUTOFF_LEVEL_STEP) / -16.0);
+		for (Bit32u i = 0; i < SOURCE_LENGTH; i++) {
+			generator->sourceRe[i] = computeEdgeSample(double(i) / SOURCE_LENGTH, cosineLen);
+		}
+		generator->generate(edgeTables, cutoffLevel);
+	}
+	delete generator;
+}
+
+LA32Wavetables::~LA32Wavetables() {
+	for (Bit32u mipmapLevel = 0; mipmapLevel < MIPMAP_LEVEL_COUNT; mipmapLevel++) {
+		delete[] edgeTables[mipmapLevel];
+	}
+}
+
+size_t LA32Wavetables::getMemoryUsage() const {
+	size_t memoryUsage = sizeof(*this);
+	for (Bit32u mipmapLevel = 0; mipmapLevel < MIPMAP_LEVEL_COUNT; mipmapLevel++) {
+		memoryUsage += CUTOFF_LEVEL_COUNT * (getTableLength(mipmapLevel) + 1) * sizeof(float);
+	}
+	return memoryUsage;
+}
+
+void LA32Wavetables::lockMemory(MemoryLock &memoryLock) const {
+	memoryLock.lockShared(this, sizeof(*this));
+	for (Bit32u mipmapLevel = 0; mipmapLevel < MIPMAP_LEVEL_COUNT; mipmapLevel++) {
+		memoryLock.lockShared(edgeTables[mipmapLevel], CUTOFF_LEVEL_COUNT * (getTableLength(mipmapLevel) + 1) * sizeof(float));
+	}
+}
+
+} // namespace MT32Emu
@@ -0,0 +1,146 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MT32EMU_LA32_WAVETABLES_H
+#define MT32EMU_LA32_WAVETABLES_H
+
+#include <cstddef>
+
+#include "globals.h"
+#include "Types.h"
+
+namespace MT32Emu {
+
+class MemoryLock;
+
+/**
+ * Wavetables the wave generator of RendererType_FLOAT_WAVETABLE looks the synth waves up in, instead of computing
+ * the model of LA32FloatWaveGenerator for each sample.
+ *
+ * The square wave is composed of two edge waves, each one a sawtooth with the cosine slope, which are offset by
+ * the position of the falling edge, so that the tables only depend on the cutoff. The edge waves are sampled over
+ * a single period as functions of the phase and band-limited, each table comes in a chain of mipmap levels that contain
+ * successively fewer harmonics, the level is chosen after the wave length in order to avoid aliasing. The cutoff levels
+ * are sparse, the tables of the adjacent levels are interpolated.
+ *
+ * The resonance sine decays within each segment of the wave at the rate relative to the cosine segment length,
+ * so it is tabulated as a function of the position scaled by the cosine segment length for each decay factor instead.
+ * Interpolating between whole resonance waves of the adjacent cutoff levels would distort the phase of the sine.
+ *
+ * The tables are generated by the first synth that opens with this renderer type and shared among all the synths
+ * in the process afterwards, they are released when the last one is closed.
+ * THREAD SAFETY: acquire() and release() are safe to invoke from several threads concurrently.
+ */
+class LA32Wavetables {
+public:
+	// The cutoff levels are spaced evenly over the range of the cutoff values above the middle one, where the cosine
+	// segment gets shorter as the cutoff value increases.
+	static const Bit32u CUTOFF_LEVEL_COUNT = 57;
+	static const Bit32u CUTOFF_LEVEL_STEP = 2;
+	// The first level contains MAX_HARMONIC_COUNT harmonics, each next one contains half as many.
+	static const Bit32u MIPMAP_LEVEL_COUNT = 9;
+	static const Bit32u MAX_HARMONIC_COUNT = 256;
+	// One level per entry of Tables::resAmpDecayFactor.
+	static const Bit32u RESONANCE_DECAY_LEVEL_COUNT = 8;
+
+	// Adds a reference to the shared tables, generating them unless they exist already.
+	static const LA32Wavetables &acquire();
+	// Drops the reference held by the caller, the tables are deleted when no references remain.
+	void release() const;
+
+	// Returns the mipmap level without harmonics above the Nyquist frequency for the wave length in samples.
+	static Bit32u getMipmapLevel(float waveLen) {
+		Bit32u mipmapLevel = 0;
+		while (mipmapLevel < MIPMAP_LEVEL_COUNT - 1 && float(MAX_HARMONIC_COUNT >> mipmapLevel) > 0.5f * waveLen) mipmapLevel++;
+		return mipmapLevel;
+	}
+
+	// Returns the number of samples per period in the tables of the mipmap level.
+	static Bit32u getTableLength(Bit32u mipmapLevel) {
+		const Bit32u tableLength = (MAX_HARMONIC_COUNT >> mipmapLevel) << 2;
+		return tableLength < MIN_TABLE_LENGTH ? MIN_TABLE_LENGTH : tableLength;
+	}
+
+	// Returns the linearly interpolated sample of the table at the phase in range [0..1].
+	static float lookup(const float *table, Bit32u tableLength, float phase) {
+		float position = phase * float(tableLength);
+		Bit32u ix = Bit32u(position);
+		if (ix >= tableLength) {
+			ix = tableLength - 1;
+			position = float(ix);
+		}
+		const float fraction = position - float(ix);
+		return table[ix] + (table[ix + 1] - table[ix]) * fraction;
+	}
+
+	const float *getEdgeTable(Bit32u cutoffLevel, Bit32u mipmapLevel) const {
+		return edgeTables[mipmapLevel] + cutoffLevel * (getTableLength(mipmapLevel) + 1);
+	}
+
+	// Returns the resonance sine of the unit amp faded after the decay factor at the position in the segment, which is
+	// measured in the cosine segment lengths. The decay is a bit faster in the negative segments.
+	float getResonanceSample(Bit32u resonanceDecayLevel, bool negativeSegment, float position) const {
+		position *= float(RESONANCE_TABLE_RESOLUTION);
+		const Bit32u ix = Bit32u(position);
+		if (ix >= RESONANCE_TABLE_LENGTH) return 0.0f;
+		const float *table = resonanceTables[(resonanceDecayLevel << 1) | (negativeSegment ? 1 : 0)];
+		return table[ix] + (table[ix + 1] - table[ix]) * (position - float(ix));
+	}
+
+	// Returns cos(2 * pi * phase) for the phase in range [0..1].
+	float getCosine(float phase) const {
+		return lookup(cosineTable, COSINE_TABLE_LENGTH, phase);
+	}
+
+	// Returns sin(pi * position) for the position in range [-0.5..0.5].
+	float getSine(float position) const {
+		return getCosine(0.75f + 0.5f * position);
+	}
+
+	// Returns the number of bytes occupied by the tables.
+	size_t getMemoryUsage() const;
+	// Locks the tables as shared memory, since they are shared among the synths.
+	void lockMemory(MemoryLock &memoryLock) const;
+
+private:
+	static const Bit32u MIN_TABLE_LENGTH = 16;
+	static const Bit32u COSINE_TABLE_LENGTH = 1024;
+	// The resonance tables cover 128 cosine segment lengths, the slowest decay fades the sine by 96 dB meanwhile.
+	static const Bit32u RESONANCE_TABLE_RESOLUTION = 16;
+	static const Bit32u RESONANCE_TABLE_LENGTH = 128 * RESONANCE_TABLE_RESOLUTION;
+
+	static LA32Wavetables *instance;
+
+	mutable Bit32u referenceCount;
+
+	// Each edge table is followed by a guard sample that repeats the first one, the resonance tables are followed
+	// by the sample at the end of the covered range.
+	float *edgeTables[MIPMAP_LEVEL_COUNT];
+	float resonanceTables[RESONANCE_DECAY_LEVEL_COUNT << 1][RESONANCE_TABLE_LENGTH + 1];
+	float cosineTable[COSINE_TABLE_LENGTH + 1];
+
+	LA32Wavetables();
+	~LA32Wavetables();
+
+	// Make LA32Wavetables an identity class.
+	LA32Wavetables(const LA32Wavetables &);
+	LA32Wavetables &operator=(const LA32Wavetables &);
+}; // class LA32Wavetables
+
+} // namespace MT32Emu
+
+#endif // #ifndef MT32EMU_LA32_WAVETABLES_H
@@ -0,0 +1,118 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#if defined _POSIX_MAPPED_FILES && _POSIX_MAPPED_FILES > 0
+#include <sys/mman.h>
+#define MT32EMU_MMAP_AVAILABLE 1
+#endif
+#endif
+
+#include "internals.h"
+
+#include "MappedFileStream.h"
+
+namespace MT32Emu {
+
+MappedFileStream::MappedFileStream() : data(NULL), size(0)
+{}
+
+MappedFileStream::~MappedFileStream() {
+	unmap();
+}
+
+size_t MappedFileStream::getSize() {
+	return size;
+}
+
+const Bit8u *MappedFileStream::getData() {
+	return data;
+}
+
+// Empty files cannot be mapped. Those are opened successfully, but no data is available, same as with FileStream.
+bool MappedFileStream::open(const char *filename) {
+	unmap();
+#if defined _WIN32
+	HANDLE fileHandle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (fileHandle == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || ULONGLONG(fileSize.QuadPart) > ULONGLONG(size_t(-1))) {
+		CloseHandle(fileHandle);
+		return false;
+	}
+	if (fileSize.QuadPart == 0) {
+		CloseHandle(fileHandle);
+		return true;
+	}
+	HANDLE mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	// The view keeps the mapping and the file open on its own.
+	CloseHandle(fileHandle);
+	if (mappingHandle == NULL) return false;
+	const void *view = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mappingHandle);
+	if (view == NULL) return false;
+	data = static_cast<const Bit8u *>(view);
+	size = size_t(fileSize.QuadPart);
+	return true;
+#elif defined MT32EMU_MMAP_AVAILABLE
+	int fd = ::open(filename, O_RDONLY);
+	if (fd == -1) return false;
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode)) {
+		::close(fd);
+		return false;
+	}
+	if (fileStat.st_size == 0) {
+		::close(fd);
+		return true;
+	}
+	void *mapping = mmap(NULL, size_t(fileStat.st_size), PROT_READ, MAP_SHARED, fd, 0);
+	// The mapping remains valid after closing the file descriptor.
+	::close(fd);
+	if (mapping == MAP_FAILED) return false;
+	data = static_cast<const Bit8u *>(mapping);
+	size = size_t(fileStat.st_size);
+	return true;
+#else
+	(void)filename;
+	return false;
+#endif
+}
+
+// The file is closed as soon as it gets mapped, so there is nothing to do here.
+void MappedFileStream::close() {}
+
+void MappedFileStream::unmap() {
+	if (data == NULL) return;
+#if defined _WIN32
+	UnmapViewOfFile(data);
+#elif defined MT32EMU_MMAP_AVAILABLE
+	munmap(const_cast<Bit8u *>(data), size);
+#endif
+	data = NULL;
+	size = 0;
+}
+
+} // namespace MT32Emu
@@ -0,0 +1,51 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MT32EMU_MAPPED_FILE_STREAM_H
+#define MT32EMU_MAPPED_FILE_STREAM_H
+
+#include "globals.h"
+#include "Types.h"
+#include "File.h"
+
+namespace MT32Emu {
+
+// A File that maps the content of a file on disk into memory rather than reading it into a private buffer.
+// The mapping is read-only, so that the pages are shared via the OS page cache among all the processes that
+// open the same file. Unlike FileStream, the file data is available right after a successful call to open().
+// The mapping stays valid after close() and is only released when the object is destroyed or opens another file.
+// The file must not be truncated while mapped, as accessing the data beyond its new end results in a crash.
+// On platforms that don't support memory-mapped files, open() always fails, FileStream may be used instead.
+class MappedFileStream : public AbstractFile {
+public:
+	MT32EMU_EXPORT_V(2.5) MappedFileStream();
+	MT32EMU_EXPORT_V(2.5) ~MappedFileStream();
+	MT32EMU_EXPORT_V(2.5) size_t getSize();
+	MT32EMU_EXPORT_V(2.5) const Bit8u *getData();
+	MT32EMU_EXPORT_V(2.5) bool open(const char *filename);
+	MT32EMU_EXPORT_V(2.5) void close();
+
+private:
+	const Bit8u *data;
+	size_t size;
+
+	void unmap();
+};
+
+} // namespace MT32Emu
+
+#endif // #ifndef MT32EMU_MAPPED_FILE_STREAM_H
@@ -0,0 +1,165 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#if defined(_POSIX_MEMLOCK_RANGE) && _POSIX_MEMLOCK_RANGE > 0
+#define MT32EMU_USE_MLOCK
+#include <sys/mman.h>
+#endif
+#if defined(__linux__)
+#include <sys/syscall.h>
+#if defined(SYS_mbind)
+#define MT32EMU_USE_MBIND
+#endif
+#endif
+#endif
+
+#include "internals.h"
+
+#include "MemoryLock.h"
+
+namespace MT32Emu {
+
+namespace {
+
+#ifdef MADV_HUGEPAGE
+// The size of the huge pages on the common platforms, the transparent huge pages are only used for aligned blocks of this size.
+const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+#endif
+const Bit32u INITIAL_RANGES_CAPACITY = 32;
+
+#ifdef MT32EMU_USE_MBIND
+// The values from linux/mempolicy.h, the header isn't necessarily installed, and libnuma is not required this way.
+const int MPOL_PREFERRED_MODE = 1;
+const unsigned int MPOL_MF_MOVE_FLAG = 1 << 1;
+const Bit32s MAX_NUMA_NODES = 1024;
+const size_t NODE_MASK_BITS = 8 * sizeof(unsigned long);
+#endif
+
+size_t getPageSize() {
+#if defined(_WIN32)
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	return systemInfo.dwPageSize;
+#elif defined(MT32EMU_USE_MLOCK)
+	long pageSize = sysconf(_SC_PAGESIZE);
+	return pageSize > 0 ? size_t(pageSize) : 4096;
+#else
+	return 4096;
+#endif
+}
+
+} // namespace
+
+MemoryLock::MemoryLock(bool useLocking, Bit32s useNUMANode) :
+	pageSize(getPageSize()), locking(useLocking), numaNode(useNUMANode), ranges(new Range[INITIAL_RANGES_CAPACITY]), rangeCount(0), rangesCapacity(INITIAL_RANGES_CAPACITY),
+	lockedSize(0), complete(true)
+{}
+
+MemoryLock::~MemoryLock() {
+	for (Bit32u i = 0; i < rangeCount; i++) {
+#if defined(_WIN32)
+		VirtualUnlock(ranges[i].start, ranges[i].size);
+#elif defined(MT32EMU_USE_MLOCK)
+		munlock(ranges[i].start, ranges[i].size);
+#endif
+	}
+	delete[] ranges;
+}
+
+void MemoryLock::lock(const void *address, size_t size) {
+	Range range;
+	if (!lockPages(address, size, true, range)) return;
+	if (rangeCount == rangesCapacity) {
+		Range *newRanges = new Range[2 * rangesCapacity];
+		memcpy(newRanges, ranges, rangeCount * sizeof(Range));
+		delete[] ranges;
+		ranges = newRanges;
+		rangesCapacity *= 2;
+	}
+	ranges[rangeCount++] = range;
+}
+
+void MemoryLock::lockShared(const void *address, size_t size) {
+	Range range;
+	lockPages(address, size, false, range);
+}
+
+size_t MemoryLock::getLockedSize() const {
+	return lockedSize;
+}
+
+bool MemoryLock::isComplete() const {
+	return complete;
+}
+
+bool MemoryLock::lockPages(const void *address, size_t size, bool binding, Range &range) {
+	if (address == NULL || size == 0) return false;
+	const size_t startAddress = reinterpret_cast<size_t>(address) & ~(pageSize - 1);
+	const size_t endAddress = (reinterpret_cast<size_t>(address) + size + pageSize - 1) & ~(pageSize - 1);
+	range.start = reinterpret_cast<void *>(startAddress);
+	range.size = endAddress - startAddress;
+	if (binding) bindPages(range);
+	// Only the locked ranges are kept track of, there is nothing to undo otherwise.
+	if (!locking) return false;
+#if defined(_WIN32)
+	bool locked = VirtualLock(range.start, range.size) != FALSE;
+#elif defined(MT32EMU_USE_MLOCK)
+#ifdef MADV_HUGEPAGE
+	const size_t hugePagesStart = (startAddress + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+	const size_t hugePagesEnd = endAddress & ~(HUGE_PAGE_SIZE - 1);
+	if (hugePagesStart < hugePagesEnd) {
+		madvise(reinterpret_cast<void *>(hugePagesStart), hugePagesEnd - hugePagesStart, MADV_HUGEPAGE);
+	}
+#endif
+	bool locked = mlock(range.start, range.size) == 0;
+#else
+	bool locked = false;
+#endif
+	if (!locked) {
+		complete = false;
+		return false;
+	}
+	lockedSize += range.size;
+	return true;
+}
+
+// The node is preferred rather than enforced, so that the allocations still succeed when the node runs out of memory.
+void MemoryLock::bindPages(const Range &range) const {
+#ifdef MT32EMU_USE_MBIND
+	if (numaNode < 0 || numaNode >= MAX_NUMA_NODES) return;
+	unsigned long nodeMask[MAX_NUMA_NODES / NODE_MASK_BITS];
+	memset(nodeMask, 0, sizeof(nodeMask));
+	nodeMask[size_t(numaNode) / NODE_MASK_BITS] = 1UL << (size_t(numaNode) % NODE_MASK_BITS);
+	// The kernel expects the number of the mask bits plus one.
+	const unsigned long maxNode = MAX_NUMA_NODES + 1;
+	syscall(SYS_mbind, range.start, range.size, MPOL_PREFERRED_MODE, nodeMask, maxNode, MPOL_MF_MOVE_FLAG);
+#else
+	(void)range;
+#endif
+}
+
+} // namespace MT32Emu
@@ -0,0 +1,85 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MT32EMU_MEMORY_LOCK_H
+#define MT32EMU_MEMORY_LOCK_H
+
+#include <cstddef>
+
+#include "globals.h"
+#include "Types.h"
+
+namespace MT32Emu {
+
+/**
+ * Keeps the memory ranges that make up the working set of a synth resident in physical memory, so that rendering
+ * never faults on a page that has been swapped out or not yet touched. Locking a range also faults it in.
+ * The ranges are extended to the page boundaries, and the ranges that span an entire huge page are also advised
+ * to be backed by huge pages where the system supports transparent huge pages.
+ * The ranges locked as owned are unlocked upon destruction, which must happen before the memory is released.
+ * The shared ranges remain locked, since the system doesn't count the locks, and unlocking them would also unlock
+ * the pages locked by the other synths. They are allocated in large blocks, which are returned to the system
+ * when released, that unlocks them.
+ * Locking is subject to the limits the system imposes on the amount of locked memory. Failures are not fatal,
+ * the affected ranges merely remain pageable.
+ * When a NUMA node is specified, the owned ranges are also bound to the node, and the pages already allocated elsewhere
+ * are migrated there, so that a synth rendering on the CPUs of the node only accesses local memory. The pages mapped
+ * by other processes are left in place. The shared ranges are neither bound nor migrated, since the synths sharing
+ * them may be placed on different nodes, and each would otherwise pull the pages over to its own node as it opens.
+ * Placement is only supported on Linux, it is merely skipped elsewhere and whenever the system refuses it. Binding
+ * is done regardless of locking, which may be disabled.
+ */
+class MemoryLock {
+public:
+	// The NUMA node is ignored if negative.
+	MemoryLock(bool locking, Bit32s numaNode);
+	~MemoryLock();
+
+	void lock(const void *address, size_t size);
+	void lockShared(const void *address, size_t size);
+
+	// Returns the number of bytes locked so far, including the shared ranges.
+	size_t getLockedSize() const;
+	// Returns false if the system refused to lock any of the ranges.
+	bool isComplete() const;
+
+private:
+	struct Range {
+		void *start;
+		size_t size;
+	};
+
+	const size_t pageSize;
+	const bool locking;
+	const Bit32s numaNode;
+	Range *ranges;
+	Bit32u rangeCount;
+	Bit32u rangesCapacity;
+	size_t lockedSize;
+	bool complete;
+
+	bool lockPages(const void *address, size_t size, bool binding, Range &range);
+	void bindPages(const Range &range) const;
+
+	// Make MemoryLock an identity class.
+	MemoryLock(const MemoryLock &);
+	MemoryLock &operator=(const MemoryLock &);
+}; // class MemoryLock
+
+} // namespace MT32Emu
+
+#endif // #ifndef MT32EMU_MEMORY_LOCK_H
@@ -18,11 +18,16 @@
 #ifndef MT32EMU_MIDI_EVENT_QUEUE_H
 #define MT32EMU_MIDI_EVENT_QUEUE_H
 
+#include <cstddef>
+
 #include "globals.h"
 #include "Types.h"
 
 namespace MT32Emu {
 
+class MemoryLock;
+struct MIDIEventQueueStats;
+
 /**
  * Simple queue implementation using a ring buffer to store incoming MIDI event before the synth actually processes it.
  * It is intended to:
@@ -32,10 +37,15 @@ namespace MT32Emu {
  * THREAD SAFETY:
  * It is safe to use either in a single thread environment or when there are only two threads - one performs only reading
  * and one performs only writing. More complicated usage requires external synchronisation.
+ * GROWTH:
+ * When allowed, the writer replaces a full ring buffer with one twice as big rather than failing. The old ring buffer
+ * remains in use until the reader drains it and switches to the successor. Memory is only allocated and released
+ * by the writer, so the reader never does either.
  */
 class MidiEventQueue {
 public:
 	class SysexDataStorage;
+	struct RingBuffer;
 
 	struct MidiEvent {
 		const Bit8u *sysexData;
@@ -49,23 +59,73 @@ public:
 	explicit MidiEventQueue(
 		// Must be a power of 2
 		Bit32u ringBufferSize,
-		Bit32u storageBufferSize
+		Bit32u storageBufferSize,
+		// Must be a power of 2, the ring buffer never grows when it isn't greater than ringBufferSize
+		Bit32u maxRingBufferSize = 0
 	);
 	~MidiEventQueue();
 	void reset();
+	// Replaces the full ring buffer with a bigger one unless it has reached the maximum size already.
+	// Returns true if there is more free space then.
+	bool grow();
+	void setMaxRingBufferSize(Bit32u maxRingBufferSize);
+	// Accounts an event that didn't fit in the queue, which is up to the writer to report.
+	void registerOverflow();
+	// The statistics are maintained by the writer, thus the methods are only safe to invoke on the writer side.
+	void getStats(MIDIEventQueueStats &stats) const;
+	void resetStats();
+	// Returns the number of bytes occupied by the ring buffers in use and the SysEx data they retain.
+	// Like the statistics, only safe to invoke on the writer side.
+	size_t getMemoryUsage() const;
+	// Locks the memory of the queue, see MemoryLock.
+	void lockMemory(MemoryLock &memoryLock) const;
 	bool pushShortMessage(Bit32u shortMessageData, Bit32u timestamp);
 	bool pushSysex(const Bit8u *sysexData, Bit32u sysexLength, Bit32u timestamp);
+	// Returns the number of events that can be enqueued before the ring buffer becomes full.
+	Bit32u getFreeSpace() const;
+	// Store events in the free slots past the end of the queue, batchIx must be less than getFreeSpace().
+	// The stored events are invisible to the reader until commitBatch() makes them all available at once.
+	void storeShortMessage(Bit32u batchIx, Bit32u shortMessageData, Bit32u timestamp);
+	bool storeSysex(Bit32u batchIx, const Bit8u *sysexData, Bit32u sysexLength, Bit32u timestamp);
+	void commitBatch(Bit32u batchSize);
+	// Allocates storage for a SysEx message of up to maxSysexLength bytes along with a slot for the event.
+	// The message data is to be written in place prior to calling pushReservedSysex().
+	Bit8u *reserveSysex(Bit32u maxSysexLength);
+	// Enqueues the reserved SysEx message trimmed to sysexLength bytes, or cancels the reservation when sysexLength is 0.
+	bool pushReservedSysex(Bit32u sysexLength, Bit32u timestamp);
+	bool hasReservedSysex() const;
 	const volatile MidiEvent *peekMidiEvent();
 	void dropMidiEvent();
-	inline bool isEmpty() const;
+	bool isEmpty();
 
 private:
 	SysexDataStorage &sysexDataStorage;
 
-	MidiEvent * const ringBuffer;
-	const Bit32u ringBufferMask;
-	volatile Bit32u startPosition;
-	volatile Bit32u endPosition;
+	// The reader consumes the events from the oldest ring buffer still in use, whereas the writer stores them
+	// to the newest one. The ring buffers in between are linked as the successors.
+	RingBuffer * volatile readRingBuffer;
+	// Only accessed by the writer.
+	RingBuffer *writeRingBuffer;
+	// The oldest ring buffer not yet released. Only accessed by the writer.
+	RingBuffer *retainedRingBuffer;
+	Bit32u maxRingBufferSize;
+	bool sysexReserved;
+
+	// The pending events and SysEx data are counted by both sides, so that each counter has a single writer.
+	Bit32u pushedEventCount;
+	volatile Bit32u droppedEventCount;
+	Bit32u storedSysexLength;
+	volatile Bit32u reclaimedSysexLength;
+	// Statistics, only accessed by the writer.
+	Bit32u maxPendingEventCount;
+	Bit32u maxSysexStorageUsage;
+	Bit32u overflowCount;
+	Bit32u growCount;
+
+	void releaseRetiredRingBuffers();
+	void releaseRingBuffer(RingBuffer *ringBuffer);
+	void updatePendingEventCount(Bit32u newEventCount);
+	void updateSysexStorageUsage(Bit32u newSysexLength);
 };
 
 } // namespace MT32Emu
@@ -18,13 +18,192 @@
 #include <cstdio>
 #include <cstring>
 
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#if defined(_POSIX_THREADS) && _POSIX_THREADS > 0
+#define MT32EMU_USE_PTHREADS
+#include <pthread.h>
+#endif
+#endif
+
 #include "internals.h"
 
 #include "MidiStreamParser.h"
 #include "Synth.h"
 
+// SSE2 and NEON are baseline on x86-64 and AArch64 respectively, so no runtime dispatch is needed here.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MT32EMU_PARSER_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define MT32EMU_PARSER_NEON
+#include <arm_neon.h>
+#endif
+
 using namespace MT32Emu;
 
+namespace {
+
+// Guards the pool of the stream buffers, the same way as the cache of the shared ROM data is guarded.
+class StreamBufferPoolLock {
+public:
+	StreamBufferPoolLock() {
+#if defined(_WIN32)
+		EnterCriticalSection(&criticalSection.handle);
+#elif defined(MT32EMU_USE_PTHREADS)
+		pthread_mutex_lock(&mutex);
+#endif
+	}
+
+	~StreamBufferPoolLock() {
+#if defined(_WIN32)
+		LeaveCriticalSection(&criticalSection.handle);
+#elif defined(MT32EMU_USE_PTHREADS)
+		pthread_mutex_unlock(&mutex);
+#endif
+	}
+
+private:
+#if defined(_WIN32)
+	static struct CriticalSection {
+		CRITICAL_SECTION handle;
+
+		CriticalSection() {
+			InitializeCriticalSection(&handle);
+		}
+
+		~CriticalSection() {
+			DeleteCriticalSection(&handle);
+		}
+	} criticalSection;
+#elif defined(MT32EMU_USE_PTHREADS)
+	static pthread_mutex_t mutex;
+#endif
+};
+
+#if defined(_WIN32)
+StreamBufferPoolLock::CriticalSection StreamBufferPoolLock::criticalSection;
+#elif defined(MT32EMU_USE_PTHREADS)
+pthread_mutex_t StreamBufferPoolLock::mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+// Keeps the stream buffers released by the parsers for reuse by all the parsers in the process. The MIDI sessions come
+// and go along with their parsers, and each parser grows its buffer once to fit a long SysEx, e.g. a timbre upload.
+// Once the pool is warm, the buffers are taken from it rather than allocated on the MIDI input thread.
+// The capacities are rounded up to size classes of powers of two from MIN_BUFFER_CAPACITY up to MAX_STREAM_BUFFER_SIZE,
+// the free buffers of each size class are chained into a list through their first bytes.
+class StreamBufferPool {
+public:
+	static Bit32u getBufferCapacity(Bit32u requestedCapacity) {
+		return getSizeClassCapacity(getSizeClassIx(requestedCapacity));
+	}
+
+	// The capacity must be one returned by getBufferCapacity().
+	static Bit8u *allocate(Bit32u capacity) {
+		{
+			StreamBufferPoolLock lock;
+			SizeClass &sizeClass = instance.sizeClasses[getSizeClassIx(capacity)];
+			Bit8u *buffer = sizeClass.freeList;
+			if (buffer != NULL) {
+				memcpy(&sizeClass.freeList, buffer, sizeof(Bit8u *));
+				sizeClass.freeCount--;
+				return buffer;
+			}
+		}
+		return new Bit8u[capacity];
+	}
+
+	static void release(Bit8u *buffer, Bit32u capacity) {
+		{
+			StreamBufferPoolLock lock;
+			SizeClass &sizeClass = instance.sizeClasses[getSizeClassIx(capacity)];
+			if (sizeClass.freeCount < MAX_FREE_BUFFER_COUNT) {
+				memcpy(buffer, &sizeClass.freeList, sizeof(Bit8u *));
+				sizeClass.freeList = buffer;
+				sizeClass.freeCount++;
+				return;
+			}
+		}
+		delete[] buffer;
+	}
+
+private:
+	static const Bit32u MIN_BUFFER_CAPACITY = 1024;
+	static const Bit32u MAX_SIZE_CLASS_COUNT = 24;
+	// Bounds the memory retained in each size class, that many parsers may grow the buffers concurrently without allocations.
+	static const Bit32u MAX_FREE_BUFFER_COUNT = 16;
+
+	struct SizeClass {
+		Bit8u *freeList;
+		Bit32u freeCount;
+	};
+
+	static StreamBufferPool instance;
+
+	SizeClass sizeClasses[MAX_SIZE_CLASS_COUNT];
+
+	static Bit32u getSizeClassIx(Bit32u capacity) {
+		Bit32u sizeClassIx = 0;
+		while (getSizeClassCapacity(sizeClassIx) < capacity && sizeClassIx < MAX_SIZE_CLASS_COUNT - 1) sizeClassIx++;
+		return sizeClassIx;
+	}
+
+	static Bit32u getSizeClassCapacity(Bit32u sizeClassIx) {
+		if (MAX_STREAM_BUFFER_SIZE >> sizeClassIx <= MIN_BUFFER_CAPACITY) return MAX_STREAM_BUFFER_SIZE;
+		return MIN_BUFFER_CAPACITY << sizeClassIx;
+	}
+
+	StreamBufferPool() {
+		for (Bit32u i = 0; i < MAX_SIZE_CLASS_COUNT; i++) {
+			sizeClasses[i].freeList = NULL;
+			sizeClasses[i].freeCount = 0;
+		}
+	}
+
+	~StreamBufferPool() {
+		StreamBufferPoolLock lock;
+		for (Bit32u i = 0; i < MAX_SIZE_CLASS_COUNT; i++) {
+			while (sizeClasses[i].freeList != NULL) {
+				Bit8u *buffer = sizeClasses[i].freeList;
+				memcpy(&sizeClasses[i].freeList, buffer, sizeof(Bit8u *));
+				delete[] buffer;
+			}
+			sizeClasses[i].freeCount = 0;
+		}
+	}
+};
+
+StreamBufferPool StreamBufferPool::instance;
+
+} // namespace
+
+// Returns the position of the first byte with the most significant bit set, i.e. a status byte, in range [pos..length),
+// or length if there is none. The long runs of data bytes within SysEx messages are skipped a vector at a time.
+static Bit32u findStatusByte(const Bit8u stream[], Bit32u pos, const Bit32u length) {
+#if defined(MT32EMU_PARSER_SSE2)
+	for (; pos + 16 <= length; pos += 16) {
+		if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(stream + pos))) != 0) break;
+	}
+#elif defined(MT32EMU_PARSER_NEON)
+	for (; pos + 16 <= length; pos += 16) {
+		if (vmaxvq_u8(vld1q_u8(stream + pos)) >= 0x80) break;
+	}
+#else
+	for (; pos + 4 <= length; pos += 4) {
+		Bit32u word;
+		memcpy(&word, stream + pos, 4);
+		if ((word & 0x80808080U) != 0) break;
+	}
+#endif
+	while (pos < length && stream[pos] < 0x80) ++pos;
+	return pos;
+}
+
 DefaultMidiStreamParser::DefaultMidiStreamParser(Synth &useSynth, Bit32u initialStreamBufferCapacity) :
 	MidiStreamParser(initialStreamBufferCapacity), synth(useSynth), timestampSet(false) {}
 
@@ -75,8 +254,8 @@ MidiStreamParserImpl::MidiStreamParserImpl(MidiReceiver &useReceiver, MidiReport
 {
 	if (initialStreamBufferCapacity < SYSEX_BUFFER_SIZE) initialStreamBufferCapacity = SYSEX_BUFFER_SIZE;
 	if (MAX_STREAM_BUFFER_SIZE < initialStreamBufferCapacity) initialStreamBufferCapacity = MAX_STREAM_BUFFER_SIZE;
-	streamBufferCapacity = initialStreamBufferCapacity;
-	streamBuffer = new Bit8u[streamBufferCapacity];
+	streamBufferCapacity = StreamBufferPool::getBufferCapacity(initialStreamBufferCapacity);
+	streamBuffer = StreamBufferPool::allocate(streamBufferCapacity);
 	streamBufferSize = 0;
 	runningStatus = 0;
 
@@ -84,7 +263,7 @@ MidiStreamParserImpl::MidiStreamParserImpl(MidiReceiver &useReceiver, MidiReport
 }
 
 MidiStreamParserImpl::~MidiStreamParserImpl() {
-	delete[] streamBuffer;
+	StreamBufferPool::release(streamBuffer, streamBufferCapacity);
 }
 
 void MidiStreamParserImpl::parseStream(const Bit8u *stream, Bit32u length) {
@@ -135,10 +314,11 @@ bool MidiStreamParserImpl::checkStreamBufferCapacity(const bool preserveContent)
 	if (streamBufferSize < streamBufferCapacity) return true;
 	if (streamBufferCapacity < MAX_STREAM_BUFFER_SIZE) {
 		Bit8u *oldStreamBuffer = streamBuffer;
-		streamBufferCapacity = MAX_STREAM_BUFFER_SIZE;
-		streamBuffer = new Bit8u[streamBufferCapacity];
+		const Bit32u oldStreamBufferCapacity = streamBufferCapacity;
+		streamBufferCapacity = StreamBufferPool::getBufferCapacity(MAX_STREAM_BUFFER_SIZE);
+		streamBuffer = StreamBufferPool::allocate(streamBufferCapacity);
 		if (preserveContent) memcpy(streamBuffer, oldStreamBuffer, streamBufferSize);
-		delete[] oldStreamBuffer;
+		StreamBufferPool::release(oldStreamBuffer, oldStreamBufferCapacity);
 		return true;
 	}
 	return false;
@@ -216,26 +396,22 @@ Bit32u MidiStreamParserImpl::parseShortMessageDataBytes(const Bit8u stream[], Bi
 // Returns # of bytes parsed
 Bit32u MidiStreamParserImpl::parseSysex(const Bit8u stream[], const Bit32u length) {
 	// Find SysEx length
-	Bit32u sysexLength = 1;
-	while (sysexLength < length) {
-		Bit8u nextByte = stream[sysexLength++];
-		if (0x80 <= nextByte) {
-			if (nextByte == 0xF7) {
-				// End of SysEx
-				midiReceiver.handleSysex(stream, sysexLength);
-				return sysexLength;
-			}
-			if (0xF8 <= nextByte) {
-				// The System Realtime message must be processed right after return
-				// but the SysEx is actually fragmented and to be reconstructed in streamBuffer
-				--sysexLength;
-				break;
-			}
+	Bit32u sysexLength = findStatusByte(stream, 1, length);
+	if (sysexLength < length) {
+		Bit8u nextByte = stream[sysexLength];
+		if (nextByte == 0xF7) {
+			// End of SysEx, the complete message is handed over right from the input stream
+			midiReceiver.handleSysex(stream, ++sysexLength);
+			return sysexLength;
+		}
+		if (nextByte < 0xF8) {
 			// Illegal status byte in SysEx message, aborting
 			midiReporter.printDebug("parseSysex: SysEx message lacks end-of-sysex (0xf7), ignored");
 			// Continue parsing from that point
-			return sysexLength - 1;
+			return sysexLength;
 		}
+		// The System Realtime message must be processed right after return
+		// but the SysEx is actually fragmented and to be reconstructed in streamBuffer
 	}
 
 	// Store incomplete SysEx message for further processing
@@ -254,12 +430,18 @@ Bit32u MidiStreamParserImpl::parseSysex(const Bit8u stream[], const Bit32u lengt
 Bit32u MidiStreamParserImpl::parseSysexFragment(const Bit8u stream[], const Bit32u length) {
 	Bit32u parsedLength = 0;
 	while (parsedLength < length) {
-		Bit8u nextByte = stream[parsedLength++];
-		if (nextByte < 0x80) {
-			// Add SysEx data byte to streamBuffer
-			if (checkStreamBufferCapacity(true)) streamBuffer[streamBufferSize++] = nextByte;
-			continue;
+		// Add SysEx data bytes to streamBuffer, those that don't fit are dropped
+		const Bit32u dataEnd = findStatusByte(stream, parsedLength, length);
+		while (parsedLength < dataEnd && checkStreamBufferCapacity(true)) {
+			Bit32u copyLength = streamBufferCapacity - streamBufferSize;
+			if (dataEnd - parsedLength < copyLength) copyLength = dataEnd - parsedLength;
+			memcpy(streamBuffer + streamBufferSize, stream + parsedLength, copyLength);
+			streamBufferSize += copyLength;
+			parsedLength += copyLength;
 		}
+		parsedLength = dataEnd;
+		if (parsedLength == length) break;
+		Bit8u nextByte = stream[parsedLength++];
 		if (0xF8 <= nextByte) {
 			// Bypass System Realtime message
 			midiReceiver.handleSystemRealtimeMessage(nextByte);
@@ -61,6 +61,8 @@ public:
 	// The third argument specifies streamBuffer initial capacity. The buffer capacity should be large enough to fit the longest SysEx expected.
 	// If a longer SysEx occurs, streamBuffer is reallocated to the maximum size of MAX_STREAM_BUFFER_SIZE (32768 bytes).
 	// Default capacity is SYSEX_BUFFER_SIZE (1000 bytes) which is enough to fit SysEx messages in common use.
+	// The buffers are taken from a pool shared by all the parsers in the process and returned there when no longer used,
+	// so the capacity is rounded up to the nearest size class of the pool.
 	MidiStreamParserImpl(MidiReceiver &, MidiReporter &, Bit32u initialStreamBufferCapacity = SYSEX_BUFFER_SIZE);
 	virtual ~MidiStreamParserImpl();
 
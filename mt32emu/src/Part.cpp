@@ -24,7 +24,12 @@
 #include "Partial.h"
 #include "PartialManager.h"
 #include "Poly.h"
+#include "RhythmHitCache.h"
 #include "Synth.h"
+#include "TraceSpan.h"
+#include "TVA.h"
+#include "TVF.h"
+#include "TVP.h"
 
 namespace MT32Emu {
 
@@ -63,14 +68,15 @@ Part::Part(Synth *useSynth, unsigned int usePartNum) {
 	expression = 100;
 	pitchBend = 0;
 	activePartialCount = 0;
+	releasingPartialCount = 0;
 	memset(patchCache, 0, sizeof(patchCache));
+	memset(firstPolyWithKey, 0, sizeof(firstPolyWithKey));
+	memset(lastPolyWithKey, 0, sizeof(lastPolyWithKey));
+	memset(polyCountByState, 0, sizeof(polyCountByState));
 }
 
-Part::~Part() {
-	while (!activePolys.isEmpty()) {
-		delete activePolys.takeFirst();
-	}
-}
+// The active polys are owned by the PartialManager, which may have been disposed of already.
+Part::~Part() {}
 
 void Part::setDataEntryMSB(unsigned char midiDataEntryMSB) {
 	if (nrpn) {
@@ -141,8 +147,20 @@ void Part::reset() {
 }
 
 void RhythmPart::refresh() {
-	// (Re-)cache all the mapped timbres ahead of time
-	for (unsigned int drumNum = 0; drumNum < synth->controlROMMap->rhythmSettingsCount; drumNum++) {
+	refreshDrums(0, synth->controlROMMap->rhythmSettingsCount - 1);
+	updatePitchBenderRange();
+}
+
+void RhythmPart::refreshDrums(unsigned int firstDrum, unsigned int lastDrum) {
+	// The timbres are (re-)cached lazily, when the drums are played next
+	if (lastDrum >= synth->controlROMMap->rhythmSettingsCount) {
+		lastDrum = synth->controlROMMap->rhythmSettingsCount - 1;
+	}
+	RhythmHitCache *rhythmHitCache = synth->getRhythmHitCache();
+	if (rhythmHitCache != NULL) {
+		rhythmHitCache->invalidateDrums(firstDrum, lastDrum);
+	}
+	for (unsigned int drumNum = firstDrum; drumNum <= lastDrum; drumNum++) {
 		int drumTimbreNum = rhythmTemp[drumNum].timbre;
 		if (drumTimbreNum >= 127) { // 94 on MT-32
 			continue;
@@ -155,7 +173,6 @@ void RhythmPart::refresh() {
 			cache[t].reverb = rhythmTemp[drumNum].reverbSwitch > 0;
 		}
 	}
-	updatePitchBenderRange();
 }
 
 void Part::refresh() {
@@ -175,9 +192,13 @@ const char *Part::getCurrentInstr() const {
 }
 
 void RhythmPart::refreshTimbre(unsigned int absTimbreNum) {
+	RhythmHitCache *rhythmHitCache = synth->getRhythmHitCache();
 	for (int m = 0; m < 85; m++) {
 		if (rhythmTemp[m].timbre == absTimbreNum - 128) {
 			drumCache[m][0].dirty = true;
+			if (rhythmHitCache != NULL) {
+				rhythmHitCache->invalidateDrums(m, m);
+			}
 		}
 	}
 }
@@ -222,8 +243,17 @@ void Part::setProgram(unsigned int patchNum) {
 	setPatch(&synth->mt32ram.patches[patchNum]);
 	holdpedal = false;
 	allSoundOff();
-	setTimbre(&synth->mt32ram.timbres[getAbsTimbreNum()].timbre);
-	refresh();
+	TimbreParam *timbre = &synth->mt32ram.timbres[getAbsTimbreNum()].timbre;
+	// Streams of program changes tend to reselect the timbre in use. As long as the timbre stays intact,
+	// the cached timbre remains valid, and neither the partials still playing need to back it up.
+	bool reverb = patchTemp->patch.reverbSwitch > 0;
+	if (patchCache[0].dirty || patchCache[0].reverb != reverb || memcmp(timbreTemp, timbre, sizeof(TimbreParam)) != 0) {
+		setTimbre(timbre);
+		refresh();
+		return;
+	}
+	synth->newTimbreSet(partNum, patchTemp->patch.timbreGroup, patchTemp->patch.timbreNum, currentInstr);
+	updatePitchBenderRange();
 }
 
 void Part::updatePitchBenderRange() {
@@ -255,7 +285,6 @@ void Part::cacheTimbre(PatchCache cache[4], const TimbreParam *timbre) {
 		// Calculate and cache common parameters
 		cache[t].srcPartial = timbre->partial[t];
 
-		cache[t].pcm = timbre->partial[t].wg.pcmWave;
 
 		switch (t) {
 		case 0:
@@ -289,6 +318,22 @@ void Part::cacheTimbre(PatchCache cache[4], const TimbreParam *timbre) {
 		cache[t].partialParam = &timbre->partial[t];
 
 		cache[t].waveform = timbre->partial[t].wg.waveform;
+
+		cache[t].pcm = timbre->partial[t].wg.pcmWave;
+		const ControlROMPCMStruct *controlROMPCMStruct = NULL;
+		if (cache[t].PCMPartial) {
+			if (synth->controlROMMap->pcmCount > 128) {
+				// CM-32L, etc. support two "banks" of PCMs, selectable by waveform type parameter.
+				if (cache[t].waveform > 1) {
+					cache[t].pcm += 128;
+				}
+			}
+			controlROMPCMStruct = synth->pcmWaves[cache[t].pcm].controlROMPCMStruct;
+		}
+
+		TVA::cachePartialParams(cache[t]);
+		TVF::cachePartialParams(cache[t]);
+		TVP::cachePartialParams(cache[t], controlROMPCMStruct);
 	}
 	for (int t = 0; t < 4; t++) {
 		// Common parameters, stored redundantly
@@ -431,15 +476,14 @@ void Part::noteOn(unsigned int midiKey, unsigned int velocity) {
 }
 
 bool Part::abortFirstPoly(unsigned int key) {
-	for (Poly *poly = activePolys.getFirst(); poly != NULL; poly = poly->getNext()) {
-		if (poly->getKey() == key) {
-			return poly->startAbort();
-		}
-	}
-	return false;
+	Poly *poly = firstPolyWithKey[key];
+	return poly != NULL && poly->startAbort();
 }
 
 bool Part::abortFirstPoly(PolyState polyState) {
+	if (polyCountByState[polyState] == 0) {
+		return false;
+	}
 	for (Poly *poly = activePolys.getFirst(); poly != NULL; poly = poly->getNext()) {
 		if (poly->getState() == polyState) {
 			return poly->startAbort();
@@ -469,14 +513,30 @@ void Part::playPoly(const PatchCache cache[4], const MemParams::RhythmTemp *rhyt
 		synth->printDebug("%s (%s): Completely muted instrument", name, currentInstr);
 		return;
 	}
+	TraceSink * const traceSink = synth->getTraceSink();
+	TraceSpan allocationTraceSpan(traceSink, TraceSink::SpanKind_PARTIAL_ALLOCATION, needPartials);
+
+	PolyphonyStats &polyphonyStats = synth->getCollectedPolyphonyStats();
 
 	if ((patchTemp->patch.assignMode & 2) == 0) {
 		// Single-assign mode
-		abortFirstPoly(key);
+		if (abortFirstPoly(key)) polyphonyStats.singleAssignPolyAbortCount++;
 		if (synth->isAbortingPoly()) return;
 	}
 
-	if (!synth->partialManager->freePartials(needPartials, partNum)) {
+	bool partialsFreed;
+	if (traceSink == NULL) {
+		partialsFreed = synth->partialManager->freePartials(needPartials, partNum);
+	} else {
+		// Only trace the steal when the free partials don't suffice, so that polys are bound to be aborted.
+		const unsigned int freePartialCount = synth->partialManager->getFreePartialCount();
+		const unsigned int lackingPartialCount = needPartials > freePartialCount ? needPartials - freePartialCount : 0;
+		TraceSpan stealTraceSpan(lackingPartialCount > 0 ? traceSink : NULL, TraceSink::SpanKind_PARTIAL_STEAL, lackingPartialCount);
+		partialsFreed = synth->partialManager->freePartials(needPartials, partNum);
+	}
+	if (!partialsFreed) {
+		polyphonyStats.noteOnCount++;
+		polyphonyStats.droppedNoteCount++;
 #if MT32EMU_MONITOR_PARTIALS > 0
 		synth->printDebug("%s (%s): Insufficient free partials to play key %d (velocity %d); needed=%d, free=%d, assignMode=%d", name, currentInstr, midiKey, velocity, needPartials, synth->partialManager->getFreePartialCount(), patchTemp->patch.assignMode);
 		synth->printPartialUsage();
@@ -485,8 +545,10 @@ void Part::playPoly(const PatchCache cache[4], const MemParams::RhythmTemp *rhyt
 	}
 	if (synth->isAbortingPoly()) return;
 
+	polyphonyStats.noteOnCount++;
 	Poly *poly = synth->partialManager->assignPolyToPart(this);
 	if (poly == NULL) {
+		polyphonyStats.droppedNoteCount++;
 		synth->printDebug("%s (%s): No free poly to play key %d (velocity %d)", name, currentInstr, midiKey, velocity);
 		return;
 	}
@@ -502,11 +564,18 @@ void Part::playPoly(const PatchCache cache[4], const MemParams::RhythmTemp *rhyt
 		if (cache[x].playPartial) {
 			partials[x] = synth->partialManager->allocPartial(partNum);
 			activePartialCount++;
+			polyphonyStats.partialAllocationCount++;
 		} else {
 			partials[x] = NULL;
 		}
 	}
+	if (polyphonyStats.peakPartPartialCount[partNum] < activePartialCount) {
+		polyphonyStats.peakPartPartialCount[partNum] = activePartialCount;
+	}
+	const Bit32u activePartialCountTotal = synth->partialManager->getActivePartialCount();
+	if (polyphonyStats.peakPartialCount < activePartialCountTotal) polyphonyStats.peakPartialCount = activePartialCountTotal;
 	poly->reset(key, velocity, cache[0].sustain, partials);
+	addPolyWithKey(poly, (patchTemp->patch.assignMode & 1) != 0);
 
 	for (int x = 0; x < 4; x++) {
 		if (partials[x] != NULL) {
@@ -563,10 +632,10 @@ void Part::stopNote(unsigned int key) {
 	synth->printDebug("%s (%s): stopping key %d", name, currentInstr, key);
 #endif
 
-	for (Poly *poly = activePolys.getFirst(); poly != NULL; poly = poly->getNext()) {
+	for (Poly *poly = firstPolyWithKey[key]; poly != NULL; poly = poly->getNextWithSameKey()) {
 		// Generally, non-sustaining instruments ignore note off. They die away eventually anyway.
 		// Key 0 (only used by special cases on rhythm part) reacts to note off even if non-sustaining or pedal held.
-		if (poly->getKey() == key && (poly->canSustain() || key == 0)) {
+		if (poly->canSustain() || key == 0) {
 			if (poly->noteOff(holdpedal && key != 0)) {
 				break;
 			}
@@ -587,28 +656,78 @@ const Poly *Part::getFirstActivePoly() const {
 }
 
 unsigned int Part::getActiveNonReleasingPartialCount() const {
-	unsigned int activeNonReleasingPartialCount = 0;
-	for (Poly *poly = activePolys.getFirst(); poly != NULL; poly = poly->getNext()) {
-		if (poly->getState() != POLY_Releasing) {
-			activeNonReleasingPartialCount += poly->getActivePartialCount();
-		}
-	}
-	return activeNonReleasingPartialCount;
+	return activePartialCount - releasingPartialCount;
 }
 
 Synth *Part::getSynth() const {
 	return synth;
 }
 
-void Part::partialDeactivated(Poly *poly) {
+void Part::partialDeactivated(Poly *poly, bool polyReleasing) {
 	activePartialCount--;
+	if (polyReleasing) {
+		releasingPartialCount--;
+	}
 	if (!poly->isActive()) {
 		activePolys.remove(poly);
+		removePolyWithKey(poly);
 		synth->partialManager->polyFreed(poly);
 		synth->reportHandler->onPolyStateChanged(Bit8u(partNum));
 	}
 }
 
+void Part::polyStateChanged(const Poly *poly, PolyState newState) {
+	PolyState oldState = poly->getState();
+	if (oldState != POLY_Inactive) {
+		polyCountByState[oldState]--;
+	}
+	if (newState != POLY_Inactive) {
+		polyCountByState[newState]++;
+	}
+	if (oldState == POLY_Releasing) {
+		releasingPartialCount -= poly->getActivePartialCount();
+	}
+	if (newState == POLY_Releasing) {
+		releasingPartialCount += poly->getActivePartialCount();
+	}
+}
+
+void Part::addPolyWithKey(Poly *poly, bool prepend) {
+	unsigned int key = poly->getKey();
+	if (firstPolyWithKey[key] == NULL) {
+		poly->setNextWithSameKey(NULL);
+		firstPolyWithKey[key] = poly;
+		lastPolyWithKey[key] = poly;
+	} else if (prepend) {
+		poly->setNextWithSameKey(firstPolyWithKey[key]);
+		firstPolyWithKey[key] = poly;
+	} else {
+		poly->setNextWithSameKey(NULL);
+		lastPolyWithKey[key]->setNextWithSameKey(poly);
+		lastPolyWithKey[key] = poly;
+	}
+}
+
+void Part::removePolyWithKey(Poly *poly) {
+	unsigned int key = poly->getKey();
+	Poly *previousPoly = NULL;
+	for (Poly *keyPoly = firstPolyWithKey[key]; keyPoly != NULL; keyPoly = keyPoly->getNextWithSameKey()) {
+		if (keyPoly == poly) {
+			if (previousPoly == NULL) {
+				firstPolyWithKey[key] = poly->getNextWithSameKey();
+			} else {
+				previousPoly->setNextWithSameKey(poly->getNextWithSameKey());
+			}
+			if (lastPolyWithKey[key] == poly) {
+				lastPolyWithKey[key] = previousPoly;
+			}
+			poly->setNextWithSameKey(NULL);
+			return;
+		}
+		previousPoly = keyPoly;
+	}
+}
+
 PolyList::PolyList() : firstPoly(NULL), lastPoly(NULL) {}
 
 bool PolyList::isEmpty() const {
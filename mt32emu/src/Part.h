@@ -55,8 +55,16 @@ private:
 	bool holdpedal;
 
 	unsigned int activePartialCount;
+	// Number of the active partials that belong to the polys in POLY_Releasing.
+	unsigned int releasingPartialCount;
 	PatchCache patchCache[4];
 	PolyList activePolys;
+	// The active polys chained by key via Poly::getNextWithSameKey(), in the same order as they appear in activePolys.
+	// This way, the polys playing a key are found without walking through all the active polys.
+	Poly *firstPolyWithKey[128];
+	Poly *lastPolyWithKey[128];
+	// Number of the active polys in each state, so that looking for a poly in a state no poly is in costs nothing.
+	unsigned int polyCountByState[POLY_Inactive];
 
 	void setPatch(const PatchParam *patch);
 	unsigned int midiKeyToKey(unsigned int midiKey);
@@ -80,6 +88,8 @@ protected:
 	void cacheTimbre(PatchCache cache[4], const TimbreParam *timbre);
 	void playPoly(const PatchCache cache[4], const MemParams::RhythmTemp *rhythmTemp, unsigned int midiKey, unsigned int key, unsigned int velocity);
 	void stopNote(unsigned int key);
+	void addPolyWithKey(Poly *poly, bool prepend);
+	void removePolyWithKey(Poly *poly);
 	const char *getName() const;
 
 public:
@@ -120,8 +130,9 @@ public:
 
 	const MemParams::PatchTemp *getPatchTemp() const;
 
-	// This should only be called by Poly
-	void partialDeactivated(Poly *poly);
+	// These should only be called by Poly
+	void partialDeactivated(Poly *poly, bool polyReleasing);
+	void polyStateChanged(const Poly *poly, PolyState newState);
 
 	// These are rather specialised, and should probably only be used by PartialManager
 	bool abortFirstPoly(PolyState polyState);
@@ -139,6 +150,8 @@ class RhythmPart: public Part {
 public:
 	RhythmPart(Synth *synth, unsigned int usePartNum);
 	void refresh();
+	// Invalidates the cached settings of the drums in the given range only, which suffices when just their rhythm settings change
+	void refreshDrums(unsigned int firstDrum, unsigned int lastDrum);
 	void refreshTimbre(unsigned int timbreNum);
 	void setTimbre(TimbreParam *timbre);
 	void noteOn(unsigned int key, unsigned int velocity);
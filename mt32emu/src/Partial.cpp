@@ -16,10 +16,13 @@
  */
 
 #include <cstddef>
+#include <cstring>
+#include <new>
 
 #include "internals.h"
 
 #include "Partial.h"
+#include "Kernels.h"
 #include "Part.h"
 #include "PartialManager.h"
 #include "Poly.h"
@@ -38,47 +41,30 @@ static const Bit8u PAN_NUMERATOR_SLAVE[]  = {0, 1, 2, 3, 4, 5, 6, 7, 7, 7, 7, 7,
 // because of the observed sample overflow, so the panSetting values are likely mapped in a similar way via a LUT.
 // FIXME: Sample analysis suggests that the use of panSetting is linear, but there are some quirks that still need to be resolved.
 static Bit32s getPanFactor(Bit32s panSetting) {
-	static const Bit32u PAN_FACTORS_COUNT = 15;
-	static Bit32s PAN_FACTORS[PAN_FACTORS_COUNT];
-	static bool firstRun = true;
-
-	if (firstRun) {
-		firstRun = false;
-		for (Bit32u i = 1; i < PAN_FACTORS_COUNT; i++) {
-			PAN_FACTORS[i] = Bit32s(0.5 + i * 8192.0 / double(PAN_FACTORS_COUNT - 1));
-		}
-	}
+	// PAN_FACTORS[i] = int(0.5 + i * 8192 / 14)
+	static const Bit32s PAN_FACTORS[] = {0, 585, 1170, 1755, 2341, 2926, 3511, 4096, 4681, 5266, 5851, 6437, 7022, 7607, 8192};
 	return PAN_FACTORS[panSetting];
 }
 
-Partial::Partial(Synth *useSynth, int usePartialIndex) :
-	synth(useSynth), partialIndex(usePartialIndex), sampleNum(0),
-	floatMode(useSynth->getSelectedRendererType() == RendererType_FLOAT) {
+Partial::Partial(Synth *useSynth, int usePartialIndex, TVA *tvaStorage, TVP *tvpStorage, TVF *tvfStorage, LA32PartialPair *useLA32Pair) :
+	synth(useSynth), partialIndex(usePartialIndex), sampleNum(0), la32Pair(useLA32Pair),
+	floatMode(useSynth->getSelectedRendererType() != RendererType_BIT16S) {
 	// Initialisation of tva, tvp and tvf uses 'this' pointer
 	// and thus should not be in the initializer list to avoid a compiler warning
-	tva = new TVA(this, &ampRamp);
-	tvp = new TVP(this);
-	tvf = new TVF(this, &cutoffModifierRamp);
+	tva = new (tvaStorage) TVA(this, &ampRamp);
+	tvp = new (tvpStorage) TVP(this);
+	tvf = new (tvfStorage) TVF(this, &cutoffModifierRamp);
 	ownerPart = -1;
+	deactivationDeferred = false;
 	poly = NULL;
 	pair = NULL;
-	switch (synth->getSelectedRendererType()) {
-	case RendererType_BIT16S:
-		la32Pair = new LA32IntPartialPair;
-		break;
-	case RendererType_FLOAT:
-		la32Pair = new LA32FloatPartialPair;
-		break;
-	default:
-		la32Pair = NULL;
-	}
+	rhythmHit = NULL;
 }
 
 Partial::~Partial() {
-	delete la32Pair;
-	delete tva;
-	delete tvp;
-	delete tvf;
+	tva->~TVA();
+	tvp->~TVP();
+	tvf->~TVF();
 }
 
 // Only used for debugging purposes
@@ -113,9 +99,15 @@ void Partial::deactivate() {
 		return;
 	}
 	ownerPart = -1;
-	synth->partialManager->partialDeactivated(partialIndex);
-	if (poly != NULL) {
-		poly->partialDeactivated(this);
+	stopRhythmHit();
+	if (synth->partialManager->isDeactivationDeferred()) {
+		// Polys and parts are shared among concurrently rendered partials, so leave them intact for now
+		deactivationDeferred = true;
+	} else {
+		synth->partialManager->partialDeactivated(partialIndex);
+		if (poly != NULL) {
+			poly->partialDeactivated(this);
+		}
 	}
 #if MT32EMU_MONITOR_PARTIALS > 2
 	synth->printDebug("[+%lu] [Partial %d] Deactivated", sampleNum, partialIndex);
@@ -135,6 +127,17 @@ void Partial::deactivate() {
 	}
 }
 
+void Partial::completeDeferredDeactivation() {
+	if (!deactivationDeferred) {
+		return;
+	}
+	deactivationDeferred = false;
+	synth->partialManager->partialDeactivated(partialIndex);
+	if (poly != NULL) {
+		poly->partialDeactivated(this);
+	}
+}
+
 void Partial::startPartial(const Part *part, Poly *usePoly, const PatchCache *usePatchCache, const MemParams::RhythmTemp *rhythmTemp, Partial *pairPartial) {
 	if (usePoly == NULL || usePatchCache == NULL) {
 		synth->printDebug("[Partial %d] *** Error: Starting partial for owner %d, usePoly=%s, usePatchCache=%s", partialIndex, ownerPart, usePoly == NULL ? "*** NULL ***" : "OK", usePatchCache == NULL ? "*** NULL ***" : "OK");
@@ -189,12 +192,6 @@ void Partial::startPartial(const Part *part, Poly *usePoly, const PatchCache *us
 
 	if (patchCache->PCMPartial) {
 		pcmNum = patchCache->pcm;
-		if (synth->controlROMMap->pcmCount > 128) {
-			// CM-32L, etc. support two "banks" of PCMs, selectable by waveform type parameter.
-			if (patchCache->waveform > 1) {
-				pcmNum += 128;
-			}
-		}
 		pcmWave = &synth->pcmWaves[pcmNum];
 	} else {
 		pcmWave = NULL;
@@ -210,9 +207,9 @@ void Partial::startPartial(const Part *part, Poly *usePoly, const PatchCache *us
 
 	pair = pairPartial;
 	alreadyOutputed = false;
-	tva->reset(part, patchCache->partialParam, rhythmTemp);
-	tvp->reset(part, patchCache->partialParam);
-	tvf->reset(patchCache->partialParam, tvp->getBasePitch());
+	tva->reset(part, patchCache, rhythmTemp);
+	tvp->reset(part, patchCache);
+	tvf->reset(patchCache, tvp->getBasePitch());
 
 	LA32PartialPair::PairType pairType;
 	LA32PartialPair *useLA32Pair;
@@ -225,13 +222,14 @@ void Partial::startPartial(const Part *part, Poly *usePoly, const PatchCache *us
 		useLA32Pair = la32Pair;
 	}
 	if (isPCM()) {
-		useLA32Pair->initPCM(pairType, &synth->pcmROMData[pcmWave->addr], pcmWave->len, pcmWave->loop);
+		useLA32Pair->initPCM(pairType, *pcmWave);
 	} else {
 		useLA32Pair->initSynth(pairType, (patchCache->waveform & 1) != 0, pulseWidthVal, patchCache->srcPartial.tvf.resonance + 1);
 	}
 	if (!hasRingModulatingSlave()) {
 		la32Pair->deactivate(LA32PartialPair::SLAVE);
 	}
+	startRhythmHit(part, rhythmTemp);
 }
 
 Bit32u Partial::getAmpValue() {
@@ -312,29 +310,202 @@ bool Partial::canProduceOutput() {
 	return true;
 }
 
-template <class LA32PairImpl>
-bool Partial::generateNextSample(LA32PairImpl *la32PairImpl) {
-	if (!tva->isPlaying() || !la32PairImpl->isActive(LA32PartialPair::MASTER)) {
-		deactivate();
-		return false;
+bool Partial::isNonLoopedPCM() const {
+	return pcmWave != NULL && !pcmWave->loop;
+}
+
+void Partial::nextControlValues(ControlBlock &block, Bit32u ix) {
+	block.amp[ix] = getAmpValue();
+	block.pitch[ix] = tvp->nextPitch();
+	block.cutoff[ix] = getCutoffValue();
+}
+
+// Returns the number of samples, up to maxLength, for which neither ramp raises an interrupt nor TVP processes
+// the pitch envelope. The control values of these samples don't affect each other, so they can be computed in bulk.
+Bit32u Partial::samplesUntilControlEvent(Bit32u maxLength) const {
+	Bit32u length = ampRamp.samplesUntilInterrupt(tvp->samplesUntilProcess(maxLength));
+	if (!isPCM()) {
+		length = cutoffModifierRamp.samplesUntilInterrupt(length);
 	}
-	la32PairImpl->generateNextSample(LA32PartialPair::MASTER, getAmpValue(), tvp->nextPitch(), getCutoffValue());
-	if (hasRingModulatingSlave()) {
-		la32PairImpl->generateNextSample(LA32PartialPair::SLAVE, pair->getAmpValue(), pair->tvp->nextPitch(), pair->getCutoffValue());
-		if (!pair->tva->isPlaying() || !la32PairImpl->isActive(LA32PartialPair::SLAVE)) {
-			pair->deactivate();
-			if (mixType == 2) {
-				deactivate();
-				return false;
+	return length;
+}
+
+// Produces the same control values as the respective number of calls to nextControlValues() would, provided that
+// the length doesn't exceed the result of samplesUntilControlEvent().
+void Partial::advanceControlValues(ControlBlock &block, Bit32u ix, Bit32u length) {
+	Bit32u *amp = block.amp + ix;
+	ampRamp.advance(length, amp);
+	for (Bit32u *ampEnd = amp + length; amp < ampEnd; amp++) {
+		*amp = 67117056 - *amp;
+	}
+	Bit16u pitch = tvp->advance(length);
+	for (Bit16u *pitchIt = block.pitch + ix, *pitchEnd = pitchIt + length; pitchIt < pitchEnd; pitchIt++) {
+		*pitchIt = pitch;
+	}
+	Bit32u *cutoff = block.cutoff + ix;
+	if (isPCM()) {
+		memset(cutoff, 0, length * sizeof(Bit32u));
+		return;
+	}
+	cutoffModifierRamp.advance(length, cutoff);
+	const Bit32u baseCutoff = Bit32u(tvf->getBaseCutoff()) << 18;
+	for (Bit32u *cutoffEnd = cutoff + length; cutoff < cutoffEnd; cutoff++) {
+		*cutoff += baseCutoff;
+	}
+}
+
+// Evaluates the envelopes and ramps of this partial and its ring modulating slave (if any) ahead of the wave generators.
+// The stretches of samples between the events that change the state of the envelopes (ramp interrupts and processing
+// of the pitch envelope) are computed in bulk. The samples where the events fire are evaluated exactly in the same order
+// as in a sample-by-sample loop, so the output remains bit-exact.
+// The block ends right after a sample that finishes either TVA, since the pair is deactivated after rendering it.
+// Returns the number of samples evaluated, which is at least 1.
+Bit32u Partial::generateControlBlock(ControlBlock &masterBlock, ControlBlock &slaveBlock, Bit32u length) {
+	const bool withSlave = hasRingModulatingSlave();
+	if (isNonLoopedPCM() || (withSlave && pair->isNonLoopedPCM())) {
+		// Only the wave generator knows when a non-looped PCM wave ends. Since TVP consumes random numbers,
+		// control values must not be evaluated beyond that point, so just go sample-by-sample in this case.
+		length = 1;
+	} else if (length > CONTROL_BLOCK_LENGTH) {
+		length = CONTROL_BLOCK_LENGTH;
+	}
+	const Bit32u blockStart = sampleNum;
+	Bit32u blockLength = 0;
+	while (blockLength < length) {
+		Bit32u steadyLength = samplesUntilControlEvent(length - blockLength);
+		if (withSlave) {
+			steadyLength = pair->samplesUntilControlEvent(steadyLength);
+		}
+		if (steadyLength > 0) {
+			advanceControlValues(masterBlock, blockLength, steadyLength);
+			if (withSlave) {
+				pair->advanceControlValues(slaveBlock, blockLength, steadyLength);
 			}
+			blockLength += steadyLength;
+			sampleNum += steadyLength;
+			continue;
+		}
+		nextControlValues(masterBlock, blockLength);
+		if (withSlave) {
+			pair->nextControlValues(slaveBlock, blockLength);
 		}
+		blockLength++;
+		sampleNum++;
+		if (!tva->isPlaying() || (withSlave && !pair->tva->isPlaying())) break;
+	}
+	sampleNum = blockStart;
+	return blockLength;
+}
+
+// Returns true if the partial culling is enabled and the TVAs attenuate the whole block at least down to the threshold,
+// in which case the wave generation may be skipped.
+bool Partial::isControlBlockInaudible(const ControlBlock &masterBlock, const ControlBlock &slaveBlock, Bit32u length) const {
+	const Bit32u cullingAmp = synth->getPartialCullingAmp();
+	if (cullingAmp == 0) return false;
+	const bool withSlave = hasRingModulatingSlave();
+	for (Bit32u ix = 0; ix < length; ix++) {
+		if (masterBlock.amp[ix] < cullingAmp) return false;
+		if (withSlave && slaveBlock.amp[ix] < cullingAmp) return false;
 	}
 	return true;
 }
 
-void Partial::produceAndMixSample(IntSample *&leftBuf, IntSample *&rightBuf, LA32IntPartialPair *la32IntPair) {
-	IntSampleEx sample = la32IntPair->nextOutSample();
+void Partial::startRhythmHit(const Part *part, const MemParams::RhythmTemp *rhythmTemp) {
+	rhythmHit = NULL;
+	RhythmHitCache *rhythmHitCache = synth->getRhythmHitCache();
+	// The output of the ring modulating slave is recorded by the master.
+	if (rhythmHitCache == NULL || rhythmTemp == NULL || isRingModulatingSlave() || part->getModulation() != 0 || part->getPitchBend() != 0) {
+		return;
+	}
+	const Bit32u drumNum = Bit32u(rhythmTemp - synth->mt32ram.rhythmTemp);
+	rhythmHit = rhythmHitCache->startHit(patchCache, drumNum, poly->getVelocity());
+	if (rhythmHit == NULL) return;
+	rhythmHitGeneration = rhythmHit->generation;
+	rhythmHitRecording = rhythmHit->recording;
+	rhythmHitPosition = 0;
+	rhythmHitMasterTunePitchDelta = synth->getMasterTunePitchDelta();
+}
+
+void Partial::stopRhythmHit() {
+	if (rhythmHit == NULL) return;
+	if (rhythmHitRecording && rhythmHit->generation == rhythmHitGeneration) {
+		RhythmHitCache::finishHit(rhythmHit);
+	}
+	rhythmHit = NULL;
+}
 
+// Computes the hashes of the amp and cutoff values of the pair for each sample of the block. While recording, the pitches
+// of the whole block are recorded here, since the wave generators of the pair are fed with them regardless of whether
+// the slave ends within the block. Returns true if the block is to be replayed, i.e. the hashes match the recording,
+// and nothing but the random timing of the pitch envelope may make the pitch differ. Otherwise, the entry is dropped
+// unless still recording, and false is returned.
+bool Partial::followRhythmHit(const ControlBlock &masterBlock, const ControlBlock &slaveBlock, Bit32u length, Bit32u *controlHashes) {
+	if (rhythmHit->generation != rhythmHitGeneration) {
+		rhythmHit = NULL;
+		return false;
+	}
+	const Part *part = synth->getPart(Bit8u(ownerPart));
+	if (part->getModulation() != 0 || part->getPitchBend() != 0 || synth->getMasterTunePitchDelta() != rhythmHitMasterTunePitchDelta) {
+		// The samples recorded so far remain valid, since TVP only follows the changes from now on.
+		stopRhythmHit();
+		return false;
+	}
+	// FNV-1a over the control values, so that a change of any single value always changes the hash.
+	const bool withSlave = hasRingModulatingSlave();
+	for (Bit32u ix = 0; ix < length; ix++) {
+		Bit32u hash = 2166136261U;
+		hash = (hash ^ masterBlock.amp[ix]) * 16777619U;
+		hash = (hash ^ masterBlock.cutoff[ix]) * 16777619U;
+		if (withSlave) {
+			hash = (hash ^ slaveBlock.amp[ix]) * 16777619U;
+			hash = (hash ^ slaveBlock.cutoff[ix]) * 16777619U;
+		}
+		controlHashes[ix] = hash;
+	}
+	if (rhythmHitRecording) {
+		Bit32u recordLength = RhythmHitCache::MAX_HIT_LENGTH - rhythmHitPosition;
+		if (recordLength > length) recordLength = length;
+		memcpy(rhythmHit->pitches + rhythmHitPosition, masterBlock.pitch, recordLength * sizeof(Bit16u));
+		if (withSlave) {
+			memcpy(rhythmHit->slavePitches + rhythmHitPosition, slaveBlock.pitch, recordLength * sizeof(Bit16u));
+		}
+		return false;
+	}
+	if (rhythmHitPosition + length > rhythmHit->length
+		|| memcmp(controlHashes, rhythmHit->controlHashes + rhythmHitPosition, length * sizeof(Bit32u)) != 0)
+	{
+		// The wave generators skipped through the replayed samples following the recorded pitches, so they resume
+		// in the state they would be in if they generated the recorded output.
+		rhythmHit = NULL;
+		return false;
+	}
+	return true;
+}
+
+template <class Sample>
+void Partial::recordRhythmHit(const Sample *outputs, const Bit32u *controlHashes, Bit32u length) {
+	Bit32u recordLength = RhythmHitCache::MAX_HIT_LENGTH - rhythmHitPosition;
+	if (recordLength > length) recordLength = length;
+	memcpy(rhythmHit->controlHashes + rhythmHitPosition, controlHashes, recordLength * sizeof(Bit32u));
+	memcpy(reinterpret_cast<Sample *>(rhythmHit->outputs) + rhythmHitPosition, outputs, recordLength * sizeof(Sample));
+	rhythmHitPosition += recordLength;
+	rhythmHit->length = rhythmHitPosition;
+	if (rhythmHitPosition == RhythmHitCache::MAX_HIT_LENGTH) stopRhythmHit();
+}
+
+template <class LA32PairImpl>
+bool Partial::checkRingModulatingSlave(LA32PairImpl *la32PairImpl) {
+	if (hasRingModulatingSlave() && (!pair->tva->isPlaying() || !la32PairImpl->isActive(LA32PartialPair::SLAVE))) {
+		pair->deactivate();
+		if (mixType == 2) {
+			deactivate();
+			return false;
+		}
+	}
+	return true;
+}
+
+void Partial::produceAndMixSample(IntSample *&leftBuf, IntSample *&rightBuf, IntSampleEx sample) {
 	// FIXME: LA32 may produce distorted sound in case if the absolute value of maximal amplitude of the input exceeds 8191
 	// when the panning value is non-zero. Most probably the distortion occurs in the same way it does with ring modulation,
 	// and it seems to be caused by limited precision of the common multiplication circuit.
@@ -348,22 +519,126 @@ void Partial::produceAndMixSample(IntSample *&leftBuf, IntSample *&rightBuf, LA3
 	*(rightBuf++) = Synth::clipSampleEx(rightOut);
 }
 
-void Partial::produceAndMixSample(FloatSample *&leftBuf, FloatSample *&rightBuf, LA32FloatPartialPair *la32FloatPair) {
-	FloatSample sample = la32FloatPair->nextOutSample();
+void Partial::produceAndMixSample(FloatSample *&leftBuf, FloatSample *&rightBuf, FloatSample sample) {
 	FloatSample leftOut = (sample * leftPanValue) / 14.0f;
 	FloatSample rightOut = (sample * rightPanValue) / 14.0f;
 	*(leftBuf++) += leftOut;
 	*(rightBuf++) += rightOut;
 }
 
+void Partial::panAndMixSamples(IntSample *&leftBuf, IntSample *&rightBuf, const IntSample *samples, Bit32u length) {
+	for (const IntSample *samplesEnd = samples + length; samples < samplesEnd; samples++) {
+		produceAndMixSample(leftBuf, rightBuf, *samples);
+	}
+}
+
+void Partial::panAndMixSamples(FloatSample *&leftBuf, FloatSample *&rightBuf, const FloatSample *samples, Bit32u length) {
+	// The same as produceAndMixSample() for each sample, yet the kernel may process several samples at once.
+	synth->getKernels().panAndMixFloat(samples, leftBuf, rightBuf, FloatSample(leftPanValue), FloatSample(rightPanValue), length);
+	leftBuf += length;
+	rightBuf += length;
+}
+
+// Combines the outputs of the wave generators as the pair output mode requires, then pans and mixes the result into
+// the output buffers. The mixing loops are specialised for each combination of the output mode and the presence
+// of the ring modulating slave, so that no more branching is needed for every sample.
+template <class Sample, class LA32PairImpl>
+void Partial::mixAndPanSamples(Sample *&leftBuf, Sample *&rightBuf, LA32PairImpl *la32PairImpl, Sample *masterOutputs, const Sample *slaveOutputs, Bit32u length) {
+	const bool withSlave = hasRingModulatingSlave();
+	switch (la32PairImpl->getOutputMode()) {
+	case LA32PartialPair::OUTPUT_MODE_MIXED:
+		if (withSlave) {
+			LA32PairImpl::template mixOutputs<LA32PartialPair::OUTPUT_MODE_MIXED, true>(length, masterOutputs, slaveOutputs);
+		} else {
+			LA32PairImpl::template mixOutputs<LA32PartialPair::OUTPUT_MODE_MIXED, false>(length, masterOutputs, slaveOutputs);
+		}
+		break;
+	case LA32PartialPair::OUTPUT_MODE_RING_MODULATED:
+		if (withSlave) {
+			LA32PairImpl::template mixOutputs<LA32PartialPair::OUTPUT_MODE_RING_MODULATED, true>(length, masterOutputs, slaveOutputs);
+		} else {
+			LA32PairImpl::template mixOutputs<LA32PartialPair::OUTPUT_MODE_RING_MODULATED, false>(length, masterOutputs, slaveOutputs);
+		}
+		break;
+	case LA32PartialPair::OUTPUT_MODE_RING_MODULATED_MIXED:
+		if (withSlave) {
+			LA32PairImpl::template mixOutputs<LA32PartialPair::OUTPUT_MODE_RING_MODULATED_MIXED, true>(length, masterOutputs, slaveOutputs);
+		} else {
+			LA32PairImpl::template mixOutputs<LA32PartialPair::OUTPUT_MODE_RING_MODULATED_MIXED, false>(length, masterOutputs, slaveOutputs);
+		}
+		break;
+	}
+	panAndMixSamples(leftBuf, rightBuf, masterOutputs, length);
+	sampleNum += length;
+}
+
 template <class Sample, class LA32PairImpl>
 bool Partial::doProduceOutput(Sample *leftBuf, Sample *rightBuf, Bit32u length, LA32PairImpl *la32PairImpl) {
 	if (!canProduceOutput()) return false;
 	alreadyOutputed = true;
 
-	for (sampleNum = 0; sampleNum < length; sampleNum++) {
-		if (!generateNextSample(la32PairImpl)) break;
-		produceAndMixSample(leftBuf, rightBuf, la32PairImpl);
+	ControlBlock masterBlock;
+	ControlBlock slaveBlock;
+	Sample masterOutputs[CONTROL_BLOCK_LENGTH];
+	Sample slaveOutputs[CONTROL_BLOCK_LENGTH];
+	sampleNum = 0;
+	while (sampleNum < length) {
+		if (!tva->isPlaying() || !la32PairImpl->isActive(LA32PartialPair::MASTER)) {
+			deactivate();
+			break;
+		}
+		const Bit32u blockLength = generateControlBlock(masterBlock, slaveBlock, length - sampleNum);
+		Bit32u controlHashes[CONTROL_BLOCK_LENGTH];
+		const bool replaying = rhythmHit != NULL && followRhythmHit(masterBlock, slaveBlock, blockLength, controlHashes);
+		const Bit32u rhythmHitBlockPosition = rhythmHitPosition;
+		if (replaying) rhythmHitPosition += blockLength;
+		if (leftBuf == NULL || isControlBlockInaudible(masterBlock, slaveBlock, blockLength)) {
+			// The output is not generated, so the recording ends here.
+			if (rhythmHit != NULL && rhythmHitRecording) stopRhythmHit();
+			// The envelopes are already advanced through the block, the wave generators only need to follow the pitch,
+			// so that they resume in the same state and a non-looped PCM wave ends just in time.
+			const Bit16u *masterPitches = replaying ? rhythmHit->pitches + rhythmHitBlockPosition : masterBlock.pitch;
+			la32PairImpl->skipSamples(LA32PartialPair::MASTER, blockLength, masterPitches, masterBlock.cutoff);
+			if (hasRingModulatingSlave()) {
+				const Bit16u *slavePitches = replaying ? rhythmHit->slavePitches + rhythmHitBlockPosition : slaveBlock.pitch;
+				la32PairImpl->skipSamples(LA32PartialPair::SLAVE, blockLength, slavePitches, slaveBlock.cutoff);
+			}
+			if (leftBuf != NULL) {
+				leftBuf += blockLength;
+				rightBuf += blockLength;
+			}
+			sampleNum += blockLength;
+			if (!checkRingModulatingSlave(la32PairImpl)) break;
+			continue;
+		}
+		const Bit32u lastIx = blockLength - 1;
+		if (replaying) {
+			// The cutoff values match the recording.
+			la32PairImpl->skipSamples(LA32PartialPair::MASTER, blockLength, rhythmHit->pitches + rhythmHitBlockPosition, masterBlock.cutoff);
+			if (hasRingModulatingSlave()) {
+				la32PairImpl->skipSamples(LA32PartialPair::SLAVE, blockLength, rhythmHit->slavePitches + rhythmHitBlockPosition, slaveBlock.cutoff);
+			}
+			// The slave is checked in the same way as while recording, so it is found finished at the same sample.
+			const Sample *replayedOutputs = reinterpret_cast<const Sample *>(rhythmHit->outputs) + rhythmHitBlockPosition;
+			panAndMixSamples(leftBuf, rightBuf, replayedOutputs, lastIx);
+			sampleNum += lastIx;
+			if (!checkRingModulatingSlave(la32PairImpl)) break;
+			panAndMixSamples(leftBuf, rightBuf, replayedOutputs + lastIx, 1);
+			sampleNum++;
+			continue;
+		}
+		// The wave generators are independent of each other, each one can render the whole block in one go.
+		la32PairImpl->generateSamples(LA32PartialPair::MASTER, blockLength, masterBlock.amp, masterBlock.pitch, masterBlock.cutoff, masterOutputs);
+		if (hasRingModulatingSlave()) {
+			la32PairImpl->generateSamples(LA32PartialPair::SLAVE, blockLength, slaveBlock.amp, slaveBlock.pitch, slaveBlock.cutoff, slaveOutputs);
+		}
+		mixAndPanSamples(leftBuf, rightBuf, la32PairImpl, masterOutputs, slaveOutputs, lastIx);
+		if (rhythmHit != NULL && rhythmHitRecording) recordRhythmHit(masterOutputs, controlHashes, lastIx);
+		// The TVAs are already evaluated up to the end of the block, so the slave can only be found finished here.
+		// Once finished, the slave is no longer mixed in, even in the last sample.
+		if (!checkRingModulatingSlave(la32PairImpl)) break;
+		mixAndPanSamples(leftBuf, rightBuf, la32PairImpl, masterOutputs + lastIx, slaveOutputs + lastIx, 1);
+		if (rhythmHit != NULL && rhythmHitRecording) recordRhythmHit(masterOutputs + lastIx, controlHashes + lastIx, 1);
 	}
 	sampleNum = 0;
 	return true;
@@ -392,6 +667,22 @@ bool Partial::shouldReverb() {
 	return patchCache->reverb;
 }
 
+Bit32u Partial::samplesUntilDeactivation(Bit32u maxLength) const {
+	if (!isActive()) return 0;
+	if (isRingModulatingSlave()) return pair->samplesUntilDeactivation(maxLength);
+	// Only the wave generator knows when a non-looped PCM wave ends.
+	if (isNonLoopedPCM() || !tva->isPlaying()) return 0;
+	// The partial is deactivated at the start of the sample following the one where the TVA ends.
+	Bit32u length = tva->samplesUntilEnd(maxLength);
+	if (length < maxLength) length++;
+	if (hasRingModulatingSlave()) {
+		if (pair->isNonLoopedPCM() || !pair->tva->isPlaying()) return 0;
+		// The slave is checked right after the sample where its TVA ends, which may also deactivate this partial.
+		length = pair->tva->samplesUntilEnd(length);
+	}
+	return length;
+}
+
 void Partial::startAbort() {
 	// This is called when the partial manager needs to terminate partials for re-use by a new Poly.
 	tva->startAbort();
@@ -25,6 +25,7 @@
 #include "LA32Ramp.h"
 #include "LA32WaveGenerator.h"
 #include "LA32FloatWaveGenerator.h"
+#include "RhythmHitCache.h"
 
 namespace MT32Emu {
 
@@ -39,6 +40,16 @@ struct ControlROMPCMStruct;
 // A partial represents one of up to four waveform generators currently playing within a poly.
 class Partial {
 private:
+	// Maximum number of samples for which the envelopes and ramps are evaluated ahead of the wave generators
+	static const Bit32u CONTROL_BLOCK_LENGTH = 32;
+
+	// Control values fed to a wave generator for each sample of a block
+	struct ControlBlock {
+		Bit32u amp[CONTROL_BLOCK_LENGTH];
+		Bit16u pitch[CONTROL_BLOCK_LENGTH];
+		Bit32u cutoff[CONTROL_BLOCK_LENGTH];
+	};
+
 	Synth *synth;
 	const int partialIndex; // Index of this Partial in the global partial table
 	// Number of the sample currently being rendered by produceOutput(), or 0 if no run is in progress
@@ -51,6 +62,8 @@ private:
 	Bit32s leftPanValue, rightPanValue;
 
 	int ownerPart; // -1 if unassigned
+	// Set when notifications about deactivation are postponed while partials are rendered concurrently
+	bool deactivationDeferred;
 	int mixType;
 	int structurePosition; // 0 or 1 of a structure pair
 
@@ -74,27 +87,54 @@ private:
 	LA32Ramp cutoffModifierRamp;
 
 	// TODO: This should be owned by PartialPair
-	LA32PartialPair *la32Pair;
+	LA32PartialPair * const la32Pair;
 	const bool floatMode;
 
 	const PatchCache *patchCache;
 	PatchCache cachebackup;
 
+	// The entry of the rhythm hit cache the output is either recorded into or replayed from, NULL if none.
+	// The entry is dropped once its generation differs from the one it was started with.
+	RhythmHitCache::Entry *rhythmHit;
+	Bit32u rhythmHitGeneration;
+	bool rhythmHitRecording;
+	// Number of samples of the hit rendered so far
+	Bit32u rhythmHitPosition;
+	// The master tune the hit started with, which has to stay the same for the recorded pitches to remain valid
+	Bit32s rhythmHitMasterTunePitchDelta;
+
 	Bit32u getAmpValue();
 	Bit32u getCutoffValue();
+	bool isNonLoopedPCM() const;
+	void nextControlValues(ControlBlock &block, Bit32u ix);
+	Bit32u samplesUntilControlEvent(Bit32u maxLength) const;
+	void advanceControlValues(ControlBlock &block, Bit32u ix, Bit32u length);
+	Bit32u generateControlBlock(ControlBlock &masterBlock, ControlBlock &slaveBlock, Bit32u length);
+	bool isControlBlockInaudible(const ControlBlock &masterBlock, const ControlBlock &slaveBlock, Bit32u length) const;
+	void startRhythmHit(const Part *part, const MemParams::RhythmTemp *rhythmTemp);
+	void stopRhythmHit();
+	bool followRhythmHit(const ControlBlock &masterBlock, const ControlBlock &slaveBlock, Bit32u length, Bit32u *controlHashes);
+	template <class Sample>
+	void recordRhythmHit(const Sample *outputs, const Bit32u *controlHashes, Bit32u length);
 
 	template <class Sample, class LA32PairImpl>
 	bool doProduceOutput(Sample *leftBuf, Sample *rightBuf, Bit32u length, LA32PairImpl *la32PairImpl);
 	bool canProduceOutput();
 	template <class LA32PairImpl>
-	bool generateNextSample(LA32PairImpl *la32PairImpl);
-	void produceAndMixSample(IntSample *&leftBuf, IntSample *&rightBuf, LA32IntPartialPair *la32IntPair);
-	void produceAndMixSample(FloatSample *&leftBuf, FloatSample *&rightBuf, LA32FloatPartialPair *la32FloatPair);
+	bool checkRingModulatingSlave(LA32PairImpl *la32PairImpl);
+	void produceAndMixSample(IntSample *&leftBuf, IntSample *&rightBuf, IntSampleEx sample);
+	void produceAndMixSample(FloatSample *&leftBuf, FloatSample *&rightBuf, FloatSample sample);
+	void panAndMixSamples(IntSample *&leftBuf, IntSample *&rightBuf, const IntSample *samples, Bit32u length);
+	void panAndMixSamples(FloatSample *&leftBuf, FloatSample *&rightBuf, const FloatSample *samples, Bit32u length);
+	template <class Sample, class LA32PairImpl>
+	void mixAndPanSamples(Sample *&leftBuf, Sample *&rightBuf, LA32PairImpl *la32PairImpl, Sample *masterOutputs, const Sample *slaveOutputs, Bit32u length);
 
 public:
 	bool alreadyOutputed;
 
-	Partial(Synth *synth, int debugPartialNum);
+	// The envelope generators are constructed within the storage provided, which is owned by the caller
+	// as well as the wave generator pair.
+	Partial(Synth *synth, int debugPartialNum, TVA *tvaStorage, TVP *tvpStorage, TVF *tvfStorage, LA32PartialPair *useLA32Pair);
 	~Partial();
 
 	int debugGetPartialNum() const;
@@ -105,9 +145,13 @@ public:
 	bool isActive() const;
 	void activate(int part);
 	void deactivate(void);
+	void completeDeferredDeactivation();
 	void startPartial(const Part *part, Poly *usePoly, const PatchCache *useCache, const MemParams::RhythmTemp *rhythmTemp, Partial *pairPartial);
 	void startAbort();
 	void startDecayAll();
+	// Returns the number of samples, up to maxLength, which are certain to be rendered before the one where the partial
+	// or its ring modulating pair may get deactivated, provided that no MIDI events are played meanwhile.
+	Bit32u samplesUntilDeactivation(Bit32u maxLength) const;
 	bool shouldReverb();
 	bool isRingModulatingNoMix() const;
 	bool hasRingModulatingSlave() const;
@@ -122,6 +166,8 @@ public:
 	// Returns true only if data written to buffer
 	// These functions produce processed stereo samples
 	// made from combining this single partial with its pair, if it has one.
+	// When the buffers are NULL, the partial only advances through the samples, as if they were culled,
+	// which is used when the output is going to be discarded.
 	bool produceOutput(IntSample *leftBuf, IntSample *rightBuf, Bit32u length);
 	bool produceOutput(FloatSample *leftBuf, FloatSample *rightBuf, Bit32u length);
 }; // class Partial
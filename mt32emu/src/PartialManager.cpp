@@ -17,14 +17,20 @@
 
 #include <cstddef>
 #include <cstring>
+#include <new>
 
 #include "internals.h"
 
 #include "PartialManager.h"
+#include "LA32Wavetables.h"
+#include "MemoryLock.h"
 #include "Part.h"
 #include "Partial.h"
 #include "Poly.h"
 #include "Synth.h"
+#include "TVA.h"
+#include "TVF.h"
+#include "TVP.h"
 
 namespace MT32Emu {
 
@@ -32,48 +38,115 @@ PartialManager::PartialManager(Synth *useSynth, Part **useParts) {
 	synth = useSynth;
 	parts = useParts;
 	inactivePartialCount = synth->getPartialCount();
-	partialTable = new Partial *[inactivePartialCount];
+	partialLimit = inactivePartialCount;
+	// All the partials and polys are kept in contiguous arrays, so that the rendering loop walks through adjacent memory.
+	// Since Partial lacks a default constructor, the partials are constructed in place within raw storage.
+	partialTable = static_cast<Partial *>(::operator new(inactivePartialCount * sizeof(Partial)));
+	// Likewise, the envelope generators and the wave generator pairs of all the partials are kept in separate arrays
+	// rather than scattered over the heap, so that the state each rendering stage touches for successive partials
+	// is adjacent. The envelope generators are constructed by the respective partials.
+	tvaTable = static_cast<TVA *>(::operator new(inactivePartialCount * sizeof(TVA)));
+	tvpTable = static_cast<TVP *>(::operator new(inactivePartialCount * sizeof(TVP)));
+	tvfTable = static_cast<TVF *>(::operator new(inactivePartialCount * sizeof(TVF)));
+	la32IntPairTable = NULL;
+	la32FloatPairTable = NULL;
+	wavetables = NULL;
+	switch (synth->getSelectedRendererType()) {
+	case RendererType_BIT16S:
+		la32IntPairTable = new LA32IntPartialPair[inactivePartialCount];
+		break;
+	case RendererType_FLOAT:
+		la32FloatPairTable = new LA32FloatPartialPair[inactivePartialCount];
+		break;
+	case RendererType_FLOAT_WAVETABLE:
+		la32FloatPairTable = new LA32FloatPartialPair[inactivePartialCount];
+		wavetables = &LA32Wavetables::acquire();
+		for (Bit32u i = 0; i < inactivePartialCount; i++) {
+			la32FloatPairTable[i].setWavetables(wavetables);
+		}
+		break;
+	default:
+		break;
+	}
+	if (la32FloatPairTable != NULL) {
+		for (Bit32u i = 0; i < inactivePartialCount; i++) {
+			la32FloatPairTable[i].setKernels(&synth->getKernels());
+		}
+	}
 	inactivePartials = new int[inactivePartialCount];
-	freePolys = new Poly *[synth->getPartialCount()];
+	activePartialMaskLength = (inactivePartialCount + 31) >> 5;
+	activePartialMask = new Bit32u[activePartialMaskLength];
+	memset(activePartialMask, 0, activePartialMaskLength * sizeof(Bit32u));
+	activePartialCount = 0;
+	polyTable = new Poly[inactivePartialCount];
+	freePolys = new Poly *[inactivePartialCount];
 	firstFreePolyIndex = 0;
+	deactivationDeferred = false;
 	for (unsigned int i = 0; i < synth->getPartialCount(); i++) {
-		partialTable[i] = new Partial(synth, i);
+		LA32PartialPair *la32Pair = NULL;
+		if (la32IntPairTable != NULL) {
+			la32Pair = &la32IntPairTable[i];
+		} else if (la32FloatPairTable != NULL) {
+			la32Pair = &la32FloatPairTable[i];
+		}
+		new (&partialTable[i]) Partial(synth, i, &tvaTable[i], &tvpTable[i], &tvfTable[i], la32Pair);
 		inactivePartials[i] = inactivePartialCount - i - 1;
-		freePolys[i] = new Poly();
+		freePolys[i] = &polyTable[i];
 	}
 }
 
 PartialManager::~PartialManager(void) {
 	for (unsigned int i = 0; i < synth->getPartialCount(); i++) {
-		delete partialTable[i];
-		if (freePolys[i] != NULL) delete freePolys[i];
+		partialTable[i].~Partial();
 	}
-	delete[] partialTable;
+	::operator delete(partialTable);
+	::operator delete(tvaTable);
+	::operator delete(tvpTable);
+	::operator delete(tvfTable);
+	delete[] la32IntPairTable;
+	delete[] la32FloatPairTable;
+	if (wavetables != NULL) wavetables->release();
 	delete[] inactivePartials;
+	delete[] activePartialMask;
+	delete[] polyTable;
 	delete[] freePolys;
 }
 
 void PartialManager::clearAlreadyOutputed() {
-	for (unsigned int i = 0; i < synth->getPartialCount(); i++) {
-		partialTable[i]->alreadyOutputed = false;
+	// Partials deactivated meanwhile are reset when restarted
+	for (Bit32u wordIx = 0; wordIx < activePartialMaskLength; wordIx++) {
+		Bit32u partialIndex = wordIx << 5;
+		for (Bit32u word = activePartialMask[wordIx]; word != 0; word >>= 1, partialIndex++) {
+			if ((word & 1) != 0) partialTable[partialIndex].alreadyOutputed = false;
+		}
 	}
 }
 
 bool PartialManager::shouldReverb(int i) {
-	return partialTable[i]->shouldReverb();
+	return partialTable[i].shouldReverb();
 }
 
 bool PartialManager::produceOutput(int i, IntSample *leftBuf, IntSample *rightBuf, Bit32u bufferLength) {
-	return partialTable[i]->produceOutput(leftBuf, rightBuf, bufferLength);
+	return partialTable[i].produceOutput(leftBuf, rightBuf, bufferLength);
 }
 
 bool PartialManager::produceOutput(int i, FloatSample *leftBuf, FloatSample *rightBuf, Bit32u bufferLength) {
-	return partialTable[i]->produceOutput(leftBuf, rightBuf, bufferLength);
+	return partialTable[i].produceOutput(leftBuf, rightBuf, bufferLength);
 }
 
 void PartialManager::deactivateAll() {
 	for (unsigned int i = 0; i < synth->getPartialCount(); i++) {
-		partialTable[i]->deactivate();
+		partialTable[i].deactivate();
+	}
+}
+
+void PartialManager::restoreInitialState() {
+	deactivateAll();
+	const Bit32u partialCount = synth->getPartialCount();
+	if (inactivePartialCount != partialCount || firstFreePolyIndex != 0) return;
+	for (Bit32u i = 0; i < partialCount; i++) {
+		inactivePartials[i] = partialCount - i - 1;
+		freePolys[i] = &polyTable[i];
 	}
 }
 
@@ -88,29 +161,62 @@ unsigned int PartialManager::setReserve(Bit8u *rset) {
 
 Partial *PartialManager::allocPartial(int partNum) {
 	if (inactivePartialCount > 0) {
-		Partial *partial = partialTable[inactivePartials[--inactivePartialCount]];
+		const int partialIndex = inactivePartials[--inactivePartialCount];
+		activePartialMask[partialIndex >> 5] |= 1U << (partialIndex & 31);
+		activePartialCount++;
+		Partial *partial = &partialTable[partialIndex];
 		partial->activate(partNum);
 		return partial;
 	}
 	synth->printDebug("PartialManager Error: No inactive partials to allocate for part %d, current partial state:\n", partNum);
 	for (Bit32u i = 0; i < synth->getPartialCount(); i++) {
-		const Partial *partial = partialTable[i];
+		const Partial *partial = &partialTable[i];
 		synth->printDebug("[Partial %d]: activation=%d, owner part=%d\n", i, partial->isActive(), partial->getOwnerPart());
 	}
 	return NULL;
 }
 
 unsigned int PartialManager::getFreePartialCount() {
-	return inactivePartialCount;
+	const Bit32u withheldPartialCount = synth->getPartialCount() - partialLimit;
+	return inactivePartialCount > withheldPartialCount ? inactivePartialCount - withheldPartialCount : 0;
+}
+
+void PartialManager::setPartialLimit(Bit32u usePartialLimit) {
+	partialLimit = usePartialLimit;
+}
+
+Bit32u PartialManager::getActivePartialCount() const {
+	return activePartialCount;
+}
+
+Bit32u PartialManager::getActivePartials(int *partialIndices) const {
+	Bit32u listedPartialCount = 0;
+	for (Bit32u wordIx = 0; wordIx < activePartialMaskLength; wordIx++) {
+		int partialIndex = int(wordIx << 5);
+		for (Bit32u word = activePartialMask[wordIx]; word != 0; word >>= 1, partialIndex++) {
+			if ((word & 1) != 0) partialIndices[listedPartialCount++] = partialIndex;
+		}
+	}
+	return listedPartialCount;
+}
+
+Bit32u PartialManager::samplesUntilPartialDeactivation(Bit32u maxLength) const {
+	Bit32u length = maxLength;
+	for (Bit32u wordIx = 0; wordIx < activePartialMaskLength; wordIx++) {
+		Bit32u partialIndex = wordIx << 5;
+		for (Bit32u word = activePartialMask[wordIx]; word != 0; word >>= 1, partialIndex++) {
+			if ((word & 1) == 0) continue;
+			length = partialTable[partialIndex].samplesUntilDeactivation(length);
+			if (length == 0) return 0;
+		}
+	}
+	return length;
 }
 
 // This function is solely used to gather data for debug output at the moment.
 void PartialManager::getPerPartPartialUsage(unsigned int perPartPartialUsage[9]) {
-	memset(perPartPartialUsage, 0, 9 * sizeof(unsigned int));
-	for (unsigned int i = 0; i < synth->getPartialCount(); i++) {
-		if (partialTable[i]->isActive()) {
-			perPartPartialUsage[partialTable[i]->getOwnerPart()]++;
-		}
+	for (int partNum = 0; partNum < 9; partNum++) {
+		perPartPartialUsage[partNum] = parts[partNum]->getActivePartialCount();
 	}
 }
 
@@ -129,6 +235,7 @@ bool PartialManager::abortFirstReleasingPolyWhereReserveExceeded(int minPart) {
 			// This part has exceeded its reserved partial count.
 			// If it has any releasing polys, kill its first one and we're done.
 			if (parts[usePartNum]->abortFirstPoly(POLY_Releasing)) {
+				synth->getCollectedPolyphonyStats().releasingPolyStealCount++;
 				return true;
 			}
 		}
@@ -151,6 +258,7 @@ bool PartialManager::abortFirstPolyPreferHeldWhereReserveExceeded(int minPart) {
 			// This part has exceeded its reserved partial count.
 			// If it has any polys, kill its first (preferably held) one and we're done.
 			if (parts[usePartNum]->abortFirstPolyPreferHeld()) {
+				synth->getCollectedPolyphonyStats().reserveExceededPolyStealCount++;
 				return true;
 			}
 		}
@@ -246,6 +354,7 @@ bool PartialManager::freePartials(unsigned int needed, int partNum) {
 		if (!parts[partNum]->abortFirstPolyPreferHeld()) {
 			break;
 		}
+		synth->getCollectedPolyphonyStats().samePartPolyStealCount++;
 		if (synth->isAbortingPoly() || getFreePartialCount() >= needed) {
 			return true;
 		}
@@ -259,7 +368,36 @@ const Partial *PartialManager::getPartial(unsigned int partialNum) const {
 	if (partialNum > synth->getPartialCount() - 1) {
 		return NULL;
 	}
-	return partialTable[partialNum];
+	return &partialTable[partialNum];
+}
+
+size_t PartialManager::getMemoryUsage() const {
+	const size_t partialCount = synth->getPartialCount();
+	size_t memoryUsage = sizeof(*this) + partialCount * (sizeof(Partial) + sizeof(TVA) + sizeof(TVP) + sizeof(TVF));
+	if (la32IntPairTable != NULL) memoryUsage += partialCount * sizeof(LA32IntPartialPair);
+	if (la32FloatPairTable != NULL) memoryUsage += partialCount * sizeof(LA32FloatPartialPair);
+	memoryUsage += partialCount * (sizeof(*inactivePartials) + sizeof(Poly) + sizeof(*freePolys));
+	return memoryUsage + activePartialMaskLength * sizeof(*activePartialMask);
+}
+
+size_t PartialManager::getSharedWavetablesSize() const {
+	return wavetables == NULL ? 0 : wavetables->getMemoryUsage();
+}
+
+void PartialManager::lockMemory(MemoryLock &memoryLock) const {
+	const size_t partialCount = synth->getPartialCount();
+	memoryLock.lock(this, sizeof(*this));
+	memoryLock.lock(partialTable, partialCount * sizeof(Partial));
+	memoryLock.lock(tvaTable, partialCount * sizeof(TVA));
+	memoryLock.lock(tvpTable, partialCount * sizeof(TVP));
+	memoryLock.lock(tvfTable, partialCount * sizeof(TVF));
+	if (la32IntPairTable != NULL) memoryLock.lock(la32IntPairTable, partialCount * sizeof(LA32IntPartialPair));
+	if (la32FloatPairTable != NULL) memoryLock.lock(la32FloatPairTable, partialCount * sizeof(LA32FloatPartialPair));
+	if (wavetables != NULL) wavetables->lockMemory(memoryLock);
+	memoryLock.lock(polyTable, partialCount * sizeof(Poly));
+	memoryLock.lock(freePolys, partialCount * sizeof(*freePolys));
+	memoryLock.lock(inactivePartials, partialCount * sizeof(*inactivePartials));
+	memoryLock.lock(activePartialMask, activePartialMaskLength * sizeof(*activePartialMask));
 }
 
 Poly *PartialManager::assignPolyToPart(Part *part) {
@@ -295,13 +433,60 @@ void PartialManager::polyFreed(Poly *poly) {
 void PartialManager::partialDeactivated(int partialIndex) {
 	if (inactivePartialCount < synth->getPartialCount()) {
 		inactivePartials[inactivePartialCount++] = partialIndex;
+		const Bit32u partialBit = 1U << (partialIndex & 31);
+		if ((activePartialMask[partialIndex >> 5] & partialBit) != 0) {
+			activePartialMask[partialIndex >> 5] &= ~partialBit;
+			activePartialCount--;
+		}
 		return;
 	}
 	synth->printDebug("PartialManager Error: Cannot return deactivated partial %d, current partial state:\n", partialIndex);
 	for (Bit32u i = 0; i < synth->getPartialCount(); i++) {
-		const Partial *partial = partialTable[i];
+		const Partial *partial = &partialTable[i];
 		synth->printDebug("[Partial %d]: activation=%d, owner part=%d\n", i, partial->isActive(), partial->getOwnerPart());
 	}
 }
 
+Bit32u PartialManager::groupPartialsByPoly(Partial **partials, Bit32u *groupEnds, Bit32u maxGroupCount) {
+	Bit32u listedPartialCount = 0;
+	for (int partNum = 0; partNum < 9; partNum++) {
+		for (const Poly *poly = parts[partNum]->getFirstActivePoly(); poly != NULL; poly = poly->getNext()) {
+			listedPartialCount += poly->getActivePartialCount();
+		}
+	}
+	if (listedPartialCount == 0) return 0;
+	const Bit32u groupSize = (listedPartialCount + maxGroupCount - 1) / maxGroupCount;
+	Bit32u groupCount = 0;
+	Bit32u partialIx = 0;
+	for (int partNum = 0; partNum < 9; partNum++) {
+		for (const Poly *poly = parts[partNum]->getFirstActivePoly(); poly != NULL; poly = poly->getNext()) {
+			for (unsigned int i = 0; i < 4; i++) {
+				Partial *partial = poly->getPartial(i);
+				if (partial != NULL) partials[partialIx++] = partial;
+			}
+			if (partialIx >= groupSize * (groupCount + 1)) groupEnds[groupCount++] = partialIx;
+		}
+	}
+	if (groupCount == 0 || groupEnds[groupCount - 1] < partialIx) groupEnds[groupCount++] = partialIx;
+	return groupCount;
+}
+
+void PartialManager::setDeactivationDeferred(bool deferred) {
+	deactivationDeferred = deferred;
+}
+
+bool PartialManager::isDeactivationDeferred() const {
+	return deactivationDeferred;
+}
+
+void PartialManager::completeDeferredDeactivations() {
+	for (Bit32u wordIx = 0; wordIx < activePartialMaskLength; wordIx++) {
+		Bit32u partialIndex = wordIx << 5;
+		// Scans a copy of the word, so the partials removed meanwhile do not disturb the iteration
+		for (Bit32u word = activePartialMask[wordIx]; word != 0; word >>= 1, partialIndex++) {
+			if ((word & 1) != 0) partialTable[partialIndex].completeDeferredDeactivation();
+		}
+	}
+}
+
 } // namespace MT32Emu
@@ -18,27 +18,52 @@
 #ifndef MT32EMU_PARTIALMANAGER_H
 #define MT32EMU_PARTIALMANAGER_H
 
+#include <cstddef>
+
 #include "globals.h"
 #include "internals.h"
 #include "Types.h"
 
 namespace MT32Emu {
 
+class LA32FloatPartialPair;
+class LA32IntPartialPair;
+class LA32Wavetables;
+class MemoryLock;
 class Part;
 class Partial;
 class Poly;
 class Synth;
+class TVA;
+class TVF;
+class TVP;
 
 class PartialManager {
 private:
 	Synth *synth;
 	Part **parts;
+	Partial *partialTable;
+	TVA *tvaTable;
+	TVP *tvpTable;
+	TVF *tvfTable;
+	LA32IntPartialPair *la32IntPairTable;
+	LA32FloatPartialPair *la32FloatPairTable;
+	// Shared among the synths, set with RendererType_FLOAT_WAVETABLE only
+	const LA32Wavetables *wavetables;
+	Poly *polyTable;
 	Poly **freePolys;
-	Partial **partialTable;
 	Bit8u numReservedPartialsForPart[9];
 	Bit32u firstFreePolyIndex;
 	int *inactivePartials; // Holds indices of inactive Partials in the Partial table
 	Bit32u inactivePartialCount;
+	// Bit (i % 32) of word (i / 32) is set while the Partial i is active, so that the partials are (de)activated
+	// at a constant cost, yet they are listed in ascending order
+	Bit32u *activePartialMask;
+	Bit32u activePartialMaskLength;
+	Bit32u activePartialCount;
+	// The number of partials the new notes may use, less than the partial count while the overload governor limits it
+	Bit32u partialLimit;
+	bool deactivationDeferred;
 
 	bool abortFirstReleasingPolyWhereReserveExceeded(int minPart);
 	bool abortFirstPolyPreferHeldWhereReserveExceeded(int minPart);
@@ -48,10 +73,21 @@ public:
 	~PartialManager();
 	Partial *allocPartial(int partNum);
 	unsigned int getFreePartialCount();
+	// The partials active beyond the limit keep playing, but no more partials are allocated until the count drops below.
+	void setPartialLimit(Bit32u partialLimit);
+	Bit32u getActivePartialCount() const;
+	// Copies indices of active partials in ascending order, returns the number of partials copied.
+	// The copy remains intact when partials get deactivated during rendering.
+	Bit32u getActivePartials(int *partialIndices) const;
+	// Returns the number of samples, up to maxLength, which are certain to be rendered before the one where any active partial
+	// may get deactivated, provided that no MIDI events are played meanwhile.
+	Bit32u samplesUntilPartialDeactivation(Bit32u maxLength) const;
 	void getPerPartPartialUsage(unsigned int perPartPartialUsage[9]);
 	bool freePartials(unsigned int needed, int partNum);
 	unsigned int setReserve(Bit8u *rset);
 	void deactivateAll();
+	// Deactivates all partials and restores the order in which the partials and polys are allocated after construction.
+	void restoreInitialState();
 	bool produceOutput(int i, IntSample *leftBuf, IntSample *rightBuf, Bit32u bufferLength);
 	bool produceOutput(int i, FloatSample *leftBuf, FloatSample *rightBuf, Bit32u bufferLength);
 	bool shouldReverb(int i);
@@ -60,6 +96,21 @@ public:
 	Poly *assignPolyToPart(Part *part);
 	void polyFreed(Poly *poly);
 	void partialDeactivated(int partialIndex);
+
+	// Lists partials of active polys in a fixed order and splits the list into at most maxGroupCount groups
+	// of roughly the same size, keeping partials of each poly together. Returns the number of groups,
+	// the list end index of each group is stored in groupEnds.
+	Bit32u groupPartialsByPoly(Partial **partials, Bit32u *groupEnds, Bit32u maxGroupCount);
+	// While set, notifications about deactivated partials are postponed until completeDeferredDeactivations() is invoked.
+	void setDeactivationDeferred(bool deferred);
+	bool isDeactivationDeferred() const;
+	void completeDeferredDeactivations();
+	// Returns the number of bytes occupied by the partials, the polys and their bookkeeping.
+	size_t getMemoryUsage() const;
+	// Returns the size of the wavetables in use, they are shared, so they aren't included in getMemoryUsage()
+	size_t getSharedWavetablesSize() const;
+	// Locks the same memory getMemoryUsage() accounts for, along with the shared wavetables.
+	void lockMemory(MemoryLock &memoryLock) const;
 }; // class PartialManager
 
 } // namespace MT32Emu
@@ -37,6 +37,7 @@ Poly::Poly() {
 	}
 	state = POLY_Inactive;
 	next = NULL;
+	nextWithSameKey = NULL;
 }
 
 void Poly::setPart(Part *usePart) {
@@ -53,7 +54,7 @@ void Poly::reset(unsigned int newKey, unsigned int newVelocity, bool newSustain,
 				activePartialCount--;
 			}
 		}
-		state = POLY_Inactive;
+		setState(POLY_Inactive);
 	}
 
 	key = newKey;
@@ -65,9 +66,11 @@ void Poly::reset(unsigned int newKey, unsigned int newVelocity, bool newSustain,
 		partials[i] = newPartials[i];
 		if (newPartials[i] != NULL) {
 			activePartialCount++;
-			state = POLY_Playing;
 		}
 	}
+	if (activePartialCount > 0) {
+		setState(POLY_Playing);
+	}
 }
 
 bool Poly::noteOff(bool pedalHeld) {
@@ -80,7 +83,7 @@ bool Poly::noteOff(bool pedalHeld) {
 		if (state == POLY_Held) {
 			return false;
 		}
-		state = POLY_Held;
+		setState(POLY_Held);
 	} else {
 		startDecay();
 	}
@@ -98,7 +101,7 @@ bool Poly::startDecay() {
 	if (state == POLY_Inactive || state == POLY_Releasing) {
 		return false;
 	}
-	state = POLY_Releasing;
+	setState(POLY_Releasing);
 
 	for (int t = 0; t < 4; t++) {
 		Partial *partial = partials[t];
@@ -120,6 +123,7 @@ bool Poly::startAbort() {
 			part->getSynth()->abortingPoly = this;
 		}
 	}
+	part->getSynth()->getCollectedPolyphonyStats().abortedPolyCount++;
 	return true;
 }
 
@@ -164,6 +168,7 @@ bool Poly::isActive() const {
 
 // This is called by Partial to inform the poly that the Partial has deactivated
 void Poly::partialDeactivated(Partial *partial) {
+	const bool releasing = state == POLY_Releasing;
 	for (int i = 0; i < 4; i++) {
 		if (partials[i] == partial) {
 			partials[i] = NULL;
@@ -171,12 +176,16 @@ void Poly::partialDeactivated(Partial *partial) {
 		}
 	}
 	if (activePartialCount == 0) {
-		state = POLY_Inactive;
+		setState(POLY_Inactive);
 		if (part->getSynth()->abortingPoly == this) {
 			part->getSynth()->abortingPoly = NULL;
 		}
 	}
-	part->partialDeactivated(this);
+	part->partialDeactivated(this, releasing);
+}
+
+Partial *Poly::getPartial(unsigned int partialNum) const {
+	return partials[partialNum];
 }
 
 Poly *Poly::getNext() const {
@@ -187,4 +196,17 @@ void Poly::setNext(Poly *poly) {
 	next = poly;
 }
 
+Poly *Poly::getNextWithSameKey() const {
+	return nextWithSameKey;
+}
+
+void Poly::setNextWithSameKey(Poly *poly) {
+	nextWithSameKey = poly;
+}
+
+void Poly::setState(PolyState newState) {
+	part->polyStateChanged(this, newState);
+	state = newState;
+}
+
 } // namespace MT32Emu
@@ -40,6 +40,9 @@ private:
 	Partial *partials[4];
 
 	Poly *next;
+	Poly *nextWithSameKey;
+
+	void setState(PolyState newState);
 
 public:
 	Poly();
@@ -58,11 +61,14 @@ public:
 	PolyState getState() const;
 	unsigned int getActivePartialCount() const;
 	bool isActive() const;
+	Partial *getPartial(unsigned int partialNum) const;
 
 	void partialDeactivated(Partial *partial);
 
 	Poly *getNext() const;
 	void setNext(Poly *poly);
+	Poly *getNextWithSameKey() const;
+	void setNextWithSameKey(Poly *poly);
 }; // class Poly
 
 } // namespace MT32Emu
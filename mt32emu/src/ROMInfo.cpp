@@ -21,6 +21,7 @@
 
 #include "File.h"
 #include "ROMInfo.h"
+#include "SharedMemorySegment.h"
 
 namespace MT32Emu {
 
@@ -239,10 +240,16 @@ const ROMImage *ROMImage::interleaveImages(const ROMImage *romImageEven, const R
 }
 
 ROMImage::ROMImage(File *useFile, bool useOwnFile, const ROMInfo * const *romInfos) :
-	file(useFile), ownFile(useOwnFile), romInfo(ROMInfo::getROMInfo(file, romInfos))
+	file(useFile), ownFile(useOwnFile), romInfo(ROMInfo::getROMInfo(file, romInfos)), decodedPCMSegment(NULL),
+	decodedPCMData(decodePCMData(file, romInfo, decodedPCMSegment))
 {}
 
 ROMImage::~ROMImage() {
+	if (decodedPCMSegment == NULL) {
+		delete[] decodedPCMData;
+	} else {
+		delete decodedPCMSegment;
+	}
 	ROMInfo::freeROMInfo(romInfo);
 	if (ownFile) {
 		const Bit8u *data = file->getData();
@@ -251,6 +258,48 @@ ROMImage::~ROMImage() {
 	}
 }
 
+// The sample bits are scrambled in the PCM ROM, this restores their order. Since each bit of a decoded sample comes
+// from either byte of the source separately, the contribution of every possible byte value is tabulated beforehand.
+// The tables are cheap enough to build each time, which saves them from having to be initialised in a thread-safe way.
+// When the cache in shared memory is enabled, the samples decoded by another process from a file with the same digest
+// are used instead, and otherwise the samples are decoded into a new segment for the processes started later.
+const Bit16s *ROMImage::decodePCMData(File *file, const ROMInfo *romInfo, SharedMemorySegment *&segment) {
+	if (romInfo == NULL || romInfo->type != ROMInfo::PCM || romInfo->pairType != ROMInfo::Full) return NULL;
+
+	size_t sampleCount = file->getSize() >> 1;
+	char segmentKey[48] = "pcm-";
+	strcat(segmentKey, file->getSHA1());
+	segment = SharedMemorySegment::open(segmentKey, sampleCount * sizeof(Bit16s));
+	if (segment != NULL && !segment->isCreated()) return static_cast<const Bit16s *>(segment->getData());
+
+	static const int order[16] = {0, 9, 1, 2, 3, 4, 5, 6, 7, 10, 11, 12, 13, 14, 15, 8};
+
+	Bit16u firstByteBits[256];
+	Bit16u secondByteBits[256];
+	for (int byteValue = 0; byteValue < 256; byteValue++) {
+		Bit16u firstBits = 0;
+		Bit16u secondBits = 0;
+		for (int u = 0; u < 16; u++) {
+			if (order[u] < 8) {
+				firstBits |= Bit16u(((byteValue >> (7 - order[u])) & 0x1) << (15 - u));
+			} else {
+				secondBits |= Bit16u(((byteValue >> (7 - (order[u] - 8))) & 0x1) << (15 - u));
+			}
+		}
+		firstByteBits[byteValue] = firstBits;
+		secondByteBits[byteValue] = secondBits;
+	}
+
+	Bit16s *pcmData = segment == NULL ? new Bit16s[sampleCount] : static_cast<Bit16s *>(segment->getWritableData());
+	const Bit8u *fileData = file->getData();
+	for (size_t i = 0; i < sampleCount; i++) {
+		pcmData[i] = Bit16s(firstByteBits[fileData[0]] | secondByteBits[fileData[1]]);
+		fileData += 2;
+	}
+	if (segment != NULL) segment->publish();
+	return pcmData;
+}
+
 const ROMImage *ROMImage::makeROMImage(File *file) {
 	return new ROMImage(file, false, getKnownROMInfoList());
 }
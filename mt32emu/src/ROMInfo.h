@@ -25,6 +25,8 @@
 
 namespace MT32Emu {
 
+class SharedMemorySegment;
+
 // Defines vital info about ROM file to be used by synth and applications
 
 struct ROMInfo {
@@ -85,6 +87,8 @@ public:
 // Synth::open() requires a full control ROMImage and a compatible full PCM ROMImage to work
 
 class ROMImage {
+friend class Synth;
+
 public:
 	// Creates a ROMImage object given a ROMInfo and a File. Keeps a reference
 	// to the File and ROMInfo given, which must be freed separately by the user
@@ -106,7 +110,8 @@ public:
 	// If the given files contain incompatible partial images, NULL is returned.
 	MT32EMU_EXPORT_V(2.5) static const ROMImage *makeROMImage(File *file1, File *file2);
 
-	// Must only be done after all Synths using the ROMImage are deleted
+	// Must only be done after all Synths using the ROMImage are closed or deleted,
+	// since an open Synth refers to the PCM samples decoded by its PCM ROMImage.
 	MT32EMU_EXPORT static void freeROMImage(const ROMImage *romImage);
 
 	// Checks whether the given ROMImages are pairable and merges them into a full image, if possible.
@@ -124,10 +129,15 @@ private:
 	static const ROMImage *makeFullROMImage(Bit8u *data, size_t dataSize);
 	static const ROMImage *appendImages(const ROMImage *romImageLow, const ROMImage *romImageHigh);
 	static const ROMImage *interleaveImages(const ROMImage *romImageEven, const ROMImage *romImageOdd);
+	static const Bit16s *decodePCMData(File *file, const ROMInfo *romInfo, SharedMemorySegment *&segment);
 
 	File * const file;
 	const bool ownFile;
 	const ROMInfo * const romInfo;
+	// Holds the decoded samples when they are shared with other processes, NULL otherwise.
+	SharedMemorySegment *decodedPCMSegment;
+	// For a full PCM ROM image, contains the samples decoded once and shared by all the Synths opened with this image.
+	const Bit16s * const decodedPCMData;
 
 	ROMImage(File *file, bool ownFile, const ROMInfo * const *romInfos);
 	~ROMImage();
@@ -0,0 +1,116 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+
+#include "internals.h"
+
+#include "RhythmHitCache.h"
+
+namespace MT32Emu {
+
+RhythmHitCache::RhythmHitCache(size_t useSampleSize) : sampleSize(useSampleSize), useCount(0) {
+	for (Bit32u i = 0; i < MAX_ENTRY_COUNT; i++) {
+		Entry &entry = entries[i];
+		entry.patchCache = NULL;
+		entry.generation = 0;
+		entry.recording = false;
+		entry.length = 0;
+		entry.lastUse = 0;
+		entry.controlHashes = NULL;
+		entry.pitches = NULL;
+		entry.slavePitches = NULL;
+		entry.outputs = NULL;
+	}
+}
+
+RhythmHitCache::~RhythmHitCache() {
+	for (Bit32u i = 0; i < MAX_ENTRY_COUNT; i++) {
+		Entry &entry = entries[i];
+		delete[] entry.controlHashes;
+		delete[] entry.pitches;
+		delete[] entry.slavePitches;
+		delete[] entry.outputs;
+	}
+}
+
+void RhythmHitCache::allocate() {
+	for (Bit32u i = 0; i < MAX_ENTRY_COUNT; i++) {
+		Entry &entry = entries[i];
+		if (entry.controlHashes != NULL) continue;
+		entry.controlHashes = new Bit32u[MAX_HIT_LENGTH];
+		entry.pitches = new Bit16u[MAX_HIT_LENGTH];
+		entry.slavePitches = new Bit16u[MAX_HIT_LENGTH];
+		entry.outputs = new Bit8u[MAX_HIT_LENGTH * sampleSize];
+	}
+}
+
+void RhythmHitCache::freeEntry(Entry &entry) {
+	if (entry.patchCache == NULL) return;
+	entry.patchCache = NULL;
+	entry.generation++;
+	entry.recording = false;
+	entry.length = 0;
+}
+
+RhythmHitCache::Entry *RhythmHitCache::startHit(const PatchCache *patchCache, Bit32u drumNum, Bit32u velocity) {
+	Entry *victim = NULL;
+	for (Bit32u i = 0; i < MAX_ENTRY_COUNT; i++) {
+		Entry &entry = entries[i];
+		if (entry.patchCache == patchCache && entry.velocity == velocity) {
+			if (entry.recording) return NULL;
+			entry.lastUse = ++useCount;
+			return &entry;
+		}
+		// The free entries come first, then the least recently used ones.
+		if (victim == NULL || (victim->patchCache != NULL && (entry.patchCache == NULL || entry.lastUse < victim->lastUse))) {
+			victim = &entry;
+		}
+	}
+	freeEntry(*victim);
+	victim->patchCache = patchCache;
+	victim->drumNum = drumNum;
+	victim->velocity = velocity;
+	victim->recording = true;
+	victim->lastUse = ++useCount;
+	return victim;
+}
+
+void RhythmHitCache::finishHit(Entry *entry) {
+	if (entry->length == 0) {
+		freeEntry(*entry);
+	} else {
+		entry->recording = false;
+	}
+}
+
+void RhythmHitCache::invalidateDrums(Bit32u firstDrum, Bit32u lastDrum) {
+	for (Bit32u i = 0; i < MAX_ENTRY_COUNT; i++) {
+		Entry &entry = entries[i];
+		if (entry.patchCache != NULL && firstDrum <= entry.drumNum && entry.drumNum <= lastDrum) {
+			freeEntry(entry);
+		}
+	}
+}
+
+void RhythmHitCache::clear() {
+	for (Bit32u i = 0; i < MAX_ENTRY_COUNT; i++) {
+		freeEntry(entries[i]);
+	}
+}
+
+} // namespace MT32Emu
@@ -0,0 +1,101 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MT32EMU_RHYTHM_HIT_CACHE_H
+#define MT32EMU_RHYTHM_HIT_CACHE_H
+
+#include <cstddef>
+
+#include "globals.h"
+#include "Types.h"
+
+namespace MT32Emu {
+
+struct PatchCache;
+
+/**
+ * Keeps the output of the wave generator pairs recorded while the rhythm part partials play, so that the later hits
+ * of the same drum with the same velocity can replay it instead of generating the waves again. Along with each sample
+ * of the output, the pitches and a hash of the amp and cutoff values the wave generators of the pair were fed with
+ * are recorded. The envelopes of the replaying partial are evaluated as usual, and the replay is only valid as long as
+ * the hashes match. The pitches are excluded, since TVP varies the timing of the pitch envelope randomly, so a replayed
+ * hit just takes over the timing of the recorded one. The wave generators skip through the replayed samples following
+ * the recorded pitches, so that the partial resumes generating the waves where the recording leaves off once the hashes
+ * don't match or the recording ends.
+ *
+ * The entries are only accessed by the partials while rendering, and only created, evicted and invalidated while
+ * the MIDI events are played. A partial keeps the generation of the entry it started with, and drops the entry
+ * once the generation changes, which happens whenever the entry is evicted or invalidated.
+ */
+class RhythmHitCache {
+public:
+	static const Bit32u MAX_ENTRY_COUNT = 64;
+	// Number of samples recorded in an entry at most, the rest of the hit is always rendered as usual.
+	static const Bit32u MAX_HIT_LENGTH = 32768;
+
+	struct Entry {
+		// Identifies the hit along with the velocity. Points to the drum cache of the partial, NULL if the entry is free.
+		const PatchCache *patchCache;
+		Bit32u drumNum;
+		Bit32u velocity;
+		Bit32u generation;
+		// Set until the partial that records the entry stops.
+		bool recording;
+		// Number of samples recorded so far.
+		Bit32u length;
+		// Value of useCount upon the last hit, the least recently used entry is evicted first.
+		Bit32u lastUse;
+		// All allocated for MAX_HIT_LENGTH samples by allocate(), NULL until then.
+		// The outputs are of the sample type the synth renders with.
+		Bit32u *controlHashes;
+		Bit16u *pitches;
+		Bit16u *slavePitches;
+		Bit8u *outputs;
+	};
+
+	explicit RhythmHitCache(size_t sampleSize);
+	~RhythmHitCache();
+
+	// Allocates the memory of the recordings of all the entries unless done already. Must be invoked before starting
+	// the hits, so that the rendering never allocates memory. The memory is kept until the cache is destroyed.
+	void allocate();
+	// Returns the entry recorded for the hit if complete, or a new entry for the partial to record, with the recording
+	// flag set. Returns NULL if the hit is being recorded by another partial. The least recently used entry is evicted
+	// to make room for the new one.
+	Entry *startHit(const PatchCache *patchCache, Bit32u drumNum, Bit32u velocity);
+	// Completes the recording of the entry by the partial. An empty entry is freed, so that the next hit records again.
+	static void finishHit(Entry *entry);
+	// Frees the entries of the drums within the specified range.
+	void invalidateDrums(Bit32u firstDrum, Bit32u lastDrum);
+	// Frees all the entries, keeping the memory of the recordings.
+	void clear();
+
+private:
+	const size_t sampleSize;
+	Bit32u useCount;
+	Entry entries[MAX_ENTRY_COUNT];
+
+	static void freeEntry(Entry &entry);
+
+	// Make RhythmHitCache an identity class.
+	RhythmHitCache(const RhythmHitCache &);
+	RhythmHitCache &operator=(const RhythmHitCache &);
+}; // class RhythmHitCache
+
+} // namespace MT32Emu
+
+#endif // #ifndef MT32EMU_RHYTHM_HIT_CACHE_H
@@ -26,23 +26,45 @@
 #include "srchelper/InternalResampler.h"
 #endif
 
+#include "Kernels.h"
 #include "Synth.h"
 
 using namespace MT32Emu;
 
-static inline void *createDelegate(Synth &synth, double targetSampleRate, SamplerateConversionQuality quality) {
+static const unsigned int CHANNEL_COUNT = 2;
+
+static inline void *createDelegate(Synth &synth, double targetSampleRate, SamplerateConversionQuality quality, bool variableRatio) {
 #if MT32EMU_WITH_LIBSOXR_RESAMPLER
-	return new SoxrAdapter(synth, targetSampleRate, quality);
+	return new SoxrAdapter(synth, targetSampleRate, quality, variableRatio);
 #elif MT32EMU_WITH_LIBSAMPLERATE_RESAMPLER
-	return new SamplerateAdapter(synth, targetSampleRate, quality);
+	return new SamplerateAdapter(synth, targetSampleRate, quality, variableRatio);
 #elif MT32EMU_WITH_INTERNAL_RESAMPLER
-	return new InternalResampler(synth, targetSampleRate, quality);
+	return new InternalResampler(synth, targetSampleRate, quality, variableRatio);
 #else
-	(void)synth, (void)targetSampleRate, (void)quality;
+	(void)synth, (void)targetSampleRate, (void)quality, (void)variableRatio;
 	return NULL;
 #endif
 }
 
+static inline void *createStreamsDelegate(Synth &synth, double targetSampleRate, SamplerateConversionQuality quality, bool variableRatio) {
+#if MT32EMU_WITH_INTERNAL_RESAMPLER && !MT32EMU_WITH_LIBSOXR_RESAMPLER && !MT32EMU_WITH_LIBSAMPLERATE_RESAMPLER
+	return new InternalStreamsResampler(synth, targetSampleRate, quality, variableRatio);
+#else
+	(void)synth, (void)targetSampleRate, (void)quality, (void)variableRatio;
+	return NULL;
+#endif
+}
+
+template <class Sample>
+static inline void muteStreams(const DACOutputStreams<Sample> &streams, unsigned int length) {
+	Synth::muteSampleBuffer(streams.nonReverbLeft, length);
+	Synth::muteSampleBuffer(streams.nonReverbRight, length);
+	Synth::muteSampleBuffer(streams.reverbDryLeft, length);
+	Synth::muteSampleBuffer(streams.reverbDryRight, length);
+	Synth::muteSampleBuffer(streams.reverbWetLeft, length);
+	Synth::muteSampleBuffer(streams.reverbWetRight, length);
+}
+
 AnalogOutputMode SampleRateConverter::getBestAnalogOutputMode(double targetSampleRate) {
 	if (Synth::getStereoOutputSampleRate(AnalogOutputMode_ACCURATE) < targetSampleRate) {
 		return AnalogOutputMode_OVERSAMPLED;
@@ -63,12 +85,32 @@ double SampleRateConverter::getSupportedOutputSampleRate(double desiredSampleRat
 
 SampleRateConverter::SampleRateConverter(Synth &useSynth, double targetSampleRate, SamplerateConversionQuality useQuality) :
 	synthInternalToTargetSampleRateRatio(SAMPLE_RATE / targetSampleRate),
+	outputStreams(false),
 	useSynthDelegate(useSynth.getStereoOutputSampleRate() == targetSampleRate),
-	srcDelegate(useSynthDelegate ? &useSynth : createDelegate(useSynth, targetSampleRate, useQuality))
+	srcDelegate(useSynthDelegate ? &useSynth : createDelegate(useSynth, targetSampleRate, useQuality, false))
+{}
+
+SampleRateConverter::SampleRateConverter(Synth &useSynth, double targetSampleRate, SamplerateConversionQuality useQuality, bool variableRatio) :
+	synthInternalToTargetSampleRateRatio(SAMPLE_RATE / targetSampleRate),
+	outputStreams(false),
+	useSynthDelegate(!variableRatio && useSynth.getStereoOutputSampleRate() == targetSampleRate),
+	srcDelegate(useSynthDelegate ? &useSynth : createDelegate(useSynth, targetSampleRate, useQuality, variableRatio))
+{}
+
+SampleRateConverter::SampleRateConverter(Synth &useSynth, double targetSampleRate, SamplerateConversionQuality useQuality, bool variableRatio, bool useOutputStreams) :
+	synthInternalToTargetSampleRateRatio(SAMPLE_RATE / targetSampleRate),
+	outputStreams(useOutputStreams),
+	useSynthDelegate(!variableRatio && (outputStreams ? SAMPLE_RATE : useSynth.getStereoOutputSampleRate()) == targetSampleRate),
+	srcDelegate(useSynthDelegate ? &useSynth : outputStreams ? createStreamsDelegate(useSynth, targetSampleRate, useQuality, variableRatio)
+		: createDelegate(useSynth, targetSampleRate, useQuality, variableRatio))
 {}
 
 SampleRateConverter::~SampleRateConverter() {
-	if (!useSynthDelegate) {
+	if (outputStreams) {
+#if MT32EMU_WITH_INTERNAL_RESAMPLER && !MT32EMU_WITH_LIBSOXR_RESAMPLER && !MT32EMU_WITH_LIBSAMPLERATE_RESAMPLER
+		if (!useSynthDelegate) delete static_cast<InternalStreamsResampler *>(srcDelegate);
+#endif
+	} else if (!useSynthDelegate) {
 #if MT32EMU_WITH_LIBSOXR_RESAMPLER
 		delete static_cast<SoxrAdapter *>(srcDelegate);
 #elif MT32EMU_WITH_LIBSAMPLERATE_RESAMPLER
@@ -80,11 +122,18 @@ SampleRateConverter::~SampleRateConverter() {
 }
 
 void SampleRateConverter::getOutputSamples(float *buffer, unsigned int length) {
+	if (outputStreams) {
+		Synth::muteSampleBuffer(buffer, CHANNEL_COUNT * length);
+		return;
+	}
 	if (useSynthDelegate) {
 		static_cast<Synth *>(srcDelegate)->render(buffer, length);
 		return;
 	}
 
+	// The resampler filters run outside Synth::render() as well.
+	DenormalsFlushScope denormalsFlushScope;
+
 #if MT32EMU_WITH_LIBSOXR_RESAMPLER
 	static_cast<SoxrAdapter *>(srcDelegate)->getOutputSamples(buffer, length);
 #elif MT32EMU_WITH_LIBSAMPLERATE_RESAMPLER
@@ -96,14 +145,45 @@ void SampleRateConverter::getOutputSamples(float *buffer, unsigned int length) {
 #endif
 }
 
-void SampleRateConverter::getOutputSamples(Bit16s *outBuffer, unsigned int length) {
-	static const unsigned int CHANNEL_COUNT = 2;
+bool SampleRateConverter::setRateAdjustment(double rateAdjustment) {
+	if (useSynthDelegate || !(SAMPLE_RATE_CONVERTER_MIN_RATE_ADJUSTMENT <= rateAdjustment && rateAdjustment <= SAMPLE_RATE_CONVERTER_MAX_RATE_ADJUSTMENT)) {
+		return false;
+	}
 
+	if (outputStreams) {
+#if MT32EMU_WITH_INTERNAL_RESAMPLER && !MT32EMU_WITH_LIBSOXR_RESAMPLER && !MT32EMU_WITH_LIBSAMPLERATE_RESAMPLER
+		return static_cast<InternalStreamsResampler *>(srcDelegate)->setRateAdjustment(rateAdjustment);
+#else
+		return false;
+#endif
+	}
+
+#if MT32EMU_WITH_LIBSOXR_RESAMPLER
+	return static_cast<SoxrAdapter *>(srcDelegate)->setRateAdjustment(rateAdjustment);
+#elif MT32EMU_WITH_LIBSAMPLERATE_RESAMPLER
+	return static_cast<SamplerateAdapter *>(srcDelegate)->setRateAdjustment(rateAdjustment);
+#elif MT32EMU_WITH_INTERNAL_RESAMPLER
+	return static_cast<InternalResampler *>(srcDelegate)->setRateAdjustment(rateAdjustment);
+#else
+	return false;
+#endif
+}
+
+void SampleRateConverter::getOutputSamples(Bit16s *outBuffer, unsigned int length) {
+	if (outputStreams) {
+		Synth::muteSampleBuffer(outBuffer, CHANNEL_COUNT * length);
+		return;
+	}
 	if (useSynthDelegate) {
 		static_cast<Synth *>(srcDelegate)->render(outBuffer, length);
 		return;
 	}
 
+	DenormalsFlushScope denormalsFlushScope;
+
+#if MT32EMU_WITH_INTERNAL_RESAMPLER && !MT32EMU_WITH_LIBSOXR_RESAMPLER && !MT32EMU_WITH_LIBSAMPLERATE_RESAMPLER
+	static_cast<InternalResampler *>(srcDelegate)->getOutputSamples(outBuffer, length);
+#else
 	float floatBuffer[CHANNEL_COUNT * MAX_SAMPLES_PER_RUN];
 	while (length > 0) {
 		const unsigned int size = MAX_SAMPLES_PER_RUN < length ? MAX_SAMPLES_PER_RUN : length;
@@ -115,6 +195,120 @@ void SampleRateConverter::getOutputSamples(Bit16s *outBuffer, unsigned int lengt
 		}
 		length -= size;
 	}
+#endif
+}
+
+void SampleRateConverter::getOutputSamples(float *leftBuffer, float *rightBuffer, unsigned int length) {
+	if (outputStreams) {
+		Synth::muteSampleBuffer(leftBuffer, length);
+		Synth::muteSampleBuffer(rightBuffer, length);
+		return;
+	}
+	if (useSynthDelegate) {
+		static_cast<Synth *>(srcDelegate)->render(leftBuffer, rightBuffer, length);
+		return;
+	}
+
+	DenormalsFlushScope denormalsFlushScope;
+
+#if MT32EMU_WITH_INTERNAL_RESAMPLER && !MT32EMU_WITH_LIBSOXR_RESAMPLER && !MT32EMU_WITH_LIBSAMPLERATE_RESAMPLER
+	static_cast<InternalResampler *>(srcDelegate)->getOutputSamples(leftBuffer, rightBuffer, length);
+#else
+	// External resamplers only produce interleaved output
+	float floatBuffer[CHANNEL_COUNT * MAX_SAMPLES_PER_RUN];
+	while (length > 0) {
+		const unsigned int size = MAX_SAMPLES_PER_RUN < length ? MAX_SAMPLES_PER_RUN : length;
+		getOutputSamples(floatBuffer, size);
+		const float *ins = floatBuffer;
+		for (unsigned int i = 0; i < size; i++) {
+			*(leftBuffer++) = *(ins++);
+			*(rightBuffer++) = *(ins++);
+		}
+		length -= size;
+	}
+#endif
+}
+
+void SampleRateConverter::getOutputStreams(const DACOutputStreams<Bit16s> &streams, unsigned int length) {
+	if (!outputStreams) {
+		muteStreams(streams, length);
+		return;
+	}
+	if (useSynthDelegate) {
+		static_cast<Synth *>(srcDelegate)->renderStreams(streams, length);
+		return;
+	}
+
+	DenormalsFlushScope denormalsFlushScope;
+
+#if MT32EMU_WITH_INTERNAL_RESAMPLER && !MT32EMU_WITH_LIBSOXR_RESAMPLER && !MT32EMU_WITH_LIBSAMPLERATE_RESAMPLER
+	static_cast<InternalStreamsResampler *>(srcDelegate)->getOutputStreams(streams, length);
+#else
+	muteStreams(streams, length);
+#endif
+}
+
+void SampleRateConverter::getOutputStreams(const DACOutputStreams<float> &streams, unsigned int length) {
+	if (!outputStreams) {
+		muteStreams(streams, length);
+		return;
+	}
+	if (useSynthDelegate) {
+		static_cast<Synth *>(srcDelegate)->renderStreams(streams, length);
+		return;
+	}
+
+	DenormalsFlushScope denormalsFlushScope;
+
+#if MT32EMU_WITH_INTERNAL_RESAMPLER && !MT32EMU_WITH_LIBSOXR_RESAMPLER && !MT32EMU_WITH_LIBSAMPLERATE_RESAMPLER
+	static_cast<InternalStreamsResampler *>(srcDelegate)->getOutputStreams(streams, length);
+#else
+	muteStreams(streams, length);
+#endif
+}
+
+double SampleRateConverter::getLatency() const {
+	if (useSynthDelegate) return 0.0;
+
+	if (outputStreams) {
+#if MT32EMU_WITH_INTERNAL_RESAMPLER && !MT32EMU_WITH_LIBSOXR_RESAMPLER && !MT32EMU_WITH_LIBSAMPLERATE_RESAMPLER
+		return static_cast<InternalStreamsResampler *>(srcDelegate)->getLatency();
+#else
+		return 0.0;
+#endif
+	}
+
+#if MT32EMU_WITH_LIBSOXR_RESAMPLER
+	return static_cast<SoxrAdapter *>(srcDelegate)->getLatency();
+#elif MT32EMU_WITH_LIBSAMPLERATE_RESAMPLER
+	return static_cast<SamplerateAdapter *>(srcDelegate)->getLatency();
+#elif MT32EMU_WITH_INTERNAL_RESAMPLER
+	return static_cast<InternalResampler *>(srcDelegate)->getLatency();
+#else
+	return 0.0;
+#endif
+}
+
+size_t SampleRateConverter::getMemoryUsage() const {
+	if (useSynthDelegate) return sizeof(*this);
+
+	if (outputStreams) {
+#if MT32EMU_WITH_INTERNAL_RESAMPLER && !MT32EMU_WITH_LIBSOXR_RESAMPLER && !MT32EMU_WITH_LIBSAMPLERATE_RESAMPLER
+		return sizeof(*this) + static_cast<InternalStreamsResampler *>(srcDelegate)->getMemoryUsage();
+#else
+		return sizeof(*this);
+#endif
+	}
+
+#if MT32EMU_WITH_LIBSOXR_RESAMPLER
+	return sizeof(*this) + static_cast<SoxrAdapter *>(srcDelegate)->getMemoryUsage();
+#elif MT32EMU_WITH_LIBSAMPLERATE_RESAMPLER
+	return sizeof(*this) + static_cast<SamplerateAdapter *>(srcDelegate)->getMemoryUsage();
+#elif MT32EMU_WITH_INTERNAL_RESAMPLER
+	return sizeof(*this) + static_cast<InternalResampler *>(srcDelegate)->getMemoryUsage();
+#else
+	return sizeof(*this);
+#endif
 }
 
 double SampleRateConverter::convertOutputToSynthTimestamp(double outputTimestamp) const {
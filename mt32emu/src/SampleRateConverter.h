@@ -17,6 +17,8 @@
 #ifndef MT32EMU_SAMPLE_RATE_CONVERTER_H
 #define MT32EMU_SAMPLE_RATE_CONVERTER_H
 
+#include <cstddef>
+
 #include "globals.h"
 #include "Types.h"
 #include "Enumerations.h"
@@ -24,12 +26,20 @@
 namespace MT32Emu {
 
 class Synth;
+template <class T> struct DACOutputStreams;
+
+// Limits of the rate adjustment accepted by SampleRateConverter::setRateAdjustment().
+const double SAMPLE_RATE_CONVERTER_MIN_RATE_ADJUSTMENT = 0.99;
+const double SAMPLE_RATE_CONVERTER_MAX_RATE_ADJUSTMENT = 1.01;
 
 /* SampleRateConverter class allows to convert the synthesiser output to any desired sample rate.
  * It processes the completely mixed stereo output signal as it passes the analogue circuit emulation,
  * so emulating the synthesiser output signal passing further through an ADC.
  * Several conversion quality options are provided which allow to trade-off the conversion speed vs. the passband width.
  * All the options except FASTEST guarantee full suppression of the aliasing noise in terms of the 16-bit integer samples.
+ * When the internal resampler is used and the synth renders with RendererType_BIT16S, the conversion is performed using
+ * fixed-point arithmetic only, which is much faster on platforms lacking a capable FPU. The output is then limited to
+ * 16-bit precision regardless of the sample format requested.
  */
 class MT32EMU_EXPORT SampleRateConverter {
 public:
@@ -44,6 +54,19 @@ public:
 	// Creates a SampleRateConverter instance that converts output signal from the synth to the given sample rate
 	// with the specified conversion quality.
 	SampleRateConverter(Synth &synth, double targetSampleRate, SamplerateConversionQuality quality);
+
+	// Creates a SampleRateConverter instance as above. When variableRatio is true, the conversion ratio can be adjusted
+	// while rendering using setRateAdjustment(), e.g. to follow the actual clock of an audio device. This mode may be
+	// somewhat slower, and the conversion is performed even when the target sample rate matches the synth output.
+	SampleRateConverter(Synth &synth, double targetSampleRate, SamplerateConversionQuality quality, bool variableRatio);
+
+	// Creates a SampleRateConverter instance as above. When outputStreams is true, the converter processes the separate
+	// DAC output streams of the synth (see Synth::renderStreams()) rather than the mixed output, and the results are retrieved
+	// using getOutputStreams(), while getOutputSamples() only produces silence. Since the streams bypass the analogue circuit
+	// emulation, they are converted from the internal synth sample rate (32000 Hz) regardless of the analog output mode.
+	// The synth is rendered once for all the streams. This mode requires the internal resampler, the streams are muted
+	// when the library is built with an external one.
+	SampleRateConverter(Synth &synth, double targetSampleRate, SamplerateConversionQuality quality, bool variableRatio, bool outputStreams);
 	~SampleRateConverter();
 
 	// Fills the provided output buffer with the results of the sample rate conversion.
@@ -54,18 +77,48 @@ public:
 	// The input samples are automatically retrieved from the synth as necessary.
 	void getOutputSamples(float *buffer, unsigned int length);
 
+	// Same as above but fills separate buffers for the left and right channels.
+	void getOutputSamples(float *leftBuffer, float *rightBuffer, unsigned int length);
+
+	// Fills the provided output stream buffers with the results of the sample rate conversion of the respective streams.
+	// As with Synth::renderStreams(), NULL skips a stream. Only works with the converter created to output streams.
+	void getOutputStreams(const DACOutputStreams<Bit16s> &streams, unsigned int length);
+
+	// Same as above but for float samples.
+	void getOutputStreams(const DACOutputStreams<float> &streams, unsigned int length);
+
+	// Scales the effective target sample rate by the specified factor, which must lie within the range
+	// [SAMPLE_RATE_CONVERTER_MIN_RATE_ADJUSTMENT, SAMPLE_RATE_CONVERTER_MAX_RATE_ADJUSTMENT]. The change takes effect
+	// with the following call to getOutputSamples(). Returns false if the factor is out of range or the conversion ratio
+	// cannot be adjusted, which never happens when the converter is created in the variable-ratio mode.
+	bool setRateAdjustment(double rateAdjustment);
+
+	// Returns the delay the conversion introduces to the low-frequency content of the signal, in samples at the target
+	// sample rate. The delay can be minimised using SamplerateConversionQuality_LOW_LATENCY. In the oversampled analog
+	// output mode, this may include the delay of the analog LPF as the internal converter applies it in place of the synth.
+	// Returns a negative value if the delay is unknown, which is the case with libsamplerate.
+	double getLatency() const;
+
+	// Returns the number of bytes occupied by the converter, including the filter delay lines and coefficients of the internal
+	// resampler. The internal state of libsoxr and libsamplerate is opaque, so only the buffers of their adapters are reported.
+	// The synth itself isn't accounted for, see Synth::getMemoryUsage().
+	size_t getMemoryUsage() const;
+
 	// Returns the number of samples produced at the internal synth sample rate (32000 Hz)
 	// that correspond to the number of samples at the target sample rate.
 	// Intended to facilitate audio time synchronisation.
+	// Note, the nominal target sample rate is assumed, regardless of the current rate adjustment.
 	double convertOutputToSynthTimestamp(double outputTimestamp) const;
 
 	// Returns the number of samples produced at the target sample rate
 	// that correspond to the number of samples at the internal synth sample rate (32000 Hz).
 	// Intended to facilitate audio time synchronisation.
+	// Note, the nominal target sample rate is assumed, regardless of the current rate adjustment.
 	double convertSynthToOutputTimestamp(double synthTimestamp) const;
 
 private:
 	const double synthInternalToTargetSampleRateRatio;
+	const bool outputStreams;
 	const bool useSynthDelegate;
 	void * const srcDelegate;
 }; // class SampleRateConverter
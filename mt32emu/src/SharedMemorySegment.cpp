@@ -0,0 +1,244 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#if defined(_POSIX_SHARED_MEMORY_OBJECTS) && _POSIX_SHARED_MEMORY_OBJECTS > 0
+#define MT32EMU_USE_SHM
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#endif
+
+#include "internals.h"
+
+#include "SharedMemorySegment.h"
+#include "MemoryFence.h"
+
+namespace MT32Emu {
+
+namespace {
+
+const char ENVIRONMENT_VARIABLE[] = "MT32EMU_SHARED_MEMORY_CACHE";
+
+// Part of the segment names, it has to be bumped whenever the layout of the data held in the segments changes,
+// so that the processes running different versions of the library never attach to each other's segments.
+const char NAME_PREFIX[] = "mt32emu1-";
+
+const size_t KEY_SIZE = 108;
+const Bit32u STATE_READY = 0x59445952;
+
+struct Header {
+	char key[KEY_SIZE];
+	Bit32u dataSize;
+	// The data is only valid once this is set to STATE_READY.
+	volatile Bit32u state;
+	Bit32u creatorProcessId;
+	Bit32u reserved;
+};
+
+// Keeps the data area aligned to a cache line, given that the segments are mapped at the page boundaries.
+const size_t HEADER_SIZE = 128;
+
+bool isCacheEnabled() {
+	const char *value = getenv(ENVIRONMENT_VARIABLE);
+	return value != NULL && *value != 0 && strcmp(value, "0") != 0;
+}
+
+// The names are limited to 31 characters on some systems, so the key is hashed, twice with FNV-1a using distinct
+// offset bases to make up 64 bits. The collisions are told apart by the key in the header anyway.
+void makeName(char *name, const char *key) {
+#if defined(_WIN32)
+	static const char NAMESPACE_PREFIX[] = "Local\\";
+#else
+	static const char NAMESPACE_PREFIX[] = "/";
+#endif
+	static const char HEX_DIGITS[] = "0123456789abcdef";
+
+	Bit32u hashes[] = {2166136261U, 3735928559U};
+	for (const char *c = key; *c != 0; c++) {
+		for (int i = 0; i < 2; i++) {
+			hashes[i] = (hashes[i] ^ Bit8u(*c)) * 16777619U;
+		}
+	}
+	strcpy(name, NAMESPACE_PREFIX);
+	strcat(name, NAME_PREFIX);
+	char *digit = name + strlen(name);
+	for (int i = 0; i < 2; i++) {
+		for (int shift = 28; shift >= 0; shift -= 4) {
+			*(digit++) = HEX_DIGITS[(hashes[i] >> shift) & 0xF];
+		}
+	}
+	*digit = 0;
+}
+
+#if defined(MT32EMU_USE_SHM)
+Bit32u getProcessId() {
+	return Bit32u(getpid());
+}
+
+// Unlike a mere ftruncate(), this makes sure the pages are available in advance, so that filling in the data cannot fault
+// when the file system that backs the segments runs out of space.
+bool reserveSegment(int fd, size_t size) {
+#if defined(_POSIX_ADVISORY_INFO) && _POSIX_ADVISORY_INFO > 0
+	return posix_fallocate(fd, 0, off_t(size)) == 0;
+#else
+	return ftruncate(fd, off_t(size)) == 0;
+#endif
+}
+
+// A segment that remains unpublished after its creator is gone would otherwise stay unusable until the system restarts.
+void removeAbandonedSegment(const char *name, const Header *header) {
+	if (header->creatorProcessId != 0 && kill(pid_t(header->creatorProcessId), 0) != 0 && errno == ESRCH) {
+		shm_unlink(name);
+	}
+}
+#elif defined(_WIN32)
+Bit32u getProcessId() {
+	return Bit32u(GetCurrentProcessId());
+}
+#endif
+
+} // namespace
+
+SharedMemorySegment *SharedMemorySegment::open(const char *key, size_t dataSize) {
+	if (!isCacheEnabled() || strlen(key) >= KEY_SIZE || dataSize > 0x7FFFFFFF - HEADER_SIZE) return NULL;
+
+	char name[32];
+	makeName(name, key);
+	const size_t size = HEADER_SIZE + dataSize;
+
+#if defined(_WIN32)
+	HANDLE mappingHandle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, DWORD(size), name);
+	if (mappingHandle == NULL) return NULL;
+	const bool created = GetLastError() != ERROR_ALREADY_EXISTS;
+	// The view of an existing mapping, which is smaller than expected, cannot be mapped.
+	void *address = MapViewOfFile(mappingHandle, created ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+	if (address == NULL) {
+		CloseHandle(mappingHandle);
+		return NULL;
+	}
+	SharedMemorySegment *segment = new SharedMemorySegment(address, size, created, mappingHandle);
+#elif defined(MT32EMU_USE_SHM)
+	int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+	const bool created = fd != -1;
+	if (created) {
+		if (!reserveSegment(fd, size)) {
+			close(fd);
+			shm_unlink(name);
+			return NULL;
+		}
+	} else {
+		if (errno != EEXIST) return NULL;
+		fd = shm_open(name, O_RDONLY, 0);
+		if (fd == -1) return NULL;
+		// Another user may have created the segment, and the creator may not have sized the segment yet.
+		struct stat fileStat;
+		if (fstat(fd, &fileStat) != 0 || fileStat.st_uid != geteuid() || fileStat.st_size != off_t(size)) {
+			close(fd);
+			return NULL;
+		}
+	}
+	void *address = mmap(NULL, size, created ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (address == MAP_FAILED) {
+		if (created) shm_unlink(name);
+		return NULL;
+	}
+	SharedMemorySegment *segment = new SharedMemorySegment(address, size, created, name);
+#else
+	return NULL;
+#endif
+
+#if defined(_WIN32) || defined(MT32EMU_USE_SHM)
+	Header *header = static_cast<Header *>(segment->address);
+	if (created) {
+		strcpy(header->key, key);
+		header->dataSize = Bit32u(dataSize);
+		header->creatorProcessId = getProcessId();
+		return segment;
+	}
+	const bool ready = header->state == STATE_READY;
+	memoryFence();
+	if (ready && header->dataSize == dataSize && strncmp(header->key, key, KEY_SIZE) == 0) return segment;
+#if defined(MT32EMU_USE_SHM)
+	if (!ready) removeAbandonedSegment(name, header);
+#endif
+	delete segment;
+	return NULL;
+#endif
+}
+
+#if defined(_WIN32)
+SharedMemorySegment::SharedMemorySegment(void *useAddress, size_t useSize, bool useCreated, void *useMappingHandle) :
+	address(useAddress), size(useSize), created(useCreated), published(false), mappingHandle(useMappingHandle)
+{}
+#else
+SharedMemorySegment::SharedMemorySegment(void *useAddress, size_t useSize, bool useCreated, const char *useName) :
+	address(useAddress), size(useSize), created(useCreated), published(false)
+{
+	strcpy(name, useName);
+}
+#endif
+
+SharedMemorySegment::~SharedMemorySegment() {
+#if defined(_WIN32)
+	UnmapViewOfFile(address);
+	CloseHandle(mappingHandle);
+#elif defined(MT32EMU_USE_SHM)
+	munmap(address, size);
+	if (created && !published) shm_unlink(name);
+#endif
+}
+
+bool SharedMemorySegment::isCreated() const {
+	return created;
+}
+
+const void *SharedMemorySegment::getData() const {
+	return static_cast<const Bit8u *>(address) + HEADER_SIZE;
+}
+
+void *SharedMemorySegment::getWritableData() const {
+	return static_cast<Bit8u *>(address) + HEADER_SIZE;
+}
+
+void SharedMemorySegment::publish() {
+	memoryFence();
+	static_cast<Header *>(address)->state = STATE_READY;
+	published = true;
+#if defined(_WIN32)
+	DWORD oldProtection;
+	VirtualProtect(address, size, PAGE_READONLY, &oldProtection);
+#elif defined(MT32EMU_USE_SHM)
+	mprotect(address, size, PROT_READ);
+#endif
+}
+
+} // namespace MT32Emu
@@ -0,0 +1,81 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MT32EMU_SHARED_MEMORY_SEGMENT_H
+#define MT32EMU_SHARED_MEMORY_SEGMENT_H
+
+#include <cstddef>
+
+#include "globals.h"
+#include "Types.h"
+
+namespace MT32Emu {
+
+/**
+ * A named segment of memory shared among processes, which holds read-only data derived from the ROM images.
+ * Only the first process has to build the data, the others merely map the pages it has filled in.
+ * The segments are only used when the environment variable MT32EMU_SHARED_MEMORY_CACHE is set to a value other than 0.
+ * The segment starts with a header that identifies the data with a key, since the name of the segment is merely derived
+ * from a hash of the key to fit the limits of the system. The processes that attach only use the data once the process
+ * that created the segment has filled it in and published it. Until then, and whenever the segment is unusable,
+ * they build private copies as usual.
+ * On POSIX systems, the segments outlive the processes until the system restarts, so that the processes started later
+ * still attach, and a segment is only shared among the processes of the user that created it. On Windows, a segment
+ * goes away along with the last process that has it mapped.
+ */
+class SharedMemorySegment {
+public:
+	// Attaches to the segment identified by the key, or creates it with a data area of the specified size if missing.
+	// Returns NULL if the cache is disabled or the segment cannot be used.
+	static SharedMemorySegment *open(const char *key, size_t dataSize);
+
+	// Returns true if this process has created the segment. It then has to fill in the data and publish it.
+	bool isCreated() const;
+	// The data area is aligned to 64 bytes. It is only writable until published by the process that created the segment.
+	const void *getData() const;
+	void *getWritableData() const;
+	// Makes the data available to the other processes and write-protects the pages.
+	void publish();
+
+	// Unmaps the segment. A segment created by this process that has not been published is also removed.
+	~SharedMemorySegment();
+
+private:
+	void * const address;
+	const size_t size;
+	const bool created;
+	bool published;
+#if defined(_WIN32)
+	void * const mappingHandle;
+#else
+	char name[32];
+#endif
+
+	// Make SharedMemorySegment an identity class.
+	SharedMemorySegment(const SharedMemorySegment &);
+	SharedMemorySegment &operator=(const SharedMemorySegment &);
+
+#if defined(_WIN32)
+	SharedMemorySegment(void *address, size_t size, bool created, void *mappingHandle);
+#else
+	SharedMemorySegment(void *address, size_t size, bool created, const char *name);
+#endif
+}; // class SharedMemorySegment
+
+} // namespace MT32Emu
+
+#endif // #ifndef MT32EMU_SHARED_MEMORY_SEGMENT_H
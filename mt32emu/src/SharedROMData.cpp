@@ -0,0 +1,150 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#if defined(_POSIX_THREADS) && _POSIX_THREADS > 0
+#define MT32EMU_USE_PTHREADS
+#include <pthread.h>
+#endif
+#endif
+
+#include "internals.h"
+
+#include "SharedMemorySegment.h"
+#include "SharedROMData.h"
+#include "Structures.h"
+
+namespace MT32Emu {
+
+namespace {
+
+// Guards the cache of the shared data, the same way as the cache of the resampler kernels is guarded.
+class CacheLock {
+public:
+	CacheLock() {
+#if defined(_WIN32)
+		EnterCriticalSection(&criticalSection.handle);
+#elif defined(MT32EMU_USE_PTHREADS)
+		pthread_mutex_lock(&mutex);
+#endif
+	}
+
+	~CacheLock() {
+#if defined(_WIN32)
+		LeaveCriticalSection(&criticalSection.handle);
+#elif defined(MT32EMU_USE_PTHREADS)
+		pthread_mutex_unlock(&mutex);
+#endif
+	}
+
+private:
+#if defined(_WIN32)
+	static struct CriticalSection {
+		CRITICAL_SECTION handle;
+
+		CriticalSection() {
+			InitializeCriticalSection(&handle);
+		}
+
+		~CriticalSection() {
+			DeleteCriticalSection(&handle);
+		}
+	} criticalSection;
+#elif defined(MT32EMU_USE_PTHREADS)
+	static pthread_mutex_t mutex;
+#endif
+};
+
+#if defined(_WIN32)
+CacheLock::CriticalSection CacheLock::criticalSection;
+#elif defined(MT32EMU_USE_PTHREADS)
+pthread_mutex_t CacheLock::mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+} // namespace
+
+SharedROMData *SharedROMData::cacheHead = NULL;
+
+const SharedROMData *SharedROMData::acquire(const ROMImage *controlROMImage, const ROMImage *pcmROMImage) {
+	CacheLock lock;
+	for (SharedROMData *data = cacheHead; data != NULL; data = data->next) {
+		if (data->controlROMImage == controlROMImage && data->pcmROMImage == pcmROMImage) {
+			data->referenceCount++;
+			return data;
+		}
+	}
+	return NULL;
+}
+
+const SharedROMData *SharedROMData::publish(SharedROMData *newData) {
+	CacheLock lock;
+	for (SharedROMData *data = cacheHead; data != NULL; data = data->next) {
+		// The ROM images remain valid for as long as the synths opened with them use the data.
+		if (data->controlROMImage == newData->controlROMImage && data->pcmROMImage == newData->pcmROMImage) return newData;
+	}
+	newData->next = cacheHead;
+	cacheHead = newData;
+	return newData;
+}
+
+SharedROMData::SharedROMData(const ROMImage *useControlROMImage, const ROMImage *usePCMROMImage, const MemParams *useDefaultMemParams, const Bit16s *usePCMWaveSlabs, size_t usePCMWaveSlabsSize, const float *useLinearPCMWaveSlabs, SharedMemorySegment *usePCMWavesSegment) :
+	controlROMImage(useControlROMImage),
+	pcmROMImage(usePCMROMImage),
+	defaultMemParams(*useDefaultMemParams),
+	pcmWaveSlabs(usePCMWaveSlabs),
+	pcmWaveSlabsSize(usePCMWaveSlabsSize),
+	linearPCMWaveSlabs(useLinearPCMWaveSlabs),
+	pcmWavesSegment(usePCMWavesSegment),
+	next(NULL),
+	referenceCount(1)
+{}
+
+SharedROMData::~SharedROMData() {
+	delete &defaultMemParams;
+	if (pcmWavesSegment == NULL) {
+		delete[] pcmWaveSlabs;
+		delete[] linearPCMWaveSlabs;
+	} else {
+		delete pcmWavesSegment;
+	}
+}
+
+void SharedROMData::release() const {
+	CacheLock lock;
+	if (--referenceCount > 0) return;
+	SharedROMData **link = &cacheHead;
+	while (*link != NULL && *link != this) link = &(*link)->next;
+	// The data remains off the cache when published concurrently with the same data from another synth.
+	if (*link == this) *link = next;
+	delete this;
+}
+
+size_t SharedROMData::getMemoryUsage() const {
+	size_t memoryUsage = sizeof(*this) + sizeof(MemParams) + pcmWaveSlabsSize * sizeof(Bit16s);
+	if (linearPCMWaveSlabs != NULL) memoryUsage += pcmWaveSlabsSize * sizeof(float);
+	return memoryUsage;
+}
+
+} // namespace MT32Emu
@@ -0,0 +1,86 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MT32EMU_SHARED_ROM_DATA_H
+#define MT32EMU_SHARED_ROM_DATA_H
+
+#include <cstddef>
+
+#include "globals.h"
+#include "Types.h"
+
+namespace MT32Emu {
+
+class ROMImage;
+class SharedMemorySegment;
+struct MemParams;
+
+/**
+ * Read-only data a synth derives from the ROM images when it opens: the default contents of the emulated memory,
+ * restored upon reset, and the slabs holding padded copies of the PCM waves, also converted to linear amplitudes
+ * for the float renderers. In the reduced memory footprint mode,
+ * the data is built by the first synth opened with a particular pair of ROM images and is then shared among all
+ * the synths in the process opened with the same ROM images. The data is released when the last one is closed.
+ * THREAD SAFETY: The methods are safe to invoke from several threads concurrently.
+ */
+class SharedROMData {
+public:
+	// Looks up the data derived from the specified ROM images and adds a reference to it. Returns NULL if not found.
+	static const SharedROMData *acquire(const ROMImage *controlROMImage, const ROMImage *pcmROMImage);
+	// Makes the data built by the caller available to the other synths, unless they have published the data derived
+	// from the same ROM images meanwhile, in which case it remains private to the caller. Either way, the caller holds
+	// a reference to the data from now on.
+	static const SharedROMData *publish(SharedROMData *data);
+
+	const ROMImage * const controlROMImage;
+	const ROMImage * const pcmROMImage;
+	const MemParams &defaultMemParams;
+	// Array, see Synth::initPCMList() for the layout
+	const Bit16s * const pcmWaveSlabs;
+	// In samples
+	const size_t pcmWaveSlabsSize;
+	// The waves converted to linear amplitudes in slabs of the same size, see Synth::initLinearPCMWaves().
+	// NULL unless the synth that built the data was opened with a float renderer or the data is held in a segment
+	// shared with other processes.
+	const float * const linearPCMWaveSlabs;
+
+	// Takes ownership of the provided arrays, or of the segment that holds them when shared with other processes.
+	SharedROMData(const ROMImage *controlROMImage, const ROMImage *pcmROMImage, const MemParams *defaultMemParams, const Bit16s *pcmWaveSlabs, size_t pcmWaveSlabsSize, const float *linearPCMWaveSlabs, SharedMemorySegment *pcmWavesSegment);
+
+	// Drops the reference held by the caller, the data is deleted when no references remain.
+	void release() const;
+
+	// Returns the number of bytes occupied by the data.
+	size_t getMemoryUsage() const;
+
+private:
+	static SharedROMData *cacheHead;
+
+	SharedMemorySegment * const pcmWavesSegment;
+	SharedROMData *next;
+	mutable Bit32u referenceCount;
+
+	~SharedROMData();
+
+	// Make SharedROMData an identity class.
+	SharedROMData(const SharedROMData &);
+	SharedROMData &operator=(const SharedROMData &);
+}; // class SharedROMData
+
+} // namespace MT32Emu
+
+#endif // #ifndef MT32EMU_SHARED_ROM_DATA_H
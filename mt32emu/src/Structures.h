@@ -234,6 +234,11 @@ struct PCMWaveEntry {
 	Bit32u addr;
 	Bit32u len;
 	bool loop;
+	// Points to the copy of the wave in its own slab, which is followed by a guard sample (see Synth::initPCMList()).
+	const Bit16s *data;
+	// Points to the copy of the wave converted to linear amplitudes, NULL unless a float renderer is selected
+	// (see Synth::initLinearPCMWaves()).
+	const float *linearData;
 	ControlROMPCMStruct *controlROMPCMStruct;
 };
 
@@ -241,6 +246,7 @@ struct PCMWaveEntry {
 struct PatchCache {
 	bool playPartial;
 	bool PCMPartial;
+	// Index in Synth::pcmWaves, adjusted for the PCM bank selected by the waveform parameter
 	int pcm;
 	Bit8u waveform;
 
@@ -256,6 +262,19 @@ struct PatchCache {
 
 	TimbreParam::PartialParam srcPartial;
 
+	// The following are the key- and velocity-independent terms of the envelope setup done at note-on,
+	// precomputed from srcPartial by TVA::cachePartialParams(), TVF::cachePartialParams() and TVP::cachePartialParams()
+	Bit8u tvaBiasAmpSubtractionCoeff1;
+	Bit8u tvaBiasAmpSubtractionCoeff2;
+	int tvaVeloMult;
+	int tvaAbsVeloMult;
+	int tvfKeyfollowMult;
+	int tvfBiasMult;
+	int tvfCutoffOffset;
+	int tvfLevelMultOffset;
+	Bit32s tvpPitchKeyfollowMult;
+	Bit32s tvpPitchOffset;
+
 	// The following directly points into live sysex-addressable memory
 	const TimbreParam::PartialParam *partialParam;
 };
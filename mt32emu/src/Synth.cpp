@@ -15,6 +15,7 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cmath>
 #include <cstdio>
 
 #include "internals.h"
@@ -23,14 +24,23 @@
 #include "Analog.h"
 #include "BReverbModel.h"
 #include "File.h"
+#include "Kernels.h"
+#include "LA32FloatWaveGenerator.h"
+#include "MemoryFence.h"
+#include "MemoryLock.h"
 #include "MemoryRegion.h"
 #include "MidiEventQueue.h"
+#include "MonotonicClock.h"
 #include "Part.h"
 #include "Partial.h"
 #include "PartialManager.h"
 #include "Poly.h"
+#include "RhythmHitCache.h"
 #include "ROMInfo.h"
+#include "SharedMemorySegment.h"
+#include "SharedROMData.h"
 #include "TVA.h"
+#include "TraceSpan.h"
 
 #if MT32EMU_MONITOR_SYSEX > 0
 #include "mmath.h"
@@ -40,6 +50,22 @@ namespace MT32Emu {
 
 // MIDI interface data transfer rate in samples. Used to simulate the transfer delay.
 static const double MIDI_DATA_TRANSFER_RATE = double(SAMPLE_RATE) / 31250.0 * 8.0;
+// Refreshes of the settings derived from the system area, which are due after a SysEx write to it.
+enum SystemRefresh {
+	SYSTEM_REFRESH_MASTER_TUNE = 1,
+	SYSTEM_REFRESH_REVERB_PARAMETERS = 2,
+	SYSTEM_REFRESH_RESERVE_SETTINGS = 4,
+	SYSTEM_REFRESH_CHAN_ASSIGN = 8,
+	SYSTEM_REFRESH_MASTER_VOL = 16
+};
+
+static const Bit16u ALL_PARTS_MASK = (1 << 9) - 1;
+
+// Alignment of the PCM wave slabs in samples, which makes up a 64-byte cache line on the common CPUs.
+static const size_t PCM_WAVE_SLAB_ALIGNMENT = 32;
+
+// Marks the absence of a pending reverb model preparation request, see Synth::prepareReverbModels().
+static const Bit32u NO_REVERB_PREPARATION_REQUEST = ~Bit32u(0);
 
 // FIXME: there should be more specific feature sets for various MT-32 control ROM versions
 static const ControlROMFeatureSet OLD_MT32_COMPATIBLE = {
@@ -88,16 +114,285 @@ static inline PartialState getPartialState(PartialManager *partialManager, unsig
 	return partial->isActive() ? PARTIAL_PHASE_TO_STATE[partial->getTVA()->getPhase()] : PartialState_INACTIVE;
 }
 
-template <class I, class O>
-static inline void convertSampleFormat(const I *inBuffer, O *outBuffer, const Bit32u len) {
+// Selects the kernels that convert the output samples, the float samples are dithered unless ditherPosition is NULL.
+struct SampleFormatConversion {
+	const Kernels &kernels;
+	Bit32u *ditherPosition;
+};
+
+static inline void convertSampleFormat(const SampleFormatConversion &conversion, const IntSample *inBuffer, FloatSample *outBuffer, const Bit32u len) {
 	if (inBuffer == NULL || outBuffer == NULL) return;
+	conversion.kernels.convertIntToFloat(inBuffer, outBuffer, len);
+}
 
-	const I *inBufferEnd = inBuffer + len;
-	while (inBuffer < inBufferEnd) {
-		*(outBuffer++) = Synth::convertSample(*(inBuffer++));
+static inline void convertSampleFormat(const SampleFormatConversion &conversion, const FloatSample *inBuffer, IntSample *outBuffer, const Bit32u len) {
+	if (inBuffer == NULL || outBuffer == NULL) return;
+	if (conversion.ditherPosition == NULL) {
+		conversion.kernels.convertFloatToInt(inBuffer, outBuffer, len);
+	} else {
+		conversion.kernels.convertFloatToIntDithered(inBuffer, outBuffer, len, *conversion.ditherPosition);
+		*conversion.ditherPosition += len;
 	}
 }
 
+#if MT32EMU_REALTIME_SAFE
+// Size of the SysEx storage buffer each MIDI event queue is preallocated with by default in the realtime-safe build.
+static const Bit32u DEFAULT_REALTIME_SYSEX_STORAGE_BUFFER_SIZE = 32768;
+
+// Keeps debug messages printed while rendering in a preallocated ring buffer until they are flushed.
+// The rendering thread is the only writer of the messages, and Synth::flushDeferredDebugMessages() is the only reader,
+// so no locking is necessary, in the same manner with MidiEventQueue. When the log is full, messages are dropped
+// and counted, so that the reader can tell this happened.
+class DeferredDebugLog {
+public:
+	static const Bit32u MESSAGE_COUNT = 64; // Must be a power of 2
+	static const Bit32u MAX_MESSAGE_LENGTH = 256;
+
+	DeferredDebugLog() : startPosition(0), endPosition(0), droppedMessageCount(0), reportedDroppedMessageCount(0) {}
+
+	void push(const char *fmt, va_list list) {
+		const Bit32u myEndPosition = endPosition;
+		const Bit32u newEndPosition = (myEndPosition + 1) & (MESSAGE_COUNT - 1);
+		if (newEndPosition == startPosition) {
+			droppedMessageCount++;
+			return;
+		}
+		char *message = messages[myEndPosition];
+		vsnprintf(message, MAX_MESSAGE_LENGTH, fmt, list);
+		message[MAX_MESSAGE_LENGTH - 1] = 0;
+		endPosition = newEndPosition;
+	}
+
+	const char *peekMessage() const {
+		return startPosition == endPosition ? NULL : messages[startPosition];
+	}
+
+	void dropMessage() {
+		startPosition = (startPosition + 1) & (MESSAGE_COUNT - 1);
+	}
+
+	// Returns the number of messages dropped since the previous call.
+	Bit32u takeDroppedMessageCount() {
+		const Bit32u myDroppedMessageCount = droppedMessageCount;
+		const Bit32u newlyDroppedMessageCount = myDroppedMessageCount - reportedDroppedMessageCount;
+		reportedDroppedMessageCount = myDroppedMessageCount;
+		return newlyDroppedMessageCount;
+	}
+
+private:
+	char messages[MESSAGE_COUNT][MAX_MESSAGE_LENGTH];
+	volatile Bit32u startPosition;
+	volatile Bit32u endPosition;
+	volatile Bit32u droppedMessageCount;
+	// Only accessed by the reader.
+	Bit32u reportedDroppedMessageCount;
+};
+#endif
+
+// Additional MIDI input, see Synth::setMIDIInputCount().
+struct MidiInput {
+	MidiEventQueue *queue;
+	volatile Bit32u lastReceivedEventTimestamp;
+};
+
+class Extensions {
+public:
+	RendererType selectedRendererType;
+	Bit32s masterTunePitchDelta;
+	bool niceAmpRamp;
+	bool nicePanning;
+	bool nicePartialMixing;
+
+	RenderingTaskExecutor *partialRenderingExecutor;
+	Bit32u partialRenderingTaskCount;
+	Bit32u partialRenderingGroupCount;
+
+	bool renderProfiling;
+	RenderProfile renderProfile;
+
+	TraceSink *traceSink;
+
+	ReverbEngine *reverbEngine;
+
+	PolyphonyStats polyphonyStats;
+
+	// Here we keep the reverse mapping of assigned parts per MIDI channel.
+	// NOTE: value above 8 means that the channel is not assigned
+	Bit8u chantable[16][9];
+
+	// This stores the index of Part in chantable that failed to play and required partial abortion.
+	Bit32u abortingPartIx;
+
+	bool preallocatedReverbMemory;
+
+	bool outputDither;
+	// Position of the next converted sample in the dither noise sequence, common to all the streams.
+	Bit32u ditherPosition;
+
+	// Attenuation in dB set by setPartialCullingThreshold() and the respective TVA amp value, zero disables the culling.
+	float partialCullingThreshold;
+	Bit32u partialCullingAmp;
+
+	// The cache is constructed upon opening for the sample type of the renderer in use, yet it only allocates the memory
+	// for the recordings while enabled. It is kept until the synth is closed, since the partials may still refer
+	// to the entries after disabling.
+	bool rhythmHitCacheEnabled;
+	RhythmHitCache *rhythmHitCache;
+
+	// The state of the overload governor, see Synth::setOverloadGovernorEnabled(). The time spent rendering is accumulated
+	// over a window of samples before being compared with the budget, and recoveryLength counts the samples rendered
+	// at a low load since the level was last changed. While the level is non-zero, overloadCullingAmp is the TVA amp
+	// of the respective culling threshold.
+	bool overloadGovernor;
+	float overloadGovernorRenderBudget;
+	Bit32u overloadGovernorLevel;
+	double overloadGovernorWindowTime;
+	Bit32u overloadGovernorWindowLength;
+	Bit32u overloadGovernorRecoveryLength;
+	Bit32u overloadCullingAmp;
+
+	// Limits the instruction set extensions the kernels selected upon opening may use.
+	Bit32u enabledCPUFeatures;
+	Kernels kernels;
+
+	// The setting takes effect upon the next opening, the mode the synth is opened in is kept in reducedMemoryFootprintOpened.
+	bool reducedMemoryFootprint;
+	bool reducedMemoryFootprintOpened;
+	// The data derived from the ROM images shared with the other synths, NULL unless opened in the reduced memory footprint mode.
+	const SharedROMData *sharedROMData;
+
+	// The settings take effect upon the next opening, the memory locked or placed on the NUMA node while opened
+	// is kept track of in memoryLock.
+	bool memoryLocking;
+	Bit32s numaNode;
+	MemoryLock *memoryLock;
+
+	// The sample clock is published by the rendering thread with a sequence counter, which is odd while the fields
+	// are being updated, so that the readers retry instead of blocking. The number of times the 32-bit counter
+	// has wrapped is derived from the last published value of the counter.
+	volatile Bit32u sampleClockSequence;
+	volatile double publishedRenderedSampleCount;
+	volatile double publishedClockNanos;
+	Bit32u renderedSampleCountWraps;
+	Bit32u lastPublishedRenderedSampleCount;
+
+	// The models of the reverb modes are constructed upon the first selection, unless the reverb memory is preallocated
+	// without deferring the preparation. The compatibility mode the models are constructed in is kept in reverbMT32CompatibleMode,
+	// and reverbModelsGeneration is incremented whenever the models are rebuilt.
+	bool reverbMT32CompatibleMode;
+	Bit32u reverbModelsGeneration;
+	bool reverbPreparationDeferred;
+	// While the reverb preparation is deferred, a missing model selected by the rendering thread is requested from
+	// prepareReverbModels() via reverbPreparationRequest, which encodes the reverb mode, the compatibility mode and
+	// the generation of the models. The prepared model is handed back in preparedReverbModel along with the request
+	// it was prepared for, and swapped in at the next rendering block boundary with the parameters kept meanwhile.
+	// The model prepared for a request cancelled in the meantime is left in discardedReverbModel to be deleted
+	// by the next invocation of prepareReverbModels().
+	volatile Bit32u reverbPreparationRequest;
+	volatile Bit32u preparedReverbRequest;
+	BReverbModel * volatile preparedReverbModel;
+	BReverbModel * volatile discardedReverbModel;
+	Bit8u pendingReverbTime;
+	Bit8u pendingReverbLevel;
+
+	Bit32u midiEventQueueSize;
+	Bit32u midiEventQueueSysexStorageBufferSize;
+	// The ring buffers of the MIDI event queues never grow when it doesn't exceed midiEventQueueSize.
+	Bit32u midiEventQueueMaxSize;
+
+	bool midiEventBatching;
+
+	// While a batch of MIDI events is dispatched, the SysEx writes to the system area only record the refreshes they require
+	// in the SystemRefresh flags, along with the parts whose channel assignment is touched. The refreshes are then applied
+	// at once, before the next short message is played or the batch is rendered, see Synth::applyPendingSystemRefreshes().
+	bool systemRefreshesDeferred;
+	Bit32u pendingSystemRefreshes;
+	Bit16u pendingChanAssignParts;
+
+	// The large banks of the emulated memory written since it was last restored to the defaults, so that a reset only
+	// copies back the entries that may differ. A bit is set in modifiedTimbres per timbre.
+	bool patchesModified;
+	Bit32u modifiedTimbres[8];
+
+	Bit32u midiInputCount;
+	// Holds midiInputCount - 1 inputs following input 0, NULL unless opened.
+	MidiInput *extraMidiInputs;
+
+	// The mode specified when opening, the analogue circuit emulation may differ while the low-pass filter is bypassed.
+	AnalogOutputMode analogOutputMode;
+	bool analogLowPassFilterBypassed;
+
+#if MT32EMU_REALTIME_SAFE
+	// Set while a rendering call is in progress, debug messages are deferred meanwhile.
+	bool renderingInProgress;
+	DeferredDebugLog deferredDebugLog;
+#endif
+};
+
+#if MT32EMU_REALTIME_SAFE
+// Marks the extent of a rendering call, so that no debug messages are printed in place within.
+class RealtimeRenderingScope {
+	bool &renderingInProgress;
+	const bool wasRenderingInProgress;
+
+public:
+	explicit RealtimeRenderingScope(bool &useRenderingInProgress) :
+		renderingInProgress(useRenderingInProgress),
+		wasRenderingInProgress(useRenderingInProgress)
+	{
+		renderingInProgress = true;
+	}
+
+	~RealtimeRenderingScope() {
+		renderingInProgress = wasRenderingInProgress;
+	}
+};
+
+#define MT32EMU_REALTIME_RENDERING_SCOPE RealtimeRenderingScope realtimeRenderingScope(extensions.renderingInProgress);
+#else
+#define MT32EMU_REALTIME_RENDERING_SCOPE
+#endif
+
+// Accumulates time spent in rendering stages when render profiling is enabled, otherwise does nothing.
+class RenderProfilingTimer {
+	RenderProfile * const renderProfile;
+	double lapStartTime;
+
+public:
+	explicit RenderProfilingTimer(RenderProfile *useRenderProfile) :
+		renderProfile(useRenderProfile),
+		lapStartTime(useRenderProfile == NULL ? 0.0 : getMonotonicClockNanos())
+	{}
+
+	// Adds the time elapsed since construction or the previous lap to the specified stage time.
+	void lap(double RenderProfile::*stageTime) {
+		if (renderProfile == NULL) return;
+		const double now = getMonotonicClockNanos();
+		renderProfile->*stageTime += now - lapStartTime;
+		lapStartTime = now;
+	}
+};
+
+// Measures the time a rendering call takes for the overload governor while it is enabled and the synth is open.
+class OverloadGovernorTimer {
+	Synth &synth;
+	const Bit32u length;
+	const bool enabled;
+	const double startTime;
+
+public:
+	OverloadGovernorTimer(Synth &useSynth, Bit32u useLength) :
+		synth(useSynth),
+		length(useLength),
+		enabled(useSynth.isOverloadGovernorEnabled() && useSynth.isOpen()),
+		startTime(enabled ? getMonotonicClockNanos() : 0.0)
+	{}
+
+	~OverloadGovernorTimer() {
+		if (enabled) synth.updateOverloadGovernor(getMonotonicClockNanos() - startTime, length);
+	}
+};
+
 class Renderer {
 protected:
 	Synth &synth;
@@ -114,12 +409,34 @@ protected:
 		return synth.isAbortingPoly();
 	}
 
+	bool isMIDIEventBatchingEnabled() const {
+		return synth.extensions.midiEventBatching;
+	}
+
+	void playQueuedSysex(const volatile MidiEventQueue::MidiEvent &event) {
+		synth.extensions.systemRefreshesDeferred = synth.extensions.midiEventBatching;
+		synth.playSysexNow(event.sysexData, event.sysexLength);
+		synth.extensions.systemRefreshesDeferred = false;
+	}
+
+	void applyPendingSystemRefreshes() {
+		synth.applyPendingSystemRefreshes();
+	}
+
 	Analog &getAnalog() const {
 		return *synth.analog;
 	}
 
-	MidiEventQueue &getMidiQueue() {
-		return *synth.midiQueue;
+	const Kernels &getKernels() const {
+		return synth.extensions.kernels;
+	}
+
+	SampleFormatConversion getSampleFormatConversion() const {
+		return synth.getSampleFormatConversion();
+	}
+
+	MidiEventQueue &getNextMidiQueue() {
+		return synth.getNextMIDIEventQueue();
 	}
 
 	PartialManager &getPartialManager() {
@@ -130,6 +447,30 @@ protected:
 		return *synth.reverbModel;
 	}
 
+	RenderingTaskExecutor *getPartialRenderingExecutor() const {
+		return synth.extensions.partialRenderingExecutor;
+	}
+
+	Bit32u getPartialRenderingTaskCount() const {
+		return synth.extensions.partialRenderingTaskCount;
+	}
+
+	Bit32u getPartialRenderingGroupCount() const {
+		return synth.extensions.partialRenderingGroupCount;
+	}
+
+	Bit32s getNUMANode() const {
+		return synth.extensions.numaNode;
+	}
+
+	RenderProfile *getRenderProfile() const {
+		return synth.getEnabledRenderProfile();
+	}
+
+	PolyphonyStats &getPolyphonyStats() {
+		return synth.getCollectedPolyphonyStats();
+	}
+
 	Bit32u getRenderedSampleCount() {
 		return synth.renderedSampleCount;
 	}
@@ -147,6 +488,63 @@ public:
 	virtual void render(FloatSample *stereoStream, Bit32u len) = 0;
 	virtual void renderStreams(const DACOutputStreams<IntSample> &streams, Bit32u len) = 0;
 	virtual void renderStreams(const DACOutputStreams<FloatSample> &streams, Bit32u len) = 0;
+	virtual void renderStreams(const PartOutputStreams<IntSample> &streams, Bit32u len) = 0;
+	virtual void renderStreams(const PartOutputStreams<FloatSample> &streams, Bit32u len) = 0;
+	virtual size_t getMemoryUsage() const = 0;
+	virtual void lockMemory(MemoryLock &memoryLock) const = 0;
+	virtual bool skipSilence(Bit32u len) = 0;
+	virtual void allocatePartialRenderingBuffers() = 0;
+};
+
+// Renders the groups of partials listed by PartialManager::groupPartialsByPoly(), each task takes every taskCount-th group.
+// Each group is mixed into own set of buffers, the first group uses the output buffers directly.
+template <class Sample>
+class PartialRenderingTask : public RenderingTaskExecutor::Task {
+public:
+	Partial * const *partials;
+	const Bit32u *groupEnds;
+	Bit32u groupCount;
+	Bit32u taskCount;
+	Sample *outputBuffers[4];
+	Sample *groupBuffers;
+	Bit32u len;
+
+	void run(Bit32u taskIx) {
+		// The tasks may run on other threads, which have own floating-point modes.
+		DenormalsFlushScope denormalsFlushScope;
+		for (Bit32u groupIx = taskIx; groupIx < groupCount; groupIx += taskCount) {
+			renderGroup(groupIx);
+		}
+	}
+
+private:
+	void renderGroup(Bit32u groupIx) {
+		Sample *nonReverbLeft, *nonReverbRight, *reverbDryLeft, *reverbDryRight;
+		if (groupIx == 0) {
+			nonReverbLeft = outputBuffers[0];
+			nonReverbRight = outputBuffers[1];
+			reverbDryLeft = outputBuffers[2];
+			reverbDryRight = outputBuffers[3];
+		} else {
+			// The buses left without the output buffers are unused, their partials are only advanced.
+			Sample * const groupBuffer = groupBuffers + (groupIx - 1) * 4 * MAX_SAMPLES_PER_RUN;
+			nonReverbLeft = outputBuffers[0] == NULL ? NULL : groupBuffer;
+			nonReverbRight = outputBuffers[1] == NULL ? NULL : groupBuffer + MAX_SAMPLES_PER_RUN;
+			reverbDryLeft = outputBuffers[2] == NULL ? NULL : groupBuffer + 2 * MAX_SAMPLES_PER_RUN;
+			reverbDryRight = outputBuffers[3] == NULL ? NULL : groupBuffer + 3 * MAX_SAMPLES_PER_RUN;
+			Synth::muteSampleBuffer(nonReverbLeft, len);
+			Synth::muteSampleBuffer(nonReverbRight, len);
+			Synth::muteSampleBuffer(reverbDryLeft, len);
+			Synth::muteSampleBuffer(reverbDryRight, len);
+		}
+		for (Bit32u i = groupIx == 0 ? 0 : groupEnds[groupIx - 1]; i < groupEnds[groupIx]; i++) {
+			if (partials[i]->shouldReverb()) {
+				partials[i]->produceOutput(reverbDryLeft, reverbDryRight, len);
+			} else {
+				partials[i]->produceOutput(nonReverbLeft, nonReverbRight, len);
+			}
+		}
+	}
 };
 
 template <class Sample>
@@ -167,48 +565,126 @@ class RendererImpl : public Renderer {
 		return buffers;
 	}
 
+	// Set when the output is known to be silent until new MIDI events arrive, see isSilent().
+	bool silent;
+	const BReverbModel *silentReverbModel;
+
+	// Indices of partials to render in the current run.
+	int * const renderedPartials;
+
+	// The reverb model last muted as its output went unused, see suspendReverbModel().
+	const BReverbModel *suspendedReverbModel;
+
+	// Used when partials are rendered concurrently.
+	Partial **groupedPartials;
+	Bit32u *partialGroupEnds;
+	Sample *partialGroupBuffers;
+	Bit32u partialGroupBufferCount;
+	// The NUMA node of each task passed to RenderingTaskExecutor::executeOnNodes() when the synth is placed on a node.
+	Bit32s *partialTaskNodes;
+	Bit32u partialTaskNodeCount;
+
 public:
 	RendererImpl(Synth &useSynth) :
 		Renderer(useSynth),
-		tmpBuffers(createTmpBuffers())
+		tmpBuffers(createTmpBuffers()),
+		silent(false),
+		silentReverbModel(NULL),
+		renderedPartials(new int[useSynth.getPartialCount()]),
+		suspendedReverbModel(NULL),
+		groupedPartials(NULL),
+		partialGroupEnds(NULL),
+		partialGroupBuffers(NULL),
+		partialGroupBufferCount(0),
+		partialTaskNodes(NULL),
+		partialTaskNodeCount(0)
 	{}
 
+	~RendererImpl() {
+		delete[] renderedPartials;
+		delete[] groupedPartials;
+		delete[] partialGroupEnds;
+		delete[] partialGroupBuffers;
+		delete[] partialTaskNodes;
+	}
+
+	size_t getMemoryUsage() const {
+		const Bit32u partialCount = synth.getPartialCount();
+		size_t memoryUsage = sizeof(*this) + partialCount * sizeof(*renderedPartials);
+		if (groupedPartials != NULL) {
+			memoryUsage += partialCount * (sizeof(*groupedPartials) + sizeof(*partialGroupEnds));
+		}
+		memoryUsage += partialTaskNodeCount * sizeof(*partialTaskNodes);
+		return memoryUsage + partialGroupBufferCount * 4 * MAX_SAMPLES_PER_RUN * sizeof(Sample);
+	}
+
+	// The buffers for concurrent rendering reallocated afterwards, as the settings change, remain pageable.
+	void lockMemory(MemoryLock &memoryLock) const {
+		const Bit32u partialCount = synth.getPartialCount();
+		memoryLock.lock(this, sizeof(*this));
+		memoryLock.lock(renderedPartials, partialCount * sizeof(*renderedPartials));
+		if (groupedPartials != NULL) {
+			memoryLock.lock(groupedPartials, partialCount * sizeof(*groupedPartials));
+			memoryLock.lock(partialGroupEnds, partialCount * sizeof(*partialGroupEnds));
+		}
+		memoryLock.lock(partialGroupBuffers, partialGroupBufferCount * 4 * MAX_SAMPLES_PER_RUN * sizeof(Sample));
+		memoryLock.lock(partialTaskNodes, partialTaskNodeCount * sizeof(*partialTaskNodes));
+	}
+
 	void render(IntSample *stereoStream, Bit32u len);
 	void render(FloatSample *stereoStream, Bit32u len);
 	void renderStreams(const DACOutputStreams<IntSample> &streams, Bit32u len);
 	void renderStreams(const DACOutputStreams<FloatSample> &streams, Bit32u len);
+	void renderStreams(const PartOutputStreams<IntSample> &streams, Bit32u len);
+	void renderStreams(const PartOutputStreams<FloatSample> &streams, Bit32u len);
+	bool skipSilence(Bit32u len);
+
+	// The maximum number of groups the partials are split into for the current settings of the concurrent rendering.
+	Bit32u getMaxPartialGroupCount() const {
+		Bit32u maxGroupCount = getPartialRenderingGroupCount() != 0 ? getPartialRenderingGroupCount() : getPartialRenderingTaskCount();
+		return maxGroupCount > synth.getPartialCount() ? synth.getPartialCount() : maxGroupCount;
+	}
+
+	// Invoked upon opening and whenever the settings of the concurrent rendering change, so that the buffers are never
+	// allocated in the rendering thread.
+	void allocatePartialRenderingBuffers() {
+		if (getPartialRenderingExecutor() == NULL && getPartialRenderingGroupCount() == 0) return;
+		if (groupedPartials == NULL) {
+			groupedPartials = new Partial *[synth.getPartialCount()];
+			partialGroupEnds = new Bit32u[synth.getPartialCount()];
+		}
+		const Bit32u maxGroupCount = getMaxPartialGroupCount();
+		if (partialGroupBufferCount < maxGroupCount - 1) {
+			delete[] partialGroupBuffers;
+			partialGroupBufferCount = maxGroupCount - 1;
+			partialGroupBuffers = new Sample[partialGroupBufferCount * 4 * MAX_SAMPLES_PER_RUN];
+		}
+		if (partialTaskNodeCount < getPartialRenderingTaskCount()) {
+			delete[] partialTaskNodes;
+			partialTaskNodeCount = getPartialRenderingTaskCount();
+			partialTaskNodes = new Bit32s[partialTaskNodeCount];
+		}
+	}
 
 	template <class O>
 	void doRenderAndConvert(O *stereoStream, Bit32u len);
 	void doRender(Sample *stereoStream, Bit32u len);
+	bool isSilent();
 
 	template <class O>
 	void doRenderAndConvertStreams(const DACOutputStreams<O> &streams, Bit32u len);
-	void doRenderStreams(const DACOutputStreams<Sample> &streams, Bit32u len);
+	template <class O>
+	void doRenderAndConvertStreams(const PartOutputStreams<O> &streams, Bit32u len);
+	template <class Streams>
+	void doRenderStreams(const Streams &streams, Bit32u len);
 	void produceLA32Output(Sample *buffer, Bit32u len);
 	void convertSamplesToOutput(Sample *buffer, Bit32u len);
+	void produceConvertedLA32Output(Sample *buffer, Bit32u len);
 	void produceStreams(const DACOutputStreams<Sample> &streams, Bit32u len);
-};
-
-class Extensions {
-public:
-	RendererType selectedRendererType;
-	Bit32s masterTunePitchDelta;
-	bool niceAmpRamp;
-	bool nicePanning;
-	bool nicePartialMixing;
-
-	// Here we keep the reverse mapping of assigned parts per MIDI channel.
-	// NOTE: value above 8 means that the channel is not assigned
-	Bit8u chantable[16][9];
-
-	// This stores the index of Part in chantable that failed to play and required partial abortion.
-	Bit32u abortingPartIx;
-
-	bool preallocatedReverbMemory;
-
-	Bit32u midiEventQueueSize;
-	Bit32u midiEventQueueSysexStorageBufferSize;
+	void produceStreams(const PartOutputStreams<Sample> &streams, Bit32u len);
+	void producePartialOutputConcurrently(Sample *nonReverbLeft, Sample *nonReverbRight, Sample *reverbDryLeft, Sample *reverbDryRight, Bit32u len);
+	void processReverbModel(const Sample *reverbDryLeft, const Sample *reverbDryRight, Sample *reverbWetLeft, Sample *reverbWetRight, Bit32u len);
+	void suspendReverbModel();
 };
 
 Bit32u Synth::getLibraryVersionInt() {
@@ -228,14 +704,14 @@ Bit8u Synth::calcSysexChecksum(const Bit8u *data, const Bit32u len, const Bit8u
 }
 
 Bit32u Synth::getStereoOutputSampleRate(AnalogOutputMode analogOutputMode) {
-	static const unsigned int SAMPLE_RATES[] = {SAMPLE_RATE, SAMPLE_RATE, SAMPLE_RATE * 3 / 2, SAMPLE_RATE * 3};
+	static const unsigned int SAMPLE_RATES[] = {SAMPLE_RATE, SAMPLE_RATE, SAMPLE_RATE * 3 / 2, SAMPLE_RATE * 3, SAMPLE_RATE * 3 / 2};
 
 	return SAMPLE_RATES[analogOutputMode];
 }
 
 Synth::Synth(ReportHandler *useReportHandler) :
 	mt32ram(*new MemParams),
-	mt32default(*new MemParams),
+	mt32default(NULL),
 	extensions(*new Extensions)
 {
 	opened = false;
@@ -252,7 +728,43 @@ Synth::Synth(ReportHandler *useReportHandler) :
 		isDefaultReportHandler = false;
 	}
 
-	extensions.preallocatedReverbMemory = false;
+	extensions.preallocatedReverbMemory = MT32EMU_REALTIME_SAFE != 0;
+	extensions.enabledCPUFeatures = ~Bit32u(0);
+	extensions.reducedMemoryFootprint = false;
+	extensions.reducedMemoryFootprintOpened = false;
+	extensions.outputDither = false;
+	extensions.ditherPosition = 0;
+	extensions.partialCullingThreshold = 0.0f;
+	extensions.partialCullingAmp = 0;
+	extensions.rhythmHitCacheEnabled = false;
+	extensions.rhythmHitCache = NULL;
+	extensions.overloadGovernor = false;
+	extensions.overloadGovernorRenderBudget = 0.75f;
+	extensions.overloadGovernorLevel = 0;
+	extensions.overloadGovernorWindowTime = 0.0;
+	extensions.overloadGovernorWindowLength = 0;
+	extensions.overloadGovernorRecoveryLength = 0;
+	extensions.overloadCullingAmp = 0;
+	extensions.sharedROMData = NULL;
+	extensions.memoryLocking = false;
+	extensions.numaNode = -1;
+	extensions.memoryLock = NULL;
+	extensions.sampleClockSequence = 0;
+	extensions.publishedRenderedSampleCount = 0.0;
+	extensions.publishedClockNanos = 0.0;
+	extensions.renderedSampleCountWraps = 0;
+	extensions.lastPublishedRenderedSampleCount = 0;
+	extensions.reverbMT32CompatibleMode = false;
+	extensions.reverbModelsGeneration = 0;
+	extensions.reverbPreparationDeferred = false;
+	extensions.reverbPreparationRequest = NO_REVERB_PREPARATION_REQUEST;
+	extensions.preparedReverbRequest = NO_REVERB_PREPARATION_REQUEST;
+	extensions.preparedReverbModel = NULL;
+	extensions.discardedReverbModel = NULL;
+	extensions.pendingReverbTime = 0;
+	extensions.pendingReverbLevel = 0;
+	extensions.patchesModified = false;
+	memset(extensions.modifiedTimbres, 0, sizeof(extensions.modifiedTimbres));
 	for (int i = REVERB_MODE_ROOM; i <= REVERB_MODE_TAP_DELAY; i++) {
 		reverbModels[i] = NULL;
 	}
@@ -261,12 +773,19 @@ Synth::Synth(ReportHandler *useReportHandler) :
 	renderer = NULL;
 	setDACInputMode(DACInputMode_NICE);
 	setMIDIDelayMode(MIDIDelayMode_DELAY_SHORT_MESSAGES_ONLY);
+	setMIDIEventBatchingEnabled(false);
 	setOutputGain(1.0f);
 	setReverbOutputGain(1.0f);
 	setReversedStereoEnabled(false);
 	setNiceAmpRampEnabled(true);
 	setNicePanningEnabled(false);
 	setNicePartialMixingEnabled(false);
+	setPartialRenderingExecutor(NULL, 1);
+	setPartialRenderingGroupCount(0);
+	setRenderProfilingEnabled(false);
+	resetRenderProfile();
+	setTraceSink(NULL);
+	extensions.reverbEngine = NULL;
 	selectRendererType(RendererType_BIT16S);
 
 	patchTempMemoryRegion = NULL;
@@ -282,10 +801,26 @@ Synth::Synth(ReportHandler *useReportHandler) :
 	partialManager = NULL;
 	pcmWaves = NULL;
 	pcmROMData = NULL;
+	pcmWaveSlabs = NULL;
+	linearPCMWaveSlabs = NULL;
+	pcmWavesSegment = NULL;
 	soundGroupNames = NULL;
 	midiQueue = NULL;
 	extensions.midiEventQueueSize = DEFAULT_MIDI_EVENT_QUEUE_SIZE;
+	extensions.midiEventQueueMaxSize = 0;
+#if MT32EMU_REALTIME_SAFE
+	extensions.midiEventQueueSysexStorageBufferSize = DEFAULT_REALTIME_SYSEX_STORAGE_BUFFER_SIZE;
+	extensions.renderingInProgress = false;
+#else
 	extensions.midiEventQueueSysexStorageBufferSize = 0;
+#endif
+	extensions.systemRefreshesDeferred = false;
+	extensions.pendingSystemRefreshes = 0;
+	extensions.pendingChanAssignParts = 0;
+	extensions.midiInputCount = 1;
+	extensions.extraMidiInputs = NULL;
+	extensions.analogOutputMode = AnalogOutputMode_COARSE;
+	extensions.analogLowPassFilterBypassed = false;
 	lastReceivedMIDIEventTimestamp = 0;
 	memset(parts, 0, sizeof(parts));
 	renderedSampleCount = 0;
@@ -297,7 +832,6 @@ Synth::~Synth() {
 		delete reportHandler;
 	}
 	delete &mt32ram;
-	delete &mt32default;
 	delete &extensions;
 }
 
@@ -338,31 +872,56 @@ void Synth::newTimbreSet(Bit8u partNum, Bit8u timbreGroup, Bit8u timbreNumber, c
 	reportHandler->printDebug(fmt, ap); \
 	va_end(ap);
 
-#if MT32EMU_DEBUG_SAMPLESTAMPS > 0
-static inline void printSamplestamp(ReportHandler *reportHandler, const char *fmt, ...) {
+#if MT32EMU_DEBUG_SAMPLESTAMPS > 0 || MT32EMU_REALTIME_SAFE
+static inline void printDebugTo(ReportHandler *reportHandler, const char *fmt, ...) {
 	MT32EMU_PRINT_DEBUG
 }
 #endif
 
 void Synth::printDebug(const char *fmt, ...) {
+#if MT32EMU_REALTIME_SAFE
+	if (extensions.renderingInProgress) {
+		va_list ap;
+		va_start(ap, fmt);
+		extensions.deferredDebugLog.push(fmt, ap);
+		va_end(ap);
+		return;
+	}
+#endif
 #if MT32EMU_DEBUG_SAMPLESTAMPS > 0
-	printSamplestamp(reportHandler, "[%u]", renderedSampleCount);
+	printDebugTo(reportHandler, "[%u]", renderedSampleCount);
 #endif
 	MT32EMU_PRINT_DEBUG
 }
 
 #undef MT32EMU_PRINT_DEBUG
 
+void Synth::flushDeferredDebugMessages() {
+#if MT32EMU_REALTIME_SAFE
+	DeferredDebugLog &deferredDebugLog = extensions.deferredDebugLog;
+	for (const char *message = deferredDebugLog.peekMessage(); message != NULL; message = deferredDebugLog.peekMessage()) {
+		printDebugTo(reportHandler, "%s", message);
+		deferredDebugLog.dropMessage();
+	}
+	Bit32u droppedMessageCount = deferredDebugLog.takeDroppedMessageCount();
+	if (droppedMessageCount > 0) {
+		printDebugTo(reportHandler, "Dropped %u debug messages printed while rendering", droppedMessageCount);
+	}
+#endif
+}
+
 void Synth::setReverbEnabled(bool newReverbEnabled) {
 	if (!opened) return;
-	if (isReverbEnabled() == newReverbEnabled) return;
+	if (newReverbEnabled && isReverbEnabled()) return;
 	if (newReverbEnabled) {
 		bool oldReverbOverridden = reverbOverridden;
 		reverbOverridden = false;
 		refreshSystemReverbParameters();
 		reverbOverridden = oldReverbOverridden;
 	} else {
-		if (!extensions.preallocatedReverbMemory) {
+		extensions.reverbPreparationRequest = NO_REVERB_PREPARATION_REQUEST;
+		if (reverbModel == NULL) return;
+		if (!isReverbMemoryPreallocated()) {
 			reverbModel->close();
 		}
 		reverbModel = NULL;
@@ -383,7 +942,7 @@ bool Synth::isReverbOverridden() const {
 
 void Synth::setReverbCompatibilityMode(bool mt32CompatibleMode) {
 	if (!opened || (isMT32ReverbCompatibilityMode() == mt32CompatibleMode)) return;
-	bool oldReverbEnabled = isReverbEnabled();
+	bool oldReverbEnabled = isReverbEnabled() || extensions.reverbPreparationRequest != NO_REVERB_PREPARATION_REQUEST;
 	setReverbEnabled(false);
 	for (int i = REVERB_MODE_ROOM; i <= REVERB_MODE_TAP_DELAY; i++) {
 		delete reverbModels[i];
@@ -394,7 +953,7 @@ void Synth::setReverbCompatibilityMode(bool mt32CompatibleMode) {
 }
 
 bool Synth::isMT32ReverbCompatibilityMode() const {
-	return opened && (reverbModels[REVERB_MODE_ROOM]->isMT32Compatible(REVERB_MODE_ROOM));
+	return opened && extensions.reverbMT32CompatibleMode;
 }
 
 bool Synth::isDefaultReverbMT32Compatible() const {
@@ -404,16 +963,136 @@ bool Synth::isDefaultReverbMT32Compatible() const {
 void Synth::preallocateReverbMemory(bool enabled) {
 	if (extensions.preallocatedReverbMemory == enabled) return;
 	extensions.preallocatedReverbMemory = enabled;
-	if (!opened) return;
+	if (!opened || extensions.reducedMemoryFootprintOpened || extensions.memoryLock != NULL) return;
 	for (int i = REVERB_MODE_ROOM; i <= REVERB_MODE_TAP_DELAY; i++) {
 		if (enabled) {
+			// The models not selected so far are prepared upon the first selection when the preparation is deferred.
+			if (reverbModels[i] == NULL) {
+				if (extensions.reverbPreparationDeferred) continue;
+				reverbModels[i] = createReverbModel(Bit8u(i), extensions.reverbMT32CompatibleMode);
+			}
 			reverbModels[i]->open();
-		} else if (reverbModel != reverbModels[i]) {
+		} else if (reverbModels[i] != NULL && reverbModel != reverbModels[i]) {
 			reverbModels[i]->close();
 		}
 	}
 }
 
+void Synth::setReverbPreparationDeferred(bool enabled) {
+	extensions.reverbPreparationDeferred = enabled;
+}
+
+bool Synth::isReverbPreparationDeferred() const {
+	return extensions.reverbPreparationDeferred;
+}
+
+bool Synth::prepareReverbModels() {
+	delete extensions.discardedReverbModel;
+	extensions.discardedReverbModel = NULL;
+	if (!opened || extensions.preparedReverbModel != NULL) return false;
+	Bit32u request = extensions.reverbPreparationRequest;
+	if (request == NO_REVERB_PREPARATION_REQUEST) return false;
+	BReverbModel *model = createReverbModel(Bit8u(request & 3), (request & 4) != 0);
+	model->open();
+	extensions.preparedReverbRequest = request;
+	extensions.preparedReverbModel = model;
+	return true;
+}
+
+void Synth::setReducedMemoryFootprintEnabled(bool enabled) {
+	extensions.reducedMemoryFootprint = enabled;
+}
+
+bool Synth::isReducedMemoryFootprintEnabled() const {
+	return extensions.reducedMemoryFootprint;
+}
+
+void Synth::setMemoryLockingEnabled(bool enabled) {
+	extensions.memoryLocking = enabled;
+}
+
+bool Synth::isMemoryLockingEnabled() const {
+	return extensions.memoryLocking;
+}
+
+void Synth::setNUMANode(Bit32s node) {
+	extensions.numaNode = node < 0 ? -1 : node;
+}
+
+Bit32s Synth::getNUMANode() const {
+	return extensions.numaNode;
+}
+
+void Synth::setOutputDitherEnabled(bool enabled) {
+	extensions.outputDither = enabled;
+}
+
+bool Synth::isOutputDitherEnabled() const {
+	return extensions.outputDither;
+}
+
+// Converts the attenuation in dB to the TVA amp value culled partials are attenuated to at least, zero disables the culling.
+static Bit32u getCullingAmp(float attenuation) {
+	// The TVA amp is the attenuation in the log space, the step of 1 << 22 halves the amplitude, i.e. it is about 6.02 dB.
+	// The amp never exceeds 67117056, so greater attenuations are effectively never reached.
+	const float amp = attenuation * (4194304.0f / 6.0206f);
+	if (attenuation == 0.0f) return 0;
+	if (amp < 1.0f) return 1;
+	if (amp < 67117057.0f) return Bit32u(amp);
+	return 67117057;
+}
+
+void Synth::setPartialCullingThreshold(float attenuation) {
+	// This also rejects NaN.
+	if (!(attenuation > 0.0f)) attenuation = 0.0f;
+	extensions.partialCullingThreshold = attenuation;
+	extensions.partialCullingAmp = getCullingAmp(attenuation);
+}
+
+float Synth::getPartialCullingThreshold() const {
+	return extensions.partialCullingThreshold;
+}
+
+void Synth::setRhythmHitCacheEnabled(bool enabled) {
+	if (enabled == extensions.rhythmHitCacheEnabled) return;
+	extensions.rhythmHitCacheEnabled = enabled;
+	if (extensions.rhythmHitCache == NULL) return;
+	if (enabled) {
+		extensions.rhythmHitCache->allocate();
+	} else {
+		extensions.rhythmHitCache->clear();
+	}
+}
+
+bool Synth::isRhythmHitCacheEnabled() const {
+	return extensions.rhythmHitCacheEnabled;
+}
+
+void Synth::setOverloadGovernorEnabled(bool enabled) {
+	if (enabled == extensions.overloadGovernor) return;
+	extensions.overloadGovernor = enabled;
+	resetOverloadGovernor();
+}
+
+bool Synth::isOverloadGovernorEnabled() const {
+	return extensions.overloadGovernor;
+}
+
+void Synth::setOverloadGovernorRenderBudget(float budget) {
+	// This also rejects NaN.
+	if (!(budget > 0.01f)) budget = 0.01f;
+	if (budget > 1.0f) budget = 1.0f;
+	extensions.overloadGovernorRenderBudget = budget;
+}
+
+float Synth::getOverloadGovernorRenderBudget() const {
+	return extensions.overloadGovernorRenderBudget;
+}
+
+Bit32u Synth::getOverloadGovernorLevel() const {
+	return extensions.overloadGovernorLevel;
+}
+
 void Synth::setDACInputMode(DACInputMode mode) {
 	dacInputMode = mode;
 }
@@ -430,6 +1109,14 @@ MIDIDelayMode Synth::getMIDIDelayMode() const {
 	return midiDelayMode;
 }
 
+void Synth::setMIDIEventBatchingEnabled(bool enabled) {
+	extensions.midiEventBatching = enabled;
+}
+
+bool Synth::isMIDIEventBatchingEnabled() const {
+	return extensions.midiEventBatching;
+}
+
 void Synth::setOutputGain(float newOutputGain) {
 	if (newOutputGain < 0.0f) newOutputGain = -newOutputGain;
 	outputGain = newOutputGain;
@@ -482,44 +1169,138 @@ bool Synth::isNicePartialMixingEnabled() const {
 	return extensions.nicePartialMixing;
 }
 
-bool Synth::loadControlROM(const ROMImage &controlROMImage) {
-	File *file = controlROMImage.getFile();
-	const ROMInfo *controlROMInfo = controlROMImage.getROMInfo();
-	if ((controlROMInfo == NULL)
-			|| (controlROMInfo->type != ROMInfo::Control)
-			|| (controlROMInfo->pairType != ROMInfo::Full)) {
-#if MT32EMU_MONITOR_INIT
-		printDebug("Invalid Control ROM Info provided");
-#endif
-		return false;
+void Synth::setPartialRenderingExecutor(RenderingTaskExecutor *executor, Bit32u taskCount) {
+	if (executor == NULL || taskCount < 2) {
+		executor = NULL;
+		taskCount = 1;
 	}
+	extensions.partialRenderingExecutor = executor;
+	extensions.partialRenderingTaskCount = taskCount;
+	if (renderer != NULL) renderer->allocatePartialRenderingBuffers();
+}
 
-#if MT32EMU_MONITOR_INIT
-	printDebug("Found Control ROM: %s, %s", controlROMInfo->shortName, controlROMInfo->description);
-#endif
-	const Bit8u *fileData = file->getData();
-	memcpy(controlROMData, fileData, CONTROL_ROM_SIZE);
+Bit32u Synth::getPartialRenderingTaskCount() const {
+	return extensions.partialRenderingTaskCount;
+}
 
-	// Control ROM successfully loaded, now check whether it's a known type
-	controlROMMap = NULL;
-	controlROMFeatures = NULL;
-	for (unsigned int i = 0; i < sizeof(ControlROMMaps) / sizeof(ControlROMMaps[0]); i++) {
-		if (strcmp(controlROMInfo->shortName, ControlROMMaps[i].shortName) == 0) {
-			controlROMMap = &ControlROMMaps[i];
-			controlROMFeatures = &controlROMMap->featureSet;
-			return true;
-		}
-	}
-#if MT32EMU_MONITOR_INIT
-	printDebug("Control ROM failed to load");
-#endif
-	return false;
+void Synth::setPartialRenderingGroupCount(Bit32u groupCount) {
+	extensions.partialRenderingGroupCount = groupCount;
+	if (renderer != NULL) renderer->allocatePartialRenderingBuffers();
 }
 
-bool Synth::loadPCMROM(const ROMImage &pcmROMImage) {
-	File *file = pcmROMImage.getFile();
-	const ROMInfo *pcmROMInfo = pcmROMImage.getROMInfo();
-	if ((pcmROMInfo == NULL)
+Bit32u Synth::getPartialRenderingGroupCount() const {
+	return extensions.partialRenderingGroupCount;
+}
+
+bool Synth::isPartialRenderingParallel() const {
+	return extensions.partialRenderingExecutor != NULL || extensions.partialRenderingGroupCount != 0;
+}
+
+void Synth::setRenderProfilingEnabled(bool enabled) {
+	if (enabled && !extensions.renderProfiling) {
+		resetRenderProfile();
+	}
+	extensions.renderProfiling = enabled;
+}
+
+bool Synth::isRenderProfilingEnabled() const {
+	return extensions.renderProfiling;
+}
+
+void Synth::getRenderProfile(RenderProfile &renderProfile) const {
+	renderProfile = extensions.renderProfile;
+}
+
+void Synth::resetRenderProfile() {
+	extensions.renderProfile = RenderProfile();
+}
+
+RenderProfile *Synth::getEnabledRenderProfile() const {
+	return extensions.renderProfiling ? &extensions.renderProfile : NULL;
+}
+
+void Synth::setTraceSink(TraceSink *traceSink) {
+	extensions.traceSink = traceSink;
+}
+
+TraceSink *Synth::getTraceSink() const {
+	return extensions.traceSink;
+}
+
+void Synth::setReverbEngine(ReverbEngine *reverbEngine) {
+	if (extensions.reverbEngine == reverbEngine) return;
+	if (!opened) {
+		extensions.reverbEngine = reverbEngine;
+		return;
+	}
+	bool mt32CompatibleMode = isMT32ReverbCompatibilityMode();
+	bool oldReverbEnabled = isReverbEnabled() || extensions.reverbPreparationRequest != NO_REVERB_PREPARATION_REQUEST;
+	setReverbEnabled(false);
+	for (int i = REVERB_MODE_ROOM; i <= REVERB_MODE_TAP_DELAY; i++) {
+		delete reverbModels[i];
+	}
+	extensions.reverbEngine = reverbEngine;
+	initReverbModels(mt32CompatibleMode);
+	setReverbEnabled(oldReverbEnabled);
+	if (reverbEngine != NULL) activated = true;
+}
+
+ReverbEngine *Synth::getReverbEngine() const {
+	return extensions.reverbEngine;
+}
+
+bool Synth::getPolyphonyStats(PolyphonyStats &stats) const {
+	if (!opened) return false;
+	stats = extensions.polyphonyStats;
+	return true;
+}
+
+void Synth::resetPolyphonyStats() {
+	extensions.polyphonyStats = PolyphonyStats();
+}
+
+PolyphonyStats &Synth::getCollectedPolyphonyStats() {
+	return extensions.polyphonyStats;
+}
+
+bool Synth::loadControlROM(const ROMImage &controlROMImage) {
+	File *file = controlROMImage.getFile();
+	const ROMInfo *controlROMInfo = controlROMImage.getROMInfo();
+	if ((controlROMInfo == NULL)
+			|| (controlROMInfo->type != ROMInfo::Control)
+			|| (controlROMInfo->pairType != ROMInfo::Full)) {
+#if MT32EMU_MONITOR_INIT
+		printDebug("Invalid Control ROM Info provided");
+#endif
+		return false;
+	}
+
+#if MT32EMU_MONITOR_INIT
+	printDebug("Found Control ROM: %s, %s", controlROMInfo->shortName, controlROMInfo->description);
+#endif
+	const Bit8u *fileData = file->getData();
+	memcpy(controlROMData, fileData, CONTROL_ROM_SIZE);
+
+	// Control ROM successfully loaded, now check whether it's a known type
+	controlROMMap = NULL;
+	controlROMFeatures = NULL;
+	for (unsigned int i = 0; i < sizeof(ControlROMMaps) / sizeof(ControlROMMaps[0]); i++) {
+		if (strcmp(controlROMInfo->shortName, ControlROMMaps[i].shortName) == 0) {
+			controlROMMap = &ControlROMMaps[i];
+			controlROMFeatures = &controlROMMap->featureSet;
+			return true;
+		}
+	}
+#if MT32EMU_MONITOR_INIT
+	printDebug("Control ROM failed to load");
+#endif
+	return false;
+}
+
+bool Synth::loadPCMROM(const ROMImage &pcmROMImage) {
+	File *file = pcmROMImage.getFile();
+	const ROMInfo *pcmROMInfo = pcmROMImage.getROMInfo();
+	if ((pcmROMInfo == NULL)
 			|| (pcmROMInfo->type != ROMInfo::PCM)
 			|| (pcmROMInfo->pairType != ROMInfo::Full)) {
 		return false;
@@ -534,30 +1315,39 @@ bool Synth::loadPCMROM(const ROMImage &pcmROMImage) {
 #endif
 		return false;
 	}
-	const Bit8u *fileData = file->getData();
-	for (size_t i = 0; i < pcmROMSize; i++) {
-		Bit8u s = *(fileData++);
-		Bit8u c = *(fileData++);
-
-		int order[16] = {0, 9, 1, 2, 3, 4, 5, 6, 7, 10, 11, 12, 13, 14, 15, 8};
-
-		Bit16s log = 0;
-		for (int u = 0; u < 16; u++) {
-			int bit;
-			if (order[u] < 8) {
-				bit = (s >> (7 - order[u])) & 0x1;
-			} else {
-				bit = (c >> (7 - (order[u] - 8))) & 0x1;
-			}
-			log = log | Bit16s(bit << (15 - u));
-		}
-		pcmROMData[i] = log;
-	}
+	// The samples are decoded when the ROMImage is created, so that all the Synths using it share the same data.
+	pcmROMData = pcmROMImage.decodedPCMData;
 	return true;
 }
 
-bool Synth::initPCMList(Bit16u mapAddress, Bit16u count) {
+// Each wave is copied into a slab of its own, aligned to a cache line and followed by a guard sample that holds the sample
+// the interpolation continues with past the end of the wave: the first sample of a looped wave and silence otherwise.
+// This way, the interpolation needs no bounds checks, and the samples a partial reads don't share cache lines with
+// the neighbouring waves. The ROM data itself is shared among the synths, so it cannot be padded in place.
+bool Synth::initPCMList(Bit16u mapAddress, Bit16u count, const char *segmentKey) {
 	ControlROMPCMStruct *tps = reinterpret_cast<ControlROMPCMStruct *>(&controlROMData[mapAddress]);
+	// In the reduced memory footprint mode, the slabs may have been filled by another synth opened with the same ROM images.
+	// Otherwise, they may have been filled by another process, when the cache in shared memory is enabled.
+	const bool slabsShared = extensions.sharedROMData != NULL;
+	Bit16s *slabsToFill = NULL;
+	if (!slabsShared) {
+		size_t slabsSize = PCM_WAVE_SLAB_ALIGNMENT - 1;
+		for (int i = 0; i < count; i++) {
+			Bit32u rLen = 0x800 << ((tps[i].len & 0x70) >> 4);
+			slabsSize += (rLen + PCM_WAVE_SLAB_ALIGNMENT) & ~(PCM_WAVE_SLAB_ALIGNMENT - 1);
+		}
+		pcmWavesSegment = SharedMemorySegment::open(segmentKey, getLinearPCMWaveSlabsOffset(slabsSize) + slabsSize * sizeof(float));
+		if (pcmWavesSegment == NULL) {
+			pcmWaveSlabs = new Bit16s[slabsSize];
+			slabsToFill = pcmWaveSlabs;
+		} else if (pcmWavesSegment->isCreated()) {
+			slabsToFill = static_cast<Bit16s *>(pcmWavesSegment->getWritableData());
+		}
+	}
+	const Bit16s *slabs = slabsShared ? extensions.sharedROMData->pcmWaveSlabs : getPCMWaveSlabs();
+	// The allocation is only guaranteed to be aligned for the sample type, so the slabs start at the first cache line boundary.
+	size_t slabsMisalignment = (reinterpret_cast<size_t>(slabs) / sizeof(Bit16s)) & (PCM_WAVE_SLAB_ALIGNMENT - 1);
+	size_t slabOffset = (PCM_WAVE_SLAB_ALIGNMENT - slabsMisalignment) & (PCM_WAVE_SLAB_ALIGNMENT - 1);
 	for (int i = 0; i < count; i++) {
 		Bit32u rAddr = tps[i].pos * 0x800;
 		Bit32u rLenExp = (tps[i].len & 0x70) >> 4;
@@ -570,11 +1360,71 @@ bool Synth::initPCMList(Bit16u mapAddress, Bit16u count) {
 		pcmWaves[i].len = rLen;
 		pcmWaves[i].loop = (tps[i].len & 0x80) != 0;
 		pcmWaves[i].controlROMPCMStruct = &tps[i];
+		if (slabsToFill != NULL) {
+			Bit16s *slab = slabsToFill + slabOffset;
+			memcpy(slab, &pcmROMData[rAddr], rLen * sizeof(Bit16s));
+			slab[rLen] = pcmWaves[i].loop ? slab[0] : 0;
+		}
+		pcmWaves[i].data = slabs + slabOffset;
+		pcmWaves[i].linearData = NULL;
+		slabOffset += (rLen + PCM_WAVE_SLAB_ALIGNMENT) & ~(PCM_WAVE_SLAB_ALIGNMENT - 1);
 		//int pitch = (tps[i].pitchMSB << 8) | tps[i].pitchLSB;
 		//bool unaffectedByMasterTune = (tps[i].len & 0x01) == 0;
 		//printDebug("PCM %d: pos=%d, len=%d, pitch=%d, loop=%s, unaffectedByMasterTune=%s", i, rAddr, rLen, pitch, pcmWaves[i].loop ? "YES" : "NO", unaffectedByMasterTune ? "YES" : "NO");
 	}
-	return false;
+	return true;
+}
+
+// The float renderers interpolate the PCM samples in linear amplitudes, so the waves are converted once into slabs
+// of their own, which are laid out in the same way as the slabs of the logarithmic samples. In the reduced memory
+// footprint mode, the converted waves are shared along with the other ROM data, unless the synth that built the data
+// was opened with the integer renderer, in which case each synth with a float renderer keeps a copy of its own.
+// The segment shared with other processes always holds the converted waves, so they are filled in by the process
+// that creates the segment regardless of the renderer type.
+void Synth::initLinearPCMWaves(Bit16u count) {
+	const bool slabsShared = extensions.sharedROMData != NULL && extensions.sharedROMData->linearPCMWaveSlabs != NULL;
+	float *slabsToFill = NULL;
+	if (!slabsShared) {
+		if (pcmWavesSegment == NULL) {
+			linearPCMWaveSlabs = new float[getPCMWaveSlabsSize()];
+			slabsToFill = linearPCMWaveSlabs;
+		} else if (pcmWavesSegment->isCreated()) {
+			slabsToFill = const_cast<float *>(getLinearPCMWaveSlabs());
+		}
+	}
+	const float *slabs = slabsShared ? extensions.sharedROMData->linearPCMWaveSlabs : getLinearPCMWaveSlabs();
+	size_t slabsMisalignment = (reinterpret_cast<size_t>(slabs) / sizeof(float)) & (PCM_WAVE_SLAB_ALIGNMENT - 1);
+	size_t slabOffset = (PCM_WAVE_SLAB_ALIGNMENT - slabsMisalignment) & (PCM_WAVE_SLAB_ALIGNMENT - 1);
+	for (int i = 0; i < count; i++) {
+		const Bit32u len = pcmWaves[i].len;
+		if (slabsToFill != NULL) {
+			float *slab = slabsToFill + slabOffset;
+			const Bit16s *logSamples = pcmWaves[i].data;
+			for (Bit32u j = 0; j < len; j++) {
+				slab[j] = LA32FloatWaveGenerator::getLinearPCMSample(logSamples[j]);
+			}
+			slab[len] = pcmWaves[i].loop ? slab[0] : 0.0f;
+		}
+		pcmWaves[i].linearData = slabs + slabOffset;
+		slabOffset += (len + PCM_WAVE_SLAB_ALIGNMENT) & ~(PCM_WAVE_SLAB_ALIGNMENT - 1);
+	}
+}
+
+// In the segment shared with other processes, the slabs of the linear samples follow the slabs of the logarithmic samples.
+size_t Synth::getLinearPCMWaveSlabsOffset(size_t slabsSize) {
+	return (slabsSize * sizeof(Bit16s) + sizeof(float) - 1) & ~(sizeof(float) - 1);
+}
+
+// Returns the slabs owned by this synth, either private or held in the segment shared with other processes.
+const Bit16s *Synth::getPCMWaveSlabs() const {
+	if (pcmWavesSegment == NULL) return pcmWaveSlabs;
+	return static_cast<const Bit16s *>(pcmWavesSegment->getData());
+}
+
+const float *Synth::getLinearPCMWaveSlabs() const {
+	if (pcmWavesSegment == NULL) return linearPCMWaveSlabs;
+	const Bit8u *segmentData = static_cast<const Bit8u *>(pcmWavesSegment->getData());
+	return reinterpret_cast<const float *>(segmentData + getLinearPCMWaveSlabsOffset(getPCMWaveSlabsSize()));
 }
 
 bool Synth::initCompressedTimbre(Bit16u timbreNum, const Bit8u *src, Bit32u srcLen) {
@@ -624,13 +1474,113 @@ bool Synth::initTimbres(Bit16u mapAddress, Bit16u offset, Bit16u count, Bit16u s
 }
 
 void Synth::initReverbModels(bool mt32CompatibleMode) {
+	extensions.reverbMT32CompatibleMode = mt32CompatibleMode;
+	// The models prepared for the previous generation are discarded when swapped in.
+	extensions.reverbModelsGeneration = (extensions.reverbModelsGeneration + 1) & 0xFFFF;
+	bool preallocated = isReverbMemoryPreallocated() && !isReverbPreparationDeferredActive();
 	for (int mode = REVERB_MODE_ROOM; mode <= REVERB_MODE_TAP_DELAY; mode++) {
-		reverbModels[mode] = BReverbModel::createBReverbModel(ReverbMode(mode), mt32CompatibleMode, getSelectedRendererType());
+		if (preallocated) {
+			reverbModels[mode] = createReverbModel(Bit8u(mode), mt32CompatibleMode);
+			reverbModels[mode]->open();
+		} else {
+			reverbModels[mode] = NULL;
+		}
+	}
+}
+
+BReverbModel *Synth::createReverbModel(Bit8u mode, bool mt32CompatibleMode) const {
+	if (extensions.reverbEngine != NULL) {
+		return BReverbModel::createExternalReverbModel(*extensions.reverbEngine, ReverbMode(mode), mt32CompatibleMode);
+	}
+	return BReverbModel::createBReverbModel(ReverbMode(mode), mt32CompatibleMode, getSelectedRendererType());
+}
 
-		if (extensions.preallocatedReverbMemory) {
+// Returns the model of the reverb mode, constructing it upon the first selection. While the preparation is deferred,
+// the missing model is requested from prepareReverbModels() instead, and NULL is returned until it is swapped in.
+BReverbModel *Synth::selectReverbModel(Bit8u mode) {
+	if (reverbModels[mode] == NULL) {
+		if (opened && isReverbPreparationDeferredActive()) {
+			extensions.reverbPreparationRequest = Bit32u(mode) | (extensions.reverbMT32CompatibleMode ? 4 : 0) | (extensions.reverbModelsGeneration << 3);
+			return NULL;
+		}
+		reverbModels[mode] = createReverbModel(mode, extensions.reverbMT32CompatibleMode);
+		if (isReverbMemoryPreallocated()) {
 			reverbModels[mode]->open();
 		}
 	}
+	return reverbModels[mode];
+}
+
+// The buffers of all the reverb modes are kept allocated while locked, so the preparation is never deferred then.
+bool Synth::isReverbPreparationDeferredActive() const {
+	return extensions.reverbPreparationDeferred && extensions.memoryLock == NULL && isReverbMemoryPreallocated();
+}
+
+// Invoked at a rendering block boundary once a model is handed back by prepareReverbModels().
+void Synth::swapInPreparedReverbModel() {
+	BReverbModel *model = extensions.preparedReverbModel;
+	Bit32u request = extensions.preparedReverbRequest;
+	if (request != extensions.reverbPreparationRequest) {
+		extensions.discardedReverbModel = model;
+		extensions.preparedReverbModel = NULL;
+		return;
+	}
+	// The request is withdrawn before the hand-over slot is released, so that the same model is never prepared twice.
+	extensions.reverbPreparationRequest = NO_REVERB_PREPARATION_REQUEST;
+	extensions.preparedReverbModel = NULL;
+	reverbModels[request & 3] = model;
+	reverbModel = model;
+	reverbModel->setParameters(extensions.pendingReverbTime, extensions.pendingReverbLevel);
+}
+
+bool Synth::isReverbMemoryPreallocated() const {
+	if (extensions.reducedMemoryFootprintOpened) return false;
+	// The locked memory is only set up upon opening, so the buffers of all the reverb modes are kept allocated meanwhile.
+	return extensions.preallocatedReverbMemory || extensions.memoryLock != NULL;
+}
+
+// Locks the memory touched while rendering and processing MIDI events and places it on the NUMA node,
+// see setMemoryLockingEnabled() and setNUMANode().
+void Synth::lockWorkingSet() {
+	MemoryLock &memoryLock = *extensions.memoryLock;
+	memoryLock.lock(this, sizeof(*this));
+	memoryLock.lock(&extensions, sizeof(Extensions));
+	// The decoded PCM ROM samples are shared among the synths opened with the same ROM image.
+	memoryLock.lockShared(pcmROMData, pcmROMSize * sizeof(Bit16s));
+	memoryLock.lock(pcmWaves, controlROMMap->pcmCount * sizeof(PCMWaveEntry));
+	if (pcmWavesSegment != NULL) {
+		const size_t slabsSize = getPCMWaveSlabsSize();
+		memoryLock.lockShared(getPCMWaveSlabs(), getLinearPCMWaveSlabsOffset(slabsSize) + slabsSize * sizeof(float));
+	} else if (extensions.sharedROMData == NULL) {
+		memoryLock.lock(pcmWaveSlabs, getPCMWaveSlabsSize() * sizeof(Bit16s));
+	} else {
+		memoryLock.lockShared(extensions.sharedROMData->pcmWaveSlabs, extensions.sharedROMData->pcmWaveSlabsSize * sizeof(Bit16s));
+		if (extensions.sharedROMData->linearPCMWaveSlabs != NULL) {
+			memoryLock.lockShared(extensions.sharedROMData->linearPCMWaveSlabs, extensions.sharedROMData->pcmWaveSlabsSize * sizeof(float));
+		}
+	}
+	if (linearPCMWaveSlabs != NULL) {
+		memoryLock.lock(linearPCMWaveSlabs, getPCMWaveSlabsSize() * sizeof(float));
+	}
+	for (int i = 0; i < 8; i++) {
+		memoryLock.lock(parts[i], sizeof(Part));
+	}
+	memoryLock.lock(parts[8], sizeof(RhythmPart));
+	partialManager->lockMemory(memoryLock);
+	for (int i = REVERB_MODE_ROOM; i <= REVERB_MODE_TAP_DELAY; i++) {
+		if (reverbModels[i] != NULL) reverbModels[i]->lockMemory(memoryLock);
+	}
+	analog->lockMemory(memoryLock);
+	renderer->lockMemory(memoryLock);
+	midiQueue->lockMemory(memoryLock);
+	if (extensions.extraMidiInputs != NULL) {
+		for (Bit32u i = 0; i < extensions.midiInputCount - 1; i++) {
+			extensions.extraMidiInputs[i].queue->lockMemory(memoryLock);
+		}
+	}
+	if (!memoryLock.isComplete()) {
+		printDebug("Memory locking incomplete, the system limit may be too low; %u KiB locked", unsigned(memoryLock.getLockedSize() >> 10));
+	}
 }
 
 void Synth::initSoundGroups(char newSoundGroupNames[][9]) {
@@ -652,6 +1602,10 @@ bool Synth::open(const ROMImage &controlROMImage, const ROMImage &pcmROMImage, B
 	partialCount = usePartialCount;
 	abortingPoly = NULL;
 	extensions.abortingPartIx = 0;
+	extensions.reducedMemoryFootprintOpened = extensions.reducedMemoryFootprint;
+	if (extensions.memoryLocking || extensions.numaNode >= 0) {
+		extensions.memoryLock = new MemoryLock(extensions.memoryLocking, extensions.numaNode);
+	}
 
 	// This is to help detect bugs
 	memset(&mt32ram, '?', sizeof(mt32ram));
@@ -668,11 +1622,17 @@ bool Synth::open(const ROMImage &controlROMImage, const ROMImage &pcmROMImage, B
 
 	initMemoryRegions();
 
+	extensions.kernels.select(extensions.enabledCPUFeatures);
+#if MT32EMU_MONITOR_INIT
+	for (Bit32u i = 0; i < Kernels::KERNEL_COUNT; i++) {
+		printDebug("Using %s implementation of kernel %s", extensions.kernels.getVariantName(i), Kernels::getKernelName(i));
+	}
+#endif
+
 	// 512KB PCM ROM for MT-32, etc.
 	// 1MB PCM ROM for CM-32L, LAPC-I, CM-64, CM-500
 	// Note that the size below is given in samples (16-bit), not bytes
 	pcmROMSize = controlROMMap->pcmCount == 256 ? 512 * 1024 : 256 * 1024;
-	pcmROMData = new Bit16s[pcmROMSize];
 
 #if MT32EMU_MONITOR_INIT
 	printDebug("Loading PCM ROM");
@@ -684,6 +1644,10 @@ bool Synth::open(const ROMImage &controlROMImage, const ROMImage &pcmROMImage, B
 		return false;
 	}
 
+	if (extensions.reducedMemoryFootprintOpened) {
+		extensions.sharedROMData = SharedROMData::acquire(&controlROMImage, &pcmROMImage);
+	}
+
 #if MT32EMU_MONITOR_INIT
 	printDebug("Initialising Reverb Models");
 #endif
@@ -724,13 +1688,25 @@ bool Synth::open(const ROMImage &controlROMImage, const ROMImage &pcmROMImage, B
 	memset(&mt32ram.timbres[128], 0, sizeof(mt32ram.timbres[128]) * 64);
 
 	partialManager = new PartialManager(this, parts);
+	resetPolyphonyStats();
+	extensions.rhythmHitCache = new RhythmHitCache(getSelectedRendererType() == RendererType_BIT16S ? sizeof(IntSample) : sizeof(FloatSample));
+	if (extensions.rhythmHitCacheEnabled) extensions.rhythmHitCache->allocate();
 
 	pcmWaves = new PCMWaveEntry[controlROMMap->pcmCount];
 
 #if MT32EMU_MONITOR_INIT
 	printDebug("Initialising PCM List");
 #endif
-	initPCMList(controlROMMap->pcmTable, controlROMMap->pcmCount);
+	char pcmWavesSegmentKey[96] = "waves-";
+	strcat(pcmWavesSegmentKey, controlROMImage.getFile()->getSHA1());
+	strcat(pcmWavesSegmentKey, "-");
+	strcat(pcmWavesSegmentKey, pcmROMImage.getFile()->getSHA1());
+	const bool pcmListValid = initPCMList(controlROMMap->pcmTable, controlROMMap->pcmCount, pcmWavesSegmentKey);
+	const bool pcmWavesSegmentCreated = pcmWavesSegment != NULL && pcmWavesSegment->isCreated();
+	if (getSelectedRendererType() != RendererType_BIT16S || pcmWavesSegmentCreated) {
+		initLinearPCMWaves(controlROMMap->pcmCount);
+	}
+	if (pcmWavesSegmentCreated && pcmListValid) pcmWavesSegment->publish();
 
 #if MT32EMU_MONITOR_INIT
 	printDebug("Initialising Rhythm Temp");
@@ -807,13 +1783,30 @@ bool Synth::open(const ROMImage &controlROMImage, const ROMImage &pcmROMImage, B
 	}
 
 	// For resetting mt32 mid-execution
-	mt32default = mt32ram;
+	if (!extensions.reducedMemoryFootprintOpened) {
+		mt32default = new MemParams(mt32ram);
+	} else {
+		if (extensions.sharedROMData == NULL) {
+			// The first synth opened with these ROM images hands over the data it has just built.
+			SharedROMData *sharedROMData = new SharedROMData(&controlROMImage, &pcmROMImage, new MemParams(mt32ram), getPCMWaveSlabs(), getPCMWaveSlabsSize(), getLinearPCMWaveSlabs(), pcmWavesSegment);
+			pcmWaveSlabs = NULL;
+			linearPCMWaveSlabs = NULL;
+			pcmWavesSegment = NULL;
+			extensions.sharedROMData = SharedROMData::publish(sharedROMData);
+		}
+		mt32default = &extensions.sharedROMData->defaultMemParams;
+	}
+	extensions.patchesModified = false;
+	memset(extensions.modifiedTimbres, 0, sizeof(extensions.modifiedTimbres));
 
-	midiQueue = new MidiEventQueue(extensions.midiEventQueueSize, extensions.midiEventQueueSysexStorageBufferSize);
+	midiQueue = new MidiEventQueue(extensions.midiEventQueueSize, extensions.midiEventQueueSysexStorageBufferSize, extensions.midiEventQueueMaxSize);
+	createExtraMIDIInputs();
 
+	extensions.analogOutputMode = analogOutputMode;
+	extensions.analogLowPassFilterBypassed = false;
 	analog = Analog::createAnalog(analogOutputMode, controlROMFeatures->oldMT32AnalogLPF, getSelectedRendererType());
 #if MT32EMU_MONITOR_INIT
-	static const char *ANALOG_OUTPUT_MODES[] = { "Digital only", "Coarse", "Accurate", "Oversampled2x" };
+	static const char *ANALOG_OUTPUT_MODES[] = { "Digital only", "Coarse", "Accurate", "Oversampled2x", "Oversampled2x decimated" };
 	printDebug("Using Analog output mode %s", ANALOG_OUTPUT_MODES[analogOutputMode]);
 #endif
 	setOutputGain(outputGain);
@@ -827,6 +1820,7 @@ bool Synth::open(const ROMImage &controlROMImage, const ROMImage &pcmROMImage, B
 #endif
 			break;
 		case RendererType_FLOAT:
+		case RendererType_FLOAT_WAVETABLE:
 			renderer = new RendererImpl<FloatSample>(*this);
 #if MT32EMU_MONITOR_INIT
 			printDebug("Using float 32-bit samples in renderer and wave generator");
@@ -837,9 +1831,15 @@ bool Synth::open(const ROMImage &controlROMImage, const ROMImage &pcmROMImage, B
 			dispose();
 			return false;
 	}
+	renderer->allocatePartialRenderingBuffers();
+
+	if (extensions.memoryLock != NULL) lockWorkingSet();
+
+	resetOverloadGovernor();
 
 	opened = true;
-	activated = false;
+	// The external reverb engine may be fed from elsewhere, so the synth is kept activated while it is set.
+	activated = extensions.reverbEngine != NULL;
 
 #if MT32EMU_MONITOR_INIT
 	printDebug("*** Initialisation complete ***");
@@ -850,18 +1850,27 @@ bool Synth::open(const ROMImage &controlROMImage, const ROMImage &pcmROMImage, B
 void Synth::dispose() {
 	opened = false;
 
+	// The memory must be unlocked before it is released.
+	delete extensions.memoryLock;
+	extensions.memoryLock = NULL;
+
 	delete midiQueue;
 	midiQueue = NULL;
+	deleteExtraMIDIInputs();
 
 	delete renderer;
 	renderer = NULL;
 
 	delete analog;
 	analog = NULL;
+	extensions.analogLowPassFilterBypassed = false;
 
 	delete partialManager;
 	partialManager = NULL;
 
+	delete extensions.rhythmHitCache;
+	extensions.rhythmHitCache = NULL;
+
 	for (int i = 0; i < 9; i++) {
 		delete parts[i];
 		parts[i] = NULL;
@@ -873,7 +1882,23 @@ void Synth::dispose() {
 	delete[] pcmWaves;
 	pcmWaves = NULL;
 
-	delete[] pcmROMData;
+	delete[] pcmWaveSlabs;
+	pcmWaveSlabs = NULL;
+
+	delete[] linearPCMWaveSlabs;
+	linearPCMWaveSlabs = NULL;
+
+	delete pcmWavesSegment;
+	pcmWavesSegment = NULL;
+
+	if (extensions.sharedROMData != NULL) {
+		extensions.sharedROMData->release();
+		extensions.sharedROMData = NULL;
+	} else {
+		delete mt32default;
+	}
+	mt32default = NULL;
+
 	pcmROMData = NULL;
 
 	deleteMemoryRegions();
@@ -883,6 +1908,11 @@ void Synth::dispose() {
 		reverbModels[i] = NULL;
 	}
 	reverbModel = NULL;
+	extensions.reverbPreparationRequest = NO_REVERB_PREPARATION_REQUEST;
+	delete extensions.preparedReverbModel;
+	extensions.preparedReverbModel = NULL;
+	delete extensions.discardedReverbModel;
+	extensions.discardedReverbModel = NULL;
 	controlROMFeatures = NULL;
 	controlROMMap = NULL;
 }
@@ -893,6 +1923,49 @@ void Synth::close() {
 	}
 }
 
+bool Synth::reinitialise(AnalogOutputMode analogOutputMode) {
+	if (!opened) return false;
+
+	midiQueue->reset();
+	midiQueue->resetStats();
+	for (Bit32u i = 0; i < extensions.midiInputCount - 1; i++) {
+		extensions.extraMidiInputs[i].queue->reset();
+		extensions.extraMidiInputs[i].queue->resetStats();
+		extensions.extraMidiInputs[i].lastReceivedEventTimestamp = renderedSampleCount;
+	}
+	lastReceivedMIDIEventTimestamp = renderedSampleCount;
+	extensions.pendingSystemRefreshes = 0;
+	extensions.pendingChanAssignParts = 0;
+
+	abortingPoly = NULL;
+	extensions.abortingPartIx = 0;
+	partialManager->restoreInitialState();
+	resetPolyphonyStats();
+
+	// Replacing the low-pass filter also clears the state of the analogue circuit emulation left by the previous session.
+	extensions.analogOutputMode = analogOutputMode;
+	extensions.analogLowPassFilterBypassed = false;
+	analog->replaceLowPassFilter(analogOutputMode, controlROMFeatures->oldMT32AnalogLPF);
+	if (extensions.memoryLock != NULL) analog->lockMemory(*extensions.memoryLock);
+
+	// The reverb models are only rebuilt if the compatibility mode has been overridden.
+	setReverbCompatibilityMode(controlROMFeatures->defaultReverbMT32Compatible);
+	for (int i = REVERB_MODE_ROOM; i <= REVERB_MODE_TAP_DELAY; i++) {
+		if (reverbModels[i] != NULL) reverbModels[i]->mute();
+	}
+	// Matches open(), which applies the reverb output gain before the reverb compatibility mode is in effect.
+	analog->setReverbOutputGain(reverbOutputGain, false);
+
+	bool oldReverbOverridden = reverbOverridden;
+	reverbOverridden = false;
+	resetEmulatedState();
+	reverbOverridden = oldReverbOverridden;
+
+	activated = extensions.reverbEngine != NULL;
+	reportHandler->onDeviceReconfig();
+	return true;
+}
+
 bool Synth::isOpen() const {
 	return opened;
 }
@@ -900,36 +1973,114 @@ bool Synth::isOpen() const {
 void Synth::flushMIDIQueue() {
 	if (midiQueue == NULL) return;
 	for (;;) {
-		const volatile MidiEventQueue::MidiEvent *midiEvent = midiQueue->peekMidiEvent();
+		MidiEventQueue &queue = getNextMIDIEventQueue();
+		const volatile MidiEventQueue::MidiEvent *midiEvent = queue.peekMidiEvent();
 		if (midiEvent == NULL) break;
 		if (midiEvent->sysexData == NULL) {
 			playMsgNow(midiEvent->shortMessageData);
 		} else {
 			playSysexNow(midiEvent->sysexData, midiEvent->sysexLength);
 		}
-		midiQueue->dropMidiEvent();
+		queue.dropMidiEvent();
 	}
 	lastReceivedMIDIEventTimestamp = renderedSampleCount;
+	for (Bit32u i = 0; i < extensions.midiInputCount - 1; i++) {
+		extensions.extraMidiInputs[i].lastReceivedEventTimestamp = renderedSampleCount;
+	}
 }
 
-Bit32u Synth::setMIDIEventQueueSize(Bit32u useSize) {
-	static const Bit32u MAX_QUEUE_SIZE = (1 << 24); // This results in about 256 Mb - much greater than any reasonable value
+void Synth::createExtraMIDIInputs() {
+	if (extensions.midiInputCount < 2) return;
+	extensions.extraMidiInputs = new MidiInput[extensions.midiInputCount - 1];
+	for (Bit32u i = 0; i < extensions.midiInputCount - 1; i++) {
+		extensions.extraMidiInputs[i].queue = new MidiEventQueue(extensions.midiEventQueueSize, extensions.midiEventQueueSysexStorageBufferSize, extensions.midiEventQueueMaxSize);
+		extensions.extraMidiInputs[i].lastReceivedEventTimestamp = renderedSampleCount;
+	}
+}
 
-	if (extensions.midiEventQueueSize == useSize) return useSize;
+void Synth::deleteExtraMIDIInputs() {
+	if (extensions.extraMidiInputs == NULL) return;
+	for (Bit32u i = 0; i < extensions.midiInputCount - 1; i++) {
+		delete extensions.extraMidiInputs[i].queue;
+	}
+	delete[] extensions.extraMidiInputs;
+	extensions.extraMidiInputs = NULL;
+}
 
-	// Find a power of 2 that is >= useSize
-	Bit32u binarySize = 1;
-	if (useSize < MAX_QUEUE_SIZE) {
-		// Using simple linear search as this isn't time critical
-		while (binarySize < useSize) binarySize <<= 1;
+MidiEventQueue *Synth::getMIDIInputQueue(Bit32u inputNum, volatile Bit32u *&lastReceivedTimestamp) {
+	if (inputNum == 0) {
+		lastReceivedTimestamp = &lastReceivedMIDIEventTimestamp;
+		return midiQueue;
+	}
+	if (extensions.extraMidiInputs == NULL || inputNum >= extensions.midiInputCount) return NULL;
+	MidiInput &midiInput = extensions.extraMidiInputs[inputNum - 1];
+	lastReceivedTimestamp = &midiInput.lastReceivedEventTimestamp;
+	return midiInput.queue;
+}
+
+MidiEventQueue *Synth::getMIDIInputQueue(Bit32u inputNum) const {
+	if (inputNum == 0) return midiQueue;
+	if (extensions.extraMidiInputs == NULL || inputNum >= extensions.midiInputCount) return NULL;
+	return extensions.extraMidiInputs[inputNum - 1].queue;
+}
+
+// Returns the queue that holds the earliest pending MIDI event among all the inputs,
+// or the queue of input 0 when there are no pending events at all.
+MidiEventQueue &Synth::getNextMIDIEventQueue() {
+	MidiEventQueue *nextQueue = midiQueue;
+	if (extensions.extraMidiInputs == NULL) return *nextQueue;
+	const volatile MidiEventQueue::MidiEvent *nextEvent = midiQueue->peekMidiEvent();
+	for (Bit32u i = 0; i < extensions.midiInputCount - 1; i++) {
+		MidiEventQueue *queue = extensions.extraMidiInputs[i].queue;
+		const volatile MidiEventQueue::MidiEvent *event = queue->peekMidiEvent();
+		if (event == NULL) continue;
+		if (nextEvent == NULL || Bit32s(event->timestamp - renderedSampleCount) < Bit32s(nextEvent->timestamp - renderedSampleCount)) {
+			nextQueue = queue;
+			nextEvent = event;
+		}
+	}
+	return *nextQueue;
+}
+
+void Synth::setMIDIInputCount(Bit32u inputCount) {
+	if (inputCount < 1) inputCount = 1;
+	if (extensions.midiInputCount == inputCount) return;
+	if (midiQueue != NULL) {
+		flushMIDIQueue();
+		deleteExtraMIDIInputs();
+		extensions.midiInputCount = inputCount;
+		createExtraMIDIInputs();
 	} else {
-		binarySize = MAX_QUEUE_SIZE;
+		extensions.midiInputCount = inputCount;
 	}
+}
+
+Bit32u Synth::getMIDIInputCount() const {
+	return extensions.midiInputCount;
+}
+
+// Finds a power of 2 that is >= useSize, limited to a size that results in about 256 Mb - much greater than any reasonable value.
+static Bit32u getBinaryMIDIEventQueueSize(Bit32u useSize) {
+	static const Bit32u MAX_QUEUE_SIZE = (1 << 24);
+
+	if (useSize >= MAX_QUEUE_SIZE) return MAX_QUEUE_SIZE;
+	Bit32u binarySize = 1;
+	// Using simple linear search as this isn't time critical
+	while (binarySize < useSize) binarySize <<= 1;
+	return binarySize;
+}
+
+Bit32u Synth::setMIDIEventQueueSize(Bit32u useSize) {
+	if (extensions.midiEventQueueSize == useSize) return useSize;
+
+	Bit32u binarySize = getBinaryMIDIEventQueueSize(useSize);
 	extensions.midiEventQueueSize = binarySize;
 	if (midiQueue != NULL) {
 		flushMIDIQueue();
 		delete midiQueue;
-		midiQueue = new MidiEventQueue(binarySize, extensions.midiEventQueueSysexStorageBufferSize);
+		midiQueue = new MidiEventQueue(binarySize, extensions.midiEventQueueSysexStorageBufferSize, extensions.midiEventQueueMaxSize);
+		deleteExtraMIDIInputs();
+		createExtraMIDIInputs();
 	}
 	return binarySize;
 }
@@ -941,8 +2092,100 @@ void Synth::configureMIDIEventQueueSysexStorage(Bit32u storageBufferSize) {
 	if (midiQueue != NULL) {
 		flushMIDIQueue();
 		delete midiQueue;
-		midiQueue = new MidiEventQueue(extensions.midiEventQueueSize, storageBufferSize);
+		midiQueue = new MidiEventQueue(extensions.midiEventQueueSize, storageBufferSize, extensions.midiEventQueueMaxSize);
+		deleteExtraMIDIInputs();
+		createExtraMIDIInputs();
+	}
+}
+
+Bit32u Synth::setMIDIEventQueueMaxSize(Bit32u requestedMaxSize) {
+	const Bit32u binaryMaxSize = requestedMaxSize > 0 ? getBinaryMIDIEventQueueSize(requestedMaxSize) : 0;
+	extensions.midiEventQueueMaxSize = binaryMaxSize;
+	if (midiQueue != NULL) {
+		midiQueue->setMaxRingBufferSize(binaryMaxSize);
+		for (Bit32u i = 0; i < extensions.midiInputCount - 1; i++) {
+			extensions.extraMidiInputs[i].queue->setMaxRingBufferSize(binaryMaxSize);
+		}
+	}
+	return binaryMaxSize;
+}
+
+Bit32u Synth::getMIDIEventQueueMaxSize() const {
+	return extensions.midiEventQueueMaxSize;
+}
+
+bool Synth::getMIDIEventQueueStats(Bit32u inputNum, MIDIEventQueueStats &stats) const {
+	const MidiEventQueue *queue = getMIDIInputQueue(inputNum);
+	if (queue == NULL) return false;
+	queue->getStats(stats);
+	stats.sysexStorageSize = extensions.midiEventQueueSysexStorageBufferSize;
+	return true;
+}
+
+bool Synth::resetMIDIEventQueueStats(Bit32u inputNum) {
+	MidiEventQueue *queue = getMIDIInputQueue(inputNum);
+	if (queue == NULL) return false;
+	queue->resetStats();
+	return true;
+}
+
+size_t Synth::getPCMWaveSlabsSize() const {
+	// See initPCMList() for the layout of the slabs.
+	size_t slabsSize = PCM_WAVE_SLAB_ALIGNMENT - 1;
+	for (Bit32u i = 0; i < controlROMMap->pcmCount; i++) {
+		slabsSize += (pcmWaves[i].len + PCM_WAVE_SLAB_ALIGNMENT) & ~(PCM_WAVE_SLAB_ALIGNMENT - 1);
+	}
+	return slabsSize;
+}
+
+bool Synth::getMemoryUsage(SynthMemoryUsage &usage) const {
+	memset(&usage, 0, sizeof(usage));
+	if (!opened) return false;
+
+	usage.stateSize = sizeof(*this) - sizeof(controlROMData) + sizeof(Extensions) + sizeof(MemParams);
+	if (extensions.sharedROMData == NULL) {
+		usage.stateSize += sizeof(MemParams);
+	}
+	usage.stateSize += sizeof(PatchTempMemoryRegion) + sizeof(RhythmTempMemoryRegion) + sizeof(TimbreTempMemoryRegion);
+	usage.stateSize += sizeof(PatchesMemoryRegion) + sizeof(TimbresMemoryRegion) + sizeof(SystemMemoryRegion);
+	usage.stateSize += sizeof(DisplayMemoryRegion) + sizeof(ResetMemoryRegion) + sizeof(MemParams::PaddedTimbre);
+	usage.stateSize += controlROMMap->soundGroupsCount * sizeof(*soundGroupNames);
+
+	usage.controlROMSize = sizeof(controlROMData);
+
+	usage.pcmWavesSize = controlROMMap->pcmCount * sizeof(PCMWaveEntry);
+	if (pcmWavesSegment != NULL) {
+		const size_t slabsSize = getPCMWaveSlabsSize();
+		usage.sharedROMDataSize = getLinearPCMWaveSlabsOffset(slabsSize) + slabsSize * sizeof(float);
+	} else if (extensions.sharedROMData == NULL) {
+		usage.pcmWavesSize += getPCMWaveSlabsSize() * sizeof(Bit16s);
+	} else {
+		usage.sharedROMDataSize = extensions.sharedROMData->getMemoryUsage();
+	}
+	if (linearPCMWaveSlabs != NULL) {
+		usage.pcmWavesSize += getPCMWaveSlabsSize() * sizeof(float);
+	}
+	usage.sharedPCMROMSize = pcmROMSize * sizeof(Bit16s);
+
+	for (int i = REVERB_MODE_ROOM; i <= REVERB_MODE_TAP_DELAY; i++) {
+		if (reverbModels[i] != NULL) usage.reverbSize += reverbModels[i]->getMemoryUsage();
+	}
+
+	usage.midiEventQueuesSize = midiQueue->getMemoryUsage();
+	if (extensions.extraMidiInputs != NULL) {
+		usage.midiEventQueuesSize += (extensions.midiInputCount - 1) * sizeof(MidiInput);
+		for (Bit32u i = 0; i < extensions.midiInputCount - 1; i++) {
+			usage.midiEventQueuesSize += extensions.extraMidiInputs[i].queue->getMemoryUsage();
+		}
 	}
+
+	usage.partialsSize = partialManager->getMemoryUsage() + 8 * sizeof(Part) + sizeof(RhythmPart);
+	usage.sharedWavetablesSize = partialManager->getSharedWavetablesSize();
+	usage.rendererSize = renderer->getMemoryUsage() + analog->getMemoryUsage();
+
+	usage.totalSize = usage.stateSize + usage.controlROMSize + usage.pcmWavesSize + usage.reverbSize + usage.midiEventQueuesSize
+		+ usage.partialsSize + usage.rendererSize;
+	return true;
 }
 
 Bit32u Synth::getShortMessageLength(Bit32u msg) {
@@ -962,14 +2205,14 @@ Bit32u Synth::getShortMessageLength(Bit32u msg) {
 	return ((msg & 0xE0) == 0xC0) ? 2 : 3;
 }
 
-Bit32u Synth::addMIDIInterfaceDelay(Bit32u len, Bit32u timestamp) {
+Bit32u Synth::addMIDIInterfaceDelay(Bit32u len, Bit32u timestamp, volatile Bit32u &lastReceivedTimestamp) {
 	Bit32u transferTime =  Bit32u(double(len) * MIDI_DATA_TRANSFER_RATE);
 	// Dealing with wrapping
-	if (Bit32s(timestamp - lastReceivedMIDIEventTimestamp) < 0) {
-		timestamp = lastReceivedMIDIEventTimestamp;
+	if (Bit32s(timestamp - lastReceivedTimestamp) < 0) {
+		timestamp = lastReceivedTimestamp;
 	}
 	timestamp += transferTime;
-	lastReceivedMIDIEventTimestamp = timestamp;
+	lastReceivedTimestamp = timestamp;
 	return timestamp;
 }
 
@@ -977,47 +2220,191 @@ Bit32u Synth::getInternalRenderedSampleCount() const {
 	return renderedSampleCount;
 }
 
+void Synth::getSampleClock(SampleClock &sampleClock) const {
+	for (;;) {
+		const Bit32u sequence = extensions.sampleClockSequence;
+		memoryFence();
+		sampleClock.renderedSampleCount = extensions.publishedRenderedSampleCount;
+		sampleClock.clockNanos = extensions.publishedClockNanos;
+		memoryFence();
+		if ((sequence & 1) == 0 && sequence == extensions.sampleClockSequence) return;
+	}
+}
+
+void Synth::publishSampleClock() {
+	const Bit32u sampleCount = renderedSampleCount;
+	// A single rendering call advances the counter by far less than 2^32 samples.
+	if (sampleCount < extensions.lastPublishedRenderedSampleCount) extensions.renderedSampleCountWraps++;
+	extensions.lastPublishedRenderedSampleCount = sampleCount;
+	const double clockNanos = getMonotonicClockNanos();
+	extensions.sampleClockSequence++;
+	memoryFence();
+	extensions.publishedRenderedSampleCount = extensions.renderedSampleCountWraps * 4294967296.0 + sampleCount;
+	extensions.publishedClockNanos = clockNanos;
+	memoryFence();
+	extensions.sampleClockSequence++;
+}
+
+// The timestamps on the 64-bit sample clock are reduced modulo 2^32, the same as the 32-bit counter wraps.
+static Bit32u toInternalTimestamp(double timestamp) {
+	return Bit32u(timestamp - floor(timestamp / 4294967296.0) * 4294967296.0);
+}
+
+bool Synth::playMsgAtSampleClock(Bit32u msg, double timestamp) {
+	return playMsgOnInput(0, msg, toInternalTimestamp(timestamp));
+}
+
+bool Synth::playSysexAtSampleClock(const Bit8u *sysex, Bit32u len, double timestamp) {
+	return playSysexOnInput(0, sysex, len, toInternalTimestamp(timestamp));
+}
+
 bool Synth::playMsg(Bit32u msg) {
-	return playMsg(msg, renderedSampleCount);
+	return playMsgOnInput(0, msg, renderedSampleCount);
 }
 
 bool Synth::playMsg(Bit32u msg, Bit32u timestamp) {
+	return playMsgOnInput(0, msg, timestamp);
+}
+
+bool Synth::playSysex(const Bit8u *sysex, Bit32u len) {
+	return playSysexOnInput(0, sysex, len, renderedSampleCount);
+}
+
+bool Synth::playSysex(const Bit8u *sysex, Bit32u len, Bit32u timestamp) {
+	return playSysexOnInput(0, sysex, len, timestamp);
+}
+
+bool Synth::playMsgOnInput(Bit32u inputNum, Bit32u msg) {
+	return playMsgOnInput(inputNum, msg, renderedSampleCount);
+}
+
+bool Synth::playMsgOnInput(Bit32u inputNum, Bit32u msg, Bit32u timestamp) {
 	if ((msg & 0xF8) == 0xF8) {
 		reportHandler->onMIDISystemRealtime(Bit8u(msg & 0xFF));
 		return true;
 	}
-	if (midiQueue == NULL) return false;
+	volatile Bit32u *lastReceivedTimestamp;
+	MidiEventQueue *queue = getMIDIInputQueue(inputNum, lastReceivedTimestamp);
+	if (queue == NULL) return false;
 	if (midiDelayMode != MIDIDelayMode_IMMEDIATE) {
-		timestamp = addMIDIInterfaceDelay(getShortMessageLength(msg), timestamp);
+		timestamp = addMIDIInterfaceDelay(getShortMessageLength(msg), timestamp, *lastReceivedTimestamp);
 	}
 	if (!activated) activated = true;
 	do {
-		if (midiQueue->pushShortMessage(msg, timestamp)) return true;
-	} while (reportHandler->onMIDIQueueOverflow());
+		if (queue->pushShortMessage(msg, timestamp)) return true;
+	} while (handleMIDIQueueOverflow(*queue));
 	return false;
 }
 
-bool Synth::playSysex(const Bit8u *sysex, Bit32u len) {
-	return playSysex(sysex, len, renderedSampleCount);
+bool Synth::playSysexOnInput(Bit32u inputNum, const Bit8u *sysex, Bit32u len) {
+	return playSysexOnInput(inputNum, sysex, len, renderedSampleCount);
 }
 
-bool Synth::playSysex(const Bit8u *sysex, Bit32u len, Bit32u timestamp) {
-	if (midiQueue == NULL) return false;
+bool Synth::playSysexOnInput(Bit32u inputNum, const Bit8u *sysex, Bit32u len, Bit32u timestamp) {
+	volatile Bit32u *lastReceivedTimestamp;
+	MidiEventQueue *queue = getMIDIInputQueue(inputNum, lastReceivedTimestamp);
+	if (queue == NULL) return false;
 	if (midiDelayMode == MIDIDelayMode_DELAY_ALL) {
-		timestamp = addMIDIInterfaceDelay(len, timestamp);
+		timestamp = addMIDIInterfaceDelay(len, timestamp, *lastReceivedTimestamp);
 	}
 	if (!activated) activated = true;
 	do {
-		if (midiQueue->pushSysex(sysex, len, timestamp)) return true;
-	} while (reportHandler->onMIDIQueueOverflow());
+		if (queue->pushSysex(sysex, len, timestamp)) return true;
+	} while (handleMIDIQueueOverflow(*queue));
 	return false;
 }
 
-void Synth::playMsgNow(Bit32u msg) {
-	if (!opened) return;
+Bit32u Synth::playEvents(const MIDIEvent *events, Bit32u count) {
+	return playEventsOnInput(0, events, count);
+}
 
-	// NOTE: Active sense IS implemented in real hardware. However, realtime processing is clearly out of the library scope.
-	//       It is assumed that realtime consumers of the library respond to these MIDI events as appropriate.
+Bit32u Synth::playEventsOnInput(Bit32u inputNum, const MIDIEvent *events, Bit32u count) {
+	volatile Bit32u *lastReceivedTimestamp;
+	MidiEventQueue *queue = getMIDIInputQueue(inputNum, lastReceivedTimestamp);
+	if (queue == NULL || queue->hasReservedSysex()) return 0;
+	if (!activated) activated = true;
+	Bit32u playedCount = 0;
+	while (playedCount < count) {
+		// The events are stored into the free slots all at once, so the queue only publishes the batch when it is filled.
+		const Bit32u freeSpace = queue->getFreeSpace();
+		Bit32u batchSize = 0;
+		while (playedCount < count && batchSize < freeSpace) {
+			const MIDIEvent &event = events[playedCount];
+			Bit32u timestamp = event.timestamp;
+			if (event.sysex == NULL) {
+				if ((event.msg & 0xF8) == 0xF8) {
+					reportHandler->onMIDISystemRealtime(Bit8u(event.msg & 0xFF));
+				} else {
+					if (midiDelayMode != MIDIDelayMode_IMMEDIATE) {
+						timestamp = addMIDIInterfaceDelay(getShortMessageLength(event.msg), timestamp, *lastReceivedTimestamp);
+					}
+					queue->storeShortMessage(batchSize++, event.msg, timestamp);
+				}
+			} else {
+				// The delay of a SysEx message that doesn't fit in the storage is accounted again when it is retried.
+				const Bit32u previousReceivedTimestamp = *lastReceivedTimestamp;
+				if (midiDelayMode == MIDIDelayMode_DELAY_ALL) {
+					timestamp = addMIDIInterfaceDelay(event.sysexLength, timestamp, *lastReceivedTimestamp);
+				}
+				if (!queue->storeSysex(batchSize, event.sysex, event.sysexLength, timestamp)) {
+					*lastReceivedTimestamp = previousReceivedTimestamp;
+					break;
+				}
+				batchSize++;
+			}
+			playedCount++;
+		}
+		queue->commitBatch(batchSize);
+		if (playedCount == count) break;
+		// A growable queue is enlarged when the batch fills it up, before the overflow is reported.
+		if (batchSize == freeSpace && queue->grow()) continue;
+		if (!handleMIDIQueueOverflow(*queue)) break;
+	}
+	return playedCount;
+}
+
+bool Synth::handleMIDIQueueOverflow(MidiEventQueue &queue) {
+	queue.registerOverflow();
+	return reportHandler->onMIDIQueueOverflow();
+}
+
+Bit8u *Synth::reserveSysexOnInput(Bit32u inputNum, Bit32u maxLen) {
+	volatile Bit32u *lastReceivedTimestamp;
+	MidiEventQueue *queue = getMIDIInputQueue(inputNum, lastReceivedTimestamp);
+	if (queue == NULL || maxLen == 0 || queue->hasReservedSysex()) return NULL;
+	do {
+		Bit8u *sysexData = queue->reserveSysex(maxLen);
+		if (sysexData != NULL) return sysexData;
+	} while (handleMIDIQueueOverflow(*queue));
+	return NULL;
+}
+
+bool Synth::playReservedSysexOnInput(Bit32u inputNum, Bit32u len) {
+	return playReservedSysexOnInput(inputNum, len, renderedSampleCount);
+}
+
+bool Synth::playReservedSysexOnInput(Bit32u inputNum, Bit32u len, Bit32u timestamp) {
+	volatile Bit32u *lastReceivedTimestamp;
+	MidiEventQueue *queue = getMIDIInputQueue(inputNum, lastReceivedTimestamp);
+	if (queue == NULL || !queue->hasReservedSysex()) return false;
+	if (len > 0) {
+		if (midiDelayMode == MIDIDelayMode_DELAY_ALL) {
+			timestamp = addMIDIInterfaceDelay(len, timestamp, *lastReceivedTimestamp);
+		}
+		if (!activated) activated = true;
+	}
+	return queue->pushReservedSysex(len, timestamp);
+}
+
+void Synth::playMsgNow(Bit32u msg) {
+	if (!opened) return;
+	TraceSpan traceSpan(extensions.traceSink, TraceSink::SpanKind_SHORT_MESSAGE, msg);
+
+	// The short messages may depend on the system settings written in the same batch of events.
+	applyPendingSystemRefreshes();
+
+	// NOTE: Active sense IS implemented in real hardware. However, realtime processing is clearly out of the library scope.
+	//       It is assumed that realtime consumers of the library respond to these MIDI events as appropriate.
 
 	Bit8u code = Bit8u((msg & 0x0000F0) >> 4);
 	Bit8u chan = Bit8u(msg & 0x00000F);
@@ -1151,6 +2538,7 @@ void Synth::playMsgOnPart(Bit8u part, Bit8u code, Bit8u note, Bit8u velocity) {
 }
 
 void Synth::playSysexNow(const Bit8u *sysex, Bit32u len) {
+	TraceSpan traceSpan(extensions.traceSink, TraceSink::SpanKind_SYSEX, len);
 	if (len < 2) {
 		printDebug("playSysex: Message is too short for sysex (%d bytes)", len);
 	}
@@ -1501,7 +2889,8 @@ void Synth::writeMemoryRegion(const MemoryRegion *region, Bit32u addr, Bit32u le
 #endif
 		}
 		if (parts[8] != NULL) {
-			parts[8]->refresh();
+			// Only the written drums need recaching, which keeps the cost of streamed rhythm setup edits proportional to their size
+			static_cast<RhythmPart *>(parts[8])->refreshDrums(first, last);
 		}
 		break;
 	case MR_TimbreTemp:
@@ -1520,6 +2909,7 @@ void Synth::writeMemoryRegion(const MemoryRegion *region, Bit32u addr, Bit32u le
 		break;
 	case MR_Patches:
 		region->write(first, off, data, len);
+		extensions.patchesModified = true;
 #if MT32EMU_MONITOR_SYSEX > 0
 		for (unsigned int i = first; i <= last; i++) {
 			PatchParam *patch = &mt32ram.patches[i];
@@ -1538,6 +2928,7 @@ void Synth::writeMemoryRegion(const MemoryRegion *region, Bit32u addr, Bit32u le
 		last += 128;
 		region->write(first, off, data, len);
 		for (unsigned int i = first; i <= last; i++) {
+			extensions.modifiedTimbres[i >> 5] |= 1 << (i & 31);
 #if MT32EMU_MONITOR_TIMBRES >= 1
 			TimbreParam *timbre = &mt32ram.timbres[i].timbre;
 			char instrumentName[11];
@@ -1641,13 +3032,13 @@ void Synth::writeMemoryRegion(const MemoryRegion *region, Bit32u addr, Bit32u le
 		printDebug("WRITE-SYSTEM:");
 #endif
 		if (off <= SYSTEM_MASTER_TUNE_OFF && off + len > SYSTEM_MASTER_TUNE_OFF) {
-			refreshSystemMasterTune();
+			extensions.pendingSystemRefreshes |= SYSTEM_REFRESH_MASTER_TUNE;
 		}
 		if (off <= SYSTEM_REVERB_LEVEL_OFF && off + len > SYSTEM_REVERB_MODE_OFF) {
-			refreshSystemReverbParameters();
+			extensions.pendingSystemRefreshes |= SYSTEM_REFRESH_REVERB_PARAMETERS;
 		}
 		if (off <= SYSTEM_RESERVE_SETTINGS_END_OFF && off + len > SYSTEM_RESERVE_SETTINGS_START_OFF) {
-			refreshSystemReserveSettings();
+			extensions.pendingSystemRefreshes |= SYSTEM_REFRESH_RESERVE_SETTINGS;
 		}
 		if (off <= SYSTEM_CHAN_ASSIGN_END_OFF && off + len > SYSTEM_CHAN_ASSIGN_START_OFF) {
 			int firstPart = off - SYSTEM_CHAN_ASSIGN_START_OFF;
@@ -1656,10 +3047,14 @@ void Synth::writeMemoryRegion(const MemoryRegion *region, Bit32u addr, Bit32u le
 			int lastPart = off + len - SYSTEM_CHAN_ASSIGN_START_OFF;
 			if(lastPart > 8)
 				lastPart = 8;
-			refreshSystemChanAssign(Bit8u(firstPart), Bit8u(lastPart));
+			extensions.pendingSystemRefreshes |= SYSTEM_REFRESH_CHAN_ASSIGN;
+			extensions.pendingChanAssignParts |= Bit16u(((2 << lastPart) - 1) & ~((1 << firstPart) - 1));
 		}
 		if (off <= SYSTEM_MASTER_VOL_OFF && off + len > SYSTEM_MASTER_VOL_OFF) {
-			refreshSystemMasterVol();
+			extensions.pendingSystemRefreshes |= SYSTEM_REFRESH_MASTER_VOL;
+		}
+		if (!extensions.systemRefreshesDeferred) {
+			applyPendingSystemRefreshes();
 		}
 		break;
 	case MR_Display:
@@ -1706,15 +3101,19 @@ void Synth::refreshSystemReverbParameters() {
 	reportHandler->onNewReverbLevel(mt32ram.system.reverbLevel);
 
 	BReverbModel *oldReverbModel = reverbModel;
+	extensions.reverbPreparationRequest = NO_REVERB_PREPARATION_REQUEST;
 	if (mt32ram.system.reverbTime == 0 && mt32ram.system.reverbLevel == 0) {
 		// Setting both time and level to 0 effectively disables wet reverb output on real devices.
 		// Take a shortcut in this case to reduce CPU load.
 		reverbModel = NULL;
 	} else {
-		reverbModel = reverbModels[mt32ram.system.reverbMode];
+		// The reverb remains silent until the model is swapped in, if its preparation is deferred.
+		extensions.pendingReverbTime = mt32ram.system.reverbTime;
+		extensions.pendingReverbLevel = mt32ram.system.reverbLevel;
+		reverbModel = selectReverbModel(mt32ram.system.reverbMode);
 	}
 	if (reverbModel != oldReverbModel) {
-		if (extensions.preallocatedReverbMemory) {
+		if (isReverbMemoryPreallocated()) {
 			if (isReverbEnabled()) {
 				reverbModel->mute();
 			}
@@ -1740,13 +3139,13 @@ void Synth::refreshSystemReserveSettings() {
 	partialManager->setReserve(rset);
 }
 
-void Synth::refreshSystemChanAssign(Bit8u firstPart, Bit8u lastPart) {
+void Synth::refreshSystemChanAssign(Bit16u touchedParts) {
 	memset(extensions.chantable, 0xFF, sizeof(extensions.chantable));
 
 	// CONFIRMED: In the case of assigning a MIDI channel to multiple parts,
 	//            the messages received on that MIDI channel are handled by all the parts.
 	for (Bit32u i = 0; i <= 8; i++) {
-		if (parts[i] != NULL && i >= firstPart && i <= lastPart) {
+		if (parts[i] != NULL && ((touchedParts >> i) & 1) != 0) {
 			// CONFIRMED: Decay is started for all polys, and all controllers are reset, for every part whose assignment was touched by the sysex write.
 			parts[i]->allSoundOff();
 			parts[i]->resetAllControllers();
@@ -1775,13 +3174,39 @@ void Synth::refreshSystemMasterVol() {
 }
 
 void Synth::refreshSystem() {
+	// Supersedes whatever refreshes are pending.
+	extensions.pendingSystemRefreshes = 0;
+	extensions.pendingChanAssignParts = 0;
 	refreshSystemMasterTune();
 	refreshSystemReverbParameters();
 	refreshSystemReserveSettings();
-	refreshSystemChanAssign(0, 8);
+	refreshSystemChanAssign(ALL_PARTS_MASK);
 	refreshSystemMasterVol();
 }
 
+void Synth::applyPendingSystemRefreshes() {
+	if (extensions.preparedReverbModel != NULL) swapInPreparedReverbModel();
+	Bit32u refreshes = extensions.pendingSystemRefreshes;
+	if (refreshes == 0) return;
+	extensions.pendingSystemRefreshes = 0;
+	if ((refreshes & SYSTEM_REFRESH_MASTER_TUNE) != 0) {
+		refreshSystemMasterTune();
+	}
+	if ((refreshes & SYSTEM_REFRESH_REVERB_PARAMETERS) != 0) {
+		refreshSystemReverbParameters();
+	}
+	if ((refreshes & SYSTEM_REFRESH_RESERVE_SETTINGS) != 0) {
+		refreshSystemReserveSettings();
+	}
+	if ((refreshes & SYSTEM_REFRESH_CHAN_ASSIGN) != 0) {
+		refreshSystemChanAssign(extensions.pendingChanAssignParts);
+		extensions.pendingChanAssignParts = 0;
+	}
+	if ((refreshes & SYSTEM_REFRESH_MASTER_VOL) != 0) {
+		refreshSystemMasterVol();
+	}
+}
+
 void Synth::reset() {
 	if (!opened) return;
 #if MT32EMU_MONITOR_SYSEX > 0
@@ -1789,7 +3214,14 @@ void Synth::reset() {
 #endif
 	reportHandler->onDeviceReset();
 	partialManager->deactivateAll();
-	mt32ram = mt32default;
+	resetEmulatedState();
+	isActive();
+}
+
+// Returns the parts and the emulated memory to the defaults, provided all the partials are deactivated.
+// The timbre caches of the parts are merely invalidated, they are rebuilt lazily when the parts play next.
+void Synth::resetEmulatedState() {
+	restoreDefaultMemory();
 	for (int i = 0; i < 9; i++) {
 		parts[i]->reset();
 		if (i != 8) {
@@ -1800,7 +3232,56 @@ void Synth::reset() {
 	}
 	refreshSystem();
 	resetMasterTunePitchDelta();
+}
+
+// The banks of the patches and the writable timbres make up the most of the emulated memory, yet they are rarely written.
+// So, only the entries modified since the defaults were last restored are copied back.
+void Synth::restoreDefaultMemory() {
+	memcpy(mt32ram.patchTemp, mt32default->patchTemp, sizeof(mt32ram.patchTemp));
+	memcpy(mt32ram.rhythmTemp, mt32default->rhythmTemp, sizeof(mt32ram.rhythmTemp));
+	memcpy(mt32ram.timbreTemp, mt32default->timbreTemp, sizeof(mt32ram.timbreTemp));
+	mt32ram.system = mt32default->system;
+	if (extensions.patchesModified) {
+		memcpy(mt32ram.patches, mt32default->patches, sizeof(mt32ram.patches));
+		extensions.patchesModified = false;
+	}
+	for (Bit32u i = 0; i < 8; i++) {
+		Bit32u modifiedTimbres = extensions.modifiedTimbres[i];
+		if (modifiedTimbres == 0) continue;
+		extensions.modifiedTimbres[i] = 0;
+		for (Bit32u timbreNum = i << 5; modifiedTimbres != 0; timbreNum++, modifiedTimbres >>= 1) {
+			if ((modifiedTimbres & 1) != 0) mt32ram.timbres[timbreNum] = mt32default->timbres[timbreNum];
+		}
+	}
+}
+
+Bit32u Synth::getMemoryStateSize() {
+	return Bit32u(sizeof(MemParams) + sizeof(Bit32s));
+}
+
+bool Synth::saveMemoryState(Bit8u *data) const {
+	if (!opened) return false;
+	memcpy(data, &mt32ram, sizeof(MemParams));
+	memcpy(data + sizeof(MemParams), &extensions.masterTunePitchDelta, sizeof(Bit32s));
+	return true;
+}
+
+bool Synth::restoreMemoryState(const Bit8u *data) {
+	if (!opened) return false;
+	reportHandler->onDeviceReset();
+	partialManager->deactivateAll();
+	memcpy(&mt32ram, data, sizeof(MemParams));
+	extensions.patchesModified = true;
+	memset(extensions.modifiedTimbres, 0xFF, sizeof(extensions.modifiedTimbres));
+	for (int i = 0; i < 9; i++) {
+		parts[i]->reset();
+		parts[i]->refresh();
+	}
+	refreshSystem();
+	// Restore the effective master tune that might differ from the system setting, see resetMasterTunePitchDelta().
+	memcpy(&extensions.masterTunePitchDelta, data + sizeof(MemParams), sizeof(Bit32s));
 	isActive();
+	return true;
 }
 
 void Synth::resetMasterTunePitchDelta() {
@@ -1827,6 +3308,11 @@ public:
 	virtual Bit8u *allocate(Bit32u sysexLength) = 0;
 	virtual void reclaimUnused(const Bit8u *sysexData, Bit32u sysexLength) = 0;
 	virtual void dispose(const Bit8u *sysexData, Bit32u sysexLength) = 0;
+	// Shrinks the most recently allocated block to the specified length, disposing it completely when the length is 0.
+	virtual void truncateLast(const Bit8u *sysexData, Bit32u sysexLength) = 0;
+	// Returns the number of bytes occupied by the storage given the total length of the SysEx data retained in the queue.
+	virtual size_t getMemoryUsage(size_t retainedSysexLength) const = 0;
+	virtual void lockMemory(MemoryLock &memoryLock) const = 0;
 };
 
 /** Storage space for SysEx data is allocated dynamically on demand and is disposed lazily. */
@@ -1841,6 +3327,19 @@ public:
 	void dispose(const Bit8u *sysexData, Bit32u) {
 		delete[] sysexData;
 	}
+
+	void truncateLast(const Bit8u *sysexData, Bit32u sysexLength) {
+		if (sysexLength == 0) delete[] sysexData;
+	}
+
+	size_t getMemoryUsage(size_t retainedSysexLength) const {
+		return sizeof(*this) + retainedSysexLength;
+	}
+
+	// The SysEx data allocated on demand can't be locked in advance.
+	void lockMemory(MemoryLock &memoryLock) const {
+		memoryLock.lock(this, sizeof(*this));
+	}
 };
 
 /**
@@ -1854,7 +3353,8 @@ public:
 		storageBuffer(new Bit8u[useStorageBufferSize]),
 		storageBufferSize(useStorageBufferSize),
 		startPosition(),
-		endPosition()
+		endPosition(),
+		lastAllocationEndPosition()
 	{}
 
 	~BufferedSysexDataStorage() {
@@ -1864,6 +3364,8 @@ public:
 	Bit8u *allocate(Bit32u sysexLength) {
 		Bit32u myStartPosition = startPosition;
 		Bit32u myEndPosition = endPosition;
+		// The end position to restore should the allocation be cancelled.
+		Bit32u myLastAllocationEndPosition = myEndPosition;
 
 		// When the free space isn't contiguous, the data is allocated either right after the end position
 		// or at the buffer beginning, wherever it fits.
@@ -1880,10 +3382,12 @@ public:
 					// concurrent reads, as there must be no SysEx messages in the queue.
 					startPosition = myStartPosition;
 				}
+				myLastAllocationEndPosition = 0;
 			} else if (myStartPosition <= sysexLength) return NULL;
 			myEndPosition = 0;
 		}
 		endPosition = myEndPosition + sysexLength;
+		lastAllocationEndPosition = myLastAllocationEndPosition;
 		return storageBuffer + myEndPosition;
 	}
 
@@ -1900,12 +3404,31 @@ public:
 
 	void dispose(const Bit8u *, Bit32u) {}
 
+	void truncateLast(const Bit8u *sysexData, Bit32u sysexLength) {
+		if (sysexLength == 0) {
+			endPosition = lastAllocationEndPosition;
+		} else {
+			endPosition = Bit32u(sysexData - storageBuffer) + sysexLength;
+		}
+	}
+
+	size_t getMemoryUsage(size_t) const {
+		return sizeof(*this) + storageBufferSize;
+	}
+
+	void lockMemory(MemoryLock &memoryLock) const {
+		memoryLock.lock(this, sizeof(*this));
+		memoryLock.lock(storageBuffer, storageBufferSize);
+	}
+
 private:
 	Bit8u * const storageBuffer;
 	const Bit32u storageBufferSize;
 
 	volatile Bit32u startPosition;
 	volatile Bit32u endPosition;
+	// Only accessed by the writer.
+	Bit32u lastAllocationEndPosition;
 };
 
 MidiEventQueue::SysexDataStorage *MidiEventQueue::SysexDataStorage::create(Bit32u storageBufferSize) {
@@ -1916,72 +3439,273 @@ MidiEventQueue::SysexDataStorage *MidiEventQueue::SysexDataStorage::create(Bit32
 	}
 }
 
-MidiEventQueue::MidiEventQueue(Bit32u useRingBufferSize, Bit32u storageBufferSize) :
+struct MidiEventQueue::RingBuffer {
+	MidiEvent * const events;
+	const Bit32u mask;
+	volatile Bit32u startPosition;
+	volatile Bit32u endPosition;
+	// Published by the writer once it stores to a grown ring buffer, after the last event in this one is committed.
+	RingBuffer * volatile successor;
+
+	explicit RingBuffer(Bit32u size) :
+		events(new MidiEvent[size]), mask(size - 1), startPosition(0), endPosition(0), successor(NULL)
+	{
+		for (Bit32u i = 0; i <= mask; i++) {
+			events[i].sysexData = NULL;
+		}
+	}
+
+	~RingBuffer() {
+		delete[] events;
+	}
+
+	bool isEmpty() const {
+		return startPosition == endPosition;
+	}
+
+private:
+	RingBuffer(const RingBuffer &);            // prevent copy-construction
+	RingBuffer &operator=(const RingBuffer &); // prevent assignment
+};
+
+MidiEventQueue::MidiEventQueue(Bit32u useRingBufferSize, Bit32u storageBufferSize, Bit32u useMaxRingBufferSize) :
 	sysexDataStorage(*SysexDataStorage::create(storageBufferSize)),
-	ringBuffer(new MidiEvent[useRingBufferSize]), ringBufferMask(useRingBufferSize - 1)
+	readRingBuffer(new RingBuffer(useRingBufferSize)), writeRingBuffer(readRingBuffer), retainedRingBuffer(readRingBuffer),
+	maxRingBufferSize(useMaxRingBufferSize), sysexReserved(false)
 {
-	for (Bit32u i = 0; i <= ringBufferMask; i++) {
-		ringBuffer[i].sysexData = NULL;
-	}
 	reset();
+	resetStats();
 }
 
 MidiEventQueue::~MidiEventQueue() {
-	for (Bit32u i = 0; i <= ringBufferMask; i++) {
-		volatile MidiEvent &currentEvent = ringBuffer[i];
-		sysexDataStorage.dispose(currentEvent.sysexData, currentEvent.sysexLength);
+	while (retainedRingBuffer != NULL) {
+		RingBuffer *successor = retainedRingBuffer->successor;
+		releaseRingBuffer(retainedRingBuffer);
+		retainedRingBuffer = successor;
 	}
 	delete &sysexDataStorage;
-	delete[] ringBuffer;
 }
 
 void MidiEventQueue::reset() {
-	startPosition = 0;
-	endPosition = 0;
+	readRingBuffer = writeRingBuffer;
+	releaseRetiredRingBuffers();
+	writeRingBuffer->startPosition = 0;
+	writeRingBuffer->endPosition = 0;
+	pushedEventCount = 0;
+	droppedEventCount = 0;
+	storedSysexLength = 0;
+	reclaimedSysexLength = 0;
+}
+
+bool MidiEventQueue::grow() {
+	const Bit32u ringBufferSize = writeRingBuffer->mask + 1;
+	if (ringBufferSize >= maxRingBufferSize || getFreeSpace() > 0) return false;
+	releaseRetiredRingBuffers();
+	RingBuffer *grownRingBuffer = new RingBuffer(ringBufferSize << 1);
+	writeRingBuffer->successor = grownRingBuffer;
+	writeRingBuffer = grownRingBuffer;
+	growCount++;
+	return true;
+}
+
+void MidiEventQueue::setMaxRingBufferSize(Bit32u useMaxRingBufferSize) {
+	maxRingBufferSize = useMaxRingBufferSize;
+}
+
+void MidiEventQueue::registerOverflow() {
+	overflowCount++;
+}
+
+void MidiEventQueue::getStats(MIDIEventQueueStats &stats) const {
+	stats.queueSize = writeRingBuffer->mask + 1;
+	stats.pendingEventCount = pushedEventCount - droppedEventCount;
+	stats.maxPendingEventCount = maxPendingEventCount;
+	stats.overflowCount = overflowCount;
+	stats.growCount = growCount;
+	stats.sysexStorageSize = 0;
+	stats.sysexStorageUsage = storedSysexLength - reclaimedSysexLength;
+	stats.maxSysexStorageUsage = maxSysexStorageUsage;
+}
+
+// The maximums start over from the current usage, as the pending events remain in the queue.
+void MidiEventQueue::resetStats() {
+	maxPendingEventCount = pushedEventCount - droppedEventCount;
+	maxSysexStorageUsage = storedSysexLength - reclaimedSysexLength;
+	overflowCount = 0;
+	growCount = 0;
+}
+
+// Counts all the ring buffers not yet released by the writer along with the SysEx data their events still refer to,
+// as the dynamic storage disposes of it lazily.
+size_t MidiEventQueue::getMemoryUsage() const {
+	size_t memoryUsage = sizeof(*this);
+	size_t retainedSysexLength = 0;
+	for (const RingBuffer *ringBuffer = retainedRingBuffer; ringBuffer != NULL; ringBuffer = ringBuffer->successor) {
+		memoryUsage += sizeof(RingBuffer) + (ringBuffer->mask + 1) * sizeof(MidiEvent);
+		for (Bit32u i = 0; i <= ringBuffer->mask; i++) {
+			const volatile MidiEvent &currentEvent = ringBuffer->events[i];
+			if (currentEvent.sysexData != NULL) retainedSysexLength += currentEvent.sysexLength;
+		}
+	}
+	return memoryUsage + sysexDataStorage.getMemoryUsage(retainedSysexLength);
+}
+
+// The ring buffers the queue grows into afterwards remain pageable.
+void MidiEventQueue::lockMemory(MemoryLock &memoryLock) const {
+	memoryLock.lock(this, sizeof(*this));
+	for (const RingBuffer *ringBuffer = retainedRingBuffer; ringBuffer != NULL; ringBuffer = ringBuffer->successor) {
+		memoryLock.lock(ringBuffer, sizeof(RingBuffer));
+		memoryLock.lock(ringBuffer->events, (ringBuffer->mask + 1) * sizeof(MidiEvent));
+	}
+	sysexDataStorage.lockMemory(memoryLock);
+}
+
+// Releases the ring buffers the reader has switched over from.
+void MidiEventQueue::releaseRetiredRingBuffers() {
+	RingBuffer * const myReadRingBuffer = readRingBuffer;
+	while (retainedRingBuffer != myReadRingBuffer) {
+		RingBuffer *successor = retainedRingBuffer->successor;
+		releaseRingBuffer(retainedRingBuffer);
+		retainedRingBuffer = successor;
+	}
+}
+
+void MidiEventQueue::releaseRingBuffer(RingBuffer *ringBuffer) {
+	for (Bit32u i = 0; i <= ringBuffer->mask; i++) {
+		volatile MidiEvent &currentEvent = ringBuffer->events[i];
+		sysexDataStorage.dispose(currentEvent.sysexData, currentEvent.sysexLength);
+	}
+	delete ringBuffer;
+}
+
+void MidiEventQueue::updatePendingEventCount(Bit32u newEventCount) {
+	pushedEventCount += newEventCount;
+	const Bit32u pendingEventCount = pushedEventCount - droppedEventCount;
+	if (maxPendingEventCount < pendingEventCount) maxPendingEventCount = pendingEventCount;
+}
+
+void MidiEventQueue::updateSysexStorageUsage(Bit32u newSysexLength) {
+	storedSysexLength += newSysexLength;
+	const Bit32u sysexStorageUsage = storedSysexLength - reclaimedSysexLength;
+	if (maxSysexStorageUsage < sysexStorageUsage) maxSysexStorageUsage = sysexStorageUsage;
 }
 
 bool MidiEventQueue::pushShortMessage(Bit32u shortMessageData, Bit32u timestamp) {
-	Bit32u newEndPosition = (endPosition + 1) & ringBufferMask;
-	// If ring buffer is full, bail out.
-	if (startPosition == newEndPosition) return false;
-	volatile MidiEvent &newEvent = ringBuffer[endPosition];
+	// If ring buffer is full and can't grow, bail out.
+	if (getFreeSpace() == 0 && !grow()) return false;
+	storeShortMessage(0, shortMessageData, timestamp);
+	commitBatch(1);
+	return true;
+}
+
+bool MidiEventQueue::pushSysex(const Bit8u *sysexData, Bit32u sysexLength, Bit32u timestamp) {
+	// If ring buffer is full and can't grow, bail out.
+	if (getFreeSpace() == 0 && !grow()) return false;
+	if (!storeSysex(0, sysexData, sysexLength, timestamp)) return false;
+	commitBatch(1);
+	return true;
+}
+
+Bit32u MidiEventQueue::getFreeSpace() const {
+	return (writeRingBuffer->startPosition - writeRingBuffer->endPosition - 1) & writeRingBuffer->mask;
+}
+
+void MidiEventQueue::storeShortMessage(Bit32u batchIx, Bit32u shortMessageData, Bit32u timestamp) {
+	volatile MidiEvent &newEvent = writeRingBuffer->events[(writeRingBuffer->endPosition + batchIx) & writeRingBuffer->mask];
 	sysexDataStorage.dispose(newEvent.sysexData, newEvent.sysexLength);
 	newEvent.sysexData = NULL;
 	newEvent.shortMessageData = shortMessageData;
 	newEvent.timestamp = timestamp;
-	endPosition = newEndPosition;
-	return true;
 }
 
-bool MidiEventQueue::pushSysex(const Bit8u *sysexData, Bit32u sysexLength, Bit32u timestamp) {
-	Bit32u newEndPosition = (endPosition + 1) & ringBufferMask;
-	// If ring buffer is full, bail out.
-	if (startPosition == newEndPosition) return false;
-	volatile MidiEvent &newEvent = ringBuffer[endPosition];
+bool MidiEventQueue::storeSysex(Bit32u batchIx, const Bit8u *sysexData, Bit32u sysexLength, Bit32u timestamp) {
+	volatile MidiEvent &newEvent = writeRingBuffer->events[(writeRingBuffer->endPosition + batchIx) & writeRingBuffer->mask];
 	sysexDataStorage.dispose(newEvent.sysexData, newEvent.sysexLength);
+	newEvent.sysexData = NULL;
 	Bit8u *dstSysexData = sysexDataStorage.allocate(sysexLength);
 	if (dstSysexData == NULL) return false;
 	memcpy(dstSysexData, sysexData, sysexLength);
 	newEvent.sysexData = dstSysexData;
 	newEvent.sysexLength = sysexLength;
 	newEvent.timestamp = timestamp;
-	endPosition = newEndPosition;
+	updateSysexStorageUsage(sysexLength);
 	return true;
 }
 
+void MidiEventQueue::commitBatch(Bit32u batchSize) {
+	if (batchSize == 0) return;
+	writeRingBuffer->endPosition = (writeRingBuffer->endPosition + batchSize) & writeRingBuffer->mask;
+	updatePendingEventCount(batchSize);
+}
+
+Bit8u *MidiEventQueue::reserveSysex(Bit32u maxSysexLength) {
+	// If there is a pending reservation already, or ring buffer is full and can't grow, bail out.
+	if (sysexReserved || (getFreeSpace() == 0 && !grow())) return NULL;
+	volatile MidiEvent &newEvent = writeRingBuffer->events[writeRingBuffer->endPosition];
+	sysexDataStorage.dispose(newEvent.sysexData, newEvent.sysexLength);
+	newEvent.sysexData = NULL;
+	Bit8u *dstSysexData = sysexDataStorage.allocate(maxSysexLength);
+	if (dstSysexData == NULL) return NULL;
+	// The event slot isn't visible to the reader until the reservation is pushed.
+	newEvent.sysexData = dstSysexData;
+	newEvent.sysexLength = maxSysexLength;
+	sysexReserved = true;
+	updateSysexStorageUsage(maxSysexLength);
+	return dstSysexData;
+}
+
+bool MidiEventQueue::pushReservedSysex(Bit32u sysexLength, Bit32u timestamp) {
+	if (!sysexReserved) return false;
+	volatile MidiEvent &newEvent = writeRingBuffer->events[writeRingBuffer->endPosition];
+	if (newEvent.sysexLength < sysexLength) return false;
+	sysexReserved = false;
+	// The excess space is released, so it's no longer accounted as used.
+	storedSysexLength -= newEvent.sysexLength - sysexLength;
+	sysexDataStorage.truncateLast(newEvent.sysexData, sysexLength);
+	if (sysexLength == 0) {
+		newEvent.sysexData = NULL;
+		return true;
+	}
+	newEvent.sysexLength = sysexLength;
+	newEvent.timestamp = timestamp;
+	commitBatch(1);
+	return true;
+}
+
+bool MidiEventQueue::hasReservedSysex() const {
+	return sysexReserved;
+}
+
 const volatile MidiEventQueue::MidiEvent *MidiEventQueue::peekMidiEvent() {
-	return isEmpty() ? NULL : &ringBuffer[startPosition];
+	if (isEmpty()) return NULL;
+	RingBuffer * const myReadRingBuffer = readRingBuffer;
+	return &myReadRingBuffer->events[myReadRingBuffer->startPosition];
 }
 
 void MidiEventQueue::dropMidiEvent() {
 	if (isEmpty()) return;
-	volatile MidiEvent &unusedEvent = ringBuffer[startPosition];
-	sysexDataStorage.reclaimUnused(unusedEvent.sysexData, unusedEvent.sysexLength);
-	startPosition = (startPosition + 1) & ringBufferMask;
-}
-
-bool MidiEventQueue::isEmpty() const {
-	return startPosition == endPosition;
+	RingBuffer * const myReadRingBuffer = readRingBuffer;
+	volatile MidiEvent &unusedEvent = myReadRingBuffer->events[myReadRingBuffer->startPosition];
+	if (unusedEvent.sysexData != NULL) {
+		sysexDataStorage.reclaimUnused(unusedEvent.sysexData, unusedEvent.sysexLength);
+		reclaimedSysexLength += unusedEvent.sysexLength;
+	}
+	myReadRingBuffer->startPosition = (myReadRingBuffer->startPosition + 1) & myReadRingBuffer->mask;
+	droppedEventCount++;
+}
+
+// Switches the reader to the successor of the drained ring buffer, should the writer have grown the queue.
+bool MidiEventQueue::isEmpty() {
+	RingBuffer *myReadRingBuffer = readRingBuffer;
+	while (myReadRingBuffer->isEmpty()) {
+		RingBuffer * const successor = myReadRingBuffer->successor;
+		if (successor == NULL) return true;
+		// The last events might have been committed before the successor was published.
+		if (!myReadRingBuffer->isEmpty()) break;
+		myReadRingBuffer = successor;
+		readRingBuffer = myReadRingBuffer;
+	}
+	return false;
 }
 
 void Synth::selectRendererType(RendererType newRendererType) {
@@ -1992,18 +3716,177 @@ RendererType Synth::getSelectedRendererType() const {
 	return extensions.selectedRendererType;
 }
 
+Bit32u Synth::getSupportedCPUFeatures() {
+	return Kernels::getSupportedCPUFeatures();
+}
+
+void Synth::setEnabledCPUFeatures(Bit32u cpuFeatures) {
+	extensions.enabledCPUFeatures = cpuFeatures;
+}
+
+Bit32u Synth::getEnabledCPUFeatures() const {
+	return extensions.enabledCPUFeatures;
+}
+
+bool Synth::getKernelVariant(Bit32u kernelIx, const char *&kernelName, const char *&variantName) const {
+	if (!opened || kernelIx >= Kernels::KERNEL_COUNT) return false;
+	kernelName = Kernels::getKernelName(kernelIx);
+	variantName = extensions.kernels.getVariantName(kernelIx);
+	return true;
+}
+
+const Kernels &Synth::getKernels() const {
+	return extensions.kernels;
+}
+
+RhythmHitCache *Synth::getRhythmHitCache() const {
+	return extensions.rhythmHitCacheEnabled ? extensions.rhythmHitCache : NULL;
+}
+
+Bit32u Synth::getPartialCullingAmp() const {
+	// The lower amp culls the partials at a lower attenuation.
+	const Bit32u cullingAmp = extensions.partialCullingAmp;
+	const Bit32u overloadCullingAmp = extensions.overloadCullingAmp;
+	if (cullingAmp == 0 || (overloadCullingAmp != 0 && overloadCullingAmp < cullingAmp)) return overloadCullingAmp;
+	return cullingAmp;
+}
+
+// The culling threshold in dB and the share of the partial count in quarters available to new notes, per degradation level.
+static const float OVERLOAD_GOVERNOR_CULLING_THRESHOLDS[OVERLOAD_GOVERNOR_MAX_LEVEL + 1] = {0.0f, 60.0f, 42.0f, 42.0f, 42.0f, 42.0f};
+static const Bit32u OVERLOAD_GOVERNOR_PARTIAL_QUARTERS[OVERLOAD_GOVERNOR_MAX_LEVEL + 1] = {4, 4, 4, 3, 2, 1};
+// The load is evaluated once per window of at least this many samples, which is about a typical audio period.
+static const Bit32u OVERLOAD_GOVERNOR_WINDOW_LENGTH = 512;
+// The share of the render budget the load must stay under, and for how many seconds of audio, for the level to step down.
+static const double OVERLOAD_GOVERNOR_RECOVERY_LOAD = 0.6;
+static const Bit32u OVERLOAD_GOVERNOR_RECOVERY_SECONDS = 2;
+
+void Synth::resetOverloadGovernor() {
+	extensions.overloadGovernorLevel = 0;
+	extensions.overloadGovernorWindowTime = 0.0;
+	extensions.overloadGovernorWindowLength = 0;
+	extensions.overloadGovernorRecoveryLength = 0;
+	applyOverloadGovernorLevel();
+}
+
+void Synth::updateOverloadGovernor(double renderTime, Bit32u len) {
+	extensions.overloadGovernorWindowTime += renderTime;
+	extensions.overloadGovernorWindowLength += len;
+	const Bit32u windowLength = extensions.overloadGovernorWindowLength;
+	if (windowLength < OVERLOAD_GOVERNOR_WINDOW_LENGTH) return;
+	const Bit32u sampleRate = getStereoOutputSampleRate();
+	const double load = extensions.overloadGovernorWindowTime * sampleRate / (1e9 * windowLength);
+	extensions.overloadGovernorWindowTime = 0.0;
+	extensions.overloadGovernorWindowLength = 0;
+	const double budget = extensions.overloadGovernorRenderBudget;
+	Bit32u level = extensions.overloadGovernorLevel;
+	if (load > budget) {
+		extensions.overloadGovernorRecoveryLength = 0;
+		if (level == OVERLOAD_GOVERNOR_MAX_LEVEL) return;
+		level++;
+	} else if (level > 0 && load < budget * OVERLOAD_GOVERNOR_RECOVERY_LOAD) {
+		extensions.overloadGovernorRecoveryLength += windowLength;
+		if (extensions.overloadGovernorRecoveryLength < OVERLOAD_GOVERNOR_RECOVERY_SECONDS * sampleRate) return;
+		extensions.overloadGovernorRecoveryLength = 0;
+		level--;
+	} else {
+		extensions.overloadGovernorRecoveryLength = 0;
+		return;
+	}
+	extensions.overloadGovernorLevel = level;
+	applyOverloadGovernorLevel();
+#if MT32EMU_MONITOR_PARTIALS > 0
+	printDebug("Overload governor: load %.2f, degradation level %u", load, level);
+#endif
+}
+
+void Synth::applyOverloadGovernorLevel() {
+	const Bit32u level = extensions.overloadGovernorLevel;
+	extensions.overloadCullingAmp = getCullingAmp(OVERLOAD_GOVERNOR_CULLING_THRESHOLDS[level]);
+	if (partialManager == NULL) return;
+	// Rounded up, so that a single partial is never withheld entirely.
+	partialManager->setPartialLimit((partialCount * OVERLOAD_GOVERNOR_PARTIAL_QUARTERS[level] + 3) / 4);
+}
+
+SampleFormatConversion Synth::getSampleFormatConversion() const {
+	SampleFormatConversion conversion = {extensions.kernels, extensions.outputDither ? &extensions.ditherPosition : NULL};
+	return conversion;
+}
+
+void Synth::convertOutputSamples(const float *inBuffer, Bit16s *outBuffer, Bit32u len) const {
+	convertSampleFormat(getSampleFormatConversion(), inBuffer, outBuffer, len);
+}
+
 Bit32u Synth::getStereoOutputSampleRate() const {
 	return (analog == NULL) ? SAMPLE_RATE : analog->getOutputSampleRate();
 }
 
+double Synth::getOutputLatencyFrames() const {
+	if (!opened) return 0.0;
+	double latency = analog->getLatency();
+	if (midiDelayMode != MIDIDelayMode_IMMEDIATE) {
+		// A note-on message is 3 bytes long, its timestamp is truncated the same way in addMIDIInterfaceDelay()
+		latency += double(Bit32u(3.0 * MIDI_DATA_TRANSFER_RATE)) * getStereoOutputSampleRate() / SAMPLE_RATE;
+	}
+	return latency;
+}
+
+const float *Synth::bypassAccurateAnalogLowPassFilter(Bit32u &tapCount, Bit32u &upsampleFactor) {
+	if (!opened || extensions.analogLowPassFilterBypassed) return NULL;
+	if (extensions.analogOutputMode != AnalogOutputMode_ACCURATE && extensions.analogOutputMode != AnalogOutputMode_OVERSAMPLED) return NULL;
+	analog->replaceLowPassFilter(AnalogOutputMode_DIGITAL_ONLY, controlROMFeatures->oldMT32AnalogLPF);
+	extensions.analogLowPassFilterBypassed = true;
+	return Analog::getAccurateLowPassFilterTaps(controlROMFeatures->oldMT32AnalogLPF, tapCount, upsampleFactor);
+}
+
+void Synth::restoreAnalogLowPassFilter() {
+	if (!extensions.analogLowPassFilterBypassed) return;
+	analog->replaceLowPassFilter(extensions.analogOutputMode, controlROMFeatures->oldMT32AnalogLPF);
+	extensions.analogLowPassFilterBypassed = false;
+}
+
+template <class Sample>
+bool RendererImpl<Sample>::isSilent() {
+	if (getPartialManager().getActivePartialCount() > 0 || getNextMidiQueue().peekMidiEvent() != NULL) {
+		silent = false;
+		return false;
+	}
+	// Once proven, the silence persists until either a partial plays or the reverb model is replaced.
+	// Except that an external reverb engine may receive the input from elsewhere, so it is always queried.
+	BReverbModel *reverbModel = synth.isReverbEnabled() ? &getReverbModel() : NULL;
+	if (silent && silentReverbModel == reverbModel && (reverbModel == NULL || synth.getReverbEngine() == NULL)) return true;
+	if (reverbModel != NULL && !reverbModel->isSilent()) {
+		if (reverbModel->isActive()) return false;
+		// A decayed reverb tail may never reach exact zeros, though it is discarded by Synth::isActive() anyway.
+		reverbModel->mute();
+	}
+	silent = getAnalog().isSilent();
+	silentReverbModel = reverbModel;
+	return silent;
+}
+
+template <class Sample>
+bool RendererImpl<Sample>::skipSilence(Bit32u len) {
+	// Pending MIDI events must be played at their timestamps, so they are never skipped over.
+	if (isActivated() ? !isSilent() : getNextMidiQueue().peekMidiEvent() != NULL) return false;
+	incRenderedSampleCount(getAnalog().getDACStreamsLength(len));
+	Sample *noStream = NULL;
+	if (!getAnalog().process(noStream, noStream, noStream, noStream, noStream, noStream, noStream, len)) {
+		printDebug("RendererImpl: Invalid call to Analog::process()!\n");
+	}
+	return true;
+}
+
 template <class Sample>
 void RendererImpl<Sample>::doRender(Sample *stereoStream, Bit32u len) {
-	if (!isActivated()) {
+	// When the whole chain is certain to produce zeros, we skip rendering yet keep the analog emulation in phase.
+	if (!isActivated() || isSilent()) {
 		incRenderedSampleCount(getAnalog().getDACStreamsLength(len));
+		RenderProfilingTimer timer(getRenderProfile());
 		if (!getAnalog().process(NULL, NULL, NULL, NULL, NULL, NULL, stereoStream, len)) {
 			printDebug("RendererImpl: Invalid call to Analog::process()!\n");
 		}
 		Synth::muteSampleBuffer(stereoStream, len << 1);
+		timer.lap(&RenderProfile::analogTime);
 		return;
 	}
 
@@ -2011,11 +3894,13 @@ void RendererImpl<Sample>::doRender(Sample *stereoStream, Bit32u len) {
 		// As in AnalogOutputMode_ACCURATE mode output is upsampled, MAX_SAMPLES_PER_RUN is more than enough for the temp buffers.
 		Bit32u thisPassLen = len > MAX_SAMPLES_PER_RUN ? MAX_SAMPLES_PER_RUN : len;
 		doRenderStreams(tmpBuffers, getAnalog().getDACStreamsLength(thisPassLen));
+		RenderProfilingTimer timer(getRenderProfile());
 		if (!getAnalog().process(stereoStream, tmpNonReverbLeft, tmpNonReverbRight, tmpReverbDryLeft, tmpReverbDryRight, tmpReverbWetLeft, tmpReverbWetRight, thisPassLen)) {
 			printDebug("RendererImpl: Invalid call to Analog::process()!\n");
 			Synth::muteSampleBuffer(stereoStream, len << 1);
 			return;
 		}
+		timer.lap(&RenderProfile::analogTime);
 		stereoStream += thisPassLen << 1;
 		len -= thisPassLen;
 	}
@@ -2028,7 +3913,7 @@ void RendererImpl<Sample>::doRenderAndConvert(O *stereoStream, Bit32u len) {
 	while (len > 0) {
 		Bit32u thisPassLen = len > MAX_SAMPLES_PER_RUN ? MAX_SAMPLES_PER_RUN : len;
 		doRender(renderingBuffer, thisPassLen);
-		convertSampleFormat(renderingBuffer, stereoStream, thisPassLen << 1);
+		convertSampleFormat(getSampleFormatConversion(), renderingBuffer, stereoStream, thisPassLen << 1);
 		stereoStream += thisPassLen << 1;
 		len -= thisPassLen;
 	}
@@ -2055,20 +3940,164 @@ void RendererImpl<FloatSample>::render(FloatSample *stereoStream, Bit32u len) {
 }
 
 template <class S>
-static inline void renderStereo(bool opened, Renderer *renderer, S *stream, Bit32u len) {
+static inline void renderStereo(bool opened, Renderer *renderer, RenderProfile *renderProfile, TraceSink *traceSink, S *stream, Bit32u len) {
+	TraceSpan traceSpan(traceSink, TraceSink::SpanKind_RENDER, len);
+	RenderProfilingTimer timer(renderProfile);
+	DenormalsFlushScope denormalsFlushScope;
 	if (opened) {
 		renderer->render(stream, len);
 	} else {
 		Synth::muteSampleBuffer(stream, len << 1);
 	}
+	timer.lap(&RenderProfile::totalTime);
+	if (renderProfile != NULL) renderProfile->renderCallCount++;
 }
 
 void Synth::render(Bit16s *stream, Bit32u len) {
-	renderStereo(opened, renderer, stream, len);
+	MT32EMU_REALTIME_RENDERING_SCOPE
+	OverloadGovernorTimer overloadGovernorTimer(*this, len);
+	renderStereo(opened, renderer, getEnabledRenderProfile(), extensions.traceSink, stream, len);
+	publishSampleClock();
 }
 
 void Synth::render(float *stream, Bit32u len) {
-	renderStereo(opened, renderer, stream, len);
+	MT32EMU_REALTIME_RENDERING_SCOPE
+	OverloadGovernorTimer overloadGovernorTimer(*this, len);
+	renderStereo(opened, renderer, getEnabledRenderProfile(), extensions.traceSink, stream, len);
+	publishSampleClock();
+}
+
+void Synth::render(float *leftStream, float *rightStream, Bit32u len) {
+	// The analog circuitry emulation produces interleaved output, so it is split per run while still in the cache.
+	float stereoBuffer[MAX_SAMPLES_PER_RUN << 1];
+	while (len > 0) {
+		Bit32u thisPassLen = len > MAX_SAMPLES_PER_RUN ? MAX_SAMPLES_PER_RUN : len;
+		render(stereoBuffer, thisPassLen);
+		const float *inSamples = stereoBuffer;
+		for (Bit32u i = 0; i < thisPassLen; i++) {
+			*(leftStream++) = *(inSamples++);
+			*(rightStream++) = *(inSamples++);
+		}
+		len -= thisPassLen;
+	}
+}
+
+// Keeps the position in the output stream that renderWithEvents() fills piecewise, between the events.
+class OutputStreamCursor {
+public:
+	virtual ~OutputStreamCursor() {}
+
+	virtual void render(Bit32u len) = 0;
+};
+
+template <class Sample>
+class InterleavedStreamCursor : public OutputStreamCursor {
+public:
+	InterleavedStreamCursor(Synth &useSynth, Sample *useStream) : synth(useSynth), stream(useStream) {}
+
+	void render(Bit32u len) {
+		synth.render(stream, len);
+		stream += len << 1;
+	}
+
+private:
+	Synth &synth;
+	Sample *stream;
+};
+
+class PlanarStreamCursor : public OutputStreamCursor {
+public:
+	PlanarStreamCursor(Synth &useSynth, float *useLeftStream, float *useRightStream) :
+		synth(useSynth), leftStream(useLeftStream), rightStream(useRightStream)
+	{}
+
+	void render(Bit32u len) {
+		synth.render(leftStream, rightStream, len);
+		leftStream += len;
+		rightStream += len;
+	}
+
+private:
+	Synth &synth;
+	float *leftStream;
+	float *rightStream;
+};
+
+Bit32u Synth::renderWithEvents(Bit16s *stream, Bit32u len, const MIDIEvent *events, Bit32u count) {
+	InterleavedStreamCursor<Bit16s> cursor(*this, stream);
+	return renderPlayingEvents(cursor, len, events, count);
+}
+
+Bit32u Synth::renderWithEvents(float *stream, Bit32u len, const MIDIEvent *events, Bit32u count) {
+	InterleavedStreamCursor<float> cursor(*this, stream);
+	return renderPlayingEvents(cursor, len, events, count);
+}
+
+Bit32u Synth::renderWithEvents(float *leftStream, float *rightStream, Bit32u len, const MIDIEvent *events, Bit32u count) {
+	PlanarStreamCursor cursor(*this, leftStream, rightStream);
+	return renderPlayingEvents(cursor, len, events, count);
+}
+
+bool Synth::isQueuedMIDIEventDue() {
+	const volatile MidiEventQueue::MidiEvent *nextEvent = getNextMIDIEventQueue().peekMidiEvent();
+	return nextEvent != NULL && Bit32s(nextEvent->timestamp - renderedSampleCount) <= 0;
+}
+
+Bit32u Synth::renderPlayingEvents(OutputStreamCursor &cursor, Bit32u len, const MIDIEvent *events, Bit32u count) {
+	const Bit32u baseTimestamp = renderedSampleCount;
+	Bit32u renderedLength = 0;
+	Bit32u playedCount = 0;
+	while (playedCount < count) {
+		const MIDIEvent &event = events[playedCount];
+		if (event.timestamp >= len) break;
+		if (event.timestamp > renderedLength) {
+			cursor.render(event.timestamp - renderedLength);
+			renderedLength = event.timestamp;
+		}
+		// Just like the queued events, this one waits while a poly abortion is in progress, which takes time.
+		// The queued events that are due by now go first as well, so that the order of the events is retained.
+		while ((isAbortingPoly() || isQueuedMIDIEventDue()) && renderedLength < len) {
+			cursor.render(1);
+			renderedLength++;
+		}
+		if (isAbortingPoly() || isQueuedMIDIEventDue()) break;
+		if (event.sysex != NULL) {
+			playSysexNow(event.sysex, event.sysexLength);
+		} else if ((event.msg & 0xF8) == 0xF8) {
+			reportHandler->onMIDISystemRealtime(Bit8u(event.msg & 0xFF));
+		} else {
+			playMsgNow(event.msg);
+			// When the message causes a poly abortion, it's played again after the abortion completes.
+			while (isAbortingPoly() && renderedLength < len) {
+				cursor.render(1);
+				renderedLength++;
+				if (!isAbortingPoly()) playMsgNow(event.msg);
+			}
+			// Otherwise, the message is left for the MIDI event queue to retry.
+			if (isAbortingPoly()) break;
+		}
+		playedCount++;
+	}
+	if (renderedLength < len) {
+		cursor.render(len - renderedLength);
+	}
+	if (playedCount == count) return count;
+
+	// The rest is enqueued in small batches converted on the stack, with the offsets turned into the timestamps.
+	static const Bit32u EVENT_BATCH_SIZE = 64;
+	const double outputToInternalSampleRateRatio = double(SAMPLE_RATE) / double(getStereoOutputSampleRate());
+	MIDIEvent batch[EVENT_BATCH_SIZE];
+	while (playedCount < count) {
+		const Bit32u batchSize = count - playedCount < EVENT_BATCH_SIZE ? count - playedCount : EVENT_BATCH_SIZE;
+		for (Bit32u eventIx = 0; eventIx < batchSize; eventIx++) {
+			batch[eventIx] = events[playedCount + eventIx];
+			batch[eventIx].timestamp = baseTimestamp + Bit32u(0.5 + batch[eventIx].timestamp * outputToInternalSampleRateRatio);
+		}
+		const Bit32u batchPlayedCount = playEvents(batch, batchSize);
+		playedCount += batchPlayedCount;
+		if (batchPlayedCount < batchSize) break;
+	}
+	return playedCount;
 }
 
 template <class Sample>
@@ -2099,24 +4128,62 @@ static inline void muteStreams(const DACOutputStreams<Sample> &streams, Bit32u l
 }
 
 template <class I, class O>
-static inline void convertStreamsFormat(const DACOutputStreams<I> &inStreams, const DACOutputStreams<O> &outStreams, Bit32u len) {
-	convertSampleFormat(inStreams.nonReverbLeft, outStreams.nonReverbLeft, len);
-	convertSampleFormat(inStreams.nonReverbRight, outStreams.nonReverbRight, len);
-	convertSampleFormat(inStreams.reverbDryLeft, outStreams.reverbDryLeft, len);
-	convertSampleFormat(inStreams.reverbDryRight, outStreams.reverbDryRight, len);
-	convertSampleFormat(inStreams.reverbWetLeft, outStreams.reverbWetLeft, len);
-	convertSampleFormat(inStreams.reverbWetRight, outStreams.reverbWetRight, len);
+static inline void convertStreamsFormat(const SampleFormatConversion &conversion, const DACOutputStreams<I> &inStreams, const DACOutputStreams<O> &outStreams, Bit32u len) {
+	convertSampleFormat(conversion, inStreams.nonReverbLeft, outStreams.nonReverbLeft, len);
+	convertSampleFormat(conversion, inStreams.nonReverbRight, outStreams.nonReverbRight, len);
+	convertSampleFormat(conversion, inStreams.reverbDryLeft, outStreams.reverbDryLeft, len);
+	convertSampleFormat(conversion, inStreams.reverbDryRight, outStreams.reverbDryRight, len);
+	convertSampleFormat(conversion, inStreams.reverbWetLeft, outStreams.reverbWetLeft, len);
+	convertSampleFormat(conversion, inStreams.reverbWetRight, outStreams.reverbWetRight, len);
+}
+
+template <class Sample>
+static inline void advanceStreams(PartOutputStreams<Sample> &streams, Bit32u len) {
+	for (Bit32u partIx = 0; partIx < PART_OUTPUT_STREAM_COUNT; partIx++) {
+		advanceStream(streams.partLeft[partIx], len);
+		advanceStream(streams.partRight[partIx], len);
+	}
+	advanceStream(streams.reverbWetLeft, len);
+	advanceStream(streams.reverbWetRight, len);
+}
+
+template <class Sample>
+static inline void muteStreams(const PartOutputStreams<Sample> &streams, Bit32u len) {
+	for (Bit32u partIx = 0; partIx < PART_OUTPUT_STREAM_COUNT; partIx++) {
+		Synth::muteSampleBuffer(streams.partLeft[partIx], len);
+		Synth::muteSampleBuffer(streams.partRight[partIx], len);
+	}
+	Synth::muteSampleBuffer(streams.reverbWetLeft, len);
+	Synth::muteSampleBuffer(streams.reverbWetRight, len);
+}
+
+template <class I, class O>
+static inline void convertStreamsFormat(const SampleFormatConversion &conversion, const PartOutputStreams<I> &inStreams, const PartOutputStreams<O> &outStreams, Bit32u len) {
+	for (Bit32u partIx = 0; partIx < PART_OUTPUT_STREAM_COUNT; partIx++) {
+		convertSampleFormat(conversion, inStreams.partLeft[partIx], outStreams.partLeft[partIx], len);
+		convertSampleFormat(conversion, inStreams.partRight[partIx], outStreams.partRight[partIx], len);
+	}
+	convertSampleFormat(conversion, inStreams.reverbWetLeft, outStreams.reverbWetLeft, len);
+	convertSampleFormat(conversion, inStreams.reverbWetRight, outStreams.reverbWetRight, len);
 }
 
 template <class Sample>
-void RendererImpl<Sample>::doRenderStreams(const DACOutputStreams<Sample> &streams, Bit32u len)
+template <class Streams>
+void RendererImpl<Sample>::doRenderStreams(const Streams &streams, Bit32u len)
 {
-	DACOutputStreams<Sample> tmpStreams = streams;
+	Streams tmpStreams = streams;
 	while (len > 0) {
 		// We need to ensure zero-duration notes will play so add minimum 1-sample delay.
 		Bit32u thisLen = 1;
-		if (!isAbortingPoly()) {
-			const volatile MidiEventQueue::MidiEvent *nextEvent = getMidiQueue().peekMidiEvent();
+		if (isAbortingPoly()) {
+			// No events are processed until the abortion completes, which always takes a partial deactivation. So, the samples
+			// rendered before any partial may get deactivated go in one run, along with the sample where that happens first.
+			// The partials freed in the same sample are returned in the same order as if rendered sample-by-sample.
+			thisLen = getPartialManager().samplesUntilPartialDeactivation((len > MAX_SAMPLES_PER_RUN ? MAX_SAMPLES_PER_RUN : len) - 1) + 1;
+			getPolyphonyStats().abortWaitSampleCount += thisLen;
+		} else {
+			MidiEventQueue &midiQueue = getNextMidiQueue();
+			const volatile MidiEventQueue::MidiEvent *nextEvent = midiQueue.peekMidiEvent();
 			Bit32s samplesToNextEvent = (nextEvent != NULL) ? Bit32s(nextEvent->timestamp - getRenderedSampleCount()) : MAX_SAMPLES_PER_RUN;
 			if (samplesToNextEvent > 0) {
 				thisLen = len > MAX_SAMPLES_PER_RUN ? MAX_SAMPLES_PER_RUN : len;
@@ -2124,19 +4191,26 @@ void RendererImpl<Sample>::doRenderStreams(const DACOutputStreams<Sample> &strea
 					thisLen = samplesToNextEvent;
 				}
 			} else {
+				RenderProfile * const renderProfile = getRenderProfile();
+				RenderProfilingTimer timer(renderProfile);
 				if (nextEvent->sysexData == NULL) {
 					synth.playMsgNow(nextEvent->shortMessageData);
 					// If a poly is aborting we don't drop the event from the queue.
 					// Instead, we'll return to it again when the abortion is done.
 					if (!isAbortingPoly()) {
-						getMidiQueue().dropMidiEvent();
+						midiQueue.dropMidiEvent();
 					}
 				} else {
-					synth.playSysexNow(nextEvent->sysexData, nextEvent->sysexLength);
-					getMidiQueue().dropMidiEvent();
+					playQueuedSysex(*nextEvent);
+					midiQueue.dropMidiEvent();
 				}
+				timer.lap(&RenderProfile::midiEventsTime);
+				if (renderProfile != NULL) renderProfile->dispatchedEventCount++;
+				// Proceed to the next event due unless the poly abortion must complete first.
+				if (isMIDIEventBatchingEnabled() && !isAbortingPoly()) continue;
 			}
 		}
+		applyPendingSystemRefreshes();
 		produceStreams(tmpStreams, thisLen);
 		advanceStreams(tmpStreams, thisLen);
 		len -= thisLen;
@@ -2161,7 +4235,33 @@ void RendererImpl<Sample>::doRenderAndConvertStreams(const DACOutputStreams<O> &
 	while (len > 0) {
 		Bit32u thisPassLen = len > MAX_SAMPLES_PER_RUN ? MAX_SAMPLES_PER_RUN : len;
 		doRenderStreams(cnvStreams, thisPassLen);
-		convertStreamsFormat(cnvStreams, tmpStreams, thisPassLen);
+		convertStreamsFormat(getSampleFormatConversion(), cnvStreams, tmpStreams, thisPassLen);
+		advanceStreams(tmpStreams, thisPassLen);
+		len -= thisPassLen;
+	}
+}
+
+template <class Sample>
+template <class O>
+void RendererImpl<Sample>::doRenderAndConvertStreams(const PartOutputStreams<O> &streams, Bit32u len) {
+	Sample cnvPartLeft[PART_OUTPUT_STREAM_COUNT][MAX_SAMPLES_PER_RUN], cnvPartRight[PART_OUTPUT_STREAM_COUNT][MAX_SAMPLES_PER_RUN];
+	Sample cnvReverbWetLeft[MAX_SAMPLES_PER_RUN], cnvReverbWetRight[MAX_SAMPLES_PER_RUN];
+
+	// Unlike the DAC streams, the skipped part streams are worth leaving out of the rendering.
+	PartOutputStreams<Sample> cnvStreams;
+	for (Bit32u partIx = 0; partIx < PART_OUTPUT_STREAM_COUNT; partIx++) {
+		cnvStreams.partLeft[partIx] = streams.partLeft[partIx] == NULL ? NULL : cnvPartLeft[partIx];
+		cnvStreams.partRight[partIx] = streams.partRight[partIx] == NULL ? NULL : cnvPartRight[partIx];
+	}
+	cnvStreams.reverbWetLeft = streams.reverbWetLeft == NULL ? NULL : cnvReverbWetLeft;
+	cnvStreams.reverbWetRight = streams.reverbWetRight == NULL ? NULL : cnvReverbWetRight;
+
+	PartOutputStreams<O> tmpStreams = streams;
+
+	while (len > 0) {
+		Bit32u thisPassLen = len > MAX_SAMPLES_PER_RUN ? MAX_SAMPLES_PER_RUN : len;
+		doRenderStreams(cnvStreams, thisPassLen);
+		convertStreamsFormat(getSampleFormatConversion(), cnvStreams, tmpStreams, thisPassLen);
 		advanceStreams(tmpStreams, thisPassLen);
 		len -= thisPassLen;
 	}
@@ -2187,21 +4287,66 @@ void RendererImpl<FloatSample>::renderStreams(const DACOutputStreams<FloatSample
 	doRenderStreams(streams, len);
 }
 
-template <class S>
-static inline void renderStreams(bool opened, Renderer *renderer, const DACOutputStreams<S> &streams, Bit32u len) {
+template<>
+void RendererImpl<IntSample>::renderStreams(const PartOutputStreams<IntSample> &streams, Bit32u len) {
+	doRenderStreams(streams, len);
+}
+
+template<>
+void RendererImpl<IntSample>::renderStreams(const PartOutputStreams<FloatSample> &streams, Bit32u len) {
+	doRenderAndConvertStreams(streams, len);
+}
+
+template<>
+void RendererImpl<FloatSample>::renderStreams(const PartOutputStreams<IntSample> &streams, Bit32u len) {
+	doRenderAndConvertStreams(streams, len);
+}
+
+template<>
+void RendererImpl<FloatSample>::renderStreams(const PartOutputStreams<FloatSample> &streams, Bit32u len) {
+	doRenderStreams(streams, len);
+}
+
+template <class Streams>
+static inline void renderStreams(bool opened, Renderer *renderer, RenderProfile *renderProfile, TraceSink *traceSink, const Streams &streams, Bit32u len) {
+	TraceSpan traceSpan(traceSink, TraceSink::SpanKind_RENDER, len);
+	RenderProfilingTimer timer(renderProfile);
+	DenormalsFlushScope denormalsFlushScope;
 	if (opened) {
 		renderer->renderStreams(streams, len);
 	} else {
 		muteStreams(streams, len);
 	}
+	timer.lap(&RenderProfile::totalTime);
+	if (renderProfile != NULL) renderProfile->renderCallCount++;
 }
 
 void Synth::renderStreams(const DACOutputStreams<Bit16s> &streams, Bit32u len) {
-	MT32Emu::renderStreams(opened, renderer, streams, len);
+	MT32EMU_REALTIME_RENDERING_SCOPE
+	OverloadGovernorTimer overloadGovernorTimer(*this, len);
+	MT32Emu::renderStreams(opened, renderer, getEnabledRenderProfile(), extensions.traceSink, streams, len);
+	publishSampleClock();
 }
 
 void Synth::renderStreams(const DACOutputStreams<float> &streams, Bit32u len) {
-	MT32Emu::renderStreams(opened, renderer, streams, len);
+	MT32EMU_REALTIME_RENDERING_SCOPE
+	OverloadGovernorTimer overloadGovernorTimer(*this, len);
+	MT32Emu::renderStreams(opened, renderer, getEnabledRenderProfile(), extensions.traceSink, streams, len);
+	publishSampleClock();
+}
+
+void Synth::renderPartStreams(const PartOutputStreams<Bit16s> &streams, Bit32u len) {
+	MT32EMU_REALTIME_RENDERING_SCOPE
+	OverloadGovernorTimer overloadGovernorTimer(*this, len);
+	MT32Emu::renderStreams(opened, renderer, getEnabledRenderProfile(), extensions.traceSink, streams, len);
+	publishSampleClock();
+}
+
+void Synth::renderPartStreams(const PartOutputStreams<float> &streams, Bit32u len) {
+	MT32EMU_REALTIME_RENDERING_SCOPE
+	OverloadGovernorTimer overloadGovernorTimer(*this, len);
+	MT32Emu::renderStreams(opened, renderer, getEnabledRenderProfile(), extensions.traceSink, streams, len);
+	publishSampleClock();
 }
 
 void Synth::renderStreams(
@@ -2264,14 +4409,15 @@ void RendererImpl<IntSample>::convertSamplesToOutput(IntSample *buffer, Bit32u l
 	}
 }
 
-static inline float produceDistortedSample(float sample) {
-	// Here we roughly simulate the distortion caused by the DAC bit shift.
-	if (sample < -1.0f) {
-		return sample + 2.0f;
-	} else if (1.0f < sample) {
-		return sample - 2.0f;
+// Same as produceLA32Output() followed by convertSamplesToOutput(), but in a single pass over the buffer.
+// None of the DAC input modes alters the samples in both stages, so applying the one which does is sufficient.
+template <class Sample>
+void RendererImpl<Sample>::produceConvertedLA32Output(Sample *buffer, Bit32u len) {
+	if (synth.getDACInputMode() == DACInputMode_GENERATION1) {
+		convertSamplesToOutput(buffer, len);
+	} else {
+		produceLA32Output(buffer, len);
 	}
-	return sample;
 }
 
 template <>
@@ -2287,10 +4433,8 @@ void RendererImpl<FloatSample>::produceLA32Output(FloatSample *buffer, Bit32u le
 		}
 		break;
 	case DACInputMode_GENERATION2:
-		while (len--) {
-			*buffer = produceDistortedSample(2.0f * *buffer);
-			buffer++;
-		}
+		// Here we roughly simulate the distortion caused by the DAC bit shift.
+		getKernels().doubleAndWrapFloat(buffer, len);
 		break;
 	default:
 		break;
@@ -2300,60 +4444,240 @@ void RendererImpl<FloatSample>::produceLA32Output(FloatSample *buffer, Bit32u le
 template <>
 void RendererImpl<FloatSample>::convertSamplesToOutput(FloatSample *buffer, Bit32u len) {
 	if (synth.getDACInputMode() == DACInputMode_GENERATION1) {
-		while (len--) {
-			*buffer = produceDistortedSample(2.0f * *buffer);
-			buffer++;
+		getKernels().doubleAndWrapFloat(buffer, len);
+	}
+}
+
+static inline void mixPartialGroupOutput(IntSample *buffer, const IntSample *groupBuffer, Bit32u len) {
+	while (len--) {
+		*buffer = Synth::clipSampleEx(IntSampleEx(*buffer) + *(groupBuffer++));
+		buffer++;
+	}
+}
+
+static inline void mixPartialGroupOutput(FloatSample *buffer, const FloatSample *groupBuffer, Bit32u len) {
+	while (len--) {
+		*(buffer++) += *(groupBuffer++);
+	}
+}
+
+template <class Sample>
+void RendererImpl<Sample>::producePartialOutputConcurrently(Sample *nonReverbLeft, Sample *nonReverbRight, Sample *reverbDryLeft, Sample *reverbDryRight, Bit32u len) {
+	// In the deterministic mode, the grouping doesn't depend on the task count, so neither does the output.
+	// The buffers are allocated beforehand for the maximum number of groups, see allocatePartialRenderingBuffers().
+	const Bit32u groupCount = getPartialManager().groupPartialsByPoly(groupedPartials, partialGroupEnds, getMaxPartialGroupCount());
+	if (groupCount == 0) return;
+
+	PartialRenderingTask<Sample> task;
+	task.partials = groupedPartials;
+	task.groupEnds = partialGroupEnds;
+	task.groupCount = groupCount;
+	task.taskCount = getPartialRenderingTaskCount() < groupCount ? getPartialRenderingTaskCount() : groupCount;
+	task.outputBuffers[0] = nonReverbLeft;
+	task.outputBuffers[1] = nonReverbRight;
+	task.outputBuffers[2] = reverbDryLeft;
+	task.outputBuffers[3] = reverbDryRight;
+	task.groupBuffers = partialGroupBuffers;
+	task.len = len;
+
+	getPartialManager().setDeactivationDeferred(true);
+	if (task.taskCount == 1) {
+		task.run(0);
+	} else if (getNUMANode() < 0) {
+		getPartialRenderingExecutor()->execute(task, task.taskCount);
+	} else {
+		// All the partials share the memory of the synth, so the tasks are best run on its node.
+		for (Bit32u taskIx = 0; taskIx < task.taskCount; taskIx++) {
+			partialTaskNodes[taskIx] = getNUMANode();
 		}
+		getPartialRenderingExecutor()->executeOnNodes(task, task.taskCount, partialTaskNodes);
 	}
+	getPartialManager().setDeactivationDeferred(false);
+
+	// Fixed order of mixing keeps the output independent of the task scheduling.
+	for (Bit32u groupIx = 1; groupIx < groupCount; groupIx++) {
+		const Sample *groupBuffer = partialGroupBuffers + (groupIx - 1) * 4 * MAX_SAMPLES_PER_RUN;
+		if (nonReverbLeft != NULL) mixPartialGroupOutput(nonReverbLeft, groupBuffer, len);
+		if (nonReverbRight != NULL) mixPartialGroupOutput(nonReverbRight, groupBuffer + MAX_SAMPLES_PER_RUN, len);
+		if (reverbDryLeft != NULL) mixPartialGroupOutput(reverbDryLeft, groupBuffer + 2 * MAX_SAMPLES_PER_RUN, len);
+		if (reverbDryRight != NULL) mixPartialGroupOutput(reverbDryRight, groupBuffer + 3 * MAX_SAMPLES_PER_RUN, len);
+	}
+	getPartialManager().completeDeferredDeactivations();
+}
+
+template <class Sample>
+void RendererImpl<Sample>::processReverbModel(const Sample *reverbDryLeft, const Sample *reverbDryRight, Sample *reverbWetLeft, Sample *reverbWetRight, Bit32u len) {
+	TraceSpan traceSpan(synth.getTraceSink(), TraceSink::SpanKind_REVERB, len);
+	suspendedReverbModel = NULL;
+	if (!getReverbModel().process(reverbDryLeft, reverbDryRight, reverbWetLeft, reverbWetRight, len)) {
+		printDebug("RendererImpl: Invalid call to BReverbModel::process()!\n");
+	}
+	if (reverbWetLeft != NULL) convertSamplesToOutput(reverbWetLeft, len);
+	if (reverbWetRight != NULL) convertSamplesToOutput(reverbWetRight, len);
+}
+
+// While the wet output goes unused, the reverb model isn't run. It is muted once instead, so that it doesn't play
+// a stale tail when the wet output is taken again, same as if the reverb input was silent meanwhile.
+template <class Sample>
+void RendererImpl<Sample>::suspendReverbModel() {
+	BReverbModel &reverbModel = getReverbModel();
+	if (suspendedReverbModel == &reverbModel) return;
+	reverbModel.mute();
+	suspendedReverbModel = &reverbModel;
 }
 
 template <class Sample>
 void RendererImpl<Sample>::produceStreams(const DACOutputStreams<Sample> &streams, Bit32u len) {
+	RenderProfile * const renderProfile = getRenderProfile();
+	if (renderProfile != NULL) {
+		const Bit32u activePartialCount = getPartialManager().getActivePartialCount();
+		renderProfile->runCount++;
+		renderProfile->totalActivePartialCount += activePartialCount;
+		if (renderProfile->maxActivePartialCount < activePartialCount) {
+			renderProfile->maxActivePartialCount = activePartialCount;
+		}
+	}
+	RenderProfilingTimer timer(renderProfile);
+
 	if (isActivated()) {
-		// Even if LA32 output isn't desired, we proceed anyway with temp buffers
-		Sample *nonReverbLeft = streams.nonReverbLeft == NULL ? tmpNonReverbLeft : streams.nonReverbLeft;
-		Sample *nonReverbRight = streams.nonReverbRight == NULL ? tmpNonReverbRight : streams.nonReverbRight;
-		Sample *reverbDryLeft = streams.reverbDryLeft == NULL ? tmpReverbDryLeft : streams.reverbDryLeft;
-		Sample *reverbDryRight = streams.reverbDryRight == NULL ? tmpReverbDryRight : streams.reverbDryRight;
-
-		Synth::muteSampleBuffer(nonReverbLeft, len);
-		Synth::muteSampleBuffer(nonReverbRight, len);
-		Synth::muteSampleBuffer(reverbDryLeft, len);
-		Synth::muteSampleBuffer(reverbDryRight, len);
-
-		for (unsigned int i = 0; i < synth.getPartialCount(); i++) {
-			if (getPartialManager().shouldReverb(i)) {
-				getPartialManager().produceOutput(i, reverbDryLeft, reverbDryRight, len);
-			} else {
-				getPartialManager().produceOutput(i, nonReverbLeft, nonReverbRight, len);
+		// The partials routed to a bus nobody takes the output of are only advanced. The reverb input is also needed
+		// for the wet output, the reverb model only runs when the wet output is taken.
+		const bool reverbModelUsed = synth.isReverbEnabled() && (streams.reverbWetLeft != NULL || streams.reverbWetRight != NULL);
+		const bool nonReverbBusUsed = streams.nonReverbLeft != NULL || streams.nonReverbRight != NULL;
+		const bool reverbBusUsed = reverbModelUsed || streams.reverbDryLeft != NULL || streams.reverbDryRight != NULL;
+
+		// Even if LA32 output of a channel isn't desired, we proceed anyway with temp buffers
+		Sample *nonReverbLeft = NULL;
+		Sample *nonReverbRight = NULL;
+		if (nonReverbBusUsed) {
+			nonReverbLeft = streams.nonReverbLeft == NULL ? tmpNonReverbLeft : streams.nonReverbLeft;
+			nonReverbRight = streams.nonReverbRight == NULL ? tmpNonReverbRight : streams.nonReverbRight;
+			Synth::muteSampleBuffer(nonReverbLeft, len);
+			Synth::muteSampleBuffer(nonReverbRight, len);
+		}
+		Sample *reverbDryLeft = NULL;
+		Sample *reverbDryRight = NULL;
+		if (reverbBusUsed) {
+			reverbDryLeft = streams.reverbDryLeft == NULL ? tmpReverbDryLeft : streams.reverbDryLeft;
+			reverbDryRight = streams.reverbDryRight == NULL ? tmpReverbDryRight : streams.reverbDryRight;
+			Synth::muteSampleBuffer(reverbDryLeft, len);
+			Synth::muteSampleBuffer(reverbDryRight, len);
+		}
+
+		if (getPartialRenderingExecutor() != NULL || getPartialRenderingGroupCount() != 0) {
+			producePartialOutputConcurrently(nonReverbLeft, nonReverbRight, reverbDryLeft, reverbDryRight, len);
+		} else {
+			const Bit32u renderedPartialCount = getPartialManager().getActivePartials(renderedPartials);
+			for (Bit32u renderedPartialIx = 0; renderedPartialIx < renderedPartialCount; renderedPartialIx++) {
+				const int i = renderedPartials[renderedPartialIx];
+				if (getPartialManager().shouldReverb(i)) {
+					getPartialManager().produceOutput(i, reverbDryLeft, reverbDryRight, len);
+				} else {
+					getPartialManager().produceOutput(i, nonReverbLeft, nonReverbRight, len);
+				}
 			}
 		}
 
-		produceLA32Output(reverbDryLeft, len);
-		produceLA32Output(reverbDryRight, len);
+		if (reverbBusUsed) {
+			produceLA32Output(reverbDryLeft, len);
+			produceLA32Output(reverbDryRight, len);
+		}
+		timer.lap(&RenderProfile::partialsTime);
 
-		if (synth.isReverbEnabled()) {
-			if (!getReverbModel().process(reverbDryLeft, reverbDryRight, streams.reverbWetLeft, streams.reverbWetRight, len)) {
-				printDebug("RendererImpl: Invalid call to BReverbModel::process()!\n");
-			}
-			if (streams.reverbWetLeft != NULL) convertSamplesToOutput(streams.reverbWetLeft, len);
-			if (streams.reverbWetRight != NULL) convertSamplesToOutput(streams.reverbWetRight, len);
+		if (reverbModelUsed) {
+			processReverbModel(reverbDryLeft, reverbDryRight, streams.reverbWetLeft, streams.reverbWetRight, len);
 		} else {
+			if (synth.isReverbEnabled()) suspendReverbModel();
 			Synth::muteSampleBuffer(streams.reverbWetLeft, len);
 			Synth::muteSampleBuffer(streams.reverbWetRight, len);
 		}
+		timer.lap(&RenderProfile::reverbTime);
 
 		// Don't bother with conversion if the output is going to be unused
-		if (streams.nonReverbLeft != NULL) {
-			produceLA32Output(nonReverbLeft, len);
-			convertSamplesToOutput(nonReverbLeft, len);
-		}
-		if (streams.nonReverbRight != NULL) {
-			produceLA32Output(nonReverbRight, len);
-			convertSamplesToOutput(nonReverbRight, len);
-		}
+		if (streams.nonReverbLeft != NULL) produceConvertedLA32Output(nonReverbLeft, len);
+		if (streams.nonReverbRight != NULL) produceConvertedLA32Output(nonReverbRight, len);
 		if (streams.reverbDryLeft != NULL) convertSamplesToOutput(reverbDryLeft, len);
 		if (streams.reverbDryRight != NULL) convertSamplesToOutput(reverbDryRight, len);
+		timer.lap(&RenderProfile::partialsTime);
+	} else {
+		muteStreams(streams, len);
+	}
+
+	getPartialManager().clearAlreadyOutputed();
+	incRenderedSampleCount(len);
+}
+
+template <class Sample>
+void RendererImpl<Sample>::produceStreams(const PartOutputStreams<Sample> &streams, Bit32u len) {
+	RenderProfile * const renderProfile = getRenderProfile();
+	if (renderProfile != NULL) {
+		const Bit32u activePartialCount = getPartialManager().getActivePartialCount();
+		renderProfile->runCount++;
+		renderProfile->totalActivePartialCount += activePartialCount;
+		if (renderProfile->maxActivePartialCount < activePartialCount) {
+			renderProfile->maxActivePartialCount = activePartialCount;
+		}
+	}
+	RenderProfilingTimer timer(renderProfile);
+
+	if (isActivated()) {
+		Synth::muteSampleBuffer(tmpReverbDryLeft, len);
+		Synth::muteSampleBuffer(tmpReverbDryRight, len);
+		for (Bit32u partIx = 0; partIx < PART_OUTPUT_STREAM_COUNT; partIx++) {
+			Synth::muteSampleBuffer(streams.partLeft[partIx], len);
+			Synth::muteSampleBuffer(streams.partRight[partIx], len);
+		}
+
+		const bool reverbModelUsed = synth.isReverbEnabled() && (streams.reverbWetLeft != NULL || streams.reverbWetRight != NULL);
+
+		// Each partial is rendered on its own, so that its output can go to both the part streams and the reverb input.
+		const Bit32u renderedPartialCount = getPartialManager().getActivePartials(renderedPartials);
+		for (Bit32u renderedPartialIx = 0; renderedPartialIx < renderedPartialCount; renderedPartialIx++) {
+			const int i = renderedPartials[renderedPartialIx];
+			// The partial may be deactivated while producing the output, so the owner and the reverb flag are taken beforehand.
+			const int partIx = getPartialManager().getPartial(i)->getOwnerPart();
+			const bool reverb = reverbModelUsed && getPartialManager().shouldReverb(i);
+			const bool partStreamUsed = 0 <= partIx && Bit32u(partIx) < PART_OUTPUT_STREAM_COUNT
+				&& (streams.partLeft[partIx] != NULL || streams.partRight[partIx] != NULL);
+			if (!reverb && !partStreamUsed) {
+				// Nothing takes the output of the partial, so it is only advanced
+				Sample * const noBuffer = NULL;
+				getPartialManager().produceOutput(i, noBuffer, noBuffer, len);
+				continue;
+			}
+			Synth::muteSampleBuffer(tmpNonReverbLeft, len);
+			Synth::muteSampleBuffer(tmpNonReverbRight, len);
+			getPartialManager().produceOutput(i, tmpNonReverbLeft, tmpNonReverbRight, len);
+			if (reverb) {
+				mixPartialGroupOutput(tmpReverbDryLeft, tmpNonReverbLeft, len);
+				mixPartialGroupOutput(tmpReverbDryRight, tmpNonReverbRight, len);
+			}
+			if (partStreamUsed) {
+				if (streams.partLeft[partIx] != NULL) mixPartialGroupOutput(streams.partLeft[partIx], tmpNonReverbLeft, len);
+				if (streams.partRight[partIx] != NULL) mixPartialGroupOutput(streams.partRight[partIx], tmpNonReverbRight, len);
+			}
+		}
+
+		if (reverbModelUsed) {
+			produceLA32Output(tmpReverbDryLeft, len);
+			produceLA32Output(tmpReverbDryRight, len);
+		}
+		timer.lap(&RenderProfile::partialsTime);
+
+		if (reverbModelUsed) {
+			processReverbModel(tmpReverbDryLeft, tmpReverbDryRight, streams.reverbWetLeft, streams.reverbWetRight, len);
+		} else {
+			if (synth.isReverbEnabled()) suspendReverbModel();
+			Synth::muteSampleBuffer(streams.reverbWetLeft, len);
+			Synth::muteSampleBuffer(streams.reverbWetRight, len);
+		}
+		timer.lap(&RenderProfile::reverbTime);
+
+		for (Bit32u partIx = 0; partIx < PART_OUTPUT_STREAM_COUNT; partIx++) {
+			if (streams.partLeft[partIx] != NULL) produceConvertedLA32Output(streams.partLeft[partIx], len);
+			if (streams.partRight[partIx] != NULL) produceConvertedLA32Output(streams.partRight[partIx], len);
+		}
+		timer.lap(&RenderProfile::partialsTime);
 	} else {
 		muteStreams(streams, len);
 	}
@@ -2372,29 +4696,28 @@ void Synth::printPartialUsage(Bit32u sampleOffset) {
 	}
 }
 
+bool Synth::skipSilence(Bit32u len) {
+	return opened && renderer->skipSilence(len);
+}
+
 bool Synth::hasActivePartials() const {
 	if (!opened) {
 		return false;
 	}
-	for (unsigned int partialNum = 0; partialNum < getPartialCount(); partialNum++) {
-		if (partialManager->getPartial(partialNum)->isActive()) {
-			return true;
-		}
-	}
-	return false;
+	return partialManager->getActivePartialCount() > 0;
 }
 
 bool Synth::isActive() {
 	if (!opened) {
 		return false;
 	}
-	if (!midiQueue->isEmpty() || hasActivePartials()) {
+	if (getNextMIDIEventQueue().peekMidiEvent() != NULL || hasActivePartials()) {
 		return true;
 	}
 	if (isReverbEnabled() && reverbModel->isActive()) {
 		return true;
 	}
-	activated = false;
+	if (extensions.reverbEngine == NULL) activated = false;
 	return false;
 }
 
@@ -31,14 +31,19 @@ namespace MT32Emu {
 class Analog;
 class BReverbModel;
 class Extensions;
+class Kernels;
+struct SampleFormatConversion;
 class MemoryRegion;
 class MidiEventQueue;
+class OutputStreamCursor;
 class Part;
 class Poly;
 class Partial;
 class PartialManager;
 class Renderer;
+class RhythmHitCache;
 class ROMImage;
+class SharedMemorySegment;
 
 class PatchTempMemoryRegion;
 class RhythmTempMemoryRegion;
@@ -71,6 +76,9 @@ const Bit8u SYSEX_CMD_RJC = 0x4F; // Rejection
 
 const Bit32u CONTROL_ROM_SIZE = 64 * 1024;
 
+// The highest degradation level of the overload governor, see Synth::setOverloadGovernorEnabled().
+const Bit32u OVERLOAD_GOVERNOR_MAX_LEVEL = 5;
+
 // Set of multiplexed output streams appeared at the DAC entrance.
 template <class T>
 struct DACOutputStreams {
@@ -82,6 +90,143 @@ struct DACOutputStreams {
 	T *reverbWetRight;
 };
 
+const Bit32u PART_OUTPUT_STREAM_COUNT = 9;
+
+// Set of output streams with the dry signal split by the owner part, parts 1-8 followed by the rhythm part.
+// The reverb is shared by all the parts, so its wet output is only available as a whole.
+template <class T>
+struct PartOutputStreams {
+	T *partLeft[PART_OUTPUT_STREAM_COUNT];
+	T *partRight[PART_OUTPUT_STREAM_COUNT];
+	T *reverbWetLeft;
+	T *reverbWetRight;
+};
+
+// Describes a MIDI event enqueued along with others in a batch, see Synth::playEvents().
+struct MIDIEvent {
+	// Points to the data of a well formed System Exclusive MIDI message, or NULL for a short message.
+	const Bit8u *sysex;
+	// Length of the System Exclusive MIDI message, ignored for a short message.
+	Bit32u sysexLength;
+	// Short MIDI message that must contain a status byte, ignored for a System Exclusive MIDI message.
+	Bit32u msg;
+	// Time to play the event at, the same as for playMsg() and playSysex().
+	Bit32u timestamp;
+};
+
+// Statistics collected by the renderer while render profiling is enabled, see Synth::setRenderProfilingEnabled().
+// Times are accumulated in nanoseconds. Each stage is accounted separately, the total time also includes
+// the overhead of the renderer itself. Counters wrap around on overflow, so they should be reset periodically.
+struct RenderProfile {
+	// Total time spent in render calls
+	double totalTime;
+	// Time spent dispatching MIDI events
+	double midiEventsTime;
+	// Time spent in the LA32 emulation producing the output of active partials
+	double partialsTime;
+	// Time spent in the reverb model
+	double reverbTime;
+	// Time spent in the analog circuitry emulation
+	double analogTime;
+	// Number of render calls
+	Bit32u renderCallCount;
+	// Number of rendering runs, each run processes a limited number of samples without MIDI events in between
+	Bit32u runCount;
+	// Number of MIDI events dispatched
+	Bit32u dispatchedEventCount;
+	// Sum of the numbers of active partials over all the runs, divided by runCount gives the average
+	Bit32u totalActivePartialCount;
+	// Maximum number of partials active in a run
+	Bit32u maxActivePartialCount;
+};
+
+// Statistics of the MIDI event queue of an input, see Synth::getMIDIEventQueueStats().
+// The counters are accumulated since the queue was created or the statistics were reset.
+struct MIDIEventQueueStats {
+	// Current capacity of the queue in events, which increases as a growable queue grows
+	Bit32u queueSize;
+	// Number of events currently pending in the queue
+	Bit32u pendingEventCount;
+	// Maximum number of events pending in the queue at once
+	Bit32u maxPendingEventCount;
+	// Number of times an event didn't fit in the queue, due to either the queue or the SysEx storage being full
+	Bit32u overflowCount;
+	// Number of times the queue grew
+	Bit32u growCount;
+	// Size of the preallocated SysEx storage buffer in bytes, 0 when the SysEx data is allocated dynamically
+	Bit32u sysexStorageSize;
+	// Number of bytes of the SysEx data currently stored in the queue
+	Bit32u sysexStorageUsage;
+	// Maximum number of bytes of the SysEx data stored in the queue at once
+	Bit32u maxSysexStorageUsage;
+};
+
+// Breakdown of the memory occupied by a synth instance in bytes, see Synth::getMemoryUsage().
+struct SynthMemoryUsage {
+	// The synth object with the emulated memory and the sound group names, excluding the control ROM copy
+	size_t stateSize;
+	// Copy of the control ROM data kept by the synth
+	size_t controlROMSize;
+	// The PCM wave table along with the padded copies of the waves and their linear copies for the float renderers,
+	// unless the copies are shared
+	size_t pcmWavesSize;
+	// Decoded PCM ROM samples. They belong to the ROMImage and are shared among all the synths opened with it,
+	// hence they aren't included in totalSize
+	size_t sharedPCMROMSize;
+	// The default memory contents and the padded copies of the PCM waves shared among the synths opened
+	// in the reduced memory footprint mode with the same ROM images, or the copies shared with other processes
+	// via the cache in shared memory, also excluded from totalSize
+	size_t sharedROMDataSize;
+	// The band-limited wavetables shared among all the synths that use RendererType_FLOAT_WAVETABLE, excluded from totalSize
+	size_t sharedWavetablesSize;
+	// Reverb models of all the modes, with the delay lines of those which are open
+	size_t reverbSize;
+	// Ring buffers and SysEx storage of the MIDI event queues of all the inputs
+	size_t midiEventQueuesSize;
+	// Parts, polys and partials with the envelope and wave generators
+	size_t partialsSize;
+	// Renderer buffers and the analogue circuit emulation
+	size_t rendererSize;
+	// Sum of all the above except for sharedPCMROMSize, sharedROMDataSize and sharedWavetablesSize
+	size_t totalSize;
+};
+
+// A consistent pair of the sample clock of the synth and the wall clock, see Synth::getSampleClock().
+struct SampleClock {
+	// The global count of samples rendered since the synth was created (at the native sample rate 32000 Hz).
+	// Unlike the 32-bit counter, which wraps in about 37 hours, it is exact for thousands of years as a double.
+	double renderedSampleCount;
+	// Reading of the monotonic clock in nanoseconds upon completion of the rendering call that brought the count
+	// to renderedSampleCount, i.e. CLOCK_MONOTONIC on POSIX systems and the performance counter on Windows, 0 before that.
+	double clockNanos;
+};
+
+// Statistics of the partial allocation, see Synth::getPolyphonyStats(). Counters are accumulated since the synth
+// was opened or the statistics were reset, and wrap around on overflow.
+struct PolyphonyStats {
+	// Number of notes that either started playing or were dropped, excluding completely muted timbres
+	Bit32u noteOnCount;
+	// Number of notes dropped due to a lack of free partials or polys
+	Bit32u droppedNoteCount;
+	// Number of partials allocated to play notes
+	Bit32u partialAllocationCount;
+	// Number of polys aborted to free partials for new notes, by reason: releasing polys of parts that exceeded
+	// their partial reserve, other polys of parts that exceeded their partial reserve, and polys of the part
+	// that plays the new note itself
+	Bit32u releasingPolyStealCount;
+	Bit32u reserveExceededPolyStealCount;
+	Bit32u samePartPolyStealCount;
+	// Number of polys aborted in the single-assign mode because the same key was played again
+	Bit32u singleAssignPolyAbortCount;
+	// Total number of polys aborted
+	Bit32u abortedPolyCount;
+	// Number of samples rendered while a note waited for an aborted poly to cease, at the internal sample rate
+	Bit32u abortWaitSampleCount;
+	// Maximum number of partials active at once in total and in each part, 0..7 for Part 1..8 and 8 for Rhythm
+	Bit32u peakPartialCount;
+	Bit32u peakPartPartialCount[9];
+};
+
 // Class for the client to supply callbacks for reporting various errors and information
 class MT32EMU_EXPORT ReportHandler {
 public:
@@ -113,9 +258,94 @@ public:
 	virtual void onProgramChanged(Bit8u /* partNum */, const char * /* soundGroupName */, const char * /* patchName */) {}
 };
 
+// Class for the client to supply a means of running rendering tasks concurrently, e.g. using a pool of worker threads.
+// The library itself never creates threads.
+class MT32EMU_EXPORT RenderingTaskExecutor {
+public:
+	class Task {
+	public:
+		virtual ~Task() {}
+
+		// Performs a part of work identified by taskIx. Tasks with different indices may run concurrently.
+		virtual void run(Bit32u taskIx) = 0;
+	};
+
+	virtual ~RenderingTaskExecutor() {}
+
+	// Invokes task.run() once for each task index in range [0, taskCount) and returns when all are complete.
+	// The synth expects no particular order of invocations.
+	virtual void execute(Task &task, Bit32u taskCount) = 0;
+
+	// Same as execute(), but also conveys the NUMA node the memory of each task is placed on, see Synth::setNUMANode(),
+	// or -1 if not placed. This is only invoked when at least one of the tasks is placed. An executor with the workers
+	// spread across several nodes should run each task on a worker of its node. The default implementation ignores
+	// the nodes.
+	virtual void executeOnNodes(Task &task, Bit32u taskCount, const Bit32s *taskNodes) {
+		(void)taskNodes;
+		execute(task, taskCount);
+	}
+};
+
+// Class for the client to receive the spans of work the synth performs, e.g. to record a trace that shows them in context
+// of the activity of the other threads of the application. Span kinds may be added in the future, so the client should
+// ignore the unknown ones.
+class MT32EMU_EXPORT TraceSink {
+public:
+	enum SpanKind {
+		// A render call, the argument is the number of frames rendered
+		SpanKind_RENDER,
+		// Dispatch of a short MIDI message, the argument is the message
+		SpanKind_SHORT_MESSAGE,
+		// Dispatch of a SysEx message, the argument is the length of the message
+		SpanKind_SYSEX,
+		// Allocation of the partials to play a note, the argument is the number of partials needed
+		SpanKind_PARTIAL_ALLOCATION,
+		// Abortion of the playing polys to free the partials for a new note, nested in the allocation span,
+		// the argument is the number of partials that lacked
+		SpanKind_PARTIAL_STEAL,
+		// Processing of a run of samples by the reverb model, the argument is the number of frames processed
+		SpanKind_REVERB
+	};
+
+	virtual ~TraceSink() {}
+
+	// Invoked on the thread that performed the span of work right upon completion, so the client may timestamp the span
+	// with its own clock. The duration is measured with a monotonic clock. Spans nested in a span complete before it.
+	// This is invoked while rendering, so it should take as little time as possible.
+	virtual void onSpanCompleted(SpanKind kind, double durationNanos, Bit32u arg) = 0;
+};
+
+// Class for the client to supply the reverb processing instead of the built-in reverb model, e.g. a vectorised one
+// or one shared reverb bus that processes the summed reverb input of several synths. The engine receives the reverb
+// settings as they are set by SysEx messages or a reset, and stays in use with each reverb mode. The synth only invokes
+// the engine from the thread that renders or plays MIDI messages and never concurrently.
+class MT32EMU_EXPORT ReverbEngine {
+public:
+	virtual ~ReverbEngine() {}
+
+	// Invoked each time the reverb parameters are set, the mode is in range [0..3] (Room, Hall, Plate, Tap delay)
+	// and the time and level are in range [0..7]. So, the engine should only reconfigure itself when the mode changes.
+	// The flag tells whether the reverb of the MT-32 or the one of the later units is to be emulated,
+	// see Synth::setReverbCompatibilityMode().
+	virtual void setMode(Bit8u mode, bool mt32CompatibleModel) = 0;
+	// Invoked right after setMode() with the reverb time and level of the mode.
+	virtual void setParameters(Bit8u time, Bit8u level) = 0;
+	// Clears the internal state, so that the tail of the input processed so far is dropped.
+	virtual void mute() = 0;
+	// Returns whether the engine still outputs the tail of the input processed so far, so that processing silence wouldn't
+	// yield silence. The synth relies on it to find out when it may stop rendering. Since the engine may also receive
+	// the input from elsewhere, the synth keeps querying it while no partials play, and never deactivates itself.
+	virtual bool isActive() const = 0;
+	// Replaces the reverb input in the buffers with the wet output. The samples are normalised floats regardless
+	// of the renderer type, at the internal sample rate. numSamples never exceeds MAX_SAMPLES_PER_RUN.
+	virtual void process(float *left, float *right, Bit32u numSamples) = 0;
+};
+
 class Synth {
 friend class DefaultMidiStreamParser;
+friend class InternalResampler;
 friend class MemoryRegion;
+friend class OverloadGovernorTimer;
 friend class Part;
 friend class Partial;
 friend class PartialManager;
@@ -124,6 +354,7 @@ friend class Renderer;
 friend class RhythmPart;
 friend class SamplerateAdapter;
 friend class SoxrAdapter;
+friend class SynthGroup;
 friend class TVA;
 friend class TVF;
 friend class TVP;
@@ -147,7 +378,10 @@ private:
 	const ControlROMFeatureSet *controlROMFeatures;
 	const ControlROMMap *controlROMMap;
 	Bit8u controlROMData[CONTROL_ROM_SIZE];
-	Bit16s *pcmROMData;
+	const Bit16s *pcmROMData;
+	Bit16s *pcmWaveSlabs; // Array, with the slabs starting at the first cache line boundary within
+	float *linearPCMWaveSlabs; // Array laid out likewise, NULL unless built for a float renderer and not shared
+	SharedMemorySegment *pcmWavesSegment; // Holds the slabs of both kinds when shared with other processes, NULL otherwise
 	size_t pcmROMSize; // This is in 16-bit samples, therefore half the number of bytes in the ROM
 
 	Bit8u soundGroupIx[128]; // For each standard timbre
@@ -160,7 +394,9 @@ private:
 	volatile Bit32u lastReceivedMIDIEventTimestamp;
 	volatile Bit32u renderedSampleCount;
 
-	MemParams &mt32ram, &mt32default;
+	MemParams &mt32ram;
+	// Restored upon reset, either owned or shared with the other synths in the reduced memory footprint mode.
+	const MemParams *mt32default;
 
 	BReverbModel *reverbModels[4];
 	BReverbModel *reverbModel;
@@ -196,8 +432,29 @@ private:
 
 	// **************************** Implementation methods **************************
 
-	Bit32u addMIDIInterfaceDelay(Bit32u len, Bit32u timestamp);
+	Bit32u addMIDIInterfaceDelay(Bit32u len, Bit32u timestamp, volatile Bit32u &lastReceivedTimestamp);
+	void createExtraMIDIInputs();
+	void deleteExtraMIDIInputs();
+	MidiEventQueue *getMIDIInputQueue(Bit32u inputNum, volatile Bit32u *&lastReceivedTimestamp);
+	MidiEventQueue *getMIDIInputQueue(Bit32u inputNum) const;
+	MidiEventQueue &getNextMIDIEventQueue();
+	bool handleMIDIQueueOverflow(MidiEventQueue &queue);
 	bool isAbortingPoly() const { return abortingPoly != NULL; }
+	const Kernels &getKernels() const;
+	Bit32u getPartialCullingAmp() const;
+	// Returns NULL unless the rhythm hit cache is enabled.
+	RhythmHitCache *getRhythmHitCache() const;
+	// Only called from the rendering thread while the overload governor is enabled.
+	void updateOverloadGovernor(double renderTime, Bit32u len);
+	void resetOverloadGovernor();
+	void applyOverloadGovernorLevel();
+	// Only called from the rendering thread upon completion of each rendering call.
+	void publishSampleClock();
+	SampleFormatConversion getSampleFormatConversion() const;
+	// Converts the float samples rendered or resampled for the output to integers, with dither if enabled.
+	void convertOutputSamples(const float *inBuffer, Bit16s *outBuffer, Bit32u len) const;
+	bool isQueuedMIDIEventDue();
+	Bit32u renderPlayingEvents(OutputStreamCursor &cursor, Bit32u len, const MIDIEvent *events, Bit32u count);
 
 	void writeSysexGlobal(Bit32u addr, const Bit8u *sysex, Bit32u len);
 	void readSysex(Bit8u channel, const Bit8u *sysex, Bit32u len) const;
@@ -210,19 +467,33 @@ private:
 	bool loadControlROM(const ROMImage &controlROMImage);
 	bool loadPCMROM(const ROMImage &pcmROMImage);
 
-	bool initPCMList(Bit16u mapAddress, Bit16u count);
+	bool initPCMList(Bit16u mapAddress, Bit16u count, const char *segmentKey);
+	void initLinearPCMWaves(Bit16u count);
+	size_t getPCMWaveSlabsSize() const;
+	static size_t getLinearPCMWaveSlabsOffset(size_t slabsSize);
+	const Bit16s *getPCMWaveSlabs() const;
+	const float *getLinearPCMWaveSlabs() const;
 	bool initTimbres(Bit16u mapAddress, Bit16u offset, Bit16u timbreCount, Bit16u startTimbre, bool compressed);
 	bool initCompressedTimbre(Bit16u drumNum, const Bit8u *mem, Bit32u memLen);
 	void initReverbModels(bool mt32CompatibleMode);
+	BReverbModel *createReverbModel(Bit8u mode, bool mt32CompatibleMode) const;
+	BReverbModel *selectReverbModel(Bit8u mode);
+	bool isReverbPreparationDeferredActive() const;
+	void swapInPreparedReverbModel();
+	bool isReverbMemoryPreallocated() const;
+	void lockWorkingSet();
 	void initSoundGroups(char newSoundGroupNames[][9]);
 
 	void refreshSystemMasterTune();
 	void refreshSystemReverbParameters();
 	void refreshSystemReserveSettings();
-	void refreshSystemChanAssign(Bit8u firstPart, Bit8u lastPart);
+	void refreshSystemChanAssign(Bit16u touchedParts);
 	void refreshSystemMasterVol();
 	void refreshSystem();
+	void applyPendingSystemRefreshes();
 	void reset();
+	void resetEmulatedState();
+	void restoreDefaultMemory();
 	void dispose();
 
 	void printPartialUsage(Bit32u sampleOffset = 0);
@@ -236,6 +507,17 @@ private:
 	void resetMasterTunePitchDelta();
 	Bit32s getMasterTunePitchDelta() const;
 
+	bool isPartialRenderingParallel() const;
+	RenderProfile *getEnabledRenderProfile() const;
+	PolyphonyStats &getCollectedPolyphonyStats();
+
+	// Used by InternalResampler to apply the accurate analogue low-pass filter fused with the sample rate conversion.
+	// When the accurate LPF is in effect, bypasses it, so that the analogue circuit emulation only mixes the output streams
+	// at the internal sample rate, and returns the LPF taps the caller becomes responsible to apply. Returns NULL otherwise.
+	const float *bypassAccurateAnalogLowPassFilter(Bit32u &tapCount, Bit32u &upsampleFactor);
+	// Restores the analogue circuit emulation in the mode specified when opening.
+	void restoreAnalogLowPassFilter();
+
 public:
 	static inline Bit16s clipSampleEx(Bit32s sampleEx) {
 		// Clamp values above 32767 to 32767, and values below -32768 to -32768
@@ -303,6 +585,14 @@ public:
 	// Closes the MT-32 and deallocates any memory used by the synthesizer
 	MT32EMU_EXPORT void close();
 
+	// Brings the opened synth to the state it has right after opening, as a faster alternative to closing it and opening again
+	// with the same ROM images. Nothing is reallocated: the decoded ROM data, the emulated memory, the partials, the parts
+	// and the reverb models are merely reset, and the analogue circuit emulation only replaces its low-pass filter.
+	// The pending MIDI events are discarded. The partial count, the renderer type, the number of MIDI inputs and the other
+	// settings that take effect upon opening remain as they were when the synth was opened. Note, the output sample rate
+	// depends on the analogue output mode. Returns false if the synth is not open.
+	MT32EMU_EXPORT_V(2.5) bool reinitialise(AnalogOutputMode analogOutputMode = AnalogOutputMode_COARSE);
+
 	// Returns true if the synth is in completely initialized state, otherwise returns false.
 	MT32EMU_EXPORT bool isOpen() const;
 
@@ -325,9 +615,37 @@ public:
 	// Note, the queue is flushed and recreated in the process so that its size remains intact.
 	MT32EMU_EXPORT void configureMIDIEventQueueSysexStorage(Bit32u storageBufferSize);
 
+	// Allows the MIDI event queues to grow up to the specified size, rounded up to a power of 2, instead of
+	// overflowing when full. A full queue is then replaced with one twice as big on the thread that enqueues
+	// the events, the rendering thread never allocates nor releases the memory. The queues never shrink back,
+	// unless recreated. The events that don't fit in the grown queue still overflow as usual. A size that
+	// doesn't exceed the queue size disables growing, which is the default.
+	// Must not be invoked concurrently with enqueueing MIDI events. Returns the actual maximum size being used.
+	MT32EMU_EXPORT_V(2.5) Bit32u setMIDIEventQueueMaxSize(Bit32u requestedMaxSize);
+	// Returns the maximum size the MIDI event queues may grow up to, which is not greater than the queue size
+	// when growing is disabled.
+	MT32EMU_EXPORT_V(2.5) Bit32u getMIDIEventQueueMaxSize() const;
+	// Fills in the statistics of the MIDI event queue of the specified input, which help sizing the queue and
+	// the SysEx storage. Must be invoked on the thread that enqueues the events to the input, yet may run
+	// concurrently with rendering. Returns false if inputNum is invalid or the synth isn't open.
+	MT32EMU_EXPORT_V(2.5) bool getMIDIEventQueueStats(Bit32u inputNum, MIDIEventQueueStats &stats) const;
+	// Resets the accumulated statistics of the MIDI event queue of the specified input, with the same restrictions.
+	MT32EMU_EXPORT_V(2.5) bool resetMIDIEventQueueStats(Bit32u inputNum);
+
+	// Fills in the breakdown of the memory occupied by the synth, which allows to estimate the footprint of an instance
+	// with the current configuration. The resources allocated on demand, such as the MIDI event queues that grow or the
+	// buffers for concurrent rendering of partials, are accounted as they are at the moment. The sample rate converter,
+	// if any, reports its memory separately, see SampleRateConverter::getMemoryUsage(). Must not be invoked concurrently
+	// with rendering or enqueueing MIDI events. Returns false and zeroes all the fields if the synth isn't open.
+	MT32EMU_EXPORT_V(2.5) bool getMemoryUsage(SynthMemoryUsage &usage) const;
+
 	// Returns current value of the global counter of samples rendered since the synth was created (at the native sample rate 32000 Hz).
 	// This method helps to compute accurate timestamp of a MIDI message to use with the methods below.
 	MT32EMU_EXPORT Bit32u getInternalRenderedSampleCount() const;
+	// Retrieves the sample clock published by the rendering thread upon completion of each rendering call, along with
+	// the wall clock reading taken at that moment, which allows to extrapolate the current sample time. Unlike the method
+	// above, this never blocks nor tears while rendering proceeds, and can be invoked from any thread at any time.
+	MT32EMU_EXPORT_V(2.5) void getSampleClock(SampleClock &sampleClock) const;
 
 	// Enqueues a MIDI event for subsequent playback.
 	// The MIDI event will be processed not before the specified timestamp.
@@ -335,6 +653,7 @@ public:
 	// The minimum delay involves emulation of the delay introduced while the event is transferred via MIDI interface
 	// and emulation of the MCU busy-loop while it frees partials for use by a new Poly.
 	// Calls from multiple threads must be synchronised, although, no synchronisation is required with the rendering thread.
+	// Alternatively, each thread may use a separate MIDI input, see setMIDIInputCount() below.
 	// The methods return false if the MIDI event queue is full and the message cannot be enqueued.
 
 	// Enqueues a single short MIDI message to play at specified time. The message must contain a status byte.
@@ -342,11 +661,53 @@ public:
 	// Enqueues a single well formed System Exclusive MIDI message to play at specified time.
 	MT32EMU_EXPORT bool playSysex(const Bit8u *sysex, Bit32u len, Bit32u timestamp);
 
+	// Same as the methods above but the timestamp is measured on the 64-bit sample clock, see getSampleClock().
+	// The timestamp must be within 2^31 samples (about 18 hours) of the current sample time.
+	MT32EMU_EXPORT_V(2.5) bool playMsgAtSampleClock(Bit32u msg, double timestamp);
+	MT32EMU_EXPORT_V(2.5) bool playSysexAtSampleClock(const Bit8u *sysex, Bit32u len, double timestamp);
+
 	// Enqueues a single short MIDI message to be processed ASAP. The message must contain a status byte.
 	MT32EMU_EXPORT bool playMsg(Bit32u msg);
 	// Enqueues a single well formed System Exclusive MIDI message to be processed ASAP.
 	MT32EMU_EXPORT bool playSysex(const Bit8u *sysex, Bit32u len);
 
+	// Sets the number of MIDI inputs, each of which is backed by a separate MIDI event queue.
+	// Different inputs can be fed concurrently from different threads without synchronisation, while calls for
+	// the same input still must be synchronised. The methods above enqueue MIDI events to input 0. Events received
+	// via all the inputs are processed in the order of their timestamps, with lower input numbers winning ties.
+	// The delays introduced by the MIDI interface are emulated for each input separately.
+	// The queues are flushed before reallocation. Must not be invoked concurrently with rendering or enqueueing.
+	// By default, there is a single MIDI input.
+	MT32EMU_EXPORT_V(2.5) void setMIDIInputCount(Bit32u inputCount);
+	// Returns the number of MIDI inputs currently configured.
+	MT32EMU_EXPORT_V(2.5) Bit32u getMIDIInputCount() const;
+
+	// Same as the methods above but enqueue MIDI events to the specified MIDI input.
+	// The methods return false if inputNum is invalid.
+	MT32EMU_EXPORT_V(2.5) bool playMsgOnInput(Bit32u inputNum, Bit32u msg, Bit32u timestamp);
+	MT32EMU_EXPORT_V(2.5) bool playSysexOnInput(Bit32u inputNum, const Bit8u *sysex, Bit32u len, Bit32u timestamp);
+	MT32EMU_EXPORT_V(2.5) bool playMsgOnInput(Bit32u inputNum, Bit32u msg);
+	MT32EMU_EXPORT_V(2.5) bool playSysexOnInput(Bit32u inputNum, const Bit8u *sysex, Bit32u len);
+
+	// Enqueues a batch of MIDI events sorted by the timestamps at once, which is cheaper than enqueueing them one by one.
+	// The events are stored in the free space of the MIDI event queue, which is checked only once for the whole batch.
+	// When the queue gets full and can't grow, the ReportHandler is consulted like for a single event and, unless it allows
+	// retrying, the remaining events are left out. Returns the number of events enqueued, which is 0 if inputNum is invalid.
+	MT32EMU_EXPORT_V(2.5) Bit32u playEvents(const MIDIEvent *events, Bit32u count);
+	MT32EMU_EXPORT_V(2.5) Bit32u playEventsOnInput(Bit32u inputNum, const MIDIEvent *events, Bit32u count);
+
+	// Reserves space for a System Exclusive MIDI message of up to maxLen bytes in the storage of the MIDI event queue
+	// of the specified input. The returned pointer allows writing the message in place, e.g. while reassembling it
+	// from fragments, so that the data isn't copied once again as playSysexOnInput() does. Returns NULL if inputNum
+	// is invalid, another reservation is pending on the input or the queue is full.
+	// Until the reservation is completed with playReservedSysexOnInput(), no other events may be enqueued to the input.
+	MT32EMU_EXPORT_V(2.5) Bit8u *reserveSysexOnInput(Bit32u inputNum, Bit32u maxLen);
+	// Enqueues the well formed System Exclusive MIDI message written to the space reserved for the specified input.
+	// The length must not exceed the one reserved, the excess space is released. A zero length cancels the reservation.
+	// Returns false if there is no reservation on the input or the length is too big, the reservation remains pending then.
+	MT32EMU_EXPORT_V(2.5) bool playReservedSysexOnInput(Bit32u inputNum, Bit32u len, Bit32u timestamp);
+	MT32EMU_EXPORT_V(2.5) bool playReservedSysexOnInput(Bit32u inputNum, Bit32u len);
+
 	// WARNING:
 	// The methods below don't ensure minimum 1-sample delay between sequential MIDI events,
 	// and a sequence of NoteOn and immediately succeeding NoteOff messages is always silent.
@@ -394,7 +755,106 @@ public:
 	// If enabled, reverb buffers for all modes are keept around allocated all the time to avoid memory
 	// allocating/freeing in the rendering thread, which may be required for realtime operation.
 	// Otherwise, reverb buffers that are not in use are deleted to save memory (the default behaviour).
+	// The reverb memory is never preallocated while the synth is opened in the reduced memory footprint mode.
 	MT32EMU_EXPORT void preallocateReverbMemory(bool enabled);
+	// Enables or disables deferring the preparation of the reverb models while the reverb memory is preallocated.
+	// Instead of allocating the buffers of all the reverb modes in advance, the model of a reverb mode is then only prepared
+	// once the mode is first selected. The model selected while opening the synth is prepared in place, while the models
+	// selected afterwards are prepared by prepareReverbModels(), and the reverb output remains silent meanwhile. Once prepared,
+	// the models are kept allocated, so that the rendering thread never allocates memory for the reverb. Ignored while
+	// the memory locking is in effect. Disabled by default.
+	MT32EMU_EXPORT_V(2.5) void setReverbPreparationDeferred(bool enabled);
+	// Returns whether the preparation of the reverb models is deferred. See setReverbPreparationDeferred() for details.
+	MT32EMU_EXPORT_V(2.5) bool isReverbPreparationDeferred() const;
+	// Prepares the reverb model requested upon a reverb mode change while the preparation is deferred, if any, which is
+	// swapped in at the next rendering block boundary. Intended to be invoked periodically from a thread other than
+	// the rendering thread, e.g. after each rendering pass. It may run concurrently with rendering and MIDI processing,
+	// but not with itself, opening or closing the synth, preallocateReverbMemory() and setReverbEngine().
+	// Returns true if a model has been prepared.
+	MT32EMU_EXPORT_V(2.5) bool prepareReverbModels();
+	// Enables or disables the reduced memory footprint mode, the setting takes effect upon the next opening of the synth.
+	// In this mode, the default contents of the emulated memory and the padded copies of the PCM waves are shared among
+	// all the synths in the process opened with the same pair of ROMImage objects, and only the memory of the reverb mode
+	// in use is allocated regardless of preallocateReverbMemory(). This is intended for memory constrained environments
+	// and for hosts running many synths at once, at the cost of memory allocations when the reverb mode changes.
+	// Disabled by default.
+	MT32EMU_EXPORT_V(2.5) void setReducedMemoryFootprintEnabled(bool enabled);
+	// Returns whether the reduced memory footprint mode is enabled. See setReducedMemoryFootprintEnabled() for details.
+	MT32EMU_EXPORT_V(2.5) bool isReducedMemoryFootprintEnabled() const;
+	// Enables or disables locking of the synth working set in physical memory, the setting takes effect upon the next opening
+	// of the synth. Upon opening, the memory of the emulated state, the decoded PCM ROM, the partials, the reverb delay lines,
+	// the analogue circuit emulation and the MIDI event queue is locked and faulted in, so that the rendering never stalls
+	// on a page fault, e.g. after a long idle period. The large blocks are backed by transparent huge pages where available.
+	// The buffers of all the reverb modes are kept allocated, unless opened in the reduced memory footprint mode.
+	// Locking is subject to the system limits, the memory that couldn't be locked remains pageable, which is reported
+	// via ReportHandler::printDebug(). Disabled by default.
+	MT32EMU_EXPORT_V(2.5) void setMemoryLockingEnabled(bool enabled);
+	// Returns whether locking of the synth working set is enabled. See setMemoryLockingEnabled() for details.
+	MT32EMU_EXPORT_V(2.5) bool isMemoryLockingEnabled() const;
+	// Sets the NUMA node the synth working set is placed on, the setting takes effect upon the next opening of the synth.
+	// Upon opening, the same memory as with setMemoryLockingEnabled() is bound to the node, and the pages allocated
+	// elsewhere are migrated, regardless of whether locking is enabled. This is intended for the hosts that render many
+	// synths on multi-socket machines, which should also run the rendering on the CPUs of the node. The node is conveyed
+	// to the partial rendering executor via RenderingTaskExecutor::executeOnNodes(). The decoded PCM ROM and the other
+	// data shared by the synths opened with the same ROMImage are left where they were first touched, as are the LA32
+	// wavetables, which all the synths in the process share. A host may load the ROM images once per node to keep a copy
+	// on each.
+	// The buffers of all the reverb modes are kept allocated, unless opened in the reduced memory footprint mode.
+	// Only supported on Linux, and ignored elsewhere. A negative value, which is the default, disables the placement.
+	MT32EMU_EXPORT_V(2.5) void setNUMANode(Bit32s node);
+	// Returns the NUMA node the synth working set is placed on, or -1 if disabled. See setNUMANode() for details.
+	MT32EMU_EXPORT_V(2.5) Bit32s getNUMANode() const;
+	// Enables or disables TPDF dither of 1 LSB peak amplitude applied when the float samples are converted to 16-bit integers
+	// on the output, i.e. when a synth with RendererType_FLOAT renders to Bit16s streams, and in the SampleRateConverter
+	// using the internal resampler. The conversion is then rounded rather than truncated, which removes the harmonic
+	// distortion of the quantisation at low levels at the cost of a constant noise floor. The dither noise is deterministic,
+	// so the output remains reproducible. Does not affect the synth rendering with RendererType_BIT16S. Disabled by default.
+	MT32EMU_EXPORT_V(2.5) void setOutputDitherEnabled(bool enabled);
+	// Returns whether the output dither is enabled. See setOutputDitherEnabled() for details.
+	MT32EMU_EXPORT_V(2.5) bool isOutputDitherEnabled() const;
+	// Sets the threshold of the opt-in culling of inaudible partials as the attenuation in dB applied by TVA.
+	// While a partial (along with its ring modulating slave, if any) is attenuated at least that much, the wave generation
+	// is skipped, yet the envelopes and the wave positions keep advancing as usual, so that the partials resume, end and
+	// get stolen exactly as they do otherwise. This saves much of the rendering time spent on long release tails, at
+	// the cost of dropping the quiet part of the sound. With RendererType_BIT16S, the output of partials attenuated by
+	// 84.3 dB or more is already silent, so such thresholds keep the output bit-exact.
+	// Zero or negative values disable the culling. Disabled by default.
+	MT32EMU_EXPORT_V(2.5) void setPartialCullingThreshold(float attenuation);
+	// Returns the threshold of culling of inaudible partials in dB, zero when disabled.
+	MT32EMU_EXPORT_V(2.5) float getPartialCullingThreshold() const;
+	// Enables or disables the opt-in cache of the rhythm part hits. Upon the first hit of a drum with a velocity, the output
+	// of each partial pair is recorded before panning, and the later hits with the same velocity replay the recording
+	// instead of generating the waves again. The recording is accompanied by the amp and cutoff values the waves were
+	// generated with, and a hit only replays it while its envelopes evaluated as usual produce the same values, so it goes
+	// back to generating the waves as soon as it is released, aborted or turned down differently. Neither modulation,
+	// pitch bend nor a change of the master tune may be applied to the rhythm part either. The replayed hits reproduce
+	// the timing of the pitch envelope of the recorded hit, which TVP otherwise varies randomly as the real units do,
+	// so the output is not bit-exact unless the drums have no pitch envelope or LFO. The recordings are dropped whenever
+	// the rhythm setup or the timbres they were made with are written. Up to 64 recordings of the first 32768 samples
+	// of the hits are kept, taking 20 MiB of memory, or 24 MiB with the float renderers. The memory is allocated upon
+	// enabling or opening the synth with the cache enabled, and kept until the synth closes. Disabled by default.
+	MT32EMU_EXPORT_V(2.5) void setRhythmHitCacheEnabled(bool enabled);
+	// Returns whether the rhythm hit cache is enabled. See setRhythmHitCacheEnabled() for details.
+	MT32EMU_EXPORT_V(2.5) bool isRhythmHitCacheEnabled() const;
+	// Enables the governor that trades the quality for the rendering speed while the host is overloaded, so that the output
+	// degrades gradually instead of dropping out. The governor measures the time the render calls take against the duration
+	// of the audio they produce. Whenever it exceeds the render budget, the degradation level steps up by one. The first two
+	// levels enable culling of quiet partials at 60 dB and 42 dB, unless setPartialCullingThreshold() sets a lower threshold,
+	// the further ones cut the number of partials available to new notes to 3/4, 1/2 and 1/4 of the partial count. The notes
+	// already playing are not cut short, rather the releasing polys are stolen as they are when the partials run out.
+	// Once the load stays below 60% of the budget for two seconds of audio, the level steps down by one. The degradation
+	// is reset upon opening and disabling. Disabled by default.
+	MT32EMU_EXPORT_V(2.5) void setOverloadGovernorEnabled(bool enabled);
+	// Returns whether the overload governor is enabled. See setOverloadGovernorEnabled() for details.
+	MT32EMU_EXPORT_V(2.5) bool isOverloadGovernorEnabled() const;
+	// Sets the share of real time the rendering may take before the overload governor steps the quality down.
+	// The value is clamped to the range [0.01, 1]. Defaults to 0.75.
+	MT32EMU_EXPORT_V(2.5) void setOverloadGovernorRenderBudget(float budget);
+	// Returns the render budget of the overload governor as a share of real time.
+	MT32EMU_EXPORT_V(2.5) float getOverloadGovernorRenderBudget() const;
+	// Returns the current degradation level of the overload governor, from 0 when the quality is intact
+	// up to OVERLOAD_GOVERNOR_MAX_LEVEL. The level is updated by the rendering thread.
+	MT32EMU_EXPORT_V(2.5) Bit32u getOverloadGovernorLevel() const;
 	// Sets new DAC input mode. See DACInputMode for details.
 	MT32EMU_EXPORT void setDACInputMode(DACInputMode mode);
 	// Returns current DAC input mode. See DACInputMode for details.
@@ -404,6 +864,19 @@ public:
 	// Returns current MIDI delay mode. See MIDIDelayMode for details.
 	MT32EMU_EXPORT MIDIDelayMode getMIDIDelayMode() const;
 
+	// Allows to toggle the MIDI event batching mode.
+	// Normally, at least one sample is rendered after processing each MIDI event, this is necessary to ensure
+	// zero-duration notes will play. This splits rendering into many tiny runs when dense streams
+	// of MIDI events are received, e.g. controller automation or SysEx dumps.
+	// In the MIDI event batching mode, all the MIDI events that are due are processed at once,
+	// except when a poly is being aborted. As a consequence, zero-duration notes may not sound.
+	// The settings derived from the system area, such as the reverb parameters or the MIDI channel assignment, are also
+	// refreshed only once after a batch of SysEx messages writing to it, rather than after each message.
+	// This mode is disabled by default.
+	MT32EMU_EXPORT_V(2.5) void setMIDIEventBatchingEnabled(bool enabled);
+	// Returns whether the MIDI event batching mode is enabled.
+	MT32EMU_EXPORT_V(2.5) bool isMIDIEventBatchingEnabled() const;
+
 	// Sets output gain factor for synth output channels. Applied to all output samples and unrelated with the synth's Master volume,
 	// it rather corresponds to the gain of the output analog circuitry of the hardware units. However, together with setReverbOutputGain()
 	// it offers to the user a capability to control the gain of reverb and non-reverb output channels independently.
@@ -461,6 +934,63 @@ public:
 	// Returns whether NicePartialMixing mode is enabled.
 	MT32EMU_EXPORT bool isNicePartialMixingEnabled() const;
 
+	// Allows to render active partials concurrently using the specified executor.
+	// Partials of active polys are split into at most taskCount groups, each is rendered into a separate buffer,
+	// and the buffers are mixed in a fixed order, so the output remains deterministic. However, it isn't bit-exact
+	// to the output produced with the sequential rendering. Setting NULL executor or taskCount less than 2 restores
+	// the sequential rendering, which is the default. The executor must remain valid while set.
+	// Must not be invoked concurrently with rendering.
+	MT32EMU_EXPORT_V(2.5) void setPartialRenderingExecutor(RenderingTaskExecutor *executor, Bit32u taskCount);
+	// Returns the number of tasks partials are rendered with, or 1 if the sequential rendering is used.
+	MT32EMU_EXPORT_V(2.5) Bit32u getPartialRenderingTaskCount() const;
+	// Enables the deterministic mode of the concurrent rendering when groupCount is non-zero. Partials are then always split
+	// into at most groupCount groups, and each task renders every taskCount-th group. Since both the grouping and the order
+	// of mixing the groups no longer depend on the task count, the output stays identical with any number of tasks, and even
+	// when no executor is set, in which case the groups are rendered in turn on the rendering thread. The output is still
+	// not bit-exact to that of the sequential rendering though. Setting 0 makes the grouping follow the task count again,
+	// which is the default. Must not be invoked concurrently with rendering.
+	MT32EMU_EXPORT_V(2.5) void setPartialRenderingGroupCount(Bit32u groupCount);
+	// Returns the number of groups set for the deterministic mode of the concurrent rendering, or 0 if it is disabled.
+	MT32EMU_EXPORT_V(2.5) Bit32u getPartialRenderingGroupCount() const;
+
+	// Allows to collect statistics of the rendering process, see RenderProfile.
+	// The time spent in each rendering stage is measured, which adds a little overhead, so this is meant for tuning purposes.
+	// Enabling resets the statistics collected so far. This mode is disabled by default.
+	MT32EMU_EXPORT_V(2.5) void setRenderProfilingEnabled(bool enabled);
+	// Returns whether render profiling is enabled.
+	MT32EMU_EXPORT_V(2.5) bool isRenderProfilingEnabled() const;
+	// Fills in the statistics collected since render profiling was enabled or reset.
+	// Must not be invoked concurrently with rendering.
+	MT32EMU_EXPORT_V(2.5) void getRenderProfile(RenderProfile &renderProfile) const;
+	// Resets the statistics of render profiling. Must not be invoked concurrently with rendering.
+	MT32EMU_EXPORT_V(2.5) void resetRenderProfile();
+
+	// Fills in the statistics of the partial allocation, which help to decide whether the partial count suffices
+	// for the MIDI data played. Must not be invoked concurrently with rendering or playing MIDI messages.
+	// Returns false if the synth isn't open.
+	MT32EMU_EXPORT_V(2.5) bool getPolyphonyStats(PolyphonyStats &stats) const;
+	// Resets the statistics of the partial allocation, with the same restrictions.
+	MT32EMU_EXPORT_V(2.5) void resetPolyphonyStats();
+
+	// Sets the TraceSink to report the spans of work to, or disables tracing when NULL, which is the default.
+	// The sink must remain valid while set. Must not be invoked concurrently with rendering or playing MIDI messages.
+	MT32EMU_EXPORT_V(2.5) void setTraceSink(TraceSink *traceSink);
+	// Returns the TraceSink set, or NULL if tracing is disabled.
+	MT32EMU_EXPORT_V(2.5) TraceSink *getTraceSink() const;
+
+	// Sets the ReverbEngine to process the reverb with instead of the built-in reverb model, or restores the built-in one
+	// when NULL, which is the default. The reverb compatibility mode then only affects the analogue circuit emulation.
+	// The engine must remain valid while set. Must not be invoked concurrently with rendering or playing MIDI messages.
+	MT32EMU_EXPORT_V(2.5) void setReverbEngine(ReverbEngine *reverbEngine);
+	// Returns the ReverbEngine set, or NULL if the built-in reverb model is used.
+	MT32EMU_EXPORT_V(2.5) ReverbEngine *getReverbEngine() const;
+
+	// When the library is built with the realtime-safe rendering (see option libmt32emu_REALTIME_SAFE), debug messages
+	// printed while rendering are kept in a preallocated log rather than passed to the ReportHandler in place.
+	// This delivers the deferred messages to the ReportHandler on the calling thread, which must be the only one doing so.
+	// Safe to invoke concurrently with rendering, e.g. periodically from a non-realtime thread. Does nothing otherwise.
+	MT32EMU_EXPORT_V(2.5) void flushDeferredDebugMessages();
+
 	// Selects new type of the wave generator and renderer to be used during subsequent calls to open().
 	// By default, RendererType_BIT16S is selected.
 	// See RendererType for details.
@@ -469,18 +999,54 @@ public:
 	// See RendererType for details.
 	MT32EMU_EXPORT RendererType getSelectedRendererType() const;
 
+	// Returns the instruction set extensions the CPU supports that the optimised implementations of the rendering kernels
+	// may use, as a combination of CPUFeature flags. The extensions disabled with the environment variable
+	// MT32EMU_CPU_FEATURES are excluded. The variable holds a comma-separated list of the extensions to use,
+	// e.g. "sse2,avx2", or "none" to use the portable implementations only.
+	MT32EMU_EXPORT_V(2.5) static Bit32u getSupportedCPUFeatures();
+	// Restricts the extensions the rendering kernels may use to the specified combination of CPUFeature flags. The output
+	// is bit-exact regardless of the implementations selected, so this is mostly useful for testing and benchmarking.
+	// Takes effect upon the next opening of the synth. By default, all the supported extensions are used.
+	MT32EMU_EXPORT_V(2.5) void setEnabledCPUFeatures(Bit32u cpuFeatures);
+	MT32EMU_EXPORT_V(2.5) Bit32u getEnabledCPUFeatures() const;
+	// Retrieves the name of the rendering kernel with the specified index along with the name of its implementation
+	// selected when the synth was opened, e.g. "sse2" or "portable". Returns false if the synth isn't open or
+	// the index is out of range, which allows to enumerate all the kernels.
+	MT32EMU_EXPORT_V(2.5) bool getKernelVariant(Bit32u kernelIx, const char *&kernelName, const char *&variantName) const;
+
 	// Returns actual sample rate used in emulation of stereo analog circuitry of hardware units.
 	// See comment for render() below.
 	MT32EMU_EXPORT Bit32u getStereoOutputSampleRate() const;
 
+	// Returns the fixed delay from the timestamp of a note-on message to the onset of the note at the stereo output,
+	// in frames at getStereoOutputSampleRate(). This comprises the transfer time of the message through the emulated
+	// MIDI interface unless MIDIDelayMode_IMMEDIATE is in effect, and the group delay of the analogue LPF at DC.
+	// The delay the reverb model applies to the wet signal isn't included as it is a part of the effect, the dry signal
+	// goes undelayed. When a SampleRateConverter is used, its own delay adds up, see SampleRateConverter::getLatency().
+	// Returns 0 if the synth isn't open.
+	MT32EMU_EXPORT_V(2.5) double getOutputLatencyFrames() const;
+
 	// Renders samples to the specified output stream as if they were sampled at the analog stereo output.
-	// When AnalogOutputMode is set to ACCURATE (OVERSAMPLED), the output signal is upsampled to 48 (96) kHz in order
+	// When AnalogOutputMode is set to ACCURATE or DECIMATED (OVERSAMPLED), the output signal is upsampled to 48 (96) kHz in order
 	// to retain emulation accuracy in whole audible frequency spectra. Otherwise, native digital signal sample rate is retained.
 	// getStereoOutputSampleRate() can be used to query actual sample rate of the output signal.
 	// The length is in frames, not bytes (in 16-bit stereo, one frame is 4 bytes). Uses NATIVE byte ordering.
 	MT32EMU_EXPORT void render(Bit16s *stream, Bit32u len);
 	// Same as above but outputs to a float stereo stream.
 	MT32EMU_EXPORT void render(float *stream, Bit32u len);
+	// Same as above but outputs the left and right channels to separate float streams.
+	MT32EMU_EXPORT_V(2.5) void render(float *leftStream, float *rightStream, Bit32u len);
+
+	// Same as the methods above, but also plays the MIDI events at the offsets in frames from the beginning of the stream,
+	// specified as the timestamps. The output is rendered in pieces between the events, and the events are played
+	// directly rather than through the MIDI event queue, so that each takes effect exactly at its offset. The events
+	// must be sorted by the offsets. The MIDI delay mode isn't applied to them, whereas the MCU busy-loop emulation is.
+	// Events with offsets beyond the length of the stream, as well as the events the busy-loop delays past the end
+	// of the stream, are enqueued as with playEvents() to play during the subsequent rendering. Returns the number
+	// of events played or enqueued, which may be less than count only if the MIDI event queue gets full.
+	MT32EMU_EXPORT_V(2.5) Bit32u renderWithEvents(Bit16s *stream, Bit32u len, const MIDIEvent *events, Bit32u count);
+	MT32EMU_EXPORT_V(2.5) Bit32u renderWithEvents(float *stream, Bit32u len, const MIDIEvent *events, Bit32u count);
+	MT32EMU_EXPORT_V(2.5) Bit32u renderWithEvents(float *leftStream, float *rightStream, Bit32u len, const MIDIEvent *events, Bit32u count);
 
 	// Renders samples to the specified output streams as if they appeared at the DAC entrance.
 	// No further processing performed in analog circuitry emulation is applied to the signal.
@@ -492,6 +1058,20 @@ public:
 	MT32EMU_EXPORT void renderStreams(float *nonReverbLeft, float *nonReverbRight, float *reverbDryLeft, float *reverbDryRight, float *reverbWetLeft, float *reverbWetRight, Bit32u len);
 	MT32EMU_EXPORT void renderStreams(const DACOutputStreams<float> &streams, Bit32u len);
 
+	// Renders the dry output of each part to a separate stereo pair of streams along with the reverb wet output,
+	// all as they appear at the DAC entrance, so that the parts can be mixed and processed individually afterwards.
+	// Each part stream contains the output of both the reverb-sent and the non-reverb partials of the part.
+	// As with renderStreams(), NULL skips a stream, and no analog circuitry emulation is applied.
+	// The partials are always rendered sequentially, the partial rendering executor is not used.
+	MT32EMU_EXPORT_V(2.5) void renderPartStreams(const PartOutputStreams<Bit16s> &streams, Bit32u len);
+	MT32EMU_EXPORT_V(2.5) void renderPartStreams(const PartOutputStreams<float> &streams, Bit32u len);
+
+	// Advances the synth by the specified number of samples at the output sample rate without rendering anything,
+	// provided the output is certain to be silent, that is, the MIDI queue is empty, no partial is active,
+	// and both the reverb and the analog circuitry emulation are silent. Returns true if the samples are skipped,
+	// in which case they are to be treated as zeros, otherwise nothing is done. This allows to pass long pauses quickly.
+	MT32EMU_EXPORT_V(2.5) bool skipSilence(Bit32u len);
+
 	// Returns true when there is at least one active partial, otherwise false.
 	MT32EMU_EXPORT bool hasActivePartials() const;
 
@@ -533,6 +1113,24 @@ public:
 
 	// Stores internal state of emulated synth into an array provided (as it would be acquired from hardware).
 	MT32EMU_EXPORT void readMemory(Bit32u addr, Bit32u len, Bit8u *data);
+
+	// Returns the size in bytes of the memory state snapshot produced by saveMemoryState().
+	MT32EMU_EXPORT_V(2.5) static Bit32u getMemoryStateSize();
+
+	// Stores a snapshot of the complete emulated synth memory (the temporary patch, timbre and rhythm settings,
+	// the patch and timbre memory and the system area) along with the effective master tune into the array provided.
+	// The array must be at least getMemoryStateSize() bytes long. The snapshot can later be restored with
+	// restoreMemoryState() into this or another synth that uses the same control ROM, which is way faster than
+	// replaying the SysEx messages that produced that state. The currently playing notes aren't included.
+	// Returns false if the synth isn't open.
+	MT32EMU_EXPORT_V(2.5) bool saveMemoryState(Bit8u *data) const;
+
+	// Restores the emulated synth memory from a snapshot previously produced by saveMemoryState(). All the parts
+	// are reset as upon a device reset, so all the playing notes are silenced, the reverb and other system settings
+	// are refreshed according to the restored state. Note, the MIDI events that are still queued are retained.
+	// See the WARNING above playMsgNow(), the same synchronisation requirements apply.
+	// Returns false if the synth isn't open.
+	MT32EMU_EXPORT_V(2.5) bool restoreMemoryState(const Bit8u *data);
 }; // class Synth
 
 } // namespace MT32Emu
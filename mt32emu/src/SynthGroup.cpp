@@ -0,0 +1,498 @@
+/* Copyright (C) 2021 Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <cstring>
+
+#include "internals.h"
+
+#include "SynthGroup.h"
+#include "BReverbModel.h"
+#include "PartialManager.h"
+#include "SampleRateConverter.h"
+
+namespace MT32Emu {
+
+// The members are rendered in chunks of this many frames into the buffers of their own, before the chunks are mixed.
+static const Bit32u MEMBER_CHUNK_LENGTH = 512;
+
+namespace {
+
+class SynthSource : public SynthGroup::Source {
+public:
+	explicit SynthSource(Synth &useSynth) : synth(useSynth) {}
+
+	void render(Bit16s *stream, Bit32u len) {
+		synth.render(stream, len);
+	}
+
+	void render(float *stream, Bit32u len) {
+		synth.render(stream, len);
+	}
+
+	Bit32s getNUMANode() const {
+		return synth.getNUMANode();
+	}
+
+private:
+	Synth &synth;
+};
+
+class SampleRateConverterSource : public SynthGroup::Source {
+public:
+	explicit SampleRateConverterSource(SampleRateConverter &useConverter) : converter(useConverter) {}
+
+	void render(Bit16s *stream, Bit32u len) {
+		converter.getOutputSamples(stream, len);
+	}
+
+	void render(float *stream, Bit32u len) {
+		converter.getOutputSamples(stream, len);
+	}
+
+private:
+	SampleRateConverter &converter;
+};
+
+// The reverb engine the group sets to a synth sharing the reverb. While the synth follows another one with the same
+// reverb settings, its reverb input is kept for the leader, which sums it with its own before processing. Since
+// the followers render before the leaders, the input of the chunk is complete by then.
+class SharedReverbEngine : public ReverbEngine {
+public:
+	SharedReverbEngine() :
+		reverbModel(NULL),
+		mode(0),
+		mt32CompatibleModel(false),
+		time(0),
+		level(0),
+		leader(NULL),
+		firstFollower(NULL),
+		lastFollower(NULL),
+		nextFollower(NULL),
+		inputBuffer(new float[MEMBER_CHUNK_LENGTH << 1]),
+		position(0),
+		fed(true)
+	{}
+
+	~SharedReverbEngine() {
+		delete reverbModel;
+		delete[] inputBuffer;
+	}
+
+	void setMode(Bit8u newMode, bool newMT32CompatibleModel) {
+		if (reverbModel != NULL && mode == newMode && mt32CompatibleModel == newMT32CompatibleModel) return;
+		delete reverbModel;
+		mode = newMode;
+		mt32CompatibleModel = newMT32CompatibleModel;
+		reverbModel = BReverbModel::createBReverbModel(ReverbMode(mode), mt32CompatibleModel, RendererType_FLOAT);
+		reverbModel->open();
+		reverbModel->setParameters(time, level);
+	}
+
+	void setParameters(Bit8u newTime, Bit8u newLevel) {
+		time = newTime;
+		level = newLevel;
+		if (reverbModel != NULL) reverbModel->setParameters(time, level);
+	}
+
+	void mute() {
+		if (reverbModel != NULL) reverbModel->mute();
+	}
+
+	bool isActive() const {
+		if (leader != NULL) return false;
+		if (reverbModel != NULL && reverbModel->isActive()) return true;
+		for (const SharedReverbEngine *follower = firstFollower; follower != NULL; follower = follower->nextFollower) {
+			if (follower->fed) return true;
+		}
+		return false;
+	}
+
+	void process(float *left, float *right, Bit32u numSamples) {
+		const Bit32u available = position < MEMBER_CHUNK_LENGTH ? MEMBER_CHUNK_LENGTH - position : 0;
+		const Bit32u sharedLength = numSamples < available ? numSamples : available;
+		if (leader != NULL) {
+			float * const bufferLeft = inputBuffer + position;
+			float * const bufferRight = bufferLeft + MEMBER_CHUNK_LENGTH;
+			for (Bit32u i = 0; i < sharedLength; i++) {
+				bufferLeft[i] = left[i];
+				bufferRight[i] = right[i];
+			}
+			Synth::muteSampleBuffer(left, numSamples);
+			Synth::muteSampleBuffer(right, numSamples);
+			position += numSamples;
+			fed = true;
+			return;
+		}
+		for (const SharedReverbEngine *follower = firstFollower; follower != NULL; follower = follower->nextFollower) {
+			const float * const followerLeft = follower->inputBuffer + position;
+			const float * const followerRight = followerLeft + MEMBER_CHUNK_LENGTH;
+			for (Bit32u i = 0; i < sharedLength; i++) {
+				left[i] += followerLeft[i];
+				right[i] += followerRight[i];
+			}
+		}
+		position += numSamples;
+		if (reverbModel == NULL || !reverbModel->process(left, right, left, right, numSamples)) {
+			Synth::muteSampleBuffer(left, numSamples);
+			Synth::muteSampleBuffer(right, numSamples);
+		}
+	}
+
+	bool hasSameSettings(const SharedReverbEngine &other) const {
+		return reverbModel != NULL && other.reverbModel != NULL && mode == other.mode
+			&& mt32CompatibleModel == other.mt32CompatibleModel && time == other.time && level == other.level;
+	}
+
+	bool hasFollowers() const {
+		return firstFollower != NULL;
+	}
+
+	// Starts the next chunk following the specified leader, or rendering the own wet output if NULL.
+	void follow(SharedReverbEngine *newLeader) {
+		if (newLeader != NULL) {
+			// The tail of the own model isn't rendered while following, so it is dropped.
+			if (leader == NULL) mute();
+			if (newLeader->lastFollower == NULL) {
+				newLeader->firstFollower = this;
+			} else {
+				newLeader->lastFollower->nextFollower = this;
+			}
+			newLeader->lastFollower = this;
+		}
+		leader = newLeader;
+		firstFollower = NULL;
+		lastFollower = NULL;
+		nextFollower = NULL;
+		position = 0;
+		// The input kept is only cleared when any came in, in case the synth skips rendering the chunk.
+		if (fed) {
+			Synth::muteSampleBuffer(inputBuffer, MEMBER_CHUNK_LENGTH << 1);
+			fed = false;
+		}
+	}
+
+private:
+	BReverbModel *reverbModel;
+	Bit8u mode;
+	bool mt32CompatibleModel;
+	Bit8u time;
+	Bit8u level;
+
+	SharedReverbEngine *leader;
+	SharedReverbEngine *firstFollower;
+	SharedReverbEngine *lastFollower;
+	SharedReverbEngine *nextFollower;
+
+	float *inputBuffer;
+	Bit32u position;
+	bool fed;
+};
+
+} // namespace
+
+struct SynthGroup::Member {
+	SynthGroup::Source *source;
+	Bit32u outputIx;
+	IntSample *intBuffer;
+	FloatSample *floatBuffer;
+	// Only set for the members added with addSynth(Synth &).
+	Synth *synth;
+	SharedReverbEngine *sharedReverb;
+	// Set when the synth skips the current chunk as silent, in which case the buffers aren't filled.
+	bool silent;
+
+	void renderChunk(bool floatOutput, Bit32u len) {
+		if (floatOutput) {
+			source->render(floatBuffer, len);
+		} else {
+			source->render(intBuffer, len);
+		}
+	}
+};
+
+class SynthGroup::MemberRenderingTask : public RenderingTaskExecutor::Task {
+public:
+	MemberRenderingTask(Member *useMembers, const Bit32u *useMemberIxs, bool useFloatOutput, Bit32u useLen) :
+		members(useMembers), memberIxs(useMemberIxs), floatOutput(useFloatOutput), len(useLen)
+	{}
+
+	void run(Bit32u taskIx) {
+		members[memberIxs[taskIx]].renderChunk(floatOutput, len);
+	}
+
+private:
+	Member * const members;
+	const Bit32u * const memberIxs;
+	const bool floatOutput;
+	const Bit32u len;
+};
+
+SynthGroup::SynthGroup(Bit32u useOutputCount) :
+	outputCount(useOutputCount > 0 ? useOutputCount : 1),
+	members(NULL),
+	memberCount(0),
+	renderingExecutor(NULL),
+	mixBuffer(new IntSampleEx[MEMBER_CHUNK_LENGTH << 1]),
+	sharedReverbEnabled(false),
+	renderOrder(NULL),
+	leadingMemberCount(0),
+	taskNodes(NULL)
+{}
+
+SynthGroup::~SynthGroup() {
+	setSharedReverbEnabled(false);
+	for (Bit32u memberIx = 0; memberIx < memberCount; memberIx++) {
+		delete members[memberIx].source;
+		delete[] members[memberIx].intBuffer;
+		delete[] members[memberIx].floatBuffer;
+	}
+	delete[] members;
+	delete[] mixBuffer;
+	delete[] renderOrder;
+	delete[] taskNodes;
+}
+
+void SynthGroup::addSynth(Synth &synth, Bit32u outputIx) {
+	addSource(new SynthSource(synth), outputIx);
+	Member &member = members[memberCount - 1];
+	member.synth = &synth;
+	if (sharedReverbEnabled) {
+		member.sharedReverb = new SharedReverbEngine;
+		synth.setReverbEngine(member.sharedReverb);
+	}
+}
+
+void SynthGroup::addSynth(SampleRateConverter &converter, Bit32u outputIx) {
+	addSource(new SampleRateConverterSource(converter), outputIx);
+}
+
+void SynthGroup::addSource(Source *source, Bit32u outputIx) {
+	// The buffers are allocated beforehand, so that the rendering never allocates memory.
+	Member *newMembers = new Member[memberCount + 1];
+	if (memberCount > 0) {
+		memcpy(newMembers, members, memberCount * sizeof(Member));
+	}
+	Member &member = newMembers[memberCount];
+	member.source = source;
+	member.outputIx = outputIx < outputCount ? outputIx : outputCount - 1;
+	member.intBuffer = new IntSample[MEMBER_CHUNK_LENGTH << 1];
+	member.floatBuffer = new FloatSample[MEMBER_CHUNK_LENGTH << 1];
+	member.synth = NULL;
+	member.sharedReverb = NULL;
+	member.silent = false;
+	delete[] members;
+	members = newMembers;
+	memberCount++;
+	delete[] renderOrder;
+	renderOrder = new Bit32u[memberCount];
+	delete[] taskNodes;
+	taskNodes = new Bit32s[memberCount];
+}
+
+Bit32u SynthGroup::getMemberCount() const {
+	return memberCount;
+}
+
+Bit32u SynthGroup::getOutputCount() const {
+	return outputCount;
+}
+
+void SynthGroup::setRenderingExecutor(RenderingTaskExecutor *executor) {
+	renderingExecutor = executor;
+}
+
+void SynthGroup::setSharedReverbEnabled(bool enabled) {
+	if (sharedReverbEnabled == enabled) return;
+	sharedReverbEnabled = enabled;
+	for (Bit32u memberIx = 0; memberIx < memberCount; memberIx++) {
+		Member &member = members[memberIx];
+		if (member.synth == NULL) continue;
+		if (enabled) {
+			member.sharedReverb = new SharedReverbEngine;
+			member.synth->setReverbEngine(member.sharedReverb);
+		} else {
+			member.synth->setReverbEngine(NULL);
+			delete member.sharedReverb;
+			member.sharedReverb = NULL;
+		}
+	}
+}
+
+bool SynthGroup::isSharedReverbEnabled() const {
+	return sharedReverbEnabled;
+}
+
+void SynthGroup::render(Bit16s *stream, Bit32u len) {
+	renderMembers(&stream, true, false, len);
+}
+
+void SynthGroup::render(float *stream, Bit32u len) {
+	renderMembers(&stream, true, true, len);
+}
+
+void SynthGroup::render(Bit16s * const *streams, Bit32u len) {
+	renderMembers(streams, false, false, len);
+}
+
+void SynthGroup::render(float * const *streams, Bit32u len) {
+	renderMembers(streams, false, true, len);
+}
+
+template <class Sample>
+void SynthGroup::renderMembers(Sample * const *streams, bool mixAllOutputs, bool floatOutput, Bit32u len) {
+	const Bit32u streamCount = mixAllOutputs ? 1 : outputCount;
+	Bit32u renderedLength = 0;
+	while (renderedLength < len) {
+		const Bit32u thisLen = len - renderedLength > MEMBER_CHUNK_LENGTH ? MEMBER_CHUNK_LENGTH : len - renderedLength;
+		renderMemberChunks(floatOutput, thisLen);
+		for (Bit32u outputIx = 0; outputIx < streamCount; outputIx++) {
+			if (streams[outputIx] != NULL) {
+				mixOutput(streams[outputIx] + (renderedLength << 1), outputIx, mixAllOutputs, thisLen);
+			}
+		}
+		renderedLength += thisLen;
+	}
+}
+
+static bool isSharingReverb(const Synth *synth) {
+	return synth->isReverbEnabled() && synth->getStereoOutputSampleRate() == SAMPLE_RATE;
+}
+
+// Each member sharing the reverb follows the first member of the same output that has the same reverb settings,
+// which thus has no leader of its own. The members with followers are put at the end of the render order.
+// The settings may change with MIDI messages rendered in any chunk, so the assignment is redone every time.
+void SynthGroup::assignSharedReverbs() {
+	for (Bit32u memberIx = 0; memberIx < memberCount; memberIx++) {
+		const Member &member = members[memberIx];
+		if (member.sharedReverb == NULL) continue;
+		SharedReverbEngine *leader = NULL;
+		if (isSharingReverb(member.synth)) {
+			for (Bit32u leaderIx = 0; leaderIx < memberIx; leaderIx++) {
+				const Member &candidate = members[leaderIx];
+				if (candidate.sharedReverb == NULL || candidate.outputIx != member.outputIx) continue;
+				if (!isSharingReverb(candidate.synth) || !candidate.sharedReverb->hasSameSettings(*member.sharedReverb)) continue;
+				leader = candidate.sharedReverb;
+				break;
+			}
+		}
+		member.sharedReverb->follow(leader);
+	}
+	Bit32u followingMemberCount = 0;
+	leadingMemberCount = 0;
+	for (Bit32u memberIx = 0; memberIx < memberCount; memberIx++) {
+		const SharedReverbEngine *sharedReverb = members[memberIx].sharedReverb;
+		if (sharedReverb != NULL && sharedReverb->hasFollowers()) {
+			leadingMemberCount++;
+			renderOrder[memberCount - leadingMemberCount] = memberIx;
+		} else {
+			renderOrder[followingMemberCount++] = memberIx;
+		}
+	}
+}
+
+void SynthGroup::renderMemberChunks(bool floatOutput, Bit32u len) {
+	if (!sharedReverbEnabled) {
+		for (Bit32u memberIx = 0; memberIx < memberCount; memberIx++) {
+			renderOrder[memberIx] = memberIx;
+		}
+		renderMemberChunks(renderOrder, memberCount, floatOutput, len);
+		return;
+	}
+	assignSharedReverbs();
+	const Bit32u followingMemberCount = memberCount - leadingMemberCount;
+	renderMemberChunks(renderOrder, followingMemberCount, floatOutput, len);
+	renderMemberChunks(renderOrder + followingMemberCount, leadingMemberCount, floatOutput, len);
+}
+
+// The idle synths are merely advanced over the chunk, the indices of the remaining members are compacted in place.
+// As the synths sharing the reverb are checked in the render order, a leader is only skipped once all its followers
+// have been rendered, so it cannot miss their reverb input.
+void SynthGroup::renderMemberChunks(Bit32u *memberIxs, Bit32u count, bool floatOutput, Bit32u len) {
+	Bit32u activeCount = 0;
+	for (Bit32u i = 0; i < count; i++) {
+		Member &member = members[memberIxs[i]];
+		member.silent = member.synth != NULL && member.synth->skipSilence(len);
+		if (!member.silent) memberIxs[activeCount++] = memberIxs[i];
+	}
+	if (renderingExecutor == NULL || activeCount < 2) {
+		for (Bit32u i = 0; i < activeCount; i++) {
+			members[memberIxs[i]].renderChunk(floatOutput, len);
+		}
+		return;
+	}
+	sortByRenderingCost(memberIxs, activeCount);
+	MemberRenderingTask task(members, memberIxs, floatOutput, len);
+	bool placed = false;
+	for (Bit32u i = 0; i < activeCount; i++) {
+		taskNodes[i] = members[memberIxs[i]].source->getNUMANode();
+		if (taskNodes[i] >= 0) placed = true;
+	}
+	if (placed) {
+		renderingExecutor->executeOnNodes(task, activeCount, taskNodes);
+	} else {
+		renderingExecutor->execute(task, activeCount);
+	}
+}
+
+// Orders the members by the descending cost estimate, so that the longest tasks are started first and the short ones
+// fill the gaps. The cost of a synth grows with the number of its active partials, while the other sources, which
+// convert the sample rate or are unknown, are assumed to be the most expensive. The order of the ties is kept.
+void SynthGroup::sortByRenderingCost(Bit32u *memberIxs, Bit32u count) const {
+	for (Bit32u i = 1; i < count; i++) {
+		const Bit32u memberIx = memberIxs[i];
+		const Synth *synth = members[memberIx].synth;
+		const Bit32u cost = synth == NULL ? Bit32u(-1) : synth->partialManager->getActivePartialCount();
+		Bit32u j = i;
+		for (; j > 0; j--) {
+			const Synth *otherSynth = members[memberIxs[j - 1]].synth;
+			const Bit32u otherCost = otherSynth == NULL ? Bit32u(-1) : otherSynth->partialManager->getActivePartialCount();
+			if (otherCost >= cost) break;
+			memberIxs[j] = memberIxs[j - 1];
+		}
+		memberIxs[j] = memberIx;
+	}
+}
+
+// The members are mixed in the order they were added, regardless of the order their chunks are rendered in.
+void SynthGroup::mixOutput(Bit16s *stream, Bit32u outputIx, bool mixAllOutputs, Bit32u len) {
+	const Bit32u sampleCount = len << 1;
+	memset(mixBuffer, 0, sampleCount * sizeof(IntSampleEx));
+	for (Bit32u memberIx = 0; memberIx < memberCount; memberIx++) {
+		const Member &member = members[memberIx];
+		if (member.silent || (!mixAllOutputs && member.outputIx != outputIx)) continue;
+		for (Bit32u sampleIx = 0; sampleIx < sampleCount; sampleIx++) {
+			mixBuffer[sampleIx] += member.intBuffer[sampleIx];
+		}
+	}
+	for (Bit32u sampleIx = 0; sampleIx < sampleCount; sampleIx++) {
+		stream[sampleIx] = Synth::clipSampleEx(mixBuffer[sampleIx]);
+	}
+}
+
+void SynthGroup::mixOutput(float *stream, Bit32u outputIx, bool mixAllOutputs, Bit32u len) {
+	const Bit32u sampleCount = len << 1;
+	memset(stream, 0, sampleCount * sizeof(float));
+	for (Bit32u memberIx = 0; memberIx < memberCount; memberIx++) {
+		const Member &member = members[memberIx];
+		if (member.silent || (!mixAllOutputs && member.outputIx != outputIx)) continue;
+		for (Bit32u sampleIx = 0; sampleIx < sampleCount; sampleIx++) {
+			stream[sampleIx] += member.floatBuffer[sampleIx];
+		}
+	}
+}
+
+} // namespace MT32Emu
@@ -0,0 +1,134 @@
+/* Copyright (C) 2021 Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MT32EMU_SYNTH_GROUP_H
+#define MT32EMU_SYNTH_GROUP_H
+
+#include "globals.h"
+#include "Types.h"
+#include "Synth.h"
+
+namespace MT32Emu {
+
+class SampleRateConverter;
+
+/* SynthGroup renders several synths at once and mixes their stereo output, e.g. to emulate a number of devices attached
+ * to separate MIDI ports. Each member of the group is mixed into one of the group outputs, so that the devices can be
+ * either combined into a single stream or kept apart, as the integrator needs. When a RenderingTaskExecutor is set,
+ * the members are rendered concurrently, while the mixing remains sequential, so that the output stays deterministic.
+ * The synths in a group are expected to be opened with the same ROMImage instances, so that they share the ROM data
+ * and the decoded PCM samples. Likewise, the members converting the sample rate with the same parameters share
+ * the filter kernels of the internal resampler.
+ * The members added with addSynth(Synth &) that are certain to output silence are skipped cheaply, they are neither
+ * rendered nor mixed, so an idle member costs next to nothing. When rendering concurrently, the others are dispatched
+ * starting with the most expensive ones, as estimated by the number of the active partials, for better packing.
+ * The members added with addSynth(Synth &) convey the NUMA node set by Synth::setNUMANode() to the executor
+ * via RenderingTaskExecutor::executeOnNodes(), so that they can be rendered on the CPUs of their nodes. The members
+ * that convert the sample rate are not known to be placed, a custom source may report the node of its own.
+ * A synth must only be rendered through the group it's added to, and never in more than one group.
+ */
+class MT32EMU_EXPORT_V(2.5) SynthGroup {
+public:
+	// Supplies the interleaved stereo output of a group member. The group takes the ownership of the sources added.
+	class Source {
+	public:
+		virtual ~Source() {}
+
+		virtual void render(Bit16s *stream, Bit32u len) = 0;
+		virtual void render(float *stream, Bit32u len) = 0;
+
+		// Returns the NUMA node the memory the source renders from is placed on, or -1 if unknown, which is the default.
+		virtual Bit32s getNUMANode() const {
+			return -1;
+		}
+	};
+
+	// Creates an empty group with the specified number of outputs, at least one.
+	explicit SynthGroup(Bit32u outputCount = 1);
+	~SynthGroup();
+
+	// Adds a member that renders the synth output at the native sample rate, mixed into the specified output.
+	// The synth must remain valid while the group is in use.
+	void addSynth(Synth &synth, Bit32u outputIx = 0);
+	// Adds a member that renders the output of the synth attached to the converter at the target sample rate.
+	// All the members should produce the output at the same sample rate. The converter must remain valid while
+	// the group is in use.
+	void addSynth(SampleRateConverter &converter, Bit32u outputIx = 0);
+	// Adds a member that renders the output of the specified source. The source is deleted along with the group.
+	void addSource(Source *source, Bit32u outputIx = 0);
+
+	Bit32u getMemberCount() const;
+	Bit32u getOutputCount() const;
+
+	// Sets the executor to render the members concurrently with, or restores the sequential rendering if NULL,
+	// which is the default. If the synths also render partials concurrently, the executor must permit invoking
+	// RenderingTaskExecutor::execute() from within the tasks. The executor must remain valid while set.
+	void setRenderingExecutor(RenderingTaskExecutor *executor);
+
+	// Enables sharing the reverb among the synths mixed into the same output that have the same reverb settings. Their
+	// reverb input is summed and processed by a single reverb model, and the wet output is rendered by the first one
+	// of them added, so the CPU time the reverb takes no longer grows with the number of synths in one configuration.
+	// Only the members added with addSynth(Synth &) that render at the native sample rate take part, the output gains
+	// and the analogue output mode of the synths sharing the reverb are expected to match. The group sets its own
+	// ReverbEngine to these synths while enabled, so they must outlive the group, and the reverb model is processed
+	// in float samples with any renderer type. When the reverb settings of a synth change, it stops sharing the reverb
+	// of the others, though the tail of its earlier input still decays in the shared reverb. Disabled by default.
+	// Must not be invoked concurrently with rendering.
+	void setSharedReverbEnabled(bool enabled);
+	bool isSharedReverbEnabled() const;
+
+	// Renders the mix of all the members, regardless of the outputs they are assigned to, into the interleaved stereo
+	// stream. The length is in frames. The mixed 16-bit samples are clipped.
+	void render(Bit16s *stream, Bit32u len);
+	void render(float *stream, Bit32u len);
+
+	// Same as above, but renders each output separately into the respective stream of the array, which must contain
+	// as many streams as there are outputs. An output that no member is assigned to is filled with silence.
+	void render(Bit16s * const *streams, Bit32u len);
+	void render(float * const *streams, Bit32u len);
+
+private:
+	struct Member;
+	class MemberRenderingTask;
+
+	const Bit32u outputCount;
+	Member *members;
+	Bit32u memberCount;
+	RenderingTaskExecutor *renderingExecutor;
+	Bit32s *mixBuffer;
+	bool sharedReverbEnabled;
+	// The members that render the wet output of the shared reverb go last, as they need the reverb input of the others.
+	Bit32u *renderOrder;
+	Bit32u leadingMemberCount;
+	// The NUMA nodes of the members dispatched to the rendering executor, in the order of the tasks.
+	Bit32s *taskNodes;
+
+	template <class Sample>
+	void renderMembers(Sample * const *streams, bool mixAllOutputs, bool floatOutput, Bit32u len);
+	void assignSharedReverbs();
+	void renderMemberChunks(bool floatOutput, Bit32u len);
+	void renderMemberChunks(Bit32u *memberIxs, Bit32u count, bool floatOutput, Bit32u len);
+	void sortByRenderingCost(Bit32u *memberIxs, Bit32u count) const;
+	void mixOutput(Bit16s *stream, Bit32u outputIx, bool mixAllOutputs, Bit32u len);
+	void mixOutput(float *stream, Bit32u outputIx, bool mixAllOutputs, Bit32u len);
+
+	SynthGroup(const SynthGroup &);            // prevent copy-construction
+	SynthGroup &operator=(const SynthGroup &); // prevent assignment
+}; // class SynthGroup
+
+} // namespace MT32Emu
+
+#endif // #ifndef MT32EMU_SYNTH_GROUP_H
@@ -55,32 +55,33 @@ void TVA::end(int newPhase) {
 #endif
 }
 
-static int multBias(Bit8u biasLevel, int bias) {
-	return (bias * biasLevelToAmpSubtractionCoeff[biasLevel]) >> 5;
+static int multBias(Bit8u biasAmpSubtractionCoeff, int bias) {
+	return (bias * biasAmpSubtractionCoeff) >> 5;
 }
 
-static int calcBiasAmpSubtraction(Bit8u biasPoint, Bit8u biasLevel, int key) {
+static int calcBiasAmpSubtraction(Bit8u biasPoint, Bit8u biasAmpSubtractionCoeff, int key) {
 	if ((biasPoint & 0x40) == 0) {
 		int bias = biasPoint + 33 - key;
 		if (bias > 0) {
-			return multBias(biasLevel, bias);
+			return multBias(biasAmpSubtractionCoeff, bias);
 		}
 	} else {
 		int bias = biasPoint - 31 - key;
 		if (bias < 0) {
 			bias = -bias;
-			return multBias(biasLevel, bias);
+			return multBias(biasAmpSubtractionCoeff, bias);
 		}
 	}
 	return 0;
 }
 
-static int calcBiasAmpSubtractions(const TimbreParam::PartialParam *partialParam, int key) {
-	int biasAmpSubtraction1 = calcBiasAmpSubtraction(partialParam->tva.biasPoint1, partialParam->tva.biasLevel1, key);
+static int calcBiasAmpSubtractions(const PatchCache *patchCache, int key) {
+	const TimbreParam::PartialParam *partialParam = patchCache->partialParam;
+	int biasAmpSubtraction1 = calcBiasAmpSubtraction(partialParam->tva.biasPoint1, patchCache->tvaBiasAmpSubtractionCoeff1, key);
 	if (biasAmpSubtraction1 > 255) {
 		return 255;
 	}
-	int biasAmpSubtraction2 = calcBiasAmpSubtraction(partialParam->tva.biasPoint2, partialParam->tva.biasLevel2, key);
+	int biasAmpSubtraction2 = calcBiasAmpSubtraction(partialParam->tva.biasPoint2, patchCache->tvaBiasAmpSubtractionCoeff2, key);
 	if (biasAmpSubtraction2 > 255) {
 		return 255;
 	}
@@ -91,12 +92,10 @@ static int calcBiasAmpSubtractions(const TimbreParam::PartialParam *partialParam
 	return biasAmpSubtraction;
 }
 
-static int calcVeloAmpSubtraction(Bit8u veloSensitivity, unsigned int velocity) {
+static int calcVeloAmpSubtraction(const PatchCache *patchCache, unsigned int velocity) {
 	// FIXME:KG: Better variable names
-	int velocityMult = veloSensitivity - 50;
-	int absVelocityMult = velocityMult < 0 ? -velocityMult : velocityMult;
-	velocityMult = signed(unsigned(velocityMult * (signed(velocity) - 64)) << 2);
-	return absVelocityMult - (velocityMult >> 8); // PORTABILITY NOTE: Assumes arithmetic shift
+	int velocityMult = signed(unsigned(patchCache->tvaVeloMult * (signed(velocity) - 64)) << 2);
+	return patchCache->tvaAbsVeloMult - (velocityMult >> 8); // PORTABILITY NOTE: Assumes arithmetic shift
 }
 
 static int calcBasicAmp(const Tables *tables, const Partial *partial, const MemParams::System *system, const TimbreParam::PartialParam *partialParam, const MemParams::PatchTemp *patchTemp, const MemParams::RhythmTemp *rhythmTemp, int biasAmpSubtraction, int veloAmpSubtraction, Bit8u expression, bool hasRingModQuirk) {
@@ -151,12 +150,24 @@ static int calcKeyTimeSubtraction(Bit8u envTimeKeyfollow, int key) {
 	return (key - 60) >> (5 - envTimeKeyfollow); // PORTABILITY NOTE: Assumes arithmetic shift
 }
 
-void TVA::reset(const Part *newPart, const TimbreParam::PartialParam *newPartialParam, const MemParams::RhythmTemp *newRhythmTemp) {
+void TVA::cachePartialParams(PatchCache &patchCache) {
+	const TimbreParam::PartialParam &partialParam = patchCache.srcPartial;
+	patchCache.tvaBiasAmpSubtractionCoeff1 = biasLevelToAmpSubtractionCoeff[partialParam.tva.biasLevel1];
+	patchCache.tvaBiasAmpSubtractionCoeff2 = biasLevelToAmpSubtractionCoeff[partialParam.tva.biasLevel2];
+	patchCache.tvaVeloMult = partialParam.tva.veloSensitivity - 50;
+	patchCache.tvaAbsVeloMult = patchCache.tvaVeloMult < 0 ? -patchCache.tvaVeloMult : patchCache.tvaVeloMult;
+}
+
+void TVA::reset(const Part *newPart, const PatchCache *patchCache, const MemParams::RhythmTemp *newRhythmTemp) {
 	part = newPart;
-	partialParam = newPartialParam;
+	partialParam = patchCache->partialParam;
 	patchTemp = newPart->getPatchTemp();
 	rhythmTemp = newRhythmTemp;
 
+	const ControlROMFeatureSet *controlROMFeatures = partial->getSynth()->controlROMFeatures;
+	quirkRingModulationNoMix = controlROMFeatures->quirkRingModulationNoMix;
+	quirkTVAZeroEnvLevels = controlROMFeatures->quirkTVAZeroEnvLevels;
+
 	playing = true;
 
 	const Tables *tables = &Tables::getInstance();
@@ -166,10 +177,10 @@ void TVA::reset(const Part *newPart, const TimbreParam::PartialParam *newPartial
 
 	keyTimeSubtraction = calcKeyTimeSubtraction(partialParam->tva.envTimeKeyfollow, key);
 
-	biasAmpSubtraction = calcBiasAmpSubtractions(partialParam, key);
-	veloAmpSubtraction = calcVeloAmpSubtraction(partialParam->tva.veloSensitivity, velocity);
+	biasAmpSubtraction = calcBiasAmpSubtractions(patchCache, key);
+	veloAmpSubtraction = calcVeloAmpSubtraction(patchCache, velocity);
 
-	int newTarget = calcBasicAmp(tables, partial, system, partialParam, patchTemp, newRhythmTemp, biasAmpSubtraction, veloAmpSubtraction, part->getExpression(), partial->getSynth()->controlROMFeatures->quirkRingModulationNoMix);
+	int newTarget = calcBasicAmp(tables, partial, system, partialParam, patchTemp, newRhythmTemp, biasAmpSubtraction, veloAmpSubtraction, part->getExpression(), quirkRingModulationNoMix);
 	int newPhase;
 	if (partialParam->tva.envTime[0] == 0) {
 		// Initially go to the TVA_PHASE_ATTACK target amp, and spend the next phase going from there to the TVA_PHASE_2 target amp
@@ -221,7 +232,7 @@ void TVA::recalcSustain() {
 	}
 	// We're sustaining. Recalculate all the values
 	const Tables *tables = &Tables::getInstance();
-	int newTarget = calcBasicAmp(tables, partial, system, partialParam, patchTemp, rhythmTemp, biasAmpSubtraction, veloAmpSubtraction, part->getExpression(), partial->getSynth()->controlROMFeatures->quirkRingModulationNoMix);
+	int newTarget = calcBasicAmp(tables, partial, system, partialParam, patchTemp, rhythmTemp, biasAmpSubtraction, veloAmpSubtraction, part->getExpression(), quirkRingModulationNoMix);
 	newTarget += partialParam->tva.envLevel[3];
 
 	// Although we're in TVA_PHASE_SUSTAIN at this point, we cannot be sure that there is no active ramp at the moment.
@@ -256,6 +267,15 @@ int TVA::getPhase() const {
 	return phase;
 }
 
+Bit32u TVA::samplesUntilEnd(Bit32u maxLength) const {
+	if (!playing) return 0;
+	// Only an event, like a note off, brings the envelope out of the sustain phase. The ramps restarted by recalcSustain()
+	// lead back to this phase.
+	if (phase == TVA_PHASE_SUSTAIN) return maxLength;
+	// Otherwise, the envelope may only end in nextPhase(), upon the interrupt of the ramp.
+	return ampRamp->samplesUntilInterrupt(maxLength);
+}
+
 void TVA::nextPhase() {
 	const Tables *tables = &Tables::getInstance();
 
@@ -271,7 +291,7 @@ void TVA::nextPhase() {
 	}
 
 	bool allLevelsZeroFromNowOn = false;
-	if (!partial->getSynth()->controlROMFeatures->quirkTVAZeroEnvLevels && partialParam->tva.envLevel[3] == 0) {
+	if (!quirkTVAZeroEnvLevels && partialParam->tva.envLevel[3] == 0) {
 		if (newPhase == TVA_PHASE_4) {
 			allLevelsZeroFromNowOn = true;
 		} else if (partialParam->tva.envLevel[2] == 0) {
@@ -294,7 +314,7 @@ void TVA::nextPhase() {
 	int envPointIndex = phase;
 
 	if (!allLevelsZeroFromNowOn) {
-		newTarget = calcBasicAmp(tables, partial, system, partialParam, patchTemp, rhythmTemp, biasAmpSubtraction, veloAmpSubtraction, part->getExpression(), partial->getSynth()->controlROMFeatures->quirkRingModulationNoMix);
+		newTarget = calcBasicAmp(tables, partial, system, partialParam, patchTemp, rhythmTemp, biasAmpSubtraction, veloAmpSubtraction, part->getExpression(), quirkRingModulationNoMix);
 
 		if (newPhase == TVA_PHASE_SUSTAIN || newPhase == TVA_PHASE_RELEASE) {
 			if (partialParam->tva.envLevel[3] == 0) {
@@ -72,6 +72,10 @@ private:
 
 	bool playing;
 
+	// Copied from the control ROM features upon reset, since they are consulted in each phase and in the sustain updates.
+	bool quirkRingModulationNoMix;
+	bool quirkTVAZeroEnvLevels;
+
 	int biasAmpSubtraction;
 	int veloAmpSubtraction;
 	int keyTimeSubtraction;
@@ -85,7 +89,10 @@ private:
 
 public:
 	TVA(const Partial *partial, LA32Ramp *ampRamp);
-	void reset(const Part *part, const TimbreParam::PartialParam *partialParam, const MemParams::RhythmTemp *rhythmTemp);
+	// Precomputes the terms of reset() that only depend on the timbre.
+	static void cachePartialParams(PatchCache &patchCache);
+
+	void reset(const Part *part, const PatchCache *patchCache, const MemParams::RhythmTemp *rhythmTemp);
 	void handleInterrupt();
 	void recalcSustain();
 	void startDecay();
@@ -93,6 +100,9 @@ public:
 
 	bool isPlaying() const;
 	int getPhase() const;
+	// Returns the number of samples, up to maxLength, which are certain to precede the one where the envelope may end,
+	// provided that no MIDI events are played meanwhile.
+	Bit32u samplesUntilEnd(Bit32u maxLength) const;
 }; // class TVA
 
 } // namespace MT32Emu
@@ -53,37 +53,38 @@ enum {
 	PHASE_DONE = 7
 };
 
-static int calcBaseCutoff(const TimbreParam::PartialParam *partialParam, Bit32u basePitch, unsigned int key, bool quirkTVFBaseCutoffLimit) {
-	// This table matches the values used by a real LAPC-I.
-	static const Bit8s biasLevelToBiasMult[] = {85, 42, 21, 16, 10, 5, 2, 0, -2, -5, -10, -16, -21, -74, -85};
-	// These values represent unique options with no consistent pattern, so we have to use something like a table in any case.
-	// The table entries, when divided by 21, match approximately what the manual claims:
-	// -1, -1/2, -1/4, 0, 1/8, 1/4, 3/8, 1/2, 5/8, 3/4, 7/8, 1, 5/4, 3/2, 2, s1, s2
-	// Note that the entry for 1/8 is rounded to 2 (from 1/8 * 21 = 2.625), which seems strangely inaccurate compared to the others.
-	static const Bit8s keyfollowMult21[] = {-21, -10, -5, 0, 2, 5, 8, 10, 13, 16, 18, 21, 26, 32, 42, 21, 21};
-	int baseCutoff = keyfollowMult21[partialParam->tvf.keyfollow] - keyfollowMult21[partialParam->wg.pitchKeyfollow];
+// This table matches the values used by a real LAPC-I.
+static const Bit8s biasLevelToBiasMult[] = {85, 42, 21, 16, 10, 5, 2, 0, -2, -5, -10, -16, -21, -74, -85};
+// These values represent unique options with no consistent pattern, so we have to use something like a table in any case.
+// The table entries, when divided by 21, match approximately what the manual claims:
+// -1, -1/2, -1/4, 0, 1/8, 1/4, 3/8, 1/2, 5/8, 3/4, 7/8, 1, 5/4, 3/2, 2, s1, s2
+// Note that the entry for 1/8 is rounded to 2 (from 1/8 * 21 = 2.625), which seems strangely inaccurate compared to the others.
+static const Bit8s keyfollowMult21[] = {-21, -10, -5, 0, 2, 5, 8, 10, 13, 16, 18, 21, 26, 32, 42, 21, 21};
+
+static int calcBaseCutoff(const PatchCache *patchCache, Bit32u basePitch, unsigned int key, bool quirkTVFBaseCutoffLimit) {
+	int baseCutoff = patchCache->tvfKeyfollowMult;
 	// baseCutoff range now: -63 to 63
 	baseCutoff *= int(key) - 60;
 	// baseCutoff range now: -3024 to 3024
-	int biasPoint = partialParam->tvf.biasPoint;
+	int biasPoint = patchCache->partialParam->tvf.biasPoint;
 	if ((biasPoint & 0x40) == 0) {
 		// biasPoint range here: 0 to 63
 		int bias = biasPoint + 33 - key; // bias range here: -75 to 84
 		if (bias > 0) {
 			bias = -bias; // bias range here: -1 to -84
-			baseCutoff += bias * biasLevelToBiasMult[partialParam->tvf.biasLevel]; // Calculation range: -7140 to 7140
+			baseCutoff += bias * patchCache->tvfBiasMult; // Calculation range: -7140 to 7140
 			// baseCutoff range now: -10164 to 10164
 		}
 	} else {
 		// biasPoint range here: 64 to 127
 		int bias = biasPoint - 31 - key; // bias range here: -75 to 84
 		if (bias < 0) {
-			baseCutoff += bias * biasLevelToBiasMult[partialParam->tvf.biasLevel]; // Calculation range: -6375 to 6375
+			baseCutoff += bias * patchCache->tvfBiasMult; // Calculation range: -6375 to 6375
 			// baseCutoff range now: -9399 to 9399
 		}
 	}
 	// baseCutoff range now: -10164 to 10164
-	baseCutoff += ((partialParam->tvf.cutoff << 4) - 800);
+	baseCutoff += patchCache->tvfCutoffOffset;
 	// baseCutoff range now: -10964 to 10964
 	if (baseCutoff >= 0) {
 		// FIXME: Potentially bad if baseCutoff ends up below -2056?
@@ -121,7 +122,16 @@ void TVF::startRamp(Bit8u newTarget, Bit8u newIncrement, int newPhase) {
 #endif
 }
 
-void TVF::reset(const TimbreParam::PartialParam *newPartialParam, unsigned int basePitch) {
+void TVF::cachePartialParams(PatchCache &patchCache) {
+	const TimbreParam::PartialParam &partialParam = patchCache.srcPartial;
+	patchCache.tvfKeyfollowMult = keyfollowMult21[partialParam.tvf.keyfollow] - keyfollowMult21[partialParam.wg.pitchKeyfollow];
+	patchCache.tvfBiasMult = biasLevelToBiasMult[partialParam.tvf.biasLevel];
+	patchCache.tvfCutoffOffset = (partialParam.tvf.cutoff << 4) - 800;
+	patchCache.tvfLevelMultOffset = 109 - partialParam.tvf.envVeloSensitivity;
+}
+
+void TVF::reset(const PatchCache *patchCache, unsigned int basePitch) {
+	const TimbreParam::PartialParam *newPartialParam = patchCache->partialParam;
 	partialParam = newPartialParam;
 
 	unsigned int key = partial->getPoly()->getKey();
@@ -129,14 +139,14 @@ void TVF::reset(const TimbreParam::PartialParam *newPartialParam, unsigned int b
 
 	const Tables *tables = &Tables::getInstance();
 
-	baseCutoff = calcBaseCutoff(newPartialParam, basePitch, key, partial->getSynth()->controlROMFeatures->quirkTVFBaseCutoffLimit);
+	baseCutoff = calcBaseCutoff(patchCache, basePitch, key, partial->getSynth()->controlROMFeatures->quirkTVFBaseCutoffLimit);
 #if MT32EMU_MONITOR_TVF >= 1
 	partial->getSynth()->printDebug("[+%lu] [Partial %d] TVF,base,%d", partial->debugGetSampleNum(), partial->debugGetPartialNum(), baseCutoff);
 #endif
 
 	int newLevelMult = velocity * newPartialParam->tvf.envVeloSensitivity;
 	newLevelMult >>= 6;
-	newLevelMult += 109 - newPartialParam->tvf.envVeloSensitivity;
+	newLevelMult += patchCache->tvfLevelMultOffset;
 	newLevelMult += (signed(key) - 60) >> (4 - newPartialParam->tvf.envDepthKeyfollow);
 	if (newLevelMult < 0) {
 		newLevelMult = 0;
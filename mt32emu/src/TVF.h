@@ -45,7 +45,10 @@ private:
 
 public:
 	TVF(const Partial *partial, LA32Ramp *cutoffModifierRamp);
-	void reset(const TimbreParam::PartialParam *partialParam, Bit32u basePitch);
+	// Precomputes the terms of reset() that only depend on the timbre.
+	static void cachePartialParams(PatchCache &patchCache);
+
+	void reset(const PatchCache *patchCache, Bit32u basePitch);
 	// Returns the base cutoff (without envelope modification).
 	// The base cutoff is calculated when reset() is called and remains static
 	// for the lifetime of the partial.
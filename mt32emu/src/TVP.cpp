@@ -78,30 +78,16 @@ static inline Bit32s fineToPitch(Bit8u fine) {
 	return (fine - 50) * 4096 / 1200; // One cent per fine offset
 }
 
-static Bit32u calcBasePitch(const Partial *partial, const TimbreParam::PartialParam *partialParam, const MemParams::PatchTemp *patchTemp, unsigned int key, const ControlROMFeatureSet *controlROMFeatures) {
+static Bit32u calcBasePitch(const PatchCache *patchCache, const MemParams::PatchTemp *patchTemp, unsigned int key, const ControlROMFeatureSet *controlROMFeatures) {
 	Bit32s basePitch = keyToPitch(key);
-	basePitch = (basePitch * pitchKeyfollowMult[partialParam->wg.pitchKeyfollow]) >> 13; // PORTABILITY NOTE: Assumes arithmetic shift
-	basePitch += coarseToPitch(partialParam->wg.pitchCoarse);
-	basePitch += fineToPitch(partialParam->wg.pitchFine);
+	basePitch = (basePitch * patchCache->tvpPitchKeyfollowMult) >> 13; // PORTABILITY NOTE: Assumes arithmetic shift
+	basePitch += patchCache->tvpPitchOffset;
 	if (controlROMFeatures->quirkKeyShift) {
 		// NOTE:Mok: This is done on MT-32, but not LAPC-I:
 		basePitch += coarseToPitch(patchTemp->patch.keyShift + 12);
 	}
 	basePitch += fineToPitch(patchTemp->patch.fineTune);
 
-	const ControlROMPCMStruct *controlROMPCMStruct = partial->getControlROMPCMStruct();
-	if (controlROMPCMStruct != NULL) {
-		basePitch += (Bit32s(controlROMPCMStruct->pitchMSB) << 8) | Bit32s(controlROMPCMStruct->pitchLSB);
-	} else {
-		if ((partialParam->wg.waveform & 1) == 0) {
-			basePitch += 37133; // This puts Middle C at around 261.64Hz (assuming no other modifications, masterTune of 64, etc.)
-		} else {
-			// Sawtooth waves are effectively double the frequency of square waves.
-			// Thus we add 4096 less than for square waves here, which results in halving the frequency.
-			basePitch += 33037;
-		}
-	}
-
 	// MT-32 GEN0 does 16-bit calculations here, allowing an integer overflow.
 	// This quirk is observable playing the patch defined for timbre "HIT BOTTOM" in Larry 3.
 	// Note, the upper bound isn't checked either.
@@ -141,9 +127,28 @@ static Bit32s calcTargetPitchOffsetWithoutLFO(const TimbreParam::PartialParam *p
 	return targetPitchOffsetWithoutLFO;
 }
 
-void TVP::reset(const Part *usePart, const TimbreParam::PartialParam *usePartialParam) {
+void TVP::cachePartialParams(PatchCache &patchCache, const ControlROMPCMStruct *controlROMPCMStruct) {
+	const TimbreParam::PartialParam &partialParam = patchCache.srcPartial;
+	patchCache.tvpPitchKeyfollowMult = pitchKeyfollowMult[partialParam.wg.pitchKeyfollow];
+	Bit32s pitchOffset = coarseToPitch(partialParam.wg.pitchCoarse);
+	pitchOffset += fineToPitch(partialParam.wg.pitchFine);
+	if (controlROMPCMStruct != NULL) {
+		pitchOffset += (Bit32s(controlROMPCMStruct->pitchMSB) << 8) | Bit32s(controlROMPCMStruct->pitchLSB);
+	} else {
+		if ((partialParam.wg.waveform & 1) == 0) {
+			pitchOffset += 37133; // This puts Middle C at around 261.64Hz (assuming no other modifications, masterTune of 64, etc.)
+		} else {
+			// Sawtooth waves are effectively double the frequency of square waves.
+			// Thus we add 4096 less than for square waves here, which results in halving the frequency.
+			pitchOffset += 33037;
+		}
+	}
+	patchCache.tvpPitchOffset = pitchOffset;
+}
+
+void TVP::reset(const Part *usePart, const PatchCache *patchCache) {
 	part = usePart;
-	partialParam = usePartialParam;
+	partialParam = patchCache->partialParam;
 	patchTemp = part->getPatchTemp();
 
 	unsigned int key = partial->getPoly()->getKey();
@@ -153,7 +158,9 @@ void TVP::reset(const Part *usePart, const TimbreParam::PartialParam *usePartial
 	timeElapsed = 0;
 	processTimerIncrement = 0;
 
-	basePitch = calcBasePitch(partial, partialParam, patchTemp, key, partial->getSynth()->controlROMFeatures);
+	const ControlROMFeatureSet *controlROMFeatures = partial->getSynth()->controlROMFeatures;
+	quirkPitchEnvelopeOverflow = controlROMFeatures->quirkPitchEnvelopeOverflow;
+	basePitch = calcBasePitch(patchCache, patchTemp, key, controlROMFeatures);
 	currentPitchOffset = calcTargetPitchOffsetWithoutLFO(partialParam, 0, velocity);
 	targetPitchOffsetWithoutLFO = currentPitchOffset;
 	phase = 0;
@@ -166,6 +173,8 @@ void TVP::reset(const Part *usePart, const TimbreParam::PartialParam *usePartial
 	lfoPitchOffset = 0;
 	counter = 0;
 	pitch = basePitch;
+	// Seeding happens here as events are always processed sequentially.
+	randomState = partial->getSynth()->isPartialRenderingParallel() ? Bit32u(rand()) : 0;
 
 	// These don't really need to be initialised, but it aids debugging.
 	pitchOffsetChangePerBigTick = 0;
@@ -190,7 +199,7 @@ void TVP::updatePitch() {
 
 	// MT-32 GEN0 does 16-bit calculations here, allowing an integer overflow.
 	// This quirk is exploited e.g. in Colonel's Bequest timbres "Lightning" and "SwmpBackgr".
-	if (partial->getSynth()->controlROMFeatures->quirkPitchEnvelopeOverflow) {
+	if (quirkPitchEnvelopeOverflow) {
 		newPitch = newPitch & 0xffff;
 	} else if (newPitch < 0) {
 		newPitch = 0;
@@ -299,6 +308,13 @@ void TVP::startDecay() {
 	targetPitchOffsetReachedBigTick = timeElapsed >> 8; // FIXME: Afaict there's no good reason for this - check
 }
 
+int TVP::nextRandom() {
+	if (!partial->getSynth()->isPartialRenderingParallel()) return rand();
+	// The state of rand() is shared, so the results would depend on the order the partials are rendered in.
+	randomState = randomState * 1103515245 + 12345;
+	return int(randomState >> 16);
+}
+
 Bit16u TVP::nextPitch() {
 	// We emulate MCU software timer using these counter and processTimerIncrement variables.
 	// The value of nominalProcessTimerPeriod approximates the period in samples
@@ -308,7 +324,7 @@ Bit16u TVP::nextPitch() {
 	if (counter == 0) {
 		timeElapsed = (timeElapsed + processTimerIncrement) & 0x00FFFFFF;
 		// This roughly emulates pitch deviations observed on real units when playing a single partial that uses TVP/LFO.
-		counter = NOMINAL_PROCESS_TIMER_PERIOD_SAMPLES + (rand() & 3);
+		counter = NOMINAL_PROCESS_TIMER_PERIOD_SAMPLES + (nextRandom() & 3);
 		processTimerIncrement = (PROCESS_TIMER_INCREMENT_x8 * counter) >> 3;
 		process();
 	}
@@ -316,6 +332,15 @@ Bit16u TVP::nextPitch() {
 	return pitch;
 }
 
+Bit32u TVP::samplesUntilProcess(Bit32u maxLength) const {
+	return Bit32u(counter) < maxLength ? Bit32u(counter) : maxLength;
+}
+
+Bit16u TVP::advance(Bit32u length) {
+	counter -= int(length);
+	return pitch;
+}
+
 void TVP::process() {
 	if (phase == 0) {
 		targetPitchOffsetReached();
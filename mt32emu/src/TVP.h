@@ -55,6 +55,13 @@ private:
 
 	Bit16u pitch;
 
+	// Copied from the control ROM features upon reset, as the pitch gets updated many times during the life of a partial.
+	bool quirkPitchEnvelopeOverflow;
+
+	// State of the private pseudo-random generator used instead of rand() while partials are rendered concurrently
+	Bit32u randomState;
+
+	int nextRandom();
 	void updatePitch();
 	void setupPitchChange(int targetPitchOffset, Bit8u changeDuration);
 	void targetPitchOffsetReached();
@@ -62,9 +69,17 @@ private:
 	void process();
 public:
 	TVP(const Partial *partial);
-	void reset(const Part *part, const TimbreParam::PartialParam *partialParam);
+	// Precomputes the terms of reset() that only depend on the timbre and the PCM wave it selects (NULL for synth waves).
+	static void cachePartialParams(PatchCache &patchCache, const ControlROMPCMStruct *controlROMPCMStruct);
+
+	void reset(const Part *part, const PatchCache *patchCache);
 	Bit32u getBasePitch() const;
 	Bit16u nextPitch();
+	// Returns the number of samples, up to maxLength, which precede the one where the pitch envelope is processed next.
+	Bit32u samplesUntilProcess(Bit32u maxLength) const;
+	// Has the same effect as length calls of nextPitch(), as long as they don't get to the processing of the envelope.
+	// Returns the pitch, which stays constant in the meantime.
+	Bit16u advance(Bit32u length);
 	void startDecay();
 }; // class TVP
 
@@ -23,14 +23,13 @@
 
 namespace MT32Emu {
 
+// All the tables are precomputed and hence stored as read-only data that needs no initialisation at runtime.
+// The formulas the tables are built with are given next to the values in Tables.cpp.
 class Tables {
-private:
-	Tables();
-	Tables(Tables &);
-	~Tables() {}
-
 public:
-	static const Tables &getInstance();
+	static const Tables &getInstance() {
+		return instance;
+	}
 
 	// Constant LUTs
 
@@ -53,8 +52,12 @@ public:
 
 	Bit16u exp9[512];
 	Bit16u logsin9[512];
+	Bit16u interpolatedExp[4096];
 
-	const Bit8u *resAmpDecayFactor;
+	Bit8u resAmpDecayFactor[8];
+
+private:
+	static const Tables instance;
 }; // class Tables
 
 } // namespace MT32Emu
@@ -0,0 +1,54 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MT32EMU_TRACE_SPAN_H
+#define MT32EMU_TRACE_SPAN_H
+
+#include "globals.h"
+#include "Types.h"
+#include "MonotonicClock.h"
+#include "Synth.h"
+
+namespace MT32Emu {
+
+// Measures a span of work that lasts till the end of the scope and reports it to the TraceSink, unless it is NULL.
+class TraceSpan {
+public:
+	TraceSpan(TraceSink *useTraceSink, TraceSink::SpanKind useKind, Bit32u useArg) :
+		traceSink(useTraceSink),
+		kind(useKind),
+		arg(useArg),
+		startTime(useTraceSink == NULL ? 0.0 : getMonotonicClockNanos())
+	{}
+
+	~TraceSpan() {
+		if (traceSink != NULL) traceSink->onSpanCompleted(kind, getMonotonicClockNanos() - startTime, arg);
+	}
+
+private:
+	TraceSink * const traceSink;
+	const TraceSink::SpanKind kind;
+	const Bit32u arg;
+	const double startTime;
+
+	TraceSpan(const TraceSpan &);            // prevent copy-construction
+	TraceSpan &operator=(const TraceSpan &); // prevent assignment
+}; // class TraceSpan
+
+} // namespace MT32Emu
+
+#endif // #ifndef MT32EMU_TRACE_SPAN_H
@@ -20,11 +20,16 @@
 #include "../globals.h"
 #include "../Types.h"
 #include "../File.h"
+#if MT32EMU_WITH_FILE_STREAMS
 #include "../FileStream.h"
+#include "../MappedFileStream.h"
+#endif
+#include "../MemoryFence.h"
 #include "../ROMInfo.h"
 #include "../Synth.h"
 #include "../MidiStreamParser.h"
 #include "../SampleRateConverter.h"
+#include "../SynthGroup.h"
 
 #include "c_types.h"
 #include "c_interface.h"
@@ -33,6 +38,8 @@ using namespace MT32Emu;
 
 namespace MT32Emu {
 
+class QueueingReportHandler;
+
 struct SamplerateConversionState {
 	double outputSampleRate;
 	SamplerateConversionQuality srcQuality;
@@ -43,7 +50,7 @@ static mt32emu_service_version getSynthVersionID(mt32emu_service_i) {
 	return MT32EMU_SERVICE_VERSION_CURRENT;
 }
 
-static const mt32emu_service_i_v4 SERVICE_VTABLE = {
+static const mt32emu_service_i_v6 SERVICE_VTABLE = {
 	getSynthVersionID,
 	mt32emu_get_supported_report_handler_version,
 	mt32emu_get_supported_midi_receiver_version,
@@ -127,22 +134,94 @@ static const mt32emu_service_i_v4 SERVICE_VTABLE = {
 	mt32emu_identify_rom_file,
 	mt32emu_merge_and_add_rom_data,
 	mt32emu_merge_and_add_rom_files,
-	mt32emu_add_machine_rom_file
+	mt32emu_add_machine_rom_file,
+	mt32emu_set_render_profiling_enabled,
+	mt32emu_is_render_profiling_enabled,
+	mt32emu_get_render_profile,
+	mt32emu_reset_render_profile,
+	mt32emu_render_float_planar,
+	mt32emu_get_samplerate_conversion_latency,
+	mt32emu_skip_silence,
+	mt32emu_play_events,
+	mt32emu_flush_deferred_debug_messages,
+	mt32emu_create_synth_group,
+	mt32emu_free_synth_group,
+	mt32emu_add_to_synth_group,
+	mt32emu_render_synth_group_bit16s,
+	mt32emu_render_synth_group_float,
+	mt32emu_render_synth_group_outputs_bit16s,
+	mt32emu_render_synth_group_outputs_float,
+	mt32emu_render_bit16s_with_events,
+	mt32emu_render_float_with_events,
+	mt32emu_render_float_planar_with_events,
+	mt32emu_set_midi_event_queue_max_size,
+	mt32emu_get_midi_event_queue_max_size,
+	mt32emu_get_midi_event_queue_stats,
+	mt32emu_reset_midi_event_queue_stats,
+	mt32emu_get_memory_usage,
+	mt32emu_set_reduced_memory_footprint_enabled,
+	mt32emu_is_reduced_memory_footprint_enabled,
+	mt32emu_get_supported_cpu_features,
+	mt32emu_set_enabled_cpu_features,
+	mt32emu_get_enabled_cpu_features,
+	mt32emu_get_kernel_variant,
+	mt32emu_get_polyphony_stats,
+	mt32emu_reset_polyphony_stats,
+	mt32emu_get_output_latency,
+	mt32emu_render_bit16s_part_streams,
+	mt32emu_render_float_part_streams,
+	mt32emu_set_output_dither_enabled,
+	mt32emu_is_output_dither_enabled,
+	mt32emu_set_partial_culling_threshold,
+	mt32emu_get_partial_culling_threshold,
+	mt32emu_set_memory_locking_enabled,
+	mt32emu_is_memory_locking_enabled,
+	mt32emu_set_reverb_preparation_deferred,
+	mt32emu_is_reverb_preparation_deferred,
+	mt32emu_prepare_reverb_models,
+	mt32emu_reinitialise_synth,
+	mt32emu_set_overload_governor_enabled,
+	mt32emu_is_overload_governor_enabled,
+	mt32emu_set_overload_governor_render_budget,
+	mt32emu_get_overload_governor_render_budget,
+	mt32emu_get_overload_governor_level,
+	mt32emu_set_numa_node,
+	mt32emu_get_numa_node,
+	mt32emu_get_sample_clock,
+	mt32emu_play_msg_at_sample_clock,
+	mt32emu_play_sysex_at_sample_clock,
+	mt32emu_set_report_queueing,
+	mt32emu_get_report_queueing_mode,
+	mt32emu_read_queued_reports,
+	mt32emu_deliver_queued_reports,
+	mt32emu_set_rhythm_hit_cache_enabled,
+	mt32emu_is_rhythm_hit_cache_enabled
 };
 
 } // namespace MT32Emu
 
 struct mt32emu_data {
 	ReportHandler *reportHandler;
+	// Stands in front of the reportHandler, so that the reports can be queued.
+	QueueingReportHandler *queueingReportHandler;
 	Synth *synth;
 	const ROMImage *controlROMImage;
 	const ROMImage *pcmROMImage;
+	// The PCM ROM image the synth is opened with. The synth uses the samples it contains until closed,
+	// so the image is kept alive even if replaced in the context meanwhile.
+	mutable const ROMImage *openedPCMROMImage;
 	DefaultMidiStreamParser *midiParser;
 	Bit32u partialCount;
 	AnalogOutputMode analogOutputMode;
 	SamplerateConversionState *srcState;
 };
 
+struct mt32emu_synth_group_data {
+	SynthGroup synthGroup;
+
+	explicit mt32emu_synth_group_data(Bit32u outputCount) : synthGroup(outputCount) {}
+};
+
 // Internal C++ utility stuff
 
 namespace MT32Emu {
@@ -269,6 +348,252 @@ private:
 	}
 };
 
+// Keeps the reports in a ring buffer while queueing is enabled, otherwise passes them to the target report handler.
+// The reports are queued by the thread that drives the synth, and may be retrieved by another thread meanwhile.
+class QueueingReportHandler : public ReportHandler {
+public:
+	explicit QueueingReportHandler(ReportHandler &useTarget) :
+		target(useTarget), mode(MT32EMU_RQM_DISABLED), reports(NULL), capacity(0), writeIx(0), readIx(0)
+	{}
+
+	~QueueingReportHandler() {
+		delete[] reports;
+	}
+
+	void setQueueing(mt32emu_report_queueing_mode newMode, Bit32u newCapacity) {
+		deliverQueuedReports();
+		delete[] reports;
+		reports = NULL;
+		capacity = 0;
+		if (newMode != MT32EMU_RQM_DISABLED) {
+			// The indices run freely and wrap around at 2^32, so the slots are addressed by masking them.
+			const Bit32u requestedCapacity = newCapacity > 0 ? newCapacity : DEFAULT_CAPACITY;
+			capacity = 1;
+			while (capacity < requestedCapacity && capacity < MAX_CAPACITY) capacity <<= 1;
+			reports = new mt32emu_report[capacity];
+		}
+		writeIx = 0;
+		readIx = 0;
+		mode = newMode;
+	}
+
+	mt32emu_report_queueing_mode getQueueingMode() const {
+		return mode;
+	}
+
+	Bit32u readQueuedReports(mt32emu_report *buffer, Bit32u maxCount) {
+		const Bit32u endIx = writeIx;
+		memoryFence();
+		Bit32u ix = readIx;
+		Bit32u count = 0;
+		for (; ix != endIx && count < maxCount; ix++) {
+			buffer[count++] = reports[ix & (capacity - 1)];
+		}
+		memoryFence();
+		readIx = ix;
+		return count;
+	}
+
+	Bit32u deliverQueuedReports() {
+		Bit32u deliveredCount = 0;
+		mt32emu_report report;
+		while (readQueuedReports(&report, 1) > 0) {
+			deliver(report);
+			deliveredCount++;
+		}
+		return deliveredCount;
+	}
+
+private:
+	static const Bit32u DEFAULT_CAPACITY = 1024;
+	static const Bit32u MAX_CAPACITY = 0x80000000;
+
+	ReportHandler &target;
+	mt32emu_report_queueing_mode mode;
+	mt32emu_report *reports;
+	Bit32u capacity;
+	volatile Bit32u writeIx;
+	volatile Bit32u readIx;
+
+	static void printDebugTo(ReportHandler &reportHandler, const char *fmt, ...) {
+		va_list ap;
+		va_start(ap, fmt);
+		reportHandler.printDebug(fmt, ap);
+		va_end(ap);
+	}
+
+	static void copyText(char *text, size_t size, const char *source) {
+		text[0] = 0;
+		if (source != NULL) strncat(text, source, size - 1);
+	}
+
+	static mt32emu_report makeReport(mt32emu_report_type type, Bit8u value) {
+		mt32emu_report report;
+		memset(&report, 0, sizeof report);
+		report.type = type;
+		report.value = value;
+		return report;
+	}
+
+	bool isQueueing() const {
+		return mode != MT32EMU_RQM_DISABLED;
+	}
+
+	void queueReport(const mt32emu_report &report) {
+		const Bit32u queuedCount = writeIx - readIx;
+		if (queuedCount >= capacity) return;
+		// Make sure the entry is no longer being read.
+		memoryFence();
+		mt32emu_report &entry = reports[writeIx & (capacity - 1)];
+		if (queuedCount < capacity - 1) {
+			entry = report;
+		} else {
+			entry = makeReport(MT32EMU_REPORT_QUEUE_OVERFLOW, 0);
+		}
+		memoryFence();
+		writeIx = writeIx + 1;
+	}
+
+	void deliver(const mt32emu_report &report) {
+		switch (report.type) {
+		case MT32EMU_REPORT_LCD_MESSAGE:
+			target.showLCDMessage(report.lcdMessage);
+			break;
+		case MT32EMU_REPORT_MIDI_MESSAGE_PLAYED:
+			target.onMIDIMessagePlayed();
+			break;
+		case MT32EMU_REPORT_DEVICE_RESET:
+			target.onDeviceReset();
+			break;
+		case MT32EMU_REPORT_DEVICE_RECONFIG:
+			target.onDeviceReconfig();
+			break;
+		case MT32EMU_REPORT_NEW_REVERB_MODE:
+			target.onNewReverbMode(report.value);
+			break;
+		case MT32EMU_REPORT_NEW_REVERB_TIME:
+			target.onNewReverbTime(report.value);
+			break;
+		case MT32EMU_REPORT_NEW_REVERB_LEVEL:
+			target.onNewReverbLevel(report.value);
+			break;
+		case MT32EMU_REPORT_POLY_STATE_CHANGED:
+			target.onPolyStateChanged(report.value);
+			break;
+		case MT32EMU_REPORT_PROGRAM_CHANGED:
+			target.onProgramChanged(report.value, report.soundGroupName[0] == 0 ? NULL : report.soundGroupName, report.patchName);
+			break;
+		case MT32EMU_REPORT_QUEUE_OVERFLOW:
+			printDebugTo(target, "Report queue overflow, some reports were lost");
+			break;
+		}
+	}
+
+	void printDebug(const char *fmt, va_list list) {
+		target.printDebug(fmt, list);
+	}
+
+	void onErrorControlROM() {
+		target.onErrorControlROM();
+	}
+
+	void onErrorPCMROM() {
+		target.onErrorPCMROM();
+	}
+
+	void showLCDMessage(const char *message) {
+		if (!isQueueing()) {
+			target.showLCDMessage(message);
+			return;
+		}
+		mt32emu_report report = makeReport(MT32EMU_REPORT_LCD_MESSAGE, 0);
+		copyText(report.lcdMessage, sizeof report.lcdMessage, message);
+		queueReport(report);
+	}
+
+	void onMIDIMessagePlayed() {
+		if (isQueueing()) {
+			queueReport(makeReport(MT32EMU_REPORT_MIDI_MESSAGE_PLAYED, 0));
+		} else {
+			target.onMIDIMessagePlayed();
+		}
+	}
+
+	bool onMIDIQueueOverflow() {
+		return target.onMIDIQueueOverflow();
+	}
+
+	void onMIDISystemRealtime(Bit8u systemRealtime) {
+		target.onMIDISystemRealtime(systemRealtime);
+	}
+
+	void onDeviceReset() {
+		if (isQueueing()) {
+			queueReport(makeReport(MT32EMU_REPORT_DEVICE_RESET, 0));
+		} else {
+			target.onDeviceReset();
+		}
+	}
+
+	void onDeviceReconfig() {
+		if (isQueueing()) {
+			queueReport(makeReport(MT32EMU_REPORT_DEVICE_RECONFIG, 0));
+		} else {
+			target.onDeviceReconfig();
+		}
+	}
+
+	void onNewReverbMode(Bit8u reverbMode) {
+		if (isQueueing()) {
+			queueReport(makeReport(MT32EMU_REPORT_NEW_REVERB_MODE, reverbMode));
+		} else {
+			target.onNewReverbMode(reverbMode);
+		}
+	}
+
+	void onNewReverbTime(Bit8u time) {
+		if (isQueueing()) {
+			queueReport(makeReport(MT32EMU_REPORT_NEW_REVERB_TIME, time));
+		} else {
+			target.onNewReverbTime(time);
+		}
+	}
+
+	void onNewReverbLevel(Bit8u level) {
+		if (isQueueing()) {
+			queueReport(makeReport(MT32EMU_REPORT_NEW_REVERB_LEVEL, level));
+		} else {
+			target.onNewReverbLevel(level);
+		}
+	}
+
+	void onPolyStateChanged(Bit8u partNum) {
+		if (isQueueing()) {
+			queueReport(makeReport(MT32EMU_REPORT_POLY_STATE_CHANGED, partNum));
+		} else {
+			target.onPolyStateChanged(partNum);
+		}
+	}
+
+	void onProgramChanged(Bit8u partNum, const char *soundGroupName, const char *patchName) {
+		if (!isQueueing()) {
+			target.onProgramChanged(partNum, soundGroupName, patchName);
+			return;
+		}
+		mt32emu_report report = makeReport(MT32EMU_REPORT_PROGRAM_CHANGED, partNum);
+		copyText(report.soundGroupName, sizeof report.soundGroupName, soundGroupName);
+		copyText(report.patchName, sizeof report.patchName, patchName);
+		queueReport(report);
+	}
+};
+
+// Delivers the reports queued while rendering if requested, after the rendering function has done its work.
+static void reportsRendered(mt32emu_const_context context) {
+	if (context->queueingReportHandler->getQueueingMode() == MT32EMU_RQM_DELIVER_AFTER_RENDERING) {
+		context->queueingReportHandler->deliverQueuedReports();
+	}
+}
+
 class DelegatingMidiStreamParser : public DefaultMidiStreamParser {
 public:
 	DelegatingMidiStreamParser(const mt32emu_data *useData, mt32emu_midi_receiver_i useMIDIReceiver, void *useInstanceData) :
@@ -304,6 +629,48 @@ private:
 	}
 };
 
+// Renders a context added to a synth group, with the sample rate conversion the context is configured with.
+class ContextSource : public SynthGroup::Source {
+public:
+	explicit ContextSource(mt32emu_const_context useContext) : context(useContext) {}
+
+	void render(Bit16s *stream, Bit32u len) {
+		mt32emu_render_bit16s(context, stream, len);
+	}
+
+	void render(float *stream, Bit32u len) {
+		mt32emu_render_float(context, stream, len);
+	}
+
+private:
+	const mt32emu_const_context context;
+};
+
+// Enqueues the events with the timestamps given as offsets at the output sample rate, relative to the current position,
+// for the sample rate converter to render. The events are converted in small batches on the stack, so that rendering
+// with events never allocates memory.
+static Bit32u playEventsAtOffsets(mt32emu_const_context context, const mt32emu_midi_event *events, Bit32u count) {
+	static const Bit32u EVENT_BATCH_SIZE = 64;
+	if (!context->synth->isOpen()) return 0;
+	const Bit32u baseTimestamp = context->synth->getInternalRenderedSampleCount();
+	MIDIEvent batch[EVENT_BATCH_SIZE];
+	Bit32u playedCount = 0;
+	while (playedCount < count) {
+		const Bit32u batchSize = count - playedCount < EVENT_BATCH_SIZE ? count - playedCount : EVENT_BATCH_SIZE;
+		for (Bit32u eventIx = 0; eventIx < batchSize; eventIx++) {
+			const mt32emu_midi_event &event = events[playedCount + eventIx];
+			batch[eventIx].sysex = event.sysex;
+			batch[eventIx].sysexLength = event.sysexLength;
+			batch[eventIx].msg = event.msg;
+			batch[eventIx].timestamp = baseTimestamp + mt32emu_convert_output_to_synth_timestamp(context, event.timestamp);
+		}
+		const Bit32u batchPlayedCount = context->synth->playEvents(batch, batchSize);
+		playedCount += batchPlayedCount;
+		if (batchPlayedCount < batchSize) break;
+	}
+	return playedCount;
+}
+
 static void fillROMInfo(mt32emu_rom_info *rom_info, const ROMInfo *controlROMInfo, const ROMInfo *pcmROMInfo) {
 	if (controlROMInfo != NULL) {
 		rom_info->control_rom_id = controlROMInfo->shortName;
@@ -365,15 +732,26 @@ static bool isROMInfoCompatible(const MachineConfiguration *machineConfiguration
 	return false;
 }
 
-static mt32emu_return_code replaceOrMergeROMImage(const ROMImage *&contextROMImage, const ROMImage *newROMImage, const MachineConfiguration *machineConfiguration, mt32emu_return_code addedFullROM, mt32emu_return_code addedPartialROM) {
+static void freeContextROMImage(const mt32emu_data *data, const ROMImage *romImage) {
+	if (romImage == data->openedPCMROMImage) return;
+	if (romImage->isFileUserProvided()) delete romImage->getFile();
+	ROMImage::freeROMImage(romImage);
+}
+
+static void releaseOpenedPCMROMImage(const mt32emu_data *data) {
+	const ROMImage *romImage = data->openedPCMROMImage;
+	data->openedPCMROMImage = NULL;
+	if (romImage != NULL && romImage != data->pcmROMImage) freeContextROMImage(data, romImage);
+}
+
+static mt32emu_return_code replaceOrMergeROMImage(const mt32emu_data *data, const ROMImage *&contextROMImage, const ROMImage *newROMImage, const MachineConfiguration *machineConfiguration, mt32emu_return_code addedFullROM, mt32emu_return_code addedPartialROM) {
 	if (contextROMImage != NULL) {
 		if (machineConfiguration != NULL) {
 			const ROMImage *mergedROMImage = ROMImage::mergeROMImages(contextROMImage, newROMImage);
 			if (mergedROMImage != NULL) {
 				if (newROMImage->isFileUserProvided()) delete newROMImage->getFile();
 				ROMImage::freeROMImage(newROMImage);
-				if (contextROMImage->isFileUserProvided()) delete contextROMImage->getFile();
-				ROMImage::freeROMImage(contextROMImage);
+				freeContextROMImage(data, contextROMImage);
 				contextROMImage = mergedROMImage;
 				return addedFullROM;
 			}
@@ -384,8 +762,7 @@ static mt32emu_return_code replaceOrMergeROMImage(const ROMImage *&contextROMIma
 				return MT32EMU_RC_OK;
 			}
 		}
-		if (contextROMImage->isFileUserProvided()) delete contextROMImage->getFile();
-		ROMImage::freeROMImage(contextROMImage);
+		freeContextROMImage(data, contextROMImage);
 	}
 	contextROMImage = newROMImage;
 	return newROMImage->getROMInfo()->pairType == ROMInfo::Full ? addedFullROM: addedPartialROM;
@@ -406,28 +783,43 @@ static mt32emu_return_code addROMFiles(mt32emu_data *data, File *file1, File *fi
 	}
 	switch (info->type) {
 	case ROMInfo::Control:
-		return replaceOrMergeROMImage(data->controlROMImage, romImage, machineConfiguration, MT32EMU_RC_ADDED_CONTROL_ROM, MT32EMU_RC_ADDED_PARTIAL_CONTROL_ROM);
+		return replaceOrMergeROMImage(data, data->controlROMImage, romImage, machineConfiguration, MT32EMU_RC_ADDED_CONTROL_ROM, MT32EMU_RC_ADDED_PARTIAL_CONTROL_ROM);
 	case ROMInfo::PCM:
-		return replaceOrMergeROMImage(data->pcmROMImage, romImage, machineConfiguration, MT32EMU_RC_ADDED_PCM_ROM, MT32EMU_RC_ADDED_PARTIAL_PCM_ROM);
+		return replaceOrMergeROMImage(data, data->pcmROMImage, romImage, machineConfiguration, MT32EMU_RC_ADDED_PCM_ROM, MT32EMU_RC_ADDED_PARTIAL_PCM_ROM);
 	default:
 		ROMImage::freeROMImage(romImage);
 		return MT32EMU_RC_OK; // No support for reverb ROM yet.
 	}
 }
 
-static mt32emu_return_code createFileStream(const char *filename, FileStream *&fileStream) {
+// Prefers mapping the file into memory, so that the ROM data is shared via the page cache with other processes.
+static mt32emu_return_code createFileStream(const char *filename, File *&file) {
+#if MT32EMU_WITH_FILE_STREAMS
+	MappedFileStream *mappedFileStream = new MappedFileStream;
+	if (mappedFileStream->open(filename) && mappedFileStream->getData() != NULL) {
+		file = mappedFileStream;
+		return MT32EMU_RC_OK;
+	}
+	delete mappedFileStream;
+
 	mt32emu_return_code rc;
-	fileStream = new FileStream;
+	FileStream *fileStream = new FileStream;
 	if (!fileStream->open(filename)) {
 		rc = MT32EMU_RC_FILE_NOT_FOUND;
 	} else if (fileStream->getData() == NULL) {
 		rc = MT32EMU_RC_FILE_NOT_LOADED;
 	} else {
+		file = fileStream;
 		return MT32EMU_RC_OK;
 	}
 	delete fileStream;
-	fileStream = NULL;
+	file = NULL;
 	return rc;
+#else
+	(void)filename;
+	file = NULL;
+	return MT32EMU_RC_FILE_NOT_FOUND;
+#endif
 }
 
 } // namespace MT32Emu
@@ -438,7 +830,7 @@ extern "C" {
 
 mt32emu_service_i mt32emu_get_service_i() {
 	mt32emu_service_i i;
-	i.v4 = &SERVICE_VTABLE;
+	i.v6 = &SERVICE_VTABLE;
 	return i;
 }
 
@@ -505,7 +897,7 @@ mt32emu_return_code mt32emu_identify_rom_data(mt32emu_rom_info *rom_info, const
 }
 
 mt32emu_return_code mt32emu_identify_rom_file(mt32emu_rom_info *rom_info, const char *filename, const char *machine_id) {
-	FileStream *fs;
+	File *fs;
 	mt32emu_return_code rc = createFileStream(filename, fs);
 	if (fs == NULL) return rc;
 	rc = identifyROM(rom_info, fs, machine_id);
@@ -516,10 +908,12 @@ mt32emu_return_code mt32emu_identify_rom_file(mt32emu_rom_info *rom_info, const
 mt32emu_context mt32emu_create_context(mt32emu_report_handler_i report_handler, void *instance_data) {
 	mt32emu_data *data = new mt32emu_data;
 	data->reportHandler = (report_handler.v0 != NULL) ? new DelegatingReportHandlerAdapter(report_handler, instance_data) : new ReportHandler;
-	data->synth = new Synth(data->reportHandler);
+	data->queueingReportHandler = new QueueingReportHandler(*data->reportHandler);
+	data->synth = new Synth(data->queueingReportHandler);
 	data->midiParser = new DefaultMidiStreamParser(*data->synth);
 	data->controlROMImage = NULL;
 	data->pcmROMImage = NULL;
+	data->openedPCMROMImage = NULL;
 	data->partialCount = DEFAULT_MAX_PARTIALS;
 	data->analogOutputMode = AnalogOutputMode_COARSE;
 
@@ -539,6 +933,7 @@ void mt32emu_free_context(mt32emu_context data) {
 	delete data->srcState;
 	data->srcState = NULL;
 
+	releaseOpenedPCMROMImage(data);
 	if (data->controlROMImage != NULL) {
 		if (data->controlROMImage->isFileUserProvided()) delete data->controlROMImage->getFile();
 		ROMImage::freeROMImage(data->controlROMImage);
@@ -553,6 +948,8 @@ void mt32emu_free_context(mt32emu_context data) {
 	data->midiParser = NULL;
 	delete data->synth;
 	data->synth = NULL;
+	delete data->queueingReportHandler;
+	data->queueingReportHandler = NULL;
 	delete data->reportHandler;
 	data->reportHandler = NULL;
 	delete data;
@@ -564,7 +961,7 @@ mt32emu_return_code mt32emu_add_rom_data(mt32emu_context context, const mt32emu_
 }
 
 mt32emu_return_code mt32emu_add_rom_file(mt32emu_context context, const char *filename) {
-	FileStream *fs;
+	File *fs;
 	mt32emu_return_code rc = createFileStream(filename, fs);
 	if (fs != NULL) rc = addROMFiles(context, fs);
 	if (rc <= MT32EMU_RC_OK) delete fs;
@@ -581,10 +978,10 @@ mt32emu_return_code mt32emu_merge_and_add_rom_data(mt32emu_context context, cons
 }
 
 mt32emu_return_code mt32emu_merge_and_add_rom_files(mt32emu_context context, const char *part1_filename, const char *part2_filename) {
-	FileStream *fs1;
+	File *fs1;
 	mt32emu_return_code rc = createFileStream(part1_filename, fs1);
 	if (fs1 != NULL) {
-		FileStream *fs2;
+		File *fs2;
 		rc = createFileStream(part2_filename, fs2);
 		if (fs2 != NULL) {
 			rc = addROMFiles(context, fs1, fs2);
@@ -599,7 +996,7 @@ mt32emu_return_code mt32emu_add_machine_rom_file(mt32emu_context context, const
 	const MachineConfiguration *machineConfiguration = findMachineConfiguration(machine_id);
 	if (machineConfiguration == NULL) return MT32EMU_RC_MACHINE_NOT_IDENTIFIED;
 
-	FileStream *fs;
+	File *fs;
 	mt32emu_return_code rc = createFileStream(filename, fs);
 	if (fs == NULL) return rc;
 	rc = addROMFiles(context, fs, NULL, machineConfiguration);
@@ -637,6 +1034,22 @@ mt32emu_renderer_type mt32emu_get_selected_renderer_type(mt32emu_context context
 	return static_cast<mt32emu_renderer_type>(context->synth->getSelectedRendererType());
 }
 
+mt32emu_bit32u mt32emu_get_supported_cpu_features() {
+	return Synth::getSupportedCPUFeatures();
+}
+
+void mt32emu_set_enabled_cpu_features(mt32emu_context context, mt32emu_bit32u cpu_features) {
+	context->synth->setEnabledCPUFeatures(cpu_features);
+}
+
+mt32emu_bit32u mt32emu_get_enabled_cpu_features(mt32emu_context context) {
+	return context->synth->getEnabledCPUFeatures();
+}
+
+mt32emu_boolean mt32emu_get_kernel_variant(mt32emu_const_context context, mt32emu_bit32u kernel_index, const char **kernel_name, const char **variant_name) {
+	return context->synth->getKernelVariant(kernel_index, *kernel_name, *variant_name) ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE;
+}
+
 mt32emu_return_code mt32emu_open_synth(mt32emu_const_context context) {
 	if ((context->controlROMImage == NULL) || (context->pcmROMImage == NULL)) {
 		return MT32EMU_RC_MISSING_ROMS;
@@ -644,6 +1057,7 @@ mt32emu_return_code mt32emu_open_synth(mt32emu_const_context context) {
 	if (!context->synth->open(*context->controlROMImage, *context->pcmROMImage, context->partialCount, context->analogOutputMode)) {
 		return MT32EMU_RC_FAILED;
 	}
+	context->openedPCMROMImage = context->pcmROMImage;
 	SamplerateConversionState &srcState = *context->srcState;
 	const double outputSampleRate = (0.0 < srcState.outputSampleRate) ? srcState.outputSampleRate : context->synth->getStereoOutputSampleRate();
 	srcState.src = new SampleRateConverter(*context->synth, outputSampleRate, srcState.srcQuality);
@@ -652,10 +1066,23 @@ mt32emu_return_code mt32emu_open_synth(mt32emu_const_context context) {
 
 void mt32emu_close_synth(mt32emu_const_context context) {
 	context->synth->close();
+	releaseOpenedPCMROMImage(context);
 	delete context->srcState->src;
 	context->srcState->src = NULL;
 }
 
+mt32emu_return_code mt32emu_reinitialise_synth(mt32emu_const_context context) {
+	if (!context->synth->reinitialise(context->analogOutputMode)) {
+		return MT32EMU_RC_FAILED;
+	}
+	// The output sample rate of the synth follows the analog output mode.
+	SamplerateConversionState &srcState = *context->srcState;
+	delete srcState.src;
+	const double outputSampleRate = (0.0 < srcState.outputSampleRate) ? srcState.outputSampleRate : context->synth->getStereoOutputSampleRate();
+	srcState.src = new SampleRateConverter(*context->synth, outputSampleRate, srcState.srcQuality);
+	return MT32EMU_RC_OK;
+}
+
 mt32emu_boolean mt32emu_is_open(mt32emu_const_context context) {
 	return context->synth->isOpen() ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE;
 }
@@ -681,6 +1108,23 @@ mt32emu_bit32u mt32emu_convert_synth_to_output_timestamp(mt32emu_const_context c
 	return mt32emu_bit32u(0.5 + context->srcState->src->convertSynthToOutputTimestamp(synth_timestamp));
 }
 
+double mt32emu_get_samplerate_conversion_latency(mt32emu_const_context context) {
+	if (context->srcState->src == NULL) {
+		return 0.0;
+	}
+	return context->srcState->src->getLatency();
+}
+
+double mt32emu_get_output_latency(mt32emu_const_context context) {
+	const double synthLatency = context->synth->getOutputLatencyFrames();
+	if (context->srcState->src == NULL) {
+		return synthLatency;
+	}
+	const double latency = synthLatency * context->srcState->outputSampleRate / context->synth->getStereoOutputSampleRate();
+	const double conversionLatency = context->srcState->src->getLatency();
+	return conversionLatency < 0.0 ? latency : latency + conversionLatency;
+}
+
 void mt32emu_flush_midi_queue(mt32emu_const_context context) {
 	context->synth->flushMIDIQueue();
 }
@@ -693,11 +1137,71 @@ void mt32emu_configure_midi_event_queue_sysex_storage(mt32emu_const_context cont
 	return context->synth->configureMIDIEventQueueSysexStorage(storage_buffer_size);
 }
 
+mt32emu_bit32u mt32emu_set_midi_event_queue_max_size(mt32emu_const_context context, const mt32emu_bit32u max_queue_size) {
+	return context->synth->setMIDIEventQueueMaxSize(max_queue_size);
+}
+
+mt32emu_bit32u mt32emu_get_midi_event_queue_max_size(mt32emu_const_context context) {
+	return context->synth->getMIDIEventQueueMaxSize();
+}
+
+mt32emu_boolean mt32emu_get_midi_event_queue_stats(mt32emu_const_context context, mt32emu_midi_event_queue_stats *stats) {
+	MIDIEventQueueStats queueStats;
+	if (!context->synth->getMIDIEventQueueStats(0, queueStats)) return MT32EMU_BOOL_FALSE;
+	stats->queueSize = queueStats.queueSize;
+	stats->pendingEventCount = queueStats.pendingEventCount;
+	stats->maxPendingEventCount = queueStats.maxPendingEventCount;
+	stats->overflowCount = queueStats.overflowCount;
+	stats->growCount = queueStats.growCount;
+	stats->sysexStorageSize = queueStats.sysexStorageSize;
+	stats->sysexStorageUsage = queueStats.sysexStorageUsage;
+	stats->maxSysexStorageUsage = queueStats.maxSysexStorageUsage;
+	return MT32EMU_BOOL_TRUE;
+}
+
+void mt32emu_reset_midi_event_queue_stats(mt32emu_const_context context) {
+	context->synth->resetMIDIEventQueueStats(0);
+}
+
+mt32emu_boolean mt32emu_get_memory_usage(mt32emu_const_context context, mt32emu_memory_usage *usage) {
+	SynthMemoryUsage synthUsage;
+	const bool open = context->synth->getMemoryUsage(synthUsage);
+	usage->stateSize = synthUsage.stateSize;
+	usage->controlROMSize = synthUsage.controlROMSize;
+	usage->pcmWavesSize = synthUsage.pcmWavesSize;
+	usage->sharedPCMROMSize = synthUsage.sharedPCMROMSize;
+	usage->sharedROMDataSize = synthUsage.sharedROMDataSize;
+	usage->sharedWavetablesSize = synthUsage.sharedWavetablesSize;
+	usage->reverbSize = synthUsage.reverbSize;
+	usage->midiEventQueuesSize = synthUsage.midiEventQueuesSize;
+	usage->partialsSize = synthUsage.partialsSize;
+	usage->rendererSize = synthUsage.rendererSize;
+	usage->sampleRateConverterSize = context->srcState->src == NULL ? 0 : context->srcState->src->getMemoryUsage();
+	usage->totalSize = synthUsage.totalSize + usage->sampleRateConverterSize;
+	return open ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE;
+}
+
 void mt32emu_set_midi_receiver(mt32emu_context context, mt32emu_midi_receiver_i midi_receiver, void *instance_data) {
 	delete context->midiParser;
 	context->midiParser = (midi_receiver.v0 != NULL) ? new DelegatingMidiStreamParser(context, midi_receiver, instance_data) : new DefaultMidiStreamParser(*context->synth);
 }
 
+void mt32emu_set_report_queueing(mt32emu_const_context context, const mt32emu_report_queueing_mode mode, const mt32emu_bit32u capacity) {
+	context->queueingReportHandler->setQueueing(mode, capacity);
+}
+
+mt32emu_report_queueing_mode mt32emu_get_report_queueing_mode(mt32emu_const_context context) {
+	return context->queueingReportHandler->getQueueingMode();
+}
+
+mt32emu_bit32u mt32emu_read_queued_reports(mt32emu_const_context context, mt32emu_report *reports, mt32emu_bit32u max_count) {
+	return context->queueingReportHandler->readQueuedReports(reports, max_count);
+}
+
+mt32emu_bit32u mt32emu_deliver_queued_reports(mt32emu_const_context context) {
+	return context->queueingReportHandler->deliverQueuedReports();
+}
+
 mt32emu_bit32u mt32emu_get_internal_rendered_sample_count(mt32emu_const_context context) {
 	return context->synth->getInternalRenderedSampleCount();
 }
@@ -742,6 +1246,28 @@ mt32emu_return_code mt32emu_play_sysex_at(mt32emu_const_context context, const m
 	return (context->synth->playSysex(sysex, len, timestamp)) ? MT32EMU_RC_OK : MT32EMU_RC_QUEUE_FULL;
 }
 
+void mt32emu_get_sample_clock(mt32emu_const_context context, mt32emu_sample_clock *sample_clock) {
+	SampleClock sampleClock;
+	context->synth->getSampleClock(sampleClock);
+	sample_clock->renderedSampleCount = sampleClock.renderedSampleCount;
+	sample_clock->clockNanos = sampleClock.clockNanos;
+}
+
+mt32emu_return_code mt32emu_play_msg_at_sample_clock(mt32emu_const_context context, mt32emu_bit32u msg, double timestamp) {
+	if (!context->synth->isOpen()) return MT32EMU_RC_NOT_OPENED;
+	return (context->synth->playMsgAtSampleClock(msg, timestamp)) ? MT32EMU_RC_OK : MT32EMU_RC_QUEUE_FULL;
+}
+
+mt32emu_return_code mt32emu_play_sysex_at_sample_clock(mt32emu_const_context context, const mt32emu_bit8u *sysex, mt32emu_bit32u len, double timestamp) {
+	if (!context->synth->isOpen()) return MT32EMU_RC_NOT_OPENED;
+	return (context->synth->playSysexAtSampleClock(sysex, len, timestamp)) ? MT32EMU_RC_OK : MT32EMU_RC_QUEUE_FULL;
+}
+
+mt32emu_bit32u mt32emu_play_events(mt32emu_const_context context, const mt32emu_midi_event *events, mt32emu_bit32u count) {
+	if (!context->synth->isOpen()) return 0;
+	return context->synth->playEvents(reinterpret_cast<const MIDIEvent *>(events), count);
+}
+
 void mt32emu_play_msg_now(mt32emu_const_context context, mt32emu_bit32u msg) {
 	context->synth->playMsgNow(msg);
 }
@@ -790,6 +1316,86 @@ void mt32emu_preallocate_reverb_memory(mt32emu_const_context context, const mt32
 	return context->synth->preallocateReverbMemory(enabled != MT32EMU_BOOL_FALSE);
 }
 
+void mt32emu_set_reduced_memory_footprint_enabled(mt32emu_const_context context, const mt32emu_boolean enabled) {
+	context->synth->setReducedMemoryFootprintEnabled(enabled != MT32EMU_BOOL_FALSE);
+}
+
+mt32emu_boolean mt32emu_is_reduced_memory_footprint_enabled(mt32emu_const_context context) {
+	return context->synth->isReducedMemoryFootprintEnabled() ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE;
+}
+
+void mt32emu_set_output_dither_enabled(mt32emu_const_context context, const mt32emu_boolean enabled) {
+	context->synth->setOutputDitherEnabled(enabled != MT32EMU_BOOL_FALSE);
+}
+
+mt32emu_boolean mt32emu_is_output_dither_enabled(mt32emu_const_context context) {
+	return context->synth->isOutputDitherEnabled() ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE;
+}
+
+void mt32emu_set_partial_culling_threshold(mt32emu_const_context context, float attenuation) {
+	context->synth->setPartialCullingThreshold(attenuation);
+}
+
+float mt32emu_get_partial_culling_threshold(mt32emu_const_context context) {
+	return context->synth->getPartialCullingThreshold();
+}
+
+void mt32emu_set_rhythm_hit_cache_enabled(mt32emu_const_context context, const mt32emu_boolean enabled) {
+	context->synth->setRhythmHitCacheEnabled(enabled != MT32EMU_BOOL_FALSE);
+}
+
+mt32emu_boolean mt32emu_is_rhythm_hit_cache_enabled(mt32emu_const_context context) {
+	return context->synth->isRhythmHitCacheEnabled() ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE;
+}
+
+void mt32emu_set_overload_governor_enabled(mt32emu_const_context context, const mt32emu_boolean enabled) {
+	context->synth->setOverloadGovernorEnabled(enabled != MT32EMU_BOOL_FALSE);
+}
+
+mt32emu_boolean mt32emu_is_overload_governor_enabled(mt32emu_const_context context) {
+	return context->synth->isOverloadGovernorEnabled() ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE;
+}
+
+void mt32emu_set_overload_governor_render_budget(mt32emu_const_context context, float budget) {
+	context->synth->setOverloadGovernorRenderBudget(budget);
+}
+
+float mt32emu_get_overload_governor_render_budget(mt32emu_const_context context) {
+	return context->synth->getOverloadGovernorRenderBudget();
+}
+
+mt32emu_bit32u mt32emu_get_overload_governor_level(mt32emu_const_context context) {
+	return context->synth->getOverloadGovernorLevel();
+}
+
+void mt32emu_set_memory_locking_enabled(mt32emu_const_context context, const mt32emu_boolean enabled) {
+	context->synth->setMemoryLockingEnabled(enabled != MT32EMU_BOOL_FALSE);
+}
+
+mt32emu_boolean mt32emu_is_memory_locking_enabled(mt32emu_const_context context) {
+	return context->synth->isMemoryLockingEnabled() ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE;
+}
+
+void mt32emu_set_numa_node(mt32emu_const_context context, const mt32emu_bit32s node) {
+	context->synth->setNUMANode(node);
+}
+
+mt32emu_bit32s mt32emu_get_numa_node(mt32emu_const_context context) {
+	return context->synth->getNUMANode();
+}
+
+void mt32emu_set_reverb_preparation_deferred(mt32emu_const_context context, const mt32emu_boolean enabled) {
+	context->synth->setReverbPreparationDeferred(enabled != MT32EMU_BOOL_FALSE);
+}
+
+mt32emu_boolean mt32emu_is_reverb_preparation_deferred(mt32emu_const_context context) {
+	return context->synth->isReverbPreparationDeferred() ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE;
+}
+
+mt32emu_boolean mt32emu_prepare_reverb_models(mt32emu_const_context context) {
+	return context->synth->prepareReverbModels() ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE;
+}
+
 void mt32emu_set_dac_input_mode(mt32emu_const_context context, const mt32emu_dac_input_mode mode) {
 	context->synth->setDACInputMode(static_cast<DACInputMode>(mode));
 }
@@ -860,6 +1466,7 @@ void mt32emu_render_bit16s(mt32emu_const_context context, mt32emu_bit16s *stream
 	} else {
 		context->synth->render(stream, len);
 	}
+	reportsRendered(context);
 }
 
 void mt32emu_render_float(mt32emu_const_context context, float *stream, mt32emu_bit32u len) {
@@ -868,14 +1475,74 @@ void mt32emu_render_float(mt32emu_const_context context, float *stream, mt32emu_
 	} else {
 		context->synth->render(stream, len);
 	}
+	reportsRendered(context);
+}
+
+void mt32emu_render_float_planar(mt32emu_const_context context, float *left_stream, float *right_stream, mt32emu_bit32u len) {
+	if (context->srcState->src != NULL) {
+		context->srcState->src->getOutputSamples(left_stream, right_stream, len);
+	} else {
+		context->synth->render(left_stream, right_stream, len);
+	}
+	reportsRendered(context);
+}
+
+mt32emu_bit32u mt32emu_render_bit16s_with_events(mt32emu_const_context context, mt32emu_bit16s *stream, mt32emu_bit32u len, const mt32emu_midi_event *events, mt32emu_bit32u count) {
+	if (context->srcState->src == NULL && context->synth->isOpen()) {
+		const Bit32u playedCount = context->synth->renderWithEvents(stream, len, reinterpret_cast<const MIDIEvent *>(events), count);
+		reportsRendered(context);
+		return playedCount;
+	}
+	const Bit32u playedCount = playEventsAtOffsets(context, events, count);
+	mt32emu_render_bit16s(context, stream, len);
+	return playedCount;
+}
+
+mt32emu_bit32u mt32emu_render_float_with_events(mt32emu_const_context context, float *stream, mt32emu_bit32u len, const mt32emu_midi_event *events, mt32emu_bit32u count) {
+	if (context->srcState->src == NULL && context->synth->isOpen()) {
+		const Bit32u playedCount = context->synth->renderWithEvents(stream, len, reinterpret_cast<const MIDIEvent *>(events), count);
+		reportsRendered(context);
+		return playedCount;
+	}
+	const Bit32u playedCount = playEventsAtOffsets(context, events, count);
+	mt32emu_render_float(context, stream, len);
+	return playedCount;
+}
+
+mt32emu_bit32u mt32emu_render_float_planar_with_events(mt32emu_const_context context, float *left_stream, float *right_stream, mt32emu_bit32u len, const mt32emu_midi_event *events, mt32emu_bit32u count) {
+	if (context->srcState->src == NULL && context->synth->isOpen()) {
+		const Bit32u playedCount = context->synth->renderWithEvents(left_stream, right_stream, len, reinterpret_cast<const MIDIEvent *>(events), count);
+		reportsRendered(context);
+		return playedCount;
+	}
+	const Bit32u playedCount = playEventsAtOffsets(context, events, count);
+	mt32emu_render_float_planar(context, left_stream, right_stream, len);
+	return playedCount;
+}
+
+mt32emu_boolean mt32emu_skip_silence(mt32emu_const_context context, mt32emu_bit32u len) {
+	if (context->srcState->src != NULL) return MT32EMU_BOOL_FALSE;
+	return context->synth->skipSilence(len) ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE;
 }
 
 void mt32emu_render_bit16s_streams(mt32emu_const_context context, const mt32emu_dac_output_bit16s_streams *streams, mt32emu_bit32u len) {
 	context->synth->renderStreams(*reinterpret_cast<const DACOutputStreams<Bit16s> *>(streams), len);
+	reportsRendered(context);
 }
 
 void mt32emu_render_float_streams(mt32emu_const_context context, const mt32emu_dac_output_float_streams *streams, mt32emu_bit32u len) {
 	context->synth->renderStreams(*reinterpret_cast<const DACOutputStreams<float> *>(streams), len);
+	reportsRendered(context);
+}
+
+void mt32emu_render_bit16s_part_streams(mt32emu_const_context context, const mt32emu_part_output_bit16s_streams *streams, mt32emu_bit32u len) {
+	context->synth->renderPartStreams(*reinterpret_cast<const PartOutputStreams<Bit16s> *>(streams), len);
+	reportsRendered(context);
+}
+
+void mt32emu_render_float_part_streams(mt32emu_const_context context, const mt32emu_part_output_float_streams *streams, mt32emu_bit32u len) {
+	context->synth->renderPartStreams(*reinterpret_cast<const PartOutputStreams<float> *>(streams), len);
+	reportsRendered(context);
 }
 
 mt32emu_boolean mt32emu_has_active_partials(mt32emu_const_context context) {
@@ -910,4 +1577,86 @@ void mt32emu_read_memory(mt32emu_const_context context, mt32emu_bit32u addr, mt3
 	context->synth->readMemory(addr, len, data);
 }
 
+void mt32emu_set_render_profiling_enabled(mt32emu_const_context context, const mt32emu_boolean enabled) {
+	context->synth->setRenderProfilingEnabled(enabled != MT32EMU_BOOL_FALSE);
+}
+
+mt32emu_boolean mt32emu_is_render_profiling_enabled(mt32emu_const_context context) {
+	return context->synth->isRenderProfilingEnabled() ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE;
+}
+
+void mt32emu_flush_deferred_debug_messages(mt32emu_const_context context) {
+	context->synth->flushDeferredDebugMessages();
+}
+
+mt32emu_synth_group mt32emu_create_synth_group(mt32emu_bit32u output_count) {
+	return new mt32emu_synth_group_data(output_count);
+}
+
+void mt32emu_free_synth_group(mt32emu_synth_group group) {
+	delete group;
+}
+
+void mt32emu_add_to_synth_group(mt32emu_synth_group group, mt32emu_const_context context, mt32emu_bit32u output_ix) {
+	group->synthGroup.addSource(new ContextSource(context), output_ix);
+}
+
+void mt32emu_render_synth_group_bit16s(mt32emu_synth_group group, mt32emu_bit16s *stream, mt32emu_bit32u len) {
+	group->synthGroup.render(stream, len);
+}
+
+void mt32emu_render_synth_group_float(mt32emu_synth_group group, float *stream, mt32emu_bit32u len) {
+	group->synthGroup.render(stream, len);
+}
+
+void mt32emu_render_synth_group_outputs_bit16s(mt32emu_synth_group group, mt32emu_bit16s * const *streams, mt32emu_bit32u len) {
+	group->synthGroup.render(streams, len);
+}
+
+void mt32emu_render_synth_group_outputs_float(mt32emu_synth_group group, float * const *streams, mt32emu_bit32u len) {
+	group->synthGroup.render(streams, len);
+}
+
+void mt32emu_get_render_profile(mt32emu_const_context context, mt32emu_render_profile *render_profile) {
+	RenderProfile renderProfile;
+	context->synth->getRenderProfile(renderProfile);
+	render_profile->totalTime = renderProfile.totalTime;
+	render_profile->midiEventsTime = renderProfile.midiEventsTime;
+	render_profile->partialsTime = renderProfile.partialsTime;
+	render_profile->reverbTime = renderProfile.reverbTime;
+	render_profile->analogTime = renderProfile.analogTime;
+	render_profile->renderCallCount = renderProfile.renderCallCount;
+	render_profile->runCount = renderProfile.runCount;
+	render_profile->dispatchedEventCount = renderProfile.dispatchedEventCount;
+	render_profile->totalActivePartialCount = renderProfile.totalActivePartialCount;
+	render_profile->maxActivePartialCount = renderProfile.maxActivePartialCount;
+}
+
+void mt32emu_reset_render_profile(mt32emu_const_context context) {
+	context->synth->resetRenderProfile();
+}
+
+mt32emu_boolean mt32emu_get_polyphony_stats(mt32emu_const_context context, mt32emu_polyphony_stats *stats) {
+	PolyphonyStats polyphonyStats;
+	if (!context->synth->getPolyphonyStats(polyphonyStats)) return MT32EMU_BOOL_FALSE;
+	stats->noteOnCount = polyphonyStats.noteOnCount;
+	stats->droppedNoteCount = polyphonyStats.droppedNoteCount;
+	stats->partialAllocationCount = polyphonyStats.partialAllocationCount;
+	stats->releasingPolyStealCount = polyphonyStats.releasingPolyStealCount;
+	stats->reserveExceededPolyStealCount = polyphonyStats.reserveExceededPolyStealCount;
+	stats->samePartPolyStealCount = polyphonyStats.samePartPolyStealCount;
+	stats->singleAssignPolyAbortCount = polyphonyStats.singleAssignPolyAbortCount;
+	stats->abortedPolyCount = polyphonyStats.abortedPolyCount;
+	stats->abortWaitSampleCount = polyphonyStats.abortWaitSampleCount;
+	stats->peakPartialCount = polyphonyStats.peakPartialCount;
+	for (int i = 0; i < 9; i++) {
+		stats->peakPartPartialCount[i] = polyphonyStats.peakPartPartialCount[i];
+	}
+	return MT32EMU_BOOL_TRUE;
+}
+
+void mt32emu_reset_polyphony_stats(mt32emu_const_context context) {
+	context->synth->resetPolyphonyStats();
+}
+
 } // extern "C"
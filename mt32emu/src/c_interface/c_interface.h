@@ -243,6 +243,31 @@ MT32EMU_EXPORT void mt32emu_select_renderer_type(mt32emu_context context, const
  */
 MT32EMU_EXPORT mt32emu_renderer_type mt32emu_get_selected_renderer_type(mt32emu_context context);
 
+/**
+ * Returns the instruction set extensions the CPU supports that the optimised implementations of the rendering kernels
+ * may use, as a combination of mt32emu_cpu_feature flags. The extensions disabled with the environment variable
+ * MT32EMU_CPU_FEATURES are excluded. The variable holds a comma-separated list of the extensions to use,
+ * e.g. "sse2,avx2", or "none" to use the portable implementations only.
+ */
+MT32EMU_EXPORT_V(2.5) mt32emu_bit32u mt32emu_get_supported_cpu_features(void);
+
+/**
+ * Limits the instruction set extensions the rendering kernels may use to the specified combination of
+ * mt32emu_cpu_feature flags. Takes effect upon the next call to mt32emu_open_synth().
+ * By default, all the supported extensions are used.
+ */
+MT32EMU_EXPORT_V(2.5) void mt32emu_set_enabled_cpu_features(mt32emu_context context, mt32emu_bit32u cpu_features);
+
+/** Returns the instruction set extensions the rendering kernels are allowed to use. */
+MT32EMU_EXPORT_V(2.5) mt32emu_bit32u mt32emu_get_enabled_cpu_features(mt32emu_context context);
+
+/**
+ * Retrieves the name of the rendering kernel with the specified index along with the name of its implementation
+ * selected when the synth was opened, e.g. "sse2" or "portable". Returns MT32EMU_BOOL_FALSE if the synth isn't open
+ * or the index is out of range, which allows to enumerate all the kernels.
+ */
+MT32EMU_EXPORT_V(2.5) mt32emu_boolean mt32emu_get_kernel_variant(mt32emu_const_context context, mt32emu_bit32u kernel_index, const char **kernel_name, const char **variant_name);
+
 /**
  * Prepares the emulation context to receive MIDI messages and produce output audio data using aforehand added set of ROMs,
  * and optionally set the maximum partial count and the analog output mode.
@@ -253,6 +278,14 @@ MT32EMU_EXPORT mt32emu_return_code mt32emu_open_synth(mt32emu_const_context cont
 /** Closes the emulation context freeing allocated resources. Added ROMs remain unaffected and ready for reuse. */
 MT32EMU_EXPORT void mt32emu_close_synth(mt32emu_const_context context);
 
+/**
+ * Brings the opened synth to the state it has right after opening, as a faster alternative to closing and opening it again.
+ * The ROMs, the maximum partial count and the other settings the synth was opened with are retained, except that the analog
+ * output mode currently set in the context is applied. The pending MIDI messages are discarded.
+ * Returns MT32EMU_RC_OK upon success or MT32EMU_RC_FAILED if the synth is not open.
+ */
+MT32EMU_EXPORT_V(2.5) mt32emu_return_code mt32emu_reinitialise_synth(mt32emu_const_context context);
+
 /** Returns true if the synth is in completely initialized state, otherwise returns false. */
 MT32EMU_EXPORT mt32emu_boolean mt32emu_is_open(mt32emu_const_context context);
 
@@ -279,6 +312,21 @@ MT32EMU_EXPORT mt32emu_bit32u mt32emu_convert_output_to_synth_timestamp(mt32emu_
  */
 MT32EMU_EXPORT mt32emu_bit32u mt32emu_convert_synth_to_output_timestamp(mt32emu_const_context context, mt32emu_bit32u synth_timestamp);
 
+/**
+ * Returns the delay the samplerate conversion introduces to the low-frequency content of the output signal, measured in samples
+ * at the output sample rate. Returns 0 if the synth is not open or no conversion is performed, and a negative value if the delay
+ * is unknown. The delay can be minimised using MT32EMU_SRCQ_LOW_LATENCY.
+ */
+MT32EMU_EXPORT_V(2.5) double mt32emu_get_samplerate_conversion_latency(mt32emu_const_context context);
+
+/**
+ * Returns the fixed delay from the timestamp of a note-on message to the onset of the note in the output signal, measured
+ * in samples at the output sample rate. This comprises the emulated MIDI interface delay unless MT32EMU_MDM_IMMEDIATE is
+ * in effect, the group delay of the analogue LPF and the delay of the samplerate conversion, unless the latter is unknown.
+ * Clients may schedule MIDI events this much earlier to compensate. Returns 0 if the synth is not open.
+ */
+MT32EMU_EXPORT_V(2.5) double mt32emu_get_output_latency(mt32emu_const_context context);
+
 /** All the enqueued events are processed by the synth immediately. */
 MT32EMU_EXPORT void mt32emu_flush_midi_queue(mt32emu_const_context context);
 
@@ -300,7 +348,34 @@ MT32EMU_EXPORT mt32emu_bit32u mt32emu_set_midi_event_queue_size(mt32emu_const_co
  * by a SysEx event, that has been processed and thus is no longer necessary, is disposed instantly.
  * Note, the queue is flushed and recreated in the process so that its size remains intact.
  */
-void mt32emu_configure_midi_event_queue_sysex_storage(mt32emu_const_context context, const mt32emu_bit32u storage_buffer_size);
+MT32EMU_EXPORT void mt32emu_configure_midi_event_queue_sysex_storage(mt32emu_const_context context, const mt32emu_bit32u storage_buffer_size);
+
+/**
+ * Allows the internal MIDI event queue to grow up to the specified size, rounded up to a power of 2, instead of
+ * overflowing when full. A full queue is then replaced with one twice as big on the thread that enqueues the events,
+ * the rendering thread never allocates nor releases the memory. A size that doesn't exceed the queue size disables
+ * growing, which is the default. Must not be invoked concurrently with enqueueing MIDI events.
+ * Returns the actual maximum size being used.
+ */
+MT32EMU_EXPORT_V(2.5) mt32emu_bit32u mt32emu_set_midi_event_queue_max_size(mt32emu_const_context context, const mt32emu_bit32u max_queue_size);
+/** Returns the maximum size the internal MIDI event queue may grow up to. */
+MT32EMU_EXPORT_V(2.5) mt32emu_bit32u mt32emu_get_midi_event_queue_max_size(mt32emu_const_context context);
+/**
+ * Fills in the statistics of the internal MIDI event queue, which help sizing the queue and the SysEx storage.
+ * Must be invoked on the thread that enqueues the events, yet may run concurrently with rendering.
+ * Returns MT32EMU_BOOL_FALSE if the synth isn't open.
+ */
+MT32EMU_EXPORT_V(2.5) mt32emu_boolean mt32emu_get_midi_event_queue_stats(mt32emu_const_context context, mt32emu_midi_event_queue_stats *stats);
+/** Resets the accumulated statistics of the internal MIDI event queue, with the same restrictions. */
+MT32EMU_EXPORT_V(2.5) void mt32emu_reset_midi_event_queue_stats(mt32emu_const_context context);
+
+/**
+ * Fills in the breakdown of the memory occupied by the context, which allows to estimate the footprint of a context
+ * with the current configuration, e.g. to decide how many of them fit in a memory limit. The resources allocated
+ * on demand are accounted as they are at the moment. Must not be invoked concurrently with rendering or enqueueing
+ * MIDI events. Returns MT32EMU_BOOL_FALSE and zeroes all the fields if the synth isn't open.
+ */
+MT32EMU_EXPORT_V(2.5) mt32emu_boolean mt32emu_get_memory_usage(mt32emu_const_context context, mt32emu_memory_usage *usage);
 
 /**
  * Installs custom MIDI receiver object intended for receiving MIDI messages generated by MIDI stream parser.
@@ -310,11 +385,41 @@ void mt32emu_configure_midi_event_queue_sysex_storage(mt32emu_const_context cont
  */
 MT32EMU_EXPORT void mt32emu_set_midi_receiver(mt32emu_context context, mt32emu_midi_receiver_i midi_receiver, void *instance_data);
 
+/**
+ * Configures queueing of the reports, which spares the clients the callbacks to the report handler from within
+ * the rendering, e.g. when each callback is an expensive transition into a managed runtime. While queueing,
+ * the reports of the LCD messages, played MIDI messages, system events, changes of the reverb settings, polys
+ * and programs are stored in a preallocated queue of the specified capacity, or 1024 entries when 0 is given.
+ * The capacity is rounded up to a power of two.
+ * The debug messages, errors, MIDI queue overflows and System Realtime messages are still delivered immediately.
+ * The reports queued beforehand are delivered upon reconfiguration. Must not be invoked concurrently with rendering
+ * or enqueueing MIDI events.
+ */
+MT32EMU_EXPORT_V(2.5) void mt32emu_set_report_queueing(mt32emu_const_context context, const mt32emu_report_queueing_mode mode, const mt32emu_bit32u capacity);
+/** Returns the current mode of queueing the reports. */
+MT32EMU_EXPORT_V(2.5) mt32emu_report_queueing_mode mt32emu_get_report_queueing_mode(mt32emu_const_context context);
+/**
+ * Moves up to max_count oldest queued reports to the provided array, returns the number of the reports moved.
+ * Unlike the callbacks, a batch of reports is retrieved at once. It is safe to invoke this concurrently with rendering,
+ * as long as the reports are only retrieved by a single thread at a time.
+ */
+MT32EMU_EXPORT_V(2.5) mt32emu_bit32u mt32emu_read_queued_reports(mt32emu_const_context context, mt32emu_report *reports, mt32emu_bit32u max_count);
+/**
+ * Removes all the queued reports and invokes the corresponding callbacks of the report handler on the calling thread,
+ * returns the number of the reports delivered. The same as for mt32emu_read_queued_reports() applies.
+ */
+MT32EMU_EXPORT_V(2.5) mt32emu_bit32u mt32emu_deliver_queued_reports(mt32emu_const_context context);
+
 /**
  * Returns current value of the global counter of samples rendered since the synth was created (at the native sample rate 32000 Hz).
  * This method helps to compute accurate timestamp of a MIDI message to use with the methods below.
  */
 MT32EMU_EXPORT mt32emu_bit32u mt32emu_get_internal_rendered_sample_count(mt32emu_const_context context);
+/**
+ * Retrieves the 64-bit sample clock published upon completion of each rendering call along with the wall clock reading
+ * taken at that moment. Never blocks and can be invoked from any thread at any time. See Synth::getSampleClock().
+ */
+MT32EMU_EXPORT_V(2.5) void mt32emu_get_sample_clock(mt32emu_const_context context, mt32emu_sample_clock *sample_clock);
 
 /* Enqueues a MIDI event for subsequent playback.
  * The MIDI event will be processed not before the specified timestamp.
@@ -364,6 +469,18 @@ MT32EMU_EXPORT mt32emu_return_code mt32emu_play_sysex(mt32emu_const_context cont
 MT32EMU_EXPORT mt32emu_return_code mt32emu_play_msg_at(mt32emu_const_context context, mt32emu_bit32u msg, mt32emu_bit32u timestamp);
 /** Enqueues a single well formed System Exclusive MIDI message to play at specified time. */
 MT32EMU_EXPORT mt32emu_return_code mt32emu_play_sysex_at(mt32emu_const_context context, const mt32emu_bit8u *sysex, mt32emu_bit32u len, mt32emu_bit32u timestamp);
+/**
+ * Same as the functions above but the timestamp is measured on the 64-bit sample clock, see mt32emu_get_sample_clock().
+ * The timestamp must be within 2^31 samples (about 18 hours) of the current sample time.
+ */
+MT32EMU_EXPORT_V(2.5) mt32emu_return_code mt32emu_play_msg_at_sample_clock(mt32emu_const_context context, mt32emu_bit32u msg, double timestamp);
+MT32EMU_EXPORT_V(2.5) mt32emu_return_code mt32emu_play_sysex_at_sample_clock(mt32emu_const_context context, const mt32emu_bit8u *sysex, mt32emu_bit32u len, double timestamp);
+
+/**
+ * Enqueues a batch of MIDI events sorted by the timestamps at once, which is cheaper than enqueueing them one by one.
+ * Returns the number of events enqueued, which is less than count if the queue is full, or 0 if the synth is not open.
+ */
+MT32EMU_EXPORT_V(2.5) mt32emu_bit32u mt32emu_play_events(mt32emu_const_context context, const mt32emu_midi_event *events, mt32emu_bit32u count);
 
 /* WARNING:
  * The methods below don't ensure minimum 1-sample delay between sequential MIDI events,
@@ -424,6 +541,92 @@ MT32EMU_EXPORT mt32emu_boolean mt32emu_is_default_reverb_mt32_compatible(mt32emu
  */
 MT32EMU_EXPORT void mt32emu_preallocate_reverb_memory(mt32emu_const_context context, const mt32emu_boolean enabled);
 
+/**
+ * Enables or disables the reduced memory footprint mode, which takes effect when the synth is opened next time.
+ * In this mode, only the memory of the reverb mode in use is allocated regardless of mt32emu_preallocate_reverb_memory(),
+ * and the default contents of the emulated memory along with the padded copies of the PCM waves are shared among
+ * the synths opened with the same ROM images. Since each context loads its own ROM images, the latter only applies
+ * to the synths in the process that use the C++ API directly. Disabled by default.
+ */
+MT32EMU_EXPORT_V(2.5) void mt32emu_set_reduced_memory_footprint_enabled(mt32emu_const_context context, const mt32emu_boolean enabled);
+/** Returns whether the reduced memory footprint mode is enabled. */
+MT32EMU_EXPORT_V(2.5) mt32emu_boolean mt32emu_is_reduced_memory_footprint_enabled(mt32emu_const_context context);
+
+/**
+ * Enables or disables TPDF dither of 1 LSB peak amplitude applied when float samples are converted to 16-bit integers
+ * on the output, i.e. when the float renderer renders to bit16s streams, including the internal samplerate conversion.
+ * The dither noise is deterministic, so the output remains reproducible. Disabled by default.
+ */
+MT32EMU_EXPORT_V(2.5) void mt32emu_set_output_dither_enabled(mt32emu_const_context context, const mt32emu_boolean enabled);
+/** Returns whether the output dither is enabled. */
+MT32EMU_EXPORT_V(2.5) mt32emu_boolean mt32emu_is_output_dither_enabled(mt32emu_const_context context);
+
+/**
+ * Sets the threshold of the opt-in culling of inaudible partials as the attenuation in dB applied by TVA.
+ * The wave generation of partials attenuated at least that much is skipped, while the envelopes keep advancing,
+ * so the partials end and get stolen as usual. Zero or negative values disable the culling. Disabled by default.
+ */
+MT32EMU_EXPORT_V(2.5) void mt32emu_set_partial_culling_threshold(mt32emu_const_context context, float attenuation);
+/** Returns the threshold of culling of inaudible partials in dB, zero when disabled. */
+MT32EMU_EXPORT_V(2.5) float mt32emu_get_partial_culling_threshold(mt32emu_const_context context);
+
+/**
+ * Enables or disables the opt-in cache of the rhythm part hits. The output of the partials is recorded upon the first hit
+ * of a drum with a velocity and replayed by the later hits as long as their amp and cutoff envelopes follow the recording
+ * exactly. The replayed hits take over the random timing of the pitch envelope of the recorded hit, so the output is not
+ * bit-exact. Takes 24 MiB of memory at most, which is allocated upon enabling or opening and kept until the synth closes.
+ * Disabled by default.
+ */
+MT32EMU_EXPORT_V(2.5) void mt32emu_set_rhythm_hit_cache_enabled(mt32emu_const_context context, const mt32emu_boolean enabled);
+/** Returns whether the rhythm hit cache is enabled. */
+MT32EMU_EXPORT_V(2.5) mt32emu_boolean mt32emu_is_rhythm_hit_cache_enabled(mt32emu_const_context context);
+
+/**
+ * Enables or disables the governor that degrades the quality gradually while the rendering takes longer than the budget
+ * share of real time, first by culling quiet partials, then by limiting the partials available to new notes. The quality
+ * is restored step by step once the load stays low. Disabled by default. See Synth::setOverloadGovernorEnabled().
+ */
+MT32EMU_EXPORT_V(2.5) void mt32emu_set_overload_governor_enabled(mt32emu_const_context context, const mt32emu_boolean enabled);
+/** Returns whether the overload governor is enabled. */
+MT32EMU_EXPORT_V(2.5) mt32emu_boolean mt32emu_is_overload_governor_enabled(mt32emu_const_context context);
+/** Sets the share of real time the rendering may take before the overload governor steps in, 0.75 by default. */
+MT32EMU_EXPORT_V(2.5) void mt32emu_set_overload_governor_render_budget(mt32emu_const_context context, float budget);
+/** Returns the render budget of the overload governor. */
+MT32EMU_EXPORT_V(2.5) float mt32emu_get_overload_governor_render_budget(mt32emu_const_context context);
+/** Returns the current degradation level of the overload governor, 0 while the quality is intact. */
+MT32EMU_EXPORT_V(2.5) mt32emu_bit32u mt32emu_get_overload_governor_level(mt32emu_const_context context);
+
+/**
+ * Enables or disables locking of the synth working set in physical memory upon the next opening of the synth,
+ * so that rendering never stalls on a page fault. Subject to the system limits. Disabled by default.
+ */
+MT32EMU_EXPORT_V(2.5) void mt32emu_set_memory_locking_enabled(mt32emu_const_context context, const mt32emu_boolean enabled);
+/** Returns whether locking of the synth working set is enabled. */
+MT32EMU_EXPORT_V(2.5) mt32emu_boolean mt32emu_is_memory_locking_enabled(mt32emu_const_context context);
+/**
+ * Sets the NUMA node the synth working set is bound to upon the next opening of the synth, a negative value disables
+ * the placement, which is the default. Only supported on Linux. See Synth::setNUMANode() for details.
+ */
+MT32EMU_EXPORT_V(2.5) void mt32emu_set_numa_node(mt32emu_const_context context, const mt32emu_bit32s node);
+/** Returns the NUMA node the synth working set is bound to, or -1 if the placement is disabled. */
+MT32EMU_EXPORT_V(2.5) mt32emu_bit32s mt32emu_get_numa_node(mt32emu_const_context context);
+
+/**
+ * Enables or disables deferring the preparation of the reverb models while the reverb memory is preallocated,
+ * so that only the models of the reverb modes actually selected are allocated. After opening, the models are prepared
+ * by mt32emu_prepare_reverb_models(), and the reverb output remains silent meanwhile. Disabled by default.
+ */
+MT32EMU_EXPORT_V(2.5) void mt32emu_set_reverb_preparation_deferred(mt32emu_const_context context, const mt32emu_boolean enabled);
+/** Returns whether the preparation of the reverb models is deferred. */
+MT32EMU_EXPORT_V(2.5) mt32emu_boolean mt32emu_is_reverb_preparation_deferred(mt32emu_const_context context);
+/**
+ * Prepares the reverb model requested upon a reverb mode change while the preparation is deferred, if any.
+ * Intended to be invoked periodically from a thread other than the rendering thread. May run concurrently with rendering
+ * and MIDI processing, but not with itself, opening or closing the synth and mt32emu_preallocate_reverb_memory().
+ * Returns true if a model has been prepared.
+ */
+MT32EMU_EXPORT_V(2.5) mt32emu_boolean mt32emu_prepare_reverb_models(mt32emu_const_context context);
+
 /** Sets new DAC input mode. See mt32emu_dac_input_mode for details. */
 MT32EMU_EXPORT void mt32emu_set_dac_input_mode(mt32emu_const_context context, const mt32emu_dac_input_mode mode);
 /** Returns current DAC input mode. See mt32emu_dac_input_mode for details. */
@@ -510,6 +713,29 @@ MT32EMU_EXPORT mt32emu_boolean mt32emu_is_nice_partial_mixing_enabled(mt32emu_co
 MT32EMU_EXPORT void mt32emu_render_bit16s(mt32emu_const_context context, mt32emu_bit16s *stream, mt32emu_bit32u len);
 /** Same as above but outputs to a float stereo stream. */
 MT32EMU_EXPORT void mt32emu_render_float(mt32emu_const_context context, float *stream, mt32emu_bit32u len);
+/** Same as above but outputs the left and right channels to separate float streams. */
+MT32EMU_EXPORT_V(2.5) void mt32emu_render_float_planar(mt32emu_const_context context, float *left_stream, float *right_stream, mt32emu_bit32u len);
+
+/**
+ * Plays a batch of MIDI events and renders the output in a single call. The timestamps of the events are offsets in frames
+ * at the output sample rate from the beginning of the stream rendered by this call, and must be sorted. Unless the sample
+ * rate conversion is performed, the events are played exactly at the offsets bypassing the MIDI event queue, the same way
+ * as Synth::renderWithEvents() does. Otherwise, the events are enqueued as with mt32emu_play_events() before rendering.
+ * Events with offsets beyond the length of the stream play during the subsequent rendering. Returns the number of events
+ * played or enqueued, which is less than count if the queue is full, or 0 if the synth is not open. The output is rendered
+ * regardless.
+ */
+MT32EMU_EXPORT_V(2.5) mt32emu_bit32u mt32emu_render_bit16s_with_events(mt32emu_const_context context, mt32emu_bit16s *stream, mt32emu_bit32u len, const mt32emu_midi_event *events, mt32emu_bit32u count);
+MT32EMU_EXPORT_V(2.5) mt32emu_bit32u mt32emu_render_float_with_events(mt32emu_const_context context, float *stream, mt32emu_bit32u len, const mt32emu_midi_event *events, mt32emu_bit32u count);
+MT32EMU_EXPORT_V(2.5) mt32emu_bit32u mt32emu_render_float_planar_with_events(mt32emu_const_context context, float *left_stream, float *right_stream, mt32emu_bit32u len, const mt32emu_midi_event *events, mt32emu_bit32u count);
+
+/**
+ * Advances the synth by the specified number of frames at the output sample rate without rendering anything, provided the output
+ * is certain to be silent: the MIDI queue is empty, no partial is active, and both the reverb and the analog circuitry emulation
+ * are silent. Returns MT32EMU_BOOL_TRUE if the frames are skipped, in which case they are to be treated as zeros, otherwise
+ * nothing is done. Skipping is never done while the sample rate conversion is performed, since the converter keeps own state.
+ */
+MT32EMU_EXPORT_V(2.5) mt32emu_boolean mt32emu_skip_silence(mt32emu_const_context context, mt32emu_bit32u len);
 
 /**
  * Renders samples to the specified output streams as if they appeared at the DAC entrance.
@@ -521,6 +747,16 @@ MT32EMU_EXPORT void mt32emu_render_bit16s_streams(mt32emu_const_context context,
 /** Same as above but outputs to float streams. */
 MT32EMU_EXPORT void mt32emu_render_float_streams(mt32emu_const_context context, const mt32emu_dac_output_float_streams *streams, mt32emu_bit32u len);
 
+/**
+ * Renders the dry output of each part to a separate stereo pair of streams along with the reverb wet output,
+ * all as they appear at the DAC entrance, so that the parts can be mixed and processed individually afterwards.
+ * As with mt32emu_render_bit16s_streams(), NULL skips a stream, and no analog circuitry emulation is applied.
+ * The partials are always rendered sequentially, the partial rendering executor is not used.
+ */
+MT32EMU_EXPORT_V(2.5) void mt32emu_render_bit16s_part_streams(mt32emu_const_context context, const mt32emu_part_output_bit16s_streams *streams, mt32emu_bit32u len);
+/** Same as above but outputs to float streams. */
+MT32EMU_EXPORT_V(2.5) void mt32emu_render_float_part_streams(mt32emu_const_context context, const mt32emu_part_output_float_streams *streams, mt32emu_bit32u len);
+
 /** Returns true when there is at least one active partial, otherwise false. */
 MT32EMU_EXPORT mt32emu_boolean mt32emu_has_active_partials(mt32emu_const_context context);
 
@@ -562,6 +798,68 @@ MT32EMU_EXPORT const char *mt32emu_get_patch_name(mt32emu_const_context context,
 /** Stores internal state of emulated synth into an array provided (as it would be acquired from hardware). */
 MT32EMU_EXPORT void mt32emu_read_memory(mt32emu_const_context context, mt32emu_bit32u addr, mt32emu_bit32u len, mt32emu_bit8u *data);
 
+/**
+ * Allows to collect statistics of the rendering process, see mt32emu_render_profile.
+ * The time spent in each rendering stage is measured, which adds a little overhead, so this is meant for tuning purposes.
+ * Enabling resets the statistics collected so far. This mode is disabled by default.
+ */
+MT32EMU_EXPORT_V(2.5) void mt32emu_set_render_profiling_enabled(mt32emu_const_context context, const mt32emu_boolean enabled);
+/** Returns whether render profiling is enabled. */
+MT32EMU_EXPORT_V(2.5) mt32emu_boolean mt32emu_is_render_profiling_enabled(mt32emu_const_context context);
+/**
+ * Fills in the statistics collected since render profiling was enabled or reset.
+ * Must not be invoked concurrently with rendering.
+ */
+MT32EMU_EXPORT_V(2.5) void mt32emu_get_render_profile(mt32emu_const_context context, mt32emu_render_profile *render_profile);
+/** Resets the statistics of render profiling. Must not be invoked concurrently with rendering. */
+MT32EMU_EXPORT_V(2.5) void mt32emu_reset_render_profile(mt32emu_const_context context);
+
+/**
+ * Fills in the statistics of the partial allocation, which help to decide whether the partial count suffices
+ * for the MIDI data played. Must not be invoked concurrently with rendering or playing MIDI messages.
+ * Returns MT32EMU_BOOL_FALSE if the synth isn't open.
+ */
+MT32EMU_EXPORT_V(2.5) mt32emu_boolean mt32emu_get_polyphony_stats(mt32emu_const_context context, mt32emu_polyphony_stats *stats);
+/** Resets the statistics of the partial allocation, with the same restrictions. */
+MT32EMU_EXPORT_V(2.5) void mt32emu_reset_polyphony_stats(mt32emu_const_context context);
+
+/**
+ * When the library is built with the realtime-safe rendering, debug messages printed while rendering are kept
+ * in a preallocated log. This delivers them to the report handler on the calling thread, concurrently with rendering.
+ * Does nothing otherwise.
+ */
+MT32EMU_EXPORT_V(2.5) void mt32emu_flush_deferred_debug_messages(mt32emu_const_context context);
+
+/* Synth groups */
+
+/**
+ * Creates an empty group to render several emulation contexts at once and mix their output, e.g. to emulate a number
+ * of devices attached to separate MIDI ports. The group has the specified number of outputs, at least one.
+ * The contexts added to the group are expected to be supplied with the same ROMs. The members are rendered
+ * sequentially. The returned group must be freed with mt32emu_free_synth_group().
+ */
+MT32EMU_EXPORT_V(2.5) mt32emu_synth_group mt32emu_create_synth_group(mt32emu_bit32u output_count);
+/** Frees the group. Contexts added to the group are left intact. */
+MT32EMU_EXPORT_V(2.5) void mt32emu_free_synth_group(mt32emu_synth_group group);
+/**
+ * Adds the context to the group, mixed into the specified output. The output of the context is rendered at the sample
+ * rate it is configured with, which should be the same for all the contexts in the group. The context must remain valid
+ * while the group is in use, and must only be rendered through the group from then on.
+ */
+MT32EMU_EXPORT_V(2.5) void mt32emu_add_to_synth_group(mt32emu_synth_group group, mt32emu_const_context context, mt32emu_bit32u output_ix);
+/**
+ * Renders the mix of all the contexts in the group, regardless of the outputs they are assigned to, into the interleaved
+ * stereo stream. The length is in frames. The mixed 16-bit samples are clipped.
+ */
+MT32EMU_EXPORT_V(2.5) void mt32emu_render_synth_group_bit16s(mt32emu_synth_group group, mt32emu_bit16s *stream, mt32emu_bit32u len);
+MT32EMU_EXPORT_V(2.5) void mt32emu_render_synth_group_float(mt32emu_synth_group group, float *stream, mt32emu_bit32u len);
+/**
+ * Same as above, but renders each output of the group separately into the respective stream of the array, which must
+ * contain as many streams as there are outputs. A NULL stream skips the output.
+ */
+MT32EMU_EXPORT_V(2.5) void mt32emu_render_synth_group_outputs_bit16s(mt32emu_synth_group group, mt32emu_bit16s * const *streams, mt32emu_bit32u len);
+MT32EMU_EXPORT_V(2.5) void mt32emu_render_synth_group_outputs_float(mt32emu_synth_group group, float * const *streams, mt32emu_bit32u len);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -66,6 +66,9 @@ typedef enum {
 typedef struct mt32emu_data *mt32emu_context;
 typedef const struct mt32emu_data *mt32emu_const_context;
 
+/** Group of emulation contexts rendered and mixed together */
+typedef struct mt32emu_synth_group_data *mt32emu_synth_group;
+
 /* Convenience aliases */
 #ifndef __cplusplus
 typedef enum mt32emu_analog_output_mode mt32emu_analog_output_mode;
@@ -106,6 +109,211 @@ typedef struct {
 	float *reverbWetRight;
 } mt32emu_dac_output_float_streams;
 
+/**
+ * Set of output bit16s streams with the dry signal split by the owner part, parts 1-8 followed by the rhythm part,
+ * accompanied with the reverb wet output common to all the parts.
+ */
+typedef struct {
+	mt32emu_bit16s *partLeft[9];
+	mt32emu_bit16s *partRight[9];
+	mt32emu_bit16s *reverbWetLeft;
+	mt32emu_bit16s *reverbWetRight;
+} mt32emu_part_output_bit16s_streams;
+
+/** Set of output float streams with the dry signal split by the owner part, same as above. */
+typedef struct {
+	float *partLeft[9];
+	float *partRight[9];
+	float *reverbWetLeft;
+	float *reverbWetRight;
+} mt32emu_part_output_float_streams;
+
+/**
+ * Statistics collected by the renderer while render profiling is enabled.
+ * Times are accumulated in nanoseconds. Each stage is accounted separately, the total time also includes
+ * the overhead of the renderer itself. Counters wrap around on overflow, so they should be reset periodically.
+ */
+typedef struct {
+	/** Total time spent in render calls */
+	double totalTime;
+	/** Time spent dispatching MIDI events */
+	double midiEventsTime;
+	/** Time spent in the LA32 emulation producing the output of active partials */
+	double partialsTime;
+	/** Time spent in the reverb model */
+	double reverbTime;
+	/** Time spent in the analog circuitry emulation */
+	double analogTime;
+	/** Number of render calls */
+	mt32emu_bit32u renderCallCount;
+	/** Number of rendering runs, each run processes a limited number of samples without MIDI events in between */
+	mt32emu_bit32u runCount;
+	/** Number of MIDI events dispatched */
+	mt32emu_bit32u dispatchedEventCount;
+	/** Sum of the numbers of active partials over all the runs, divided by runCount gives the average */
+	mt32emu_bit32u totalActivePartialCount;
+	/** Maximum number of partials active in a run */
+	mt32emu_bit32u maxActivePartialCount;
+} mt32emu_render_profile;
+
+/**
+ * Statistics of the MIDI event queue, see mt32emu_get_midi_event_queue_stats().
+ * The counters are accumulated since the queue was created or the statistics were reset.
+ */
+typedef struct {
+	/** Current capacity of the queue in events, which increases as a growable queue grows */
+	mt32emu_bit32u queueSize;
+	/** Number of events currently pending in the queue */
+	mt32emu_bit32u pendingEventCount;
+	/** Maximum number of events pending in the queue at once */
+	mt32emu_bit32u maxPendingEventCount;
+	/** Number of times an event didn't fit in the queue, due to either the queue or the SysEx storage being full */
+	mt32emu_bit32u overflowCount;
+	/** Number of times the queue grew */
+	mt32emu_bit32u growCount;
+	/** Size of the preallocated SysEx storage buffer in bytes, 0 when the SysEx data is allocated dynamically */
+	mt32emu_bit32u sysexStorageSize;
+	/** Number of bytes of the SysEx data currently stored in the queue */
+	mt32emu_bit32u sysexStorageUsage;
+	/** Maximum number of bytes of the SysEx data stored in the queue at once */
+	mt32emu_bit32u maxSysexStorageUsage;
+} mt32emu_midi_event_queue_stats;
+
+/**
+ * Statistics of the partial allocation, see mt32emu_get_polyphony_stats(). Counters are accumulated since the synth
+ * was opened or the statistics were reset, and wrap around on overflow.
+ */
+typedef struct {
+	/** Number of notes that either started playing or were dropped, excluding completely muted timbres */
+	mt32emu_bit32u noteOnCount;
+	/** Number of notes dropped due to a lack of free partials or polys */
+	mt32emu_bit32u droppedNoteCount;
+	/** Number of partials allocated to play notes */
+	mt32emu_bit32u partialAllocationCount;
+	/** Number of releasing polys of parts that exceeded their partial reserve aborted to free partials for new notes */
+	mt32emu_bit32u releasingPolyStealCount;
+	/** Number of other polys of parts that exceeded their partial reserve aborted to free partials for new notes */
+	mt32emu_bit32u reserveExceededPolyStealCount;
+	/** Number of polys of the part that plays the new note aborted to free partials for it */
+	mt32emu_bit32u samePartPolyStealCount;
+	/** Number of polys aborted in the single-assign mode because the same key was played again */
+	mt32emu_bit32u singleAssignPolyAbortCount;
+	/** Total number of polys aborted */
+	mt32emu_bit32u abortedPolyCount;
+	/** Number of samples rendered while a note waited for an aborted poly to cease, at the internal sample rate */
+	mt32emu_bit32u abortWaitSampleCount;
+	/** Maximum number of partials active at once */
+	mt32emu_bit32u peakPartialCount;
+	/** Maximum number of partials active at once in each part, 0..7 for Part 1..8 and 8 for Rhythm */
+	mt32emu_bit32u peakPartPartialCount[9];
+} mt32emu_polyphony_stats;
+
+/** Breakdown of the memory occupied by a synth context in bytes, see mt32emu_get_memory_usage(). */
+typedef struct {
+	/** The synth object with the emulated memory and the sound group names, excluding the control ROM copy */
+	size_t stateSize;
+	/** Copy of the control ROM data kept by the synth */
+	size_t controlROMSize;
+	/** The PCM wave table along with the padded copies of the waves and their linear copies for the float renderers, unless shared */
+	size_t pcmWavesSize;
+	/**
+	 * Decoded PCM ROM samples. They belong to the ROM image and are shared among all the contexts
+	 * that use the same image, hence they aren't included in totalSize
+	 */
+	size_t sharedPCMROMSize;
+	/**
+	 * The default memory contents and the padded copies of the PCM waves shared in the reduced memory footprint mode,
+	 * see mt32emu_set_reduced_memory_footprint_enabled(). Also excluded from totalSize
+	 */
+	size_t sharedROMDataSize;
+	/**
+	 * The band-limited wavetables shared among all the contexts that use MT32EMU_RT_FLOAT_WAVETABLE renderer type.
+	 * Also excluded from totalSize
+	 */
+	size_t sharedWavetablesSize;
+	/** Reverb models of all the modes, with the delay lines of those which are open */
+	size_t reverbSize;
+	/** Ring buffers and SysEx storage of the internal MIDI event queue */
+	size_t midiEventQueuesSize;
+	/** Parts, polys and partials with the envelope and wave generators */
+	size_t partialsSize;
+	/** Renderer buffers and the analogue circuit emulation */
+	size_t rendererSize;
+	/**
+	 * The sample rate converter of the context. The internal state of libsoxr and libsamplerate is opaque,
+	 * so only the buffers of the adapters are reported when either is in use
+	 */
+	size_t sampleRateConverterSize;
+	/** Sum of all the above except for sharedPCMROMSize, sharedROMDataSize and sharedWavetablesSize */
+	size_t totalSize;
+} mt32emu_memory_usage;
+
+/** A consistent pair of the sample clock of a synth and the wall clock, see mt32emu_get_sample_clock(). */
+typedef struct {
+	/**
+	 * The global count of samples rendered since the synth was created (at the native sample rate 32000 Hz).
+	 * Unlike the 32-bit counter, which wraps in about 37 hours, it is exact for thousands of years as a double.
+	 */
+	double renderedSampleCount;
+	/**
+	 * Reading of the monotonic clock in nanoseconds upon completion of the rendering call that brought the count
+	 * to renderedSampleCount, i.e. CLOCK_MONOTONIC on POSIX systems and the performance counter on Windows, 0 before that.
+	 */
+	double clockNanos;
+} mt32emu_sample_clock;
+
+/** Describes a MIDI event enqueued along with others in a batch, see mt32emu_play_events(). */
+typedef struct {
+	/** Points to the data of a well formed System Exclusive MIDI message, or NULL for a short message */
+	const mt32emu_bit8u *sysex;
+	/** Length of the System Exclusive MIDI message, ignored for a short message */
+	mt32emu_bit32u sysexLength;
+	/** Short MIDI message that must contain a status byte, ignored for a System Exclusive MIDI message */
+	mt32emu_bit32u msg;
+	/**
+	 * Time to play the event at, the same as for mt32emu_play_msg_at(), or the offset in frames from the beginning of the stream
+	 * when rendering with events, e.g. with mt32emu_render_bit16s_with_events()
+	 */
+	mt32emu_bit32u timestamp;
+} mt32emu_midi_event;
+
+/** Modes of queueing the reports, see mt32emu_set_report_queueing(). */
+typedef enum {
+	/** The reports are delivered to the report handler immediately, which is the default */
+	MT32EMU_RQM_DISABLED = 0,
+	/** The reports are queued while rendering and delivered to the report handler at once before the rendering function returns */
+	MT32EMU_RQM_DELIVER_AFTER_RENDERING = 1,
+	/** The reports are queued until the client retrieves them with mt32emu_read_queued_reports() or mt32emu_deliver_queued_reports() */
+	MT32EMU_RQM_ON_DEMAND = 2
+} mt32emu_report_queueing_mode;
+
+/** Types of the queued reports, each corresponds to a callback of the report handler. */
+typedef enum {
+	MT32EMU_REPORT_LCD_MESSAGE = 0,
+	MT32EMU_REPORT_MIDI_MESSAGE_PLAYED = 1,
+	MT32EMU_REPORT_DEVICE_RESET = 2,
+	MT32EMU_REPORT_DEVICE_RECONFIG = 3,
+	MT32EMU_REPORT_NEW_REVERB_MODE = 4,
+	MT32EMU_REPORT_NEW_REVERB_TIME = 5,
+	MT32EMU_REPORT_NEW_REVERB_LEVEL = 6,
+	MT32EMU_REPORT_POLY_STATE_CHANGED = 7,
+	MT32EMU_REPORT_PROGRAM_CHANGED = 8,
+	/** Takes the last free entry of the queue when it gets full, the subsequent reports are lost until there is space again */
+	MT32EMU_REPORT_QUEUE_OVERFLOW = 9
+} mt32emu_report_type;
+
+/** A report kept in the report queue, see mt32emu_read_queued_reports(). The unused fields are zeroed. */
+typedef struct {
+	mt32emu_report_type type;
+	/** The part number for the poly state and program changes, or the new value for the changes of the reverb settings */
+	mt32emu_bit8u value;
+	/** For the program changes, the sound group name is empty when unknown */
+	char soundGroupName[9];
+	char patchName[11];
+	/** The message to display on the LCD, truncated to the 20 characters the LCD fits */
+	char lcdMessage[21];
+} mt32emu_report;
+
 /* === Interface handling === */
 
 /** Report handler interface versions */
@@ -127,7 +335,9 @@ typedef enum {
 	MT32EMU_SERVICE_VERSION_2 = 2,
 	MT32EMU_SERVICE_VERSION_3 = 3,
 	MT32EMU_SERVICE_VERSION_4 = 4,
-	MT32EMU_SERVICE_VERSION_CURRENT = MT32EMU_SERVICE_VERSION_4
+	MT32EMU_SERVICE_VERSION_5 = 5,
+	MT32EMU_SERVICE_VERSION_6 = 6,
+	MT32EMU_SERVICE_VERSION_CURRENT = MT32EMU_SERVICE_VERSION_6
 } mt32emu_service_version;
 
 /* === Report Handler Interface === */
@@ -327,6 +537,76 @@ typedef union mt32emu_service_i mt32emu_service_i;
 	mt32emu_return_code (*mergeAndAddROMFiles)(mt32emu_context context, const char *part1_filename, const char *part2_filename); \
 	mt32emu_return_code (*addMachineROMFile)(mt32emu_context context, const char *machine_id, const char *filename);
 
+#define MT32EMU_SERVICE_I_V5 \
+	void (*setRenderProfilingEnabled)(mt32emu_const_context context, const mt32emu_boolean enabled); \
+	mt32emu_boolean (*isRenderProfilingEnabled)(mt32emu_const_context context); \
+	void (*getRenderProfile)(mt32emu_const_context context, mt32emu_render_profile *render_profile); \
+	void (*resetRenderProfile)(mt32emu_const_context context);
+
+#define MT32EMU_SERVICE_I_V6 \
+	void (*renderFloatPlanar)(mt32emu_const_context context, float *left_stream, float *right_stream, mt32emu_bit32u len); \
+	double (*getSamplerateConversionLatency)(mt32emu_const_context context); \
+	mt32emu_boolean (*skipSilence)(mt32emu_const_context context, mt32emu_bit32u len); \
+	mt32emu_bit32u (*playEvents)(mt32emu_const_context context, const mt32emu_midi_event *events, mt32emu_bit32u count); \
+	void (*flushDeferredDebugMessages)(mt32emu_const_context context); \
+\
+	mt32emu_synth_group (*createSynthGroup)(mt32emu_bit32u output_count); \
+	void (*freeSynthGroup)(mt32emu_synth_group group); \
+	void (*addToSynthGroup)(mt32emu_synth_group group, mt32emu_const_context context, mt32emu_bit32u output_ix); \
+	void (*renderSynthGroupBit16s)(mt32emu_synth_group group, mt32emu_bit16s *stream, mt32emu_bit32u len); \
+	void (*renderSynthGroupFloat)(mt32emu_synth_group group, float *stream, mt32emu_bit32u len); \
+	void (*renderSynthGroupOutputsBit16s)(mt32emu_synth_group group, mt32emu_bit16s * const *streams, mt32emu_bit32u len); \
+	void (*renderSynthGroupOutputsFloat)(mt32emu_synth_group group, float * const *streams, mt32emu_bit32u len); \
+\
+	mt32emu_bit32u (*renderBit16sWithEvents)(mt32emu_const_context context, mt32emu_bit16s *stream, mt32emu_bit32u len, const mt32emu_midi_event *events, mt32emu_bit32u count); \
+	mt32emu_bit32u (*renderFloatWithEvents)(mt32emu_const_context context, float *stream, mt32emu_bit32u len, const mt32emu_midi_event *events, mt32emu_bit32u count); \
+	mt32emu_bit32u (*renderFloatPlanarWithEvents)(mt32emu_const_context context, float *left_stream, float *right_stream, mt32emu_bit32u len, const mt32emu_midi_event *events, mt32emu_bit32u count); \
+\
+	mt32emu_bit32u (*setMIDIEventQueueMaxSize)(mt32emu_const_context context, const mt32emu_bit32u max_queue_size); \
+	mt32emu_bit32u (*getMIDIEventQueueMaxSize)(mt32emu_const_context context); \
+	mt32emu_boolean (*getMIDIEventQueueStats)(mt32emu_const_context context, mt32emu_midi_event_queue_stats *stats); \
+	void (*resetMIDIEventQueueStats)(mt32emu_const_context context); \
+	mt32emu_boolean (*getMemoryUsage)(mt32emu_const_context context, mt32emu_memory_usage *usage); \
+	void (*setReducedMemoryFootprintEnabled)(mt32emu_const_context context, const mt32emu_boolean enabled); \
+	mt32emu_boolean (*isReducedMemoryFootprintEnabled)(mt32emu_const_context context); \
+\
+	mt32emu_bit32u (*getSupportedCPUFeatures)(void); \
+	void (*setEnabledCPUFeatures)(mt32emu_context context, mt32emu_bit32u cpu_features); \
+	mt32emu_bit32u (*getEnabledCPUFeatures)(mt32emu_context context); \
+	mt32emu_boolean (*getKernelVariant)(mt32emu_const_context context, mt32emu_bit32u kernel_index, const char **kernel_name, const char **variant_name); \
+\
+	mt32emu_boolean (*getPolyphonyStats)(mt32emu_const_context context, mt32emu_polyphony_stats *stats); \
+	void (*resetPolyphonyStats)(mt32emu_const_context context); \
+	double (*getOutputLatency)(mt32emu_const_context context); \
+	void (*renderBit16sPartStreams)(mt32emu_const_context context, const mt32emu_part_output_bit16s_streams *streams, mt32emu_bit32u len); \
+	void (*renderFloatPartStreams)(mt32emu_const_context context, const mt32emu_part_output_float_streams *streams, mt32emu_bit32u len); \
+	void (*setOutputDitherEnabled)(mt32emu_const_context context, const mt32emu_boolean enabled); \
+	mt32emu_boolean (*isOutputDitherEnabled)(mt32emu_const_context context); \
+	void (*setPartialCullingThreshold)(mt32emu_const_context context, float attenuation); \
+	float (*getPartialCullingThreshold)(mt32emu_const_context context); \
+	void (*setMemoryLockingEnabled)(mt32emu_const_context context, const mt32emu_boolean enabled); \
+	mt32emu_boolean (*isMemoryLockingEnabled)(mt32emu_const_context context); \
+	void (*setReverbPreparationDeferred)(mt32emu_const_context context, const mt32emu_boolean enabled); \
+	mt32emu_boolean (*isReverbPreparationDeferred)(mt32emu_const_context context); \
+	mt32emu_boolean (*prepareReverbModels)(mt32emu_const_context context); \
+	mt32emu_return_code (*reinitialiseSynth)(mt32emu_const_context context); \
+	void (*setOverloadGovernorEnabled)(mt32emu_const_context context, const mt32emu_boolean enabled); \
+	mt32emu_boolean (*isOverloadGovernorEnabled)(mt32emu_const_context context); \
+	void (*setOverloadGovernorRenderBudget)(mt32emu_const_context context, float budget); \
+	float (*getOverloadGovernorRenderBudget)(mt32emu_const_context context); \
+	mt32emu_bit32u (*getOverloadGovernorLevel)(mt32emu_const_context context); \
+	void (*setNUMANode)(mt32emu_const_context context, const mt32emu_bit32s node); \
+	mt32emu_bit32s (*getNUMANode)(mt32emu_const_context context); \
+	void (*getSampleClock)(mt32emu_const_context context, mt32emu_sample_clock *sample_clock); \
+	mt32emu_return_code (*playMsgAtSampleClock)(mt32emu_const_context context, mt32emu_bit32u msg, double timestamp); \
+	mt32emu_return_code (*playSysexAtSampleClock)(mt32emu_const_context context, const mt32emu_bit8u *sysex, mt32emu_bit32u len, double timestamp); \
+	void (*setReportQueueing)(mt32emu_const_context context, const mt32emu_report_queueing_mode mode, const mt32emu_bit32u capacity); \
+	mt32emu_report_queueing_mode (*getReportQueueingMode)(mt32emu_const_context context); \
+	mt32emu_bit32u (*readQueuedReports)(mt32emu_const_context context, mt32emu_report *reports, mt32emu_bit32u max_count); \
+	mt32emu_bit32u (*deliverQueuedReports)(mt32emu_const_context context); \
+	void (*setRhythmHitCacheEnabled)(mt32emu_const_context context, const mt32emu_boolean enabled); \
+	mt32emu_boolean (*isRhythmHitCacheEnabled)(mt32emu_const_context context);
+
 typedef struct {
 	MT32EMU_SERVICE_I_V0
 } mt32emu_service_i_v0;
@@ -357,6 +637,25 @@ typedef struct {
 	MT32EMU_SERVICE_I_V4
 } mt32emu_service_i_v4;
 
+typedef struct {
+	MT32EMU_SERVICE_I_V0
+	MT32EMU_SERVICE_I_V1
+	MT32EMU_SERVICE_I_V2
+	MT32EMU_SERVICE_I_V3
+	MT32EMU_SERVICE_I_V4
+	MT32EMU_SERVICE_I_V5
+} mt32emu_service_i_v5;
+
+typedef struct {
+	MT32EMU_SERVICE_I_V0
+	MT32EMU_SERVICE_I_V1
+	MT32EMU_SERVICE_I_V2
+	MT32EMU_SERVICE_I_V3
+	MT32EMU_SERVICE_I_V4
+	MT32EMU_SERVICE_I_V5
+	MT32EMU_SERVICE_I_V6
+} mt32emu_service_i_v6;
+
 /**
  * Extensible interface for all the library services.
  * Union intended to view an interface of any subsequent version as any parent interface not requiring a cast.
@@ -368,6 +667,8 @@ union mt32emu_service_i {
 	const mt32emu_service_i_v2 *v2;
 	const mt32emu_service_i_v3 *v3;
 	const mt32emu_service_i_v4 *v4;
+	const mt32emu_service_i_v5 *v5;
+	const mt32emu_service_i_v6 *v6;
 };
 
 #undef MT32EMU_SERVICE_I_V0
@@ -375,5 +676,7 @@ union mt32emu_service_i {
 #undef MT32EMU_SERVICE_I_V2
 #undef MT32EMU_SERVICE_I_V3
 #undef MT32EMU_SERVICE_I_V4
+#undef MT32EMU_SERVICE_I_V5
+#undef MT32EMU_SERVICE_I_V6
 
 #endif /* #ifndef MT32EMU_C_TYPES_H */
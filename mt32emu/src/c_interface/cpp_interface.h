@@ -118,6 +118,67 @@ mt32emu_service_i mt32emu_get_service_i();
 #define mt32emu_get_playing_notes i.v0->getPlayingNotes
 #define mt32emu_get_patch_name i.v0->getPatchName
 #define mt32emu_read_memory i.v0->readMemory
+#define mt32emu_set_render_profiling_enabled iV5()->setRenderProfilingEnabled
+#define mt32emu_is_render_profiling_enabled iV5()->isRenderProfilingEnabled
+#define mt32emu_get_render_profile iV5()->getRenderProfile
+#define mt32emu_reset_render_profile iV5()->resetRenderProfile
+#define mt32emu_render_float_planar iV6()->renderFloatPlanar
+#define mt32emu_get_samplerate_conversion_latency iV6()->getSamplerateConversionLatency
+#define mt32emu_skip_silence iV6()->skipSilence
+#define mt32emu_play_events iV6()->playEvents
+#define mt32emu_flush_deferred_debug_messages iV6()->flushDeferredDebugMessages
+#define mt32emu_create_synth_group iV6()->createSynthGroup
+#define mt32emu_free_synth_group iV6()->freeSynthGroup
+#define mt32emu_add_to_synth_group iV6()->addToSynthGroup
+#define mt32emu_render_synth_group_bit16s iV6()->renderSynthGroupBit16s
+#define mt32emu_render_synth_group_float iV6()->renderSynthGroupFloat
+#define mt32emu_render_synth_group_outputs_bit16s iV6()->renderSynthGroupOutputsBit16s
+#define mt32emu_render_synth_group_outputs_float iV6()->renderSynthGroupOutputsFloat
+#define mt32emu_render_bit16s_with_events iV6()->renderBit16sWithEvents
+#define mt32emu_render_float_with_events iV6()->renderFloatWithEvents
+#define mt32emu_render_float_planar_with_events iV6()->renderFloatPlanarWithEvents
+#define mt32emu_set_midi_event_queue_max_size iV6()->setMIDIEventQueueMaxSize
+#define mt32emu_get_midi_event_queue_max_size iV6()->getMIDIEventQueueMaxSize
+#define mt32emu_get_midi_event_queue_stats iV6()->getMIDIEventQueueStats
+#define mt32emu_reset_midi_event_queue_stats iV6()->resetMIDIEventQueueStats
+#define mt32emu_get_memory_usage iV6()->getMemoryUsage
+#define mt32emu_set_reduced_memory_footprint_enabled iV6()->setReducedMemoryFootprintEnabled
+#define mt32emu_is_reduced_memory_footprint_enabled iV6()->isReducedMemoryFootprintEnabled
+#define mt32emu_get_supported_cpu_features iV6()->getSupportedCPUFeatures
+#define mt32emu_set_enabled_cpu_features iV6()->setEnabledCPUFeatures
+#define mt32emu_get_enabled_cpu_features iV6()->getEnabledCPUFeatures
+#define mt32emu_get_kernel_variant iV6()->getKernelVariant
+#define mt32emu_get_polyphony_stats iV6()->getPolyphonyStats
+#define mt32emu_reset_polyphony_stats iV6()->resetPolyphonyStats
+#define mt32emu_get_output_latency iV6()->getOutputLatency
+#define mt32emu_render_bit16s_part_streams iV6()->renderBit16sPartStreams
+#define mt32emu_render_float_part_streams iV6()->renderFloatPartStreams
+#define mt32emu_set_output_dither_enabled iV6()->setOutputDitherEnabled
+#define mt32emu_is_output_dither_enabled iV6()->isOutputDitherEnabled
+#define mt32emu_set_partial_culling_threshold iV6()->setPartialCullingThreshold
+#define mt32emu_get_partial_culling_threshold iV6()->getPartialCullingThreshold
+#define mt32emu_set_memory_locking_enabled iV6()->setMemoryLockingEnabled
+#define mt32emu_is_memory_locking_enabled iV6()->isMemoryLockingEnabled
+#define mt32emu_set_reverb_preparation_deferred iV6()->setReverbPreparationDeferred
+#define mt32emu_is_reverb_preparation_deferred iV6()->isReverbPreparationDeferred
+#define mt32emu_prepare_reverb_models iV6()->prepareReverbModels
+#define mt32emu_reinitialise_synth iV6()->reinitialiseSynth
+#define mt32emu_set_overload_governor_enabled iV6()->setOverloadGovernorEnabled
+#define mt32emu_is_overload_governor_enabled iV6()->isOverloadGovernorEnabled
+#define mt32emu_set_overload_governor_render_budget iV6()->setOverloadGovernorRenderBudget
+#define mt32emu_get_overload_governor_render_budget iV6()->getOverloadGovernorRenderBudget
+#define mt32emu_get_overload_governor_level iV6()->getOverloadGovernorLevel
+#define mt32emu_set_numa_node iV6()->setNUMANode
+#define mt32emu_get_numa_node iV6()->getNUMANode
+#define mt32emu_get_sample_clock iV6()->getSampleClock
+#define mt32emu_play_msg_at_sample_clock iV6()->playMsgAtSampleClock
+#define mt32emu_play_sysex_at_sample_clock iV6()->playSysexAtSampleClock
+#define mt32emu_set_report_queueing iV6()->setReportQueueing
+#define mt32emu_get_report_queueing_mode iV6()->getReportQueueingMode
+#define mt32emu_read_queued_reports iV6()->readQueuedReports
+#define mt32emu_deliver_queued_reports iV6()->deliverQueuedReports
+#define mt32emu_set_rhythm_hit_cache_enabled iV6()->setRhythmHitCacheEnabled
+#define mt32emu_is_rhythm_hit_cache_enabled iV6()->isRhythmHitCacheEnabled
 
 #else // #if MT32EMU_API_TYPE == 2
 
@@ -227,19 +288,31 @@ public:
 	void setSamplerateConversionQuality(const SamplerateConversionQuality quality) { mt32emu_set_samplerate_conversion_quality(c, static_cast<mt32emu_samplerate_conversion_quality>(quality)); }
 	void selectRendererType(const RendererType newRendererType) { mt32emu_select_renderer_type(c, static_cast<mt32emu_renderer_type>(newRendererType)); }
 	RendererType getSelectedRendererType() { return static_cast<RendererType>(mt32emu_get_selected_renderer_type(c)); }
+	Bit32u getSupportedCPUFeatures() { return mt32emu_get_supported_cpu_features(); }
+	void setEnabledCPUFeatures(const Bit32u cpuFeatures) { mt32emu_set_enabled_cpu_features(c, cpuFeatures); }
+	Bit32u getEnabledCPUFeatures() { return mt32emu_get_enabled_cpu_features(c); }
+	bool getKernelVariant(const Bit32u kernelIndex, const char *&kernelName, const char *&variantName) { return mt32emu_get_kernel_variant(c, kernelIndex, &kernelName, &variantName) != MT32EMU_BOOL_FALSE; }
 	mt32emu_return_code openSynth() { return mt32emu_open_synth(c); }
 	void closeSynth() { mt32emu_close_synth(c); }
+	mt32emu_return_code reinitialiseSynth() { return mt32emu_reinitialise_synth(c); }
 	bool isOpen() { return mt32emu_is_open(c) != MT32EMU_BOOL_FALSE; }
 	Bit32u getActualStereoOutputSamplerate() { return mt32emu_get_actual_stereo_output_samplerate(c); }
 	Bit32u convertOutputToSynthTimestamp(Bit32u output_timestamp) { return mt32emu_convert_output_to_synth_timestamp(c, output_timestamp); }
 	Bit32u convertSynthToOutputTimestamp(Bit32u synth_timestamp) { return mt32emu_convert_synth_to_output_timestamp(c, synth_timestamp); }
+	double getSamplerateConversionLatency() { return mt32emu_get_samplerate_conversion_latency(c); }
+	double getOutputLatency() { return mt32emu_get_output_latency(c); }
 	void flushMIDIQueue() { mt32emu_flush_midi_queue(c); }
 	Bit32u setMIDIEventQueueSize(const Bit32u queue_size) { return mt32emu_set_midi_event_queue_size(c, queue_size); }
 	void configureMIDIEventQueueSysexStorage(const Bit32u storage_buffer_size) { mt32emu_configure_midi_event_queue_sysex_storage(c, storage_buffer_size); }
 	void setMIDIReceiver(mt32emu_midi_receiver_i midi_receiver, void *instance_data) { mt32emu_set_midi_receiver(c, midi_receiver, instance_data); }
 	void setMIDIReceiver(IMidiReceiver &midi_receiver) { setMIDIReceiver(CppInterfaceImpl::getMidiReceiverThunk(), &midi_receiver); }
+	void setReportQueueing(const mt32emu_report_queueing_mode mode, const Bit32u capacity = 0) { mt32emu_set_report_queueing(c, mode, capacity); }
+	mt32emu_report_queueing_mode getReportQueueingMode() { return mt32emu_get_report_queueing_mode(c); }
+	Bit32u readQueuedReports(mt32emu_report *reports, Bit32u max_count) { return mt32emu_read_queued_reports(c, reports, max_count); }
+	Bit32u deliverQueuedReports() { return mt32emu_deliver_queued_reports(c); }
 
 	Bit32u getInternalRenderedSampleCount() { return mt32emu_get_internal_rendered_sample_count(c); }
+	void getSampleClock(mt32emu_sample_clock *sample_clock) { mt32emu_get_sample_clock(c, sample_clock); }
 	void parseStream(const Bit8u *stream, Bit32u length) { mt32emu_parse_stream(c, stream, length); }
 	void parseStream_At(const Bit8u *stream, Bit32u length, Bit32u timestamp) { mt32emu_parse_stream_at(c, stream, length, timestamp); }
 	void playShortMessage(Bit32u message) { mt32emu_play_short_message(c, message); }
@@ -248,6 +321,9 @@ public:
 	mt32emu_return_code playSysex(const Bit8u *sysex, Bit32u len) { return mt32emu_play_sysex(c, sysex, len); }
 	mt32emu_return_code playMsgAt(Bit32u msg, Bit32u timestamp) { return mt32emu_play_msg_at(c, msg, timestamp); }
 	mt32emu_return_code playSysexAt(const Bit8u *sysex, Bit32u len, Bit32u timestamp) { return mt32emu_play_sysex_at(c, sysex, len, timestamp); }
+	mt32emu_return_code playMsgAtSampleClock(Bit32u msg, double timestamp) { return mt32emu_play_msg_at_sample_clock(c, msg, timestamp); }
+	mt32emu_return_code playSysexAtSampleClock(const Bit8u *sysex, Bit32u len, double timestamp) { return mt32emu_play_sysex_at_sample_clock(c, sysex, len, timestamp); }
+	Bit32u playEvents(const mt32emu_midi_event *events, Bit32u count) { return mt32emu_play_events(c, events, count); }
 
 	void playMsgNow(Bit32u msg) { mt32emu_play_msg_now(c, msg); }
 	void playMsgOnPart(Bit8u part, Bit8u code, Bit8u note, Bit8u velocity) { mt32emu_play_msg_on_part(c, part, code, note, velocity); }
@@ -262,6 +338,26 @@ public:
 	bool isMT32ReverbCompatibilityMode() { return mt32emu_is_mt32_reverb_compatibility_mode(c) != MT32EMU_BOOL_FALSE; }
 	bool isDefaultReverbMT32Compatible() { return mt32emu_is_default_reverb_mt32_compatible(c) != MT32EMU_BOOL_FALSE; }
 	void preallocateReverbMemory(const bool enabled) { mt32emu_preallocate_reverb_memory(c, enabled ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE); }
+	void setReducedMemoryFootprintEnabled(const bool enabled) { mt32emu_set_reduced_memory_footprint_enabled(c, enabled ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE); }
+	bool isReducedMemoryFootprintEnabled() { return mt32emu_is_reduced_memory_footprint_enabled(c) != MT32EMU_BOOL_FALSE; }
+	void setOutputDitherEnabled(const bool enabled) { mt32emu_set_output_dither_enabled(c, enabled ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE); }
+	bool isOutputDitherEnabled() { return mt32emu_is_output_dither_enabled(c) != MT32EMU_BOOL_FALSE; }
+	void setPartialCullingThreshold(const float attenuation) { mt32emu_set_partial_culling_threshold(c, attenuation); }
+	float getPartialCullingThreshold() { return mt32emu_get_partial_culling_threshold(c); }
+	void setRhythmHitCacheEnabled(const bool enabled) { mt32emu_set_rhythm_hit_cache_enabled(c, enabled ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE); }
+	bool isRhythmHitCacheEnabled() { return mt32emu_is_rhythm_hit_cache_enabled(c) != MT32EMU_BOOL_FALSE; }
+	void setOverloadGovernorEnabled(const bool enabled) { mt32emu_set_overload_governor_enabled(c, enabled ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE); }
+	bool isOverloadGovernorEnabled() { return mt32emu_is_overload_governor_enabled(c) != MT32EMU_BOOL_FALSE; }
+	void setOverloadGovernorRenderBudget(const float budget) { mt32emu_set_overload_governor_render_budget(c, budget); }
+	float getOverloadGovernorRenderBudget() { return mt32emu_get_overload_governor_render_budget(c); }
+	Bit32u getOverloadGovernorLevel() { return mt32emu_get_overload_governor_level(c); }
+	void setMemoryLockingEnabled(const bool enabled) { mt32emu_set_memory_locking_enabled(c, enabled ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE); }
+	bool isMemoryLockingEnabled() { return mt32emu_is_memory_locking_enabled(c) != MT32EMU_BOOL_FALSE; }
+	void setNUMANode(const Bit32s node) { mt32emu_set_numa_node(c, node); }
+	Bit32s getNUMANode() { return mt32emu_get_numa_node(c); }
+	void setReverbPreparationDeferred(const bool enabled) { mt32emu_set_reverb_preparation_deferred(c, enabled ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE); }
+	bool isReverbPreparationDeferred() { return mt32emu_is_reverb_preparation_deferred(c) != MT32EMU_BOOL_FALSE; }
+	bool prepareReverbModels() { return mt32emu_prepare_reverb_models(c) != MT32EMU_BOOL_FALSE; }
 
 	void setDACInputMode(const DACInputMode mode) { mt32emu_set_dac_input_mode(c, static_cast<mt32emu_dac_input_mode>(mode)); }
 	DACInputMode getDACInputMode() { return static_cast<DACInputMode>(mt32emu_get_dac_input_mode(c)); }
@@ -290,6 +386,8 @@ public:
 	void renderFloat(float *stream, Bit32u len) { mt32emu_render_float(c, stream, len); }
 	void renderBit16sStreams(const mt32emu_dac_output_bit16s_streams *streams, Bit32u len) { mt32emu_render_bit16s_streams(c, streams, len); }
 	void renderFloatStreams(const mt32emu_dac_output_float_streams *streams, Bit32u len) { mt32emu_render_float_streams(c, streams, len); }
+	void renderBit16sPartStreams(const mt32emu_part_output_bit16s_streams *streams, Bit32u len) { mt32emu_render_bit16s_part_streams(c, streams, len); }
+	void renderFloatPartStreams(const mt32emu_part_output_float_streams *streams, Bit32u len) { mt32emu_render_float_part_streams(c, streams, len); }
 
 	bool hasActivePartials() { return mt32emu_has_active_partials(c) != MT32EMU_BOOL_FALSE; }
 	bool isActive() { return mt32emu_is_active(c) != MT32EMU_BOOL_FALSE; }
@@ -300,6 +398,34 @@ public:
 	const char *getPatchName(Bit8u part_number) { return mt32emu_get_patch_name(c, part_number); }
 	void readMemory(Bit32u addr, Bit32u len, Bit8u *data) { mt32emu_read_memory(c, addr, len, data); }
 
+	void setRenderProfilingEnabled(const bool enabled) { mt32emu_set_render_profiling_enabled(c, enabled ? MT32EMU_BOOL_TRUE : MT32EMU_BOOL_FALSE); }
+	bool isRenderProfilingEnabled() { return mt32emu_is_render_profiling_enabled(c) != MT32EMU_BOOL_FALSE; }
+	void getRenderProfile(mt32emu_render_profile *render_profile) { mt32emu_get_render_profile(c, render_profile); }
+	void resetRenderProfile() { mt32emu_reset_render_profile(c); }
+	bool getPolyphonyStats(mt32emu_polyphony_stats *stats) { return mt32emu_get_polyphony_stats(c, stats) != MT32EMU_BOOL_FALSE; }
+	void resetPolyphonyStats() { mt32emu_reset_polyphony_stats(c); }
+	void flushDeferredDebugMessages() { mt32emu_flush_deferred_debug_messages(c); }
+
+	void renderFloatPlanar(float *left_stream, float *right_stream, Bit32u len) { mt32emu_render_float_planar(c, left_stream, right_stream, len); }
+	Bit32u renderBit16sWithEvents(Bit16s *stream, Bit32u len, const mt32emu_midi_event *events, Bit32u count) { return mt32emu_render_bit16s_with_events(c, stream, len, events, count); }
+	Bit32u renderFloatWithEvents(float *stream, Bit32u len, const mt32emu_midi_event *events, Bit32u count) { return mt32emu_render_float_with_events(c, stream, len, events, count); }
+	Bit32u renderFloatPlanarWithEvents(float *left_stream, float *right_stream, Bit32u len, const mt32emu_midi_event *events, Bit32u count) { return mt32emu_render_float_planar_with_events(c, left_stream, right_stream, len, events, count); }
+
+	Bit32u setMIDIEventQueueMaxSize(const Bit32u max_queue_size) { return mt32emu_set_midi_event_queue_max_size(c, max_queue_size); }
+	Bit32u getMIDIEventQueueMaxSize() { return mt32emu_get_midi_event_queue_max_size(c); }
+	bool getMIDIEventQueueStats(mt32emu_midi_event_queue_stats *stats) { return mt32emu_get_midi_event_queue_stats(c, stats) != MT32EMU_BOOL_FALSE; }
+	void resetMIDIEventQueueStats() { mt32emu_reset_midi_event_queue_stats(c); }
+	bool getMemoryUsage(mt32emu_memory_usage *usage) { return mt32emu_get_memory_usage(c, usage) != MT32EMU_BOOL_FALSE; }
+	bool skipSilence(Bit32u len) { return mt32emu_skip_silence(c, len) != MT32EMU_BOOL_FALSE; }
+
+	mt32emu_synth_group createSynthGroup(Bit32u output_count) { return mt32emu_create_synth_group(output_count); }
+	void freeSynthGroup(mt32emu_synth_group group) { mt32emu_free_synth_group(group); }
+	void addToSynthGroup(mt32emu_synth_group group, Bit32u output_ix) { mt32emu_add_to_synth_group(group, c, output_ix); }
+	void renderSynthGroup(mt32emu_synth_group group, Bit16s *stream, Bit32u len) { mt32emu_render_synth_group_bit16s(group, stream, len); }
+	void renderSynthGroup(mt32emu_synth_group group, float *stream, Bit32u len) { mt32emu_render_synth_group_float(group, stream, len); }
+	void renderSynthGroupOutputs(mt32emu_synth_group group, Bit16s * const *streams, Bit32u len) { mt32emu_render_synth_group_outputs_bit16s(group, streams, len); }
+	void renderSynthGroupOutputs(mt32emu_synth_group group, float * const *streams, Bit32u len) { mt32emu_render_synth_group_outputs_float(group, streams, len); }
+
 private:
 #if MT32EMU_API_TYPE == 2
 	const mt32emu_service_i i;
@@ -311,6 +437,8 @@ private:
 	const mt32emu_service_i_v2 *iV2() { return (getVersionID() < MT32EMU_SERVICE_VERSION_2) ? NULL : i.v2; }
 	const mt32emu_service_i_v3 *iV3() { return (getVersionID() < MT32EMU_SERVICE_VERSION_3) ? NULL : i.v3; }
 	const mt32emu_service_i_v4 *iV4() { return (getVersionID() < MT32EMU_SERVICE_VERSION_4) ? NULL : i.v4; }
+	const mt32emu_service_i_v5 *iV5() { return (getVersionID() < MT32EMU_SERVICE_VERSION_5) ? NULL : i.v5; }
+	const mt32emu_service_i_v6 *iV6() { return (getVersionID() < MT32EMU_SERVICE_VERSION_6) ? NULL : i.v6; }
 #endif
 
 	Service(const Service &);            // prevent copy-construction
@@ -521,6 +649,67 @@ static mt32emu_midi_receiver_i getMidiReceiverThunk() {
 #undef mt32emu_get_playing_notes
 #undef mt32emu_get_patch_name
 #undef mt32emu_read_memory
+#undef mt32emu_set_render_profiling_enabled
+#undef mt32emu_is_render_profiling_enabled
+#undef mt32emu_get_render_profile
+#undef mt32emu_reset_render_profile
+#undef mt32emu_render_float_planar
+#undef mt32emu_get_samplerate_conversion_latency
+#undef mt32emu_skip_silence
+#undef mt32emu_play_events
+#undef mt32emu_flush_deferred_debug_messages
+#undef mt32emu_create_synth_group
+#undef mt32emu_free_synth_group
+#undef mt32emu_add_to_synth_group
+#undef mt32emu_render_synth_group_bit16s
+#undef mt32emu_render_synth_group_float
+#undef mt32emu_render_synth_group_outputs_bit16s
+#undef mt32emu_render_synth_group_outputs_float
+#undef mt32emu_render_bit16s_with_events
+#undef mt32emu_render_float_with_events
+#undef mt32emu_render_float_planar_with_events
+#undef mt32emu_set_midi_event_queue_max_size
+#undef mt32emu_get_midi_event_queue_max_size
+#undef mt32emu_get_midi_event_queue_stats
+#undef mt32emu_reset_midi_event_queue_stats
+#undef mt32emu_get_memory_usage
+#undef mt32emu_set_reduced_memory_footprint_enabled
+#undef mt32emu_is_reduced_memory_footprint_enabled
+#undef mt32emu_get_supported_cpu_features
+#undef mt32emu_set_enabled_cpu_features
+#undef mt32emu_get_enabled_cpu_features
+#undef mt32emu_get_kernel_variant
+#undef mt32emu_get_polyphony_stats
+#undef mt32emu_reset_polyphony_stats
+#undef mt32emu_get_output_latency
+#undef mt32emu_render_bit16s_part_streams
+#undef mt32emu_render_float_part_streams
+#undef mt32emu_set_output_dither_enabled
+#undef mt32emu_is_output_dither_enabled
+#undef mt32emu_set_partial_culling_threshold
+#undef mt32emu_get_partial_culling_threshold
+#undef mt32emu_set_memory_locking_enabled
+#undef mt32emu_is_memory_locking_enabled
+#undef mt32emu_set_reverb_preparation_deferred
+#undef mt32emu_is_reverb_preparation_deferred
+#undef mt32emu_prepare_reverb_models
+#undef mt32emu_reinitialise_synth
+#undef mt32emu_set_overload_governor_enabled
+#undef mt32emu_is_overload_governor_enabled
+#undef mt32emu_set_overload_governor_render_budget
+#undef mt32emu_get_overload_governor_render_budget
+#undef mt32emu_get_overload_governor_level
+#undef mt32emu_set_numa_node
+#undef mt32emu_get_numa_node
+#undef mt32emu_get_sample_clock
+#undef mt32emu_play_msg_at_sample_clock
+#undef mt32emu_play_sysex_at_sample_clock
+#undef mt32emu_set_report_queueing
+#undef mt32emu_get_report_queueing_mode
+#undef mt32emu_read_queued_reports
+#undef mt32emu_deliver_queued_reports
+#undef mt32emu_set_rhythm_hit_cache_enabled
+#undef mt32emu_is_rhythm_hit_cache_enabled
 
 #endif // #if MT32EMU_API_TYPE == 2
 
@@ -30,6 +30,14 @@
 #define MT32EMU_DEBUG_SAMPLESTAMPS 0
 #endif
 
+// 0: The rendering may print debug messages and allocate memory in place, which is acceptable for most clients
+// 1: The rendering is realtime-safe: debug messages printed while rendering are deferred to a preallocated log
+//    until Synth::flushDeferredDebugMessages() is invoked, and the memory that is otherwise allocated on demand
+//    (e.g. the reverb buffers and the SysEx storage of the MIDI event queues) is preallocated by default
+#ifndef MT32EMU_REALTIME_SAFE
+#define MT32EMU_REALTIME_SAFE 0
+#endif
+
 // 0: No debug output for initialisation progress
 // 1: Debug output for initialisation progress
 #ifndef MT32EMU_MONITOR_INIT
@@ -18,6 +18,7 @@
 #ifndef MT32EMU_MMATH_H
 #define MT32EMU_MMATH_H
 
+#include <cfloat>
 #include <cmath>
 
 namespace MT32Emu {
@@ -63,6 +64,12 @@ static inline float LOG10F(float x) {
 	return log10(x);
 }
 
+// Replaces denormal values with zero, used for the state of the recursive filters where the floating-point unit
+// does not flush them itself.
+static inline float FLUSH_DENORMAL(float x) {
+	return (-FLT_MIN < x && x < FLT_MIN) ? 0.0f : x;
+}
+
 } // namespace MT32Emu
 
 #endif // #ifndef MT32EMU_MMATH_H
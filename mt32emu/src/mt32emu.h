@@ -68,11 +68,16 @@
 
 #include "Types.h"
 #include "File.h"
+#if MT32EMU_WITH_FILE_STREAMS
 #include "FileStream.h"
+#include "MappedFileStream.h"
+#endif
 #include "ROMInfo.h"
 #include "Synth.h"
 #include "MidiStreamParser.h"
 #include "SampleRateConverter.h"
+#include "SynthGroup.h"
+#include "AsyncRenderer.h"
 
 #if MT32EMU_RUNTIME_VERSION_CHECK == 1
 #include "VersionTagging.h"
@@ -113,9 +113,35 @@ namespace sha1
             result[3] += d;
             result[4] += e;
         }
+
+        void processBlocksPortable(unsigned int* result, const unsigned char* blocks, int blockCount)
+        {
+            // The reusable round buffer
+            unsigned int w[80];
+
+            for (; blockCount > 0; --blockCount)
+            {
+                // Init the round buffer with the 64 byte block data.
+                for (int roundPos = 0; roundPos < 16; ++roundPos)
+                {
+                    // This line will swap endian on big endian and keep endian on little endian.
+                    w[roundPos] = static_cast<unsigned int>(blocks[3])
+                            | (static_cast<unsigned int>(blocks[2]) << 8)
+                            | (static_cast<unsigned int>(blocks[1]) << 16)
+                            | (static_cast<unsigned int>(blocks[0]) << 24);
+                    blocks += 4;
+                }
+                innerHash(result, w);
+            }
+        }
     } // namespace
 
     void calc(const void* src, const int bytelength, unsigned char* hash)
+    {
+        calc(src, bytelength, hash, processBlocksPortable);
+    }
+
+    void calc(const void* src, const int bytelength, unsigned char* hash, BlockFunction processBlocks)
     {
         // Init the result array.
         unsigned int result[5] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
@@ -127,28 +153,12 @@ namespace sha1
         unsigned int w[80];
 
         // Loop through all complete 64byte blocks.
-        const int endOfFullBlocks = bytelength - 64;
-        int endCurrentBlock;
-        int currentBlock = 0;
-
-        while (currentBlock <= endOfFullBlocks)
-        {
-            endCurrentBlock = currentBlock + 64;
-
-            // Init the round buffer with the 64 byte block data.
-            for (int roundPos = 0; currentBlock < endCurrentBlock; currentBlock += 4)
-            {
-                // This line will swap endian on big endian and keep endian on little endian.
-                w[roundPos++] = static_cast<unsigned int>(sarray[currentBlock + 3])
-                        | (static_cast<unsigned int>(sarray[currentBlock + 2]) << 8)
-                        | (static_cast<unsigned int>(sarray[currentBlock + 1]) << 16)
-                        | (static_cast<unsigned int>(sarray[currentBlock]) << 24);
-            }
-            innerHash(result, w);
-        }
+        const int fullBlockCount = bytelength >> 6;
+        processBlocks(result, sarray, fullBlockCount);
+        const int currentBlock = fullBlockCount << 6;
 
         // Handle the last and not full 64 byte block if existing.
-        endCurrentBlock = bytelength - currentBlock;
+        const int endCurrentBlock = bytelength - currentBlock;
         clearWBuffert(w);
         int lastBlockBytes = 0;
         for (;lastBlockBytes < endCurrentBlock; ++lastBlockBytes)
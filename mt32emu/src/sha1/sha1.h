@@ -38,6 +38,18 @@ namespace sha1
      */
     void calc(const void* src, const int bytelength, unsigned char* hash);
 
+    /**
+     Processes the complete 64 byte blocks, which the blocks pointer is not necessarily aligned for,
+     updating the five words of the intermediate hash value in result.
+     */
+    typedef void (*BlockFunction)(unsigned int* result, const unsigned char* blocks, int blockCount);
+
+    /**
+     Same as above, except that the complete blocks are processed by the specified function,
+     e.g. one that makes use of the SHA instructions of the CPU.
+     */
+    void calc(const void* src, const int bytelength, unsigned char* hash, BlockFunction processBlocks);
+
     /**
      @param hash is 20 bytes of sha1 hash. This is the same data that is the result from the calc function.
      @param hexstring should point to a buffer of at least 41 bytes of size for storing the hexadecimal representation of the hash. A zero will be written at position 40, so the buffer will be a valid zero ended string.
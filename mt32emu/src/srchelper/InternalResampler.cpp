@@ -14,61 +14,549 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
+
 #include "InternalResampler.h"
 
 #include "srctools/include/SincResampler.h"
 #include "srctools/include/ResamplerModel.h"
 
+#include "../Kernels.h"
 #include "../Synth.h"
 
 using namespace SRCTools;
 
 namespace MT32Emu {
 
+static const unsigned int CHANNEL_COUNT = 2;
+
+// The resampler stages tend to request the input in small chunks of varying length, especially with short audio callbacks.
+// Since each call to Synth::render() has a fixed overhead, the synth is rendered ahead in blocks of this length instead.
+// Requests that are at least as long bypass the buffer.
+static const unsigned int SYNTH_READ_AHEAD_LENGTH = 256;
+
+template <class Sample>
+class SynthReadAheadBuffer {
+public:
+	SynthReadAheadBuffer() : bufferPtr(buffer), size(0)
+	{}
+
+	// Copies up to length frames from the buffer and returns the number copied.
+	unsigned int read(Sample *&outBuffer, unsigned int length) {
+		const unsigned int frameCount = size < length ? size : length;
+		const Sample *const end = bufferPtr + CHANNEL_COUNT * frameCount;
+		while (bufferPtr < end) {
+			*(outBuffer++) = *(bufferPtr++);
+		}
+		size -= frameCount;
+		return frameCount;
+	}
+
+	// Same as above but splits the channels into separate buffers.
+	unsigned int readPlanar(Sample *&leftBuffer, Sample *&rightBuffer, unsigned int length) {
+		const unsigned int frameCount = size < length ? size : length;
+		for (unsigned int i = 0; i < frameCount; i++) {
+			*(leftBuffer++) = *(bufferPtr++);
+			*(rightBuffer++) = *(bufferPtr++);
+		}
+		size -= frameCount;
+		return frameCount;
+	}
+
+	bool isEmpty() const {
+		return size == 0;
+	}
+
+	void fill(Synth &synth) {
+		synth.render(buffer, SYNTH_READ_AHEAD_LENGTH);
+		bufferPtr = buffer;
+		size = SYNTH_READ_AHEAD_LENGTH;
+	}
+
+private:
+	Sample buffer[CHANNEL_COUNT * SYNTH_READ_AHEAD_LENGTH];
+	const Sample *bufferPtr;
+	unsigned int size;
+};
+
 class SynthWrapper : public FloatSampleProvider {
 	Synth &synth;
+	SynthReadAheadBuffer<FloatSample> readAheadBuffer;
 
 public:
 	SynthWrapper(Synth &useSynth) : synth(useSynth)
 	{}
 
 	void getOutputSamples(FloatSample *outBuffer, unsigned int size) {
-		synth.render(outBuffer, size);
+		size -= readAheadBuffer.read(outBuffer, size);
+		if (size >= SYNTH_READ_AHEAD_LENGTH) {
+			synth.render(outBuffer, size);
+			return;
+		}
+		if (size == 0) return;
+		readAheadBuffer.fill(synth);
+		readAheadBuffer.read(outBuffer, size);
+	}
+
+	void getPlanarOutputSamples(FloatSample *leftBuffer, FloatSample *rightBuffer, unsigned int size) {
+		size -= readAheadBuffer.readPlanar(leftBuffer, rightBuffer, size);
+		if (size >= SYNTH_READ_AHEAD_LENGTH) {
+			synth.render(leftBuffer, rightBuffer, size);
+			return;
+		}
+		if (size == 0) return;
+		readAheadBuffer.fill(synth);
+		readAheadBuffer.readPlanar(leftBuffer, rightBuffer, size);
+	}
+};
+
+class FixedPointSynthWrapper : public IntSampleProvider {
+	Synth &synth;
+	SynthReadAheadBuffer<IntSample> readAheadBuffer;
+
+public:
+	FixedPointSynthWrapper(Synth &useSynth) : synth(useSynth)
+	{}
+
+	void getOutputSamples(IntSample *outBuffer, unsigned int size) {
+		size -= readAheadBuffer.read(outBuffer, size);
+		if (size >= SYNTH_READ_AHEAD_LENGTH) {
+			synth.render(outBuffer, size);
+			return;
+		}
+		if (size == 0) return;
+		readAheadBuffer.fill(synth);
+		readAheadBuffer.read(outBuffer, size);
 	}
 };
 
-static FloatSampleProvider &createModel(Synth &synth, SRCTools::FloatSampleProvider &synthSource, double targetSampleRate, SamplerateConversionQuality quality) {
-	static const double MAX_AUDIBLE_FREQUENCY = 20000.0;
+// Holds the DAC output streams rendered by the synth until the resampler models of all the lanes consume them.
+// The models of the lanes are identical and run in turn for the same output length, so they pull the same sequence
+// of input lengths. The first model to pull input that isn't queued yet renders the synth, the others find it queued.
+// Hence, the queues only retain the input of a single pull ahead, and growing them is rarely necessary.
+template <class Sample>
+class SynthStreamsQueue {
+public:
+	SynthStreamsQueue(Synth &useSynth) : synth(useSynth) {
+		for (unsigned int lane = 0; lane < InternalStreamsResampler::LANE_COUNT; lane++) {
+			lanes[lane].buffer = new Sample[CHANNEL_COUNT * INITIAL_LANE_CAPACITY];
+			lanes[lane].capacity = INITIAL_LANE_CAPACITY;
+			lanes[lane].start = 0;
+			lanes[lane].size = 0;
+		}
+	}
+
+	~SynthStreamsQueue() {
+		for (unsigned int lane = 0; lane < InternalStreamsResampler::LANE_COUNT; lane++) {
+			delete[] lanes[lane].buffer;
+		}
+	}
+
+	// Fills the buffer with length interleaved stereo frames of the lane, rendering the synth as necessary.
+	void read(unsigned int laneIx, Sample *outBuffer, unsigned int length) {
+		Lane &lane = lanes[laneIx];
+		while (lane.size < length) {
+			render();
+		}
+		const Sample *inBuffer = lane.buffer + CHANNEL_COUNT * lane.start;
+		const Sample *const end = inBuffer + CHANNEL_COUNT * length;
+		while (inBuffer < end) {
+			*(outBuffer++) = *(inBuffer++);
+		}
+		lane.size -= length;
+		lane.start = lane.size == 0 ? 0 : lane.start + length;
+	}
+
+	size_t getMemoryUsage() const {
+		size_t memoryUsage = sizeof(*this);
+		for (unsigned int lane = 0; lane < InternalStreamsResampler::LANE_COUNT; lane++) {
+			memoryUsage += CHANNEL_COUNT * lanes[lane].capacity * sizeof(Sample);
+		}
+		return memoryUsage;
+	}
+
+private:
+	// Enough to hold a complete run of a resampler stage along with a rendered block.
+	static const unsigned int INITIAL_LANE_CAPACITY = 2 * MAX_SAMPLES_PER_RUN + SYNTH_READ_AHEAD_LENGTH;
+
+	struct Lane {
+		Sample *buffer;
+		unsigned int capacity;
+		unsigned int start;
+		unsigned int size;
+	};
+
+	Synth &synth;
+	Lane lanes[InternalStreamsResampler::LANE_COUNT];
+	Sample streamBuffers[CHANNEL_COUNT * InternalStreamsResampler::LANE_COUNT][SYNTH_READ_AHEAD_LENGTH];
+
+	void render() {
+		const DACOutputStreams<Sample> streams = {
+			streamBuffers[0], streamBuffers[1], streamBuffers[2], streamBuffers[3], streamBuffers[4], streamBuffers[5]
+		};
+		synth.renderStreams(streams, SYNTH_READ_AHEAD_LENGTH);
+		for (unsigned int laneIx = 0; laneIx < InternalStreamsResampler::LANE_COUNT; laneIx++) {
+			Lane &lane = lanes[laneIx];
+			reserve(lane, SYNTH_READ_AHEAD_LENGTH);
+			Sample *outBuffer = lane.buffer + CHANNEL_COUNT * (lane.start + lane.size);
+			const Sample *leftBuffer = streamBuffers[CHANNEL_COUNT * laneIx];
+			const Sample *rightBuffer = streamBuffers[CHANNEL_COUNT * laneIx + 1];
+			for (unsigned int i = 0; i < SYNTH_READ_AHEAD_LENGTH; i++) {
+				*(outBuffer++) = leftBuffer[i];
+				*(outBuffer++) = rightBuffer[i];
+			}
+			lane.size += SYNTH_READ_AHEAD_LENGTH;
+		}
+	}
+
+	// Ensures there is room for the specified number of frames past the queued ones.
+	static void reserve(Lane &lane, unsigned int length) {
+		if (lane.start + lane.size + length <= lane.capacity) return;
+		Sample *buffer = lane.buffer;
+		if (lane.size + length > lane.capacity) {
+			while (lane.size + length > lane.capacity) {
+				lane.capacity *= 2;
+			}
+			buffer = new Sample[CHANNEL_COUNT * lane.capacity];
+		}
+		memmove(buffer, lane.buffer + CHANNEL_COUNT * lane.start, CHANNEL_COUNT * lane.size * sizeof(Sample));
+		if (buffer != lane.buffer) {
+			delete[] lane.buffer;
+			lane.buffer = buffer;
+		}
+		lane.start = 0;
+	}
+};
+
+class SynthStreamsLane : public FloatSampleProvider {
+	SynthStreamsQueue<FloatSample> &queue;
+	const unsigned int lane;
+
+public:
+	SynthStreamsLane(SynthStreamsQueue<FloatSample> &useQueue, unsigned int useLane) : queue(useQueue), lane(useLane)
+	{}
+
+	void getOutputSamples(FloatSample *outBuffer, unsigned int size) {
+		queue.read(lane, outBuffer, size);
+	}
+};
+
+class FixedPointSynthStreamsLane : public IntSampleProvider {
+	SynthStreamsQueue<IntSample> &queue;
+	const unsigned int lane;
+
+public:
+	FixedPointSynthStreamsLane(SynthStreamsQueue<IntSample> &useQueue, unsigned int useLane) : queue(useQueue), lane(useLane)
+	{}
+
+	void getOutputSamples(IntSample *outBuffer, unsigned int size) {
+		queue.read(lane, outBuffer, size);
+	}
+};
+
+static inline void storeSample(float *&outBuffer, FloatSample sample) {
+	*(outBuffer++) = sample;
+}
+
+static inline void storeSample(Bit16s *&outBuffer, FloatSample sample) {
+	*(outBuffer++) = Synth::convertSample(sample);
+}
+
+static inline void storeSample(float *&outBuffer, IntSample sample) {
+	*(outBuffer++) = Synth::convertSample(sample);
+}
+
+static inline void storeSample(Bit16s *&outBuffer, IntSample sample) {
+	*(outBuffer++) = sample;
+}
 
+// Splits interleaved stereo frames into the left and right buffers, either of which may be NULL to discard the channel.
+template <class InSample, class OutSample>
+static void splitChannels(const InSample *inBuffer, OutSample *&leftBuffer, OutSample *&rightBuffer, unsigned int length) {
+	for (unsigned int i = 0; i < length; i++) {
+		if (leftBuffer != NULL) storeSample(leftBuffer, inBuffer[0]);
+		if (rightBuffer != NULL) storeSample(rightBuffer, inBuffer[1]);
+		inBuffer += CHANNEL_COUNT;
+	}
+}
+
+} // namespace MT32Emu
+
+using namespace MT32Emu;
+
+static const double MAX_AUDIBLE_FREQUENCY = 20000.0;
+
+InternalResampler::InternalResampler(Synth &useSynth, double useTargetSampleRate, SamplerateConversionQuality quality, bool variableRatio) :
+	synth(useSynth),
+	targetSampleRate(useTargetSampleRate),
+	customStage(NULL),
+	fixedPointCustomStage(NULL),
+	analogLowPassFilterBypassed(false),
+	synthSource(NULL),
+	model(NULL),
+	fixedPointSynthSource(NULL),
+	fixedPointModel(NULL)
+{
+	if (synth.getSelectedRendererType() == RendererType_BIT16S) {
+		fixedPointSynthSource = new FixedPointSynthWrapper(synth);
+		fixedPointModel = &createFixedPointModel(quality, variableRatio);
+	} else {
+		synthSource = new SynthWrapper(synth);
+		model = &createModel(quality, variableRatio);
+	}
+}
+
+InternalResampler::~InternalResampler() {
+	if (fixedPointModel != NULL) {
+		ResamplerModel::freeResamplerModel(*fixedPointModel, *fixedPointSynthSource);
+		delete fixedPointCustomStage;
+		delete fixedPointSynthSource;
+		return;
+	}
+	ResamplerModel::freeResamplerModel(*model, *synthSource);
+	delete customStage;
+	if (analogLowPassFilterBypassed) {
+		synth.restoreAnalogLowPassFilter();
+	}
+	delete synthSource;
+}
+
+void InternalResampler::getOutputSamples(Bit16s *buffer, unsigned int length) {
+	if (fixedPointModel != NULL) {
+		fixedPointModel->getOutputSamples(buffer, length);
+		return;
+	}
+	float floatBuffer[CHANNEL_COUNT * MAX_SAMPLES_PER_RUN];
+	while (length > 0) {
+		const unsigned int size = MAX_SAMPLES_PER_RUN < length ? MAX_SAMPLES_PER_RUN : length;
+		model->getOutputSamples(floatBuffer, size);
+		synth.convertOutputSamples(floatBuffer, buffer, CHANNEL_COUNT * size);
+		buffer += CHANNEL_COUNT * size;
+		length -= size;
+	}
+}
+
+void InternalResampler::getOutputSamples(float *buffer, unsigned int length) {
+	if (model != NULL) {
+		model->getOutputSamples(buffer, length);
+		return;
+	}
+	Bit16s intBuffer[CHANNEL_COUNT * MAX_SAMPLES_PER_RUN];
+	while (length > 0) {
+		const unsigned int size = MAX_SAMPLES_PER_RUN < length ? MAX_SAMPLES_PER_RUN : length;
+		fixedPointModel->getOutputSamples(intBuffer, size);
+		synth.getKernels().convertIntToFloat(intBuffer, buffer, CHANNEL_COUNT * size);
+		buffer += CHANNEL_COUNT * size;
+		length -= size;
+	}
+}
+
+void InternalResampler::getOutputSamples(float *leftBuffer, float *rightBuffer, unsigned int length) {
+	if (model != NULL) {
+		model->getPlanarOutputSamples(leftBuffer, rightBuffer, length);
+		return;
+	}
+	Bit16s intBuffer[CHANNEL_COUNT * MAX_SAMPLES_PER_RUN];
+	while (length > 0) {
+		const unsigned int size = MAX_SAMPLES_PER_RUN < length ? MAX_SAMPLES_PER_RUN : length;
+		fixedPointModel->getOutputSamples(intBuffer, size);
+		const Bit16s *ins = intBuffer;
+		for (unsigned int i = 0; i < size; i++) {
+			*(leftBuffer++) = Synth::convertSample(*(ins++));
+			*(rightBuffer++) = Synth::convertSample(*(ins++));
+		}
+		length -= size;
+	}
+}
+
+bool InternalResampler::setRateAdjustment(double rateAdjustment) {
+	if (fixedPointModel != NULL) {
+		return ResamplerModel::setRateAdjustment(*fixedPointModel, *fixedPointSynthSource, rateAdjustment);
+	}
+	return ResamplerModel::setRateAdjustment(*model, *synthSource, rateAdjustment);
+}
+
+double InternalResampler::getLatency() const {
+	// When the analogue LPF is bypassed, the synth output sample rate drops accordingly
+	const double groupDelay = fixedPointModel != NULL ? ResamplerModel::getGroupDelay(*fixedPointModel, *fixedPointSynthSource)
+		: ResamplerModel::getGroupDelay(*model, *synthSource);
+	return groupDelay * targetSampleRate / synth.getStereoOutputSampleRate();
+}
+
+size_t InternalResampler::getMemoryUsage() const {
+	if (fixedPointModel != NULL) {
+		return sizeof(*this) + sizeof(FixedPointSynthWrapper) + ResamplerModel::getMemoryUsage(*fixedPointModel, *fixedPointSynthSource);
+	}
+	return sizeof(*this) + sizeof(SynthWrapper) + ResamplerModel::getMemoryUsage(*model, *synthSource);
+}
+
+FloatSampleProvider &InternalResampler::createModel(SamplerateConversionQuality quality, bool variableRatio) {
 	const double sourceSampleRate = synth.getStereoOutputSampleRate();
 	if (quality != SamplerateConversionQuality_FASTEST) {
-		const bool oversampledMode = synth.getStereoOutputSampleRate() == Synth::getStereoOutputSampleRate(AnalogOutputMode_OVERSAMPLED);
+		const bool oversampledMode = sourceSampleRate == Synth::getStereoOutputSampleRate(AnalogOutputMode_OVERSAMPLED);
 		// Oversampled input allows to bypass IIR interpolation stage and, in some cases, IIR decimation stage
 		if (oversampledMode && (0.5 * sourceSampleRate) <= targetSampleRate) {
 			// NOTE: In the oversampled mode, the transition band starts at 20kHz and ends at 28kHz
 			double passband = MAX_AUDIBLE_FREQUENCY;
 			double stopband = 0.5 * sourceSampleRate + MAX_AUDIBLE_FREQUENCY;
-			ResamplerStage &resamplerStage = *SincResampler::createSincResampler(sourceSampleRate, targetSampleRate, passband, stopband, ResamplerModel::DEFAULT_DB_SNR, ResamplerModel::DEFAULT_WINDOWED_SINC_MAX_UPSAMPLE_FACTOR);
-			return ResamplerModel::createResamplerModel(synthSource, resamplerStage);
+			customStage = createOversampledStage(sourceSampleRate, passband, stopband, variableRatio, quality == SamplerateConversionQuality_LOW_LATENCY);
+			return ResamplerModel::createResamplerModel(*synthSource, *customStage);
 		}
 	}
-	return ResamplerModel::createResamplerModel(synthSource, sourceSampleRate, targetSampleRate, static_cast<ResamplerModel::Quality>(quality));
+	return ResamplerModel::createResamplerModel(*synthSource, sourceSampleRate, targetSampleRate, static_cast<ResamplerModel::Quality>(quality), variableRatio);
 }
 
-} // namespace MT32Emu
+// The fixed-point model applies a single windowed sinc filter to the synth output. In the oversampled mode, the analogue LPF
+// isn't bypassed, as it is rendered in integer samples as well. Since it leaves nothing above 20kHz, the transition band
+// may be as wide as in the floating-point model.
+IntSampleProvider &InternalResampler::createFixedPointModel(SamplerateConversionQuality quality, bool variableRatio) {
+	const double sourceSampleRate = synth.getStereoOutputSampleRate();
+	if (quality != SamplerateConversionQuality_FASTEST) {
+		const bool oversampledMode = sourceSampleRate == Synth::getStereoOutputSampleRate(AnalogOutputMode_OVERSAMPLED);
+		if (oversampledMode && (0.5 * sourceSampleRate) <= targetSampleRate) {
+			double passband = MAX_AUDIBLE_FREQUENCY;
+			double stopband = 0.5 * sourceSampleRate + MAX_AUDIBLE_FREQUENCY;
+			fixedPointCustomStage = SincResampler::createFixedPointSincResampler(sourceSampleRate, targetSampleRate, passband, stopband, ResamplerModel::DEFAULT_DB_SNR, ResamplerModel::DEFAULT_WINDOWED_SINC_MAX_UPSAMPLE_FACTOR, variableRatio, quality == SamplerateConversionQuality_LOW_LATENCY);
+			return ResamplerModel::createResamplerModel(*fixedPointSynthSource, *fixedPointCustomStage);
+		}
+	}
+	return ResamplerModel::createResamplerModel(*fixedPointSynthSource, sourceSampleRate, targetSampleRate, static_cast<ResamplerModel::Quality>(quality), variableRatio);
+}
 
-using namespace MT32Emu;
+// In the oversampled mode, the synth output is upsampled by the analogue LPF only to be filtered once again by the windowed sinc
+// stage. Instead, the LPF is bypassed in the synth and fused with the windowed sinc into a single polyphase filter, which then
+// takes the signal at the internal sample rate. The response remains the same, while the intermediate oversampled signal is gone.
+ResamplerStage *InternalResampler::createOversampledStage(double sourceSampleRate, double passband, double stopband, bool variableRatio, bool minimumPhase) {
+	Bit32u lpfTapCount;
+	Bit32u lpfUpsampleFactor;
+	const FloatSample *lpfTaps = synth.bypassAccurateAnalogLowPassFilter(lpfTapCount, lpfUpsampleFactor);
+	if (lpfTaps == NULL) {
+		return SincResampler::createSincResampler(sourceSampleRate, targetSampleRate, passband, stopband, ResamplerModel::DEFAULT_DB_SNR, ResamplerModel::DEFAULT_WINDOWED_SINC_MAX_UPSAMPLE_FACTOR, variableRatio, minimumPhase);
+	}
+	analogLowPassFilterBypassed = true;
+	return SincResampler::createFusedSincResampler(SAMPLE_RATE, targetSampleRate, passband, stopband, ResamplerModel::DEFAULT_DB_SNR, ResamplerModel::DEFAULT_WINDOWED_SINC_MAX_UPSAMPLE_FACTOR, variableRatio, lpfTaps, lpfTapCount, lpfUpsampleFactor, minimumPhase);
+}
 
-InternalResampler::InternalResampler(Synth &synth, double targetSampleRate, SamplerateConversionQuality quality) :
-	synthSource(*new SynthWrapper(synth)),
-	model(createModel(synth, synthSource, targetSampleRate, quality))
-{}
+InternalStreamsResampler::InternalStreamsResampler(Synth &synth, double useTargetSampleRate, SamplerateConversionQuality quality, bool variableRatio) :
+	targetSampleRate(useTargetSampleRate),
+	queue(NULL),
+	fixedPointQueue(NULL)
+{
+	const ResamplerModel::Quality modelQuality = static_cast<ResamplerModel::Quality>(quality);
+	for (unsigned int lane = 0; lane < LANE_COUNT; lane++) {
+		laneSources[lane] = NULL;
+		models[lane] = NULL;
+		fixedPointLaneSources[lane] = NULL;
+		fixedPointModels[lane] = NULL;
+	}
+	if (synth.getSelectedRendererType() == RendererType_BIT16S) {
+		fixedPointQueue = new SynthStreamsQueue<IntSample>(synth);
+		for (unsigned int lane = 0; lane < LANE_COUNT; lane++) {
+			fixedPointLaneSources[lane] = new FixedPointSynthStreamsLane(*fixedPointQueue, lane);
+			fixedPointModels[lane] = &ResamplerModel::createResamplerModel(*fixedPointLaneSources[lane], SAMPLE_RATE, targetSampleRate, modelQuality, variableRatio);
+		}
+	} else {
+		queue = new SynthStreamsQueue<FloatSample>(synth);
+		for (unsigned int lane = 0; lane < LANE_COUNT; lane++) {
+			laneSources[lane] = new SynthStreamsLane(*queue, lane);
+			models[lane] = &ResamplerModel::createResamplerModel(*laneSources[lane], SAMPLE_RATE, targetSampleRate, modelQuality, variableRatio);
+		}
+	}
+}
 
-InternalResampler::~InternalResampler() {
-	ResamplerModel::freeResamplerModel(model, synthSource);
-	delete &synthSource;
+InternalStreamsResampler::~InternalStreamsResampler() {
+	for (unsigned int lane = 0; lane < LANE_COUNT; lane++) {
+		if (fixedPointModels[lane] != NULL) {
+			ResamplerModel::freeResamplerModel(*fixedPointModels[lane], *fixedPointLaneSources[lane]);
+			delete fixedPointLaneSources[lane];
+		} else {
+			ResamplerModel::freeResamplerModel(*models[lane], *laneSources[lane]);
+			delete laneSources[lane];
+		}
+	}
+	delete fixedPointQueue;
+	delete queue;
 }
 
-void InternalResampler::getOutputSamples(float *buffer, unsigned int length) {
-	model.getOutputSamples(buffer, length);
+void InternalStreamsResampler::getOutputStreams(const DACOutputStreams<Bit16s> &streams, unsigned int length) {
+	Bit16s * const outBuffers[] = {
+		streams.nonReverbLeft, streams.nonReverbRight, streams.reverbDryLeft, streams.reverbDryRight, streams.reverbWetLeft, streams.reverbWetRight
+	};
+	renderLanes(outBuffers, length);
+}
+
+void InternalStreamsResampler::getOutputStreams(const DACOutputStreams<float> &streams, unsigned int length) {
+	float * const outBuffers[] = {
+		streams.nonReverbLeft, streams.nonReverbRight, streams.reverbDryLeft, streams.reverbDryRight, streams.reverbWetLeft, streams.reverbWetRight
+	};
+	if (queue != NULL && outBuffers[0] != NULL && outBuffers[1] != NULL && outBuffers[2] != NULL
+		&& outBuffers[3] != NULL && outBuffers[4] != NULL && outBuffers[5] != NULL)
+	{
+		// The floating-point models write planar output directly.
+		unsigned int offset = 0;
+		while (offset < length) {
+			const unsigned int size = MAX_SAMPLES_PER_RUN < length - offset ? MAX_SAMPLES_PER_RUN : length - offset;
+			for (unsigned int lane = 0; lane < LANE_COUNT; lane++) {
+				models[lane]->getPlanarOutputSamples(outBuffers[CHANNEL_COUNT * lane] + offset, outBuffers[CHANNEL_COUNT * lane + 1] + offset, size);
+			}
+			offset += size;
+		}
+		return;
+	}
+	renderLanes(outBuffers, length);
+}
+
+// The lanes are run in turn within each chunk, so that the queued input never exceeds a single run of the models.
+// Each lane is run even if both its streams are skipped, otherwise it would fall behind the others.
+template <class OutSample>
+void InternalStreamsResampler::renderLanes(OutSample * const *outBuffers, unsigned int length) {
+	OutSample *outs[CHANNEL_COUNT * LANE_COUNT];
+	for (unsigned int i = 0; i < CHANNEL_COUNT * LANE_COUNT; i++) {
+		outs[i] = outBuffers[i];
+	}
+	FloatSample floatBuffer[CHANNEL_COUNT * MAX_SAMPLES_PER_RUN];
+	IntSample intBuffer[CHANNEL_COUNT * MAX_SAMPLES_PER_RUN];
+	while (length > 0) {
+		const unsigned int size = MAX_SAMPLES_PER_RUN < length ? MAX_SAMPLES_PER_RUN : length;
+		for (unsigned int lane = 0; lane < LANE_COUNT; lane++) {
+			if (fixedPointModels[lane] != NULL) {
+				fixedPointModels[lane]->getOutputSamples(intBuffer, size);
+				splitChannels(intBuffer, outs[CHANNEL_COUNT * lane], outs[CHANNEL_COUNT * lane + 1], size);
+			} else {
+				models[lane]->getOutputSamples(floatBuffer, size);
+				splitChannels(floatBuffer, outs[CHANNEL_COUNT * lane], outs[CHANNEL_COUNT * lane + 1], size);
+			}
+		}
+		length -= size;
+	}
+}
+
+bool InternalStreamsResampler::setRateAdjustment(double rateAdjustment) {
+	bool result = true;
+	for (unsigned int lane = 0; lane < LANE_COUNT; lane++) {
+		if (fixedPointModels[lane] != NULL) {
+			result = ResamplerModel::setRateAdjustment(*fixedPointModels[lane], *fixedPointLaneSources[lane], rateAdjustment) && result;
+		} else {
+			result = ResamplerModel::setRateAdjustment(*models[lane], *laneSources[lane], rateAdjustment) && result;
+		}
+	}
+	return result;
+}
+
+double InternalStreamsResampler::getLatency() const {
+	const double groupDelay = fixedPointModels[0] != NULL ? ResamplerModel::getGroupDelay(*fixedPointModels[0], *fixedPointLaneSources[0])
+		: ResamplerModel::getGroupDelay(*models[0], *laneSources[0]);
+	return groupDelay * targetSampleRate / SAMPLE_RATE;
+}
+
+size_t InternalStreamsResampler::getMemoryUsage() const {
+	size_t memoryUsage = sizeof(*this);
+	for (unsigned int lane = 0; lane < LANE_COUNT; lane++) {
+		if (fixedPointModels[lane] != NULL) {
+			memoryUsage += sizeof(FixedPointSynthStreamsLane) + ResamplerModel::getMemoryUsage(*fixedPointModels[lane], *fixedPointLaneSources[lane]);
+		} else {
+			memoryUsage += sizeof(SynthStreamsLane) + ResamplerModel::getMemoryUsage(*models[lane], *laneSources[lane]);
+		}
+	}
+	return memoryUsage + (fixedPointQueue != NULL ? fixedPointQueue->getMemoryUsage() : queue->getMemoryUsage());
 }
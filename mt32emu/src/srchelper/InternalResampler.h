@@ -17,24 +17,79 @@
 #ifndef MT32EMU_INTERNAL_RESAMPLER_H
 #define MT32EMU_INTERNAL_RESAMPLER_H
 
+#include "../Types.h"
 #include "../Enumerations.h"
 
 #include "srctools/include/FloatSampleProvider.h"
+#include "srctools/include/IntSampleProvider.h"
+#include "srctools/include/ResamplerStage.h"
+#include "srctools/include/FixedPointFIRResampler.h"
 
 namespace MT32Emu {
 
 class Synth;
+template <class T> struct DACOutputStreams;
+template <class Sample> class SynthStreamsQueue;
 
 class InternalResampler {
 public:
-	InternalResampler(Synth &synth, double targetSampleRate, SamplerateConversionQuality quality);
+	InternalResampler(Synth &synth, double targetSampleRate, SamplerateConversionQuality quality, bool variableRatio);
 	~InternalResampler();
 
+	void getOutputSamples(Bit16s *buffer, unsigned int length);
 	void getOutputSamples(float *buffer, unsigned int length);
+	void getOutputSamples(float *leftBuffer, float *rightBuffer, unsigned int length);
+	bool setRateAdjustment(double rateAdjustment);
+	double getLatency() const;
+	size_t getMemoryUsage() const;
 
 private:
-	SRCTools::FloatSampleProvider &synthSource;
-	SRCTools::FloatSampleProvider &model;
+	Synth &synth;
+	const double targetSampleRate;
+	// The stage of a custom model is owned here, unlike the default model that owns its stages
+	SRCTools::ResamplerStage *customStage;
+	SRCTools::FixedPointFIRResampler *fixedPointCustomStage;
+	bool analogLowPassFilterBypassed;
+	// Only one of the two models is created. When the synth renders integer samples, the fixed-point model is used,
+	// so that the entire pipeline avoids floating-point arithmetic.
+	SRCTools::FloatSampleProvider *synthSource;
+	SRCTools::FloatSampleProvider *model;
+	SRCTools::IntSampleProvider *fixedPointSynthSource;
+	SRCTools::IntSampleProvider *fixedPointModel;
+
+	SRCTools::FloatSampleProvider &createModel(SamplerateConversionQuality quality, bool variableRatio);
+	SRCTools::IntSampleProvider &createFixedPointModel(SamplerateConversionQuality quality, bool variableRatio);
+	SRCTools::ResamplerStage *createOversampledStage(double sourceSampleRate, double passband, double stopband, bool variableRatio, bool minimumPhase);
+};
+
+// Converts the DAC output streams of the synth. Each stereo pair of streams is a lane with its own resampler model,
+// while all the lanes share the rendered input, so the synth is rendered once. The streams bypass the analogue circuit
+// emulation, hence the conversion always starts at the internal sample rate.
+class InternalStreamsResampler {
+public:
+	static const unsigned int LANE_COUNT = 3;
+
+	InternalStreamsResampler(Synth &synth, double targetSampleRate, SamplerateConversionQuality quality, bool variableRatio);
+	~InternalStreamsResampler();
+
+	void getOutputStreams(const DACOutputStreams<Bit16s> &streams, unsigned int length);
+	void getOutputStreams(const DACOutputStreams<float> &streams, unsigned int length);
+	bool setRateAdjustment(double rateAdjustment);
+	double getLatency() const;
+	size_t getMemoryUsage() const;
+
+private:
+	const double targetSampleRate;
+	// As in InternalResampler, the fixed-point models are only created when the synth renders integer samples.
+	SynthStreamsQueue<SRCTools::FloatSample> *queue;
+	SRCTools::FloatSampleProvider *laneSources[LANE_COUNT];
+	SRCTools::FloatSampleProvider *models[LANE_COUNT];
+	SynthStreamsQueue<SRCTools::IntSample> *fixedPointQueue;
+	SRCTools::IntSampleProvider *fixedPointLaneSources[LANE_COUNT];
+	SRCTools::IntSampleProvider *fixedPointModels[LANE_COUNT];
+
+	template <class OutSample>
+	void renderLanes(OutSample * const *outBuffers, unsigned int length);
 };
 
 } // namespace MT32Emu
@@ -31,12 +31,14 @@ long SamplerateAdapter::getInputSamples(void *cb_data, float **data) {
 	return length;
 }
 
-SamplerateAdapter::SamplerateAdapter(Synth &useSynth, double targetSampleRate, SamplerateConversionQuality quality) :
+SamplerateAdapter::SamplerateAdapter(Synth &useSynth, double targetSampleRate, SamplerateConversionQuality quality, bool useVariableRatio) :
 	synth(useSynth),
 	inBuffer(new float[CHANNEL_COUNT * MAX_SAMPLES_PER_RUN]),
 	inBufferSize(MAX_SAMPLES_PER_RUN),
+	nominalOutputToInputRatio(targetSampleRate / useSynth.getStereoOutputSampleRate()),
+	variableRatio(useVariableRatio),
 	inputToOutputRatio(useSynth.getStereoOutputSampleRate() / targetSampleRate),
-	outputToInputRatio(targetSampleRate / useSynth.getStereoOutputSampleRate())
+	outputToInputRatio(nominalOutputToInputRatio)
 {
 	int error;
 	int conversionType;
@@ -45,6 +47,8 @@ SamplerateAdapter::SamplerateAdapter(Synth &useSynth, double targetSampleRate, S
 		conversionType = SRC_LINEAR;
 		break;
 	case SamplerateConversionQuality_FAST:
+	case SamplerateConversionQuality_LOW_LATENCY:
+		// The sinc filters are only linear-phase, the shortest one introduces the least delay
 		conversionType = SRC_SINC_FASTEST;
 		break;
 	case SamplerateConversionQuality_BEST:
@@ -97,3 +101,21 @@ void SamplerateAdapter::getOutputSamples(float *buffer, unsigned int length) {
 		length -= gotFrames;
 	}
 }
+
+bool SamplerateAdapter::setRateAdjustment(double rateAdjustment) {
+	// The callback API of libsamplerate accepts a new ratio with each read
+	if (resampler == NULL || !variableRatio) return false;
+	outputToInputRatio = nominalOutputToInputRatio * rateAdjustment;
+	inputToOutputRatio = 1.0 / outputToInputRatio;
+	return true;
+}
+
+double SamplerateAdapter::getLatency() const {
+	// libsamplerate doesn't report the delay of its filters
+	return -1.0;
+}
+
+// The internal state of libsamplerate is opaque, so only the adapter itself is accounted for.
+size_t SamplerateAdapter::getMemoryUsage() const {
+	return sizeof(*this) + CHANNEL_COUNT * MAX_SAMPLES_PER_RUN * sizeof(*inBuffer);
+}
@@ -27,17 +27,22 @@ class Synth;
 
 class SamplerateAdapter {
 public:
-	SamplerateAdapter(Synth &synth, double targetSampleRate, SamplerateConversionQuality quality);
+	SamplerateAdapter(Synth &synth, double targetSampleRate, SamplerateConversionQuality quality, bool variableRatio);
 	~SamplerateAdapter();
 
 	void getOutputSamples(float *outBuffer, unsigned int length);
+	bool setRateAdjustment(double rateAdjustment);
+	double getLatency() const;
+	size_t getMemoryUsage() const;
 
 private:
 	Synth &synth;
 	float * const inBuffer;
 	unsigned int inBufferSize;
-	const double inputToOutputRatio;
-	const double outputToInputRatio;
+	const double nominalOutputToInputRatio;
+	const bool variableRatio;
+	double inputToOutputRatio;
+	double outputToInputRatio;
 	SRC_STATE *resampler;
 
 	static long getInputSamples(void *cb_data, float **data);
@@ -16,6 +16,7 @@
 
 #include "SoxrAdapter.h"
 
+#include "../SampleRateConverter.h"
 #include "../Synth.h"
 
 using namespace MT32Emu;
@@ -30,9 +31,11 @@ size_t SoxrAdapter::getInputSamples(void *input_fn_state, soxr_in_t *data, size_
 	return length;
 }
 
-SoxrAdapter::SoxrAdapter(Synth &useSynth, double targetSampleRate, SamplerateConversionQuality quality) :
+SoxrAdapter::SoxrAdapter(Synth &useSynth, double targetSampleRate, SamplerateConversionQuality quality, bool useVariableRatio) :
 	synth(useSynth),
-	inBuffer(new float[CHANNEL_COUNT * MAX_SAMPLES_PER_RUN])
+	inBuffer(new float[CHANNEL_COUNT * MAX_SAMPLES_PER_RUN]),
+	nominalInputToOutputRatio(useSynth.getStereoOutputSampleRate() / targetSampleRate),
+	variableRatio(useVariableRatio)
 {
 	soxr_io_spec_t ioSpec = soxr_io_spec(SOXR_FLOAT32_I, SOXR_FLOAT32_I);
 	unsigned long qualityRecipe;
@@ -46,15 +49,29 @@ SoxrAdapter::SoxrAdapter(Synth &useSynth, double targetSampleRate, SamplerateCon
 	case SamplerateConversionQuality_GOOD:
 		qualityRecipe = SOXR_MQ;
 		break;
+	case SamplerateConversionQuality_LOW_LATENCY:
+		qualityRecipe = SOXR_16_BITQ | SOXR_MINIMUM_PHASE;
+		break;
 	case SamplerateConversionQuality_BEST:
 	default:
 		qualityRecipe = SOXR_16_BITQ;
 		break;
 	};
-	soxr_quality_spec_t qSpec = soxr_quality_spec(qualityRecipe, 0);
 	soxr_runtime_spec_t rtSpec = soxr_runtime_spec(1);
 	soxr_error_t error;
-	resampler = soxr_create(synth.getStereoOutputSampleRate(), targetSampleRate, CHANNEL_COUNT, &error, &ioSpec, &qSpec, &rtSpec);
+	if (variableRatio) {
+		// SOXR only supports variable-rate resampling with the HQ recipe. The resampler is created for the maximum ratio
+		// while the current one is set separately.
+		const unsigned long phaseResponse = quality == SamplerateConversionQuality_LOW_LATENCY ? SOXR_MINIMUM_PHASE : SOXR_LINEAR_PHASE;
+		soxr_quality_spec_t qSpec = soxr_quality_spec(SOXR_HQ | phaseResponse, SOXR_VR);
+		resampler = soxr_create(nominalInputToOutputRatio / SAMPLE_RATE_CONVERTER_MIN_RATE_ADJUSTMENT, 1, CHANNEL_COUNT, &error, &ioSpec, &qSpec, &rtSpec);
+		if (error == NULL) {
+			error = soxr_set_io_ratio(resampler, nominalInputToOutputRatio, 0);
+		}
+	} else {
+		soxr_quality_spec_t qSpec = soxr_quality_spec(qualityRecipe, 0);
+		resampler = soxr_create(synth.getStereoOutputSampleRate(), targetSampleRate, CHANNEL_COUNT, &error, &ioSpec, &qSpec, &rtSpec);
+	}
 	if (error != NULL) {
 		synth.printDebug("SoxrAdapter: Creation of SOXR instance failed: %s\n", soxr_strerror(error));
 		soxr_delete(resampler);
@@ -104,3 +121,23 @@ void SoxrAdapter::getOutputSamples(float *buffer, unsigned int length) {
 		length -= static_cast<unsigned int>(gotFrames);
 	}
 }
+
+double SoxrAdapter::getLatency() const {
+	return resampler == NULL ? 0.0 : soxr_delay(resampler);
+}
+
+// The internal state of libsoxr is opaque, so only the adapter itself is accounted for.
+size_t SoxrAdapter::getMemoryUsage() const {
+	return sizeof(*this) + CHANNEL_COUNT * MAX_SAMPLES_PER_RUN * sizeof(*inBuffer);
+}
+
+bool SoxrAdapter::setRateAdjustment(double rateAdjustment) {
+	if (resampler == NULL || !variableRatio) return false;
+	// Let SOXR change the ratio smoothly over a short run
+	soxr_error_t error = soxr_set_io_ratio(resampler, nominalInputToOutputRatio / rateAdjustment, MAX_SAMPLES_PER_RUN);
+	if (error != NULL) {
+		synth.printDebug("SoxrAdapter: Setting SOXR I/O ratio failed: %s\n", soxr_strerror(error));
+		return false;
+	}
+	return true;
+}
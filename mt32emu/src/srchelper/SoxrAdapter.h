@@ -27,14 +27,19 @@ class Synth;
 
 class SoxrAdapter {
 public:
-	SoxrAdapter(Synth &synth, double targetSampleRate, SamplerateConversionQuality quality);
+	SoxrAdapter(Synth &synth, double targetSampleRate, SamplerateConversionQuality quality, bool variableRatio);
 	~SoxrAdapter();
 
 	void getOutputSamples(float *buffer, unsigned int length);
+	bool setRateAdjustment(double rateAdjustment);
+	double getLatency() const;
+	size_t getMemoryUsage() const;
 
 private:
 	Synth &synth;
 	float * const inBuffer;
+	const double nominalInputToOutputRatio;
+	const bool variableRatio;
 	soxr_t resampler;
 
 	static size_t getInputSamples(void *input_fn_state, soxr_in_t *data, size_t requested_len);
@@ -25,41 +25,85 @@ typedef FloatSample FIRCoefficient;
 
 static const unsigned int FIR_INTERPOLATOR_CHANNEL_COUNT = 2;
 
+// Number of delay line samples processed per iteration of the convolution loop. Together with the interleaved channels,
+// this makes up the number of independent accumulators, so that the loop maps well to vector instructions.
+static const unsigned int FIR_INTERPOLATOR_SAMPLES_PER_ITERATION = 4;
+
+// Immutable filter data prepared for the convolution. Since it doesn't change while resampling, a single instance
+// may be shared among FIRResampler instances that use the same kernel.
+class FIRKernel {
+public:
+	// Filter coefficients rearranged by phase. The taps of each phase are stored contiguously in the order
+	// they are applied to the delay line samples, each tap is repeated for every channel to match the layout
+	// of the delay line. The tail is padded with zeros, and an extra phase is appended for tap interpolation.
+	const FIRCoefficient *phaseTaps;
+	// Indicates whether to interpolate filter taps
+	bool usePhaseInterpolation;
+	// Number of delay line samples each phase is applied to, a multiple of FIR_INTERPOLATOR_SAMPLES_PER_ITERATION
+	unsigned int phaseLength;
+	// Upsampling factor
+	unsigned int numberOfPhases;
+	// Downsampling factor
+	double phaseIncrement;
+	// Delay of the low-frequency content in input samples, the centre of the kernel unless it isn't linear-phase
+	double groupDelay;
+
+	// Specifying variableRatio enables the tap interpolation regardless of the downsampling factor, so that the phase increment
+	// can be adjusted while resampling.
+	FIRKernel(const unsigned int upsampleFactor, const double downsampleFactor, const FIRCoefficient kernel[], const unsigned int kernelLength, const bool variableRatio = false);
+	virtual ~FIRKernel();
+
+	// Invoked by a FIRResampler when it no longer uses the kernel. By default, the kernel is owned by a single
+	// FIRResampler, so it is simply deleted. Shared kernels override this to maintain a reference count.
+	virtual void release() const;
+
+	// Returns the number of bytes occupied by the kernel and its filter coefficients.
+	size_t getMemoryUsage() const;
+
+private:
+	FIRKernel(const FIRKernel &);
+	FIRKernel &operator=(const FIRKernel &);
+}; // class FIRKernel
+
 class FIRResampler : public ResamplerStage {
 public:
 	FIRResampler(const unsigned int upsampleFactor, const double downsampleFactor, const FIRCoefficient kernel[], const unsigned int kernelLength);
+	// Creates a resampler that uses the provided kernel, which is released when the resampler is destroyed.
+	explicit FIRResampler(const FIRKernel &kernel);
 	~FIRResampler();
 
 	void process(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outSamples, unsigned int &outLength);
+	void processPlanar(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outLeft, FloatSample *&outRight, unsigned int &outLength);
 	unsigned int estimateInLength(const unsigned int outLength) const;
+	double getOutputToInputRatio() const;
+	double getGroupDelay() const;
+	size_t getMemoryUsage() const;
+	// Only supported when the kernel uses the tap interpolation.
+	bool setRateAdjustment(const double rateAdjustment);
 
 private:
+	const FIRKernel &kernel;
 	const struct Constants {
-		// Filter coefficients
-		const FIRCoefficient *taps;
-		// Indicates whether to interpolate filter taps
-		bool usePhaseInterpolation;
-		// Size of array of filter coefficients
-		unsigned int numberOfTaps;
-		// Upsampling factor
-		unsigned int numberOfPhases;
-		// Downsampling factor
-		double phaseIncrement;
-		// Index of last delay line element, generally greater than numberOfTaps to form a proper binary mask
+		// Index of last delay line element, generally greater than the phase length to form a proper binary mask
 		unsigned int delayLineMask;
-		// Delay line
+		// Delay line, each sample is stored twice so that the samples of any phase are found contiguously
 		FloatSample(*ringBuffer)[FIR_INTERPOLATOR_CHANNEL_COUNT];
 
-		Constants(const unsigned int upsampleFactor, const double downsampleFactor, const FIRCoefficient kernel[], const unsigned int kernelLength);
+		Constants(const FIRKernel &kernel);
 	} constants;
 	// Index of current sample in delay line
 	unsigned int ringBufferPosition;
 	// Current phase
 	double phase;
+	// Current downsampling factor, equals to the one of the kernel unless adjusted
+	double phaseIncrement;
 
 	bool needNextInSample() const;
 	void addInSamples(const FloatSample *&inSamples);
-	void getOutSamplesStereo(FloatSample *&outSamples);
+	template <class Output>
+	void processFrames(const FloatSample *&inSamples, unsigned int &inLength, Output &output, unsigned int &outLength);
+	template <class Output>
+	void getOutSamplesStereo(Output &output);
 }; // class FIRResampler
 
 } // namespace SRCTools
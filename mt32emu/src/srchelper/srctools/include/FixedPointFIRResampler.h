@@ -0,0 +1,101 @@
+/* Copyright (C) 2015-2021 Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRCTOOLS_FIXED_POINT_FIR_RESAMPLER_H
+#define SRCTOOLS_FIXED_POINT_FIR_RESAMPLER_H
+
+#include "FIRResampler.h"
+#include "IntSampleProvider.h"
+
+namespace SRCTools {
+
+// Filter coefficient stored as a fixed-point number with FixedPointFIRKernel::coefficientShift fractional bits.
+typedef short FixedPointCoefficient;
+
+// Filter data prepared for the integer convolution. The float kernel is quantised to 16-bit coefficients, which are
+// scaled so that the 32-bit accumulators cannot overflow with any input.
+class FixedPointFIRKernel {
+public:
+	// Filter coefficients rearranged by phase in the same layout as in FIRKernel
+	const FixedPointCoefficient *phaseTaps;
+	// Indicates whether to interpolate filter taps
+	bool usePhaseInterpolation;
+	// Number of delay line samples each phase is applied to, a multiple of FIR_INTERPOLATOR_SAMPLES_PER_ITERATION
+	unsigned int phaseLength;
+	// Upsampling factor
+	unsigned int numberOfPhases;
+	// Number of fractional bits of the phase, as many as the integer part leaves in 32 bits, but no more than 24
+	unsigned int phaseFractionBits;
+	// Downsampling factor with phaseFractionBits fractional bits
+	unsigned int phaseIncrement;
+	// Number of fractional bits of the coefficients, 15 unless the kernel needs extra headroom
+	unsigned int coefficientShift;
+	// Number of fractional bits dropped from each accumulator before they are summed up, so that the sum cannot overflow
+	unsigned int accumulatorShift;
+	// Delay of the low-frequency content in input samples
+	double groupDelay;
+
+	FixedPointFIRKernel(const unsigned int upsampleFactor, const double downsampleFactor, const FIRCoefficient kernel[], const unsigned int kernelLength, const bool variableRatio = false);
+	~FixedPointFIRKernel();
+
+private:
+	FixedPointFIRKernel(const FixedPointFIRKernel &);
+	FixedPointFIRKernel &operator=(const FixedPointFIRKernel &);
+}; // class FixedPointFIRKernel
+
+// Counterpart of FIRResampler that processes stereo interleaved streams of Q15 samples using integer arithmetic only.
+class FixedPointFIRResampler {
+public:
+	FixedPointFIRResampler(const unsigned int upsampleFactor, const double downsampleFactor, const FIRCoefficient kernel[], const unsigned int kernelLength, const bool variableRatio = false);
+	~FixedPointFIRResampler();
+
+	/** Generates output samples. The arguments are adjusted in accordance with the number of samples processed. */
+	void process(const IntSample *&inSamples, unsigned int &inLength, IntSample *&outSamples, unsigned int &outLength);
+	/** Returns a lower estimation of required number of input samples to produce the specified number of output samples. */
+	unsigned int estimateInLength(const unsigned int outLength) const;
+	double getOutputToInputRatio() const;
+	double getGroupDelay() const;
+	// Returns the number of bytes occupied by the resampler, including the delay line and the filter coefficients.
+	size_t getMemoryUsage() const;
+	// Only supported when the kernel uses the tap interpolation.
+	bool setRateAdjustment(const double rateAdjustment);
+
+private:
+	const FixedPointFIRKernel kernel;
+	// Index of last delay line element, generally greater than the phase length to form a proper binary mask
+	const unsigned int delayLineMask;
+	// Delay line, each sample is stored twice so that the samples of any phase are found contiguously
+	IntSample(*const ringBuffer)[FIR_INTERPOLATOR_CHANNEL_COUNT];
+	// Index of current sample in delay line
+	unsigned int ringBufferPosition;
+	// Current phase with kernel.phaseFractionBits fractional bits
+	unsigned int phase;
+	// Current downsampling factor, equals to the one of the kernel unless adjusted
+	unsigned int phaseIncrement;
+
+	static unsigned int computeDelayLineMask(const unsigned int phaseLength);
+
+	bool needNextInSample() const;
+	void addInSamples(const IntSample *&inSamples);
+	void getOutSamplesStereo(IntSample *&outSamples);
+
+	FixedPointFIRResampler(const FixedPointFIRResampler &);
+	FixedPointFIRResampler &operator=(const FixedPointFIRResampler &);
+}; // class FixedPointFIRResampler
+
+} // namespace SRCTools
+
+#endif // SRCTOOLS_FIXED_POINT_FIR_RESAMPLER_H
@@ -27,6 +27,25 @@ public:
 	virtual ~FloatSampleProvider() {}
 
 	virtual void getOutputSamples(FloatSample *outBuffer, unsigned int size) = 0;
+
+	/** Produces a stereo stream with the samples of the left and right channels written into separate buffers.
+	 * By default, the interleaved output is split in chunks, providers that can write planar output directly override this.
+	 */
+	virtual void getPlanarOutputSamples(FloatSample *leftBuffer, FloatSample *rightBuffer, unsigned int size) {
+		static const unsigned int PLANAR_CHUNK_LENGTH = 1024;
+
+		FloatSample buffer[2 * PLANAR_CHUNK_LENGTH];
+		while (size > 0) {
+			const unsigned int chunkLength = PLANAR_CHUNK_LENGTH < size ? PLANAR_CHUNK_LENGTH : size;
+			getOutputSamples(buffer, chunkLength);
+			const FloatSample *inSamples = buffer;
+			for (unsigned int i = 0; i < chunkLength; i++) {
+				*(leftBuffer++) = *(inSamples++);
+				*(rightBuffer++) = *(inSamples++);
+			}
+			size -= chunkLength;
+		}
+	}
 };
 
 } // namespace SRCTools
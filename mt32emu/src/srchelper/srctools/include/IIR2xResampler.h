@@ -54,11 +54,23 @@ public:
 	// Returns the retained fraction of the passband for the given standard quality value
 	static double getPassbandFractionForQuality(Quality quality);
 
+	// Returns true if the delay line contains zeros only, so that the output remains silent while the input does.
+	bool isSilent() const;
+
 protected:
 	explicit IIRResampler(const Quality quality);
 	explicit IIRResampler(const unsigned int useSectionsCount, const IIRCoefficient useFIR, const IIRSection useSections[]);
 	~IIRResampler();
 
+	// Returns the group delay of the filter at DC, measured in samples at the higher sample rate.
+	double getFilterGroupDelay() const;
+
+	// Returns the number of bytes occupied by the delay line of the filter.
+	size_t getDelayLineMemoryUsage() const;
+
+	// Replaces denormal values in the delay line with zeros, the recursive sections decay to them after the input stops.
+	void flushDenormals();
+
 	const struct Constants {
 		// Coefficient of the 0-order FIR part
 		IIRCoefficient fir;
@@ -79,11 +91,18 @@ public:
 	explicit IIR2xInterpolator(const unsigned int useSectionsCount, const IIRCoefficient useFIR, const IIRSection useSections[]);
 
 	void process(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outSamples, unsigned int &outLength);
+	void processPlanar(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outLeft, FloatSample *&outRight, unsigned int &outLength);
 	unsigned int estimateInLength(const unsigned int outLength) const;
+	double getOutputToInputRatio() const;
+	double getGroupDelay() const;
+	size_t getMemoryUsage() const;
 
 private:
 	FloatSample lastInputSamples[IIR_RESAMPER_CHANNEL_COUNT];
 	unsigned int phase;
+
+	template <class Output>
+	void processFrames(const FloatSample *&inSamples, unsigned int &inLength, Output &output, unsigned int &outLength);
 };
 
 class IIR2xDecimator : public IIRResampler {
@@ -92,7 +111,15 @@ public:
 	explicit IIR2xDecimator(const unsigned int useSectionsCount, const IIRCoefficient useFIR, const IIRSection useSections[]);
 
 	void process(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outSamples, unsigned int &outLength);
+	void processPlanar(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outLeft, FloatSample *&outRight, unsigned int &outLength);
 	unsigned int estimateInLength(const unsigned int outLength) const;
+	double getOutputToInputRatio() const;
+	double getGroupDelay() const;
+	size_t getMemoryUsage() const;
+
+private:
+	template <class Output>
+	void processFrames(const FloatSample *&inSamples, unsigned int &inLength, Output &output, unsigned int &outLength);
 };
 
 } // namespace SRCTools
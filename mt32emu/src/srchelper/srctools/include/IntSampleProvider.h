@@ -0,0 +1,35 @@
+/* Copyright (C) 2015-2021 Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRCTOOLS_INT_SAMPLE_PROVIDER_H
+#define SRCTOOLS_INT_SAMPLE_PROVIDER_H
+
+namespace SRCTools {
+
+// Signed 16-bit integer sample, which represents a Q15 fixed-point number.
+typedef short IntSample;
+
+/** Interface defines an abstract source of integer samples. It can either define a single channel stream or a stream with interleaved channels. */
+class IntSampleProvider {
+public:
+	virtual ~IntSampleProvider() {}
+
+	virtual void getOutputSamples(IntSample *outBuffer, unsigned int size) = 0;
+};
+
+} // namespace SRCTools
+
+#endif // SRCTOOLS_INT_SAMPLE_PROVIDER_H
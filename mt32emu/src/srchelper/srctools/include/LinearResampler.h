@@ -29,12 +29,21 @@ public:
 	~LinearResampler() {}
 
 	unsigned int estimateInLength(const unsigned int outLength) const;
+	double getOutputToInputRatio() const;
+	double getGroupDelay() const;
+	size_t getMemoryUsage() const;
 	void process(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outSamples, unsigned int &outLength);
+	void processPlanar(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outLeft, FloatSample *&outRight, unsigned int &outLength);
+	bool setRateAdjustment(const double rateAdjustment);
 
 private:
-	const double inputToOutputRatio;
+	const double nominalInputToOutputRatio;
+	double inputToOutputRatio;
 	double position;
 	FloatSample lastInputSamples[LINEAR_RESAMPER_CHANNEL_COUNT];
+
+	template <class Output>
+	void processFrames(const FloatSample *&inSamples, unsigned int &inLength, Output &output, unsigned int &outLength);
 };
 
 } // namespace SRCTools
@@ -17,11 +17,15 @@
 #ifndef SRCTOOLS_RESAMPLER_MODEL_H
 #define SRCTOOLS_RESAMPLER_MODEL_H
 
+#include <cstddef>
+
 #include "FloatSampleProvider.h"
+#include "IntSampleProvider.h"
 
 namespace SRCTools {
 
 class ResamplerStage;
+class FixedPointFIRResampler;
 
 /** Model consists of one or more ResampleStage instances connected in a cascade. */
 namespace ResamplerModel {
@@ -47,15 +51,43 @@ enum Quality {
 	// Use GOOD quality setting of the IIR stage (77% of passband retained).
 	GOOD,
 	// Use BEST quality setting of the IIR stage (95% of passband retained).
-	BEST
+	BEST,
+	// Same as BEST but the windowed sinc stage is minimum-phase. This minimises the group delay at the cost of
+	// the phase distortion, which affects frequencies close to the passband edge most.
+	LOW_LATENCY
 };
 
-FloatSampleProvider &createResamplerModel(FloatSampleProvider &source, double sourceSampleRate, double targetSampleRate, Quality quality);
+// When variableRatio is true, the model always includes a resampler stage that supports adjusting the conversion ratio
+// while processing via setRateAdjustment(), even if the sample rates are equal or related by a factor of 2.
+FloatSampleProvider &createResamplerModel(FloatSampleProvider &source, double sourceSampleRate, double targetSampleRate, Quality quality, bool variableRatio = false);
 FloatSampleProvider &createResamplerModel(FloatSampleProvider &source, ResamplerStage **stages, unsigned int stageCount);
 FloatSampleProvider &createResamplerModel(FloatSampleProvider &source, ResamplerStage &stage);
 
 void freeResamplerModel(FloatSampleProvider &model, FloatSampleProvider &source);
 
+// Scales the output sample rate of the model by the specified factor relative to the nominal target sample rate.
+// Returns false if none of the stages the model consists of supports variable-ratio resampling.
+bool setRateAdjustment(FloatSampleProvider &model, FloatSampleProvider &source, double rateAdjustment);
+
+// Returns the delay the model introduces to the low-frequency content of the signal, measured in samples at the source
+// sample rate. The result is nominal, i.e. the rate adjustment is disregarded.
+double getGroupDelay(FloatSampleProvider &model, FloatSampleProvider &source);
+
+// Returns the number of bytes occupied by the cascade stages of the model and the resampler stages they drive.
+// The source is not accounted for.
+size_t getMemoryUsage(FloatSampleProvider &model, FloatSampleProvider &source);
+
+// Fixed-point counterparts of the above that process Q15 samples using integer arithmetic only. Each model consists of
+// a single FixedPointFIRResampler. Lacking the IIR stage, its windowed sinc filter is applied to the source signal directly,
+// so it is considerably longer than in the floating-point model, and the FASTEST quality uses linear interpolation.
+IntSampleProvider &createResamplerModel(IntSampleProvider &source, double sourceSampleRate, double targetSampleRate, Quality quality, bool variableRatio = false);
+IntSampleProvider &createResamplerModel(IntSampleProvider &source, FixedPointFIRResampler &resampler);
+
+void freeResamplerModel(IntSampleProvider &model, IntSampleProvider &source);
+bool setRateAdjustment(IntSampleProvider &model, IntSampleProvider &source, double rateAdjustment);
+double getGroupDelay(IntSampleProvider &model, IntSampleProvider &source);
+size_t getMemoryUsage(IntSampleProvider &model, IntSampleProvider &source);
+
 } // namespace ResamplerModel
 
 } // namespace SRCTools
@@ -17,10 +17,46 @@
 #ifndef SRCTOOLS_RESAMPLER_STAGE_H
 #define SRCTOOLS_RESAMPLER_STAGE_H
 
+#include <cstddef>
+
 #include "FloatSampleProvider.h"
 
 namespace SRCTools {
 
+/** Writes output frames into a single buffer with interleaved channels. Samples of each frame are put in the channel order. */
+class InterleavedOutput {
+public:
+	explicit InterleavedOutput(FloatSample *&useOutSamples) : outSamples(useOutSamples) {}
+
+	void put(const unsigned int, const FloatSample sample) {
+		*(outSamples++) = sample;
+	}
+
+	void nextFrame() {}
+
+private:
+	FloatSample *&outSamples;
+};
+
+/** Writes output frames of a stereo stream into separate buffers per channel. */
+class PlanarStereoOutput {
+public:
+	PlanarStereoOutput(FloatSample *&useOutLeft, FloatSample *&useOutRight) : outLeft(useOutLeft), outRight(useOutRight) {}
+
+	void put(const unsigned int chIx, const FloatSample sample) {
+		*(chIx == 0 ? outLeft : outRight) = sample;
+	}
+
+	void nextFrame() {
+		++outLeft;
+		++outRight;
+	}
+
+private:
+	FloatSample *&outLeft;
+	FloatSample *&outRight;
+};
+
 /** Interface defines an abstract source of samples. It can either define a single channel stream or a stream with interleaved channels. */
 class ResamplerStage {
 public:
@@ -31,6 +67,25 @@ public:
 
 	/** Generates output samples. The arguments are adjusted in accordance with the number of samples processed. */
 	virtual void process(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outSamples, unsigned int &outLength) = 0;
+
+	/** Same as process() but the output stereo stream is written into separate buffers for the left and right channels. */
+	virtual void processPlanar(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outLeft, FloatSample *&outRight, unsigned int &outLength) = 0;
+
+	/** Returns the nominal ratio of the output sample rate to the input sample rate. */
+	virtual double getOutputToInputRatio() const = 0;
+
+	/** Returns the delay the stage introduces to the low-frequency content of the signal, measured in input samples. */
+	virtual double getGroupDelay() const = 0;
+
+	/** Returns the number of bytes occupied by the stage, including the delay line and the filter data it refers to. */
+	virtual size_t getMemoryUsage() const = 0;
+
+	/** Scales the output sample rate by the specified factor relative to the nominal rate, which can be changed anytime
+	 * while processing. Returns false if the stage doesn't support variable-ratio resampling (that is the default).
+	 */
+	virtual bool setRateAdjustment(const double) {
+		return false;
+	}
 };
 
 } // namespace SRCTools
@@ -18,6 +18,7 @@
 #define SRCTOOLS_SINC_RESAMPLER_H
 
 #include "FIRResampler.h"
+#include "FixedPointFIRResampler.h"
 
 namespace SRCTools {
 
@@ -25,13 +26,63 @@ class ResamplerStage;
 
 namespace SincResampler {
 
-	ResamplerStage *createSincResampler(const double inputFrequency, const double outputFrequency, const double passbandFrequency, const double stopbandFrequency, const double dbSNR, const unsigned int maxUpsampleFactor);
+	// Designed kernels are cached process-wide and shared among all resamplers created with identical parameters.
+	// A cached kernel is freed when the last resampler that uses it is deleted. This function is thread-safe.
+	// When variableRatio is true, the resampler always interpolates between maxUpsampleFactor phases of the kernel,
+	// so that its rate can be adjusted with ResamplerStage::setRateAdjustment().
+	// When minimumPhase is true, the kernel is converted to minimum phase, which trades the linear phase response
+	// for a much smaller group delay.
+	ResamplerStage *createSincResampler(const double inputFrequency, const double outputFrequency, const double passbandFrequency, const double stopbandFrequency, const double dbSNR, const unsigned int maxUpsampleFactor, const bool variableRatio = false, const bool minimumPhase = false);
+
+	// Creates a resampler as above that also applies the given FIR prefilter. Both filters are fused into a single polyphase
+	// kernel, so the input signal is only processed once. The prefilter is defined at the sample rate inputFrequency multiplied
+	// by prefilterUpsampleFactor and applied as if the input was upsampled with zero stuffing, compensating for the upsampling
+	// gain. Thus, the DC gain of the result equals to the sum of the prefilter taps. The prefilter identifies the cached
+	// kernel, so it must be static or outlive all the resamplers that use it.
+	ResamplerStage *createFusedSincResampler(const double inputFrequency, const double outputFrequency, const double passbandFrequency, const double stopbandFrequency, const double dbSNR, const unsigned int maxUpsampleFactor, const bool variableRatio, const FIRCoefficient prefilter[], const unsigned int prefilterLength, const unsigned int prefilterUpsampleFactor, const bool minimumPhase = false);
+
+	// Creates a fixed-point resampler with the windowed sinc kernel designed as above and quantised to 16-bit coefficients.
+	// Unlike the floating-point kernels, these aren't cached, as each resampler owns the quantised copy.
+	FixedPointFIRResampler *createFixedPointSincResampler(const double inputFrequency, const double outputFrequency, const double passbandFrequency, const double stopbandFrequency, const double dbSNR, const unsigned int maxUpsampleFactor, const bool variableRatio = false, const bool minimumPhase = false);
+
+	// Designs the windowed sinc kernel for the given parameters and computes the resample factors of the FIRResampler that
+	// applies it. The caller takes ownership of the returned kernel, which is allocated as an array of kernelLength elements.
+	FIRCoefficient *designWindowedSincKernel(unsigned int &kernelLength, unsigned int &upsampleFactor, double &downsampleFactor, const double inputFrequency, const double outputFrequency, const double passbandFrequency, const double stopbandFrequency, const double dbSNR, const unsigned int maxUpsampleFactor, const bool variableRatio);
+
+	// Kernels designed in advance for the most common conversions, so that they needn't be computed at runtime.
+	namespace PrecomputedKernels {
+		struct Kernel {
+			double inputFrequency;
+			double outputFrequency;
+			double passbandFrequency;
+			double stopbandFrequency;
+			double dbSNR;
+			unsigned int maxUpsampleFactor;
+			unsigned int upsampleFactor;
+			double downsampleFactor;
+			unsigned int kernelLength;
+			const FIRCoefficient *kernel;
+		};
+
+		// Defined in the generated file PrecomputedKernels.cpp
+		extern const Kernel KERNELS[];
+		extern const unsigned int KERNEL_COUNT;
+
+		// Returns the precomputed kernel designed with the given parameters or NULL if there is none.
+		const Kernel *find(const double inputFrequency, const double outputFrequency, const double passbandFrequency, const double stopbandFrequency, const double dbSNR, const unsigned int maxUpsampleFactor);
+	}
 
 	namespace Utils {
 		void computeResampleFactors(unsigned int &upsampleFactor, double &downsampleFactor, const double inputFrequency, const double outputFrequency, const unsigned int maxUpsampleFactor);
 		unsigned int greatestCommonDivisor(unsigned int a, unsigned int b);
 	}
 
+	namespace MinimumPhase {
+		// Replaces the kernel with the minimum-phase filter of the same length that has approximately the same magnitude
+		// response. Its energy is concentrated at the start, so the filter introduces much less delay than a linear-phase one.
+		void transformKernel(FIRCoefficient kernel[], const unsigned int kernelLength);
+	}
+
 	namespace KaizerWindow {
 		double estimateBeta(double dbRipple);
 		unsigned int estimateOrder(double dbRipple, double fp, double fs);
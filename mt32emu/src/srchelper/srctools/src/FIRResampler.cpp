@@ -15,93 +15,179 @@
  */
 
 #include <cmath>
-#include <cstring>
 
 #include "../include/FIRResampler.h"
 
 using namespace SRCTools;
 
-FIRResampler::Constants::Constants(const unsigned int upsampleFactor, const double downsampleFactor, const FIRCoefficient kernel[], const unsigned int kernelLength) {
-	usePhaseInterpolation = downsampleFactor != floor(downsampleFactor);
-	FIRCoefficient *kernelCopy = new FIRCoefficient[kernelLength];
-	memcpy(kernelCopy, kernel, kernelLength * sizeof(FIRCoefficient));
-	taps = kernelCopy;
-	numberOfTaps = kernelLength;
+static const unsigned int PHASE_ITERATION_LENGTH = FIR_INTERPOLATOR_SAMPLES_PER_ITERATION * FIR_INTERPOLATOR_CHANNEL_COUNT;
+
+FIRKernel::FIRKernel(const unsigned int upsampleFactor, const double downsampleFactor, const FIRCoefficient kernel[], const unsigned int kernelLength, const bool variableRatio) {
+	usePhaseInterpolation = variableRatio || downsampleFactor != floor(downsampleFactor);
 	numberOfPhases = upsampleFactor;
 	phaseIncrement = downsampleFactor;
-	unsigned int minDelayLineLength = static_cast<unsigned int>(ceil(double(kernelLength) / upsampleFactor));
+	unsigned int minPhaseLength = (kernelLength + upsampleFactor - 1) / upsampleFactor;
+	phaseLength = (minPhaseLength + FIR_INTERPOLATOR_SAMPLES_PER_ITERATION - 1) / FIR_INTERPOLATOR_SAMPLES_PER_ITERATION * FIR_INTERPOLATOR_SAMPLES_PER_ITERATION;
+
+	const unsigned int phaseTapsLength = phaseLength * FIR_INTERPOLATOR_CHANNEL_COUNT;
+	FIRCoefficient *phaseTapsTable = new FIRCoefficient[(upsampleFactor + 1) * phaseTapsLength];
+	for (unsigned int phaseIx = 0; phaseIx <= upsampleFactor; phaseIx++) {
+		FIRCoefficient *phaseTap = phaseTapsTable + phaseIx * phaseTapsLength;
+		for (unsigned int tapIx = phaseIx; tapIx < phaseIx + phaseLength * upsampleFactor; tapIx += upsampleFactor) {
+			const FIRCoefficient tap = tapIx < kernelLength ? kernel[tapIx] : 0;
+			for (unsigned int i = 0; i < FIR_INTERPOLATOR_CHANNEL_COUNT; i++) {
+				*(phaseTap++) = tap;
+			}
+		}
+	}
+	phaseTaps = phaseTapsTable;
+
+	// The group delay at DC equals to the centroid of the impulse response
+	double tapSum = 0.0;
+	double weightedTapSum = 0.0;
+	for (unsigned int tapIx = 0; tapIx < kernelLength; tapIx++) {
+		tapSum += kernel[tapIx];
+		weightedTapSum += double(tapIx) * kernel[tapIx];
+	}
+	groupDelay = tapSum == 0.0 ? 0.0 : weightedTapSum / (tapSum * upsampleFactor);
+}
+
+FIRKernel::~FIRKernel() {
+	delete[] phaseTaps;
+}
+
+void FIRKernel::release() const {
+	delete this;
+}
+
+size_t FIRKernel::getMemoryUsage() const {
+	return sizeof(*this) + (numberOfPhases + 1) * phaseLength * FIR_INTERPOLATOR_CHANNEL_COUNT * sizeof(FIRCoefficient);
+}
+
+FIRResampler::Constants::Constants(const FIRKernel &kernel) {
 	unsigned int delayLineLength = 2;
-	while (delayLineLength < minDelayLineLength) delayLineLength <<= 1;
+	while (delayLineLength < kernel.phaseLength) delayLineLength <<= 1;
 	delayLineMask = delayLineLength - 1;
-	ringBuffer = new FloatSample[delayLineLength][FIR_INTERPOLATOR_CHANNEL_COUNT];
+	ringBuffer = new FloatSample[2 * delayLineLength][FIR_INTERPOLATOR_CHANNEL_COUNT];
 	FloatSample *s = *ringBuffer;
-	FloatSample *e = ringBuffer[delayLineLength];
+	FloatSample *e = ringBuffer[2 * delayLineLength];
 	while (s < e) *(s++) = 0;
 }
 
-FIRResampler::FIRResampler(const unsigned int upsampleFactor, const double downsampleFactor, const FIRCoefficient kernel[], const unsigned int kernelLength) :
-	constants(upsampleFactor, downsampleFactor, kernel, kernelLength),
+FIRResampler::FIRResampler(const unsigned int upsampleFactor, const double downsampleFactor, const FIRCoefficient useKernel[], const unsigned int kernelLength) :
+	kernel(*new FIRKernel(upsampleFactor, downsampleFactor, useKernel, kernelLength)),
+	constants(kernel),
 	ringBufferPosition(0),
-	phase(constants.numberOfPhases)
+	phase(kernel.numberOfPhases),
+	phaseIncrement(kernel.phaseIncrement)
+{}
+
+FIRResampler::FIRResampler(const FIRKernel &useKernel) :
+	kernel(useKernel),
+	constants(kernel),
+	ringBufferPosition(0),
+	phase(kernel.numberOfPhases),
+	phaseIncrement(kernel.phaseIncrement)
 {}
 
 FIRResampler::~FIRResampler() {
 	delete[] constants.ringBuffer;
-	delete[] constants.taps;
+	kernel.release();
 }
 
-void FIRResampler::process(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outSamples, unsigned int &outLength) {
+template <class Output>
+void FIRResampler::processFrames(const FloatSample *&inSamples, unsigned int &inLength, Output &output, unsigned int &outLength) {
 	while (outLength > 0) {
 		while (needNextInSample()) {
 			if (inLength == 0) return;
 			addInSamples(inSamples);
 			--inLength;
 		}
-		getOutSamplesStereo(outSamples);
+		getOutSamplesStereo(output);
 		--outLength;
 	}
 }
 
+void FIRResampler::process(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outSamples, unsigned int &outLength) {
+	InterleavedOutput output(outSamples);
+	processFrames(inSamples, inLength, output, outLength);
+}
+
+void FIRResampler::processPlanar(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outLeft, FloatSample *&outRight, unsigned int &outLength) {
+	PlanarStereoOutput output(outLeft, outRight);
+	processFrames(inSamples, inLength, output, outLength);
+}
+
 unsigned int FIRResampler::estimateInLength(const unsigned int outLength) const {
-	return static_cast<unsigned int>((outLength * constants.phaseIncrement + phase) / constants.numberOfPhases);
+	return static_cast<unsigned int>((outLength * phaseIncrement + phase) / kernel.numberOfPhases);
+}
+
+double FIRResampler::getOutputToInputRatio() const {
+	return kernel.numberOfPhases / kernel.phaseIncrement;
+}
+
+double FIRResampler::getGroupDelay() const {
+	return kernel.groupDelay;
+}
+
+// A shared kernel is accounted in full by each resampler that refers to it.
+size_t FIRResampler::getMemoryUsage() const {
+	return sizeof(*this) + 2 * (constants.delayLineMask + 1) * sizeof(*constants.ringBuffer) + kernel.getMemoryUsage();
+}
+
+bool FIRResampler::setRateAdjustment(const double rateAdjustment) {
+	if (!kernel.usePhaseInterpolation) return false;
+	phaseIncrement = kernel.phaseIncrement / rateAdjustment;
+	return true;
 }
 
 bool FIRResampler::needNextInSample() const {
-	return constants.numberOfPhases <= phase;
+	return kernel.numberOfPhases <= phase;
 }
 
 void FIRResampler::addInSamples(const FloatSample *&inSamples) {
 	ringBufferPosition = (ringBufferPosition - 1) & constants.delayLineMask;
+	const unsigned int mirrorPosition = ringBufferPosition + constants.delayLineMask + 1;
 	for (unsigned int i = 0; i < FIR_INTERPOLATOR_CHANNEL_COUNT; i++) {
-		constants.ringBuffer[ringBufferPosition][i] = *(inSamples++);
+		constants.ringBuffer[ringBufferPosition][i] = *inSamples;
+		constants.ringBuffer[mirrorPosition][i] = *(inSamples++);
 	}
-	phase -= constants.numberOfPhases;
-}
-
-// Optimised for processing stereo interleaved streams
-void FIRResampler::getOutSamplesStereo(FloatSample *&outSamples) {
-	FloatSample leftSample = 0.0;
-	FloatSample rightSample = 0.0;
-	unsigned int delaySampleIx = ringBufferPosition;
-	if (constants.usePhaseInterpolation) {
-		double phaseFraction = phase - floor(phase);
-		unsigned int maxTapIx = phaseFraction == 0 ? constants.numberOfTaps : constants.numberOfTaps - 1;
-		for (unsigned int tapIx = static_cast<unsigned int>(phase); tapIx < maxTapIx; tapIx += constants.numberOfPhases) {
-			FIRCoefficient tap = FIRCoefficient(constants.taps[tapIx] + (constants.taps[tapIx + 1] - constants.taps[tapIx]) * phaseFraction);
-			leftSample += tap * constants.ringBuffer[delaySampleIx][0];
-			rightSample += tap * constants.ringBuffer[delaySampleIx][1];
-			delaySampleIx = (delaySampleIx + 1) & constants.delayLineMask;
+	phase -= kernel.numberOfPhases;
+}
+
+// Optimised for processing stereo interleaved streams. The delay line samples and the taps of the current phase lie contiguously
+// in the same interleaved layout, the convolution maintains independent accumulators for several samples of each channel.
+template <class Output>
+void FIRResampler::getOutSamplesStereo(Output &output) {
+	const unsigned int phaseTapsLength = kernel.phaseLength * FIR_INTERPOLATOR_CHANNEL_COUNT;
+	const unsigned int phaseIx = static_cast<unsigned int>(phase);
+	const FIRCoefficient *phaseTaps = kernel.phaseTaps + phaseIx * phaseTapsLength;
+	const FloatSample *delaySamples = constants.ringBuffer[ringBufferPosition];
+	FloatSample accumulators[PHASE_ITERATION_LENGTH] = { 0 };
+	if (kernel.usePhaseInterpolation) {
+		const FIRCoefficient phaseFraction = FIRCoefficient(phase - phaseIx);
+		const FIRCoefficient *nextPhaseTaps = phaseTaps + phaseTapsLength;
+		for (unsigned int tapIx = 0; tapIx < phaseTapsLength; tapIx += PHASE_ITERATION_LENGTH) {
+			for (unsigned int i = 0; i < PHASE_ITERATION_LENGTH; i++) {
+				const FIRCoefficient tap = phaseTaps[tapIx + i] + (nextPhaseTaps[tapIx + i] - phaseTaps[tapIx + i]) * phaseFraction;
+				accumulators[i] += tap * delaySamples[tapIx + i];
+			}
 		}
 	} else {
 		// Optimised for rational resampling ratios when phase is always integer
-		for (unsigned int tapIx = static_cast<unsigned int>(phase); tapIx < constants.numberOfTaps; tapIx += constants.numberOfPhases) {
-			FIRCoefficient tap = constants.taps[tapIx];
-			leftSample += tap * constants.ringBuffer[delaySampleIx][0];
-			rightSample += tap * constants.ringBuffer[delaySampleIx][1];
-			delaySampleIx = (delaySampleIx + 1) & constants.delayLineMask;
+		for (unsigned int tapIx = 0; tapIx < phaseTapsLength; tapIx += PHASE_ITERATION_LENGTH) {
+			for (unsigned int i = 0; i < PHASE_ITERATION_LENGTH; i++) {
+				accumulators[i] += phaseTaps[tapIx + i] * delaySamples[tapIx + i];
+			}
+		}
+	}
+	for (unsigned int i = 0; i < FIR_INTERPOLATOR_CHANNEL_COUNT; i++) {
+		FloatSample sample = 0;
+		for (unsigned int j = i; j < PHASE_ITERATION_LENGTH; j += FIR_INTERPOLATOR_CHANNEL_COUNT) {
+			sample += accumulators[j];
 		}
+		output.put(i, sample);
 	}
-	*(outSamples++) = leftSample;
-	*(outSamples++) = rightSample;
-	phase += constants.phaseIncrement;
+	output.nextFrame();
+	phase += phaseIncrement;
 }
@@ -0,0 +1,222 @@
+/* Copyright (C) 2015-2021 Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+
+#include "../include/FixedPointFIRResampler.h"
+
+using namespace SRCTools;
+
+static const unsigned int PHASE_ITERATION_LENGTH = FIR_INTERPOLATOR_SAMPLES_PER_ITERATION * FIR_INTERPOLATOR_CHANNEL_COUNT;
+// The tap interpolation uses Q15 fractions, so that the product with a difference of two taps fits in 32 bits
+static const unsigned int TAP_FRACTION_BITS = 15;
+static const unsigned int MAX_PHASE_FRACTION_BITS = 24;
+static const unsigned int MAX_COEFFICIENT_SHIFT = 15;
+
+// The input samples are at most 2^15 in magnitude, hence the sum of the coefficient magnitudes an accumulator
+// is applied to is kept below 2^16.
+static const double MAX_PHASE_MAGNITUDE = 65535.0;
+static const double MAX_COEFFICIENT_MAGNITUDE = 32767.0;
+
+FixedPointFIRKernel::FixedPointFIRKernel(const unsigned int upsampleFactor, const double downsampleFactor, const FIRCoefficient kernel[], const unsigned int kernelLength, const bool variableRatio) {
+	usePhaseInterpolation = variableRatio || downsampleFactor != floor(downsampleFactor);
+	numberOfPhases = upsampleFactor;
+	// The phase may reach the number of phases plus the downsampling factor before the next input sample is taken, the bound
+	// leaves room for the rate adjustment. Rounding of the phase increment offsets the conversion ratio by 2^-phaseFractionBits
+	// of the phase at most.
+	phaseFractionBits = MAX_PHASE_FRACTION_BITS;
+	while (phaseFractionBits > TAP_FRACTION_BITS && 4294967295.0 < (upsampleFactor + 2.0 * downsampleFactor + 1.0) * (1 << phaseFractionBits)) {
+		phaseFractionBits--;
+	}
+	phaseIncrement = static_cast<unsigned int>(floor(downsampleFactor * (1 << phaseFractionBits) + 0.5));
+	unsigned int minPhaseLength = (kernelLength + upsampleFactor - 1) / upsampleFactor;
+	phaseLength = (minPhaseLength + FIR_INTERPOLATOR_SAMPLES_PER_ITERATION - 1) / FIR_INTERPOLATOR_SAMPLES_PER_ITERATION * FIR_INTERPOLATOR_SAMPLES_PER_ITERATION;
+
+	// Find the largest scale the coefficients can take, the extra phase appended for tap interpolation is included.
+	// Each accumulator only sums every FIR_INTERPOLATOR_SAMPLES_PER_ITERATION-th tap of a phase, so it needs much less
+	// headroom than the whole phase. The accumulators are then shifted right before they are added up if necessary.
+	double maxTapMagnitude = 0.0;
+	double maxAccumulatorMagnitude = 0.0;
+	double maxPhaseMagnitude = 0.0;
+	for (unsigned int phaseIx = 0; phaseIx <= upsampleFactor; phaseIx++) {
+		double accumulatorMagnitudes[FIR_INTERPOLATOR_SAMPLES_PER_ITERATION] = { 0 };
+		double phaseMagnitude = 0.0;
+		for (unsigned int tapIx = phaseIx, i = 0; tapIx < kernelLength; tapIx += upsampleFactor, i++) {
+			const double tapMagnitude = fabs(kernel[tapIx]);
+			accumulatorMagnitudes[i % FIR_INTERPOLATOR_SAMPLES_PER_ITERATION] += tapMagnitude;
+			phaseMagnitude += tapMagnitude;
+			if (maxTapMagnitude < tapMagnitude) maxTapMagnitude = tapMagnitude;
+		}
+		for (unsigned int i = 0; i < FIR_INTERPOLATOR_SAMPLES_PER_ITERATION; i++) {
+			if (maxAccumulatorMagnitude < accumulatorMagnitudes[i]) maxAccumulatorMagnitude = accumulatorMagnitudes[i];
+		}
+		if (maxPhaseMagnitude < phaseMagnitude) maxPhaseMagnitude = phaseMagnitude;
+	}
+	// Rounding of the coefficients and of the interpolated taps may add up to 1.5 per tap. The centre tap of an integer
+	// phase commonly reaches 1.0, which is saturated rather than losing a bit of precision in all the other taps.
+	const double roundingMagnitude = 1.5 * minPhaseLength;
+	coefficientShift = MAX_COEFFICIENT_SHIFT;
+	while (coefficientShift > 0 && (MAX_COEFFICIENT_MAGNITUDE < maxTapMagnitude * (1 << (coefficientShift - 1))
+		|| MAX_PHASE_MAGNITUDE < maxAccumulatorMagnitude * (1 << coefficientShift) + roundingMagnitude)) {
+		coefficientShift--;
+	}
+	accumulatorShift = 0;
+	while (accumulatorShift < coefficientShift && MAX_PHASE_MAGNITUDE < maxPhaseMagnitude * (1 << (coefficientShift - accumulatorShift)) + roundingMagnitude) {
+		accumulatorShift++;
+	}
+	const double scale = 1 << coefficientShift;
+
+	const unsigned int phaseTapsLength = phaseLength * FIR_INTERPOLATOR_CHANNEL_COUNT;
+	FixedPointCoefficient *phaseTapsTable = new FixedPointCoefficient[(upsampleFactor + 1) * phaseTapsLength];
+	for (unsigned int phaseIx = 0; phaseIx <= upsampleFactor; phaseIx++) {
+		FixedPointCoefficient *phaseTap = phaseTapsTable + phaseIx * phaseTapsLength;
+		for (unsigned int tapIx = phaseIx; tapIx < phaseIx + phaseLength * upsampleFactor; tapIx += upsampleFactor) {
+			const double tap = tapIx < kernelLength ? floor(kernel[tapIx] * scale + 0.5) : 0.0;
+			const FixedPointCoefficient saturatedTap = FixedPointCoefficient(tap < -MAX_COEFFICIENT_MAGNITUDE ? -MAX_COEFFICIENT_MAGNITUDE : MAX_COEFFICIENT_MAGNITUDE < tap ? MAX_COEFFICIENT_MAGNITUDE : tap);
+			for (unsigned int i = 0; i < FIR_INTERPOLATOR_CHANNEL_COUNT; i++) {
+				*(phaseTap++) = saturatedTap;
+			}
+		}
+	}
+	phaseTaps = phaseTapsTable;
+
+	// The group delay at DC equals to the centroid of the impulse response
+	double tapSum = 0.0;
+	double weightedTapSum = 0.0;
+	for (unsigned int tapIx = 0; tapIx < kernelLength; tapIx++) {
+		tapSum += kernel[tapIx];
+		weightedTapSum += double(tapIx) * kernel[tapIx];
+	}
+	groupDelay = tapSum == 0.0 ? 0.0 : weightedTapSum / (tapSum * upsampleFactor);
+}
+
+FixedPointFIRKernel::~FixedPointFIRKernel() {
+	delete[] phaseTaps;
+}
+
+unsigned int FixedPointFIRResampler::computeDelayLineMask(const unsigned int phaseLength) {
+	unsigned int delayLineLength = 2;
+	while (delayLineLength < phaseLength) delayLineLength <<= 1;
+	return delayLineLength - 1;
+}
+
+FixedPointFIRResampler::FixedPointFIRResampler(const unsigned int upsampleFactor, const double downsampleFactor, const FIRCoefficient useKernel[], const unsigned int kernelLength, const bool variableRatio) :
+	kernel(upsampleFactor, downsampleFactor, useKernel, kernelLength, variableRatio),
+	delayLineMask(computeDelayLineMask(kernel.phaseLength)),
+	ringBuffer(new IntSample[2 * (delayLineMask + 1)][FIR_INTERPOLATOR_CHANNEL_COUNT]),
+	ringBufferPosition(0),
+	phase(kernel.numberOfPhases << kernel.phaseFractionBits),
+	phaseIncrement(kernel.phaseIncrement)
+{
+	IntSample *s = *ringBuffer;
+	IntSample *e = ringBuffer[2 * (delayLineMask + 1)];
+	while (s < e) *(s++) = 0;
+}
+
+FixedPointFIRResampler::~FixedPointFIRResampler() {
+	delete[] ringBuffer;
+}
+
+void FixedPointFIRResampler::process(const IntSample *&inSamples, unsigned int &inLength, IntSample *&outSamples, unsigned int &outLength) {
+	while (outLength > 0) {
+		while (needNextInSample()) {
+			if (inLength == 0) return;
+			addInSamples(inSamples);
+			--inLength;
+		}
+		getOutSamplesStereo(outSamples);
+		--outLength;
+	}
+}
+
+unsigned int FixedPointFIRResampler::estimateInLength(const unsigned int outLength) const {
+	return static_cast<unsigned int>((double(outLength) * phaseIncrement + phase) / (kernel.numberOfPhases << kernel.phaseFractionBits));
+}
+
+double FixedPointFIRResampler::getOutputToInputRatio() const {
+	return double(kernel.numberOfPhases << kernel.phaseFractionBits) / kernel.phaseIncrement;
+}
+
+double FixedPointFIRResampler::getGroupDelay() const {
+	return kernel.groupDelay;
+}
+
+size_t FixedPointFIRResampler::getMemoryUsage() const {
+	const size_t phaseTapsSize = (kernel.numberOfPhases + 1) * kernel.phaseLength * FIR_INTERPOLATOR_CHANNEL_COUNT * sizeof(FixedPointCoefficient);
+	return sizeof(*this) + 2 * (delayLineMask + 1) * sizeof(*ringBuffer) + phaseTapsSize;
+}
+
+bool FixedPointFIRResampler::setRateAdjustment(const double rateAdjustment) {
+	if (!kernel.usePhaseInterpolation) return false;
+	phaseIncrement = static_cast<unsigned int>(floor(kernel.phaseIncrement / rateAdjustment + 0.5));
+	return true;
+}
+
+bool FixedPointFIRResampler::needNextInSample() const {
+	return (kernel.numberOfPhases << kernel.phaseFractionBits) <= phase;
+}
+
+void FixedPointFIRResampler::addInSamples(const IntSample *&inSamples) {
+	ringBufferPosition = (ringBufferPosition - 1) & delayLineMask;
+	const unsigned int mirrorPosition = ringBufferPosition + delayLineMask + 1;
+	for (unsigned int i = 0; i < FIR_INTERPOLATOR_CHANNEL_COUNT; i++) {
+		ringBuffer[ringBufferPosition][i] = *inSamples;
+		ringBuffer[mirrorPosition][i] = *(inSamples++);
+	}
+	phase -= kernel.numberOfPhases << kernel.phaseFractionBits;
+}
+
+// Same as FIRResampler::getOutSamplesStereo() but the products of Q15 samples and coefficients are accumulated in 32-bit integers.
+// The kernel scale guarantees that neither the accumulators nor their sum can overflow, the result is rounded and saturated
+// to the sample range.
+void FixedPointFIRResampler::getOutSamplesStereo(IntSample *&outSamples) {
+	const unsigned int phaseTapsLength = kernel.phaseLength * FIR_INTERPOLATOR_CHANNEL_COUNT;
+	const unsigned int phaseIx = phase >> kernel.phaseFractionBits;
+	const FixedPointCoefficient *phaseTaps = kernel.phaseTaps + phaseIx * phaseTapsLength;
+	const IntSample *delaySamples = ringBuffer[ringBufferPosition];
+	int accumulators[PHASE_ITERATION_LENGTH] = { 0 };
+	if (kernel.usePhaseInterpolation) {
+		const int phaseFraction = int((phase & ((1 << kernel.phaseFractionBits) - 1)) >> (kernel.phaseFractionBits - TAP_FRACTION_BITS));
+		const int tapRounding = 1 << (TAP_FRACTION_BITS - 1);
+		const FixedPointCoefficient *nextPhaseTaps = phaseTaps + phaseTapsLength;
+		for (unsigned int tapIx = 0; tapIx < phaseTapsLength; tapIx += PHASE_ITERATION_LENGTH) {
+			for (unsigned int i = 0; i < PHASE_ITERATION_LENGTH; i++) {
+				const int tap = phaseTaps[tapIx + i] + (((nextPhaseTaps[tapIx + i] - phaseTaps[tapIx + i]) * phaseFraction + tapRounding) >> TAP_FRACTION_BITS);
+				accumulators[i] += tap * delaySamples[tapIx + i];
+			}
+		}
+	} else {
+		// Optimised for rational resampling ratios when phase is always integer
+		for (unsigned int tapIx = 0; tapIx < phaseTapsLength; tapIx += PHASE_ITERATION_LENGTH) {
+			for (unsigned int i = 0; i < PHASE_ITERATION_LENGTH; i++) {
+				accumulators[i] += phaseTaps[tapIx + i] * delaySamples[tapIx + i];
+			}
+		}
+	}
+	const unsigned int outputShift = kernel.coefficientShift - kernel.accumulatorShift;
+	const int rounding = outputShift > 0 ? 1 << (outputShift - 1) : 0;
+	for (unsigned int i = 0; i < FIR_INTERPOLATOR_CHANNEL_COUNT; i++) {
+		int sample = rounding;
+		for (unsigned int j = i; j < PHASE_ITERATION_LENGTH; j += FIR_INTERPOLATOR_CHANNEL_COUNT) {
+			sample += accumulators[j] >> kernel.accumulatorShift;
+		}
+		sample >>= outputShift;
+		if (sample < -0x8000) sample = -0x8000;
+		if (sample > 0x7FFF) sample = 0x7FFF;
+		*(outSamples++) = IntSample(sample);
+	}
+	phase += phaseIncrement;
+}
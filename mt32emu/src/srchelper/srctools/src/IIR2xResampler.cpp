@@ -14,15 +14,13 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cfloat>
 #include <cstddef>
 
 #include "../include/IIR2xResampler.h"
 
 namespace SRCTools {
 
-	// Avoid denormals degrading performance, using biased input
-	static const BufferedSample BIAS = 1e-20f;
-
 	// Sharp elliptic filter with symmetric ripple: N=18, Ap=As=-106 dB, fp=0.238, fs = 0.25 (in terms of sample rate)
 	static const IIRCoefficient FIR_BEST = 0.0014313792470984f;
 	static const IIRSection SECTIONS_BEST[] = {
@@ -130,6 +128,42 @@ IIRResampler::~IIRResampler() {
 	delete[] constants.buffer;
 }
 
+bool IIRResampler::isSilent() const {
+	const BufferedSample *s = constants.buffer[0];
+	const BufferedSample *e = constants.buffer[IIR_RESAMPER_CHANNEL_COUNT * constants.sectionsCount];
+	for (; s < e; s++) {
+		if (*s != 0) return false;
+	}
+	return true;
+}
+
+void IIRResampler::flushDenormals() {
+	BufferedSample *s = constants.buffer[0];
+	BufferedSample *e = constants.buffer[IIR_RESAMPER_CHANNEL_COUNT * constants.sectionsCount];
+	for (; s < e; s++) {
+		if (-FLT_MIN < *s && *s < FLT_MIN) *s = 0;
+	}
+}
+
+// For a section S(x) = (num1 * x + num2 * x^2) / (1 + den1 * x + den2 * x^2) with x = z^-1, the impulse response moments
+// sum(h[n]) and sum(n * h[n]) equal to S(1) and S'(1) respectively. Their ratio for the whole bank is the group delay at DC.
+double IIRResampler::getFilterGroupDelay() const {
+	double response = constants.fir;
+	double derivative = 0.0;
+	for (unsigned int i = 0; i < constants.sectionsCount; ++i) {
+		const IIRSection &section = constants.sections[i];
+		const double num = double(section.num1) + section.num2;
+		const double den = 1.0 + section.den1 + section.den2;
+		response += num / den;
+		derivative += ((double(section.num1) + 2.0 * section.num2) * den - num * (double(section.den1) + 2.0 * section.den2)) / (den * den);
+	}
+	return response == 0.0 ? 0.0 : derivative / response;
+}
+
+size_t IIRResampler::getDelayLineMemoryUsage() const {
+	return IIR_RESAMPER_CHANNEL_COUNT * constants.sectionsCount * sizeof(SectionBuffer);
+}
+
 IIR2xInterpolator::IIR2xInterpolator(const Quality quality) :
 	IIRResampler(quality),
 	phase(1)
@@ -148,7 +182,8 @@ IIR2xInterpolator::IIR2xInterpolator(const unsigned int useSectionsCount, const
 	}
 }
 
-void IIR2xInterpolator::process(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outSamples, unsigned int &outLength) {
+template <class Output>
+void IIR2xInterpolator::processFrames(const FloatSample *&inSamples, unsigned int &inLength, Output &output, unsigned int &outLength) {
 	static const IIRCoefficient INTERPOLATOR_AMP = 2.0;
 
 	while (outLength > 0 && inLength > 0) {
@@ -163,22 +198,23 @@ void IIR2xInterpolator::process(const FloatSample *&inSamples, unsigned int &inL
 				// For 2x interpolation, calculation of the numerator reduces to a single multiplication depending on the phase.
 				if (phase == 0) {
 					const BufferedSample numOutSample = section.num1 * lastInputSample;
-					const BufferedSample denOutSample = calcDenominator(section, BIAS + numOutSample, buffer[0], buffer[1]);
+					const BufferedSample denOutSample = calcDenominator(section, numOutSample, buffer[0], buffer[1]);
 					buffer[1] = denOutSample;
 					tmpOut += denOutSample;
 				} else {
 					const BufferedSample numOutSample = section.num2 * lastInputSample;
-					const BufferedSample denOutSample = calcDenominator(section, BIAS + numOutSample, buffer[1], buffer[0]);
+					const BufferedSample denOutSample = calcDenominator(section, numOutSample, buffer[1], buffer[0]);
 					buffer[0] = denOutSample;
 					tmpOut += denOutSample;
 				}
 				bufferp++;
 			}
-			*(outSamples++) = FloatSample(INTERPOLATOR_AMP * tmpOut);
+			output.put(chIx, FloatSample(INTERPOLATOR_AMP * tmpOut));
 			if (phase > 0) {
 				lastInputSamples[chIx] = inSample;
 			}
 		}
+		output.nextFrame();
 		outLength--;
 		if (phase > 0) {
 			inSamples += IIR_RESAMPER_CHANNEL_COUNT;
@@ -188,12 +224,35 @@ void IIR2xInterpolator::process(const FloatSample *&inSamples, unsigned int &inL
 			phase = 1;
 		}
 	}
+	flushDenormals();
+}
+
+void IIR2xInterpolator::process(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outSamples, unsigned int &outLength) {
+	InterleavedOutput output(outSamples);
+	processFrames(inSamples, inLength, output, outLength);
+}
+
+void IIR2xInterpolator::processPlanar(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outLeft, FloatSample *&outRight, unsigned int &outLength) {
+	PlanarStereoOutput output(outLeft, outRight);
+	processFrames(inSamples, inLength, output, outLength);
 }
 
 unsigned int IIR2xInterpolator::estimateInLength(const unsigned int outLength) const {
 	return outLength >> 1;
 }
 
+double IIR2xInterpolator::getOutputToInputRatio() const {
+	return 2.0;
+}
+
+double IIR2xInterpolator::getGroupDelay() const {
+	return 0.5 * getFilterGroupDelay();
+}
+
+size_t IIR2xInterpolator::getMemoryUsage() const {
+	return sizeof(*this) + getDelayLineMemoryUsage();
+}
+
 IIR2xDecimator::IIR2xDecimator(const Quality quality) :
 	IIRResampler(quality)
 {}
@@ -202,7 +261,8 @@ IIR2xDecimator::IIR2xDecimator(const unsigned int useSectionsCount, const IIRCoe
 	IIRResampler(useSectionsCount, useFIR, useSections)
 {}
 
-void IIR2xDecimator::process(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outSamples, unsigned int &outLength) {
+template <class Output>
+void IIR2xDecimator::processFrames(const FloatSample *&inSamples, unsigned int &inLength, Output &output, unsigned int &outLength) {
 	while (outLength > 0 && inLength > 1) {
 		SectionBuffer *bufferp = constants.buffer;
 		for (unsigned int chIx = 0; chIx < IIR_RESAMPER_CHANNEL_COUNT; ++chIx) {
@@ -212,18 +272,42 @@ void IIR2xDecimator::process(const FloatSample *&inSamples, unsigned int &inLeng
 				SectionBuffer &buffer = *bufferp;
 				// For 2x decimation, calculation of the numerator is not performed for odd output samples which are to be omitted.
 				tmpOut += calcNumerator(section, buffer[0], buffer[1]);
-				buffer[1] = calcDenominator(section, BIAS + inSamples[chIx], buffer[0], buffer[1]);
-				buffer[0] = calcDenominator(section, BIAS + inSamples[chIx + IIR_RESAMPER_CHANNEL_COUNT], buffer[1], buffer[0]);
+				buffer[1] = calcDenominator(section, inSamples[chIx], buffer[0], buffer[1]);
+				buffer[0] = calcDenominator(section, inSamples[chIx + IIR_RESAMPER_CHANNEL_COUNT], buffer[1], buffer[0]);
 				bufferp++;
 			}
-			*(outSamples++) = FloatSample(tmpOut);
+			output.put(chIx, FloatSample(tmpOut));
 		}
+		output.nextFrame();
 		outLength--;
 		inLength -= 2;
 		inSamples += 2 * IIR_RESAMPER_CHANNEL_COUNT;
 	}
+	flushDenormals();
+}
+
+void IIR2xDecimator::process(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outSamples, unsigned int &outLength) {
+	InterleavedOutput output(outSamples);
+	processFrames(inSamples, inLength, output, outLength);
+}
+
+void IIR2xDecimator::processPlanar(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outLeft, FloatSample *&outRight, unsigned int &outLength) {
+	PlanarStereoOutput output(outLeft, outRight);
+	processFrames(inSamples, inLength, output, outLength);
 }
 
 unsigned int IIR2xDecimator::estimateInLength(const unsigned int outLength) const {
 	return outLength << 1;
 }
+
+double IIR2xDecimator::getOutputToInputRatio() const {
+	return 0.5;
+}
+
+double IIR2xDecimator::getGroupDelay() const {
+	return getFilterGroupDelay();
+}
+
+size_t IIR2xDecimator::getMemoryUsage() const {
+	return sizeof(*this) + getDelayLineMemoryUsage();
+}
@@ -19,11 +19,13 @@
 using namespace SRCTools;
 
 LinearResampler::LinearResampler(double sourceSampleRate, double targetSampleRate) :
-	inputToOutputRatio(sourceSampleRate / targetSampleRate),
+	nominalInputToOutputRatio(sourceSampleRate / targetSampleRate),
+	inputToOutputRatio(nominalInputToOutputRatio),
 	position(1.0) // Preload delay line which effectively makes resampler zero phase
 {}
 
-void LinearResampler::process(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outSamples, unsigned int &outLength) {
+template <class Output>
+void LinearResampler::processFrames(const FloatSample *&inSamples, unsigned int &inLength, Output &output, unsigned int &outLength) {
 	if (inLength == 0) return;
 	while (outLength > 0) {
 		while (1.0 <= position) {
@@ -35,13 +37,42 @@ void LinearResampler::process(const FloatSample *&inSamples, unsigned int &inLen
 			if (inLength == 0) return;
 		}
 		for (unsigned int chIx = 0; chIx < LINEAR_RESAMPER_CHANNEL_COUNT; chIx++) {
-			*(outSamples++) = FloatSample(lastInputSamples[chIx] + position * (inSamples[chIx] - lastInputSamples[chIx]));
+			output.put(chIx, FloatSample(lastInputSamples[chIx] + position * (inSamples[chIx] - lastInputSamples[chIx])));
 		}
+		output.nextFrame();
 		outLength--;
 		position += inputToOutputRatio;
 	}
 }
 
+void LinearResampler::process(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outSamples, unsigned int &outLength) {
+	InterleavedOutput output(outSamples);
+	processFrames(inSamples, inLength, output, outLength);
+}
+
+void LinearResampler::processPlanar(const FloatSample *&inSamples, unsigned int &inLength, FloatSample *&outLeft, FloatSample *&outRight, unsigned int &outLength) {
+	PlanarStereoOutput output(outLeft, outRight);
+	processFrames(inSamples, inLength, output, outLength);
+}
+
+bool LinearResampler::setRateAdjustment(const double rateAdjustment) {
+	inputToOutputRatio = nominalInputToOutputRatio / rateAdjustment;
+	return true;
+}
+
 unsigned int LinearResampler::estimateInLength(const unsigned int outLength) const {
 	return static_cast<unsigned int>(outLength * inputToOutputRatio);
 }
+
+double LinearResampler::getOutputToInputRatio() const {
+	return 1.0 / nominalInputToOutputRatio;
+}
+
+double LinearResampler::getGroupDelay() const {
+	// The interpolation is zero-phase, see the constructor
+	return 0.0;
+}
+
+size_t LinearResampler::getMemoryUsage() const {
+	return sizeof(*this);
+}
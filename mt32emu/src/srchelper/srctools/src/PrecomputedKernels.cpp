@@ -0,0 +1,1362 @@
+/* Copyright (C) 2015-2021 Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// This file is generated by tools/PrecomputedKernelsGenerator.cpp, do not edit.
+
+#include "../include/SincResampler.h"
+
+using namespace SRCTools;
+
+using namespace SincResampler;
+
+// 32000 -> 44100, quality 1
+static const FIRCoefficient KERNEL_0[] = {
+	6.68301664e-06f, 7.43861210e-06f, 8.24482504e-06f, 9.10320432e-06f, 1.00152738e-05f, 1.09825351e-05f,
+	1.20064578e-05f, 1.30884791e-05f, 1.42300005e-05f, 1.54323770e-05f, 1.66969239e-05f, 1.80249008e-05f,
+	1.94175154e-05f, 2.08759175e-05f, 2.24011892e-05f, 2.39943474e-05f, 2.56563326e-05f, 2.73880105e-05f,
+	2.91901615e-05f, 3.10634787e-05f, 3.30085604e-05f, 3.50259106e-05f, 3.71159222e-05f, 3.92788897e-05f,
+	4.15149880e-05f, 4.38242678e-05f, 4.62066673e-05f, 4.86619829e-05f, 5.11898834e-05f, 5.37898959e-05f,
+	5.64613947e-05f, 5.92036085e-05f, 6.20156134e-05f, 6.48963178e-05f, 6.78444558e-05f, 7.08586085e-05f,
+	7.39371535e-05f, 7.70783081e-05f, 8.02800932e-05f, 8.35403262e-05f, 8.68566349e-05f, 9.02264510e-05f,
+	9.36469878e-05f, 9.71152476e-05f, 0.000100628014f, 0.000104181847f, 0.000107773092f, 0.000111397858f,
+	0.000115052004f, 0.000118731165f, 0.000122430749f, 0.000126145867f, 0.000129871449f, 0.000133602123f,
+	0.000137332288f, 0.000141056051f, 0.000144767284f, 0.000148459614f, 0.000152126348f, 0.000155760586f,
+	0.000159355128f, 0.000162902506f, 0.000166394966f, 0.000169824532f, 0.000173182896f, 0.000176461530f,
+	0.000179651601f, 0.000182744014f, 0.000185729412f, 0.000188598147f, 0.000191340354f, 0.000193945845f,
+	0.000196404202f, 0.000198704729f, 0.000200836512f, 0.000202788346f, 0.000204548778f, 0.000206106139f,
+	0.000207448509f, 0.000208563710f, 0.000209439386f, 0.000210062906f, 0.000210421465f, 0.000210502039f,
+	0.000210291400f, 0.000209776117f, 0.000208942613f, 0.000207777077f, 0.000206265613f, 0.000204394091f,
+	0.000202148309f, 0.000199513874f, 0.000196476321f, 0.000193021027f, 0.000189133323f, 0.000184798424f,
+	0.000180001472f, 0.000174727596f, 0.000168961837f, 0.000162689234f, 0.000155894828f, 0.000148563631f,
+	0.000140680699f, 0.000132231144f, 0.000123200123f, 0.000113572845f, 0.000103334642f, 9.24709602e-05f,
+	8.09673656e-05f, 6.88095897e-05f, 5.59835207e-05f, 4.24752507e-05f, 2.82710953e-05f, 1.33575932e-05f,
+	-2.27845044e-06f, -1.86499492e-05f, -3.57695171e-05f, -5.36494299e-05f, -7.23016274e-05f, -9.17376601e-05f,
+	-0.000111968686f, -0.000133005437f, -0.000154858208f, -0.000177536785f, -0.000201050512f, -0.000225408163f,
+	-0.000250617974f, -0.000276687584f, -0.000303624081f, -0.000331433897f, -0.000360122795f, -0.000389695866f,
+	-0.000420157477f, -0.000451511325f, -0.000483760232f, -0.000516906381f, -0.000550950936f, -0.000585894450f,
+	-0.000621736457f, -0.000658475619f, -0.000696109666f, -0.000734635512f, -0.000774048851f, -0.000814344676f,
+	-0.000855516642f, -0.000897557591f, -0.000940459198f, -0.000984212034f, -0.00102880551f, -0.00107422809f,
+	-0.00112046674f, -0.00116750749f, -0.00121533510f, -0.00126393302f, -0.00131328346f, -0.00136336731f,
+	-0.00141416432f, -0.00146565284f, -0.00151780969f, -0.00157061068f, -0.00162402994f, -0.00167804048f,
+	-0.00173261354f, -0.00178771932f, -0.00184332638f, -0.00189940189f, -0.00195591152f, -0.00201281952f,
+	-0.00207008864f, -0.00212768000f, -0.00218555355f, -0.00224366761f, -0.00230197865f, -0.00236044219f,
+	-0.00241901190f, -0.00247763982f, -0.00253627682f, -0.00259487214f, -0.00265337341f, -0.00271172682f,
+	-0.00276987697f, -0.00282776705f, -0.00288533908f, -0.00294253277f, -0.00299928733f, -0.00305553991f,
+	-0.00311122648f, -0.00316628162f, -0.00322063803f, -0.00327422773f, -0.00332698110f, -0.00337882712f,
+	-0.00342969340f, -0.00347950659f, -0.00352819148f, -0.00357567263f, -0.00362187228f, -0.00366671244f,
+	-0.00371011347f, -0.00375199481f, -0.00379227498f, -0.00383087131f, -0.00386770023f, -0.00390267745f,
+	-0.00393571751f, -0.00396673428f, -0.00399564067f, -0.00402235007f, -0.00404677307f, -0.00406882167f,
+	-0.00408840599f, -0.00410543662f, -0.00411982276f, -0.00413147453f, -0.00414030068f, -0.00414621038f,
+	-0.00414911238f, -0.00414891494f, -0.00414552679f, -0.00413885759f, -0.00412881514f, -0.00411530957f,
+	-0.00409824960f, -0.00407754583f, -0.00405310793f, -0.00402484741f, -0.00399267534f, -0.00395650463f,
+	-0.00391624775f, -0.00387181877f, -0.00382313319f, -0.00377010670f, -0.00371265691f, -0.00365070230f,
+	-0.00358416280f, -0.00351296016f, -0.00343701709f, -0.00335625862f, -0.00327061117f, -0.00318000303f,
+	-0.00308436481f, -0.00298362877f, -0.00287772971f, -0.00276660430f, -0.00265019247f, -0.00252843532f,
+	-0.00240127812f, -0.00226866733f, -0.00213055336f, -0.00198688894f, -0.00183763006f, -0.00168273586f,
+	-0.00152216875f, -0.00135589414f, -0.00118388131f, -0.00100610289f, -0.000822535192f, -0.000633158372f,
+	-0.000437956332f, -0.000236916996f, -3.00323882e-05f, 0.000182701362f, 0.000401283818f, 0.000625710236f,
+	0.000855971361f, 0.00109205337f, 0.00133393775f, 0.00158160145f, 0.00183501642f, 0.00209414982f,
+	0.00235896348f, 0.00262941467f, 0.00290545472f, 0.00318703079f, 0.00347408373f, 0.00376654975f,
+	0.00406435877f, 0.00436743535f, 0.00467569986f, 0.00498906430f, 0.00530743785f, 0.00563072134f,
+	0.00595881185f, 0.00629159855f, 0.00662896689f, 0.00697079441f, 0.00731695350f, 0.00766731007f,
+	0.00802172441f, 0.00838005077f, 0.00874213595f, 0.00910782255f, 0.00947694574f, 0.00984933414f,
+	0.0102248099f, 0.0106031913f, 0.0109842876f, 0.0113679040f, 0.0117538366f, 0.0121418796f,
+	0.0125318160f, 0.0129234269f, 0.0133164851f, 0.0137107568f, 0.0141060036f, 0.0145019814f,
+	0.0148984380f, 0.0152951172f, 0.0156917553f, 0.0160880834f, 0.0164838303f, 0.0168787111f,
+	0.0172724444f, 0.0176647361f, 0.0180552918f, 0.0184438080f, 0.0188299790f, 0.0192134939f,
+	0.0195940323f, 0.0199712738f, 0.0203448907f, 0.0207145549f, 0.0210799277f, 0.0214406680f,
+	0.0217964351f, 0.0221468788f, 0.0224916469f, 0.0228303820f, 0.0231627282f, 0.0234883204f,
+	0.0238067936f, 0.0241177771f, 0.0244209021f, 0.0247157924f, 0.0250020716f, 0.0252793618f,
+	0.0255472809f, 0.0258054454f, 0.0260534752f, 0.0262909830f, 0.0265175812f, 0.0267328843f,
+	0.0269365031f, 0.0271280520f, 0.0273071397f, 0.0274733808f, 0.0276263878f, 0.0277657751f,
+	0.0278911535f, 0.0280021410f, 0.0280983560f, 0.0281794164f, 0.0282449424f, 0.0282945596f,
+	0.0283278935f, 0.0283445753f, 0.0283442345f, 0.0283265114f, 0.0282910429f, 0.0282374769f,
+	0.0281654615f, 0.0280746501f, 0.0279647037f, 0.0278352872f, 0.0276860707f, 0.0275167301f,
+	0.0273269508f, 0.0271164216f, 0.0268848427f, 0.0266319178f, 0.0263573583f, 0.0260608867f,
+	0.0257422347f, 0.0254011359f, 0.0250373408f, 0.0246506054f, 0.0242406968f, 0.0238073934f,
+	0.0233504809f, 0.0228697564f, 0.0223650318f, 0.0218361262f, 0.0212828722f, 0.0207051132f,
+	0.0201027095f, 0.0194755271f, 0.0188234523f, 0.0181463771f, 0.0174442139f, 0.0167168844f,
+	0.0159643274f, 0.0151864951f, 0.0143833542f, 0.0135548860f, 0.0127010895f, 0.0118219769f,
+	0.0109175770f, 0.00998793542f, 0.00903311372f, 0.00805318914f, 0.00704825763f, 0.00601843093f,
+	0.00496383943f, 0.00388462935f, 0.00278096600f, 0.00165303238f, 0.000501029775f, -0.000674822426f,
+	-0.00187428598f, -0.00309710391f, -0.00434300071f, -0.00561168091f, -0.00690283068f, -0.00821611658f,
+	-0.00955118518f, -0.0109076649f, -0.0122851618f, -0.0136832660f, -0.0151015427f, -0.0165395420f,
+	-0.0179967918f, -0.0194727983f, -0.0209670514f, -0.0224790163f, -0.0240081418f, -0.0255538542f,
+	-0.0271155592f, -0.0286926460f, -0.0302844811f, -0.0318904072f, -0.0335097574f, -0.0351418294f,
+	-0.0367859155f, -0.0384412780f, -0.0401071683f, -0.0417828113f, -0.0434674136f, -0.0451601595f,
+	-0.0468602255f, -0.0485667586f, -0.0502788872f, -0.0519957244f, -0.0537163652f, -0.0554398857f,
+	-0.0571653396f, -0.0588917695f, -0.0606181957f, -0.0623436235f, -0.0640670359f, -0.0657874122f,
+	-0.0675037056f, -0.0692148507f, -0.0709197670f, -0.0726173669f, -0.0743065402f, -0.0759861693f,
+	-0.0776551142f, -0.0793122277f, -0.0809563324f, -0.0825862736f, -0.0842008367f, -0.0857988447f,
+	-0.0873790607f, -0.0889402777f, -0.0904812515f, -0.0920007452f, -0.0934974924f, -0.0949702337f,
+	-0.0964176953f, -0.0978385955f, -0.0992316455f, -0.100595549f, -0.101929009f, -0.103230707f,
+	-0.104499340f, -0.105733581f, -0.106932119f, -0.108093619f, -0.109216757f, -0.110300198f,
+	-0.111342616f, -0.112342678f, -0.113299042f, -0.114210390f, -0.115075372f, -0.115892678f,
+	-0.116660967f, -0.117378928f, -0.118045226f, -0.118658558f, -0.119217612f, -0.119721085f,
+	-0.120167673f, -0.120556086f, -0.120885059f, -0.121153302f, -0.121359564f, -0.121502586f,
+	-0.121581130f, -0.121593967f, -0.121539876f, -0.121417664f, -0.121226139f, -0.120964117f,
+	-0.120630458f, -0.120224006f, -0.119743638f, -0.119188249f, -0.118556753f, -0.117848076f,
+	-0.117061175f, -0.116195016f, -0.115248598f, -0.114220925f, -0.113111049f, -0.111918025f,
+	-0.110640936f, -0.109278888f, -0.107831039f, -0.106296524f, -0.104674555f, -0.102964342f,
+	-0.101165123f, -0.0992761850f, -0.0972968265f, -0.0952263772f, -0.0930642113f, -0.0908097178f,
+	-0.0884623304f, -0.0860215053f, -0.0834867433f, -0.0808575675f, -0.0781335458f, -0.0753142685f,
+	-0.0723993704f, -0.0693885162f, -0.0662814230f, -0.0630778149f, -0.0597774796f, -0.0563802309f,
+	-0.0528859235f, -0.0492944494f, -0.0456057414f, -0.0418197699f, -0.0379365422f, -0.0339561105f,
+	-0.0298785679f, -0.0257040411f, -0.0214327034f, -0.0170647688f, -0.0126004899f, -0.00804016460f,
+	-0.00338412868f, 0.00136723660f, 0.00621350994f, 0.0111542260f, 0.0161888804f, 0.0213169195f,
+	0.0265377555f, 0.0318507515f, 0.0372552313f, 0.0427504741f, 0.0483357161f, 0.0540101528f,
+	0.0597729348f, 0.0656231716f, 0.0715599284f, 0.0775822252f, 0.0836890489f, 0.0898793340f,
+	0.0961519778f, 0.102505840f, 0.108939737f, 0.115452424f, 0.122042648f, 0.128709093f,
+	0.135450423f, 0.142265216f, 0.149152055f, 0.156109497f, 0.163135991f, 0.170230016f,
+	0.177389964f, 0.184614226f, 0.191901147f, 0.199249029f, 0.206656113f, 0.214120641f,
+	0.221640825f, 0.229214802f, 0.236840710f, 0.244516641f, 0.252240628f, 0.260010749f,
+	0.267824948f, 0.275681257f, 0.283577532f, 0.291511714f, 0.299481720f, 0.307485342f,
+	0.315520406f, 0.323584735f, 0.331676126f, 0.339792252f, 0.347930908f, 0.356089741f,
+	0.364266455f, 0.372458726f, 0.380664170f, 0.388880372f, 0.397105008f, 0.405335605f,
+	0.413569778f, 0.421805024f, 0.430038899f, 0.438268960f, 0.446492702f, 0.454707593f,
+	0.462911159f, 0.471100897f, 0.479274243f, 0.487428665f, 0.495561659f, 0.503670692f,
+	0.511753142f, 0.519806504f, 0.527828276f, 0.535815835f, 0.543766618f, 0.551678181f,
+	0.559547842f, 0.567373157f, 0.575151563f, 0.582880497f, 0.590557456f, 0.598179996f,
+	0.605745494f, 0.613251507f, 0.620695531f, 0.628075123f, 0.635387838f, 0.642631233f,
+	0.649802804f, 0.656900227f, 0.663921118f, 0.670863032f, 0.677723706f, 0.684500754f,
+	0.691191912f, 0.697794855f, 0.704307377f, 0.710727155f, 0.717052102f, 0.723279953f,
+	0.729408622f, 0.735435963f, 0.741359890f, 0.747178376f, 0.752889335f, 0.758490801f,
+	0.763980865f, 0.769357622f, 0.774619102f, 0.779763520f, 0.784789026f, 0.789693952f,
+	0.794476449f, 0.799134910f, 0.803667665f, 0.808073103f, 0.812349677f, 0.816495895f,
+	0.820510209f, 0.824391305f, 0.828137696f, 0.831748128f, 0.835221231f, 0.838555813f,
+	0.841750741f, 0.844804764f, 0.847716808f, 0.850485921f, 0.853111029f, 0.855591238f,
+	0.857925653f, 0.860113382f, 0.862153649f, 0.864045739f, 0.865789056f, 0.867382824f,
+	0.868826568f, 0.870119750f, 0.871261835f, 0.872252524f, 0.873091400f, 0.873778164f,
+	0.874312580f, 0.874694407f, 0.874923587f, 0.875000000f, 0.874923587f, 0.874694407f,
+	0.874312580f, 0.873778164f, 0.873091400f, 0.872252524f, 0.871261835f, 0.870119750f,
+	0.868826568f, 0.867382824f, 0.865789056f, 0.864045739f, 0.862153649f, 0.860113382f,
+	0.857925653f, 0.855591238f, 0.853111029f, 0.850485921f, 0.847716808f, 0.844804764f,
+	0.841750741f, 0.838555813f, 0.835221231f, 0.831748128f, 0.828137696f, 0.824391305f,
+	0.820510209f, 0.816495895f, 0.812349677f, 0.808073103f, 0.803667665f, 0.799134910f,
+	0.794476449f, 0.789693952f, 0.784789026f, 0.779763520f, 0.774619102f, 0.769357622f,
+	0.763980865f, 0.758490801f, 0.752889335f, 0.747178376f, 0.741359890f, 0.735435963f,
+	0.729408622f, 0.723279953f, 0.717052102f, 0.710727155f, 0.704307377f, 0.697794855f,
+	0.691191912f, 0.684500754f, 0.677723706f, 0.670863032f, 0.663921118f, 0.656900227f,
+	0.649802804f, 0.642631233f, 0.635387838f, 0.628075123f, 0.620695531f, 0.613251507f,
+	0.605745494f, 0.598179996f, 0.590557456f, 0.582880497f, 0.575151563f, 0.567373157f,
+	0.559547842f, 0.551678181f, 0.543766618f, 0.535815835f, 0.527828276f, 0.519806504f,
+	0.511753142f, 0.503670692f, 0.495561659f, 0.487428665f, 0.479274243f, 0.471100897f,
+	0.462911159f, 0.454707593f, 0.446492702f, 0.438268960f, 0.430038899f, 0.421805024f,
+	0.413569778f, 0.405335605f, 0.397105008f, 0.388880372f, 0.380664170f, 0.372458726f,
+	0.364266455f, 0.356089741f, 0.347930908f, 0.339792252f, 0.331676126f, 0.323584735f,
+	0.315520406f, 0.307485342f, 0.299481720f, 0.291511714f, 0.283577532f, 0.275681257f,
+	0.267824948f, 0.260010749f, 0.252240628f, 0.244516641f, 0.236840710f, 0.229214802f,
+	0.221640825f, 0.214120641f, 0.206656113f, 0.199249029f, 0.191901147f, 0.184614226f,
+	0.177389964f, 0.170230016f, 0.163135991f, 0.156109497f, 0.149152055f, 0.142265216f,
+	0.135450423f, 0.128709093f, 0.122042648f, 0.115452424f, 0.108939737f, 0.102505840f,
+	0.0961519778f, 0.0898793340f, 0.0836890489f, 0.0775822252f, 0.0715599284f, 0.0656231716f,
+	0.0597729348f, 0.0540101528f, 0.0483357161f, 0.0427504741f, 0.0372552313f, 0.0318507515f,
+	0.0265377555f, 0.0213169195f, 0.0161888804f, 0.0111542260f, 0.00621350994f, 0.00136723660f,
+	-0.00338412868f, -0.00804016460f, -0.0126004899f, -0.0170647688f, -0.0214327034f, -0.0257040411f,
+	-0.0298785679f, -0.0339561105f, -0.0379365422f, -0.0418197699f, -0.0456057414f, -0.0492944494f,
+	-0.0528859235f, -0.0563802309f, -0.0597774796f, -0.0630778149f, -0.0662814230f, -0.0693885162f,
+	-0.0723993704f, -0.0753142685f, -0.0781335458f, -0.0808575675f, -0.0834867433f, -0.0860215053f,
+	-0.0884623304f, -0.0908097178f, -0.0930642113f, -0.0952263772f, -0.0972968265f, -0.0992761850f,
+	-0.101165123f, -0.102964342f, -0.104674555f, -0.106296524f, -0.107831039f, -0.109278888f,
+	-0.110640936f, -0.111918025f, -0.113111049f, -0.114220925f, -0.115248598f, -0.116195016f,
+	-0.117061175f, -0.117848076f, -0.118556753f, -0.119188249f, -0.119743638f, -0.120224006f,
+	-0.120630458f, -0.120964117f, -0.121226139f, -0.121417664f, -0.121539876f, -0.121593967f,
+	-0.121581130f, -0.121502586f, -0.121359564f, -0.121153302f, -0.120885059f, -0.120556086f,
+	-0.120167673f, -0.119721085f, -0.119217612f, -0.118658558f, -0.118045226f, -0.117378928f,
+	-0.116660967f, -0.115892678f, -0.115075372f, -0.114210390f, -0.113299042f, -0.112342678f,
+	-0.111342616f, -0.110300198f, -0.109216757f, -0.108093619f, -0.106932119f, -0.105733581f,
+	-0.104499340f, -0.103230707f, -0.101929009f, -0.100595549f, -0.0992316455f, -0.0978385955f,
+	-0.0964176953f, -0.0949702337f, -0.0934974924f, -0.0920007452f, -0.0904812515f, -0.0889402777f,
+	-0.0873790607f, -0.0857988447f, -0.0842008367f, -0.0825862736f, -0.0809563324f, -0.0793122277f,
+	-0.0776551142f, -0.0759861693f, -0.0743065402f, -0.0726173669f, -0.0709197670f, -0.0692148507f,
+	-0.0675037056f, -0.0657874122f, -0.0640670359f, -0.0623436235f, -0.0606181957f, -0.0588917695f,
+	-0.0571653396f, -0.0554398857f, -0.0537163652f, -0.0519957244f, -0.0502788872f, -0.0485667586f,
+	-0.0468602255f, -0.0451601595f, -0.0434674136f, -0.0417828113f, -0.0401071683f, -0.0384412780f,
+	-0.0367859155f, -0.0351418294f, -0.0335097574f, -0.0318904072f, -0.0302844811f, -0.0286926460f,
+	-0.0271155592f, -0.0255538542f, -0.0240081418f, -0.0224790163f, -0.0209670514f, -0.0194727983f,
+	-0.0179967918f, -0.0165395420f, -0.0151015427f, -0.0136832660f, -0.0122851618f, -0.0109076649f,
+	-0.00955118518f, -0.00821611658f, -0.00690283068f, -0.00561168091f, -0.00434300071f, -0.00309710391f,
+	-0.00187428598f, -0.000674822426f, 0.000501029775f, 0.00165303238f, 0.00278096600f, 0.00388462935f,
+	0.00496383943f, 0.00601843093f, 0.00704825763f, 0.00805318914f, 0.00903311372f, 0.00998793542f,
+	0.0109175770f, 0.0118219769f, 0.0127010895f, 0.0135548860f, 0.0143833542f, 0.0151864951f,
+	0.0159643274f, 0.0167168844f, 0.0174442139f, 0.0181463771f, 0.0188234523f, 0.0194755271f,
+	0.0201027095f, 0.0207051132f, 0.0212828722f, 0.0218361262f, 0.0223650318f, 0.0228697564f,
+	0.0233504809f, 0.0238073934f, 0.0242406968f, 0.0246506054f, 0.0250373408f, 0.0254011359f,
+	0.0257422347f, 0.0260608867f, 0.0263573583f, 0.0266319178f, 0.0268848427f, 0.0271164216f,
+	0.0273269508f, 0.0275167301f, 0.0276860707f, 0.0278352872f, 0.0279647037f, 0.0280746501f,
+	0.0281654615f, 0.0282374769f, 0.0282910429f, 0.0283265114f, 0.0283442345f, 0.0283445753f,
+	0.0283278935f, 0.0282945596f, 0.0282449424f, 0.0281794164f, 0.0280983560f, 0.0280021410f,
+	0.0278911535f, 0.0277657751f, 0.0276263878f, 0.0274733808f, 0.0273071397f, 0.0271280520f,
+	0.0269365031f, 0.0267328843f, 0.0265175812f, 0.0262909830f, 0.0260534752f, 0.0258054454f,
+	0.0255472809f, 0.0252793618f, 0.0250020716f, 0.0247157924f, 0.0244209021f, 0.0241177771f,
+	0.0238067936f, 0.0234883204f, 0.0231627282f, 0.0228303820f, 0.0224916469f, 0.0221468788f,
+	0.0217964351f, 0.0214406680f, 0.0210799277f, 0.0207145549f, 0.0203448907f, 0.0199712738f,
+	0.0195940323f, 0.0192134939f, 0.0188299790f, 0.0184438080f, 0.0180552918f, 0.0176647361f,
+	0.0172724444f, 0.0168787111f, 0.0164838303f, 0.0160880834f, 0.0156917553f, 0.0152951172f,
+	0.0148984380f, 0.0145019814f, 0.0141060036f, 0.0137107568f, 0.0133164851f, 0.0129234269f,
+	0.0125318160f, 0.0121418796f, 0.0117538366f, 0.0113679040f, 0.0109842876f, 0.0106031913f,
+	0.0102248099f, 0.00984933414f, 0.00947694574f, 0.00910782255f, 0.00874213595f, 0.00838005077f,
+	0.00802172441f, 0.00766731007f, 0.00731695350f, 0.00697079441f, 0.00662896689f, 0.00629159855f,
+	0.00595881185f, 0.00563072134f, 0.00530743785f, 0.00498906430f, 0.00467569986f, 0.00436743535f,
+	0.00406435877f, 0.00376654975f, 0.00347408373f, 0.00318703079f, 0.00290545472f, 0.00262941467f,
+	0.00235896348f, 0.00209414982f, 0.00183501642f, 0.00158160145f, 0.00133393775f, 0.00109205337f,
+	0.000855971361f, 0.000625710236f, 0.000401283818f, 0.000182701362f, -3.00323882e-05f, -0.000236916996f,
+	-0.000437956332f, -0.000633158372f, -0.000822535192f, -0.00100610289f, -0.00118388131f, -0.00135589414f,
+	-0.00152216875f, -0.00168273586f, -0.00183763006f, -0.00198688894f, -0.00213055336f, -0.00226866733f,
+	-0.00240127812f, -0.00252843532f, -0.00265019247f, -0.00276660430f, -0.00287772971f, -0.00298362877f,
+	-0.00308436481f, -0.00318000303f, -0.00327061117f, -0.00335625862f, -0.00343701709f, -0.00351296016f,
+	-0.00358416280f, -0.00365070230f, -0.00371265691f, -0.00377010670f, -0.00382313319f, -0.00387181877f,
+	-0.00391624775f, -0.00395650463f, -0.00399267534f, -0.00402484741f, -0.00405310793f, -0.00407754583f,
+	-0.00409824960f, -0.00411530957f, -0.00412881514f, -0.00413885759f, -0.00414552679f, -0.00414891494f,
+	-0.00414911238f, -0.00414621038f, -0.00414030068f, -0.00413147453f, -0.00411982276f, -0.00410543662f,
+	-0.00408840599f, -0.00406882167f, -0.00404677307f, -0.00402235007f, -0.00399564067f, -0.00396673428f,
+	-0.00393571751f, -0.00390267745f, -0.00386770023f, -0.00383087131f, -0.00379227498f, -0.00375199481f,
+	-0.00371011347f, -0.00366671244f, -0.00362187228f, -0.00357567263f, -0.00352819148f, -0.00347950659f,
+	-0.00342969340f, -0.00337882712f, -0.00332698110f, -0.00327422773f, -0.00322063803f, -0.00316628162f,
+	-0.00311122648f, -0.00305553991f, -0.00299928733f, -0.00294253277f, -0.00288533908f, -0.00282776705f,
+	-0.00276987697f, -0.00271172682f, -0.00265337341f, -0.00259487214f, -0.00253627682f, -0.00247763982f,
+	-0.00241901190f, -0.00236044219f, -0.00230197865f, -0.00224366761f, -0.00218555355f, -0.00212768000f,
+	-0.00207008864f, -0.00201281952f, -0.00195591152f, -0.00189940189f, -0.00184332638f, -0.00178771932f,
+	-0.00173261354f, -0.00167804048f, -0.00162402994f, -0.00157061068f, -0.00151780969f, -0.00146565284f,
+	-0.00141416432f, -0.00136336731f, -0.00131328346f, -0.00126393302f, -0.00121533510f, -0.00116750749f,
+	-0.00112046674f, -0.00107422809f, -0.00102880551f, -0.000984212034f, -0.000940459198f, -0.000897557591f,
+	-0.000855516642f, -0.000814344676f, -0.000774048851f, -0.000734635512f, -0.000696109666f, -0.000658475619f,
+	-0.000621736457f, -0.000585894450f, -0.000550950936f, -0.000516906381f, -0.000483760232f, -0.000451511325f,
+	-0.000420157477f, -0.000389695866f, -0.000360122795f, -0.000331433897f, -0.000303624081f, -0.000276687584f,
+	-0.000250617974f, -0.000225408163f, -0.000201050512f, -0.000177536785f, -0.000154858208f, -0.000133005437f,
+	-0.000111968686f, -9.17376601e-05f, -7.23016274e-05f, -5.36494299e-05f, -3.57695171e-05f, -1.86499492e-05f,
+	-2.27845044e-06f, 1.33575932e-05f, 2.82710953e-05f, 4.24752507e-05f, 5.59835207e-05f, 6.88095897e-05f,
+	8.09673656e-05f, 9.24709602e-05f, 0.000103334642f, 0.000113572845f, 0.000123200123f, 0.000132231144f,
+	0.000140680699f, 0.000148563631f, 0.000155894828f, 0.000162689234f, 0.000168961837f, 0.000174727596f,
+	0.000180001472f, 0.000184798424f, 0.000189133323f, 0.000193021027f, 0.000196476321f, 0.000199513874f,
+	0.000202148309f, 0.000204394091f, 0.000206265613f, 0.000207777077f, 0.000208942613f, 0.000209776117f,
+	0.000210291400f, 0.000210502039f, 0.000210421465f, 0.000210062906f, 0.000209439386f, 0.000208563710f,
+	0.000207448509f, 0.000206106139f, 0.000204548778f, 0.000202788346f, 0.000200836512f, 0.000198704729f,
+	0.000196404202f, 0.000193945845f, 0.000191340354f, 0.000188598147f, 0.000185729412f, 0.000182744014f,
+	0.000179651601f, 0.000176461530f, 0.000173182896f, 0.000169824532f, 0.000166394966f, 0.000162902506f,
+	0.000159355128f, 0.000155760586f, 0.000152126348f, 0.000148459614f, 0.000144767284f, 0.000141056051f,
+	0.000137332288f, 0.000133602123f, 0.000129871449f, 0.000126145867f, 0.000122430749f, 0.000118731165f,
+	0.000115052004f, 0.000111397858f, 0.000107773092f, 0.000104181847f, 0.000100628014f, 9.71152476e-05f,
+	9.36469878e-05f, 9.02264510e-05f, 8.68566349e-05f, 8.35403262e-05f, 8.02800932e-05f, 7.70783081e-05f,
+	7.39371535e-05f, 7.08586085e-05f, 6.78444558e-05f, 6.48963178e-05f, 6.20156134e-05f, 5.92036085e-05f,
+	5.64613947e-05f, 5.37898959e-05f, 5.11898834e-05f, 4.86619829e-05f, 4.62066673e-05f, 4.38242678e-05f,
+	4.15149880e-05f, 3.92788897e-05f, 3.71159222e-05f, 3.50259106e-05f, 3.30085604e-05f, 3.10634787e-05f,
+	2.91901615e-05f, 2.73880105e-05f, 2.56563326e-05f, 2.39943474e-05f, 2.24011892e-05f, 2.08759175e-05f,
+	1.94175154e-05f, 1.80249008e-05f, 1.66969239e-05f, 1.54323770e-05f, 1.42300005e-05f, 1.30884791e-05f,
+	1.20064578e-05f, 1.09825351e-05f, 1.00152738e-05f, 9.10320432e-06f, 8.24482504e-06f, 7.43861210e-06f,
+	6.68301664e-06f
+};
+
+// 32000 -> 44100, quality 2
+static const FIRCoefficient KERNEL_1[] = {
+	-6.05378682e-06f, -6.68751773e-06f, -7.36011725e-06f, -8.07248853e-06f, -8.82549739e-06f, -9.61997375e-06f,
+	-1.04567052e-05f, -1.13364331e-05f, -1.22598540e-05f, -1.32276118e-05f, -1.42402951e-05f, -1.52984358e-05f,
+	-1.64025059e-05f, -1.75529094e-05f, -1.87499845e-05f, -1.99939968e-05f, -2.12851373e-05f, -2.26235152e-05f,
+	-2.40091631e-05f, -2.54420211e-05f, -2.69219454e-05f, -2.84486941e-05f, -3.00219344e-05f, -3.16412297e-05f,
+	-3.33060379e-05f, -3.50157134e-05f, -3.67694993e-05f, -3.85665226e-05f, -4.04057973e-05f, -4.22862140e-05f,
+	-4.42065357e-05f, -4.61654017e-05f, -4.81613242e-05f, -5.01926770e-05f, -5.22576993e-05f, -5.43544920e-05f,
+	-5.64810107e-05f, -5.86350725e-05f, -6.08143382e-05f, -6.30163267e-05f, -6.52384042e-05f, -6.74777693e-05f,
+	-6.97314899e-05f, -7.19964519e-05f, -7.42693883e-05f, -7.65468722e-05f, -7.88253165e-05f, -8.11009595e-05f,
+	-8.33698869e-05f, -8.56280021e-05f, -8.78710562e-05f, -9.00946252e-05f, -9.22941181e-05f, -9.44647618e-05f,
+	-9.66016451e-05f, -9.86996602e-05f, -0.000100753547f, -0.000102757876f, -0.000104707040f, -0.000106595289f,
+	-0.000108416687f, -0.000110165158f, -0.000111834452f, -0.000113418173f, -0.000114909759f, -0.000116302508f,
+	-0.000117589560f, -0.000118763914f, -0.000119818433f, -0.000120745841f, -0.000121538724f, -0.000122189551f,
+	-0.000122690646f, -0.000123034246f, -0.000123212463f, -0.000123217294f, -0.000123040634f, -0.000122674319f,
+	-0.000122110054f, -0.000121339493f, -0.000120354205f, -0.000119145712f, -0.000117705466f, -0.000116024879f,
+	-0.000114095317f, -0.000111908128f, -0.000109454631f, -0.000106726147f, -0.000103713988f, -0.000100409488f,
+	-9.68039894e-05f, -9.28888767e-05f, -8.86555790e-05f, -8.40955763e-05f, -7.92004212e-05f, -7.39617535e-05f,
+	-6.83712860e-05f, -6.24208624e-05f, -5.61024353e-05f, -4.94080778e-05f, -4.23300298e-05f, -3.48606736e-05f,
+	-2.69925786e-05f, -1.87184960e-05f, -1.00313828e-05f, -9.24412404e-07f, 8.60900855e-06f, 1.85752233e-05f,
+	2.89803156e-05f, 3.98300872e-05f, 5.11300495e-05f, 6.28853959e-05f, 7.51009939e-05f, 8.77813873e-05f,
+	0.000100930738f, 0.000114552837f, 0.000128651111f, 0.000143228535f, 0.000158287687f, 0.000173830718f,
+	0.000189859304f, 0.000206374651f, 0.000223377487f, 0.000240868001f, 0.000258845917f, 0.000277310377f,
+	0.000296259997f, 0.000315692771f, 0.000335606223f, 0.000355997152f, 0.000376861804f, 0.000398195814f,
+	0.000419994118f, 0.000442251010f, 0.000464960176f, 0.000488114514f, 0.000511706283f, 0.000535727013f,
+	0.000560167537f, 0.000585017842f, 0.000610267336f, 0.000635904551f, 0.000661917205f, 0.000688292319f,
+	0.000715016155f, 0.000742074102f, 0.000769450678f, 0.000797129644f, 0.000825094001f, 0.000853325881f,
+	0.000881806423f, 0.000910516130f, 0.000939434511f, 0.000968540320f, 0.000997811323f, 0.00102722459f,
+	0.00105675624f, 0.00108638138f, 0.00111607451f, 0.00114580919f, 0.00117555785f, 0.00120529253f,
+	0.00123498391f, 0.00126460230f, 0.00129411684f, 0.00132349576f, 0.00135270681f, 0.00138171669f,
+	0.00141049107f, 0.00143899524f, 0.00146719348f, 0.00149504922f, 0.00152252510f, 0.00154958328f,
+	0.00157618499f, 0.00160229055f, 0.00162785978f, 0.00165285193f, 0.00167722534f, 0.00170093786f,
+	0.00172394654f, 0.00174620806f, 0.00176767842f, 0.00178831292f, 0.00180806662f, 0.00182689389f,
+	0.00184474862f, 0.00186158437f, 0.00187735423f, 0.00189201115f, 0.00190550729f, 0.00191779481f,
+	0.00192882563f, 0.00193855143f, 0.00194692344f, 0.00195389311f, 0.00195941166f, 0.00196343032f,
+	0.00196589972f, 0.00196677144f, 0.00196599658f, 0.00196352624f, 0.00195931224f, 0.00195330591f,
+	0.00194545952f, 0.00193572522f, 0.00192405551f, 0.00191040360f, 0.00189472293f, 0.00187696761f,
+	0.00185709214f, 0.00183505181f, 0.00181080261f, 0.00178430113f, 0.00175550487f, 0.00172437227f,
+	0.00169086258f, 0.00165493600f, 0.00161655375f, 0.00157567835f, 0.00153227337f, 0.00148630340f,
+	0.00143773470f, 0.00138653454f, 0.00133267185f, 0.00127611682f, 0.00121684128f, 0.00115481869f,
+	0.00109002402f, 0.00102243409f, 0.000952027622f, 0.000878784806f, 0.000802688068f, 0.000723721634f,
+	0.000641871826f, 0.000557127118f, 0.000469477964f, 0.000378917146f, 0.000285439688f, 0.000189042956f,
+	8.97266655e-05f, -1.25070146e-05f, -0.000117653406f, -0.000225705284f, -0.000336652825f, -0.000450483523f,
+	-0.000567182200f, -0.000686730840f, -0.000809108780f, -0.000934292271f, -0.00106225477f, -0.00119296683f,
+	-0.00132639601f, -0.00146250671f, -0.00160126027f, -0.00174261502f, -0.00188652601f, -0.00203294540f,
+	-0.00218182150f, -0.00233310019f, -0.00248672324f, -0.00264262967f, -0.00280075520f, -0.00296103186f,
+	-0.00312338816f, -0.00328774983f, -0.00345403887f, -0.00362217380f, -0.00379206962f, -0.00396363810f,
+	-0.00413678773f, -0.00431142282f, -0.00448744511f, -0.00466475263f, -0.00484324014f, -0.00502279773f,
+	-0.00520331366f, -0.00538467243f, -0.00556675484f, -0.00574943842f, -0.00593259744f, -0.00611610245f,
+	-0.00629982166f, -0.00648361957f, -0.00666735740f, -0.00685089268f, -0.00703408150f, -0.00721677486f,
+	-0.00739882281f, -0.00758007029f, -0.00776036130f, -0.00793953612f, -0.00811743177f, -0.00829388388f,
+	-0.00846872479f, -0.00864178408f, -0.00881288946f, -0.00898186583f, -0.00914853532f, -0.00931272004f,
+	-0.00947423745f, -0.00963290408f, -0.00978853460f, -0.00994094275f, -0.0100899395f, -0.0102353347f,
+	-0.0103769358f, -0.0105145508f, -0.0106479852f, -0.0107770432f, -0.0109015303f, -0.0110212481f,
+	-0.0111359991f, -0.0112455860f, -0.0113498103f, -0.0114484727f, -0.0115413759f, -0.0116283195f,
+	-0.0117091071f, -0.0117835384f, -0.0118514188f, -0.0119125489f, -0.0119667351f, -0.0120137818f,
+	-0.0120534953f, -0.0120856846f, -0.0121101588f, -0.0121267280f, -0.0121352077f, -0.0121354116f,
+	-0.0121271573f, -0.0121102668f, -0.0120845614f, -0.0120498668f, -0.0120060127f, -0.0119528314f,
+	-0.0118901571f, -0.0118178306f, -0.0117356936f, -0.0116435932f, -0.0115413815f, -0.0114289131f,
+	-0.0113060484f, -0.0111726541f, -0.0110285981f, -0.0108737564f, -0.0107080098f, -0.0105312448f,
+	-0.0103433523f, -0.0101442318f, -0.00993378554f, -0.00971192587f, -0.00947856810f, -0.00923363771f,
+	-0.00897706300f, -0.00870878343f, -0.00842874404f, -0.00813689549f, -0.00783319958f, -0.00751762325f,
+	-0.00719014229f, -0.00685074087f, -0.00649941107f, -0.00613615382f, -0.00576097798f, -0.00537390169f,
+	-0.00497495243f, -0.00456416560f, -0.00414158637f, -0.00370726991f, -0.00326128025f, -0.00280369050f,
+	-0.00233458471f, -0.00185405556f, -0.00136220676f, -0.000859151420f, -0.000345012930f, 0.000180074901f,
+	0.000715968024f, 0.00126251183f, 0.00181954145f, 0.00238688104f, 0.00296434457f, 0.00355173461f,
+	0.00414884370f, 0.00475545367f, 0.00537133450f, 0.00599624589f, 0.00662993686f, 0.00727214525f,
+	0.00792259816f, 0.00858101156f, 0.00924709067f, 0.00992053002f, 0.0106010120f, 0.0112882107f,
+	0.0119817872f, 0.0126813920f, 0.0133866658f, 0.0140972389f, 0.0148127303f, 0.0155327478f,
+	0.0162568912f, 0.0169847477f, 0.0177158955f, 0.0184499044f, 0.0191863291f, 0.0199247207f,
+	0.0206646174f, 0.0214055460f, 0.0221470315f, 0.0228885803f, 0.0236296970f, 0.0243698731f,
+	0.0251085963f, 0.0258453395f, 0.0265795738f, 0.0273107607f, 0.0280383490f, 0.0287617892f,
+	0.0294805150f, 0.0301939622f, 0.0309015550f, 0.0316027142f, 0.0322968476f, 0.0329833664f,
+	0.0336616710f, 0.0343311615f, 0.0349912271f, 0.0356412604f, 0.0362806395f, 0.0369087495f,
+	0.0375249609f, 0.0381286591f, 0.0387192070f, 0.0392959751f, 0.0398583338f, 0.0404056534f,
+	0.0409372896f, 0.0414526165f, 0.0419509932f, 0.0424317904f, 0.0428943746f, 0.0433381051f,
+	0.0437623598f, 0.0441665091f, 0.0445499234f, 0.0449119806f, 0.0452520624f, 0.0455695502f,
+	0.0458638407f, 0.0461343192f, 0.0463803895f, 0.0466014594f, 0.0467969365f, 0.0469662398f,
+	0.0471087955f, 0.0472240411f, 0.0473114178f, 0.0473703779f, 0.0474003814f, 0.0474008955f,
+	0.0473714098f, 0.0473114103f, 0.0472204052f, 0.0470979065f, 0.0469434485f, 0.0467565656f,
+	0.0465368181f, 0.0462837778f, 0.0459970199f, 0.0456761494f, 0.0453207791f, 0.0449305363f,
+	0.0445050746f, 0.0440440550f, 0.0435471572f, 0.0430140831f, 0.0424445495f, 0.0418382920f,
+	0.0411950685f, 0.0405146554f, 0.0397968479f, 0.0390414633f, 0.0382483415f, 0.0374173447f,
+	0.0365483500f, 0.0356412642f, 0.0346960165f, 0.0337125547f, 0.0326908529f, 0.0316309147f,
+	0.0305327568f, 0.0293964315f, 0.0282220077f, 0.0270095859f, 0.0257592890f, 0.0244712681f,
+	0.0231456999f, 0.0217827857f, 0.0203827545f, 0.0189458672f, 0.0174724068f, 0.0159626845f,
+	0.0144170411f, 0.0128358454f, 0.0112194931f, 0.00956840999f, 0.00788304955f, 0.00616389373f,
+	0.00441145431f, 0.00262627215f, 0.000808915996f, -0.00104001537f, -0.00291989418f, -0.00483006286f,
+	-0.00676983548f, -0.00873849634f, -0.0107352994f, -0.0127594713f, -0.0148102073f, -0.0168866757f,
+	-0.0189880133f, -0.0211133305f, -0.0232617073f, -0.0254321937f, -0.0276238136f, -0.0298355632f,
+	-0.0320664048f, -0.0343152769f, -0.0365810953f, -0.0388627388f, -0.0411590599f, -0.0434688926f,
+	-0.0457910374f, -0.0481242687f, -0.0504673347f, -0.0528189652f, -0.0551778562f, -0.0575426780f,
+	-0.0599120855f, -0.0622847006f, -0.0646591261f, -0.0670339465f, -0.0694077089f, -0.0717789531f,
+	-0.0741461962f, -0.0765079260f, -0.0788626224f, -0.0812087208f, -0.0835446715f, -0.0858688802f,
+	-0.0881797448f, -0.0904756561f, -0.0927549601f, -0.0950160176f, -0.0972571522f, -0.0994766951f,
+	-0.101672933f, -0.103844173f, -0.105988696f, -0.108104758f, -0.110190623f, -0.112244546f,
+	-0.114264764f, -0.116249502f, -0.118196994f, -0.120105453f, -0.121973090f, -0.123798124f,
+	-0.125578761f, -0.127313197f, -0.128999621f, -0.130636260f, -0.132221311f, -0.133752957f,
+	-0.135229424f, -0.136648908f, -0.138009623f, -0.139309794f, -0.140547633f, -0.141721383f,
+	-0.142829269f, -0.143869549f, -0.144840479f, -0.145740315f, -0.146567360f, -0.147319913f,
+	-0.147996262f, -0.148594737f, -0.149113685f, -0.149551466f, -0.149906456f, -0.150177062f,
+	-0.150361672f, -0.150458753f, -0.150466755f, -0.150384158f, -0.150209486f, -0.149941280f,
+	-0.149578065f, -0.149118468f, -0.148561105f, -0.147904605f, -0.147147655f, -0.146288961f,
+	-0.145327285f, -0.144261375f, -0.143090069f, -0.141812190f, -0.140426636f, -0.138932317f,
+	-0.137328207f, -0.135613292f, -0.133786604f, -0.131847218f, -0.129794270f, -0.127626911f,
+	-0.125344336f, -0.122945808f, -0.120430611f, -0.117798090f, -0.115047626f, -0.112178653f,
+	-0.109190643f, -0.106083125f, -0.102855682f, -0.0995079353f, -0.0960395560f, -0.0924502760f,
+	-0.0887398645f, -0.0849081650f, -0.0809550509f, -0.0768804550f, -0.0726843625f, -0.0683668181f,
+	-0.0639279187f, -0.0593678132f, -0.0546867028f, -0.0498848483f, -0.0449625663f, -0.0399202257f,
+	-0.0347582549f, -0.0294771325f, -0.0240774006f, -0.0185596533f, -0.0129245436f, -0.00717278104f,
+	-0.00130513019f, 0.00467758626f, 0.0107744886f, 0.0169846397f, 0.0233070478f, 0.0297406632f,
+	0.0362843797f, 0.0429370329f, 0.0496974029f, 0.0565642156f, 0.0635361448f, 0.0706117898f,
+	0.0777897239f, 0.0850684419f, 0.0924463943f, 0.0999219716f, 0.107493520f, 0.115159318f,
+	0.122917607f, 0.130766571f, 0.138704315f, 0.146728948f, 0.154838488f, 0.163030908f,
+	0.171304122f, 0.179656044f, 0.188084468f, 0.196587205f, 0.205161989f, 0.213806495f,
+	0.222518370f, 0.231295243f, 0.240134642f, 0.249034107f, 0.257991105f, 0.267003059f,
+	0.276067376f, 0.285181433f, 0.294342548f, 0.303547949f, 0.312794954f, 0.322080731f,
+	0.331402510f, 0.340757370f, 0.350142509f, 0.359554976f, 0.368991822f, 0.378450096f,
+	0.387926817f, 0.397418976f, 0.406923503f, 0.416437358f, 0.425957471f, 0.435480744f,
+	0.445004016f, 0.454524189f, 0.464038104f, 0.473542601f, 0.483034521f, 0.492510647f,
+	0.501967788f, 0.511402786f, 0.520812333f, 0.530193329f, 0.539542496f, 0.548856616f,
+	0.558132470f, 0.567366838f, 0.576556504f, 0.585698247f, 0.594788849f, 0.603825152f,
+	0.612803936f, 0.621721983f, 0.630576134f, 0.639363289f, 0.648080230f, 0.656723857f,
+	0.665291011f, 0.673778713f, 0.682183743f, 0.690503120f, 0.698733866f, 0.706872880f,
+	0.714917243f, 0.722863972f, 0.730710149f, 0.738452911f, 0.746089339f, 0.753616631f,
+	0.761032045f, 0.768332779f, 0.775516093f, 0.782579362f, 0.789519846f, 0.796335042f,
+	0.803022385f, 0.809579253f, 0.816003323f, 0.822292030f, 0.828443110f, 0.834454238f,
+	0.840323031f, 0.846047282f, 0.851624906f, 0.857053697f, 0.862331629f, 0.867456675f,
+	0.872426808f, 0.877240241f, 0.881895065f, 0.886389494f, 0.890721858f, 0.894890428f,
+	0.898893595f, 0.902729869f, 0.906397700f, 0.909895778f, 0.913222671f, 0.916377127f,
+	0.919357896f, 0.922163904f, 0.924793959f, 0.927247107f, 0.929522336f, 0.931618869f,
+	0.933535814f, 0.935272396f, 0.936828077f, 0.938202143f, 0.939394057f, 0.940403402f,
+	0.941229761f, 0.941872776f, 0.942332268f, 0.942608058f, 0.942700028f, 0.942608058f,
+	0.942332268f, 0.941872776f, 0.941229761f, 0.940403402f, 0.939394057f, 0.938202143f,
+	0.936828077f, 0.935272396f, 0.933535814f, 0.931618869f, 0.929522336f, 0.927247107f,
+	0.924793959f, 0.922163904f, 0.919357896f, 0.916377127f, 0.913222671f, 0.909895778f,
+	0.906397700f, 0.902729869f, 0.898893595f, 0.894890428f, 0.890721858f, 0.886389494f,
+	0.881895065f, 0.877240241f, 0.872426808f, 0.867456675f, 0.862331629f, 0.857053697f,
+	0.851624906f, 0.846047282f, 0.840323031f, 0.834454238f, 0.828443110f, 0.822292030f,
+	0.816003323f, 0.809579253f, 0.803022385f, 0.796335042f, 0.789519846f, 0.782579362f,
+	0.775516093f, 0.768332779f, 0.761032045f, 0.753616631f, 0.746089339f, 0.738452911f,
+	0.730710149f, 0.722863972f, 0.714917243f, 0.706872880f, 0.698733866f, 0.690503120f,
+	0.682183743f, 0.673778713f, 0.665291011f, 0.656723857f, 0.648080230f, 0.639363289f,
+	0.630576134f, 0.621721983f, 0.612803936f, 0.603825152f, 0.594788849f, 0.585698247f,
+	0.576556504f, 0.567366838f, 0.558132470f, 0.548856616f, 0.539542496f, 0.530193329f,
+	0.520812333f, 0.511402786f, 0.501967788f, 0.492510647f, 0.483034521f, 0.473542601f,
+	0.464038104f, 0.454524189f, 0.445004016f, 0.435480744f, 0.425957471f, 0.416437358f,
+	0.406923503f, 0.397418976f, 0.387926817f, 0.378450096f, 0.368991822f, 0.359554976f,
+	0.350142509f, 0.340757370f, 0.331402510f, 0.322080731f, 0.312794954f, 0.303547949f,
+	0.294342548f, 0.285181433f, 0.276067376f, 0.267003059f, 0.257991105f, 0.249034107f,
+	0.240134642f, 0.231295243f, 0.222518370f, 0.213806495f, 0.205161989f, 0.196587205f,
+	0.188084468f, 0.179656044f, 0.171304122f, 0.163030908f, 0.154838488f, 0.146728948f,
+	0.138704315f, 0.130766571f, 0.122917607f, 0.115159318f, 0.107493520f, 0.0999219716f,
+	0.0924463943f, 0.0850684419f, 0.0777897239f, 0.0706117898f, 0.0635361448f, 0.0565642156f,
+	0.0496974029f, 0.0429370329f, 0.0362843797f, 0.0297406632f, 0.0233070478f, 0.0169846397f,
+	0.0107744886f, 0.00467758626f, -0.00130513019f, -0.00717278104f, -0.0129245436f, -0.0185596533f,
+	-0.0240774006f, -0.0294771325f, -0.0347582549f, -0.0399202257f, -0.0449625663f, -0.0498848483f,
+	-0.0546867028f, -0.0593678132f, -0.0639279187f, -0.0683668181f, -0.0726843625f, -0.0768804550f,
+	-0.0809550509f, -0.0849081650f, -0.0887398645f, -0.0924502760f, -0.0960395560f, -0.0995079353f,
+	-0.102855682f, -0.106083125f, -0.109190643f, -0.112178653f, -0.115047626f, -0.117798090f,
+	-0.120430611f, -0.122945808f, -0.125344336f, -0.127626911f, -0.129794270f, -0.131847218f,
+	-0.133786604f, -0.135613292f, -0.137328207f, -0.138932317f, -0.140426636f, -0.141812190f,
+	-0.143090069f, -0.144261375f, -0.145327285f, -0.146288961f, -0.147147655f, -0.147904605f,
+	-0.148561105f, -0.149118468f, -0.149578065f, -0.149941280f, -0.150209486f, -0.150384158f,
+	-0.150466755f, -0.150458753f, -0.150361672f, -0.150177062f, -0.149906456f, -0.149551466f,
+	-0.149113685f, -0.148594737f, -0.147996262f, -0.147319913f, -0.146567360f, -0.145740315f,
+	-0.144840479f, -0.143869549f, -0.142829269f, -0.141721383f, -0.140547633f, -0.139309794f,
+	-0.138009623f, -0.136648908f, -0.135229424f, -0.133752957f, -0.132221311f, -0.130636260f,
+	-0.128999621f, -0.127313197f, -0.125578761f, -0.123798124f, -0.121973090f, -0.120105453f,
+	-0.118196994f, -0.116249502f, -0.114264764f, -0.112244546f, -0.110190623f, -0.108104758f,
+	-0.105988696f, -0.103844173f, -0.101672933f, -0.0994766951f, -0.0972571522f, -0.0950160176f,
+	-0.0927549601f, -0.0904756561f, -0.0881797448f, -0.0858688802f, -0.0835446715f, -0.0812087208f,
+	-0.0788626224f, -0.0765079260f, -0.0741461962f, -0.0717789531f, -0.0694077089f, -0.0670339465f,
+	-0.0646591261f, -0.0622847006f, -0.0599120855f, -0.0575426780f, -0.0551778562f, -0.0528189652f,
+	-0.0504673347f, -0.0481242687f, -0.0457910374f, -0.0434688926f, -0.0411590599f, -0.0388627388f,
+	-0.0365810953f, -0.0343152769f, -0.0320664048f, -0.0298355632f, -0.0276238136f, -0.0254321937f,
+	-0.0232617073f, -0.0211133305f, -0.0189880133f, -0.0168866757f, -0.0148102073f, -0.0127594713f,
+	-0.0107352994f, -0.00873849634f, -0.00676983548f, -0.00483006286f, -0.00291989418f, -0.00104001537f,
+	0.000808915996f, 0.00262627215f, 0.00441145431f, 0.00616389373f, 0.00788304955f, 0.00956840999f,
+	0.0112194931f, 0.0128358454f, 0.0144170411f, 0.0159626845f, 0.0174724068f, 0.0189458672f,
+	0.0203827545f, 0.0217827857f, 0.0231456999f, 0.0244712681f, 0.0257592890f, 0.0270095859f,
+	0.0282220077f, 0.0293964315f, 0.0305327568f, 0.0316309147f, 0.0326908529f, 0.0337125547f,
+	0.0346960165f, 0.0356412642f, 0.0365483500f, 0.0374173447f, 0.0382483415f, 0.0390414633f,
+	0.0397968479f, 0.0405146554f, 0.0411950685f, 0.0418382920f, 0.0424445495f, 0.0430140831f,
+	0.0435471572f, 0.0440440550f, 0.0445050746f, 0.0449305363f, 0.0453207791f, 0.0456761494f,
+	0.0459970199f, 0.0462837778f, 0.0465368181f, 0.0467565656f, 0.0469434485f, 0.0470979065f,
+	0.0472204052f, 0.0473114103f, 0.0473714098f, 0.0474008955f, 0.0474003814f, 0.0473703779f,
+	0.0473114178f, 0.0472240411f, 0.0471087955f, 0.0469662398f, 0.0467969365f, 0.0466014594f,
+	0.0463803895f, 0.0461343192f, 0.0458638407f, 0.0455695502f, 0.0452520624f, 0.0449119806f,
+	0.0445499234f, 0.0441665091f, 0.0437623598f, 0.0433381051f, 0.0428943746f, 0.0424317904f,
+	0.0419509932f, 0.0414526165f, 0.0409372896f, 0.0404056534f, 0.0398583338f, 0.0392959751f,
+	0.0387192070f, 0.0381286591f, 0.0375249609f, 0.0369087495f, 0.0362806395f, 0.0356412604f,
+	0.0349912271f, 0.0343311615f, 0.0336616710f, 0.0329833664f, 0.0322968476f, 0.0316027142f,
+	0.0309015550f, 0.0301939622f, 0.0294805150f, 0.0287617892f, 0.0280383490f, 0.0273107607f,
+	0.0265795738f, 0.0258453395f, 0.0251085963f, 0.0243698731f, 0.0236296970f, 0.0228885803f,
+	0.0221470315f, 0.0214055460f, 0.0206646174f, 0.0199247207f, 0.0191863291f, 0.0184499044f,
+	0.0177158955f, 0.0169847477f, 0.0162568912f, 0.0155327478f, 0.0148127303f, 0.0140972389f,
+	0.0133866658f, 0.0126813920f, 0.0119817872f, 0.0112882107f, 0.0106010120f, 0.00992053002f,
+	0.00924709067f, 0.00858101156f, 0.00792259816f, 0.00727214525f, 0.00662993686f, 0.00599624589f,
+	0.00537133450f, 0.00475545367f, 0.00414884370f, 0.00355173461f, 0.00296434457f, 0.00238688104f,
+	0.00181954145f, 0.00126251183f, 0.000715968024f, 0.000180074901f, -0.000345012930f, -0.000859151420f,
+	-0.00136220676f, -0.00185405556f, -0.00233458471f, -0.00280369050f, -0.00326128025f, -0.00370726991f,
+	-0.00414158637f, -0.00456416560f, -0.00497495243f, -0.00537390169f, -0.00576097798f, -0.00613615382f,
+	-0.00649941107f, -0.00685074087f, -0.00719014229f, -0.00751762325f, -0.00783319958f, -0.00813689549f,
+	-0.00842874404f, -0.00870878343f, -0.00897706300f, -0.00923363771f, -0.00947856810f, -0.00971192587f,
+	-0.00993378554f, -0.0101442318f, -0.0103433523f, -0.0105312448f, -0.0107080098f, -0.0108737564f,
+	-0.0110285981f, -0.0111726541f, -0.0113060484f, -0.0114289131f, -0.0115413815f, -0.0116435932f,
+	-0.0117356936f, -0.0118178306f, -0.0118901571f, -0.0119528314f, -0.0120060127f, -0.0120498668f,
+	-0.0120845614f, -0.0121102668f, -0.0121271573f, -0.0121354116f, -0.0121352077f, -0.0121267280f,
+	-0.0121101588f, -0.0120856846f, -0.0120534953f, -0.0120137818f, -0.0119667351f, -0.0119125489f,
+	-0.0118514188f, -0.0117835384f, -0.0117091071f, -0.0116283195f, -0.0115413759f, -0.0114484727f,
+	-0.0113498103f, -0.0112455860f, -0.0111359991f, -0.0110212481f, -0.0109015303f, -0.0107770432f,
+	-0.0106479852f, -0.0105145508f, -0.0103769358f, -0.0102353347f, -0.0100899395f, -0.00994094275f,
+	-0.00978853460f, -0.00963290408f, -0.00947423745f, -0.00931272004f, -0.00914853532f, -0.00898186583f,
+	-0.00881288946f, -0.00864178408f, -0.00846872479f, -0.00829388388f, -0.00811743177f, -0.00793953612f,
+	-0.00776036130f, -0.00758007029f, -0.00739882281f, -0.00721677486f, -0.00703408150f, -0.00685089268f,
+	-0.00666735740f, -0.00648361957f, -0.00629982166f, -0.00611610245f, -0.00593259744f, -0.00574943842f,
+	-0.00556675484f, -0.00538467243f, -0.00520331366f, -0.00502279773f, -0.00484324014f, -0.00466475263f,
+	-0.00448744511f, -0.00431142282f, -0.00413678773f, -0.00396363810f, -0.00379206962f, -0.00362217380f,
+	-0.00345403887f, -0.00328774983f, -0.00312338816f, -0.00296103186f, -0.00280075520f, -0.00264262967f,
+	-0.00248672324f, -0.00233310019f, -0.00218182150f, -0.00203294540f, -0.00188652601f, -0.00174261502f,
+	-0.00160126027f, -0.00146250671f, -0.00132639601f, -0.00119296683f, -0.00106225477f, -0.000934292271f,
+	-0.000809108780f, -0.000686730840f, -0.000567182200f, -0.000450483523f, -0.000336652825f, -0.000225705284f,
+	-0.000117653406f, -1.25070146e-05f, 8.97266655e-05f, 0.000189042956f, 0.000285439688f, 0.000378917146f,
+	0.000469477964f, 0.000557127118f, 0.000641871826f, 0.000723721634f, 0.000802688068f, 0.000878784806f,
+	0.000952027622f, 0.00102243409f, 0.00109002402f, 0.00115481869f, 0.00121684128f, 0.00127611682f,
+	0.00133267185f, 0.00138653454f, 0.00143773470f, 0.00148630340f, 0.00153227337f, 0.00157567835f,
+	0.00161655375f, 0.00165493600f, 0.00169086258f, 0.00172437227f, 0.00175550487f, 0.00178430113f,
+	0.00181080261f, 0.00183505181f, 0.00185709214f, 0.00187696761f, 0.00189472293f, 0.00191040360f,
+	0.00192405551f, 0.00193572522f, 0.00194545952f, 0.00195330591f, 0.00195931224f, 0.00196352624f,
+	0.00196599658f, 0.00196677144f, 0.00196589972f, 0.00196343032f, 0.00195941166f, 0.00195389311f,
+	0.00194692344f, 0.00193855143f, 0.00192882563f, 0.00191779481f, 0.00190550729f, 0.00189201115f,
+	0.00187735423f, 0.00186158437f, 0.00184474862f, 0.00182689389f, 0.00180806662f, 0.00178831292f,
+	0.00176767842f, 0.00174620806f, 0.00172394654f, 0.00170093786f, 0.00167722534f, 0.00165285193f,
+	0.00162785978f, 0.00160229055f, 0.00157618499f, 0.00154958328f, 0.00152252510f, 0.00149504922f,
+	0.00146719348f, 0.00143899524f, 0.00141049107f, 0.00138171669f, 0.00135270681f, 0.00132349576f,
+	0.00129411684f, 0.00126460230f, 0.00123498391f, 0.00120529253f, 0.00117555785f, 0.00114580919f,
+	0.00111607451f, 0.00108638138f, 0.00105675624f, 0.00102722459f, 0.000997811323f, 0.000968540320f,
+	0.000939434511f, 0.000910516130f, 0.000881806423f, 0.000853325881f, 0.000825094001f, 0.000797129644f,
+	0.000769450678f, 0.000742074102f, 0.000715016155f, 0.000688292319f, 0.000661917205f, 0.000635904551f,
+	0.000610267336f, 0.000585017842f, 0.000560167537f, 0.000535727013f, 0.000511706283f, 0.000488114514f,
+	0.000464960176f, 0.000442251010f, 0.000419994118f, 0.000398195814f, 0.000376861804f, 0.000355997152f,
+	0.000335606223f, 0.000315692771f, 0.000296259997f, 0.000277310377f, 0.000258845917f, 0.000240868001f,
+	0.000223377487f, 0.000206374651f, 0.000189859304f, 0.000173830718f, 0.000158287687f, 0.000143228535f,
+	0.000128651111f, 0.000114552837f, 0.000100930738f, 8.77813873e-05f, 7.51009939e-05f, 6.28853959e-05f,
+	5.11300495e-05f, 3.98300872e-05f, 2.89803156e-05f, 1.85752233e-05f, 8.60900855e-06f, -9.24412404e-07f,
+	-1.00313828e-05f, -1.87184960e-05f, -2.69925786e-05f, -3.48606736e-05f, -4.23300298e-05f, -4.94080778e-05f,
+	-5.61024353e-05f, -6.24208624e-05f, -6.83712860e-05f, -7.39617535e-05f, -7.92004212e-05f, -8.40955763e-05f,
+	-8.86555790e-05f, -9.28888767e-05f, -9.68039894e-05f, -0.000100409488f, -0.000103713988f, -0.000106726147f,
+	-0.000109454631f, -0.000111908128f, -0.000114095317f, -0.000116024879f, -0.000117705466f, -0.000119145712f,
+	-0.000120354205f, -0.000121339493f, -0.000122110054f, -0.000122674319f, -0.000123040634f, -0.000123217294f,
+	-0.000123212463f, -0.000123034246f, -0.000122690646f, -0.000122189551f, -0.000121538724f, -0.000120745841f,
+	-0.000119818433f, -0.000118763914f, -0.000117589560f, -0.000116302508f, -0.000114909759f, -0.000113418173f,
+	-0.000111834452f, -0.000110165158f, -0.000108416687f, -0.000106595289f, -0.000104707040f, -0.000102757876f,
+	-0.000100753547f, -9.86996602e-05f, -9.66016451e-05f, -9.44647618e-05f, -9.22941181e-05f, -9.00946252e-05f,
+	-8.78710562e-05f, -8.56280021e-05f, -8.33698869e-05f, -8.11009595e-05f, -7.88253165e-05f, -7.65468722e-05f,
+	-7.42693883e-05f, -7.19964519e-05f, -6.97314899e-05f, -6.74777693e-05f, -6.52384042e-05f, -6.30163267e-05f,
+	-6.08143382e-05f, -5.86350725e-05f, -5.64810107e-05f, -5.43544920e-05f, -5.22576993e-05f, -5.01926770e-05f,
+	-4.81613242e-05f, -4.61654017e-05f, -4.42065357e-05f, -4.22862140e-05f, -4.04057973e-05f, -3.85665226e-05f,
+	-3.67694993e-05f, -3.50157134e-05f, -3.33060379e-05f, -3.16412297e-05f, -3.00219344e-05f, -2.84486941e-05f,
+	-2.69219454e-05f, -2.54420211e-05f, -2.40091631e-05f, -2.26235152e-05f, -2.12851373e-05f, -1.99939968e-05f,
+	-1.87499845e-05f, -1.75529094e-05f, -1.64025059e-05f, -1.52984358e-05f, -1.42402951e-05f, -1.32276118e-05f,
+	-1.22598540e-05f, -1.13364331e-05f, -1.04567052e-05f, -9.61997375e-06f, -8.82549739e-06f, -8.07248853e-06f,
+	-7.36011725e-06f, -6.68751773e-06f, -6.05378682e-06f
+};
+
+// 32000 -> 44100, quality 3
+static const FIRCoefficient KERNEL_2[] = {
+	8.20368678e-06f, 8.83379289e-06f, 9.48590787e-06f, 1.01597388e-05f, 1.08549348e-05f, 1.15710800e-05f,
+	1.23076961e-05f, 1.30642384e-05f, 1.38400937e-05f, 1.46345783e-05f, 1.54469381e-05f, 1.62763463e-05f,
+	1.71218981e-05f, 1.79826184e-05f, 1.88574468e-05f, 1.97452482e-05f, 2.06448058e-05f, 2.15548207e-05f,
+	2.24739106e-05f, 2.34006111e-05f, 2.43333689e-05f, 2.52705486e-05f, 2.62104222e-05f, 2.71511781e-05f,
+	2.80909153e-05f, 2.90276457e-05f, 2.99592884e-05f, 3.08836752e-05f, 3.17985505e-05f, 3.27015623e-05f,
+	3.35902732e-05f, 3.44621549e-05f, 3.53145988e-05f, 3.61448911e-05f, 3.69502486e-05f, 3.77277829e-05f,
+	3.84745363e-05f, 3.91874564e-05f, 3.98634111e-05f, 4.04991843e-05f, 4.10914836e-05f, 4.16369294e-05f,
+	4.21320728e-05f, 4.25733924e-05f, 4.29572865e-05f, 4.32800916e-05f, 4.35380716e-05f, 4.37274321e-05f,
+	4.38443094e-05f, 4.38847928e-05f, 4.38449097e-05f, 4.37206400e-05f, 4.35079128e-05f, 4.32026172e-05f,
+	4.28006060e-05f, 4.22976955e-05f, 4.16896692e-05f, 4.09722925e-05f, 4.01413017e-05f, 3.91924295e-05f,
+	3.81213904e-05f, 3.69238951e-05f, 3.55956618e-05f, 3.41324121e-05f, 3.25298788e-05f, 3.07838200e-05f,
+	2.88900192e-05f, 2.68442873e-05f, 2.46424825e-05f, 2.22805011e-05f, 1.97543013e-05f, 1.70598942e-05f,
+	1.41933670e-05f, 1.11508753e-05f, 7.92866103e-06f, 4.52305903e-06f, 9.30500221e-07f, -2.85247620e-06f,
+	-6.82921609e-06f, -1.10029414e-05f, -1.53767432e-05f, -1.99535698e-05f, -2.47362241e-05f, -2.97273491e-05f,
+	-3.49294205e-05f, -4.03447448e-05f, -4.59754337e-05f, -5.18234192e-05f, -5.78904219e-05f, -6.41779625e-05f,
+	-7.06873179e-05f, -7.74195723e-05f, -8.43755479e-05f, -9.15558267e-05f, -9.89607288e-05f, -0.000106590327f,
+	-0.000114444403f, -0.000122522470f, -0.000130823741f, -0.000139347147f, -0.000148091276f, -0.000157054455f,
+	-0.000166234633f, -0.000175629466f, -0.000185236233f, -0.000195051907f, -0.000205073069f, -0.000215295964f,
+	-0.000225716445f, -0.000236330015f, -0.000247131771f, -0.000258116401f, -0.000269278273f, -0.000280611246f,
+	-0.000292108860f, -0.000303764187f, -0.000315569923f, -0.000327518297f, -0.000339601131f, -0.000351809809f,
+	-0.000364135311f, -0.000376568147f, -0.000389098393f, -0.000401715661f, -0.000414409122f, -0.000427167572f,
+	-0.000439979223f, -0.000452831970f, -0.000465713179f, -0.000478609814f, -0.000491508341f, -0.000504394819f,
+	-0.000517254812f, -0.000530073477f, -0.000542835623f, -0.000555525417f, -0.000568126736f, -0.000580623047f,
+	-0.000592997356f, -0.000605232141f, -0.000617309706f, -0.000629211718f, -0.000640919607f, -0.000652414339f,
+	-0.000663676590f, -0.000674686453f, -0.000685424020f, -0.000695868628f, -0.000705999613f, -0.000715795846f,
+	-0.000725235906f, -0.000734297966f, -0.000742960139f, -0.000751200132f, -0.000758995418f, -0.000766323239f,
+	-0.000773160602f, -0.000779484340f, -0.000785271171f, -0.000790497521f, -0.000795139698f, -0.000799174013f,
+	-0.000802576542f, -0.000805323303f, -0.000807390374f, -0.000808753597f, -0.000809388934f, -0.000809272402f,
+	-0.000808379962f, -0.000806687691f, -0.000804171723f, -0.000800808368f, -0.000796573993f, -0.000791445142f,
+	-0.000785398704f, -0.000778411573f, -0.000770461163f, -0.000761524891f, -0.000751580752f, -0.000740606920f,
+	-0.000728581974f, -0.000715484959f, -0.000701295387f, -0.000685993058f, -0.000669558591f, -0.000651972834f,
+	-0.000633217394f, -0.000613274402f, -0.000592126686f, -0.000569757714f, -0.000546151656f, -0.000521293492f,
+	-0.000495168846f, -0.000467764214f, -0.000439067022f, -0.000409065455f, -0.000377748656f, -0.000345106731f,
+	-0.000311130687f, -0.000275812665f, -0.000239145753f, -0.000201124174f, -0.000161743228f, -0.000120999386f,
+	-7.88902908e-05f, -3.54147960e-05f, 9.42700444e-06f, 5.56337400e-05f, 0.000103202743f, 0.000152130000f,
+	0.000202410127f, 0.000254036393f, 0.000307000562f, 0.000361293030f, 0.000416902680f, 0.000473816879f,
+	0.000532021455f, 0.000591500779f, 0.000652237562f, 0.000714212889f, 0.000777406269f, 0.000841795583f,
+	0.000907357025f, 0.000974065159f, 0.00104189268f, 0.00111081090f, 0.00118078908f, 0.00125179486f,
+	0.00132379413f, 0.00139675115f, 0.00147062808f, 0.00154538557f, 0.00162098242f, 0.00169737556f,
+	0.00177452026f, 0.00185236987f, 0.00193087605f, 0.00200998853f, 0.00208965526f, 0.00216982258f,
+	0.00225043460f, 0.00233143452f, 0.00241276273f, 0.00249435869f, 0.00257615955f, 0.00265810126f,
+	0.00274011749f, 0.00282214046f, 0.00290410127f, 0.00298592844f, 0.00306754955f, 0.00314889033f,
+	0.00322987488f, 0.00331042591f, 0.00339046470f, 0.00346991117f, 0.00354868313f, 0.00362669793f,
+	0.00370387128f, 0.00378011703f, 0.00385534856f, 0.00392947765f, 0.00400241511f, 0.00407407014f,
+	0.00414435193f, 0.00421316782f, 0.00428042421f, 0.00434602750f, 0.00440988224f, 0.00447189296f,
+	0.00453196326f, 0.00458999583f, 0.00464589335f, 0.00469955802f, 0.00475089159f, 0.00479979487f,
+	0.00484616915f, 0.00488991570f, 0.00493093533f, 0.00496912887f, 0.00500439713f, 0.00503664184f,
+	0.00506576430f, 0.00509166624f, 0.00511425035f, 0.00513341976f, 0.00514907716f, 0.00516112754f,
+	0.00516947592f, 0.00517402869f, 0.00517469225f, 0.00517137581f, 0.00516398856f, 0.00515244156f,
+	0.00513664726f, 0.00511651905f, 0.00509197311f, 0.00506292656f, 0.00502929883f, 0.00499101123f,
+	0.00494798692f, 0.00490015186f, 0.00484743342f, 0.00478976220f, 0.00472707069f, 0.00465929508f,
+	0.00458637252f, 0.00450824527f, 0.00442485651f, 0.00433615409f, 0.00424208725f, 0.00414261036f,
+	0.00403768010f, 0.00392725738f, 0.00381130539f, 0.00368979247f, 0.00356269022f, 0.00342997373f,
+	0.00329162274f, 0.00314762071f, 0.00299795531f, 0.00284261885f, 0.00268160738f, 0.00251492229f,
+	0.00234256848f, 0.00216455641f, 0.00198090076f, 0.00179162133f, 0.00159674254f, 0.00139629387f,
+	0.00119030999f, 0.000978830503f, 0.000761900272f, 0.000539569417f, 0.000311893265f, 7.89326587e-05f,
+	-0.000159246207f, -0.000402571663f, -0.000650966540f, -0.000904347980f, -0.00116262771f, -0.00142571155f,
+	-0.00169349997f, -0.00196588761f, -0.00224276283f, -0.00252400944f, -0.00280950405f, -0.00309911883f,
+	-0.00339271897f, -0.00369016477f, -0.00399131002f, -0.00429600384f, -0.00460408814f, -0.00491539994f,
+	-0.00522977021f, -0.00554702431f, -0.00586698251f, -0.00618945807f, -0.00651426008f, -0.00684119109f,
+	-0.00717004854f, -0.00750062475f, -0.00783270597f, -0.00816607382f, -0.00850050338f, -0.00883576646f,
+	-0.00917162932f, -0.00950785168f, -0.00984418951f, -0.0101803942f, -0.0105162133f, -0.0108513869f,
+	-0.0111856535f, -0.0115187466f, -0.0118503943f, -0.0121803218f, -0.0125082508f, -0.0128338980f,
+	-0.0131569766f, -0.0134771978f, -0.0137942676f, -0.0141078895f, -0.0144177657f, -0.0147235934f,
+	-0.0150250671f, -0.0153218824f, -0.0156137282f, -0.0159002934f, -0.0161812659f, -0.0164563321f,
+	-0.0167251732f, -0.0169874746f, -0.0172429178f, -0.0174911842f, -0.0177319553f, -0.0179649107f,
+	-0.0181897301f, -0.0184060987f, -0.0186136942f, -0.0188121982f, -0.0190012977f, -0.0191806760f,
+	-0.0193500165f, -0.0195090100f, -0.0196573455f, -0.0197947174f, -0.0199208166f, -0.0200353451f,
+	-0.0201380011f, -0.0202284902f, -0.0203065202f, -0.0203718059f, -0.0204240605f, -0.0204630066f,
+	-0.0204883721f, -0.0204998869f, -0.0204972886f, -0.0204803180f, -0.0204487275f, -0.0204022676f,
+	-0.0203407034f, -0.0202638041f, -0.0201713424f, -0.0200631060f, -0.0199388824f, -0.0197984725f,
+	-0.0196416844f, -0.0194683354f, -0.0192782488f, -0.0190712623f, -0.0188472178f, -0.0186059698f,
+	-0.0183473825f, -0.0180713311f, -0.0177777000f, -0.0174663849f, -0.0171372928f, -0.0167903416f,
+	-0.0164254624f, -0.0160425976f, -0.0156417005f, -0.0152227366f, -0.0147856846f, -0.0143305380f,
+	-0.0138572995f, -0.0133659868f, -0.0128566325f, -0.0123292813f, -0.0117839901f, -0.0112208333f,
+	-0.0106398966f, -0.0100412806f, -0.00942510180f, -0.00879148860f, -0.00814058725f, -0.00747255748f,
+	-0.00678757252f, -0.00608582282f, -0.00536751375f, -0.00463286461f, -0.00388211128f, -0.00311550498f,
+	-0.00233331206f, -0.00153581484f, -0.000723310746f, 0.000103886661f, 0.000945448468f, 0.00180102990f,
+	0.00267027086f, 0.00355279492f, 0.00444821129f, 0.00535611156f, 0.00627607433f, 0.00720766047f,
+	0.00815041736f, 0.00910387468f, 0.0100675495f, 0.0110409427f, 0.0120235402f, 0.0130148120f,
+	0.0140142152f, 0.0150211910f, 0.0160351675f, 0.0170555580f, 0.0180817619f, 0.0191131663f,
+	0.0201491397f, 0.0211890433f, 0.0222322233f, 0.0232780110f, 0.0243257303f, 0.0253746863f,
+	0.0264241770f, 0.0274734870f, 0.0285218917f, 0.0295686517f, 0.0306130201f, 0.0316542424f,
+	0.0326915458f, 0.0337241553f, 0.0347512886f, 0.0357721485f, 0.0367859304f, 0.0377918296f,
+	0.0387890227f, 0.0397766903f, 0.0407540016f, 0.0417201146f, 0.0426741987f, 0.0436153971f,
+	0.0445428677f, 0.0454557501f, 0.0463531911f, 0.0472343266f, 0.0480982997f, 0.0489442423f,
+	0.0497712903f, 0.0505785830f, 0.0513652563f, 0.0521304421f, 0.0528732762f, 0.0535929054f,
+	0.0542884693f, 0.0549591146f, 0.0556039885f, 0.0562222488f, 0.0568130538f, 0.0573755726f,
+	0.0579089709f, 0.0584124364f, 0.0588851497f, 0.0593263097f, 0.0597351268f, 0.0601108074f,
+	0.0604525842f, 0.0607596934f, 0.0610313863f, 0.0612669177f, 0.0614655726f, 0.0616266318f,
+	0.0617494062f, 0.0618332140f, 0.0618773885f, 0.0618812852f, 0.0618442707f, 0.0617657378f,
+	0.0616450869f, 0.0614817515f, 0.0612751767f, 0.0610248260f, 0.0607301928f, 0.0603907816f,
+	0.0600061342f, 0.0595757999f, 0.0590993650f, 0.0585764349f, 0.0580066368f, 0.0573896281f,
+	0.0567250960f, 0.0560127459f, 0.0552523136f, 0.0544435717f, 0.0535863116f, 0.0526803546f,
+	0.0517255552f, 0.0507217944f, 0.0496689938f, 0.0485670902f, 0.0474160649f, 0.0462159254f,
+	0.0449667163f, 0.0436685123f, 0.0423214175f, 0.0409255773f, 0.0394811668f, 0.0379883945f,
+	0.0364475101f, 0.0348587930f, 0.0332225598f, 0.0315391608f, 0.0298089813f, 0.0280324519f,
+	0.0262100305f, 0.0243422147f, 0.0224295370f, 0.0204725713f, 0.0184719246f, 0.0164282434f,
+	0.0143422121f, 0.0122145480f, 0.0100460127f, 0.00783739891f, 0.00558954244f, 0.00330331223f,
+	0.000979616772f, -0.00138059806f, -0.00377634983f, -0.00620661862f, -0.00867034681f, -0.0111664413f,
+	-0.0136937713f, -0.0162511691f, -0.0188374333f, -0.0214513224f, -0.0240915641f, -0.0267568473f,
+	-0.0294458251f, -0.0321571194f, -0.0348893180f, -0.0376409702f, -0.0404105969f, -0.0431966819f,
+	-0.0459976792f, -0.0488120131f, -0.0516380705f, -0.0544742160f, -0.0573187731f, -0.0601700470f,
+	-0.0630263016f, -0.0658857897f, -0.0687467158f, -0.0716072768f, -0.0744656250f, -0.0773199126f,
+	-0.0801682398f, -0.0830086991f, -0.0858393535f, -0.0886582509f, -0.0914634094f, -0.0942528322f,
+	-0.0970245004f, -0.0997763872f, -0.102506429f, -0.105212562f, -0.107892700f, -0.110544741f,
+	-0.113166578f, -0.115756072f, -0.118311100f, -0.120829508f, -0.123309143f, -0.125747845f,
+	-0.128143430f, -0.130493715f, -0.132796541f, -0.135049716f, -0.137251049f, -0.139398351f,
+	-0.141489431f, -0.143522099f, -0.145494193f, -0.147403508f, -0.149247870f, -0.151025131f,
+	-0.152733102f, -0.154369652f, -0.155932635f, -0.157419905f, -0.158829361f, -0.160158902f,
+	-0.161406428f, -0.162569866f, -0.163647160f, -0.164636284f, -0.165535226f, -0.166341975f,
+	-0.167054594f, -0.167671099f, -0.168189600f, -0.168608189f, -0.168925017f, -0.169138238f,
+	-0.169246048f, -0.169246674f, -0.169138372f, -0.168919459f, -0.168588266f, -0.168143138f,
+	-0.167582497f, -0.166904792f, -0.166108504f, -0.165192157f, -0.164154336f, -0.162993655f,
+	-0.161708772f, -0.160298392f, -0.158761263f, -0.157096207f, -0.155302063f, -0.153377727f,
+	-0.151322186f, -0.149134412f, -0.146813482f, -0.144358501f, -0.141768664f, -0.139043167f,
+	-0.136181310f, -0.133182436f, -0.130045936f, -0.126771286f, -0.123357996f, -0.119805641f,
+	-0.116113879f, -0.112282403f, -0.108310983f, -0.104199462f, -0.0999477282f, -0.0955557376f,
+	-0.0910235271f, -0.0863511786f, -0.0815388635f, -0.0765867978f, -0.0714952722f, -0.0662646517f,
+	-0.0608953610f, -0.0553878956f, -0.0497428179f, -0.0439607576f, -0.0380424187f, -0.0319885649f,
+	-0.0258000400f, -0.0194777437f, -0.0130226556f, -0.00643581664f, 0.000281659130f, 0.00712859118f,
+	0.0141037302f, 0.0212057568f, 0.0284332875f, 0.0357848667f, 0.0432589725f, 0.0508540161f,
+	0.0585683435f, 0.0664002299f, 0.0743478909f, 0.0824094787f, 0.0905830562f, 0.0988666639f,
+	0.107258238f, 0.115755670f, 0.124356791f, 0.133059368f, 0.141861111f, 0.150759652f,
+	0.159752592f, 0.168837443f, 0.178011671f, 0.187272698f, 0.196617872f, 0.206044510f,
+	0.215549842f, 0.225131065f, 0.234785333f, 0.244509742f, 0.254301310f, 0.264157057f,
+	0.274073929f, 0.284048796f, 0.294078559f, 0.304160029f, 0.314289957f, 0.324465066f,
+	0.334682107f, 0.344937682f, 0.355228454f, 0.365550965f, 0.375901818f, 0.386277497f,
+	0.396674514f, 0.407089323f, 0.417518377f, 0.427958071f, 0.438404799f, 0.448854923f,
+	0.459304810f, 0.469750762f, 0.480189115f, 0.490616143f, 0.501028180f, 0.511421382f,
+	0.521792173f, 0.532136679f, 0.542451203f, 0.552731991f, 0.562975228f, 0.573177218f,
+	0.583334208f, 0.593442380f, 0.603498042f, 0.613497376f, 0.623436749f, 0.633312345f,
+	0.643120468f, 0.652857482f, 0.662519634f, 0.672103226f, 0.681604743f, 0.691020370f,
+	0.700346649f, 0.709579945f, 0.718716741f, 0.727753460f, 0.736686647f, 0.745512784f,
+	0.754228473f, 0.762830317f, 0.771314979f, 0.779679060f, 0.787919402f, 0.796032667f,
+	0.804015756f, 0.811865389f, 0.819578588f, 0.827152193f, 0.834583282f, 0.841868818f,
+	0.849005997f, 0.855991960f, 0.862823844f, 0.869498968f, 0.876014650f, 0.882368267f,
+	0.888557315f, 0.894579232f, 0.900431693f, 0.906112194f, 0.911618531f, 0.916948497f,
+	0.922099948f, 0.927070677f, 0.931858778f, 0.936462343f, 0.940879345f, 0.945108116f,
+	0.949146926f, 0.952994108f, 0.956648052f, 0.960107386f, 0.963370562f, 0.966436327f,
+	0.969303370f, 0.971970618f, 0.974436879f, 0.976701200f, 0.978762627f, 0.980620325f,
+	0.982273519f, 0.983721554f, 0.984963834f, 0.985999882f, 0.986829221f, 0.987451494f,
+	0.987866521f, 0.988074064f, 0.988074064f, 0.987866521f, 0.987451494f, 0.986829221f,
+	0.985999882f, 0.984963834f, 0.983721554f, 0.982273519f, 0.980620325f, 0.978762627f,
+	0.976701200f, 0.974436879f, 0.971970618f, 0.969303370f, 0.966436327f, 0.963370562f,
+	0.960107386f, 0.956648052f, 0.952994108f, 0.949146926f, 0.945108116f, 0.940879345f,
+	0.936462343f, 0.931858778f, 0.927070677f, 0.922099948f, 0.916948497f, 0.911618531f,
+	0.906112194f, 0.900431693f, 0.894579232f, 0.888557315f, 0.882368267f, 0.876014650f,
+	0.869498968f, 0.862823844f, 0.855991960f, 0.849005997f, 0.841868818f, 0.834583282f,
+	0.827152193f, 0.819578588f, 0.811865389f, 0.804015756f, 0.796032667f, 0.787919402f,
+	0.779679060f, 0.771314979f, 0.762830317f, 0.754228473f, 0.745512784f, 0.736686647f,
+	0.727753460f, 0.718716741f, 0.709579945f, 0.700346649f, 0.691020370f, 0.681604743f,
+	0.672103226f, 0.662519634f, 0.652857482f, 0.643120468f, 0.633312345f, 0.623436749f,
+	0.613497376f, 0.603498042f, 0.593442380f, 0.583334208f, 0.573177218f, 0.562975228f,
+	0.552731991f, 0.542451203f, 0.532136679f, 0.521792173f, 0.511421382f, 0.501028180f,
+	0.490616143f, 0.480189115f, 0.469750762f, 0.459304810f, 0.448854923f, 0.438404799f,
+	0.427958071f, 0.417518377f, 0.407089323f, 0.396674514f, 0.386277497f, 0.375901818f,
+	0.365550965f, 0.355228454f, 0.344937682f, 0.334682107f, 0.324465066f, 0.314289957f,
+	0.304160029f, 0.294078559f, 0.284048796f, 0.274073929f, 0.264157057f, 0.254301310f,
+	0.244509742f, 0.234785333f, 0.225131065f, 0.215549842f, 0.206044510f, 0.196617872f,
+	0.187272698f, 0.178011671f, 0.168837443f, 0.159752592f, 0.150759652f, 0.141861111f,
+	0.133059368f, 0.124356791f, 0.115755670f, 0.107258238f, 0.0988666639f, 0.0905830562f,
+	0.0824094787f, 0.0743478909f, 0.0664002299f, 0.0585683435f, 0.0508540161f, 0.0432589725f,
+	0.0357848667f, 0.0284332875f, 0.0212057568f, 0.0141037302f, 0.00712859118f, 0.000281659130f,
+	-0.00643581664f, -0.0130226556f, -0.0194777437f, -0.0258000400f, -0.0319885649f, -0.0380424187f,
+	-0.0439607576f, -0.0497428179f, -0.0553878956f, -0.0608953610f, -0.0662646517f, -0.0714952722f,
+	-0.0765867978f, -0.0815388635f, -0.0863511786f, -0.0910235271f, -0.0955557376f, -0.0999477282f,
+	-0.104199462f, -0.108310983f, -0.112282403f, -0.116113879f, -0.119805641f, -0.123357996f,
+	-0.126771286f, -0.130045936f, -0.133182436f, -0.136181310f, -0.139043167f, -0.141768664f,
+	-0.144358501f, -0.146813482f, -0.149134412f, -0.151322186f, -0.153377727f, -0.155302063f,
+	-0.157096207f, -0.158761263f, -0.160298392f, -0.161708772f, -0.162993655f, -0.164154336f,
+	-0.165192157f, -0.166108504f, -0.166904792f, -0.167582497f, -0.168143138f, -0.168588266f,
+	-0.168919459f, -0.169138372f, -0.169246674f, -0.169246048f, -0.169138238f, -0.168925017f,
+	-0.168608189f, -0.168189600f, -0.167671099f, -0.167054594f, -0.166341975f, -0.165535226f,
+	-0.164636284f, -0.163647160f, -0.162569866f, -0.161406428f, -0.160158902f, -0.158829361f,
+	-0.157419905f, -0.155932635f, -0.154369652f, -0.152733102f, -0.151025131f, -0.149247870f,
+	-0.147403508f, -0.145494193f, -0.143522099f, -0.141489431f, -0.139398351f, -0.137251049f,
+	-0.135049716f, -0.132796541f, -0.130493715f, -0.128143430f, -0.125747845f, -0.123309143f,
+	-0.120829508f, -0.118311100f, -0.115756072f, -0.113166578f, -0.110544741f, -0.107892700f,
+	-0.105212562f, -0.102506429f, -0.0997763872f, -0.0970245004f, -0.0942528322f, -0.0914634094f,
+	-0.0886582509f, -0.0858393535f, -0.0830086991f, -0.0801682398f, -0.0773199126f, -0.0744656250f,
+	-0.0716072768f, -0.0687467158f, -0.0658857897f, -0.0630263016f, -0.0601700470f, -0.0573187731f,
+	-0.0544742160f, -0.0516380705f, -0.0488120131f, -0.0459976792f, -0.0431966819f, -0.0404105969f,
+	-0.0376409702f, -0.0348893180f, -0.0321571194f, -0.0294458251f, -0.0267568473f, -0.0240915641f,
+	-0.0214513224f, -0.0188374333f, -0.0162511691f, -0.0136937713f, -0.0111664413f, -0.00867034681f,
+	-0.00620661862f, -0.00377634983f, -0.00138059806f, 0.000979616772f, 0.00330331223f, 0.00558954244f,
+	0.00783739891f, 0.0100460127f, 0.0122145480f, 0.0143422121f, 0.0164282434f, 0.0184719246f,
+	0.0204725713f, 0.0224295370f, 0.0243422147f, 0.0262100305f, 0.0280324519f, 0.0298089813f,
+	0.0315391608f, 0.0332225598f, 0.0348587930f, 0.0364475101f, 0.0379883945f, 0.0394811668f,
+	0.0409255773f, 0.0423214175f, 0.0436685123f, 0.0449667163f, 0.0462159254f, 0.0474160649f,
+	0.0485670902f, 0.0496689938f, 0.0507217944f, 0.0517255552f, 0.0526803546f, 0.0535863116f,
+	0.0544435717f, 0.0552523136f, 0.0560127459f, 0.0567250960f, 0.0573896281f, 0.0580066368f,
+	0.0585764349f, 0.0590993650f, 0.0595757999f, 0.0600061342f, 0.0603907816f, 0.0607301928f,
+	0.0610248260f, 0.0612751767f, 0.0614817515f, 0.0616450869f, 0.0617657378f, 0.0618442707f,
+	0.0618812852f, 0.0618773885f, 0.0618332140f, 0.0617494062f, 0.0616266318f, 0.0614655726f,
+	0.0612669177f, 0.0610313863f, 0.0607596934f, 0.0604525842f, 0.0601108074f, 0.0597351268f,
+	0.0593263097f, 0.0588851497f, 0.0584124364f, 0.0579089709f, 0.0573755726f, 0.0568130538f,
+	0.0562222488f, 0.0556039885f, 0.0549591146f, 0.0542884693f, 0.0535929054f, 0.0528732762f,
+	0.0521304421f, 0.0513652563f, 0.0505785830f, 0.0497712903f, 0.0489442423f, 0.0480982997f,
+	0.0472343266f, 0.0463531911f, 0.0454557501f, 0.0445428677f, 0.0436153971f, 0.0426741987f,
+	0.0417201146f, 0.0407540016f, 0.0397766903f, 0.0387890227f, 0.0377918296f, 0.0367859304f,
+	0.0357721485f, 0.0347512886f, 0.0337241553f, 0.0326915458f, 0.0316542424f, 0.0306130201f,
+	0.0295686517f, 0.0285218917f, 0.0274734870f, 0.0264241770f, 0.0253746863f, 0.0243257303f,
+	0.0232780110f, 0.0222322233f, 0.0211890433f, 0.0201491397f, 0.0191131663f, 0.0180817619f,
+	0.0170555580f, 0.0160351675f, 0.0150211910f, 0.0140142152f, 0.0130148120f, 0.0120235402f,
+	0.0110409427f, 0.0100675495f, 0.00910387468f, 0.00815041736f, 0.00720766047f, 0.00627607433f,
+	0.00535611156f, 0.00444821129f, 0.00355279492f, 0.00267027086f, 0.00180102990f, 0.000945448468f,
+	0.000103886661f, -0.000723310746f, -0.00153581484f, -0.00233331206f, -0.00311550498f, -0.00388211128f,
+	-0.00463286461f, -0.00536751375f, -0.00608582282f, -0.00678757252f, -0.00747255748f, -0.00814058725f,
+	-0.00879148860f, -0.00942510180f, -0.0100412806f, -0.0106398966f, -0.0112208333f, -0.0117839901f,
+	-0.0123292813f, -0.0128566325f, -0.0133659868f, -0.0138572995f, -0.0143305380f, -0.0147856846f,
+	-0.0152227366f, -0.0156417005f, -0.0160425976f, -0.0164254624f, -0.0167903416f, -0.0171372928f,
+	-0.0174663849f, -0.0177777000f, -0.0180713311f, -0.0183473825f, -0.0186059698f, -0.0188472178f,
+	-0.0190712623f, -0.0192782488f, -0.0194683354f, -0.0196416844f, -0.0197984725f, -0.0199388824f,
+	-0.0200631060f, -0.0201713424f, -0.0202638041f, -0.0203407034f, -0.0204022676f, -0.0204487275f,
+	-0.0204803180f, -0.0204972886f, -0.0204998869f, -0.0204883721f, -0.0204630066f, -0.0204240605f,
+	-0.0203718059f, -0.0203065202f, -0.0202284902f, -0.0201380011f, -0.0200353451f, -0.0199208166f,
+	-0.0197947174f, -0.0196573455f, -0.0195090100f, -0.0193500165f, -0.0191806760f, -0.0190012977f,
+	-0.0188121982f, -0.0186136942f, -0.0184060987f, -0.0181897301f, -0.0179649107f, -0.0177319553f,
+	-0.0174911842f, -0.0172429178f, -0.0169874746f, -0.0167251732f, -0.0164563321f, -0.0161812659f,
+	-0.0159002934f, -0.0156137282f, -0.0153218824f, -0.0150250671f, -0.0147235934f, -0.0144177657f,
+	-0.0141078895f, -0.0137942676f, -0.0134771978f, -0.0131569766f, -0.0128338980f, -0.0125082508f,
+	-0.0121803218f, -0.0118503943f, -0.0115187466f, -0.0111856535f, -0.0108513869f, -0.0105162133f,
+	-0.0101803942f, -0.00984418951f, -0.00950785168f, -0.00917162932f, -0.00883576646f, -0.00850050338f,
+	-0.00816607382f, -0.00783270597f, -0.00750062475f, -0.00717004854f, -0.00684119109f, -0.00651426008f,
+	-0.00618945807f, -0.00586698251f, -0.00554702431f, -0.00522977021f, -0.00491539994f, -0.00460408814f,
+	-0.00429600384f, -0.00399131002f, -0.00369016477f, -0.00339271897f, -0.00309911883f, -0.00280950405f,
+	-0.00252400944f, -0.00224276283f, -0.00196588761f, -0.00169349997f, -0.00142571155f, -0.00116262771f,
+	-0.000904347980f, -0.000650966540f, -0.000402571663f, -0.000159246207f, 7.89326587e-05f, 0.000311893265f,
+	0.000539569417f, 0.000761900272f, 0.000978830503f, 0.00119030999f, 0.00139629387f, 0.00159674254f,
+	0.00179162133f, 0.00198090076f, 0.00216455641f, 0.00234256848f, 0.00251492229f, 0.00268160738f,
+	0.00284261885f, 0.00299795531f, 0.00314762071f, 0.00329162274f, 0.00342997373f, 0.00356269022f,
+	0.00368979247f, 0.00381130539f, 0.00392725738f, 0.00403768010f, 0.00414261036f, 0.00424208725f,
+	0.00433615409f, 0.00442485651f, 0.00450824527f, 0.00458637252f, 0.00465929508f, 0.00472707069f,
+	0.00478976220f, 0.00484743342f, 0.00490015186f, 0.00494798692f, 0.00499101123f, 0.00502929883f,
+	0.00506292656f, 0.00509197311f, 0.00511651905f, 0.00513664726f, 0.00515244156f, 0.00516398856f,
+	0.00517137581f, 0.00517469225f, 0.00517402869f, 0.00516947592f, 0.00516112754f, 0.00514907716f,
+	0.00513341976f, 0.00511425035f, 0.00509166624f, 0.00506576430f, 0.00503664184f, 0.00500439713f,
+	0.00496912887f, 0.00493093533f, 0.00488991570f, 0.00484616915f, 0.00479979487f, 0.00475089159f,
+	0.00469955802f, 0.00464589335f, 0.00458999583f, 0.00453196326f, 0.00447189296f, 0.00440988224f,
+	0.00434602750f, 0.00428042421f, 0.00421316782f, 0.00414435193f, 0.00407407014f, 0.00400241511f,
+	0.00392947765f, 0.00385534856f, 0.00378011703f, 0.00370387128f, 0.00362669793f, 0.00354868313f,
+	0.00346991117f, 0.00339046470f, 0.00331042591f, 0.00322987488f, 0.00314889033f, 0.00306754955f,
+	0.00298592844f, 0.00290410127f, 0.00282214046f, 0.00274011749f, 0.00265810126f, 0.00257615955f,
+	0.00249435869f, 0.00241276273f, 0.00233143452f, 0.00225043460f, 0.00216982258f, 0.00208965526f,
+	0.00200998853f, 0.00193087605f, 0.00185236987f, 0.00177452026f, 0.00169737556f, 0.00162098242f,
+	0.00154538557f, 0.00147062808f, 0.00139675115f, 0.00132379413f, 0.00125179486f, 0.00118078908f,
+	0.00111081090f, 0.00104189268f, 0.000974065159f, 0.000907357025f, 0.000841795583f, 0.000777406269f,
+	0.000714212889f, 0.000652237562f, 0.000591500779f, 0.000532021455f, 0.000473816879f, 0.000416902680f,
+	0.000361293030f, 0.000307000562f, 0.000254036393f, 0.000202410127f, 0.000152130000f, 0.000103202743f,
+	5.56337400e-05f, 9.42700444e-06f, -3.54147960e-05f, -7.88902908e-05f, -0.000120999386f, -0.000161743228f,
+	-0.000201124174f, -0.000239145753f, -0.000275812665f, -0.000311130687f, -0.000345106731f, -0.000377748656f,
+	-0.000409065455f, -0.000439067022f, -0.000467764214f, -0.000495168846f, -0.000521293492f, -0.000546151656f,
+	-0.000569757714f, -0.000592126686f, -0.000613274402f, -0.000633217394f, -0.000651972834f, -0.000669558591f,
+	-0.000685993058f, -0.000701295387f, -0.000715484959f, -0.000728581974f, -0.000740606920f, -0.000751580752f,
+	-0.000761524891f, -0.000770461163f, -0.000778411573f, -0.000785398704f, -0.000791445142f, -0.000796573993f,
+	-0.000800808368f, -0.000804171723f, -0.000806687691f, -0.000808379962f, -0.000809272402f, -0.000809388934f,
+	-0.000808753597f, -0.000807390374f, -0.000805323303f, -0.000802576542f, -0.000799174013f, -0.000795139698f,
+	-0.000790497521f, -0.000785271171f, -0.000779484340f, -0.000773160602f, -0.000766323239f, -0.000758995418f,
+	-0.000751200132f, -0.000742960139f, -0.000734297966f, -0.000725235906f, -0.000715795846f, -0.000705999613f,
+	-0.000695868628f, -0.000685424020f, -0.000674686453f, -0.000663676590f, -0.000652414339f, -0.000640919607f,
+	-0.000629211718f, -0.000617309706f, -0.000605232141f, -0.000592997356f, -0.000580623047f, -0.000568126736f,
+	-0.000555525417f, -0.000542835623f, -0.000530073477f, -0.000517254812f, -0.000504394819f, -0.000491508341f,
+	-0.000478609814f, -0.000465713179f, -0.000452831970f, -0.000439979223f, -0.000427167572f, -0.000414409122f,
+	-0.000401715661f, -0.000389098393f, -0.000376568147f, -0.000364135311f, -0.000351809809f, -0.000339601131f,
+	-0.000327518297f, -0.000315569923f, -0.000303764187f, -0.000292108860f, -0.000280611246f, -0.000269278273f,
+	-0.000258116401f, -0.000247131771f, -0.000236330015f, -0.000225716445f, -0.000215295964f, -0.000205073069f,
+	-0.000195051907f, -0.000185236233f, -0.000175629466f, -0.000166234633f, -0.000157054455f, -0.000148091276f,
+	-0.000139347147f, -0.000130823741f, -0.000122522470f, -0.000114444403f, -0.000106590327f, -9.89607288e-05f,
+	-9.15558267e-05f, -8.43755479e-05f, -7.74195723e-05f, -7.06873179e-05f, -6.41779625e-05f, -5.78904219e-05f,
+	-5.18234192e-05f, -4.59754337e-05f, -4.03447448e-05f, -3.49294205e-05f, -2.97273491e-05f, -2.47362241e-05f,
+	-1.99535698e-05f, -1.53767432e-05f, -1.10029414e-05f, -6.82921609e-06f, -2.85247620e-06f, 9.30500221e-07f,
+	4.52305903e-06f, 7.92866103e-06f, 1.11508753e-05f, 1.41933670e-05f, 1.70598942e-05f, 1.97543013e-05f,
+	2.22805011e-05f, 2.46424825e-05f, 2.68442873e-05f, 2.88900192e-05f, 3.07838200e-05f, 3.25298788e-05f,
+	3.41324121e-05f, 3.55956618e-05f, 3.69238951e-05f, 3.81213904e-05f, 3.91924295e-05f, 4.01413017e-05f,
+	4.09722925e-05f, 4.16896692e-05f, 4.22976955e-05f, 4.28006060e-05f, 4.32026172e-05f, 4.35079128e-05f,
+	4.37206400e-05f, 4.38449097e-05f, 4.38847928e-05f, 4.38443094e-05f, 4.37274321e-05f, 4.35380716e-05f,
+	4.32800916e-05f, 4.29572865e-05f, 4.25733924e-05f, 4.21320728e-05f, 4.16369294e-05f, 4.10914836e-05f,
+	4.04991843e-05f, 3.98634111e-05f, 3.91874564e-05f, 3.84745363e-05f, 3.77277829e-05f, 3.69502486e-05f,
+	3.61448911e-05f, 3.53145988e-05f, 3.44621549e-05f, 3.35902732e-05f, 3.27015623e-05f, 3.17985505e-05f,
+	3.08836752e-05f, 2.99592884e-05f, 2.90276457e-05f, 2.80909153e-05f, 2.71511781e-05f, 2.62104222e-05f,
+	2.52705486e-05f, 2.43333689e-05f, 2.34006111e-05f, 2.24739106e-05f, 2.15548207e-05f, 2.06448058e-05f,
+	1.97452482e-05f, 1.88574468e-05f, 1.79826184e-05f, 1.71218981e-05f, 1.62763463e-05f, 1.54469381e-05f,
+	1.46345783e-05f, 1.38400937e-05f, 1.30642384e-05f, 1.23076961e-05f, 1.15710800e-05f, 1.08549348e-05f,
+	1.01597388e-05f, 9.48590787e-06f, 8.83379289e-06f, 8.20368678e-06f
+};
+
+// 32000 -> 48000, quality 1
+static const FIRCoefficient KERNEL_3[] = {
+	5.74688102e-06f, 9.40860555e-05f, 0.000234719191f, -0.000192810941f, -0.00206281617f, -0.00425704895f,
+	-0.00174785336f, 0.0104008466f, 0.0262183715f, 0.0232597068f, -0.0207208041f, -0.0917773694f,
+	-0.119864307f, -0.0141468793f, 0.255259544f, 0.598543823f, 0.840757966f, 0.840757966f,
+	0.598543823f, 0.255259544f, -0.0141468793f, -0.119864307f, -0.0917773694f, -0.0207208041f,
+	0.0232597068f, 0.0262183715f, 0.0104008466f, -0.00174785336f, -0.00425704895f, -0.00206281617f,
+	-0.000192810941f, 0.000234719191f, 9.40860555e-05f, 5.74688102e-06f
+};
+
+// 32000 -> 48000, quality 2
+static const FIRCoefficient KERNEL_4[] = {
+	-5.10589871e-06f, -7.06146311e-05f, -0.000135142531f, 0.000256155501f, 0.00142571249f, 0.00199814886f,
+	-0.00119894138f, -0.00864078384f, -0.0122156013f, 0.00110234169f, 0.0309358258f, 0.0478132330f,
+	0.0102157565f, -0.0825180709f, -0.150544167f, -0.0699969232f, 0.216981485f, 0.613085628f,
+	0.901515663f, 0.901515663f, 0.613085628f, 0.216981485f, -0.0699969232f, -0.150544167f,
+	-0.0825180709f, 0.0102157565f, 0.0478132330f, 0.0309358258f, 0.00110234169f, -0.0122156013f,
+	-0.00864078384f, -0.00119894138f, 0.00199814886f, 0.00142571249f, 0.000256155501f, -0.000135142531f,
+	-7.06146311e-05f, -5.10589871e-06f
+};
+
+// 32000 -> 48000, quality 3
+static const FIRCoefficient KERNEL_5[] = {
+	5.84977715e-06f, 5.33897219e-05f, 5.17658773e-05f, -0.000303665554f, -0.000949189416f, -0.000612139178f,
+	0.00220119092f, 0.00568557624f, 0.00334956427f, -0.00893580634f, -0.0214693211f, -0.0124380346f,
+	0.0264468063f, 0.0625452772f, 0.0371812880f, -0.0666726008f, -0.165196240f, -0.108454458f,
+	0.186437845f, 0.619326413f, 0.941740930f, 0.941740930f, 0.619326413f, 0.186437845f,
+	-0.108454458f, -0.165196240f, -0.0666726008f, 0.0371812880f, 0.0625452772f, 0.0264468063f,
+	-0.0124380346f, -0.0214693211f, -0.00893580634f, 0.00334956427f, 0.00568557624f, 0.00220119092f,
+	-0.000612139178f, -0.000949189416f, -0.000303665554f, 5.17658773e-05f, 5.33897219e-05f, 5.84977715e-06f
+};
+
+// 48000 -> 44100, quality 1
+static const FIRCoefficient KERNEL_6[] = {
+	1.22133588e-05f, 1.44714586e-05f, 1.69718969e-05f, 1.97262161e-05f, 2.27456439e-05f, 2.60410197e-05f,
+	2.96227190e-05f, 3.35005680e-05f, 3.76837561e-05f, 4.21807672e-05f, 4.69992628e-05f, 5.21460097e-05f,
+	5.76267812e-05f, 6.34462485e-05f, 6.96079151e-05f, 7.61139672e-05f, 8.29652126e-05f, 9.01609674e-05f,
+	9.76989395e-05f, 0.000105575149f, 0.000113783812f, 0.000122317215f, 0.000131165652f, 0.000140317294f,
+	0.000149758125f, 0.000159471776f, 0.000169439503f, 0.000179640032f, 0.000190049512f, 0.000200641429f,
+	0.000211386461f, 0.000222252478f, 0.000233204410f, 0.000244204246f, 0.000255210849f, 0.000266180083f,
+	0.000277064566f, 0.000287813775f, 0.000298373954f, 0.000308688090f, 0.000318695878f, 0.000328333757f,
+	0.000337534904f, 0.000346229237f, 0.000354343414f, 0.000361800921f, 0.000368522102f, 0.000374424155f,
+	0.000379421341f, 0.000383424922f, 0.000386343308f, 0.000388082291f, 0.000388544955f, 0.000387631997f,
+	0.000385241787f, 0.000381270569f, 0.000375612610f, 0.000368160516f, 0.000358805264f, 0.000347436639f,
+	0.000333943259f, 0.000318213046f, 0.000300133397f, 0.000279591477f, 0.000256474479f, 0.000230670164f,
+	0.000202066905f, 0.000170554253f, 0.000136023213f, 9.83666687e-05f, 5.74797377e-05f, 1.32602145e-05f,
+	-3.43910251e-05f, -8.55695907e-05f, -0.000140367119f, -0.000198870825f, -0.000261163048f, -0.000327320740f,
+	-0.000397415017f, -0.000471510692f, -0.000549665652f, -0.000631930598f, -0.000718348136f, -0.000808952784f,
+	-0.000903769978f, -0.00100281590f, -0.00110609666f, -0.00121360819f, -0.00132533512f, -0.00144125114f,
+	-0.00156131759f, -0.00168548361f, -0.00181368529f, -0.00194584532f, -0.00208187266f, -0.00222166185f,
+	-0.00236509298f, -0.00251203054f, -0.00266232388f, -0.00281580607f, -0.00297229411f, -0.00313158846f,
+	-0.00329347234f, -0.00345771224f, -0.00362405693f, -0.00379223772f, -0.00396196730f, -0.00413294183f,
+	-0.00430483790f, -0.00447731419f, -0.00465001259f, -0.00482255453f, -0.00499454467f, -0.00516556948f,
+	-0.00533519685f, -0.00550297787f, -0.00566844456f, -0.00583111355f, -0.00599048333f, -0.00614603562f,
+	-0.00629723631f, -0.00644353684f, -0.00658437097f, -0.00671916083f, -0.00684731267f, -0.00696822023f,
+	-0.00708126510f, -0.00718581676f, -0.00728123495f, -0.00736686913f, -0.00744205946f, -0.00750613958f,
+	-0.00755843613f, -0.00759826973f, -0.00762495771f, -0.00763781415f, -0.00763615221f, -0.00761928363f,
+	-0.00758652296f, -0.00753718661f, -0.00747059565f, -0.00738607720f, -0.00728296582f, -0.00716060586f,
+	-0.00701835193f, -0.00685557211f, -0.00667164894f, -0.00646598171f, -0.00623798696f, -0.00598710310f,
+	-0.00571278995f, -0.00541453110f, -0.00509183761f, -0.00474424707f, -0.00437132828f, -0.00397268217f,
+	-0.00354794436f, -0.00309678563f, -0.00261891563f, -0.00211408478f, -0.00158208527f, -0.00102275400f,
+	-0.000435973896f, 0.000178323447f, 0.000820156420f, 0.00148949132f, 0.00218624016f, 0.00291025965f,
+	0.00366134848f, 0.00443924638f, 0.00524363201f, 0.00607412169f, 0.00693026744f, 0.00781155610f,
+	0.00871740747f, 0.00964717381f, 0.0106001366f, 0.0115755098f, 0.0125724319f, 0.0135899726f,
+	0.0146271279f, 0.0156828184f, 0.0167558920f, 0.0178451221f, 0.0189492051f, 0.0200667661f,
+	0.0211963505f, 0.0223364327f, 0.0234854091f, 0.0246416032f, 0.0258032642f, 0.0269685723f,
+	0.0281356275f, 0.0293024648f, 0.0304670483f, 0.0316272750f, 0.0327809677f, 0.0339258909f,
+	0.0350597426f, 0.0361801647f, 0.0372847356f, 0.0383709744f, 0.0394363478f, 0.0404782780f,
+	0.0414941274f, 0.0424812213f, 0.0434368439f, 0.0443582311f, 0.0452425964f, 0.0460871160f,
+	0.0468889363f, 0.0476451851f, 0.0483529717f, 0.0490093865f, 0.0496115163f, 0.0501564406f,
+	0.0506412387f, 0.0510629974f, 0.0514188074f, 0.0517057814f, 0.0519210547f, 0.0520617813f,
+	0.0521251559f, 0.0521084033f, 0.0520088039f, 0.0518236756f, 0.0515503995f, 0.0511864200f,
+	0.0507292412f, 0.0501764528f, 0.0495257191f, 0.0487747900f, 0.0479215160f, 0.0469638444f,
+	0.0458998233f, 0.0447276197f, 0.0434455164f, 0.0420519225f, 0.0405453853f, 0.0389245749f,
+	0.0371883214f, 0.0353355929f, 0.0333655179f, 0.0312773921f, 0.0290706661f, 0.0267449766f,
+	0.0243001338f, 0.0217361338f, 0.0190531574f, 0.0162515864f, 0.0133319981f, 0.0102951759f,
+	0.00714211073f, 0.00387400691f, 0.000492285064f, -0.00300141284f, -0.00660522096f, -0.0103170462f,
+	-0.0141345635f, -0.0180552173f, -0.0220762156f, -0.0261945259f, -0.0304068793f, -0.0347097665f,
+	-0.0390994325f, -0.0435718819f, -0.0481228791f, -0.0527479351f, -0.0574423335f, -0.0622010976f,
+	-0.0670190230f, -0.0718906596f, -0.0768103153f, -0.0817720741f, -0.0867697671f, -0.0917970240f,
+	-0.0968472138f, -0.101913512f, -0.106988847f, -0.112065956f, -0.117137365f, -0.122195370f,
+	-0.127232105f, -0.132239491f, -0.137209266f, -0.142132998f, -0.147002071f, -0.151807711f,
+	-0.156541005f, -0.161192849f, -0.165754080f, -0.170215324f, -0.174567133f, -0.178799942f,
+	-0.182904109f, -0.186869860f, -0.190687388f, -0.194346800f, -0.197838143f, -0.201151460f,
+	-0.204276711f, -0.207203880f, -0.209922954f, -0.212423891f, -0.214696690f, -0.216731399f,
+	-0.218518093f, -0.220046923f, -0.221308127f, -0.222292006f, -0.222988978f, -0.223389596f,
+	-0.223484531f, -0.223264590f, -0.222720772f, -0.221844211f, -0.220626265f, -0.219058484f,
+	-0.217132643f, -0.214840740f, -0.212175012f, -0.209127977f, -0.205692410f, -0.201861396f,
+	-0.197628275f, -0.192986742f, -0.187930807f, -0.182454824f, -0.176553488f, -0.170221865f,
+	-0.163455382f, -0.156249881f, -0.148601562f, -0.140507087f, -0.131963477f, -0.122968234f,
+	-0.113519266f, -0.103614934f, -0.0932540521f, -0.0824359134f, -0.0711602643f, -0.0594273396f,
+	-0.0472378507f, -0.0345929973f, -0.0214944873f, -0.00794451777f, 0.00605421001f, 0.0204984844f,
+	0.0353845805f, 0.0507082716f, 0.0664648041f, 0.0826489180f, 0.0992548317f, 0.116276257f,
+	0.133706376f, 0.151537880f, 0.169762954f, 0.188373223f, 0.207359895f, 0.226713598f,
+	0.246424511f, 0.266482323f, 0.286876231f, 0.307594955f, 0.328626782f, 0.349959493f,
+	0.371580422f, 0.393476546f, 0.415634304f, 0.438039809f, 0.460678697f, 0.483536273f,
+	0.506597400f, 0.529846609f, 0.553268075f, 0.576845706f, 0.600562930f, 0.624402940f,
+	0.648348808f, 0.672383010f, 0.696488082f, 0.720646024f, 0.744838953f, 0.769048452f,
+	0.793256104f, 0.817443311f, 0.841591299f, 0.865681171f, 0.889694035f, 0.913610697f,
+	0.937412083f, 0.961079001f, 0.984592259f, 1.00793266f, 1.03108096f, 1.05401814f,
+	1.07672501f, 1.09918272f, 1.12137234f, 1.14327502f, 1.16487229f, 1.18614566f,
+	1.20707691f, 1.22764802f, 1.24784112f, 1.26763892f, 1.28702390f, 1.30597925f,
+	1.32448816f, 1.34253454f, 1.36010230f, 1.37717593f, 1.39374030f, 1.40978038f,
+	1.42528200f, 1.44023132f, 1.45461476f, 1.46841943f, 1.48163283f, 1.49424291f,
+	1.50623846f, 1.51760840f, 1.52834237f, 1.53843069f, 1.54786408f, 1.55663383f,
+	1.56473207f, 1.57215130f, 1.57888472f, 1.58492601f, 1.59026980f, 1.59491110f,
+	1.59884560f, 1.60206974f, 1.60458040f, 1.60637546f, 1.60745311f, 1.60781252f,
+	1.60745311f, 1.60637546f, 1.60458040f, 1.60206974f, 1.59884560f, 1.59491110f,
+	1.59026980f, 1.58492601f, 1.57888472f, 1.57215130f, 1.56473207f, 1.55663383f,
+	1.54786408f, 1.53843069f, 1.52834237f, 1.51760840f, 1.50623846f, 1.49424291f,
+	1.48163283f, 1.46841943f, 1.45461476f, 1.44023132f, 1.42528200f, 1.40978038f,
+	1.39374030f, 1.37717593f, 1.36010230f, 1.34253454f, 1.32448816f, 1.30597925f,
+	1.28702390f, 1.26763892f, 1.24784112f, 1.22764802f, 1.20707691f, 1.18614566f,
+	1.16487229f, 1.14327502f, 1.12137234f, 1.09918272f, 1.07672501f, 1.05401814f,
+	1.03108096f, 1.00793266f, 0.984592259f, 0.961079001f, 0.937412083f, 0.913610697f,
+	0.889694035f, 0.865681171f, 0.841591299f, 0.817443311f, 0.793256104f, 0.769048452f,
+	0.744838953f, 0.720646024f, 0.696488082f, 0.672383010f, 0.648348808f, 0.624402940f,
+	0.600562930f, 0.576845706f, 0.553268075f, 0.529846609f, 0.506597400f, 0.483536273f,
+	0.460678697f, 0.438039809f, 0.415634304f, 0.393476546f, 0.371580422f, 0.349959493f,
+	0.328626782f, 0.307594955f, 0.286876231f, 0.266482323f, 0.246424511f, 0.226713598f,
+	0.207359895f, 0.188373223f, 0.169762954f, 0.151537880f, 0.133706376f, 0.116276257f,
+	0.0992548317f, 0.0826489180f, 0.0664648041f, 0.0507082716f, 0.0353845805f, 0.0204984844f,
+	0.00605421001f, -0.00794451777f, -0.0214944873f, -0.0345929973f, -0.0472378507f, -0.0594273396f,
+	-0.0711602643f, -0.0824359134f, -0.0932540521f, -0.103614934f, -0.113519266f, -0.122968234f,
+	-0.131963477f, -0.140507087f, -0.148601562f, -0.156249881f, -0.163455382f, -0.170221865f,
+	-0.176553488f, -0.182454824f, -0.187930807f, -0.192986742f, -0.197628275f, -0.201861396f,
+	-0.205692410f, -0.209127977f, -0.212175012f, -0.214840740f, -0.217132643f, -0.219058484f,
+	-0.220626265f, -0.221844211f, -0.222720772f, -0.223264590f, -0.223484531f, -0.223389596f,
+	-0.222988978f, -0.222292006f, -0.221308127f, -0.220046923f, -0.218518093f, -0.216731399f,
+	-0.214696690f, -0.212423891f, -0.209922954f, -0.207203880f, -0.204276711f, -0.201151460f,
+	-0.197838143f, -0.194346800f, -0.190687388f, -0.186869860f, -0.182904109f, -0.178799942f,
+	-0.174567133f, -0.170215324f, -0.165754080f, -0.161192849f, -0.156541005f, -0.151807711f,
+	-0.147002071f, -0.142132998f, -0.137209266f, -0.132239491f, -0.127232105f, -0.122195370f,
+	-0.117137365f, -0.112065956f, -0.106988847f, -0.101913512f, -0.0968472138f, -0.0917970240f,
+	-0.0867697671f, -0.0817720741f, -0.0768103153f, -0.0718906596f, -0.0670190230f, -0.0622010976f,
+	-0.0574423335f, -0.0527479351f, -0.0481228791f, -0.0435718819f, -0.0390994325f, -0.0347097665f,
+	-0.0304068793f, -0.0261945259f, -0.0220762156f, -0.0180552173f, -0.0141345635f, -0.0103170462f,
+	-0.00660522096f, -0.00300141284f, 0.000492285064f, 0.00387400691f, 0.00714211073f, 0.0102951759f,
+	0.0133319981f, 0.0162515864f, 0.0190531574f, 0.0217361338f, 0.0243001338f, 0.0267449766f,
+	0.0290706661f, 0.0312773921f, 0.0333655179f, 0.0353355929f, 0.0371883214f, 0.0389245749f,
+	0.0405453853f, 0.0420519225f, 0.0434455164f, 0.0447276197f, 0.0458998233f, 0.0469638444f,
+	0.0479215160f, 0.0487747900f, 0.0495257191f, 0.0501764528f, 0.0507292412f, 0.0511864200f,
+	0.0515503995f, 0.0518236756f, 0.0520088039f, 0.0521084033f, 0.0521251559f, 0.0520617813f,
+	0.0519210547f, 0.0517057814f, 0.0514188074f, 0.0510629974f, 0.0506412387f, 0.0501564406f,
+	0.0496115163f, 0.0490093865f, 0.0483529717f, 0.0476451851f, 0.0468889363f, 0.0460871160f,
+	0.0452425964f, 0.0443582311f, 0.0434368439f, 0.0424812213f, 0.0414941274f, 0.0404782780f,
+	0.0394363478f, 0.0383709744f, 0.0372847356f, 0.0361801647f, 0.0350597426f, 0.0339258909f,
+	0.0327809677f, 0.0316272750f, 0.0304670483f, 0.0293024648f, 0.0281356275f, 0.0269685723f,
+	0.0258032642f, 0.0246416032f, 0.0234854091f, 0.0223364327f, 0.0211963505f, 0.0200667661f,
+	0.0189492051f, 0.0178451221f, 0.0167558920f, 0.0156828184f, 0.0146271279f, 0.0135899726f,
+	0.0125724319f, 0.0115755098f, 0.0106001366f, 0.00964717381f, 0.00871740747f, 0.00781155610f,
+	0.00693026744f, 0.00607412169f, 0.00524363201f, 0.00443924638f, 0.00366134848f, 0.00291025965f,
+	0.00218624016f, 0.00148949132f, 0.000820156420f, 0.000178323447f, -0.000435973896f, -0.00102275400f,
+	-0.00158208527f, -0.00211408478f, -0.00261891563f, -0.00309678563f, -0.00354794436f, -0.00397268217f,
+	-0.00437132828f, -0.00474424707f, -0.00509183761f, -0.00541453110f, -0.00571278995f, -0.00598710310f,
+	-0.00623798696f, -0.00646598171f, -0.00667164894f, -0.00685557211f, -0.00701835193f, -0.00716060586f,
+	-0.00728296582f, -0.00738607720f, -0.00747059565f, -0.00753718661f, -0.00758652296f, -0.00761928363f,
+	-0.00763615221f, -0.00763781415f, -0.00762495771f, -0.00759826973f, -0.00755843613f, -0.00750613958f,
+	-0.00744205946f, -0.00736686913f, -0.00728123495f, -0.00718581676f, -0.00708126510f, -0.00696822023f,
+	-0.00684731267f, -0.00671916083f, -0.00658437097f, -0.00644353684f, -0.00629723631f, -0.00614603562f,
+	-0.00599048333f, -0.00583111355f, -0.00566844456f, -0.00550297787f, -0.00533519685f, -0.00516556948f,
+	-0.00499454467f, -0.00482255453f, -0.00465001259f, -0.00447731419f, -0.00430483790f, -0.00413294183f,
+	-0.00396196730f, -0.00379223772f, -0.00362405693f, -0.00345771224f, -0.00329347234f, -0.00313158846f,
+	-0.00297229411f, -0.00281580607f, -0.00266232388f, -0.00251203054f, -0.00236509298f, -0.00222166185f,
+	-0.00208187266f, -0.00194584532f, -0.00181368529f, -0.00168548361f, -0.00156131759f, -0.00144125114f,
+	-0.00132533512f, -0.00121360819f, -0.00110609666f, -0.00100281590f, -0.000903769978f, -0.000808952784f,
+	-0.000718348136f, -0.000631930598f, -0.000549665652f, -0.000471510692f, -0.000397415017f, -0.000327320740f,
+	-0.000261163048f, -0.000198870825f, -0.000140367119f, -8.55695907e-05f, -3.43910251e-05f, 1.32602145e-05f,
+	5.74797377e-05f, 9.83666687e-05f, 0.000136023213f, 0.000170554253f, 0.000202066905f, 0.000230670164f,
+	0.000256474479f, 0.000279591477f, 0.000300133397f, 0.000318213046f, 0.000333943259f, 0.000347436639f,
+	0.000358805264f, 0.000368160516f, 0.000375612610f, 0.000381270569f, 0.000385241787f, 0.000387631997f,
+	0.000388544955f, 0.000388082291f, 0.000386343308f, 0.000383424922f, 0.000379421341f, 0.000374424155f,
+	0.000368522102f, 0.000361800921f, 0.000354343414f, 0.000346229237f, 0.000337534904f, 0.000328333757f,
+	0.000318695878f, 0.000308688090f, 0.000298373954f, 0.000287813775f, 0.000277064566f, 0.000266180083f,
+	0.000255210849f, 0.000244204246f, 0.000233204410f, 0.000222252478f, 0.000211386461f, 0.000200641429f,
+	0.000190049512f, 0.000179640032f, 0.000169439503f, 0.000159471776f, 0.000149758125f, 0.000140317294f,
+	0.000131165652f, 0.000122317215f, 0.000113783812f, 0.000105575149f, 9.76989395e-05f, 9.01609674e-05f,
+	8.29652126e-05f, 7.61139672e-05f, 6.96079151e-05f, 6.34462485e-05f, 5.76267812e-05f, 5.21460097e-05f,
+	4.69992628e-05f, 4.21807672e-05f, 3.76837561e-05f, 3.35005680e-05f, 2.96227190e-05f, 2.60410197e-05f,
+	2.27456439e-05f, 1.97262161e-05f, 1.69718969e-05f, 1.44714586e-05f, 1.22133588e-05f
+};
+
+// 48000 -> 44100, quality 2
+static const FIRCoefficient KERNEL_7[] = {
+	-1.11238332e-05f, -1.30211765e-05f, -1.51039048e-05f, -1.73785666e-05f, -1.98512407e-05f, -2.25274816e-05f,
+	-2.54122479e-05f, -2.85098449e-05f, -3.18238563e-05f, -3.53570758e-05f, -3.91114372e-05f, -4.30879663e-05f,
+	-4.72866777e-05f, -5.17065382e-05f, -5.63453832e-05f, -6.11998403e-05f, -6.62652965e-05f, -7.15357746e-05f,
+	-7.70039260e-05f, -8.26609248e-05f, -8.84964320e-05f, -9.44985295e-05f, -0.000100653633f, -0.000106946485f,
+	-0.000113360060f, -0.000119875564f, -0.000126472325f, -0.000133127804f, -0.000139817537f, -0.000146515129f,
+	-0.000153192159f, -0.000159818257f, -0.000166361002f, -0.000172785964f, -0.000179056675f, -0.000185134646f,
+	-0.000190979379f, -0.000196548383f, -0.000201797186f, -0.000206679382f, -0.000211146675f, -0.000215148946f,
+	-0.000218634261f, -0.000221548995f, -0.000223837866f, -0.000225444062f, -0.000226309319f, -0.000226374003f,
+	-0.000225577285f, -0.000223857205f, -0.000221150854f, -0.000217394496f, -0.000212523708f, -0.000206473604f,
+	-0.000199178976f, -0.000190574458f, -0.000180594754f, -0.000169174848f, -0.000156250186f, -0.000141756958f,
+	-0.000125632243f, -0.000107814354f, -8.82430177e-05f, -6.68596549e-05f, -4.36076662e-05f, -1.84326655e-05f,
+	8.71719931e-06f, 3.78909826e-05f, 6.91346359e-05f, 0.000102490718f, 0.000137998082f, 0.000175691588f,
+	0.000215601773f, 0.000257754553f, 0.000302170869f, 0.000348866481f, 0.000397851516f, 0.000449130224f,
+	0.000502700685f, 0.000558554544f, 0.000616676407f, 0.000677044096f, 0.000739627751f, 0.000804389943f,
+	0.000871285331f, 0.000940260303f, 0.00101125264f, 0.00108419149f, 0.00115899695f, 0.00123558007f,
+	0.00131384225f, 0.00139367545f, 0.00147496175f, 0.00155757333f, 0.00164137245f, 0.00172621093f,
+	0.00181193044f, 0.00189836218f, 0.00198532711f, 0.00207263557f, 0.00216008746f, 0.00224747276f,
+	0.00233457051f, 0.00242114952f, 0.00250696880f, 0.00259177736f, 0.00267531397f, 0.00275730831f,
+	0.00283748028f, 0.00291554094f, 0.00299119251f, 0.00306412857f, 0.00313403504f, 0.00320058991f,
+	0.00326346443f, 0.00332232239f, 0.00337682222f, 0.00342661608f, 0.00347135193f, 0.00351067237f,
+	0.00354421721f, 0.00357162254f, 0.00359252305f, 0.00360655109f, 0.00361333881f, 0.00361251854f,
+	0.00360372360f, 0.00358658936f, 0.00356075400f, 0.00352585968f, 0.00348155340f, 0.00342748803f,
+	0.00336332340f, 0.00328872749f, 0.00320337713f, 0.00310696010f, 0.00299917441f, 0.00287973159f,
+	0.00274835643f, 0.00260478887f, 0.00244878442f, 0.00228011655f, 0.00209857617f, 0.00190397492f,
+	0.00169614458f, 0.00147493929f, 0.00124023634f, 0.000991937472f, 0.000729969877f, 0.000454287656f,
+	0.000164872748f, -0.000138264018f, -0.000455081667f, -0.000785508135f, -0.00112943910f, -0.00148673740f,
+	-0.00185723125f, -0.00224071438f, -0.00263694441f, -0.00304564228f, -0.00346649159f, -0.00389913749f,
+	-0.00434318697f, -0.00479820650f, -0.00526372390f, -0.00573922601f, -0.00622415869f, -0.00671792729f,
+	-0.00721989572f, -0.00772938645f, -0.00824568048f, -0.00876801834f, -0.00929559581f, -0.00982757285f,
+	-0.0103630647f, -0.0109011475f, -0.0114408573f, -0.0119811920f, -0.0125211086f, -0.0130595285f,
+	-0.0135953361f, -0.0141273793f, -0.0146544715f, -0.0151753929f, -0.0156888906f, -0.0161936842f,
+	-0.0166884605f, -0.0171718840f, -0.0176425856f, -0.0180991832f, -0.0185402650f, -0.0189644024f,
+	-0.0193701498f, -0.0197560489f, -0.0201206263f, -0.0204623975f, -0.0207798779f, -0.0210715700f,
+	-0.0213359781f, -0.0215716120f, -0.0217769817f, -0.0219506025f, -0.0220910087f, -0.0221967399f,
+	-0.0222663563f, -0.0222984441f, -0.0222916044f, -0.0222444739f, -0.0221557170f, -0.0220240336f,
+	-0.0218481645f, -0.0216268878f, -0.0213590339f, -0.0210434794f, -0.0206791554f, -0.0202650484f,
+	-0.0198002104f, -0.0192837529f, -0.0187148619f, -0.0180927906f, -0.0174168702f, -0.0166865103f,
+	-0.0159012061f, -0.0150605394f, -0.0141641777f, -0.0132118864f, -0.0122035258f, -0.0111390566f,
+	-0.0100185424f, -0.00884215254f, -0.00761016505f, -0.00632297061f, -0.00498107262f, -0.00358509202f,
+	-0.00213576807f, -0.000633961230f, 0.000919344951f, 0.00252304249f, 0.00417589722f, 0.00587654673f,
+	0.00762350066f, 0.00941513758f, 0.0112497080f, 0.0131253274f, 0.0150399823f, 0.0169915296f,
+	0.0189776905f, 0.0209960584f, 0.0230440982f, 0.0251191407f, 0.0272183921f, 0.0293389298f,
+	0.0314777121f, 0.0336315706f, 0.0357972123f, 0.0379712321f, 0.0401501134f, 0.0423302203f,
+	0.0445078127f, 0.0466790423f, 0.0488399677f, 0.0509865470f, 0.0531146452f, 0.0552200414f,
+	0.0572984368f, 0.0593454577f, 0.0613566488f, 0.0633275062f, 0.0652534589f, 0.0671298802f,
+	0.0689521208f, 0.0707154647f, 0.0724151805f, 0.0740465149f, 0.0756046996f, 0.0770849511f,
+	0.0784825012f, 0.0797925889f, 0.0810104460f, 0.0821313709f, 0.0831506625f, 0.0840636939f,
+	0.0848658681f, 0.0855526626f, 0.0861196369f, 0.0865624174f, 0.0868767202f, 0.0870583802f,
+	0.0871033370f, 0.0870076492f, 0.0867674947f, 0.0863792151f, 0.0858392939f, 0.0851443633f,
+	0.0842912421f, 0.0832769275f, 0.0820985958f, 0.0807536319f, 0.0792396218f, 0.0775543824f,
+	0.0756959394f, 0.0736625642f, 0.0714527741f, 0.0690653399f, 0.0664992929f, 0.0637539253f,
+	0.0608288273f, 0.0577238463f, 0.0544391461f, 0.0509751774f, 0.0473326929f, 0.0435127728f,
+	0.0395167992f, 0.0353464819f, 0.0310038626f, 0.0264913123f, 0.0218115393f, 0.0169675946f,
+	0.0119628673f, 0.00680110138f, 0.00148638315f, -0.00397684658f, -0.00958379637f, -0.0153293218f,
+	-0.0212079249f, -0.0272137560f, -0.0333406106f, -0.0395819396f, -0.0459308363f, -0.0523800589f,
+	-0.0589220189f, -0.0655487850f, -0.0722520873f, -0.0790233463f, -0.0858536363f, -0.0927337334f,
+	-0.0996540785f, -0.106604837f, -0.113575853f, -0.120556697f, -0.127536669f, -0.134504780f,
+	-0.141449794f, -0.148360237f, -0.155224383f, -0.162030280f, -0.168765798f, -0.175418571f,
+	-0.181976065f, -0.188425571f, -0.194754228f, -0.200949028f, -0.206996843f, -0.212884441f,
+	-0.218598470f, -0.224125549f, -0.229452208f, -0.234564915f, -0.239450157f, -0.244094387f,
+	-0.248484075f, -0.252605736f, -0.256445915f, -0.259991258f, -0.263228476f, -0.266144365f,
+	-0.268725902f, -0.270960182f, -0.272834480f, -0.274336249f, -0.275453120f, -0.276173025f,
+	-0.276484072f, -0.276374698f, -0.275833577f, -0.274849713f, -0.273412406f, -0.271511376f,
+	-0.269136608f, -0.266278535f, -0.262927979f, -0.259076208f, -0.254714847f, -0.249836028f,
+	-0.244432375f, -0.238496974f, -0.232023403f, -0.225005776f, -0.217438743f, -0.209317505f,
+	-0.200637802f, -0.191395983f, -0.181588948f, -0.171214238f, -0.160269961f, -0.148754895f,
+	-0.136668429f, -0.124010563f, -0.110781997f, -0.0969840512f, -0.0826187134f, -0.0676886663f,
+	-0.0521972291f, -0.0361484252f, -0.0195469484f, -0.00239817658f, 0.0152918287f, 0.0335163213f,
+	0.0522678643f, 0.0715383515f, 0.0913189799f, 0.111600280f, 0.132372111f, 0.153623655f,
+	0.175343439f, 0.197519347f, 0.220138580f, 0.243187740f, 0.266652793f, 0.290519089f,
+	0.314771324f, 0.339393705f, 0.364369780f, 0.389682531f, 0.415314436f, 0.441247404f,
+	0.467462867f, 0.493941724f, 0.520664394f, 0.547610879f, 0.574760735f, 0.602092981f,
+	0.629586458f, 0.657219410f, 0.684969902f, 0.712815523f, 0.740733743f, 0.768701553f,
+	0.796695888f, 0.824693203f, 0.852670014f, 0.880602539f, 0.908466756f, 0.936238766f,
+	0.963894367f, 0.991409361f, 1.01875949f, 1.04592049f, 1.07286823f, 1.09957850f,
+	1.12602723f, 1.15219033f, 1.17804408f, 1.20356464f, 1.22872853f, 1.25351262f,
+	1.27789378f, 1.30184925f, 1.32535672f, 1.34839392f, 1.37093914f, 1.39297104f,
+	1.41446877f, 1.43541169f, 1.45577979f, 1.47555363f, 1.49471402f, 1.51324260f,
+	1.53112137f, 1.54833293f, 1.56486070f, 1.58068860f, 1.59580100f, 1.61018324f,
+	1.62382114f, 1.63670135f, 1.64881134f, 1.66013885f, 1.67067301f, 1.68040335f,
+	1.68932021f, 1.69741464f, 1.70467889f, 1.71110559f, 1.71668828f, 1.72142160f,
+	1.72530067f, 1.72832179f, 1.73048186f, 1.73177886f, 1.73221123f, 1.73177886f,
+	1.73048186f, 1.72832179f, 1.72530067f, 1.72142160f, 1.71668828f, 1.71110559f,
+	1.70467889f, 1.69741464f, 1.68932021f, 1.68040335f, 1.67067301f, 1.66013885f,
+	1.64881134f, 1.63670135f, 1.62382114f, 1.61018324f, 1.59580100f, 1.58068860f,
+	1.56486070f, 1.54833293f, 1.53112137f, 1.51324260f, 1.49471402f, 1.47555363f,
+	1.45577979f, 1.43541169f, 1.41446877f, 1.39297104f, 1.37093914f, 1.34839392f,
+	1.32535672f, 1.30184925f, 1.27789378f, 1.25351262f, 1.22872853f, 1.20356464f,
+	1.17804408f, 1.15219033f, 1.12602723f, 1.09957850f, 1.07286823f, 1.04592049f,
+	1.01875949f, 0.991409361f, 0.963894367f, 0.936238766f, 0.908466756f, 0.880602539f,
+	0.852670014f, 0.824693203f, 0.796695888f, 0.768701553f, 0.740733743f, 0.712815523f,
+	0.684969902f, 0.657219410f, 0.629586458f, 0.602092981f, 0.574760735f, 0.547610879f,
+	0.520664394f, 0.493941724f, 0.467462867f, 0.441247404f, 0.415314436f, 0.389682531f,
+	0.364369780f, 0.339393705f, 0.314771324f, 0.290519089f, 0.266652793f, 0.243187740f,
+	0.220138580f, 0.197519347f, 0.175343439f, 0.153623655f, 0.132372111f, 0.111600280f,
+	0.0913189799f, 0.0715383515f, 0.0522678643f, 0.0335163213f, 0.0152918287f, -0.00239817658f,
+	-0.0195469484f, -0.0361484252f, -0.0521972291f, -0.0676886663f, -0.0826187134f, -0.0969840512f,
+	-0.110781997f, -0.124010563f, -0.136668429f, -0.148754895f, -0.160269961f, -0.171214238f,
+	-0.181588948f, -0.191395983f, -0.200637802f, -0.209317505f, -0.217438743f, -0.225005776f,
+	-0.232023403f, -0.238496974f, -0.244432375f, -0.249836028f, -0.254714847f, -0.259076208f,
+	-0.262927979f, -0.266278535f, -0.269136608f, -0.271511376f, -0.273412406f, -0.274849713f,
+	-0.275833577f, -0.276374698f, -0.276484072f, -0.276173025f, -0.275453120f, -0.274336249f,
+	-0.272834480f, -0.270960182f, -0.268725902f, -0.266144365f, -0.263228476f, -0.259991258f,
+	-0.256445915f, -0.252605736f, -0.248484075f, -0.244094387f, -0.239450157f, -0.234564915f,
+	-0.229452208f, -0.224125549f, -0.218598470f, -0.212884441f, -0.206996843f, -0.200949028f,
+	-0.194754228f, -0.188425571f, -0.181976065f, -0.175418571f, -0.168765798f, -0.162030280f,
+	-0.155224383f, -0.148360237f, -0.141449794f, -0.134504780f, -0.127536669f, -0.120556697f,
+	-0.113575853f, -0.106604837f, -0.0996540785f, -0.0927337334f, -0.0858536363f, -0.0790233463f,
+	-0.0722520873f, -0.0655487850f, -0.0589220189f, -0.0523800589f, -0.0459308363f, -0.0395819396f,
+	-0.0333406106f, -0.0272137560f, -0.0212079249f, -0.0153293218f, -0.00958379637f, -0.00397684658f,
+	0.00148638315f, 0.00680110138f, 0.0119628673f, 0.0169675946f, 0.0218115393f, 0.0264913123f,
+	0.0310038626f, 0.0353464819f, 0.0395167992f, 0.0435127728f, 0.0473326929f, 0.0509751774f,
+	0.0544391461f, 0.0577238463f, 0.0608288273f, 0.0637539253f, 0.0664992929f, 0.0690653399f,
+	0.0714527741f, 0.0736625642f, 0.0756959394f, 0.0775543824f, 0.0792396218f, 0.0807536319f,
+	0.0820985958f, 0.0832769275f, 0.0842912421f, 0.0851443633f, 0.0858392939f, 0.0863792151f,
+	0.0867674947f, 0.0870076492f, 0.0871033370f, 0.0870583802f, 0.0868767202f, 0.0865624174f,
+	0.0861196369f, 0.0855526626f, 0.0848658681f, 0.0840636939f, 0.0831506625f, 0.0821313709f,
+	0.0810104460f, 0.0797925889f, 0.0784825012f, 0.0770849511f, 0.0756046996f, 0.0740465149f,
+	0.0724151805f, 0.0707154647f, 0.0689521208f, 0.0671298802f, 0.0652534589f, 0.0633275062f,
+	0.0613566488f, 0.0593454577f, 0.0572984368f, 0.0552200414f, 0.0531146452f, 0.0509865470f,
+	0.0488399677f, 0.0466790423f, 0.0445078127f, 0.0423302203f, 0.0401501134f, 0.0379712321f,
+	0.0357972123f, 0.0336315706f, 0.0314777121f, 0.0293389298f, 0.0272183921f, 0.0251191407f,
+	0.0230440982f, 0.0209960584f, 0.0189776905f, 0.0169915296f, 0.0150399823f, 0.0131253274f,
+	0.0112497080f, 0.00941513758f, 0.00762350066f, 0.00587654673f, 0.00417589722f, 0.00252304249f,
+	0.000919344951f, -0.000633961230f, -0.00213576807f, -0.00358509202f, -0.00498107262f, -0.00632297061f,
+	-0.00761016505f, -0.00884215254f, -0.0100185424f, -0.0111390566f, -0.0122035258f, -0.0132118864f,
+	-0.0141641777f, -0.0150605394f, -0.0159012061f, -0.0166865103f, -0.0174168702f, -0.0180927906f,
+	-0.0187148619f, -0.0192837529f, -0.0198002104f, -0.0202650484f, -0.0206791554f, -0.0210434794f,
+	-0.0213590339f, -0.0216268878f, -0.0218481645f, -0.0220240336f, -0.0221557170f, -0.0222444739f,
+	-0.0222916044f, -0.0222984441f, -0.0222663563f, -0.0221967399f, -0.0220910087f, -0.0219506025f,
+	-0.0217769817f, -0.0215716120f, -0.0213359781f, -0.0210715700f, -0.0207798779f, -0.0204623975f,
+	-0.0201206263f, -0.0197560489f, -0.0193701498f, -0.0189644024f, -0.0185402650f, -0.0180991832f,
+	-0.0176425856f, -0.0171718840f, -0.0166884605f, -0.0161936842f, -0.0156888906f, -0.0151753929f,
+	-0.0146544715f, -0.0141273793f, -0.0135953361f, -0.0130595285f, -0.0125211086f, -0.0119811920f,
+	-0.0114408573f, -0.0109011475f, -0.0103630647f, -0.00982757285f, -0.00929559581f, -0.00876801834f,
+	-0.00824568048f, -0.00772938645f, -0.00721989572f, -0.00671792729f, -0.00622415869f, -0.00573922601f,
+	-0.00526372390f, -0.00479820650f, -0.00434318697f, -0.00389913749f, -0.00346649159f, -0.00304564228f,
+	-0.00263694441f, -0.00224071438f, -0.00185723125f, -0.00148673740f, -0.00112943910f, -0.000785508135f,
+	-0.000455081667f, -0.000138264018f, 0.000164872748f, 0.000454287656f, 0.000729969877f, 0.000991937472f,
+	0.00124023634f, 0.00147493929f, 0.00169614458f, 0.00190397492f, 0.00209857617f, 0.00228011655f,
+	0.00244878442f, 0.00260478887f, 0.00274835643f, 0.00287973159f, 0.00299917441f, 0.00310696010f,
+	0.00320337713f, 0.00328872749f, 0.00336332340f, 0.00342748803f, 0.00348155340f, 0.00352585968f,
+	0.00356075400f, 0.00358658936f, 0.00360372360f, 0.00361251854f, 0.00361333881f, 0.00360655109f,
+	0.00359252305f, 0.00357162254f, 0.00354421721f, 0.00351067237f, 0.00347135193f, 0.00342661608f,
+	0.00337682222f, 0.00332232239f, 0.00326346443f, 0.00320058991f, 0.00313403504f, 0.00306412857f,
+	0.00299119251f, 0.00291554094f, 0.00283748028f, 0.00275730831f, 0.00267531397f, 0.00259177736f,
+	0.00250696880f, 0.00242114952f, 0.00233457051f, 0.00224747276f, 0.00216008746f, 0.00207263557f,
+	0.00198532711f, 0.00189836218f, 0.00181193044f, 0.00172621093f, 0.00164137245f, 0.00155757333f,
+	0.00147496175f, 0.00139367545f, 0.00131384225f, 0.00123558007f, 0.00115899695f, 0.00108419149f,
+	0.00101125264f, 0.000940260303f, 0.000871285331f, 0.000804389943f, 0.000739627751f, 0.000677044096f,
+	0.000616676407f, 0.000558554544f, 0.000502700685f, 0.000449130224f, 0.000397851516f, 0.000348866481f,
+	0.000302170869f, 0.000257754553f, 0.000215601773f, 0.000175691588f, 0.000137998082f, 0.000102490718f,
+	6.91346359e-05f, 3.78909826e-05f, 8.71719931e-06f, -1.84326655e-05f, -4.36076662e-05f, -6.68596549e-05f,
+	-8.82430177e-05f, -0.000107814354f, -0.000125632243f, -0.000141756958f, -0.000156250186f, -0.000169174848f,
+	-0.000180594754f, -0.000190574458f, -0.000199178976f, -0.000206473604f, -0.000212523708f, -0.000217394496f,
+	-0.000221150854f, -0.000223857205f, -0.000225577285f, -0.000226374003f, -0.000226309319f, -0.000225444062f,
+	-0.000223837866f, -0.000221548995f, -0.000218634261f, -0.000215148946f, -0.000211146675f, -0.000206679382f,
+	-0.000201797186f, -0.000196548383f, -0.000190979379f, -0.000185134646f, -0.000179056675f, -0.000172785964f,
+	-0.000166361002f, -0.000159818257f, -0.000153192159f, -0.000146515129f, -0.000139817537f, -0.000133127804f,
+	-0.000126472325f, -0.000119875564f, -0.000113360060f, -0.000106946485f, -0.000100653633f, -9.44985295e-05f,
+	-8.84964320e-05f, -8.26609248e-05f, -7.70039260e-05f, -7.15357746e-05f, -6.62652965e-05f, -6.11998403e-05f,
+	-5.63453832e-05f, -5.17065382e-05f, -4.72866777e-05f, -4.30879663e-05f, -3.91114372e-05f, -3.53570758e-05f,
+	-3.18238563e-05f, -2.85098449e-05f, -2.54122479e-05f, -2.25274816e-05f, -1.98512407e-05f, -1.73785666e-05f,
+	-1.51039048e-05f, -1.30211765e-05f, -1.11238332e-05f
+};
+
+// 48000 -> 44100, quality 3
+static const FIRCoefficient KERNEL_8[] = {
+	1.50620162e-05f, 1.69339492e-05f, 1.89088369e-05f, 2.09840946e-05f, 2.31563918e-05f, 2.54215975e-05f,
+	2.77747604e-05f, 3.02100616e-05f, 3.27207963e-05f, 3.52993338e-05f, 3.79370904e-05f, 4.06245053e-05f,
+	4.33510213e-05f, 4.61050549e-05f, 4.88739788e-05f, 5.16441214e-05f, 5.44007307e-05f, 5.71279888e-05f,
+	5.98089937e-05f, 6.24257664e-05f, 6.49592475e-05f, 6.73893082e-05f, 6.96947536e-05f, 7.18533702e-05f,
+	7.38419039e-05f, 7.56361260e-05f, 7.72108178e-05f, 7.85398734e-05f, 7.95962769e-05f, 8.03521980e-05f,
+	8.07790057e-05f, 8.08473633e-05f, 8.05272794e-05f, 7.97881585e-05f, 7.85989105e-05f, 7.69280232e-05f,
+	7.47436206e-05f, 7.20136159e-05f, 6.87057545e-05f, 6.47877387e-05f, 6.02273576e-05f, 5.49925826e-05f,
+	4.90516941e-05f, 4.23734164e-05f, 3.49270376e-05f, 2.66825591e-05f, 1.76108315e-05f, 7.68369955e-06f,
+	-3.12583848e-06f, -1.48434847e-05f, -2.74934791e-05f, -4.10984430e-05f, -5.56792002e-05f, -7.12546389e-05f,
+	-8.78415012e-05f, -0.000105454259f, -0.000124104903f, -0.000143802798f, -0.000164554498f, -0.000186363570f,
+	-0.000209230435f, -0.000233152168f, -0.000258122396f, -0.000284131063f, -0.000311164302f, -0.000339204271f,
+	-0.000368229026f, -0.000398212287f, -0.000429123407f, -0.000460927171f, -0.000493583677f, -0.000527048251f,
+	-0.000561271328f, -0.000596198137f, -0.000631769071f, -0.000667919172f, -0.000704578299f, -0.000741670898f,
+	-0.000779116119f, -0.000816827698f, -0.000854713959f, -0.000892677868f, -0.000930616981f, -0.000968423323f,
+	-0.00100598368f, -0.00104317977f, -0.00107988785f, -0.00111597928f, -0.00115132018f, -0.00118577213f,
+	-0.00121919182f, -0.00125143165f, -0.00128233945f, -0.00131175923f, -0.00133953069f, -0.00136549061f,
+	-0.00138947170f, -0.00141130411f, -0.00143081520f, -0.00144782988f, -0.00146217097f, -0.00147365977f,
+	-0.00148211652f, -0.00148736022f, -0.00148920983f, -0.00148748443f, -0.00148200337f, -0.00147258735f,
+	-0.00145905849f, -0.00144124113f, -0.00141896214f, -0.00139205181f, -0.00136034412f, -0.00132367737f,
+	-0.00128189498f, -0.00123484596f, -0.00118238549f, -0.00112437562f, -0.00106068607f, -0.000991194509f,
+	-0.000915787648f, -0.000834361417f, -0.000746822043f, -0.000653086463f, -0.000553083082f, -0.000446752441f,
+	-0.000334047741f, -0.000214935557f, -8.93965553e-05f, 4.25740363e-05f, 0.000180965726f, 0.000325752218f,
+	0.000476890738f, 0.000634321652f, 0.000797967776f, 0.000967733795f, 0.00114350615f, 0.00132515200f,
+	0.00151251943f, 0.00170543650f, 0.00190371124f, 0.00210713083f, 0.00231546233f, 0.00252845092f,
+	0.00274582137f, 0.00296727638f, 0.00319249718f, 0.00342114363f, 0.00365285366f, 0.00388724380f,
+	0.00412390893f, 0.00436242158f, 0.00460233493f, 0.00484317960f, 0.00508446572f, 0.00532568339f,
+	0.00556630269f, 0.00580577366f, 0.00604352867f, 0.00627898006f, 0.00651152385f, 0.00674053887f,
+	0.00696538715f, 0.00718541583f, 0.00739995809f, 0.00760833360f, 0.00780984852f, 0.00800380018f,
+	0.00818947330f, 0.00836614612f, 0.00853308756f, 0.00868956186f, 0.00883482862f, 0.00896814186f,
+	0.00908875745f, 0.00919592939f, 0.00928891264f, 0.00936696678f, 0.00942935608f, 0.00947535317f,
+	0.00950423535f, 0.00951529481f, 0.00950783398f, 0.00948117021f, 0.00943463761f, 0.00936758798f,
+	0.00927939545f, 0.00916945469f, 0.00903718639f, 0.00888203550f, 0.00870347954f, 0.00850102399f,
+	0.00827420875f, 0.00802260824f, 0.00774583407f, 0.00744353700f, 0.00711540878f, 0.00676118489f,
+	0.00638064556f, 0.00597361894f, 0.00553998118f, 0.00507966010f, 0.00459263567f, 0.00407894282f,
+	0.00353867165f, 0.00297197117f, 0.00237904885f, 0.00176017266f, 0.00111567311f, 0.000445943791f,
+	-0.000248557335f, -0.000967306725f, -0.00170971430f, -0.00247512269f, -0.00326280668f, -0.00407197187f,
+	-0.00490175514f, -0.00575122377f, -0.00661937520f, -0.00750513701f, -0.00840736739f, -0.00932485610f,
+	-0.0102563202f, -0.0112004131f, -0.0121557154f, -0.0131207444f, -0.0140939504f, -0.0150737166f,
+	-0.0160583667f, -0.0170461591f, -0.0180352926f, -0.0190239083f, -0.0200100914f, -0.0209918693f,
+	-0.0219672248f, -0.0229340829f, -0.0238903295f, -0.0248338003f, -0.0257622954f, -0.0266735759f,
+	-0.0275653675f, -0.0284353681f, -0.0292812474f, -0.0301006529f, -0.0308912117f, -0.0316505395f,
+	-0.0323762372f, -0.0330659039f, -0.0337171406f, -0.0343275405f, -0.0348947160f, -0.0354162864f,
+	-0.0358898938f, -0.0363132022f, -0.0366839021f, -0.0369997211f, -0.0372584276f, -0.0374578275f,
+	-0.0375957862f, -0.0376702175f, -0.0376791023f, -0.0376204886f, -0.0374924876f, -0.0372933075f,
+	-0.0370212235f, -0.0366746075f, -0.0362519249f, -0.0357517451f, -0.0351727419f, -0.0345136970f,
+	-0.0337735154f, -0.0329512209f, -0.0320459679f, -0.0310570356f, -0.0299838483f, -0.0288259666f,
+	-0.0275831036f, -0.0262551196f, -0.0248420276f, -0.0233440064f, -0.0217613913f, -0.0200946871f,
+	-0.0183445700f, -0.0165118854f, -0.0145976599f, -0.0126030939f, -0.0105295712f, -0.00837865844f,
+	-0.00615210552f, -0.00385185075f, -0.00148001767f, 0.000961081183f, 0.00346894469f, 0.00604088372f,
+	0.00867401995f, 0.0113652870f, 0.0141114341f, 0.0169090237f, 0.0197544303f, 0.0226438567f,
+	0.0255733151f, 0.0285386499f, 0.0315355286f, 0.0345594548f, 0.0376057550f, 0.0406696126f,
+	0.0437460355f, 0.0468298979f, 0.0499159209f, 0.0529986881f, 0.0560726561f, 0.0591321439f,
+	0.0621713698f, 0.0651844218f, 0.0681653023f, 0.0711079165f, 0.0740060806f, 0.0768535286f,
+	0.0796439424f, 0.0823709443f, 0.0850280896f, 0.0876089334f, 0.0901069716f, 0.0925156996f,
+	0.0948286131f, 0.0970392153f, 0.0991410241f, 0.101127595f, 0.102992512f, 0.104729444f,
+	0.106332108f, 0.107794307f, 0.109109938f, 0.110273018f, 0.111277662f, 0.112118140f,
+	0.112788856f, 0.113284379f, 0.113599457f, 0.113729015f, 0.113668188f, 0.113412306f,
+	0.112956941f, 0.112297893f, 0.111431234f, 0.110353269f, 0.109060593f, 0.107550107f,
+	0.105818979f, 0.103864707f, 0.101685122f, 0.0992783606f, 0.0966429338f, 0.0937776789f,
+	0.0906818211f, 0.0873549581f, 0.0837970451f, 0.0800084621f, 0.0759899765f, 0.0717427507f,
+	0.0672683790f, 0.0625688657f, 0.0576466434f, 0.0525045879f, 0.0471460000f, 0.0415746234f,
+	0.0357946493f, 0.0298107173f, 0.0236279108f, 0.0172517709f, 0.0106882863f, 0.00394389778f,
+	-0.00297450158f, -0.0100595700f, -0.0173035171f, -0.0246981103f, -0.0322346725f, -0.0399040952f,
+	-0.0476968363f, -0.0556029305f, -0.0636119917f, -0.0717132166f, -0.0798954219f, -0.0881469995f,
+	-0.0964559913f, -0.104810044f, -0.113196447f, -0.121602148f, -0.130013749f, -0.138417557f,
+	-0.146799520f, -0.155145332f, -0.163440406f, -0.171669900f, -0.179818690f, -0.187871486f,
+	-0.195812747f, -0.203626752f, -0.211297631f, -0.218809322f, -0.226145700f, -0.233290493f,
+	-0.240227327f, -0.246939808f, -0.253411502f, -0.259625882f, -0.265566528f, -0.271217018f,
+	-0.276560962f, -0.281582028f, -0.286264032f, -0.290590942f, -0.294546783f, -0.298115879f,
+	-0.301282614f, -0.304031730f, -0.306348145f, -0.308217078f, -0.309624046f, -0.310554892f,
+	-0.310995817f, -0.310933381f, -0.310354561f, -0.309246749f, -0.307597786f, -0.305395991f,
+	-0.302630156f, -0.299289584f, -0.295364201f, -0.290844351f, -0.285721034f, -0.279985875f,
+	-0.273631096f, -0.266649514f, -0.259034663f, -0.250780731f, -0.241882563f, -0.232335761f,
+	-0.222136617f, -0.211282179f, -0.199770212f, -0.187599286f, -0.174768701f, -0.161278576f,
+	-0.147129804f, -0.132324055f, -0.116863869f, -0.100752547f, -0.0839942172f, -0.0665938556f,
+	-0.0485572442f, -0.0298909917f, -0.0106025441f, 0.00929982867f, 0.0298070274f, 0.0509091355f,
+	0.0725954100f, 0.0948543027f, 0.117673457f, 0.141039699f, 0.164939091f, 0.189356908f,
+	0.214277640f, 0.239685029f, 0.265562087f, 0.291891068f, 0.318653524f, 0.345830351f,
+	0.373401731f, 0.401347160f, 0.429645538f, 0.458275139f, 0.487213641f, 0.516438127f,
+	0.545925200f, 0.575650871f, 0.605590701f, 0.635719717f, 0.666012526f, 0.696443439f,
+	0.726986170f, 0.757614255f, 0.788300872f, 0.819018841f, 0.849740744f, 0.880438983f,
+	0.911085725f, 0.941653013f, 0.972112656f, 1.00243652f, 1.03259635f, 1.06256378f,
+	1.09231043f, 1.12180829f, 1.15102911f, 1.17994475f, 1.20852745f, 1.23674941f,
+	1.26458323f, 1.29200161f, 1.31897759f, 1.34548450f, 1.37149620f, 1.39698672f,
+	1.42193067f, 1.44630313f, 1.47007942f, 1.49323571f, 1.51574862f, 1.53759515f,
+	1.55875313f, 1.57920110f, 1.59891796f, 1.61788368f, 1.63607872f, 1.65348434f,
+	1.67008257f, 1.68585622f, 1.70078909f, 1.71486557f, 1.72807097f, 1.74039185f,
+	1.75181508f, 1.76232886f, 1.77192223f, 1.78058517f, 1.78830850f, 1.79508436f,
+	1.80090535f, 1.80576563f, 1.80965996f, 1.81258428f, 1.81453562f, 1.81551170f,
+	1.81551170f, 1.81453562f, 1.81258428f, 1.80965996f, 1.80576563f, 1.80090535f,
+	1.79508436f, 1.78830850f, 1.78058517f, 1.77192223f, 1.76232886f, 1.75181508f,
+	1.74039185f, 1.72807097f, 1.71486557f, 1.70078909f, 1.68585622f, 1.67008257f,
+	1.65348434f, 1.63607872f, 1.61788368f, 1.59891796f, 1.57920110f, 1.55875313f,
+	1.53759515f, 1.51574862f, 1.49323571f, 1.47007942f, 1.44630313f, 1.42193067f,
+	1.39698672f, 1.37149620f, 1.34548450f, 1.31897759f, 1.29200161f, 1.26458323f,
+	1.23674941f, 1.20852745f, 1.17994475f, 1.15102911f, 1.12180829f, 1.09231043f,
+	1.06256378f, 1.03259635f, 1.00243652f, 0.972112656f, 0.941653013f, 0.911085725f,
+	0.880438983f, 0.849740744f, 0.819018841f, 0.788300872f, 0.757614255f, 0.726986170f,
+	0.696443439f, 0.666012526f, 0.635719717f, 0.605590701f, 0.575650871f, 0.545925200f,
+	0.516438127f, 0.487213641f, 0.458275139f, 0.429645538f, 0.401347160f, 0.373401731f,
+	0.345830351f, 0.318653524f, 0.291891068f, 0.265562087f, 0.239685029f, 0.214277640f,
+	0.189356908f, 0.164939091f, 0.141039699f, 0.117673457f, 0.0948543027f, 0.0725954100f,
+	0.0509091355f, 0.0298070274f, 0.00929982867f, -0.0106025441f, -0.0298909917f, -0.0485572442f,
+	-0.0665938556f, -0.0839942172f, -0.100752547f, -0.116863869f, -0.132324055f, -0.147129804f,
+	-0.161278576f, -0.174768701f, -0.187599286f, -0.199770212f, -0.211282179f, -0.222136617f,
+	-0.232335761f, -0.241882563f, -0.250780731f, -0.259034663f, -0.266649514f, -0.273631096f,
+	-0.279985875f, -0.285721034f, -0.290844351f, -0.295364201f, -0.299289584f, -0.302630156f,
+	-0.305395991f, -0.307597786f, -0.309246749f, -0.310354561f, -0.310933381f, -0.310995817f,
+	-0.310554892f, -0.309624046f, -0.308217078f, -0.306348145f, -0.304031730f, -0.301282614f,
+	-0.298115879f, -0.294546783f, -0.290590942f, -0.286264032f, -0.281582028f, -0.276560962f,
+	-0.271217018f, -0.265566528f, -0.259625882f, -0.253411502f, -0.246939808f, -0.240227327f,
+	-0.233290493f, -0.226145700f, -0.218809322f, -0.211297631f, -0.203626752f, -0.195812747f,
+	-0.187871486f, -0.179818690f, -0.171669900f, -0.163440406f, -0.155145332f, -0.146799520f,
+	-0.138417557f, -0.130013749f, -0.121602148f, -0.113196447f, -0.104810044f, -0.0964559913f,
+	-0.0881469995f, -0.0798954219f, -0.0717132166f, -0.0636119917f, -0.0556029305f, -0.0476968363f,
+	-0.0399040952f, -0.0322346725f, -0.0246981103f, -0.0173035171f, -0.0100595700f, -0.00297450158f,
+	0.00394389778f, 0.0106882863f, 0.0172517709f, 0.0236279108f, 0.0298107173f, 0.0357946493f,
+	0.0415746234f, 0.0471460000f, 0.0525045879f, 0.0576466434f, 0.0625688657f, 0.0672683790f,
+	0.0717427507f, 0.0759899765f, 0.0800084621f, 0.0837970451f, 0.0873549581f, 0.0906818211f,
+	0.0937776789f, 0.0966429338f, 0.0992783606f, 0.101685122f, 0.103864707f, 0.105818979f,
+	0.107550107f, 0.109060593f, 0.110353269f, 0.111431234f, 0.112297893f, 0.112956941f,
+	0.113412306f, 0.113668188f, 0.113729015f, 0.113599457f, 0.113284379f, 0.112788856f,
+	0.112118140f, 0.111277662f, 0.110273018f, 0.109109938f, 0.107794307f, 0.106332108f,
+	0.104729444f, 0.102992512f, 0.101127595f, 0.0991410241f, 0.0970392153f, 0.0948286131f,
+	0.0925156996f, 0.0901069716f, 0.0876089334f, 0.0850280896f, 0.0823709443f, 0.0796439424f,
+	0.0768535286f, 0.0740060806f, 0.0711079165f, 0.0681653023f, 0.0651844218f, 0.0621713698f,
+	0.0591321439f, 0.0560726561f, 0.0529986881f, 0.0499159209f, 0.0468298979f, 0.0437460355f,
+	0.0406696126f, 0.0376057550f, 0.0345594548f, 0.0315355286f, 0.0285386499f, 0.0255733151f,
+	0.0226438567f, 0.0197544303f, 0.0169090237f, 0.0141114341f, 0.0113652870f, 0.00867401995f,
+	0.00604088372f, 0.00346894469f, 0.000961081183f, -0.00148001767f, -0.00385185075f, -0.00615210552f,
+	-0.00837865844f, -0.0105295712f, -0.0126030939f, -0.0145976599f, -0.0165118854f, -0.0183445700f,
+	-0.0200946871f, -0.0217613913f, -0.0233440064f, -0.0248420276f, -0.0262551196f, -0.0275831036f,
+	-0.0288259666f, -0.0299838483f, -0.0310570356f, -0.0320459679f, -0.0329512209f, -0.0337735154f,
+	-0.0345136970f, -0.0351727419f, -0.0357517451f, -0.0362519249f, -0.0366746075f, -0.0370212235f,
+	-0.0372933075f, -0.0374924876f, -0.0376204886f, -0.0376791023f, -0.0376702175f, -0.0375957862f,
+	-0.0374578275f, -0.0372584276f, -0.0369997211f, -0.0366839021f, -0.0363132022f, -0.0358898938f,
+	-0.0354162864f, -0.0348947160f, -0.0343275405f, -0.0337171406f, -0.0330659039f, -0.0323762372f,
+	-0.0316505395f, -0.0308912117f, -0.0301006529f, -0.0292812474f, -0.0284353681f, -0.0275653675f,
+	-0.0266735759f, -0.0257622954f, -0.0248338003f, -0.0238903295f, -0.0229340829f, -0.0219672248f,
+	-0.0209918693f, -0.0200100914f, -0.0190239083f, -0.0180352926f, -0.0170461591f, -0.0160583667f,
+	-0.0150737166f, -0.0140939504f, -0.0131207444f, -0.0121557154f, -0.0112004131f, -0.0102563202f,
+	-0.00932485610f, -0.00840736739f, -0.00750513701f, -0.00661937520f, -0.00575122377f, -0.00490175514f,
+	-0.00407197187f, -0.00326280668f, -0.00247512269f, -0.00170971430f, -0.000967306725f, -0.000248557335f,
+	0.000445943791f, 0.00111567311f, 0.00176017266f, 0.00237904885f, 0.00297197117f, 0.00353867165f,
+	0.00407894282f, 0.00459263567f, 0.00507966010f, 0.00553998118f, 0.00597361894f, 0.00638064556f,
+	0.00676118489f, 0.00711540878f, 0.00744353700f, 0.00774583407f, 0.00802260824f, 0.00827420875f,
+	0.00850102399f, 0.00870347954f, 0.00888203550f, 0.00903718639f, 0.00916945469f, 0.00927939545f,
+	0.00936758798f, 0.00943463761f, 0.00948117021f, 0.00950783398f, 0.00951529481f, 0.00950423535f,
+	0.00947535317f, 0.00942935608f, 0.00936696678f, 0.00928891264f, 0.00919592939f, 0.00908875745f,
+	0.00896814186f, 0.00883482862f, 0.00868956186f, 0.00853308756f, 0.00836614612f, 0.00818947330f,
+	0.00800380018f, 0.00780984852f, 0.00760833360f, 0.00739995809f, 0.00718541583f, 0.00696538715f,
+	0.00674053887f, 0.00651152385f, 0.00627898006f, 0.00604352867f, 0.00580577366f, 0.00556630269f,
+	0.00532568339f, 0.00508446572f, 0.00484317960f, 0.00460233493f, 0.00436242158f, 0.00412390893f,
+	0.00388724380f, 0.00365285366f, 0.00342114363f, 0.00319249718f, 0.00296727638f, 0.00274582137f,
+	0.00252845092f, 0.00231546233f, 0.00210713083f, 0.00190371124f, 0.00170543650f, 0.00151251943f,
+	0.00132515200f, 0.00114350615f, 0.000967733795f, 0.000797967776f, 0.000634321652f, 0.000476890738f,
+	0.000325752218f, 0.000180965726f, 4.25740363e-05f, -8.93965553e-05f, -0.000214935557f, -0.000334047741f,
+	-0.000446752441f, -0.000553083082f, -0.000653086463f, -0.000746822043f, -0.000834361417f, -0.000915787648f,
+	-0.000991194509f, -0.00106068607f, -0.00112437562f, -0.00118238549f, -0.00123484596f, -0.00128189498f,
+	-0.00132367737f, -0.00136034412f, -0.00139205181f, -0.00141896214f, -0.00144124113f, -0.00145905849f,
+	-0.00147258735f, -0.00148200337f, -0.00148748443f, -0.00148920983f, -0.00148736022f, -0.00148211652f,
+	-0.00147365977f, -0.00146217097f, -0.00144782988f, -0.00143081520f, -0.00141130411f, -0.00138947170f,
+	-0.00136549061f, -0.00133953069f, -0.00131175923f, -0.00128233945f, -0.00125143165f, -0.00121919182f,
+	-0.00118577213f, -0.00115132018f, -0.00111597928f, -0.00107988785f, -0.00104317977f, -0.00100598368f,
+	-0.000968423323f, -0.000930616981f, -0.000892677868f, -0.000854713959f, -0.000816827698f, -0.000779116119f,
+	-0.000741670898f, -0.000704578299f, -0.000667919172f, -0.000631769071f, -0.000596198137f, -0.000561271328f,
+	-0.000527048251f, -0.000493583677f, -0.000460927171f, -0.000429123407f, -0.000398212287f, -0.000368229026f,
+	-0.000339204271f, -0.000311164302f, -0.000284131063f, -0.000258122396f, -0.000233152168f, -0.000209230435f,
+	-0.000186363570f, -0.000164554498f, -0.000143802798f, -0.000124104903f, -0.000105454259f, -8.78415012e-05f,
+	-7.12546389e-05f, -5.56792002e-05f, -4.10984430e-05f, -2.74934791e-05f, -1.48434847e-05f, -3.12583848e-06f,
+	7.68369955e-06f, 1.76108315e-05f, 2.66825591e-05f, 3.49270376e-05f, 4.23734164e-05f, 4.90516941e-05f,
+	5.49925826e-05f, 6.02273576e-05f, 6.47877387e-05f, 6.87057545e-05f, 7.20136159e-05f, 7.47436206e-05f,
+	7.69280232e-05f, 7.85989105e-05f, 7.97881585e-05f, 8.05272794e-05f, 8.08473633e-05f, 8.07790057e-05f,
+	8.03521980e-05f, 7.95962769e-05f, 7.85398734e-05f, 7.72108178e-05f, 7.56361260e-05f, 7.38419039e-05f,
+	7.18533702e-05f, 6.96947536e-05f, 6.73893082e-05f, 6.49592475e-05f, 6.24257664e-05f, 5.98089937e-05f,
+	5.71279888e-05f, 5.44007307e-05f, 5.16441214e-05f, 4.88739788e-05f, 4.61050549e-05f, 4.33510213e-05f,
+	4.06245053e-05f, 3.79370904e-05f, 3.52993338e-05f, 3.27207963e-05f, 3.02100616e-05f, 2.77747604e-05f,
+	2.54215975e-05f, 2.31563918e-05f, 2.09840946e-05f, 1.89088369e-05f, 1.69339492e-05f, 1.50620162e-05f
+};
+
+const PrecomputedKernels::Kernel PrecomputedKernels::KERNELS[] = {
+	{64000, 44100, 8000, 48000, 106, 128, 128, 185.75963718820861, 1399, KERNEL_0},
+	{64000, 44100, 12332.800000000001, 48000, 106, 128, 128, 185.75963718820861, 1569, KERNEL_1},
+	{64000, 44100, 15238.4, 48000, 106, 128, 128, 185.75963718820861, 1708, KERNEL_2},
+	{64000, 48000, 8000, 48000, 106, 128, 3, 4, 34, KERNEL_3},
+	{64000, 48000, 12332.800000000001, 48000, 106, 128, 3, 4, 38, KERNEL_4},
+	{64000, 48000, 15238.4, 48000, 106, 128, 3, 4, 42, KERNEL_5},
+	{48000, 88200, 11025, 66150, 106, 471, 147, 80, 875, KERNEL_6},
+	{48000, 88200, 16996.139999999999, 66150, 106, 471, 147, 80, 981, KERNEL_7},
+	{48000, 88200, 21000.420000000002, 66150, 106, 471, 147, 80, 1068, KERNEL_8}
+};
+
+const unsigned int PrecomputedKernels::KERNEL_COUNT = 9;
@@ -23,6 +23,7 @@
 #include "../include/SincResampler.h"
 #include "../include/IIR2xResampler.h"
 #include "../include/LinearResampler.h"
+#include "../include/FixedPointFIRResampler.h"
 
 namespace SRCTools {
 
@@ -33,10 +34,14 @@ static const unsigned int MAX_SAMPLES_PER_RUN = 4096;
 
 class CascadeStage : public FloatSampleProvider {
 friend void freeResamplerModel(FloatSampleProvider &model, FloatSampleProvider &source);
+friend bool setRateAdjustment(FloatSampleProvider &model, FloatSampleProvider &source, double rateAdjustment);
+friend double getGroupDelay(FloatSampleProvider &model, FloatSampleProvider &source);
+friend size_t getMemoryUsage(FloatSampleProvider &model, FloatSampleProvider &source);
 public:
 	CascadeStage(FloatSampleProvider &source, ResamplerStage &resamplerStage);
 
 	void getOutputSamples(FloatSample *outBuffer, unsigned int size);
+	void getPlanarOutputSamples(FloatSample *leftBuffer, FloatSample *rightBuffer, unsigned int size);
 
 protected:
 	ResamplerStage &resamplerStage;
@@ -46,6 +51,8 @@ private:
 	FloatSample buffer[CHANNEL_COUNT * MAX_SAMPLES_PER_RUN];
 	const FloatSample *bufferPtr;
 	unsigned int size;
+
+	void fillBuffer(unsigned int outLength);
 };
 
 class InternalResamplerCascadeStage : public CascadeStage {
@@ -59,36 +66,90 @@ public:
 	}
 };
 
+class FixedPointCascadeStage : public IntSampleProvider {
+friend void freeResamplerModel(IntSampleProvider &model, IntSampleProvider &source);
+friend bool setRateAdjustment(IntSampleProvider &model, IntSampleProvider &source, double rateAdjustment);
+friend double getGroupDelay(IntSampleProvider &model, IntSampleProvider &source);
+friend size_t getMemoryUsage(IntSampleProvider &model, IntSampleProvider &source);
+public:
+	FixedPointCascadeStage(IntSampleProvider &source, FixedPointFIRResampler &resampler);
+
+	void getOutputSamples(IntSample *outBuffer, unsigned int size);
+
+protected:
+	FixedPointFIRResampler &resampler;
+
+private:
+	IntSampleProvider &source;
+	IntSample buffer[CHANNEL_COUNT * MAX_SAMPLES_PER_RUN];
+	const IntSample *bufferPtr;
+	unsigned int size;
+};
+
+class InternalFixedPointCascadeStage : public FixedPointCascadeStage {
+public:
+	InternalFixedPointCascadeStage(IntSampleProvider &useSource, FixedPointFIRResampler &useResampler) :
+		FixedPointCascadeStage(useSource, useResampler)
+	{}
+
+	~InternalFixedPointCascadeStage() {
+		delete &resampler;
+	}
+};
+
+// Linear interpolation is the convolution with a triangular kernel, which spans two input samples. Since the kernel is linear
+// between its phases, the tap interpolation reproduces it exactly regardless of the number of phases.
+static FixedPointFIRResampler *createFixedPointLinearResampler(double sourceSampleRate, double targetSampleRate, bool variableRatio) {
+	unsigned int upsampleFactor;
+	double downsampleFactor;
+	if (variableRatio) {
+		upsampleFactor = DEFAULT_WINDOWED_SINC_MAX_DOWNSAMPLE_FACTOR;
+		downsampleFactor = upsampleFactor * sourceSampleRate / targetSampleRate;
+	} else {
+		SincResampler::Utils::computeResampleFactors(upsampleFactor, downsampleFactor, sourceSampleRate, targetSampleRate, DEFAULT_WINDOWED_SINC_MAX_DOWNSAMPLE_FACTOR);
+	}
+	const unsigned int kernelLength = 2 * upsampleFactor + 1;
+	FIRCoefficient *kernel = new FIRCoefficient[kernelLength];
+	for (unsigned int tapIx = 0; tapIx < kernelLength; tapIx++) {
+		kernel[tapIx] = FIRCoefficient(1.0 - fabs(double(tapIx) - upsampleFactor) / upsampleFactor);
+	}
+	FixedPointFIRResampler *resampler = new FixedPointFIRResampler(upsampleFactor, downsampleFactor, kernel, kernelLength, variableRatio);
+	delete[] kernel;
+	return resampler;
+}
+
 } // namespace ResamplerModel
 
 } // namespace SRCTools
 
 using namespace SRCTools;
 
-FloatSampleProvider &ResamplerModel::createResamplerModel(FloatSampleProvider &source, double sourceSampleRate, double targetSampleRate, Quality quality) {
-	if (sourceSampleRate == targetSampleRate) {
+FloatSampleProvider &ResamplerModel::createResamplerModel(FloatSampleProvider &source, double sourceSampleRate, double targetSampleRate, Quality quality, bool variableRatio) {
+	if (sourceSampleRate == targetSampleRate && !variableRatio) {
 		return source;
 	}
 	if (quality == FASTEST) {
 		return *new InternalResamplerCascadeStage(source, *new LinearResampler(sourceSampleRate, targetSampleRate));
 	}
-	const IIRResampler::Quality iirQuality = static_cast<IIRResampler::Quality>(quality);
+	// The sharpest IIR filter also has the least group delay at low frequencies
+	const bool minimumPhase = quality == LOW_LATENCY;
+	const IIRResampler::Quality iirQuality = minimumPhase ? IIRResampler::BEST : static_cast<IIRResampler::Quality>(quality);
 	const double iirPassbandFraction = IIRResampler::getPassbandFractionForQuality(iirQuality);
 	if (sourceSampleRate < targetSampleRate) {
 		ResamplerStage *iir2xInterpolator = new IIR2xInterpolator(iirQuality);
 		FloatSampleProvider &iir2xInterpolatorStage = *new InternalResamplerCascadeStage(source, *iir2xInterpolator);
 
-		if (2.0 * sourceSampleRate == targetSampleRate) {
+		if (2.0 * sourceSampleRate == targetSampleRate && !variableRatio) {
 			return iir2xInterpolatorStage;
 		}
 
 		double passband = 0.5 * sourceSampleRate * iirPassbandFraction;
 		double stopband = 1.5 * sourceSampleRate;
-		ResamplerStage *sincResampler = SincResampler::createSincResampler(2.0 * sourceSampleRate, targetSampleRate, passband, stopband, DEFAULT_DB_SNR, DEFAULT_WINDOWED_SINC_MAX_UPSAMPLE_FACTOR);
+		ResamplerStage *sincResampler = SincResampler::createSincResampler(2.0 * sourceSampleRate, targetSampleRate, passband, stopband, DEFAULT_DB_SNR, DEFAULT_WINDOWED_SINC_MAX_UPSAMPLE_FACTOR, variableRatio, minimumPhase);
 		return *new InternalResamplerCascadeStage(iir2xInterpolatorStage, *sincResampler);
 	}
 
-	if (sourceSampleRate == 2.0 * targetSampleRate) {
+	if (sourceSampleRate == 2.0 * targetSampleRate && !variableRatio) {
 		ResamplerStage *iir2xDecimator = new IIR2xDecimator(iirQuality);
 		return *new InternalResamplerCascadeStage(source, *iir2xDecimator);
 	}
@@ -97,7 +158,7 @@ FloatSampleProvider &ResamplerModel::createResamplerModel(FloatSampleProvider &s
 	double stopband = 1.5 * targetSampleRate;
 	double sincOutSampleRate = 2.0 * targetSampleRate;
 	const unsigned int maxUpsampleFactor = static_cast<unsigned int>(ceil(DEFAULT_WINDOWED_SINC_MAX_DOWNSAMPLE_FACTOR * sincOutSampleRate / sourceSampleRate));
-	ResamplerStage *sincResampler = SincResampler::createSincResampler(sourceSampleRate, sincOutSampleRate, passband, stopband, DEFAULT_DB_SNR, maxUpsampleFactor);
+	ResamplerStage *sincResampler = SincResampler::createSincResampler(sourceSampleRate, sincOutSampleRate, passband, stopband, DEFAULT_DB_SNR, maxUpsampleFactor, variableRatio, minimumPhase);
 	FloatSampleProvider &sincResamplerStage = *new InternalResamplerCascadeStage(source, *sincResampler);
 
 	ResamplerStage *iir2xDecimator = new IIR2xDecimator(iirQuality);
@@ -127,6 +188,97 @@ void ResamplerModel::freeResamplerModel(FloatSampleProvider &model, FloatSampleP
 	}
 }
 
+bool ResamplerModel::setRateAdjustment(FloatSampleProvider &model, FloatSampleProvider &source, double rateAdjustment) {
+	FloatSampleProvider *currentStage = &model;
+	while (currentStage != &source) {
+		CascadeStage *cascadeStage = dynamic_cast<CascadeStage *>(currentStage);
+		if (cascadeStage == NULL) return false;
+		// Adjusting the ratio of any single stage scales the output sample rate of the entire cascade
+		if (cascadeStage->resamplerStage.setRateAdjustment(rateAdjustment)) return true;
+		currentStage = &cascadeStage->source;
+	}
+	return false;
+}
+
+double ResamplerModel::getGroupDelay(FloatSampleProvider &model, FloatSampleProvider &source) {
+	// The delay of each stage is measured at its input sample rate, which relates to the source sample rate by the product
+	// of the ratios of all the preceding stages. As the cascade is traversed from the output, the overall ratio comes first.
+	double overallRatio = 1.0;
+	for (FloatSampleProvider *currentStage = &model; currentStage != &source;) {
+		CascadeStage *cascadeStage = dynamic_cast<CascadeStage *>(currentStage);
+		if (cascadeStage == NULL) break;
+		overallRatio *= cascadeStage->resamplerStage.getOutputToInputRatio();
+		currentStage = &cascadeStage->source;
+	}
+	double groupDelay = 0.0;
+	double followingRatio = 1.0;
+	for (FloatSampleProvider *currentStage = &model; currentStage != &source;) {
+		CascadeStage *cascadeStage = dynamic_cast<CascadeStage *>(currentStage);
+		if (cascadeStage == NULL) break;
+		followingRatio *= cascadeStage->resamplerStage.getOutputToInputRatio();
+		groupDelay += cascadeStage->resamplerStage.getGroupDelay() * followingRatio / overallRatio;
+		currentStage = &cascadeStage->source;
+	}
+	return groupDelay;
+}
+
+size_t ResamplerModel::getMemoryUsage(FloatSampleProvider &model, FloatSampleProvider &source) {
+	size_t memoryUsage = 0;
+	for (FloatSampleProvider *currentStage = &model; currentStage != &source;) {
+		CascadeStage *cascadeStage = dynamic_cast<CascadeStage *>(currentStage);
+		if (cascadeStage == NULL) break;
+		memoryUsage += sizeof(*cascadeStage) + cascadeStage->resamplerStage.getMemoryUsage();
+		currentStage = &cascadeStage->source;
+	}
+	return memoryUsage;
+}
+
+IntSampleProvider &ResamplerModel::createResamplerModel(IntSampleProvider &source, double sourceSampleRate, double targetSampleRate, Quality quality, bool variableRatio) {
+	if (sourceSampleRate == targetSampleRate && !variableRatio) {
+		return source;
+	}
+	if (quality == FASTEST) {
+		return *new InternalFixedPointCascadeStage(source, *createFixedPointLinearResampler(sourceSampleRate, targetSampleRate, variableRatio));
+	}
+	// The passband matches the floating-point model of the same quality. Like the IIR stage there, the filter suppresses
+	// everything above the lower Nyquist frequency, so neither aliasing nor imaging reaches the transition band
+	const bool minimumPhase = quality == LOW_LATENCY;
+	const IIRResampler::Quality iirQuality = minimumPhase ? IIRResampler::BEST : static_cast<IIRResampler::Quality>(quality);
+	const double stopband = 0.5 * (sourceSampleRate < targetSampleRate ? sourceSampleRate : targetSampleRate);
+	const double passband = stopband * IIRResampler::getPassbandFractionForQuality(iirQuality);
+	FixedPointFIRResampler *sincResampler = SincResampler::createFixedPointSincResampler(sourceSampleRate, targetSampleRate, passband, stopband, DEFAULT_DB_SNR, DEFAULT_WINDOWED_SINC_MAX_DOWNSAMPLE_FACTOR, variableRatio, minimumPhase);
+	return *new InternalFixedPointCascadeStage(source, *sincResampler);
+}
+
+IntSampleProvider &ResamplerModel::createResamplerModel(IntSampleProvider &source, FixedPointFIRResampler &resampler) {
+	return *new FixedPointCascadeStage(source, resampler);
+}
+
+void ResamplerModel::freeResamplerModel(IntSampleProvider &model, IntSampleProvider &source) {
+	if (&model == &source) return;
+	FixedPointCascadeStage *cascadeStage = dynamic_cast<FixedPointCascadeStage *>(&model);
+	if (cascadeStage == NULL || &cascadeStage->source != &source) return;
+	delete cascadeStage;
+}
+
+bool ResamplerModel::setRateAdjustment(IntSampleProvider &model, IntSampleProvider &source, double rateAdjustment) {
+	if (&model == &source) return false;
+	FixedPointCascadeStage *cascadeStage = dynamic_cast<FixedPointCascadeStage *>(&model);
+	return cascadeStage != NULL && cascadeStage->resampler.setRateAdjustment(rateAdjustment);
+}
+
+double ResamplerModel::getGroupDelay(IntSampleProvider &model, IntSampleProvider &source) {
+	if (&model == &source) return 0.0;
+	FixedPointCascadeStage *cascadeStage = dynamic_cast<FixedPointCascadeStage *>(&model);
+	return cascadeStage == NULL ? 0.0 : cascadeStage->resampler.getGroupDelay();
+}
+
+size_t ResamplerModel::getMemoryUsage(IntSampleProvider &model, IntSampleProvider &source) {
+	if (&model == &source) return 0;
+	FixedPointCascadeStage *cascadeStage = dynamic_cast<FixedPointCascadeStage *>(&model);
+	return cascadeStage == NULL ? 0 : sizeof(*cascadeStage) + cascadeStage->resampler.getMemoryUsage();
+}
+
 using namespace ResamplerModel;
 
 CascadeStage::CascadeStage(FloatSampleProvider &useSource, ResamplerStage &useResamplerStage) :
@@ -137,9 +289,43 @@ CascadeStage::CascadeStage(FloatSampleProvider &useSource, ResamplerStage &useRe
 {}
 
 void CascadeStage::getOutputSamples(FloatSample *outBuffer, unsigned int length) {
+	while (length > 0) {
+		fillBuffer(length);
+		resamplerStage.process(bufferPtr, size, outBuffer, length);
+	}
+}
+
+// The source is always read interleaved into the internal buffer, only the final stage writes the planar output.
+void CascadeStage::getPlanarOutputSamples(FloatSample *leftBuffer, FloatSample *rightBuffer, unsigned int length) {
+	while (length > 0) {
+		fillBuffer(length);
+		resamplerStage.processPlanar(bufferPtr, size, leftBuffer, rightBuffer, length);
+	}
+}
+
+void CascadeStage::fillBuffer(unsigned int outLength) {
+	if (size > 0) return;
+	size = resamplerStage.estimateInLength(outLength);
+	if (size < 1) {
+		size = 1;
+	} else if (MAX_SAMPLES_PER_RUN < size) {
+		size = MAX_SAMPLES_PER_RUN;
+	}
+	source.getOutputSamples(buffer, size);
+	bufferPtr = buffer;
+}
+
+FixedPointCascadeStage::FixedPointCascadeStage(IntSampleProvider &useSource, FixedPointFIRResampler &useResampler) :
+	resampler(useResampler),
+	source(useSource),
+	bufferPtr(buffer),
+	size()
+{}
+
+void FixedPointCascadeStage::getOutputSamples(IntSample *outBuffer, unsigned int length) {
 	while (length > 0) {
 		if (size == 0) {
-			size = resamplerStage.estimateInLength(length);
+			size = resampler.estimateInLength(length);
 			if (size < 1) {
 				size = 1;
 			} else if (MAX_SAMPLES_PER_RUN < size) {
@@ -148,6 +334,6 @@ void CascadeStage::getOutputSamples(FloatSample *outBuffer, unsigned int length)
 			source.getOutputSamples(buffer, size);
 			bufferPtr = buffer;
 		}
-		resamplerStage.process(bufferPtr, size, outBuffer, length);
+		resampler.process(bufferPtr, size, outBuffer, length);
 	}
 }
@@ -15,11 +15,23 @@
  */
 
 #include <cmath>
+#include <cstddef>
 
 #ifdef SRCTOOLS_SINC_RESAMPLER_DEBUG_LOG
 #include <iostream>
 #endif
 
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <unistd.h>
+#if defined(_POSIX_THREADS) && _POSIX_THREADS > 0
+#define SRCTOOLS_USE_PTHREADS
+#include <pthread.h>
+#endif
+#endif
+
 #include "../include/SincResampler.h"
 
 #ifndef M_PI
@@ -28,6 +40,109 @@ static const double M_PI = 3.1415926535897932;
 
 using namespace SRCTools;
 
+namespace SRCTools {
+
+namespace SincResampler {
+
+// Guards the kernel cache, which is shared by all resamplers in the process.
+class KernelCacheLock {
+public:
+	KernelCacheLock() {
+#if defined(_WIN32)
+		EnterCriticalSection(&criticalSection.handle);
+#elif defined(SRCTOOLS_USE_PTHREADS)
+		pthread_mutex_lock(&mutex);
+#endif
+	}
+
+	~KernelCacheLock() {
+#if defined(_WIN32)
+		LeaveCriticalSection(&criticalSection.handle);
+#elif defined(SRCTOOLS_USE_PTHREADS)
+		pthread_mutex_unlock(&mutex);
+#endif
+	}
+
+private:
+#if defined(_WIN32)
+	static struct CriticalSection {
+		CRITICAL_SECTION handle;
+
+		CriticalSection() {
+			InitializeCriticalSection(&handle);
+		}
+
+		~CriticalSection() {
+			DeleteCriticalSection(&handle);
+		}
+	} criticalSection;
+#elif defined(SRCTOOLS_USE_PTHREADS)
+	static pthread_mutex_t mutex;
+#endif
+};
+
+#if defined(_WIN32)
+KernelCacheLock::CriticalSection KernelCacheLock::criticalSection;
+#elif defined(SRCTOOLS_USE_PTHREADS)
+pthread_mutex_t KernelCacheLock::mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+// Parameters that completely determine the designed kernel.
+struct KernelParameters {
+	double inputFrequency;
+	double outputFrequency;
+	double passbandFrequency;
+	double stopbandFrequency;
+	double dbSNR;
+	unsigned int maxUpsampleFactor;
+	bool variableRatio;
+	bool minimumPhase;
+	// NULL unless a fused kernel is designed
+	const FIRCoefficient *prefilter;
+	unsigned int prefilterLength;
+	unsigned int prefilterUpsampleFactor;
+
+	bool operator==(const KernelParameters &other) const {
+		return inputFrequency == other.inputFrequency && outputFrequency == other.outputFrequency
+			&& passbandFrequency == other.passbandFrequency && stopbandFrequency == other.stopbandFrequency
+			&& dbSNR == other.dbSNR && maxUpsampleFactor == other.maxUpsampleFactor && variableRatio == other.variableRatio
+			&& minimumPhase == other.minimumPhase && prefilter == other.prefilter && prefilterLength == other.prefilterLength
+			&& prefilterUpsampleFactor == other.prefilterUpsampleFactor;
+	}
+};
+
+// A kernel kept in the process-wide cache for as long as any resampler uses it.
+class SharedKernel : public FIRKernel {
+public:
+	static SharedKernel *acquire(const KernelParameters &parameters);
+
+	void release() const;
+
+private:
+	static SharedKernel *cacheHead;
+
+	const KernelParameters parameters;
+	SharedKernel *next;
+	mutable unsigned int referenceCount;
+
+	static SharedKernel *design(const KernelParameters &parameters);
+	static FIRCoefficient *designFused(unsigned int &kernelLength, unsigned int &upsampleFactor, double &downsampleFactor, const KernelParameters &parameters);
+	static SharedKernel *find(const KernelParameters &parameters);
+
+	SharedKernel(const KernelParameters &useParameters, const unsigned int upsampleFactor, const double downsampleFactor, const FIRCoefficient kernel[], const unsigned int kernelLength) :
+		FIRKernel(upsampleFactor, downsampleFactor, kernel, kernelLength, useParameters.variableRatio),
+		parameters(useParameters),
+		next(NULL),
+		referenceCount(1)
+	{}
+};
+
+SharedKernel *SharedKernel::cacheHead = NULL;
+
+} // namespace SincResampler
+
+} // namespace SRCTools
+
 using namespace SincResampler;
 
 using namespace Utils;
@@ -97,6 +212,93 @@ double KaizerWindow::bessel(const double x) {
 	return 1.0 + sum;
 }
 
+// Radix-2 FFT performed in place, the length must be a power of 2. The inverse transform is not normalised.
+static void fft(double re[], double im[], const unsigned int length, const bool inverse) {
+	for (unsigned int i = 1, j = 0; i < length; i++) {
+		unsigned int bit = length >> 1;
+		for (; j & bit; bit >>= 1) j ^= bit;
+		j ^= bit;
+		if (i < j) {
+			double t = re[i]; re[i] = re[j]; re[j] = t;
+			t = im[i]; im[i] = im[j]; im[j] = t;
+		}
+	}
+	for (unsigned int span = 2; span <= length; span <<= 1) {
+		const double angle = (inverse ? 2.0 : -2.0) * M_PI / span;
+		const double stepRe = cos(angle);
+		const double stepIm = sin(angle);
+		for (unsigned int start = 0; start < length; start += span) {
+			double wRe = 1.0;
+			double wIm = 0.0;
+			for (unsigned int i = start; i < start + span / 2; i++) {
+				const unsigned int k = i + span / 2;
+				const double tRe = re[k] * wRe - im[k] * wIm;
+				const double tIm = re[k] * wIm + im[k] * wRe;
+				re[k] = re[i] - tRe;
+				im[k] = im[i] - tIm;
+				re[i] += tRe;
+				im[i] += tIm;
+				const double nextWRe = wRe * stepRe - wIm * stepIm;
+				wIm = wRe * stepIm + wIm * stepRe;
+				wRe = nextWRe;
+			}
+		}
+	}
+}
+
+// Uses the homomorphic method: the real cepstrum of the kernel is folded onto positive quefrencies, which yields
+// the cepstrum of the minimum-phase filter with the same magnitude response. The transform length is made large
+// enough to keep the cepstral aliasing well below the stopband attenuation.
+void MinimumPhase::transformKernel(FIRCoefficient kernel[], const unsigned int kernelLength) {
+	static const unsigned int OVERSAMPLING_FACTOR = 16;
+	// Limits the log magnitude at the zeros of the response, relative to the peak magnitude
+	static const double MIN_MAGNITUDE = 1e-10;
+
+	unsigned int length = 2;
+	while (length < OVERSAMPLING_FACTOR * kernelLength) length <<= 1;
+	double *re = new double[length];
+	double *im = new double[length];
+	for (unsigned int i = 0; i < length; i++) {
+		re[i] = i < kernelLength ? kernel[i] : 0.0;
+		im[i] = 0.0;
+	}
+	fft(re, im, length, false);
+	double maxMagnitude = 0.0;
+	for (unsigned int i = 0; i < length; i++) {
+		re[i] = sqrt(re[i] * re[i] + im[i] * im[i]);
+		if (maxMagnitude < re[i]) maxMagnitude = re[i];
+	}
+	const double minMagnitude = MIN_MAGNITUDE * maxMagnitude;
+	for (unsigned int i = 0; i < length; i++) {
+		re[i] = log(re[i] < minMagnitude ? minMagnitude : re[i]);
+		im[i] = 0.0;
+	}
+	fft(re, im, length, true);
+	const double recipLength = 1.0 / length;
+	for (unsigned int i = 0; i < length; i++) {
+		double factor = 0.0;
+		if (i == 0 || i == length / 2) {
+			factor = recipLength;
+		} else if (i < length / 2) {
+			factor = 2.0 * recipLength;
+		}
+		re[i] *= factor;
+		im[i] = 0.0;
+	}
+	fft(re, im, length, false);
+	for (unsigned int i = 0; i < length; i++) {
+		const double magnitude = exp(re[i]);
+		re[i] = magnitude * cos(im[i]);
+		im[i] = magnitude * sin(im[i]);
+	}
+	fft(re, im, length, true);
+	for (unsigned int i = 0; i < kernelLength; i++) {
+		kernel[i] = FIRCoefficient(re[i] * recipLength);
+	}
+	delete[] re;
+	delete[] im;
+}
+
 void KaizerWindow::windowedSinc(FIRCoefficient kernel[], const unsigned int order, const double fc, const double beta, const double amp) {
 	const double fc_pi = M_PI * fc;
 	const double recipOrder = 1.0 / order;
@@ -112,17 +314,150 @@ void KaizerWindow::windowedSinc(FIRCoefficient kernel[], const unsigned int orde
 	}
 }
 
-ResamplerStage *SincResampler::createSincResampler(const double inputFrequency, const double outputFrequency, const double passbandFrequency, const double stopbandFrequency, const double dbSNR, const unsigned int maxUpsampleFactor) {
+SharedKernel *SharedKernel::find(const KernelParameters &parameters) {
+	for (SharedKernel *kernel = cacheHead; kernel != NULL; kernel = kernel->next) {
+		if (kernel->parameters == parameters) {
+			kernel->referenceCount++;
+			return kernel;
+		}
+	}
+	return NULL;
+}
+
+SharedKernel *SharedKernel::acquire(const KernelParameters &parameters) {
+	{
+		KernelCacheLock lock;
+		SharedKernel *kernel = find(parameters);
+		if (kernel != NULL) return kernel;
+	}
+	// Designing the kernel takes a while, so the lock is not held meanwhile. Instead, we look up the cache once again
+	// to discard a duplicate in the unlikely event that another thread has just cached the same kernel.
+	SharedKernel *newKernel = design(parameters);
+	KernelCacheLock lock;
+	SharedKernel *kernel = find(parameters);
+	if (kernel != NULL) {
+		delete newKernel;
+		return kernel;
+	}
+	newKernel->next = cacheHead;
+	cacheHead = newKernel;
+	return newKernel;
+}
+
+void SharedKernel::release() const {
+	KernelCacheLock lock;
+	if (--referenceCount > 0) return;
+	SharedKernel **link = &cacheHead;
+	while (*link != this) link = &(*link)->next;
+	*link = next;
+	delete this;
+}
+
+SharedKernel *SharedKernel::design(const KernelParameters &parameters) {
+	if (!parameters.variableRatio && !parameters.minimumPhase && parameters.prefilter == NULL) {
+		const PrecomputedKernels::Kernel *precomputedKernel = PrecomputedKernels::find(parameters.inputFrequency, parameters.outputFrequency, parameters.passbandFrequency, parameters.stopbandFrequency, parameters.dbSNR, parameters.maxUpsampleFactor);
+		if (precomputedKernel != NULL) {
+			return new SharedKernel(parameters, precomputedKernel->upsampleFactor, precomputedKernel->downsampleFactor, precomputedKernel->kernel, precomputedKernel->kernelLength);
+		}
+	}
+	unsigned int kernelLength;
 	unsigned int upsampleFactor;
 	double downsampleFactor;
-	computeResampleFactors(upsampleFactor, downsampleFactor, inputFrequency, outputFrequency, maxUpsampleFactor);
+	FIRCoefficient *windowedSincKernel = parameters.prefilter != NULL ? designFused(kernelLength, upsampleFactor, downsampleFactor, parameters)
+		: designWindowedSincKernel(kernelLength, upsampleFactor, downsampleFactor, parameters.inputFrequency, parameters.outputFrequency, parameters.passbandFrequency, parameters.stopbandFrequency, parameters.dbSNR, parameters.maxUpsampleFactor, parameters.variableRatio);
+	if (parameters.minimumPhase) MinimumPhase::transformKernel(windowedSincKernel, kernelLength);
+	SharedKernel *kernel = new SharedKernel(parameters, upsampleFactor, downsampleFactor, windowedSincKernel, kernelLength);
+	delete[] windowedSincKernel;
+	return kernel;
+}
+
+// The fused kernel is the convolution of the prefilter taps, spaced as in the upsampled input signal they apply to,
+// with the continuous windowed sinc, which is sampled at the base sample rate of the resulting polyphase filter.
+// All the points the windowed sinc is needed at lie on the grid of the upsampled input, so it is only evaluated there once.
+FIRCoefficient *SharedKernel::designFused(unsigned int &kernelLength, unsigned int &upsampleFactor, double &downsampleFactor, const KernelParameters &parameters) {
+	if (parameters.variableRatio) {
+		upsampleFactor = parameters.maxUpsampleFactor;
+		downsampleFactor = parameters.maxUpsampleFactor * parameters.inputFrequency / parameters.outputFrequency;
+	} else {
+		computeResampleFactors(upsampleFactor, downsampleFactor, parameters.inputFrequency, parameters.outputFrequency, parameters.maxUpsampleFactor);
+	}
+	double baseSamplePeriod = 1.0 / (parameters.inputFrequency * upsampleFactor);
+	double fp = parameters.passbandFrequency * baseSamplePeriod;
+	double fs = parameters.stopbandFrequency * baseSamplePeriod;
+	double fc = 0.5 * (fp + fs);
+	double beta = KaizerWindow::estimateBeta(parameters.dbSNR);
+	unsigned int order = KaizerWindow::estimateOrder(parameters.dbSNR, fp, fs);
+
+	// Distance between the prefilter taps measured in base sample periods is upsampleFactor / prefilterUpsampleFactor
+	const unsigned int gridFactor = parameters.prefilterUpsampleFactor;
+	kernelLength = order + 1 + (parameters.prefilterLength - 1) * upsampleFactor / gridFactor;
+	if ((parameters.prefilterLength - 1) * upsampleFactor % gridFactor != 0) kernelLength++;
+
+#ifdef SRCTOOLS_SINC_RESAMPLER_DEBUG_LOG
+	std::clog << "Fused FIR: " << upsampleFactor << "/" << downsampleFactor << ", N=" << kernelLength << ", NPh=" << kernelLength / double(upsampleFactor) << ", C=" << 0.5 / fc << ", fp=" << fp << ", fs=" << fs << ", M=" << parameters.maxUpsampleFactor << ", P=" << parameters.prefilterLength << std::endl;
+#endif
+
+	// Grid points are 1 / gridFactor base sample periods apart, the windowed sinc is centred in the grid
+	const unsigned int gridLength = gridFactor * (kernelLength - 1) + upsampleFactor * (parameters.prefilterLength - 1) + 1;
+	const double gridCenter = 0.5 * (gridLength - 1);
+	const double fc_pi = M_PI * fc;
+	const double recipOrder = 1.0 / order;
+	const double mult = 2.0 * fc * upsampleFactor / KaizerWindow::bessel(beta);
+	double *windowedSinc = new double[gridLength];
+	for (unsigned int gridIx = 0; gridIx < gridLength; gridIx++) {
+		// Position relative to the windowed sinc centre, in half base sample periods as in KaizerWindow::windowedSinc()
+		const double i = 2.0 * (gridIx - gridCenter) / gridFactor;
+		if (order < fabs(i)) {
+			windowedSinc[gridIx] = 0.0;
+			continue;
+		}
+		const double xw = i * recipOrder;
+		const double win = KaizerWindow::bessel(beta * sqrt(fabs(1.0 - xw * xw)));
+		const double xs = i * fc_pi;
+		const double sinc = (i == 0) ? 1.0 : sin(xs) / xs;
+		windowedSinc[gridIx] = mult * sinc * win;
+	}
+
+	FIRCoefficient *kernel = new FIRCoefficient[kernelLength];
+	for (unsigned int tapIx = 0; tapIx < kernelLength; tapIx++) {
+		// The last prefilter tap meets the windowed sinc at the earliest grid point
+		const double *tapWindowedSinc = windowedSinc + gridFactor * tapIx + upsampleFactor * (parameters.prefilterLength - 1);
+		double tap = 0.0;
+		for (unsigned int prefilterTapIx = 0; prefilterTapIx < parameters.prefilterLength; prefilterTapIx++) {
+			tap += parameters.prefilter[prefilterTapIx] * *(tapWindowedSinc - upsampleFactor * prefilterTapIx);
+		}
+		kernel[tapIx] = FIRCoefficient(tap);
+	}
+	delete[] windowedSinc;
+	return kernel;
+}
+
+const PrecomputedKernels::Kernel *PrecomputedKernels::find(const double inputFrequency, const double outputFrequency, const double passbandFrequency, const double stopbandFrequency, const double dbSNR, const unsigned int maxUpsampleFactor) {
+	for (unsigned int i = 0; i < KERNEL_COUNT; i++) {
+		const Kernel &kernel = KERNELS[i];
+		if (kernel.inputFrequency == inputFrequency && kernel.outputFrequency == outputFrequency
+			&& kernel.passbandFrequency == passbandFrequency && kernel.stopbandFrequency == stopbandFrequency
+			&& kernel.dbSNR == dbSNR && kernel.maxUpsampleFactor == maxUpsampleFactor) {
+			return &kernel;
+		}
+	}
+	return NULL;
+}
+
+FIRCoefficient *SincResampler::designWindowedSincKernel(unsigned int &kernelLength, unsigned int &upsampleFactor, double &downsampleFactor, const double inputFrequency, const double outputFrequency, const double passbandFrequency, const double stopbandFrequency, const double dbSNR, const unsigned int maxUpsampleFactor, const bool variableRatio) {
+	if (variableRatio) {
+		upsampleFactor = maxUpsampleFactor;
+		downsampleFactor = maxUpsampleFactor * inputFrequency / outputFrequency;
+	} else {
+		computeResampleFactors(upsampleFactor, downsampleFactor, inputFrequency, outputFrequency, maxUpsampleFactor);
+	}
 	double baseSamplePeriod = 1.0 / (inputFrequency * upsampleFactor);
 	double fp = passbandFrequency * baseSamplePeriod;
 	double fs = stopbandFrequency * baseSamplePeriod;
 	double fc = 0.5 * (fp + fs);
 	double beta = KaizerWindow::estimateBeta(dbSNR);
 	unsigned int order = KaizerWindow::estimateOrder(dbSNR, fp, fs);
-	const unsigned int kernelLength = order + 1;
+	kernelLength = order + 1;
 
 #ifdef SRCTOOLS_SINC_RESAMPLER_DEBUG_LOG
 	std::clog << "FIR: " << upsampleFactor << "/" << downsampleFactor << ", N=" << kernelLength << ", NPh=" << kernelLength / double(upsampleFactor) << ", C=" << 0.5 / fc << ", fp=" << fp << ", fs=" << fs << ", M=" << maxUpsampleFactor << std::endl;
@@ -130,7 +465,48 @@ ResamplerStage *SincResampler::createSincResampler(const double inputFrequency,
 
 	FIRCoefficient *windowedSincKernel = new FIRCoefficient[kernelLength];
 	KaizerWindow::windowedSinc(windowedSincKernel, order, fc, beta, upsampleFactor);
-	ResamplerStage *windowedSincStage = new FIRResampler(upsampleFactor, downsampleFactor, windowedSincKernel, kernelLength);
+	return windowedSincKernel;
+}
+
+ResamplerStage *SincResampler::createSincResampler(const double inputFrequency, const double outputFrequency, const double passbandFrequency, const double stopbandFrequency, const double dbSNR, const unsigned int maxUpsampleFactor, const bool variableRatio, const bool minimumPhase) {
+	KernelParameters parameters;
+	parameters.inputFrequency = inputFrequency;
+	parameters.outputFrequency = outputFrequency;
+	parameters.passbandFrequency = passbandFrequency;
+	parameters.stopbandFrequency = stopbandFrequency;
+	parameters.dbSNR = dbSNR;
+	parameters.maxUpsampleFactor = maxUpsampleFactor;
+	parameters.variableRatio = variableRatio;
+	parameters.minimumPhase = minimumPhase;
+	parameters.prefilter = NULL;
+	parameters.prefilterLength = 0;
+	parameters.prefilterUpsampleFactor = 1;
+	return new FIRResampler(*SharedKernel::acquire(parameters));
+}
+
+ResamplerStage *SincResampler::createFusedSincResampler(const double inputFrequency, const double outputFrequency, const double passbandFrequency, const double stopbandFrequency, const double dbSNR, const unsigned int maxUpsampleFactor, const bool variableRatio, const FIRCoefficient prefilter[], const unsigned int prefilterLength, const unsigned int prefilterUpsampleFactor, const bool minimumPhase) {
+	KernelParameters parameters;
+	parameters.inputFrequency = inputFrequency;
+	parameters.outputFrequency = outputFrequency;
+	parameters.passbandFrequency = passbandFrequency;
+	parameters.stopbandFrequency = stopbandFrequency;
+	parameters.dbSNR = dbSNR;
+	parameters.maxUpsampleFactor = maxUpsampleFactor;
+	parameters.variableRatio = variableRatio;
+	parameters.minimumPhase = minimumPhase;
+	parameters.prefilter = prefilter;
+	parameters.prefilterLength = prefilterLength;
+	parameters.prefilterUpsampleFactor = prefilterUpsampleFactor;
+	return new FIRResampler(*SharedKernel::acquire(parameters));
+}
+
+FixedPointFIRResampler *SincResampler::createFixedPointSincResampler(const double inputFrequency, const double outputFrequency, const double passbandFrequency, const double stopbandFrequency, const double dbSNR, const unsigned int maxUpsampleFactor, const bool variableRatio, const bool minimumPhase) {
+	unsigned int kernelLength;
+	unsigned int upsampleFactor;
+	double downsampleFactor;
+	FIRCoefficient *windowedSincKernel = designWindowedSincKernel(kernelLength, upsampleFactor, downsampleFactor, inputFrequency, outputFrequency, passbandFrequency, stopbandFrequency, dbSNR, maxUpsampleFactor, variableRatio);
+	if (minimumPhase) MinimumPhase::transformKernel(windowedSincKernel, kernelLength);
+	FixedPointFIRResampler *resampler = new FixedPointFIRResampler(upsampleFactor, downsampleFactor, windowedSincKernel, kernelLength, variableRatio);
 	delete[] windowedSincKernel;
-	return windowedSincStage;
+	return resampler;
 }
@@ -0,0 +1,137 @@
+/* Copyright (C) 2015-2021 Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Generates src/PrecomputedKernels.cpp that contains the windowed sinc kernels SincResampler designs for the most common
+ * conversions in the default resampler model. It is not a part of the regular build. Whenever the kernel design
+ * or the default resampler model changes, rebuild and run the generator, e.g.:
+ *
+ *   c++ -I.. -o generator tools/PrecomputedKernelsGenerator.cpp \
+ *     src/SincResampler.cpp src/PrecomputedKernels.cpp src/FIRResampler.cpp src/IIR2xResampler.cpp
+ *   ./generator > src/PrecomputedKernels.cpp
+ *
+ * Outdated kernels are harmless, as they simply aren't found, and the design falls back to runtime computation.
+ */
+
+#include <cmath>
+#include <cstdio>
+
+#include "../include/SincResampler.h"
+#include "../include/IIR2xResampler.h"
+#include "../include/ResamplerModel.h"
+
+using namespace SRCTools;
+
+static const double CONVERSIONS[][2] = {
+	{32000, 44100},
+	{32000, 48000},
+	{48000, 44100},
+	// Handled by the IIR stage alone, listed for completeness
+	{48000, 96000}
+};
+static const unsigned int CONVERSION_COUNT = sizeof(CONVERSIONS) / sizeof(CONVERSIONS[0]);
+
+static const char HEADER[] =
+	"/* Copyright (C) 2015-2021 Sergey V. Mikayev\n"
+	" *\n"
+	" *  This program is free software: you can redistribute it and/or modify\n"
+	" *  it under the terms of the GNU Lesser General Public License as published by\n"
+	" *  the Free Software Foundation, either version 2.1 of the License, or\n"
+	" *  (at your option) any later version.\n"
+	" *\n"
+	" *  This program is distributed in the hope that it will be useful,\n"
+	" *  but WITHOUT ANY WARRANTY; without even the implied warranty of\n"
+	" *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the\n"
+	" *  GNU Lesser General Public License for more details.\n"
+	" *\n"
+	" *  You should have received a copy of the GNU Lesser General Public License\n"
+	" *  along with this program.  If not, see <http://www.gnu.org/licenses/>.\n"
+	" */\n"
+	"\n"
+	"// This file is generated by tools/PrecomputedKernelsGenerator.cpp, do not edit.\n"
+	"\n"
+	"#include \"../include/SincResampler.h\"\n"
+	"\n"
+	"using namespace SRCTools;\n"
+	"\n"
+	"using namespace SincResampler;\n";
+
+struct DesignParameters {
+	double inputFrequency;
+	double outputFrequency;
+	double passbandFrequency;
+	double stopbandFrequency;
+	unsigned int maxUpsampleFactor;
+};
+
+// Mirrors ResamplerModel::createResamplerModel(). Returns false if the conversion involves no windowed sinc stage.
+static bool getDesignParameters(DesignParameters &parameters, double sourceSampleRate, double targetSampleRate, ResamplerModel::Quality quality) {
+	if (sourceSampleRate == targetSampleRate || quality == ResamplerModel::FASTEST) return false;
+	const double iirPassbandFraction = IIRResampler::getPassbandFractionForQuality(static_cast<IIRResampler::Quality>(quality));
+	if (sourceSampleRate < targetSampleRate) {
+		if (2.0 * sourceSampleRate == targetSampleRate) return false;
+		parameters.inputFrequency = 2.0 * sourceSampleRate;
+		parameters.outputFrequency = targetSampleRate;
+		parameters.passbandFrequency = 0.5 * sourceSampleRate * iirPassbandFraction;
+		parameters.stopbandFrequency = 1.5 * sourceSampleRate;
+		parameters.maxUpsampleFactor = ResamplerModel::DEFAULT_WINDOWED_SINC_MAX_UPSAMPLE_FACTOR;
+		return true;
+	}
+	if (sourceSampleRate == 2.0 * targetSampleRate) return false;
+	parameters.inputFrequency = sourceSampleRate;
+	parameters.outputFrequency = 2.0 * targetSampleRate;
+	parameters.passbandFrequency = 0.5 * targetSampleRate * iirPassbandFraction;
+	parameters.stopbandFrequency = 1.5 * targetSampleRate;
+	parameters.maxUpsampleFactor = static_cast<unsigned int>(ceil(ResamplerModel::DEFAULT_WINDOWED_SINC_MAX_DOWNSAMPLE_FACTOR * parameters.outputFrequency / sourceSampleRate));
+	return true;
+}
+
+int main() {
+	DesignParameters designs[CONVERSION_COUNT * ResamplerModel::BEST];
+	unsigned int kernelLengths[CONVERSION_COUNT * ResamplerModel::BEST];
+	unsigned int upsampleFactors[CONVERSION_COUNT * ResamplerModel::BEST];
+	double downsampleFactors[CONVERSION_COUNT * ResamplerModel::BEST];
+	unsigned int kernelCount = 0;
+
+	printf("%s", HEADER);
+	for (unsigned int i = 0; i < CONVERSION_COUNT; i++) {
+		for (int quality = ResamplerModel::FAST; quality <= ResamplerModel::BEST; quality++) {
+			DesignParameters &parameters = designs[kernelCount];
+			if (!getDesignParameters(parameters, CONVERSIONS[i][0], CONVERSIONS[i][1], static_cast<ResamplerModel::Quality>(quality))) continue;
+			FIRCoefficient *kernel = SincResampler::designWindowedSincKernel(kernelLengths[kernelCount], upsampleFactors[kernelCount],
+				downsampleFactors[kernelCount], parameters.inputFrequency, parameters.outputFrequency, parameters.passbandFrequency,
+				parameters.stopbandFrequency, ResamplerModel::DEFAULT_DB_SNR, parameters.maxUpsampleFactor, false);
+			printf("\n// %.17g -> %.17g, quality %i\nstatic const FIRCoefficient KERNEL_%u[] = {", CONVERSIONS[i][0], CONVERSIONS[i][1], quality, kernelCount);
+			for (unsigned int tapIx = 0; tapIx < kernelLengths[kernelCount]; tapIx++) {
+				printf("%s%#.9gf", tapIx % 6 == 0 ? "\n\t" : " ", double(kernel[tapIx]));
+				if (tapIx + 1 < kernelLengths[kernelCount]) printf(",");
+			}
+			printf("\n};\n");
+			delete[] kernel;
+			kernelCount++;
+		}
+	}
+
+	printf("\nconst PrecomputedKernels::Kernel PrecomputedKernels::KERNELS[] = {\n");
+	for (unsigned int i = 0; i < kernelCount; i++) {
+		const DesignParameters &parameters = designs[i];
+		printf("\t{%.17g, %.17g, %.17g, %.17g, %.17g, %u, %u, %.17g, %u, KERNEL_%u}%s\n", parameters.inputFrequency, parameters.outputFrequency,
+			parameters.passbandFrequency, parameters.stopbandFrequency, ResamplerModel::DEFAULT_DB_SNR, parameters.maxUpsampleFactor,
+			upsampleFactors[i], downsampleFactors[i], kernelLengths[i], i, i + 1 < kernelCount ? "," : "");
+	}
+	printf("};\n\nconst unsigned int PrecomputedKernels::KERNEL_COUNT = %u;\n", kernelCount);
+	return 0;
+}
@@ -0,0 +1,310 @@
+/* Copyright (C) 2015-2021 Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures the throughput, the group delay and the frequency response of the default resampler model for each quality
+ * and a set of common conversions. It is not a part of the default build, the CMake target srctools-benchmark builds it
+ * from the same sources as the library, e.g.:
+ *
+ *   make srctools-benchmark && ./srctools-benchmark [seconds] > results.csv
+ *
+ * The optional argument specifies the duration of the output rendered to measure the throughput of each conversion,
+ * 10 seconds by default. Both the floating-point and the fixed-point models are measured. The results are printed as CSV,
+ * one line per conversion, so that they can be compared across builds. The columns are:
+ *   arithmetic, quality, input_rate, output_rate - the conversion;
+ *   frames_per_second - the number of stereo frames generated per second of the CPU time;
+ *   realtime_factor - frames_per_second related to the output sample rate;
+ *   reported_delay, measured_delay - the group delay reported by the model and the phase delay measured at 100 Hz,
+ *     both in samples at the output sample rate;
+ *   gain_5, gain_25, gain_45 - the gain in dB of tones at 5%, 25% and 45% of the lower Nyquist frequency;
+ *   residual - the power in dB of everything but the 25% tone in the output, relative to the tone;
+ *   stopband - the output power in dB of a tone halfway between the output and input Nyquist frequencies, which must
+ *     be rejected when decimating; empty when interpolating.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+#include "../include/ResamplerModel.h"
+#include "../include/FixedPointFIRResampler.h"
+
+using namespace SRCTools;
+
+static const double PI = 3.1415926535897932;
+
+static const char * const ARITHMETIC_NAMES[] = {"float", "fixed"};
+static const char * const QUALITY_NAMES[] = {"FASTEST", "FAST", "GOOD", "BEST", "LOW_LATENCY"};
+static const unsigned int QUALITY_COUNT = sizeof(QUALITY_NAMES) / sizeof(QUALITY_NAMES[0]);
+
+static const double CONVERSIONS[][2] = {
+	{32000, 22050},
+	{32000, 44100},
+	{32000, 48000},
+	{32000, 96000},
+	{44100, 48000},
+	{48000, 44100},
+	{96000, 44100}
+};
+static const unsigned int CONVERSION_COUNT = sizeof(CONVERSIONS) / sizeof(CONVERSIONS[0]);
+
+static const unsigned int CHANNEL_COUNT = 2;
+static const unsigned int CHUNK_LENGTH = 1024;
+static const double DEFAULT_THROUGHPUT_SECONDS = 10.0;
+static const double DELAY_MEASUREMENT_FREQUENCY = 100.0;
+
+// Feeds the same block of white noise repeatedly, so that generating the input costs next to nothing.
+class NoiseSource : public FloatSampleProvider, public IntSampleProvider {
+public:
+	NoiseSource() : position(0) {
+		unsigned int seed = 1;
+		for (unsigned int i = 0; i < CHANNEL_COUNT * BLOCK_LENGTH; i++) {
+			seed = seed * 1664525 + 1013904223;
+			block[i] = IntSample(int(seed >> 16) - 0x8000);
+		}
+	}
+
+	void getOutputSamples(FloatSample *outBuffer, unsigned int size) {
+		while (size > 0) {
+			const unsigned int length = nextLength(size);
+			const IntSample *inSamples = block + CHANNEL_COUNT * position;
+			for (unsigned int i = 0; i < CHANNEL_COUNT * length; i++) {
+				*(outBuffer++) = *(inSamples++) / 65536.0f;
+			}
+			advance(length, size);
+		}
+	}
+
+	void getOutputSamples(IntSample *outBuffer, unsigned int size) {
+		while (size > 0) {
+			const unsigned int length = nextLength(size);
+			const IntSample *inSamples = block + CHANNEL_COUNT * position;
+			for (unsigned int i = 0; i < CHANNEL_COUNT * length; i++) {
+				*(outBuffer++) = IntSample(*(inSamples++) >> 1);
+			}
+			advance(length, size);
+		}
+	}
+
+private:
+	static const unsigned int BLOCK_LENGTH = 65536;
+
+	IntSample block[CHANNEL_COUNT * BLOCK_LENGTH];
+	unsigned int position;
+
+	unsigned int nextLength(const unsigned int size) const {
+		return BLOCK_LENGTH - position < size ? BLOCK_LENGTH - position : size;
+	}
+
+	void advance(const unsigned int length, unsigned int &size) {
+		position = (position + length) % BLOCK_LENGTH;
+		size -= length;
+	}
+};
+
+// Generates a sine tone of amplitude 0.5 in the left channel and silence in the right one.
+class ToneSource : public FloatSampleProvider, public IntSampleProvider {
+public:
+	ToneSource(double frequency, double sampleRate) : omega(2.0 * PI * frequency / sampleRate), position(0) {}
+
+	void getOutputSamples(FloatSample *outBuffer, unsigned int size) {
+		while (size-- > 0) {
+			*(outBuffer++) = FloatSample(0.5 * sin(omega * position++));
+			*(outBuffer++) = 0.0f;
+		}
+	}
+
+	void getOutputSamples(IntSample *outBuffer, unsigned int size) {
+		while (size-- > 0) {
+			*(outBuffer++) = IntSample(floor(16384.0 * sin(omega * position++) + 0.5));
+			*(outBuffer++) = 0;
+		}
+	}
+
+private:
+	const double omega;
+	unsigned long position;
+};
+
+struct Conversion {
+	bool fixedPoint;
+	ResamplerModel::Quality quality;
+	double inputRate;
+	double outputRate;
+};
+
+struct ToneResponse {
+	double gain;
+	double delay;
+	double residual;
+};
+
+// Renders one second of a tone through a new resampler model, the fixed-point output is scaled to match the floating-point one.
+static FloatSample *renderTone(double frequency, const Conversion &conversion, unsigned int &length) {
+	ToneSource source(frequency, conversion.inputRate);
+	length = unsigned(conversion.outputRate);
+	FloatSample *buffer = new FloatSample[CHANNEL_COUNT * length];
+	if (conversion.fixedPoint) {
+		IntSampleProvider &intSource = source;
+		IntSampleProvider &model = ResamplerModel::createResamplerModel(intSource, conversion.inputRate, conversion.outputRate, conversion.quality);
+		IntSample *intBuffer = new IntSample[CHANNEL_COUNT * length];
+		model.getOutputSamples(intBuffer, length);
+		ResamplerModel::freeResamplerModel(model, intSource);
+		for (unsigned int i = 0; i < CHANNEL_COUNT * length; i++) {
+			buffer[i] = intBuffer[i] / 32768.0f;
+		}
+		delete[] intBuffer;
+	} else {
+		FloatSampleProvider &floatSource = source;
+		FloatSampleProvider &model = ResamplerModel::createResamplerModel(floatSource, conversion.inputRate, conversion.outputRate, conversion.quality);
+		model.getOutputSamples(buffer, length);
+		ResamplerModel::freeResamplerModel(model, floatSource);
+	}
+	return buffer;
+}
+
+// Fits a sinusoid of the same frequency to the left channel of the output, skipping the initial quarter to let the transient decay.
+static ToneResponse measureTone(double frequency, const Conversion &conversion) {
+	unsigned int length;
+	FloatSample *buffer = renderTone(frequency, conversion, length);
+
+	const double omega = 2.0 * PI * frequency / conversion.outputRate;
+	const unsigned int start = length / 4;
+	double ss = 0, cc = 0, sc = 0, ys = 0, yc = 0;
+	for (unsigned int i = start; i < length; i++) {
+		const double s = sin(omega * i), c = cos(omega * i), y = buffer[CHANNEL_COUNT * i];
+		ss += s * s;
+		cc += c * c;
+		sc += s * c;
+		ys += y * s;
+		yc += y * c;
+	}
+	const double det = ss * cc - sc * sc;
+	const double a = (ys * cc - yc * sc) / det;
+	const double b = (yc * ss - ys * sc) / det;
+	double signalPower = 0, residualPower = 0;
+	for (unsigned int i = start; i < length; i++) {
+		const double fit = a * sin(omega * i) + b * cos(omega * i);
+		const double error = buffer[CHANNEL_COUNT * i] - fit;
+		signalPower += fit * fit;
+		residualPower += error * error;
+	}
+	delete[] buffer;
+
+	// The output approximates 0.5 * gain * sin(omega * (i - delay)) = a * sin(omega * i) + b * cos(omega * i)
+	ToneResponse response;
+	response.gain = 20.0 * log10(2.0 * sqrt(a * a + b * b));
+	response.delay = atan2(-b, a) / omega;
+	response.residual = 10.0 * log10(residualPower / signalPower);
+	return response;
+}
+
+// Returns the output power in dB relative to the power of the input tone.
+static double measureStopband(double frequency, const Conversion &conversion) {
+	unsigned int length;
+	FloatSample *buffer = renderTone(frequency, conversion, length);
+
+	double power = 0;
+	for (unsigned int i = length / 4; i < length; i++) {
+		power += double(buffer[CHANNEL_COUNT * i]) * buffer[CHANNEL_COUNT * i];
+	}
+	delete[] buffer;
+	return 10.0 * log10(power / (length - length / 4) / 0.125);
+}
+
+// Returns the group delay reported by the model in samples at the output sample rate.
+static double getReportedDelay(const Conversion &conversion) {
+	ToneSource source(DELAY_MEASUREMENT_FREQUENCY, conversion.inputRate);
+	double groupDelay;
+	if (conversion.fixedPoint) {
+		IntSampleProvider &intSource = source;
+		IntSampleProvider &model = ResamplerModel::createResamplerModel(intSource, conversion.inputRate, conversion.outputRate, conversion.quality);
+		groupDelay = ResamplerModel::getGroupDelay(model, intSource);
+		ResamplerModel::freeResamplerModel(model, intSource);
+	} else {
+		FloatSampleProvider &floatSource = source;
+		FloatSampleProvider &model = ResamplerModel::createResamplerModel(floatSource, conversion.inputRate, conversion.outputRate, conversion.quality);
+		groupDelay = ResamplerModel::getGroupDelay(model, floatSource);
+		ResamplerModel::freeResamplerModel(model, floatSource);
+	}
+	return groupDelay * conversion.outputRate / conversion.inputRate;
+}
+
+template <class Sample, class Provider>
+static double measureThroughput(Provider &source, const Conversion &conversion, double seconds) {
+	static Sample buffer[CHANNEL_COUNT * CHUNK_LENGTH];
+
+	Provider &model = ResamplerModel::createResamplerModel(source, conversion.inputRate, conversion.outputRate, conversion.quality);
+	const unsigned long chunkCount = static_cast<unsigned long>(ceil(seconds * conversion.outputRate / CHUNK_LENGTH));
+
+	// Warm up caches and let the model fill its internal buffers before the measurement.
+	model.getOutputSamples(buffer, CHUNK_LENGTH);
+	const clock_t startTime = clock();
+	for (unsigned long i = 0; i < chunkCount; i++) {
+		model.getOutputSamples(buffer, CHUNK_LENGTH);
+	}
+	const double elapsed = double(clock() - startTime) / CLOCKS_PER_SEC;
+	ResamplerModel::freeResamplerModel(model, source);
+	return elapsed > 0 ? chunkCount * CHUNK_LENGTH / elapsed : 0;
+}
+
+static double measureThroughput(const Conversion &conversion, double seconds) {
+	NoiseSource *source = new NoiseSource;
+	const double framesPerSecond = conversion.fixedPoint ? measureThroughput<IntSample, IntSampleProvider>(*source, conversion, seconds)
+		: measureThroughput<FloatSample, FloatSampleProvider>(*source, conversion, seconds);
+	delete source;
+	return framesPerSecond;
+}
+
+int main(int argc, char *argv[]) {
+	const double seconds = argc > 1 ? atof(argv[1]) : DEFAULT_THROUGHPUT_SECONDS;
+	if (!(seconds > 0)) {
+		fprintf(stderr, "Usage: %s [seconds]\n", argv[0]);
+		return 1;
+	}
+
+	printf("arithmetic,quality,input_rate,output_rate,frames_per_second,realtime_factor,reported_delay,measured_delay,gain_5,gain_25,gain_45,residual,stopband\n");
+	for (unsigned int arithmeticIx = 0; arithmeticIx < 2; arithmeticIx++) {
+		for (unsigned int qualityIx = 0; qualityIx < QUALITY_COUNT; qualityIx++) {
+			for (unsigned int conversionIx = 0; conversionIx < CONVERSION_COUNT; conversionIx++) {
+				Conversion conversion;
+				conversion.fixedPoint = arithmeticIx != 0;
+				conversion.quality = static_cast<ResamplerModel::Quality>(qualityIx);
+				conversion.inputRate = CONVERSIONS[conversionIx][0];
+				conversion.outputRate = CONVERSIONS[conversionIx][1];
+				const double nyquist = 0.5 * (conversion.inputRate < conversion.outputRate ? conversion.inputRate : conversion.outputRate);
+
+				const double framesPerSecond = measureThroughput(conversion, seconds);
+				const double reportedDelay = getReportedDelay(conversion);
+				const ToneResponse delayResponse = measureTone(DELAY_MEASUREMENT_FREQUENCY, conversion);
+				const ToneResponse response5 = measureTone(0.05 * nyquist, conversion);
+				const ToneResponse response25 = measureTone(0.25 * nyquist, conversion);
+				const ToneResponse response45 = measureTone(0.45 * nyquist, conversion);
+
+				printf("%s,%s,%.0f,%.0f,%.0f,%.2f,%.3f,%.3f,%.4f,%.4f,%.4f,%.1f,", ARITHMETIC_NAMES[arithmeticIx], QUALITY_NAMES[qualityIx],
+					conversion.inputRate, conversion.outputRate, framesPerSecond, framesPerSecond / conversion.outputRate, reportedDelay,
+					delayResponse.delay, response5.gain, response25.gain, response45.gain, response25.residual);
+				if (conversion.outputRate < conversion.inputRate) {
+					printf("%.1f", measureStopband(0.25 * (conversion.inputRate + conversion.outputRate), conversion));
+				}
+				printf("\n");
+				fflush(stdout);
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,460 @@
+/* Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Drives several synth instances concurrently with synthetic MIDI traffic in order to find out how many of them a host
+ * sustains. Each instance renders on its own thread in periods of a fixed length, either paced in real time as an audio
+ * device would request them or as fast as possible. It is not a part of the default build, the CMake target
+ * mt32emu_loadgen builds it, e.g.:
+ *
+ *   make mt32emu_loadgen && ./mt32emu_loadgen --instances 8 --notes 40 --polyphony 24
+ *
+ * Options:
+ *   --roms <control> <pcm>  - renders with the specified ROM images rather than with the built-in synthetic ones;
+ *   --instances <count>     - the number of synth instances, 1 by default;
+ *   --seconds <seconds>     - the duration of the rendered audio, 10 seconds by default;
+ *   --notes <rate>          - the number of note-on messages per second sent to each instance, 20 by default;
+ *   --sysex <rate>          - the number of SysEx messages per second sent to each instance, 0 by default;
+ *   --polyphony <count>     - the maximum number of notes held at once on each instance, the oldest note is released
+ *                             when a new one exceeds it, 16 by default;
+ *   --partials <count>      - the maximum number of partials each synth plays, 32 by default;
+ *   --period <frames>       - the length of a render period at the synth output sample rate, 512 by default;
+ *   --analog <mode>         - the analogue output mode (0 - DIGITAL_ONLY ... 4 - DECIMATED), 1 (COARSE) by default;
+ *   --float                 - uses the float renderer rather than the integer one;
+ *   --fast                  - renders as fast as possible rather than in real time.
+ *
+ * In real time, a period is due one period after it is requested, in the fast mode, the render time alone is compared
+ * with the period length. Whenever a period misses its deadline, the schedule restarts from its completion, as an audio
+ * device does after an underrun. For each instance, the realtime factor, which is the duration of the rendered audio
+ * divided by the time spent rendering, the percentiles of the render latency in milliseconds, the deadline misses,
+ * and the note counts are reported.
+ */
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <time.h>
+#endif
+
+#include "../mt32emu.h"
+#include "SyntheticROMs.h"
+#include "Threads.h"
+
+using namespace MT32Emu;
+
+static const unsigned int MAX_INSTANCE_COUNT = 256;
+static const unsigned int MAX_POLYPHONY = 256;
+static const Bit32u MAX_PERIOD_FRAMES = 16384;
+static const double DEFAULT_SECONDS = 10.0;
+static const double DEFAULT_NOTES_PER_SECOND = 20.0;
+static const unsigned int DEFAULT_POLYPHONY = 16;
+static const Bit32u DEFAULT_PERIOD_FRAMES = 512;
+static const Bit32u MIN_NOTE_DURATION = SAMPLE_RATE / 10;
+static const Bit32u MAX_NOTE_DURATION = SAMPLE_RATE;
+
+struct LoadSettings {
+	const ROMImage *controlROMImage;
+	const ROMImage *pcmROMImage;
+	double seconds;
+	double notesPerSecond;
+	double sysexPerSecond;
+	unsigned int polyphony;
+	Bit32u partialCount;
+	Bit32u periodFrames;
+	AnalogOutputMode analogOutputMode;
+	RendererType rendererType;
+	bool realTime;
+};
+
+#ifdef _WIN32
+
+static double getTime() {
+	static LARGE_INTEGER frequency;
+	if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return double(counter.QuadPart) / double(frequency.QuadPart);
+}
+
+static void sleepUntil(double time) {
+	const double delay = time - getTime();
+	if (delay > 0) Sleep(DWORD(delay * 1000.0));
+}
+
+#else
+
+static double getTime() {
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return double(now.tv_sec) + 1e-9 * double(now.tv_nsec);
+}
+
+static void sleepUntil(double time) {
+	const double delay = time - getTime();
+	if (delay <= 0) return;
+	timespec interval;
+	interval.tv_sec = time_t(delay);
+	interval.tv_nsec = long((delay - double(interval.tv_sec)) * 1e9);
+	nanosleep(&interval, NULL);
+}
+
+#endif
+
+// Keeps the console quiet, the synth reports each program change and SysEx otherwise.
+class SilentReportHandler : public ReportHandler {
+public:
+	void printDebug(const char *, va_list) {}
+};
+
+struct HeldNote {
+	Bit8u channel;
+	Bit8u key;
+	Bit32u releaseTimestamp;
+};
+
+// A synth instance along with the MIDI traffic generator that feeds it, the timestamps are in samples
+// at the internal sample rate.
+class Instance {
+public:
+	Instance(unsigned int index, const LoadSettings &useSettings) :
+		settings(useSettings),
+		synth(&reportHandler),
+		random(1 + index),
+		heldNoteCount(0),
+		nextNoteTimestamp(0),
+		nextSysexTimestamp(0),
+		periodCount(0),
+		latencies(NULL),
+		renderTime(0),
+		deadlineMissCount(0)
+	{}
+
+	~Instance() {
+		delete[] latencies;
+	}
+
+	bool open() {
+		synth.selectRendererType(settings.rendererType);
+		if (!synth.open(*settings.controlROMImage, *settings.pcmROMImage, settings.partialCount, settings.analogOutputMode)) return false;
+		nextNoteTimestamp = nextInterval(settings.notesPerSecond);
+		nextSysexTimestamp = nextInterval(settings.sysexPerSecond);
+		return true;
+	}
+
+	void run() {
+		const Bit32u outputSampleRate = synth.getStereoOutputSampleRate();
+		const double periodDuration = double(settings.periodFrames) / outputSampleRate;
+		const Bit32u periodSamples = Bit32u(double(settings.periodFrames) * SAMPLE_RATE / outputSampleRate);
+		periodCount = Bit32u(settings.seconds / periodDuration);
+		latencies = new double[periodCount];
+		float *buffer = new float[2 * settings.periodFrames];
+
+		double scheduleStart = getTime();
+		for (Bit32u periodIx = 0; periodIx < periodCount; periodIx++) {
+			const double requestTime = scheduleStart + periodIx * periodDuration;
+			if (settings.realTime) sleepUntil(requestTime);
+			const double renderStart = getTime();
+			const Bit32u periodStartTimestamp = synth.getInternalRenderedSampleCount();
+			playEvents(periodStartTimestamp, periodStartTimestamp + periodSamples);
+			synth.render(buffer, settings.periodFrames);
+			const double renderEnd = getTime();
+			renderTime += renderEnd - renderStart;
+			const double latency = renderEnd - (settings.realTime ? requestTime : renderStart);
+			latencies[periodIx] = latency;
+			if (latency > periodDuration) {
+				deadlineMissCount++;
+				scheduleStart = renderEnd - (periodIx + 1) * periodDuration;
+			}
+		}
+		delete[] buffer;
+		qsort(latencies, periodCount, sizeof(double), compareLatencies);
+	}
+
+	double getRealtimeFactor() const {
+		return renderTime > 0 ? periodCount * double(settings.periodFrames) / synth.getStereoOutputSampleRate() / renderTime : 0;
+	}
+
+	// Returns the latency not exceeded by the specified fraction of the periods, in milliseconds.
+	double getLatencyPercentile(double fraction) const {
+		if (periodCount == 0) return 0;
+		Bit32u ix = Bit32u(fraction * periodCount);
+		if (ix >= periodCount) ix = periodCount - 1;
+		return 1000.0 * latencies[ix];
+	}
+
+	Bit32u getPeriodCount() const {
+		return periodCount;
+	}
+
+	Bit32u getDeadlineMissCount() const {
+		return deadlineMissCount;
+	}
+
+	bool getPolyphonyStats(PolyphonyStats &stats) const {
+		return synth.getPolyphonyStats(stats);
+	}
+
+private:
+	const LoadSettings &settings;
+	SilentReportHandler reportHandler;
+	Synth synth;
+	Random random;
+	HeldNote heldNotes[MAX_POLYPHONY];
+	unsigned int heldNoteCount;
+	Bit32u nextNoteTimestamp;
+	Bit32u nextSysexTimestamp;
+	Bit32u periodCount;
+	double *latencies;
+	double renderTime;
+	Bit32u deadlineMissCount;
+
+	static int compareLatencies(const void *a, const void *b) {
+		const double latencyA = *static_cast<const double *>(a);
+		const double latencyB = *static_cast<const double *>(b);
+		return latencyA < latencyB ? -1 : latencyB < latencyA ? 1 : 0;
+	}
+
+	// Returns a random interval between events that averages to the specified rate, or 0 if the rate is 0.
+	Bit32u nextInterval(double eventsPerSecond) {
+		if (!(eventsPerSecond > 0)) return 0;
+		const Bit32u meanInterval = Bit32u(SAMPLE_RATE / eventsPerSecond);
+		return 1 + random.next(2 * meanInterval);
+	}
+
+	// Plays the events due before the end of the period in chronological order.
+	void playEvents(Bit32u periodStartTimestamp, Bit32u periodEndTimestamp) {
+		for (;;) {
+			unsigned int heldNoteIx = findEarliestRelease();
+			Bit32u timestamp = periodEndTimestamp;
+			if (heldNoteIx < heldNoteCount) timestamp = heldNotes[heldNoteIx].releaseTimestamp;
+			const bool sendNote = settings.notesPerSecond > 0 && isBefore(nextNoteTimestamp, timestamp);
+			if (sendNote) timestamp = nextNoteTimestamp;
+			const bool sendSysex = settings.sysexPerSecond > 0 && isBefore(nextSysexTimestamp, timestamp);
+			if (sendSysex) timestamp = nextSysexTimestamp;
+			if (!isBefore(timestamp, periodEndTimestamp)) break;
+			if (isBefore(timestamp, periodStartTimestamp)) timestamp = periodStartTimestamp;
+
+			if (sendSysex) {
+				playSysex(timestamp);
+				nextSysexTimestamp += nextInterval(settings.sysexPerSecond);
+			} else if (sendNote) {
+				// The held notes are kept in the order of the note-on messages, so the oldest one goes first.
+				if (heldNoteCount == settings.polyphony) releaseNote(0, timestamp);
+				playNote(timestamp);
+				nextNoteTimestamp += nextInterval(settings.notesPerSecond);
+			} else {
+				releaseNote(heldNoteIx, timestamp);
+			}
+		}
+	}
+
+	static bool isBefore(Bit32u timestamp, Bit32u otherTimestamp) {
+		return Bit32s(timestamp - otherTimestamp) < 0;
+	}
+
+	unsigned int findEarliestRelease() const {
+		unsigned int earliestIx = heldNoteCount;
+		for (unsigned int i = 0; i < heldNoteCount; i++) {
+			if (earliestIx == heldNoteCount || isBefore(heldNotes[i].releaseTimestamp, heldNotes[earliestIx].releaseTimestamp)) {
+				earliestIx = i;
+			}
+		}
+		return earliestIx;
+	}
+
+	// Notes on the melodic channels 2-9 mostly, every fourth goes to the rhythm channel.
+	void playNote(Bit32u timestamp) {
+		HeldNote &note = heldNotes[heldNoteCount++];
+		note.channel = Bit8u(random.next(3) == 0 ? 9 : 1 + random.next(7));
+		note.key = Bit8u(note.channel == 9 ? 35 + random.next(46) : 36 + random.next(48));
+		note.releaseTimestamp = timestamp + MIN_NOTE_DURATION + random.next(MAX_NOTE_DURATION - MIN_NOTE_DURATION);
+		const Bit32u velocity = 64 + random.next(63);
+		synth.playMsg(0x90 | note.channel | (note.key << 8) | (velocity << 16), timestamp);
+	}
+
+	void releaseNote(unsigned int heldNoteIx, Bit32u timestamp) {
+		const HeldNote &note = heldNotes[heldNoteIx];
+		synth.playMsg(0x80 | note.channel | (note.key << 8) | (64 << 16), timestamp);
+		memmove(&heldNotes[heldNoteIx], &heldNotes[heldNoteIx + 1], (--heldNoteCount - heldNoteIx) * sizeof(HeldNote));
+	}
+
+	// Changes a parameter of the timbre of part 1, which keeps the synth busy refreshing the affected partials.
+	void playSysex(Bit32u timestamp) {
+		Bit8u sysex[] = {0xF0, 0x41, 0x10, 0x16, 0x12, 0x04, 0x00, Bit8u(random.next(0x75)), Bit8u(random.next(3)), 0, 0xF7};
+		Bit32u checksum = 0;
+		for (Bit32u i = 5; i < 9; i++) {
+			checksum += sysex[i];
+		}
+		sysex[9] = Bit8u((128 - (checksum & 0x7F)) & 0x7F);
+		synth.playSysex(sysex, sizeof(sysex), timestamp);
+	}
+};
+
+static void runInstance(void *instance) {
+	static_cast<Instance *>(instance)->run();
+}
+
+// Runs each instance on a thread of its own and waits for all of them to finish.
+static bool runInstances(Instance **instances, unsigned int instanceCount) {
+	Thread threads[MAX_INSTANCE_COUNT];
+	for (unsigned int i = 0; i < instanceCount; i++) {
+		if (!threads[i].start(runInstance, instances[i])) return false;
+	}
+	for (unsigned int i = 0; i < instanceCount; i++) {
+		threads[i].join();
+	}
+	return true;
+}
+
+static void printResults(Instance **instances, unsigned int instanceCount) {
+	printf("%8s %9s %8s %8s %8s %8s %15s %8s %8s %9s\n", "instance", "realtime", "p50 ms", "p99 ms", "p99.9 ms", "max ms",
+		"misses/periods", "notes", "dropped", "partials");
+	double minRealtimeFactor = 0;
+	double maxLatency = 0;
+	Bit32u totalDeadlineMissCount = 0;
+	Bit32u totalPeriodCount = 0;
+	for (unsigned int i = 0; i < instanceCount; i++) {
+		const Instance &instance = *instances[i];
+		PolyphonyStats stats;
+		if (!instance.getPolyphonyStats(stats)) memset(&stats, 0, sizeof(stats));
+		char misses[32];
+		sprintf(misses, "%u/%u", instance.getDeadlineMissCount(), instance.getPeriodCount());
+		printf("%8u %9.2f %8.3f %8.3f %8.3f %8.3f %15s %8u %8u %9u\n", i + 1, instance.getRealtimeFactor(),
+			instance.getLatencyPercentile(0.5), instance.getLatencyPercentile(0.99), instance.getLatencyPercentile(0.999),
+			instance.getLatencyPercentile(1.0), misses, stats.noteOnCount, stats.droppedNoteCount, stats.peakPartialCount);
+		if (i == 0 || instance.getRealtimeFactor() < minRealtimeFactor) minRealtimeFactor = instance.getRealtimeFactor();
+		if (maxLatency < instance.getLatencyPercentile(1.0)) maxLatency = instance.getLatencyPercentile(1.0);
+		totalDeadlineMissCount += instance.getDeadlineMissCount();
+		totalPeriodCount += instance.getPeriodCount();
+	}
+	printf("%u instances: minimum realtime factor %.2f, maximum latency %.3f ms, %u of %u periods missed the deadline\n",
+		instanceCount, minRealtimeFactor, maxLatency, totalDeadlineMissCount, totalPeriodCount);
+}
+
+static int printUsage(const char *programName) {
+	fprintf(stderr, "Usage: %s [--roms <control> <pcm>] [--instances <count>] [--seconds <seconds>] [--notes <rate>] [--sysex <rate>]\n"
+		"  [--polyphony <count>] [--partials <count>] [--period <frames>] [--analog <mode>] [--float] [--fast]\n", programName);
+	return 1;
+}
+
+int main(int argc, char *argv[]) {
+	const char *controlROMFileName = NULL;
+	const char *pcmROMFileName = NULL;
+	unsigned int instanceCount = 1;
+	LoadSettings settings;
+	settings.seconds = DEFAULT_SECONDS;
+	settings.notesPerSecond = DEFAULT_NOTES_PER_SECOND;
+	settings.sysexPerSecond = 0;
+	settings.polyphony = DEFAULT_POLYPHONY;
+	settings.partialCount = DEFAULT_MAX_PARTIALS;
+	settings.periodFrames = DEFAULT_PERIOD_FRAMES;
+	settings.analogOutputMode = AnalogOutputMode_COARSE;
+	settings.rendererType = RendererType_BIT16S;
+	settings.realTime = true;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--roms") == 0 && i + 2 < argc) {
+			controlROMFileName = argv[++i];
+			pcmROMFileName = argv[++i];
+		} else if (strcmp(argv[i], "--instances") == 0 && i + 1 < argc) {
+			instanceCount = unsigned(atoi(argv[++i]));
+			if (instanceCount < 1 || MAX_INSTANCE_COUNT < instanceCount) return printUsage(argv[0]);
+		} else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+			settings.seconds = atof(argv[++i]);
+			if (!(settings.seconds > 0)) return printUsage(argv[0]);
+		} else if (strcmp(argv[i], "--notes") == 0 && i + 1 < argc) {
+			settings.notesPerSecond = atof(argv[++i]);
+			if (!(settings.notesPerSecond >= 0)) return printUsage(argv[0]);
+		} else if (strcmp(argv[i], "--sysex") == 0 && i + 1 < argc) {
+			settings.sysexPerSecond = atof(argv[++i]);
+			if (!(settings.sysexPerSecond >= 0)) return printUsage(argv[0]);
+		} else if (strcmp(argv[i], "--polyphony") == 0 && i + 1 < argc) {
+			settings.polyphony = unsigned(atoi(argv[++i]));
+			if (settings.polyphony < 1 || MAX_POLYPHONY < settings.polyphony) return printUsage(argv[0]);
+		} else if (strcmp(argv[i], "--partials") == 0 && i + 1 < argc) {
+			settings.partialCount = Bit32u(atoi(argv[++i]));
+			if (settings.partialCount < 8) return printUsage(argv[0]);
+		} else if (strcmp(argv[i], "--period") == 0 && i + 1 < argc) {
+			settings.periodFrames = Bit32u(atoi(argv[++i]));
+			if (settings.periodFrames < 1 || MAX_PERIOD_FRAMES < settings.periodFrames) return printUsage(argv[0]);
+		} else if (strcmp(argv[i], "--analog") == 0 && i + 1 < argc) {
+			const int mode = atoi(argv[++i]);
+			if (mode < AnalogOutputMode_DIGITAL_ONLY || AnalogOutputMode_DECIMATED < mode) return printUsage(argv[0]);
+			settings.analogOutputMode = AnalogOutputMode(mode);
+		} else if (strcmp(argv[i], "--float") == 0) {
+			settings.rendererType = RendererType_FLOAT;
+		} else if (strcmp(argv[i], "--fast") == 0) {
+			settings.realTime = false;
+		} else {
+			return printUsage(argv[0]);
+		}
+	}
+
+	FileStream controlROMFile;
+	FileStream pcmROMFile;
+	SyntheticROMs *syntheticROMs = NULL;
+	if (controlROMFileName != NULL) {
+		if (!controlROMFile.open(controlROMFileName) || !pcmROMFile.open(pcmROMFileName)) {
+			fprintf(stderr, "Failed to open ROM files\n");
+			return 1;
+		}
+		settings.controlROMImage = ROMImage::makeROMImage(&controlROMFile);
+		settings.pcmROMImage = ROMImage::makeROMImage(&pcmROMFile);
+	} else {
+		syntheticROMs = new SyntheticROMs;
+		settings.controlROMImage = syntheticROMs->makeControlROMImage();
+		settings.pcmROMImage = syntheticROMs->makePCMROMImage();
+	}
+	if (settings.controlROMImage == NULL || settings.controlROMImage->getROMInfo() == NULL
+		|| settings.pcmROMImage == NULL || settings.pcmROMImage->getROMInfo() == NULL) {
+		fprintf(stderr, "Unrecognised ROM images\n");
+		return 1;
+	}
+
+	int exitCode = 0;
+	Instance *instances[MAX_INSTANCE_COUNT];
+	unsigned int openedCount = 0;
+	while (openedCount < instanceCount) {
+		instances[openedCount] = new Instance(openedCount, settings);
+		if (!instances[openedCount++]->open()) {
+			fprintf(stderr, "Failed to open synth instance %u\n", openedCount);
+			exitCode = 1;
+			break;
+		}
+	}
+	if (exitCode == 0) {
+		printf("Rendering %.1f seconds on %u instances %s, %.1f notes and %.1f SysEx messages per second, polyphony %u\n",
+			settings.seconds, instanceCount, settings.realTime ? "in real time" : "as fast as possible",
+			settings.notesPerSecond, settings.sysexPerSecond, settings.polyphony);
+		fflush(stdout);
+		if (runInstances(instances, instanceCount)) {
+			printResults(instances, instanceCount);
+		} else {
+			fprintf(stderr, "Failed to start rendering threads\n");
+			exitCode = 1;
+		}
+	}
+
+	for (unsigned int i = 0; i < openedCount; i++) {
+		delete instances[i];
+	}
+	ROMImage::freeROMImage(settings.controlROMImage);
+	ROMImage::freeROMImage(settings.pcmROMImage);
+	delete syntheticROMs;
+	return exitCode;
+}
@@ -0,0 +1,711 @@
+/* Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures the throughput of the hot paths of the library in isolation: the wave generators, the amplitude ramp,
+ * the reverb models, the analogue circuit models, the rendering kernels, the resamplers, the MIDI event queue
+ * and the MIDI stream parser. The inputs are synthetic, so no ROM images are needed. It is not a part of the default
+ * build, the CMake target mt32emu_bench builds it from the same sources as the library, e.g.:
+ *
+ *   make mt32emu_bench && ./mt32emu_bench [--json results.json] [--filter Reverb] [seconds]
+ *
+ * The optional argument specifies the CPU time spent measuring each case, 0.5 seconds by default. The option --filter
+ * restricts the run to the cases which names contain the specified string. The results are printed as a table with
+ * the CPU time in nanoseconds per processed unit, which is a sample of a mono stream, a frame of a stereo stream or
+ * a MIDI event depending on the case. With the option --json, a summary is also written to the specified file
+ * ("-" for the standard output), so that the results may be compared across builds to track regressions.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include "../internals.h"
+
+#include "../Analog.h"
+#include "../BReverbModel.h"
+#include "../Kernels.h"
+#include "../LA32FloatWaveGenerator.h"
+#include "../LA32Ramp.h"
+#include "../LA32WaveGenerator.h"
+#include "../MidiEventQueue.h"
+#include "../MidiStreamParser.h"
+#include "../Synth.h"
+
+#if MT32EMU_WITH_INTERNAL_RESAMPLER
+#include "../srchelper/srctools/include/ResamplerModel.h"
+#endif
+
+using namespace MT32Emu;
+
+static const Bit32u BLOCK_LENGTH = 1024;
+static const double DEFAULT_SECONDS = 0.5;
+static const unsigned int MAX_RESULT_COUNT = 128;
+
+static const char * const UNIT_SAMPLE = "sample";
+static const char * const UNIT_FRAME = "frame";
+static const char * const UNIT_EVENT = "event";
+
+// Deterministic pseudo-random numbers, so that each run processes the same inputs.
+static Bit32u nextRandom(Bit32u &seed) {
+	seed = seed * 1664525 + 1013904223;
+	return seed >> 8;
+}
+
+// A processing step repeated over and over while measuring.
+class Benchmark {
+public:
+	virtual ~Benchmark() {}
+	// Processes the next block of input and returns the number of units processed.
+	virtual Bit32u run() = 0;
+};
+
+struct Result {
+	char name[64];
+	const char *unit;
+	double units;
+	double nsPerUnit;
+};
+
+class Runner {
+public:
+	Runner(double useSeconds, const char *useFilter) : seconds(useSeconds), filter(useFilter), resultCount(0) {}
+
+	bool isSelected(const char *name) const {
+		return filter == NULL || strstr(name, filter) != NULL;
+	}
+
+	// Runs the benchmark until it consumes the configured CPU time, the first block doesn't count to warm up the caches.
+	void measure(const char *name, const char *unit, Benchmark &benchmark) {
+		if (!isSelected(name) || resultCount == MAX_RESULT_COUNT) return;
+		benchmark.run();
+		const clock_t minClocks = clock_t(seconds * CLOCKS_PER_SEC);
+		const clock_t startTime = clock();
+		clock_t elapsed;
+		double units = 0;
+		do {
+			units += benchmark.run();
+			elapsed = clock() - startTime;
+		} while (elapsed < minClocks);
+
+		Result &result = results[resultCount++];
+		size_t nameLength = strlen(name);
+		if (nameLength >= sizeof(result.name)) nameLength = sizeof(result.name) - 1;
+		memcpy(result.name, name, nameLength);
+		result.name[nameLength] = 0;
+		result.unit = unit;
+		result.units = units;
+		result.nsPerUnit = 1e9 * elapsed / CLOCKS_PER_SEC / units;
+		printf("%-52s %12.3f ns/%s\n", result.name, result.nsPerUnit, unit);
+		fflush(stdout);
+	}
+
+	void writeJSON(FILE *file) const {
+		fprintf(file, "{\n");
+		fprintf(file, "  \"library_version\": \"%s\",\n", Synth::getLibraryVersionString());
+		fprintf(file, "  \"supported_cpu_features\": %u,\n", Kernels::getSupportedCPUFeatures());
+		fprintf(file, "  \"seconds_per_benchmark\": %g,\n", seconds);
+		fprintf(file, "  \"results\": [");
+		for (unsigned int i = 0; i < resultCount; i++) {
+			const Result &result = results[i];
+			fprintf(file, "%s\n    {\"name\": \"%s\", \"unit\": \"%s\", \"units\": %.0f, \"ns_per_sample\": %.4f}",
+				i == 0 ? "" : ",", result.name, result.unit, result.units, result.nsPerUnit);
+		}
+		fprintf(file, "\n  ]\n}\n");
+	}
+
+private:
+	const double seconds;
+	const char * const filter;
+	Result results[MAX_RESULT_COUNT];
+	unsigned int resultCount;
+};
+
+// Control inputs of a wave generator resembling a note with a moderately moving envelope, pitch and cutoff.
+struct WaveGeneratorInputs {
+	static const Bit32u PCM_WAVE_LENGTH = 1 << 14;
+
+	Bit32u amps[BLOCK_LENGTH];
+	Bit16u pitches[BLOCK_LENGTH];
+	Bit32u cutoffs[BLOCK_LENGTH];
+	// Followed by the guard sample the interpolation of a looped wave needs.
+	Bit16s pcmWave[PCM_WAVE_LENGTH + 1];
+	// The same wave converted to linear amplitudes, as the float wave generator reads it.
+	float linearPCMWave[PCM_WAVE_LENGTH + 1];
+
+	WaveGeneratorInputs() {
+		for (Bit32u i = 0; i < BLOCK_LENGTH; i++) {
+			amps[i] = ((i >> 4) & 0x3F) << 18;
+			pitches[i] = Bit16u(0x6000 + ((i >> 2) & 0x7FF));
+			cutoffs[i] = (0x60 + ((i >> 3) & 0x7F)) << 18;
+		}
+		Bit32u seed = 1;
+		for (Bit32u i = 0; i < PCM_WAVE_LENGTH; i++) {
+			pcmWave[i] = Bit16s(nextRandom(seed));
+		}
+		pcmWave[PCM_WAVE_LENGTH] = pcmWave[0];
+		for (Bit32u i = 0; i <= PCM_WAVE_LENGTH; i++) {
+			linearPCMWave[i] = LA32FloatWaveGenerator::getLinearPCMSample(pcmWave[i]);
+		}
+	}
+};
+
+enum WaveKind {
+	WAVE_SQUARE,
+	WAVE_SQUARE_RESONANT,
+	WAVE_SAWTOOTH_RESONANT,
+	WAVE_PCM,
+	WAVE_PCM_INTERPOLATED,
+	WAVE_KIND_COUNT
+};
+
+static const char * const WAVE_KIND_NAMES[] = {"square", "square_resonant", "sawtooth_resonant", "pcm", "pcm_interpolated"};
+
+// Each wave generator reads the PCM wave in the representation of its own.
+static void initPCMWave(LA32WaveGenerator &waveGenerator, const WaveGeneratorInputs &inputs, bool interpolated) {
+	waveGenerator.initPCM(inputs.pcmWave, WaveGeneratorInputs::PCM_WAVE_LENGTH, true, interpolated);
+}
+
+static void initPCMWave(LA32FloatWaveGenerator &waveGenerator, const WaveGeneratorInputs &inputs, bool interpolated) {
+	// The samples are produced with the kernels a synth selects for this CPU.
+	static Kernels kernels;
+	kernels.select(~Bit32u(0));
+	waveGenerator.setKernels(&kernels);
+	waveGenerator.initPCM(inputs.linearPCMWave, WaveGeneratorInputs::PCM_WAVE_LENGTH, true, interpolated);
+}
+
+template <class WaveGenerator, class Sample>
+class WaveGeneratorBenchmark : public Benchmark {
+public:
+	WaveGeneratorBenchmark(const WaveGeneratorInputs &useInputs, WaveKind useKind) : inputs(useInputs), kind(useKind) {
+		init();
+	}
+
+	Bit32u run() {
+		if (!waveGenerator.isActive()) init();
+		waveGenerator.generateSamples(BLOCK_LENGTH, inputs.amps, inputs.pitches, inputs.cutoffs, outputs);
+		return BLOCK_LENGTH;
+	}
+
+private:
+	const WaveGeneratorInputs &inputs;
+	const WaveKind kind;
+	WaveGenerator waveGenerator;
+	Sample outputs[BLOCK_LENGTH];
+
+	void init() {
+		switch (kind) {
+		case WAVE_SQUARE:
+			waveGenerator.initSynth(false, 0, 0);
+			break;
+		case WAVE_SQUARE_RESONANT:
+			waveGenerator.initSynth(false, 64, 24);
+			break;
+		case WAVE_SAWTOOTH_RESONANT:
+			waveGenerator.initSynth(true, 32, 24);
+			break;
+		case WAVE_PCM:
+		case WAVE_PCM_INTERPOLATED:
+			initPCMWave(waveGenerator, inputs, kind == WAVE_PCM_INTERPOLATED);
+			break;
+		default:
+			break;
+		}
+	}
+};
+
+// Keeps the ramp moving up and down between two targets, as a TVA does while in the attack and the decay phases.
+class RampBenchmark : public Benchmark {
+public:
+	RampBenchmark() : rising(true) {
+		ramp.startRamp(0xC0, 0x30);
+	}
+
+	Bit32u run() {
+		if (ramp.checkInterrupt()) {
+			rising = !rising;
+			ramp.startRamp(rising ? 0xC0 : 0x20, rising ? 0x30 : 0xB0);
+		}
+		ramp.advance(BLOCK_LENGTH, values);
+		return BLOCK_LENGTH;
+	}
+
+private:
+	LA32Ramp ramp;
+	bool rising;
+	Bit32u values[BLOCK_LENGTH];
+};
+
+// Stereo noise, scaled down to leave headroom like the mixed output of a few partials.
+static void fillNoise(IntSample *left, IntSample *right, Bit32u length) {
+	Bit32u seed = 1;
+	for (Bit32u i = 0; i < length; i++) {
+		left[i] = IntSample(Bit16s(nextRandom(seed)) >> 2);
+		right[i] = IntSample(Bit16s(nextRandom(seed)) >> 2);
+	}
+}
+
+static void fillNoise(FloatSample *left, FloatSample *right, Bit32u length) {
+	Bit32u seed = 1;
+	for (Bit32u i = 0; i < length; i++) {
+		left[i] = Bit16s(nextRandom(seed)) / 131072.0f;
+		right[i] = Bit16s(nextRandom(seed)) / 131072.0f;
+	}
+}
+
+template <class Sample>
+class ReverbBenchmark : public Benchmark {
+public:
+	ReverbBenchmark(ReverbMode mode, RendererType rendererType) : model(BReverbModel::createBReverbModel(mode, true, rendererType)) {
+		model->open();
+		model->setParameters(5, 5);
+		fillNoise(inLeft, inRight, BLOCK_LENGTH);
+	}
+
+	~ReverbBenchmark() {
+		delete model;
+	}
+
+	Bit32u run() {
+		model->process(inLeft, inRight, outLeft, outRight, BLOCK_LENGTH);
+		return BLOCK_LENGTH;
+	}
+
+private:
+	BReverbModel * const model;
+	Sample inLeft[BLOCK_LENGTH];
+	Sample inRight[BLOCK_LENGTH];
+	Sample outLeft[BLOCK_LENGTH];
+	Sample outRight[BLOCK_LENGTH];
+};
+
+// Measures the time per output frame, the DAC streams are shorter when the analogue model upsamples.
+template <class Sample>
+class AnalogBenchmark : public Benchmark {
+public:
+	AnalogBenchmark(AnalogOutputMode mode, RendererType rendererType) : analog(Analog::createAnalog(mode, false, rendererType)) {
+		analog->setSynthOutputGain(1.0f);
+		analog->setReverbOutputGain(1.0f, false);
+		fillNoise(nonReverbLeft, nonReverbRight, DAC_STREAM_LENGTH);
+		fillNoise(reverbLeft, reverbRight, DAC_STREAM_LENGTH);
+	}
+
+	~AnalogBenchmark() {
+		delete analog;
+	}
+
+	Bit32u run() {
+		analog->process(outStream, nonReverbLeft, nonReverbRight, reverbLeft, reverbRight, reverbRight, reverbLeft, BLOCK_LENGTH);
+		return BLOCK_LENGTH;
+	}
+
+private:
+	// Even the playback at the DAC sample rate consumes no more than the output length, a bit of slack is for rounding.
+	static const Bit32u DAC_STREAM_LENGTH = BLOCK_LENGTH + 16;
+
+	Analog * const analog;
+	Sample nonReverbLeft[DAC_STREAM_LENGTH];
+	Sample nonReverbRight[DAC_STREAM_LENGTH];
+	Sample reverbLeft[DAC_STREAM_LENGTH];
+	Sample reverbRight[DAC_STREAM_LENGTH];
+	Sample outStream[2 * BLOCK_LENGTH];
+};
+
+enum KernelCase {
+	KERNEL_CASE_CONVERT_FLOAT_TO_INT,
+	KERNEL_CASE_CONVERT_INT_TO_FLOAT,
+	KERNEL_CASE_PAN_AND_MIX_FLOAT,
+	KERNEL_CASE_DOUBLE_AND_WRAP_FLOAT,
+	KERNEL_CASE_CONVERT_FLOAT_TO_INT_DITHERED,
+	KERNEL_CASE_GENERATE_PCM_FLOAT
+};
+
+class KernelBenchmark : public Benchmark {
+public:
+	KernelBenchmark(const Kernels &useKernels, KernelCase useKernelCase) : kernels(useKernels), kernelCase(useKernelCase) {
+		fillNoise(floatSamples, floatLeft, BLOCK_LENGTH);
+		fillNoise(intSamples, intSamples + BLOCK_LENGTH, BLOCK_LENGTH);
+		memset(floatRight, 0, sizeof(floatRight));
+		// Positions advancing at a varying pitch over a wave that fits in the cache, as interpolated PCM partials read.
+		Bit32u seed = 1;
+		for (Bit32u i = 0; i < BLOCK_LENGTH; i++) {
+			pcmPositions[i] = (i * 3 + (nextRandom(seed) & 1)) % PCM_WAVE_LENGTH;
+			pcmFractions[i] = float(nextRandom(seed) & 0xFFFF) / 65536.0f;
+			pcmAmps[i] = 0.5f;
+		}
+		fillNoise(pcmWave, pcmWave + PCM_WAVE_LENGTH, PCM_WAVE_LENGTH);
+		pcmWave[PCM_WAVE_LENGTH] = pcmWave[0];
+	}
+
+	Bit32u run() {
+		switch (kernelCase) {
+		case KERNEL_CASE_CONVERT_FLOAT_TO_INT:
+			kernels.convertFloatToInt(floatSamples, intSamples, BLOCK_LENGTH);
+			break;
+		case KERNEL_CASE_CONVERT_INT_TO_FLOAT:
+			kernels.convertIntToFloat(intSamples, floatSamples, BLOCK_LENGTH);
+			break;
+		case KERNEL_CASE_PAN_AND_MIX_FLOAT:
+			// Alternating the sign of the pan keeps the mix buffers from growing.
+			kernels.panAndMixFloat(floatSamples, floatLeft, floatRight, 5.0f, -5.0f, BLOCK_LENGTH);
+			kernels.panAndMixFloat(floatSamples, floatLeft, floatRight, -5.0f, 5.0f, BLOCK_LENGTH);
+			return 2 * BLOCK_LENGTH;
+		case KERNEL_CASE_DOUBLE_AND_WRAP_FLOAT:
+			// Repeated doubling would soon settle the samples, so the kernel works on a fresh copy of the noise.
+			memcpy(floatLeft, floatSamples, sizeof(floatLeft));
+			kernels.doubleAndWrapFloat(floatLeft, BLOCK_LENGTH);
+			break;
+		case KERNEL_CASE_CONVERT_FLOAT_TO_INT_DITHERED:
+			kernels.convertFloatToIntDithered(floatSamples, intSamples, BLOCK_LENGTH, 0);
+			break;
+		case KERNEL_CASE_GENERATE_PCM_FLOAT:
+			kernels.generatePCMFloat(pcmWave, pcmPositions, pcmFractions, pcmAmps, floatSamples, BLOCK_LENGTH);
+			break;
+		}
+		return BLOCK_LENGTH;
+	}
+
+private:
+	const Kernels &kernels;
+	const KernelCase kernelCase;
+	FloatSample floatSamples[BLOCK_LENGTH];
+	FloatSample floatLeft[BLOCK_LENGTH];
+	FloatSample floatRight[BLOCK_LENGTH];
+	IntSample intSamples[2 * BLOCK_LENGTH];
+
+	static const Bit32u PCM_WAVE_LENGTH = 4096;
+
+	// Twice as long for the noise on both channels, the first half followed by the guard sample is read.
+	FloatSample pcmWave[2 * PCM_WAVE_LENGTH];
+	Bit32u pcmPositions[BLOCK_LENGTH];
+	float pcmFractions[BLOCK_LENGTH];
+	float pcmAmps[BLOCK_LENGTH];
+};
+
+#if MT32EMU_WITH_INTERNAL_RESAMPLER
+
+// Feeds the same block of stereo noise repeatedly, so that generating the input costs next to nothing.
+class NoiseSource : public SRCTools::FloatSampleProvider, public SRCTools::IntSampleProvider {
+public:
+	NoiseSource() {
+		Bit32u seed = 1;
+		for (Bit32u i = 0; i < 2 * BLOCK_LENGTH; i++) {
+			intBlock[i] = Bit16s(nextRandom(seed)) >> 1;
+			floatBlock[i] = intBlock[i] / 32768.0f;
+		}
+	}
+
+	void getOutputSamples(SRCTools::FloatSample *outBuffer, unsigned int size) {
+		while (size > 0) {
+			const unsigned int length = size < BLOCK_LENGTH ? size : BLOCK_LENGTH;
+			memcpy(outBuffer, floatBlock, 2 * length * sizeof(SRCTools::FloatSample));
+			outBuffer += 2 * length;
+			size -= length;
+		}
+	}
+
+	void getOutputSamples(SRCTools::IntSample *outBuffer, unsigned int size) {
+		while (size > 0) {
+			const unsigned int length = size < BLOCK_LENGTH ? size : BLOCK_LENGTH;
+			memcpy(outBuffer, intBlock, 2 * length * sizeof(SRCTools::IntSample));
+			outBuffer += 2 * length;
+			size -= length;
+		}
+	}
+
+private:
+	SRCTools::FloatSample floatBlock[2 * BLOCK_LENGTH];
+	SRCTools::IntSample intBlock[2 * BLOCK_LENGTH];
+};
+
+template <class Sample, class Provider>
+class ResamplerBenchmark : public Benchmark {
+public:
+	ResamplerBenchmark(double inputRate, double outputRate, SRCTools::ResamplerModel::Quality quality) :
+		model(SRCTools::ResamplerModel::createResamplerModel(static_cast<Provider &>(source), inputRate, outputRate, quality))
+	{}
+
+	~ResamplerBenchmark() {
+		SRCTools::ResamplerModel::freeResamplerModel(model, static_cast<Provider &>(source));
+	}
+
+	Bit32u run() {
+		model.getOutputSamples(outBuffer, BLOCK_LENGTH);
+		return BLOCK_LENGTH;
+	}
+
+private:
+	NoiseSource source;
+	Provider &model;
+	Sample outBuffer[2 * BLOCK_LENGTH];
+};
+
+#endif // #if MT32EMU_WITH_INTERNAL_RESAMPLER
+
+// Fills the queue up to the half and drains it, as when a burst of events arrives within a rendering pass.
+class MidiEventQueueBenchmark : public Benchmark {
+public:
+	explicit MidiEventQueueBenchmark(bool useSysex) : queue(DEFAULT_MIDI_EVENT_QUEUE_SIZE, 32768), sysex(useSysex) {
+		for (Bit32u i = 0; i < sizeof(sysexData); i++) {
+			sysexData[i] = Bit8u(i & 0x7F);
+		}
+		sysexData[0] = 0xF0;
+		sysexData[sizeof(sysexData) - 1] = 0xF7;
+	}
+
+	Bit32u run() {
+		static const Bit32u EVENT_COUNT = DEFAULT_MIDI_EVENT_QUEUE_SIZE / 2;
+		for (Bit32u i = 0; i < EVENT_COUNT; i++) {
+			if (sysex) {
+				queue.pushSysex(sysexData, sizeof(sysexData), i);
+			} else {
+				queue.pushShortMessage(0x7F3C90 | (i & 0x0F), i);
+			}
+		}
+		Bit32u popped = 0;
+		while (queue.peekMidiEvent() != NULL) {
+			queue.dropMidiEvent();
+			popped++;
+		}
+		return popped;
+	}
+
+private:
+	MidiEventQueue queue;
+	const bool sysex;
+	Bit8u sysexData[32];
+};
+
+class MidiStreamParserBenchmark : public Benchmark, private MidiStreamParser {
+public:
+	explicit MidiStreamParserBenchmark(bool sysex) : streamLength(0), eventCount(0) {
+		Bit32u seed = 1;
+		while (streamLength + 32 <= sizeof(stream)) {
+			if (sysex) {
+				stream[streamLength++] = 0xF0;
+				for (int i = 0; i < 30; i++) stream[streamLength++] = Bit8u(nextRandom(seed) & 0x7F);
+				stream[streamLength++] = 0xF7;
+			} else {
+				// Note on with explicit status, followed by a note off with running status and a controller change.
+				const Bit8u channel = Bit8u(nextRandom(seed) & 0x0F);
+				const Bit8u key = Bit8u(nextRandom(seed) & 0x7F);
+				stream[streamLength++] = 0x90 | channel;
+				stream[streamLength++] = key;
+				stream[streamLength++] = 0x7F;
+				stream[streamLength++] = key;
+				stream[streamLength++] = 0x00;
+				stream[streamLength++] = 0xB0 | channel;
+				stream[streamLength++] = 0x07;
+				stream[streamLength++] = Bit8u(nextRandom(seed) & 0x7F);
+			}
+		}
+	}
+
+	Bit32u run() {
+		eventCount = 0;
+		parseStream(stream, streamLength);
+		return eventCount;
+	}
+
+protected:
+	void handleShortMessage(const Bit32u) {
+		eventCount++;
+	}
+
+	void handleSysex(const Bit8u *, const Bit32u) {
+		eventCount++;
+	}
+
+	void handleSystemRealtimeMessage(const Bit8u) {
+		eventCount++;
+	}
+
+	void printDebug(const char *) {}
+
+private:
+	Bit8u stream[4096];
+	Bit32u streamLength;
+	Bit32u eventCount;
+};
+
+static const char * const REVERB_MODE_NAMES[] = {"ROOM", "HALL", "PLATE", "TAP_DELAY"};
+static const char * const ANALOG_OUTPUT_MODE_NAMES[] = {"DIGITAL_ONLY", "COARSE", "ACCURATE", "OVERSAMPLED", "DECIMATED"};
+static const char * const RENDERER_TYPE_NAMES[] = {"int", "float"};
+
+static void runWaveGeneratorBenchmarks(Runner &runner) {
+	WaveGeneratorInputs *inputs = new WaveGeneratorInputs;
+	char name[64];
+	for (int kind = 0; kind < WAVE_KIND_COUNT; kind++) {
+		sprintf(name, "LA32WaveGenerator/%s", WAVE_KIND_NAMES[kind]);
+		if (runner.isSelected(name)) {
+			WaveGeneratorBenchmark<LA32WaveGenerator, Bit16s> benchmark(*inputs, WaveKind(kind));
+			runner.measure(name, UNIT_SAMPLE, benchmark);
+		}
+	}
+	for (int kind = 0; kind < WAVE_KIND_COUNT; kind++) {
+		sprintf(name, "LA32FloatWaveGenerator/%s", WAVE_KIND_NAMES[kind]);
+		if (runner.isSelected(name)) {
+			WaveGeneratorBenchmark<LA32FloatWaveGenerator, float> benchmark(*inputs, WaveKind(kind));
+			runner.measure(name, UNIT_SAMPLE, benchmark);
+		}
+	}
+	delete inputs;
+
+	RampBenchmark rampBenchmark;
+	runner.measure("LA32Ramp/advance", UNIT_SAMPLE, rampBenchmark);
+}
+
+static void runOutputStageBenchmarks(Runner &runner) {
+	char name[64];
+	for (int rendererType = RendererType_BIT16S; rendererType <= RendererType_FLOAT; rendererType++) {
+		for (int mode = REVERB_MODE_ROOM; mode <= REVERB_MODE_TAP_DELAY; mode++) {
+			sprintf(name, "BReverbModel/%s/%s", REVERB_MODE_NAMES[mode], RENDERER_TYPE_NAMES[rendererType]);
+			if (!runner.isSelected(name)) continue;
+			if (rendererType == RendererType_FLOAT) {
+				ReverbBenchmark<FloatSample> *benchmark = new ReverbBenchmark<FloatSample>(ReverbMode(mode), RendererType_FLOAT);
+				runner.measure(name, UNIT_FRAME, *benchmark);
+				delete benchmark;
+			} else {
+				ReverbBenchmark<IntSample> *benchmark = new ReverbBenchmark<IntSample>(ReverbMode(mode), RendererType_BIT16S);
+				runner.measure(name, UNIT_FRAME, *benchmark);
+				delete benchmark;
+			}
+		}
+		for (int mode = AnalogOutputMode_DIGITAL_ONLY; mode <= AnalogOutputMode_DECIMATED; mode++) {
+			sprintf(name, "Analog/%s/%s", ANALOG_OUTPUT_MODE_NAMES[mode], RENDERER_TYPE_NAMES[rendererType]);
+			if (!runner.isSelected(name)) continue;
+			if (rendererType == RendererType_FLOAT) {
+				AnalogBenchmark<FloatSample> *benchmark = new AnalogBenchmark<FloatSample>(AnalogOutputMode(mode), RendererType_FLOAT);
+				runner.measure(name, UNIT_FRAME, *benchmark);
+				delete benchmark;
+			} else {
+				AnalogBenchmark<IntSample> *benchmark = new AnalogBenchmark<IntSample>(AnalogOutputMode(mode), RendererType_BIT16S);
+				runner.measure(name, UNIT_FRAME, *benchmark);
+				delete benchmark;
+			}
+		}
+	}
+}
+
+static void runKernelBenchmarks(Runner &runner) {
+	static const char * const KERNEL_CASE_NAMES[] = {"convertFloatToInt", "convertIntToFloat", "panAndMixFloat", "doubleAndWrapFloat", "convertFloatToIntDithered", "generatePCMFloat"};
+	Kernels kernels;
+	char name[64];
+	// The portable implementations first, then the ones selected for this CPU.
+	for (int pass = 0; pass < 2; pass++) {
+		kernels.select(pass == 0 ? 0 : ~Bit32u(0));
+		for (int kernelCase = KERNEL_CASE_CONVERT_FLOAT_TO_INT; kernelCase <= KERNEL_CASE_GENERATE_PCM_FLOAT; kernelCase++) {
+			sprintf(name, "Kernels/%s/%s", KERNEL_CASE_NAMES[kernelCase], kernels.getVariantName(Bit32u(kernelCase)));
+			// Avoid duplicates when there is nothing faster than the portable implementation.
+			if (pass > 0 && strcmp(kernels.getVariantName(Bit32u(kernelCase)), "portable") == 0) continue;
+			KernelBenchmark *benchmark = new KernelBenchmark(kernels, KernelCase(kernelCase));
+			runner.measure(name, UNIT_SAMPLE, *benchmark);
+			delete benchmark;
+		}
+	}
+}
+
+static void runResamplerBenchmarks(Runner &runner) {
+#if MT32EMU_WITH_INTERNAL_RESAMPLER
+	static const char * const QUALITY_NAMES[] = {"FASTEST", "FAST", "GOOD", "BEST", "LOW_LATENCY"};
+	static const double CONVERSIONS[][2] = {{32000, 44100}, {32000, 48000}};
+	char name[64];
+	for (unsigned int conversionIx = 0; conversionIx < sizeof(CONVERSIONS) / sizeof(CONVERSIONS[0]); conversionIx++) {
+		const double inputRate = CONVERSIONS[conversionIx][0];
+		const double outputRate = CONVERSIONS[conversionIx][1];
+		for (int qualityIx = SRCTools::ResamplerModel::FASTEST; qualityIx <= SRCTools::ResamplerModel::LOW_LATENCY; qualityIx++) {
+			const SRCTools::ResamplerModel::Quality quality = SRCTools::ResamplerModel::Quality(qualityIx);
+			sprintf(name, "ResamplerModel/%.0f-%.0f/%s/float", inputRate, outputRate, QUALITY_NAMES[qualityIx]);
+			if (runner.isSelected(name)) {
+				ResamplerBenchmark<SRCTools::FloatSample, SRCTools::FloatSampleProvider> *benchmark
+					= new ResamplerBenchmark<SRCTools::FloatSample, SRCTools::FloatSampleProvider>(inputRate, outputRate, quality);
+				runner.measure(name, UNIT_FRAME, *benchmark);
+				delete benchmark;
+			}
+			sprintf(name, "ResamplerModel/%.0f-%.0f/%s/fixed", inputRate, outputRate, QUALITY_NAMES[qualityIx]);
+			if (runner.isSelected(name)) {
+				ResamplerBenchmark<SRCTools::IntSample, SRCTools::IntSampleProvider> *benchmark
+					= new ResamplerBenchmark<SRCTools::IntSample, SRCTools::IntSampleProvider>(inputRate, outputRate, quality);
+				runner.measure(name, UNIT_FRAME, *benchmark);
+				delete benchmark;
+			}
+		}
+	}
+#else
+	(void)runner;
+#endif
+}
+
+static void runMidiBenchmarks(Runner &runner) {
+	for (int sysex = 0; sysex < 2; sysex++) {
+		const char *queueName = sysex ? "MidiEventQueue/push_pop_sysex" : "MidiEventQueue/push_pop_short";
+		if (runner.isSelected(queueName)) {
+			MidiEventQueueBenchmark *benchmark = new MidiEventQueueBenchmark(sysex != 0);
+			runner.measure(queueName, UNIT_EVENT, *benchmark);
+			delete benchmark;
+		}
+		const char *parserName = sysex ? "MidiStreamParser/parseStream/sysex" : "MidiStreamParser/parseStream/short";
+		if (runner.isSelected(parserName)) {
+			MidiStreamParserBenchmark *benchmark = new MidiStreamParserBenchmark(sysex != 0);
+			runner.measure(parserName, UNIT_EVENT, *benchmark);
+			delete benchmark;
+		}
+	}
+}
+
+static int printUsage(const char *programName) {
+	fprintf(stderr, "Usage: %s [--json <file>] [--filter <substring>] [seconds]\n", programName);
+	return 1;
+}
+
+int main(int argc, char *argv[]) {
+	const char *jsonFileName = NULL;
+	const char *filter = NULL;
+	double seconds = DEFAULT_SECONDS;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+			jsonFileName = argv[++i];
+		} else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+			filter = argv[++i];
+		} else {
+			seconds = atof(argv[i]);
+			if (!(seconds > 0)) return printUsage(argv[0]);
+		}
+	}
+
+	Runner *runner = new Runner(seconds, filter);
+	runWaveGeneratorBenchmarks(*runner);
+	runOutputStageBenchmarks(*runner);
+	runKernelBenchmarks(*runner);
+	runResamplerBenchmarks(*runner);
+	runMidiBenchmarks(*runner);
+
+	int exitCode = 0;
+	if (jsonFileName != NULL) {
+		const bool useStdout = strcmp(jsonFileName, "-") == 0;
+		FILE *jsonFile = useStdout ? stdout : fopen(jsonFileName, "w");
+		if (jsonFile == NULL) {
+			fprintf(stderr, "Failed to open %s for writing\n", jsonFileName);
+			exitCode = 1;
+		} else {
+			runner->writeJSON(jsonFile);
+			if (!useStdout) fclose(jsonFile);
+		}
+	}
+	delete runner;
+	return exitCode;
+}
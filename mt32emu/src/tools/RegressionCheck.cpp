@@ -0,0 +1,531 @@
+/* Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Verifies that the optimised rendering paths produce the same output as the reference ones. A corpus of MIDI scenarios
+ * is rendered with every combination of the DAC input mode, the analogue output mode and the reverb mode, first through
+ * the integer renderer restricted to the portable implementations of the kernels, which is the reference, and then
+ * through each optimised path: the kernels selected for the CPU and the reduced memory footprint mode. The integer
+ * output must match the reference exactly, whereas the output of the float renderer is compared to the portable float
+ * rendering with a tolerance. Besides, the deterministic mode of the concurrent rendering is checked to produce exactly
+ * the same output when the partials are rendered on a single thread and on several threads. It is not a part of the default build, the CMake target mt32emu_verify builds it from
+ * the same sources as the library, e.g.:
+ *
+ *   make mt32emu_verify && ./mt32emu_verify [options]
+ *
+ * Options:
+ *   --roms <control> <pcm> - renders with the specified ROM images rather than with the built-in synthetic ones;
+ *   --seconds <seconds>    - the duration of each scenario, 2 seconds by default;
+ *   --tolerance <value>    - the maximum absolute difference permitted for the float output, 1e-6 by default;
+ *   --digests <file>       - compares the SHA1 digests of the reference outputs with those listed in the file,
+ *                            or creates the file when it doesn't exist. This catches changes of the reference paths
+ *                            themselves, as long as the same ROM images are used.
+ *
+ * The synthetic ROM images aren't musical, yet they drive the same code paths. The exit code is 0 when all the checks
+ * pass and 1 otherwise.
+ */
+
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "../mt32emu.h"
+#include "../sha1/sha1.h"
+#include "SyntheticROMs.h"
+#include "Threads.h"
+
+using namespace MT32Emu;
+
+static const Bit32u MAX_EVENT_COUNT = 8192;
+static const Bit32u MAX_EVENT_SYSEX_LENGTH = 16;
+static const Bit32u RENDER_CHUNK_LENGTH = 511;
+static const unsigned int RANDOM_SEED = 1;
+static const Bit32u EVENT_LOOKAHEAD = 2048;
+static const double DEFAULT_SECONDS = 2.0;
+static const double DEFAULT_TOLERANCE = 1e-6;
+static const unsigned int MAX_DIGEST_COUNT = 1024;
+
+static const char * const DAC_INPUT_MODE_NAMES[] = {"NICE", "PURE", "GENERATION1", "GENERATION2"};
+static const char * const ANALOG_OUTPUT_MODE_NAMES[] = {"DIGITAL_ONLY", "COARSE", "ACCURATE", "OVERSAMPLED", "DECIMATED"};
+static const char * const REVERB_MODE_NAMES[] = {"ROOM", "HALL", "PLATE", "TAP_DELAY"};
+static const Bit8u REVERB_MODE_COUNT = 4;
+
+struct Event {
+	Bit32u timestamp;
+	Bit32u message;
+	Bit32u sysexLength;
+	Bit8u sysex[MAX_EVENT_SYSEX_LENGTH];
+};
+
+enum ScenarioKind {
+	SCENARIO_MELODIC,
+	SCENARIO_RHYTHM,
+	SCENARIO_SYSEX,
+	SCENARIO_COUNT
+};
+
+static const char * const SCENARIO_NAMES[] = {"melodic", "rhythm", "sysex"};
+
+// A sequence of MIDI events with timestamps in samples at the internal sample rate, sorted by the timestamp.
+class Scenario {
+public:
+	Scenario(ScenarioKind kind, Bit8u reverbMode, Bit32u length) : eventCount(0) {
+		Random random(1 + kind);
+		// Reverb mode, time and level.
+		const Bit8u reverbSettings[] = {reverbMode, 5, 4};
+		addSysex(0, 0x100001, reverbSettings, sizeof(reverbSettings));
+		Bit32u timestamp = 0;
+		while (eventCount < MAX_EVENT_COUNT) {
+			timestamp += random.next(1200);
+			if (timestamp >= length) break;
+			switch (kind) {
+			case SCENARIO_MELODIC:
+				addMelodicEvent(random, timestamp);
+				break;
+			case SCENARIO_RHYTHM:
+				if (random.next(3) == 0) {
+					addMelodicEvent(random, timestamp);
+				} else {
+					addShortMessage(timestamp, 0x99 | ((24 + random.next(60)) << 8) | ((1 + random.next(126)) << 16));
+				}
+				break;
+			case SCENARIO_SYSEX:
+				if (random.next(2) == 0) {
+					// A parameter of the timbre in use by part 1 changes while its notes sound.
+					const Bit8u value = Bit8u(random.next(100));
+					addSysex(timestamp, 0x040000 + random.next(0xF5), &value, 1);
+				} else if (random.next(4) == 0) {
+					// Tuning, fine tune and bender range of the patch of part 1.
+					const Bit8u value = Bit8u(random.next(48));
+					addSysex(timestamp, 0x030000 + 2 + random.next(2), &value, 1);
+				} else {
+					addShortMessage(timestamp, 0x91 | ((36 + random.next(48)) << 8) | (random.next(127) << 16));
+				}
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	Bit32u getEventCount() const {
+		return eventCount;
+	}
+
+	const Event &getEvent(Bit32u ix) const {
+		return events[ix];
+	}
+
+private:
+	Event events[MAX_EVENT_COUNT];
+	Bit32u eventCount;
+
+	void addShortMessage(Bit32u timestamp, Bit32u message) {
+		if (eventCount == MAX_EVENT_COUNT) return;
+		Event &event = events[eventCount++];
+		event.timestamp = timestamp;
+		event.message = message;
+		event.sysexLength = 0;
+	}
+
+	// Encodes a data set message to the MT-32 with the 7-bit address packed as in the memory map.
+	void addSysex(Bit32u timestamp, Bit32u address, const Bit8u *data, Bit32u dataLength) {
+		if (eventCount == MAX_EVENT_COUNT || dataLength + 10 > MAX_EVENT_SYSEX_LENGTH) return;
+		Event &event = events[eventCount++];
+		event.timestamp = timestamp;
+		event.message = 0;
+		Bit8u *sysex = event.sysex;
+		Bit32u length = 0;
+		sysex[length++] = 0xF0;
+		sysex[length++] = 0x41;
+		sysex[length++] = 0x10;
+		sysex[length++] = 0x16;
+		sysex[length++] = 0x12;
+		sysex[length++] = Bit8u((address >> 16) & 0x7F);
+		sysex[length++] = Bit8u((address >> 8) & 0x7F);
+		sysex[length++] = Bit8u(address & 0x7F);
+		memcpy(sysex + length, data, dataLength);
+		length += dataLength;
+		Bit32u checksum = 0;
+		for (Bit32u i = 5; i < length; i++) {
+			checksum += sysex[i];
+		}
+		sysex[length++] = Bit8u((128 - (checksum & 0x7F)) & 0x7F);
+		sysex[length++] = 0xF7;
+		event.sysexLength = length;
+	}
+
+	// Notes, program changes, pitch bends and controllers on the melodic channels 2-9.
+	void addMelodicEvent(Random &random, Bit32u timestamp) {
+		const Bit32u channel = 1 + random.next(7);
+		const Bit32u kind = random.next(19);
+		if (kind < 9) {
+			addShortMessage(timestamp, 0x90 | channel | ((30 + random.next(60)) << 8) | ((1 + random.next(126)) << 16));
+		} else if (kind < 14) {
+			addShortMessage(timestamp, 0x80 | channel | ((30 + random.next(60)) << 8) | (64 << 16));
+		} else if (kind == 14) {
+			addShortMessage(timestamp, 0xE0 | channel | (random.next(127) << 8) | (random.next(127) << 16));
+		} else if (kind == 15) {
+			addShortMessage(timestamp, 0xB0 | channel | (1 << 8) | (random.next(127) << 16));
+		} else if (kind == 16) {
+			addShortMessage(timestamp, 0xB0 | channel | (10 << 8) | (random.next(127) << 16));
+		} else if (kind == 17) {
+			addShortMessage(timestamp, 0xB0 | channel | (64 << 8) | ((random.next(1) * 127) << 16));
+		} else {
+			addShortMessage(timestamp, 0xC0 | channel | (random.next(127) << 8));
+		}
+	}
+};
+
+struct Setup {
+	DACInputMode dacInputMode;
+	AnalogOutputMode analogOutputMode;
+	const Scenario *scenario;
+	Bit32u length;
+};
+
+// A rendering path, the portable renderings of each type are the references.
+struct Variant {
+	const char *name;
+	RendererType rendererType;
+	Bit32u cpuFeatures;
+	bool reducedMemoryFootprint;
+	// Non-zero values enable the deterministic mode of the concurrent rendering, see Synth::setPartialRenderingGroupCount().
+	Bit32u partialRenderingGroupCount;
+	Bit32u partialRenderingTaskCount;
+};
+
+static const Variant INT_REFERENCE = {"int/portable", RendererType_BIT16S, 0, false, 0, 1};
+static const Variant FLOAT_REFERENCE = {"float/portable", RendererType_FLOAT, 0, false, 0, 1};
+static const Variant OPTIMISED_VARIANTS[] = {
+	{"int/optimised", RendererType_BIT16S, ~Bit32u(0), false, 0, 1},
+	{"int/reduced_memory", RendererType_BIT16S, ~Bit32u(0), true, 0, 1},
+	{"float/optimised", RendererType_FLOAT, ~Bit32u(0), false, 0, 1},
+	{"float/reduced_memory", RendererType_FLOAT, ~Bit32u(0), true, 0, 1}
+};
+static const unsigned int OPTIMISED_VARIANT_COUNT = sizeof(OPTIMISED_VARIANTS) / sizeof(OPTIMISED_VARIANTS[0]);
+
+// The concurrent rendering in the deterministic mode must produce exactly the same output with any number of tasks,
+// the groups of partials rendered in turn on a single thread are the references.
+static const Bit32u PARTIAL_RENDERING_GROUP_COUNT = 6;
+static const Variant INT_SERIAL_REFERENCE = {"int/serial", RendererType_BIT16S, ~Bit32u(0), false, PARTIAL_RENDERING_GROUP_COUNT, 1};
+static const Variant FLOAT_SERIAL_REFERENCE = {"float/serial", RendererType_FLOAT, ~Bit32u(0), false, PARTIAL_RENDERING_GROUP_COUNT, 1};
+static const Variant PARALLEL_VARIANTS[] = {
+	{"int/parallel_2", RendererType_BIT16S, ~Bit32u(0), false, PARTIAL_RENDERING_GROUP_COUNT, 2},
+	{"int/parallel_4", RendererType_BIT16S, ~Bit32u(0), false, PARTIAL_RENDERING_GROUP_COUNT, 4},
+	{"float/parallel_2", RendererType_FLOAT, ~Bit32u(0), false, PARTIAL_RENDERING_GROUP_COUNT, 2},
+	{"float/parallel_4", RendererType_FLOAT, ~Bit32u(0), false, PARTIAL_RENDERING_GROUP_COUNT, 4}
+};
+static const unsigned int PARALLEL_VARIANT_COUNT = sizeof(PARALLEL_VARIANTS) / sizeof(PARALLEL_VARIANTS[0]);
+
+// Keeps the console quiet, the synth reports each program change and SysEx otherwise.
+class SilentReportHandler : public ReportHandler {
+public:
+	void printDebug(const char *, va_list) {}
+};
+
+static void playEvent(Synth &synth, const Event &event) {
+	if (event.sysexLength > 0) {
+		synth.playSysex(event.sysex, event.sysexLength, event.timestamp);
+	} else {
+		synth.playMsg(event.message, event.timestamp);
+	}
+}
+
+// Renders the scenario into a new buffer of interleaved stereo frames, returns NULL if the synth fails to open.
+template <class Sample>
+static Sample *render(const ROMImage &controlROMImage, const ROMImage &pcmROMImage, const Setup &setup, const Variant &variant, Bit32u &frameCount) {
+	SilentReportHandler reportHandler;
+	ThreadExecutor executor;
+	Synth synth(&reportHandler);
+	synth.selectRendererType(variant.rendererType);
+	synth.setEnabledCPUFeatures(variant.cpuFeatures);
+	synth.setReducedMemoryFootprintEnabled(variant.reducedMemoryFootprint);
+	synth.setPartialRenderingGroupCount(variant.partialRenderingGroupCount);
+	synth.setPartialRenderingExecutor(&executor, variant.partialRenderingTaskCount);
+	if (!synth.open(controlROMImage, pcmROMImage, setup.analogOutputMode)) return NULL;
+	synth.setDACInputMode(setup.dacInputMode);
+	// TVP draws the pitch fluctuations from rand(), so each rendering starts from the same state of the generator.
+	srand(RANDOM_SEED);
+
+	frameCount = Bit32u(double(setup.length) * synth.getStereoOutputSampleRate() / SAMPLE_RATE);
+	Sample *output = new Sample[2 * frameCount];
+	const Scenario &scenario = *setup.scenario;
+	Bit32u eventIx = 0;
+	for (Bit32u framesRendered = 0; framesRendered < frameCount;) {
+		const Bit32u horizon = synth.getInternalRenderedSampleCount() + EVENT_LOOKAHEAD;
+		while (eventIx < scenario.getEventCount() && scenario.getEvent(eventIx).timestamp < horizon) {
+			playEvent(synth, scenario.getEvent(eventIx++));
+		}
+		const Bit32u chunkLength = frameCount - framesRendered < RENDER_CHUNK_LENGTH ? frameCount - framesRendered : RENDER_CHUNK_LENGTH;
+		synth.render(output + 2 * framesRendered, chunkLength);
+		framesRendered += chunkLength;
+	}
+	synth.close();
+	return output;
+}
+
+static double getDifference(Bit16s a, Bit16s b) {
+	return abs(int(a) - int(b));
+}
+
+static double getDifference(float a, float b) {
+	return fabs(double(a) - double(b));
+}
+
+// Returns true if all the samples differ by no more than the tolerance, reports the first mismatch otherwise.
+template <class Sample>
+static bool compare(const Sample *reference, const Sample *output, Bit32u frameCount, double tolerance, const char *setupName, const char *variantName) {
+	double maxDifference = 0;
+	Bit32u mismatchCount = 0;
+	Bit32u firstMismatchIx = 0;
+	for (Bit32u i = 0; i < 2 * frameCount; i++) {
+		const double difference = getDifference(reference[i], output[i]);
+		if (difference > tolerance) {
+			if (mismatchCount++ == 0) firstMismatchIx = i;
+		}
+		if (difference > maxDifference) maxDifference = difference;
+	}
+	if (mismatchCount == 0) {
+		printf("PASS %s %s (max difference %g)\n", setupName, variantName, maxDifference);
+		return true;
+	}
+	printf("FAIL %s %s: %u samples differ, first at frame %u, max difference %g\n", setupName, variantName, mismatchCount, firstMismatchIx / 2, maxDifference);
+	return false;
+}
+
+// Reference digests of the outputs, keyed by the setup and the variant name.
+class DigestList {
+public:
+	DigestList() : count(0), loaded(false) {}
+
+	bool load(const char *fileName) {
+		FILE *file = fopen(fileName, "r");
+		if (file == NULL) return false;
+		char line[256];
+		while (count < MAX_DIGEST_COUNT && fgets(line, sizeof(line), file) != NULL) {
+			Digest &digest = digests[count];
+			if (sscanf(line, "%127s %40s", digest.name, digest.hexDigest) == 2) count++;
+		}
+		fclose(file);
+		loaded = true;
+		return true;
+	}
+
+	bool isLoaded() const {
+		return loaded;
+	}
+
+	// Returns NULL if the name isn't listed.
+	const char *find(const char *name) const {
+		for (unsigned int i = 0; i < count; i++) {
+			if (strcmp(digests[i].name, name) == 0) return digests[i].hexDigest;
+		}
+		return NULL;
+	}
+
+	void add(const char *name, const char *hexDigest) {
+		if (count == MAX_DIGEST_COUNT) return;
+		Digest &digest = digests[count++];
+		size_t nameLength = strlen(name);
+		if (nameLength >= sizeof(digest.name)) nameLength = sizeof(digest.name) - 1;
+		memcpy(digest.name, name, nameLength);
+		digest.name[nameLength] = 0;
+		strcpy(digest.hexDigest, hexDigest);
+	}
+
+	bool save(const char *fileName) const {
+		FILE *file = fopen(fileName, "w");
+		if (file == NULL) return false;
+		for (unsigned int i = 0; i < count; i++) {
+			fprintf(file, "%s %s\n", digests[i].name, digests[i].hexDigest);
+		}
+		fclose(file);
+		return true;
+	}
+
+private:
+	struct Digest {
+		char name[128];
+		char hexDigest[41];
+	};
+
+	Digest digests[MAX_DIGEST_COUNT];
+	unsigned int count;
+	bool loaded;
+};
+
+// Checks the digest of the reference output against the list, or adds it when the list is being created.
+template <class Sample>
+static bool checkDigest(DigestList &digestList, const Sample *output, Bit32u frameCount, const char *setupName, const char *variantName) {
+	unsigned char hash[20];
+	char hexDigest[41];
+	sha1::calc(output, int(2 * frameCount * sizeof(Sample)), hash);
+	sha1::toHexString(hash, hexDigest);
+	char name[128];
+	sprintf(name, "%s/%s", setupName, variantName);
+	if (!digestList.isLoaded()) {
+		digestList.add(name, hexDigest);
+		return true;
+	}
+	const char *expectedDigest = digestList.find(name);
+	if (expectedDigest == NULL) {
+		printf("FAIL %s %s: no reference digest\n", setupName, variantName);
+		return false;
+	}
+	if (strcmp(expectedDigest, hexDigest) != 0) {
+		printf("FAIL %s %s: digest %s, expected %s\n", setupName, variantName, hexDigest, expectedDigest);
+		return false;
+	}
+	return true;
+}
+
+// Renders the references of the type and all the optimised variants of the same type, returns the number of failures.
+template <class Sample>
+static unsigned int checkSetup(const ROMImage &controlROMImage, const ROMImage &pcmROMImage, const Setup &setup, const char *setupName,
+	const Variant &referenceVariant, const Variant *variants, unsigned int variantCount, double tolerance, DigestList *digestList)
+{
+	unsigned int failureCount = 0;
+	Bit32u frameCount;
+	Sample *reference = render<Sample>(controlROMImage, pcmROMImage, setup, referenceVariant, frameCount);
+	if (reference == NULL) {
+		printf("FAIL %s %s: failed to open synth\n", setupName, referenceVariant.name);
+		return 1;
+	}
+	if (digestList != NULL && !checkDigest(*digestList, reference, frameCount, setupName, referenceVariant.name)) failureCount++;
+	for (unsigned int variantIx = 0; variantIx < variantCount; variantIx++) {
+		const Variant &variant = variants[variantIx];
+		if (variant.rendererType != referenceVariant.rendererType) continue;
+		Bit32u variantFrameCount;
+		Sample *output = render<Sample>(controlROMImage, pcmROMImage, setup, variant, variantFrameCount);
+		if (output == NULL) {
+			printf("FAIL %s %s: failed to open synth\n", setupName, variant.name);
+			failureCount++;
+			continue;
+		}
+		if (!compare(reference, output, frameCount, tolerance, setupName, variant.name)) failureCount++;
+		delete[] output;
+	}
+	delete[] reference;
+	return failureCount;
+}
+
+static int printUsage(const char *programName) {
+	fprintf(stderr, "Usage: %s [--roms <control> <pcm>] [--seconds <seconds>] [--tolerance <value>] [--digests <file>]\n", programName);
+	return 1;
+}
+
+int main(int argc, char *argv[]) {
+	const char *controlROMFileName = NULL;
+	const char *pcmROMFileName = NULL;
+	const char *digestsFileName = NULL;
+	double seconds = DEFAULT_SECONDS;
+	double tolerance = DEFAULT_TOLERANCE;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--roms") == 0 && i + 2 < argc) {
+			controlROMFileName = argv[++i];
+			pcmROMFileName = argv[++i];
+		} else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+			seconds = atof(argv[++i]);
+			if (!(seconds > 0)) return printUsage(argv[0]);
+		} else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+			tolerance = atof(argv[++i]);
+			if (!(tolerance >= 0)) return printUsage(argv[0]);
+		} else if (strcmp(argv[i], "--digests") == 0 && i + 1 < argc) {
+			digestsFileName = argv[++i];
+		} else {
+			return printUsage(argv[0]);
+		}
+	}
+
+	const ROMImage *controlROMImage;
+	const ROMImage *pcmROMImage;
+	FileStream controlROMFile;
+	FileStream pcmROMFile;
+	SyntheticROMs *syntheticROMs = NULL;
+	if (controlROMFileName != NULL) {
+		if (!controlROMFile.open(controlROMFileName) || !pcmROMFile.open(pcmROMFileName)) {
+			fprintf(stderr, "Failed to open ROM files\n");
+			return 1;
+		}
+		controlROMImage = ROMImage::makeROMImage(&controlROMFile);
+		pcmROMImage = ROMImage::makeROMImage(&pcmROMFile);
+	} else {
+		syntheticROMs = new SyntheticROMs;
+		controlROMImage = syntheticROMs->makeControlROMImage();
+		pcmROMImage = syntheticROMs->makePCMROMImage();
+	}
+	if (controlROMImage == NULL || controlROMImage->getROMInfo() == NULL || pcmROMImage == NULL || pcmROMImage->getROMInfo() == NULL) {
+		fprintf(stderr, "Unrecognised ROM images\n");
+		return 1;
+	}
+
+	DigestList *digestList = NULL;
+	bool createDigests = false;
+	if (digestsFileName != NULL) {
+		digestList = new DigestList;
+		createDigests = !digestList->load(digestsFileName);
+	}
+
+	const Bit32u length = Bit32u(seconds * SAMPLE_RATE);
+	unsigned int failureCount = 0;
+	unsigned int setupCount = 0;
+	char setupName[96];
+	for (int scenarioKind = 0; scenarioKind < SCENARIO_COUNT; scenarioKind++) {
+		for (Bit8u reverbMode = 0; reverbMode < REVERB_MODE_COUNT; reverbMode++) {
+			Scenario *scenario = new Scenario(ScenarioKind(scenarioKind), reverbMode, length);
+			for (int dacInputMode = DACInputMode_NICE; dacInputMode <= DACInputMode_GENERATION2; dacInputMode++) {
+				for (int analogOutputMode = AnalogOutputMode_DIGITAL_ONLY; analogOutputMode <= AnalogOutputMode_DECIMATED; analogOutputMode++) {
+					const Setup setup = {DACInputMode(dacInputMode), AnalogOutputMode(analogOutputMode), scenario, length};
+					sprintf(setupName, "%s/%s/%s/%s", SCENARIO_NAMES[scenarioKind], REVERB_MODE_NAMES[reverbMode],
+						DAC_INPUT_MODE_NAMES[dacInputMode], ANALOG_OUTPUT_MODE_NAMES[analogOutputMode]);
+					failureCount += checkSetup<Bit16s>(*controlROMImage, *pcmROMImage, setup, setupName, INT_REFERENCE,
+						OPTIMISED_VARIANTS, OPTIMISED_VARIANT_COUNT, 0, digestList);
+					failureCount += checkSetup<float>(*controlROMImage, *pcmROMImage, setup, setupName, FLOAT_REFERENCE,
+						OPTIMISED_VARIANTS, OPTIMISED_VARIANT_COUNT, tolerance, digestList);
+					// The partials are rendered the same way regardless of the DAC input and analogue output modes.
+					if (dacInputMode == DACInputMode_NICE && analogOutputMode == AnalogOutputMode_COARSE) {
+						failureCount += checkSetup<Bit16s>(*controlROMImage, *pcmROMImage, setup, setupName, INT_SERIAL_REFERENCE,
+							PARALLEL_VARIANTS, PARALLEL_VARIANT_COUNT, 0, NULL);
+						failureCount += checkSetup<float>(*controlROMImage, *pcmROMImage, setup, setupName, FLOAT_SERIAL_REFERENCE,
+							PARALLEL_VARIANTS, PARALLEL_VARIANT_COUNT, 0, NULL);
+					}
+					setupCount++;
+					fflush(stdout);
+				}
+			}
+			delete scenario;
+		}
+	}
+
+	if (createDigests) {
+		if (digestList->save(digestsFileName)) {
+			printf("Reference digests written to %s\n", digestsFileName);
+		} else {
+			fprintf(stderr, "Failed to write %s\n", digestsFileName);
+			failureCount++;
+		}
+	}
+	printf("%u setups checked, %u failures\n", setupCount, failureCount);
+
+	delete digestList;
+	ROMImage::freeROMImage(controlROMImage);
+	ROMImage::freeROMImage(pcmROMImage);
+	delete syntheticROMs;
+	return failureCount == 0 ? 0 : 1;
+}
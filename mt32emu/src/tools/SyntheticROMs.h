@@ -0,0 +1,205 @@
+/* Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Synthetic ROM images shared by the tools, which allow running them without the original ROM images. The data isn't
+ * musical, yet it drives the same code paths as the original ROMs do.
+ */
+
+#ifndef MT32EMU_TOOLS_SYNTHETIC_ROMS_H
+#define MT32EMU_TOOLS_SYNTHETIC_ROMS_H
+
+#include <cstring>
+
+#include "../mt32emu.h"
+
+namespace MT32Emu {
+
+static const Bit32u PCM_ROM_SIZE = 512 * 1024;
+
+static const Bit8u TIMBRE_COMMON_MAX[] = {127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 12, 12, 15, 1};
+static const Bit8u TIMBRE_PARTIAL_MAX[] = {
+	96, 100, 16, 1, 1, 127, 100, 14,
+	10, 100, 4, 100, 100, 100, 100, 100, 100, 100, 100, 100,
+	100, 100, 100,
+	100, 30, 14, 127, 14, 100, 100, 4, 4, 100, 100, 100, 100, 100, 100, 100, 100, 100,
+	100, 100, 127, 12, 127, 12, 4, 4, 100, 100, 100, 100, 100, 100, 100, 100, 100
+};
+
+// Deterministic pseudo-random numbers, so that each run processes the same inputs.
+class Random {
+public:
+	explicit Random(Bit32u seed) : state(seed) {}
+
+	// Returns a number in the range 0..maxValue inclusive.
+	Bit32u next(Bit32u maxValue) {
+		state = state * 1103515245 + 12345;
+		return ((state >> 8) & 0xFFFFFF) % (maxValue + 1);
+	}
+
+private:
+	Bit32u state;
+};
+
+// Synthetic ROM images laid out as the control ROM map of ctrl_mt32_1_07 expects. The timbres are random,
+// yet the parameters are kept within the ranges the max tables impose, and the PCM ROM is filled with noise.
+class SyntheticROMs {
+public:
+	SyntheticROMs() :
+		controlFile(control, CONTROL_ROM_SIZE, CONTROL_ROM_DIGEST),
+		pcmFile(pcm, PCM_ROM_SIZE, PCM_ROM_DIGEST),
+		random(12345)
+	{
+		memset(control, 0, sizeof(control));
+		generatePCMTable();
+		generateTimbres();
+		generateTables();
+		for (Bit32u i = 0; i < PCM_ROM_SIZE; i++) {
+			pcm[i] = Bit8u(random.next(255));
+		}
+	}
+
+	Bit8u control[CONTROL_ROM_SIZE];
+	Bit8u pcm[PCM_ROM_SIZE];
+
+	// The images refer to the data of this instance, so they must be freed with ROMImage::freeROMImage() before it is destroyed.
+	const ROMImage *makeControlROMImage() {
+		return ROMImage::makeROMImage(&controlFile, getROMInfos());
+	}
+
+	const ROMImage *makePCMROMImage() {
+		return ROMImage::makeROMImage(&pcmFile, getROMInfos());
+	}
+
+private:
+	static const File::SHA1Digest CONTROL_ROM_DIGEST;
+	static const File::SHA1Digest PCM_ROM_DIGEST;
+	static const Bit16u PCM_TABLE_ADDRESS = 0x3000;
+	static const Bit16u TIMBRE_A_MAP_ADDRESS = 0x8000;
+	static const Bit16u TIMBRE_B_MAP_ADDRESS = 0xC000;
+	static const Bit16u TIMBRE_B_OFFSET = 0x4000;
+	static const Bit16u TIMBRE_R_MAP_ADDRESS = 0x3200;
+	static const Bit16u RHYTHM_SETTINGS_ADDRESS = 0x73FE;
+	static const Bit16u RESERVE_SETTINGS_ADDRESS = 0x57B1;
+	static const Bit16u PAN_SETTINGS_ADDRESS = 0x57CC;
+	static const Bit16u PROGRAM_SETTINGS_ADDRESS = 0x57BA;
+	static const Bit16u RHYTHM_MAX_TABLE_ADDRESS = 0x523C;
+	static const Bit16u PATCH_MAX_TABLE_ADDRESS = 0x5248;
+	static const Bit16u SYSTEM_MAX_TABLE_ADDRESS = 0x5258;
+	static const Bit16u TIMBRE_MAX_TABLE_ADDRESS = 0x51F4;
+	static const Bit16u SOUND_GROUPS_TABLE_ADDRESS = 0x70B0;
+	static const Bit16u TIMBRE_SIZE = 14 + 4 * 58;
+
+	ArrayFile controlFile;
+	ArrayFile pcmFile;
+	Random random;
+
+	static const ROMInfo * const *getROMInfos() {
+		static const ROMInfo CONTROL_ROM_INFO = {CONTROL_ROM_SIZE, CONTROL_ROM_DIGEST, ROMInfo::Control, "ctrl_mt32_1_07", "Synthetic control ROM", ROMInfo::Full, NULL};
+		static const ROMInfo PCM_ROM_INFO = {PCM_ROM_SIZE, PCM_ROM_DIGEST, ROMInfo::PCM, "pcm_mt32", "Synthetic PCM ROM", ROMInfo::Full, NULL};
+		static const ROMInfo * const ROM_INFOS[] = {&CONTROL_ROM_INFO, &PCM_ROM_INFO, NULL};
+		return ROM_INFOS;
+	}
+
+	void generatePCMTable() {
+		for (Bit32u i = 0; i < 128; i++) {
+			Bit8u *entry = &control[PCM_TABLE_ADDRESS + i * 4];
+			const Bit32u lengthExp = random.next(4);
+			const Bit32u length = 0x800 << lengthExp;
+			entry[0] = Bit8u(random.next((PCM_ROM_SIZE / 2 - length) / 0x800));
+			entry[1] = Bit8u((lengthExp << 4) | (random.next(1) << 7) | random.next(1));
+			const Bit32u pitch = 20000 + random.next(20000);
+			entry[2] = Bit8u(pitch & 0xFF);
+			entry[3] = Bit8u(pitch >> 8);
+		}
+	}
+
+	void generateTimbre(Bit8u *timbre, bool allPartialsUnmuted) {
+		for (int i = 0; i < 10; i++) {
+			timbre[i] = Bit8u('A' + random.next(25));
+		}
+		timbre[10] = Bit8u(random.next(TIMBRE_COMMON_MAX[10]));
+		timbre[11] = Bit8u(random.next(TIMBRE_COMMON_MAX[11]));
+		timbre[12] = Bit8u(allPartialsUnmuted ? 15 : 1 + random.next(14));
+		timbre[13] = Bit8u(random.next(TIMBRE_COMMON_MAX[13]));
+		for (int partialIx = 0; partialIx < 4; partialIx++) {
+			Bit8u *partial = timbre + 14 + partialIx * 58;
+			for (int i = 0; i < 58; i++) {
+				partial[i] = Bit8u(random.next(TIMBRE_PARTIAL_MAX[i]));
+			}
+			// Keep the notes within the audible range and the modulation moderate to resemble real timbres.
+			partial[0] = Bit8u(24 + random.next(24));
+			partial[2] = Bit8u(random.next(3) == 0 ? random.next(16) : 11);
+			partial[8] = Bit8u(random.next(3));
+			partial[21] = Bit8u(random.next(20));
+			partial[41] = Bit8u(60 + random.next(40));
+		}
+	}
+
+	void generateTimbres() {
+		for (Bit32u i = 0; i < 64; i++) {
+			const Bit16u timbreAAddress = Bit16u(TIMBRE_A_MAP_ADDRESS + 0x80 + i * TIMBRE_SIZE);
+			control[TIMBRE_A_MAP_ADDRESS + i * 2] = Bit8u(timbreAAddress & 0xFF);
+			control[TIMBRE_A_MAP_ADDRESS + i * 2 + 1] = Bit8u(timbreAAddress >> 8);
+			generateTimbre(&control[timbreAAddress], false);
+			const Bit16u timbreBAddress = Bit16u(TIMBRE_B_MAP_ADDRESS + 0x80 + i * TIMBRE_SIZE);
+			const Bit16u timbreBMapValue = Bit16u(timbreBAddress - TIMBRE_B_OFFSET);
+			control[TIMBRE_B_MAP_ADDRESS + i * 2] = Bit8u(timbreBMapValue & 0xFF);
+			control[TIMBRE_B_MAP_ADDRESS + i * 2 + 1] = Bit8u(timbreBMapValue >> 8);
+			generateTimbre(&control[timbreBAddress], false);
+		}
+		for (Bit32u i = 0; i < 30; i++) {
+			const Bit16u timbreRAddress = Bit16u(i * TIMBRE_SIZE);
+			control[TIMBRE_R_MAP_ADDRESS + i * 2] = Bit8u(timbreRAddress & 0xFF);
+			control[TIMBRE_R_MAP_ADDRESS + i * 2 + 1] = Bit8u(timbreRAddress >> 8);
+			generateTimbre(&control[timbreRAddress], true);
+		}
+	}
+
+	void generateTables() {
+		static const Bit8u RHYTHM_MAX[] = {94, 100, 14, 1};
+		static const Bit8u PATCH_MAX[] = {3, 63, 48, 100, 24, 3, 1, 0, 100, 14, 0, 0, 0, 0, 0, 0};
+		static const Bit8u SYSTEM_MAX[] = {127, 3, 7, 7, 32, 32, 32, 32, 32, 32, 32, 32, 32, 16, 16, 16, 16, 16, 16, 16, 16, 16, 100};
+		static const Bit8u RESERVE_SETTINGS[] = {3, 10, 6, 4, 3, 0, 0, 0, 6};
+		memcpy(&control[TIMBRE_MAX_TABLE_ADDRESS], TIMBRE_COMMON_MAX, sizeof(TIMBRE_COMMON_MAX));
+		memcpy(&control[TIMBRE_MAX_TABLE_ADDRESS + sizeof(TIMBRE_COMMON_MAX)], TIMBRE_PARTIAL_MAX, sizeof(TIMBRE_PARTIAL_MAX));
+		memcpy(&control[RHYTHM_MAX_TABLE_ADDRESS], RHYTHM_MAX, sizeof(RHYTHM_MAX));
+		memcpy(&control[PATCH_MAX_TABLE_ADDRESS], PATCH_MAX, sizeof(PATCH_MAX));
+		memcpy(&control[SYSTEM_MAX_TABLE_ADDRESS], SYSTEM_MAX, sizeof(SYSTEM_MAX));
+		memcpy(&control[RESERVE_SETTINGS_ADDRESS], RESERVE_SETTINGS, sizeof(RESERVE_SETTINGS));
+		for (Bit32u i = 0; i < 8; i++) {
+			control[PROGRAM_SETTINGS_ADDRESS + i] = Bit8u(random.next(127));
+			control[PAN_SETTINGS_ADDRESS + i] = Bit8u(random.next(14));
+		}
+		for (Bit32u i = 0; i < 85; i++) {
+			Bit8u *entry = &control[RHYTHM_SETTINGS_ADDRESS + i * 4];
+			entry[0] = Bit8u(random.next(7) == 0 ? 94 : 64 + random.next(29));
+			entry[1] = Bit8u(60 + random.next(40));
+			entry[2] = Bit8u(random.next(14));
+			entry[3] = Bit8u(random.next(1));
+		}
+		for (Bit32u i = 0; i < 19; i++) {
+			memcpy(&control[SOUND_GROUPS_TABLE_ADDRESS + i * 14 + 3], "GROUPNAME", 9);
+		}
+	}
+};
+
+const File::SHA1Digest SyntheticROMs::CONTROL_ROM_DIGEST = "0000000000000000000000000000000000000001";
+const File::SHA1Digest SyntheticROMs::PCM_ROM_DIGEST = "0000000000000000000000000000000000000002";
+
+} // namespace MT32Emu
+
+#endif // #ifndef MT32EMU_TOOLS_SYNTHETIC_ROMS_H
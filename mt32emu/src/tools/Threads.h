@@ -0,0 +1,125 @@
+/* Copyright (C) 2011-2021 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Minimal threading support shared by the tools, built on top of the Win32 API or pthreads. The library itself never
+ * creates threads, so the tools bring their own means of running the rendering concurrently.
+ */
+
+#ifndef MT32EMU_TOOLS_THREADS_H
+#define MT32EMU_TOOLS_THREADS_H
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include "../mt32emu.h"
+
+namespace MT32Emu {
+
+class Thread {
+public:
+	typedef void (*Function)(void *arg);
+
+	Thread() : function(NULL), arg(NULL), started(false) {}
+
+	~Thread() {
+		join();
+	}
+
+	// Runs the function with the argument on a new thread, returns false if the thread cannot be created.
+	bool start(Function useFunction, void *useArg) {
+		if (started) return false;
+		function = useFunction;
+		arg = useArg;
+#ifdef _WIN32
+		handle = CreateThread(NULL, 0, run, this, 0, NULL);
+		started = handle != NULL;
+#else
+		started = pthread_create(&handle, NULL, run, this) == 0;
+#endif
+		return started;
+	}
+
+	// Waits for the function to return, does nothing unless the thread has started.
+	void join() {
+		if (!started) return;
+#ifdef _WIN32
+		WaitForSingleObject(handle, INFINITE);
+		CloseHandle(handle);
+#else
+		pthread_join(handle, NULL);
+#endif
+		started = false;
+	}
+
+private:
+	Function function;
+	void *arg;
+	bool started;
+#ifdef _WIN32
+	HANDLE handle;
+
+	static DWORD WINAPI run(LPVOID thread) {
+		static_cast<Thread *>(thread)->function(static_cast<Thread *>(thread)->arg);
+		return 0;
+	}
+#else
+	pthread_t handle;
+
+	static void *run(void *thread) {
+		static_cast<Thread *>(thread)->function(static_cast<Thread *>(thread)->arg);
+		return NULL;
+	}
+#endif
+
+	Thread(const Thread &);
+	Thread &operator=(const Thread &);
+};
+
+// Executes the rendering tasks on threads started for each call, the first task runs on the calling thread.
+// It is simple rather than efficient, which suffices to check the concurrent rendering.
+class ThreadExecutor : public RenderingTaskExecutor {
+public:
+	void execute(Task &task, Bit32u taskCount) {
+		TaskInvocation *invocations = new TaskInvocation[taskCount];
+		Thread *threads = new Thread[taskCount];
+		for (Bit32u taskIx = 1; taskIx < taskCount; taskIx++) {
+			invocations[taskIx].task = &task;
+			invocations[taskIx].taskIx = taskIx;
+			if (!threads[taskIx].start(runTask, &invocations[taskIx])) task.run(taskIx);
+		}
+		task.run(0);
+		delete[] threads;
+		delete[] invocations;
+	}
+
+private:
+	struct TaskInvocation {
+		Task *task;
+		Bit32u taskIx;
+	};
+
+	static void runTask(void *invocation) {
+		static_cast<TaskInvocation *>(invocation)->task->run(static_cast<TaskInvocation *>(invocation)->taskIx);
+	}
+};
+
+} // namespace MT32Emu
+
+#endif // #ifndef MT32EMU_TOOLS_THREADS_H
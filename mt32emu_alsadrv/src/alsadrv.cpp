@@ -31,6 +31,10 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sched.h>
+#include <stdint.h>
 #include <math.h>
 
 #include <alsa/version.h>
@@ -44,7 +48,11 @@ char *recwav_filename = NULL;
 FILE *recwav_file = NULL;
 
 #define PERC_CHANNEL  9 
-const char default_rom_dir[] = "/usr/share/mt32-rom-data/";
+/* may be overridden at build time, e.g. to use fixed ROM paths in the headless daemon */
+#ifndef MT32_ROM_DIR
+#define MT32_ROM_DIR "/usr/share/mt32-rom-data/"
+#endif
+const char default_rom_dir[] = MT32_ROM_DIR;
 
 #include <mt32emu/mt32emu.h>
 
@@ -60,10 +68,27 @@ int rv_time = 0;
 int rv_level = 0;
 
 
-/* midi event and ui-command pipes */
+/* control event and ui-command pipes */
 int eventpipe[2];
 int uicmd_pipe[2];
 
+/* set by the front ends that send commands through the ui-command pipe, it isn't polled otherwise */
+int ui_commands_enabled = 0;
+
+/* Lock-free ring buffer that passes the MIDI events from the ALSA reader thread to the processing
+ * thread without a system call per event. There is a single writer and a single reader, each position
+ * is only modified by its owner. The control events from the UI still go through the event pipe. */
+#define MIDI_RING_SIZE 4096 /* must be a power of 2 */
+
+static midiev_t midi_ring[MIDI_RING_SIZE];
+static volatile unsigned int midi_ring_read_pos = 0;
+static volatile unsigned int midi_ring_write_pos = 0;
+
+/* Set by the processing thread while it sleeps in poll(), so that the eventfd is only signalled
+ * when the processing thread needs waking up */
+static volatile int midi_ring_reader_waiting = 0;
+static int midi_ring_eventfd = -1;
+
 
 #define BUFFER_SIZE_INC  20
 #define MINPROCESS_SIZE  16
@@ -71,13 +96,17 @@ int uicmd_pipe[2];
 
 class SysexHandler : public MT32Emu::MidiStreamParser {
 public:
-	explicit SysexHandler(MT32Emu::Synth &useSynth) : synth(useSynth) {}
+	explicit SysexHandler(MT32Emu::Synth &useSynth) : synth(useSynth), timestamp(0) {}
+
+	void setTimestamp(const MT32Emu::Bit32u useTimestamp) {
+		timestamp = useTimestamp;
+	}
 
 	void handleSystemRealtimeMessage(const MT32Emu::Bit8u realtime) { /* Not interesting */ }
 	void handleShortMessage(const MT32Emu::Bit32u message) { /* Not interesting */ }
 
 	void handleSysex(const MT32Emu::Bit8u stream[], const MT32Emu::Bit32u length) {
-		synth.playSysex(stream, length);
+		synth.playSysex(stream, length, timestamp);
 	}
 
 	void printDebug(const char *debugMessage) {
@@ -86,11 +115,17 @@ public:
 
 private:
 	MT32Emu::Synth &synth;
+	MT32Emu::Bit32u timestamp;
 };
 
 MT32Emu::Synth *mt32;
 SysexHandler *sysexHandler;
+// The synth references the decoded PCM samples owned by the PCM ROM image, so the images must outlive it.
+const MT32Emu::ROMImage *controlROMImage = NULL;
+const MT32Emu::ROMImage *pcmROMImage = NULL;
 snd_seq_t *seq_handle = NULL;
+/* queue used to timestamp incoming events in the kernel, -1 if unavailable */
+int seq_queue = -1;
 
 
 /* Buffer infomation */
@@ -107,6 +142,9 @@ int buffermsec = 100;
 int minimum_msec = 40;
 int maximum_msec = 1500;
 int buffer_mode = BUFFER_AUTO;
+/* mmap mode, enabled when the period size is set. Renders straight into the ALSA buffer at each period wakeup */
+int mmap_period_frames = 0;
+int mmap_periods = 2;
 int num_underruns = 0;	
 unsigned int playbuffer_size = 0;
 
@@ -128,6 +166,12 @@ int consumer_types = 0;
 /* pcm structures */
 snd_pcm_t *pcm_handle = NULL;
 snd_pcm_hw_params_t *pcm_hwparams;
+snd_pcm_uframes_t pcm_period_frames = 0;
+snd_pcm_uframes_t pcm_buffer_frames = 0;
+
+/* Frames queued in the PCM buffer and the time they were measured at, used to timestamp MIDI events in mmap mode */
+snd_pcm_sframes_t pcm_delay_frames = 0;
+struct timeval pcm_delay_time;
 // char *pcm_name = "plughw:0,0";
 char *pcm_name = "default";
 
@@ -166,7 +210,7 @@ void debug_msg(const char *msg, ...)
 int alsa_set_buffer_time(int msec)
 {
 	int dir, err, channels, realmsec;
-	unsigned int v, rate, periods;
+	unsigned int v, rate, periods, period_size;
 	double sec, tpp;
 	
 	rate = sample_rate;
@@ -180,7 +224,14 @@ int alsa_set_buffer_time(int msec)
 		return -1;
 	}
 	
-	if (snd_pcm_hw_params_set_access(pcm_handle, pcm_hwparams, SND_PCM_ACCESS_RW_INTERLEAVED) < 0) {
+	if (mmap_period_frames > 0)
+	{
+		if (snd_pcm_hw_params_set_access(pcm_handle, pcm_hwparams, SND_PCM_ACCESS_MMAP_INTERLEAVED) < 0) {
+			fprintf(stderr, "Error setting mmap access, falling back to read/write access.\n");
+			mmap_period_frames = 0;
+		}
+	}
+	if (mmap_period_frames == 0 && snd_pcm_hw_params_set_access(pcm_handle, pcm_hwparams, SND_PCM_ACCESS_RW_INTERLEAVED) < 0) {
 		fprintf(stderr, "Error setting access.\n");
 		return -1;
 	}
@@ -213,14 +264,24 @@ int alsa_set_buffer_time(int msec)
 	}
 	
 	
-	/* calculate time per period in seconds */
-	tpp = (double)PERIOD_SIZE / (double)(rate * 2 * channels); 
+	if (mmap_period_frames > 0)
+	{
+		/* the buffer consists of the requested number of periods */
+		period_size = mmap_period_frames;
+		periods = mmap_periods;
+		realmsec = (int)ceil((double)periods * period_size * 1000.0 / rate);
+	} else {
+		period_size = PERIOD_SIZE;
+
+		/* calculate time per period in seconds */
+		tpp = (double)PERIOD_SIZE / (double)(rate * 2 * channels); 
 	
-	/* calculate the number of periods required. round it up */
-	periods = (unsigned int)ceil(sec / tpp);
-	if (periods < 1) periods = 1;
+		/* calculate the number of periods required. round it up */
+		periods = (unsigned int)ceil(sec / tpp);
+		if (periods < 1) periods = 1;
 	
-	realmsec = (int)((double)periods * tpp * 1000.0);
+		realmsec = (int)((double)periods * tpp * 1000.0);
+	}
 	
 	printf("Buffer resize: Requested %d msec got %d msec / %d periods \n", msec, realmsec, periods);
 	
@@ -237,9 +298,9 @@ int alsa_set_buffer_time(int msec)
 	}
 	
 #if SND_LIB_MAJOR < 1	
-	if (snd_pcm_hw_params_set_period_size_near(pcm_handle, pcm_hwparams, PERIOD_SIZE, 0) < 0) 
+	if (snd_pcm_hw_params_set_period_size_near(pcm_handle, pcm_hwparams, period_size, 0) < 0) 
 #else
-	v = PERIOD_SIZE; dir = 0;
+	v = period_size; dir = 0;
 	if (snd_pcm_hw_params_set_period_size_near(pcm_handle, pcm_hwparams, (snd_pcm_uframes_t *)&v, &dir) < 0) 
 #endif				
 	{
@@ -254,6 +315,21 @@ int alsa_set_buffer_time(int msec)
 		fprintf(stderr, "Error setting HW params: %s\n", snd_strerror(err));
 		return -1;
 	}	
+
+	/* the actual buffer geometry may differ from the requested one */
+#if SND_LIB_MAJOR < 1	
+	pcm_period_frames = snd_pcm_hw_params_get_period_size(pcm_hwparams, 0);
+	pcm_buffer_frames = snd_pcm_hw_params_get_buffer_size(pcm_hwparams);
+#else
+	dir = 0;
+	snd_pcm_hw_params_get_period_size(pcm_hwparams, &pcm_period_frames, &dir);
+	snd_pcm_hw_params_get_buffer_size(pcm_hwparams, &pcm_buffer_frames);
+#endif
+	if (mmap_period_frames > 0)
+	{
+		realmsec = (int)ceil((double)pcm_buffer_frames * 1000.0 / rate);
+		printf("mmap mode: %d periods of %d frames\n", (int)(pcm_buffer_frames / pcm_period_frames), (int)pcm_period_frames);
+	}
 	
 	report(DRV_LATENCY, realmsec);
 	
@@ -293,8 +369,9 @@ int alsa_init_pcm(unsigned int rate, int channels)
 		return -1;
 	}
 	
-	/* allow the transfer when at least PERIOD_SIZE samples can be processed */
-	err = snd_pcm_sw_params_set_avail_min(pcm_handle, swparams, PERIOD_SIZE >> 2);
+	/* allow the transfer when at least PERIOD_SIZE samples can be processed,
+	 * in mmap mode wake up once per period */
+	err = snd_pcm_sw_params_set_avail_min(pcm_handle, swparams, mmap_period_frames > 0 ? pcm_period_frames : PERIOD_SIZE >> 2);
 	if (err < 0) {
 		printf("Unable to set avail min for playback: %s\n", snd_strerror(err));
 		return -1;
@@ -319,6 +396,70 @@ int alsa_init_pcm(unsigned int rate, int channels)
 	return 0;
 }
 
+/* Makes the sequencer stamp the events delivered to the port with the real time of our queue */
+static void enable_port_timestamping(int port)
+{
+	snd_seq_port_info_t *pinfo;
+	
+	snd_seq_port_info_alloca(&pinfo);
+	if (snd_seq_get_port_info(seq_handle, port, pinfo) < 0)
+		return;
+	snd_seq_port_info_set_timestamping(pinfo, 1);
+	snd_seq_port_info_set_timestamp_real(pinfo, 1);
+	snd_seq_port_info_set_timestamp_queue(pinfo, seq_queue);
+	if (snd_seq_set_port_info(seq_handle, port, pinfo) < 0)
+		fprintf(stderr, "Could not enable timestamping on sequencer port %d.\n", port);
+}
+
+static void setup_seq_queue(int port_mt, int port_gm)
+{
+	seq_queue = snd_seq_alloc_named_queue(seq_handle, "MT-32");
+	if (seq_queue < 0)
+	{
+		fprintf(stderr, "Could not allocate sequencer queue, events won't be timestamped.\n");
+		seq_queue = -1;
+		return;
+	}
+	enable_port_timestamping(port_mt);
+	enable_port_timestamping(port_gm);
+	snd_seq_start_queue(seq_handle, seq_queue, NULL);
+	snd_seq_drain_output(seq_handle);
+}
+
+/* Current real time of the sequencer queue, falls back to the system time without the queue */
+static void get_queue_time(struct timeval *tv)
+{
+	snd_seq_queue_status_t *status;
+	const snd_seq_real_time_t *rt;
+	
+	if (seq_queue >= 0)
+	{
+		snd_seq_queue_status_alloca(&status);
+		if (snd_seq_get_queue_status(seq_handle, seq_queue, status) >= 0)
+		{
+			rt = snd_seq_queue_status_get_real_time(status);
+			tv->tv_sec = rt->tv_sec;
+			tv->tv_usec = rt->tv_nsec / 1000;
+			return;
+		}
+	}
+	gettimeofday(tv, NULL);
+}
+
+/* Takes the timestamp the sequencer assigned to the event on delivery, so that it doesn't depend on
+ * when the reader thread wakes up */
+static inline void get_event_time(const snd_seq_event_t *seq_ev, struct timeval *tv)
+{
+	if (seq_queue >= 0 && seq_ev->queue == seq_queue
+		&& (seq_ev->flags & (SND_SEQ_TIME_STAMP_MASK | SND_SEQ_TIME_MODE_MASK)) == (SND_SEQ_TIME_STAMP_REAL | SND_SEQ_TIME_MODE_ABS))
+	{
+		tv->tv_sec = seq_ev->time.time.tv_sec;
+		tv->tv_usec = seq_ev->time.time.tv_nsec / 1000;
+	} else {
+		get_queue_time(tv);
+	}
+}
+
 int alsa_setup_midi()
 {
 	int port_in_mt;
@@ -351,11 +492,48 @@ int alsa_setup_midi()
 		return -1;
 	}	
 	
+	setup_seq_queue(port_in_mt, port_in_gm);
+
 	printf("MT-32 emulator ALSA address is %d:0\n", snd_seq_client_id(seq_handle));
 	
 	return port_in_mt;
 }
 
+/* Locks all the current and future memory of the process, so that no pages are swapped out or reclaimed while
+ * playing. Where supported, the future mappings are only locked once touched, so that the thread stacks don't
+ * consume the entire reserved size up front. */
+int lock_memory()
+{
+	int flags = MCL_CURRENT | MCL_FUTURE;
+
+#ifdef MCL_ONFAULT
+	flags |= MCL_ONFAULT;
+#endif
+	if (mlockall(flags) == -1)
+	{
+		fprintf(stderr, "Could not lock memory: %s\n", strerror(errno));
+		return -1;
+	}
+	printf("Locked memory\n");
+	return 0;
+}
+
+/* Pins the calling thread to a CPU. The threads created afterwards inherit the affinity. */
+int pin_to_cpu(int cpu)
+{
+	cpu_set_t cpus;
+	
+	CPU_ZERO(&cpus);
+	CPU_SET(cpu, &cpus);
+	if (sched_setaffinity(0, sizeof(cpus), &cpus) == -1)
+	{
+		fprintf(stderr, "Could not pin to CPU %d: %s\n", cpu, strerror(errno));
+		return -1;
+	}
+	printf("Pinned to CPU %d\n", cpu);
+	return 0;
+}
+
 void attempt_realtime()
 {
 	int status;
@@ -395,6 +573,51 @@ static inline struct timeval get_time()
 	return nt;
 }
 
+static inline int midi_ring_empty()
+{
+	return midi_ring_read_pos == midi_ring_write_pos;
+}
+
+/* Called from the ALSA reader thread only. Returns 0 if the ring buffer is full. */
+static int midi_ring_push(const midiev_t *ev)
+{
+	unsigned int pos = midi_ring_write_pos;
+	uint64_t one = 1;
+
+	if (pos - midi_ring_read_pos == MIDI_RING_SIZE)
+		return 0;
+	midi_ring[pos & (MIDI_RING_SIZE - 1)] = *ev;
+	/* publish the event before the position, then check the flag after publishing the position */
+	__sync_synchronize();
+	midi_ring_write_pos = pos + 1;
+	__sync_synchronize();
+	if (midi_ring_reader_waiting && __sync_bool_compare_and_swap(&midi_ring_reader_waiting, 1, 0))
+		write(midi_ring_eventfd, &one, sizeof(one));
+	return 1;
+}
+
+/* Called from the processing thread only. Returns 0 if the ring buffer is empty. */
+static int midi_ring_pop(midiev_t *ev)
+{
+	unsigned int pos = midi_ring_read_pos;
+
+	if (pos == midi_ring_write_pos)
+		return 0;
+	__sync_synchronize();
+	*ev = midi_ring[pos & (MIDI_RING_SIZE - 1)];
+	__sync_synchronize();
+	midi_ring_read_pos = pos + 1;
+	return 1;
+}
+
+static inline void free_event_data(midiev_t *ev)
+{
+	if (ev->type == EVENT_SYSEX)
+		free(ev->sysex);
+	else if (ev->type == EVENT_MIDI_TRIPLET)
+		delete[] (unsigned int *)ev->sysex;
+}
+
 static inline void get_null_event(midiev_t *newev)
 {
 	newev->type = EVENT_NONE;
@@ -467,6 +690,8 @@ void flush_mt32_emu()
 		if (read(eventpipe[0], &newev, sizeof(newev)) != sizeof(newev))
 			break;
 	}
+	while (midi_ring_pop(&newev))
+		free_event_data(&newev);
 	
 	/* push note flush events */
 	for (i = 0; i < 16; i++)
@@ -824,20 +1049,6 @@ static inline void underrun()
 	}
 }
 
-/* flushes events from an event pipe. tries to recycle proper notes */
-void flush_event_pipe(int epipe[2])
-{	
-	midiev_t newev;
-	int status;
-	
-	while(1)
-	{
-		status = read(eventpipe[0], &newev, sizeof(newev));
-		if (status != sizeof(newev))
-			break;
-	}
-}
-
 /* A main loop that reads events from ALSA, time stamps them and then passes them on */
 void * event_startup(void *arg_data)
 {
@@ -860,17 +1071,14 @@ void * event_startup(void *arg_data)
 				continue; /* skip event */
 		
 		get_msg(seq_ev, &newev);
-		gettimeofday(&newev.stamp, NULL);		
+		if (newev.type == EVENT_NONE)
+			continue;
+		get_event_time(seq_ev, &newev.stamp);
 				
-		status = write(eventpipe[1], &newev, sizeof(newev));
-		if ((unsigned int)status != sizeof(newev))
+		if (!midi_ring_push(&newev))
 		{
-			if (errno == EAGAIN)
-			{
-				flush_event_pipe(eventpipe);
-				report(DRV_NOTEDROP);
-			} else
-				fprintf(stderr, "stderr: could not sub pipe\n");
+			free_event_data(&newev);
+			report(DRV_NOTEDROP);
 		}
 		events_qd++;
 	}
@@ -904,7 +1112,7 @@ int init_alsadrv()
 	/* create pcm thread if needed */
 	alsa_init_pcm(sample_rate, 2);
 		
-	/* create communication pipe from alsa reader to processor */
+	/* create communication pipe from ui to processor */
 	if (socketpair(PF_LOCAL, SOCK_STREAM, 0, eventpipe))
 	{
 		fprintf(stderr, "Could not open IPC socket pair\n");
@@ -912,6 +1120,14 @@ int init_alsadrv()
 		exit(1);
 	}
 	
+	/* create the wakeup notifier of the midi event ring buffer */
+	midi_ring_eventfd = eventfd(0, EFD_NONBLOCK);
+	if (midi_ring_eventfd == -1)
+	{
+		fprintf(stderr, "Could not create eventfd: %s\n\n", strerror(errno));
+		exit(1);
+	}
+	
 	/* Enable non-blocking operation on pipe in both directions */
 	if(fcntl(eventpipe[0], F_SETFL, O_NONBLOCK) == -1)
 	{
@@ -940,7 +1156,7 @@ int init_alsadrv()
 	return 0;
 }
 
-static bool tryROMFile(const char romDir[], const char filename[], MT32Emu::FileStream &romFile) {
+static bool tryROMFile(const char romDir[], const char filename[], MT32Emu::MappedFileStream &romFile) {
 	static const int MAX_PATH_LENGTH = 4096;
 
 	if ((strlen(romDir) + strlen(filename) + 1) > MAX_PATH_LENGTH) {
@@ -952,7 +1168,7 @@ static bool tryROMFile(const char romDir[], const char filename[], MT32Emu::File
 	return romFile.open(romPathName);
 }
 
-static void openROMFile(const char romDir[], const char romFile1[], const char romFile2[], MT32Emu::FileStream &romFile, const char romType[]) {
+static void openROMFile(const char romDir[], const char romFile1[], const char romFile2[], MT32Emu::MappedFileStream &romFile, const char romType[]) {
 	switch (rom_search_type) {
 	case ROM_SEARCH_TYPE_CM32L_ONLY:
 		if (!tryROMFile(romDir, romFile1, romFile)) {
@@ -984,14 +1200,16 @@ void reload_mt32_core(int rv)
 	{
 		delete sysexHandler;
 		delete mt32;
+		MT32Emu::ROMImage::freeROMImage(controlROMImage);
+		MT32Emu::ROMImage::freeROMImage(pcmROMImage);
 		printf("Restarting MT-32 core\n");
 		report(DRV_M32RESET);
 	} else 
 		printf("Starting MT-32 core\n");
 	
 	// create ROM images
-	MT32Emu::FileStream controlROMFile;
-	MT32Emu::FileStream pcmROMFile;
+	MT32Emu::MappedFileStream controlROMFile;
+	MT32Emu::MappedFileStream pcmROMFile;
 
 	char romDir[4096];
 	if (rom_dir != NULL) {
@@ -1004,8 +1222,8 @@ void reload_mt32_core(int rv)
 	openROMFile(romDir, "CM32L_CONTROL.ROM", "MT32_CONTROL.ROM", controlROMFile, "Control");
 	openROMFile(romDir, "CM32L_PCM.ROM", "MT32_PCM.ROM", pcmROMFile, "PCM");
 
-	const MT32Emu::ROMImage *controlROMImage = MT32Emu::ROMImage::makeROMImage(&controlROMFile);
-	const MT32Emu::ROMImage *pcmROMImage = MT32Emu::ROMImage::makeROMImage(&pcmROMFile);
+	controlROMImage = MT32Emu::ROMImage::makeROMImage(&controlROMFile);
+	pcmROMImage = MT32Emu::ROMImage::makeROMImage(&pcmROMFile);
 
 	/* create MT32Synth object */
 	mt32 = new MT32Emu::Synth(mt32ReportHandler);
@@ -1015,9 +1233,6 @@ void reload_mt32_core(int rv)
 	}
 	sysexHandler = new SysexHandler(*mt32);
 
-	MT32Emu::ROMImage::freeROMImage(controlROMImage);
-	MT32Emu::ROMImage::freeROMImage(pcmROMImage);
-
 	send_rvmode_sysex(rv_type);
 	send_rvtime_sysex(rv_time);
 	send_rvlevel_sysex(rv_level);
@@ -1027,16 +1242,199 @@ void reload_mt32_core(int rv)
 	mt32->setReverbOutputGain(gain_multiplier);
 }
 
+static void check_ui_command()
+{
+	int status, cmdid;
+
+	if (!ui_commands_enabled)
+		return;
+	status = read(uicmd_pipe[0], &cmdid, sizeof(int));
+	if (status == sizeof(int))
+		switch(cmdid)
+		{
+		    case DRVCMD_CLEAR:
+			flush_mt32_emu();
+			break;
+		}			
+}
+
+static void write_wav_data(const void *data, int size, signed int *total_bytes)
+{
+	int pos;
+
+	*total_bytes += size;
+	fwrite(data, 1, size, recwav_file); 	
+	
+	pos = ftell(recwav_file);									
+	fseek(recwav_file, 0x28, SEEK_SET);
+	fwrite(total_bytes, 1, 4, recwav_file);
+	fseek(recwav_file, pos, SEEK_SET);
+}
+
+/* Fills all the available space of the ALSA buffer in mmap mode, without an intermediate buffer */
+static int render_mmap(signed int *total_bytes)
+{
+	const snd_pcm_channel_area_t *areas;
+	snd_pcm_uframes_t offset, frames;
+	snd_pcm_sframes_t avail, committed;
+	MT32Emu::Bit16s *buf;
+	int err;
+	
+	avail = snd_pcm_avail_update(pcm_handle);
+	if (avail < 0)
+		return avail;
+	while (avail > 0)
+	{
+		frames = avail;
+		err = snd_pcm_mmap_begin(pcm_handle, &areas, &offset, &frames);
+		if (err < 0)
+			return err;
+		
+		/* interleaved stereo, so the first area covers both channels */
+		buf = (MT32Emu::Bit16s *)((unsigned char *)areas[0].addr + (areas[0].first >> 3)) + offset * 2;
+		mt32->render(buf, frames);
+		if (consumer_types & CONSUME_WAVOUT)
+			write_wav_data(buf, frames << 2, total_bytes);
+		
+		committed = snd_pcm_mmap_commit(pcm_handle, offset, frames);
+		if (committed < 0)
+			return committed;
+		if ((snd_pcm_uframes_t)committed != frames)
+			return -EPIPE;
+		avail -= frames;
+	}
+	
+	/* unlike snd_pcm_writei, committing doesn't start the stream */
+	if (snd_pcm_state(pcm_handle) == SND_PCM_STATE_PREPARED)
+		return snd_pcm_start(pcm_handle);
+	return 0;
+}
+
+/* Takes a snapshot of the hardware pointer right after rendering, MIDI events are timestamped relative to it */
+static void update_event_timing()
+{
+	if (mmap_period_frames == 0)
+		return;
+	if (snd_pcm_delay(pcm_handle, &pcm_delay_frames) < 0)
+		pcm_delay_frames = pcm_buffer_frames;
+	get_queue_time(&pcm_delay_time);
+}
+
+/* Converts the arrival time of a MIDI event to a synth timestamp, so that in mmap mode all events are played
+ * with the constant latency of the whole ALSA buffer plus one period, regardless of when they arrived within
+ * a period. Otherwise, the events are played immediately at the current render position. */
+static MT32Emu::Bit32u get_event_timestamp(const midiev_t *ev)
+{
+	MT32Emu::Bit32u now = mt32->getInternalRenderedSampleCount();
+	double rate, age, offset;
+	
+	if (mmap_period_frames == 0)
+		return now;
+	rate = mt32->getStereoOutputSampleRate();
+	age = (double)(pcm_delay_time.tv_sec - ev->stamp.tv_sec) + 1e-6 * (pcm_delay_time.tv_usec - ev->stamp.tv_usec);
+	offset = (double)(pcm_buffer_frames + pcm_period_frames) - (double)pcm_delay_frames - age * rate;
+	if (offset <= 0)
+		return now;
+	return now + (MT32Emu::Bit32u)(offset * MT32Emu::SAMPLE_RATE / rate);
+}
+
+static void process_event(midiev_t *newev, int rv, MT32Emu::Bit32u timestamp)
+{
+	switch(newev->type)
+	{
+	    case EVENT_MIDI:
+		mt32->playMsg(newev->msg, timestamp);    
+		break;
+		
+	    case EVENT_MIDI_TRIPLET: {
+		unsigned int *msg_buffer = (unsigned int *)newev->sysex;
+		for(int i = 0; i < 3; i++) {
+			mt32->playMsg(msg_buffer[i], timestamp);
+		}
+		delete[] msg_buffer;
+		break;
+	    }
+
+	    case EVENT_SYSEX:
+		/* record it if needed */
+		if (consumer_types & CONSUME_SYSEX)
+		{
+			fwrite((unsigned char *)newev->sysex, 1, newev->sysex_len, recsyx_file);
+			fflush(recsyx_file);
+		}			
+		sysexHandler->setTimestamp(timestamp);
+		sysexHandler->parseStream((MT32Emu::Bit8u *) newev->sysex, newev->sysex_len);
+		free(newev->sysex);
+		break;
+	
+	    case EVENT_SET_RVMODE:			
+		rvsysex[7]  = 1;
+		rvsysex[8] = newev->msg;	
+		rvsysex[9] = 128-((rvsysex[5]+rvsysex[6]+rvsysex[7]+rvsysex[8])&127);
+		mt32->playSysex(rvsysex, 11);
+		break;
+	    case EVENT_SET_RVTIME:			
+		rvsysex[7]  = 2;
+		rvsysex[8] = newev->msg;	
+		rvsysex[9] = 128-((rvsysex[5]+rvsysex[6]+rvsysex[7]+rvsysex[8])&127);
+		mt32->playSysex(rvsysex, 11);
+		break;
+	    case EVENT_SET_RVLEVEL:			
+		rvsysex[7]  = 3;
+		rvsysex[8] = newev->msg;	
+		rvsysex[9] = 128-((rvsysex[5]+rvsysex[6]+rvsysex[7]+rvsysex[8])&127);
+		mt32->playSysex(rvsysex, 11);
+		break;
+	
+	    case EVENT_RESET:
+		reload_mt32_core(rv);
+		break;
+		
+	    case EVENT_WAVREC_ON:
+		start_recordwav();
+		if (recwav_filename != NULL)
+			report(DRV_NEWWAV, recwav_filename);
+		break;
+	    case EVENT_WAVREC_OFF:
+		if (recwav_filename != NULL)
+		{
+			fclose(recwav_file); free(recwav_filename); 
+			recwav_file = NULL; recwav_filename = NULL;
+			report(DRV_WAVOUTPUT, 0);
+			consumer_types ^= CONSUME_WAVOUT;
+		}
+		break;			
+
+	    case EVENT_SYXREC_ON:
+		start_recordsyx();
+		if (recsyx_filename != NULL)
+			report(DRV_NEWSYX, recsyx_filename);
+		break;
+	    case EVENT_SYXREC_OFF:
+		if (recsyx_filename != NULL)
+		{
+			consumer_types ^= CONSUME_SYSEX;
+			fclose(recsyx_file); free(recsyx_filename);
+			recsyx_file = NULL; recsyx_filename = NULL;
+			report(DRV_SYXOUTPUT, 0);
+		}
+		break;			
+	}
+}
+
 int process_loop(int rv)
 {
 	unsigned char processbuffer[FRAGMENT_SIZE];
 	unsigned int msg;
 	struct timeval ot;
-	int i, n, pos, csize, size, state;
+	int i, n, csize, size, state;
 	signed int total_bytes, bufferused;
 	midiev_t newev;
-	struct pollfd event_poll;
-	int status, cmdid;
+	struct pollfd *event_poll;
+	int npoll;
+	unsigned short revents;
+	uint64_t wakeups;
+	int timeout;
 	snd_pcm_uframes_t frames;
 	snd_pcm_state_t pcmstate;
 	
@@ -1049,9 +1447,17 @@ int process_loop(int rv)
 	
 	reload_mt32_core(rv);
 	
-	/* setup poll info */
-	event_poll.fd = eventpipe[0];
-	event_poll.events = POLLIN | POLLPRI;
+	/* setup poll info, in mmap mode also wake up at each period */
+	npoll = 2;
+	if (mmap_period_frames > 0)
+		npoll += snd_pcm_poll_descriptors_count(pcm_handle);
+	event_poll = (struct pollfd *)malloc(npoll * sizeof(struct pollfd));
+	if (npoll > 2)
+		snd_pcm_poll_descriptors(pcm_handle, &event_poll[2], npoll - 2);
+	event_poll[0].fd = eventpipe[0];
+	event_poll[0].events = POLLIN | POLLPRI;
+	event_poll[1].fd = midi_ring_eventfd;
+	event_poll[1].events = POLLIN;
 	
 	/* init variables */
 	ot = get_time();
@@ -1084,13 +1490,26 @@ int process_loop(int rv)
 
 	while (1) 
 	{		
-		n = poll(&event_poll, 1, 20);
+		/* only sleep if there are no pending midi events, the reader thread wakes us up after queueing one */
+		timeout = 0;
+		if (midi_ring_empty())
+		{
+			midi_ring_reader_waiting = 1;
+			__sync_synchronize();
+			if (midi_ring_empty())
+				timeout = 20;
+		}
+		n = poll(event_poll, npoll, timeout);
+		midi_ring_reader_waiting = 0;
 		if (n < 0)
 			return -1;
 
-		if (n > 0)
-			read(eventpipe[0], &newev, sizeof(newev));
-		else
+		if (npoll > 2)
+			snd_pcm_poll_descriptors_revents(pcm_handle, &event_poll[2], npoll - 2, &revents);
+
+		if (event_poll[1].revents & POLLIN)
+			read(midi_ring_eventfd, &wakeups, sizeof(wakeups));
+		if (!(event_poll[0].revents & POLLIN) || read(eventpipe[0], &newev, sizeof(newev)) != sizeof(newev))
 			get_null_event(&newev);
 					
 		
@@ -1112,128 +1531,47 @@ int process_loop(int rv)
 			snd_pcm_prepare(pcm_handle);
 		}
 		
-		/* get new time */
-		frames = snd_pcm_avail_update(pcm_handle);
-		csize = frames << 2;
-				
-		/* process data till offset */
-		while(csize > 0)
-		{				
+		if (mmap_period_frames > 0)
+		{
 			/* check for commands from the gui */
-			status = read(uicmd_pipe[0], &cmdid, sizeof(int));
-			if (status == sizeof(int))
-				switch(cmdid)
-				{
-				    case DRVCMD_CLEAR:
-					flush_mt32_emu();
-					break;
-				}			
-
-			size = csize;
-			if (size > FRAGMENT_SIZE)
-				size = FRAGMENT_SIZE;
-
-			mt32->render((MT32Emu::Bit16s *)processbuffer, size >> 2);
-
-			/* output to WAV file */
-			if (consumer_types & CONSUME_WAVOUT)
-			{
-				total_bytes += size;
-				fwrite(processbuffer, 1, size, recwav_file); 	
+			check_ui_command();
+
+			/* render straight into the ALSA buffer, xruns are recovered in the next pass */
+			render_mmap(&total_bytes);
+		} else {
+			/* get new time */
+			frames = snd_pcm_avail_update(pcm_handle);
+			csize = frames << 2;
 				
-				pos = ftell(recwav_file);									
-				fseek(recwav_file, 0x28, SEEK_SET);
-				fwrite(&total_bytes, 1, 4, recwav_file);
-				fseek(recwav_file, pos, SEEK_SET);
-			} 
+			/* process data till offset */
+			while(csize > 0)
+			{				
+				/* check for commands from the gui */
+				check_ui_command();
+
+				size = csize;
+				if (size > FRAGMENT_SIZE)
+					size = FRAGMENT_SIZE;
+
+				mt32->render((MT32Emu::Bit16s *)processbuffer, size >> 2);
+
+				/* output to WAV file */
+				if (consumer_types & CONSUME_WAVOUT)
+					write_wav_data(processbuffer, size, &total_bytes);
 					      			
-			/* output data to sound card buffer */
-			if (consumer_types & CONSUME_PLAYING)
-				snd_pcm_writei(pcm_handle, processbuffer, size >> 2);
+				/* output data to sound card buffer */
+				if (consumer_types & CONSUME_PLAYING)
+					snd_pcm_writei(pcm_handle, processbuffer, size >> 2);
 			
-			csize -= size;			
+				csize -= size;			
+			}
 		}
 		
 		/* decide what to do */
-		switch(newev.type)
-		{
-		    case EVENT_MIDI:
-			mt32->playMsg(newev.msg);    
-			break;
-			
-		    case EVENT_MIDI_TRIPLET: {
-			unsigned int *msg_buffer = (unsigned int *)newev.sysex;
-			for(int i = 0; i < 3; i++) {
-				mt32->playMsg(msg_buffer[i]);
-			}
-			delete[] msg_buffer;
-			break;
-		    }
-
-		    case EVENT_SYSEX:
-			/* record it if needed */
-			if (consumer_types & CONSUME_SYSEX)
-			{
-				fwrite((unsigned char *)newev.sysex, 1, newev.sysex_len, recsyx_file);
-				fflush(recsyx_file);
-			}			
-			sysexHandler->parseStream((MT32Emu::Bit8u *) newev.sysex, newev.sysex_len);
-			free(newev.sysex);
-			break;
-		
-		    case EVENT_SET_RVMODE:			
-			rvsysex[7]  = 1;
-			rvsysex[8] = newev.msg;	
-			rvsysex[9] = 128-((rvsysex[5]+rvsysex[6]+rvsysex[7]+rvsysex[8])&127);
-			mt32->playSysex(rvsysex, 11);
-			break;
-		    case EVENT_SET_RVTIME:			
-			rvsysex[7]  = 2;
-			rvsysex[8] = newev.msg;	
-			rvsysex[9] = 128-((rvsysex[5]+rvsysex[6]+rvsysex[7]+rvsysex[8])&127);
-			mt32->playSysex(rvsysex, 11);
-			break;
-		    case EVENT_SET_RVLEVEL:			
-			rvsysex[7]  = 3;
-			rvsysex[8] = newev.msg;	
-			rvsysex[9] = 128-((rvsysex[5]+rvsysex[6]+rvsysex[7]+rvsysex[8])&127);
-			mt32->playSysex(rvsysex, 11);
-			break;
-		
-		    case EVENT_RESET:
-			reload_mt32_core(rv);
-			break;
-			
-		    case EVENT_WAVREC_ON:
-			start_recordwav();
-			if (recwav_filename != NULL)
-				report(DRV_NEWWAV, recwav_filename);
-			break;
-		    case EVENT_WAVREC_OFF:
-			if (recwav_filename != NULL)
-			{
-				fclose(recwav_file); free(recwav_filename); 
-				recwav_file = NULL; recwav_filename = NULL;
-				report(DRV_WAVOUTPUT, 0);
-				consumer_types ^= CONSUME_WAVOUT;
-			}
-			break;			
-
-		    case EVENT_SYXREC_ON:
-			start_recordsyx();
-			if (recsyx_filename != NULL)
-				report(DRV_NEWSYX, recsyx_filename);
-			break;
-		    case EVENT_SYXREC_OFF:
-			if (recsyx_filename != NULL)
-			{
-				consumer_types ^= CONSUME_SYSEX;
-				fclose(recsyx_file); free(recsyx_filename);
-				recsyx_file = NULL; recsyx_filename = NULL;
-				report(DRV_SYXOUTPUT, 0);
-			}
-			break;			
-		}		
+		process_event(&newev, rv, mt32->getInternalRenderedSampleCount());
+		update_event_timing();
+		while (midi_ring_pop(&newev))
+			process_event(&newev, rv, get_event_timestamp(&newev));
 	}
 	
 	return 0;
@@ -60,6 +60,8 @@ extern int minimum_msec;
 extern int maximum_msec;
 extern int buffer_mode;
 extern int buffermsec;
+extern int mmap_period_frames;
+extern int mmap_periods;
 
 extern int consumer_types;
 
@@ -88,12 +90,17 @@ extern MT32Emu::AnalogOutputMode analog_output_mode;
 extern unsigned int sample_rate;
 
 extern char *rom_dir;
+extern const char default_rom_dir[];
 extern enum rom_search_type_t {
 	ROM_SEARCH_TYPE_DEFAULT,
 	ROM_SEARCH_TYPE_CM32L_ONLY,
 	ROM_SEARCH_TYPE_MT32_ONLY
 } rom_search_type;
 
+extern int ui_commands_enabled;
+
+int lock_memory();
+int pin_to_cpu(int cpu);
 int init_alsadrv();
 int process_loop(int rv);
 
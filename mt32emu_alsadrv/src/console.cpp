@@ -29,6 +29,19 @@
 #include "alsadrv.h"
 #include "drvreport.h"
 
+/* The headless daemon for embedded boxes keeps quiet unless something goes wrong
+ * and locks its memory by default */
+static void info(const char *msg, ...)
+{
+#ifndef MT32D_HEADLESS
+	va_list ap;
+	
+	va_start(ap, msg);
+	vprintf(msg, ap);
+	va_end(ap);
+#endif
+}
+
 static class : public MT32Emu::ReportHandler {
 protected:
 	virtual void onErrorControlROM() {
@@ -40,7 +53,7 @@ protected:
 	}
 
 	virtual void showLCDMessage(const char *message) {
-		printf("LCD: %s\n", message);
+		info("LCD: %s\n", message);
 	}
 
 	//virtual void printDebug(const char *fmt, va_list list) {}
@@ -68,23 +81,23 @@ void report(int type, ...)
 	switch(type)
 	{
 	case DRV_SUBMT32:
-		printf("%s subscribed to MT-32 port\n", va_arg(ap, char *));
+		info("%s subscribed to MT-32 port\n", va_arg(ap, char *));
 		break;
 
 	case DRV_SUBGMEMU:
-		printf("%s subscribed to GM emulation port\n", va_arg(ap, char *));
+		info("%s subscribed to GM emulation port\n", va_arg(ap, char *));
 		break;
 	    
 	case DRV_UNSUB:
-		printf("Client unsubscribed\n");
+		info("Client unsubscribed\n");
 		break;
 
 	case DRV_NOTEDROP:
-		printf("Note dropped, queue overfull\n");
+		info("Note dropped, queue overfull\n");
 		break;
 
 	case DRV_SYSEXGM:
-		printf("Sysex message recieved on GM emulation port\n");
+		info("Sysex message recieved on GM emulation port\n");
 		break;
 
 	case DRV_ERRWAVOUT:
@@ -104,11 +117,11 @@ void report(int type, ...)
 		break;
 
 	case DRV_READY:
-		printf("MT-32 emulator ready\n");
+		info("MT-32 emulator ready\n");
 		break;
 
 	case DRV_UNDERRUN:
-		printf("Output buffer underrun\n");
+		info("Output buffer underrun\n");
 		break;
 	}
 	
@@ -128,6 +141,10 @@ void usage(char *argv[])
 	printf("-a           : Automatic buffering mode (default)\n");
 	printf("-x msec      : Maximum buffer size in milliseconds\n");
 	printf("-i msec      : Minimum (initial) buffer size in milliseconds\n");
+	printf("-p frames    : mmap mode, renders straight into the ALSA buffer once\n"
+	       "               per period of the given size (disabled by default)\n");
+	printf("-c periods   : Number of periods in the ALSA buffer in mmap mode\n"
+	       "               (default: 2)\n");
 	
 	printf("\n");
 	printf("-d name      : ALSA PCM device name (default: \"default\") \n");
@@ -135,17 +152,21 @@ void usage(char *argv[])
 	printf("\n");
 	printf("-g factor    : Gain multiplier (default: 1.0) \n");
 	printf("-l mode      : Analog emulation mode (0 - Digital, 1 - Coarse,\n"
-	       "               2 - Accurate, 3 - Oversampled 2x, default: 2)\n");
+	       "               2 - Accurate, 3 - Oversampled 2x,\n"
+	       "               4 - Oversampled 2x decimated, default: 2)\n");
 
 	printf("\n");
 	printf("-f romdir    : Directory with ROM files to load\n"
-	       "               (default: '/usr/share/mt32-rom-data/')\n");
+	       "               (default: '%s')\n", default_rom_dir);
 	printf("-o romsearch : Search algorithm to use when loading ROM files:\n"
 	       "               (0 - try both but CM32-L first, 1 - CM32-L only,\n"
 	       "                2 - MT-32 only, default: 0)\n");
 
 	printf("\n");
-	
+	printf("-k           : Lock memory to avoid page faults (default in headless mode)\n");
+	printf("-u           : Don't lock memory\n");
+	printf("-C cpu       : Pin the synth threads to the given CPU\n");
+
 	printf("\n");
 	exit(1);
 }
@@ -153,6 +174,12 @@ void usage(char *argv[])
 int main(int argc, char **argv) 
 {	
 	int reverb_switch = 1;
+#ifdef MT32D_HEADLESS
+	int lock_switch = 1;
+#else
+	int lock_switch = 0;
+#endif
+	int cpu = -1;
 	int i;
 
 	/* parse the options */
@@ -205,6 +232,14 @@ int main(int argc, char **argv)
 		    case 'i': i++; if (i == argc) usage(argv);
 			minimum_msec = atoi(argv[i]);
 			break;
+		    case 'p': i++; if (i == argc) usage(argv);
+			mmap_period_frames = atoi(argv[i]);
+			if (mmap_period_frames < 0) usage(argv);
+			break;
+		    case 'c': i++; if (i == argc) usage(argv);
+			mmap_periods = atoi(argv[i]);
+			if (mmap_periods < 2) usage(argv);
+			break;
 
 		    case 'd': i++; if (i == argc) usage(argv);
 			pcm_name = (char *)malloc(strlen(argv[i]) + 1);
@@ -217,7 +252,7 @@ int main(int argc, char **argv)
 		    case 'l': i++; if (i == argc) usage(argv);
 			analog_output_mode = MT32Emu::AnalogOutputMode(atoi(argv[i]));
 			if (analog_output_mode < MT32Emu::AnalogOutputMode_DIGITAL_ONLY
-					|| MT32Emu::AnalogOutputMode_OVERSAMPLED < analog_output_mode) usage(argv);
+					|| MT32Emu::AnalogOutputMode_DECIMATED < analog_output_mode) usage(argv);
 			sample_rate = MT32Emu::Synth::getStereoOutputSampleRate(analog_output_mode);
 			break;
 
@@ -231,10 +266,23 @@ int main(int argc, char **argv)
 					|| ROM_SEARCH_TYPE_MT32_ONLY < rom_search_type) usage(argv);
 			break;
 
+		    case 'k': lock_switch = 1; break;
+		    case 'u': lock_switch = 0; break;
+		    case 'C': i++; if (i == argc) usage(argv);
+			cpu = atoi(argv[i]);
+			if (cpu < 0) usage(argv);
+			break;
+
 		    default:
 			usage(argv);
 		}
 	}
+	
+	/* done before creating any threads, so that they all inherit the CPU affinity */
+	if (cpu >= 0 && pin_to_cpu(cpu) == -1)
+		exit(1);
+	if (lock_switch)
+		lock_memory();
 		
 	if (init_alsadrv() == -1)
 	{
@@ -22,6 +22,7 @@
 #include <string.h>
 #include <unistd.h>
 #include <time.h>
+#include <pthread.h>
 
 #include <X11/X.h>
 #include <X11/Xlib.h>
@@ -59,25 +60,38 @@ const char *lcd_font2[] =
 #define LCD_CHARS   20
 #define MSG_CHARS   40
 
-/* LCD sections */
+#define FLAG_COUNT  3
+#define MSEC_CHARS  31
+
+/* LCD sections, updated by the driver thread and drawn by the X thread */
 char lcd_client[LCD_CHARS + 1] = "";
 char lcd_message[MSG_CHARS + 1] = "";
-char lcd_flags[] = {'W', 'P', 'X', 0};
+char lcd_flags[FLAG_COUNT + 1] = {'W', 'P', 'X', 0};
+int lcd_msec = 0;
+pthread_mutex_t lcd_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* What is currently drawn in the window, compared against the above to find the changed parts */
+char shown_client[LCD_CHARS + 1];
+char shown_message[MSG_CHARS + 1];
+char shown_msec[MSEC_CHARS + 1];
+char shown_flags[FLAG_COUNT];
 
 int lcd_flags_w, lcd_flags_h;
-int lcd_msec = 0;
 
 XFontStruct *lcd_main;
 XFontStruct *lcd_flagfont;
 XFontStruct *lcd_sub;
 
-void lcd_flag_draw(int n)
+void lcd_flag_draw(int n, char c)
 {
 	int x, y;
-	char c;
 	
-	c = lcd_flags[n];
-	if (c == 0) return;
+	x = DISPLAY_X + DISPLAY_W - (lcd_flags_w * (n + 1) + 6 + (n << 3) );
+	y = DISPLAY_Y + 4;
+	
+	/* Blank the cell, including the frame */
+	XSetForeground(dpy, mainGC, LCDColour.pixel);
+	XFillRectangle(dpy, mainWindow, mainGC, x - 2, y - 2, lcd_flags_w + 5, lcd_flags_h + 5);
 	
 	if (c & (1 << 7))
 		XSetForeground(dpy, mainGC, LCDHardColour.pixel);
@@ -85,15 +99,54 @@ void lcd_flag_draw(int n)
 		XSetForeground(dpy, mainGC, LCDSoftColour.pixel); 	
 	c &= ~(1 << 7);
 	
-	x = DISPLAY_X + DISPLAY_W - (lcd_flags_w * (n + 1) + 6 + (n << 3) );
-	y = DISPLAY_Y + 4;
-	
 	XDrawRectangle(dpy, mainWindow, mainGC, x - 2, y - 2, lcd_flags_w + 4, lcd_flags_h + 4);
 	
 	y += lcd_flags_h;
+	XSetFont(dpy, mainGC, lcd_flagfont->fid);
 	XDrawString(dpy, mainWindow, mainGC, x, y, &c, 1);
 }
 
+/* Redraws the glyphs of a line that differ from those shown. Only the area from the first changed glyph
+   to the end of the longer of both strings is blanked and redrawn, the clipping keeps the overhangs
+   of the neighbouring glyphs intact. */
+void lcd_text_draw(XFontStruct *font, unsigned long pixel, int x, int y, char *shown, const char *str)
+{
+	int i, shownLength, length, left, right, dir, ascent, descent;
+	XCharStruct shownExtents, extents;
+	XRectangle clip;
+	
+	for (i = 0; shown[i] != 0 && shown[i] == str[i]; i++);
+	if (shown[i] == 0 && str[i] == 0)
+		return;
+	
+	shownLength = strlen(shown);
+	length = strlen(str);
+	XTextExtents(font, shown, shownLength, &dir, &ascent, &descent, &shownExtents);
+	XTextExtents(font, str, length, &dir, &ascent, &descent, &extents);
+	
+	left = XTextWidth(font, str, i);
+	if (font->min_bounds.lbearing < 0)
+		left += font->min_bounds.lbearing;
+	right = shownExtents.rbearing > extents.rbearing ? shownExtents.rbearing : extents.rbearing;
+	if (right <= left)
+		right = left + 1;
+	
+	clip.x = x + left;
+	clip.y = y - font->max_bounds.ascent;
+	clip.width = right - left;
+	clip.height = font->max_bounds.ascent + font->max_bounds.descent;
+	XSetClipRectangles(dpy, mainGC, 0, 0, &clip, 1, Unsorted);
+	
+	XSetForeground(dpy, mainGC, LCDColour.pixel);
+	XFillRectangle(dpy, mainWindow, mainGC, clip.x, clip.y, clip.width, clip.height);
+	XSetForeground(dpy, mainGC, pixel);
+	XSetFont(dpy, mainGC, font->fid);
+	XDrawString(dpy, mainWindow, mainGC, x, y, str, length);
+	
+	XSetClipMask(dpy, mainGC, None);
+	strcpy(shown, str);
+}
+
 void lcd_flags_bounds(char *str, int &w, int &h)
 {
 	int i, nw, nh;
@@ -145,9 +198,6 @@ void lcd_display_channels()
 
 void lcd_redraw()
 {
-	char str[32];
-	int i, w, h;
-	
 	if (dpy == NULL)
 		return;
 	
@@ -156,32 +206,57 @@ void lcd_redraw()
 	XFillRectangle(dpy, mainWindow, mainGC,
 		       DISPLAY_X, DISPLAY_Y, DISPLAY_W, DISPLAY_H);	
 	
-	/* Set text colours */
-	XSetForeground(dpy, mainGC, LCDTextColour.pixel);
+	/* Forget what was shown, so that everything is drawn anew */
+	*shown_client = 0;
+	*shown_message = 0;
+	*shown_msec = 0;
+	memset(shown_flags, 0, sizeof shown_flags);
+	
+	lcd_update();
+
+//	lcd_display_channels();
+}
 
+void lcd_update()
+{
+	char client[LCD_CHARS + 1];
+	char message[MSG_CHARS + 1];
+	char flags[FLAG_COUNT];
+	char msec[MSEC_CHARS + 1];
+	int i;
+	
+	if (dpy == NULL)
+		return;
+	
+	/* Take a snapshot, the time spent with the lock held must not delay the driver thread */
+	pthread_mutex_lock(&lcd_mutex);
+	strcpy(client, lcd_client);
+	strcpy(message, lcd_message);
+	memcpy(flags, lcd_flags, FLAG_COUNT);
+	sprintf(msec, "%d msec", lcd_msec);
+	pthread_mutex_unlock(&lcd_mutex);
+	
 	/* Client area */
-	XSetFont(dpy, mainGC, lcd_main->fid);
-	XDrawString(dpy, mainWindow, mainGC, 
-		    DISPLAY_X + 6, DISPLAY_Y + 20 + lcd_main->max_bounds.ascent, 
-		    lcd_client, strlen(lcd_client));
+	lcd_text_draw(lcd_main, LCDTextColour.pixel,
+		      DISPLAY_X + 6, DISPLAY_Y + 20 + lcd_main->max_bounds.ascent,
+		      shown_client, client);
 	
 	/* Message area */
-	XSetFont(dpy, mainGC, lcd_sub->fid);
-	XDrawString(dpy, mainWindow, mainGC, 
-		    DISPLAY_X + 6, DISPLAY_Y + 44 + lcd_sub->max_bounds.ascent, 
-		    lcd_message, strlen(lcd_message));
+	lcd_text_draw(lcd_sub, LCDTextColour.pixel,
+		      DISPLAY_X + 6, DISPLAY_Y + 44 + lcd_sub->max_bounds.ascent,
+		      shown_message, message);
 	
 	/* latency info */
-	XSetForeground(dpy, mainGC, LCDHardColour.pixel);
-	sprintf(str, "%d msec", lcd_msec);
-	XDrawString(dpy, mainWindow, mainGC, DISPLAY_X + 6, DISPLAY_Y + 12, str, strlen(str));
+	lcd_text_draw(lcd_sub, LCDHardColour.pixel, DISPLAY_X + 6, DISPLAY_Y + 12, shown_msec, msec);
 		
 	/* draw flags */
-	XSetFont(dpy, mainGC, lcd_flagfont->fid);
-	for (i = 0; i < 4; i++)
-		lcd_flag_draw(i);
-
-//	lcd_display_channels();
+	for (i = 0; i < FLAG_COUNT; i++)
+	{
+		if (shown_flags[i] == flags[i])
+			continue;
+		lcd_flag_draw(i, flags[i]);
+		shown_flags[i] = flags[i];
+	}
 }
 
 int lcd_strnlen(const char *str, int n)
@@ -201,10 +276,10 @@ void sysex_lcd_message(const char *buf)
 	
 	length = lcd_strnlen(buf, LCD_CHARS);
 	
+	pthread_mutex_lock(&lcd_mutex);
 	memcpy(lcd_client, buf, length);
 	lcd_client[length] = 0;
-	
-	lcd_redraw();
+	pthread_mutex_unlock(&lcd_mutex);
 }
 
 void general_lcd_message(const char *buf)
@@ -215,19 +290,39 @@ void general_lcd_message(const char *buf)
 	if (length > MSG_CHARS) 
 		length = MSG_CHARS;
 	
+	pthread_mutex_lock(&lcd_mutex);
 	memcpy(lcd_message, buf, length);
 	lcd_message[length] = 0;
-		
-	lcd_redraw();
 
 	/* schedule clearing of message area */
 	lcd_last_age = time(NULL);
+	pthread_mutex_unlock(&lcd_mutex);
+}
+
+void lcd_set_latency(int msec)
+{
+	pthread_mutex_lock(&lcd_mutex);
+	lcd_msec = msec;
+	pthread_mutex_unlock(&lcd_mutex);
+}
+
+void lcd_set_flag(int n, int on)
+{
+	pthread_mutex_lock(&lcd_mutex);
+	if (on)
+		lcd_flags[n] |= 1 << 7;
+	else
+		lcd_flags[n] &= ~(1 << 7);
+	pthread_mutex_unlock(&lcd_mutex);
 }
 
 int lcd_age()
 {		
 	time_t current_time;
-		
+	int remaining = -1;
+	
+	pthread_mutex_lock(&lcd_mutex);
+	
 	/* return time remaining */
 	if (lcd_last_age != 0)
 	{
@@ -235,22 +330,21 @@ int lcd_age()
 		
 		/* return remaining time */
 		if (current_time < lcd_last_age + LCD_CLEAR_DELAY)
-			return (int)(lcd_last_age + LCD_CLEAR_DELAY - current_time); 
+			remaining = (int)(lcd_last_age + LCD_CLEAR_DELAY - current_time); 
 	}
 	
-	/* clear LCD */
-	if (*lcd_message != 0)
+	/* clear LCD, drawn with the next update */
+	if (remaining == -1 && *lcd_message != 0)
 	{
 		*lcd_message = 0;	
-		lcd_redraw();
 	
 		/* reset lcd aging */
 		lcd_last_age = 0;
-		
-		return -1;
 	}
 	
-	return -1;
+	pthread_mutex_unlock(&lcd_mutex);
+	
+	return remaining;
 }
 
 void lcd_setup()
@@ -24,15 +24,17 @@
 void lcd_setup();
 
 int lcd_age();   /* returns seconds remaining or -1 for none */
-void lcd_redraw();
+void lcd_redraw();  /* draws the whole display, e.g. on exposure */
+void lcd_update();  /* draws only the parts changed since the last drawing */
+
+/* These only change the state, which is drawn by the X thread with the next lcd_update() */
 void sysex_lcd_message(const char *buf);
 void general_lcd_message(const char *buf);
+void lcd_set_latency(int msec);
+void lcd_set_flag(int n, int on);
 
 
 extern XFontStruct *flcd;
 
-extern int lcd_msec;
-extern char lcd_flags[];
-
 #endif
 
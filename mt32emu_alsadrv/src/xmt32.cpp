@@ -74,6 +74,9 @@ int reportpipe[2];
 /* Some settings */
 int xreverb_switch = 1;
 
+/* Set by the driver thread when the keypad needs redrawing, the X thread does the drawing */
+volatile int keypad_dirty = 0;
+
 
 void setup_wm()
 {
@@ -253,19 +256,19 @@ protected:
 
 	virtual void onNewReverbMode(MT32Emu::Bit8u mode) {
 		rv_type = mode;
-		redraw_keypad();
+		keypad_dirty = 1;
 		notify();
 	}
 
 	virtual void onNewReverbTime(MT32Emu::Bit8u time) {
 		rv_time = time;
-		redraw_keypad();
+		keypad_dirty = 1;
 		notify();
 	}
 
 	virtual void onNewReverbLevel(MT32Emu::Bit8u level) {
 		rv_level = level;
-		redraw_keypad();
+		keypad_dirty = 1;
 		notify();
 	}
 
@@ -335,12 +338,12 @@ void report(int type, ...)
 		break;
 		
 	case DRV_LATENCY:
-		lcd_msec = va_arg(ap, int); lcd_redraw();
+		lcd_set_latency(va_arg(ap, int));
 		break;
 	
-	case DRV_WAVOUTPUT: lcd_flags[0] = (va_arg(ap, int)) ? 'W'|(1<<7) : 'W'; lcd_redraw(); break;
-	case DRV_PLAYING:   lcd_flags[1] = (va_arg(ap, int)) ? 'P'|(1<<7) : 'P'; lcd_redraw(); break;
-	case DRV_SYXOUTPUT: lcd_flags[2] = (va_arg(ap, int)) ? 'X'|(1<<7) : 'X'; lcd_redraw(); break;
+	case DRV_WAVOUTPUT: lcd_set_flag(0, va_arg(ap, int)); break;
+	case DRV_PLAYING:   lcd_set_flag(1, va_arg(ap, int)); break;
+	case DRV_SYXOUTPUT: lcd_set_flag(2, va_arg(ap, int)); break;
 		
 	case DRV_NEWWAV:
 		sprintf(tmpstr, "Wave output in %s", va_arg(ap, char *));
@@ -402,6 +405,14 @@ void *xdisplay_main(void *indata)
 		age = lcd_age();
 		if (age != -1) age *= 1000;
 		
+		/* draw what has changed since the last pass */
+		lcd_update();
+		if (keypad_dirty)
+		{
+			keypad_dirty = 0;
+			redraw_keypad();
+		}
+		
 		XFlush(dpy);		
 		status = poll((struct pollfd *)evs, 2, age);
 		
@@ -478,6 +489,10 @@ void usage(char *argv[])
 	printf("-a           : Automatic buffering mode (default)\n");
 	printf("-x msec      : Maximum buffer size in milliseconds\n");
 	printf("-i msec      : Minimum (initial) buffer size in milliseconds\n");
+	printf("-p frames    : mmap mode, renders straight into the ALSA buffer once\n"
+	       "               per period of the given size (disabled by default)\n");
+	printf("-c periods   : Number of periods in the ALSA buffer in mmap mode\n"
+	       "               (default: 2)\n");
 	
 	printf("\n");
 	printf("-d name      : ALSA PCM device name (default: \"default\")\n");
@@ -485,7 +500,8 @@ void usage(char *argv[])
 	printf("\n");
 	printf("-g factor    : Gain multiplier (default: 1.0) \n");
 	printf("-l mode      : Analog emulation mode (0 - Digital, 1 - Coarse,\n"
-	       "               2 - Accurate, 3 - Oversampled 2x, default: 2)\n");
+	       "               2 - Accurate, 3 - Oversampled 2x,\n"
+	       "               4 - Oversampled 2x decimated, default: 2)\n");
 
 	printf("\n");
 	printf("-f romdir    : Directory with ROM files to load\n"
@@ -548,6 +564,14 @@ int main(int argc, char *argv[])
 		    case 'i': i++; if (i == argc) usage(argv);
 			minimum_msec = atoi(argv[i]);
 			break;
+		    case 'p': i++; if (i == argc) usage(argv);
+			mmap_period_frames = atoi(argv[i]);
+			if (mmap_period_frames < 0) usage(argv);
+			break;
+		    case 'c': i++; if (i == argc) usage(argv);
+			mmap_periods = atoi(argv[i]);
+			if (mmap_periods < 2) usage(argv);
+			break;
 		    case 'd': i++; if (i == argc) usage(argv);
 			pcm_name = (char *)malloc(strlen(argv[i]) + 1);
 			strcpy(pcm_name, argv[i]);
@@ -558,7 +582,7 @@ int main(int argc, char *argv[])
 		    case 'l': i++; if (i == argc) usage(argv);
 			analog_output_mode = MT32Emu::AnalogOutputMode(atoi(argv[i]));
 			if (analog_output_mode < MT32Emu::AnalogOutputMode_DIGITAL_ONLY
-					|| MT32Emu::AnalogOutputMode_OVERSAMPLED < analog_output_mode) usage(argv);
+					|| MT32Emu::AnalogOutputMode_DECIMATED < analog_output_mode) usage(argv);
 			sample_rate = MT32Emu::Synth::getStereoOutputSampleRate(analog_output_mode);
 			break;
 
@@ -579,6 +603,7 @@ int main(int argc, char *argv[])
 		
 	/* setup stuff for communication */
 	pipe(reportpipe);	
+	ui_commands_enabled = 1;
 
 	/* first try and open port */
 	if (init_alsadrv() == -1)
@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2021 Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <lv2/core/lv2.h>
+#include <lv2/atom/atom.h>
+#include <lv2/atom/util.h>
+#include <lv2/midi/midi.h>
+#include <lv2/urid/urid.h>
+
+#define MT32EMU_API_TYPE 3
+#include <mt32emu.h>
+
+#define MT32EMU_LV2_URI "http://munt.sourceforge.net/plugins/mt32emu"
+
+// Overrides the directory where the ROM files are looked for, which is the subdirectory "roms" of the plugin bundle by default.
+static const char ROM_DIR_ENVIRONMENT_VARIABLE[] = "MT32EMU_LV2_ROM_DIR";
+static const char DEFAULT_ROM_SUBDIR[] = "roms/";
+
+static const char * const CONTROL_ROM_FILE_NAMES[] = {"CM32L_CONTROL.ROM", "MT32_CONTROL.ROM", NULL};
+static const char * const PCM_ROM_FILE_NAMES[] = {"CM32L_PCM.ROM", "MT32_PCM.ROM", NULL};
+
+// Preallocated storage for the SysEx data, so that enqueueing SysEx messages in run() never allocates memory.
+static const MT32Emu::Bit32u SYSEX_STORAGE_BUFFER_SIZE = 32768;
+
+enum PortIndex {
+	PORT_MIDI_IN = 0,
+	PORT_AUDIO_OUT_LEFT = 1,
+	PORT_AUDIO_OUT_RIGHT = 2
+};
+
+struct Plugin {
+	MT32Emu::Service service;
+	LV2_URID midiEventURID;
+
+	const LV2_Atom_Sequence *midiIn;
+	float *audioOutLeft;
+	float *audioOutRight;
+
+	// Number of samples at the internal synth sample rate per frame at the host sample rate.
+	double synthSamplesPerFrame;
+	// Position of the current block in the synth timeline, the fractional part is accumulated separately.
+	MT32Emu::Bit32u blockStartTimestamp;
+	double blockStartTimestampFraction;
+	// Delay applied to all MIDI events, so that none of them is due before the synth has rendered ahead.
+	MT32Emu::Bit32u timestampOffset;
+};
+
+// Debug and LCD messages may come from the audio thread, where no I/O is allowed. Hence, they are dropped.
+static void printDebug(void *, const char *, va_list) {}
+
+static void showLCDMessage(void *, const char *) {}
+
+static mt32emu_report_handler_version getReportHandlerVersionID(mt32emu_report_handler_i) {
+	return MT32EMU_REPORT_HANDLER_VERSION_0;
+}
+
+static mt32emu_report_handler_i getReportHandler() {
+	static const mt32emu_report_handler_i_v0 REPORT_HANDLER_V0_IMPL = {
+		getReportHandlerVersionID,
+		printDebug,
+		NULL, // onErrorControlROM
+		NULL, // onErrorPCMROM
+		showLCDMessage,
+		NULL, // onMIDIMessagePlayed
+		NULL, // onMIDIQueueOverflow
+		NULL, // onMIDISystemRealtime
+		NULL, // onDeviceReset
+		NULL, // onDeviceReconfig
+		NULL, // onNewReverbMode
+		NULL, // onNewReverbTime
+		NULL, // onNewReverbLevel
+		NULL, // onPolyStateChanged
+		NULL // onProgramChanged
+	};
+	static const mt32emu_report_handler_i REPORT_HANDLER_I = { &REPORT_HANDLER_V0_IMPL };
+	return REPORT_HANDLER_I;
+}
+
+static bool addROMFile(MT32Emu::Service &service, const std::string &romDir, const char * const fileNames[], mt32emu_return_code addedRC) {
+	for (const char * const *fileName = fileNames; *fileName != NULL; fileName++) {
+		if (service.addROMFile((romDir + *fileName).c_str()) == addedRC) return true;
+	}
+	return false;
+}
+
+static LV2_Handle instantiate(const LV2_Descriptor *, double sampleRate, const char *bundlePath, const LV2_Feature * const *features) {
+	const LV2_URID_Map *urIDMap = NULL;
+	for (const LV2_Feature * const *feature = features; *feature != NULL; feature++) {
+		if (strcmp((*feature)->URI, LV2_URID__map) == 0) {
+			urIDMap = static_cast<const LV2_URID_Map *>((*feature)->data);
+		}
+	}
+	if (urIDMap == NULL) return NULL;
+
+	const char *romDirOverride = getenv(ROM_DIR_ENVIRONMENT_VARIABLE);
+	std::string romDir;
+	if (romDirOverride != NULL && *romDirOverride != 0) {
+		romDir = romDirOverride;
+		char lastChar = romDir[romDir.length() - 1];
+		if (lastChar != '/' && lastChar != '\\') romDir += '/';
+	} else {
+		// The bundle path always ends with a directory separator.
+		romDir = std::string(bundlePath) + DEFAULT_ROM_SUBDIR;
+	}
+
+	Plugin *plugin = new Plugin;
+	MT32Emu::Service &service = plugin->service;
+	service.createContext(getReportHandler(), plugin);
+
+	// The ROM files are mapped into memory by the library where possible, so that all the plugin instances loading
+	// the same files share the ROM data via the page cache rather than reading in a private copy each.
+	if (!addROMFile(service, romDir, CONTROL_ROM_FILE_NAMES, MT32EMU_RC_ADDED_CONTROL_ROM)
+		|| !addROMFile(service, romDir, PCM_ROM_FILE_NAMES, MT32EMU_RC_ADDED_PCM_ROM))
+	{
+		delete plugin;
+		return NULL;
+	}
+
+	service.setStereoOutputSampleRate(sampleRate);
+	service.setSamplerateConversionQuality(MT32Emu::SamplerateConversionQuality_GOOD);
+	if (service.openSynth() != MT32EMU_RC_OK) {
+		delete plugin;
+		return NULL;
+	}
+	// Ensure the rendering never allocates memory.
+	service.configureMIDIEventQueueSysexStorage(SYSEX_STORAGE_BUFFER_SIZE);
+	service.preallocateReverbMemory(true);
+	// The host delivers the events with sample accurate timing already, which the MIDI interface emulation would distort.
+	service.setMIDIDelayMode(MT32Emu::MIDIDelayMode_IMMEDIATE);
+
+	plugin->midiEventURID = urIDMap->map(urIDMap->handle, LV2_MIDI__MidiEvent);
+	plugin->midiIn = NULL;
+	plugin->audioOutLeft = NULL;
+	plugin->audioOutRight = NULL;
+	plugin->synthSamplesPerFrame = MT32Emu::SAMPLE_RATE / sampleRate;
+	plugin->blockStartTimestamp = service.getInternalRenderedSampleCount();
+	plugin->blockStartTimestampFraction = 0.0;
+	plugin->timestampOffset = 0;
+	return plugin;
+}
+
+static void connectPort(LV2_Handle instance, uint32_t port, void *data) {
+	Plugin *plugin = static_cast<Plugin *>(instance);
+	switch (port) {
+	case PORT_MIDI_IN:
+		plugin->midiIn = static_cast<const LV2_Atom_Sequence *>(data);
+		break;
+	case PORT_AUDIO_OUT_LEFT:
+		plugin->audioOutLeft = static_cast<float *>(data);
+		break;
+	case PORT_AUDIO_OUT_RIGHT:
+		plugin->audioOutRight = static_cast<float *>(data);
+		break;
+	}
+}
+
+// Maps the frame offset of an event within the current block to the synth timeline. The events retain the exact spacing
+// they are sent by the host with. The sample rate conversion renders the synth output ahead in chunks though, so that
+// an event could be due before the current rendering position. In this case, the delay applied to all the events is
+// increased accordingly, which quickly settles at the lookahead of the sample rate converter.
+static MT32Emu::Bit32u getEventTimestamp(Plugin *plugin, uint32_t frameOffset) {
+	MT32Emu::Bit32u timestamp = plugin->blockStartTimestamp + plugin->timestampOffset
+		+ MT32Emu::Bit32u(plugin->blockStartTimestampFraction + frameOffset * plugin->synthSamplesPerFrame);
+	MT32Emu::Bit32u renderedSampleCount = plugin->service.getInternalRenderedSampleCount();
+	MT32Emu::Bit32s lateness = MT32Emu::Bit32s(renderedSampleCount - timestamp);
+	if (lateness > 0) {
+		plugin->timestampOffset += lateness;
+		timestamp = renderedSampleCount;
+	}
+	return timestamp;
+}
+
+static void playMIDIEvent(Plugin *plugin, const uint8_t *data, uint32_t size, MT32Emu::Bit32u timestamp) {
+	if (size == 0) return;
+	if (data[0] == LV2_MIDI_MSG_SYSTEM_EXCLUSIVE) {
+		plugin->service.playSysexAt(data, size, timestamp);
+	} else if (size <= 3 && (data[0] & 0x80) != 0) {
+		MT32Emu::Bit32u msg = data[0];
+		if (size > 1) msg |= data[1] << 8;
+		if (size > 2) msg |= data[2] << 16;
+		plugin->service.playMsgAt(msg, timestamp);
+	}
+}
+
+static void run(LV2_Handle instance, uint32_t sampleCount) {
+	Plugin *plugin = static_cast<Plugin *>(instance);
+
+	LV2_ATOM_SEQUENCE_FOREACH(plugin->midiIn, event) {
+		if (event->body.type != plugin->midiEventURID) continue;
+		const uint8_t *data = static_cast<const uint8_t *>(LV2_ATOM_BODY_CONST(&event->body));
+		playMIDIEvent(plugin, data, event->body.size, getEventTimestamp(plugin, uint32_t(event->time.frames)));
+	}
+
+	plugin->service.renderFloatPlanar(plugin->audioOutLeft, plugin->audioOutRight, sampleCount);
+
+	double blockLength = plugin->blockStartTimestampFraction + sampleCount * plugin->synthSamplesPerFrame;
+	MT32Emu::Bit32u wholeBlockLength = MT32Emu::Bit32u(blockLength);
+	plugin->blockStartTimestamp += wholeBlockLength;
+	plugin->blockStartTimestampFraction = blockLength - wholeBlockLength;
+}
+
+static void cleanup(LV2_Handle instance) {
+	delete static_cast<Plugin *>(instance);
+}
+
+static const void *extensionData(const char *) {
+	return NULL;
+}
+
+static const LV2_Descriptor DESCRIPTOR = {
+	MT32EMU_LV2_URI,
+	instantiate,
+	connectPort,
+	NULL, // activate
+	run,
+	NULL, // deactivate
+	cleanup,
+	extensionData
+};
+
+LV2_SYMBOL_EXPORT const LV2_Descriptor *lv2_descriptor(uint32_t index) {
+	return index == 0 ? &DESCRIPTOR : NULL;
+}
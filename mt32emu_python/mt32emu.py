@@ -0,0 +1,301 @@
+# Copyright (C) 2021 Jerome Fisher, Sergey V. Mikayev
+#
+#  This program is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU Lesser General Public License as published by
+#  the Free Software Foundation, either version 2.1 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU Lesser General Public License for more details.
+#
+#  You should have received a copy of the GNU Lesser General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""Python binding of the mt32emu library over its C interface.
+
+The output is rendered straight into the memory of caller-provided buffers,
+such as NumPy arrays, and batches of MIDI events are passed to the library
+as arrays of mt32emu_midi_event structures, so no data is copied on the way.
+The binding relies on ctypes, which releases the GIL for the duration of each
+call to the library, so synths rendered in separate threads run concurrently.
+A single Synth object must not be used by several threads at once though.
+"""
+
+import ctypes
+import ctypes.util
+import os
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
+# Return codes, see mt32emu_return_code.
+RC_OK = 0
+RC_ADDED_CONTROL_ROM = 1
+RC_ADDED_PCM_ROM = 2
+RC_ADDED_PARTIAL_CONTROL_ROM = 3
+RC_ADDED_PARTIAL_PCM_ROM = 4
+RC_ROM_NOT_IDENTIFIED = -1
+RC_FILE_NOT_FOUND = -2
+RC_FILE_NOT_LOADED = -3
+RC_MISSING_ROMS = -4
+RC_NOT_OPENED = -5
+RC_QUEUE_FULL = -6
+RC_ROMS_NOT_PAIRABLE = -7
+RC_MACHINE_NOT_IDENTIFIED = -8
+RC_FAILED = -100
+
+# Analogue circuit emulation modes, see mt32emu_analog_output_mode.
+AOM_DIGITAL_ONLY = 0
+AOM_COARSE = 1
+AOM_ACCURATE = 2
+AOM_OVERSAMPLED = 3
+AOM_DECIMATED = 4
+
+# Sample rate conversion quality options, see mt32emu_samplerate_conversion_quality.
+SRCQ_FASTEST = 0
+SRCQ_FAST = 1
+SRCQ_GOOD = 2
+SRCQ_BEST = 3
+
+
+class MidiEvent(ctypes.Structure):
+    """Mirrors mt32emu_midi_event. Arrays of these, e.g. (MidiEvent * count)(),
+    can be passed wherever a batch of events is expected."""
+    _fields_ = [
+        ('sysex', ctypes.c_void_p),
+        ('sysexLength', ctypes.c_uint32),
+        ('msg', ctypes.c_uint32),
+        ('timestamp', ctypes.c_uint32),
+    ]
+
+
+if numpy is not None:
+    # The NumPy equivalent of MidiEvent, with the same field offsets and padding.
+    EVENT_DTYPE = numpy.dtype([
+        ('sysex', numpy.uintp),
+        ('sysexLength', numpy.uint32),
+        ('msg', numpy.uint32),
+        ('timestamp', numpy.uint32),
+    ], align=True)
+    assert EVENT_DTYPE.itemsize == ctypes.sizeof(MidiEvent)
+
+    def make_events(msgs, timestamps):
+        """Builds an array of short MIDI message events from a pair of sequences
+        of equal length, the messages being packed as for Synth.play_msg()."""
+        events = numpy.zeros(len(msgs), dtype=EVENT_DTYPE)
+        events['msg'] = msgs
+        events['timestamp'] = timestamps
+        return events
+
+
+class _ReportHandler(ctypes.Union):
+    _fields_ = [('v0', ctypes.c_void_p)]
+
+
+def _load_library(path):
+    if path is None:
+        path = os.environ.get('MT32EMU_LIBRARY') or ctypes.util.find_library('mt32emu')
+        if path is None:
+            raise OSError('mt32emu library not found, set MT32EMU_LIBRARY to its path')
+    lib = ctypes.CDLL(path)
+    context = ctypes.c_void_p
+    u32 = ctypes.c_uint32
+    f32p = ctypes.POINTER(ctypes.c_float)
+    s16p = ctypes.POINTER(ctypes.c_int16)
+    eventp = ctypes.POINTER(MidiEvent)
+    prototypes = {
+        'mt32emu_get_library_version_string': (ctypes.c_char_p, []),
+        'mt32emu_create_context': (context, [_ReportHandler, ctypes.c_void_p]),
+        'mt32emu_free_context': (None, [context]),
+        'mt32emu_add_rom_data': (ctypes.c_int, [context, ctypes.c_char_p, ctypes.c_size_t, ctypes.c_void_p]),
+        'mt32emu_add_rom_file': (ctypes.c_int, [context, ctypes.c_char_p]),
+        'mt32emu_set_analog_output_mode': (None, [context, ctypes.c_int]),
+        'mt32emu_set_stereo_output_samplerate': (None, [context, ctypes.c_double]),
+        'mt32emu_set_samplerate_conversion_quality': (None, [context, ctypes.c_int]),
+        'mt32emu_open_synth': (ctypes.c_int, [context]),
+        'mt32emu_close_synth': (None, [context]),
+        'mt32emu_get_actual_stereo_output_samplerate': (u32, [context]),
+        'mt32emu_play_msg': (ctypes.c_int, [context, u32]),
+        'mt32emu_play_sysex': (ctypes.c_int, [context, ctypes.c_char_p, u32]),
+        'mt32emu_play_events': (u32, [context, eventp, u32]),
+        'mt32emu_render_bit16s': (None, [context, s16p, u32]),
+        'mt32emu_render_float': (None, [context, f32p, u32]),
+        'mt32emu_render_float_planar': (None, [context, f32p, f32p, u32]),
+        'mt32emu_render_bit16s_with_events': (u32, [context, s16p, u32, eventp, u32]),
+        'mt32emu_render_float_with_events': (u32, [context, f32p, u32, eventp, u32]),
+        'mt32emu_render_float_planar_with_events': (u32, [context, f32p, f32p, u32, eventp, u32]),
+        'mt32emu_is_active': (ctypes.c_int, [context]),
+    }
+    for name, (restype, argtypes) in prototypes.items():
+        function = getattr(lib, name)
+        function.restype = restype
+        function.argtypes = argtypes
+    return lib
+
+
+_libraries = {}
+
+
+def _get_library(path):
+    lib = _libraries.get(path)
+    if lib is None:
+        lib = _libraries[path] = _load_library(path)
+    return lib
+
+
+def get_library_version_string(library=None):
+    return _get_library(library).mt32emu_get_library_version_string().decode()
+
+
+def _view(buffer, formats, what):
+    view = memoryview(buffer)
+    if view.readonly or not view.c_contiguous:
+        raise ValueError(what + ' must be a writable C-contiguous buffer')
+    if view.format.lstrip('@=<') not in formats:
+        raise TypeError(what + ' has unsupported item format ' + repr(view.format))
+    return view
+
+
+def _pointer(view, pointer_type):
+    # Refers to the memory of the buffer without copying. The ctypes object keeps the buffer exported while alive.
+    if view.nbytes == 0:
+        return None
+    return ctypes.cast((ctypes.c_char * view.nbytes).from_buffer(view), pointer_type)
+
+
+def _sample_view(buffer, what):
+    view = _view(buffer, ('h', 'f'), what)
+    if view.format.endswith('h'):
+        if view.itemsize != 2:
+            raise TypeError(what + ' must consist of 16-bit samples')
+        return view, ctypes.POINTER(ctypes.c_int16)
+    if view.itemsize != 4:
+        raise TypeError(what + ' must consist of 32-bit float samples')
+    return view, ctypes.POINTER(ctypes.c_float)
+
+
+def _events_pointer(events):
+    # Accepts arrays of MidiEvent as well as NumPy arrays of EVENT_DTYPE, which export different item formats.
+    view = memoryview(events)
+    if not view.c_contiguous:
+        raise ValueError('events must be a C-contiguous buffer')
+    if view.itemsize != ctypes.sizeof(MidiEvent):
+        raise TypeError('events must consist of mt32emu_midi_event structures')
+    count = view.nbytes // view.itemsize
+    if count == 0:
+        return None, 0
+    if view.readonly:
+        # The ctypes buffer cannot refer to read-only memory, so the events are copied in this case.
+        return ctypes.cast((ctypes.c_char * view.nbytes).from_buffer_copy(view), ctypes.POINTER(MidiEvent)), count
+    return _pointer(view, ctypes.POINTER(MidiEvent)), count
+
+
+class Synth:
+    """Owns an emulation context of the library. The output is stereo."""
+
+    def __init__(self, library=None):
+        self._lib = _get_library(library)
+        self._context = self._lib.mt32emu_create_context(_ReportHandler(None), None)
+        if not self._context:
+            raise RuntimeError('failed to create mt32emu context')
+        # The library refers to the ROM data added from memory directly.
+        self._rom_data = []
+
+    def __del__(self):
+        self.free()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc_info):
+        self.free()
+
+    def free(self):
+        if getattr(self, '_context', None):
+            self._lib.mt32emu_free_context(self._context)
+            self._context = None
+            self._rom_data = []
+
+    def _check(self, rc, what):
+        if rc < 0:
+            raise RuntimeError('%s failed with mt32emu return code %d' % (what, rc))
+        return rc
+
+    def add_rom_file(self, filename):
+        return self._check(self._lib.mt32emu_add_rom_file(self._context, os.fsencode(filename)), 'Adding ROM file')
+
+    def add_rom_data(self, data):
+        data = bytes(data)
+        rc = self._check(self._lib.mt32emu_add_rom_data(self._context, data, len(data), None), 'Adding ROM data')
+        self._rom_data.append(data)
+        return rc
+
+    def open(self, analog_output_mode=AOM_COARSE, sample_rate=0, conversion_quality=SRCQ_GOOD):
+        """Opens the synth. With sample_rate 0, the native rate of the analog_output_mode is used."""
+        self._lib.mt32emu_set_analog_output_mode(self._context, analog_output_mode)
+        self._lib.mt32emu_set_stereo_output_samplerate(self._context, sample_rate)
+        self._lib.mt32emu_set_samplerate_conversion_quality(self._context, conversion_quality)
+        self._check(self._lib.mt32emu_open_synth(self._context), 'Opening synth')
+
+    def close(self):
+        self._lib.mt32emu_close_synth(self._context)
+
+    @property
+    def sample_rate(self):
+        return self._lib.mt32emu_get_actual_stereo_output_samplerate(self._context)
+
+    def is_active(self):
+        return bool(self._lib.mt32emu_is_active(self._context))
+
+    def play_msg(self, msg):
+        """Enqueues a short MIDI message packed into an integer, the status byte being the least significant."""
+        return self._check(self._lib.mt32emu_play_msg(self._context, msg), 'Playing MIDI message')
+
+    def play_sysex(self, sysex):
+        sysex = bytes(sysex)
+        return self._check(self._lib.mt32emu_play_sysex(self._context, sysex, len(sysex)), 'Playing SysEx')
+
+    def play_events(self, events):
+        """Enqueues a batch of events sorted by timestamps. Returns the number of events enqueued."""
+        pointer, count = _events_pointer(events)
+        return self._lib.mt32emu_play_events(self._context, pointer, count)
+
+    def render(self, stream, events=None):
+        """Renders into an interleaved stereo buffer of int16 or float32 samples, e.g. a NumPy array
+        of shape (frames, 2). If events are given, they are played at the frame offsets they specify
+        within the rendered stream, and the number of events played is returned."""
+        view, pointer_type = _sample_view(stream, 'stream')
+        frames = view.nbytes // view.itemsize // 2
+        pointer = _pointer(view, pointer_type)
+        if events is None:
+            if pointer_type is ctypes.POINTER(ctypes.c_int16):
+                self._lib.mt32emu_render_bit16s(self._context, pointer, frames)
+            else:
+                self._lib.mt32emu_render_float(self._context, pointer, frames)
+            return 0
+        events_pointer, count = _events_pointer(events)
+        if pointer_type is ctypes.POINTER(ctypes.c_int16):
+            return self._lib.mt32emu_render_bit16s_with_events(self._context, pointer, frames, events_pointer, count)
+        return self._lib.mt32emu_render_float_with_events(self._context, pointer, frames, events_pointer, count)
+
+    def render_planar(self, left, right, events=None):
+        """Renders the channels into separate float32 buffers of equal length, e.g. the rows
+        of a NumPy array of shape (2, frames). Events are handled as in render()."""
+        left_view = _view(left, ('f',), 'left')
+        right_view = _view(right, ('f',), 'right')
+        if left_view.itemsize != 4 or right_view.itemsize != 4 or left_view.nbytes != right_view.nbytes:
+            raise TypeError('left and right must be float32 buffers of equal length')
+        frames = left_view.nbytes // 4
+        float_pointer = ctypes.POINTER(ctypes.c_float)
+        left_pointer = _pointer(left_view, float_pointer)
+        right_pointer = _pointer(right_view, float_pointer)
+        if events is None:
+            self._lib.mt32emu_render_float_planar(self._context, left_pointer, right_pointer, frames)
+            return 0
+        events_pointer, count = _events_pointer(events)
+        return self._lib.mt32emu_render_float_planar_with_events(self._context, left_pointer, right_pointer, frames,
+            events_pointer, count)
@@ -25,17 +25,35 @@
 #include "audiodrv/AudioFileWriterDriver.h"
 
 static const unsigned int FRAME_SIZE = 4; // Stereo, 16-bit
+static const ulong FREE_RUNNING_MAX_SLEEP_MICROS = 1000;
+// Samples are collected in a buffer of this size, so that the file is written in large blocks.
+static const uint WRITE_BUFFER_SIZE = 1 << 20;
+// The header reserves space for the ds64 chunk in a JUNK chunk, as recommended in EBU Tech 3306.
+// This way, the header can be converted to RF64 in place, when the file appears bigger than 4 GiB.
 static const unsigned char WAVE_HEADER[] = {
-	0x52, 0x49, 0x46, 0x46, 0x00, 0x00, 0x00, 0x00, 0x57, 0x41, 0x56, 0x45, 0x66, 0x6D, 0x74, 0x20,
-	0x10, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x44, 0xAC, 0x00, 0x00, 0x10, 0xB1, 0x02, 0x00,
-	0x04, 0x00, 0x10, 0x00, 0x64, 0x61, 0x74, 0x61, 0x00, 0x00, 0x00, 0x00
+	0x52, 0x49, 0x46, 0x46, 0x00, 0x00, 0x00, 0x00, 0x57, 0x41, 0x56, 0x45, 0x4A, 0x55, 0x4E, 0x4B,
+	0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x66, 0x6D, 0x74, 0x20, 0x10, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x44, 0xAC, 0x00, 0x00,
+	0x10, 0xB1, 0x02, 0x00, 0x04, 0x00, 0x10, 0x00, 0x64, 0x61, 0x74, 0x61, 0x00, 0x00, 0x00, 0x00
 };
+static const unsigned char RF64_CHUNK_ID[] = {0x52, 0x46, 0x36, 0x34};
+static const unsigned char DS64_CHUNK_ID[] = {0x64, 0x73, 0x36, 0x34};
+static const unsigned int RIFF_CHUNK_ID_OFFSET = 0;
 static const unsigned int RIFF_PAYLOAD_SIZE_OFFSET = 4;
 static const unsigned int RIFF_HEADER_LENGTH = 8;
-static const unsigned int WAVE_SAMPLE_RATE_OFFSET = 24;
-static const unsigned int WAVE_BYTE_RATE_OFFSET = 28;
-static const unsigned int WAVE_DATA_SIZE_OFFSET = 40;
-static const unsigned int WAVE_HEADER_LENGTH = 44;
+static const unsigned int JUNK_CHUNK_ID_OFFSET = 12;
+static const unsigned int DS64_RIFF_SIZE_OFFSET = 20;
+static const unsigned int DS64_DATA_SIZE_OFFSET = 28;
+static const unsigned int DS64_SAMPLE_COUNT_OFFSET = 36;
+static const unsigned int WAVE_SAMPLE_RATE_OFFSET = 60;
+static const unsigned int WAVE_BYTE_RATE_OFFSET = 64;
+static const unsigned int WAVE_DATA_SIZE_OFFSET = 76;
+static const unsigned int WAVE_HEADER_LENGTH = 80;
+static const quint64 MAX_RIFF_CHUNK_SIZE = 0xFFFFFFFFU;
+// The samples being recorded in the background are buffered for that long, to ride out stalls of the file system.
+static const uint RECORDER_BUFFER_SECONDS = 4;
+static const ulong RECORDER_POLL_INTERVAL_MILLIS = 100;
 
 bool AudioFileWriter::convertSamplesFromNativeEndian(const qint16 *sourceBuffer, qint16 *targetBuffer, uint sampleCount, QSysInfo::Endian targetByteOrder) {
 	if (QSysInfo::ByteOrder == targetByteOrder) return false;
@@ -46,27 +64,30 @@ bool AudioFileWriter::convertSamplesFromNativeEndian(const qint16 *sourceBuffer,
 }
 
 AudioFileWriter::AudioFileWriter(uint sampleRate, const QString &fileName) :
-	sampleRate(sampleRate), fileName(fileName), waveMode(fileName.endsWith(".wav")), file(fileName)
+	sampleRate(sampleRate), fileName(fileName), waveMode(fileName.endsWith(".wav")), file(fileName), writeBuffer(NULL), writeBufferPos(0)
 {}
 
 AudioFileWriter::~AudioFileWriter() {
 	if (file.isOpen()) close();
+	delete[] writeBuffer;
 }
 
 bool AudioFileWriter::open(bool skipInitialSilence) {
-	if (!file.open(QIODevice::WriteOnly)) {
+	// We do our own buffering, so writes of the entire buffer go straight to the file system.
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Unbuffered)) {
 		qDebug() << "AudioFileWriter: Can't open file '" + fileName + "' for writing:" << file.errorString();
 		return false;
 	}
 	if (waveMode) file.seek(WAVE_HEADER_LENGTH);
 	skipSilence = skipInitialSilence;
+	delete[] writeBuffer;
+	writeBuffer = new char[WRITE_BUFFER_SIZE];
+	writeBufferPos = 0;
 	return true;
 }
 
 // Writes samples in native byte order
 bool AudioFileWriter::write(const qint16 *buffer, uint totalFrames) {
-	static const uint MAX_FRAMES_PER_RUN = 4096;
-
 	if (!file.isOpen()) return false;
 
 	const qint32 *startPos = (const qint32 *)buffer;
@@ -83,37 +104,58 @@ bool AudioFileWriter::write(const qint16 *buffer, uint totalFrames) {
 		}
 	}
 
-	qint16 cnvBuffer[MAX_FRAMES_PER_RUN << 1];
 	while (totalFrames > 0) {
-		uint framesToWrite = qMin(MAX_FRAMES_PER_RUN, totalFrames);
-		bool converted = convertSamplesFromNativeEndian(buffer, cnvBuffer, framesToWrite << 1, waveMode ? QSysInfo::LittleEndian : QSysInfo::BigEndian);
-		if (!converted) framesToWrite = totalFrames;
-
-		const char *bufferPos = (const char *)(converted ? cnvBuffer : buffer);
-		qint64 bytesToWrite = framesToWrite * FRAME_SIZE;
-		while (bytesToWrite > 0) {
-			qint64 bytesWritten = file.write(bufferPos, bytesToWrite);
-			if (bytesWritten == -1) {
-				qDebug() << "AudioFileWriter: error writing into the audio file:" << file.errorString();
-				file.close();
-				return false;
-			}
-			bytesToWrite -= bytesWritten;
-			bufferPos += bytesWritten;
+		uint framesToWrite = qMin((WRITE_BUFFER_SIZE - writeBufferPos) / FRAME_SIZE, totalFrames);
+		qint16 *bufferPos = (qint16 *)(writeBuffer + writeBufferPos);
+		uint sampleCount = framesToWrite << 1;
+		if (!convertSamplesFromNativeEndian(buffer, bufferPos, sampleCount, waveMode ? QSysInfo::LittleEndian : QSysInfo::BigEndian)) {
+			memcpy(bufferPos, buffer, sampleCount * sizeof(qint16));
 		}
-		buffer += framesToWrite << 1;
+		writeBufferPos += framesToWrite * FRAME_SIZE;
+		if (writeBufferPos == WRITE_BUFFER_SIZE && !flushWriteBuffer()) return false;
+		buffer += sampleCount;
 		totalFrames -= framesToWrite;
 	}
 	return true;
 }
 
+bool AudioFileWriter::flushWriteBuffer() {
+	const char *bufferPos = writeBuffer;
+	qint64 bytesToWrite = writeBufferPos;
+	writeBufferPos = 0;
+	while (bytesToWrite > 0) {
+		qint64 bytesWritten = file.write(bufferPos, bytesToWrite);
+		if (bytesWritten == -1) {
+			qDebug() << "AudioFileWriter: error writing into the audio file:" << file.errorString();
+			file.close();
+			return false;
+		}
+		bytesToWrite -= bytesWritten;
+		bufferPos += bytesWritten;
+	}
+	return true;
+}
+
 void AudioFileWriter::close() {
+	if (writeBufferPos > 0 && !flushWriteBuffer()) return;
 	if (waveMode) {
 		uchar headerBuffer[WAVE_HEADER_LENGTH];
-		quint32 fileSize = (quint32)file.size();
+		quint64 fileSize = quint64(file.size());
+		quint64 riffSize = fileSize - RIFF_HEADER_LENGTH;
+		quint64 dataSize = fileSize - WAVE_HEADER_LENGTH;
 		memcpy(headerBuffer, WAVE_HEADER, WAVE_HEADER_LENGTH);
-		qToLittleEndian(fileSize - RIFF_HEADER_LENGTH, headerBuffer + RIFF_PAYLOAD_SIZE_OFFSET);
-		qToLittleEndian(fileSize - WAVE_HEADER_LENGTH, headerBuffer + WAVE_DATA_SIZE_OFFSET);
+		if (riffSize > MAX_RIFF_CHUNK_SIZE) {
+			memcpy(headerBuffer + RIFF_CHUNK_ID_OFFSET, RF64_CHUNK_ID, sizeof RF64_CHUNK_ID);
+			memcpy(headerBuffer + JUNK_CHUNK_ID_OFFSET, DS64_CHUNK_ID, sizeof DS64_CHUNK_ID);
+			qToLittleEndian(riffSize, headerBuffer + DS64_RIFF_SIZE_OFFSET);
+			qToLittleEndian(dataSize, headerBuffer + DS64_DATA_SIZE_OFFSET);
+			qToLittleEndian(dataSize / FRAME_SIZE, headerBuffer + DS64_SAMPLE_COUNT_OFFSET);
+			qToLittleEndian(quint32(MAX_RIFF_CHUNK_SIZE), headerBuffer + RIFF_PAYLOAD_SIZE_OFFSET);
+			qToLittleEndian(quint32(MAX_RIFF_CHUNK_SIZE), headerBuffer + WAVE_DATA_SIZE_OFFSET);
+		} else {
+			qToLittleEndian(quint32(riffSize), headerBuffer + RIFF_PAYLOAD_SIZE_OFFSET);
+			qToLittleEndian(quint32(dataSize), headerBuffer + WAVE_DATA_SIZE_OFFSET);
+		}
 		qToLittleEndian(sampleRate, headerBuffer + WAVE_SAMPLE_RATE_OFFSET);
 		qToLittleEndian(sampleRate * FRAME_SIZE, headerBuffer + WAVE_BYTE_RATE_OFFSET);
 		file.seek(0);
@@ -122,6 +164,77 @@ void AudioFileWriter::close() {
 	file.close();
 }
 
+AudioFileRecorder::AudioFileRecorder(uint sampleRate, const QString &fileName) :
+	writer(sampleRate, fileName),
+	// QRingBuffer needs a bit of spare space to accommodate the entire requested size.
+	ringBuffer((RECORDER_BUFFER_SECONDS * sampleRate + 1) * FRAME_SIZE),
+	stopProcessing(false),
+	writeFailed(false),
+	droppedFrameCount(0)
+{}
+
+AudioFileRecorder::~AudioFileRecorder() {
+	stop();
+}
+
+bool AudioFileRecorder::start() {
+	if (!writer.open()) {
+		writeFailed = true;
+		return false;
+	}
+	QThread::start();
+	return true;
+}
+
+bool AudioFileRecorder::write(const qint16 *buffer, uint frameCount) {
+	if (writeFailed) return false;
+	while (frameCount > 0) {
+		quint32 bytesFree;
+		bool freeSpaceContiguous;
+		void *writePointer = ringBuffer.writePointer(bytesFree, freeSpaceContiguous);
+		uint framesToWrite = qMin(uint(bytesFree / FRAME_SIZE), frameCount);
+		if (framesToWrite == 0) {
+			droppedFrameCount += frameCount;
+			break;
+		}
+		memcpy(writePointer, buffer, framesToWrite * FRAME_SIZE);
+		ringBuffer.advanceWritePointer(framesToWrite * FRAME_SIZE);
+		buffer += framesToWrite << 1;
+		frameCount -= framesToWrite;
+	}
+	return true;
+}
+
+void AudioFileRecorder::stop() {
+	if (!isRunning()) return;
+	stopProcessing = true;
+	wait();
+	writer.close();
+	if (droppedFrameCount > 0) {
+		qDebug() << "AudioFileRecorder: Dropped" << droppedFrameCount << "frames, the file system couldn't keep up";
+	}
+}
+
+void AudioFileRecorder::run() {
+	for (;;) {
+		// Some samples may be handed over while the writer is being stopped, they are written as well.
+		const bool lastPass = stopProcessing;
+		quint32 bytesReady;
+		const void *readPointer = ringBuffer.readPointer(bytesReady);
+		while (bytesReady > 0) {
+			if (!writer.write(static_cast<const qint16 *>(readPointer), bytesReady / FRAME_SIZE)) {
+				// The producer finds out upon the next write, then the recorder is stopped promptly as this thread is done.
+				writeFailed = true;
+				return;
+			}
+			ringBuffer.advanceReadPointer(bytesReady);
+			readPointer = ringBuffer.readPointer(bytesReady);
+		}
+		if (lastPass) break;
+		msleep(RECORDER_POLL_INTERVAL_MILLIS);
+	}
+}
+
 AudioFileRenderer::AudioFileRenderer() : buffer(NULL), parsers(NULL) {
 	audioRenderer.synth = NULL;
 	connect(this, SIGNAL(parsingFailed(const QString &, const QString &)), Master::getInstance(), SLOT(showBalloon(const QString &, const QString &)));
@@ -172,7 +285,7 @@ bool AudioFileRenderer::convertMIDIFiles(QString useOutFileName, QStringList mid
 		QMessageBox::critical(NULL, "Error", "Failed to open synth");
 		return false;
 	}
-	Master::getInstance()->setAudioFileWriterSynth(audioRenderer.synth);
+	Master::getInstance()->addAudioFileWriterSynth(audioRenderer.synth);
 	bufferSize = useBufferSize;
 	outFileName = useOutFileName;
 	realtimeMode = false;
@@ -221,7 +334,7 @@ void AudioFileRenderer::run() {
 	AudioFileWriter writer(sampleRate, outFileName);
 	if (!writer.open(!realtimeMode)) {
 		audioFileWriteFailed();
-		if (!realtimeMode) Master::getInstance()->setAudioFileWriterSynth(NULL);
+		if (!realtimeMode) Master::getInstance()->removeAudioFileWriterSynth(audioRenderer.synth);
 		emit conversionFinished();
 		return;
 	}
@@ -242,12 +355,17 @@ void AudioFileRenderer::run() {
 	while (!stopProcessing) {
 		uint frameCount = 0;
 		if (realtimeMode) {
-			frameCount = uint((sampleRate * (MasterClock::getClockNanos() - firstSampleNanos)) / MasterClock::NANOS_PER_SECOND);
-			if (frameCount < bufferSize) {
-				usleep(ulong((MasterClock::MICROS_PER_SECOND * (bufferSize - frameCount)) / sampleRate));
+			// In the free-running mode, we may go ahead of realtime, so the frame count can be negative.
+			qint64 realtimeFrameCount = (sampleRate * (MasterClock::getClockNanos() - firstSampleNanos)) / MasterClock::NANOS_PER_SECOND;
+			qint64 freeRunningFrameCount = audioRenderer.audioStream->getFreeRunningFrameCount();
+			if (realtimeFrameCount < bufferSize && freeRunningFrameCount == 0) {
+				ulong sleepMicros = ulong((MasterClock::MICROS_PER_SECOND * (bufferSize - qMax(realtimeFrameCount, qint64(0)))) / sampleRate);
+				// A MIDI source running ahead of realtime may report progress anytime, so keep sleeps short.
+				if (audioRenderer.audioStream->isFreeRunning()) sleepMicros = qMin(sleepMicros, FREE_RUNNING_MAX_SLEEP_MICROS);
+				usleep(sleepMicros);
 				continue;
 			} else {
-				frameCount = bufferSize;
+				frameCount = uint(qMin(qMax(realtimeFrameCount, freeRunningFrameCount), qint64(bufferSize)));
 			}
 		} else {
 			while (midiEventIx < midiEvents.count()) {
@@ -265,7 +383,7 @@ void AudioFileRenderer::run() {
 						eventPushed = audioRenderer.synth->playMIDIShortMessage(e.getShortMessage(), nextEventFrames);
 						break;
 					case SYSEX:
-						eventPushed = audioRenderer.synth->playMIDISysex(e.getSysexData(), e.getSysexLen(), nextEventFrames);
+						eventPushed = audioRenderer.synth->playMIDISysex(midiEvents.getSysexData(e), midiEvents.getSysexLen(e), nextEventFrames);
 						break;
 					case SET_TEMPO:
 						midiTick = parsers[parserIx].getMidiTick(e.getShortMessage());
@@ -299,7 +417,7 @@ void AudioFileRenderer::run() {
 			render(buffer, framesToRender);
 			if (!writer.write(buffer, framesToRender)) {
 				audioFileWriteFailed();
-				if (!realtimeMode) Master::getInstance()->setAudioFileWriterSynth(NULL);
+				if (!realtimeMode) Master::getInstance()->removeAudioFileWriterSynth(audioRenderer.synth);
 				emit conversionFinished();
 				return;
 			}
@@ -312,7 +430,7 @@ void AudioFileRenderer::run() {
 	if (!realtimeMode) {
 		qDebug() << "AudioFileRenderer: Elapsed seconds: " << 1e-9 * (MasterClock::getClockNanos() - startNanos);
 		audioRenderer.synth->close();
-		Master::getInstance()->setAudioFileWriterSynth(NULL);
+		Master::getInstance()->removeAudioFileWriterSynth(audioRenderer.synth);
 	}
 	writer.close();
 	if (!stopProcessing) emit conversionFinished();
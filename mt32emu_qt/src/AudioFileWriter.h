@@ -3,6 +3,8 @@
 
 #include <QtCore>
 
+#include "QRingBuffer.h"
+
 class AudioFileWriter {
 public:
 	static bool convertSamplesFromNativeEndian(const qint16 *sourceBuffer, qint16 *targetBuffer, uint sampleCount, QSysInfo::Endian targetByteOrder);
@@ -20,6 +22,37 @@ private:
 	const bool waveMode;
 	QFile file;
 	bool skipSilence;
+	char *writeBuffer;
+	uint writeBufferPos;
+
+	bool flushWriteBuffer();
+};
+
+// Records an audio stream in the background, so that the file I/O never blocks the realtime thread the samples are
+// produced by. The samples are handed over through a lock-free ring buffer, which the writer thread drains periodically.
+// Should the file system stall for longer than the ring buffer lasts, the samples that don't fit are dropped and counted.
+class AudioFileRecorder : public QThread {
+public:
+	AudioFileRecorder(uint sampleRate, const QString &fileName);
+	~AudioFileRecorder();
+
+	// Opens the file and starts the writer thread.
+	bool start();
+	// Invoked from the thread that produces the samples, never blocks. Returns false once writing to the file has failed.
+	bool write(const qint16 *buffer, uint frameCount);
+	// Waits for the writer thread to write all the samples handed over and closes the file.
+	void stop();
+
+protected:
+	void run();
+
+private:
+	AudioFileWriter writer;
+	Utility::QRingBuffer ringBuffer;
+	volatile bool stopProcessing;
+	volatile bool writeFailed;
+	// Only accessed by the producer thread, until the writer thread is stopped.
+	quint64 droppedFrameCount;
 };
 
 class AudioFileWriterStream;
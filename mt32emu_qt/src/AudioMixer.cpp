@@ -0,0 +1,246 @@
+/* Copyright (C) 2011-2021 Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "AudioMixer.h"
+#include "Master.h"
+#include "RealtimeReadLocker.h"
+#include "SynthRoute.h"
+
+using namespace MT32Emu;
+
+static const uint CHANNEL_COUNT = 2;
+// The maximum number of frames mixed at once, the longer requests of the output stream are split.
+static const uint MIX_CHUNK_FRAMES = 512;
+
+MixerAudioStream::MixerAudioStream(const AudioDriverSettings &useSettings, SynthRoute &useSynthRoute, const quint32 useSampleRate,
+	AudioMixer &useMixer, const quint64 useStartFramesCount) :
+	AudioStream(useSettings, useSynthRoute, useSampleRate), mixer(useMixer), startFramesCount(useStartFramesCount), renderNanos(0)
+{}
+
+MixerAudioStream::~MixerAudioStream() {
+	if (mixer.removeInputStream(this)) Master::getInstance()->releaseAudioMixer(&mixer);
+}
+
+// Intended to be called from MIDI receiving threads.
+quint64 MixerAudioStream::estimateMIDITimestamp(const MasterClockNanos refNanos) {
+	quint64 timestamp = mixer.outputStream->estimateMIDITimestamp(refNanos);
+	return timestamp > startFramesCount ? timestamp - startFramesCount : 0;
+}
+
+// Intended to be called from MIDI receiving threads.
+MasterClockNanos MixerAudioStream::getMIDIClockNanos() {
+	return mixer.outputStream->getMIDIClockNanos();
+}
+
+// Intended to be called from MIDI receiving threads.
+bool MixerAudioStream::reportMIDIProgress(const MasterClockNanos midiNanos) {
+	return mixer.outputStream->reportMIDIProgress(midiNanos);
+}
+
+void MixerAudioStream::setOnsetDetectionEnabled(bool enabled) {
+	mixer.outputStream->setOnsetDetectionEnabled(enabled);
+}
+
+MasterClockNanos MixerAudioStream::getLastOnsetNanos() const {
+	return mixer.outputStream->getLastOnsetNanos();
+}
+
+// The route stays aligned to the output stream even when it misses some rendering passes, namely the one in progress
+// when it joined, and those skipped while the list of routes was being modified. The audio of those is lost,
+// though the MIDI events due within are played at once.
+void MixerAudioStream::catchUp(const quint64 outputFramesCount) {
+	const quint64 expectedFramesCount = outputFramesCount - startFramesCount;
+	const quint64 framesCount = getRenderedFramesCount();
+	if (framesCount < expectedFramesCount) framesRendered(quint32(expectedFramesCount - framesCount));
+}
+
+AudioMixer::AudioMixer(const AudioDevice &useAudioDevice, const uint useSampleRate) :
+	audioDriver(useAudioDevice.driver), driverId(useAudioDevice.driver.id), deviceName(useAudioDevice.name), sampleRate(useSampleRate),
+	outputStream(), realtimeMode(), multiMidiMode(), outputFailed()
+{}
+
+AudioMixer::~AudioMixer() {
+	qDebug() << "AudioMixer: Stopping output stream on" << driverId << deviceName;
+	delete outputStream;
+}
+
+bool AudioMixer::start(const AudioDevice &useAudioDevice) {
+	qDebug() << "AudioMixer: Starting output stream on" << driverId << deviceName << "at" << sampleRate << "Hz";
+	outputStream = useAudioDevice.startAudioStream(*this, sampleRate);
+	return outputStream != NULL;
+}
+
+bool AudioMixer::matches(const AudioDevice &useAudioDevice, const uint useSampleRate) const {
+	return driverId == useAudioDevice.driver.id && deviceName == useAudioDevice.name && sampleRate == useSampleRate;
+}
+
+bool AudioMixer::hasInputStreams() {
+	QReadLocker inputStreamsLocker(&inputStreamsLock);
+	return !inputStreams.isEmpty();
+}
+
+AudioStream *AudioMixer::startAudioStream(SynthRoute &synthRoute) {
+	if (outputFailed) return NULL;
+	MixerAudioStream *inputStream = new MixerAudioStream(audioDriver.getAudioSettings(), synthRoute, sampleRate, *this,
+		outputStream->takeRenderedFramesCountSnapshot());
+	if (realtimeMode) synthRoute.enableRealtimeMode();
+	if (multiMidiMode) synthRoute.enableMultiMidiMode();
+	QWriteLocker inputStreamsLocker(&inputStreamsLock);
+	inputStreams.append(inputStream);
+	qDebug() << "AudioMixer: Mixing" << inputStreams.size() << "routes on" << driverId << deviceName;
+	return inputStream;
+}
+
+bool AudioMixer::removeInputStream(MixerAudioStream *inputStream) {
+	QWriteLocker inputStreamsLocker(&inputStreamsLock);
+	inputStreams.removeOne(inputStream);
+	return inputStreams.isEmpty();
+}
+
+void AudioMixer::beginRenderingPass() {
+	const quint64 outputFramesCount = outputStream->getRenderedFramesCount();
+	for (int streamIx = 0; streamIx < inputStreams.size(); streamIx++) {
+		MixerAudioStream *inputStream = inputStreams.at(streamIx);
+		inputStream->catchUp(outputFramesCount);
+	}
+}
+
+void AudioMixer::endRenderingPass(const uint frameCount) {
+	const MasterClockNanos nanosNow = MasterClock::getClockNanos();
+	for (int streamIx = 0; streamIx < inputStreams.size(); streamIx++) {
+		MixerAudioStream *inputStream = inputStreams.at(streamIx);
+		inputStream->framesRendered(frameCount);
+		inputStream->updateRenderTimingStats(frameCount, nanosNow - inputStream->renderNanos, nanosNow);
+		inputStream->renderNanos = 0;
+	}
+}
+
+// Only called from the rendering thread. The mix saturates as the output of a single synth does.
+void AudioMixer::render(Bit16s *buffer, uint length) {
+	RealtimeReadLocker inputStreamsLocker(inputStreamsLock);
+	if (!inputStreamsLocker.isLocked() || inputStreams.isEmpty()) {
+		memset(buffer, 0, CHANNEL_COUNT * length * sizeof(Bit16s));
+		return;
+	}
+	beginRenderingPass();
+	const uint frameCount = length;
+	qint32 mixBuffer[CHANNEL_COUNT * MIX_CHUNK_FRAMES];
+	Bit16s inputBuffer[CHANNEL_COUNT * MIX_CHUNK_FRAMES];
+	while (length > 0) {
+		const uint chunkLength = qMin(length, MIX_CHUNK_FRAMES);
+		const uint sampleCount = CHANNEL_COUNT * chunkLength;
+		memset(mixBuffer, 0, sampleCount * sizeof(qint32));
+		for (int streamIx = 0; streamIx < inputStreams.size(); streamIx++) {
+			MixerAudioStream *inputStream = inputStreams.at(streamIx);
+			const MasterClockNanos renderStartNanos = MasterClock::getClockNanos();
+			inputStream->audioSource.render(inputBuffer, chunkLength);
+			inputStream->renderNanos += MasterClock::getClockNanos() - renderStartNanos;
+			for (uint i = 0; i < sampleCount; i++) {
+				mixBuffer[i] += inputBuffer[i];
+			}
+		}
+		for (uint i = 0; i < sampleCount; i++) {
+			*(buffer++) = Bit16s(qBound(-32768, mixBuffer[i], 32767));
+		}
+		length -= chunkLength;
+	}
+	endRenderingPass(frameCount);
+}
+
+// Only called from the rendering thread.
+void AudioMixer::render(float *buffer, uint length) {
+	RealtimeReadLocker inputStreamsLocker(inputStreamsLock);
+	memset(buffer, 0, CHANNEL_COUNT * length * sizeof(float));
+	if (!inputStreamsLocker.isLocked() || inputStreams.isEmpty()) return;
+	beginRenderingPass();
+	const uint frameCount = length;
+	float inputBuffer[CHANNEL_COUNT * MIX_CHUNK_FRAMES];
+	while (length > 0) {
+		const uint chunkLength = qMin(length, MIX_CHUNK_FRAMES);
+		const uint sampleCount = CHANNEL_COUNT * chunkLength;
+		for (int streamIx = 0; streamIx < inputStreams.size(); streamIx++) {
+			MixerAudioStream *inputStream = inputStreams.at(streamIx);
+			const MasterClockNanos renderStartNanos = MasterClock::getClockNanos();
+			inputStream->audioSource.render(inputBuffer, chunkLength);
+			inputStream->renderNanos += MasterClock::getClockNanos() - renderStartNanos;
+			for (uint i = 0; i < sampleCount; i++) {
+				buffer[i] += inputBuffer[i];
+			}
+		}
+		buffer += sampleCount;
+		length -= chunkLength;
+	}
+	endRenderingPass(frameCount);
+}
+
+// Only called from the rendering thread.
+void AudioMixer::render(float *leftBuffer, float *rightBuffer, uint length) {
+	RealtimeReadLocker inputStreamsLocker(inputStreamsLock);
+	memset(leftBuffer, 0, length * sizeof(float));
+	memset(rightBuffer, 0, length * sizeof(float));
+	if (!inputStreamsLocker.isLocked() || inputStreams.isEmpty()) return;
+	beginRenderingPass();
+	const uint frameCount = length;
+	float inputLeftBuffer[MIX_CHUNK_FRAMES];
+	float inputRightBuffer[MIX_CHUNK_FRAMES];
+	while (length > 0) {
+		const uint chunkLength = qMin(length, MIX_CHUNK_FRAMES);
+		for (int streamIx = 0; streamIx < inputStreams.size(); streamIx++) {
+			MixerAudioStream *inputStream = inputStreams.at(streamIx);
+			const MasterClockNanos renderStartNanos = MasterClock::getClockNanos();
+			inputStream->audioSource.render(inputLeftBuffer, inputRightBuffer, chunkLength);
+			inputStream->renderNanos += MasterClock::getClockNanos() - renderStartNanos;
+			for (uint i = 0; i < chunkLength; i++) {
+				leftBuffer[i] += inputLeftBuffer[i];
+				rightBuffer[i] += inputRightBuffer[i];
+			}
+		}
+		leftBuffer += chunkLength;
+		rightBuffer += chunkLength;
+		length -= chunkLength;
+	}
+	endRenderingPass(frameCount);
+}
+
+// The routes are closed as they would be if each had a stream of its own, and the mixer goes away with the last of them.
+void AudioMixer::audioStreamFailed() {
+	outputFailed = true;
+	QReadLocker inputStreamsLocker(&inputStreamsLock);
+	for (int streamIx = 0; streamIx < inputStreams.size(); streamIx++) {
+		MixerAudioStream *inputStream = inputStreams.at(streamIx);
+		inputStream->audioSource.audioStreamFailed();
+	}
+}
+
+void AudioMixer::enableRealtimeMode() {
+	realtimeMode = true;
+	QReadLocker inputStreamsLocker(&inputStreamsLock);
+	for (int streamIx = 0; streamIx < inputStreams.size(); streamIx++) {
+		MixerAudioStream *inputStream = inputStreams.at(streamIx);
+		inputStream->audioSource.enableRealtimeMode();
+	}
+}
+
+void AudioMixer::enableMultiMidiMode() {
+	multiMidiMode = true;
+	QReadLocker inputStreamsLocker(&inputStreamsLock);
+	for (int streamIx = 0; streamIx < inputStreams.size(); streamIx++) {
+		MixerAudioStream *inputStream = inputStreams.at(streamIx);
+		inputStream->audioSource.enableMultiMidiMode();
+	}
+}
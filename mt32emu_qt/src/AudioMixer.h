@@ -0,0 +1,86 @@
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include <QtCore>
+
+#include <mt32emu/mt32emu.h>
+
+#include "audiodrv/AudioDriver.h"
+
+class SynthRoute;
+class AudioMixer;
+
+// The AudioStream of a SynthRoute that plays through an AudioMixer. It has no buffering of its own, the route is rendered
+// by the mixer in the callback of the output stream. The MIDI timestamps are estimated by the output stream, hence all
+// the routes mixed together follow the same clock. The timestamps of each route are merely offset by the number
+// of frames the output stream has rendered before the route joined.
+class MixerAudioStream : public AudioStream {
+friend class AudioMixer;
+private:
+	AudioMixer &mixer;
+	// The rendered frame count of the output stream that corresponds to the start of this stream.
+	const quint64 startFramesCount;
+	// The time spent rendering the route in the current rendering pass of the mixer.
+	MasterClockNanos renderNanos;
+
+	MixerAudioStream(const AudioDriverSettings &settings, SynthRoute &synthRoute, const quint32 sampleRate, AudioMixer &mixer, const quint64 startFramesCount);
+
+	// Only called from the rendering thread.
+	void catchUp(const quint64 outputFramesCount);
+
+public:
+	~MixerAudioStream();
+	quint64 estimateMIDITimestamp(const MasterClockNanos refNanos);
+	MasterClockNanos getMIDIClockNanos();
+	bool reportMIDIProgress(const MasterClockNanos midiNanos);
+	// The onsets are detected in the mix rendered by the output stream.
+	void setOnsetDetectionEnabled(bool enabled);
+	MasterClockNanos getLastOnsetNanos() const;
+};
+
+// Renders all the routes that share an audio device into a single stereo stream. Only one stream is started
+// on the device, so there is only one callback and one set of buffers regardless of the number of the routes.
+// The mixer is created by Master once a route is opened with audio mixing enabled, and it is deleted when the last route
+// leaves. The routes may join and leave while the output stream is running.
+class AudioMixer : public AudioSource {
+friend class MixerAudioStream;
+public:
+	AudioMixer(const AudioDevice &audioDevice, const uint sampleRate);
+	~AudioMixer();
+
+	bool start(const AudioDevice &audioDevice);
+	bool matches(const AudioDevice &audioDevice, const uint sampleRate) const;
+	bool hasInputStreams();
+	// Returns NULL if the output stream failed.
+	AudioStream *startAudioStream(SynthRoute &synthRoute);
+
+	void render(MT32Emu::Bit16s *buffer, uint length);
+	void render(float *buffer, uint length);
+	void render(float *leftBuffer, float *rightBuffer, uint length);
+	void audioStreamFailed();
+	void enableRealtimeMode();
+	void enableMultiMidiMode();
+
+private:
+	// The device objects are recreated each time the devices are scanned, so only the driver is kept.
+	AudioDriver &audioDriver;
+	const QString driverId;
+	const QString deviceName;
+	const uint sampleRate;
+	AudioStream *outputStream;
+	QList<MixerAudioStream *> inputStreams;
+	// Protects inputStreams against modifications while rendering.
+	QReadWriteLock inputStreamsLock;
+	// The modes requested by the output stream, which are also applied to the routes that join later.
+	bool realtimeMode;
+	bool multiMidiMode;
+	volatile bool outputFailed;
+
+	// Returns true if the mixer has no more input streams.
+	bool removeInputStream(MixerAudioStream *inputStream);
+	// Only called from the rendering thread while inputStreamsLock is held.
+	void beginRenderingPass();
+	void endRenderingPass(const uint frameCount);
+};
+
+#endif
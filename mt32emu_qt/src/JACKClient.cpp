@@ -67,6 +67,14 @@ JACKClient::~JACKClient() {
 	close();
 }
 
+quint32 JACKClient::getSystemSampleRate() {
+	jack_client_t *queryClient = jack_client_open("mt32emu-qt", JackNoStartServer, NULL);
+	if (queryClient == NULL) return 0;
+	quint32 systemSampleRate = jack_get_sample_rate(queryClient);
+	jack_client_close(queryClient);
+	return systemSampleRate;
+}
+
 JACKClientState JACKClient::open(MidiSession *useMidiSession, JACKAudioStream *useAudioStream) {
 	if (state != JACKClientState_CLOSED) return state;
 	client = jack_client_open("mt32emu-qt", JackNullOption, NULL);
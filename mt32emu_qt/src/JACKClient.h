@@ -17,6 +17,9 @@ class JACKAudioStream;
 
 class JACKClient {
 public:
+	// Queries the sample rate of a running JACK server, returns 0 if there is none.
+	static quint32 getSystemSampleRate();
+
 	JACKClient();
 	virtual ~JACKClient();
 
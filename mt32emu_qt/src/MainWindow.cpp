@@ -47,6 +47,7 @@ MainWindow::MainWindow(Master *master, QWidget *parent) :
 	ui(new Ui::MainWindow),
 	master(master),
 	testMidiDriver(NULL),
+	latencyMeasurementMidiDriver(NULL),
 	audioFileWriter(NULL),
 	midiPlayerDialog(NULL),
 	midiConverterDialog(NULL)
@@ -83,6 +84,10 @@ MainWindow::MainWindow(Master *master, QWidget *parent) :
 	ui->actionNew_JACK_MIDI_port->setVisible(true);
 	ui->actionNew_exclusive_JACK_MIDI_port->setVisible(true);
 #endif
+#ifdef WITH_PIPEWIRE_MIDI_DRIVER
+	ui->actionNew_PipeWire_MIDI_port->setVisible(true);
+	ui->actionNew_exclusive_PipeWire_MIDI_port->setVisible(true);
+#endif
 }
 
 MainWindow::~MainWindow()
@@ -108,6 +113,10 @@ void MainWindow::on_actionExit_triggered() {
 		delete testMidiDriver;
 		testMidiDriver = NULL;
 	}
+	if (latencyMeasurementMidiDriver != NULL) {
+		delete latencyMeasurementMidiDriver;
+		latencyMeasurementMidiDriver = NULL;
+	}
 	if (audioFileWriter != NULL) {
 		delete audioFileWriter;
 		audioFileWriter = NULL;
@@ -205,6 +214,20 @@ void MainWindow::on_actionTest_MIDI_Driver_toggled(bool checked) {
 	}
 }
 
+void MainWindow::on_actionMeasure_MIDI_to_audio_latency_toggled(bool checked) {
+	bool running = latencyMeasurementMidiDriver != NULL;
+	if (running != checked) {
+		if (running) {
+			latencyMeasurementMidiDriver->stop();
+			delete latencyMeasurementMidiDriver;
+			latencyMeasurementMidiDriver = NULL;
+		} else {
+			latencyMeasurementMidiDriver = new TestMidiDriver(master, TestMode_LATENCY_MEASUREMENT);
+			latencyMeasurementMidiDriver->start();
+		}
+	}
+}
+
 void MainWindow::on_actionPlay_MIDI_file_triggered() {
 	if (midiPlayerDialog == NULL) {
 		midiPlayerDialog = new MidiPlayerDialog(master, this);
@@ -226,6 +249,7 @@ void MainWindow::on_menuOptions_aboutToShow() {
 	ui->actionHide_to_tray_on_close->setChecked(master->getSettings()->value("Master/hideToTrayOnClose", false).toBool());
 	ui->actionShow_LCD_balloons->setChecked(master->getSettings()->value("Master/showLCDBalloons", true).toBool());
 	ui->actionShow_connection_balloons->setChecked(master->getSettings()->value("Master/showConnectionBalloons", true).toBool());
+	ui->actionMix_audio_streams->setChecked(master->isAudioMixingEnabled());
 }
 
 void MainWindow::on_actionStart_iconized_toggled(bool checked) {
@@ -244,6 +268,11 @@ void MainWindow::on_actionShow_connection_balloons_toggled(bool checked) {
 	master->getSettings()->setValue("Master/showConnectionBalloons", checked);
 }
 
+// Takes effect for the synths opened afterwards.
+void MainWindow::on_actionMix_audio_streams_toggled(bool checked) {
+	master->getSettings()->setValue("Master/mixAudioStreams", checked);
+}
+
 void MainWindow::on_actionROM_Configuration_triggered() {
 	showROMSelectionDialog();
 }
@@ -346,3 +375,15 @@ void MainWindow::on_actionNew_exclusive_JACK_MIDI_port_triggered() {
 	QMessageBox::warning(this, "Error", "Failed to create JACK MIDI port");
 }
 #endif
+
+#ifdef WITH_PIPEWIRE_MIDI_DRIVER
+void MainWindow::on_actionNew_PipeWire_MIDI_port_triggered() {
+	if (master->createPipeWireMidiPort(false)) return;
+	QMessageBox::warning(this, "Error", "Failed to create PipeWire MIDI port");
+}
+
+void MainWindow::on_actionNew_exclusive_PipeWire_MIDI_port_triggered() {
+	if (master->createPipeWireMidiPort(true)) return;
+	QMessageBox::warning(this, "Error", "Failed to create PipeWire MIDI port");
+}
+#endif
@@ -34,6 +34,7 @@ private:
 	Ui::MainWindow *ui;
 	Master *master;
 	MidiDriver *testMidiDriver;
+	MidiDriver *latencyMeasurementMidiDriver;
 	AudioFileWriter *audioFileWriter;
 	MidiPlayerDialog *midiPlayerDialog;
 	MidiConverterDialog *midiConverterDialog;
@@ -50,6 +51,7 @@ private slots:
 	void on_menuMIDI_aboutToShow();
 	void on_actionNew_MIDI_port_triggered();
 	void on_actionTest_MIDI_Driver_toggled(bool checked);
+	void on_actionMeasure_MIDI_to_audio_latency_toggled(bool checked);
 	void on_actionPlay_MIDI_file_triggered();
 	void on_actionConvert_MIDI_to_Wave_triggered();
 	void on_menuOptions_aboutToShow();
@@ -57,6 +59,7 @@ private slots:
 	void on_actionHide_to_tray_on_close_toggled(bool checked);
 	void on_actionShow_LCD_balloons_toggled(bool checked);
 	void on_actionShow_connection_balloons_toggled(bool checked);
+	void on_actionMix_audio_streams_toggled(bool checked);
 	void on_actionROM_Configuration_triggered();
 	void refreshTabNames();
 	void showHideMainWindow();
@@ -70,6 +73,12 @@ private slots:
 	void on_actionNew_JACK_MIDI_port_triggered();
 	void on_actionNew_exclusive_JACK_MIDI_port_triggered();
 #endif
+
+#ifdef WITH_PIPEWIRE_MIDI_DRIVER
+private slots:
+	void on_actionNew_PipeWire_MIDI_port_triggered();
+	void on_actionNew_exclusive_PipeWire_MIDI_port_triggered();
+#endif
 };
 
 #endif // MAINWINDOW_H
@@ -18,9 +18,16 @@
 #include <QDropEvent>
 #include <QMessageBox>
 
+#if defined(Q_OS_WIN) && defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0501
+#define WITH_WIN_NUMA
+#include <windows.h>
+#endif
+
 #include "Master.h"
 #include "MasterClock.h"
 #include "MidiSession.h"
+#include "RenderingThreadPool.h"
+#include "Tracer.h"
 
 #ifdef WITH_WINMM_AUDIO_DRIVER
 #include "audiodrv/WinMMAudioDriver.h"
@@ -40,6 +47,9 @@
 #ifdef WITH_JACK_AUDIO_DRIVER
 #include "audiodrv/JACKAudioDriver.h"
 #endif
+#ifdef WITH_PIPEWIRE_AUDIO_DRIVER
+#include "audiodrv/PipeWireAudioDriver.h"
+#endif
 #ifdef WITH_PORT_AUDIO_DRIVER
 #include "audiodrv/PortAudioDriver.h"
 #endif
@@ -48,6 +58,7 @@
 #endif
 
 #include "audiodrv/AudioFileWriterDriver.h"
+#include "AudioMixer.h"
 
 #ifdef WITH_WIN32_MIDI_DRIVER
 #include "mididrv/Win32Driver.h"
@@ -62,11 +73,77 @@
 #ifdef WITH_JACK_MIDI_DRIVER
 #include "mididrv/JACKMidiDriver.h"
 #endif
+#ifdef WITH_PIPEWIRE_MIDI_DRIVER
+#include "mididrv/PipeWireMidiDriver.h"
+#endif
+#ifdef WITH_NETWORK_MIDI_DRIVER
+#include "mididrv/NetworkMidiDriver.h"
+#endif
 
 static const int ACTUAL_SETTINGS_VERSION = 2;
+// The cache is simply dropped when it grows that big, to get rid of the entries of files that disappeared.
+static const int MAX_ROM_INFO_CACHE_SIZE = 256;
 
 static Master *instance = NULL;
 
+class AudioDeviceScanTask : public QRunnable {
+private:
+	Master &master;
+	AudioDriver &audioDriver;
+	const int driverIx;
+
+public:
+	AudioDeviceScanTask(Master &useMaster, AudioDriver &useAudioDriver, int useDriverIx) :
+		master(useMaster), audioDriver(useAudioDriver), driverIx(useDriverIx)
+	{}
+
+	void run() {
+		const QList<const AudioDevice *> deviceList = audioDriver.createDeviceList();
+		{
+			QMutexLocker audioDeviceScanLocker(&master.audioDeviceScanMutex);
+			master.scannedAudioDevices[driverIx] = deviceList;
+			master.audioDeviceScanFinishedFlags[driverIx] = true;
+			master.finishedAudioDeviceScanCount++;
+			master.audioDeviceScanFinished.wakeAll();
+		}
+		QMetaObject::invokeMethod(&master, "handleAudioDeviceScanFinished", Qt::QueuedConnection);
+	}
+};
+
+#if defined(Q_OS_LINUX)
+// Parses the lists of the form "0-3,8,10-11" the kernel exposes for the sets of CPUs and NUMA nodes.
+static QList<int> readSysfsList(const QString &pathName) {
+	QList<int> list;
+	QFile file(pathName);
+	if (!file.open(QIODevice::ReadOnly)) return list;
+	foreach (const QString &item, QString::fromLatin1(file.readAll()).trimmed().split(',')) {
+		const QStringList bounds = item.split('-');
+		bool firstOk, lastOk;
+		const int first = bounds.first().toInt(&firstOk);
+		const int last = bounds.last().toInt(&lastOk);
+		if (bounds.size() > 2 || !firstOk || !lastOk) continue;
+		for (int i = first; i <= last; i++) list << i;
+	}
+	return list;
+}
+#endif
+
+// Only the nodes with CPU cores are considered, since the synths on the others would merely render from remote memory.
+static QList<int> getNUMANodes() {
+	QList<int> numaNodes;
+#if defined(WITH_WIN_NUMA)
+	ULONG highestNodeNumber = 0;
+	if (!GetNumaHighestNodeNumber(&highestNodeNumber)) return numaNodes;
+	for (ULONG numaNode = 0; numaNode <= highestNodeNumber && numaNode <= 255; numaNode++) {
+		ULONGLONG processorMask = 0;
+		if (GetNumaNodeProcessorMask(UCHAR(numaNode), &processorMask) && processorMask != 0) numaNodes << int(numaNode);
+	}
+#elif defined(Q_OS_LINUX)
+	numaNodes = readSysfsList("/sys/devices/system/node/has_cpu");
+#endif
+	return numaNodes;
+}
+
 static void migrateSettings(QSettings &settings, const int fromVersion) {
 	qDebug() << "Migrating settings from version" << fromVersion << "to version" << ACTUAL_SETTINGS_VERSION;
 	switch (fromVersion) {
@@ -104,6 +181,22 @@ Master::Master() {
 
 	synthProfileName = settings->value("Master/defaultSynthProfile", "default").toString();
 
+	if (settings->value("Master/sharedRenderingThreadPool", false).toBool()) {
+		QList<int> numaNodes;
+		if (settings->value("Master/numaAwarePlacement", false).toBool()) numaNodes = getNUMANodes();
+		if (numaNodes.size() < 2) numaNodes.clear();
+		renderingThreadPool = new RenderingThreadPool(settings->value("Master/renderingThreadCount", 0).toUInt(), numaNodes);
+	} else {
+		renderingThreadPool = NULL;
+	}
+
+	QString traceFileName = settings->value("Master/traceFileName").toString();
+	if (traceFileName.isEmpty()) {
+		tracer = NULL;
+	} else {
+		tracer = new Tracer(traceFileName, settings->value("Master/traceSpanCapacity", 262144).toUInt());
+	}
+
 	trayIcon = NULL;
 	defaultAudioDriverId = settings->value("Master/DefaultAudioDriver").toString();
 	defaultAudioDeviceName = settings->value("Master/DefaultAudioDevice").toString();
@@ -111,9 +204,8 @@ Master::Master() {
 	initAudioDrivers();
 	initMidiDrivers();
 	lastAudioDeviceScan = -4 * MasterClock::NANOS_PER_SECOND;
-	getAudioDevices();
+	startAudioDeviceScan();
 	pinnedSynthRoute = NULL;
-	audioFileWriterSynth = NULL;
 
 	qRegisterMetaType<MidiDriver *>("MidiDriver*");
 	qRegisterMetaType<MidiSession *>("MidiSession*");
@@ -138,12 +230,33 @@ Master::~Master() {
 	jackMidiDriver = NULL;
 #endif
 
+#ifdef WITH_PIPEWIRE_MIDI_DRIVER
+	pipeWireMidiDriver->stop();
+	delete pipeWireMidiDriver;
+	pipeWireMidiDriver = NULL;
+#endif
+
+#ifdef WITH_NETWORK_MIDI_DRIVER
+	networkMidiDriver->stop();
+	delete networkMidiDriver;
+	networkMidiDriver = NULL;
+#endif
+
 	QMutableListIterator<SynthRoute *> synthRouteIt(synthRoutes);
 	while (synthRouteIt.hasNext()) {
 		delete synthRouteIt.next();
 		synthRouteIt.remove();
 	}
 
+	delete renderingThreadPool;
+	renderingThreadPool = NULL;
+
+	// All the threads that record spans are stopped by now.
+	delete tracer;
+	tracer = NULL;
+
+	audioDeviceScanThreadPool.waitForDone();
+	mergeScannedAudioDevices();
 	QMutableListIterator<const AudioDevice *> audioDeviceIt(audioDevices);
 	while (audioDeviceIt.hasNext()) {
 		delete audioDeviceIt.next();
@@ -178,6 +291,9 @@ void Master::initAudioDrivers() {
 #ifdef WITH_JACK_AUDIO_DRIVER
 	audioDrivers.append(new JACKAudioDriver(this));
 #endif
+#ifdef WITH_PIPEWIRE_AUDIO_DRIVER
+	audioDrivers.append(new PipeWireAudioDriver(this));
+#endif
 #ifdef WITH_PORT_AUDIO_DRIVER
 	audioDrivers.append(new PortAudioDriver(this));
 #endif
@@ -201,6 +317,14 @@ void Master::initMidiDrivers() {
 #ifdef WITH_JACK_MIDI_DRIVER
 	jackMidiDriver = new JACKMidiDriver(this);
 #endif
+
+#ifdef WITH_PIPEWIRE_MIDI_DRIVER
+	pipeWireMidiDriver = new PipeWireMidiDriver(this);
+#endif
+
+#ifdef WITH_NETWORK_MIDI_DRIVER
+	networkMidiDriver = new NetworkMidiDriver(this);
+#endif
 }
 
 void Master::startMidiProcessing() {
@@ -211,6 +335,14 @@ void Master::startMidiProcessing() {
 #ifdef WITH_JACK_MIDI_DRIVER
 	jackMidiDriver->start();
 #endif
+
+#ifdef WITH_PIPEWIRE_MIDI_DRIVER
+	pipeWireMidiDriver->start();
+#endif
+
+#ifdef WITH_NETWORK_MIDI_DRIVER
+	networkMidiDriver->start();
+#endif
 }
 
 Master *Master::getInstance() {
@@ -299,7 +431,71 @@ void Master::setDefaultAudioDevice(QString driverId, QString name) {
 	settings->setValue("Master/DefaultAudioDevice", name);
 }
 
+void Master::startAudioDeviceScan() {
+	finishedAudioDeviceScanCount = 0;
+	mergedAudioDeviceScanCount = 0;
+	audioDeviceScanInProgress = true;
+	pinnedSynthRouteStartPending = false;
+	qDebug() << "Scanning audio devices in background ...";
+	audioDeviceScanThreadPool.setMaxThreadCount(audioDrivers.size());
+	for (int driverIx = 0; driverIx < audioDrivers.size(); driverIx++) {
+		scannedAudioDevices.append(QList<const AudioDevice *>());
+		audioDeviceScanFinishedFlags.append(false);
+	}
+	for (int driverIx = 0; driverIx < audioDrivers.size(); driverIx++) {
+		audioDeviceScanThreadPool.start(new AudioDeviceScanTask(*this, *audioDrivers.at(driverIx), driverIx));
+	}
+}
+
+// Takes over the devices of the drivers scanned by now. Returns true unless the initial scan has completed.
+bool Master::mergeScannedAudioDevices() {
+	if (!audioDeviceScanInProgress) return false;
+	QMutexLocker audioDeviceScanLocker(&audioDeviceScanMutex);
+	if (mergedAudioDeviceScanCount == finishedAudioDeviceScanCount) return true;
+	audioDevices.clear();
+	for (int driverIx = 0; driverIx < scannedAudioDevices.size(); driverIx++) {
+		audioDevices.append(scannedAudioDevices.at(driverIx));
+	}
+	mergedAudioDeviceScanCount = finishedAudioDeviceScanCount;
+	if (mergedAudioDeviceScanCount < audioDrivers.size()) return true;
+	qDebug() << "Scanning audio devices completed";
+	audioDeviceScanInProgress = false;
+	lastAudioDeviceScan = MasterClock::getClockNanos();
+	return false;
+}
+
+// Returns true if findAudioDevice() won't change its result as more devices arrive.
+bool Master::isAudioDeviceKnown(QString driverId, QString name) const {
+	if (!audioDeviceScanInProgress) return true;
+	QListIterator<const AudioDevice *> audioDeviceIt(audioDevices);
+	while(audioDeviceIt.hasNext()) {
+		const AudioDevice *audioDevice = audioDeviceIt.next();
+		if (driverId == audioDevice->driver.id && name == audioDevice->name) return true;
+	}
+	return false;
+}
+
+// Blocks until the initial scan finds the device or completes. The other drivers are still scanned in background.
+void Master::waitForAudioDevice(QString driverId, QString name) {
+	while (mergeScannedAudioDevices() && !isAudioDeviceKnown(driverId, name)) {
+		QMutexLocker audioDeviceScanLocker(&audioDeviceScanMutex);
+		while (mergedAudioDeviceScanCount == finishedAudioDeviceScanCount) {
+			audioDeviceScanFinished.wait(&audioDeviceScanMutex);
+		}
+	}
+}
+
+void Master::handleAudioDeviceScanFinished() {
+	mergeScannedAudioDevices();
+	emit audioDevicesChanged();
+	if (pinnedSynthRouteStartPending && isAudioDeviceKnown(defaultAudioDriverId, defaultAudioDeviceName)) {
+		pinnedSynthRouteStartPending = false;
+		setPinned(startSynthRoute());
+	}
+}
+
 const QList<const AudioDevice *> Master::getAudioDevices() {
+	if (mergeScannedAudioDevices()) return audioDevices;
 	MasterClockNanos nanosNow = MasterClock::getClockNanos();
 	if ((nanosNow - lastAudioDeviceScan) > 3 * MasterClock::NANOS_PER_SECOND) {
 		lastAudioDeviceScan = nanosNow;
@@ -314,6 +510,36 @@ const QList<const AudioDevice *> Master::getAudioDevices() {
 	return audioDevices;
 }
 
+bool Master::isAudioMixingEnabled() const {
+	return settings->value("Master/mixAudioStreams", false).toBool();
+}
+
+AudioStream *Master::startMixedAudioStream(const AudioDevice &audioDevice, SynthRoute &synthRoute, const uint sampleRate) {
+	QListIterator<AudioMixer *> audioMixerIt(audioMixers);
+	while (audioMixerIt.hasNext()) {
+		AudioMixer *audioMixer = audioMixerIt.next();
+		if (!audioMixer->matches(audioDevice, sampleRate)) continue;
+		AudioStream *audioStream = audioMixer->startAudioStream(synthRoute);
+		if (audioStream != NULL) return audioStream;
+		// The output stream of the mixer has failed, the routes it still has will release it once closed.
+		audioMixers.removeOne(audioMixer);
+		if (!audioMixer->hasInputStreams()) delete audioMixer;
+		break;
+	}
+	AudioMixer *audioMixer = new AudioMixer(audioDevice, sampleRate);
+	if (!audioMixer->start(audioDevice)) {
+		delete audioMixer;
+		return NULL;
+	}
+	audioMixers.append(audioMixer);
+	return audioMixer->startAudioStream(synthRoute);
+}
+
+void Master::releaseAudioMixer(AudioMixer *audioMixer) {
+	audioMixers.removeOne(audioMixer);
+	delete audioMixer;
+}
+
 const AudioDevice *Master::findAudioDevice(QString driverId, QString name) const {
 	QListIterator<const AudioDevice *> audioDeviceIt(audioDevices);
 	while(audioDeviceIt.hasNext()) {
@@ -329,6 +555,50 @@ QSettings *Master::getSettings() const {
 	return settings;
 }
 
+RenderingThreadPool *Master::getRenderingThreadPool() const {
+	return renderingThreadPool;
+}
+
+Tracer *Master::getTracer() const {
+	return tracer;
+}
+
+int Master::selectNUMANode() const {
+	if (!settings->value("Master/numaAwarePlacement", false).toBool()) return -1;
+	const QList<int> numaNodes = getNUMANodes();
+	if (numaNodes.size() < 2) return -1;
+	int selectedNode = numaNodes.first();
+	int selectedNodeSynthCount = synthRoutes.size() + 1;
+	foreach (int numaNode, numaNodes) {
+		int synthCount = 0;
+		foreach (SynthRoute *synthRoute, synthRoutes) {
+			if (synthRoute->getNUMANode() == numaNode) synthCount++;
+		}
+		if (synthCount < selectedNodeSynthCount) {
+			selectedNode = numaNode;
+			selectedNodeSynthCount = synthCount;
+		}
+	}
+	return selectedNode;
+}
+
+QList<int> Master::getNUMANodeCPUCores(int numaNode) {
+#if defined(WITH_WIN_NUMA)
+	ULONGLONG processorMask = 0;
+	QList<int> cpuCores;
+	if (numaNode > 255 || !GetNumaNodeProcessorMask(UCHAR(numaNode), &processorMask)) return cpuCores;
+	for (int cpuCore = 0; cpuCore < 64; cpuCore++) {
+		if ((processorMask >> cpuCore) & 1) cpuCores << cpuCore;
+	}
+	return cpuCores;
+#elif defined(Q_OS_LINUX)
+	return readSysfsList("/sys/devices/system/node/node" + QString::number(numaNode) + "/cpulist");
+#else
+	Q_UNUSED(numaNode)
+	return QList<int>();
+#endif
+}
+
 QString Master::getDefaultSynthProfileName() {
 	return synthProfileName;
 }
@@ -355,17 +625,70 @@ const QString Master::getROMPathName(const QDir &romDir, QString romFileName) {
 	return pathName + QDir::separator() + romFileName;
 }
 
-void Master::findROMImages(const SynthProfile &synthProfile, const MT32Emu::ROMImage *&controlROMImage, const MT32Emu::ROMImage *&pcmROMImage) const {
+static const QString getROMFileStamp(const QFileInfo &fileInfo) {
+	return QString::number(fileInfo.size()) + ' ' + fileInfo.lastModified().toString(Qt::ISODate);
+}
+
+const MT32Emu::ROMInfo *Master::identifyROMFile(const QString &romPathName, const MT32Emu::ROMInfo * const *romInfos) {
+	const MT32Emu::ROMInfo *romInfo;
+	if (findCachedROMInfo(romPathName, romInfos, romInfo)) return romInfo;
+	const QString sha1Digest = computeROMFileDigest(romPathName);
+	if (sha1Digest.isEmpty()) return NULL;
+	return identifyROMDigest(romPathName, sha1Digest, romInfos);
+}
+
+bool Master::findCachedROMInfo(const QString &romPathName, const MT32Emu::ROMInfo * const *romInfos, const MT32Emu::ROMInfo *&romInfo) const {
+	romInfo = NULL;
+	QFileInfo fileInfo(romPathName);
+	if (!fileInfo.isFile()) return true;
+	// Most files are rejected by size without computing the digest, no need to cache them.
+	size_t fileSize = size_t(fileInfo.size());
+	bool fileSizeMatched = false;
+	for (int i = 0; romInfos[i] != NULL && !fileSizeMatched; i++) {
+		fileSizeMatched = romInfos[i]->fileSize == fileSize;
+	}
+	if (!fileSizeMatched) return true;
+
+	const QVariantMap romInfoCache = settings->value("Master/romInfoCache").toMap();
+	const QStringList cacheEntry = romInfoCache.value(fileInfo.absoluteFilePath()).toStringList();
+	if (cacheEntry.size() != 2 || cacheEntry.at(0) != getROMFileStamp(fileInfo) || cacheEntry.at(1).size() != 40) return false;
+	MT32Emu::File::SHA1Digest sha1Digest;
+	memcpy(sha1Digest, cacheEntry.at(1).toLatin1().constData(), sizeof(sha1Digest));
+	MT32Emu::ArrayFile file(NULL, fileSize, sha1Digest);
+	romInfo = MT32Emu::ROMInfo::getROMInfo(&file, romInfos);
+	return true;
+}
+
+const QString Master::computeROMFileDigest(const QString &romPathName) {
+	MT32Emu::FileStream file;
+	if (!file.open(romPathName.toLocal8Bit())) return QString();
+	const char *sha1Digest = file.getSHA1();
+	if (file.getData() == NULL) return QString();
+	return QString(sha1Digest);
+}
+
+const MT32Emu::ROMInfo *Master::identifyROMDigest(const QString &romPathName, const QString &sha1Digest, const MT32Emu::ROMInfo * const *romInfos) {
+	QFileInfo fileInfo(romPathName);
+	MT32Emu::File::SHA1Digest digest;
+	memcpy(digest, sha1Digest.toLatin1().constData(), sizeof(digest));
+	MT32Emu::ArrayFile file(NULL, size_t(fileInfo.size()), digest);
+	const MT32Emu::ROMInfo *romInfo = MT32Emu::ROMInfo::getROMInfo(&file, romInfos);
+	QVariantMap romInfoCache = settings->value("Master/romInfoCache").toMap();
+	if (romInfoCache.size() >= MAX_ROM_INFO_CACHE_SIZE) romInfoCache.clear();
+	romInfoCache.insert(fileInfo.absoluteFilePath(), QStringList() << getROMFileStamp(fileInfo) << sha1Digest);
+	settings->setValue("Master/romInfoCache", romInfoCache);
+	return romInfo;
+}
+
+void Master::findROMImages(const SynthProfile &synthProfile, int numaNode, const MT32Emu::ROMImage *&controlROMImage, const MT32Emu::ROMImage *&pcmROMImage) const {
 	if (controlROMImage != NULL && pcmROMImage != NULL) return;
 	const MT32Emu::ROMImage *synthControlROMImage = NULL;
 	const MT32Emu::ROMImage *synthPCMROMImage = NULL;
-	if (audioFileWriterSynth != NULL) {
-		audioFileWriterSynth->getROMImages(controlROMImage, pcmROMImage);
-		if (controlROMImage == NULL) controlROMImage = synthControlROMImage;
-		if (pcmROMImage == NULL) controlROMImage = synthPCMROMImage;
-	}
+	// The ROM images of the synths used in SMF converter are not shared. These synths are closed in their rendering threads,
+	// so if two of them shared the ROM images, both might find the images no longer in use and free them concurrently.
 	foreach (SynthRoute *synthRoute, synthRoutes) {
 		if (controlROMImage != NULL && pcmROMImage != NULL) return;
+		if (synthRoute->getNUMANode() != numaNode) continue;
 		SynthProfile profile;
 		synthRoute->getSynthProfile(profile);
 		if (synthProfile.romDir != profile.romDir) continue;
@@ -381,10 +704,13 @@ void Master::freeROMImages(const MT32Emu::ROMImage *&controlROMImage, const MT32
 	bool pcmROMInUse = false;
 	const MT32Emu::ROMImage *synthControlROMImage = NULL;
 	const MT32Emu::ROMImage *synthPCMROMImage = NULL;
-	if (audioFileWriterSynth != NULL) {
-		audioFileWriterSynth->getROMImages(synthControlROMImage, synthPCMROMImage);
-		controlROMInUse = controlROMInUse || (synthControlROMImage == controlROMImage);
-		pcmROMInUse = pcmROMInUse || (synthPCMROMImage == pcmROMImage);
+	{
+		QMutexLocker audioFileWriterSynthsLocker(&audioFileWriterSynthsMutex);
+		foreach (const QSynth *audioFileWriterSynth, audioFileWriterSynths) {
+			audioFileWriterSynth->getROMImages(synthControlROMImage, synthPCMROMImage);
+			controlROMInUse = controlROMInUse || (synthControlROMImage == controlROMImage);
+			pcmROMInUse = pcmROMInUse || (synthPCMROMImage == pcmROMImage);
+		}
 	}
 	foreach (SynthRoute *synthRoute, synthRoutes) {
 		if (controlROMInUse && pcmROMInUse) break;
@@ -501,22 +827,33 @@ void Master::setPinned(SynthRoute *synthRoute) {
 	emit synthRoutePinned();
 }
 
+// The route is started once its audio device is found, unless a MIDI session needs it sooner.
 void Master::startPinnedSynthRoute() {
 	if (settings->value("Master/startPinnedSynthRoute", false).toBool()) {
+		mergeScannedAudioDevices();
+		if (!isAudioDeviceKnown(defaultAudioDriverId, defaultAudioDeviceName)) {
+			pinnedSynthRouteStartPending = true;
+			return;
+		}
 		setPinned(startSynthRoute());
 	}
 }
 
 SynthRoute *Master::startSynthRoute() {
+	if (pinnedSynthRouteStartPending) {
+		pinnedSynthRouteStartPending = false;
+		setPinned(startSynthRoute());
+	}
 	SynthRoute *synthRoute = pinnedSynthRoute;
 	if (synthRoute == NULL) {
 		synthRoute = new SynthRoute(this);
 		const AudioDevice *audioDevice = NULL;
+		waitForAudioDevice(defaultAudioDriverId, defaultAudioDeviceName);
 		getAudioDevices();
 		if (!audioDevices.isEmpty()) {
 			audioDevice = findAudioDevice(defaultAudioDriverId, defaultAudioDeviceName);
 			synthRoute->setAudioDevice(audioDevice);
-			synthRoute->open();
+			if (!synthRoute->suspendUntilMIDIActivity()) synthRoute->open();
 			synthRoutes.append(synthRoute);
 			emit synthRouteAdded(synthRoute, audioDevice, true);
 		}
@@ -573,6 +910,9 @@ bool Master::canCreateMidiPort() {
 bool Master::canDeleteMidiPort(MidiSession *midiSession) {
 #ifdef WITH_JACK_MIDI_DRIVER
 	if (jackMidiDriver->canDeletePort(midiSession)) return true;
+#endif
+#ifdef WITH_PIPEWIRE_MIDI_DRIVER
+	if (pipeWireMidiDriver->canDeletePort(midiSession)) return true;
 #endif
 	return midiDriver->canDeletePort(midiSession);
 }
@@ -600,6 +940,13 @@ void Master::deleteMidiPort(MidiSession *midiSession) {
 		deleteMidiSession(midiSession);
 		return;
 	}
+#endif
+#ifdef WITH_PIPEWIRE_MIDI_DRIVER
+	if (pipeWireMidiDriver->canDeletePort(midiSession)) {
+		pipeWireMidiDriver->deletePort(midiSession);
+		deleteMidiSession(midiSession);
+		return;
+	}
 #endif
 	midiDriver->deletePort(midiSession);
 	deleteMidiSession(midiSession);
@@ -611,8 +958,14 @@ void Master::setMidiPortProperties(MidiPropertiesDialog *mpd, MidiSession *midiS
 
 // A quick hack to prevent ROMImages used in SMF converter from being freed
 // when closing another synth which uses the same ROMImages
-void Master::setAudioFileWriterSynth(const QSynth *qSynth) {
-	audioFileWriterSynth = qSynth;
+void Master::addAudioFileWriterSynth(const QSynth *qSynth) {
+	QMutexLocker audioFileWriterSynthsLocker(&audioFileWriterSynthsMutex);
+	audioFileWriterSynths.append(qSynth);
+}
+
+void Master::removeAudioFileWriterSynth(const QSynth *qSynth) {
+	QMutexLocker audioFileWriterSynthsLocker(&audioFileWriterSynthsMutex);
+	audioFileWriterSynths.removeOne(qSynth);
 }
 
 void Master::isSupportedDropEvent(QDropEvent *e) {
@@ -682,6 +1035,7 @@ void Master::deleteJACKMidiPort(MidiSession *midiSession) {
 }
 
 MidiSession *Master::createExclusiveJACKMidiPort(QString portName) {
+	waitForAudioDevice("jackaudio", "Default");
 	getAudioDevices();
 	if (!audioDevices.isEmpty()) {
 		const AudioDevice *jackAudioDevice = findAudioDevice("jackaudio", "Default");
@@ -703,3 +1057,36 @@ MidiSession *Master::createExclusiveJACKMidiPort(QString portName) {
 	return NULL;
 }
 #endif
+
+#ifdef WITH_PIPEWIRE_MIDI_DRIVER
+bool Master::createPipeWireMidiPort(bool exclusive) {
+	return static_cast<PipeWireMidiDriver *>(pipeWireMidiDriver)->createPipeWirePort(exclusive);
+}
+
+void Master::deletePipeWireMidiPort(MidiSession *midiSession) {
+	emit pipeWireMidiPortDeleted(midiSession);
+}
+
+MidiSession *Master::createExclusivePipeWireMidiPort(QString portName) {
+	waitForAudioDevice("pipewire", "Default");
+	getAudioDevices();
+	if (!audioDevices.isEmpty()) {
+		const AudioDevice *pipeWireAudioDevice = findAudioDevice("pipewire", "Default");
+		if (pipeWireAudioDevice->driver.id == "pipewire") {
+			SynthRoute *synthRoute = new SynthRoute(this);
+			synthRoute->setAudioDevice(pipeWireAudioDevice);
+			synthRoutes.append(synthRoute);
+			emit synthRouteAdded(synthRoute, pipeWireAudioDevice, false);
+			MidiSession *midiSession = new MidiSession(this, pipeWireMidiDriver, portName, synthRoute);
+			synthRoute->enableExclusiveMidiMode(midiSession);
+			if (synthRoute->open(PipeWireAudioDefaultDevice::startAudioStream)) {
+				// This must be done asynchronously
+				connect(synthRoute, SIGNAL(exclusiveMidiSessionRemoved(MidiSession *)), pipeWireMidiDriver, SLOT(onPipeWireMidiPortDeleted(MidiSession *)), Qt::QueuedConnection);
+				return midiSession;
+			}
+			deleteMidiSession(midiSession);
+		}
+	}
+	return NULL;
+}
+#endif
@@ -2,18 +2,24 @@
 #define MASTER_H
 
 #include <QObject>
+#include <QThreadPool>
+#include <QWaitCondition>
 
 #include "SynthRoute.h"
 
 class AudioDriver;
+class AudioMixer;
 class MidiDriver;
 class MidiSession;
 class QSystemTrayIcon;
 class MidiPropertiesDialog;
 class QDropEvent;
+class RenderingThreadPool;
+class Tracer;
 
 class Master : public QObject {
 friend int main(int argv, char **args);
+friend class AudioDeviceScanTask;
 	Q_OBJECT
 private:
 	static void showCommandLineHelp();
@@ -21,9 +27,24 @@ private:
 	QList<SynthRoute *> synthRoutes;
 	QList<AudioDriver *> audioDrivers;
 	QList<const AudioDevice *> audioDevices;
+	// The initial scan of the audio devices runs in background, a task per driver, so that the slow drivers don't delay
+	// the startup. The devices are merged into audioDevices in the order of the drivers as the tasks finish.
+	QThreadPool audioDeviceScanThreadPool;
+	QMutex audioDeviceScanMutex;
+	QWaitCondition audioDeviceScanFinished;
+	QList<QList<const AudioDevice *> > scannedAudioDevices;
+	QList<bool> audioDeviceScanFinishedFlags;
+	int finishedAudioDeviceScanCount;
+	int mergedAudioDeviceScanCount;
+	bool audioDeviceScanInProgress;
+	bool pinnedSynthRouteStartPending;
+	QList<AudioMixer *> audioMixers;
 	MidiDriver *midiDriver;
 	SynthRoute *pinnedSynthRoute;
-	const QSynth *audioFileWriterSynth;
+	QList<const QSynth *> audioFileWriterSynths;
+	mutable QMutex audioFileWriterSynthsMutex;
+	RenderingThreadPool *renderingThreadPool;
+	Tracer *tracer;
 
 	QSettings *settings;
 	QString synthProfileName;
@@ -40,6 +61,10 @@ private:
 
 	void initAudioDrivers();
 	void initMidiDrivers();
+	void startAudioDeviceScan();
+	bool mergeScannedAudioDevices();
+	bool isAudioDeviceKnown(QString driverId, QString name) const;
+	void waitForAudioDevice(QString driverId, QString name);
 	const AudioDevice *findAudioDevice(QString driverId, QString name) const;
 	SynthRoute *startSynthRoute();
 
@@ -50,20 +75,47 @@ public:
 	static QStringList parseMidiListFromPathName(const QString pathName);
 	static const QString getROMPathName(const QDir &romDir, QString romFileName);
 
-	// May only be called from the application thread
+	// May only be called from the application thread. While the initial scan is in progress, only returns the devices
+	// found so far, audioDevicesChanged() is emitted as more arrive.
 	const QList<const AudioDevice *> getAudioDevices();
 	void setDefaultAudioDevice(QString driverId, QString name);
+	// Returns true if the routes that use the same audio device should be mixed into a single stream.
+	bool isAudioMixingEnabled() const;
+	// Starts a stream for the route that plays through the AudioMixer of the audio device, creating the mixer
+	// as necessary. Returns NULL if the output stream of the mixer can't be started.
+	AudioStream *startMixedAudioStream(const AudioDevice &audioDevice, SynthRoute &synthRoute, const uint sampleRate);
+	// Deletes the mixer once its last stream has been deleted.
+	void releaseAudioMixer(AudioMixer *audioMixer);
 	void setTrayIcon(QSystemTrayIcon *trayIcon);
 	QString getDefaultSynthProfileName();
 	bool setDefaultSynthProfileName(QString name);
 	const QStringList enumSynthProfiles() const;
 	void loadSynthProfile(SynthProfile &synthProfile, QString name);
 	void storeSynthProfile(const SynthProfile &synthProfile, QString name) const;
-	void findROMImages(const SynthProfile &synthProfile, const MT32Emu::ROMImage *&controlROMImage, const MT32Emu::ROMImage *&pcmROMImage) const;
+	// Only the ROM images of the synths placed on the same NUMA node are shared, so that each node has a copy of its own.
+	void findROMImages(const SynthProfile &synthProfile, int numaNode, const MT32Emu::ROMImage *&controlROMImage, const MT32Emu::ROMImage *&pcmROMImage) const;
 	void freeROMImages(const MT32Emu::ROMImage *&controlROMImage, const MT32Emu::ROMImage *&pcmROMImage) const;
+	// Finds the ROMInfo among the given list that describes the ROM file. The SHA1 digests of the files identified
+	// before are cached along with their size and modification time, so that unchanged files needn't be read again.
+	const MT32Emu::ROMInfo *identifyROMFile(const QString &romPathName, const MT32Emu::ROMInfo * const *romInfos);
+	// The steps of identifyROMFile() for the callers that compute the digests in background. Returns false
+	// if the ROMInfo can't be found without computing the digest of the file first.
+	bool findCachedROMInfo(const QString &romPathName, const MT32Emu::ROMInfo * const *romInfos, const MT32Emu::ROMInfo *&romInfo) const;
+	// Reads the file and returns its SHA1 digest or an empty string on failure. Safe to invoke from any thread.
+	static const QString computeROMFileDigest(const QString &romPathName);
+	const MT32Emu::ROMInfo *identifyROMDigest(const QString &romPathName, const QString &sha1Digest, const MT32Emu::ROMInfo * const *romInfos);
 	bool handleROMSLoadFailed(QString usedSynthProfileName);
 	QSystemTrayIcon *getTrayIcon() const;
 	QSettings *getSettings() const;
+	// Returns the rendering thread pool shared by all the synths or NULL if each synth renders sequentially.
+	RenderingThreadPool *getRenderingThreadPool() const;
+	// Returns the tracer that records the spans of work of all the threads or NULL unless tracing is enabled.
+	Tracer *getTracer() const;
+	// Returns the NUMA node with the fewest synths placed on it, or -1 unless "Master/numaAwarePlacement" is set
+	// and the system has more than one node with CPU cores.
+	int selectNUMANode() const;
+	// Returns the CPU cores of the NUMA node, the list is empty if unknown.
+	static QList<int> getNUMANodeCPUCores(int numaNode);
 	bool isPinned(const SynthRoute *synthRoute) const;
 	void setPinned(SynthRoute *synthRoute);
 	void startPinnedSynthRoute();
@@ -76,16 +128,20 @@ public:
 	void deleteMidiPort(MidiSession *midiSession);
 	void setMidiPortProperties(MidiPropertiesDialog *mpd, MidiSession *midiSession);
 	QString getDefaultROMSearchPath();
-	void setAudioFileWriterSynth(const QSynth *);
+	// Thread-safe
+	void addAudioFileWriterSynth(const QSynth *);
+	void removeAudioFileWriterSynth(const QSynth *);
 
 private slots:
 	void createMidiSession(MidiSession **returnVal, MidiDriver *midiDriver, QString name);
+	void handleAudioDeviceScanFinished();
 	void deleteMidiSession(MidiSession *midiSession);
 	void showBalloon(const QString &title, const QString &text);
 	void updateMainWindowTitleContribution(const QString &titleContribution);
 
 signals:
 	void synthRouteAdded(SynthRoute *route, const AudioDevice *audioDevice, bool pinnable);
+	void audioDevicesChanged();
 	void synthRouteRemoved(SynthRoute *route);
 	void synthRoutePinned();
 	void synthRoutePinnable();
@@ -107,6 +163,24 @@ public:
 signals:
 	void jackMidiPortDeleted(MidiSession *);
 #endif
+
+#ifdef WITH_PIPEWIRE_MIDI_DRIVER
+private:
+	MidiDriver *pipeWireMidiDriver;
+
+public:
+	bool createPipeWireMidiPort(bool exclusive);
+	void deletePipeWireMidiPort(MidiSession *midiSession);
+	MidiSession *createExclusivePipeWireMidiPort(QString portName);
+
+signals:
+	void pipeWireMidiPortDeleted(MidiSession *);
+#endif
+
+#ifdef WITH_NETWORK_MIDI_DRIVER
+private:
+	MidiDriver *networkMidiDriver;
+#endif
 };
 
 #endif
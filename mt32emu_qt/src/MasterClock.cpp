@@ -85,7 +85,36 @@ void MasterClock::cleanup() {}
 
 #include <Windows.h>
 
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+// CreateWaitableTimerExW is missing before Windows Vista, hence it is resolved at runtime.
+typedef HANDLE (WINAPI *CreateWaitableTimerExWProc)(LPSECURITY_ATTRIBUTES, LPCWSTR, DWORD, DWORD);
+
+static CreateWaitableTimerExWProc createWaitableTimerExW = NULL;
+
+// High resolution waitable timers are only supported since Windows 10 version 1803. Unlike Sleep(), they are not bound
+// to the multimedia timer resolution, and the actual wait is typically accurate within 0.5 ms or better.
+static HANDLE createHighResolutionTimer() {
+	if (createWaitableTimerExW == NULL) return NULL;
+	return createWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+}
+
 void MasterClock::sleepForNanos(MasterClockNanos nanos) {
+	if (nanos <= 0) return;
+	// A timer object is created for each wait to keep this thread-safe, which is cheap compared to the sleeps involved.
+	HANDLE timer = createHighResolutionTimer();
+	if (timer != NULL) {
+		LARGE_INTEGER dueTime;
+		// Negative due time is relative and specified in 100-nanosecond intervals.
+		dueTime.QuadPart = -qMax(1LL, nanos / 100);
+		if (SetWaitableTimer(timer, &dueTime, 0, NULL, NULL, FALSE) && WaitForSingleObject(timer, INFINITE) == WAIT_OBJECT_0) {
+			CloseHandle(timer);
+			return;
+		}
+		CloseHandle(timer);
+	}
 	Sleep(DWORD(qMax(1LL, nanos / NANOS_PER_MILLISECOND)));
 }
 
@@ -142,6 +171,15 @@ void MasterClock::init() {
 		qDebug() << "MasterClock: High resolution timer unavailable on the system. Falling back to multimedia timer.";
 		startTime.QuadPart = timeGetTime();
 	}
+	createWaitableTimerExW = CreateWaitableTimerExWProc(GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "CreateWaitableTimerExW"));
+	HANDLE timer = createHighResolutionTimer();
+	if (timer != NULL) {
+		CloseHandle(timer);
+		qDebug() << "MasterClock: Using high resolution waitable timers for sleeping";
+	} else {
+		createWaitableTimerExW = NULL;
+		qDebug() << "MasterClock: High resolution waitable timers unavailable. Sleeping with multimedia timer resolution.";
+	}
 }
 
 void MasterClock::cleanup() {
@@ -151,7 +189,52 @@ void MasterClock::cleanup() {
 	}
 }
 
-#else // defined WITH_POSIX_CLOCK_NANOSLEEP || defined WITH_WINMMTIMER
+#elif defined WITH_MACH_TIMER
+
+#include <mach/mach_time.h>
+
+static mach_timebase_info_data_t timebaseInfo = {1, 1};
+static uint64_t startTime = 0;
+
+static MasterClockNanos machTimeToNanos(uint64_t machTime) {
+	// The quotient and remainder are scaled separately to avoid overflowing with timebases like 125 / 3.
+	return MasterClockNanos(machTime / timebaseInfo.denom * timebaseInfo.numer
+		+ machTime % timebaseInfo.denom * timebaseInfo.numer / timebaseInfo.denom);
+}
+
+static uint64_t nanosToMachTime(MasterClockNanos nanos) {
+	uint64_t unsignedNanos = uint64_t(nanos);
+	return unsignedNanos / timebaseInfo.numer * timebaseInfo.denom
+		+ unsignedNanos % timebaseInfo.numer * timebaseInfo.denom / timebaseInfo.numer;
+}
+
+void MasterClock::sleepForNanos(MasterClockNanos nanos) {
+	if (nanos <= 0) return;
+	mach_wait_until(mach_absolute_time() + nanosToMachTime(nanos));
+}
+
+void MasterClock::sleepUntilClockNanos(MasterClockNanos clockNanos) {
+	if (clockNanos <= 0) return;
+	mach_wait_until(startTime + nanosToMachTime(clockNanos));
+}
+
+MasterClockNanos MasterClock::getClockNanos() {
+	return machTimeToNanos(mach_absolute_time() - startTime);
+}
+
+void MasterClock::init() {
+	if (mach_timebase_info(&timebaseInfo) != KERN_SUCCESS || timebaseInfo.numer == 0 || timebaseInfo.denom == 0) {
+		qDebug() << "MasterClock: Unable to get Mach timebase, assuming nanoseconds";
+		timebaseInfo.numer = 1;
+		timebaseInfo.denom = 1;
+	}
+	startTime = mach_absolute_time();
+	qDebug() << "MasterClock: Using Mach absolute time. Timebase:" << timebaseInfo.numer << "/" << timebaseInfo.denom;
+}
+
+void MasterClock::cleanup() {}
+
+#else // defined WITH_POSIX_CLOCK_NANOSLEEP || defined WITH_WINMMTIMER || defined WITH_MACH_TIMER
 
 #include <QThread>
 
@@ -236,4 +319,4 @@ void MasterClock::cleanup() {
 
 #endif // (QT_VERSION < QT_VERSION_CHECK(4, 7, 0))
 
-#endif // defined WITH_POSIX_CLOCK_NANOSLEEP || defined WITH_WINMMTIMER
+#endif // defined WITH_POSIX_CLOCK_NANOSLEEP || defined WITH_WINMMTIMER || defined WITH_MACH_TIMER
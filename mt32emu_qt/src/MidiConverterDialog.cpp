@@ -28,11 +28,14 @@ static inline bool isSmfFileName(const QString &fileName) {
 	return fileName.endsWith(".mid", Qt::CaseInsensitive) || fileName.endsWith(".smf", Qt::CaseInsensitive);
 }
 
-MidiConverterDialog::MidiConverterDialog(Master *master, QWidget *parent) : QDialog(parent), ui(new Ui::MidiConverterDialog), batchMode(false) {
+MidiConverterDialog::MidiConverterDialog(Master *master, QWidget *parent) :
+	QDialog(parent), ui(new Ui::MidiConverterDialog), totalJobCount(0), finishedJobCount(0), batchMode(false)
+{
 	ui->setupUi(this);
 	loadProfileCombo();
-	connect(&converter, SIGNAL(conversionFinished()), SLOT(handleConversionFinished()));
-	connect(&converter, SIGNAL(midiEventProcessed(int, int)), SLOT(updateConversionProgress(int, int)));
+	int idealThreadCount = QThread::idealThreadCount();
+	int parallelJobs = master->getSettings()->value("Master/midiConverterParallelJobs", qMax(1, idealThreadCount)).toInt();
+	ui->parallelJobsSpinBox->setValue(parallelJobs);
 	connect(this, SIGNAL(conversionFinished(const QString &, const QString &)), master, SLOT(showBalloon(const QString &, const QString &)));
 #if (QT_VERSION >= QT_VERSION_CHECK(4, 6, 0))
 	ui->midiList->setDefaultDropAction(Qt::MoveAction);
@@ -41,6 +44,7 @@ MidiConverterDialog::MidiConverterDialog(Master *master, QWidget *parent) : QDia
 }
 
 MidiConverterDialog::~MidiConverterDialog() {
+	stopConversion();
 	delete ui;
 }
 
@@ -191,16 +195,83 @@ void MidiConverterDialog::on_startButton_clicked() {
 		return;
 	}
 	enableControls(false);
+	// The MIDI file list of the current PCM file is only stored in the item when another one gets selected.
+	ui->pcmList->currentItem()->setData(Qt::UserRole, getMidiFileNames());
 	ui->pcmList->setCurrentRow(0);
-	const QStringList midiFileNames = getMidiFileNames();
-	if (!converter.convertMIDIFiles(ui->pcmList->currentItem()->text(), midiFileNames, ui->profileComboBox->currentText())) enableControls(true);
+	totalJobCount = ui->pcmList->count();
+	finishedJobCount = 0;
+	int converterCount = qMin(ui->parallelJobsSpinBox->value(), totalJobCount);
+	for (int i = 0; i < converterCount; i++) {
+		AudioFileRenderer *converter = new AudioFileRenderer;
+		connect(converter, SIGNAL(conversionFinished()), SLOT(handleConversionFinished()));
+		connect(converter, SIGNAL(midiEventProcessed(int, int)), SLOT(updateConversionProgress(int, int)));
+		converters.append(converter);
+		if (!startNextJob(converter)) {
+			stopConversion();
+			enableControls(true);
+			return;
+		}
+	}
 }
 
 void MidiConverterDialog::on_stopButton_clicked() {
-	converter.stop();
+	stopConversion();
 	enableControls(true);
 }
 
+void MidiConverterDialog::on_parallelJobsSpinBox_valueChanged(int value) {
+	Master::getInstance()->getSettings()->setValue("Master/midiConverterParallelJobs", value);
+}
+
+// Starts converting the first PCM file in the list that isn't being converted yet, if any.
+bool MidiConverterDialog::startNextJob(AudioFileRenderer *converter) {
+	QListWidgetItem *pcmItem = NULL;
+	for (int i = 0; i < ui->pcmList->count(); i++) {
+		pcmItem = ui->pcmList->item(i);
+		foreach (const ConversionJob &job, activeJobs) {
+			if (job.pcmItem == pcmItem) {
+				pcmItem = NULL;
+				break;
+			}
+		}
+		if (pcmItem != NULL) break;
+	}
+	if (pcmItem == NULL) return true;
+	ConversionJob job = {pcmItem, pcmItem->text(), 0};
+	const QStringList midiFileNames = pcmItem->data(Qt::UserRole).value<QStringList>();
+	if (!converter->convertMIDIFiles(job.pcmFileName, midiFileNames, ui->profileComboBox->currentText())) return false;
+	activeJobs.insert(converter, job);
+	pcmItem->setText(job.pcmFileName + " (0%)");
+	return true;
+}
+
+// Deletes the converters once all the jobs are done.
+void MidiConverterDialog::finishConversion() {
+	qDeleteAll(converters);
+	converters.clear();
+	on_startButton_clicked();
+}
+
+void MidiConverterDialog::stopConversion() {
+	foreach (AudioFileRenderer *converter, converters) {
+		converter->stop();
+	}
+	qDeleteAll(converters);
+	converters.clear();
+	foreach (const ConversionJob &job, activeJobs) {
+		job.pcmItem->setText(job.pcmFileName);
+	}
+	activeJobs.clear();
+}
+
+void MidiConverterDialog::updateTotalProgress() {
+	int percentage = 100 * finishedJobCount;
+	foreach (const ConversionJob &job, activeJobs) {
+		percentage += job.percentage;
+	}
+	ui->progressBar->setValue(percentage / totalJobCount);
+}
+
 void MidiConverterDialog::loadProfileCombo() {
 	Master &master = *Master::getInstance();
 	QStringList profiles = master.enumSynthProfiles();
@@ -242,17 +313,33 @@ void MidiConverterDialog::on_pcmList_currentItemChanged(QListWidgetItem *current
 }
 
 void MidiConverterDialog::handleConversionFinished() {
+	AudioFileRenderer *converter = qobject_cast<AudioFileRenderer *>(sender());
+	if (!activeJobs.contains(converter)) return;
+	const ConversionJob job = activeJobs.take(converter);
 	if (Master::getInstance()->getSettings()->value("Master/showConnectionBalloons", "1").toBool()) {
-		emit conversionFinished("MIDI file converted", ui->pcmList->currentItem()->text());
+		emit conversionFinished("MIDI file converted", job.pcmFileName);
 	}
-	ui->midiList->clear();
-	delete ui->pcmList->takeItem(ui->pcmList->currentRow());
-	on_startButton_clicked();
+	if (job.pcmItem == ui->pcmList->currentItem()) ui->midiList->clear();
+	delete ui->pcmList->takeItem(ui->pcmList->row(job.pcmItem));
+	finishedJobCount++;
+	updateTotalProgress();
+	if (!startNextJob(converter)) {
+		stopConversion();
+		enableControls(true);
+		return;
+	}
+	if (activeJobs.isEmpty()) finishConversion();
 }
 
 void MidiConverterDialog::updateConversionProgress(int midiEventsProcessed, int midiEventsTotal) {
-	double percentage = (100.0 * midiEventsProcessed) / midiEventsTotal;
-	ui->progressBar->setValue((int)percentage);
+	AudioFileRenderer *converter = qobject_cast<AudioFileRenderer *>(sender());
+	if (!activeJobs.contains(converter)) return;
+	ConversionJob &job = activeJobs[converter];
+	int percentage = int((100 * qint64(midiEventsProcessed)) / midiEventsTotal);
+	if (job.percentage == percentage) return;
+	job.percentage = percentage;
+	job.pcmItem->setText(job.pcmFileName + QString(" (%1%)").arg(percentage));
+	updateTotalProgress();
 }
 
 void MidiConverterDialog::enableControls(bool enable) {
@@ -262,6 +349,7 @@ void MidiConverterDialog::enableControls(bool enable) {
 	ui->stopButton->setEnabled(!enable);
 	ui->startButton->setEnabled(enable && ui->pcmList->count() > 0);
 	ui->profileComboBox->setEnabled(enable);
+	ui->parallelJobsSpinBox->setEnabled(enable);
 	ui->midiList->setEnabled(enable);
 	ui->pcmList->setEnabled(enable);
 	ui->newPcmButton->setEnabled(enable);
@@ -25,10 +25,23 @@ protected:
 	void dropEvent(QDropEvent *event);
 
 private:
+	struct ConversionJob {
+		QListWidgetItem *pcmItem;
+		QString pcmFileName;
+		int percentage;
+	};
+
 	Ui::MidiConverterDialog *ui;
-	AudioFileRenderer converter;
+	QList<AudioFileRenderer *> converters;
+	QHash<AudioFileRenderer *, ConversionJob> activeJobs;
+	int totalJobCount;
+	int finishedJobCount;
 	bool batchMode;
 
+	bool startNextJob(AudioFileRenderer *converter);
+	void finishConversion();
+	void stopConversion();
+	void updateTotalProgress();
 	void enableControls(bool enable);
 	void loadProfileCombo();
 	QStringList getMidiFileNames();
@@ -52,6 +65,7 @@ private slots:
 	void on_pcmList_currentItemChanged(QListWidgetItem *current, QListWidgetItem *previous);
 	void handleConversionFinished();
 	void updateConversionProgress(int midiEventsProcessed, int midiEventsTotal);
+	void on_parallelJobsSpinBox_valueChanged(int value);
 
 signals:
 	void conversionFinished(const QString &, const QString &);
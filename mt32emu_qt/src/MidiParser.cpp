@@ -20,183 +20,232 @@
 static const char headerID[] = "MThd\x00\x00\x00\x06";
 static const char trackID[] = "MTrk";
 
-bool MidiParser::readFile(char *data, qint64 len) {
-	qint64 readLen = file.read(data, len);
-	if (readLen == len) return true;
-	qDebug() << "MidiParser: Error reading file";
-	return false;
-}
+// Decodes the events of a track chunk one at a time directly from the file data, so that the tracks can be merged
+// into the output list as they are consumed, without an intermediate list of events per track.
+class MidiParser::TrackDecoder {
+public:
+	TrackDecoder() : data(NULL), dataEnd(NULL), runningStatus(0), deltaTime(0), eventTime(0) {}
 
-bool MidiParser::parseHeader() {
-	char header[8];
-	if (!readFile(header, 8)) return false;
-	if ((uchar)header[0] == 0xF0) {
-		format = 0xF0;
-		numberOfTracks = 1;
-		division = 500;
-		return true;
+	void start(const uchar *trackData, quint32 trackLen) {
+		data = trackData;
+		dataEnd = trackData + trackLen;
+		runningStatus = 0;
+		eventTime = 0;
+		readDeltaTime();
 	}
-	if (memcmp(header, headerID, 8) != 0) {
-		qDebug() << "MidiParser: Wrong MIDI header";
-		return false;
-	}
-	if (!readFile(header, 6)) return false;
-	format = qFromBigEndian<quint16>((uchar *)&header[0]);
-	numberOfTracks = qFromBigEndian<quint16>((uchar *)&header[2]);
-	division = qFromBigEndian<qint16>((uchar *)&header[4]);
-	return true;
-}
 
-bool MidiParser::parseTrack(QMidiEventList &midiEventList) {
-	char header[8];
-	forever {
-		if (!readFile(header, 8)) return false;
-		if (memcmp(header, trackID, 4) == 0) {
-			break;
-		} else {
-			qDebug() << "MidiParser: Wrong MIDI track signature, skipping unknown data chunk";
-			quint32 dataLen = qFromBigEndian<quint32>((uchar *)&header[4]);
-			if (file.seek(file.pos() + dataLen)) {
-				qDebug() << "MidiParser: Error in data chunk";
-				return false;
-			}
-		}
+	bool isFinished() const {
+		return data == NULL;
 	}
-	quint32 trackLen = qFromBigEndian<quint32>((uchar *)&header[4]);
-	char *trackData = new char[trackLen];
-	if (!readFile(trackData, trackLen)) {
-		delete[] trackData;
-		return false;
+
+	// Returns the time in MIDI ticks since the track start of the event to be decoded next.
+	SynthTimestamp getEventTime() const {
+		return eventTime;
 	}
 
-	// Reserve memory for MIDI events, approx. 3 bytes per event
-	midiEventList.reserve(trackLen / 3);
-	qDebug() << "MidiParser: Memory reservation" << trackLen / 3;
+	// Appends the next event to the list unless it is unsupported and carries no timing information.
+	// The event timestamp is left to the caller to assign.
+	void decodeEvent(QMidiEventList &midiEventList);
 
-	// Parsing actual MIDI events
-	unsigned int runningStatus = 0;
-	const uchar *data = (uchar *)trackData;
+private:
+	const uchar *data;
+	const uchar *dataEnd;
+	unsigned int runningStatus;
+	SynthTimestamp deltaTime;
+	SynthTimestamp eventTime;
 	QVarLengthArray<MT32Emu::Bit8u, MT32Emu::SYSEX_BUFFER_SIZE> sysexBuffer;
-	while (data < (uchar *)trackData + trackLen) {
-		SynthTimestamp time = parseVarLenInt(data);
-		quint32 message = 0;
-		const uchar status = *data;
-		if (status & 0x80) {
-			// It's normal status byte
-			if (0xF0 <= status) {
-				// It's a System event
-				if (status == 0xF0) {
-					// It's a SysEx event
-					runningStatus = 0; // SysEx clears running status
+
+	void readDeltaTime();
+	void finish();
+};
+
+void MidiParser::TrackDecoder::readDeltaTime() {
+	if (dataEnd <= data) {
+		if (runningStatus != 0x2F) {
+			qDebug() << "MidiParser: End-of-track Meta-event isn't the last event, file is probably corrupted.";
+		}
+		finish();
+		return;
+	}
+	deltaTime = parseVarLenInt(data);
+	eventTime += deltaTime;
+}
+
+void MidiParser::TrackDecoder::finish() {
+	data = NULL;
+	dataEnd = NULL;
+}
+
+void MidiParser::TrackDecoder::decodeEvent(QMidiEventList &midiEventList) {
+	SynthTimestamp time = deltaTime;
+	quint32 message = 0;
+	const uchar status = *data;
+	if (status & 0x80) {
+		// It's normal status byte
+		if (0xF0 <= status) {
+			// It's a System event
+			if (status == 0xF0) {
+				// It's a SysEx event
+				runningStatus = 0; // SysEx clears running status
+				sysexBuffer.clear();
+				sysexBuffer.append(status);
+				quint32 sysexLength = parseVarLenInt(++data);
+				if (sysexLength < 1) {
+					// No SysEx data, keep the time in sync
+					midiEventList.newMidiEvent().assignSyncMessage(time);
+					readDeltaTime();
+					return;
+				}
+				if (MT32Emu::SYSEX_BUFFER_SIZE <= sysexLength) {
+					qDebug() << "MidiParser: Warning: too long sysex encountered, it may cause problems with real hardware. Sysex length:" << sysexLength + 1;
+				}
+				sysexBuffer.append(data, sysexLength);
+				data += sysexLength - 1;
+				if (*(data++) == 0xF7) {
+					// Complete SysEx event
+					midiEventList.newSysexEvent(time, sysexBuffer.constData(), sysexBuffer.size());
 					sysexBuffer.clear();
-					sysexBuffer.append(status);
-					quint32 sysexLength = parseVarLenInt(++data);
-					if (sysexLength < 1) {
-						// No SysEx data, keep the time in sync
-						midiEventList.newMidiEvent().assignSyncMessage(time);
-						continue;
-					}
-					if (MT32Emu::SYSEX_BUFFER_SIZE <= sysexLength) {
-						qDebug() << "MidiParser: Warning: too long sysex encountered, it may cause problems with real hardware. Sysex length:" << sysexLength + 1;
-					}
-					sysexBuffer.append(data, sysexLength);
-					data += sysexLength - 1;
+				} else {
+					// SysEx fragment, just keep the time in sync
+					midiEventList.newMidiEvent().assignSyncMessage(time);
+				}
+				readDeltaTime();
+				return;
+			} else if (status == 0xF7) {
+				// It's either a SysEx Continuation event or an escaped System event
+				quint32 len = parseVarLenInt(++data);
+				if (sysexBuffer.isEmpty() || len < 1) {
+					qDebug() << "MidiParser: escaped System event, unsupported";
+					data += len;
+				} else {
+					sysexBuffer.append(data, len);
+					data += len - 1;
 					if (*(data++) == 0xF7) {
-						// Complete SysEx event
-						midiEventList.newMidiEvent().assignSysex(time, sysexBuffer.constData(), sysexBuffer.size());
+						// Last SysEx fragment
+						midiEventList.newSysexEvent(time, sysexBuffer.constData(), sysexBuffer.size());
 						sysexBuffer.clear();
 					} else {
-						// SysEx fragment, just keep the time in sync
+						// SysEx is still incomplete, just keep the time in sync
 						midiEventList.newMidiEvent().assignSyncMessage(time);
 					}
-					continue;
-				} else if (status == 0xF7) {
-					// It's either a SysEx Continuation event or an escaped System event
-					quint32 len = parseVarLenInt(++data);
-					if (sysexBuffer.isEmpty() || len < 1) {
-						qDebug() << "MidiParser: escaped System event, unsupported";
-						data += len;
-					} else {
-						sysexBuffer.append(data, len);
-						data += len - 1;
-						if (*(data++) == 0xF7) {
-							// Last SysEx fragment
-							midiEventList.newMidiEvent().assignSysex(time, sysexBuffer.constData(), sysexBuffer.size());
-							sysexBuffer.clear();
-						} else {
-							// SysEx is still incomplete, just keep the time in sync
-							midiEventList.newMidiEvent().assignSyncMessage(time);
-						}
-						continue;
-					}
-				} else if (status == 0xFF) {
-					// It's a Meta-event
-					runningStatus = 0; // Meta-event clears running status
-					uint metaType = *(++data);
-					quint32 len = parseVarLenInt(++data);
-					if (metaType == 0x2F) {
-						qDebug() << "MidiParser: End-of-track Meta-event";
-						if (time > 0) {
-							// Assign a special marker event to end the track in time
-							qDebug() << "MidiParser: Adding sync event for" << time << "divisions";
-							midiEventList.newMidiEvent().assignSyncMessage(time);
-						}
-						runningStatus = 0x2F;
-						break;
-					} else if (metaType == 0x51) {
-						uint newTempo = qFromBigEndian<quint32>(data) >> 8;
-						midiEventList.newMidiEvent().assignSetTempoMessage(time, newTempo);
-						qDebug() << "MidiParser: Meta-event: Set tempo:" << newTempo;
-						data += len;
-						continue;
-					} else {
-						qDebug() << "MidiParser: Meta-event code" << metaType << "unsupported";
+					readDeltaTime();
+					return;
+				}
+			} else if (status == 0xFF) {
+				// It's a Meta-event
+				runningStatus = 0; // Meta-event clears running status
+				uint metaType = *(++data);
+				quint32 len = parseVarLenInt(++data);
+				if (metaType == 0x2F) {
+					qDebug() << "MidiParser: End-of-track Meta-event";
+					if (time > 0) {
+						// Assign a special marker event to end the track in time
+						qDebug() << "MidiParser: Adding sync event for" << time << "divisions";
+						midiEventList.newMidiEvent().assignSyncMessage(time);
 					}
+					finish();
+					return;
+				} else if (metaType == 0x51) {
+					uint newTempo = qFromBigEndian<quint32>(data) >> 8;
+					midiEventList.newMidiEvent().assignSetTempoMessage(time, newTempo);
+					qDebug() << "MidiParser: Meta-event: Set tempo:" << newTempo;
 					data += len;
+					readDeltaTime();
+					return;
 				} else {
-					qDebug() << "MidiParser: Unsupported event" << status;
-					data++;
+					qDebug() << "MidiParser: Meta-event code" << metaType << "unsupported";
 				}
-				if (time > 0) {
-					// The event is unsupported. Nevertheless, assign a special marker event to retain timing information
-					qDebug() << "MidiParser: Adding sync event for" << time << "divisions";
-					midiEventList.newMidiEvent().assignSyncMessage(time);
-				}
-				continue;
-			} else if ((status & 0xE0) == 0xC0) {
-				// It's a short message with one data byte
-				message = qFromLittleEndian<quint16>(data);
-				data += 2;
+				data += len;
 			} else {
-				// It's a short message with two data bytes
-				message = qFromLittleEndian<quint32>(data) & 0xFFFFFF;
-				data += 3;
-			}
-			runningStatus = status;
-		} else {
-			// Handle running status
-			if ((runningStatus & 0x80) == 0) {
-				qDebug() << "MidiParser: First MIDI event must have status byte";
+				qDebug() << "MidiParser: Unsupported event" << status;
 				data++;
-				continue;
 			}
-			if ((runningStatus & 0xE0) == 0xC0) {
-				// It's a short message with one data byte
-				message = runningStatus | ((quint32)*data << 8);
-				data++;
-			} else {
-				// It's a short message with two data bytes
-				message = runningStatus | ((quint32)qFromLittleEndian<quint16>(data) << 8);
-				data += 2;
+			if (time > 0) {
+				// The event is unsupported. Nevertheless, assign a special marker event to retain timing information
+				qDebug() << "MidiParser: Adding sync event for" << time << "divisions";
+				midiEventList.newMidiEvent().assignSyncMessage(time);
 			}
+			readDeltaTime();
+			return;
+		} else if ((status & 0xE0) == 0xC0) {
+			// It's a short message with one data byte
+			message = qFromLittleEndian<quint16>(data);
+			data += 2;
+		} else {
+			// It's a short message with two data bytes
+			message = qFromLittleEndian<quint32>(data) & 0xFFFFFF;
+			data += 3;
+		}
+		runningStatus = status;
+	} else {
+		// Handle running status
+		if ((runningStatus & 0x80) == 0) {
+			qDebug() << "MidiParser: First MIDI event must have status byte";
+			data++;
+			readDeltaTime();
+			return;
+		}
+		if ((runningStatus & 0xE0) == 0xC0) {
+			// It's a short message with one data byte
+			message = runningStatus | ((quint32)*data << 8);
+			data++;
+		} else {
+			// It's a short message with two data bytes
+			message = runningStatus | ((quint32)qFromLittleEndian<quint16>(data) << 8);
+			data += 2;
 		}
-		midiEventList.newMidiEvent().assignShortMessage(time, message);
 	}
-	if (runningStatus != 0x2F) {
-		qDebug() << "MidiParser: End-of-track Meta-event isn't the last event, file is probably corrupted.";
+	midiEventList.newMidiEvent().assignShortMessage(time, message);
+	readDeltaTime();
+}
+
+const uchar *MidiParser::readFile(quint32 len) {
+	if (quint32(fileData.size() - filePos) < len) {
+		qDebug() << "MidiParser: Error reading file";
+		return NULL;
 	}
-	delete[] trackData;
-	qDebug() << "MidiParser: Parsed" << midiEventList.count() << "MIDI events";
+	const uchar *data = (const uchar *)fileData.constData() + filePos;
+	filePos += len;
+	return data;
+}
+
+bool MidiParser::parseHeader() {
+	const uchar *header = readFile(8);
+	if (header == NULL) return false;
+	if (header[0] == 0xF0) {
+		format = 0xF0;
+		numberOfTracks = 1;
+		division = 500;
+		return true;
+	}
+	if (memcmp(header, headerID, 8) != 0) {
+		qDebug() << "MidiParser: Wrong MIDI header";
+		return false;
+	}
+	header = readFile(6);
+	if (header == NULL) return false;
+	format = qFromBigEndian<quint16>(&header[0]);
+	numberOfTracks = qFromBigEndian<quint16>(&header[2]);
+	division = qFromBigEndian<qint16>(&header[4]);
+	return true;
+}
+
+bool MidiParser::findTrack(TrackDecoder &track, quint32 &trackLen) {
+	const uchar *header;
+	forever {
+		header = readFile(8);
+		if (header == NULL) return false;
+		if (memcmp(header, trackID, 4) == 0) break;
+		qDebug() << "MidiParser: Wrong MIDI track signature, skipping unknown data chunk";
+		if (readFile(qFromBigEndian<quint32>(&header[4])) == NULL) {
+			qDebug() << "MidiParser: Error in data chunk";
+			return false;
+		}
+	}
+	trackLen = qFromBigEndian<quint32>(&header[4]);
+	const uchar *trackData = readFile(trackLen);
+	if (trackData == NULL) return false;
+	track.start(trackData, trackLen);
 	return true;
 }
 
@@ -211,81 +260,55 @@ quint32 MidiParser::parseVarLenInt(const uchar * &data) {
 	return value;
 }
 
-void MidiParser::mergeMidiEventLists(QVector<QMidiEventList> &trackList) {
-	int totalEventCount = 0;
-
-	// Remove empty tracks & allocate memory exactly needed
-	for (int i = trackList.count() - 1; i >=0; i--) {
-		int eventCount = trackList.at(i).count();
-		if (eventCount == 0) {
-			trackList.remove(i);
-		} else {
-			totalEventCount += eventCount;
-		}
-	}
-	midiEventList.reserve(totalEventCount);
-	qDebug() << "MidiParser: Expected" << totalEventCount << "events";
+// Appends the events from all the tracks to the output list in sequence, each event is decoded when it is due.
+// The events with the same time come in the order of the tracks, while the consecutive events of a track are kept together.
+void MidiParser::mergeTracks(QVector<TrackDecoder> &tracks, quint32 totalTrackLen) {
+	// Reserve memory for MIDI events, approx. 3 bytes per event
+	midiEventList.reserve(midiEventList.count() + int(totalTrackLen / 3));
+	qDebug() << "MidiParser: Memory reservation" << totalTrackLen / 3;
 
-	// Append events from all the tracks to the output list in sequence
-	QVarLengthArray<int> currentIx(trackList.count());	            // The index of the event to be added next
-	QVarLengthArray<SynthTimestamp> currentTime(trackList.count()); // The time in MIDI ticks of the event to be added next
-	for (int i = 0; i < trackList.count(); i++) {
-		currentIx[i] = 0;
-		currentTime[i] = trackList.at(i).at(0).getTimestamp();
-	}
 	SynthTimestamp lastEventTime = 0; // Timestamp of the last added event
 	forever {
 		int trackIx = -1;
-		SynthTimestamp nextEventTime = 0x10000000;
+		SynthTimestamp nextEventTime = 0;
 
 		// Find lowest track index with earliest event
-		for (int i = 0; i < trackList.count(); i++) {
-			if (trackList.at(i).count() <= currentIx[i]) continue;
-			if (currentTime[i] < nextEventTime) {
-				nextEventTime = currentTime[i];
+		for (int i = 0; i < tracks.count(); i++) {
+			if (tracks.at(i).isFinished()) continue;
+			if (trackIx == -1 || tracks.at(i).getEventTime() < nextEventTime) {
+				nextEventTime = tracks.at(i).getEventTime();
 				trackIx = i;
 			}
 		}
 		if (trackIx == -1) break;
-		const QMidiEvent *e = &trackList.at(trackIx).at(currentIx[trackIx]);
-		forever {
-			midiEventList.append(*e);
-			midiEventList.last().setTimestamp(nextEventTime - lastEventTime);
-			lastEventTime = nextEventTime;
-			if (trackList.at(trackIx).count() <= ++currentIx[trackIx]) break;
-			e = &trackList.at(trackIx).at(currentIx[trackIx]);
-			SynthTimestamp nextDeltaTime = e->getTimestamp();
-			if (nextDeltaTime != 0) {
-				currentTime[trackIx] += nextDeltaTime;
-				break;
+		TrackDecoder &track = tracks[trackIx];
+		do {
+			int eventCount = midiEventList.count();
+			track.decodeEvent(midiEventList);
+			if (eventCount < midiEventList.count()) {
+				midiEventList.last().setTimestamp(nextEventTime - lastEventTime);
+				lastEventTime = nextEventTime;
 			}
-		}
+		} while (!track.isFinished() && track.getEventTime() == nextEventTime);
 	}
-	qDebug() << "MidiParser: Actually" << midiEventList.count() << "events";
+	qDebug() << "MidiParser: Parsed" << midiEventList.count() << "MIDI events";
 }
 
 bool MidiParser::parseSysex() {
-	qint64 fileSize = file.size();
-	file.seek(0);
-	char *fileData = new char[fileSize];
-	if (!readFile(fileData, fileSize)) {
-		delete[] fileData;
-		return false;
-	}
+	const uchar *data = (const uchar *)fileData.constData();
+	int fileSize = fileData.size();
 	int sysexBeginIx = -1;
-	uchar *data = (uchar *)fileData;
 	for (int i = 0; i < fileSize; i++) {
 		if (data[i] == 0xF0) {
 			sysexBeginIx = i;
 		}
 		if (sysexBeginIx != -1 && data[i] == 0xF7) {
 			int sysexLen = i - sysexBeginIx + 1;
-			midiEventList.newMidiEvent().assignSysex(1, &data[sysexBeginIx], sysexLen);
+			midiEventList.newSysexEvent(1, &data[sysexBeginIx], sysexLen);
 			sysexBeginIx = -1;
 		}
 	}
 	qDebug() << "MidiParser: Loaded sysex events:" << midiEventList.count();
-	delete[] fileData;
 	return true;
 }
 
@@ -294,20 +317,28 @@ bool MidiParser::doParse() {
 	if (format == 0xF0) return parseSysex();
 	qDebug() << "MidiParser: MIDI file format" << format;
 	switch(format) {
-		case 0:
+		case 0: {
 			if (numberOfTracks != 1) {
 				qDebug() << "MidiParser: MIDI file format error: MIDI files format 0 must have 1 MIDI track, not" << numberOfTracks;
 				return false;
 			}
-			return parseTrack(midiEventList);
+			QVector<TrackDecoder> tracks(1);
+			quint32 trackLen;
+			if (!findTrack(tracks[0], trackLen)) return false;
+			mergeTracks(tracks, trackLen);
+			return true;
+		}
 		case 1:
 			if (numberOfTracks > 0) {
-				QVector<QMidiEventList> trackList(numberOfTracks);
+				QVector<TrackDecoder> tracks(numberOfTracks);
+				quint32 totalTrackLen = 0;
 				for (uint i = 0; i < numberOfTracks; i++) {
-					qDebug() << "MidiParser: Parsing & merging MIDI track" << i + 1;
-					if (!parseTrack(trackList[i])) return false;
+					quint32 trackLen;
+					if (!findTrack(tracks[i], trackLen)) return false;
+					totalTrackLen += trackLen;
 				}
-				mergeMidiEventLists(trackList);
+				qDebug() << "MidiParser: Merging" << numberOfTracks << "MIDI tracks";
+				mergeTracks(tracks, totalTrackLen);
 				return true;
 			}
 			qDebug() << "MidiParser: MIDI file format error: MIDI files format 1 must have at least 1 MIDI track";
@@ -315,9 +346,10 @@ bool MidiParser::doParse() {
 		case 2:
 			for (uint i = 0; i < numberOfTracks; i++) {
 				qDebug() << "MidiParser: Parsing & appending MIDI track" << i + 1;
-				QMidiEventList list;
-				if (!parseTrack(list)) return false;
-				midiEventList += list;
+				QVector<TrackDecoder> tracks(1);
+				quint32 trackLen;
+				if (!findTrack(tracks[0], trackLen)) return false;
+				mergeTracks(tracks, trackLen);
 			}
 			return true;
 		default:
@@ -328,10 +360,17 @@ bool MidiParser::doParse() {
 
 bool MidiParser::parse(const QString fileName) {
 	midiEventList.clear();
-	file.setFileName(fileName);
-	file.open(QIODevice::ReadOnly);
-	bool parseResult = doParse();
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly)) {
+		qDebug() << "MidiParser: Error opening file";
+		return false;
+	}
+	fileData = file.readAll();
 	file.close();
+	filePos = 0;
+	bool parseResult = doParse();
+	// The decoded events don't refer to the file data
+	fileData.clear();
 	return parseResult;
 }
 
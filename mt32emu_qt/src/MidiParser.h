@@ -17,7 +17,10 @@ public:
 	void addChannelsReset();
 
 private:
-	QFile file;
+	class TrackDecoder;
+
+	QByteArray fileData;
+	quint32 filePos;
 	QMidiEventList midiEventList;
 
 	unsigned int format;
@@ -26,10 +29,10 @@ private:
 
 	static quint32 parseVarLenInt(const uchar * &data);
 
-	bool readFile(char *data, qint64 len);
+	const uchar *readFile(quint32 len);
 	bool parseHeader();
-	bool parseTrack(QMidiEventList &midiEventList);
-	void mergeMidiEventLists(QVector<QMidiEventList> &tracks);
+	bool findTrack(TrackDecoder &track, quint32 &trackLen);
+	void mergeTracks(QVector<TrackDecoder> &tracks, quint32 totalTrackLen);
 	bool parseSysex();
 	bool doParse();
 };
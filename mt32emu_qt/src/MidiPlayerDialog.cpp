@@ -19,11 +19,12 @@
 
 #include "MidiPlayerDialog.h"
 
-MidiPlayerDialog::MidiPlayerDialog(Master *master, QWidget *parent) : QDialog(parent), ui(new Ui::MidiPlayerDialog), smfDriver(master), stopped(true), sliderUpdating(false), paused(false), currentItem() {
+MidiPlayerDialog::MidiPlayerDialog(Master *master, QWidget *parent) : QDialog(parent), ui(new Ui::MidiPlayerDialog), smfDriver(master), stopped(true), sliderUpdating(false), paused(false), currentItem(), nextItem() {
 	ui->setupUi(this);
 	standardTitle = windowTitle();
 	ui->playButton->setEnabled(false);
 	connect(&smfDriver, SIGNAL(playbackFinished()), SLOT(handlePlaybackFinished()));
+	connect(&smfDriver, SIGNAL(playbackAdvanced(QString)), SLOT(handlePlaybackAdvanced(QString)));
 	connect(&smfDriver, SIGNAL(playbackTimeChanged(quint64, quint32)), SLOT(handlePlaybackTimeChanged(quint64, quint32)));
 	connect(&smfDriver, SIGNAL(tempoUpdated(quint32)), SLOT(handleTempoSet(quint32)));
 	connect(this, SIGNAL(playbackStarted(const QString &, const QString &)), master, SLOT(showBalloon(const QString &, const QString &)));
@@ -31,6 +32,12 @@ MidiPlayerDialog::MidiPlayerDialog(Master *master, QWidget *parent) : QDialog(pa
 	ui->playList->setDefaultDropAction(Qt::MoveAction);
 #endif // (QT_VERSION >= QT_VERSION_CHECK(4, 6, 0))
 	setAcceptDrops(true);
+	// Covers the items moved by dragging as well.
+	connect(ui->playList->model(), SIGNAL(rowsInserted(const QModelIndex &, int, int)), SLOT(handlePlayListChanged()));
+	connect(ui->playList->model(), SIGNAL(rowsRemoved(const QModelIndex &, int, int)), SLOT(handlePlayListChanged()));
+#if (QT_VERSION >= QT_VERSION_CHECK(4, 6, 0))
+	connect(ui->playList->model(), SIGNAL(rowsMoved(const QModelIndex &, int, int, const QModelIndex &, int)), SLOT(handlePlayListChanged()));
+#endif // (QT_VERSION >= QT_VERSION_CHECK(4, 6, 0))
 }
 
 MidiPlayerDialog::~MidiPlayerDialog() {
@@ -93,6 +100,7 @@ void MidiPlayerDialog::on_clearButton_clicked() {
 	currentItem = NULL;
 	ui->playList->clear();
 	updateCurrentItem();
+	queueNextItem();
 }
 
 void MidiPlayerDialog::on_saveListButton_clicked() {
@@ -158,6 +166,7 @@ void MidiPlayerDialog::on_stopButton_clicked() {
 		stopped = true;
 		smfDriver.stop();
 		updateCurrentItem();
+		queueNextItem();
 	}
 	ui->tempoSpinBox->setValue(MidiParser::DEFAULT_BPM);
 }
@@ -206,6 +215,7 @@ void MidiPlayerDialog::handlePlaybackFinished() {
 			}
 			stopped = true;
 			updateCurrentItem();
+			queueNextItem();
 			return;
 		}
 		ui->playList->setCurrentRow(rowPlaying);
@@ -213,11 +223,31 @@ void MidiPlayerDialog::handlePlaybackFinished() {
 		updateCurrentItem();
 	}
 	smfDriver.start(currentItem->text());
+	queueNextItem();
 	if (Master::getInstance()->getSettings()->value("Master/showConnectionBalloons", "1").toBool()) {
 		emit playbackStarted("Playing MIDI file", QFileInfo(ui->playList->currentItem()->text()).fileName());
 	}
 }
 
+// The playlist may have been changed since the driver took the queued item, then the one playing is no longer known.
+void MidiPlayerDialog::handlePlaybackAdvanced(QString fileName) {
+	currentItem = (nextItem != NULL && nextItem->text() == fileName) ? nextItem : NULL;
+	if (currentItem != NULL) ui->playList->setCurrentRow(ui->playList->row(currentItem));
+	updateCurrentItem();
+	queueNextItem();
+	// The driver has reset the tempo itself, so it needn't be notified.
+	ui->tempoSpinBox->blockSignals(true);
+	ui->tempoSpinBox->setValue(MidiParser::DEFAULT_BPM);
+	ui->tempoSpinBox->blockSignals(false);
+	if (Master::getInstance()->getSettings()->value("Master/showConnectionBalloons", "1").toBool()) {
+		emit playbackStarted("Playing MIDI file", QFileInfo(fileName).fileName());
+	}
+}
+
+void MidiPlayerDialog::handlePlayListChanged() {
+	queueNextItem();
+}
+
 void MidiPlayerDialog::handlePlaybackTimeChanged(quint64 currentNanos, quint32 totalSeconds) {
 	quint32 currentSeconds = currentNanos / MasterClock::NANOS_PER_SECOND;
 	QChar z = QChar('0');
@@ -269,6 +299,8 @@ void MidiPlayerDialog::dropEvent(QDropEvent *e) {
 }
 
 void MidiPlayerDialog::startPlayingFiles(const QStringList &fileList) {
+	// The item would be gone along with the others.
+	currentItem = NULL;
 	ui->playList->clear();
 	foreach (QString fileName, fileList) {
 		ui->playList->addItems(Master::parseMidiListFromPathName(fileName));
@@ -292,3 +324,13 @@ void MidiPlayerDialog::updateCurrentItem() {
 	}
 	setWindowTitle(title);
 }
+
+// Lets the driver prepare the item that follows the one playing, so that the playback continues with it seamlessly.
+void MidiPlayerDialog::queueNextItem() {
+	nextItem = NULL;
+	if (!stopped && currentItem != NULL) {
+		int nextRow = ui->playList->row(currentItem) + 1;
+		if (0 < nextRow && nextRow < ui->playList->count()) nextItem = ui->playList->item(nextRow);
+	}
+	smfDriver.setNextFileName(nextItem == NULL ? QString() : nextItem->text());
+}
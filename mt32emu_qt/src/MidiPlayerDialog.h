@@ -32,8 +32,10 @@ private:
 	bool sliderUpdating;
 	bool paused;
 	const QListWidgetItem *currentItem;
+	const QListWidgetItem *nextItem;
 
 	void updateCurrentItem();
+	void queueNextItem();
 
 private slots:
 	void on_playList_currentRowChanged(int currentRow);
@@ -56,6 +58,8 @@ private slots:
 	void on_positionSlider_valueChanged();
 	void on_positionSlider_sliderReleased();
 	void handlePlaybackFinished();
+	void handlePlaybackAdvanced(QString fileName);
+	void handlePlayListChanged();
 	void handlePlaybackTimeChanged(quint64 currentNanos, quint32 totalSeconds);
 	void handleTempoSet(quint32 tempo);
 
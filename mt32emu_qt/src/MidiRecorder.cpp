@@ -18,15 +18,9 @@
 
 #include "MidiRecorder.h"
 
-#include "MidiEventLayout.h"
 #include "QAtomicHelper.h"
 #include "RealtimeLocker.h"
 
-using MidiEventLayout::MidiEventHeader;
-
-typedef MidiEventLayout::ShortMessageEntry<MasterClockNanos> ShortMessageEntry;
-typedef MidiEventLayout::SysexMessageHeader<MasterClockNanos> SysexMessageHeader;
-
 enum MidiRecorderStatus {
 	MidiRecorderStatus_EMPTY = 0,
 	MidiRecorderStatus_RECORDING = 1,
@@ -37,56 +31,38 @@ static const char headerID[] = "MThd\x00\x00\x00\x06";
 static const char trackID[] = "MTrk";
 static const MasterClockNanos DEFAULT_NANOS_PER_QUARTER_NOTE = 500000000;
 
-static const uint DATA_CHUNK_SIZE = 32768;
-static const int DATA_CHUNK_ALLOCATION_PERIOD_MILLIS = 4000;
-static const quint32 MESSAGE_DATA_ALIGNMENT = quint32(sizeof(MasterClockNanos));
-
-// A chunk of byte data. Chunks can be bound into a semi-lock-free linked list.
-class DataChunk {
-private:
-	uchar * const byteBuffer;
-	QAtomicPointer<DataChunk> nextChunk;
-
-public:
-	DataChunk(uint byteBufferSize) : byteBuffer(new uchar[byteBufferSize]) {
-		// Touch the newly allocated chuck, potentially to trigger a page fault early.
-		volatile uchar *vBuffer = byteBuffer;
-		vBuffer[0];
-	}
+// Each capture buffer holds up to 2048 short messages, which is way more than a MIDI port is able to deliver in this period.
+static const unsigned long CAPTURE_DRAIN_PERIOD_MILLIS = 20;
+static const int RECORDED_EVENTS_RESERVATION = 4096;
 
-	~DataChunk() {
-		delete nextChunk.fetchAndStoreRelaxed(NULL);
-		delete[] byteBuffer;
-	}
+MidiCaptureDrainer::MidiCaptureDrainer(MidiRecorder &useMidiRecorder) : midiRecorder(useMidiRecorder), stopProcessing(false) {}
 
-	uchar *getByteBuffer() {
-		return byteBuffer;
-	}
-
-	DataChunk *getNextChunk() {
-		return QAtomicHelper::loadRelaxed(nextChunk);
-	}
+void MidiCaptureDrainer::stop() {
+	stopProcessing = true;
+	wait();
+	stopProcessing = false;
+}
 
-	DataChunk *setNextChunk(DataChunk *useNextChunk) {
-		return nextChunk.fetchAndStoreRelease(useNextChunk);
+void MidiCaptureDrainer::run() {
+	while (!stopProcessing) {
+		midiRecorder.drainTracks();
+		msleep(CAPTURE_DRAIN_PERIOD_MILLIS);
 	}
-};
-
-MidiRecorder::MidiRecorder() : startNanos(), endNanos(), allocationTimer(this) {
-	allocationTimer.setInterval(DATA_CHUNK_ALLOCATION_PERIOD_MILLIS);
-	connect(&allocationTimer, SIGNAL(timeout()), SLOT(handleAllocationTimer()));
 }
 
+MidiRecorder::MidiRecorder() : startNanos(), endNanos(), captureDrainer(*this) {}
+
 MidiRecorder::~MidiRecorder() {
 	reset();
 }
 
 void MidiRecorder::reset() {
 	status.fetchAndStoreOrdered(MidiRecorderStatus_EMPTY);
+	captureDrainer.stop();
+	QMutexLocker trackListLocker(&trackListMutex);
 	while (!midiTrackRecorders.isEmpty()) {
 		delete midiTrackRecorders.takeLast();
 	}
-	allocationTimer.stop();
 }
 
 void MidiRecorder::startRecording() {
@@ -96,7 +72,7 @@ void MidiRecorder::startRecording() {
 		reset();
 		return;
 	}
-	allocationTimer.start();
+	captureDrainer.start();
 }
 
 bool MidiRecorder::stopRecording() {
@@ -113,7 +89,8 @@ bool MidiRecorder::stopRecording() {
 	}
 
 	endNanos = MasterClock::getClockNanos();
-	allocationTimer.stop();
+	captureDrainer.stop();
+	drainTracks();
 	return newStatus == MidiRecorderStatus_HAS_DATA_PENDING_WRITE;
 }
 
@@ -131,10 +108,18 @@ bool MidiRecorder::hasPendingData() const {
 
 MidiTrackRecorder *MidiRecorder::addTrack() {
 	MidiTrackRecorder *midiTrackRecorder = new MidiTrackRecorder(*this);
+	QMutexLocker trackListLocker(&trackListMutex);
 	midiTrackRecorders << midiTrackRecorder;
 	return midiTrackRecorder;
 }
 
+void MidiRecorder::drainTracks() {
+	QMutexLocker trackListLocker(&trackListMutex);
+	for (int i = 0; i < midiTrackRecorders.size(); i++) {
+		midiTrackRecorders.at(i)->drainCaptureBuffer();
+	}
+}
+
 bool MidiRecorder::saveSMF(QString fileName, MasterClockNanos midiTick) {
 	if (!hasPendingData()) {
 		qWarning() << "MidiRecorder: Attempted to save SMF while was in status" << int(status) << "-> resetting";
@@ -158,11 +143,13 @@ bool MidiRecorder::saveSMF(QString fileName, MasterClockNanos midiTick) {
 	QFile file(fileName);
 	if (!file.open(QIODevice::WriteOnly)) return false;
 	if (!writeHeader(file, midiTrackRecorders.size(), division)) return false;
+	QMutexLocker trackListLocker(&trackListMutex);
 	while (!midiTrackRecorders.isEmpty()) {
 		MidiTrackRecorder *trackRecorder = midiTrackRecorders.takeFirst();
 		bool result = writeTrack(file, trackRecorder, midiTick);
 		delete trackRecorder;
 		if (!result) {
+			trackListLocker.unlock();
 			reset();
 			return false;
 		}
@@ -192,32 +179,22 @@ bool MidiRecorder::writeTrack(QFile &file, MidiTrackRecorder *midiTrackRecorder,
 	quint32 eventsProcessed = 0;
 	quint32 eventTicks = 0; // Number of ticks from start of track
 	uchar eventData[16]; // Buffer for single short event / sysex header
-	DataChunk *chunk = midiTrackRecorder->firstChunk;
-	DataChunk *lastChunk = QAtomicHelper::loadRelaxed(midiTrackRecorder->currentChunk);
-	quint32 readPosition = 0;
-	while (chunk != lastChunk || readPosition < midiTrackRecorder->writePosition) {
-		const uchar *readBuffer = chunk->getByteBuffer() + readPosition;
-		const MidiEventHeader *eventHeader = reinterpret_cast<const MidiEventHeader *>(readBuffer);
-		if (eventHeader->eventType == MidiEventLayout::MidiEventType_PAD) {
-			readPosition = 0;
-			chunk = chunk->getNextChunk();
-			if (chunk == NULL) break;
-			continue;
-		}
-
+	if (midiTrackRecorder->overflowCount > 0) {
+		qDebug() << "MidiRecorder: Lost" << midiTrackRecorder->overflowCount << "MIDI events due to capture buffer overflow";
+	}
+	for (int eventIx = 0; eventIx < midiTrackRecorder->recordedEvents.size(); eventIx++) {
+		const MidiTrackRecorder::RecordedEvent &event = midiTrackRecorder->recordedEvents.at(eventIx);
 		uchar *data = eventData;
-		if (eventHeader->eventType == MidiEventLayout::MidiEventType_SYSEX_MESSAGE) {
+		if (event.sysexOffset >= 0) {
 			// Process SysEx message
-			const SysexMessageHeader *sysexMessageHeader = reinterpret_cast<const SysexMessageHeader *>(readBuffer);
-			quint32 sysexLength = sysexMessageHeader->sysexDataLength;
-			readPosition += quint32(sizeof(SysexMessageHeader)) + MidiEventLayout::alignSysexDataLength(sysexLength, MESSAGE_DATA_ALIGNMENT);
-			const uchar *sysexData = reinterpret_cast<const uchar *>(sysexMessageHeader + 1);
+			quint32 sysexLength = event.eventData;
+			const uchar *sysexData = reinterpret_cast<const uchar *>(midiTrackRecorder->sysexPool.constData()) + event.sysexOffset;
 			if (sysexLength < 4 || sysexData[0] != 0xF0 || sysexData[sysexLength - 1] != 0xF7) {
 				// Invalid sysex, skipping
-				qDebug() << "MidiRecorder: wrong sysex skipped at:" << (sysexMessageHeader->timestamp - startNanos) * 1e-6 << "millis, length:" << sysexLength;
+				qDebug() << "MidiRecorder: wrong sysex skipped at:" << (event.timestamp - startNanos) * 1e-6 << "millis, length:" << sysexLength;
 				continue;
 			}
-			writeMessageTimestamp(data, eventTicks, sysexMessageHeader->timestamp, midiTick);
+			writeMessageTimestamp(data, eventTicks, event.timestamp, midiTick);
 			*(data++) = sysexData[0];
 			writeVarLenInt(data, sysexLength - 1);
 			if (!writeFile(file, (char *)eventData, data - eventData)) return false;
@@ -225,16 +202,14 @@ bool MidiRecorder::writeTrack(QFile &file, MidiTrackRecorder *midiTrackRecorder,
 			runningStatus = 0;
 		} else {
 			// Process short message
-			readPosition += quint32(sizeof(ShortMessageEntry));
-			const ShortMessageEntry *shortMessageEntry = reinterpret_cast<const ShortMessageEntry *>(readBuffer);
-			quint32 message = shortMessageEntry->shortMessageData;
+			quint32 message = event.eventData;
 			uint newStatus = message & 0xFF;
 			if (0xF0 <= newStatus) {
 				// No support for escaping System messages, ignore
-				qDebug() << "MidiRecorder: unsupported System message skipped at:" << (shortMessageEntry->timestamp - startNanos) * 1e-6 << "millis, code:" << newStatus;
+				qDebug() << "MidiRecorder: unsupported System message skipped at:" << (event.timestamp - startNanos) * 1e-6 << "millis, code:" << newStatus;
 				continue;
 			}
-			writeMessageTimestamp(data, eventTicks, shortMessageEntry->timestamp, midiTick);
+			writeMessageTimestamp(data, eventTicks, event.timestamp, midiTick);
 			if (newStatus == runningStatus) {
 				message >>= 8;
 				if ((newStatus & 0xE0) == 0xC0) {
@@ -314,67 +289,49 @@ void MidiRecorder::writeVarLenInt(uchar * &data, quint32 value) {
 	}
 }
 
-void MidiRecorder::handleAllocationTimer() {
-	for (int i = 0; i < midiTrackRecorders.size(); i++) {
-		MidiTrackRecorder *midiTrackRecorder = midiTrackRecorders.at(i);
-		DataChunk *chunk = QAtomicHelper::loadRelaxed(midiTrackRecorder->currentChunk);
-		if (chunk->getNextChunk() == NULL) {
-			// This track needs allocation of a new chunk.
-			chunk->setNextChunk(new DataChunk(DATA_CHUNK_SIZE));
-		}
-	}
-}
-
 MidiTrackRecorder::MidiTrackRecorder(MidiRecorder &useMidiRecorder) :
 	midiRecorder(useMidiRecorder),
-	firstChunk(new DataChunk(DATA_CHUNK_SIZE)),
-	currentChunk(firstChunk),
-	writePosition()
-{}
-
-MidiTrackRecorder::~MidiTrackRecorder() {
-	delete firstChunk;
+	overflowCount()
+{
+	recordedEvents.reserve(RECORDED_EVENTS_RESERVATION);
 }
 
 bool MidiTrackRecorder::recordShortMessage(quint32 shortMessageData, MasterClockNanos midiNanos) {
 	RealtimeLocker trackLocker(trackMutex);
 	if (!trackLocker.isLocked() || !midiRecorder.isRecording()) return false;
-	quint32 entryLength = quint32(sizeof(ShortMessageEntry));
-	uchar *byteBuffer = requireBufferSpace(entryLength);
-	if (byteBuffer == NULL) return false;
-	ShortMessageEntry *shortMessageEntry = reinterpret_cast<ShortMessageEntry *>(byteBuffer + writePosition);
-	shortMessageEntry->eventType = MidiEventLayout::MidiEventType_SHORT_MESSAGE;
-	shortMessageEntry->shortMessageData = shortMessageData;
-	shortMessageEntry->timestamp = midiNanos;
-	writePosition += entryLength;
+	if (!captureBuffer.pushShortMessage(quint64(midiNanos), shortMessageData)) {
+		overflowCount++;
+		return false;
+	}
+	captureBuffer.flush();
 	return true;
 }
 
 bool MidiTrackRecorder::recordSysex(const uchar *sysexData, quint32 sysexDataLength, MasterClockNanos midiNanos) {
 	RealtimeLocker trackLocker(trackMutex);
 	if (!trackLocker.isLocked() || !midiRecorder.isRecording()) return false;
-	quint32 entryLength = quint32(sizeof(SysexMessageHeader)) + MidiEventLayout::alignSysexDataLength(sysexDataLength, MESSAGE_DATA_ALIGNMENT);
-	uchar *byteBuffer = requireBufferSpace(entryLength);
-	if (byteBuffer == NULL) return false;
-	SysexMessageHeader *sysexMessageHeader = reinterpret_cast<SysexMessageHeader *>(byteBuffer + writePosition);
-	sysexMessageHeader->eventType = MidiEventLayout::MidiEventType_SYSEX_MESSAGE;
-	sysexMessageHeader->sysexDataLength = sysexDataLength;
-	sysexMessageHeader->timestamp = midiNanos;
-	memcpy(sysexMessageHeader + 1, sysexData, sysexDataLength);
-	writePosition += entryLength;
+	if (!captureBuffer.pushSysexMessage(quint64(midiNanos), sysexDataLength, sysexData)) {
+		overflowCount++;
+		return false;
+	}
+	captureBuffer.flush();
 	return true;
 }
 
-uchar *MidiTrackRecorder::requireBufferSpace(quint32 byteLength) {
-	DataChunk *chunk = QAtomicHelper::loadRelaxed(currentChunk);
-	if (writePosition + byteLength + sizeof(MidiEventHeader) <= DATA_CHUNK_SIZE) return chunk->getByteBuffer();
-	if (byteLength + sizeof(MidiEventHeader) > DATA_CHUNK_SIZE) return NULL;
-
-	DataChunk *nextChunk = chunk->getNextChunk();
-	if (nextChunk == NULL) return NULL;
-
-	reinterpret_cast<MidiEventHeader *>(chunk->getByteBuffer() + writePosition)->eventType = MidiEventLayout::MidiEventType_PAD;
-	writePosition = 0;
-	QAtomicHelper::storeRelease(currentChunk, nextChunk);
-	return nextChunk->getByteBuffer();
+void MidiTrackRecorder::drainCaptureBuffer() {
+	while (captureBuffer.retieveEvents()) {
+		do {
+			RecordedEvent event;
+			event.timestamp = MasterClockNanos(captureBuffer.getEventTimestamp());
+			const uchar *sysexData;
+			event.eventData = captureBuffer.getEventData(sysexData);
+			if (sysexData == NULL) {
+				event.sysexOffset = -1;
+			} else {
+				event.sysexOffset = qint32(sysexPool.size());
+				sysexPool.append(reinterpret_cast<const char *>(sysexData), int(event.eventData));
+			}
+			recordedEvents.append(event);
+		} while (captureBuffer.nextEvent());
+	}
 }
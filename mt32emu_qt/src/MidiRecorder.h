@@ -4,12 +4,28 @@
 #include <QtCore>
 
 #include "MasterClock.h"
+#include "QMidiBuffer.h"
 
-class DataChunk;
+class MidiRecorder;
 class MidiTrackRecorder;
 
+// Periodically moves the MIDI events captured by the track recorders to the track storage.
+class MidiCaptureDrainer : public QThread {
+public:
+	MidiCaptureDrainer(MidiRecorder &midiRecorder);
+	void stop();
+
+private:
+	MidiRecorder &midiRecorder;
+	volatile bool stopProcessing;
+
+	void run();
+};
+
 class MidiRecorder : public QObject {
 	Q_OBJECT
+	friend class MidiCaptureDrainer;
+
 public:
 	MidiRecorder();
 	~MidiRecorder();
@@ -30,43 +46,54 @@ private:
 
 	// Fields below are only accessed from the main thread.
 	MasterClockNanos startNanos, endNanos;
+	MidiCaptureDrainer captureDrainer;
+
+	// Guards the list of track recorders shared with the drainer thread.
+	QMutex trackListMutex;
 	QList<MidiTrackRecorder *> midiTrackRecorders;
-	QTimer allocationTimer;
 
+	void drainTracks();
 	bool writeHeader(QFile &file, const int numberOfTracks, uint division);
 	bool writeTrack(QFile &file, MidiTrackRecorder *midiTrackRecorder, const MasterClockNanos midiTick);
 	bool writeFile(QFile &file, const char *data, qint64 len);
 	void writeMessageTimestamp(uchar * &data, quint32 &eventTicks, const MasterClockNanos timestamp, const MasterClockNanos midiTick);
 	void writeVarLenInt(uchar * &data, quint32 value);
-
-private slots:
-	void handleAllocationTimer();
 };
 
-// A semi-lock-free MIDI stream buffer capable to grow as it gets filled up.
-// Memory is allocated upfront by chunks of predefined size in the main thread.
-// This property makes it suitable for using directly from a realtime thread.
+// Records the MIDI stream of a single MIDI session. The events are captured into a preallocated lock-free ring buffer,
+// so that recording neither allocates memory nor waits in the MIDI driver thread. The MidiCaptureDrainer thread moves
+// the captured events to the growing track storage in the background.
 class MidiTrackRecorder {
 friend class MidiRecorder;
 
 public:
 	MidiTrackRecorder(MidiRecorder &midiRecorder);
-	~MidiTrackRecorder();
 
 	// Methods below are only invoked from a single MIDI driver thread.
 	bool recordShortMessage(quint32 shortMessageData, MasterClockNanos midiNanos);
 	bool recordSysex(const uchar *sysexData, quint32 sysexDataLength, MasterClockNanos midiNanos);
 
 private:
+	struct RecordedEvent {
+		MasterClockNanos timestamp;
+		// Either short message data or SysEx data length.
+		quint32 eventData;
+		// Offset of the SysEx data in sysexPool, or -1 for a short message.
+		qint32 sysexOffset;
+	};
+
 	MidiRecorder &midiRecorder;
 	QMutex trackMutex;
-	DataChunk * const firstChunk;
-	QAtomicPointer<DataChunk> currentChunk;
+	QMidiBuffer captureBuffer;
+
+	// This field is only accessed from the MIDI driver thread while recording.
+	quint32 overflowCount;
 
-	// This field is only accessed from the MIDI driver thread.
-	quint32 writePosition;
+	// Fields below are only accessed from the drainer thread while recording, and from the main thread otherwise.
+	QVector<RecordedEvent> recordedEvents;
+	QByteArray sysexPool;
 
-	uchar *requireBufferSpace(quint32 byteLength);
+	void drainCaptureBuffer();
 };
 
 #endif
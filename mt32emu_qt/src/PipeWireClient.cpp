@@ -0,0 +1,226 @@
+/* Copyright (C) 2011-2021 Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <time.h>
+
+#include <spa/pod/iter.h>
+#include <spa/control/control.h>
+
+#include "PipeWireClient.h"
+#include "Master.h"
+#include "MasterClock.h"
+#include "MidiSession.h"
+#include "mididrv/PipeWireMidiDriver.h"
+#include "audiodrv/PipeWireAudioDriver.h"
+
+// Assumed until the graph runs the first cycle, when no latency is requested.
+static const quint32 DEFAULT_QUANTUM = 1024;
+
+static void initPipeWire() {
+	static bool initialised = false;
+	if (initialised) return;
+	pw_init(NULL, NULL);
+	initialised = true;
+}
+
+// The graph timestamps the cycles against CLOCK_MONOTONIC.
+static MasterClockNanos graphTimeToMasterClockNanos(quint64 graphNanos) {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	quint64 monotonicNanos = quint64(ts.tv_sec) * MasterClock::NANOS_PER_SECOND + ts.tv_nsec;
+	return MasterClock::getClockNanos() - MasterClockNanos(monotonicNanos - graphNanos);
+}
+
+void PipeWireClient::onStateChanged(void *instance, pw_filter_state, pw_filter_state newState, const char *error) {
+	PipeWireClient *pipeWireClient = static_cast<PipeWireClient *>(instance);
+	if (newState != PW_FILTER_STATE_ERROR || pipeWireClient->state != PipeWireClientState_OPEN) return;
+	qDebug() << "PipeWireClient: Filter failed:" << (error != NULL ? error : "unknown error");
+	// The thread loop cannot be stopped from within, so the resources are released by close() later.
+	pipeWireClient->state = PipeWireClientState_CLOSING;
+	if (pipeWireClient->midiSession != NULL) {
+		// This eventually deletes pipeWireClient
+		Master::getInstance()->deletePipeWireMidiPort(pipeWireClient->midiSession);
+	} else if (pipeWireClient->audioStream != NULL) {
+		pipeWireClient->audioStream->onPipeWireError();
+	}
+}
+
+void PipeWireClient::onProcess(void *instance, spa_io_position *position) {
+	PipeWireClient *pipeWireClient = static_cast<PipeWireClient *>(instance);
+	pipeWireClient->process(position);
+}
+
+PipeWireClient::PipeWireClient() :
+	state(PipeWireClientState_CLOSED),
+	threadLoop(),
+	filter(),
+	midiSession(),
+	audioStream(),
+	midiInPort(),
+	leftAudioOutPort(),
+	rightAudioOutPort(),
+	quantum(DEFAULT_QUANTUM)
+{
+	memset(&filterEvents, 0, sizeof filterEvents);
+	filterEvents.version = PW_VERSION_FILTER_EVENTS;
+	filterEvents.state_changed = onStateChanged;
+	filterEvents.process = onProcess;
+}
+
+PipeWireClient::~PipeWireClient() {
+	close();
+}
+
+PipeWireClientState PipeWireClient::open(MidiSession *useMidiSession, PipeWireAudioStream *useAudioStream, quint32 sampleRate, quint32 latencyFrames) {
+	if (state != PipeWireClientState_CLOSED) return state;
+	initPipeWire();
+	threadLoop = pw_thread_loop_new("mt32emu-qt", NULL);
+	if (threadLoop == NULL) return state;
+	if (pw_thread_loop_start(threadLoop) < 0) {
+		pw_thread_loop_destroy(threadLoop);
+		threadLoop = NULL;
+		return state;
+	}
+
+	pw_properties *properties = pw_properties_new(
+		PW_KEY_MEDIA_TYPE, useAudioStream != NULL ? "Audio" : "Midi",
+		PW_KEY_MEDIA_CATEGORY, "Playback",
+		PW_KEY_MEDIA_ROLE, "Music",
+		NULL);
+	if (useAudioStream != NULL) {
+		// Let the session manager link the audio output ports to the default sink like those of a playback stream.
+		pw_properties_set(properties, PW_KEY_MEDIA_CLASS, "Stream/Output/Audio");
+		pw_properties_set(properties, PW_KEY_NODE_AUTOCONNECT, "true");
+	}
+	if (sampleRate != 0) {
+		pw_properties_setf(properties, PW_KEY_NODE_RATE, "1/%u", sampleRate);
+		if (latencyFrames != 0) {
+			// The graph runs with the smallest quantum requested by the nodes, within the limits of the configuration.
+			pw_properties_setf(properties, PW_KEY_NODE_LATENCY, "%u/%u", latencyFrames, sampleRate);
+			quantum = latencyFrames;
+		}
+	}
+
+	pw_thread_loop_lock(threadLoop);
+	filter = pw_filter_new_simple(pw_thread_loop_get_loop(threadLoop), "mt32emu-qt", properties, &filterEvents, this);
+	if (filter == NULL) {
+		pw_thread_loop_unlock(threadLoop);
+		releaseResources();
+		return state;
+	}
+	if (useMidiSession != NULL) {
+		midiInPort = pw_filter_add_port(filter, PW_DIRECTION_INPUT, PW_FILTER_PORT_FLAG_MAP_BUFFERS, 0,
+			pw_properties_new(PW_KEY_FORMAT_DSP, "8 bit raw midi", PW_KEY_PORT_NAME, "midi_in", NULL), NULL, 0);
+		if (midiInPort == NULL) {
+			pw_thread_loop_unlock(threadLoop);
+			releaseResources();
+			return state;
+		}
+		midiSession = useMidiSession;
+	}
+	if (useAudioStream != NULL) {
+		leftAudioOutPort = pw_filter_add_port(filter, PW_DIRECTION_OUTPUT, PW_FILTER_PORT_FLAG_MAP_BUFFERS, 0,
+			pw_properties_new(PW_KEY_FORMAT_DSP, "32 bit float mono audio", PW_KEY_PORT_NAME, "left_audio_out", NULL), NULL, 0);
+		rightAudioOutPort = pw_filter_add_port(filter, PW_DIRECTION_OUTPUT, PW_FILTER_PORT_FLAG_MAP_BUFFERS, 0,
+			pw_properties_new(PW_KEY_FORMAT_DSP, "32 bit float mono audio", PW_KEY_PORT_NAME, "right_audio_out", NULL), NULL, 0);
+		if (leftAudioOutPort == NULL || rightAudioOutPort == NULL) {
+			pw_thread_loop_unlock(threadLoop);
+			releaseResources();
+			return state;
+		}
+		audioStream = useAudioStream;
+	}
+
+	// The process callback runs in the realtime data thread of the graph.
+	if (pw_filter_connect(filter, PW_FILTER_FLAG_RT_PROCESS, NULL, 0) < 0) {
+		pw_thread_loop_unlock(threadLoop);
+		releaseResources();
+		return state;
+	}
+	state = PipeWireClientState_OPEN;
+	pw_thread_loop_unlock(threadLoop);
+	return state;
+}
+
+PipeWireClientState PipeWireClient::close() {
+	if (state == PipeWireClientState_CLOSED) return state;
+	releaseResources();
+	state = PipeWireClientState_CLOSED;
+	return state;
+}
+
+void PipeWireClient::releaseResources() {
+	if (threadLoop == NULL) return;
+	pw_thread_loop_lock(threadLoop);
+	if (filter != NULL) {
+		// This also destroys the ports.
+		pw_filter_destroy(filter);
+		filter = NULL;
+	}
+	pw_thread_loop_unlock(threadLoop);
+	pw_thread_loop_stop(threadLoop);
+	pw_thread_loop_destroy(threadLoop);
+	threadLoop = NULL;
+	midiInPort = NULL;
+	leftAudioOutPort = NULL;
+	rightAudioOutPort = NULL;
+}
+
+void PipeWireClient::process(spa_io_position *position) {
+	if (position == NULL) return;
+	const quint32 frameCount = quint32(position->clock.duration);
+	quantum = frameCount;
+	if (midiSession != NULL) processMIDIInput(position);
+	if (audioStream != NULL) {
+		float *leftOutBuffer = static_cast<float *>(pw_filter_get_dsp_buffer(leftAudioOutPort, frameCount));
+		float *rightOutBuffer = static_cast<float *>(pw_filter_get_dsp_buffer(rightAudioOutPort, frameCount));
+		if (leftOutBuffer == NULL || rightOutBuffer == NULL) return;
+		const quint32 graphSampleRate = position->clock.rate.num == 0 ? 0 : position->clock.rate.denom / position->clock.rate.num;
+		MasterClockNanos cycleStartNanos = graphTimeToMasterClockNanos(position->clock.nsec);
+		audioStream->renderStreams(frameCount, graphSampleRate, cycleStartNanos, leftOutBuffer, rightOutBuffer);
+	}
+}
+
+void PipeWireClient::processMIDIInput(const spa_io_position *position) {
+	pw_buffer *buffer = pw_filter_dequeue_buffer(midiInPort);
+	if (buffer == NULL) return;
+	spa_data *data = &buffer->buffer->datas[0];
+	spa_pod *pod = static_cast<spa_pod *>(spa_pod_from_data(data->data, data->maxsize, data->chunk->offset, data->chunk->size));
+	if (pod != NULL && spa_pod_is_sequence(pod) && position->clock.rate.num != 0) {
+		const quint64 graphSampleRate = position->clock.rate.denom / position->clock.rate.num;
+		MasterClockNanos cycleStartNanos = audioStream != NULL ? 0 : graphTimeToMasterClockNanos(position->clock.nsec);
+		spa_pod_sequence *sequence = reinterpret_cast<spa_pod_sequence *>(pod);
+		spa_pod_control *control;
+		SPA_POD_SEQUENCE_FOREACH(sequence, control) {
+			if (control->type != SPA_CONTROL_Midi) continue;
+			uchar *midiBuffer = static_cast<uchar *>(SPA_POD_BODY(&control->value));
+			size_t midiBufferSize = SPA_POD_BODY_SIZE(&control->value);
+			if (midiBufferSize == 0) continue;
+			bool eventConsumed;
+			if (audioStream != NULL) {
+				// The events are rendered in the same cycle, at the sample offsets they arrive with.
+				quint64 eventTimestamp = audioStream->computeMIDITimestamp(control->offset);
+				eventConsumed = PipeWireMidiDriver::playMIDIMessage(midiSession, eventTimestamp, midiBufferSize, midiBuffer);
+			} else {
+				MasterClockNanos eventNanos = cycleStartNanos + MasterClockNanos(control->offset * MasterClock::NANOS_PER_SECOND / graphSampleRate);
+				eventConsumed = PipeWireMidiDriver::pushMIDIMessage(midiSession, eventNanos, midiBufferSize, midiBuffer);
+			}
+			if (!eventConsumed) break;
+		}
+	}
+	pw_filter_queue_buffer(midiInPort, buffer);
+}
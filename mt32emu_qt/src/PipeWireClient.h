@@ -0,0 +1,55 @@
+#ifndef PIPEWIRE_CLIENT_H
+#define PIPEWIRE_CLIENT_H
+
+#include <QtCore>
+
+#include <pipewire/pipewire.h>
+#include <pipewire/filter.h>
+
+enum PipeWireClientState {
+	PipeWireClientState_OPEN,
+	PipeWireClientState_CLOSING,
+	PipeWireClientState_CLOSED
+};
+
+class MidiSession;
+class PipeWireAudioStream;
+
+// Wraps a PipeWire filter node, which is processed by the data thread of the graph in the cycles of the graph quantum.
+// Similarly to JACKClient, the node has a MIDI input port when created for a MIDI session, and a pair of DSP audio
+// output ports when created for an audio stream. The MIDI events arrive in the same cycle with sample offsets,
+// so that they can be either rendered synchronously or pushed to the synth route with precise timestamps.
+class PipeWireClient {
+public:
+	PipeWireClient();
+	virtual ~PipeWireClient();
+
+	PipeWireClientState open(MidiSession *midiSession, PipeWireAudioStream *audioStream, quint32 sampleRate, quint32 latencyFrames);
+	PipeWireClientState close();
+	// Returns the number of frames processed in the latest cycle of the graph, or the requested latency before it starts.
+	quint32 getQuantum() const {
+		return quantum;
+	}
+
+private:
+	PipeWireClientState state;
+	pw_thread_loop *threadLoop;
+	pw_filter *filter;
+	pw_filter_events filterEvents;
+	spa_hook filterListener;
+	MidiSession *midiSession;
+	PipeWireAudioStream *audioStream;
+	void *midiInPort;
+	void *leftAudioOutPort;
+	void *rightAudioOutPort;
+	volatile quint32 quantum;
+
+	static void onStateChanged(void *instance, pw_filter_state oldState, pw_filter_state newState, const char *error);
+	static void onProcess(void *instance, spa_io_position *position);
+
+	void releaseResources();
+	void process(spa_io_position *position);
+	void processMIDIInput(const spa_io_position *position);
+};
+
+#endif
@@ -21,89 +21,90 @@
 using namespace MT32Emu;
 
 QMidiEvent::QMidiEvent() :
-	type(SHORT_MESSAGE),
-	msg(),
-	sysexData()
+	typeAndTimestamp(quint32(SHORT_MESSAGE) << TYPE_SHIFT),
+	msg()
 {}
 
-QMidiEvent::QMidiEvent(const QMidiEvent &copyOf) :
-	timestamp(copyOf.timestamp),
-	type(copyOf.type)
-{
-	if (type == SYSEX && copyOf.sysexData != NULL) {
-		sysexLen = copyOf.sysexLen;
-		sysexData = new uchar[sysexLen];
-		memcpy(sysexData, copyOf.sysexData, sysexLen);
-	} else {
-		msg = copyOf.msg;
-		sysexData = NULL;
-	}
+SynthTimestamp QMidiEvent::getTimestamp() const {
+	return typeAndTimestamp & TIMESTAMP_MASK;
 }
 
-QMidiEvent::~QMidiEvent() {
-	delete[] sysexData;
+MidiEventType QMidiEvent::getType() const {
+	return MidiEventType(typeAndTimestamp >> TYPE_SHIFT);
 }
 
-SynthTimestamp QMidiEvent::getTimestamp() const {
-	return timestamp;
+Bit32u QMidiEvent::getShortMessage() const {
+	return msg;
 }
 
-MidiEventType QMidiEvent::getType() const {
-	return type;
+void QMidiEvent::setTimestamp(SynthTimestamp newTimestamp) {
+	// Delta times in SMF are limited to 28 bits, and so are the delta times of the merged tracks.
+	quint32 timestamp = newTimestamp < TIMESTAMP_MASK ? quint32(newTimestamp) : TIMESTAMP_MASK;
+	typeAndTimestamp = (typeAndTimestamp & ~TIMESTAMP_MASK) | timestamp;
 }
 
-uchar *QMidiEvent::getSysexData() const {
-	return sysexData;
+void QMidiEvent::assign(MidiEventType newType, SynthTimestamp newTimestamp, Bit32u newData) {
+	typeAndTimestamp = quint32(newType) << TYPE_SHIFT;
+	setTimestamp(newTimestamp);
+	msg = newData;
 }
 
-Bit32u QMidiEvent::getShortMessage() const {
-	return msg;
+void QMidiEvent::assignShortMessage(SynthTimestamp newTimestamp, Bit32u newMsg) {
+	assign(SHORT_MESSAGE, newTimestamp, newMsg);
 }
 
-Bit32u QMidiEvent::getSysexLen() const {
-	return sysexLen;
+void QMidiEvent::assignSetTempoMessage(SynthTimestamp newTimestamp, MT32Emu::Bit32u newTempo) {
+	assign(SET_TEMPO, newTimestamp, newTempo);
 }
 
-void QMidiEvent::setTimestamp(SynthTimestamp newTimestamp) {
-	timestamp = newTimestamp;
+void QMidiEvent::assignSyncMessage(SynthTimestamp newTimestamp) {
+	assign(SYNC, newTimestamp, 0);
 }
 
-void QMidiEvent::assignShortMessage(SynthTimestamp newTimestamp, Bit32u newMsg) {
-	timestamp = newTimestamp;
-	type = SHORT_MESSAGE;
-	msg = newMsg;
-	delete[] sysexData;
-	sysexData = NULL;
+int QMidiEventList::count() const {
+	return events.count();
 }
 
-void QMidiEvent::assignSysex(SynthTimestamp newTimestamp, uchar const * const newSysexData, Bit32u newSysexLen) {
-	timestamp = newTimestamp;
-	type = SYSEX;
-	sysexLen = newSysexLen;
-	delete[] sysexData;
-	uchar *copy = new uchar[newSysexLen];
-	memcpy(copy, newSysexData, newSysexLen);
-	sysexData = copy;
+bool QMidiEventList::isEmpty() const {
+	return events.isEmpty();
 }
 
-void QMidiEvent::assignSetTempoMessage(SynthTimestamp newTimestamp, MT32Emu::Bit32u newTempo) {
-	timestamp = newTimestamp;
-	type = SET_TEMPO;
-	msg = newTempo;
-	delete[] sysexData;
-	sysexData = NULL;
+const QMidiEvent &QMidiEventList::at(int i) const {
+	return events.at(i);
 }
 
-void QMidiEvent::assignSyncMessage(SynthTimestamp newTimestamp) {
-	timestamp = newTimestamp;
-	type = SYNC;
-	msg = 0;
-	delete[] sysexData;
-	sysexData = NULL;
+QMidiEvent &QMidiEventList::last() {
+	return events.last();
+}
+
+void QMidiEventList::reserve(int eventCount) {
+	events.reserve(eventCount);
+}
+
+void QMidiEventList::clear() {
+	events.clear();
+	sysexPool.clear();
 }
 
 QMidiEvent &QMidiEventList::newMidiEvent() {
-	uint s = size();
-	resize(s + 1);
-	return last();
+	events.resize(events.size() + 1);
+	return events.last();
+}
+
+// The SysEx data is stored in the pool prefixed with its length.
+void QMidiEventList::newSysexEvent(SynthTimestamp timestamp, uchar const * const sysexData, Bit32u sysexLen) {
+	Bit32u sysexOffset = Bit32u(sysexPool.size());
+	sysexPool.append(reinterpret_cast<const char *>(&sysexLen), int(sizeof sysexLen));
+	sysexPool.append(reinterpret_cast<const char *>(sysexData), int(sysexLen));
+	newMidiEvent().assign(SYSEX, timestamp, sysexOffset);
+}
+
+const uchar *QMidiEventList::getSysexData(const QMidiEvent &event) const {
+	return reinterpret_cast<const uchar *>(sysexPool.constData()) + event.sysexOffset + sizeof(Bit32u);
+}
+
+Bit32u QMidiEventList::getSysexLen(const QMidiEvent &event) const {
+	Bit32u sysexLen;
+	memcpy(&sysexLen, sysexPool.constData() + event.sysexOffset, sizeof sysexLen);
+	return sysexLen;
 }
@@ -3,6 +3,7 @@
 
 #include <QtGlobal>
 #include <QVector>
+#include <QByteArray>
 
 #include <mt32emu/mt32emu.h>
 
@@ -17,37 +18,59 @@ enum MidiEventType {
 
 typedef MasterClockNanos SynthTimestamp;
 
+// A MIDI event packed in 8 bytes. The event type shares a word with the timestamp, which is a delta time in MIDI ticks
+// and never exceeds the 28 bits of an SMF variable-length quantity. The other word holds the short message or the tempo,
+// while the data of a SysEx event is kept in the pool of the QMidiEventList the event belongs to.
 class QMidiEvent {
+	friend class QMidiEventList;
+
 private:
-	SynthTimestamp timestamp;
-	MidiEventType type;
+	static const uint TYPE_SHIFT = 28;
+	static const quint32 TIMESTAMP_MASK = (1U << TYPE_SHIFT) - 1U;
+
+	quint32 typeAndTimestamp;
 	union {
 		MT32Emu::Bit32u msg;
-		MT32Emu::Bit32u sysexLen;
+		MT32Emu::Bit32u sysexOffset;
 	};
-	uchar *sysexData;
+
+	void assign(MidiEventType newType, SynthTimestamp newTimestamp, MT32Emu::Bit32u newData);
 
 public:
 	QMidiEvent();
-	QMidiEvent(const QMidiEvent &copyOf);
-	~QMidiEvent();
 
 	SynthTimestamp getTimestamp() const;
 	MidiEventType getType() const;
 	MT32Emu::Bit32u getShortMessage() const;
-	MT32Emu::Bit32u getSysexLen() const;
-	uchar *getSysexData() const;
 
 	void setTimestamp(SynthTimestamp newTimestamp);
 	void assignShortMessage(SynthTimestamp newTimestamp, MT32Emu::Bit32u newMsg);
-	void assignSysex(SynthTimestamp newTimestamp, uchar const * const newSysexData, MT32Emu::Bit32u newSysexLen);
 	void assignSetTempoMessage(SynthTimestamp newTimestamp, MT32Emu::Bit32u newTempo);
 	void assignSyncMessage(SynthTimestamp newTimestamp);
 };
 
-class QMidiEventList : public QVector<QMidiEvent> {
+Q_DECLARE_TYPEINFO(QMidiEvent, Q_PRIMITIVE_TYPE);
+
+// A sequence of MIDI events with the SysEx data stored contiguously in a single byte pool, each SysEx event refers to
+// its data by offset. This avoids a heap allocation per SysEx event and keeps the events trivially copyable.
+class QMidiEventList {
 public:
+	int count() const;
+	bool isEmpty() const;
+	const QMidiEvent &at(int i) const;
+	QMidiEvent &last();
+	void reserve(int eventCount);
+	void clear();
+
 	QMidiEvent &newMidiEvent();
+	void newSysexEvent(SynthTimestamp timestamp, uchar const * const sysexData, MT32Emu::Bit32u sysexLen);
+
+	const uchar *getSysexData(const QMidiEvent &event) const;
+	MT32Emu::Bit32u getSysexLen(const QMidiEvent &event) const;
+
+private:
+	QVector<QMidiEvent> events;
+	QByteArray sysexPool;
 };
 
 #endif
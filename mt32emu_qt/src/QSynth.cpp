@@ -18,11 +18,30 @@
 #include <QtGlobal>
 #include <QMessageBox>
 
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#elif defined(Q_OS_MAC)
+#include <AvailabilityMacros.h>
+#include <pthread.h>
+// Thread QoS classes are only available since OS X 10.10.
+#if MAC_OS_X_VERSION_MIN_REQUIRED >= 101000
+#define WITH_MAC_QOS_CLASS
+#include <sys/qos.h>
+#endif
+#elif defined(Q_OS_UNIX)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include "QSynth.h"
 #include "AudioFileWriter.h"
 #include "Master.h"
 #include "MasterClock.h"
+#include "QAtomicHelper.h"
 #include "RealtimeLocker.h"
+#include "RealtimeReadLocker.h"
+#include "RenderingThreadPool.h"
+#include "Tracer.h"
 
 using namespace MT32Emu;
 
@@ -73,43 +92,179 @@ static int readMasterVolume(Synth *synth) {
 	return masterVolume;
 }
 
+static void applyReverbCompatibilityMode(Synth *synth, ReverbCompatibilityMode reverbCompatibilityMode) {
+	bool mt32CompatibleReverb;
+	if (reverbCompatibilityMode == ReverbCompatibilityMode_DEFAULT) {
+		mt32CompatibleReverb = synth->isDefaultReverbMT32Compatible();
+	} else {
+		mt32CompatibleReverb = reverbCompatibilityMode == ReverbCompatibilityMode_MT32;
+	}
+	synth->setReverbCompatibilityMode(mt32CompatibleReverb);
+}
+
+// Triple-buffered copy of the synth state that the monitors poll. The rendering thread publishes a complete state
+// after each rendered block, while the readers pick up the latest published one. Neither side ever waits for the other,
+// so the monitors can't interfere with rendering. Concurrent readers are only serialised among themselves.
+class MonitorStateBuffer {
+private:
+	static const int STATE_INDEX_MASK = 3;
+	static const int FRESH_STATE_FLAG = 4;
+
+	struct MonitorState {
+		Bit32u partialCount;
+		PartialState partialStates[MAX_PARTIAL_COUNT];
+		bool partStates[PART_COUNT];
+		Bit32u playingNotesCount[PART_COUNT];
+		Bit8u keysOfPlayingNotes[PART_COUNT][MAX_PARTIAL_COUNT];
+		Bit8u velocitiesOfPlayingNotes[PART_COUNT][MAX_PARTIAL_COUNT];
+	};
+
+	MonitorState states[3];
+	// Only accessed from the rendering thread.
+	int backStateIx;
+	// Index of the latest published state, combined with FRESH_STATE_FLAG until a reader takes it over.
+	QAtomicInt middleStateIx;
+	// Guarded by readerMutex.
+	int frontStateIx;
+	QMutex readerMutex;
+
+	// Must be invoked with the readerMutex locked.
+	const MonitorState &getFrontState() {
+		if (QAtomicHelper::loadRelaxed(middleStateIx) & FRESH_STATE_FLAG) {
+			frontStateIx = middleStateIx.fetchAndStoreOrdered(frontStateIx) & STATE_INDEX_MASK;
+		}
+		return states[frontStateIx];
+	}
+
+public:
+	MonitorStateBuffer() : states(), backStateIx(0), middleStateIx(1), frontStateIx(2) {}
+
+	// Invoked by the rendering thread with the synth locked.
+	void publish(Synth &synth) {
+		MonitorState &state = states[backStateIx];
+		state.partialCount = synth.getPartialCount();
+		synth.getPartialStates(state.partialStates);
+		synth.getPartStates(state.partStates);
+		for (int partIx = 0; partIx < PART_COUNT; partIx++) {
+			state.playingNotesCount[partIx] = synth.getPlayingNotes(partIx, state.keysOfPlayingNotes[partIx], state.velocitiesOfPlayingNotes[partIx]);
+		}
+		// Ordered exchange publishes the state just written and makes sure the readers are done with the one we take over.
+		backStateIx = middleStateIx.fetchAndStoreOrdered(backStateIx | FRESH_STATE_FLAG) & STATE_INDEX_MASK;
+	}
+
+	void getPartStates(bool *partStates) {
+		QMutexLocker readerLocker(&readerMutex);
+		memcpy(partStates, getFrontState().partStates, PART_COUNT * sizeof(bool));
+	}
+
+	// The state published before the synth got reopened with fewer partials may still be around, hence the limit.
+	void getPartialStates(PartialState *partialStates, Bit32u partialCount) {
+		QMutexLocker readerLocker(&readerMutex);
+		const MonitorState &state = getFrontState();
+		memcpy(partialStates, state.partialStates, qMin(partialCount, state.partialCount) * sizeof(PartialState));
+	}
+
+	uint getPlayingNotes(uint partNumber, Bit8u *keys, Bit8u *velocities) {
+		QMutexLocker readerLocker(&readerMutex);
+		const MonitorState &state = getFrontState();
+		Bit32u playingNotesCount = state.playingNotesCount[partNumber];
+		memcpy(keys, state.keysOfPlayingNotes[partNumber], playingNotesCount * sizeof(Bit8u));
+		memcpy(velocities, state.velocitiesOfPlayingNotes[partNumber], playingNotesCount * sizeof(Bit8u));
+		return playingNotesCount;
+	}
+};
+
+// Collects the synth state changes reported in the non-realtime mode, guarded by the synth mutex. Emitting a queued signal
+// for each reported event would post an event to the GUI thread each time, which floods its event loop with dense MIDI.
+// Instead, the changes are taken over by the rendering thread and delivered no more often than the display can follow.
+class CoalescedReports {
+public:
+	static const MasterClockNanos MINIMUM_DELIVERY_INTERVAL_NANOS = MasterClock::NANOS_PER_SECOND / 60;
+
+	MasterClockNanos lastDeliveryNanos;
+	bool midiMessagePlayed;
+	// Bit masks of the parts with the respective state changed.
+	quint32 polyStateChangedParts;
+	quint32 programChangedParts;
+	char soundGroupNames[PART_COUNT][SOUND_GROUP_NAME_LENGTH];
+	char timbreNames[PART_COUNT][TIMBRE_NAME_LENGTH];
+
+	CoalescedReports() : lastDeliveryNanos(), midiMessagePlayed(), polyStateChangedParts(), programChangedParts(),
+		soundGroupNames(), timbreNames()
+	{}
+
+	bool isEmpty() const {
+		return !midiMessagePlayed && polyStateChangedParts == 0 && programChangedParts == 0;
+	}
+
+	void onProgramChanged(Bit8u partNum, const char soundGroupName[], const char patchName[]) {
+		programChangedParts |= 1 << partNum;
+		memcpy(soundGroupNames[partNum], soundGroupName, SOUND_GROUP_NAME_LENGTH - 1);
+		memcpy(timbreNames[partNum], patchName, TIMBRE_NAME_LENGTH - 1);
+	}
+
+	void takeOver(CoalescedReports &reports) {
+		reports.midiMessagePlayed = midiMessagePlayed;
+		reports.polyStateChangedParts = polyStateChangedParts;
+		reports.programChangedParts = programChangedParts;
+		for (int partIx = 0; partIx < PART_COUNT; partIx++) {
+			if ((programChangedParts & (1 << partIx)) == 0) continue;
+			memcpy(reports.soundGroupNames[partIx], soundGroupNames[partIx], SOUND_GROUP_NAME_LENGTH - 1);
+			memcpy(reports.timbreNames[partIx], timbreNames[partIx], TIMBRE_NAME_LENGTH - 1);
+		}
+		midiMessagePlayed = false;
+		polyStateChangedParts = 0;
+		programChangedParts = 0;
+	}
+};
+
 class RealtimeHelper : public QThread {
 private:
+	// The changes are applied in the order of declaration, regardless of the order they were requested in.
+	// Notably, the reverb settings are overridden before the reverb gets enabled or disabled, as writing them re-enables it.
 	enum SynthControlEvent {
 		SYNTH_RESET,
 		MASTER_VOLUME_CHANGED,
 		OUTPUT_GAIN_CHANGED,
 		REVERB_OUTPUT_GAIN_CHANGED,
-		REVERB_ENABLED_CHANGED,
+		REVERB_COMPATIBILITY_MODE_CHANGED,
 		REVERB_OVERRIDDEN_CHANGED,
 		REVERB_SETTINGS_CHANGED,
+		REVERB_ENABLED_CHANGED,
 		REVERSED_STEREO_ENABLED_CHANGED,
 		NICE_AMP_RAMP_ENABLED_CHANGED,
 		NICE_PANNING_ENABLED_CHANGED,
 		NICE_PARTIAL_MIXING_ENABLED_CHANGED,
 		EMU_DAC_INPUT_MODE_CHANGED,
 		MIDI_DELAY_MODE_CHANGED,
-		MIDI_CHANNELS_ASSIGNMENT_RESET
+		MIDI_CHANNELS_ASSIGNMENT_RESET,
+		SYNTH_CONTROL_EVENT_COUNT
 	};
 
 	QSynth &qsynth;
 	bool stopProcessing;
 
-	QQueue<SynthControlEvent> synthControlEvents;
-
-	// Synth settings, guarded by settingsMutex.
-	int masterVolume;
-	float outputGain;
-	float reverbOutputGain;
-	bool reverbEnabled;
-	bool reverbOverridden;
-	bool reversedStereoEnabled;
-	bool niceAmpRampEnabled;
-	bool nicePanningEnabled;
-	bool nicePartialMixingEnabled;
-	DACInputMode emuDACInputMode;
-	MIDIDelayMode midiDelayMode;
-	bool midiChannelsAssignmentChannel1Engaged;
+	// Bit mask of pending SynthControlEvents. The rendering thread takes the entire mask atomically at the beginning
+	// of each rendering pass, so it never has to wait for the setters, which may run concurrently in any other thread.
+	QAtomicInt pendingSynthControlEvents;
+
+	// Synth settings. Each setting is stored before the respective event is posted, so that the rendering thread
+	// always sees the latest value. Floating-point values are kept as their binary representation.
+	QAtomicInt masterVolume;
+	QAtomicInt outputGain;
+	QAtomicInt reverbOutputGain;
+	QAtomicInt reverbCompatibilityMode;
+	QAtomicInt reverbEnabled;
+	QAtomicInt reverbOverridden;
+	// Reverb mode, time and level packed into a single value to be updated atomically.
+	QAtomicInt reverbSettings;
+	QAtomicInt reversedStereoEnabled;
+	QAtomicInt niceAmpRampEnabled;
+	QAtomicInt nicePanningEnabled;
+	QAtomicInt nicePartialMixingEnabled;
+	QAtomicInt emuDACInputMode;
+	QAtomicInt midiDelayMode;
+	QAtomicInt midiChannelsAssignmentChannel1Engaged;
 
 	// Temp synth state collected while rendering, only accessed from the rendering thread.
 	// On backpressure, the latest values are kept.
@@ -141,69 +296,92 @@ private:
 			bool programChanged;
 			char soundGroupName[SOUND_GROUP_NAME_LENGTH];
 			char timbreName[TIMBRE_NAME_LENGTH];
-			bool active;
-			Bit32u playingNotesCount;
-			Bit8u keysOfPlayingNotes[MAX_PARTIAL_COUNT];
-			Bit8u velocitiesOfPlayingNotes[MAX_PARTIAL_COUNT];
 		} partStates[PART_COUNT];
-		PartialState partialStates[MAX_PARTIAL_COUNT];
 	} stateSnapshot;
 
 
-	/** Ensures atomicity of collecting changes to be applied to the synth settings. */
-	QMutex settingsMutex;
 	/** Ensures atomicity of handling the output signals of the synth and capturing its internal state. */
 	QMutex stateSnapshotMutex;
 	/** Used to block this thread until each rendering pass completes. */
 	QWaitCondition renderCompleteCondition;
 
+	static quint32 floatToBits(float value) {
+		union {
+			float floatValue;
+			quint32 bits;
+		} converter;
+		converter.floatValue = value;
+		return converter.bits;
+	}
+
+	static float bitsToFloat(quint32 bits) {
+		union {
+			float floatValue;
+			quint32 bits;
+		} converter;
+		converter.bits = bits;
+		return converter.floatValue;
+	}
+
+	static quint32 packReverbSettings(int reverbMode, int reverbTime, int reverbLevel) {
+		return (reverbMode & 0xFF) | ((reverbTime & 0xFF) << 8) | ((reverbLevel & 0xFF) << 16);
+	}
+
 	void applyChangesRealtime() {
-		RealtimeLocker settingsLocker(settingsMutex);
-		if (!settingsLocker.isLocked()) return;
+		// Acquire ordering ensures the settings stored prior to posting the events are visible here.
+		quint32 events = pendingSynthControlEvents.fetchAndStoreAcquire(0);
 		Synth *synth = qsynth.synth;
-		while (!synthControlEvents.isEmpty()) {
-			switch (synthControlEvents.dequeue()) {
+		for (int event = 0; events != 0; event++, events >>= 1) {
+			if ((events & 1) == 0) continue;
+			switch (SynthControlEvent(event)) {
 			case SYNTH_RESET:
 				writeSystemResetSysex(synth);
 				break;
 			case MASTER_VOLUME_CHANGED:
-				writeMasterVolumeSysex(synth, masterVolume);
+				writeMasterVolumeSysex(synth, QAtomicHelper::loadRelaxed(masterVolume));
 				break;
 			case OUTPUT_GAIN_CHANGED:
-				synth->setOutputGain(outputGain);
+				synth->setOutputGain(bitsToFloat(QAtomicHelper::loadRelaxed(outputGain)));
 				break;
 			case REVERB_OUTPUT_GAIN_CHANGED:
-				synth->setReverbOutputGain(reverbOutputGain);
+				synth->setReverbOutputGain(bitsToFloat(QAtomicHelper::loadRelaxed(reverbOutputGain)));
 				break;
-			case REVERB_ENABLED_CHANGED:
-				synth->setReverbEnabled(reverbEnabled);
+			case REVERB_COMPATIBILITY_MODE_CHANGED:
+				applyReverbCompatibilityMode(synth, ReverbCompatibilityMode(QAtomicHelper::loadRelaxed(reverbCompatibilityMode)));
 				break;
 			case REVERB_OVERRIDDEN_CHANGED:
-				synth->setReverbOverridden(reverbOverridden);
+				synth->setReverbOverridden(QAtomicHelper::loadRelaxed(reverbOverridden) != 0);
 				break;
-			case REVERB_SETTINGS_CHANGED:
-				overrideReverbSettings(synth, qsynth.reverbMode, qsynth.reverbTime, qsynth.reverbLevel);
+			case REVERB_SETTINGS_CHANGED: {
+				quint32 settings = QAtomicHelper::loadRelaxed(reverbSettings);
+				overrideReverbSettings(synth, settings & 0xFF, (settings >> 8) & 0xFF, (settings >> 16) & 0xFF);
+				break;
+			}
+			case REVERB_ENABLED_CHANGED:
+				synth->setReverbEnabled(QAtomicHelper::loadRelaxed(reverbEnabled) != 0);
 				break;
 			case REVERSED_STEREO_ENABLED_CHANGED:
-				synth->setReversedStereoEnabled(reversedStereoEnabled);
+				synth->setReversedStereoEnabled(QAtomicHelper::loadRelaxed(reversedStereoEnabled) != 0);
 				break;
 			case NICE_AMP_RAMP_ENABLED_CHANGED:
-				synth->setNiceAmpRampEnabled(niceAmpRampEnabled);
+				synth->setNiceAmpRampEnabled(QAtomicHelper::loadRelaxed(niceAmpRampEnabled) != 0);
 				break;
 			case NICE_PANNING_ENABLED_CHANGED:
-				synth->setNicePanningEnabled(nicePanningEnabled);
+				synth->setNicePanningEnabled(QAtomicHelper::loadRelaxed(nicePanningEnabled) != 0);
 				break;
 			case NICE_PARTIAL_MIXING_ENABLED_CHANGED:
-				synth->setNicePartialMixingEnabled(nicePartialMixingEnabled);
+				synth->setNicePartialMixingEnabled(QAtomicHelper::loadRelaxed(nicePartialMixingEnabled) != 0);
 				break;
 			case EMU_DAC_INPUT_MODE_CHANGED:
-				synth->setDACInputMode(emuDACInputMode);
+				synth->setDACInputMode(DACInputMode(QAtomicHelper::loadRelaxed(emuDACInputMode)));
 				break;
 			case MIDI_DELAY_MODE_CHANGED:
-				synth->setMIDIDelayMode(midiDelayMode);
+				synth->setMIDIDelayMode(MIDIDelayMode(QAtomicHelper::loadRelaxed(midiDelayMode)));
 				break;
 			case MIDI_CHANNELS_ASSIGNMENT_RESET:
-				writeMIDIChannelsAssignmentResetSysex(synth, midiChannelsAssignmentChannel1Engaged);
+				writeMIDIChannelsAssignmentResetSysex(synth, QAtomicHelper::loadRelaxed(midiChannelsAssignmentChannel1Engaged) != 0);
+				break;
+			case SYNTH_CONTROL_EVENT_COUNT:
 				break;
 			}
 		}
@@ -231,10 +409,6 @@ private:
 		stateSnapshot.reverbLevel = tempState.reverbLevel;
 		tempState.reverbLevel = NO_UPDATE_VALUE;
 
-		Synth *synth = qsynth.synth;
-		bool partStates[PART_COUNT];
-		synth->getPartStates(partStates);
-
 		for (int partIx = 0; partIx < PART_COUNT; partIx++) {
 			stateSnapshot.partStates[partIx].programChanged = tempState.partStates[partIx].programChanged;
 			if (tempState.partStates[partIx].programChanged) {
@@ -243,21 +417,18 @@ private:
 				memcpy(stateSnapshot.partStates[partIx].timbreName, tempState.partStates[partIx].timbreName, TIMBRE_NAME_LENGTH - 1);
 			}
 
-			stateSnapshot.partStates[partIx].active = partStates[partIx];
-
 			stateSnapshot.partStates[partIx].polyStateChanged = tempState.partStates[partIx].polyStateChanged;
-			if (tempState.partStates[partIx].polyStateChanged) {
-				tempState.partStates[partIx].polyStateChanged = false;
-				stateSnapshot.partStates[partIx].playingNotesCount = synth->getPlayingNotes(partIx, stateSnapshot.partStates[partIx].keysOfPlayingNotes, stateSnapshot.partStates[partIx].velocitiesOfPlayingNotes);
-			}
+			tempState.partStates[partIx].polyStateChanged = false;
 		}
-
-		synth->getPartialStates(stateSnapshot.partialStates);
 	}
 
-	void enqueueSynthControlEvent(SynthControlEvent value) {
-		synthControlEvents.removeOne(value);
-		synthControlEvents.enqueue(value);
+	// Release ordering publishes the setting stored right before.
+	void postSynthControlEvent(SynthControlEvent event) {
+		const int eventBit = 1 << event;
+		int events;
+		do {
+			events = QAtomicHelper::loadRelaxed(pendingSynthControlEvents);
+		} while (!pendingSynthControlEvents.testAndSetRelease(events, events | eventBit));
 	}
 
 	void run() {
@@ -307,6 +478,10 @@ private:
 			}
 
 			emit qsynth.audioBlockRendered();
+
+			// The reverb model selected while rendering is prepared here, as the rendering thread must not allocate memory.
+			QMutexLocker reverbPreparationLocker(qsynth.reverbPreparationMutex);
+			qsynth.synth->prepareReverbModels();
 		}
 	}
 
@@ -314,8 +489,9 @@ public:
 	RealtimeHelper(QSynth &useQSynth) :
 		qsynth(useQSynth),
 		stopProcessing(),
-		outputGain(qsynth.synth->getOutputGain()),
-		reverbOutputGain(qsynth.synth->getReverbOutputGain()),
+		outputGain(floatToBits(qsynth.synth->getOutputGain())),
+		reverbOutputGain(floatToBits(qsynth.synth->getReverbOutputGain())),
+		reverbCompatibilityMode(qsynth.reverbCompatibilityMode),
 		reverbEnabled(!qsynth.synth->isReverbOverridden() || qsynth.synth->isReverbEnabled()),
 		reverbOverridden(qsynth.synth->isReverbOverridden()),
 		reversedStereoEnabled(qsynth.synth->isReversedStereoEnabled()),
@@ -342,105 +518,97 @@ public:
 	}
 
 	void getSynthSettings(SynthProfile &synthProfile) {
-		QMutexLocker settingsLocker(&settingsMutex);
-		synthProfile.outputGain = outputGain;
-		synthProfile.reverbOutputGain = reverbOutputGain;
-		synthProfile.reverbOverridden = reverbOverridden;
-		synthProfile.reverbEnabled = reverbEnabled;
+		synthProfile.outputGain = bitsToFloat(QAtomicHelper::loadRelaxed(outputGain));
+		synthProfile.reverbOutputGain = bitsToFloat(QAtomicHelper::loadRelaxed(reverbOutputGain));
+		synthProfile.reverbOverridden = QAtomicHelper::loadRelaxed(reverbOverridden) != 0;
+		synthProfile.reverbEnabled = QAtomicHelper::loadRelaxed(reverbEnabled) != 0;
 		synthProfile.reverbMode = qsynth.reverbMode;
 		synthProfile.reverbTime = qsynth.reverbTime;
 		synthProfile.reverbLevel = qsynth.reverbLevel;
-		synthProfile.reversedStereoEnabled = reversedStereoEnabled;
-		synthProfile.niceAmpRamp = niceAmpRampEnabled;
-		synthProfile.nicePanning = nicePanningEnabled;
-		synthProfile.nicePartialMixing = nicePartialMixingEnabled;
-		synthProfile.emuDACInputMode = emuDACInputMode;
-		synthProfile.midiDelayMode = midiDelayMode;
+		synthProfile.reversedStereoEnabled = QAtomicHelper::loadRelaxed(reversedStereoEnabled) != 0;
+		synthProfile.niceAmpRamp = QAtomicHelper::loadRelaxed(niceAmpRampEnabled) != 0;
+		synthProfile.nicePanning = QAtomicHelper::loadRelaxed(nicePanningEnabled) != 0;
+		synthProfile.nicePartialMixing = QAtomicHelper::loadRelaxed(nicePartialMixingEnabled) != 0;
+		synthProfile.emuDACInputMode = DACInputMode(QAtomicHelper::loadRelaxed(emuDACInputMode));
+		synthProfile.midiDelayMode = MIDIDelayMode(QAtomicHelper::loadRelaxed(midiDelayMode));
 	}
 
 	void setMasterVolume(int useMasterVolume) {
-		QMutexLocker settingsLocker(&settingsMutex);
-		masterVolume = useMasterVolume;
-		enqueueSynthControlEvent(MASTER_VOLUME_CHANGED);
+		QAtomicHelper::storeRelease(masterVolume, useMasterVolume);
+		postSynthControlEvent(MASTER_VOLUME_CHANGED);
 	}
 
 	void setOutputGain(float useOutputGain) {
-		QMutexLocker settingsLocker(&settingsMutex);
-		outputGain = useOutputGain;
-		enqueueSynthControlEvent(OUTPUT_GAIN_CHANGED);
+		QAtomicHelper::storeRelease(outputGain, floatToBits(useOutputGain));
+		postSynthControlEvent(OUTPUT_GAIN_CHANGED);
 	}
 
 	void setReverbOutputGain(float useReverbOutputGain) {
-		QMutexLocker settingsLocker(&settingsMutex);
-		reverbOutputGain = useReverbOutputGain;
-		enqueueSynthControlEvent(REVERB_OUTPUT_GAIN_CHANGED);
+		QAtomicHelper::storeRelease(reverbOutputGain, floatToBits(useReverbOutputGain));
+		postSynthControlEvent(REVERB_OUTPUT_GAIN_CHANGED);
+	}
+
+	void setReverbCompatibilityMode(ReverbCompatibilityMode useReverbCompatibilityMode) {
+		QAtomicHelper::storeRelease(reverbCompatibilityMode, useReverbCompatibilityMode);
+		postSynthControlEvent(REVERB_COMPATIBILITY_MODE_CHANGED);
 	}
 
 	void setReverbEnabled(bool useReverbEnabled) {
-		QMutexLocker settingsLocker(&settingsMutex);
-		reverbEnabled = useReverbEnabled;
-		enqueueSynthControlEvent(REVERB_ENABLED_CHANGED);
+		QAtomicHelper::storeRelease(reverbEnabled, useReverbEnabled);
+		postSynthControlEvent(REVERB_ENABLED_CHANGED);
 	}
 
 	void setReverbOverridden(bool useReverbOverridden) {
-		QMutexLocker settingsLocker(&settingsMutex);
-		reverbOverridden = useReverbOverridden;
-		enqueueSynthControlEvent(REVERB_OVERRIDDEN_CHANGED);
+		QAtomicHelper::storeRelease(reverbOverridden, useReverbOverridden);
+		postSynthControlEvent(REVERB_OVERRIDDEN_CHANGED);
 	}
 
+	// The reverb settings in QSynth are only accessed from the thread that changes them.
 	void setReverbSettings(int useReverbMode, int useReverbTime, int useReverbLevel) {
-		QMutexLocker settingsLocker(&settingsMutex);
 		qsynth.reverbMode = useReverbMode;
 		qsynth.reverbTime = useReverbTime;
 		qsynth.reverbLevel = useReverbLevel;
-		enqueueSynthControlEvent(REVERB_SETTINGS_CHANGED);
+		QAtomicHelper::storeRelease(reverbSettings, packReverbSettings(useReverbMode, useReverbTime, useReverbLevel));
+		postSynthControlEvent(REVERB_SETTINGS_CHANGED);
 	}
 
 	void setReversedStereoEnabled(bool useReversedStereoEnabled) {
-		QMutexLocker settingsLocker(&settingsMutex);
-		reversedStereoEnabled = useReversedStereoEnabled;
-		enqueueSynthControlEvent(REVERSED_STEREO_ENABLED_CHANGED);
+		QAtomicHelper::storeRelease(reversedStereoEnabled, useReversedStereoEnabled);
+		postSynthControlEvent(REVERSED_STEREO_ENABLED_CHANGED);
 	}
 
 	void setNiceAmpRampEnabled(bool useNiceAmpRampEnabled) {
-		QMutexLocker settingsLocker(&settingsMutex);
-		niceAmpRampEnabled = useNiceAmpRampEnabled;
-		enqueueSynthControlEvent(NICE_AMP_RAMP_ENABLED_CHANGED);
+		QAtomicHelper::storeRelease(niceAmpRampEnabled, useNiceAmpRampEnabled);
+		postSynthControlEvent(NICE_AMP_RAMP_ENABLED_CHANGED);
 	}
 
 	void setNicePanningEnabled(bool useNicePanningEnabled) {
-		QMutexLocker settingsLocker(&settingsMutex);
-		nicePanningEnabled = useNicePanningEnabled;
-		enqueueSynthControlEvent(NICE_PANNING_ENABLED_CHANGED);
+		QAtomicHelper::storeRelease(nicePanningEnabled, useNicePanningEnabled);
+		postSynthControlEvent(NICE_PANNING_ENABLED_CHANGED);
 	}
 
 	void setNicePartialMixingEnabled(bool useNicePartialMixingEnabled) {
-		QMutexLocker settingsLocker(&settingsMutex);
-		nicePartialMixingEnabled = useNicePartialMixingEnabled;
-		enqueueSynthControlEvent(NICE_PARTIAL_MIXING_ENABLED_CHANGED);
+		QAtomicHelper::storeRelease(nicePartialMixingEnabled, useNicePartialMixingEnabled);
+		postSynthControlEvent(NICE_PARTIAL_MIXING_ENABLED_CHANGED);
 	}
 
 	void setDACInputMode(DACInputMode useEmuDACInputMode) {
-		QMutexLocker settingsLocker(&settingsMutex);
-		emuDACInputMode = useEmuDACInputMode;
-		enqueueSynthControlEvent(EMU_DAC_INPUT_MODE_CHANGED);
+		QAtomicHelper::storeRelease(emuDACInputMode, useEmuDACInputMode);
+		postSynthControlEvent(EMU_DAC_INPUT_MODE_CHANGED);
 	}
 
 	void setMIDIDelayMode(MIDIDelayMode useMIDIDelayMode) {
-		QMutexLocker settingsLocker(&settingsMutex);
-		midiDelayMode = useMIDIDelayMode;
-		enqueueSynthControlEvent(MIDI_DELAY_MODE_CHANGED);
+		QAtomicHelper::storeRelease(midiDelayMode, useMIDIDelayMode);
+		postSynthControlEvent(MIDI_DELAY_MODE_CHANGED);
 	}
 
 	void resetMidiChannelsAssignment(bool useMidiChannelsAssignmentChannel1Engaged) {
-		QMutexLocker settingsLocker(&settingsMutex);
-		midiChannelsAssignmentChannel1Engaged = useMidiChannelsAssignmentChannel1Engaged;
-		enqueueSynthControlEvent(MIDI_CHANNELS_ASSIGNMENT_RESET);
+		QAtomicHelper::storeRelease(midiChannelsAssignmentChannel1Engaged, useMidiChannelsAssignmentChannel1Engaged);
+		postSynthControlEvent(MIDI_CHANNELS_ASSIGNMENT_RESET);
 	}
 
 	void resetSynth() {
-		QMutexLocker settingsLocker(&settingsMutex);
-		enqueueSynthControlEvent(SYNTH_RESET);
+		postSynthControlEvent(SYNTH_RESET);
 	}
 
 	bool playMIDIShortMessageRealtime(Bit32u msg, quint64 timestamp) const {
@@ -458,6 +626,7 @@ public:
 		if (synthLocker.isLocked() && qsynth.isOpen()) {
 			applyChangesRealtime();
 			qsynth.sampleRateConverter->getOutputSamples(buffer, length);
+			qsynth.monitorStateBuffer->publish(*qsynth.synth);
 			saveStateRealtime();
 			renderCompleteCondition.wakeOne();
 		} else {
@@ -465,27 +634,30 @@ public:
 		}
 	}
 
-	void getPartStates(bool *partStates) {
-		QMutexLocker stateSnapshotLocker(&stateSnapshotMutex);
-		if (!qsynth.isOpen()) return;
-		for (int partIx = 0; partIx < PART_COUNT; partIx++) {
-			partStates[partIx] = stateSnapshot.partStates[partIx].active;
+	void renderRealtime(float *leftBuffer, float *rightBuffer, uint length) {
+		RealtimeLocker synthLocker(*qsynth.synthMutex);
+		if (synthLocker.isLocked() && qsynth.isOpen()) {
+			applyChangesRealtime();
+			qsynth.sampleRateConverter->getOutputSamples(leftBuffer, rightBuffer, length);
+			qsynth.monitorStateBuffer->publish(*qsynth.synth);
+			saveStateRealtime();
+			renderCompleteCondition.wakeOne();
+		} else {
+			Synth::muteSampleBuffer(leftBuffer, length);
+			Synth::muteSampleBuffer(rightBuffer, length);
 		}
 	}
 
-	void getPartialStates(PartialState *partialStates) {
-		QMutexLocker stateSnapshotLocker(&stateSnapshotMutex);
-		if (!qsynth.isOpen()) return;
-		memcpy(partialStates, stateSnapshot.partialStates, qsynth.synth->getPartialCount() * sizeof(PartialState));
-	}
-
-	uint getPlayingNotes(uint partNumber, Bit8u *keys, Bit8u *velocities) {
-		QMutexLocker stateSnapshotLocker(&stateSnapshotMutex);
-		if (!qsynth.isOpen()) return 0;
-		Bit32u playingNotesCount = stateSnapshot.partStates[partNumber].playingNotesCount;
-		memcpy(keys, stateSnapshot.partStates[partNumber].keysOfPlayingNotes, playingNotesCount * sizeof(Bit8u));
-		memcpy(velocities, stateSnapshot.partStates[partNumber].velocitiesOfPlayingNotes, playingNotesCount * sizeof(Bit8u));
-		return playingNotesCount;
+	// Invoked by the render worker, which takes over the rendering pass from the audio driver thread.
+	void renderAheadRealtime(AsyncRenderer &asyncRenderer) {
+		RealtimeLocker synthLocker(*qsynth.synthMutex);
+		if (synthLocker.isLocked() && qsynth.isOpen()) {
+			applyChangesRealtime();
+			if (asyncRenderer.renderAhead() == 0) return;
+			qsynth.monitorStateBuffer->publish(*qsynth.synth);
+			saveStateRealtime();
+			renderCompleteCondition.wakeOne();
+		}
 	}
 
 	void onLCDMessage(const char *message) {
@@ -523,6 +695,122 @@ public:
 	}
 };
 
+// Renders the synth output ahead into the ring buffer of an AsyncRenderer on a dedicated thread, so that the audio driver
+// threads merely copy the rendered frames out and never wait for the synth. The thread may be pinned to a set of CPU cores
+// and runs with the realtime scheduling priority where the system permits. Frames are rendered ahead by the length
+// of the largest block requested by the audio driver, which adds as much latency.
+class RenderWorker : public QThread, private AsyncRenderer::Listener {
+public:
+	RenderWorker(QSynth &useQSynth, const QList<int> &useCPUCores) :
+		qsynth(useQSynth), cpuCores(useCPUCores), stopProcessing(false),
+		asyncRenderer(*useQSynth.sampleRateConverter, useQSynth.synth->getSelectedRendererType(), BUFFER_LENGTH, this)
+	{
+		asyncRenderer.setRenderAheadLength(0);
+		start(QThread::TimeCriticalPriority);
+	}
+
+	~RenderWorker() {
+		stopProcessing = true;
+		renderAheadNeeded.release();
+		wait();
+	}
+
+	template <class Sample>
+	void read(Sample *buffer, uint length) {
+		if (asyncRenderer.getRenderAheadLength() < length) asyncRenderer.setRenderAheadLength(length);
+		asyncRenderer.read(buffer, length);
+	}
+
+	// Events are delayed by the render-ahead length, so that they keep the precise timing despite the synth running ahead.
+	// The silence filled in upon underruns shifts the output timeline with respect to the synth.
+	quint64 convertOutputToRenderedTimestamp(quint64 timestamp) const {
+		qint64 renderedTimestamp = qint64(timestamp) + asyncRenderer.getRenderAheadLength() - asyncRenderer.getUnderrunLength();
+		return renderedTimestamp < 0 ? 0 : quint64(renderedTimestamp);
+	}
+
+private:
+	static const Bit32u BUFFER_LENGTH = 16384;
+
+	QSynth &qsynth;
+	const QList<int> cpuCores;
+	volatile bool stopProcessing;
+	QSemaphore renderAheadNeeded;
+	AsyncRenderer asyncRenderer;
+
+	void onRenderAheadNeeded() {
+		renderAheadNeeded.release();
+	}
+
+	void run() {
+#if defined(Q_OS_WIN)
+		typedef HANDLE (WINAPI *AvSetMmThreadCharacteristicsProc)(LPCWSTR, LPDWORD);
+		typedef BOOL (WINAPI *AvRevertMmThreadCharacteristicsProc)(HANDLE);
+
+		DWORD_PTR affinityMask = 0;
+		foreach (int cpuCore, cpuCores) {
+			if (cpuCore < int(8 * sizeof(DWORD_PTR))) affinityMask |= DWORD_PTR(1) << cpuCore;
+		}
+		if (affinityMask != 0 && SetThreadAffinityMask(GetCurrentThread(), affinityMask) == 0) {
+			qDebug() << "QSynth: Failed to pin render worker to CPU cores" << cpuCores;
+		}
+		HANDLE hMmcss = NULL;
+		HMODULE hAvrt = LoadLibraryA("avrt.dll");
+		AvRevertMmThreadCharacteristicsProc avRevertMmThreadCharacteristics = NULL;
+		if (hAvrt != NULL) {
+			AvSetMmThreadCharacteristicsProc avSetMmThreadCharacteristics = (AvSetMmThreadCharacteristicsProc)GetProcAddress(hAvrt, "AvSetMmThreadCharacteristicsW");
+			avRevertMmThreadCharacteristics = (AvRevertMmThreadCharacteristicsProc)GetProcAddress(hAvrt, "AvRevertMmThreadCharacteristics");
+			DWORD taskIndex = 0;
+			if (avSetMmThreadCharacteristics != NULL) hMmcss = avSetMmThreadCharacteristics(L"Pro Audio", &taskIndex);
+		}
+#elif defined(Q_OS_MAC)
+#ifdef WITH_MAC_QOS_CLASS
+		pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0);
+#endif
+#elif defined(Q_OS_UNIX)
+#ifdef Q_OS_LINUX
+		if (!cpuCores.isEmpty()) {
+			cpu_set_t cpuSet;
+			CPU_ZERO(&cpuSet);
+			foreach (int cpuCore, cpuCores) {
+				if (cpuCore < CPU_SETSIZE) CPU_SET(cpuCore, &cpuSet);
+			}
+			if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0) {
+				qDebug() << "QSynth: Failed to pin render worker to CPU cores" << cpuCores;
+			}
+		}
+#endif
+		sched_param schedParam;
+		schedParam.sched_priority = (sched_get_priority_min(SCHED_FIFO) + sched_get_priority_max(SCHED_FIFO)) / 2;
+		if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &schedParam) != 0) {
+			qDebug() << "QSynth: Realtime scheduling is not permitted, render worker runs with normal priority";
+		}
+#endif
+
+		forever {
+			renderAheadNeeded.acquire();
+			if (stopProcessing) break;
+			// Notifications that pile up while rendering are served by a single pass.
+			renderAheadNeeded.tryAcquire(renderAheadNeeded.available());
+			if (qsynth.isRealtime()) {
+				qsynth.realtimeHelper->renderAheadRealtime(asyncRenderer);
+				continue;
+			}
+			QMutexLocker synthLocker(qsynth.synthMutex);
+			if (!qsynth.isOpen() || asyncRenderer.renderAhead() == 0) continue;
+			qsynth.monitorStateBuffer->publish(*qsynth.synth);
+			CoalescedReports reports;
+			bool reportsTaken = qsynth.takeCoalescedReports(reports);
+			synthLocker.unlock();
+			if (reportsTaken) qsynth.emitCoalescedReports(reports);
+		}
+
+#if defined(Q_OS_WIN)
+		if (hMmcss != NULL && avRevertMmThreadCharacteristics != NULL) avRevertMmThreadCharacteristics(hMmcss);
+		if (hAvrt != NULL) FreeLibrary(hAvrt);
+#endif
+	}
+};
+
 QReportHandler::QReportHandler(QSynth *qsynth) : QObject(qsynth) {
 	connect(this, SIGNAL(balloonMessageAppeared(const QString &, const QString &)), Master::getInstance(), SLOT(showBalloon(const QString &, const QString &)));
 }
@@ -556,7 +844,7 @@ void QReportHandler::onMIDIMessagePlayed() {
 	if (qSynth()->isRealtime()) {
 		qSynth()->realtimeHelper->onMIDIMessagePlayed();
 	} else {
-		emit midiMessagePlayed();
+		qSynth()->coalescedReports->midiMessagePlayed = true;
 	}
 }
 
@@ -608,7 +896,7 @@ void QReportHandler::onPolyStateChanged(Bit8u partNum) {
 	if (qSynth()->isRealtime()) {
 		qSynth()->realtimeHelper->onPolyStateChanged(partNum);
 	} else {
-		emit polyStateChanged(partNum);
+		qSynth()->coalescedReports->polyStateChangedParts |= 1 << partNum;
 	}
 }
 
@@ -616,7 +904,7 @@ void QReportHandler::onProgramChanged(Bit8u partNum, const char soundGroupName[]
 	if (qSynth()->isRealtime()) {
 		qSynth()->realtimeHelper->onProgramChanged(partNum, soundGroupName, patchName);
 	} else {
-		emit programChanged(partNum, QString().fromLocal8Bit(soundGroupName), QString().fromLocal8Bit(patchName));
+		qSynth()->coalescedReports->onProgramChanged(partNum, soundGroupName, patchName);
 	}
 }
 
@@ -629,19 +917,25 @@ void QReportHandler::doShowLCDMessage(const char *message) {
 }
 
 QSynth::QSynth(QObject *parent) :
-	QObject(parent), state(SynthState_CLOSED), midiMutex(new QMutex), synthMutex(new QMutex),
-	controlROMImage(), pcmROMImage(), reportHandler(this), sampleRateConverter(),
-	audioRecorder(), realtimeHelper()
+	QObject(parent), state(SynthState_CLOSED), midiMutex(new QMutex), synthMutex(new QMutex), reverbPreparationMutex(new QMutex),
+	controlROMImage(), pcmROMImage(), numaNode(-1), reportHandler(this), sampleRateConverter(),
+	audioRecorder(), realtimeHelper(), renderWorker(), renderWorkerLock(new QReadWriteLock),
+	monitorStateBuffer(new MonitorStateBuffer), coalescedReports(new CoalescedReports)
 {
 	synth = new Synth(&reportHandler);
 }
 
 QSynth::~QSynth() {
 	freeROMImages();
+	delete renderWorker;
 	delete realtimeHelper;
+	delete monitorStateBuffer;
+	delete coalescedReports;
 	delete audioRecorder;
 	delete sampleRateConverter;
 	delete synth;
+	delete renderWorkerLock;
+	delete reverbPreparationMutex;
 	delete synthMutex;
 	delete midiMutex;
 }
@@ -684,11 +978,50 @@ bool QSynth::playMIDISysex(const Bit8u *sysex, Bit32u sysexLen, quint64 timestam
 	}
 }
 
+// Must be invoked with the MIDI mutex locked.
 Bit32u QSynth::convertOutputToSynthTimestamp(quint64 timestamp) const {
+	if (renderWorker != NULL) timestamp = renderWorker->convertOutputToRenderedTimestamp(timestamp);
 	return Bit32u(sampleRateConverter->convertOutputToSynthTimestamp(timestamp));
 }
 
+// Must be invoked with the synth mutex locked.
+bool QSynth::takeCoalescedReports(CoalescedReports &reports) const {
+	if (coalescedReports->isEmpty()) return false;
+	MasterClockNanos nanosNow = MasterClock::getClockNanos();
+	if (nanosNow - coalescedReports->lastDeliveryNanos < CoalescedReports::MINIMUM_DELIVERY_INTERVAL_NANOS) return false;
+	coalescedReports->lastDeliveryNanos = nanosNow;
+	coalescedReports->takeOver(reports);
+	return true;
+}
+
+void QSynth::emitCoalescedReports(const CoalescedReports &reports) {
+	if (reports.midiMessagePlayed) emit reportHandler.midiMessagePlayed();
+	for (int partIx = 0; partIx < PART_COUNT; partIx++) {
+		if (reports.polyStateChangedParts & (1 << partIx)) emit reportHandler.polyStateChanged(partIx);
+		if (reports.programChangedParts & (1 << partIx)) {
+			emit reportHandler.programChanged(partIx, QString().fromLocal8Bit(reports.soundGroupNames[partIx]), QString().fromLocal8Bit(reports.timbreNames[partIx]));
+		}
+	}
+}
+
 void QSynth::render(Bit16s *buffer, uint length) {
+	TraceScope traceScope("QSynth::render", length);
+	RealtimeReadLocker renderWorkerLocker(*renderWorkerLock);
+	if (!renderWorkerLocker.isLocked()) {
+		// The render worker is going down along with the synth
+		Synth::muteSampleBuffer(buffer, 2 * length);
+		emit audioBlockRendered();
+		return;
+	}
+	if (renderWorker != NULL) {
+		renderWorker->read(buffer, length);
+		QMutexLocker synthLocker(synthMutex);
+		bool recordingFailed = isRecordingAudio() && !audioRecorder->write(buffer, length);
+		synthLocker.unlock();
+		if (recordingFailed) stopRecordingAudio();
+		emit audioBlockRendered();
+		return;
+	}
 	QMutexLocker synthLocker(synthMutex);
 	if (!isOpen()) {
 		synthLocker.unlock();
@@ -699,14 +1032,30 @@ void QSynth::render(Bit16s *buffer, uint length) {
 		return;
 	}
 	sampleRateConverter->getOutputSamples(buffer, length);
-	if (isRecordingAudio()) {
-		if (!audioRecorder->write(buffer, length)) stopRecordingAudio();
-	}
+	monitorStateBuffer->publish(*synth);
+	bool recordingFailed = isRecordingAudio() && !audioRecorder->write(buffer, length);
+	CoalescedReports reports;
+	bool reportsTaken = takeCoalescedReports(reports);
 	synthLocker.unlock();
+	if (recordingFailed) stopRecordingAudio();
+	if (reportsTaken) emitCoalescedReports(reports);
 	emit audioBlockRendered();
 }
 
 void QSynth::render(float *buffer, uint length) {
+	TraceScope traceScope("QSynth::render", length);
+	RealtimeReadLocker renderWorkerLocker(*renderWorkerLock);
+	if (!renderWorkerLocker.isLocked()) {
+		// The render worker is going down along with the synth
+		Synth::muteSampleBuffer(buffer, 2 * length);
+		emit audioBlockRendered();
+		return;
+	}
+	if (renderWorker != NULL) {
+		renderWorker->read(buffer, length);
+		emit audioBlockRendered();
+		return;
+	}
 	if (isRealtime()) {
 		realtimeHelper->renderRealtime(buffer, length);
 		return;
@@ -721,11 +1070,59 @@ void QSynth::render(float *buffer, uint length) {
 		return;
 	}
 	sampleRateConverter->getOutputSamples(buffer, length);
+	monitorStateBuffer->publish(*synth);
+	CoalescedReports reports;
+	bool reportsTaken = takeCoalescedReports(reports);
 	synthLocker.unlock();
+	if (reportsTaken) emitCoalescedReports(reports);
 	// TODO: Add support for recording to float WAVs
 	emit audioBlockRendered();
 }
 
+void QSynth::render(float *leftBuffer, float *rightBuffer, uint length) {
+	TraceScope traceScope("QSynth::render", length);
+	RealtimeReadLocker renderWorkerLocker(*renderWorkerLock);
+	if (!renderWorkerLocker.isLocked()) {
+		// The render worker is going down along with the synth
+		Synth::muteSampleBuffer(leftBuffer, length);
+		Synth::muteSampleBuffer(rightBuffer, length);
+		emit audioBlockRendered();
+		return;
+	}
+	if (renderWorker != NULL) {
+		// The frames are kept interleaved in the ring buffer.
+		QVarLengthArray<float, 4096> frames(int(2 * length));
+		renderWorker->read(frames.data(), length);
+		for (uint i = 0; i < length; i++) {
+			leftBuffer[i] = frames[int(2 * i)];
+			rightBuffer[i] = frames[int(2 * i + 1)];
+		}
+		emit audioBlockRendered();
+		return;
+	}
+	if (isRealtime()) {
+		realtimeHelper->renderRealtime(leftBuffer, rightBuffer, length);
+		return;
+	}
+	QMutexLocker synthLocker(synthMutex);
+	if (!isOpen()) {
+		synthLocker.unlock();
+
+		// Synth is closed, simply erase buffer content
+		Synth::muteSampleBuffer(leftBuffer, length);
+		Synth::muteSampleBuffer(rightBuffer, length);
+		emit audioBlockRendered();
+		return;
+	}
+	sampleRateConverter->getOutputSamples(leftBuffer, rightBuffer, length);
+	monitorStateBuffer->publish(*synth);
+	CoalescedReports reports;
+	bool reportsTaken = takeCoalescedReports(reports);
+	synthLocker.unlock();
+	if (reportsTaken) emitCoalescedReports(reports);
+	emit audioBlockRendered();
+}
+
 bool QSynth::open(uint &targetSampleRate, SamplerateConversionQuality srcQuality, const QString useSynthProfileName) {
 	if (isOpen()) return true;
 
@@ -734,7 +1131,11 @@ bool QSynth::open(uint &targetSampleRate, SamplerateConversionQuality srcQuality
 
 	forever {
 		Master::getInstance()->loadSynthProfile(synthProfile, synthProfileName);
-		if (controlROMImage == NULL || pcmROMImage == NULL) Master::getInstance()->findROMImages(synthProfile, controlROMImage, pcmROMImage);
+		// The node only changes along with the ROM images, which are shared with the synths on the same node.
+		if (controlROMImage == NULL && pcmROMImage == NULL) numaNode = Master::getInstance()->selectNUMANode();
+		if (controlROMImage == NULL || pcmROMImage == NULL) {
+			Master::getInstance()->findROMImages(synthProfile, numaNode, controlROMImage, pcmROMImage);
+		}
 		if (controlROMImage == NULL) controlROMImage = makeROMImage(synthProfile.romDir, synthProfile.controlROMFileName);
 		if (controlROMImage != NULL && pcmROMImage == NULL) pcmROMImage = makeROMImage(synthProfile.romDir, synthProfile.pcmROMFileName);
 		if (controlROMImage != NULL && pcmROMImage != NULL) break;
@@ -750,20 +1151,34 @@ bool QSynth::open(uint &targetSampleRate, SamplerateConversionQuality srcQuality
 	}
 	setRendererType(synthProfile.rendererType);
 
-	static const char *ANALOG_OUTPUT_MODES[] = {"Digital only", "Coarse", "Accurate", "Oversampled2x"};
+	static const char *ANALOG_OUTPUT_MODES[] = {"Digital only", "Coarse", "Accurate", "Oversampled2x", "Oversampled2x decimated"};
 	qDebug() << "Using Analogue output mode:" << ANALOG_OUTPUT_MODES[actualAnalogOutputMode];
-	qDebug() << "Using Renderer Type:" << (synthProfile.rendererType ? "Float 32-bit" : "Integer 16-bit");
+	static const char * const RENDERER_TYPE_NAMES[] = {"Integer 16-bit", "Float 32-bit", "Float 32-bit wavetable"};
+	qDebug() << "Using Renderer Type:" << RENDERER_TYPE_NAMES[synthProfile.rendererType];
 	qDebug() << "Using Max Partials:" << synthProfile.partialCount;
 
 	targetSampleRate = SampleRateConverter::getSupportedOutputSampleRate(targetSampleRate);
 
+	// SysEx data is always stored in a preallocated buffer, so that enqueueing bulk dumps never allocates memory.
+	synth->configureMIDIEventQueueSysexStorage(MAX_STREAM_BUFFER_SIZE);
+	synth->setMemoryLockingEnabled(Master::getInstance()->getSettings()->value("Master/lockSynthMemory", false).toBool());
+	synth->setNUMANode(numaNode);
+	if (numaNode >= 0) qDebug() << "QSynth: Placing synth on NUMA node" << numaNode;
+	QMutexLocker reverbPreparationLocker(reverbPreparationMutex);
 	if (synth->open(*controlROMImage, *pcmROMImage, Bit32u(synthProfile.partialCount), actualAnalogOutputMode)) {
+		reverbPreparationLocker.unlock();
+		// Nothing renders while the synth is closed, so it is safe to publish the initial state from this thread.
+		monitorStateBuffer->publish(*synth);
 		setState(SynthState_OPEN);
 		reportHandler.onDeviceReconfig();
 		setSynthProfile(synthProfile, synthProfileName);
 		if (engageChannel1OnOpen) resetMIDIChannelsAssignment(true);
+		RenderingThreadPool *renderingThreadPool = Master::getInstance()->getRenderingThreadPool();
+		if (renderingThreadPool != NULL) synth->setPartialRenderingExecutor(renderingThreadPool, renderingThreadPool->getTaskCount());
+		synth->setTraceSink(Master::getInstance()->getTracer());
 		if (targetSampleRate == 0) targetSampleRate = getSynthSampleRate();
 		sampleRateConverter = new SampleRateConverter(*synth, targetSampleRate, srcQuality);
+		startRenderWorker();
 		return true;
 	}
 	delete synth;
@@ -879,15 +1294,12 @@ void QSynth::setInitialMIDIChannelsAssignment(bool engageChannel1) {
 
 void QSynth::setReverbCompatibilityMode(ReverbCompatibilityMode useReverbCompatibilityMode) {
 	reverbCompatibilityMode = useReverbCompatibilityMode;
-	QMutexLocker synthLocker(synthMutex);
-	if (!isOpen()) return;
-	bool mt32CompatibleReverb;
-	if (useReverbCompatibilityMode == ReverbCompatibilityMode_DEFAULT) {
-		mt32CompatibleReverb = synth->isDefaultReverbMT32Compatible();
+	if (isRealtime()) {
+		realtimeHelper->setReverbCompatibilityMode(useReverbCompatibilityMode);
 	} else {
-		mt32CompatibleReverb = useReverbCompatibilityMode == ReverbCompatibilityMode_MT32;
+		QMutexLocker synthLocker(synthMutex);
+		if (isOpen()) applyReverbCompatibilityMode(synth, useReverbCompatibilityMode);
 	}
-	synth->setReverbCompatibilityMode(mt32CompatibleReverb);
 }
 
 void QSynth::setMIDIDelayMode(MIDIDelayMode midiDelayMode) {
@@ -927,38 +1339,31 @@ const QString QSynth::getPatchName(int partNum) const {
 }
 
 void QSynth::getPartStates(bool *partStates) const {
-	if (isRealtime()) {
-		realtimeHelper->getPartStates(partStates);
-	} else {
-		QMutexLocker synthLocker(synthMutex);
-		if (!isOpen()) return;
-		synth->getPartStates(partStates);
-	}
+	if (!isOpen()) return;
+	monitorStateBuffer->getPartStates(partStates);
 }
 
 void QSynth::getPartialStates(PartialState *partialStates) const {
-	if (isRealtime()) {
-		realtimeHelper->getPartialStates(partialStates);
-	} else {
-		QMutexLocker synthLocker(synthMutex);
-		if (!isOpen()) return;
-		synth->getPartialStates(partialStates);
-	}
+	if (!isOpen()) return;
+	monitorStateBuffer->getPartialStates(partialStates, synth->getPartialCount());
 }
 
 uint QSynth::getPlayingNotes(uint partNumber, Bit8u *keys, Bit8u *velocities) const {
-	if (isRealtime()) {
-		return realtimeHelper->getPlayingNotes(partNumber, keys, velocities);
-	} else {
-		QMutexLocker synthLocker(synthMutex);
-		return synth->getPlayingNotes(partNumber, keys, velocities);
-	}
+	if (!isOpen()) return 0;
+	return monitorStateBuffer->getPlayingNotes(partNumber, keys, velocities);
 }
 
 uint QSynth::getPartialCount() const {
 	return synth->getPartialCount();
 }
 
+// The synth profile is loaded anew, like open() does, since the analogue output mode may change until then.
+uint QSynth::getNativeSampleRate() const {
+	SynthProfile synthProfile;
+	Master::getInstance()->loadSynthProfile(synthProfile, synthProfileName);
+	return Synth::getStereoOutputSampleRate(synthProfile.analogOutputMode);
+}
+
 uint QSynth::getSynthSampleRate() const {
 	return synth->getStereoOutputSampleRate();
 }
@@ -968,6 +1373,19 @@ bool QSynth::isActive() const {
 	return isOpen() && synth->isActive();
 }
 
+bool QSynth::saveMemoryState(QByteArray &memoryState) const {
+	QMutexLocker synthLocker(synthMutex);
+	if (!isOpen()) return false;
+	memoryState.resize(int(Synth::getMemoryStateSize()));
+	return synth->saveMemoryState(reinterpret_cast<Bit8u *>(memoryState.data()));
+}
+
+bool QSynth::restoreMemoryState(const QByteArray &memoryState) const {
+	QMutexLocker synthLocker(synthMutex);
+	if (!isOpen() || memoryState.size() != int(Synth::getMemoryStateSize())) return false;
+	return synth->restoreMemoryState(reinterpret_cast<const Bit8u *>(memoryState.constData()));
+}
+
 void QSynth::reset() const {
 	if (isRealtime()) {
 		realtimeHelper->resetSynth();
@@ -982,8 +1400,16 @@ bool QSynth::isRealtime() const {
 }
 
 void QSynth::enableRealtime() {
+	// Keeping the buffers of all the reverb modes allocated avoids allocating memory in the rendering thread upon a reverb mode
+	// change. It can be turned off to save memory when running many synths, unless the reverb mode is changed during playback.
+	// Unless "Master/deferReverbPreparation" is turned off, only the buffers of the reverb modes actually used are allocated,
+	// by the realtime helper thread upon the first selection.
+	QSettings *settings = Master::getInstance()->getSettings();
+	bool preallocateReverbMemory = settings->value("Master/preallocateReverbMemory", true).toBool();
+	bool deferReverbPreparation = settings->value("Master/deferReverbPreparation", true).toBool();
 	QMutexLocker synthLocker(synthMutex);
-	synth->preallocateReverbMemory(true);
+	synth->setReverbPreparationDeferred(deferReverbPreparation);
+	synth->preallocateReverbMemory(preallocateReverbMemory);
 	synth->configureMIDIEventQueueSysexStorage(MAX_STREAM_BUFFER_SIZE);
 	if (isRealtime()) return;
 	realtimeHelper = new RealtimeHelper(*this);
@@ -991,6 +1417,25 @@ void QSynth::enableRealtime() {
 	qDebug() << "QSynth: Realtime rendering initialised";
 }
 
+// Synthesis may be offloaded from the audio driver threads to a dedicated render worker, which is enabled by setting
+// "Master/renderWorkerEnabled". The worker thread is pinned to the CPU core set as "Master/renderWorkerCPUCore", if any,
+// or else to the CPU cores of the NUMA node the synth is placed on.
+void QSynth::startRenderWorker() {
+	QSettings *settings = Master::getInstance()->getSettings();
+	if (!settings->value("Master/renderWorkerEnabled", false).toBool()) return;
+	int cpuCore = settings->value("Master/renderWorkerCPUCore", -1).toInt();
+	QList<int> cpuCores;
+	if (cpuCore >= 0) {
+		cpuCores << cpuCore;
+	} else if (numaNode >= 0) {
+		cpuCores = Master::getNUMANodeCPUCores(numaNode);
+	}
+	QMutexLocker midiLocker(midiMutex);
+	QWriteLocker renderWorkerLocker(renderWorkerLock);
+	renderWorker = new RenderWorker(*this, cpuCores);
+	qDebug() << "QSynth: Render worker started";
+}
+
 void QSynth::setState(SynthState newState) {
 	if (state == newState) return;
 	state = newState;
@@ -1002,7 +1447,13 @@ void QSynth::close() {
 	setState(SynthState_CLOSING);
 	{
 		QMutexLocker midiLocker(midiMutex);
+		{
+			QWriteLocker renderWorkerLocker(renderWorkerLock);
+			delete renderWorker;
+			renderWorker = NULL;
+		}
 		QMutexLocker synthLocker(synthMutex);
+		QMutexLocker reverbPreparationLocker(reverbPreparationMutex);
 		synth->close();
 		// This effectively resets rendered frame counter, audioStream is also going down
 		delete synth;
@@ -1078,12 +1529,17 @@ void QSynth::getROMImages(const ROMImage *&cri, const ROMImage *&pri) const {
 	pri = pcmROMImage;
 }
 
+int QSynth::getNUMANode() const {
+	return numaNode;
+}
+
 void QSynth::freeROMImages() {
 	// Ensure our ROM images get freed even if the synth is still in use
 	const ROMImage *cri = controlROMImage;
 	controlROMImage = NULL;
 	const ROMImage *pri = pcmROMImage;
 	pcmROMImage = NULL;
+	numaNode = -1;
 	Master::getInstance()->freeROMImages(cri, pri);
 }
 
@@ -1091,19 +1547,26 @@ const QReportHandler *QSynth::getReportHandler() const {
 	return &reportHandler;
 }
 
+// The recorders are started and stopped with the synth mutex released, as that waits for the file I/O.
 void QSynth::startRecordingAudio(const QString &fileName) {
 	QMutexLocker synthLocker(synthMutex);
-	if (isRecordingAudio()) delete audioRecorder;
-	audioRecorder = new AudioFileWriter(sampleRateConverter->convertSynthToOutputTimestamp(SAMPLE_RATE), fileName);
-	audioRecorder->open();
+	const uint sampleRate = sampleRateConverter->convertSynthToOutputTimestamp(SAMPLE_RATE);
+	synthLocker.unlock();
+	AudioFileRecorder *newAudioRecorder = new AudioFileRecorder(sampleRate, fileName);
+	newAudioRecorder->start();
+	synthLocker.relock();
+	AudioFileRecorder *oldAudioRecorder = audioRecorder;
+	audioRecorder = newAudioRecorder;
+	synthLocker.unlock();
+	delete oldAudioRecorder;
 }
 
 void QSynth::stopRecordingAudio() {
 	QMutexLocker synthLocker(synthMutex);
-	if (!isRecordingAudio()) return;
-	audioRecorder->close();
-	delete audioRecorder;
+	AudioFileRecorder *oldAudioRecorder = audioRecorder;
 	audioRecorder = NULL;
+	synthLocker.unlock();
+	delete oldAudioRecorder;
 }
 
 bool QSynth::isRecordingAudio() const {
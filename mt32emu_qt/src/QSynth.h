@@ -4,8 +4,11 @@
 #include <QtCore>
 #include <mt32emu/mt32emu.h>
 
-class AudioFileWriter;
+class AudioFileRecorder;
+class MonitorStateBuffer;
+class CoalescedReports;
 class RealtimeHelper;
+class RenderWorker;
 class QSynth;
 
 enum SynthState {
@@ -49,6 +52,7 @@ class QReportHandler : public QObject, public MT32Emu::ReportHandler {
 
 // For the sake of Qt4 compatibility.
 friend class RealtimeHelper;
+friend class QSynth;
 
 public:
 	QReportHandler(QSynth *qsynth);
@@ -92,18 +96,23 @@ class QSynth : public QObject {
 
 friend class QReportHandler;
 friend class RealtimeHelper;
+friend class RenderWorker;
 
 private:
 	volatile SynthState state;
 
 	QMutex * const midiMutex;
 	QMutex * const synthMutex;
+	// Guards the synth object against replacing while the reverb models are prepared in the realtime helper thread.
+	QMutex * const reverbPreparationMutex;
 
 	QDir romDir;
 	QString controlROMFileName;
 	QString pcmROMFileName;
 	const MT32Emu::ROMImage *controlROMImage;
 	const MT32Emu::ROMImage *pcmROMImage;
+	// The NUMA node the synth is placed on along with its ROM images, or -1 if the placement is disabled.
+	int numaNode;
 	int reverbMode;
 	int reverbTime;
 	int reverbLevel;
@@ -117,13 +126,20 @@ private:
 	QString synthProfileName;
 
 	MT32Emu::SampleRateConverter *sampleRateConverter;
-	AudioFileWriter *audioRecorder;
+	AudioFileRecorder *audioRecorder;
 
 	RealtimeHelper *realtimeHelper;
+	RenderWorker *renderWorker;
+	QReadWriteLock * const renderWorkerLock;
+	MonitorStateBuffer * const monitorStateBuffer;
+	CoalescedReports * const coalescedReports;
 
 	void setState(SynthState newState);
+	void startRenderWorker();
 	void freeROMImages();
 	MT32Emu::Bit32u convertOutputToSynthTimestamp(quint64 timestamp) const;
+	bool takeCoalescedReports(CoalescedReports &reports) const;
+	void emitCoalescedReports(const CoalescedReports &reports);
 
 public:
 	explicit QSynth(QObject *parent = NULL);
@@ -142,6 +158,7 @@ public:
 	bool playMIDISysex(const MT32Emu::Bit8u *sysex, MT32Emu::Bit32u sysexLen, quint64 timestamp) const;
 	void render(MT32Emu::Bit16s *buffer, uint length);
 	void render(float *buffer, uint length);
+	void render(float *leftBuffer, float *rightBuffer, uint length);
 
 	const QReportHandler *getReportHandler() const;
 
@@ -149,6 +166,7 @@ public:
 	void setSynthProfile(const SynthProfile &synthProfile, QString useSynthProfileName);
 
 	void getROMImages(const MT32Emu::ROMImage *&controlROMImage, const MT32Emu::ROMImage *&pcmROMImage) const;
+	int getNUMANode() const;
 
 	void setMasterVolume(int masterVolume);
 	void setOutputGain(float outputGain);
@@ -174,7 +192,12 @@ public:
 	uint getPlayingNotes(uint partNumber, MT32Emu::Bit8u *keys, MT32Emu::Bit8u *velocities) const;
 	uint getPartialCount() const;
 	uint getSynthSampleRate() const;
+	// Returns the sample rate the synth outputs at when it is opened with the target sample rate 0.
+	uint getNativeSampleRate() const;
 	bool isActive() const;
+	// Snapshot the emulated synth memory, so that the state set up by the SysEx messages survives reopening the synth.
+	bool saveMemoryState(QByteArray &memoryState) const;
+	bool restoreMemoryState(const QByteArray &memoryState) const;
 
 	void startRecordingAudio(const QString &fileName);
 	void stopRecordingAudio();
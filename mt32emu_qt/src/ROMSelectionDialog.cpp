@@ -16,6 +16,7 @@
 
 #include <QCheckBox>
 #include <QFileDialog>
+#include <QRunnable>
 
 #include <mt32emu/mt32emu.h>
 
@@ -27,12 +28,34 @@ using namespace MT32Emu;
 
 static const int FILENAME_COLUMN = 1;
 
+class ROMDigestTask : public QRunnable {
+private:
+	QObject &dialog;
+	const uint scanNumber;
+	const QString fileName;
+	const QString romPathName;
+
+public:
+	ROMDigestTask(QObject &useDialog, uint useScanNumber, const QString &useFileName, const QString &useROMPathName) :
+		dialog(useDialog), scanNumber(useScanNumber), fileName(useFileName), romPathName(useROMPathName)
+	{}
+
+	void run() {
+		const QString sha1Digest = Master::computeROMFileDigest(romPathName);
+		QMetaObject::invokeMethod(&dialog, "handleROMDigestComputed", Qt::QueuedConnection,
+			Q_ARG(uint, scanNumber), Q_ARG(QString, fileName), Q_ARG(QString, sha1Digest));
+	}
+};
+
 ROMSelectionDialog::ROMSelectionDialog(SynthProfile &useSynthProfile, QWidget *parent) :
 		QDialog(parent),
 		ui(new Ui::ROMSelectionDialog),
 		controlROMGroup(this),
 		pcmROMGroup(this),
-		synthProfile(useSynthProfile)
+		synthProfile(useSynthProfile),
+		controlROMRow(-1),
+		pcmROMRow(-1),
+		scanNumber(0)
 {
 	ui->setupUi(this);
 
@@ -54,6 +77,9 @@ ROMSelectionDialog::ROMSelectionDialog(SynthProfile &useSynthProfile, QWidget *p
 }
 
 ROMSelectionDialog::~ROMSelectionDialog() {
+	// The pending results are discarded along with this object once the tasks complete.
+	scanNumber++;
+	romDigestThreadPool.waitForDone();
 	delete ui;
 }
 
@@ -79,9 +105,7 @@ void ROMSelectionDialog::clearButtonGroup(QButtonGroup &group) {
 }
 
 void ROMSelectionDialog::refreshROMInfos() {
-	QString controlROMFileName = synthProfile.controlROMFileName;
-	QString pcmROMFileName = synthProfile.pcmROMFileName;
-
+	scanNumber++;
 	clearButtonGroup(controlROMGroup);
 	clearButtonGroup(pcmROMGroup);
 	controlROMRow = -1;
@@ -90,84 +114,98 @@ void ROMSelectionDialog::refreshROMInfos() {
 	QStringList fileFilter = ui->fileFilterCombo->itemData(ui->fileFilterCombo->currentIndex()).value<QStringList>();
 	QStringList dirEntries = synthProfile.romDir.entryList(fileFilter);
 	ui->romInfoTable->clearContents();
-	ui->romInfoTable->setRowCount(dirEntries.size());
+	ui->romInfoTable->setRowCount(0);
 
 	const ROMInfo * const * const fullROMInfos = ROMInfo::getFullROMInfos();
+	Master *master = Master::getInstance();
 
-	int row = 0;
+	// The files identified before are listed right away, the rest is added as soon as their digests are computed.
 	for (QStringListIterator it(dirEntries); it.hasNext();) {
 		QString fileName = it.next();
-		FileStream file;
-		if (!file.open(Master::getROMPathName(synthProfile.romDir, fileName).toLocal8Bit())) continue;
-		const ROMInfo *romInfoPtr = ROMInfo::getROMInfo(&file, fullROMInfos);
-		if (romInfoPtr == NULL) continue;
-		const ROMInfo &romInfo = *romInfoPtr;
-
-		QButtonGroup *romGroup;
-		QString romType;
-		switch (romInfo.type) {
-			case ROMInfo::PCM:
-				romType = QString("PCM");
-				romGroup = &pcmROMGroup;
-				if (pcmROMRow == -1) pcmROMRow = row;
-				break;
-			case ROMInfo::Control:
-				romType = QString("Control");
-				romGroup = &controlROMGroup;
-				if (controlROMRow == -1) controlROMRow = row;
-				break;
-			case ROMInfo::Reverb:
-				romType = QString("Reverb");
-				romGroup = NULL;
-				break;
-			default:
-				MT32Emu::ROMInfo::freeROMInfo(romInfoPtr);
-				continue;
+		QString romPathName = Master::getROMPathName(synthProfile.romDir, fileName);
+		const ROMInfo *romInfo;
+		if (!master->findCachedROMInfo(romPathName, fullROMInfos, romInfo)) {
+			romDigestThreadPool.start(new ROMDigestTask(*this, scanNumber, fileName, romPathName));
+			continue;
 		}
+		if (romInfo == NULL) continue;
+		addROMInfoRow(fileName, *romInfo);
+		ROMInfo::freeROMInfo(romInfo);
+	}
+	ui->romInfoTable->resizeColumnsToContents();
+}
 
-		if (fileName == controlROMFileName) {
-			controlROMRow = row;
-		} else if (fileName == pcmROMFileName) {
-			pcmROMRow = row;
-		}
+void ROMSelectionDialog::handleROMDigestComputed(uint digestScanNumber, const QString &fileName, const QString &sha1Digest) {
+	if (digestScanNumber != scanNumber || sha1Digest.isEmpty()) return;
+	QString romPathName = Master::getROMPathName(synthProfile.romDir, fileName);
+	const ROMInfo *romInfo = Master::getInstance()->identifyROMDigest(romPathName, sha1Digest, ROMInfo::getFullROMInfos());
+	if (romInfo == NULL) return;
+	addROMInfoRow(fileName, *romInfo);
+	ROMInfo::freeROMInfo(romInfo);
+	ui->romInfoTable->resizeColumnsToContents();
+}
 
-		int column = 0;
-		QCheckBox *checkBox = new QCheckBox();
-		if (romInfo.type != ROMInfo::Reverb) {
-			romGroup->addButton(checkBox);
-			romGroup->setId(checkBox, row);
-		} else checkBox->setDisabled(true);
-		ui->romInfoTable->setCellWidget(row, column++, checkBox);
+void ROMSelectionDialog::addROMInfoRow(const QString &fileName, const ROMInfo &romInfo) {
+	QButtonGroup *romGroup;
+	QString romType;
+	int *romRow = NULL;
+	bool profileROM = false;
+	switch (romInfo.type) {
+		case ROMInfo::PCM:
+			romType = QString("PCM");
+			romGroup = &pcmROMGroup;
+			romRow = &pcmROMRow;
+			profileROM = fileName == synthProfile.pcmROMFileName;
+			break;
+		case ROMInfo::Control:
+			romType = QString("Control");
+			romGroup = &controlROMGroup;
+			romRow = &controlROMRow;
+			profileROM = fileName == synthProfile.controlROMFileName;
+			break;
+		case ROMInfo::Reverb:
+			romType = QString("Reverb");
+			romGroup = NULL;
+			break;
+		default:
+			return;
+	}
 
-		if (controlROMRow == row || pcmROMRow == row) {
+	int row = ui->romInfoTable->rowCount();
+	ui->romInfoTable->setRowCount(row + 1);
+
+	int column = 0;
+	QCheckBox *checkBox = new QCheckBox();
+	if (romInfo.type != ROMInfo::Reverb) {
+		romGroup->addButton(checkBox);
+		romGroup->setId(checkBox, row);
+		// The first ROM of each type is selected unless the one set in the profile turns up.
+		if (*romRow == -1 || profileROM) {
+			*romRow = row;
 			checkBox->setChecked(true);
 		}
+	} else checkBox->setDisabled(true);
+	ui->romInfoTable->setCellWidget(row, column++, checkBox);
 
-		QTableWidgetItem *item = new QTableWidgetItem(fileName);
-		item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-		ui->romInfoTable->setItem(row, column++, item);
+	QTableWidgetItem *item = new QTableWidgetItem(fileName);
+	item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+	ui->romInfoTable->setItem(row, column++, item);
 
-		item = new QTableWidgetItem(QString(romInfo.shortName));
-		item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-		ui->romInfoTable->setItem(row, column++, item);
+	item = new QTableWidgetItem(QString(romInfo.shortName));
+	item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+	ui->romInfoTable->setItem(row, column++, item);
 
-		item = new QTableWidgetItem(QString(romInfo.description));
-		item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-		ui->romInfoTable->setItem(row, column++, item);
+	item = new QTableWidgetItem(QString(romInfo.description));
+	item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+	ui->romInfoTable->setItem(row, column++, item);
 
-		item = new QTableWidgetItem(romType);
-		item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-		ui->romInfoTable->setItem(row, column++, item);
+	item = new QTableWidgetItem(romType);
+	item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+	ui->romInfoTable->setItem(row, column++, item);
 
-		item = new QTableWidgetItem(QString(romInfo.sha1Digest));
-		item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-		ui->romInfoTable->setItem(row, column++, item);
-
-		MT32Emu::ROMInfo::freeROMInfo(romInfoPtr);
-		row++;
-	}
-	ui->romInfoTable->setRowCount(row);
-	ui->romInfoTable->resizeColumnsToContents();
+	item = new QTableWidgetItem(QString(romInfo.sha1Digest));
+	item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+	ui->romInfoTable->setItem(row, column++, item);
 }
 
 void ROMSelectionDialog::on_romDirButton_clicked() {
@@ -4,6 +4,9 @@
 #include <QDialog>
 #include <QButtonGroup>
 #include <QDir>
+#include <QThreadPool>
+
+#include <mt32emu/mt32emu.h>
 
 namespace Ui {
 	class ROMSelectionDialog;
@@ -29,11 +32,18 @@ private:
 	int controlROMRow;
 	int pcmROMRow;
 
+	// Computes the digests of the ROM files unknown to the cache, so that the dialog fills in as they complete.
+	QThreadPool romDigestThreadPool;
+	// Identifies the latest scan, the digests computed for the previous ones are discarded.
+	uint scanNumber;
+
 	const QString fileFilterToString(const QStringList fileFilter) const;
 	void clearButtonGroup(QButtonGroup &group);
 	void refreshROMInfos();
+	void addROMInfoRow(const QString &fileName, const MT32Emu::ROMInfo &romInfo);
 
 private slots:
+	void handleROMDigestComputed(uint digestScanNumber, const QString &fileName, const QString &sha1Digest);
 	void on_romDirButton_clicked();
 	void on_refreshButton_clicked();
 	void on_fileFilterCombo_currentIndexChanged(int);
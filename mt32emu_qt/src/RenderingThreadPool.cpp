@@ -0,0 +1,183 @@
+/* Copyright (C) 2011-2021 Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtGlobal>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#elif defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "RenderingThreadPool.h"
+#include "Master.h"
+
+using namespace MT32Emu;
+
+class RenderingThreadPool::WorkerThread : public QThread {
+public:
+	WorkerThread(RenderingThreadPool &usePool, int useNUMANode) :
+		pool(usePool), numaNode(useNUMANode), cpuCores(useNUMANode < 0 ? QList<int>() : Master::getNUMANodeCPUCores(useNUMANode))
+	{}
+
+protected:
+	void run() {
+		if (!cpuCores.isEmpty() && !pinToCPUCores()) {
+			qDebug() << "RenderingThreadPool: Failed to pin worker to CPU cores" << cpuCores;
+		}
+		pool.runWorker(numaNode);
+	}
+
+private:
+	RenderingThreadPool &pool;
+	const int numaNode;
+	const QList<int> cpuCores;
+
+	bool pinToCPUCores() const {
+#if defined(Q_OS_WIN)
+		DWORD_PTR affinityMask = 0;
+		foreach (int cpuCore, cpuCores) {
+			if (cpuCore < int(8 * sizeof(DWORD_PTR))) affinityMask |= DWORD_PTR(1) << cpuCore;
+		}
+		return affinityMask != 0 && SetThreadAffinityMask(GetCurrentThread(), affinityMask) != 0;
+#elif defined(Q_OS_LINUX)
+		cpu_set_t cpuSet;
+		CPU_ZERO(&cpuSet);
+		foreach (int cpuCore, cpuCores) {
+			if (cpuCore < CPU_SETSIZE) CPU_SET(cpuCore, &cpuSet);
+		}
+		return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+		return false;
+#endif
+	}
+};
+
+// Lives on the stack of the thread that submitted it. All the fields except the constant ones are guarded by the mutex.
+struct RenderingThreadPool::Job {
+	Task &task;
+	const Bit32u taskCount;
+	// The node all the tasks are placed on, or -1 if they may run on any worker.
+	const int numaNode;
+	Bit32u nextTaskIx;
+	Bit32u pendingTaskCount;
+
+	Job(Task &useTask, Bit32u useTaskCount, int useNUMANode) :
+		task(useTask), taskCount(useTaskCount), numaNode(useNUMANode), nextTaskIx(0), pendingTaskCount(useTaskCount)
+	{}
+};
+
+RenderingThreadPool::RenderingThreadPool(uint workerCount, const QList<int> &numaNodes) : stopProcessing(false) {
+	if (workerCount == 0) {
+		int idealThreadCount = QThread::idealThreadCount();
+		workerCount = idealThreadCount > 1 ? uint(idealThreadCount - 1) : 1;
+	}
+	for (uint i = 0; i < workerCount; i++) {
+		WorkerThread *worker = new WorkerThread(*this, numaNodes.isEmpty() ? -1 : numaNodes.at(int(i % uint(numaNodes.size()))));
+		workers.append(worker);
+		worker->start(QThread::TimeCriticalPriority);
+	}
+	if (numaNodes.isEmpty()) {
+		qDebug() << "RenderingThreadPool: Started" << workerCount << "worker threads";
+	} else {
+		qDebug() << "RenderingThreadPool: Started" << workerCount << "worker threads on NUMA nodes" << numaNodes;
+	}
+}
+
+RenderingThreadPool::~RenderingThreadPool() {
+	{
+		QMutexLocker locker(&mutex);
+		stopProcessing = true;
+		jobSubmitted.wakeAll();
+	}
+	QMutableListIterator<WorkerThread *> workerIt(workers);
+	while (workerIt.hasNext()) {
+		WorkerThread *worker = workerIt.next();
+		worker->wait();
+		delete worker;
+		workerIt.remove();
+	}
+}
+
+uint RenderingThreadPool::getTaskCount() const {
+	return uint(workers.size()) + 1;
+}
+
+void RenderingThreadPool::execute(Task &task, Bit32u taskCount) {
+	if (taskCount < 2) {
+		if (taskCount > 0) task.run(0);
+		return;
+	}
+	Job job(task, taskCount, -1);
+	submit(job);
+}
+
+void RenderingThreadPool::executeOnNodes(Task &task, Bit32u taskCount, const Bit32s *taskNodes) {
+	if (taskCount < 2) {
+		if (taskCount > 0) task.run(0);
+		return;
+	}
+	int numaNode = taskNodes[0];
+	for (Bit32u i = 1; i < taskCount; i++) {
+		if (taskNodes[i] != numaNode) numaNode = -1;
+	}
+	Job job(task, taskCount, numaNode < 0 ? -1 : numaNode);
+	submit(job);
+}
+
+void RenderingThreadPool::submit(Job &job) {
+	QMutexLocker locker(&mutex);
+	pendingJobs.append(&job);
+	// The workers of the other nodes would leave a placed job pending, so all are woken to reach the right ones.
+	if (job.numaNode >= 0 || job.taskCount > Bit32u(workers.size())) {
+		jobSubmitted.wakeAll();
+	} else {
+		for (Bit32u i = 1; i < job.taskCount; i++) jobSubmitted.wakeOne();
+	}
+	// The submitting thread only takes over the tasks of its own job, so that it is never delayed by the other synths.
+	while (job.nextTaskIx < job.taskCount) runNextTask(job, locker);
+	while (job.pendingTaskCount > 0) jobCompleted.wait(&mutex);
+}
+
+// The worker of a node only picks up the jobs placed on that node or not placed at all.
+void RenderingThreadPool::runWorker(int numaNode) {
+	QMutexLocker locker(&mutex);
+	while (!stopProcessing) {
+		Job *job = NULL;
+		foreach (Job *pendingJob, pendingJobs) {
+			if (pendingJob->numaNode < 0 || numaNode < 0 || pendingJob->numaNode == numaNode) {
+				job = pendingJob;
+				break;
+			}
+		}
+		if (job == NULL) {
+			jobSubmitted.wait(&mutex);
+		} else {
+			runNextTask(*job, locker);
+		}
+	}
+}
+
+// Must be invoked with the mutex locked, which is released while the task is running.
+void RenderingThreadPool::runNextTask(Job &job, QMutexLocker &locker) {
+	Bit32u taskIx = job.nextTaskIx++;
+	if (job.nextTaskIx == job.taskCount) pendingJobs.removeOne(&job);
+	locker.unlock();
+	job.task.run(taskIx);
+	locker.relock();
+	if (--job.pendingTaskCount == 0) jobCompleted.wakeAll();
+}
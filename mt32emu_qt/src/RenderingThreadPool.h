@@ -0,0 +1,43 @@
+#ifndef RENDERING_THREAD_POOL_H
+#define RENDERING_THREAD_POOL_H
+
+#include <QtCore>
+#include <mt32emu/mt32emu.h>
+
+// Executes the partial rendering tasks of all the synths using a single pool of worker threads shared among them.
+// The rendering thread that requests execution also runs the tasks of its own job, so that the synths never wait
+// for a worker to wake up unless there are spare workers available. Idle workers pick up tasks of whichever job
+// is pending, in the order the jobs were submitted, so that the load spreads evenly across all the active synths.
+// When NUMA nodes are given, the workers are spread evenly across them and pinned to the CPU cores of their nodes
+// on Linux and Windows. The jobs whose tasks are all placed on one node are then only picked up by the workers
+// of that node, so that the synths render from local memory, while the other jobs are picked up by any worker.
+class RenderingThreadPool : public MT32Emu::RenderingTaskExecutor {
+public:
+	// Creates a pool with the specified number of worker threads or with as many workers as there are CPU cores
+	// beyond the first one, if workerCount is 0.
+	explicit RenderingThreadPool(uint workerCount = 0, const QList<int> &numaNodes = QList<int>());
+	~RenderingThreadPool();
+
+	// Returns the number of tasks each synth is suggested to split the partial rendering into.
+	uint getTaskCount() const;
+
+	void execute(Task &task, MT32Emu::Bit32u taskCount);
+	void executeOnNodes(Task &task, MT32Emu::Bit32u taskCount, const MT32Emu::Bit32s *taskNodes);
+
+private:
+	class WorkerThread;
+	struct Job;
+
+	QMutex mutex;
+	QWaitCondition jobSubmitted;
+	QWaitCondition jobCompleted;
+	QList<Job *> pendingJobs;
+	QList<WorkerThread *> workers;
+	bool stopProcessing;
+
+	void submit(Job &job);
+	void runWorker(int numaNode);
+	void runNextTask(Job &job, QMutexLocker &locker);
+};
+
+#endif
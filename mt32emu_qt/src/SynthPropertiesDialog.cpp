@@ -20,6 +20,9 @@
 #include "SynthPropertiesDialog.h"
 #include "ROMSelectionDialog.h"
 #include "ui_SynthPropertiesDialog.h"
+#include "audiodrv/AudioDriver.h"
+
+static const int RENDER_TIMING_REFRESH_INTERVAL_MILLIS = 1000;
 
 SynthPropertiesDialog::SynthPropertiesDialog(QWidget *parent, SynthRoute *useSynthRoute) :
 	QDialog(parent),
@@ -39,6 +42,9 @@ SynthPropertiesDialog::SynthPropertiesDialog(QWidget *parent, SynthRoute *useSyn
 	synthRoute->connectReportHandler(SIGNAL(reverbModeChanged(int)), this, SLOT(handleReverbModeChanged(int)));
 	synthRoute->connectReportHandler(SIGNAL(reverbTimeChanged(int)), this, SLOT(handleReverbTimeChanged(int)));
 	synthRoute->connectReportHandler(SIGNAL(reverbLevelChanged(int)), this, SLOT(handleReverbLevelChanged(int)));
+
+	renderTimingToolTip = ui->renderTimingLabel->toolTip();
+	connect(&renderTimingRefreshTimer, SIGNAL(timeout()), SLOT(refreshRenderTimingStats()));
 }
 
 SynthPropertiesDialog::~SynthPropertiesDialog() {
@@ -47,6 +53,29 @@ SynthPropertiesDialog::~SynthPropertiesDialog() {
 
 void SynthPropertiesDialog::showEvent(QShowEvent *) {
 	loadSynthProfile();
+	refreshRenderTimingStats();
+	renderTimingRefreshTimer.start(RENDER_TIMING_REFRESH_INTERVAL_MILLIS);
+}
+
+void SynthPropertiesDialog::hideEvent(QHideEvent *) {
+	renderTimingRefreshTimer.stop();
+}
+
+void SynthPropertiesDialog::refreshRenderTimingStats() {
+	RenderTimingStats stats;
+	if (!synthRoute->getRenderTimingStats(stats)) {
+		ui->renderTimingLabel->setText("No active audio stream");
+		ui->renderTimingLabel->setToolTip(renderTimingToolTip);
+		return;
+	}
+	ui->renderTimingLabel->setText(QString("Missed %1 of %2, underruns: %3, max. load: %4%")
+		.arg(stats.deadlineMissCount).arg(stats.renderCount).arg(stats.underrunCount).arg(stats.maxLoadPercent));
+	QString toolTip = renderTimingToolTip + "\n\nRendering passes by load:";
+	for (uint i = 0; i < RenderTimingStats::LOAD_HISTOGRAM_BUCKET_COUNT - 1; i++) {
+		toolTip += QString("\n%1-%2%: %3").arg(10 * i).arg(10 * (i + 1)).arg(stats.loadHistogram[i]);
+	}
+	toolTip += QString("\nMissed deadline: %1").arg(stats.loadHistogram[RenderTimingStats::LOAD_HISTOGRAM_BUCKET_COUNT - 1]);
+	ui->renderTimingLabel->setToolTip(toolTip);
 }
 
 void SynthPropertiesDialog::on_changeROMSetButton_clicked() {
@@ -298,14 +327,12 @@ void SynthPropertiesDialog::refreshProfileCombo(QString name) {
 }
 
 QString SynthPropertiesDialog::getROMSetDescription() {
-	MT32Emu::FileStream file;
-	if (file.open(Master::getROMPathName(synthProfile.romDir, synthProfile.controlROMFileName).toLocal8Bit())) {
-		const MT32Emu::ROMInfo *romInfo = MT32Emu::ROMInfo::getROMInfo(&file);
-		if (romInfo != NULL) {
-			QString des = romInfo->description;
-			MT32Emu::ROMInfo::freeROMInfo(romInfo);
-			return des;
-		}
+	const QString pathName = Master::getROMPathName(synthProfile.romDir, synthProfile.controlROMFileName);
+	const MT32Emu::ROMInfo *romInfo = Master::getInstance()->identifyROMFile(pathName, MT32Emu::ROMInfo::getFullROMInfos());
+	if (romInfo != NULL) {
+		QString des = romInfo->description;
+		MT32Emu::ROMInfo::freeROMInfo(romInfo);
+		return des;
 	}
 	return "Unknown";
 }
@@ -2,6 +2,7 @@
 #define SYNTHPROPERTIESDIALOG_H
 
 #include <QDialog>
+#include <QTimer>
 
 #include "SynthRoute.h"
 #include "ROMSelectionDialog.h"
@@ -19,12 +20,15 @@ public:
 
 protected:
 	void showEvent(QShowEvent *showEvent);
+	void hideEvent(QHideEvent *hideEvent);
 
 private:
 	Ui::SynthPropertiesDialog *ui;
 	SynthRoute *synthRoute;
 	SynthProfile synthProfile;
 	ROMSelectionDialog rsd;
+	QTimer renderTimingRefreshTimer;
+	QString renderTimingToolTip;
 	void resetSynth();
 	void restoreDefaults();
 	void loadSynthProfile(bool reloadFromSynthRoute = true);
@@ -56,6 +60,7 @@ private slots:
 	void handleReverbModeChanged(int mode);
 	void handleReverbTimeChanged(int time);
 	void handleReverbLevelChanged(int level);
+	void refreshRenderTimingStats();
 };
 
 #endif // SYNTHPROPERTIESDIALOG_H
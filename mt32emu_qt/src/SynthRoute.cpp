@@ -20,6 +20,7 @@
  *  - Initial setup
  *  - Sample rate changes
  *  - Pausing/unpausing when the QSynth becomes unavailable (NYI)
+ *  - Suspending the idle synth and resuming it upon MIDI activity (optional)
  * - Maintaining a list of MIDI sessions for the synth
  * - Merging MIDI streams coming from several MIDI sessions
  */
@@ -27,13 +28,52 @@
 #include <limits>
 
 #include "SynthRoute.h"
+#include "Master.h"
 #include "MidiSession.h"
 #include "QMidiBuffer.h"
 #include "RealtimeReadLocker.h"
+#include "Tracer.h"
 #include "audiodrv/AudioDriver.h"
 
 using namespace MT32Emu;
 
+// The MIDI buffers with events pending within a rendering pass, kept in a binary min-heap ordered by the timestamp
+// of the next event to deliver.
+struct MidiBufferHeapEntry {
+	QMidiBuffer *midiBuffer;
+	quint64 eventTimestamp;
+};
+
+typedef QVarLengthArray<MidiBufferHeapEntry, 16> MidiBufferHeap;
+
+// Limits the MIDI events held while the route is reopening, should a flood arrive or the reopening fail.
+static const int MAX_PENDING_MIDI_EVENTS = 65536;
+
+// Returns 0 unless the idle routes are to be suspended.
+static uint getIdleSuspendTimeoutSeconds() {
+	return Master::getInstance()->getSettings()->value("Master/idleSynthRouteSuspendTimeout", 0).toUInt();
+}
+
+static void siftUpMidiBuffer(MidiBufferHeap &heap, int ix) {
+	while (ix > 0) {
+		const int parentIx = (ix - 1) >> 1;
+		if (heap[parentIx].eventTimestamp <= heap[ix].eventTimestamp) break;
+		qSwap(heap[parentIx], heap[ix]);
+		ix = parentIx;
+	}
+}
+
+static void siftDownMidiBuffer(MidiBufferHeap &heap, int ix) {
+	for (;;) {
+		int childIx = (ix << 1) + 1;
+		if (heap.size() <= childIx) break;
+		if (childIx + 1 < heap.size() && heap[childIx + 1].eventTimestamp < heap[childIx].eventTimestamp) childIx++;
+		if (heap[ix].eventTimestamp <= heap[childIx].eventTimestamp) break;
+		qSwap(heap[ix], heap[childIx]);
+		ix = childIx;
+	}
+}
+
 SynthRoute::SynthRoute(QObject *parent) :
 	QObject(parent),
 	state(SynthRouteState_CLOSED),
@@ -42,9 +82,13 @@ SynthRoute::SynthRoute(QObject *parent) :
 	multiMidiMode(),
 	audioDevice(NULL),
 	audioStream(NULL),
+	suspended(),
+	midiActivity(),
+	resumeRequested(),
 	debugLastEventTimestamp(0)
 {
 	connect(&qSynth, SIGNAL(stateChanged(SynthState)), SLOT(handleQSynthState(SynthState)));
+	connect(&idleTimer, SIGNAL(timeout()), SLOT(handleIdleTimeout()));
 }
 
 SynthRoute::~SynthRoute() {
@@ -77,6 +121,17 @@ bool SynthRoute::open(AudioStreamFactory audioStreamFactory) {
 	setState(SynthRouteState_OPENING);
 	if (audioDevice != NULL) {
 		uint sampleRate = audioDevice->driver.getAudioSettings().sampleRate;
+		if (sampleRate == 0) {
+			// The synth output goes at its native rate by default. Unless the device supports that rate natively,
+			// the closest rate it does is used instead, so that the conversion is done by the sample rate converter
+			// at the configured quality rather than by the audio system.
+			const uint nativeSampleRate = qSynth.getNativeSampleRate();
+			const uint deviceSampleRate = audioDevice->negotiateSampleRate(nativeSampleRate);
+			if (deviceSampleRate != 0 && deviceSampleRate != nativeSampleRate) {
+				qDebug() << "Native sample rate" << nativeSampleRate << "not supported by the audio device, using:" << deviceSampleRate;
+				sampleRate = deviceSampleRate;
+			}
+		}
 		if (qSynth.open(sampleRate, audioDevice->driver.getAudioSettings().srcQuality)) {
 			double debugDeltaMean = sampleRate * (8.0 / MasterClock::MILLIS_PER_SECOND);
 			double debugDeltaLimit = debugDeltaMean * 0.01;
@@ -86,11 +141,17 @@ bool SynthRoute::open(AudioStreamFactory audioStreamFactory) {
 
 			AudioStream *newAudioStream = exclusiveMidiMode && audioStreamFactory != NULL
 				? audioStreamFactory(audioDevice, *this, sampleRate, midiSessions.first())
-				: audioDevice->startAudioStream(*this, sampleRate);
+				: startAudioStream(sampleRate);
 			if (newAudioStream != NULL) {
+				{
+					QWriteLocker audioStreamLocker(&audioStreamLock);
+					audioStream = newAudioStream;
+				}
 				setState(SynthRouteState_OPEN);
-				QWriteLocker audioStreamLocker(&audioStreamLock);
-				audioStream = newAudioStream;
+				if (suspended) finishResume(true);
+				const uint idleTimeoutSeconds = getIdleSuspendTimeoutSeconds();
+				// The idle time is checked once per timeout period, so the route remains open for up to twice as long.
+				if (idleTimeoutSeconds > 0 && !exclusiveMidiMode) idleTimer.start(idleTimeoutSeconds * MasterClock::MILLIS_PER_SECOND);
 				return true;
 			} else {
 				qDebug() << "Failed to start audioStream";
@@ -102,11 +163,18 @@ bool SynthRoute::open(AudioStreamFactory audioStreamFactory) {
 	} else {
 		qDebug() << "No audioDevice set";
 	}
+	if (suspended) finishResume(false);
 	setState(SynthRouteState_CLOSED);
 	return false;
 }
 
 bool SynthRoute::close() {
+	cancelSuspension();
+	return closeSynth();
+}
+
+bool SynthRoute::closeSynth() {
+	idleTimer.stop();
 	switch (state) {
 	case SynthRouteState_CLOSING:
 	case SynthRouteState_CLOSED:
@@ -124,6 +192,96 @@ bool SynthRoute::close() {
 	return true;
 }
 
+bool SynthRoute::suspend() {
+	if (state != SynthRouteState_OPEN || exclusiveMidiMode) return false;
+	qDebug() << "SynthRoute: Suspending idle synth";
+	qSynth.saveMemoryState(suspendedMemoryState);
+	// Raised in advance, so that the state reported as closed is shown as suspended, and the MIDI events that arrive
+	// while closing are held.
+	suspended = true;
+	return closeSynth();
+}
+
+bool SynthRoute::suspendUntilMIDIActivity() {
+	if (getIdleSuspendTimeoutSeconds() == 0 || state != SynthRouteState_CLOSED) return false;
+	qDebug() << "SynthRoute: Deferring opening synth until MIDI activity";
+	suspended = true;
+	emit stateChanged(state);
+	return true;
+}
+
+bool SynthRoute::isSuspended() const {
+	return suspended;
+}
+
+void SynthRoute::handleIdleTimeout() {
+	if (midiActivity || qSynth.isActive() || isRecordingAudio() || isRecordingMidi()) {
+		midiActivity = false;
+		return;
+	}
+	suspend();
+}
+
+void SynthRoute::resume() {
+	if (suspended) open();
+}
+
+void SynthRoute::requestResume() {
+	QMutexLocker pendingMidiEventsLocker(&pendingMidiEventsMutex);
+	if (suspended) requestResumeLocked();
+}
+
+// Must be invoked with pendingMidiEventsMutex locked.
+void SynthRoute::requestResumeLocked() {
+	if (resumeRequested) return;
+	resumeRequested = true;
+	QMetaObject::invokeMethod(this, "resume", Qt::QueuedConnection);
+}
+
+// Returns false if the route is no longer suspended, then the message goes the usual way.
+bool SynthRoute::holdPendingShortMessage(Bit32u msg) {
+	QMutexLocker pendingMidiEventsLocker(&pendingMidiEventsMutex);
+	if (!suspended) return false;
+	if (pendingMidiEvents.count() < MAX_PENDING_MIDI_EVENTS) pendingMidiEvents.newMidiEvent().assignShortMessage(0, msg);
+	requestResumeLocked();
+	return true;
+}
+
+bool SynthRoute::holdPendingSysex(const Bit8u *sysex, Bit32u sysexLen) {
+	QMutexLocker pendingMidiEventsLocker(&pendingMidiEventsMutex);
+	if (!suspended) return false;
+	if (pendingMidiEvents.count() < MAX_PENDING_MIDI_EVENTS) pendingMidiEvents.newSysexEvent(0, sysex, sysexLen);
+	requestResumeLocked();
+	return true;
+}
+
+// The memory state is restored before the held events are played, and the route only leaves the suspended state
+// once they are, so that the events arriving meanwhile don't overtake them.
+void SynthRoute::finishResume(bool opened) {
+	if (opened) {
+		qDebug() << "SynthRoute: Resumed synth";
+		if (!suspendedMemoryState.isEmpty()) qSynth.restoreMemoryState(suspendedMemoryState);
+		QMutexLocker pendingMidiEventsLocker(&pendingMidiEventsMutex);
+		for (int i = 0; i < pendingMidiEvents.count(); i++) {
+			const QMidiEvent &e = pendingMidiEvents.at(i);
+			if (e.getType() == SYSEX) {
+				qSynth.playMIDISysexNow(pendingMidiEvents.getSysexData(e), pendingMidiEvents.getSysexLen(e));
+			} else {
+				qSynth.playMIDIShortMessageNow(e.getShortMessage());
+			}
+		}
+	}
+	cancelSuspension();
+}
+
+void SynthRoute::cancelSuspension() {
+	QMutexLocker pendingMidiEventsLocker(&pendingMidiEventsMutex);
+	suspended = false;
+	resumeRequested = false;
+	pendingMidiEvents.clear();
+	suspendedMemoryState.clear();
+}
+
 bool SynthRoute::enableExclusiveMidiMode(MidiSession *midiSession) {
 	if (exclusiveMidiMode || hasMIDISessions()) return false;
 	addMidiSession(midiSession);
@@ -158,7 +316,8 @@ SynthRouteState SynthRoute::getState() const {
 
 void SynthRoute::addMidiSession(MidiSession *midiSession) {
 	if (exclusiveMidiMode) return;
-	if (hasMIDISessions() && !multiMidiMode) enableMultiMidiMode();
+	// In the realtime mode, the MIDI sessions must not contend with the rendering thread, even a single one.
+	if ((hasMIDISessions() || qSynth.isRealtime()) && !multiMidiMode) enableMultiMidiMode();
 	QMutexLocker midiSessionsLocker(&midiSessionsMutex);
 	midiSessions.append(midiSession);
 	if (midiRecorder.isRecording()) midiSession->setMidiTrackRecorder(midiRecorder.addTrack());
@@ -169,7 +328,7 @@ void SynthRoute::removeMidiSession(MidiSession *midiSession) {
 	QMutexLocker midiSessionsLocker(&midiSessionsMutex);
 	midiSessions.removeOne(midiSession);
 	emit midiSessionRemoved(midiSession);
-	if (!hasMIDISessions() && multiMidiMode) {
+	if (!hasMIDISessions() && multiMidiMode && !qSynth.isRealtime()) {
 		multiMidiMode = false;
 		qDebug() << "SynthRoute: stopped merging MIDI stream buffers";
 	}
@@ -217,7 +376,10 @@ bool SynthRoute::connectReportHandler(const char *signal, const QObject *receive
 }
 
 bool SynthRoute::pushMIDIShortMessage(MidiSession &midiSession, Bit32u msg, MasterClockNanos refNanos) {
+	TraceScope traceScope("SynthRoute::pushMIDIShortMessage", msg);
 	if (midiRecorder.isRecording()) midiSession.getMidiTrackRecorder()->recordShortMessage(msg, refNanos);
+	midiActivity = true;
+	if (suspended && msg != 0 && holdPendingShortMessage(msg)) return true;
 	quint64 timestamp;
 	{
 		RealtimeReadLocker audioStreamLocker(audioStreamLock);
@@ -238,7 +400,10 @@ bool SynthRoute::pushMIDIShortMessage(MidiSession &midiSession, Bit32u msg, Mast
 }
 
 bool SynthRoute::pushMIDISysex(MidiSession &midiSession, const Bit8u *sysexData, unsigned int sysexLen, MasterClockNanos refNanos) {
+	TraceScope traceScope("SynthRoute::pushMIDISysex", sysexLen);
 	if (midiRecorder.isRecording()) midiSession.getMidiTrackRecorder()->recordSysex(sysexData, sysexLen, refNanos);
+	midiActivity = true;
+	if (suspended && holdPendingSysex(sysexData, sysexLen)) return true;
 	quint64 timestamp;
 	{
 		RealtimeReadLocker audioStreamLocker(audioStreamLock);
@@ -248,6 +413,49 @@ bool SynthRoute::pushMIDISysex(MidiSession &midiSession, const Bit8u *sysexData,
 	return playMIDISysex(midiSession, sysexData, sysexLen, timestamp);
 }
 
+// Returns the time MIDI events should be pushed at according to the audio stream, see AudioStream::getMIDIClockNanos().
+MasterClockNanos SynthRoute::getMIDIClockNanos() {
+	RealtimeReadLocker audioStreamLocker(audioStreamLock);
+	if (!audioStreamLocker.isLocked() || audioStream == NULL) return MasterClock::getClockNanos();
+	return audioStream->getMIDIClockNanos();
+}
+
+bool SynthRoute::reportMIDIProgress(MasterClockNanos midiNanos) {
+	RealtimeReadLocker audioStreamLocker(audioStreamLock);
+	if (!audioStreamLocker.isLocked() || audioStream == NULL) return false;
+	return audioStream->reportMIDIProgress(midiNanos);
+}
+
+// Returns false if there is no active audio stream.
+bool SynthRoute::getRenderTimingStats(RenderTimingStats &stats) {
+	QReadLocker audioStreamLocker(&audioStreamLock);
+	if (audioStream == NULL) return false;
+	audioStream->getRenderTimingStats(stats);
+	return true;
+}
+
+bool SynthRoute::setOnsetDetectionEnabled(bool enabled) {
+	QReadLocker audioStreamLocker(&audioStreamLock);
+	if (audioStream == NULL) return false;
+	audioStream->setOnsetDetectionEnabled(enabled);
+	return true;
+}
+
+MasterClockNanos SynthRoute::getLastOutputOnsetNanos() {
+	QReadLocker audioStreamLocker(&audioStreamLock);
+	if (audioStream == NULL) return 0;
+	return audioStream->getLastOnsetNanos();
+}
+
+QString SynthRoute::getAudioOutputDescription() {
+	QReadLocker audioStreamLocker(&audioStreamLock);
+	if (audioStream == NULL || audioDevice == NULL) return QString();
+	const AudioDriverSettings &settings = audioStream->getSettings();
+	return QString("%1 / %2, sample rate %3 Hz, chunk %4 ms, audio latency %5 ms, MIDI latency %6%7")
+		.arg(audioDevice->driver.name, audioDevice->name).arg(audioStream->getSampleRate()).arg(settings.chunkLen)
+		.arg(settings.audioLatency).arg(settings.midiLatency == 0 ? QString("auto") : QString("%1 ms").arg(settings.midiLatency)).arg(settings.advancedTiming ? ", advanced timing" : "");
+}
+
 bool SynthRoute::playMIDIShortMessage(MidiSession &midiSession, Bit32u msg, quint64 timestamp) {
 	if (multiMidiMode) {
 		QMidiBuffer *qMidiBuffer = midiSession.getQMidiBuffer();
@@ -296,6 +504,7 @@ void SynthRoute::flushMIDIQueue() {
 
 // When renderingPassFrameLength == 0, all pending messages are merged.
 void SynthRoute::mergeMidiStreams(uint renderingPassFrameLength) {
+	TraceScope traceScope("SynthRoute::mergeMidiStreams", renderingPassFrameLength);
 	quint64 renderingPassEndTimestamp;
 	{
 		if (renderingPassFrameLength > 0) {
@@ -308,47 +517,44 @@ void SynthRoute::mergeMidiStreams(uint renderingPassFrameLength) {
 		}
 	}
 
-	QMutexLocker midiSessionsLocker(&midiSessionsMutex);
-	QVarLengthArray<QMidiBuffer *, 16> streamBuffers;
+	// The realtime rendering thread must never block, so merging is postponed to the next rendering pass
+	// should a MIDI session be added or removed at the moment.
+	if (renderingPassFrameLength > 0 && qSynth.isRealtime()) {
+		if (!midiSessionsMutex.tryLock()) return;
+	} else {
+		midiSessionsMutex.lock();
+	}
+	MidiBufferHeap streamBuffers;
 	for (int i = 0; i < midiSessions.size(); i++) {
 		QMidiBuffer *midiBuffer = midiSessions[i]->getQMidiBuffer();
 		if (midiBuffer->retieveEvents() && midiBuffer->getEventTimestamp() < renderingPassEndTimestamp) {
-			streamBuffers.append(midiBuffer);
+			MidiBufferHeapEntry entry = {midiBuffer, midiBuffer->getEventTimestamp()};
+			streamBuffers.append(entry);
+			siftUpMidiBuffer(streamBuffers, streamBuffers.size() - 1);
 		}
 	}
 
 	while (!streamBuffers.isEmpty()) {
-		int nextEventBufferIx = 0;
-		quint64 nextEventTimestamp = streamBuffers[nextEventBufferIx]->getEventTimestamp();
-		for (int i = 1; i < streamBuffers.size(); i++) {
-			quint64 eventTimestamp = streamBuffers[i]->getEventTimestamp();
-			if (eventTimestamp < nextEventTimestamp) {
-				nextEventBufferIx = i;
-				nextEventTimestamp = eventTimestamp;
-			}
+		MidiBufferHeapEntry &entry = streamBuffers[0];
+		const uchar *sysexData;
+		quint32 eventData = entry.midiBuffer->getEventData(sysexData);
+		if (sysexData == NULL) {
+			qSynth.playMIDIShortMessage(eventData, entry.eventTimestamp);
+		} else {
+			qSynth.playMIDISysex(sysexData, eventData, entry.eventTimestamp);
 		}
-		QMidiBuffer * const midiBuffer = streamBuffers[nextEventBufferIx];
-		do {
-			const uchar *sysexData;
-			quint32 eventData = midiBuffer->getEventData(sysexData);
-			if (sysexData == NULL) {
-				qSynth.playMIDIShortMessage(eventData, nextEventTimestamp);
-			} else {
-				qSynth.playMIDISysex(sysexData, eventData, nextEventTimestamp);
-			}
-			if (!(midiBuffer->nextEvent() && midiBuffer->getEventTimestamp() < renderingPassEndTimestamp)) {
-#if QT_VERSION < QT_VERSION_CHECK(4, 7, 0)
-				if (nextEventBufferIx < streamBuffers.count() - 1) {
-					streamBuffers[nextEventBufferIx] = streamBuffers[streamBuffers.count() - 1];
-				}
-				streamBuffers.removeLast();
-#else
-				streamBuffers.remove(nextEventBufferIx);
-#endif
-				break;
-			}
-		} while (midiBuffer->getEventTimestamp() <= nextEventTimestamp);
+		if (entry.midiBuffer->nextEvent() && entry.midiBuffer->getEventTimestamp() < renderingPassEndTimestamp) {
+			// The timestamps estimated by a driver may step back a little, yet the events of a session must not overtake
+			// each other, nor be delivered to the synth out of order.
+			quint64 eventTimestamp = entry.midiBuffer->getEventTimestamp();
+			if (entry.eventTimestamp < eventTimestamp) entry.eventTimestamp = eventTimestamp;
+		} else {
+			entry = streamBuffers[streamBuffers.size() - 1];
+			streamBuffers.removeLast();
+		}
+		siftDownMidiBuffer(streamBuffers, 0);
 	}
+	midiSessionsMutex.unlock();
 }
 
 void SynthRoute::deleteAudioStream() {
@@ -357,6 +563,14 @@ void SynthRoute::deleteAudioStream() {
 	audioStream = NULL;
 }
 
+AudioStream *SynthRoute::startAudioStream(const uint sampleRate) {
+	Master *master = Master::getInstance();
+	if (master->isAudioMixingEnabled() && audioDevice->isMixingSupported()) {
+		return master->startMixedAudioStream(*audioDevice, *this, sampleRate);
+	}
+	return audioDevice->startAudioStream(*this, sampleRate);
+}
+
 void SynthRoute::render(MT32Emu::Bit16s *buffer, uint length) {
 	if (multiMidiMode) mergeMidiStreams(length);
 	qSynth.render(buffer, length);
@@ -367,6 +581,11 @@ void SynthRoute::render(float *buffer, uint length) {
 	qSynth.render(buffer, length);
 }
 
+void SynthRoute::render(float *leftBuffer, float *rightBuffer, uint length) {
+	if (multiMidiMode) mergeMidiStreams(length);
+	qSynth.render(leftBuffer, rightBuffer, length);
+}
+
 void SynthRoute::audioStreamFailed() {
 	qSynth.close();
 }
@@ -378,10 +597,12 @@ void SynthRoute::enableRealtimeMode() {
 }
 
 void SynthRoute::playMIDIShortMessageNow(Bit32u msg) {
+	if (suspended && holdPendingShortMessage(msg)) return;
 	qSynth.playMIDIShortMessageNow(msg);
 }
 
 void SynthRoute::playMIDISysexNow(const Bit8u *sysex, Bit32u sysexLen) {
+	if (suspended && holdPendingSysex(sysex, sysexLen)) return;
 	qSynth.playMIDISysexNow(sysex, sysexLen);
 }
 
@@ -473,6 +694,10 @@ void SynthRoute::getROMImages(const MT32Emu::ROMImage *&controlROMImage, const M
 	qSynth.getROMImages(controlROMImage, pcmROMImage);
 }
 
+int SynthRoute::getNUMANode() const {
+	return qSynth.getNUMANode();
+}
+
 uint SynthRoute::getPartialCount() const {
 	return qSynth.getPartialCount();
 }
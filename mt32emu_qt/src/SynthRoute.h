@@ -7,10 +7,11 @@
 #include "QSynth.h"
 #include "MasterClock.h"
 #include "MidiRecorder.h"
+#include "QMidiEvent.h"
+#include "audiodrv/AudioDriver.h"
 
 class MidiSession;
-class AudioStream;
-class AudioDevice;
+struct RenderTimingStats;
 
 enum SynthRouteState {
 	SynthRouteState_CLOSED,
@@ -19,10 +20,10 @@ enum SynthRouteState {
 	SynthRouteState_CLOSING
 };
 
-class SynthRoute : public QObject {
+class SynthRoute : public QObject, public AudioSource {
 	Q_OBJECT
 private:
-	typedef AudioStream *(*AudioStreamFactory)(const AudioDevice *, SynthRoute &, const uint, MidiSession *midiSession);
+	typedef AudioStream *(*AudioStreamFactory)(const AudioDevice *, AudioSource &, const uint, MidiSession *midiSession);
 
 	SynthRouteState state;
 	QSynth qSynth;
@@ -38,19 +39,44 @@ private:
 	// Protects read accesses to audioStream against concurrent deletions.
 	QReadWriteLock audioStreamLock;
 
+	// When enabled with the setting Master/idleSynthRouteSuspendTimeout, an idle route closes the synth and the audio stream
+	// until MIDI activity resumes. The memory state of the synth is kept aside meanwhile, and the MIDI events that arrive
+	// while suspended are held in pendingMidiEvents and played at once upon reopening.
+	volatile bool suspended;
+	volatile bool midiActivity;
+	bool resumeRequested;
+	QByteArray suspendedMemoryState;
+	QMidiEventList pendingMidiEvents;
+	QMutex pendingMidiEventsMutex;
+	QTimer idleTimer;
+
 	quint64 debugLastEventTimestamp;
 	qint64 debugDeltaLowerLimit, debugDeltaUpperLimit;
 
 	void setState(SynthRouteState newState);
+	bool closeSynth();
+	bool holdPendingShortMessage(MT32Emu::Bit32u msg);
+	bool holdPendingSysex(const MT32Emu::Bit8u *sysex, MT32Emu::Bit32u sysexLen);
+	void requestResumeLocked();
+	void finishResume(bool opened);
+	void cancelSuspension();
 	void disableExclusiveMidiMode();
 	void mergeMidiStreams(uint renderingPassFrameLength);
 	void deleteAudioStream();
+	AudioStream *startAudioStream(const uint sampleRate);
 
 public:
 	SynthRoute(QObject *parent = NULL);
 	~SynthRoute();
 	bool open(AudioStreamFactory audioStreamFactory = NULL);
 	bool close();
+	// Closes the open route until the next MIDI event arrives, then reopens it with the same memory state.
+	bool suspend();
+	// Sets up the closed route to open on the first MIDI event. Returns false unless idle suspension is enabled.
+	bool suspendUntilMIDIActivity();
+	bool isSuspended() const;
+	// Makes the suspended route reopen soon. Intended to be called from MIDI receiving threads.
+	void requestResume();
 	void reset();
 	bool enableExclusiveMidiMode(MidiSession *midiSession);
 	bool isExclusiveMidiModeEnabled();
@@ -69,9 +95,19 @@ public:
 	bool playMIDISysex(MidiSession &midiSession, const MT32Emu::Bit8u *sysex, MT32Emu::Bit32u sysexLen, quint64 timestamp);
 	bool pushMIDIShortMessage(MidiSession &midiSession, MT32Emu::Bit32u msg, MasterClockNanos midiNanos);
 	bool pushMIDISysex(MidiSession &midiSession, const MT32Emu::Bit8u *sysex, unsigned int sysexLen, MasterClockNanos midiNanos);
+	MasterClockNanos getMIDIClockNanos();
+	bool reportMIDIProgress(MasterClockNanos midiNanos);
+	bool getRenderTimingStats(RenderTimingStats &stats);
+	// Used by the latency measurement. Returns false if there is no audio stream.
+	bool setOnsetDetectionEnabled(bool enabled);
+	// Returns 0 if there is no audio stream or no onset was detected since the detection was enabled.
+	MasterClockNanos getLastOutputOnsetNanos();
+	// Identifies the audio device and settings of the output for the reports, an empty string if there is no audio stream.
+	QString getAudioOutputDescription();
 	void discardMidiBuffers();
 	void render(MT32Emu::Bit16s *buffer, uint length);
 	void render(float *buffer, uint length);
+	void render(float *leftBuffer, float *rightBuffer, uint length);
 	void audioStreamFailed();
 
 	void enableRealtimeMode();
@@ -112,11 +148,14 @@ public:
 	void getSynthProfile(SynthProfile &synthProfile) const;
 	void setSynthProfile(const SynthProfile &synthProfile, QString useSynthProfileName);
 	void getROMImages(const MT32Emu::ROMImage *&controlROMImage, const MT32Emu::ROMImage *&pcmROMImage) const;
+	int getNUMANode() const;
 	bool connectSynth(const char *signal, const QObject *receiver, const char *slot) const;
 	bool connectReportHandler(const char *signal, const QObject *receiver, const char *slot) const;
 
 private slots:
 	void handleQSynthState(SynthState synthState);
+	void handleIdleTimeout();
+	void resume();
 
 signals:
 	void stateChanged(SynthRouteState state);
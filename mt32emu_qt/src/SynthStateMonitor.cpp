@@ -128,24 +128,34 @@ void SynthStateMonitor::handleUpdate() {
 	if (nanosNow - previousUpdateNanos < MINIMUM_UPDATE_INTERVAL_NANOS) return;
 	previousUpdateNanos = nanosNow;
 	bool midiMessageOn = false;
-	synthRoute->getPartialStates(partialStates);
-	for (unsigned int partialNum = 0; partialNum < partialCount; partialNum++) {
-		partialStateLED[partialNum]->setColor(&partialStateColor[partialStates[partialNum]]);
+	// The LEDs only repaint when their colour changes, so we merely avoid querying the states nobody can see.
+	if (ui->partialStateGrid->parentWidget()->isVisible()) {
+		synthRoute->getPartialStates(partialStates);
+		for (unsigned int partialNum = 0; partialNum < partialCount; partialNum++) {
+			partialStateLED[partialNum]->setColor(&partialStateColor[partialStates[partialNum]]);
+		}
 	}
 	bool partActiveNonReleasing[9] = {false};
 	synthRoute->getPartStates(partActiveNonReleasing);
 	for (unsigned int partNum = 0; partNum < 9; partNum++) {
 		midiMessageOn = midiMessageOn || partActiveNonReleasing[partNum];
 	}
+	bool lcdChanged = false;
 	if ((lcdWidget.lcdState == LCDWidget::DISPLAYING_TIMBRE_NAME) && (nanosNow - lcdWidget.lcdStateStartNanos > LCD_TIMBRE_NAME_DISPLAYING_NANOS)) {
 		lcdWidget.setPartStateLCDText();
+		lcdChanged = true;
 	}
 	if (lcdWidget.lcdState == LCDWidget::DISPLAYING_PART_STATE) {
-		for (int partNum = 0; partNum < 5; partNum++) {
-			lcdWidget.maskedChar[partNum << 1] = partActiveNonReleasing[partNum];
+		for (int partNum = 0; partNum < 6; partNum++) {
+			// Mapping for the rhythm channel is at the last position
+			bool partActive = partActiveNonReleasing[partNum < 5 ? partNum : 8];
+			if (lcdWidget.maskedChar[partNum << 1] != partActive) {
+				lcdWidget.maskedChar[partNum << 1] = partActive;
+				lcdChanged = true;
+			}
 		}
-		lcdWidget.maskedChar[5 << 1] = partActiveNonReleasing[8]; // mapping for the rhythm channel
-		lcdWidget.update();
+		// Repainting the LCD is fairly expensive, do it only when the displayed part state actually changes.
+		if (lcdChanged) lcdWidget.update();
 	}
 
 	if (midiMessageOn) {
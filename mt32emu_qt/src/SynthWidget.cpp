@@ -61,6 +61,8 @@ SynthWidget::SynthWidget(Master *master, SynthRoute *useSynthRoute, bool pinnabl
 	connect(synthRoute, SIGNAL(midiSessionRemoved(MidiSession *)), SLOT(handleMIDISessionRemoved(MidiSession *)));
 	connect(synthRoute, SIGNAL(midiSessionNameChanged(MidiSession *)), SLOT(handleMIDISessionNameChanged(MidiSession *)));
 	connect(master, SIGNAL(synthRoutePinned()), SLOT(handleSynthRoutePinned()));
+	// The devices keep arriving while the initial scan is in progress.
+	connect(master, SIGNAL(audioDevicesChanged()), SLOT(on_refreshButton_clicked()));
 	connect(ui->synthPropertiesButton, SIGNAL(clicked()), &spd, SLOT(exec()));
 
 	synthRoute->connectReportHandler(SIGNAL(masterVolumeChanged(int)), this, SLOT(handleMasterVolumeChanged(int)));
@@ -144,7 +146,7 @@ void SynthWidget::handleSynthRouteState(SynthRouteState SynthRouteState) {
 		ui->refreshButton->setEnabled(true);
 		ui->audioPropertiesButton->setEnabled(true);
 		ui->audioRecord->setEnabled(false);
-		ui->statusLabel->setText("Closed");
+		ui->statusLabel->setText(synthRoute->isSuspended() ? "Suspended" : "Closed");
 		break;
 	}
 	setEmuModeText();
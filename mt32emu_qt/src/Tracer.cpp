@@ -0,0 +1,110 @@
+/* Copyright (C) 2011-2021 Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Tracer.h"
+
+#include "Master.h"
+#include "QAtomicHelper.h"
+
+using namespace MT32Emu;
+
+static const char *getSpanName(TraceSink::SpanKind kind) {
+	switch (kind) {
+	case TraceSink::SpanKind_RENDER:
+		return "Synth::render";
+	case TraceSink::SpanKind_SHORT_MESSAGE:
+		return "Synth::playMsgNow";
+	case TraceSink::SpanKind_SYSEX:
+		return "Synth::playSysexNow";
+	case TraceSink::SpanKind_PARTIAL_ALLOCATION:
+		return "Part::playPoly";
+	case TraceSink::SpanKind_PARTIAL_STEAL:
+		return "PartialManager::freePartials";
+	case TraceSink::SpanKind_REVERB:
+		return "BReverbModel::process";
+	}
+	return "Synth";
+}
+
+Tracer::Tracer(const QString &useFileName, uint useCapacity) :
+	fileName(useFileName), capacity(useCapacity), spans(new Span[useCapacity]), reservedSpanCount(0)
+{
+	qDebug() << "Tracer: Recording up to" << capacity << "spans to" << fileName;
+}
+
+Tracer::~Tracer() {
+	writeTrace();
+	delete[] spans;
+}
+
+void Tracer::recordSpan(const char *name, MasterClockNanos startNanos, MasterClockNanos endNanos, quint32 arg) {
+	// Once the buffer is full, avoid incrementing the counter further so that it never wraps around.
+	if (QAtomicHelper::loadRelaxed(reservedSpanCount) >= capacity) return;
+	const uint spanIx = uint(reservedSpanCount.fetchAndAddRelaxed(1));
+	if (spanIx >= capacity) return;
+	Span &span = spans[spanIx];
+	span.name = name;
+	span.startNanos = startNanos;
+	span.endNanos = endNanos;
+	span.threadId = quint64(quintptr(QThread::currentThreadId()));
+	span.arg = arg;
+	QAtomicHelper::storeRelease(span.recorded, 1);
+}
+
+void Tracer::onSpanCompleted(TraceSink::SpanKind kind, double durationNanos, Bit32u arg) {
+	const MasterClockNanos endNanos = MasterClock::getClockNanos();
+	recordSpan(getSpanName(kind), endNanos - MasterClockNanos(durationNanos), endNanos, arg);
+}
+
+// Only called once all the threads that record spans have stopped.
+void Tracer::writeTrace() const {
+	const uint spanCount = qMin(QAtomicHelper::loadAcquire(reservedSpanCount), quint32(capacity));
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		qDebug() << "Tracer: Failed to open file" << fileName;
+		return;
+	}
+	MasterClockNanos originNanos = 0;
+	for (uint i = 0; i < spanCount; i++) {
+		if (QAtomicHelper::loadAcquire(spans[i].recorded) == 0) continue;
+		if (originNanos == 0 || spans[i].startNanos < originNanos) originNanos = spans[i].startNanos;
+	}
+	QTextStream out(&file);
+	out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	uint writtenSpanCount = 0;
+	for (uint i = 0; i < spanCount; i++) {
+		const Span &span = spans[i];
+		if (QAtomicHelper::loadAcquire(span.recorded) == 0) continue;
+		if (writtenSpanCount++ > 0) out << ",";
+		// The timestamps are in microseconds relative to the earliest span.
+		out << "\n{\"name\":\"" << span.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << span.threadId
+			<< ",\"ts\":" << QString::number(double(span.startNanos - originNanos) / MasterClock::NANOS_PER_MICROSECOND, 'f', 3)
+			<< ",\"dur\":" << QString::number(double(span.endNanos - span.startNanos) / MasterClock::NANOS_PER_MICROSECOND, 'f', 3)
+			<< ",\"args\":{\"arg\":" << span.arg << "}}";
+	}
+	out << "\n]}\n";
+	uint droppedSpanCount = QAtomicHelper::loadAcquire(reservedSpanCount) - spanCount;
+	qDebug() << "Tracer: Written" << writtenSpanCount << "spans to" << fileName << "dropped:" << droppedSpanCount;
+}
+
+TraceScope::TraceScope(const char *useName, quint32 useArg) :
+	tracer(Master::getInstance()->getTracer()), name(useName), arg(useArg),
+	startNanos(tracer == NULL ? 0 : MasterClock::getClockNanos())
+{}
+
+TraceScope::~TraceScope() {
+	if (tracer != NULL) tracer->recordSpan(name, startNanos, MasterClock::getClockNanos(), arg);
+}
@@ -0,0 +1,56 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QtCore>
+#include <mt32emu/mt32emu.h>
+
+#include "MasterClock.h"
+
+// Records the spans of work performed by the threads of the application along with the spans reported by the synths,
+// and writes them in the Chrome trace event format on destruction. The trace can be viewed with chrome://tracing
+// or the Perfetto UI, which shows the MIDI, rendering and audio threads on a common timeline. The spans are recorded
+// into a preallocated buffer without locking, so that tracing is usable in the realtime threads. When the buffer
+// fills up, further spans are dropped.
+class Tracer : public MT32Emu::TraceSink {
+public:
+	Tracer(const QString &fileName, uint capacity);
+	~Tracer();
+
+	// Thread-safe. The name must be a string literal, it is only referenced until the trace is written.
+	void recordSpan(const char *name, MasterClockNanos startNanos, MasterClockNanos endNanos, quint32 arg);
+	void onSpanCompleted(MT32Emu::TraceSink::SpanKind kind, double durationNanos, MT32Emu::Bit32u arg);
+
+private:
+	struct Span {
+		const char *name;
+		MasterClockNanos startNanos;
+		MasterClockNanos endNanos;
+		quint64 threadId;
+		quint32 arg;
+		// Set once the other fields are written.
+		QAtomicInt recorded;
+	};
+
+	const QString fileName;
+	const uint capacity;
+	Span * const spans;
+	// The number of spans reserved so far, which may slightly exceed the capacity as the overflowing spans are dropped.
+	QAtomicInt reservedSpanCount;
+
+	void writeTrace() const;
+};
+
+// Records a span of work that lasts till the end of the scope, provided tracing is enabled.
+class TraceScope {
+public:
+	explicit TraceScope(const char *name, quint32 arg = 0);
+	~TraceScope();
+
+private:
+	Tracer * const tracer;
+	const char * const name;
+	const quint32 arg;
+	const MasterClockNanos startNanos;
+};
+
+#endif
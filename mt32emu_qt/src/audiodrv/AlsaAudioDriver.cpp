@@ -28,8 +28,8 @@ static const unsigned int DEFAULT_CHUNK_MS = 16;
 static const unsigned int DEFAULT_AUDIO_LATENCY = 64;
 static const unsigned int DEFAULT_MIDI_LATENCY = 32;
 
-AlsaAudioStream::AlsaAudioStream(const AudioDriverSettings &useSettings, SynthRoute &useSynthRoute, const quint32 useSampleRate) :
-  AudioStream(useSettings, useSynthRoute, useSampleRate), stream(NULL), processingThreadID(0), stopProcessing(false)
+AlsaAudioStream::AlsaAudioStream(const AudioDriverSettings &useSettings, AudioSource &useAudioSource, const quint32 useSampleRate) :
+  AudioStream(useSettings, useAudioSource, useSampleRate), stream(NULL), processingThreadID(0), stopProcessing(false)
 {
 	bufferSize = settings.chunkLen * sampleRate / MasterClock::MILLIS_PER_SECOND;
 	buffer = new Bit16s[/* channels */ 2 * bufferSize];
@@ -78,7 +78,7 @@ void *AlsaAudioStream::processingThread(void *userData) {
 	if (isErrorOccured) {
 		snd_pcm_close(audioStream.stream);
 		audioStream.stream = NULL;
-		audioStream.synthRoute.audioStreamFailed();
+		audioStream.audioSource.audioStreamFailed();
 	} else {
 		audioStream.stopProcessing = false;
 	}
@@ -174,13 +174,39 @@ void AlsaAudioStream::close() {
 
 AlsaAudioDevice::AlsaAudioDevice(AlsaAudioDriver &driver, const char *useDeviceID, const QString name) : AudioDevice(driver, name), deviceID(useDeviceID) {}
 
-AudioStream *AlsaAudioDevice::startAudioStream(SynthRoute &synthRoute, const uint sampleRate) const {
-	AlsaAudioStream *stream = new AlsaAudioStream(driver.getAudioSettings(), synthRoute, sampleRate);
+AudioStream *AlsaAudioDevice::startAudioStream(AudioSource &audioSource, const uint sampleRate) const {
+	AlsaAudioStream *stream = new AlsaAudioStream(driver.getAudioSettings(), audioSource, sampleRate);
 	if (stream->start(deviceID)) return stream;
 	delete stream;
 	return NULL;
 }
 
+// The device is opened briefly with the rate resampling of ALSA disabled, which makes the plug devices expose
+// the rates of the hardware. Returns 0 if the device is unavailable, e.g. while it is used exclusively.
+uint AlsaAudioDevice::negotiateSampleRate(const uint desiredSampleRate) const {
+	snd_pcm_t *pcm;
+	int error = snd_pcm_open(&pcm, deviceID, SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK);
+	if (error < 0) {
+		qDebug() << "ALSA audio: Can't query sample rates of device" << deviceID << "-" << snd_strerror(error);
+		return 0;
+	}
+	snd_pcm_hw_params_t *hwParams;
+	snd_pcm_hw_params_alloca(&hwParams);
+	uint sampleRate = desiredSampleRate;
+	int dir = 0;
+	if (snd_pcm_hw_params_any(pcm, hwParams) < 0
+		|| snd_pcm_hw_params_set_rate_resample(pcm, hwParams, 0) < 0
+		|| snd_pcm_hw_params_set_access(pcm, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED) < 0
+		|| snd_pcm_hw_params_set_format(pcm, hwParams, SND_PCM_FORMAT_S16) < 0
+		|| snd_pcm_hw_params_set_channels(pcm, hwParams, 2) < 0
+		|| snd_pcm_hw_params_set_rate_near(pcm, hwParams, &sampleRate, &dir) < 0)
+	{
+		sampleRate = 0;
+	}
+	snd_pcm_close(pcm);
+	return sampleRate;
+}
+
 AlsaAudioDriver::AlsaAudioDriver(Master *master) : AudioDriver("alsa", "ALSA") {
 	Q_UNUSED(master);
 
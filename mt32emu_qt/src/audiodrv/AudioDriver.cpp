@@ -15,9 +15,41 @@
  */
 
 #include "AudioDriver.h"
+
+#include <cmath>
+#include <cstring>
 #include <QSettings>
 #include "../Master.h"
 #include "../QAtomicHelper.h"
+#include "../Tracer.h"
+
+// The adaptive MIDI latency controller evaluates the timing over windows of this length.
+static const quint32 LATENCY_CONTROL_WINDOW_MILLIS = 2000;
+// The slack kept available for incoming MIDI events in addition to the worst case observed.
+static const quint32 LATENCY_CONTROL_HEADROOM_MILLIS = 4;
+// The MIDI latency is reduced slowly, by at most this value per window, to avoid audible timing changes.
+static const quint32 LATENCY_CONTROL_MAX_DECREMENT_MILLIS = 2;
+// The number of windows to wait after an underrun before reducing the MIDI latency again.
+static const quint32 LATENCY_CONTROL_UNDERRUN_HOLD_COUNT = 15;
+// The upper bound for the MIDI latency adjusted automatically.
+static const quint32 LATENCY_CONTROL_MAX_MIDI_LATENCY_MILLIS = 1000;
+
+static const double DLL_TWO_PI = 6.283185307179586;
+// The bandwidth of the DLL that tracks the play position. Lower values reject more jitter but the loop locks slower.
+static const double DLL_BANDWIDTH_HZ = 0.4;
+// Limits the loop gain when the updates are infrequent to keep the loop stable.
+static const double DLL_MAX_OMEGA = 0.5;
+// The smoothing factor of the mean squared prediction error of the DLL.
+static const double JITTER_FILTER_FACTOR = 0.05;
+// Sets how often the estimated jitter is reported.
+static const qint64 JITTER_REPORT_INTERVAL_SECONDS = 10;
+// Sets how often the render timing statistics are reported, provided there were new deadline misses or underruns.
+static const qint64 RENDER_TIMING_REPORT_INTERVAL_SECONDS = 10;
+// A note onset is detected when the output reaches this level after staying below the quiet level for some time.
+// The hysteresis keeps the decaying tail of the previous note, including the reverb, from being taken for an onset.
+static const int ONSET_LEVEL = 2048;
+static const int ONSET_QUIET_LEVEL = 512;
+static const quint32 ONSET_MIN_QUIET_MILLIS = 100;
 
 template<class T>
 static inline void takeSnapshot(T &snapshot, const T snapshots[], const QAtomicInt &changeCount) {
@@ -43,9 +75,11 @@ static inline void publishSnapshot(QAtomicInt &changeCount) {
 	QAtomicHelper::storeRelease(changeCount, (myChangeCount + 1U) & 0x7fffffffU);
 }
 
-AudioStream::AudioStream(const AudioDriverSettings &useSettings, SynthRoute &useSynthRoute, const quint32 useSampleRate) :
-	synthRoute(useSynthRoute), sampleRate(useSampleRate), settings(useSettings), lastEstimatedPlayedFramesCount(0),
-	resetScheduled(true)
+AudioStream::AudioStream(const AudioDriverSettings &useSettings, AudioSource &useAudioSource, const quint32 useSampleRate) :
+	audioSource(useAudioSource), sampleRate(useSampleRate), settings(useSettings), resetScheduled(true),
+	meanSquaredTimingError(0), lastJitterReportNanos(0), latencyControlFramesCount(0), latencyControlMinSlackFrames(0), latencyControlHoldCount(0),
+	underrunDetected(false), pendingUnderrunCount(0), lastRenderTimingReportNanos(0), lastReportedDeadlineMissCount(0),
+	lastReportedUnderrunCount(0), onsetDetectionEnabled(false), onsetDetectorQuietFrames(0)
 {
 	audioLatencyFrames = settings.audioLatency * sampleRate / MasterClock::MILLIS_PER_SECOND;
 	midiLatencyFrames = settings.midiLatency * sampleRate / MasterClock::MILLIS_PER_SECOND;
@@ -55,6 +89,14 @@ AudioStream::AudioStream(const AudioDriverSettings &useSettings, SynthRoute &use
 	timeInfos[0].lastPlayedFramesCount = 0;
 	timeInfos[0].actualSampleRate = sampleRate;
 	timeInfos[1] = timeInfos[0];
+	memset(renderTimingStats, 0, sizeof renderTimingStats);
+	lastOnsetNanos[0] = 0;
+	lastOnsetNanos[1] = 0;
+}
+
+AudioStream::~AudioStream() {
+	const RenderTimingStats &stats = renderTimingStats[getSnapshotReadIx(renderTimingStatsChangeCount)];
+	if (stats.renderCount > 0) logRenderTimingStats("Render timing summary", stats);
 }
 
 // Intended to be called from MIDI receiving threads.
@@ -77,6 +119,16 @@ quint64 AudioStream::estimateMIDITimestamp(const MasterClockNanos midiNanos) {
 	return timestamp < 0 ? 0 : quint64(timestamp);
 }
 
+// Intended to be called from MIDI receiving threads.
+MasterClockNanos AudioStream::getMIDIClockNanos() {
+	return MasterClock::getClockNanos();
+}
+
+// Intended to be called from MIDI receiving threads.
+bool AudioStream::reportMIDIProgress(const MasterClockNanos) {
+	return false;
+}
+
 // Only called from the rendering thread.
 quint64 AudioStream::computeMIDITimestamp(uint relativeFrameTime) const {
 	return getRenderedFramesCount() + relativeFrameTime;
@@ -84,9 +136,137 @@ quint64 AudioStream::computeMIDITimestamp(uint relativeFrameTime) const {
 
 // Only called from the rendering thread.
 void AudioStream::renderAndUpdateState(MT32Emu::Bit16s *buffer, const quint32 frameCount, const MasterClockNanos measuredNanos, const quint32 framesInAudioBuffer) {
+	TraceScope traceScope("AudioStream::renderAndUpdateState", frameCount);
 	updateTimeInfo(measuredNanos, framesInAudioBuffer);
-	synthRoute.render(buffer, frameCount);
+	MasterClockNanos renderStartNanos = MasterClock::getClockNanos();
+	audioSource.render(buffer, frameCount);
 	framesRendered(frameCount);
+	updateRenderTimingStats(frameCount, renderStartNanos, MasterClock::getClockNanos());
+	if (isAutoLatencyMode()) updateMIDILatency(frameCount);
+	if (onsetDetectionEnabled) detectOnset(buffer, frameCount, measuredNanos, framesInAudioBuffer);
+}
+
+// Only called from the rendering thread. The frames already in the audio buffer are played before the rendered ones,
+// so the play time of each frame follows from the time of the measurement and its position.
+void AudioStream::detectOnset(const MT32Emu::Bit16s *buffer, const quint32 frameCount, const MasterClockNanos measuredNanos, const quint32 framesInAudioBuffer) {
+	const quint32 minQuietFrames = quint32(ONSET_MIN_QUIET_MILLIS * sampleRate / MasterClock::MILLIS_PER_SECOND);
+	for (quint32 frameIx = 0; frameIx < frameCount; frameIx++) {
+		const int level = qMax(qAbs(int(buffer[2 * frameIx])), qAbs(int(buffer[2 * frameIx + 1])));
+		if (level < ONSET_QUIET_LEVEL) {
+			if (onsetDetectorQuietFrames < minQuietFrames) onsetDetectorQuietFrames++;
+			continue;
+		}
+		if (level >= ONSET_LEVEL && onsetDetectorQuietFrames >= minQuietFrames) {
+			lastOnsetNanos[getSnapshotWriteIx(lastOnsetChangeCount)] = measuredNanos
+				+ MasterClockNanos(framesInAudioBuffer + frameIx) * MasterClock::NANOS_PER_SECOND / sampleRate;
+			publishSnapshot(lastOnsetChangeCount);
+		}
+		onsetDetectorQuietFrames = 0;
+	}
+}
+
+// Only called from the rendering thread.
+// A rendering pass misses the deadline when it takes longer than the duration of the audio rendered. Even if the audio buffer
+// absorbs the occasional misses, a steady load close to 100% leaves no headroom for the scheduling latency of the system.
+void AudioStream::updateRenderTimingStats(const quint32 frameCount, const MasterClockNanos renderStartNanos, const MasterClockNanos renderEndNanos) {
+	const RenderTimingStats &stats = renderTimingStats[getSnapshotReadIx(renderTimingStatsChangeCount)];
+	RenderTimingStats &nextStats = renderTimingStats[getSnapshotWriteIx(renderTimingStatsChangeCount)];
+	nextStats = stats;
+	nextStats.underrunCount += pendingUnderrunCount;
+	pendingUnderrunCount = 0;
+	if (frameCount > 0) {
+		const MasterClockNanos renderNanos = renderEndNanos - renderStartNanos;
+		const MasterClockNanos deadlineNanos = MasterClockNanos(frameCount) * MasterClock::NANOS_PER_SECOND / sampleRate;
+		const bool deadlineMissed = renderNanos > deadlineNanos;
+		const quint32 loadPercent = quint32(qMin(renderNanos * 100 / qMax(deadlineNanos, MasterClockNanos(1)), MasterClockNanos(1000000)));
+		const quint32 lastBucketIx = RenderTimingStats::LOAD_HISTOGRAM_BUCKET_COUNT - 1;
+		nextStats.renderCount++;
+		if (deadlineMissed) nextStats.deadlineMissCount++;
+		nextStats.maxLoadPercent = qMax(nextStats.maxLoadPercent, loadPercent);
+		nextStats.loadHistogram[deadlineMissed ? lastBucketIx : qMin(loadPercent / 10, lastBucketIx - 1)]++;
+	}
+	publishSnapshot(renderTimingStatsChangeCount);
+
+	if ((renderEndNanos - lastRenderTimingReportNanos) < RENDER_TIMING_REPORT_INTERVAL_SECONDS * MasterClock::NANOS_PER_SECOND) return;
+	lastRenderTimingReportNanos = renderEndNanos;
+	if (nextStats.deadlineMissCount == lastReportedDeadlineMissCount && nextStats.underrunCount == lastReportedUnderrunCount) return;
+	lastReportedDeadlineMissCount = nextStats.deadlineMissCount;
+	lastReportedUnderrunCount = nextStats.underrunCount;
+	logRenderTimingStats("Render deadlines missed", nextStats);
+}
+
+void AudioStream::logRenderTimingStats(const char *title, const RenderTimingStats &stats) const {
+	QString loadHistogram;
+	for (uint i = 0; i < RenderTimingStats::LOAD_HISTOGRAM_BUCKET_COUNT; i++) {
+		if (i > 0) loadHistogram += " ";
+		loadHistogram += QString::number(stats.loadHistogram[i]);
+	}
+	qDebug() << "AudioStream:" << title << "- rendering passes:" << stats.renderCount << "deadline misses:" << stats.deadlineMissCount
+		<< "underruns:" << stats.underrunCount << "max. load (%):" << stats.maxLoadPercent
+		<< "load histogram (10% steps):" << qPrintable(loadHistogram);
+}
+
+const AudioDriverSettings &AudioStream::getSettings() const {
+	return settings;
+}
+
+quint32 AudioStream::getSampleRate() const {
+	return sampleRate;
+}
+
+// The onset detector starts anew, so that the onsets that preceded the enabling are not reported.
+void AudioStream::setOnsetDetectionEnabled(bool enabled) {
+	if (enabled && !onsetDetectionEnabled) onsetDetectorQuietFrames = 0;
+	onsetDetectionEnabled = enabled;
+}
+
+MasterClockNanos AudioStream::getLastOnsetNanos() const {
+	MasterClockNanos nanos;
+	takeSnapshot(nanos, lastOnsetNanos, lastOnsetChangeCount);
+	return nanos;
+}
+
+// Intended to be called from the GUI thread.
+void AudioStream::getRenderTimingStats(RenderTimingStats &stats) const {
+	takeSnapshot(stats, renderTimingStats, renderTimingStatsChangeCount);
+}
+
+// Only called from the rendering thread.
+// Right after rendering, the rendered frames count is the farthest ahead of the estimated play position,
+// so a MIDI event received at this moment is the one closest to be late. Measuring the slack for such an event
+// accounts for the render time, the callback jitter and the audio buffer filling pattern at once.
+void AudioStream::updateMIDILatency(const quint32 frameCount) {
+	if (resetScheduled) return;
+	const TimeInfo &timeInfo = timeInfos[getSnapshotReadIx(timeInfoChangeCount)];
+	MasterClockNanos nanosNow = MasterClock::getClockNanos();
+	qint64 refFrameOffset = qint64(((nanosNow - timeInfo.lastPlayedNanos) * timeInfo.actualSampleRate) / MasterClock::NANOS_PER_SECOND);
+	qint64 slack = qint64(timeInfo.lastPlayedFramesCount) + refFrameOffset + qint64(midiLatencyFrames) - qint64(getRenderedFramesCount());
+	if (latencyControlFramesCount == 0 || slack < latencyControlMinSlackFrames) latencyControlMinSlackFrames = slack;
+	latencyControlFramesCount += frameCount;
+	if (latencyControlFramesCount < LATENCY_CONTROL_WINDOW_MILLIS * sampleRate / MasterClock::MILLIS_PER_SECOND) return;
+	latencyControlFramesCount = 0;
+
+	const qint64 headroomFrames = LATENCY_CONTROL_HEADROOM_MILLIS * sampleRate / MasterClock::MILLIS_PER_SECOND;
+	qint64 newMIDILatencyFrames = midiLatencyFrames;
+	if (underrunDetected) {
+		// The slack measured across an underrun is meaningless, just back off and stay there for a while.
+		underrunDetected = false;
+		latencyControlHoldCount = LATENCY_CONTROL_UNDERRUN_HOLD_COUNT;
+		newMIDILatencyFrames += headroomFrames;
+	} else if (latencyControlMinSlackFrames < headroomFrames) {
+		newMIDILatencyFrames += headroomFrames - latencyControlMinSlackFrames;
+	} else if (latencyControlHoldCount > 0) {
+		latencyControlHoldCount--;
+	} else {
+		const qint64 maxDecrementFrames = LATENCY_CONTROL_MAX_DECREMENT_MILLIS * sampleRate / MasterClock::MILLIS_PER_SECOND;
+		newMIDILatencyFrames -= qMin((latencyControlMinSlackFrames - headroomFrames) / 2, maxDecrementFrames);
+	}
+	const qint64 maxMIDILatencyFrames = LATENCY_CONTROL_MAX_MIDI_LATENCY_MILLIS * sampleRate / MasterClock::MILLIS_PER_SECOND;
+	newMIDILatencyFrames = qMin(newMIDILatencyFrames, maxMIDILatencyFrames);
+	if (newMIDILatencyFrames == qint64(midiLatencyFrames)) return;
+	qDebug() << "AudioStream: Adjusted MIDI latency (frames):" << midiLatencyFrames << "->" << newMIDILatencyFrames
+		<< "min. slack:" << latencyControlMinSlackFrames;
+	midiLatencyFrames = quint32(newMIDILatencyFrames);
 }
 
 // Only called from the rendering thread.
@@ -113,29 +293,38 @@ void AudioStream::updateTimeInfo(const MasterClockNanos measuredNanos, const qui
 	quint64 estimatedNewPlayedFramesCount = settings.advancedTiming ? quint64(renderedFramesCount - framesInAudioBuffer) : renderedFramesCount;
 	double secondsElapsed = double(measuredNanos - timeInfo.lastPlayedNanos) / MasterClock::NANOS_PER_SECOND;
 
-	// Ensure lastPlayedFramesCount is monotonically increasing and has no jumps
-	quint64 newPlayedFramesCount = timeInfo.lastPlayedFramesCount + quint64(timeInfo.actualSampleRate * secondsElapsed + 0.5);
-
-	qint64 absError = qint64(estimatedNewPlayedFramesCount - newPlayedFramesCount);
+	// The play position is tracked by a second-order delay-locked loop, similarly to the one used in JACK.
+	// The loop predicts the play position using the current estimation of the actual sample rate,
+	// then both the position and the sample rate are corrected based on the prediction error.
+	// This way, the callback jitter is filtered out from the computed MIDI timestamps, provided the loop bandwidth is low enough.
+	double predictedPlayedFramesCount = timeInfo.lastPlayedFramesCount + timeInfo.actualSampleRate * secondsElapsed;
+	double error = double(estimatedNewPlayedFramesCount) - predictedPlayedFramesCount;
 
 	// If the estimation goes too far - do reset
-	if (resetScheduled || qAbs(absError) > qint64(midiLatencyFrames)) {
+	if (resetScheduled || qAbs(error) > midiLatencyFrames) {
 		if (resetScheduled) {
 			resetScheduled = false;
 		} else {
-			qDebug() << "AudioStream: Estimated play position is way off:" << absError << "-> resetting...";
+			qDebug() << "AudioStream: Estimated play position is way off:" << error << "-> resetting...";
+			underrunDetected = true;
+			pendingUnderrunCount++;
 		}
-		lastEstimatedPlayedFramesCount = estimatedNewPlayedFramesCount;
+		meanSquaredTimingError = 0;
 		nextTimeInfo.lastPlayedNanos = measuredNanos;
-		nextTimeInfo.lastPlayedFramesCount = estimatedNewPlayedFramesCount;
+		nextTimeInfo.lastPlayedFramesCount = double(estimatedNewPlayedFramesCount);
 		nextTimeInfo.actualSampleRate = sampleRate;
 		publishSnapshot(timeInfoChangeCount);
 		return;
 	}
 
-	const double estimatedNewActualSampleRate = (estimatedNewPlayedFramesCount - lastEstimatedPlayedFramesCount + absError) / secondsElapsed;
-	const double prevActualSampleRate = timeInfo.actualSampleRate;
-	const double filteredNewActualSampleRate = prevActualSampleRate + (estimatedNewActualSampleRate - prevActualSampleRate) * 0.1;
+	// The loop coefficients are derived for the critical damping of the loop with the given bandwidth.
+	// As the update interval varies, they are recomputed each time.
+	const double omega = qMin(DLL_TWO_PI * DLL_BANDWIDTH_HZ * secondsElapsed, DLL_MAX_OMEGA);
+	const double b = sqrt(2.0) * omega;
+	const double c = omega * omega;
+
+	// Ensure lastPlayedFramesCount is monotonically increasing
+	double newPlayedFramesCount = qMax(timeInfo.lastPlayedFramesCount, predictedPlayedFramesCount + b * error);
 
 	// Now fixup sample rate estimation. It shouldn't go too far from expected.
 	// Assume the actual sample rate differs from nominal one within 1% range.
@@ -145,19 +334,30 @@ void AudioStream::updateTimeInfo(const MasterClockNanos measuredNanos, const qui
 	// e.g. WinMME on my WinXP system works at about 32100Hz instead, while WASAPI, OSS, PulseAudio and ALSA perform much better.
 	// Setting 0.5% as the maximum permitted relative error provides for superior rendering accuracy, and sample rate deviations should now be inaudible.
 	// In case there are nasty environments with greater deviations in sample rate, we should make this configurable.
-	double newActualSampleRate = qBound(0.995 * sampleRate, filteredNewActualSampleRate, 1.005 * sampleRate) ;
+	double newActualSampleRate = qBound(0.995 * sampleRate, timeInfo.actualSampleRate + c * error / secondsElapsed, 1.005 * sampleRate);
+
+	// The prediction error that remains once the loop is locked is the jitter of the play position reported by the driver.
+	meanSquaredTimingError += (error * error - meanSquaredTimingError) * JITTER_FILTER_FACTOR;
+	if ((measuredNanos - lastJitterReportNanos) > JITTER_REPORT_INTERVAL_SECONDS * MasterClock::NANOS_PER_SECOND) {
+		lastJitterReportNanos = measuredNanos;
+		qDebug() << "AudioStream: Estimated timing jitter (ms):" << getEstimatedJitterMillis() << "actual sample rate:" << newActualSampleRate;
+	}
 
 #if 0
-	qDebug() << "S" << newActualSampleRate << absError;
+	qDebug() << "S" << newActualSampleRate << error;
 #endif
 
-	lastEstimatedPlayedFramesCount = estimatedNewPlayedFramesCount;
 	nextTimeInfo.lastPlayedNanos = measuredNanos;
 	nextTimeInfo.lastPlayedFramesCount = newPlayedFramesCount;
 	nextTimeInfo.actualSampleRate = newActualSampleRate;
 	publishSnapshot(timeInfoChangeCount);
 }
 
+// Only called from the rendering thread.
+double AudioStream::getEstimatedJitterMillis() const {
+	return sqrt(meanSquaredTimingError) * MasterClock::MILLIS_PER_SECOND / sampleRate;
+}
+
 bool AudioStream::isAutoLatencyMode() const {
 	return settings.midiLatency == 0;
 }
@@ -174,6 +374,13 @@ quint64 AudioStream::getRenderedFramesCount() const {
 	return renderedFramesCounts[getSnapshotReadIx(renderedFramesChangeCount)];
 }
 
+// Intended to be called from MIDI receiving threads.
+quint64 AudioStream::takeRenderedFramesCountSnapshot() const {
+	quint64 renderedFramesCount;
+	takeSnapshot(renderedFramesCount, renderedFramesCounts, renderedFramesChangeCount);
+	return renderedFramesCount;
+}
+
 AudioDevice::AudioDevice(AudioDriver &useDriver, QString useName) : driver(useDriver), name(useName) {}
 
 AudioDriver::AudioDriver(QString useID, QString useName) : id(useID), name(useName) {}
@@ -11,20 +11,58 @@
 #include "../MasterClock.h"
 
 class AudioDriver;
-class SynthRoute;
 struct AudioDriverSettings;
 
+// The source of the audio an AudioStream plays. Normally, it is the SynthRoute the stream is started for,
+// while an AudioMixer combines the audio of all the routes that share an audio device.
+class AudioSource {
+public:
+	virtual void render(MT32Emu::Bit16s *buffer, uint length) = 0;
+	virtual void render(float *buffer, uint length) = 0;
+	virtual void render(float *leftBuffer, float *rightBuffer, uint length) = 0;
+	virtual void audioStreamFailed() = 0;
+	virtual void enableRealtimeMode() = 0;
+	virtual void enableMultiMidiMode() = 0;
+
+protected:
+	virtual ~AudioSource() {}
+};
+
+// Statistics of the render timing of an AudioStream relative to the real-time deadlines, which are given by the duration
+// of the audio rendered in each pass. These help to check whether the configured audio buffer settings suffice.
+struct RenderTimingStats {
+	enum {
+		// The load histogram has a bucket for each 10% step of the load, plus the last one for rendering passes
+		// that missed the deadline.
+		LOAD_HISTOGRAM_BUCKET_COUNT = 11
+	};
+
+	// The number of rendering passes measured.
+	quint32 renderCount;
+	// The number of rendering passes that took longer than the duration of the audio rendered.
+	quint32 deadlineMissCount;
+	// The number of underruns detected, i.e. when the audio buffer ran dry, apparently as a result of missed deadlines.
+	quint32 underrunCount;
+	// The load of the longest rendering pass, i.e. the render time relative to the duration of the audio rendered, in percent.
+	quint32 maxLoadPercent;
+	quint32 loadHistogram[LOAD_HISTOGRAM_BUCKET_COUNT];
+};
+
 class AudioStream {
+friend class AudioMixer;
 protected:
-	SynthRoute &synthRoute;
+	AudioSource &audioSource;
 	const quint32 sampleRate;
 	const AudioDriverSettings &settings;
 	quint32 audioLatencyFrames;
 	quint32 midiLatencyFrames;
 
-	quint64 lastEstimatedPlayedFramesCount;
 	bool resetScheduled;
 
+	// The mean squared prediction error of the play position DLL, in frames squared.
+	double meanSquaredTimingError;
+	MasterClockNanos lastJitterReportNanos;
+
 	// Note, renderedFramesCount and timeInfo are read from several MIDI receiving threads,
 	// so they need a thread-safe publication tech. The two snapshots are written in turn,
 	// so that while the change count stays intact, it is safe to read the snapshot
@@ -35,22 +73,68 @@ protected:
 
 	struct TimeInfo {
 		MasterClockNanos lastPlayedNanos;
-		quint64 lastPlayedFramesCount;
+		double lastPlayedFramesCount;
 		double actualSampleRate;
 	} timeInfos[2];
 	QAtomicInt timeInfoChangeCount;
 
+	// State of the adaptive MIDI latency controller, only used in the auto latency mode from the rendering thread.
+	// The controller tracks the minimum slack left for MIDI events over an evaluation window and adjusts the MIDI latency
+	// when the window ends, so that the slack stays close to the safety margin despite render time and callback jitter.
+	quint32 latencyControlFramesCount;
+	qint64 latencyControlMinSlackFrames;
+	quint32 latencyControlHoldCount;
+	bool underrunDetected;
+
+	// The render timing statistics are read from the GUI thread, so they are published the same way as the time infos.
+	RenderTimingStats renderTimingStats[2];
+	QAtomicInt renderTimingStatsChangeCount;
+	// The underruns detected since the last update of the render timing statistics.
+	quint32 pendingUnderrunCount;
+	MasterClockNanos lastRenderTimingReportNanos;
+	quint32 lastReportedDeadlineMissCount;
+	quint32 lastReportedUnderrunCount;
+
+	// State of the note onset detector used to measure the MIDI-to-audio latency. It only runs while enabled, and only
+	// in the streams rendered via renderAndUpdateState(), since the play time is derived from the fill of the audio buffer.
+	volatile bool onsetDetectionEnabled;
+	quint32 onsetDetectorQuietFrames;
+	// The estimated play times of the last detected onset are published the same way as the time infos.
+	MasterClockNanos lastOnsetNanos[2];
+	QAtomicInt lastOnsetChangeCount;
+
 	void renderAndUpdateState(MT32Emu::Bit16s *buffer, const quint32 frameCount, const MasterClockNanos measuredNanos, const quint32 framesInAudioBuffer);
 	void updateTimeInfo(const MasterClockNanos measuredNanos, const quint32 framesInAudioBuffer);
 	bool isAutoLatencyMode() const;
+	// Returns the RMS jitter of the play position reported by the audio driver estimated by the timing DLL.
+	double getEstimatedJitterMillis() const;
+	void updateMIDILatency(const quint32 frameCount);
 	void framesRendered(quint32 frameCount);
 	quint64 getRenderedFramesCount() const;
+	quint64 takeRenderedFramesCountSnapshot() const;
+	// Accounts a rendering pass of frameCount frames in the render timing statistics.
+	void updateRenderTimingStats(const quint32 frameCount, const MasterClockNanos renderStartNanos, const MasterClockNanos renderEndNanos);
+	void logRenderTimingStats(const char *title, const RenderTimingStats &stats) const;
+	void detectOnset(const MT32Emu::Bit16s *buffer, const quint32 frameCount, const MasterClockNanos measuredNanos, const quint32 framesInAudioBuffer);
 
 public:
-	AudioStream(const AudioDriverSettings &settings, SynthRoute &synthRoute, const quint32 sampleRate);
-	virtual ~AudioStream() {}
+	AudioStream(const AudioDriverSettings &settings, AudioSource &audioSource, const quint32 sampleRate);
+	virtual ~AudioStream();
 	virtual quint64 estimateMIDITimestamp(const MasterClockNanos refNanos);
+	// Returns the current time of the clock MIDI events are timestamped against, which is normally the MasterClock.
+	virtual MasterClockNanos getMIDIClockNanos();
+	// Informs the stream that the caller isn't going to push MIDI events timestamped earlier than midiNanos.
+	// Returns true if the stream makes use of it to render ahead of realtime, so the MIDI clock may run faster.
+	virtual bool reportMIDIProgress(const MasterClockNanos midiNanos);
 	quint64 computeMIDITimestamp(uint relativeFrameTime) const;
+	// Intended to be called from the GUI thread.
+	void getRenderTimingStats(RenderTimingStats &stats) const;
+	const AudioDriverSettings &getSettings() const;
+	quint32 getSampleRate() const;
+	virtual void setOnsetDetectionEnabled(bool enabled);
+	// Returns the estimated time when the last note onset detected in the output is played by the audio device,
+	// or 0 if there was none since the detection was enabled. Safe to call from any thread.
+	virtual MasterClockNanos getLastOnsetNanos() const;
 };
 
 class AudioDevice {
@@ -60,7 +144,13 @@ public:
 
 	AudioDevice(AudioDriver &driver, const QString name);
 	virtual ~AudioDevice() {}
-	virtual AudioStream *startAudioStream(SynthRoute &synthRoute, const uint sampleRate) const = 0;
+	virtual AudioStream *startAudioStream(AudioSource &audioSource, const uint sampleRate) const = 0;
+	// Returns false if the streams of this device must not be mixed together with an AudioMixer.
+	virtual bool isMixingSupported() const { return true; }
+	// Returns the sample rate closest to the desired one that the device plays without resampling in the audio system,
+	// or 0 if it cannot be found out. Used when the sample rate is left at the default, so that the synth output goes
+	// to the device unconverted whenever the hardware supports the native rate of the synth.
+	virtual uint negotiateSampleRate(const uint /* desiredSampleRate */) const { return 0; }
 };
 
 Q_DECLARE_METATYPE(const AudioDevice *)
@@ -18,14 +18,15 @@
 
 #include "AudioFileWriterDriver.h"
 
+#include "../Master.h"
 #include "../MasterClock.h"
 #include "../SynthRoute.h"
 
 static const unsigned int DEFAULT_AUDIO_LATENCY = 150;
 static const unsigned int DEFAULT_MIDI_LATENCY = 200;
 
-AudioFileWriterStream::AudioFileWriterStream(const AudioDriverSettings &useSettings, SynthRoute &useSynthRoute, const quint32 useSampleRate) :
-	AudioStream(useSettings, useSynthRoute, useSampleRate) {}
+AudioFileWriterStream::AudioFileWriterStream(const AudioDriverSettings &useSettings, AudioSource &useAudioSource, const quint32 useSampleRate, bool useFreeRunning) :
+	AudioStream(useSettings, useAudioSource, useSampleRate), freeRunning(useFreeRunning), midiProgressNanos(0) {}
 
 bool AudioFileWriterStream::start() {
 	static QString currentDir = NULL;
@@ -33,17 +34,18 @@ bool AudioFileWriterStream::start() {
 	if (fileName.isEmpty()) return false;
 	currentDir = QDir(fileName).absolutePath();
 	timeInfos[0].lastPlayedNanos = MasterClock::getClockNanos();
+	midiProgressNanos = timeInfos[0].lastPlayedNanos;
 	writer.startRealtimeProcessing(this, sampleRate, fileName, audioLatencyFrames);
 	return true;
 }
 
 void AudioFileWriterStream::audioStreamFailed() {
-	synthRoute.audioStreamFailed();
+	audioSource.audioStreamFailed();
 }
 
 void AudioFileWriterStream::render(qint16 *buffer, uint frameCount) {
 	// No need to update time info, we assume perfect timing.
-	synthRoute.render(buffer, frameCount);
+	audioSource.render(buffer, frameCount);
 	framesRendered(frameCount);
 }
 
@@ -52,11 +54,45 @@ quint64 AudioFileWriterStream::estimateMIDITimestamp(const MasterClockNanos midi
 	return quint64(((midiNanos - timeInfos[0].lastPlayedNanos) * sampleRate) / MasterClock::NANOS_PER_SECOND) + midiLatencyFrames;
 }
 
+// In the free-running mode, the MIDI clock follows the rendered frames rather than the MasterClock.
+// MIDI events pushed at this time or later are timestamped no earlier than the frames yet to render.
+MasterClockNanos AudioFileWriterStream::getMIDIClockNanos() {
+	if (!freeRunning) return AudioStream::getMIDIClockNanos();
+	qint64 midiClockFrames = qint64(takeRenderedFramesCountSnapshot()) - qint64(midiLatencyFrames);
+	return timeInfos[0].lastPlayedNanos + (midiClockFrames * MasterClock::NANOS_PER_SECOND) / sampleRate;
+}
+
+bool AudioFileWriterStream::reportMIDIProgress(const MasterClockNanos midiNanos) {
+	if (!freeRunning) return false;
+	QMutexLocker midiProgressLocker(&midiProgressMutex);
+	if (midiProgressNanos < midiNanos) midiProgressNanos = midiNanos;
+	return true;
+}
+
+bool AudioFileWriterStream::isFreeRunning() const {
+	return freeRunning;
+}
+
+// Only called from the rendering thread.
+// Returns the number of frames that can be rendered ahead of realtime, as no more MIDI events are expected to arrive for them.
+quint32 AudioFileWriterStream::getFreeRunningFrameCount() {
+	if (!freeRunning) return 0;
+	MasterClockNanos myMIDIProgressNanos;
+	{
+		QMutexLocker midiProgressLocker(&midiProgressMutex);
+		myMIDIProgressNanos = midiProgressNanos;
+	}
+	qint64 midiProgressFrames = ((myMIDIProgressNanos - timeInfos[0].lastPlayedNanos) * sampleRate) / MasterClock::NANOS_PER_SECOND;
+	qint64 frameCount = midiProgressFrames + qint64(midiLatencyFrames) - qint64(getRenderedFramesCount());
+	return frameCount > 0 ? quint32(frameCount) : 0;
+}
+
 AudioFileWriterDevice::AudioFileWriterDevice(AudioFileWriterDriver &driver, QString useDeviceName) :
 	AudioDevice(driver, useDeviceName) {}
 
-AudioStream *AudioFileWriterDevice::startAudioStream(SynthRoute &synthRoute, const uint sampleRate) const {
-	AudioFileWriterStream *stream = new AudioFileWriterStream(driver.getAudioSettings(), synthRoute, sampleRate);
+AudioStream *AudioFileWriterDevice::startAudioStream(AudioSource &audioSource, const uint sampleRate) const {
+	bool freeRunning = static_cast<AudioFileWriterDriver &>(driver).isFreeRunningModeEnabled();
+	AudioFileWriterStream *stream = new AudioFileWriterStream(driver.getAudioSettings(), audioSource, sampleRate, freeRunning);
 	if (stream->start()) {
 		return stream;
 	}
@@ -64,6 +100,11 @@ AudioStream *AudioFileWriterDevice::startAudioStream(SynthRoute &synthRoute, con
 	return NULL;
 }
 
+// Each stream writes a separate file, besides, the free running mode renders ahead of realtime.
+bool AudioFileWriterDevice::isMixingSupported() const {
+	return false;
+}
+
 AudioFileWriterDriver::AudioFileWriterDriver(Master *master) : AudioDriver("fileWriter", "AudioFileWriter") {
 	Q_UNUSED(master);
 
@@ -76,6 +117,12 @@ const QList<const AudioDevice *> AudioFileWriterDriver::createDeviceList() {
 	return deviceList;
 }
 
+// In the free-running mode, the audio is rendered as fast as the MIDI sources allow, e.g. the internal MIDI player
+// runs as fast as possible. The other MIDI sources still work in realtime.
+bool AudioFileWriterDriver::isFreeRunningModeEnabled() const {
+	return Master::getInstance()->getSettings()->value("Audio/" + id + "/FreeRunning", false).toBool();
+}
+
 void AudioFileWriterDriver::validateAudioSettings(AudioDriverSettings &settings) const {
 	if (settings.midiLatency == 0) {
 		settings.midiLatency = DEFAULT_MIDI_LATENCY;
@@ -7,20 +7,26 @@
 #include "../AudioFileWriter.h"
 
 class Master;
-class SynthRoute;
 class AudioFileWriterDriver;
 class AudioFileWriterDevice;
 
 class AudioFileWriterStream : public AudioStream {
 private:
 	AudioFileRenderer writer;
+	const bool freeRunning;
+	QMutex midiProgressMutex;
+	MasterClockNanos midiProgressNanos;
 
 public:
-	AudioFileWriterStream(const AudioDriverSettings &settings, SynthRoute &useSynthRoute, const quint32 useSampleRate);
+	AudioFileWriterStream(const AudioDriverSettings &settings, AudioSource &useAudioSource, const quint32 useSampleRate, bool freeRunning);
 	quint64 estimateMIDITimestamp(const MasterClockNanos refNanos);
+	MasterClockNanos getMIDIClockNanos();
+	bool reportMIDIProgress(const MasterClockNanos midiNanos);
 	bool start();
 	void audioStreamFailed();
 	void render(qint16 *buffer, uint frameCount);
+	bool isFreeRunning() const;
+	quint32 getFreeRunningFrameCount();
 };
 
 class AudioFileWriterDevice : public AudioDevice {
@@ -28,7 +34,8 @@ friend class AudioFileWriterDriver;
 private:
 	AudioFileWriterDevice(AudioFileWriterDriver &driver, QString useDeviceName);
 public:
-	AudioStream *startAudioStream(SynthRoute &synthRoute, const uint sampleRate) const;
+	AudioStream *startAudioStream(AudioSource &audioSource, const uint sampleRate) const;
+	bool isMixingSupported() const;
 };
 
 class AudioFileWriterDriver : public AudioDriver {
@@ -37,6 +44,7 @@ private:
 public:
 	AudioFileWriterDriver(Master *useMaster);
 	const QList<const AudioDevice *> createDeviceList();
+	bool isFreeRunningModeEnabled() const;
 };
 
 #endif
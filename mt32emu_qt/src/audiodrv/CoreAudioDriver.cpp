@@ -16,6 +16,8 @@
 
 #include "CoreAudioDriver.h"
 
+#include <CoreAudio/HostTime.h>
+
 #include "../Master.h"
 #include "../SynthRoute.h"
 
@@ -53,8 +55,8 @@ static QString cfStringToQString(CFStringRef string) {
 #endif
 }
 
-CoreAudioStream::CoreAudioStream(const AudioDriverSettings &useSettings, SynthRoute &useSynthRoute, quint32 useSampleRate) :
-	AudioStream(useSettings, useSynthRoute, useSampleRate), audioQueue(NULL)
+CoreAudioStream::CoreAudioStream(const AudioDriverSettings &useSettings, AudioSource &useAudioSource, quint32 useSampleRate) :
+	AudioStream(useSettings, useAudioSource, useSampleRate), audioQueue(NULL)
 {
 	const uint bufferSize = (settings.chunkLen * sampleRate) / MasterClock::MILLIS_PER_SECOND;
 	bufferByteSize = bufferSize << 2;
@@ -163,11 +165,159 @@ void CoreAudioStream::close() {
 	audioQueue = NULL;
 }
 
+static bool findDeviceID(const QString deviceUid, AudioDeviceID &deviceID) {
+	CFStringRef deviceUidRef = qStringToCFString(deviceUid);
+	AudioValueTranslation translation = {&deviceUidRef, sizeof(CFStringRef), &deviceID, sizeof(AudioDeviceID)};
+	AudioObjectPropertyAddress propertyAddress;
+	propertyAddress.mSelector = kAudioHardwarePropertyDeviceForUID;
+	propertyAddress.mScope = kAudioObjectPropertyScopeGlobal;
+	propertyAddress.mElement = kAudioObjectPropertyElementMaster;
+	UInt32 propertySize = sizeof(AudioValueTranslation);
+	deviceID = kAudioDeviceUnknown;
+	OSStatus res = AudioObjectGetPropertyData(kAudioObjectSystemObject, &propertyAddress, 0, NULL, &propertySize, &translation);
+	CFRelease(deviceUidRef);
+	if (res) qDebug() << "CoreAudio: Failed to find audio output device" << deviceUid << "error code:" << res;
+	return res == noErr && deviceID != kAudioDeviceUnknown;
+}
+
+CoreAudioUnitStream::CoreAudioUnitStream(const AudioDriverSettings &useSettings, AudioSource &useAudioSource, quint32 useSampleRate) :
+	AudioStream(useSettings, useAudioSource, useSampleRate), audioUnit(NULL)
+{}
+
+CoreAudioUnitStream::~CoreAudioUnitStream() {
+	close();
+}
+
+OSStatus CoreAudioUnitStream::renderCallback(void *userData, AudioUnitRenderActionFlags *actionFlags, const AudioTimeStamp *timeStamp, UInt32 busNumber, UInt32 frameCount, AudioBufferList *bufferList) {
+	Q_UNUSED(actionFlags);
+	Q_UNUSED(busNumber);
+
+	CoreAudioUnitStream *stream = (CoreAudioUnitStream *)userData;
+	const MasterClockNanos nanosNow = MasterClock::getClockNanos();
+	quint32 framesInAudioBuffer = 0;
+	if (stream->settings.advancedTiming && (timeStamp->mFlags & kAudioTimeStampHostTimeValid)) {
+		// The host time stamp refers to the moment the first frame of this buffer is going to be played.
+		UInt64 hostTimeNow = AudioGetCurrentHostTime();
+		if (timeStamp->mHostTime > hostTimeNow) {
+			UInt64 nanosToPlayback = AudioConvertHostTimeToNanos(timeStamp->mHostTime - hostTimeNow);
+			framesInAudioBuffer = quint32((nanosToPlayback * stream->sampleRate) / MasterClock::NANOS_PER_SECOND);
+		}
+	}
+	stream->renderAndUpdateState((MT32Emu::Bit16s *)bufferList->mBuffers[0].mData, frameCount, nanosNow, framesInAudioBuffer);
+	return noErr;
+}
+
+bool CoreAudioUnitStream::start(const QString deviceUid) {
+	if (audioUnit != NULL) {
+		return true;
+	}
+
+	AudioComponentDescription description = {kAudioUnitType_Output, deviceUid.isEmpty() ? kAudioUnitSubType_DefaultOutput : kAudioUnitSubType_HALOutput, kAudioUnitManufacturer_Apple, 0, 0};
+	AudioComponent component = AudioComponentFindNext(NULL, &description);
+	if (component == NULL) {
+		qDebug() << "CoreAudio: Output audio unit not found";
+		return false;
+	}
+	OSStatus res = AudioComponentInstanceNew(component, &audioUnit);
+	if (res || audioUnit == NULL) {
+		qDebug() << "CoreAudio: AudioComponentInstanceNew() failed with error code:" << res;
+		audioUnit = NULL;
+		return false;
+	}
+
+	if (!deviceUid.isEmpty()) {
+		AudioDeviceID deviceID;
+		if (!findDeviceID(deviceUid, deviceID)) {
+			dispose();
+			return false;
+		}
+		res = AudioUnitSetProperty(audioUnit, kAudioOutputUnitProperty_CurrentDevice, kAudioUnitScope_Global, 0, &deviceID, sizeof(AudioDeviceID));
+		if (res) {
+			qDebug() << "CoreAudio: Setting audio output device failed with error code:" << res;
+			dispose();
+			return false;
+		}
+		qDebug() << "CoreAudio: Using audio output device:" << deviceUid;
+	} else {
+		qDebug() << "CoreAudio: Using default audio output device";
+	}
+
+	AudioStreamBasicDescription dataFormat = {(Float64)sampleRate, kAudioFormatLinearPCM, kAudioFormatFlagsNativeEndian | kAudioFormatFlagIsSignedInteger | kAudioFormatFlagIsPacked, 4, 1, 4, 2, 16, 0};
+	res = AudioUnitSetProperty(audioUnit, kAudioUnitProperty_StreamFormat, kAudioUnitScope_Input, 0, &dataFormat, sizeof(AudioStreamBasicDescription));
+	if (res) {
+		qDebug() << "CoreAudio: Setting stream format failed with error code:" << res;
+		dispose();
+		return false;
+	}
+
+	// The I/O buffer size is only a request, the device may choose a different one, especially when shared.
+	UInt32 bufferFrameSize = (settings.chunkLen * sampleRate) / MasterClock::MILLIS_PER_SECOND;
+	res = AudioUnitSetProperty(audioUnit, kAudioDevicePropertyBufferFrameSize, kAudioUnitScope_Global, 0, &bufferFrameSize, sizeof(UInt32));
+	if (res) qDebug() << "CoreAudio: Setting I/O buffer size failed with error code:" << res;
+	UInt32 propertySize = sizeof(UInt32);
+	res = AudioUnitGetProperty(audioUnit, kAudioDevicePropertyBufferFrameSize, kAudioUnitScope_Global, 0, &bufferFrameSize, &propertySize);
+	if (res) qDebug() << "CoreAudio: Getting I/O buffer size failed with error code:" << res;
+
+	AURenderCallbackStruct renderCallbackStruct = {renderCallback, this};
+	res = AudioUnitSetProperty(audioUnit, kAudioUnitProperty_SetRenderCallback, kAudioUnitScope_Input, 0, &renderCallbackStruct, sizeof(AURenderCallbackStruct));
+	if (res) {
+		qDebug() << "CoreAudio: Setting render callback failed with error code:" << res;
+		dispose();
+		return false;
+	}
+
+	res = AudioUnitInitialize(audioUnit);
+	if (res) {
+		qDebug() << "CoreAudio: AudioUnitInitialize() failed with error code:" << res;
+		dispose();
+		return false;
+	}
+
+	// The rendered buffer is played after the one currently being played, so two I/O buffers are in flight.
+	audioLatencyFrames = bufferFrameSize << 1;
+	qDebug() << "CoreAudio: Using output audio unit, I/O buffer size:" << bufferFrameSize << "frames, audio latency:" << audioLatencyFrames << "frames.";
+
+	// Setup initial MIDI latency
+	if (isAutoLatencyMode()) midiLatencyFrames = audioLatencyFrames + ((DEFAULT_MIDI_LATENCY * sampleRate) / MasterClock::MILLIS_PER_SECOND);
+	qDebug() << "CoreAudio: total MIDI latency:" << midiLatencyFrames << "frames";
+
+	res = AudioOutputUnitStart(audioUnit);
+	if (res) {
+		qDebug() << "CoreAudio: AudioOutputUnitStart() failed with error code:" << res;
+		AudioUnitUninitialize(audioUnit);
+		dispose();
+		return false;
+	}
+
+	return true;
+}
+
+void CoreAudioUnitStream::dispose() {
+	OSStatus res = AudioComponentInstanceDispose(audioUnit);
+	if (res) qDebug() << "CoreAudio: AudioComponentInstanceDispose() failed with error code" << res;
+	audioUnit = NULL;
+}
+
+void CoreAudioUnitStream::close() {
+	if (audioUnit == NULL) return;
+	OSStatus res = AudioOutputUnitStop(audioUnit);
+	if (res) qDebug() << "CoreAudio: AudioOutputUnitStop() failed with error code" << res;
+	res = AudioUnitUninitialize(audioUnit);
+	if (res) qDebug() << "CoreAudio: AudioUnitUninitialize() failed with error code" << res;
+	dispose();
+}
+
 CoreAudioDevice::CoreAudioDevice(CoreAudioDriver &driver, const QString uid, const QString name) :
 	AudioDevice(driver, name), uid(uid) {}
 
-AudioStream *CoreAudioDevice::startAudioStream(SynthRoute &synthRoute, const uint sampleRate) const {
-	CoreAudioStream *stream = new CoreAudioStream(driver.getAudioSettings(), synthRoute, sampleRate);
+AudioStream *CoreAudioDevice::startAudioStream(AudioSource &audioSource, const uint sampleRate) const {
+	CoreAudioUnitStream *audioUnitStream = new CoreAudioUnitStream(driver.getAudioSettings(), audioSource, sampleRate);
+	if (audioUnitStream->start(uid)) {
+		return (AudioStream *)audioUnitStream;
+	}
+	delete audioUnitStream;
+	qDebug() << "CoreAudio: Falling back to audio queue output";
+	CoreAudioStream *stream = new CoreAudioStream(driver.getAudioSettings(), audioSource, sampleRate);
 	if (stream->start(uid)) {
 		return (AudioStream *)stream;
 	}
@@ -2,11 +2,11 @@
 #define CORE_AUDIO_DRIVER_H
 
 #include <AudioToolbox/AudioQueue.h>
+#include <AudioUnit/AudioUnit.h>
 #include <CoreAudio/AudioHardware.h>
 
 #include "AudioDriver.h"
 
-class SynthRoute;
 class Master;
 class CoreAudioDriver;
 
@@ -20,12 +20,29 @@ private:
 	static void renderOutputBuffer(void *userData, AudioQueueRef queue, AudioQueueBufferRef buffer);
 
 public:
-	CoreAudioStream(const AudioDriverSettings &settings, SynthRoute &synthRoute, const quint32 sampleRate);
+	CoreAudioStream(const AudioDriverSettings &settings, AudioSource &audioSource, const quint32 sampleRate);
 	~CoreAudioStream();
 	bool start(const QString deviceUid);
 	void close();
 };
 
+// Renders straight into the buffers of the HAL output unit, whose I/O buffer size is set from the chunk length.
+// The host time of each render callback tells when the rendered frames are going to be played.
+class CoreAudioUnitStream : public AudioStream {
+private:
+	AudioUnit audioUnit;
+
+	static OSStatus renderCallback(void *userData, AudioUnitRenderActionFlags *actionFlags, const AudioTimeStamp *timeStamp, UInt32 busNumber, UInt32 frameCount, AudioBufferList *bufferList);
+
+	void dispose();
+
+public:
+	CoreAudioUnitStream(const AudioDriverSettings &settings, AudioSource &audioSource, const quint32 sampleRate);
+	~CoreAudioUnitStream();
+	bool start(const QString deviceUid);
+	void close();
+};
+
 class CoreAudioDevice : public AudioDevice {
 friend class CoreAudioDriver;
 private:
@@ -34,7 +51,7 @@ private:
 	CoreAudioDevice(CoreAudioDriver &driver, const QString uid = NULL, const QString name = "Default output device");
 
 public:
-	AudioStream *startAudioStream(SynthRoute &synthRoute, const uint sampleRate) const;
+	AudioStream *startAudioStream(AudioSource &audioSource, const uint sampleRate) const;
 };
 
 class CoreAudioDriver : public AudioDriver {
@@ -22,13 +22,14 @@
 #include "../QSynth.h"
 #include "../JACKClient.h"
 #include "../QRingBuffer.h"
+#include "../Tracer.h"
 
 static const uint CHANNEL_COUNT = 2;
 static const uint MINIMUM_JACK_BUFFER_COUNT = 2;
 static const uint FRAME_BYTE_SIZE = sizeof(float[CHANNEL_COUNT]);
 
 class JACKAudioProcessor : QThread {
-	SynthRoute &synthRoute;
+	AudioSource &audioSource;
 	Utility::QRingBuffer *buffer;
 	volatile bool stopProcessing;
 
@@ -63,15 +64,15 @@ class JACKAudioProcessor : QThread {
 			if (framesToRender == 0) {
 				bufferDataRetrievals.acquire(currentRetrievals + 1);
 			} else {
-				synthRoute.render(writePointer, framesToRender);
+				audioSource.render(writePointer, framesToRender);
 				buffer->advanceWritePointer(framesToRender * FRAME_BYTE_SIZE);
 			}
 		}
 	}
 
 public:
-	JACKAudioProcessor(SynthRoute &useSynthRoute) :
-		synthRoute(useSynthRoute),
+	JACKAudioProcessor(AudioSource &useAudioSource) :
+		audioSource(useAudioSource),
 		buffer(),
 		stopProcessing(),
 		pendingUpdateBufferSize()
@@ -124,10 +125,9 @@ public:
 	}
 };
 
-JACKAudioStream::JACKAudioStream(const AudioDriverSettings &useSettings, SynthRoute &useSynthRoute, const quint32 useSampleRate) :
-	AudioStream(useSettings, useSynthRoute, useSampleRate),
+JACKAudioStream::JACKAudioStream(const AudioDriverSettings &useSettings, AudioSource &useAudioSource, const quint32 useSampleRate) :
+	AudioStream(useSettings, useAudioSource, useSampleRate),
 	jackClient(new JACKClient),
-	buffer(),
 	processor(),
 	configuredAudioLatencyFrames(audioLatencyFrames)
 {}
@@ -135,11 +135,10 @@ JACKAudioStream::JACKAudioStream(const AudioDriverSettings &useSettings, SynthRo
 JACKAudioStream::~JACKAudioStream() {
 	stop();
 	delete jackClient;
-	delete[] buffer;
 	delete processor;
 }
 
-bool JACKAudioStream::start(MidiSession *midiSession) {
+bool JACKAudioStream::start(MidiSession *midiSession, bool directRendering) {
 	JACKClientState state = jackClient->open(midiSession, this);
 	if (JACKClientState_OPEN != state) {
 		qDebug() << "JACKAudioDriver: Failed to open JACK client connection";
@@ -150,11 +149,11 @@ bool JACKAudioStream::start(MidiSession *midiSession) {
 	const quint32 jackBufferSizeFrames = jackClient->getBufferSize();
 	qDebug() << "JACKAudioDriver: JACK reported initial audio buffer size (frames / s):"
 		<< jackBufferSizeFrames << "/" << double(jackBufferSizeFrames) / sampleRate;
-	if (midiSession == NULL && jackClient->isRealtimeProcessing()) {
+	if (midiSession == NULL && jackClient->isRealtimeProcessing() && !directRendering) {
 		// Use prerendering to prevent the realtime thread from locking, yet to retain complete functionality.
 		// Additional latency of at least the JACK buffer length is introduced.
 		if (audioLatencyFrames < jackBufferSizeFrames) audioLatencyFrames = jackBufferSizeFrames;
-		processor = new JACKAudioProcessor(synthRoute);
+		processor = new JACKAudioProcessor(audioSource);
 		processor->reallocateBuffer(audioLatencyFrames);
 		processor->start();
 		qDebug() << "JACKAudioDriver: Configured prerendering audio buffer size (frames / s):"
@@ -162,10 +161,16 @@ bool JACKAudioStream::start(MidiSession *midiSession) {
 	} else {
 		// Rendering is synchronous, zero additional latency introduced.
 		audioLatencyFrames = 0;
-		buffer = new float[CHANNEL_COUNT * MT32Emu::MAX_SAMPLES_PER_RUN];
 	}
 
 	if (midiSession == NULL) {
+		if (directRendering && jackClient->isRealtimeProcessing()) {
+			// The MIDI events from all the sources are collected in lock-free buffers and merged
+			// in the process callback, so that the realtime thread never blocks.
+			audioSource.enableRealtimeMode();
+			audioSource.enableMultiMidiMode();
+			qDebug() << "JACKAudioDriver: Configured direct rendering in the process callback";
+		}
 		// Setup initial MIDI latency
 		if (isAutoLatencyMode()) midiLatencyFrames = audioLatencyFrames + MINIMUM_JACK_BUFFER_COUNT * jackBufferSizeFrames;
 		qDebug() << "JACKAudioDriver: Configured MIDI latency (frames / s):" << midiLatencyFrames
@@ -174,7 +179,7 @@ bool JACKAudioStream::start(MidiSession *midiSession) {
 		// MIDI processing is synchronous, zero latency introduced
 		midiLatencyFrames = 0;
 		qDebug() << "JACKAudioDriver: Configured synchronous MIDI processing";
-		if (jackClient->isRealtimeProcessing()) synthRoute.enableRealtimeMode();
+		if (jackClient->isRealtimeProcessing()) audioSource.enableRealtimeMode();
 	}
 
 	return true;
@@ -210,10 +215,11 @@ void JACKAudioStream::onJACKBufferSizeChange(const quint32 newBufferSize) {
 
 void JACKAudioStream::onJACKShutdown() {
 	qDebug() << "JACKAudioDriver: JACK server is shutting down, closing synth";
-	synthRoute.audioStreamFailed();
+	audioSource.audioStreamFailed();
 }
 
 void JACKAudioStream::renderStreams(const quint32 totalFrameCount, JACKAudioSample *leftOutBuffer, JACKAudioSample *rightOutBuffer) {
+	TraceScope traceScope("JACKAudioStream::renderStreams", totalFrameCount);
 	// Only bother with updating TimeInfo when MIDI processing is asynchronous
 	if (midiLatencyFrames != 0) {
 		quint32 framesInAudioBuffer;
@@ -224,45 +230,56 @@ void JACKAudioStream::renderStreams(const quint32 totalFrameCount, JACKAudioSamp
 		}
 		updateTimeInfo(MasterClock::getClockNanos(), framesInAudioBuffer);
 	}
+	MasterClockNanos renderStartNanos = MasterClock::getClockNanos();
 	for (quint32 framesLeft = totalFrameCount; framesLeft > 0;) {
-		float *bufferPtr;
 		uint framesToRender;
 		if (processor != NULL) {
 			framesToRender = framesLeft;
-			bufferPtr = processor->getAvailableChunk(framesToRender);
+			float *bufferPtr = processor->getAvailableChunk(framesToRender);
 			if (framesToRender == 0) {
 				for (JACKAudioSample *leftOutBufferEnd = leftOutBuffer + framesLeft; leftOutBuffer < leftOutBufferEnd;) {
 					*(leftOutBuffer++) = 0;
 					*(rightOutBuffer++) = 0;
 				}
+				// The prerendering thread didn't keep up.
+				pendingUnderrunCount++;
+				updateRenderTimingStats(totalFrameCount, renderStartNanos, MasterClock::getClockNanos());
 				return;
 			}
+			for (JACKAudioSample *leftOutBufferEnd = leftOutBuffer + framesToRender; leftOutBuffer < leftOutBufferEnd;) {
+				*(leftOutBuffer++) = JACKAudioSample(*(bufferPtr++));
+				*(rightOutBuffer++) = JACKAudioSample(*(bufferPtr++));
+			}
+			processor->markChunkProcessed(framesToRender);
 		} else {
-			bufferPtr = buffer;
+			// Synchronous rendering goes straight to the port buffers, which are planar
 			framesToRender = qMin(framesLeft, MT32Emu::MAX_SAMPLES_PER_RUN);
-			synthRoute.render(buffer, framesToRender);
+			audioSource.render(leftOutBuffer, rightOutBuffer, framesToRender);
+			leftOutBuffer += framesToRender;
+			rightOutBuffer += framesToRender;
 		}
-		for (JACKAudioSample *leftOutBufferEnd = leftOutBuffer + framesToRender; leftOutBuffer < leftOutBufferEnd;) {
-			*(leftOutBuffer++) = JACKAudioSample(*(bufferPtr++));
-			*(rightOutBuffer++) = JACKAudioSample(*(bufferPtr++));
-		}
-		if (processor != NULL) processor->markChunkProcessed(framesToRender);
 		framesLeft -= framesToRender;
 	}
 	framesRendered(totalFrameCount);
+	updateRenderTimingStats(totalFrameCount, renderStartNanos, MasterClock::getClockNanos());
 }
 
 JACKAudioDefaultDevice::JACKAudioDefaultDevice(JACKAudioDriver &useDriver) :
 	AudioDevice(useDriver, "Default")
 {}
 
-AudioStream *JACKAudioDefaultDevice::startAudioStream(SynthRoute &synthRoute, const uint sampleRate) const {
-	return startAudioStream(this, synthRoute, sampleRate, NULL);
+uint JACKAudioDefaultDevice::negotiateSampleRate(const uint) const {
+	return JACKClient::getSystemSampleRate();
 }
 
-AudioStream *JACKAudioDefaultDevice::startAudioStream(const AudioDevice *audioDevice, SynthRoute &synthRoute, const uint sampleRate, MidiSession *midiSession) {
-	JACKAudioStream *stream = new JACKAudioStream(audioDevice->driver.getAudioSettings(), synthRoute, sampleRate);
-	if (stream->start(midiSession)) return stream;
+AudioStream *JACKAudioDefaultDevice::startAudioStream(AudioSource &audioSource, const uint sampleRate) const {
+	return startAudioStream(this, audioSource, sampleRate, NULL);
+}
+
+AudioStream *JACKAudioDefaultDevice::startAudioStream(const AudioDevice *audioDevice, AudioSource &audioSource, const uint sampleRate, MidiSession *midiSession) {
+	bool directRendering = static_cast<const JACKAudioDriver &>(audioDevice->driver).isDirectRenderingEnabled();
+	JACKAudioStream *stream = new JACKAudioStream(audioDevice->driver.getAudioSettings(), audioSource, sampleRate);
+	if (stream->start(midiSession, directRendering)) return stream;
 	delete stream;
 	return NULL;
 }
@@ -279,6 +296,13 @@ const QList<const AudioDevice *> JACKAudioDriver::createDeviceList() {
 	return deviceList;
 }
 
+// In the direct rendering mode, the synth renders straight into the port buffers in the JACK process callback
+// even when the MIDI events come from other sources than a JACK MIDI port of the same client. This avoids
+// the prerendering thread and the additional audio latency of at least one JACK period it introduces.
+bool JACKAudioDriver::isDirectRenderingEnabled() const {
+	return Master::getInstance()->getSettings()->value("Audio/" + id + "/DirectRendering", false).toBool();
+}
+
 void JACKAudioDriver::validateAudioSettings(AudioDriverSettings &newSettings) const {
 	newSettings.chunkLen = 0;
 }
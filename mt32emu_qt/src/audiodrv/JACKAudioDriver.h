@@ -8,7 +8,6 @@
 typedef float JACKAudioSample;
 
 class Master;
-class SynthRoute;
 class JACKClient;
 class JACKAudioDriver;
 class JACKAudioProcessor;
@@ -16,9 +15,9 @@ class MidiSession;
 
 class JACKAudioStream : public AudioStream {
 public:
-	JACKAudioStream(const AudioDriverSettings &useSettings, SynthRoute &synthRoute, const quint32 useSampleRate);
+	JACKAudioStream(const AudioDriverSettings &useSettings, AudioSource &audioSource, const quint32 useSampleRate);
 	~JACKAudioStream();
-	bool start(MidiSession *midiSession);
+	bool start(MidiSession *midiSession, bool directRendering);
 	void stop();
 	bool checkSampleRate(quint32 sampleRate) const;
 	void onJACKBufferSizeChange(const quint32 bufferSize);
@@ -27,7 +26,6 @@ public:
 
 private:
 	JACKClient * const jackClient;
-	float *buffer;
 	JACKAudioProcessor *processor;
 	const quint32 configuredAudioLatencyFrames;
 };
@@ -35,9 +33,11 @@ private:
 class JACKAudioDefaultDevice : public AudioDevice {
 	friend class JACKAudioDriver;
 public:
-	static AudioStream *startAudioStream(const AudioDevice *audioDevice, SynthRoute &synthRoute, const uint sampleRate, MidiSession *midiSession);
+	static AudioStream *startAudioStream(const AudioDevice *audioDevice, AudioSource &audioSource, const uint sampleRate, MidiSession *midiSession);
 
-	AudioStream *startAudioStream(SynthRoute &synthRoute, const uint sampleRate) const;
+	AudioStream *startAudioStream(AudioSource &audioSource, const uint sampleRate) const;
+	// The JACK server runs at a single system sample rate, which the stream must use.
+	uint negotiateSampleRate(const uint desiredSampleRate) const;
 
 private:
 	JACKAudioDefaultDevice(JACKAudioDriver &driver);
@@ -47,6 +47,7 @@ class JACKAudioDriver : public AudioDriver {
 public:
 	JACKAudioDriver(Master *useMaster);
 	const QList<const AudioDevice *> createDeviceList();
+	bool isDirectRenderingEnabled() const;
 
 private:
 	void validateAudioSettings(AudioDriverSettings &settings) const;
@@ -34,8 +34,8 @@ static const unsigned int DEFAULT_AUDIO_LATENCY = 32;
 static const unsigned int DEFAULT_MIDI_LATENCY = 16;
 static const char deviceName[] = "/dev/dsp";
 
-OSSAudioStream::OSSAudioStream(const AudioDriverSettings &useSettings, SynthRoute &useSynthRoute, const quint32 useSampleRate) :
-	AudioStream(useSettings, useSynthRoute, useSampleRate), buffer(NULL), stream(0), processingThreadID(0), stopProcessing(false)
+OSSAudioStream::OSSAudioStream(const AudioDriverSettings &useSettings, AudioSource &useAudioSource, const quint32 useSampleRate) :
+	AudioStream(useSettings, useAudioSource, useSampleRate), buffer(NULL), stream(0), processingThreadID(0), stopProcessing(false)
 {
 	bufferSize = settings.chunkLen * sampleRate / MasterClock::MILLIS_PER_SECOND;
 }
@@ -79,7 +79,7 @@ void *OSSAudioStream::processingThread(void *userData) {
 	if (isErrorOccured) {
 		close(audioStream.stream);
 		audioStream.stream = 0;
-		audioStream.synthRoute.audioStreamFailed();
+		audioStream.audioSource.audioStreamFailed();
 	} else {
 		audioStream.stopProcessing = false;
 	}
@@ -230,8 +230,8 @@ void OSSAudioStream::stop() {
 
 OSSAudioDefaultDevice::OSSAudioDefaultDevice(OSSAudioDriver &driver) : AudioDevice(driver, "Default") {}
 
-AudioStream *OSSAudioDefaultDevice::startAudioStream(SynthRoute &synthRoute, const uint sampleRate) const {
-	OSSAudioStream *stream = new OSSAudioStream(driver.getAudioSettings(), synthRoute, sampleRate);
+AudioStream *OSSAudioDefaultDevice::startAudioStream(AudioSource &audioSource, const uint sampleRate) const {
+	OSSAudioStream *stream = new OSSAudioStream(driver.getAudioSettings(), audioSource, sampleRate);
 	if (stream->start()) return stream;
 	delete stream;
 	return NULL;
@@ -8,7 +8,6 @@
 #include "AudioDriver.h"
 
 class Master;
-class SynthRoute;
 class OSSAudioDriver;
 
 class OSSAudioStream : public AudioStream {
@@ -22,7 +21,7 @@ private:
 	static void *processingThread(void *);
 
 public:
-	OSSAudioStream(const AudioDriverSettings &settings, SynthRoute &synthRoute, const quint32 sampleRate);
+	OSSAudioStream(const AudioDriverSettings &settings, AudioSource &audioSource, const quint32 sampleRate);
 	~OSSAudioStream();
 	bool start();
 	void stop();
@@ -32,7 +31,7 @@ class OSSAudioDefaultDevice : public AudioDevice {
 friend class OSSAudioDriver;
 	OSSAudioDefaultDevice(OSSAudioDriver &driver);
 public:
-	AudioStream *startAudioStream(SynthRoute &synthRoute, const uint sampleRate) const;
+	AudioStream *startAudioStream(AudioSource &audioSource, const uint sampleRate) const;
 };
 
 class OSSAudioDriver : public AudioDriver {
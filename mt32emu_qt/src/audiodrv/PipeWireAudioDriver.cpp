@@ -0,0 +1,144 @@
+/* Copyright (C) 2011-2021 Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PipeWireAudioDriver.h"
+
+#include "../Master.h"
+#include "../QSynth.h"
+#include "../PipeWireClient.h"
+#include "../Tracer.h"
+
+static const uint MINIMUM_QUANTUM_COUNT = 2;
+
+PipeWireAudioStream::PipeWireAudioStream(const AudioDriverSettings &useSettings, AudioSource &useAudioSource, const quint32 useSampleRate) :
+	AudioStream(useSettings, useAudioSource, useSampleRate),
+	pipeWireClient(new PipeWireClient),
+	lastQuantum(),
+	sampleRateMismatch()
+{}
+
+PipeWireAudioStream::~PipeWireAudioStream() {
+	stop();
+	delete pipeWireClient;
+}
+
+bool PipeWireAudioStream::start(MidiSession *midiSession) {
+	// The configured audio latency is only requested as the node latency, which the graph quantum is chosen upon.
+	PipeWireClientState state = pipeWireClient->open(midiSession, this, sampleRate, audioLatencyFrames);
+	if (PipeWireClientState_OPEN != state) {
+		qDebug() << "PipeWireAudioDriver: Failed to create PipeWire filter";
+		return false;
+	}
+	lastQuantum = pipeWireClient->getQuantum();
+	qDebug() << "PipeWireAudioDriver: Expected graph quantum (frames / s):" << lastQuantum << "/" << double(lastQuantum) / sampleRate;
+
+	// Rendering is synchronous, zero additional latency introduced.
+	audioLatencyFrames = 0;
+	// The process callback runs in the realtime data thread of the graph, so it must never block.
+	audioSource.enableRealtimeMode();
+	if (midiSession == NULL) {
+		// The MIDI events from all the sources are collected in lock-free buffers and merged in the process callback.
+		audioSource.enableMultiMidiMode();
+		// Setup initial MIDI latency
+		if (isAutoLatencyMode()) midiLatencyFrames = MINIMUM_QUANTUM_COUNT * lastQuantum;
+		qDebug() << "PipeWireAudioDriver: Configured MIDI latency (frames / s):" << midiLatencyFrames
+			<< "/" << double(midiLatencyFrames) / sampleRate;
+	} else {
+		// MIDI processing is synchronous, zero latency introduced
+		midiLatencyFrames = 0;
+		qDebug() << "PipeWireAudioDriver: Configured synchronous MIDI processing";
+	}
+	return true;
+}
+
+void PipeWireAudioStream::stop() {
+	qDebug() << "PipeWireAudioDriver: Stopping PipeWire filter";
+	pipeWireClient->close();
+	qDebug() << "PipeWireAudioDriver: PipeWire filter stopped";
+	if (sampleRateMismatch) {
+		qDebug() << "PipeWireAudioDriver: The graph ran at a sample rate other than" << sampleRate << "Hz, silence was output";
+	}
+}
+
+void PipeWireAudioStream::onPipeWireError() {
+	qDebug() << "PipeWireAudioDriver: PipeWire filter failed, closing synth";
+	audioSource.audioStreamFailed();
+}
+
+void PipeWireAudioStream::renderStreams(const quint32 totalFrameCount, const quint32 graphSampleRate, const MasterClockNanos cycleStartNanos, float *leftOutBuffer, float *rightOutBuffer) {
+	TraceScope traceScope("PipeWireAudioStream::renderStreams", totalFrameCount);
+	if (graphSampleRate != sampleRate) {
+		// The graph may only be switched to the requested rate while idle. Rendering at another rate would alter the pitch.
+		sampleRateMismatch = true;
+		for (float *leftOutBufferEnd = leftOutBuffer + totalFrameCount; leftOutBuffer < leftOutBufferEnd;) {
+			*(leftOutBuffer++) = 0;
+			*(rightOutBuffer++) = 0;
+		}
+		return;
+	}
+	// Only bother with updating TimeInfo when MIDI processing is asynchronous
+	if (midiLatencyFrames != 0) {
+		if (lastQuantum != totalFrameCount) {
+			lastQuantum = totalFrameCount;
+			if (isAutoLatencyMode()) midiLatencyFrames = MINIMUM_QUANTUM_COUNT * totalFrameCount;
+		}
+		// The cycle start time reported by the graph isn't affected by the wakeup jitter of the data thread.
+		updateTimeInfo(settings.advancedTiming ? cycleStartNanos : MasterClock::getClockNanos(), 0U);
+	}
+	MasterClockNanos renderStartNanos = MasterClock::getClockNanos();
+	for (quint32 framesLeft = totalFrameCount; framesLeft > 0;) {
+		// The port buffers are planar
+		uint framesToRender = qMin(framesLeft, MT32Emu::MAX_SAMPLES_PER_RUN);
+		audioSource.render(leftOutBuffer, rightOutBuffer, framesToRender);
+		leftOutBuffer += framesToRender;
+		rightOutBuffer += framesToRender;
+		framesLeft -= framesToRender;
+	}
+	framesRendered(totalFrameCount);
+	updateRenderTimingStats(totalFrameCount, renderStartNanos, MasterClock::getClockNanos());
+}
+
+PipeWireAudioDefaultDevice::PipeWireAudioDefaultDevice(PipeWireAudioDriver &useDriver) :
+	AudioDevice(useDriver, "Default")
+{}
+
+AudioStream *PipeWireAudioDefaultDevice::startAudioStream(AudioSource &audioSource, const uint sampleRate) const {
+	return startAudioStream(this, audioSource, sampleRate, NULL);
+}
+
+AudioStream *PipeWireAudioDefaultDevice::startAudioStream(const AudioDevice *audioDevice, AudioSource &audioSource, const uint sampleRate, MidiSession *midiSession) {
+	PipeWireAudioStream *stream = new PipeWireAudioStream(audioDevice->driver.getAudioSettings(), audioSource, sampleRate);
+	if (stream->start(midiSession)) return stream;
+	delete stream;
+	return NULL;
+}
+
+PipeWireAudioDriver::PipeWireAudioDriver(Master *useMaster) : AudioDriver("pipewire", "PipeWire") {
+	Q_UNUSED(useMaster)
+
+	loadAudioSettings();
+}
+
+const QList<const AudioDevice *> PipeWireAudioDriver::createDeviceList() {
+	QList<const AudioDevice *> deviceList;
+	deviceList.append(new PipeWireAudioDefaultDevice(*this));
+	return deviceList;
+}
+
+void PipeWireAudioDriver::validateAudioSettings(AudioDriverSettings &newSettings) const {
+	// The graph quantum determines the chunk length.
+	newSettings.chunkLen = 0;
+}
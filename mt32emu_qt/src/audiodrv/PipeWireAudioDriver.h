@@ -0,0 +1,50 @@
+#ifndef PIPEWIRE_AUDIO_DRIVER_H
+#define PIPEWIRE_AUDIO_DRIVER_H
+
+#include <QtCore>
+
+#include "AudioDriver.h"
+
+class Master;
+class PipeWireClient;
+class PipeWireAudioDriver;
+class MidiSession;
+
+// Renders directly into the DSP port buffers in the process callback of the PipeWire graph, one quantum at a time.
+// Hence, there is no audio buffering on top of the graph, and the audio latency is governed by the graph quantum.
+class PipeWireAudioStream : public AudioStream {
+public:
+	PipeWireAudioStream(const AudioDriverSettings &useSettings, AudioSource &audioSource, const quint32 useSampleRate);
+	~PipeWireAudioStream();
+	bool start(MidiSession *midiSession);
+	void stop();
+	void onPipeWireError();
+	void renderStreams(const quint32 frameCount, const quint32 graphSampleRate, const MasterClockNanos cycleStartNanos, float *leftOutBuffer, float *rightOutBuffer);
+
+private:
+	PipeWireClient * const pipeWireClient;
+	quint32 lastQuantum;
+	volatile bool sampleRateMismatch;
+};
+
+class PipeWireAudioDefaultDevice : public AudioDevice {
+	friend class PipeWireAudioDriver;
+public:
+	static AudioStream *startAudioStream(const AudioDevice *audioDevice, AudioSource &audioSource, const uint sampleRate, MidiSession *midiSession);
+
+	AudioStream *startAudioStream(AudioSource &audioSource, const uint sampleRate) const;
+
+private:
+	PipeWireAudioDefaultDevice(PipeWireAudioDriver &driver);
+};
+
+class PipeWireAudioDriver : public AudioDriver {
+public:
+	PipeWireAudioDriver(Master *useMaster);
+	const QList<const AudioDevice *> createDeviceList();
+
+private:
+	void validateAudioSettings(AudioDriverSettings &settings) const;
+};
+
+#endif
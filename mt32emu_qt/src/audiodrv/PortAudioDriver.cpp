@@ -57,8 +57,8 @@ static void dumpPortAudioDevices() {
 	}
 }
 
-PortAudioStream::PortAudioStream(const AudioDriverSettings &useSettings, SynthRoute &useSynthRoute, quint32 useSampleRate) :
-  AudioStream(useSettings, useSynthRoute, useSampleRate), stream(NULL) {}
+PortAudioStream::PortAudioStream(const AudioDriverSettings &useSettings, AudioSource &useAudioSource, quint32 useSampleRate) :
+  AudioStream(useSettings, useAudioSource, useSampleRate), stream(NULL) {}
 
 PortAudioStream::~PortAudioStream() {
 	close();
@@ -151,8 +151,8 @@ void PortAudioStream::close() {
 PortAudioDevice::PortAudioDevice(PortAudioDriver &driver, int useDeviceIndex, QString useDeviceName) :
   AudioDevice(driver, useDeviceName), deviceIndex(useDeviceIndex) {}
 
-AudioStream *PortAudioDevice::startAudioStream(SynthRoute &synthRoute, const uint sampleRate) const {
-	PortAudioStream *stream = new PortAudioStream(driver.getAudioSettings(), synthRoute, sampleRate);
+AudioStream *PortAudioDevice::startAudioStream(AudioSource &audioSource, const uint sampleRate) const {
+	PortAudioStream *stream = new PortAudioStream(driver.getAudioSettings(), audioSource, sampleRate);
 	if (stream->start(deviceIndex)) {
 		return stream;
 	}
@@ -163,16 +163,6 @@ AudioStream *PortAudioDevice::startAudioStream(SynthRoute &synthRoute, const uin
 PortAudioDriver::PortAudioDriver(Master *useMaster) : AudioDriver("portaudio", "PortAudio") {
 	Q_UNUSED(useMaster);
 
-	if (!paInitialised) {
-		PaError err = Pa_Initialize();
-		if (err != paNoError) {
-			qDebug() << "Error initializing PortAudio";
-			// FIXME: Do something drastic instead of continuing on happily
-		} else {
-			paInitialised = true;
-		}
-	}
-	dumpPortAudioDevices();
 	loadAudioSettings();
 }
 
@@ -187,7 +177,19 @@ PortAudioDriver::~PortAudioDriver() {
 	}
 }
 
+// PortAudio is initialised along with the first scan of the devices, which runs in background, since probing
+// the host APIs may take a while.
 const QList<const AudioDevice *> PortAudioDriver::createDeviceList() {
+	if (!paInitialised) {
+		PaError err = Pa_Initialize();
+		if (err != paNoError) {
+			qDebug() << "Error initializing PortAudio";
+			// FIXME: Do something drastic instead of continuing on happily
+		} else {
+			paInitialised = true;
+			dumpPortAudioDevices();
+		}
+	}
 	QList<const AudioDevice *> deviceList;
 	PaDeviceIndex deviceCount = paInitialised ? Pa_GetDeviceCount() : 0;
 	if (deviceCount < 0) {
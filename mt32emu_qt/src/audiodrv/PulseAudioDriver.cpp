@@ -14,12 +14,8 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <unistd.h>
-#include <pthread.h>
 #include <dlfcn.h>
 
-#include <pulse/error.h>
-
 #include "PulseAudioDriver.h"
 
 #include "../Master.h"
@@ -29,46 +25,72 @@
 using namespace MT32Emu;
 
 static const int FRAME_SIZE = 4; // Stereo, 16-bit
-static const unsigned int DEFAULT_CHUNK_MS = 10;
-static const unsigned int DEFAULT_AUDIO_LATENCY = 40;
+static const unsigned int DEFAULT_CHUNK_MS = 5;
+static const unsigned int DEFAULT_AUDIO_LATENCY = 20;
 static const unsigned int DEFAULT_MIDI_LATENCY = 20;
 
+// PulseAudio functions in use
+#define PA_FUNCTIONS(PA_FUNCTION) \
+	PA_FUNCTION(pa_threaded_mainloop_new) \
+	PA_FUNCTION(pa_threaded_mainloop_free) \
+	PA_FUNCTION(pa_threaded_mainloop_start) \
+	PA_FUNCTION(pa_threaded_mainloop_stop) \
+	PA_FUNCTION(pa_threaded_mainloop_lock) \
+	PA_FUNCTION(pa_threaded_mainloop_unlock) \
+	PA_FUNCTION(pa_threaded_mainloop_wait) \
+	PA_FUNCTION(pa_threaded_mainloop_signal) \
+	PA_FUNCTION(pa_threaded_mainloop_get_api) \
+	PA_FUNCTION(pa_context_new) \
+	PA_FUNCTION(pa_context_connect) \
+	PA_FUNCTION(pa_context_disconnect) \
+	PA_FUNCTION(pa_context_unref) \
+	PA_FUNCTION(pa_context_get_state) \
+	PA_FUNCTION(pa_context_set_state_callback) \
+	PA_FUNCTION(pa_context_errno) \
+	PA_FUNCTION(pa_stream_new) \
+	PA_FUNCTION(pa_stream_connect_playback) \
+	PA_FUNCTION(pa_stream_disconnect) \
+	PA_FUNCTION(pa_stream_unref) \
+	PA_FUNCTION(pa_stream_get_state) \
+	PA_FUNCTION(pa_stream_set_state_callback) \
+	PA_FUNCTION(pa_stream_set_write_callback) \
+	PA_FUNCTION(pa_stream_set_underflow_callback) \
+	PA_FUNCTION(pa_stream_begin_write) \
+	PA_FUNCTION(pa_stream_cancel_write) \
+	PA_FUNCTION(pa_stream_write) \
+	PA_FUNCTION(pa_stream_get_latency) \
+	PA_FUNCTION(pa_stream_drain) \
+	PA_FUNCTION(pa_operation_get_state) \
+	PA_FUNCTION(pa_operation_unref) \
+	PA_FUNCTION(pa_strerror)
+
 #ifdef USE_PULSEAUDIO_DYNAMIC_LOADING
 
-static const char PA_LIB_NAME[] = "libpulse-simple.so"; // PulseAudio library filename
-static const char PA_LIB_NAME_MAJOR_VERSION[] = "libpulse-simple.so.0"; // PulseAudio library filename with major version appended
+static const char PA_LIB_NAME[] = "libpulse.so"; // PulseAudio library filename
+static const char PA_LIB_NAME_MAJOR_VERSION[] = "libpulse.so.0"; // PulseAudio library filename with major version appended
 
-// Pointers for PulseAudio simple functions
-	static __typeof__ (pa_simple_new) *_pa_simple_new = NULL;
-	static __typeof__ (pa_simple_free) *_pa_simple_free = NULL;
-	static __typeof__ (pa_simple_write) *_pa_simple_write = NULL;
-	static __typeof__ (pa_simple_drain) *_pa_simple_drain = NULL;
-	static __typeof__ (pa_simple_get_latency) *_pa_simple_get_latency = NULL;
-	static __typeof__ (pa_strerror) *_pa_strerror = NULL;
+// Pointers for PulseAudio functions
+#define PA_DECLARE_FUNCTION(name) static __typeof__ (name) *_##name = NULL;
 #else
-	static __typeof__ (pa_simple_new) *_pa_simple_new = pa_simple_new;
-	static __typeof__ (pa_simple_free) *_pa_simple_free = pa_simple_free;
-	static __typeof__ (pa_simple_write) *_pa_simple_write = pa_simple_write;
-	static __typeof__ (pa_simple_drain) *_pa_simple_drain = pa_simple_drain;
-	static __typeof__ (pa_simple_get_latency) *_pa_simple_get_latency = pa_simple_get_latency;
-	static __typeof__ (pa_strerror) *_pa_strerror = pa_strerror;
+#define PA_DECLARE_FUNCTION(name) static __typeof__ (name) *_##name = name;
 #endif
 
+PA_FUNCTIONS(PA_DECLARE_FUNCTION)
+
+#undef PA_DECLARE_FUNCTION
+
 static bool loadLibrary(bool loadNeeded) {
 #ifdef USE_PULSEAUDIO_DYNAMIC_LOADING
 	static void *dlHandle = NULL;
-	char *error;
+	char *error = NULL;
 
 	if (!loadNeeded) {
 		if (dlHandle) {
 			if (dlclose(dlHandle) == 0) {
 				dlHandle = NULL;
-				_pa_simple_new = NULL;
-				_pa_simple_free = NULL;
-				_pa_simple_write = NULL;
-				_pa_simple_drain = NULL;
-				_pa_simple_get_latency = NULL;
-				_pa_strerror = NULL;
+#define PA_RESET_FUNCTION(name) _##name = NULL;
+				PA_FUNCTIONS(PA_RESET_FUNCTION)
+#undef PA_RESET_FUNCTION
 			} else {
 				qDebug() << "PulseAudio library unload failed:" << dlerror();
 			}
@@ -94,28 +116,13 @@ static bool loadLibrary(bool loadNeeded) {
 	}
 
 	// Getting function pointers
-	_pa_simple_new = (__typeof__(_pa_simple_new)) dlsym(dlHandle, "pa_simple_new");
-	error = dlerror();
-	if (!error) {
-		_pa_simple_free = (__typeof__(_pa_simple_free)) dlsym(dlHandle, "pa_simple_free");
-		error = dlerror();
-	}
-	if (!error) {
-		_pa_simple_write = (__typeof__(_pa_simple_write)) dlsym(dlHandle, "pa_simple_write");
-		error = dlerror();
-	}
-	if (!error) {
-		_pa_simple_drain = (__typeof__(_pa_simple_drain)) dlsym(dlHandle, "pa_simple_drain");
-		error = dlerror();
-	}
-	if (!error) {
-		_pa_simple_get_latency = (__typeof__(_pa_simple_get_latency)) dlsym(dlHandle, "pa_simple_get_latency");
-		error = dlerror();
-	}
-	if (!error) {
-		_pa_strerror = (__typeof__(_pa_strerror)) dlsym(dlHandle, "pa_strerror");
-		error = dlerror();
+#define PA_LOAD_FUNCTION(name) \
+	if (!error) { \
+		_##name = (__typeof__(_##name)) dlsym(dlHandle, #name); \
+		error = dlerror(); \
 	}
+	PA_FUNCTIONS(PA_LOAD_FUNCTION)
+#undef PA_LOAD_FUNCTION
 	if (error) {
 		qDebug() << "Failed to get addresses of PulseAudio library functions, dlsym() returned:" << error;
 		loadLibrary(false);
@@ -127,127 +134,212 @@ static bool loadLibrary(bool loadNeeded) {
 	return true;
 }
 
-PulseAudioStream::PulseAudioStream(const AudioDriverSettings &useSettings, SynthRoute &useSynthRoute, const quint32 useSampleRate) :
-	AudioStream(useSettings, useSynthRoute, useSampleRate), stream(NULL), processingThreadID(0), stopProcessing(false)
+PulseAudioStream::PulseAudioStream(const AudioDriverSettings &useSettings, AudioSource &useAudioSource, const quint32 useSampleRate) :
+	AudioStream(useSettings, useAudioSource, useSampleRate), mainloop(NULL), context(NULL), stream(NULL), started(false), stopProcessing(false)
 {
 	bufferSize = settings.chunkLen * sampleRate / MasterClock::MILLIS_PER_SECOND;
-	buffer = new Bit16s[/* channels */ 2 * bufferSize];
 }
 
 PulseAudioStream::~PulseAudioStream() {
-	if (stream != NULL) close();
-	delete[] buffer;
+	close();
 }
 
-void *PulseAudioStream::processingThread(void *userData) {
-	int error;
-	PulseAudioStream &audioStream = *(PulseAudioStream *)userData;
-	qDebug() << "PulseAudio: Processing thread started";
-	while (!audioStream.stopProcessing) {
-		MasterClockNanos nanosNow = MasterClock::getClockNanos();
-		quint32 framesInAudioBuffer;
-		if (audioStream.settings.advancedTiming) {
-			framesInAudioBuffer = quint32(audioStream.sampleRate * ((double)_pa_simple_get_latency(audioStream.stream, &error) / MasterClock::MICROS_PER_SECOND));
-		} else {
-			framesInAudioBuffer = 0;
+void PulseAudioStream::contextStateCallback(pa_context *, void *userData) {
+	PulseAudioStream &audioStream = *static_cast<PulseAudioStream *>(userData);
+	_pa_threaded_mainloop_signal(audioStream.mainloop, 0);
+}
+
+void PulseAudioStream::streamStateCallback(pa_stream *stream, void *userData) {
+	PulseAudioStream &audioStream = *static_cast<PulseAudioStream *>(userData);
+	if (audioStream.started && _pa_stream_get_state(stream) == PA_STREAM_FAILED) {
+		qDebug() << "PulseAudio: Stream failed:" << _pa_strerror(_pa_context_errno(audioStream.context));
+		audioStream.started = false;
+		audioStream.audioSource.audioStreamFailed();
+	}
+	_pa_threaded_mainloop_signal(audioStream.mainloop, 0);
+}
+
+void PulseAudioStream::streamWriteCallback(pa_stream *stream, size_t requestedBytes, void *userData) {
+	PulseAudioStream &audioStream = *static_cast<PulseAudioStream *>(userData);
+	if (audioStream.stopProcessing) return;
+	const size_t maxChunkBytes = audioStream.bufferSize * FRAME_SIZE;
+	size_t bytesLeft = requestedBytes - requestedBytes % FRAME_SIZE;
+	while (bytesLeft > 0) {
+		// Rendering directly into the memory block provided by the server saves copying the audio data.
+		void *data = NULL;
+		size_t chunkBytes = qMin(bytesLeft, maxChunkBytes);
+		if (_pa_stream_begin_write(stream, &data, &chunkBytes) < 0 || data == NULL) {
+			qDebug() << "pa_stream_begin_write() failed:" << _pa_strerror(_pa_context_errno(audioStream.context));
+			return;
 		}
-		audioStream.renderAndUpdateState(audioStream.buffer, audioStream.bufferSize, nanosNow, framesInAudioBuffer);
-		if (_pa_simple_write(audioStream.stream, audioStream.buffer, audioStream.bufferSize * FRAME_SIZE, &error) < 0) {
-			qDebug() << "pa_simple_write() failed:" << _pa_strerror(error);
-			_pa_simple_free(audioStream.stream);
-			audioStream.stream = NULL;
-			qDebug() << "PulseAudio: Processing thread stopped";
-			audioStream.synthRoute.audioStreamFailed();
-			audioStream.processingThreadID = 0;
-			return NULL;
+		chunkBytes = qMin(chunkBytes - chunkBytes % FRAME_SIZE, bytesLeft);
+		if (chunkBytes == 0) {
+			_pa_stream_cancel_write(stream);
+			return;
 		}
+		MasterClockNanos nanosNow = MasterClock::getClockNanos();
+		quint32 framesInAudioBuffer = audioStream.settings.advancedTiming ? audioStream.getFramesInAudioBuffer() : 0;
+		audioStream.renderAndUpdateState(static_cast<Bit16s *>(data), quint32(chunkBytes / FRAME_SIZE), nanosNow, framesInAudioBuffer);
+		if (_pa_stream_write(stream, data, chunkBytes, NULL, 0, PA_SEEK_RELATIVE) < 0) {
+			qDebug() << "pa_stream_write() failed:" << _pa_strerror(_pa_context_errno(audioStream.context));
+			return;
+		}
+		bytesLeft -= chunkBytes;
 	}
-	audioStream.stopProcessing = false;
-	audioStream.processingThreadID = 0;
-	return NULL;
 }
 
-bool PulseAudioStream::start() {
-	int error;
-	if (buffer == NULL) return false;
-	memset(buffer, 0, FRAME_SIZE * bufferSize);
-	if (stream != NULL) close();
+void PulseAudioStream::streamUnderflowCallback(pa_stream *, void *userData) {
+	PulseAudioStream &audioStream = *static_cast<PulseAudioStream *>(userData);
+	if (!audioStream.stopProcessing) audioStream.pendingUnderrunCount++;
+}
 
-	qDebug() << "Using PulseAudio default device";
+void PulseAudioStream::streamSuccessCallback(pa_stream *, int, void *userData) {
+	PulseAudioStream &audioStream = *static_cast<PulseAudioStream *>(userData);
+	_pa_threaded_mainloop_signal(audioStream.mainloop, 0);
+}
+
+// Must be called with the main loop locked.
+bool PulseAudioStream::connectContext() {
+	context = _pa_context_new(_pa_threaded_mainloop_get_api(mainloop), "mt32emu-qt");
+	if (context == NULL) {
+		qDebug() << "pa_context_new() failed";
+		return false;
+	}
+	_pa_context_set_state_callback(context, contextStateCallback, this);
+	if (_pa_context_connect(context, NULL, PA_CONTEXT_NOFLAGS, NULL) < 0) {
+		qDebug() << "pa_context_connect() failed:" << _pa_strerror(_pa_context_errno(context));
+		return false;
+	}
+	for (;;) {
+		pa_context_state_t state = _pa_context_get_state(context);
+		if (state == PA_CONTEXT_READY) return true;
+		if (!PA_CONTEXT_IS_GOOD(state)) {
+			qDebug() << "PulseAudio: Connection to server failed:" << _pa_strerror(_pa_context_errno(context));
+			return false;
+		}
+		_pa_threaded_mainloop_wait(mainloop);
+	}
+}
 
-	// The Sample format to use
-	static const pa_sample_spec ss = {
+// Must be called with the main loop locked.
+bool PulseAudioStream::connectStream() {
+	const pa_sample_spec ss = {
 		PA_SAMPLE_S16NE, // format
 		sampleRate,
 		2 // channels
 	};
+	stream = _pa_stream_new(context, "playback", &ss, NULL);
+	if (stream == NULL) {
+		qDebug() << "pa_stream_new() failed:" << _pa_strerror(_pa_context_errno(context));
+		return false;
+	}
+	_pa_stream_set_state_callback(stream, streamStateCallback, this);
+	_pa_stream_set_write_callback(stream, streamWriteCallback, this);
+	_pa_stream_set_underflow_callback(stream, streamUnderflowCallback, this);
 
-	// Configuring desired audio latency
+	// Configuring desired audio latency. The server is asked to keep no more than the target length buffered
+	// and to request more data in chunks, so that the latency setting is respected.
 	qDebug() << "Using audio latency:" << settings.audioLatency;
-	static const pa_buffer_attr ba = {
-		audioLatencyFrames * FRAME_SIZE, // uint32_t maxlength;
+	const pa_buffer_attr ba = {
+		(uint32_t)-1, // uint32_t maxlength;
 		audioLatencyFrames * FRAME_SIZE, // uint32_t tlength;
 		(uint32_t)-1, // uint32_t prebuf;
-		(uint32_t)-1, // uint32_t minreq;
+		bufferSize * FRAME_SIZE, // uint32_t minreq;
 		(uint32_t)-1 // uint32_t fragsize;
 	};
-
-	// Create a new playback stream
-	stream = _pa_simple_new(NULL, "mt32emu-qt", PA_STREAM_PLAYBACK, NULL, "playback", &ss, NULL, &ba, &error);
-	if (stream == NULL) {
-		qDebug() << "pa_simple_new() failed:" << _pa_strerror(error);
+	const pa_stream_flags_t flags = pa_stream_flags_t(PA_STREAM_ADJUST_LATENCY | PA_STREAM_INTERPOLATE_TIMING | PA_STREAM_AUTO_TIMING_UPDATE);
+	if (_pa_stream_connect_playback(stream, NULL, &ba, flags, NULL, NULL) < 0) {
+		qDebug() << "pa_stream_connect_playback() failed:" << _pa_strerror(_pa_context_errno(context));
 		return false;
 	}
+	for (;;) {
+		pa_stream_state_t state = _pa_stream_get_state(stream);
+		if (state == PA_STREAM_READY) return true;
+		if (!PA_STREAM_IS_GOOD(state)) {
+			qDebug() << "PulseAudio: Stream creation failed:" << _pa_strerror(_pa_context_errno(context));
+			return false;
+		}
+		_pa_threaded_mainloop_wait(mainloop);
+	}
+}
+
+// Must be called with the main loop locked.
+void PulseAudioStream::waitForOperation(pa_operation *operation) {
+	if (operation == NULL) return;
+	while (_pa_operation_get_state(operation) == PA_OPERATION_RUNNING) {
+		_pa_threaded_mainloop_wait(mainloop);
+	}
+	_pa_operation_unref(operation);
+}
 
-	// Setup initial MIDI latency
+// Returns the number of frames written to the stream but not played yet, as interpolated from the latest timing info.
+quint32 PulseAudioStream::getFramesInAudioBuffer() {
+	pa_usec_t latency;
+	int negative;
+	// Fails while no timing info has been received yet.
+	if (_pa_stream_get_latency(stream, &latency, &negative) < 0 || negative) return 0;
+	return quint32(sampleRate * (double(latency) / MasterClock::MICROS_PER_SECOND));
+}
+
+bool PulseAudioStream::start() {
+	close();
+
+	qDebug() << "Using PulseAudio default device";
+
+	// Setup initial MIDI latency, the rendering starts as soon as the stream gets connected
 	if (isAutoLatencyMode()) midiLatencyFrames = audioLatencyFrames + ((DEFAULT_MIDI_LATENCY * sampleRate) / MasterClock::MILLIS_PER_SECOND);
 
-	// Start playing to fill audio buffers
-	int initFrames = audioLatencyFrames;
-	while (initFrames > 0) {
-		if (_pa_simple_write(stream, buffer, FRAME_SIZE * bufferSize, &error) < 0) {
-			qDebug() << "pa_simple_write() failed:" << _pa_strerror(error);
-			_pa_simple_free(stream);
-			stream = NULL;
-			return false;
-		}
-		initFrames -= bufferSize;
+	mainloop = _pa_threaded_mainloop_new();
+	if (mainloop == NULL) {
+		qDebug() << "pa_threaded_mainloop_new() failed";
+		return false;
 	}
-	error = pthread_create(&processingThreadID, NULL, processingThread, this);
-	if (error != 0) {
-		processingThreadID = 0;
-		qDebug() << "PulseAudio: Processing Thread creation failed:" << error;
-		_pa_simple_free(stream);
-		stream = NULL;
+	if (_pa_threaded_mainloop_start(mainloop) < 0) {
+		qDebug() << "pa_threaded_mainloop_start() failed";
+		_pa_threaded_mainloop_free(mainloop);
+		mainloop = NULL;
+		return false;
+	}
+	_pa_threaded_mainloop_lock(mainloop);
+	bool connected = connectContext() && connectStream();
+	started = connected;
+	_pa_threaded_mainloop_unlock(mainloop);
+	if (!connected) {
+		close();
 		return false;
 	}
 	return true;
 }
 
 void PulseAudioStream::close() {
-	int error;
+	if (mainloop == NULL) return;
+	_pa_threaded_mainloop_lock(mainloop);
+	stopProcessing = true;
 	if (stream != NULL) {
-		if (processingThreadID != 0) {
-			qDebug() << "PulseAudio: Stopping processing thread...";
-			stopProcessing = true;
-			pthread_join(processingThreadID, NULL);
-			stopProcessing = false;
-			processingThreadID = 0;
-			qDebug() << "PulseAudio: Processing thread stopped";
-		}
-		if (_pa_simple_drain(stream, &error) < 0) {
-			qDebug() << "pa_simple_drain() failed:" << _pa_strerror(error);
+		if (started) {
+			started = false;
+			waitForOperation(_pa_stream_drain(stream, streamSuccessCallback, this));
 		}
-		_pa_simple_free(stream);
+		_pa_stream_disconnect(stream);
+		_pa_stream_unref(stream);
 		stream = NULL;
 	}
-	return;
+	if (context != NULL) {
+		_pa_context_disconnect(context);
+		_pa_context_unref(context);
+		context = NULL;
+	}
+	_pa_threaded_mainloop_unlock(mainloop);
+	_pa_threaded_mainloop_stop(mainloop);
+	_pa_threaded_mainloop_free(mainloop);
+	mainloop = NULL;
+	stopProcessing = false;
 }
 
 PulseAudioDefaultDevice::PulseAudioDefaultDevice(PulseAudioDriver &driver) : AudioDevice(driver, "Default") {}
 
-AudioStream *PulseAudioDefaultDevice::startAudioStream(SynthRoute &synthRoute, const uint sampleRate) const {
-	PulseAudioStream *stream = new PulseAudioStream(driver.getAudioSettings(), synthRoute, sampleRate);
+AudioStream *PulseAudioDefaultDevice::startAudioStream(AudioSource &audioSource, const uint sampleRate) const {
+	PulseAudioStream *stream = new PulseAudioStream(driver.getAudioSettings(), audioSource, sampleRate);
 	if (stream->start()) return stream;
 	delete stream;
 	return NULL;
@@ -3,28 +3,42 @@
 
 #include <QtCore>
 
-#include <pulse/simple.h>
+#include <pulse/pulseaudio.h>
 
 #include <mt32emu/mt32emu.h>
 
 #include "AudioDriver.h"
 
 class Master;
-class SynthRoute;
 class PulseAudioDriver;
 
+// Plays a stream using the asynchronous API of PulseAudio. The audio is rendered in the write request callbacks,
+// which are invoked by the thread of a threaded main loop dedicated to the stream. Unlike the simple API, this allows
+// to keep the target length of the server buffer as short as the audio latency setting requires and to query
+// the interpolated timing info of the stream without blocking.
 class PulseAudioStream : public AudioStream {
 private:
-	MT32Emu::Bit16s *buffer;
-	pa_simple *stream;
-	uint bufferSize;
-	pthread_t processingThreadID;
+	pa_threaded_mainloop *mainloop;
+	pa_context *context;
+	pa_stream *stream;
+	quint32 bufferSize;
+	// Set once the stream is playing, so that a failure is reported rather than handled by start().
+	bool started;
 	volatile bool stopProcessing;
 
-	static void *processingThread(void *);
+	static void contextStateCallback(pa_context *context, void *userData);
+	static void streamStateCallback(pa_stream *stream, void *userData);
+	static void streamWriteCallback(pa_stream *stream, size_t requestedBytes, void *userData);
+	static void streamUnderflowCallback(pa_stream *stream, void *userData);
+	static void streamSuccessCallback(pa_stream *stream, int success, void *userData);
+
+	bool connectContext();
+	bool connectStream();
+	void waitForOperation(pa_operation *operation);
+	quint32 getFramesInAudioBuffer();
 
 public:
-	PulseAudioStream(const AudioDriverSettings &settings, SynthRoute &synthRoute, const quint32 sampleRate);
+	PulseAudioStream(const AudioDriverSettings &settings, AudioSource &audioSource, const quint32 sampleRate);
 	~PulseAudioStream();
 	bool start();
 	void close();
@@ -34,7 +48,7 @@ class PulseAudioDefaultDevice : public AudioDevice {
 friend class PulseAudioDriver;
 	PulseAudioDefaultDevice(PulseAudioDriver &driver);
 public:
-	AudioStream *startAudioStream(SynthRoute &synthRoute, const uint sampleRate) const;
+	AudioStream *startAudioStream(AudioSource &audioSource, const uint sampleRate) const;
 };
 
 class PulseAudioDriver : public AudioDriver {
@@ -51,9 +51,17 @@ public:
 		} else {
 			framesInAudioBuffer = 0;
 		}
+		// The audio output pulls the data as it needs it, so render exactly the requested whole frames
+		// and let it request the remainder of a partial frame again with the next read.
 		uint framesToRender = uint(len >> 2);
+		if (framesToRender == 0) return 0;
 		stream.renderAndUpdateState((Bit16s *)data, framesToRender, nanosNow, framesInAudioBuffer);
-		return len;
+		return qint64(framesToRender) << 2;
+	}
+
+	qint64 bytesAvailable() const {
+		// The synth can always produce more samples, yet some backends only pull as much data as reported available.
+		return (qint64(stream.audioLatencyFrames) << 2) + QIODevice::bytesAvailable();
 	}
 
 	qint64 writeData(const char *data, qint64 len) {
@@ -77,8 +85,8 @@ public:
 	}
 };
 
-QtAudioStream::QtAudioStream(const AudioDriverSettings &useSettings, SynthRoute &useSynthRoute, const quint32 useSampleRate) :
-	AudioStream(useSettings, useSynthRoute, useSampleRate)
+QtAudioStream::QtAudioStream(const AudioDriverSettings &useSettings, AudioSource &useAudioSource, const quint32 useSampleRate) :
+	AudioStream(useSettings, useAudioSource, useSampleRate)
 {
 	// Creating QAudioOutput in a thread leads to smooth rendering
 	// Rendering will be performed in the main thread otherwise
@@ -126,8 +134,8 @@ void QtAudioStream::close() {
 
 QtAudioDefaultDevice::QtAudioDefaultDevice(QtAudioDriver &driver) : AudioDevice(driver, "Default") {}
 
-AudioStream *QtAudioDefaultDevice::startAudioStream(SynthRoute &synthRoute, const uint sampleRate) const {
-	return new QtAudioStream(driver.getAudioSettings(), synthRoute, sampleRate);
+AudioStream *QtAudioDefaultDevice::startAudioStream(AudioSource &audioSource, const uint sampleRate) const {
+	return new QtAudioStream(driver.getAudioSettings(), audioSource, sampleRate);
 }
 
 QtAudioDriver::QtAudioDriver(Master *useMaster) : AudioDriver("qtaudio", "QtAudio") {
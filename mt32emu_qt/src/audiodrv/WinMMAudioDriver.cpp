@@ -29,8 +29,8 @@ static const DWORD FRAME_SIZE = 4;
 // Latency for MIDI processing. 15 ms is the offset of interprocess timeGetTime() difference.
 static const DWORD DEFAULT_MIDI_LATENCY = 15;
 
-WinMMAudioStream::WinMMAudioStream(const AudioDriverSettings &useSettings, bool useRingBufferMode, SynthRoute &useSynthRoute, const uint useSampleRate) :
-	AudioStream(useSettings, useSynthRoute, useSampleRate),
+WinMMAudioStream::WinMMAudioStream(const AudioDriverSettings &useSettings, bool useRingBufferMode, AudioSource &useAudioSource, const uint useSampleRate) :
+	AudioStream(useSettings, useAudioSource, useSampleRate),
 	hWaveOut(NULL), waveHdr(NULL), hEvent(NULL), hWaitableTimer(NULL), stopProcessing(false),
 	processor(*this), ringBufferMode(useRingBufferMode), prevPlayPosition(0L)
 {
@@ -102,7 +102,7 @@ void WinMMAudioProcessor::run() {
 		const DWORD playCursor = stream.getCurrentPlayPosition();
 		if (playCursor == (DWORD)-1) {
 			stream.stopProcessing = true;
-			stream.synthRoute.audioStreamFailed();
+			stream.audioSource.audioStreamFailed();
 			return;
 		}
 
@@ -154,7 +154,7 @@ void WinMMAudioProcessor::run() {
 		if (!stream.ringBufferMode && waveOutWrite(stream.hWaveOut, waveHdr, sizeof(WAVEHDR)) != MMSYSERR_NOERROR) {
 			qDebug() << "WinMMAudioDriver: waveOutWrite failed, thread stopped";
 			stream.stopProcessing = true;
-			stream.synthRoute.audioStreamFailed();
+			stream.audioSource.audioStreamFailed();
 			return;
 		}
 	}
@@ -262,9 +262,9 @@ WinMMAudioDevice::WinMMAudioDevice(WinMMAudioDriver &driver, int useDeviceIndex,
 	AudioDevice(driver, useDeviceName), deviceIndex(useDeviceIndex) {
 }
 
-AudioStream *WinMMAudioDevice::startAudioStream(SynthRoute &synthRoute, const uint sampleRate) const {
+AudioStream *WinMMAudioDevice::startAudioStream(AudioSource &audioSource, const uint sampleRate) const {
 	WinMMAudioDriver &winDriver = (WinMMAudioDriver &)driver;
-	WinMMAudioStream *stream = new WinMMAudioStream(winDriver.getAudioStreamSettings(), winDriver.isRingBufferMode(), synthRoute, sampleRate);
+	WinMMAudioStream *stream = new WinMMAudioStream(winDriver.getAudioStreamSettings(), winDriver.isRingBufferMode(), audioSource, sampleRate);
 	if (stream->start(deviceIndex)) {
 		return stream;
 	}
@@ -16,12 +16,23 @@
 
 #include <QtGlobal>
 
+#include <CoreAudio/HostTime.h>
+
 #include "CoreMidiDriver.h"
 #include "../MasterClock.h"
 #include "../MidiPropertiesDialog.h"
 
 static CoreMidiDriver *driver;
 
+// MIDIPacket timestamps are expressed in host time, zero meaning "now". Senders like DAWs schedule the events
+// ahead of time with precise timestamps, so these are mapped to the MasterClock domain rather than replaced
+// with the time of reception.
+static MasterClockNanos hostTimeToClockNanos(MIDITimeStamp hostTime, UInt64 hostTimeNow, MasterClockNanos nanosNow) {
+	if (hostTime == 0) return nanosNow;
+	if (hostTime < hostTimeNow) return nanosNow - MasterClockNanos(AudioConvertHostTimeToNanos(hostTimeNow - hostTime));
+	return nanosNow + MasterClockNanos(AudioConvertHostTimeToNanos(hostTime - hostTimeNow));
+}
+
 void CoreMidiDriver::readProc(const MIDIPacketList *packetList, void *readProcRefCon, void *srcConnRefCon) {
 Q_UNUSED(srcConnRefCon)
 
@@ -30,12 +41,14 @@ Q_UNUSED(srcConnRefCon)
 		data->midiSession = driver->createMidiSession(data->sessionID);
 	}
 	QMidiStreamParser &qMidiStreamParser = *data->midiSession->getQMidiStreamParser();
-	qMidiStreamParser.setTimestamp(MasterClock::getClockNanos());
+	const MasterClockNanos nanosNow = MasterClock::getClockNanos();
+	const UInt64 hostTimeNow = AudioGetCurrentHostTime();
 	MIDIPacket const *packet = &packetList->packet[0];
 	UInt32 numPackets = packetList->numPackets;
 	while (numPackets > 0) {
 		UInt32 packetLen = packet->length;
 		if (packetLen > 0) {
+			qMidiStreamParser.setTimestamp(hostTimeToClockNanos(packet->timeStamp, hostTimeNow, nanosNow));
 			qMidiStreamParser.parseStream(packet->data, packetLen);
 		}
 		packet = MIDIPacketNext(packet);
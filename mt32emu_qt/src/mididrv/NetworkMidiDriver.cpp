@@ -0,0 +1,251 @@
+/* Copyright (C) 2011-2021 Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NetworkMidiDriver.h"
+
+#include <QtCore>
+
+#include <cstring>
+#include <unistd.h>
+#include <poll.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "../MidiSession.h"
+
+/* Each UDP datagram carries a fragment of the raw MIDI stream of the sender preceded by the header below.
+ * The multi-byte fields are in network byte order.
+ * BYTE[4] - magic "MUNT"
+ * BYTE - protocol version, currently 1
+ * BYTE - flags, FLAG_END_OF_SESSION tells the sender is done, the session is closed after the payload is processed
+ * WORD - sequence number, incremented by one with each datagram, the datagrams that come out of order are dropped
+ * QWORD - the time the datagram is sent in nanoseconds, as measured by a monotonic clock of the sender
+ * The MIDI stream may use running status, the SysEx messages may span several datagrams.
+ */
+static const char PACKET_MAGIC[] = {'M', 'U', 'N', 'T'};
+static const uchar PROTOCOL_VERSION = 1;
+static const uchar FLAG_END_OF_SESSION = 1;
+static const int PACKET_HEADER_LENGTH = 16;
+static const int MAX_PACKET_LENGTH = 65536;
+
+static const MasterClockNanos SYNC_WINDOW_NANOS = 2 * MasterClock::NANOS_PER_SECOND;
+static const MasterClockNanos MAX_JITTER_DELAY_NANOS = 100 * MasterClock::NANOS_PER_MILLISECOND;
+// A change of the clock offset above that makes the sender clock to be synchronised anew, e.g. when the sender restarts.
+static const MasterClockNanos CLOCK_RESYNC_THRESHOLD_NANOS = MasterClock::NANOS_PER_SECOND;
+// The sessions of the senders gone silent for that long are closed.
+static const MasterClockNanos PEER_TIMEOUT_NANOS = 60 * MasterClock::NANOS_PER_SECOND;
+static const int POLL_INTERVAL_MILLIS = 100;
+
+struct NetworkMidiProcessor::Peer {
+	MidiSession *midiSession;
+	NetworkMidiClockSync clockSync;
+	quint16 lastSequenceNumber;
+	MasterClockNanos lastArrivalNanos;
+};
+
+NetworkMidiClockSync::NetworkMidiClockSync() {
+	reset();
+}
+
+void NetworkMidiClockSync::reset() {
+	synchronised = false;
+	jitterDelay = 0;
+}
+
+MasterClockNanos NetworkMidiClockSync::map(MasterClockNanos senderNanos, MasterClockNanos arrivalNanos) {
+	const MasterClockNanos offset = arrivalNanos - senderNanos;
+	if (synchronised && (offset < minOffset - CLOCK_RESYNC_THRESHOLD_NANOS || minOffset + MAX_JITTER_DELAY_NANOS + CLOCK_RESYNC_THRESHOLD_NANOS < offset)) {
+		qDebug() << "NetworkMidiDriver: Sender clock offset changed by" << 1e-6 * (offset - minOffset) << "ms, resynchronising";
+		synchronised = false;
+	}
+	if (!synchronised) {
+		synchronised = true;
+		windowStartNanos = arrivalNanos;
+		minOffset = offset;
+		windowMinOffset = offset;
+		jitterDelay = 0;
+		windowJitterDelay = 0;
+		lastEventNanos = arrivalNanos;
+	} else if (SYNC_WINDOW_NANOS <= arrivalNanos - windowStartNanos) {
+		// The estimates made within the previous window expire, those of the one just finished remain
+		windowStartNanos = arrivalNanos;
+		minOffset = windowMinOffset;
+		jitterDelay = windowJitterDelay;
+		windowMinOffset = offset;
+		windowJitterDelay = 0;
+	}
+	if (offset < windowMinOffset) windowMinOffset = offset;
+	if (offset < minOffset) minOffset = offset;
+	MasterClockNanos excessTransitNanos = offset - minOffset;
+	if (MAX_JITTER_DELAY_NANOS < excessTransitNanos) excessTransitNanos = MAX_JITTER_DELAY_NANOS;
+	if (windowJitterDelay < excessTransitNanos) windowJitterDelay = excessTransitNanos;
+	if (jitterDelay < excessTransitNanos) jitterDelay = excessTransitNanos;
+	MasterClockNanos eventNanos = senderNanos + minOffset + jitterDelay;
+	// The events must not be reordered when the delay shrinks
+	if (eventNanos < lastEventNanos) eventNanos = lastEventNanos;
+	lastEventNanos = eventNanos;
+	return eventNanos;
+}
+
+NetworkMidiProcessor::NetworkMidiProcessor(NetworkMidiDriver *useNetworkMidiDriver) :
+	networkMidiDriver(useNetworkMidiDriver), udpPort(0), stopProcessing(false)
+{}
+
+void NetworkMidiProcessor::start(quint16 useUdpPort) {
+	udpPort = useUdpPort;
+	stopProcessing = false;
+	QThread::start(QThread::TimeCriticalPriority);
+}
+
+void NetworkMidiProcessor::stop() {
+	stopProcessing = true;
+}
+
+void NetworkMidiProcessor::run() {
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (fd == -1) {
+		qDebug() << "NetworkMidiDriver: Can't create UDP socket, errno:" << errno;
+		return;
+	}
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(udpPort);
+	if (bind(fd, (sockaddr *)&address, sizeof(address)) != 0) {
+		qDebug() << "NetworkMidiDriver: Can't bind UDP port" << udpPort << ", errno:" << errno;
+		close(fd);
+		return;
+	}
+	qDebug() << "NetworkMidiDriver: Processing thread started, listening on UDP port" << udpPort;
+
+	uchar *packet = new uchar[MAX_PACKET_LENGTH];
+	QHash<quint64, Peer *> peers;
+	MasterClockNanos lastTimeoutCheckNanos = MasterClock::getClockNanos();
+	while (!stopProcessing) {
+		pollfd pfd;
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		int pollRes = poll(&pfd, 1, POLL_INTERVAL_MILLIS);
+		if (pollRes < 0 && errno != EINTR) {
+			qDebug() << "NetworkMidiDriver: Poll() returned error, errno:" << errno;
+			break;
+		}
+		if (pollRes > 0) {
+			sockaddr_in peerAddress;
+			socklen_t peerAddressLength = sizeof(peerAddress);
+			ssize_t packetLength = recvfrom(fd, packet, MAX_PACKET_LENGTH, 0, (sockaddr *)&peerAddress, &peerAddressLength);
+			if (packetLength >= 0) {
+				const quint32 peerIP = ntohl(peerAddress.sin_addr.s_addr);
+				const quint16 peerPort = ntohs(peerAddress.sin_port);
+				processPacket(peers, (quint64(peerIP) << 16) | peerPort, packet, int(packetLength));
+			}
+		}
+		MasterClockNanos nanosNow = MasterClock::getClockNanos();
+		if (nanosNow - lastTimeoutCheckNanos < MasterClock::NANOS_PER_SECOND) continue;
+		lastTimeoutCheckNanos = nanosNow;
+		QList<quint64> peerKeys = peers.keys();
+		for (int i = 0; i < peerKeys.size(); i++) {
+			if (PEER_TIMEOUT_NANOS < nanosNow - peers.value(peerKeys[i])->lastArrivalNanos) {
+				qDebug() << "NetworkMidiDriver: Sender timed out:" << peers.value(peerKeys[i])->midiSession->getName();
+				deletePeer(peers, peerKeys[i]);
+			}
+		}
+	}
+	QList<quint64> peerKeys = peers.keys();
+	for (int i = 0; i < peerKeys.size(); i++) {
+		deletePeer(peers, peerKeys[i]);
+	}
+	delete[] packet;
+	close(fd);
+	qDebug() << "NetworkMidiDriver: Processing thread stopped";
+}
+
+void NetworkMidiProcessor::processPacket(QHash<quint64, Peer *> &peers, quint64 peerKey, const uchar *packet, int packetLength) {
+	const MasterClockNanos arrivalNanos = MasterClock::getClockNanos();
+	if (packetLength < PACKET_HEADER_LENGTH || memcmp(packet, PACKET_MAGIC, sizeof(PACKET_MAGIC)) != 0 || packet[4] != PROTOCOL_VERSION) {
+		qDebug() << "NetworkMidiDriver: Ignored unrecognised packet of length" << packetLength;
+		return;
+	}
+	const uchar flags = packet[5];
+	const quint16 sequenceNumber = qFromBigEndian<quint16>(packet + 6);
+	const MasterClockNanos senderNanos = qFromBigEndian<qint64>(packet + 8);
+	Peer *peer = peers.value(peerKey);
+	if (peer == NULL) {
+		if (flags & FLAG_END_OF_SESSION) return;
+		const quint32 peerIP = quint32(peerKey >> 16);
+		QString peerName = QString("UDP %1.%2.%3.%4:%5").arg(peerIP >> 24).arg((peerIP >> 16) & 0xFF).arg((peerIP >> 8) & 0xFF)
+			.arg(peerIP & 0xFF).arg(peerKey & 0xFFFF);
+		MidiSession *midiSession = networkMidiDriver->createMidiSession(peerName);
+		if (midiSession == NULL) {
+			qDebug() << "NetworkMidiDriver: Failed to create new session for" << peerName;
+			return;
+		}
+		peer = new Peer;
+		peer->midiSession = midiSession;
+		peers.insert(peerKey, peer);
+		networkMidiDriver->showBalloon("Connected network MIDI sender:", peerName);
+		qDebug() << "NetworkMidiDriver: Connected sender" << peerName;
+	} else {
+		const qint16 sequenceGap = qint16(sequenceNumber - peer->lastSequenceNumber);
+		if (sequenceGap <= 0) {
+			qDebug() << "NetworkMidiDriver: Dropped packet received out of order from" << peer->midiSession->getName();
+			return;
+		}
+		if (sequenceGap > 1) {
+			qDebug() << "NetworkMidiDriver: Lost" << sequenceGap - 1 << "packets from" << peer->midiSession->getName();
+		}
+	}
+	peer->lastSequenceNumber = sequenceNumber;
+	peer->lastArrivalNanos = arrivalNanos;
+	if (PACKET_HEADER_LENGTH < packetLength) {
+		QMidiStreamParser &qMidiStreamParser = *peer->midiSession->getQMidiStreamParser();
+		qMidiStreamParser.setTimestamp(peer->clockSync.map(senderNanos, arrivalNanos));
+		qMidiStreamParser.parseStream(packet + PACKET_HEADER_LENGTH, packetLength - PACKET_HEADER_LENGTH);
+	}
+	if (flags & FLAG_END_OF_SESSION) {
+		qDebug() << "NetworkMidiDriver: Sender finished:" << peer->midiSession->getName();
+		deletePeer(peers, peerKey);
+	}
+}
+
+void NetworkMidiProcessor::deletePeer(QHash<quint64, Peer *> &peers, quint64 peerKey) {
+	Peer *peer = peers.take(peerKey);
+	networkMidiDriver->deleteMidiSession(peer->midiSession);
+	delete peer;
+}
+
+NetworkMidiDriver::NetworkMidiDriver(Master *useMaster) : MidiDriver(useMaster), processor(this) {
+	name = "Network MIDI Driver";
+}
+
+NetworkMidiDriver::~NetworkMidiDriver() {
+	stop();
+}
+
+void NetworkMidiDriver::start() {
+	int udpPort = master->getSettings()->value("Master/networkMidiPort", 0).toInt();
+	if (udpPort <= 0 || 65535 < udpPort) return;
+	processor.start(quint16(udpPort));
+}
+
+void NetworkMidiDriver::stop() {
+	processor.stop();
+	MidiDriver::waitForProcessingThread(processor, POLL_INTERVAL_MILLIS * MasterClock::NANOS_PER_MILLISECOND);
+}
@@ -0,0 +1,68 @@
+#ifndef NETWORK_MIDI_DRIVER_H
+#define NETWORK_MIDI_DRIVER_H
+
+#include <QThread>
+
+#include "MidiDriver.h"
+#include "../MasterClock.h"
+
+class NetworkMidiDriver;
+
+// Maps the timestamps of a sender clock onto MasterClock and absorbs the network jitter. The offset between the clocks
+// is estimated by the fastest transit observed within the last two windows, so that the estimate follows the clock drift.
+// The events are delayed by the largest excess transit time seen within the same windows, up to a limit. Thus, the delay
+// grows immediately with the jitter and shrinks once the jitter has stayed lower for a window at least.
+class NetworkMidiClockSync {
+public:
+	NetworkMidiClockSync();
+	void reset();
+	// Returns the MasterClock time an event sent at the sender clock time should be played at, given its arrival time.
+	MasterClockNanos map(MasterClockNanos senderNanos, MasterClockNanos arrivalNanos);
+
+private:
+	bool synchronised;
+	MasterClockNanos windowStartNanos;
+	MasterClockNanos minOffset;
+	MasterClockNanos windowMinOffset;
+	MasterClockNanos jitterDelay;
+	MasterClockNanos windowJitterDelay;
+	MasterClockNanos lastEventNanos;
+};
+
+class NetworkMidiProcessor : public QThread {
+	Q_OBJECT
+public:
+	NetworkMidiProcessor(NetworkMidiDriver *useNetworkMidiDriver);
+	void start(quint16 useUdpPort);
+	void stop();
+
+protected:
+	void run();
+
+private:
+	struct Peer;
+
+	NetworkMidiDriver *networkMidiDriver;
+	quint16 udpPort;
+	volatile bool stopProcessing;
+
+	void processPacket(QHash<quint64, Peer *> &peers, quint64 peerKey, const uchar *packet, int packetLength);
+	void deletePeer(QHash<quint64, Peer *> &peers, quint64 peerKey);
+};
+
+// Receives raw MIDI streams sent over UDP and creates a MIDI session per sender address. Disabled unless the UDP port
+// to listen on is set in the configuration file as "Master/networkMidiPort".
+class NetworkMidiDriver : public MidiDriver {
+	Q_OBJECT
+	friend class NetworkMidiProcessor;
+public:
+	NetworkMidiDriver(Master *master);
+	~NetworkMidiDriver();
+	void start();
+	void stop();
+
+private:
+	NetworkMidiProcessor processor;
+};
+
+#endif
@@ -0,0 +1,121 @@
+/* Copyright (C) 2011-2021 Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PipeWireMidiDriver.h"
+
+#include <QtCore>
+
+#include "../MasterClock.h"
+#include "../MidiSession.h"
+#include "../PipeWireClient.h"
+
+static inline quint32 midiBufferToShortMessage(size_t midiBufferSize, uchar *midiBuffer) {
+	switch (midiBufferSize) {
+	case 1:
+		return *midiBuffer;
+	case 2:
+		return qFromLittleEndian<quint16>(midiBuffer);
+	default:
+		return qFromLittleEndian<quint32>(midiBuffer) & 0xFFFFFF;
+	}
+}
+
+bool PipeWireMidiDriver::pushMIDIMessage(MidiSession *midiSession, MasterClockNanos eventTimestamp, size_t midiBufferSize, uchar *midiBuffer) {
+	SynthRoute *synthRoute = midiSession->getSynthRoute();
+	if (*midiBuffer == 0xF0) {
+		return synthRoute->pushMIDISysex(*midiSession, midiBuffer, uint(midiBufferSize), eventTimestamp);
+	}
+	quint32 message = midiBufferToShortMessage(midiBufferSize, midiBuffer);
+	return synthRoute->pushMIDIShortMessage(*midiSession, message, eventTimestamp);
+}
+
+bool PipeWireMidiDriver::playMIDIMessage(MidiSession *midiSession, quint64 eventTimestamp, size_t midiBufferSize, uchar *midiBuffer) {
+	SynthRoute *synthRoute = midiSession->getSynthRoute();
+	if (*midiBuffer == 0xF0) {
+		return synthRoute->playMIDISysex(*midiSession, midiBuffer, quint32(midiBufferSize), eventTimestamp);
+	}
+	quint32 message = midiBufferToShortMessage(midiBufferSize, midiBuffer);
+	return synthRoute->playMIDIShortMessage(*midiSession, message, eventTimestamp);
+}
+
+PipeWireMidiDriver::PipeWireMidiDriver(Master *master) : MidiDriver(master) {
+	name = "PipeWire MIDI Driver";
+	disconnect(SIGNAL(midiSessionInitiated(MidiSession **, MidiDriver *, QString)));
+	connect(this, SIGNAL(midiSessionInitiated(MidiSession **, MidiDriver *, QString)), master, SLOT(createMidiSession(MidiSession **, MidiDriver *, QString)), Qt::DirectConnection);
+	connect(master, SIGNAL(pipeWireMidiPortDeleted(MidiSession *)), SLOT(onPipeWireMidiPortDeleted(MidiSession *)));
+}
+
+PipeWireMidiDriver::~PipeWireMidiDriver() {
+	stop();
+	qDebug() << "PipeWire MIDI Driver stopped";
+}
+
+void PipeWireMidiDriver::start() {
+	qDebug() << "PipeWire MIDI Driver started";
+}
+
+void PipeWireMidiDriver::stop() {
+	while (!exclusiveSessions.isEmpty()) {
+		emit midiSessionDeleted(exclusiveSessions.takeFirst());
+	}
+	while (!pipeWireClients.isEmpty()) {
+		delete pipeWireClients.takeFirst();
+	}
+}
+
+bool PipeWireMidiDriver::canDeletePort(MidiSession *midiSession) {
+	return exclusiveSessions.contains(midiSession) || midiSessions.contains(midiSession);
+}
+
+void PipeWireMidiDriver::deletePort(MidiSession *midiSession) {
+	if (exclusiveSessions.removeOne(midiSession)) return;
+
+	int midiSessionIx = midiSessions.indexOf(midiSession);
+	if (midiSessionIx < 0 || pipeWireClients.size() <= midiSessionIx) return;
+	PipeWireClient *pipeWireClient = pipeWireClients.at(midiSessionIx);
+	delete pipeWireClient;
+	pipeWireClients.removeAt(midiSessionIx);
+	midiSessions.removeAt(midiSessionIx);
+}
+
+bool PipeWireMidiDriver::createPipeWirePort(bool exclusive) {
+	QString portName = QString("PipeWire MIDI In");
+	if (exclusive) {
+		MidiSession *midiSession = master->createExclusivePipeWireMidiPort(portName);
+		if (midiSession == NULL) return false;
+		exclusiveSessions.append(midiSession);
+		return true;
+	}
+	MidiSession *midiSession = createMidiSession(portName);
+	PipeWireClient *pipeWireClient = new PipeWireClient;
+	PipeWireClientState state = pipeWireClient->open(midiSession, NULL, 0, 0);
+	if (PipeWireClientState_OPEN == state) {
+		pipeWireClients.append(pipeWireClient);
+		// The events arrive in the realtime data thread of the graph, this leads to pushing them to a lockless buffer.
+		midiSession->getSynthRoute()->enableMultiMidiMode();
+		return true;
+	}
+	delete pipeWireClient;
+	deleteMidiSession(midiSession);
+	return false;
+}
+
+void PipeWireMidiDriver::onPipeWireMidiPortDeleted(MidiSession *midiSession) {
+	if (canDeletePort(midiSession)) {
+		deletePort(midiSession);
+		emit midiSessionDeleted(midiSession);
+	}
+}
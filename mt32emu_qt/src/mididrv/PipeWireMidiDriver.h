@@ -0,0 +1,34 @@
+#ifndef PIPEWIRE_MIDI_DRIVER_H
+#define PIPEWIRE_MIDI_DRIVER_H
+
+#include <QThread>
+
+#include "MidiDriver.h"
+
+class Master;
+class PipeWireClient;
+
+class PipeWireMidiDriver : public MidiDriver {
+	Q_OBJECT
+
+public:
+	static bool pushMIDIMessage(MidiSession *midiSession, MasterClockNanos eventTimestamp, size_t midiBufferSize, uchar *midiBuffer);
+	static bool playMIDIMessage(MidiSession *midiSession, quint64 eventTimestamp, size_t midiBufferSize, uchar *midiBuffer);
+
+	PipeWireMidiDriver(Master *master);
+	~PipeWireMidiDriver();
+	void start();
+	void stop();
+	bool canDeletePort(MidiSession *midiSession);
+	void deletePort(MidiSession *midiSession);
+	bool createPipeWirePort(bool exclusive);
+
+private:
+	QList<PipeWireClient *> pipeWireClients;
+	QList<MidiSession *> exclusiveSessions;
+
+private slots:
+	void onPipeWireMidiPortDeleted(MidiSession *midiSession);
+};
+
+#endif
@@ -16,6 +16,8 @@
 
 #include "SMFDriver.h"
 
+#include <cstring>
+
 #include <QtCore>
 #include <QFileDialog>
 #include <QMessageBox>
@@ -23,6 +25,14 @@
 #include "../MidiSession.h"
 
 static const MasterClockNanos MAX_SLEEP_TIME = 200 * MasterClock::NANOS_PER_MILLISECOND;
+static const MasterClockNanos LOOK_AHEAD_TIME = 100 * MasterClock::NANOS_PER_MILLISECOND;
+static const MasterClockNanos REFILL_INTERVAL = LOOK_AHEAD_TIME / 2;
+static const MasterClockNanos FREE_RUNNING_SLEEP_TIME = 250 * MasterClock::NANOS_PER_MICROSECOND;
+
+// A suspended route reopens upon MIDI activity, so the playback goes on.
+static bool isSynthRouteAvailable(SynthRoute *synthRoute) {
+	return synthRoute->getState() == SynthRouteState_OPEN || synthRoute->isSuspended();
+}
 
 static void sendAllSoundOff(SynthRoute *synthRoute, bool resetAllControllers) {
 	if (synthRoute->getState() != SynthRouteState_OPEN) return;
@@ -43,6 +53,120 @@ static void sendAllSoundOff(SynthRoute *synthRoute, bool resetAllControllers) {
 	}
 }
 
+// While seeking, the channel messages that merely set the current value of a pitch bender or a controller
+// are collected here, so that only the last value on each channel is sent to the synth. Dense streams of such messages
+// are common in long soundtracks, and each message sent individually has to contend with the rendering thread.
+// The collected messages are flushed before any other message on the same channel and before any SysEx,
+// which keeps the effective order of events intact.
+class SeekStateCollector {
+public:
+	SeekStateCollector() {
+		memset(pendingMessages, 0, sizeof pendingMessages);
+	}
+
+	void playMIDIShortMessage(SynthRoute *synthRoute, quint32 msg) {
+		uint channel = msg & 0x0F;
+		switch (msg & 0xF0) {
+			case 0x80:
+			case 0x90:
+				// Ignore NoteOn & NoteOff while seeking
+				return;
+			case 0xA0:
+			case 0xD0:
+				// Aftertouch is ignored by the synth anyway
+				return;
+			case 0xE0:
+				pendingMessages[channel][PITCH_BEND_SLOT] = msg;
+				return;
+			case 0xB0: {
+				int slot = getControllerSlot((msg >> 8) & 0x7F);
+				if (slot >= 0) {
+					pendingMessages[channel][slot] = msg;
+					return;
+				}
+				break;
+			}
+			default:
+				break;
+		}
+		flushChannel(synthRoute, channel);
+		synthRoute->playMIDIShortMessageNow(msg);
+	}
+
+	void playMIDISysex(SynthRoute *synthRoute, const uchar *sysex, quint32 sysexLen) {
+		flush(synthRoute);
+		synthRoute->playMIDISysexNow(sysex, sysexLen);
+	}
+
+	void flush(SynthRoute *synthRoute) {
+		for (uint channel = 0; channel < 16; channel++) {
+			flushChannel(synthRoute, channel);
+		}
+	}
+
+private:
+	enum {
+		PITCH_BEND_SLOT,
+		MODULATION_SLOT,
+		VOLUME_SLOT,
+		PAN_SLOT,
+		EXPRESSION_SLOT,
+		HOLD_PEDAL_SLOT,
+		SLOT_COUNT
+	};
+
+	// Since a status byte is never zero, zero marks an empty slot.
+	quint32 pendingMessages[16][SLOT_COUNT];
+
+	static int getControllerSlot(uint controller) {
+		switch (controller) {
+			case 0x01:
+				return MODULATION_SLOT;
+			case 0x07:
+				return VOLUME_SLOT;
+			case 0x0A:
+				return PAN_SLOT;
+			case 0x0B:
+				return EXPRESSION_SLOT;
+			case 0x40:
+				return HOLD_PEDAL_SLOT;
+			default:
+				return -1;
+		}
+	}
+
+	void flushChannel(SynthRoute *synthRoute, uint channel) {
+		for (uint slot = 0; slot < SLOT_COUNT; slot++) {
+			quint32 &msg = pendingMessages[channel][slot];
+			if (msg == 0) continue;
+			synthRoute->playMIDIShortMessageNow(msg);
+			msg = 0;
+		}
+	}
+};
+
+SMFPreparser::SMFPreparser() : parsed() {
+}
+
+void SMFPreparser::start(QString useFileName) {
+	fileName = useFileName;
+	parsed = false;
+	if (!fileName.isEmpty()) QThread::start(QThread::LowPriority);
+}
+
+const QString &SMFPreparser::getFileName() const {
+	return fileName;
+}
+
+bool SMFPreparser::isParsed() const {
+	return parsed;
+}
+
+void SMFPreparser::run() {
+	parsed = parser.parse(fileName);
+	if (!parsed) qDebug() << "SMFDriver: Error preparsing MIDI file:" << fileName;
+}
+
 SMFProcessor::SMFProcessor(SMFDriver *useSMFDriver) : driver(useSMFDriver) {
 }
 
@@ -53,7 +177,11 @@ void SMFProcessor::start(QString useFileName) {
 	driver->fastForwardingFactor = 0;
 	driver->seekPosition = -1;
 	fileName = useFileName;
-	if (!parser.parse(fileName)) {
+	// The file may have been parsed already while the previous one was playing.
+	preparser.wait();
+	if (preparser.getFileName() == fileName && preparser.isParsed()) {
+		parser = preparser.parser;
+	} else if (!parser.parse(fileName)) {
 		qDebug() << "SMFDriver: Error parsing MIDI file:" << fileName;
 		QMessageBox::warning(NULL, "Error", "Error encountered while loading MIDI file");
 		emit driver->playbackFinished();
@@ -69,88 +197,181 @@ void SMFProcessor::run() {
 	const QMidiEventList &midiEvents = parser.getMIDIEvents();
 	midiTick = parser.getMidiTick();
 	quint32 totalSeconds = estimateRemainingTime(midiEvents, 0);
-	MasterClockNanos startNanos = MasterClock::getClockNanos();
+	MasterClockNanos startNanos = synthRoute->getMIDIClockNanos();
+	// The events are pushed ahead of time, currentNanos is when the next event to push is due
+	// while pushedNanos is when the last pushed one is.
 	MasterClockNanos currentNanos = startNanos;
-	for (int currentEventIx = 0; currentEventIx < midiEvents.count(); currentEventIx++) {
-		currentNanos += midiEvents.at(currentEventIx).getTimestamp() * midiTick;
-		while (!driver->stopProcessing && synthRoute->getState() == SynthRouteState_OPEN) {
-			uint bpmUpdate = uint(driver->bpmUpdate.fetchAndStoreRelaxed(0));
-			if (bpmUpdate > 0) {
-				midiTick = parser.getMidiTick(MidiParser::MICROSECONDS_PER_MINUTE / bpmUpdate);
-				totalSeconds = (currentNanos - startNanos) / MasterClock::NANOS_PER_SECOND + estimateRemainingTime(midiEvents, currentEventIx + 1);
+	MasterClockNanos pushedNanos = startNanos;
+	int currentEventIx = 0;
+	if (!midiEvents.isEmpty()) currentNanos += midiEvents.at(currentEventIx).getTimestamp() * midiTick;
+	while (currentEventIx < midiEvents.count() && !driver->stopProcessing && isSynthRouteAvailable(synthRoute)) {
+		uint bpmUpdate = uint(driver->bpmUpdate.fetchAndStoreRelaxed(0));
+		if (bpmUpdate > 0) {
+			midiTick = parser.getMidiTick(MidiParser::MICROSECONDS_PER_MINUTE / bpmUpdate);
+			totalSeconds = (currentNanos - startNanos) / MasterClock::NANOS_PER_SECOND + estimateRemainingTime(midiEvents, currentEventIx + 1);
+		}
+		updatePreparser();
+		MasterClockNanos nanosNow = synthRoute->getMIDIClockNanos();
+		if (driver->pauseProcessing) {
+			if (!paused) {
+				paused = true;
+				waitForPushedEvents(synthRoute, pushedNanos);
+				sendAllSoundOff(synthRoute, false);
+				nanosNow = synthRoute->getMIDIClockNanos();
 			}
-			MasterClockNanos nanosNow = MasterClock::getClockNanos();
-			if (driver->pauseProcessing) {
-				if (!paused) {
-					paused = true;
-					sendAllSoundOff(synthRoute, false);
-				}
-				usleep(MAX_SLEEP_TIME / MasterClock::NANOS_PER_MICROSECOND);
-				MasterClockNanos delay = MasterClock::getClockNanos() - nanosNow;
-				startNanos += delay;
-				currentNanos += delay;
-				continue;
+			usleep(MAX_SLEEP_TIME / MasterClock::NANOS_PER_MICROSECOND);
+			MasterClockNanos delay = synthRoute->getMIDIClockNanos() - nanosNow;
+			startNanos += delay;
+			currentNanos += delay;
+			pushedNanos += delay;
+			continue;
+		}
+		if (paused) paused = false;
+		if (synthRoute->isSuspended() && currentNanos <= nanosNow + LOOK_AHEAD_TIME) {
+			// Nothing is pushed until the synth reopens, lest the events due meanwhile were played all at once.
+			synthRoute->requestResume();
+			usleep(REFILL_INTERVAL / MasterClock::NANOS_PER_MICROSECOND);
+			MasterClockNanos delay = synthRoute->getMIDIClockNanos() - nanosNow;
+			startNanos += delay;
+			currentNanos += delay;
+			pushedNanos += delay;
+			continue;
+		}
+		int seekPosition = driver->seekPosition.fetchAndStoreRelaxed(-1);
+		if (seekPosition > -1) {
+			waitForPushedEvents(synthRoute, pushedNanos);
+			MasterClockNanos seekNanosSinceStart = totalSeconds * seekPosition * MasterClock::NANOS_PER_MILLISECOND;
+			MasterClockNanos currentNanosSinceStart = currentNanos - startNanos;
+			MasterClockNanos lastEventNanosSinceStart = pushedNanos - startNanos;
+			bool resetAllControllers;
+			if (seekNanosSinceStart < lastEventNanosSinceStart || seekNanosSinceStart == 0) {
+				midiTick = parser.getMidiTick();
+				emit driver->tempoUpdated(0);
+				currentEventIx = 0;
+				currentNanosSinceStart = midiEvents.at(currentEventIx).getTimestamp() * midiTick;
+				resetAllControllers = true;
+			} else {
+				resetAllControllers = false;
 			}
-			if (paused) paused = false;
-			int seekPosition = driver->seekPosition.fetchAndStoreRelaxed(-1);
-			if (seekPosition > -1) {
-				MasterClockNanos seekNanosSinceStart = totalSeconds * seekPosition * MasterClock::NANOS_PER_MILLISECOND;
-				MasterClockNanos currentNanosSinceStart = currentNanos - startNanos;
-				MasterClockNanos lastEventNanosSinceStart = currentNanosSinceStart - midiEvents.at(currentEventIx).getTimestamp() * midiTick;
-				bool resetAllControllers;
-				if (seekNanosSinceStart < lastEventNanosSinceStart || seekNanosSinceStart == 0) {
-					midiTick = parser.getMidiTick();
-					emit driver->tempoUpdated(0);
-					currentEventIx = 0;
-					currentNanosSinceStart = midiEvents.at(currentEventIx).getTimestamp() * midiTick;
-					resetAllControllers = true;
-				} else {
-					resetAllControllers = false;
+			sendAllSoundOff(synthRoute, resetAllControllers);
+			seek(synthRoute, midiEvents, currentEventIx, currentNanosSinceStart, seekNanosSinceStart);
+			nanosNow = synthRoute->getMIDIClockNanos();
+			startNanos = nanosNow - seekNanosSinceStart;
+			currentNanos = currentNanosSinceStart + startNanos;
+			pushedNanos = nanosNow;
+		}
+		// Having advanced to the next file, the events pushed ahead of time may be due yet before it starts.
+		emit driver->playbackTimeChanged(qMax(nanosNow - startNanos, MasterClockNanos(0)), totalSeconds);
+		// Each event within the look-ahead window is stamped with its exact due time, so the rendering places it
+		// sample-accurately regardless of when this thread wakes up.
+		MasterClockNanos lookAheadNanos = nanosNow + LOOK_AHEAD_TIME;
+		while (currentNanos <= lookAheadNanos) {
+			const QMidiEvent &e = midiEvents.at(currentEventIx);
+			switch (e.getType()) {
+				case SHORT_MESSAGE:
+					synthRoute->pushMIDIShortMessage(*session, e.getShortMessage(), currentNanos);
+					break;
+				case SYSEX:
+					synthRoute->pushMIDISysex(*session, midiEvents.getSysexData(e), midiEvents.getSysexLen(e), currentNanos);
+					break;
+				case SET_TEMPO: {
+					uint tempo = e.getShortMessage();
+					midiTick = parser.getMidiTick(tempo);
+					emit driver->tempoUpdated(MidiParser::MICROSECONDS_PER_MINUTE / tempo);
+					break;
 				}
-				sendAllSoundOff(synthRoute, resetAllControllers);
-				seek(synthRoute, midiEvents, currentEventIx, currentNanosSinceStart, seekNanosSinceStart);
-				nanosNow = MasterClock::getClockNanos();
-				startNanos = nanosNow - seekNanosSinceStart;
-				currentNanos = currentNanosSinceStart + startNanos;
+				default:
+					break;
 			}
-			emit driver->playbackTimeChanged(nanosNow - startNanos, totalSeconds);
-			MasterClockNanos delay = currentNanos - nanosNow;
+			pushedNanos = currentNanos;
+			if (++currentEventIx == midiEvents.count()) break;
+			MasterClockNanos delta = midiEvents.at(currentEventIx).getTimestamp() * midiTick;
 			uint fastForwardingFactor = driver->fastForwardingFactor;
 			if (fastForwardingFactor > 1) {
-				MasterClockNanos timeShift = delay - (delay / fastForwardingFactor);
-				delay -= timeShift;
-				currentNanos -= timeShift;
+				MasterClockNanos timeShift = delta - (delta / fastForwardingFactor);
+				delta -= timeShift;
 				startNanos -= timeShift;
 			}
-			if (delay < MasterClock::NANOS_PER_MILLISECOND) break;
-			usleep(((delay < MAX_SLEEP_TIME ? delay : MAX_SLEEP_TIME) - MasterClock::NANOS_PER_MILLISECOND) / MasterClock::NANOS_PER_MICROSECOND);
+			currentNanos += delta;
 		}
-		const QMidiEvent &e = midiEvents.at(currentEventIx);
-		if (driver->stopProcessing || synthRoute->getState() != SynthRouteState_OPEN) break;
-		switch (e.getType()) {
-			case SHORT_MESSAGE:
-				synthRoute->pushMIDIShortMessage(*session, e.getShortMessage(), currentNanos);
-				break;
-			case SYSEX:
-				synthRoute->pushMIDISysex(*session, e.getSysexData(), e.getSysexLen(), currentNanos);
-				break;
-			case SET_TEMPO: {
-				uint tempo = e.getShortMessage();
-				midiTick = parser.getMidiTick(tempo);
-				emit driver->tempoUpdated(MidiParser::MICROSECONDS_PER_MINUTE / tempo);
-				break;
+		if (currentEventIx == midiEvents.count()) {
+			if (driver->stopProcessing || !advanceToNextFile()) break;
+			// The channels are reset at the end of the previous file as they would if the playback stopped there,
+			// and the next file starts right after its last event with no gap.
+			for (quint8 i = 0; i < 16; i++) {
+				synthRoute->pushMIDIShortMessage(*session, 0x7FB0 | i, pushedNanos);
+				synthRoute->pushMIDIShortMessage(*session, 0x79B0 | i, pushedNanos);
 			}
-			default:
-				break;
+			synthRoute->setMidiSessionName(session, QFileInfo(fileName).fileName());
+			emit driver->playbackAdvanced(fileName);
+			driver->bpmUpdate = 0;
+			midiTick = parser.getMidiTick();
+			totalSeconds = estimateRemainingTime(midiEvents, 0);
+			startNanos = pushedNanos;
+			currentEventIx = 0;
+			currentNanos = startNanos + midiEvents.at(currentEventIx).getTimestamp() * midiTick;
+			continue;
 		}
+		if (synthRoute->reportMIDIProgress(currentNanos)) {
+			// The audio stream renders ahead of realtime up to the next event, so its MIDI clock should reach the window soon.
+			usleep(FREE_RUNNING_SLEEP_TIME / MasterClock::NANOS_PER_MICROSECOND);
+			continue;
+		}
+		// Wake up when the next event enters the window, but not sooner than the refill interval, so that dense streams
+		// are pushed in batches, and not later than MAX_SLEEP_TIME to respond to the playback controls.
+		MasterClockNanos sleepTime = qBound(REFILL_INTERVAL, currentNanos - lookAheadNanos, MAX_SLEEP_TIME);
+		usleep(sleepTime / MasterClock::NANOS_PER_MICROSECOND);
 	}
+	waitForPushedEvents(synthRoute, pushedNanos);
 	sendAllSoundOff(synthRoute, true);
 	emit driver->playbackTimeChanged(0, 0);
 	qDebug() << "SMFDriver: processor thread stopped";
 	driver->deleteMidiSession(session);
+	preparser.wait();
 	if (!driver->stopProcessing) emit driver->playbackFinished();
 }
 
+// Starts parsing the file queued to follow unless it is done already. The file queued is only picked up once
+// the parsing of the previous one completes.
+void SMFProcessor::updatePreparser() {
+	if (preparser.isRunning()) return;
+	const QString nextFileName = driver->getNextFileName();
+	if (nextFileName != preparser.getFileName()) preparser.start(nextFileName);
+}
+
+// Takes over the events of the file queued to follow, once the current one has been pushed entirely. If the queued file
+// could not be parsed, the playback finishes as usual, so that the error is reported when the file is started.
+bool SMFProcessor::advanceToNextFile() {
+	const QString nextFileName = driver->getNextFileName();
+	if (nextFileName.isEmpty()) return false;
+	preparser.wait();
+	if (preparser.getFileName() != nextFileName) {
+		preparser.start(nextFileName);
+		preparser.wait();
+	}
+	if (!preparser.isParsed() || preparser.parser.getMIDIEvents().isEmpty()) return false;
+	// The playlist may have changed meanwhile.
+	if (!driver->takeNextFileName(nextFileName)) return false;
+	parser = preparser.parser;
+	fileName = nextFileName;
+	qDebug() << "SMFDriver: Advancing to MIDI file:" << fileName;
+	return true;
+}
+
+// Since the messages sent to stop playback or to seek are played immediately, the events already pushed ahead of time
+// have to become due first or they would sound after those messages.
+void SMFProcessor::waitForPushedEvents(SynthRoute *synthRoute, const MasterClockNanos pushedNanos) {
+	while (synthRoute->getState() == SynthRouteState_OPEN) {
+		MasterClockNanos delay = pushedNanos - synthRoute->getMIDIClockNanos();
+		if (delay <= 0) return;
+		if (synthRoute->reportMIDIProgress(pushedNanos)) {
+			usleep(FREE_RUNNING_SLEEP_TIME / MasterClock::NANOS_PER_MICROSECOND);
+			continue;
+		}
+		usleep((delay < MAX_SLEEP_TIME ? delay : MAX_SLEEP_TIME) / MasterClock::NANOS_PER_MICROSECOND + 1);
+	}
+}
+
 quint32 SMFProcessor::estimateRemainingTime(const QMidiEventList &midiEvents, int currentEventIx) {
 	MasterClockNanos tick = midiTick;
 	MasterClockNanos totalNanos = 0;
@@ -163,17 +384,15 @@ quint32 SMFProcessor::estimateRemainingTime(const QMidiEventList &midiEvents, in
 }
 
 void SMFProcessor::seek(SynthRoute *synthRoute, const QMidiEventList &midiEvents, int &currentEventIx, MasterClockNanos &currentEventNanos, const MasterClockNanos seekNanos) {
-	while (!driver->stopProcessing && synthRoute->getState() == SynthRouteState_OPEN && currentEventNanos < seekNanos) {
+	SeekStateCollector seekStateCollector;
+	while (!driver->stopProcessing && isSynthRouteAvailable(synthRoute) && currentEventNanos < seekNanos) {
 		const QMidiEvent &e = midiEvents.at(currentEventIx);
 		switch (e.getType()) {
-			case SHORT_MESSAGE: {
-				quint32 msg = e.getShortMessage();
-				// Ignore NoteOn & NoteOff while seeking
-				if ((msg & 0xE0) != 0x80) synthRoute->playMIDIShortMessageNow(msg);
+			case SHORT_MESSAGE:
+				seekStateCollector.playMIDIShortMessage(synthRoute, e.getShortMessage());
 				break;
-			}
 			case SYSEX:
-				synthRoute->playMIDISysexNow(e.getSysexData(), e.getSysexLen());
+				seekStateCollector.playMIDISysex(synthRoute, midiEvents.getSysexData(e), midiEvents.getSysexLen(e));
 				break;
 			case SET_TEMPO: {
 				uint tempo = e.getShortMessage();
@@ -185,10 +404,11 @@ void SMFProcessor::seek(SynthRoute *synthRoute, const QMidiEventList &midiEvents
 				break;
 		}
 		int nextEventIx = currentEventIx + 1;
-		if (midiEvents.size() <= nextEventIx) break;
+		if (midiEvents.count() <= nextEventIx) break;
 		currentEventIx = nextEventIx;
 		currentEventNanos += midiEvents.at(currentEventIx).getTimestamp() * midiTick;
 	}
+	if (isSynthRouteAvailable(synthRoute)) seekStateCollector.flush(synthRoute);
 }
 
 SMFDriver::SMFDriver(Master *useMaster) : MidiDriver(useMaster), processor(this) {
@@ -233,6 +453,25 @@ void SMFDriver::jump(int newPosition) {
 	seekPosition = newPosition;
 }
 
+// Queues the file to continue the playback with once the current one ends. An empty file name cancels.
+void SMFDriver::setNextFileName(QString fileName) {
+	QMutexLocker nextFileNameLocker(&nextFileNameMutex);
+	nextFileName = fileName;
+}
+
+QString SMFDriver::getNextFileName() {
+	QMutexLocker nextFileNameLocker(&nextFileNameMutex);
+	return nextFileName;
+}
+
+// Dequeues the file unless it has been replaced since.
+bool SMFDriver::takeNextFileName(const QString &fileName) {
+	QMutexLocker nextFileNameLocker(&nextFileNameMutex);
+	if (nextFileName != fileName) return false;
+	nextFileName.clear();
+	return true;
+}
+
 SMFDriver::~SMFDriver() {
 	stop();
 }
@@ -1,6 +1,7 @@
 #ifndef SMF_DRIVER_H
 #define SMF_DRIVER_H
 
+#include <QMutex>
 #include <QThread>
 
 #include "MidiDriver.h"
@@ -10,6 +11,26 @@
 
 class SMFDriver;
 
+// Parses the file queued to follow the one playing in the background, so that the playback continues with no gap
+// between the files.
+class SMFPreparser : public QThread {
+public:
+	MidiParser parser;
+
+	SMFPreparser();
+	// Must not be called while running. An empty file name merely discards the previous result.
+	void start(QString fileName);
+	const QString &getFileName() const;
+	// Only meaningful once the thread has finished.
+	bool isParsed() const;
+
+private:
+	QString fileName;
+	bool parsed;
+
+	void run();
+};
+
 class SMFProcessor : public QThread {
 	Q_OBJECT
 
@@ -19,11 +40,15 @@ public:
 
 private:
 	MidiParser parser;
+	SMFPreparser preparser;
 	SMFDriver *driver;
 	MasterClockNanos midiTick;
 	QString fileName;
 
 	void run();
+	void updatePreparser();
+	bool advanceToNextFile();
+	void waitForPushedEvents(SynthRoute *synthRoute, const MasterClockNanos pushedNanos);
 	quint32 estimateRemainingTime(const QMidiEventList &midiEvents, int currentEventIx);
 	void seek(SynthRoute *synthRoute, const QMidiEventList &midiEvents, int &currentEventIx, MasterClockNanos &currentEventNanos, const MasterClockNanos seekNanos);
 };
@@ -42,6 +67,7 @@ public:
 	void setBPM(quint32 newBPM);
 	void setFastForwardingFactor(uint useFastForwardingFactor);
 	void jump(int newPosition);
+	void setNextFileName(QString fileName);
 
 private:
 	SMFProcessor processor;
@@ -50,9 +76,15 @@ private:
 	QAtomicInt bpmUpdate;
 	volatile uint fastForwardingFactor;
 	QAtomicInt seekPosition;
+	QMutex nextFileNameMutex;
+	QString nextFileName;
+
+	QString getNextFileName();
+	bool takeNextFileName(const QString &fileName);
 
 signals:
 	void playbackFinished();
+	void playbackAdvanced(QString fileName);
 	void playbackTimeChanged(quint64 currentNanos, quint32 totalSeconds);
 	void tempoUpdated(quint32 newTempo);
 };
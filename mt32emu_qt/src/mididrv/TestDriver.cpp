@@ -16,15 +16,29 @@
 
 #include "TestDriver.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include <QtCore>
 
 #include "../MasterClock.h"
 #include "../MidiSession.h"
+#include "../SynthRoute.h"
 
 static const qint64 TEST1_EVENT_INTERVAL_NANOS = 8000000; // 256 samples;
 
-TestProcessor::TestProcessor(TestMidiDriver *useTestMidiDriver) : testMidiDriver(useTestMidiDriver), stopProcessing(false) {
-}
+// The probes are spaced widely enough for the note and its reverb to decay below the quiet level of the onset detector.
+static const qint64 PROBE_INTERVAL_NANOS = 1000000000;
+static const qint64 PROBE_NOTE_NANOS = 50000000;
+// Note-on and note-off of the middle C at the full velocity on channel 2, which the first part listens to by default.
+static const MT32Emu::Bit32u PROBE_NOTE_ON_MESSAGE = 0x7F3C91;
+static const MT32Emu::Bit32u PROBE_NOTE_OFF_MESSAGE = 0x003C81;
+// The latency distribution is reported after this many probes, and when the measurement stops.
+static const int PROBE_REPORT_COUNT = 30;
+
+TestProcessor::TestProcessor(TestMidiDriver *useTestMidiDriver, TestMode useTestMode) :
+	testMidiDriver(useTestMidiDriver), testMode(useTestMode), stopProcessing(false)
+{}
 
 void TestProcessor::start() {
 	stopProcessing = false;
@@ -36,8 +50,23 @@ void TestProcessor::stop() {
 }
 
 void TestProcessor::run() {
-	MidiSession *session1 = testMidiDriver->createMidiSession("Test 1");
-	MidiSession *session2 = NULL;//testMidiDriver->createMidiSession("Test 2");
+	if (testMode == TestMode_LATENCY_MEASUREMENT) {
+		MidiSession *session = testMidiDriver->createMidiSession("Latency Measurement");
+		measureLatency(session);
+		testMidiDriver->deleteMidiSession(session);
+	} else {
+		MidiSession *session1 = testMidiDriver->createMidiSession("Test 1");
+		MidiSession *session2 = NULL;//testMidiDriver->createMidiSession("Test 2");
+		sendEventStream(session1, session2);
+		testMidiDriver->deleteMidiSession(session1);
+		if (session2 != NULL) {
+			testMidiDriver->deleteMidiSession(session2);
+		}
+	}
+	qDebug() << "Test processor finished";
+}
+
+void TestProcessor::sendEventStream(MidiSession *session1, MidiSession *session2) {
 	qint64 currentNanos = MasterClock::getClockNanos();
 	qDebug() << currentNanos;
 	bool alt = false;
@@ -50,16 +79,69 @@ void TestProcessor::run() {
 		currentNanos += TEST1_EVENT_INTERVAL_NANOS;
 		MasterClock::sleepUntilClockNanos(currentNanos);
 	}
-	qDebug() << "Test processor finished";
-	testMidiDriver->deleteMidiSession(session1);
-	if (session2 != NULL) {
-		testMidiDriver->deleteMidiSession(session2);
+}
+
+// Each probe is a note-on timestamped with the time it is sent, just like the MIDI drivers timestamp the received events.
+// The latency is the time from sending the note-on till its onset is played by the audio device, as estimated
+// by the audio stream from the fill of the audio buffer. A probe is lost when no onset follows it within the interval,
+// e.g. due to an underrun or when the first part is muted.
+void TestProcessor::measureLatency(MidiSession *session) {
+	SynthRoute *synthRoute = session->getSynthRoute();
+	QVector<qint64> latencies;
+	uint lostProbeCount = 0;
+	MasterClockNanos probeSendNanos = 0;
+	MasterClockNanos nextProbeNanos = MasterClock::getClockNanos() + PROBE_INTERVAL_NANOS;
+	while (!stopProcessing) {
+		MasterClock::sleepUntilClockNanos(nextProbeNanos);
+		nextProbeNanos += PROBE_INTERVAL_NANOS;
+		if (probeSendNanos != 0) {
+			MasterClockNanos onsetNanos = synthRoute->getLastOutputOnsetNanos();
+			if (onsetNanos > probeSendNanos) {
+				latencies.append(onsetNanos - probeSendNanos);
+			} else {
+				lostProbeCount++;
+			}
+			probeSendNanos = 0;
+			if ((latencies.size() + int(lostProbeCount)) % PROBE_REPORT_COUNT == 0) reportLatency(session, latencies, lostProbeCount);
+		}
+		if (stopProcessing) break;
+		// The audio stream may be yet to start or restarting, the probe is skipped then.
+		if (!synthRoute->setOnsetDetectionEnabled(true)) continue;
+		probeSendNanos = MasterClock::getClockNanos();
+		synthRoute->pushMIDIShortMessage(*session, PROBE_NOTE_ON_MESSAGE, probeSendNanos);
+		MasterClock::sleepUntilClockNanos(probeSendNanos + PROBE_NOTE_NANOS);
+		synthRoute->pushMIDIShortMessage(*session, PROBE_NOTE_OFF_MESSAGE, MasterClock::getClockNanos());
+	}
+	synthRoute->setOnsetDetectionEnabled(false);
+	if (!latencies.isEmpty() || lostProbeCount > 0) reportLatency(session, latencies, lostProbeCount);
+}
+
+// The jitter is given as the standard deviation of the latency.
+void TestProcessor::reportLatency(MidiSession *session, QVector<qint64> latencies, uint lostProbeCount) {
+	const QString audioOutputDescription = session->getSynthRoute()->getAudioOutputDescription();
+	if (latencies.isEmpty()) {
+		qDebug() << "TestProcessor: No onsets detected for" << lostProbeCount << "probes on" << qPrintable(audioOutputDescription);
+		return;
 	}
+	std::sort(latencies.begin(), latencies.end());
+	const int count = latencies.size();
+	double sum = 0;
+	for (int i = 0; i < count; i++) sum += latencies.at(i);
+	const double mean = sum / count;
+	double sumOfSquares = 0;
+	for (int i = 0; i < count; i++) sumOfSquares += (latencies.at(i) - mean) * (latencies.at(i) - mean);
+	const double nanosPerMilli = double(MasterClock::NANOS_PER_MILLISECOND);
+	qDebug() << "TestProcessor: MIDI-to-audio latency on" << qPrintable(audioOutputDescription) << "- probes:" << count << "lost:" << lostProbeCount
+		<< "min/median/95%/max (ms):" << latencies.first() / nanosPerMilli << latencies.at(count / 2) / nanosPerMilli
+		<< latencies.at((count * 95) / 100) / nanosPerMilli << latencies.last() / nanosPerMilli
+		<< "mean (ms):" << mean / nanosPerMilli << "jitter (ms):" << sqrt(sumOfSquares / count) / nanosPerMilli;
 }
 
 
-TestMidiDriver::TestMidiDriver(Master *useMaster) : MidiDriver(useMaster), processor(this) {
-	name = "Test Driver";
+TestMidiDriver::TestMidiDriver(Master *useMaster, TestMode useTestMode) :
+	MidiDriver(useMaster), testMode(useTestMode), processor(this, useTestMode)
+{
+	name = testMode == TestMode_LATENCY_MEASUREMENT ? "Latency Measurement Driver" : "Test Driver";
 }
 
 void TestMidiDriver::start() {
@@ -68,7 +150,7 @@ void TestMidiDriver::start() {
 
 void TestMidiDriver::stop() {
 	processor.stop();
-	MidiDriver::waitForProcessingThread(processor, TEST1_EVENT_INTERVAL_NANOS);
+	MidiDriver::waitForProcessingThread(processor, testMode == TestMode_LATENCY_MEASUREMENT ? PROBE_INTERVAL_NANOS : TEST1_EVENT_INTERVAL_NANOS);
 }
 
 TestMidiDriver::~TestMidiDriver() {
@@ -2,16 +2,25 @@
 #define TEST_MIDI_DRIVER_H
 
 #include <QThread>
+#include <QVector>
 
 #include "MidiDriver.h"
 #include "../Master.h"
 
 class TestMidiDriver;
+class MidiSession;
+
+enum TestMode {
+	// Sends a stream of dummy events at a fixed rate, to exercise the MIDI timing paths.
+	TestMode_EVENT_STREAM,
+	// Sends timestamped note-on probes and measures when their onsets appear in the output of the audio stream.
+	TestMode_LATENCY_MEASUREMENT
+};
 
 class TestProcessor : public QThread {
 	Q_OBJECT
 public:
-	TestProcessor(TestMidiDriver *useTestMidiDriver);
+	TestProcessor(TestMidiDriver *useTestMidiDriver, TestMode useTestMode);
 	void start();
 	void stop();
 
@@ -20,21 +29,25 @@ protected:
 
 private:
 	TestMidiDriver *testMidiDriver;
+	const TestMode testMode;
 	volatile bool stopProcessing;
+
+	void sendEventStream(MidiSession *session1, MidiSession *session2);
+	void measureLatency(MidiSession *session);
+	void reportLatency(MidiSession *session, QVector<qint64> latencies, uint lostProbeCount);
 };
 
 class TestMidiDriver : public MidiDriver {
 	Q_OBJECT
 	friend class TestProcessor;
 public:
-	TestMidiDriver(Master *master);
+	TestMidiDriver(Master *master, TestMode testMode = TestMode_EVENT_STREAM);
 	~TestMidiDriver();
 	void start();
 	void stop();
 private:
+	const TestMode testMode;
 	TestProcessor processor;
 };
 
 #endif
-
-
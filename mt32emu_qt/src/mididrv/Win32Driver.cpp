@@ -16,6 +16,8 @@
 
 #include <QMessageBox>
 
+#include <cstdio>
+
 #include <windows.h>
 #include <process.h>
 
@@ -48,6 +50,48 @@
 
 #endif // _WIN32_WINNT < 0x0500
 
+// Private message sent by the MME MIDI driver to inform when MIDI data becomes available in the shared ring buffer
+// of the session specified in wParam. Used since protocol version 2.
+#define WM_APP_DRV_RING_HAS_DATA WM_APP + 2
+
+#define SHARED_RING_BUFFER_NAME_FORMAT "mt32emu_midi_ring_%08X"
+#define SHARED_RING_EVENT_NAME_FORMAT "mt32emu_midi_ring_event_%08X"
+#define SHARED_RING_BUFFER_MAGIC 0x474E4952
+#define SHARED_RING_BUFFER_SIZE 0x10000
+#define SHARED_RING_RECORD_HEADER_LENGTH 16
+
+/* Since protocol version 2, the driver forwards MIDI data to each session via a ring buffer in a named shared memory
+ * section, so that the client threads don't wait until every message is processed. The layout must match the one
+ * used in mt32emu_win32drv. The section starts with the header below followed by the data area of the ring buffer.
+ * The record format is as follows:
+ * DWORD - record length including the payload padded to a multiple of 4 bytes, 0 marks a wrap to the beginning
+ * DWORD - Sysex length, 0 for short message
+ * DWORD[2] - nanosecond timestamp
+ * data payload:
+ * - either DWORD for short message
+ * - raw Sysex data bytes
+ * The read position is only modified by the synth application and the write position by the driver.
+ * Since protocol version 3, each session also gets a named auto-reset event that the driver signals instead of sending
+ * WM_APP_DRV_RING_HAS_DATA, the message window thread waits for the events along with the window messages.
+ * As the number of wait slots is limited, the sessions beyond that are still notified with the window message.
+ */
+struct SharedRingBufferHeader {
+	DWORD magic;
+	DWORD size;
+	volatile LONG readPos;
+	volatile LONG writePos;
+	// Set by the driver when it sends WM_APP_DRV_RING_HAS_DATA, cleared before the data is read
+	volatile LONG notificationPending;
+	DWORD reserved;
+};
+
+struct Win32MidiDriver::SharedRingBuffer {
+	HANDLE mapping;
+	SharedRingBufferHeader *header;
+	// NULL unless the driver signals the data by the event
+	HANDLE dataEvent;
+};
+
 static Win32MidiDriver *driver;
 static HWND hwnd = NULL;
 static MasterClockNanos startMasterClock; // FIXME: Should actually be per-session but doesn't seem to be a real win
@@ -58,6 +102,8 @@ LRESULT CALLBACK Win32MidiDriver::midiInProc(HWND hwnd, UINT uMsg, WPARAM wParam
 	case WM_APP: {
 		// Closing session
 		quint32 midiSessionID = (quint32)wParam;
+		driver->processSharedRingBuffer(midiSessionID);
+		driver->deleteSharedRingBuffer(midiSessionID);
 		MidiSession *midiSession = driver->findMidiSession(midiSessionID);
 		driver->midiSessionIDs.removeAll(midiSessionID);
 		if (!midiSession) {
@@ -69,6 +115,9 @@ LRESULT CALLBACK Win32MidiDriver::midiInProc(HWND hwnd, UINT uMsg, WPARAM wParam
 		return 1;
 	}
 
+	case WM_APP_DRV_RING_HAS_DATA:
+		return driver->processSharedRingBuffer((quint32)wParam) ? 1 : 0;
+
 #if _WIN32_WINNT < 0x0500
 	case WM_APP_DRV_HAS_DATA: {
 		const PBYTE ringBuffer = (PBYTE)lParam;
@@ -166,6 +215,7 @@ LRESULT CALLBACK Win32MidiDriver::midiInProc(HWND hwnd, UINT uMsg, WPARAM wParam
 				driver->showBalloon("Connected application:", appName);
 				qDebug() << "Win32MidiDriver: Connected application" << appName;
 				qDebug() << "Win32MidiDriver: Session ID:" << "0x" + QString::number(midiSessionID, 16) << "with protocol version" << data[2];
+				if (data[2] >= 2) driver->createSharedRingBuffer(midiSessionID, data[2] >= 3);
 				return (LRESULT)midiSessionID;
 			} else if (data[1] == 0) { // Special value, mark of a short MIDI message
 				// Process short MIDI message
@@ -202,6 +252,96 @@ MidiSession *Win32MidiDriver::findMidiSession(quint32 midiSessionID) {
 	return ((midiSessionIx < 0) || (midiSessions.size() <= midiSessionIx)) ? NULL : midiSessions.at(midiSessionIx);
 }
 
+void Win32MidiDriver::createSharedRingBuffer(quint32 midiSessionID, bool useDataEvent) {
+	char name[32];
+	sprintf(name, SHARED_RING_BUFFER_NAME_FORMAT, midiSessionID);
+	HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(SharedRingBufferHeader) + SHARED_RING_BUFFER_SIZE, name);
+	if (mapping == NULL) {
+		qDebug() << "Win32MidiDriver: Error creating shared ring buffer" << GetLastError();
+		return;
+	}
+	SharedRingBufferHeader *header = (SharedRingBufferHeader *)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	if (header == NULL) {
+		qDebug() << "Win32MidiDriver: Error mapping shared ring buffer" << GetLastError();
+		CloseHandle(mapping);
+		return;
+	}
+	header->size = SHARED_RING_BUFFER_SIZE;
+	header->readPos = 0;
+	header->writePos = 0;
+	header->notificationPending = 0;
+	// The driver doesn't use the buffer unless the magic matches
+	header->magic = SHARED_RING_BUFFER_MAGIC;
+	SharedRingBuffer *ringBuffer = new SharedRingBuffer;
+	ringBuffer->mapping = mapping;
+	ringBuffer->header = header;
+	ringBuffer->dataEvent = NULL;
+	// The event must exist before the driver opens the section, it looks for the event right after that
+	if (useDataEvent && dataEventSessionIDs.size() < MAX_DATA_EVENT_COUNT) {
+		sprintf(name, SHARED_RING_EVENT_NAME_FORMAT, midiSessionID);
+		ringBuffer->dataEvent = CreateEventA(NULL, FALSE, FALSE, name);
+		if (ringBuffer->dataEvent == NULL) {
+			qDebug() << "Win32MidiDriver: Error creating shared ring buffer event" << GetLastError();
+		} else {
+			dataEventSessionIDs.append(midiSessionID);
+		}
+	}
+	sharedRingBuffers.insert(midiSessionID, ringBuffer);
+}
+
+// Returns false if the session has no shared ring buffer.
+bool Win32MidiDriver::processSharedRingBuffer(quint32 midiSessionID) {
+	SharedRingBuffer *ringBuffer = sharedRingBuffers.value(midiSessionID);
+	if (ringBuffer == NULL) return false;
+	SharedRingBufferHeader *header = ringBuffer->header;
+	// The driver sends another notification for the data written after the flag is cleared
+	InterlockedExchange(&header->notificationPending, 0);
+	const PBYTE ringData = (PBYTE)(header + 1);
+	MidiSession *midiSession = findMidiSession(midiSessionID);
+	LONG readPos = header->readPos;
+	const LONG writePos = InterlockedCompareExchange(&header->writePos, 0, 0);
+	while (readPos != writePos) {
+		const PDWORD record = (PDWORD)&ringData[readPos];
+		const DWORD recordLength = record[0];
+		if (recordLength == 0) {
+			readPos = 0;
+			continue;
+		}
+		const DWORD sysexLength = record[1];
+		if (recordLength < SHARED_RING_RECORD_HEADER_LENGTH + 4 || DWORD(SHARED_RING_BUFFER_SIZE - readPos) <= recordLength
+			|| recordLength - SHARED_RING_RECORD_HEADER_LENGTH < sysexLength)
+		{
+			qDebug() << "Win32MidiDriver: Invalid shared ring buffer record length:" << recordLength;
+			readPos = writePos;
+			break;
+		}
+		if (midiSession != NULL) {
+			LARGE_INTEGER t = {{record[2], (LONG)record[3]}};
+			const MasterClockNanos timestamp = t.QuadPart - startMasterClock;
+			if (sysexLength == 0) {
+				midiSession->getSynthRoute()->pushMIDIShortMessage(*midiSession, record[4], timestamp);
+			} else {
+				midiSession->getSynthRoute()->pushMIDISysex(*midiSession, (MT32Emu::Bit8u *)&record[4], sysexLength, timestamp);
+			}
+		}
+		readPos += recordLength;
+	}
+	InterlockedExchange(&header->readPos, readPos);
+	return true;
+}
+
+void Win32MidiDriver::deleteSharedRingBuffer(quint32 midiSessionID) {
+	SharedRingBuffer *ringBuffer = sharedRingBuffers.take(midiSessionID);
+	if (ringBuffer == NULL) return;
+	if (ringBuffer->dataEvent != NULL) {
+		CloseHandle(ringBuffer->dataEvent);
+		dataEventSessionIDs.removeAll(midiSessionID);
+	}
+	UnmapViewOfFile(ringBuffer->header);
+	CloseHandle(ringBuffer->mapping);
+	delete ringBuffer;
+}
+
 void Win32MidiInProcessor::run() {
 	qDebug() << "Win32MidiDriver: Win32MidiInProcessor started";
 	HINSTANCE hInstance = GetModuleHandle(NULL);
@@ -250,8 +390,36 @@ void Win32MidiInProcessor::run() {
 		DispatchMessage(&msg);
 	}
 #else // _WIN32_WINNT < 0x0500
-	MSG msg;
-	GetMessage(&msg, hwnd, WM_QUIT, WM_QUIT);
+	for (;;) {
+		// The sessions only change while the messages are dispatched, so the list is rebuilt in every iteration
+		HANDLE dataEvents[Win32MidiDriver::MAX_DATA_EVENT_COUNT];
+		const QList<quint32> &dataEventSessionIDs = driver->dataEventSessionIDs;
+		const DWORD dataEventCount = DWORD(dataEventSessionIDs.size());
+		for (DWORD i = 0; i < dataEventCount; i++) {
+			dataEvents[i] = driver->sharedRingBuffers.value(dataEventSessionIDs.at(i))->dataEvent;
+		}
+		DWORD res = MsgWaitForMultipleObjects(dataEventCount, dataEvents, FALSE, INFINITE, QS_ALLINPUT);
+		if (res < WAIT_OBJECT_0 + dataEventCount) {
+			driver->processSharedRingBuffer(dataEventSessionIDs.at(res - WAIT_OBJECT_0));
+			continue;
+		}
+		if (res != WAIT_OBJECT_0 + dataEventCount) {
+			DWORD err = GetLastError();
+			qDebug() << "Win32MidiDriver: Error in MsgWaitForMultipleObjects()" << err;
+			break;
+		}
+		MSG msg;
+		bool quit = false;
+		// Sent messages are dispatched within PeekMessage()
+		while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+			if (msg.message == WM_QUIT) {
+				quit = true;
+				break;
+			}
+			DispatchMessage(&msg);
+		}
+		if (quit) break;
+	}
 #endif // _WIN32_WINNT < 0x0500
 	hwnd = NULL;
 	qDebug() << "Win32MidiDriver: Win32MidiInProcessor stopped";
@@ -272,6 +440,10 @@ void Win32MidiDriver::stop() {
 		PostMessage(hwnd, WM_QUIT, 0, 0);
 		waitForProcessingThread(midiInProcessor, 10 * MasterClock::NANOS_PER_MILLISECOND);
 	}
+	QList<quint32> sharedRingBufferIDs = sharedRingBuffers.keys();
+	for (int i = 0; i < sharedRingBufferIDs.size(); i++) {
+		deleteSharedRingBuffer(sharedRingBufferIDs[i]);
+	}
 	for (int i = 0; i < midiInPorts.size(); i++) {
 		delete midiInPorts[i];
 		deleteMidiSession(midiInSessions[i]);
@@ -32,6 +32,11 @@ protected:
 class Win32MidiDriver : public MidiDriver {
 	friend class Win32MidiInProcessor;
 private:
+	struct SharedRingBuffer;
+
+	// One wait slot of MsgWaitForMultipleObjects() is taken by the window messages
+	static const int MAX_DATA_EVENT_COUNT = MAXIMUM_WAIT_OBJECTS - 1;
+
 	static LRESULT CALLBACK midiInProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 	static void enumPorts(QList<QString> &midiInPortNames);
 
@@ -39,8 +44,15 @@ private:
 	QList<unsigned int> midiSessionIDs;
 	QList<Win32MidiIn *> midiInPorts;
 	QList<MidiSession *> midiInSessions;
+	// Only accessed from the message window thread
+	QHash<quint32, SharedRingBuffer *> sharedRingBuffers;
+	// Sessions whose shared ring buffers are signalled by the events, in the order of the wait slots
+	QList<quint32> dataEventSessionIDs;
 
 	MidiSession *findMidiSession(quint32 midiSessionID);
+	void createSharedRingBuffer(quint32 midiSessionID, bool useDataEvent);
+	bool processSharedRingBuffer(quint32 midiSessionID);
+	void deleteSharedRingBuffer(quint32 midiSessionID);
 
 public:
 	Win32MidiDriver(Master *useMaster);
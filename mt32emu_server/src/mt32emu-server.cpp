@@ -0,0 +1,782 @@
+/* Copyright (C) 2011-2021 Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cerrno>
+#include <csignal>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <stdint.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <mt32emu/mt32emu.h>
+
+#if MT32EMU_VERSION_MAJOR != 2 || MT32EMU_VERSION_MINOR < 4
+#error Incompatible mt32emu library version
+#endif
+
+using namespace MT32Emu;
+
+/* The server speaks the same MIDI protocol as the network MIDI driver of mt32emu-qt. Each UDP datagram carries
+ * a fragment of the raw MIDI stream of the client preceded by the header below. The multi-byte fields are in network
+ * byte order.
+ * BYTE[4] - magic "MUNT"
+ * BYTE - protocol version, currently 1
+ * BYTE - flags, FLAG_END_OF_SESSION tells the client is done, the session is closed after the payload is processed
+ * WORD - sequence number, incremented by one with each datagram, the datagrams that come out of order are dropped
+ * QWORD - the time the datagram is sent in nanoseconds, as measured by a monotonic clock of the client
+ * An empty payload is fine, so that the client may keep the session alive while not playing.
+ *
+ * The audio rendered for a session is sent back to the address the MIDI comes from in datagrams of the fixed number
+ * of frames, each one preceded by the header below. The multi-byte header fields are in network byte order.
+ * BYTE[4] - magic "MUNA"
+ * BYTE - protocol version, currently 1
+ * BYTE - sample format, SAMPLE_FORMAT_S16LE_STEREO is the only one defined by now
+ * WORD - sequence number, incremented by one with each datagram
+ * DWORD - sample rate in Hz
+ * QWORD - position of the first frame in the stream
+ * The payload contains interleaved stereo frames of 16-bit signed little-endian samples.
+ */
+static const char MIDI_PACKET_MAGIC[] = {'M', 'U', 'N', 'T'};
+static const char AUDIO_PACKET_MAGIC[] = {'M', 'U', 'N', 'A'};
+static const Bit8u PROTOCOL_VERSION = 1;
+static const Bit8u FLAG_END_OF_SESSION = 1;
+static const Bit8u SAMPLE_FORMAT_S16LE_STEREO = 1;
+static const unsigned int MIDI_PACKET_HEADER_LENGTH = 16;
+static const unsigned int AUDIO_PACKET_HEADER_LENGTH = 20;
+static const unsigned int MAX_PACKET_LENGTH = 65536;
+
+static const int64_t NANOS_PER_SECOND = 1000000000;
+static const int64_t NANOS_PER_MILLISECOND = 1000000;
+static const int64_t SYNC_WINDOW_NANOS = 2 * NANOS_PER_SECOND;
+static const int64_t MAX_JITTER_DELAY_NANOS = 100 * NANOS_PER_MILLISECOND;
+// A change of the clock offset above that makes the client clock to be synchronised anew, e.g. when the client restarts.
+static const int64_t CLOCK_RESYNC_THRESHOLD_NANOS = NANOS_PER_SECOND;
+static const int POLL_INTERVAL_MILLIS = 100;
+
+static const unsigned int DEFAULT_UDP_PORT = 7619;
+static const unsigned int DEFAULT_SAMPLE_RATE = 48000;
+static const unsigned int DEFAULT_PACKET_FRAMES = 128;
+static const unsigned int MAX_PACKET_FRAMES = (MAX_PACKET_LENGTH - AUDIO_PACKET_HEADER_LENGTH) / 4;
+static const unsigned int DEFAULT_RENDER_THREAD_COUNT = 1;
+static const unsigned int MAX_RENDER_THREAD_COUNT = 64;
+static const unsigned int DEFAULT_MAX_SESSION_COUNT = 32;
+static const unsigned int MAX_SESSION_COUNT = 1024;
+static const unsigned int DEFAULT_SESSION_TIMEOUT_SECONDS = 10;
+// The synths of the finished sessions are reinitialised and kept for the new clients, up to that many.
+static const unsigned int MAX_SPARE_SESSION_COUNT = 4;
+
+struct Options {
+	const char *controlROMFileName;
+	const char *pcmROMFileName;
+	unsigned int udpPort;
+	unsigned int sampleRate;
+	unsigned int packetFrames;
+	unsigned int latencyMillis;
+	unsigned int renderThreadCount;
+	unsigned int maxSessionCount;
+	unsigned int sessionTimeoutSeconds;
+	unsigned int partialCount;
+	RendererType rendererType;
+	bool verbose;
+};
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static int64_t getClockNanos() {
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return int64_t(now.tv_sec) * NANOS_PER_SECOND + now.tv_nsec;
+}
+
+static void sleepUntil(int64_t nanos) {
+	timespec deadline;
+	deadline.tv_sec = time_t(nanos / NANOS_PER_SECOND);
+	deadline.tv_nsec = long(nanos % NANOS_PER_SECOND);
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR && !stopRequested) {}
+}
+
+static void readBigEndian(const Bit8u *data, unsigned int length, uint64_t &value) {
+	value = 0;
+	for (unsigned int i = 0; i < length; i++) {
+		value = (value << 8) | data[i];
+	}
+}
+
+static void writeBigEndian(Bit8u *data, unsigned int length, uint64_t value) {
+	for (unsigned int i = length; i-- > 0;) {
+		data[i] = Bit8u(value);
+		value >>= 8;
+	}
+}
+
+static void handleStopSignal(int) {
+	stopRequested = 1;
+}
+
+// Keeps the console quiet unless verbose output is requested, the synth reports each program change and SysEx otherwise.
+class ServerReportHandler : public ReportHandler {
+public:
+	explicit ServerReportHandler(bool useVerbose) : verbose(useVerbose) {}
+
+	void printDebug(const char *fmt, va_list list) {
+		if (!verbose) return;
+		vfprintf(stderr, fmt, list);
+		fprintf(stderr, "\n");
+	}
+
+private:
+	const bool verbose;
+};
+
+// Maps the timestamps of a client clock onto the local monotonic clock and absorbs the network jitter. The offset between
+// the clocks is estimated by the fastest transit observed within the last two windows, the events are delayed by the largest
+// excess transit time seen within the same windows, up to a limit. This follows NetworkMidiClockSync in mt32emu-qt.
+class ClockSync {
+public:
+	ClockSync() : synchronised(false), jitterDelay(0) {}
+
+	// Returns the local time an event sent at the client clock time should be played at, given its arrival time.
+	int64_t map(int64_t senderNanos, int64_t arrivalNanos) {
+		const int64_t offset = arrivalNanos - senderNanos;
+		if (synchronised && (offset < minOffset - CLOCK_RESYNC_THRESHOLD_NANOS || minOffset + MAX_JITTER_DELAY_NANOS + CLOCK_RESYNC_THRESHOLD_NANOS < offset)) {
+			synchronised = false;
+		}
+		if (!synchronised) {
+			synchronised = true;
+			windowStartNanos = arrivalNanos;
+			minOffset = offset;
+			windowMinOffset = offset;
+			jitterDelay = 0;
+			windowJitterDelay = 0;
+			lastEventNanos = arrivalNanos;
+		} else if (SYNC_WINDOW_NANOS <= arrivalNanos - windowStartNanos) {
+			// The estimates made within the previous window expire, those of the one just finished remain
+			windowStartNanos = arrivalNanos;
+			minOffset = windowMinOffset;
+			jitterDelay = windowJitterDelay;
+			windowMinOffset = offset;
+			windowJitterDelay = 0;
+		}
+		if (offset < windowMinOffset) windowMinOffset = offset;
+		if (offset < minOffset) minOffset = offset;
+		int64_t excessTransitNanos = offset - minOffset;
+		if (MAX_JITTER_DELAY_NANOS < excessTransitNanos) excessTransitNanos = MAX_JITTER_DELAY_NANOS;
+		if (windowJitterDelay < excessTransitNanos) windowJitterDelay = excessTransitNanos;
+		if (jitterDelay < excessTransitNanos) jitterDelay = excessTransitNanos;
+		int64_t eventNanos = senderNanos + minOffset + jitterDelay;
+		// The events must not be reordered when the delay shrinks
+		if (eventNanos < lastEventNanos) eventNanos = lastEventNanos;
+		lastEventNanos = eventNanos;
+		return eventNanos;
+	}
+
+private:
+	bool synchronised;
+	int64_t windowStartNanos;
+	int64_t minOffset;
+	int64_t windowMinOffset;
+	int64_t jitterDelay;
+	int64_t windowJitterDelay;
+	int64_t lastEventNanos;
+};
+
+class RenderThread;
+
+// A synth instance dedicated to a client along with the state of both streams. The MIDI input is handled by the receiving
+// thread, which is the only one that plays MIDI messages on the synth, while the audio is rendered by the assigned render
+// thread, so that Synth::playMsg() is safe to use without further synchronisation. Once finished, a session may be kept
+// spare and reused for a new client, which saves opening a synth anew.
+class Session {
+public:
+	uint64_t key;
+	sockaddr_in address;
+	RenderThread *renderThread;
+	// Links the list of all the sessions and the one of the render thread, respectively.
+	Session *nextSession;
+	Session *nextRenderedSession;
+	// The local time the first frame of the audio stream is rendered at, as scheduled by the render thread.
+	int64_t streamStartNanos;
+	uint64_t streamPosition;
+	Bit16u audioSequenceNumber;
+	Bit16u lastMidiSequenceNumber;
+	int64_t lastArrivalNanos;
+	ClockSync clockSync;
+
+	Session(uint64_t useKey, const sockaddr_in &useAddress, bool verbose) :
+		key(useKey),
+		address(useAddress),
+		renderThread(NULL),
+		nextSession(NULL),
+		nextRenderedSession(NULL),
+		streamStartNanos(0),
+		streamPosition(0),
+		audioSequenceNumber(0),
+		lastMidiSequenceNumber(0),
+		lastArrivalNanos(0),
+		reportHandler(verbose),
+		synth(&reportHandler),
+		parser(NULL),
+		sampleRateConverter(NULL),
+		latencyFrames(0)
+	{}
+
+	~Session() {
+		delete sampleRateConverter;
+		delete parser;
+		synth.close();
+	}
+
+	bool open(const ROMImage &controlROMImage, const ROMImage &pcmROMImage, const Options &options) {
+		synth.setReducedMemoryFootprintEnabled(true);
+		synth.selectRendererType(options.rendererType);
+		const AnalogOutputMode analogOutputMode = SampleRateConverter::getBestAnalogOutputMode(options.sampleRate);
+		if (!synth.open(controlROMImage, pcmROMImage, options.partialCount, analogOutputMode)) return false;
+		parser = new DefaultMidiStreamParser(synth);
+		sampleRateConverter = new SampleRateConverter(synth, options.sampleRate, SamplerateConversionQuality_LOW_LATENCY);
+		latencyFrames = double(options.latencyMillis) * options.sampleRate / 1000.0;
+		return true;
+	}
+
+	// Brings the finished session to the state of a newly opened one, keeping the allocations of the synth.
+	bool reinitialise(const Options &options) {
+		delete sampleRateConverter;
+		sampleRateConverter = NULL;
+		delete parser;
+		parser = NULL;
+		if (!synth.reinitialise(SampleRateConverter::getBestAnalogOutputMode(options.sampleRate))) return false;
+		parser = new DefaultMidiStreamParser(synth);
+		sampleRateConverter = new SampleRateConverter(synth, options.sampleRate, SamplerateConversionQuality_LOW_LATENCY);
+		return true;
+	}
+
+	// Assigns the reinitialised session to a new client.
+	void reuse(uint64_t useKey, const sockaddr_in &useAddress) {
+		key = useKey;
+		address = useAddress;
+		renderThread = NULL;
+		nextSession = NULL;
+		nextRenderedSession = NULL;
+		streamStartNanos = 0;
+		streamPosition = 0;
+		audioSequenceNumber = 0;
+		lastMidiSequenceNumber = 0;
+		lastArrivalNanos = 0;
+		clockSync = ClockSync();
+	}
+
+	// Plays the MIDI stream fragment at the local time, the events that are late are played as soon as possible.
+	void playMidi(const Bit8u *stream, Bit32u length, int64_t eventNanos, unsigned int sampleRate) {
+		double outputTimestamp = double(eventNanos - streamStartNanos) * sampleRate / double(NANOS_PER_SECOND) + latencyFrames;
+		if (outputTimestamp < double(streamPosition)) outputTimestamp = double(streamPosition);
+		const double synthTimestamp = sampleRateConverter->convertOutputToSynthTimestamp(outputTimestamp);
+		parser->setTimestamp(Bit32u(uint64_t(synthTimestamp)));
+		parser->parseStream(stream, length);
+	}
+
+	void render(Bit16s *buffer, unsigned int frameCount) {
+		sampleRateConverter->getOutputSamples(buffer, frameCount);
+		streamPosition += frameCount;
+	}
+
+private:
+	ServerReportHandler reportHandler;
+	Synth synth;
+	DefaultMidiStreamParser *parser;
+	SampleRateConverter *sampleRateConverter;
+	double latencyFrames;
+};
+
+// Renders the audio of the sessions assigned at the pace of the real time and sends it to the clients. The sessions
+// are only added and removed by the receiving thread, with the mutex locked.
+class RenderThread {
+public:
+	pthread_mutex_t mutex;
+	unsigned int sessionCount;
+
+	RenderThread(int useSocketFD, const Options &useOptions) :
+		sessionCount(0),
+		socketFD(useSocketFD),
+		options(useOptions),
+		sessions(NULL),
+		periodIx(0)
+	{
+		pthread_mutex_init(&mutex, NULL);
+		packet = new Bit8u[AUDIO_PACKET_HEADER_LENGTH + 4 * options.packetFrames];
+		memcpy(packet, AUDIO_PACKET_MAGIC, sizeof(AUDIO_PACKET_MAGIC));
+		packet[4] = PROTOCOL_VERSION;
+		packet[5] = SAMPLE_FORMAT_S16LE_STEREO;
+		writeBigEndian(packet + 8, 4, options.sampleRate);
+	}
+
+	~RenderThread() {
+		delete[] packet;
+		pthread_mutex_destroy(&mutex);
+	}
+
+	bool start() {
+		scheduleStartNanos = getClockNanos();
+		return pthread_create(&thread, NULL, run, this) == 0;
+	}
+
+	void join() {
+		pthread_join(thread, NULL);
+	}
+
+	// Makes the session rendered starting from the next period. Must be invoked with the mutex locked.
+	void addSession(Session *session) {
+		session->renderThread = this;
+		session->streamStartNanos = getPeriodStartNanos(periodIx);
+		session->nextRenderedSession = sessions;
+		sessions = session;
+		sessionCount++;
+	}
+
+	// Must be invoked with the mutex locked.
+	void removeSession(Session *session) {
+		for (Session **link = &sessions; *link != NULL; link = &(*link)->nextRenderedSession) {
+			if (*link == session) {
+				*link = session->nextRenderedSession;
+				sessionCount--;
+				return;
+			}
+		}
+	}
+
+private:
+	const int socketFD;
+	const Options &options;
+	pthread_t thread;
+	Session *sessions;
+	int64_t scheduleStartNanos;
+	// The index of the period to be rendered next, only changed with the mutex locked.
+	uint64_t periodIx;
+	Bit8u *packet;
+
+	static void *run(void *arg) {
+		static_cast<RenderThread *>(arg)->renderLoop();
+		return NULL;
+	}
+
+	// Computes the period start times from the index, so that the error doesn't accumulate.
+	int64_t getPeriodStartNanos(uint64_t ix) const {
+		return scheduleStartNanos + int64_t(ix * options.packetFrames * uint64_t(NANOS_PER_SECOND) / options.sampleRate);
+	}
+
+	void renderLoop() {
+		Bit16s *buffer = reinterpret_cast<Bit16s *>(packet + AUDIO_PACKET_HEADER_LENGTH);
+		const size_t packetLength = AUDIO_PACKET_HEADER_LENGTH + 4 * options.packetFrames;
+		while (!stopRequested) {
+			// When overloaded, the periods are rendered back to back until the schedule is met again, so the streams
+			// stay continuous and the clients may absorb the delay with their buffers.
+			sleepUntil(getPeriodStartNanos(periodIx));
+			pthread_mutex_lock(&mutex);
+			for (Session *session = sessions; session != NULL; session = session->nextRenderedSession) {
+				writeBigEndian(packet + 6, 2, session->audioSequenceNumber++);
+				writeBigEndian(packet + 12, 8, session->streamPosition);
+				session->render(buffer, options.packetFrames);
+				convertToLittleEndian(buffer, 2 * options.packetFrames);
+				sendto(socketFD, packet, packetLength, 0, reinterpret_cast<const sockaddr *>(&session->address), sizeof(session->address));
+			}
+			periodIx++;
+			pthread_mutex_unlock(&mutex);
+		}
+	}
+
+	static void convertToLittleEndian(Bit16s *buffer, unsigned int sampleCount) {
+		static const Bit16u probe = 1;
+		if (*reinterpret_cast<const Bit8u *>(&probe) == 1) return;
+		Bit8u *bytes = reinterpret_cast<Bit8u *>(buffer);
+		for (unsigned int i = 0; i < sampleCount; i++) {
+			const Bit8u highByte = bytes[2 * i];
+			bytes[2 * i] = bytes[2 * i + 1];
+			bytes[2 * i + 1] = highByte;
+		}
+	}
+};
+
+class Server {
+public:
+	Server(const ROMImage &useControlROMImage, const ROMImage &usePCMROMImage, const Options &useOptions) :
+		controlROMImage(useControlROMImage),
+		pcmROMImage(usePCMROMImage),
+		options(useOptions),
+		socketFD(-1),
+		renderThreadCount(0),
+		renderThreadsRunning(false),
+		sessions(NULL),
+		sessionCount(0),
+		spareSessions(NULL),
+		spareSessionCount(0)
+	{}
+
+	~Server() {
+		stopRenderThreads();
+		while (sessions != NULL) {
+			deleteSession(sessions, "closed");
+		}
+		while (spareSessions != NULL) {
+			Session *nextSpareSession = spareSessions->nextSession;
+			delete spareSessions;
+			spareSessions = nextSpareSession;
+		}
+		for (unsigned int i = 0; i < renderThreadCount; i++) {
+			delete renderThreads[i];
+		}
+		if (socketFD != -1) close(socketFD);
+	}
+
+	bool start() {
+		socketFD = socket(AF_INET, SOCK_DGRAM, 0);
+		if (socketFD == -1) {
+			fprintf(stderr, "Can't create UDP socket: %s\n", strerror(errno));
+			return false;
+		}
+		sockaddr_in address;
+		memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_ANY);
+		address.sin_port = htons(Bit16u(options.udpPort));
+		if (bind(socketFD, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+			fprintf(stderr, "Can't bind UDP port %u: %s\n", options.udpPort, strerror(errno));
+			return false;
+		}
+		renderThreadsRunning = true;
+		for (; renderThreadCount < options.renderThreadCount; renderThreadCount++) {
+			renderThreads[renderThreadCount] = new RenderThread(socketFD, options);
+			if (!renderThreads[renderThreadCount]->start()) {
+				fprintf(stderr, "Can't start render thread\n");
+				delete renderThreads[renderThreadCount];
+				stopRenderThreads();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void run() {
+		Bit8u *packet = new Bit8u[MAX_PACKET_LENGTH];
+		int64_t lastTimeoutCheckNanos = getClockNanos();
+		while (!stopRequested) {
+			pollfd pfd;
+			pfd.fd = socketFD;
+			pfd.events = POLLIN;
+			pfd.revents = 0;
+			int pollRes = poll(&pfd, 1, POLL_INTERVAL_MILLIS);
+			if (pollRes < 0 && errno != EINTR) {
+				fprintf(stderr, "Poll failed: %s\n", strerror(errno));
+				break;
+			}
+			if (pollRes > 0) {
+				sockaddr_in clientAddress;
+				socklen_t clientAddressLength = sizeof(clientAddress);
+				ssize_t packetLength = recvfrom(socketFD, packet, MAX_PACKET_LENGTH, 0, reinterpret_cast<sockaddr *>(&clientAddress), &clientAddressLength);
+				if (packetLength >= 0) processPacket(clientAddress, packet, Bit32u(packetLength));
+			}
+			const int64_t nanosNow = getClockNanos();
+			if (nanosNow - lastTimeoutCheckNanos < NANOS_PER_SECOND) continue;
+			lastTimeoutCheckNanos = nanosNow;
+			const int64_t sessionTimeoutNanos = options.sessionTimeoutSeconds * NANOS_PER_SECOND;
+			for (Session *session = sessions; session != NULL;) {
+				Session *nextSession = session->nextSession;
+				if (sessionTimeoutNanos < nanosNow - session->lastArrivalNanos) {
+					deleteSession(session, "timed out");
+				}
+				session = nextSession;
+			}
+		}
+		delete[] packet;
+		stopRenderThreads();
+	}
+
+private:
+	const ROMImage &controlROMImage;
+	const ROMImage &pcmROMImage;
+	const Options &options;
+	int socketFD;
+	RenderThread *renderThreads[MAX_RENDER_THREAD_COUNT];
+	unsigned int renderThreadCount;
+	bool renderThreadsRunning;
+	// The list of all the sessions is only used by the receiving thread, the render threads keep their own lists.
+	Session *sessions;
+	unsigned int sessionCount;
+	// The finished sessions kept for reuse, linked by nextSession.
+	Session *spareSessions;
+	unsigned int spareSessionCount;
+
+	void processPacket(const sockaddr_in &clientAddress, const Bit8u *packet, Bit32u packetLength) {
+		const int64_t arrivalNanos = getClockNanos();
+		if (packetLength < MIDI_PACKET_HEADER_LENGTH || memcmp(packet, MIDI_PACKET_MAGIC, sizeof(MIDI_PACKET_MAGIC)) != 0 || packet[4] != PROTOCOL_VERSION) {
+			if (options.verbose) fprintf(stderr, "Ignored unrecognised packet of length %u\n", packetLength);
+			return;
+		}
+		const Bit8u flags = packet[5];
+		uint64_t sequenceNumber;
+		readBigEndian(packet + 6, 2, sequenceNumber);
+		uint64_t senderNanos;
+		readBigEndian(packet + 8, 8, senderNanos);
+		const uint64_t key = (uint64_t(ntohl(clientAddress.sin_addr.s_addr)) << 16) | ntohs(clientAddress.sin_port);
+		Session *session = findSession(key);
+		if (session == NULL) {
+			if (flags & FLAG_END_OF_SESSION) return;
+			session = createSession(key, clientAddress);
+			if (session == NULL) return;
+		} else {
+			const Bit16s sequenceGap = Bit16s(Bit16u(sequenceNumber) - session->lastMidiSequenceNumber);
+			if (sequenceGap <= 0) {
+				if (options.verbose) logSession(session, "dropped packet received out of order");
+				return;
+			}
+			if (sequenceGap > 1 && options.verbose) logSession(session, "lost packets");
+		}
+		session->lastMidiSequenceNumber = Bit16u(sequenceNumber);
+		session->lastArrivalNanos = arrivalNanos;
+		if (MIDI_PACKET_HEADER_LENGTH < packetLength) {
+			const int64_t eventNanos = session->clockSync.map(int64_t(senderNanos), arrivalNanos);
+			session->playMidi(packet + MIDI_PACKET_HEADER_LENGTH, packetLength - MIDI_PACKET_HEADER_LENGTH, eventNanos, options.sampleRate);
+		}
+		if (flags & FLAG_END_OF_SESSION) {
+			deleteSession(session, "finished");
+		}
+	}
+
+	void stopRenderThreads() {
+		if (!renderThreadsRunning) return;
+		renderThreadsRunning = false;
+		stopRequested = 1;
+		for (unsigned int i = 0; i < renderThreadCount; i++) {
+			renderThreads[i]->join();
+		}
+	}
+
+	Session *findSession(uint64_t key) const {
+		for (Session *session = sessions; session != NULL; session = session->nextSession) {
+			if (session->key == key) return session;
+		}
+		return NULL;
+	}
+
+	Session *createSession(uint64_t key, const sockaddr_in &clientAddress) {
+		Session *session;
+		if (spareSessions != NULL && sessionCount < options.maxSessionCount) {
+			session = spareSessions;
+			spareSessions = session->nextSession;
+			spareSessionCount--;
+			session->reuse(key, clientAddress);
+		} else {
+			session = new Session(key, clientAddress, options.verbose);
+			if (options.maxSessionCount <= sessionCount) {
+				logSession(session, "rejected, too many sessions");
+				delete session;
+				return NULL;
+			}
+			if (!session->open(controlROMImage, pcmROMImage, options)) {
+				logSession(session, "rejected, failed to open synth");
+				delete session;
+				return NULL;
+			}
+		}
+		// The sessions are spread evenly among the render threads.
+		RenderThread *renderThread = renderThreads[0];
+		for (unsigned int i = 1; i < renderThreadCount; i++) {
+			if (renderThreads[i]->sessionCount < renderThread->sessionCount) renderThread = renderThreads[i];
+		}
+		pthread_mutex_lock(&renderThread->mutex);
+		renderThread->addSession(session);
+		pthread_mutex_unlock(&renderThread->mutex);
+		session->nextSession = sessions;
+		sessions = session;
+		sessionCount++;
+		logSession(session, "connected");
+		return session;
+	}
+
+	void deleteSession(Session *session, const char *reason) {
+		RenderThread *renderThread = session->renderThread;
+		pthread_mutex_lock(&renderThread->mutex);
+		renderThread->removeSession(session);
+		pthread_mutex_unlock(&renderThread->mutex);
+		for (Session **link = &sessions; *link != NULL; link = &(*link)->nextSession) {
+			if (*link == session) {
+				*link = session->nextSession;
+				break;
+			}
+		}
+		sessionCount--;
+		logSession(session, reason);
+		// The reinitialisation is done while the session is idle, so that a new client doesn't wait for it.
+		if (spareSessionCount < MAX_SPARE_SESSION_COUNT && !stopRequested && session->reinitialise(options)) {
+			session->nextSession = spareSessions;
+			spareSessions = session;
+			spareSessionCount++;
+		} else {
+			delete session;
+		}
+	}
+
+	void logSession(const Session *session, const char *event) const {
+		char addressText[INET_ADDRSTRLEN];
+		inet_ntop(AF_INET, &session->address.sin_addr, addressText, sizeof(addressText));
+		fprintf(stderr, "Session %s:%u %s, %u session(s) active\n", addressText, ntohs(session->address.sin_port), event, sessionCount);
+	}
+};
+
+static void printUsage() {
+	fprintf(stderr,
+		"mt32emu-server v" VERSION "\n"
+		"Usage: mt32emu-server [options] <control ROM file> <PCM ROM file>\n"
+		"Options:\n"
+		"  -p <port>       UDP port to listen on (default %u)\n"
+		"  -r <rate>       Output sample rate in Hz (default %u)\n"
+		"  -f <frames>     Number of frames per audio packet (default %u, maximum %u)\n"
+		"  -l <millis>     Additional latency of the MIDI events (default: the duration of one audio packet)\n"
+		"  -j <count>      Number of render threads (default %u, maximum %u)\n"
+		"  -n <count>      Maximum number of sessions (default %u, maximum %u)\n"
+		"  -t <seconds>    Close sessions idle for that long (default %u)\n"
+		"  -a <count>      Maximum number of partials per synth (default %u)\n"
+		"  -e <renderer>   Renderer type: 0 - 16-bit integer, 1 - float, 2 - float wavetable (default 0)\n"
+		"  -v              Verbose output\n",
+		DEFAULT_UDP_PORT, DEFAULT_SAMPLE_RATE, DEFAULT_PACKET_FRAMES, MAX_PACKET_FRAMES, DEFAULT_RENDER_THREAD_COUNT, MAX_RENDER_THREAD_COUNT,
+		DEFAULT_MAX_SESSION_COUNT, MAX_SESSION_COUNT, DEFAULT_SESSION_TIMEOUT_SECONDS, DEFAULT_MAX_PARTIALS);
+}
+
+static bool parseNumber(const char *text, unsigned int minValue, unsigned int maxValue, unsigned int &value) {
+	char *end;
+	const unsigned long parsedValue = strtoul(text, &end, 10);
+	if (*text == 0 || *end != 0 || parsedValue < minValue || maxValue < parsedValue) return false;
+	value = static_cast<unsigned int>(parsedValue);
+	return true;
+}
+
+static bool parseOptions(int argc, char *argv[], Options &options) {
+	options.udpPort = DEFAULT_UDP_PORT;
+	options.sampleRate = DEFAULT_SAMPLE_RATE;
+	options.packetFrames = DEFAULT_PACKET_FRAMES;
+	options.latencyMillis = 0;
+	options.renderThreadCount = DEFAULT_RENDER_THREAD_COUNT;
+	options.maxSessionCount = DEFAULT_MAX_SESSION_COUNT;
+	options.sessionTimeoutSeconds = DEFAULT_SESSION_TIMEOUT_SECONDS;
+	options.partialCount = DEFAULT_MAX_PARTIALS;
+	options.rendererType = RendererType_BIT16S;
+	options.verbose = false;
+	bool latencySet = false;
+	int opt;
+	while ((opt = getopt(argc, argv, "p:r:f:l:j:n:t:a:e:v")) != -1) {
+		unsigned int rendererType = 0;
+		bool valid = true;
+		switch (opt) {
+		case 'p':
+			valid = parseNumber(optarg, 1, 65535, options.udpPort);
+			break;
+		case 'r':
+			valid = parseNumber(optarg, 8000, 192000, options.sampleRate);
+			break;
+		case 'f':
+			valid = parseNumber(optarg, 1, MAX_PACKET_FRAMES, options.packetFrames);
+			break;
+		case 'l':
+			valid = parseNumber(optarg, 0, 1000, options.latencyMillis);
+			latencySet = true;
+			break;
+		case 'j':
+			valid = parseNumber(optarg, 1, MAX_RENDER_THREAD_COUNT, options.renderThreadCount);
+			break;
+		case 'n':
+			valid = parseNumber(optarg, 1, MAX_SESSION_COUNT, options.maxSessionCount);
+			break;
+		case 't':
+			valid = parseNumber(optarg, 1, 3600, options.sessionTimeoutSeconds);
+			break;
+		case 'a':
+			valid = parseNumber(optarg, 8, 256, options.partialCount);
+			break;
+		case 'e':
+			valid = parseNumber(optarg, 0, 2, rendererType);
+			options.rendererType = RendererType(rendererType);
+			break;
+		case 'v':
+			options.verbose = true;
+			break;
+		default:
+			return false;
+		}
+		if (!valid) {
+			fprintf(stderr, "Invalid value of option -%c: %s\n", opt, optarg);
+			return false;
+		}
+	}
+	if (argc - optind != 2) return false;
+	options.controlROMFileName = argv[optind];
+	options.pcmROMFileName = argv[optind + 1];
+	if (!latencySet) {
+		// One packet ahead covers the events that arrive while the period they belong to is being rendered.
+		options.latencyMillis = (1000 * options.packetFrames + options.sampleRate - 1) / options.sampleRate;
+	}
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) {
+		printUsage();
+		return 1;
+	}
+
+	// The ROM images are loaded once and shared by all the sessions, so are the ROM data derived from them.
+	FileStream controlROMFile;
+	FileStream pcmROMFile;
+	if (!controlROMFile.open(options.controlROMFileName)) {
+		fprintf(stderr, "Can't open control ROM file %s\n", options.controlROMFileName);
+		return 1;
+	}
+	if (!pcmROMFile.open(options.pcmROMFileName)) {
+		fprintf(stderr, "Can't open PCM ROM file %s\n", options.pcmROMFileName);
+		return 1;
+	}
+	const ROMImage *controlROMImage = ROMImage::makeROMImage(&controlROMFile);
+	const ROMImage *pcmROMImage = ROMImage::makeROMImage(&pcmROMFile);
+	if (controlROMImage->getROMInfo() == NULL || pcmROMImage->getROMInfo() == NULL) {
+		fprintf(stderr, "Unrecognised ROM files\n");
+		ROMImage::freeROMImage(controlROMImage);
+		ROMImage::freeROMImage(pcmROMImage);
+		return 1;
+	}
+
+	signal(SIGINT, handleStopSignal);
+	signal(SIGTERM, handleStopSignal);
+
+	int exitCode = 1;
+	{
+		Server server(*controlROMImage, *pcmROMImage, options);
+		if (server.start()) {
+			fprintf(stderr, "Listening on UDP port %u, rendering at %u Hz in packets of %u frames\n", options.udpPort, options.sampleRate, options.packetFrames);
+			server.run();
+			exitCode = 0;
+		}
+	}
+
+	ROMImage::freeROMImage(controlROMImage);
+	ROMImage::freeROMImage(pcmROMImage);
+	return exitCode;
+}
@@ -27,6 +27,12 @@
 #include <cstring>
 
 #include <glib.h>
+#include <glib/gstdio.h>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
 
 #define MT32EMU_API_TYPE 3
 #include <mt32emu/mt32emu.h>
@@ -46,6 +52,37 @@ static const int DEFAULT_BUFFER_SIZE = 128 * 1024;
 // Maximum number of frames to render in each pass while waiting for reverb to become inactive.
 static const unsigned int MAX_REVERB_END_FRAMES = 8192;
 
+// Number of output blocks, each of the buffer size, the encoded samples are cycled through.
+static const unsigned int OUTPUT_BLOCK_COUNT = 3;
+
+// Raw stream IDs 0-5 select the DAC output streams, the part streams follow them, left and right for each part.
+static const int RAW_STREAM_ID_COUNT = 6 + 2 * 9;
+static const int FIRST_PART_RAW_STREAM_ID = 6;
+static const int MAX_RAW_STREAM_COUNT = RAW_STREAM_ID_COUNT;
+
+// Maximum number of the additional outputs written from the same rendering.
+static const int MAX_TEE_OUTPUT_COUNT = 8;
+
+// Output file name that stands for the standard output.
+static const char STDOUT_FILENAME[] = "-";
+
+// A pre-timed event stream file consists of the signature and the format version, 4 bytes each, followed by event records.
+// A record contains the timestamp in samples at the synth sample rate relative to the start of the file, and either a short
+// message or the length of a sysex combined with EVENT_STREAM_SYSEX_FLAG. The bytes of a sysex follow, padded up to
+// a multiple of 4. All the words are little-endian and 4-byte aligned, so that the events are read straight from
+// the memory-mapped file. The records with a zero message only advance the time, e.g. to the end of the last track.
+static const char EVENT_STREAM_SIGNATURE[] = "MTES";
+static const MT32Emu::Bit32u EVENT_STREAM_VERSION = 1;
+static const unsigned int EVENT_STREAM_HEADER_SIZE = 8;
+static const unsigned int EVENT_STREAM_RECORD_SIZE = 8;
+static const MT32Emu::Bit32u EVENT_STREAM_SYSEX_FLAG = 0x80000000;
+static const char EVENT_STREAM_EXTENSION[] = ".mtes";
+
+// Identifies the way the cached output files are named, so that changing it invalidates the existing cache entries.
+static const char RENDER_CACHE_VERSION[] = "smf2wav render cache 1";
+// Size of the buffer the cached output files and the rendered segments are copied through.
+static const size_t COPY_BUFFER_SIZE = 64 * 1024;
+
 static const int HEADEROFFS_RIFFLEN = 4;
 static const int HEADEROFFS_FORMAT_TAG = 20;
 static const int HEADEROFFS_SAMPLERATE = 24;
@@ -70,19 +107,22 @@ static const MT32Emu::AnalogOutputMode ANALOG_OUTPUT_MODES[] = {
 	MT32Emu::AnalogOutputMode_DIGITAL_ONLY,
 	MT32Emu::AnalogOutputMode_COARSE,
 	MT32Emu::AnalogOutputMode_ACCURATE,
-	MT32Emu::AnalogOutputMode_OVERSAMPLED
+	MT32Emu::AnalogOutputMode_OVERSAMPLED,
+	MT32Emu::AnalogOutputMode_DECIMATED
 };
 
 static const MT32Emu::RendererType RENDERER_TYPES[] = {
 	MT32Emu::RendererType_BIT16S,
-	MT32Emu::RendererType_FLOAT
+	MT32Emu::RendererType_FLOAT,
+	MT32Emu::RendererType_FLOAT_WAVETABLE
 };
 
 static const MT32Emu::SamplerateConversionQuality SRC_QUALITIES[] = {
 	MT32Emu::SamplerateConversionQuality_FASTEST,
 	MT32Emu::SamplerateConversionQuality_FAST,
 	MT32Emu::SamplerateConversionQuality_GOOD,
-	MT32Emu::SamplerateConversionQuality_BEST
+	MT32Emu::SamplerateConversionQuality_BEST,
+	MT32Emu::SamplerateConversionQuality_LOW_LATENCY
 };
 
 struct Options {
@@ -90,6 +130,12 @@ struct Options {
 	gchar *outputFilename;
 	gboolean force;
 	gboolean quiet;
+	gint jobCount;
+	gboolean benchmark;
+	gboolean writeEventStreams;
+	gchar *cacheDir;
+	gint segmentCount;
+	gdouble segmentPreroll;
 
 	gchar *romDir;
 	unsigned int bufferFrameCount;
@@ -101,8 +147,14 @@ struct Options {
 	MT32Emu::RendererType rendererType;
 	MT32Emu::SamplerateConversionQuality srcQuality;
 	int partialCount;
-	int rawChannelMap[8];
+	int rawChannelMap[MAX_RAW_STREAM_COUNT];
 	int rawChannelCount;
+	// Set when any of the part streams is requested, which are rendered instead of the DAC output streams.
+	bool rawPartStreams;
+	// The additional outputs converted from the samples of the main output, each in the sample format of its own.
+	int teeOutputCount;
+	gchar *teeOutputFilenames[MAX_TEE_OUTPUT_COUNT];
+	OUTPUT_SAMPLE_FORMAT teeOutputSampleFormats[MAX_TEE_OUTPUT_COUNT];
 
 	unsigned int renderMinFrames;
 	unsigned int renderMaxFrames;
@@ -111,17 +163,65 @@ struct Options {
 	gint recordMaxLA32EndSilentFrames;
 	gboolean waitForLA32;
 	gboolean waitForReverb;
+	// Linear peak level relative to the full scale below which the reverb tail is considered inaudible, 0 if disabled.
+	double reverbEndLevel;
 	gboolean sendAllNotesOff;
 	gboolean niceAmpRamp;
 	gboolean nicePanning;
 	gboolean nicePartialMixing;
+	gboolean dither;
+	gdouble partialCullingThreshold;
+	gboolean rhythmHitCache;
+};
+
+// Informational messages are redirected to the standard error when the output goes to the standard output.
+static FILE *messageStream = stdout;
+
+struct OutputBlock {
+	MT32Emu::Bit8u *data;
+	unsigned int byteCount;
+};
+
+struct TeeWriter;
+
+// Writes the filled output blocks to the file on a thread of its own, so that rendering only waits for the disk
+// when all the blocks are pending. The end block terminates the thread. Each block is also passed to the tee writers,
+// and it is only reused once all of them have converted it.
+struct OutputWriter {
+	FILE *file;
+	GAsyncQueue *filledBlocks;
+	GAsyncQueue *freeBlocks;
+	GThread *thread;
+	OutputBlock blocks[OUTPUT_BLOCK_COUNT];
+	OutputBlock endBlock;
+	TeeWriter *teeWriters;
+	unsigned int teeWriterCount;
+	GAsyncQueue *convertedBlocks;
+};
+
+// Converts the blocks written to the main output to another sample format and writes them to a file of its own
+// on a thread of its own, so that the conversions of all the outputs run in parallel while rendering proceeds.
+// The layout of the frames and the byte order remain those of the main output.
+struct TeeWriter {
+	FILE *file;
+	OUTPUT_SAMPLE_FORMAT sampleFormat;
+	OUTPUT_SAMPLE_FORMAT sourceSampleFormat;
+	bool bigEndian;
+	OutputWriter *outputWriter;
+	GAsyncQueue *pendingBlocks;
+	GThread *thread;
+	MT32Emu::Bit8u *data;
 };
 
 struct State {
 	void *stereoSampleBuffer;
-	void *rawSampleBuffer[6];
+	void *rawSampleBuffer[RAW_STREAM_ID_COUNT];
 	MT32Emu::Service &service;
 	FILE *outputFile;
+	OutputWriter *outputWriter;
+	// Encoded samples are collected here and passed to the output writer once the block is full.
+	OutputBlock *outputBlock;
+	unsigned int outputBufferSize;
 	bool lastInputFile;
 	bool firstNoiseEncountered;
 	unsigned long unwrittenSilentFrames;
@@ -136,6 +236,12 @@ static void freeOptions(Options *options) {
 	options->outputFilename = NULL;
 	g_free(options->romDir);
 	options->romDir = NULL;
+	g_free(options->cacheDir);
+	options->cacheDir = NULL;
+	for (int i = 0; i < options->teeOutputCount; i++) {
+		g_free(options->teeOutputFilenames[i]);
+	}
+	options->teeOutputCount = 0;
 }
 
 static bool parseOptions(int argc, char *argv[], Options *options) {
@@ -149,11 +255,19 @@ static bool parseOptions(int argc, char *argv[], Options *options) {
 	gint renderMinFrames = 0;
 	gint renderMaxFrames = -1;
 	gchar **rawStreams = NULL;
+	gchar **teeOutputs = NULL;
 	gchar *deprecatedSysexFile = NULL;
+	gdouble reverbEndLevelDb = 0;
 	options->inputFilenames = NULL;
 	options->outputFilename = NULL;
 	options->force = false;
 	options->quiet = false;
+	options->jobCount = 0;
+	options->benchmark = false;
+	options->writeEventStreams = false;
+	options->cacheDir = NULL;
+	options->segmentCount = 0;
+	options->segmentPreroll = 10;
 
 	options->romDir = NULL;
 
@@ -163,6 +277,8 @@ static bool parseOptions(int argc, char *argv[], Options *options) {
 	options->srcQuality = SRC_QUALITIES[2];
 	options->sampleRate = 0;
 	options->rawChannelCount = 0;
+	options->rawPartStreams = false;
+	options->teeOutputCount = 0;
 	options->outputSampleFormat = OUTPUT_SAMPLE_FORMAT_SINT16;
 
 	options->recordMaxStartSilentFrames = 0;
@@ -174,11 +290,30 @@ static bool parseOptions(int argc, char *argv[], Options *options) {
 	options->niceAmpRamp = true;
 	options->nicePanning = false;
 	options->nicePartialMixing = false;
+	options->dither = false;
+	options->partialCullingThreshold = 0.0;
+	options->rhythmHitCache = false;
 	// FIXME: Perhaps there's a nicer way to represent long argument descriptions...
 	GOptionEntry entries[] = {
-		{"output", 'o', 0, G_OPTION_ARG_FILENAME, &options->outputFilename, "Output file (default: last source file name with \".wav\" appended)", "<filename>"},
+		{"output", 'o', 0, G_OPTION_ARG_FILENAME, &options->outputFilename, "Output file (default: last source file name with \".wav\" appended)\n"
+		 "                Use - to write to the standard output, e.g. to pipe into an encoder. When it is not seekable, the WAVE header has the sizes unset.", "<filename>"},
 		{"force", 'f', 0, G_OPTION_ARG_NONE, &options->force, "Overwrite the output file if it already exists", NULL},
 		{"quiet", 'q', 0, G_OPTION_ARG_NONE, &options->quiet, "Be quiet", NULL},
+		{"jobs", 'j', 0, G_OPTION_ARG_INT, &options->jobCount, "Convert each source file to a separate output file named after it, running this many conversions in parallel.\n"
+		 "                Cannot be combined with -o. Each file is played through an emulator of its own, starting in the power-on state.", "<job_count>"},
+		{"benchmark", 0, 0, G_OPTION_ARG_NONE, &options->benchmark, "Render the source files without writing any output and report the rendering performance.\n"
+		 "                Cannot be combined with -j.", NULL},
+		{"write-event-stream", 0, 0, G_OPTION_ARG_NONE, &options->writeEventStreams, "Instead of rendering, convert each SMF source file to a pre-timed event stream file named after it with \".mtes\" appended.\n"
+		 "                Such files are accepted as source files and load faster, e.g. when the same files are rendered repeatedly with different settings.\n"
+		 "                Cannot be combined with -o, -j and --benchmark.", NULL},
+		{"cache-dir", 0, 0, G_OPTION_ARG_FILENAME, &options->cacheDir, "Keep a copy of each output file in this directory, named after a hash of the source files, the ROMs and all the settings.\n"
+		 "                When the same conversion is requested again, the output is copied from there without rendering.\n"
+		 "                Cannot be combined with --benchmark and --write-event-stream.", "<directory>"},
+		{"segments", 0, 0, G_OPTION_ARG_INT, &options->segmentCount, "Split the source file into this many parts of equal duration and render them in parallel, each through an emulator of its own.\n"
+		 "                Each part starts in the state the preceding events leave the emulator in, except for the notes, and is preceded by a pre-roll that is rendered but not recorded.\n"
+		 "                The parts are spliced, so the output only matches the sequential rendering as long as nothing started before a pre-roll still sounds at the start of the part.\n"
+		 "                Requires a single SMF or event stream source file. Cannot be combined with -j, --benchmark and --write-event-stream.", "<count>"},
+		{"segment-preroll", 0, 0, G_OPTION_ARG_DOUBLE, &options->segmentPreroll, "Duration of the pre-roll before each part rendered with --segments in seconds (default: 10)", "<seconds>"},
 
 		{"rom-dir", 'm', 0, G_OPTION_ARG_STRING, &options->romDir, "Directory in which ROMs are stored (including trailing path separator)", "<directory>"},
 		// buffer-size determines the maximum number of frames to be rendered by the emulator in one pass.
@@ -191,7 +326,8 @@ static bool parseOptions(int argc, char *argv[], Options *options) {
 		 "                 0: FASTEST\n"
 		 "                 1: FAST\n"
 		 "                 2: GOOD\n"
-		 "                 3: BEST", "<src_quality>"},
+		 "                 3: BEST\n"
+		 "                 4: LOW_LATENCY", "<src_quality>"},
 
 		{"max-partials", 'x', 0, G_OPTION_ARG_INT, &partialCount, "The maximum number of partials playing simultaneously.\n"
 		 "                (minimum: 8, default: 32)\n", "<max-partials>"},
@@ -201,15 +337,28 @@ static bool parseOptions(int argc, char *argv[], Options *options) {
 		 "                 0: DISABLED\n"
 		 "                 1: COARSE\n"
 		 "                 2: ACCURATE\n"
-		 "                 3: OVERSAMPLED", "<analog_output_mode>"},
+		 "                 3: OVERSAMPLED\n"
+		 "                 4: DECIMATED", "<analog_output_mode>"},
 
 		{"renderer-type", 'r', 0, G_OPTION_ARG_INT, &rendererTypeIx, "Type of samples to use in renderer and wave generator (default: 0)\n"
 		 "                 0: Integer 16-bit\n"
-		 "                 1: Float 32-bit\n", "<renderer_type>"},
+		 "                 1: Float 32-bit\n"
+		 "                 2: Float 32-bit with wavetable synthesis, faster but less accurate\n", "<renderer_type>"},
 
 		{"output-sample-format", 0, 0, G_OPTION_ARG_INT, &outputSampleFormat, "Format of output samples (default: 0)\n"
 		"                 0: Signed Integer 16-bit\n"
 		"                 1: IEEE 754 Float 32-bit\n", "<output_sample_format>"},
+		{"tee-output", 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &teeOutputs, "Also write the output to this file, with the samples in the specified format (see output-sample-format), e.g. 1:float.wav.\n"
+		 "                This option can be specified multiple times (up to 8). The output is rendered once, and each file is converted from the samples of the main output\n"
+		 "                on a thread of its own. The files are WAVE or raw files with the same streams as the main output. A float file converted from 16-bit samples\n"
+		 "                only has 16-bit resolution, so the main output should have the most precise sample format. Use - to write to the standard output.\n"
+		 "                Cannot be combined with -j, --benchmark, --write-event-stream, --segments and --cache-dir.", "<sample_format>:<filename>"},
+		{"dither", 0, 0, G_OPTION_ARG_NONE, &options->dither, "Apply TPDF dither when converting float samples to 16-bit integers.\n"
+		 "                Only has effect with the float renderers (-r 1 or 2) and 16-bit output samples.", NULL},
+		{"partial-culling", 0, 0, G_OPTION_ARG_DOUBLE, &options->partialCullingThreshold, "Skip the wave generation of partials attenuated by TVA at least this much in dB.\n"
+		 "                Speeds up the rendering of long release tails at the cost of accuracy (default: 0, disabled)", "<attenuation>"},
+		{"rhythm-hit-cache", 0, 0, G_OPTION_ARG_NONE, &options->rhythmHitCache, "Replay the recorded output of the repeated rhythm part hits.\n"
+		 "                Speeds up the rendering of drum-heavy files, the hits take over the random pitch envelope timing of the first hit", NULL},
 
 		{"dac-input-mode", 'd', 0, G_OPTION_ARG_INT, &dacInputModeIx, "LA-32 to DAC input mode (default: 0)\n"
 		 "                Ignored if -w is used (in which case 1/PURE is always used)\n"
@@ -218,7 +367,7 @@ static bool parseOptions(int argc, char *argv[], Options *options) {
 		 "                 2: GENERATION1\n"
 		 "                 3: GENERATION2", "<dac_input_mode>"},
 		{"raw-stream", 'w', 0, G_OPTION_ARG_STRING_ARRAY, &rawStreams, "Write a raw file with signed 16-bit big-endian samples instead of a WAVE file, and include the specified channel.\n"
-		 "                This option can be specified multiple times (up to eight), in which case streams will be written to the file multiplexed sample-by-sample in the order given.\n"
+		 "                This option can be specified multiple times (up to 24), in which case streams will be written to the file multiplexed sample-by-sample in the order given.\n"
 		 "                Available stream IDs:\n"
 		 "                -1: Dummy stream filled with 0\n"
 		 "                 0: [LA32] Left non-reverb\n"
@@ -226,7 +375,10 @@ static bool parseOptions(int argc, char *argv[], Options *options) {
 		 "                 2: [LA32] Left reverb dry\n"
 		 "                 3: [LA32] Right reverb dry\n"
 		 "                 4: [Reverb] Left reverb wet\n"
-		 "                 5: [Reverb] Right reverb wet", "<stream_id>"},
+		 "                 5: [Reverb] Right reverb wet\n"
+		 "              6-21: [Part] Left and right dry output of parts 1-8 (e.g. 6: Left part 1, 7: Right part 1)\n"
+		 "             22-23: [Part] Left and right dry output of the rhythm part\n"
+		 "                The part streams contain both the reverb-sent and the non-reverb output of each part, so they cannot be combined with streams 0-3.", "<stream_id>"},
 
 		{"render-min", 0, 0, G_OPTION_ARG_INT, &renderMinFrames, "Render at least this many frames (default: 0) (NYI)", "<frame_count>"},
 		{"render-max", 'e', 0, G_OPTION_ARG_INT, &renderMaxFrames, "Render at most this many frames (default: -1)", "<frame_count>|-1 (unlimited)"},
@@ -235,6 +387,8 @@ static bool parseOptions(int argc, char *argv[], Options *options) {
 		{"record-max-la32-end-silence", 0, 0, G_OPTION_ARG_INT, &options->recordMaxLA32EndSilentFrames, "Record at most this many silent frames produced by the emulated LA32 before it becomes inactive (default: 0)", "<frame_count>|-1 (unlimited)"},
 		{"no-wait-for-la32", 't', G_OPTION_FLAG_REVERSE, G_OPTION_ARG_NONE, &options->waitForLA32, "Don't wait for all partials to become inactive after each SMF file has ended. Implies no-wait-for-reverb.", NULL},
 		{"no-wait-for-reverb", 0, G_OPTION_FLAG_REVERSE, G_OPTION_ARG_NONE, &options->waitForReverb, "Don't wait for reverb to finish after each SMF file has ended.", NULL},
+		{"reverb-end-level", 0, 0, G_OPTION_ARG_DOUBLE, &reverbEndLevelDb, "Stop waiting for reverb to finish once the peak output level stays below this many dBFS, e.g. -96, for 8192 frames (or the buffer size if smaller).\n"
+		 "                The reverb tail decays below the resolution of the output long before the emulator becomes inactive. (default: 0, disabled)", "<level>"},
 		{"no-send-all-notes-off", 0, G_OPTION_FLAG_REVERSE, G_OPTION_ARG_NONE, &options->sendAllNotesOff, "Don't release the hold pedal and perform all-notes-off on all parts in the emulator at the end of each SMF file.\n"
 		 "                WARNING: Sound can theoretically continue forever if not limited by other options.", NULL},
 		{"no-nice-amp-ramp", 0, G_OPTION_FLAG_REVERSE, G_OPTION_ARG_NONE, &options->niceAmpRamp, "Emulate amplitude ramp accurately.\n"
@@ -256,26 +410,47 @@ static bool parseOptions(int argc, char *argv[], Options *options) {
 	if (!parseSuccess) {
 		fprintf(stderr, "Option parsing failed: %s\n", error->message);
 	}
-	if (analogOutputModeIx < 0 || analogOutputModeIx > 3) {
-		fprintf(stderr, "analog-output-mode must be between 0 and 3\n");
+	if (analogOutputModeIx < 0 || analogOutputModeIx > 4) {
+		fprintf(stderr, "analog-output-mode must be between 0 and 4\n");
 		parseSuccess = false;
 	}
-	if (rendererTypeIx < 0 || rendererTypeIx > 1) {
-		fprintf(stderr, "renderer-type must be either 0 or 1\n");
+	if (rendererTypeIx < 0 || rendererTypeIx > 2) {
+		fprintf(stderr, "renderer-type must be between 0 and 2\n");
 		parseSuccess = false;
 	}
 	if (outputSampleFormat < OUTPUT_SAMPLE_FORMAT_SINT16 || outputSampleFormat > OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32) {
 		fprintf(stderr, "output-sample-format must be either 0 or 1\n");
 		parseSuccess = false;
 	}
-	if (srcQualityIx < 0 || srcQualityIx > 3) {
-		fprintf(stderr, "src-quality must be between 0 and 3\n");
+	if (srcQualityIx < 0 || srcQualityIx > 4) {
+		fprintf(stderr, "src-quality must be between 0 and 4\n");
 		parseSuccess = false;
 	}
 	if (dacInputModeIx < 0 || dacInputModeIx > 3) {
 		fprintf(stderr, "dac-input-mode must be between 0 and 3\n");
 		parseSuccess = false;
 	}
+	if (options->jobCount < 0) {
+		fprintf(stderr, "jobs must not be negative\n");
+		parseSuccess = false;
+	} else if (options->jobCount > 0 && options->outputFilename != NULL) {
+		fprintf(stderr, "output cannot be combined with jobs\n");
+		parseSuccess = false;
+	} else if (options->jobCount > 0 && options->benchmark) {
+		fprintf(stderr, "benchmark cannot be combined with jobs\n");
+		parseSuccess = false;
+	}
+	if (options->writeEventStreams && (options->outputFilename != NULL || options->jobCount > 0 || options->benchmark)) {
+		fprintf(stderr, "write-event-stream cannot be combined with output, jobs or benchmark\n");
+		parseSuccess = false;
+	}
+	if (options->cacheDir != NULL && (options->benchmark || options->writeEventStreams)) {
+		fprintf(stderr, "cache-dir cannot be combined with benchmark or write-event-stream\n");
+		parseSuccess = false;
+	} else if (options->cacheDir != NULL && g_mkdir_with_parents(options->cacheDir, 0755) != 0) {
+		fprintf(stderr, "Error creating cache directory: %s\n", g_strerror(errno));
+		parseSuccess = false;
+	}
 	if (bufferFrameCount < 1) {
 		fprintf(stderr, "buffer-size must be greater than 0\n");
 		parseSuccess = false;
@@ -297,23 +472,36 @@ static bool parseOptions(int argc, char *argv[], Options *options) {
 	if (options->recordMaxLA32EndSilentFrames < 0) {
 		options->recordMaxLA32EndSilentFrames = INT_MAX;
 	}
+	if (reverbEndLevelDb > 0) {
+		fprintf(stderr, "reverb-end-level must not be positive\n");
+		parseSuccess = false;
+	}
+	options->reverbEndLevel = reverbEndLevelDb < 0 ? pow(10.0, reverbEndLevelDb / 20.0) : 0;
 	if (rawStreams != NULL && g_strv_length(rawStreams) > 0) {
 		gchar **rawStream = rawStreams;
 		while(*rawStream != NULL) {
-			if (options->rawChannelCount == 8) {
-				fprintf(stderr, "Too many raw-stream options - maximum 8\n");
+			if (options->rawChannelCount == MAX_RAW_STREAM_COUNT) {
+				fprintf(stderr, "Too many raw-stream options - maximum %d\n", MAX_RAW_STREAM_COUNT);
 				parseSuccess = false;
 				break;
 			}
 			options->rawChannelMap[options->rawChannelCount] = atoi(*rawStream);
-			if (options->rawChannelMap[options->rawChannelCount] < -1 || options->rawChannelMap[options->rawChannelCount] > 5) {
-				fprintf(stderr, "Invalid option raw-stream option %s - must be a number between -1 and 5 (inclusive)\n", *rawStream);
+			if (options->rawChannelMap[options->rawChannelCount] < -1 || options->rawChannelMap[options->rawChannelCount] >= RAW_STREAM_ID_COUNT) {
+				fprintf(stderr, "Invalid option raw-stream option %s - must be a number between -1 and %d (inclusive)\n", *rawStream, RAW_STREAM_ID_COUNT - 1);
 				parseSuccess = false;
 				break;
 			}
+			if (options->rawChannelMap[options->rawChannelCount] >= FIRST_PART_RAW_STREAM_ID) options->rawPartStreams = true;
 			options->rawChannelCount++;
 			rawStream++;
 		}
+		for (int i = 0; options->rawPartStreams && i < options->rawChannelCount; i++) {
+			if (0 <= options->rawChannelMap[i] && options->rawChannelMap[i] < 4) {
+				fprintf(stderr, "Invalid option raw-stream option %d - LA32 streams cannot be combined with part streams\n", options->rawChannelMap[i]);
+				parseSuccess = false;
+				break;
+			}
+		}
 	}
 	if (deprecatedSysexFile != NULL) {
 		guint oldLength = options->inputFilenames == NULL ? 0 : g_strv_length(options->inputFilenames);
@@ -330,6 +518,50 @@ static bool parseOptions(int argc, char *argv[], Options *options) {
 		fprintf(stderr, "No input files specified\n");
 		parseSuccess = false;
 	}
+	if (options->segmentCount < 0) {
+		fprintf(stderr, "segments must not be negative\n");
+		parseSuccess = false;
+	} else if (options->segmentCount > 1 && (options->jobCount > 0 || options->benchmark || options->writeEventStreams)) {
+		fprintf(stderr, "segments cannot be combined with jobs, benchmark or write-event-stream\n");
+		parseSuccess = false;
+	} else if (options->segmentCount > 1 && options->inputFilenames != NULL && g_strv_length(options->inputFilenames) != 1) {
+		fprintf(stderr, "segments requires a single source file\n");
+		parseSuccess = false;
+	}
+	if (options->segmentPreroll < 0) {
+		fprintf(stderr, "segment-preroll must not be negative\n");
+		parseSuccess = false;
+	}
+	int stdoutOutputCount = options->outputFilename != NULL && strcmp(options->outputFilename, STDOUT_FILENAME) == 0 ? 1 : 0;
+	for (gchar **teeOutput = teeOutputs; teeOutput != NULL && *teeOutput != NULL; teeOutput++) {
+		if (options->teeOutputCount == MAX_TEE_OUTPUT_COUNT) {
+			fprintf(stderr, "Too many tee-output options - maximum %d\n", MAX_TEE_OUTPUT_COUNT);
+			parseSuccess = false;
+			break;
+		}
+		const gchar *teeOutputSpec = *teeOutput;
+		if ((teeOutputSpec[0] != '0' && teeOutputSpec[0] != '1') || teeOutputSpec[1] != ':' || teeOutputSpec[2] == 0) {
+			fprintf(stderr, "Invalid tee-output option %s - must be a sample format 0 or 1 followed by a colon and the file name\n", teeOutputSpec);
+			parseSuccess = false;
+			break;
+		}
+		const gchar *teeOutputFilename = teeOutputSpec + 2;
+		if (strcmp(teeOutputFilename, STDOUT_FILENAME) == 0) stdoutOutputCount++;
+		options->teeOutputSampleFormats[options->teeOutputCount] = static_cast<OUTPUT_SAMPLE_FORMAT>(teeOutputSpec[0] - '0');
+		options->teeOutputFilenames[options->teeOutputCount] = g_strdup(teeOutputFilename);
+		options->teeOutputCount++;
+	}
+	g_strfreev(teeOutputs);
+	if (stdoutOutputCount > 1) {
+		fprintf(stderr, "Only one output can be written to the standard output\n");
+		parseSuccess = false;
+	}
+	if (options->teeOutputCount > 0 && (options->jobCount > 0 || options->benchmark || options->writeEventStreams
+		|| options->segmentCount > 1 || options->cacheDir != NULL))
+	{
+		fprintf(stderr, "tee-output cannot be combined with jobs, benchmark, write-event-stream, segments or cache-dir\n");
+		parseSuccess = false;
+	}
 	options->analogOutputMode = ANALOG_OUTPUT_MODES[analogOutputModeIx];
 	options->rendererType = RENDERER_TYPES[rendererTypeIx];
 	options->outputSampleFormat = static_cast<OUTPUT_SAMPLE_FORMAT>(outputSampleFormat);
@@ -364,7 +596,7 @@ static bool writeWAVEHeader(FILE *outputFile, int sampleRate, OUTPUT_SAMPLE_FORM
 	// All values are little-endian
 	unsigned char waveHeader[] = {
 		'R','I','F','F',
-		0,0,0,0, // Length to be filled in later
+		0xFF,0xFF,0xFF,0xFF, // Length to be filled in later, if the output is seekable; unknown otherwise
 		'W','A','V','E',
 
 		// "fmt " chunk
@@ -379,7 +611,7 @@ static bool writeWAVEHeader(FILE *outputFile, int sampleRate, OUTPUT_SAMPLE_FORM
 
 		// "data" chunk
 		'd','a','t','a',
-		0x00, 0x00, 0x00, 0x00 // Chunk length, to be filled in later
+		0xFF, 0xFF, 0xFF, 0xFF // Chunk length, to be filled in later, if the output is seekable; unknown otherwise
 	};
 	waveHeader[HEADEROFFS_FORMAT_TAG] = outputSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32 ? 3 : 1;
 	waveHeader[HEADEROFFS_SAMPLERATE] = sampleRate & 0xFF;
@@ -425,18 +657,81 @@ static bool fillWAVESizes(FILE *outputFile, int numFrames, OUTPUT_SAMPLE_FORMAT
 	return true;
 }
 
-static bool loadFile(MT32Emu::Bit8u *&fileBuffer, gsize &fileBufferLength, const gchar *filename, const gchar *displayFilename) {
+// The source files are mapped into memory rather than read, so that the event streams need no copying.
+static GMappedFile *mapFile(const MT32Emu::Bit8u *&fileBuffer, gsize &fileBufferLength, const gchar *filename, const gchar *displayFilename) {
 	GError *err = NULL;
-	g_file_get_contents(filename, (gchar **)&fileBuffer, &fileBufferLength, &err);
-	if (err != NULL) {
+	GMappedFile *mappedFile = g_mapped_file_new(filename, FALSE, &err);
+	if (mappedFile == NULL) {
 		fprintf(stderr, "Error reading file '%s': %s\n", displayFilename, err->message);
 		g_error_free(err);
-		return false;
+		return NULL;
 	}
-	return true;
+	fileBufferLength = g_mapped_file_get_length(mappedFile);
+	if (fileBufferLength == 0) {
+		fprintf(stderr, "File '%s' is empty.\n", displayFilename);
+		g_mapped_file_unref(mappedFile);
+		return NULL;
+	}
+	fileBuffer = reinterpret_cast<const MT32Emu::Bit8u *>(g_mapped_file_get_contents(mappedFile));
+	return mappedFile;
+}
+
+// A source file of a conversion. It is mapped once and shared by everything that reads it: making the cache key,
+// finding the end time and playing the segments in the segmented mode, and playing the file as usual.
+struct InputFile {
+	// NULL in the entry that terminates an array.
+	const gchar *filename;
+	gchar *displayFilename;
+	// NULL if the file cannot be read, which is reported when mapping.
+	GMappedFile *mappedFile;
+	const MT32Emu::Bit8u *fileBuffer;
+	gsize fileBufferLength;
+};
+
+static InputFile *mapInputFiles(gchar **inputFilenames) {
+	const guint inputFileCount = g_strv_length(inputFilenames);
+	InputFile *inputFiles = new InputFile[inputFileCount + 1];
+	for (guint i = 0; i < inputFileCount; i++) {
+		InputFile &inputFile = inputFiles[i];
+		inputFile.filename = inputFilenames[i];
+		inputFile.displayFilename = g_filename_display_name(inputFilenames[i]);
+		inputFile.fileBuffer = NULL;
+		inputFile.fileBufferLength = 0;
+		inputFile.mappedFile = mapFile(inputFile.fileBuffer, inputFile.fileBufferLength, inputFile.filename, inputFile.displayFilename);
+	}
+	inputFiles[inputFileCount].filename = NULL;
+	return inputFiles;
+}
+
+static void unmapInputFiles(InputFile *inputFiles) {
+	for (InputFile *inputFile = inputFiles; inputFile->filename != NULL; inputFile++) {
+		if (inputFile->mappedFile != NULL) {
+			g_mapped_file_unref(inputFile->mappedFile);
+		}
+		g_free(inputFile->displayFilename);
+	}
+	delete[] inputFiles;
+}
+
+static inline MT32Emu::Bit32u readLE32(const MT32Emu::Bit8u *data) {
+	return data[0] | (data[1] << 8) | (data[2] << 16) | (MT32Emu::Bit32u(data[3]) << 24);
+}
+
+static bool writeLE32(FILE *file, MT32Emu::Bit32u value) {
+	const unsigned char data[] = {
+		static_cast<unsigned char>(value & 0xFF),
+		static_cast<unsigned char>((value >> 8) & 0xFF),
+		static_cast<unsigned char>((value >> 16) & 0xFF),
+		static_cast<unsigned char>((value >> 24) & 0xFF)
+	};
+	return fwrite(data, 1, sizeof(data), file) == sizeof(data);
+}
+
+static bool isEventStreamBuffer(const MT32Emu::Bit8u *fileBuffer, gsize fileBufferLength) {
+	return fileBufferLength >= EVENT_STREAM_HEADER_SIZE && memcmp(fileBuffer, EVENT_STREAM_SIGNATURE, 4) == 0;
 }
 
-static bool playSysexFileBuffer(MT32Emu::Service &service, const gchar *displayFilename, MT32Emu::Bit8u *fileBuffer, gsize fileBufferLength) {
+static bool playSysexFileBuffer(MT32Emu::Service &service, const gchar *displayFilename, const MT32Emu::Bit8u *fileBuffer, gsize fileBufferLength) {
 	long start = -1;
 	for (gsize i = 0; i < fileBufferLength; i++) {
 		if (fileBuffer[i] == 0xF0) {
@@ -449,7 +744,7 @@ static bool playSysexFileBuffer(MT32Emu::Service &service, const gchar *displayF
 			if (start == -1) {
 				fprintf(stderr, "Ended a sysex message without a start byte - sysex file '%s' may be in an unsupported format.\n", displayFilename);
 			} else {
-				service.playSysexNow((MT32Emu::Bit8u*)(fileBuffer + start), MT32Emu::Bit32u(i - start + 1));
+				service.playSysexNow(fileBuffer + start, MT32Emu::Bit32u(i - start + 1));
 			}
 			start = -1;
 		}
@@ -463,6 +758,78 @@ enum Occasion {
 	LA32_INACTIVE
 };
 
+static gpointer runOutputWriter(gpointer data) {
+	OutputWriter *writer = static_cast<OutputWriter *>(data);
+	for (;;) {
+		OutputBlock *block = static_cast<OutputBlock *>(g_async_queue_pop(writer->filledBlocks));
+		for (unsigned int i = 0; i < writer->teeWriterCount; i++) {
+			g_async_queue_push(writer->teeWriters[i].pendingBlocks, block);
+		}
+		if (block == &writer->endBlock) break;
+		if (fwrite(block->data, 1, block->byteCount, writer->file) != block->byteCount) {
+			fprintf(stderr, "Error writing to output file\n");
+		}
+		for (unsigned int i = 0; i < writer->teeWriterCount; i++) {
+			g_async_queue_pop(writer->convertedBlocks);
+		}
+		block->byteCount = 0;
+		g_async_queue_push(writer->freeBlocks, block);
+	}
+	return NULL;
+}
+
+// Returns the block to be filled first. The tee writers, if any, must be started beforehand.
+static OutputBlock *startOutputWriter(OutputWriter &writer, FILE *file, unsigned int blockSize, TeeWriter *teeWriters, unsigned int teeWriterCount) {
+	writer.file = file;
+	writer.filledBlocks = g_async_queue_new();
+	writer.freeBlocks = g_async_queue_new();
+	writer.teeWriters = teeWriters;
+	writer.teeWriterCount = teeWriterCount;
+	writer.convertedBlocks = g_async_queue_new();
+	for (unsigned int i = 0; i < OUTPUT_BLOCK_COUNT; i++) {
+		writer.blocks[i].data = new MT32Emu::Bit8u[blockSize];
+		writer.blocks[i].byteCount = 0;
+		if (i > 0) g_async_queue_push(writer.freeBlocks, &writer.blocks[i]);
+	}
+	writer.endBlock.data = NULL;
+	writer.endBlock.byteCount = 0;
+	writer.thread = g_thread_new("output writer", runOutputWriter, &writer);
+	return &writer.blocks[0];
+}
+
+// Waits until all the filled blocks are written. The tee writers are stopped afterwards.
+static void stopOutputWriter(OutputWriter &writer) {
+	g_async_queue_push(writer.filledBlocks, &writer.endBlock);
+	g_thread_join(writer.thread);
+	g_async_queue_unref(writer.filledBlocks);
+	g_async_queue_unref(writer.freeBlocks);
+	g_async_queue_unref(writer.convertedBlocks);
+	for (unsigned int i = 0; i < OUTPUT_BLOCK_COUNT; i++) {
+		delete[] writer.blocks[i].data;
+	}
+}
+
+static void flushOutputBuffer(State &state) {
+	if (state.outputWriter == NULL) {
+		state.outputBlock->byteCount = 0;
+		return;
+	}
+	if (state.outputBlock->byteCount == 0) return;
+	g_async_queue_push(state.outputWriter->filledBlocks, state.outputBlock);
+	state.outputBlock = static_cast<OutputBlock *>(g_async_queue_pop(state.outputWriter->freeBlocks));
+}
+
+// Returns a pointer to the specified number of bytes in the output buffer to be filled in, passing the buffer to the writer
+// beforehand if it lacks space. The number of bytes must not exceed the buffer size.
+static MT32Emu::Bit8u *reserveOutput(State &state, unsigned int byteCount) {
+	if (state.outputBlock->byteCount + byteCount > state.outputBufferSize) {
+		flushOutputBuffer(state);
+	}
+	MT32Emu::Bit8u *output = state.outputBlock->data + state.outputBlock->byteCount;
+	state.outputBlock->byteCount += byteCount;
+	return output;
+}
+
 static void flushSilence(Occasion occasion, const Options &options, State &state) {
 	unsigned int channelCount = options.rawChannelCount > 0 ? options.rawChannelCount : 2;
 	int writtenFrames = state.unwrittenSilentFrames;
@@ -484,8 +851,11 @@ static void flushSilence(Occasion occasion, const Options &options, State &state
 		break;
 	}
 	const int sampleSize = options.outputSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32 ? 4 : 2;
-	for (unsigned long i = 0; i < writtenFrames * sampleSize * channelCount; i++) {
-		fputc(0, state.outputFile);
+	unsigned long silenceBytes = writtenFrames * sampleSize * channelCount;
+	while (silenceBytes > 0) {
+		unsigned int chunkBytes = MIN(silenceBytes, state.outputBufferSize);
+		memset(reserveOutput(state, chunkBytes), 0, chunkBytes);
+		silenceBytes -= chunkBytes;
 	}
 	state.writtenFrames += writtenFrames;
 }
@@ -498,8 +868,28 @@ static inline void renderStereo(MT32Emu::Service &service, void *stereoSampleBuf
 	}
 }
 
-static inline void renderRaw(MT32Emu::Service &service, void *rawSampleBuffer[], const unsigned int frameCount, const OUTPUT_SAMPLE_FORMAT outputSampleFormat) {
-	if (outputSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32) {
+template <class Streams, class Sample>
+static inline void fillPartStreams(Streams &streams, void *rawSampleBuffer[]) {
+	for (int partIx = 0; partIx < 9; partIx++) {
+		streams.partLeft[partIx] = static_cast<Sample *>(rawSampleBuffer[FIRST_PART_RAW_STREAM_ID + 2 * partIx]);
+		streams.partRight[partIx] = static_cast<Sample *>(rawSampleBuffer[FIRST_PART_RAW_STREAM_ID + 2 * partIx + 1]);
+	}
+	streams.reverbWetLeft = static_cast<Sample *>(rawSampleBuffer[4]);
+	streams.reverbWetRight = static_cast<Sample *>(rawSampleBuffer[5]);
+}
+
+static inline void renderRaw(MT32Emu::Service &service, void *rawSampleBuffer[], const unsigned int frameCount, const OUTPUT_SAMPLE_FORMAT outputSampleFormat, const bool partStreams) {
+	if (partStreams) {
+		if (outputSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32) {
+			mt32emu_part_output_float_streams streams;
+			fillPartStreams<mt32emu_part_output_float_streams, float>(streams, rawSampleBuffer);
+			service.renderFloatPartStreams(&streams, frameCount);
+		} else {
+			mt32emu_part_output_bit16s_streams streams;
+			fillPartStreams<mt32emu_part_output_bit16s_streams, MT32Emu::Bit16s>(streams, rawSampleBuffer);
+			service.renderBit16sPartStreams(&streams, frameCount);
+		}
+	} else if (outputSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32) {
 		mt32emu_dac_output_float_streams streams = {
 			static_cast<float *>(rawSampleBuffer[0]),
 			static_cast<float *>(rawSampleBuffer[1]),
@@ -530,6 +920,33 @@ static inline bool isSilence(void * const sampleBuffer, const int sampleIx, cons
 	}
 }
 
+static inline double getSampleLevel(void * const sampleBuffer, const int sampleIx, const OUTPUT_SAMPLE_FORMAT outputSampleFormat) {
+	if (outputSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32) {
+		return fabs(static_cast<float *>(sampleBuffer)[sampleIx]);
+	} else {
+		return fabs(static_cast<MT32Emu::Bit16s *>(sampleBuffer)[sampleIx] / 32768.0);
+	}
+}
+
+// Returns the peak level relative to the full scale of the specified number of frames rendered last,
+// which must not exceed the buffer size.
+static double getPeakLevel(const unsigned int frameCount, const Options &options, const State &state) {
+	double peakLevel = 0;
+	if (options.rawChannelCount > 0) {
+		for (int chanMapIx = 0; chanMapIx < options.rawChannelCount; chanMapIx++) {
+			if (options.rawChannelMap[chanMapIx] < 0) continue;
+			for (unsigned int frameIx = 0; frameIx < frameCount; frameIx++) {
+				peakLevel = MAX(peakLevel, getSampleLevel(state.rawSampleBuffer[options.rawChannelMap[chanMapIx]], frameIx, options.outputSampleFormat));
+			}
+		}
+	} else {
+		for (unsigned int sampleIx = 0; sampleIx < frameCount * 2; sampleIx++) {
+			peakLevel = MAX(peakLevel, getSampleLevel(state.stereoSampleBuffer, sampleIx, options.outputSampleFormat));
+		}
+	}
+	return peakLevel;
+}
+
 static inline MT32Emu::Bit32u makeIeeeFloat(float sample) {
 	MT32Emu::Bit32u floatBits = 0;
 	// In this context, all the denormals, INFs and NaNs are treated as silence.
@@ -548,86 +965,195 @@ static inline MT32Emu::Bit32u makeIeeeFloat(float sample) {
 	return floatBits;
 }
 
-static inline void putSampleLE(void * const sampleBuffer, const int sampleIx, FILE *outputFile, const OUTPUT_SAMPLE_FORMAT outputSampleFormat) {
+static inline MT32Emu::Bit8u *putSampleLE(void * const sampleBuffer, const int sampleIx, MT32Emu::Bit8u *output, const OUTPUT_SAMPLE_FORMAT outputSampleFormat) {
 	if (outputSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32) {
 		MT32Emu::Bit32u sample = makeIeeeFloat(static_cast<float *>(sampleBuffer)[sampleIx]);
-		fputc(sample & 0xFF, outputFile);
-		fputc((sample >> 8) & 0xFF, outputFile);
-		fputc((sample >> 16) & 0xFF, outputFile);
-		fputc((sample >> 24) & 0xFF, outputFile);
+		*(output++) = sample & 0xFF;
+		*(output++) = (sample >> 8) & 0xFF;
+		*(output++) = (sample >> 16) & 0xFF;
+		*(output++) = (sample >> 24) & 0xFF;
 	} else {
 		MT32Emu::Bit16s sample = static_cast<MT32Emu::Bit16s *>(sampleBuffer)[sampleIx];
-		fputc(sample & 0xFF, outputFile);
-		fputc((sample >> 8) & 0xFF, outputFile);
+		*(output++) = sample & 0xFF;
+		*(output++) = (sample >> 8) & 0xFF;
 	}
+	return output;
 }
 
-static inline void putSampleBE(void * const sampleBuffer, const int sampleIx, FILE *outputFile, const OUTPUT_SAMPLE_FORMAT outputSampleFormat) {
+static inline MT32Emu::Bit8u *putSampleBE(void * const sampleBuffer, const int sampleIx, MT32Emu::Bit8u *output, const OUTPUT_SAMPLE_FORMAT outputSampleFormat) {
 	if (outputSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32) {
 		MT32Emu::Bit32u sample = makeIeeeFloat(static_cast<float *>(sampleBuffer)[sampleIx]);
-		fputc((sample >> 24) & 0xFF, outputFile);
-		fputc((sample >> 16) & 0xFF, outputFile);
-		fputc((sample >> 8) & 0xFF, outputFile);
-		fputc(sample & 0xFF, outputFile);
+		*(output++) = (sample >> 24) & 0xFF;
+		*(output++) = (sample >> 16) & 0xFF;
+		*(output++) = (sample >> 8) & 0xFF;
+		*(output++) = sample & 0xFF;
 	} else {
 		MT32Emu::Bit16s sample = static_cast<MT32Emu::Bit16s *>(sampleBuffer)[sampleIx];
-		fputc((sample >> 8) & 0xFF, outputFile);
-		fputc(sample & 0xFF, outputFile);
+		*(output++) = (sample >> 8) & 0xFF;
+		*(output++) = sample & 0xFF;
+	}
+	return output;
+}
+
+static inline MT32Emu::Bit32u getSampleBits(const MT32Emu::Bit8u *input, const unsigned int sampleSize, const bool bigEndian) {
+	MT32Emu::Bit32u sampleBits = 0;
+	for (unsigned int i = 0; i < sampleSize; i++) {
+		sampleBits = (sampleBits << 8) | input[bigEndian ? i : sampleSize - 1 - i];
+	}
+	return sampleBits;
+}
+
+static inline MT32Emu::Bit8u *putSampleBits(MT32Emu::Bit32u sampleBits, const unsigned int sampleSize, const bool bigEndian, MT32Emu::Bit8u *output) {
+	for (unsigned int i = 0; i < sampleSize; i++) {
+		const unsigned int shift = 8 * (bigEndian ? sampleSize - 1 - i : i);
+		*(output++) = (sampleBits >> shift) & 0xFF;
+	}
+	return output;
+}
+
+// The inverse of makeIeeeFloat(), which never produces denormals, INFs and NaNs.
+static inline float parseIeeeFloat(MT32Emu::Bit32u floatBits) {
+	const int exp = (floatBits >> 23) & 0xFF;
+	if (exp == 0) return 0.0f;
+	const float absSample = float(ldexp(double((floatBits & ((1 << 23) - 1)) | (1 << 23)), exp - 127 - 23));
+	return (floatBits >> 31) != 0 ? -absSample : absSample;
+}
+
+// The samples are converted as the library does when rendering in the other format, without dithering.
+static unsigned int convertTeeBlock(const TeeWriter &writer, const OutputBlock &block) {
+	const unsigned int sourceSampleSize = writer.sourceSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32 ? 4 : 2;
+	const unsigned int sampleSize = writer.sampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32 ? 4 : 2;
+	const MT32Emu::Bit8u *input = block.data;
+	const MT32Emu::Bit8u *inputEnd = block.data + block.byteCount;
+	MT32Emu::Bit8u *output = writer.data;
+	for (; input < inputEnd; input += sourceSampleSize) {
+		const MT32Emu::Bit32u sampleBits = getSampleBits(input, sourceSampleSize, writer.bigEndian);
+		if (writer.sampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32) {
+			const float sample = MT32Emu::Bit16s(sampleBits) / 32768.0f;
+			output = putSampleBits(makeIeeeFloat(sample), sampleSize, writer.bigEndian, output);
+		} else {
+			const float sample = parseIeeeFloat(sampleBits) * 32768.0f;
+			const MT32Emu::Bit16s intSample = sample >= 32767.0f ? 32767 : sample <= -32768.0f ? -32768 : MT32Emu::Bit16s(sample);
+			output = putSampleBits(MT32Emu::Bit16u(intSample), sampleSize, writer.bigEndian, output);
+		}
+	}
+	return static_cast<unsigned int>(output - writer.data);
+}
+
+static gpointer runTeeWriter(gpointer data) {
+	TeeWriter *writer = static_cast<TeeWriter *>(data);
+	for (;;) {
+		OutputBlock *block = static_cast<OutputBlock *>(g_async_queue_pop(writer->pendingBlocks));
+		if (block == &writer->outputWriter->endBlock) break;
+		const MT32Emu::Bit8u *teeData = block->data;
+		unsigned int teeByteCount = block->byteCount;
+		if (writer->sampleFormat != writer->sourceSampleFormat) {
+			teeData = writer->data;
+			teeByteCount = convertTeeBlock(*writer, *block);
+		}
+		if (fwrite(teeData, 1, teeByteCount, writer->file) != teeByteCount) {
+			fprintf(stderr, "Error writing to tee output file\n");
+		}
+		g_async_queue_push(writer->outputWriter->convertedBlocks, block);
+	}
+	return NULL;
+}
+
+// Returns the number of the tee writers started for the files opened successfully.
+static unsigned int startTeeWriters(TeeWriter *teeWriters, OutputWriter &outputWriter, FILE * const *teeFiles, const Options &options, unsigned int blockSize) {
+	unsigned int teeWriterCount = 0;
+	for (int i = 0; i < options.teeOutputCount; i++) {
+		if (teeFiles == NULL || teeFiles[i] == NULL) continue;
+		TeeWriter &writer = teeWriters[teeWriterCount++];
+		writer.file = teeFiles[i];
+		writer.sampleFormat = options.teeOutputSampleFormats[i];
+		writer.sourceSampleFormat = options.outputSampleFormat;
+		writer.bigEndian = options.rawChannelCount > 0;
+		writer.outputWriter = &outputWriter;
+		writer.pendingBlocks = g_async_queue_new();
+		writer.data = new MT32Emu::Bit8u[2 * blockSize];
+		writer.thread = g_thread_new("tee writer", runTeeWriter, &writer);
+	}
+	return teeWriterCount;
+}
+
+// Only called once the output writer is stopped, so that the end block is already passed to the tee writers.
+static void stopTeeWriters(TeeWriter *teeWriters, unsigned int teeWriterCount) {
+	for (unsigned int i = 0; i < teeWriterCount; i++) {
+		g_thread_join(teeWriters[i].thread);
+		g_async_queue_unref(teeWriters[i].pendingBlocks);
+		delete[] teeWriters[i].data;
+	}
+}
+
+static inline bool isSilentStereoFrame(void * const sampleBuffer, const unsigned int frameIx, const OUTPUT_SAMPLE_FORMAT outputSampleFormat) {
+	return isSilence(sampleBuffer, frameIx * 2, outputSampleFormat) && isSilence(sampleBuffer, frameIx * 2 + 1, outputSampleFormat);
+}
+
+static inline bool isSilentRawFrame(void * const rawSampleBuffer[], const unsigned int frameIx, const Options &options) {
+	for (int chanMapIx = 0; chanMapIx < options.rawChannelCount; chanMapIx++) {
+		if (options.rawChannelMap[chanMapIx] >= 0 && !isSilence(rawSampleBuffer[options.rawChannelMap[chanMapIx]], frameIx, options.outputSampleFormat)) {
+			return false;
+		}
 	}
+	return true;
 }
 
+// The rendered frames are scanned for runs of silent and non-silent frames. The silent frames are only counted
+// while each run of non-silent frames is encoded into the output buffer at once.
 static void renderStereo(unsigned int frameCount, const Options &options, State &state) {
+	const unsigned int frameSize = options.outputSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32 ? 8 : 4;
 	state.renderedFrames += frameCount;
 	while (frameCount > 0) {
 		unsigned int renderedFramesThisPass = MIN(frameCount, options.bufferFrameCount);
 		renderStereo(state.service, state.stereoSampleBuffer, renderedFramesThisPass, options.outputSampleFormat);
-		for (unsigned int i = 0; i < renderedFramesThisPass; i++) {
-			unsigned int leftIx = i * 2;
-			unsigned int rightIx = leftIx + 1;
-			bool silent = isSilence(state.stereoSampleBuffer, leftIx, options.outputSampleFormat)
-				&& isSilence(state.stereoSampleBuffer, rightIx, options.outputSampleFormat);
-			if (silent) {
-				state.unwrittenSilentFrames++;
-				continue;
-			}
+		unsigned int i = 0;
+		while (i < renderedFramesThisPass) {
+			unsigned int runStartIx = i;
+			while (i < renderedFramesThisPass && isSilentStereoFrame(state.stereoSampleBuffer, i, options.outputSampleFormat)) i++;
+			state.unwrittenSilentFrames += i - runStartIx;
+			if (i == renderedFramesThisPass) break;
+			runStartIx = i;
+			while (i < renderedFramesThisPass && !isSilentStereoFrame(state.stereoSampleBuffer, i, options.outputSampleFormat)) i++;
 			flushSilence(NOISE_DETECTED, options, state);
-			putSampleLE(state.stereoSampleBuffer, leftIx, state.outputFile, options.outputSampleFormat);
-			putSampleLE(state.stereoSampleBuffer, rightIx, state.outputFile, options.outputSampleFormat);
-			state.writtenFrames++;
+			MT32Emu::Bit8u *output = reserveOutput(state, (i - runStartIx) * frameSize);
+			for (unsigned int sampleIx = runStartIx * 2; sampleIx < i * 2; sampleIx++) {
+				output = putSampleLE(state.stereoSampleBuffer, sampleIx, output, options.outputSampleFormat);
+			}
+			state.writtenFrames += i - runStartIx;
 		}
 		frameCount -= renderedFramesThisPass;
 	}
 }
 
 static void renderRaw(unsigned int frameCount, const Options &options, State &state) {
+	const int sampleSize = options.outputSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32 ? 4 : 2;
+	const unsigned int frameSize = sampleSize * options.rawChannelCount;
 	state.renderedFrames += frameCount;
 	while (frameCount > 0) {
 		unsigned int renderedFramesThisPass = MIN(frameCount, options.bufferFrameCount);
-		renderRaw(state.service, state.rawSampleBuffer, renderedFramesThisPass, options.outputSampleFormat);
-		for (unsigned int i = 0; i < renderedFramesThisPass; i++) {
-			bool allSilent = true;
-			for (int chanMapIx = 0; chanMapIx < options.rawChannelCount; chanMapIx++) {
-				if (options.rawChannelMap[chanMapIx] >= 0 && !isSilence(state.rawSampleBuffer[options.rawChannelMap[chanMapIx]], i, options.outputSampleFormat)) {
-					allSilent = false;
-					break;
-				}
-			}
-			if (allSilent) {
-				state.unwrittenSilentFrames++;
-				continue;
-			}
+		renderRaw(state.service, state.rawSampleBuffer, renderedFramesThisPass, options.outputSampleFormat, options.rawPartStreams);
+		unsigned int i = 0;
+		while (i < renderedFramesThisPass) {
+			unsigned int runStartIx = i;
+			while (i < renderedFramesThisPass && isSilentRawFrame(state.rawSampleBuffer, i, options)) i++;
+			state.unwrittenSilentFrames += i - runStartIx;
+			if (i == renderedFramesThisPass) break;
+			runStartIx = i;
+			while (i < renderedFramesThisPass && !isSilentRawFrame(state.rawSampleBuffer, i, options)) i++;
 			flushSilence(NOISE_DETECTED, options, state);
-			for (int chanMapIx = 0; chanMapIx < options.rawChannelCount; chanMapIx++) {
-				if (options.rawChannelMap[chanMapIx] < 0) {
-					const int sampleSize = options.outputSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32 ? 4 : 2;
-					for (int sampleIx = 0; sampleIx < sampleSize; sampleIx++) {
-						fputc(0, state.outputFile);
+			MT32Emu::Bit8u *output = reserveOutput(state, (i - runStartIx) * frameSize);
+			for (unsigned int frameIx = runStartIx; frameIx < i; frameIx++) {
+				for (int chanMapIx = 0; chanMapIx < options.rawChannelCount; chanMapIx++) {
+					if (options.rawChannelMap[chanMapIx] < 0) {
+						memset(output, 0, sampleSize);
+						output += sampleSize;
+					} else {
+						output = putSampleBE(state.rawSampleBuffer[options.rawChannelMap[chanMapIx]], frameIx, output, options.outputSampleFormat);
 					}
-				} else {
-					putSampleBE(state.rawSampleBuffer[options.rawChannelMap[chanMapIx]], i, state.outputFile, options.outputSampleFormat);
 				}
 			}
-			state.writtenFrames++;
+			state.writtenFrames += i - runStartIx;
 		}
 		frameCount -= renderedFramesThisPass;
 	}
@@ -641,14 +1167,124 @@ static void render(unsigned int frameCount, const Options &options, State &state
 	}
 }
 
-static void playSMF(smf_t *smf, const Options &options, State &state) {
+// Renders the current SMF file up to the specified frame, unless already there, so that the events enqueued earlier are played.
+// Returns false once the maximum number of frames is rendered.
+static bool renderUntil(unsigned long frameIx, unsigned long &renderedFrames, const Options &options, State &state) {
+	if (frameIx > renderedFrames) {
+		unsigned long renderLength = frameIx - renderedFrames;
+		if (state.renderedFrames + renderLength > options.renderMaxFrames) {
+			renderLength = options.renderMaxFrames - state.renderedFrames;
+		}
+		renderedFrames += renderLength;
+		// The synth is advanced over silent pauses without rendering, the skipped frames are then accounted as silence.
+		while (renderLength > 0) {
+			if (state.service.skipSilence(static_cast<MT32Emu::Bit32u>(renderLength))) {
+				state.renderedFrames += renderLength;
+				state.unwrittenSilentFrames += renderLength;
+				break;
+			}
+			unsigned int framesToRender = static_cast<unsigned int>(MIN(renderLength, options.bufferFrameCount));
+			render(framesToRender, options, state);
+			renderLength -= framesToRender;
+		}
+	}
+	return state.renderedFrames < options.renderMaxFrames;
+}
+
+// Enqueues a short message, or a sysex unless it is NULL, to be played at the specified frame of the current SMF file.
+// The timestamp is relative to the rendered frames, the same way as if the event was played immediately once they reach it.
+// While the queue is full, the frames up to the event are rendered. Returns false once the maximum number of frames is rendered.
+static bool enqueueEvent(MT32Emu::Bit32u msg, const MT32Emu::Bit8u *sysex, MT32Emu::Bit32u sysexLength, unsigned long eventFrameIx, unsigned long &renderedFrames, const Options &options, State &state) {
+	for (;;) {
+		unsigned long framesAhead = eventFrameIx > renderedFrames ? eventFrameIx - renderedFrames : 0;
+		MT32Emu::Bit32u timestamp = state.service.getInternalRenderedSampleCount() + state.service.convertOutputToSynthTimestamp(framesAhead);
+		mt32emu_return_code rc = sysex == NULL ? state.service.playMsgAt(msg, timestamp) : state.service.playSysexAt(sysex, sysexLength, timestamp);
+		if (rc != MT32EMU_RC_QUEUE_FULL) return true;
+		if (!renderUntil(MAX(eventFrameIx, renderedFrames + 1), renderedFrames, options, state)) return false;
+	}
+}
+
+// Tracks the progress of playing a source file. The frames are counted at the output sample rate from its start.
+struct Playback {
+	const Options &options;
+	State &state;
+	unsigned long renderedFrames;
+	unsigned long eventFrameIx;
+	bool renderLimitReached;
+};
+
+// The events are enqueued with timestamps as they are read, and the frames are only rendered when the next event lies
+// beyond the horizon of the buffer size, so that dense passages don't need a render call per event. An event with a zero
+// message and no sysex only advances the time. Returns false once the maximum number of frames is rendered.
+static bool playEvent(MT32Emu::Bit32u msg, const MT32Emu::Bit8u *sysex, MT32Emu::Bit32u sysexLength, unsigned long eventFrameIx, Playback &playback) {
+	playback.eventFrameIx = eventFrameIx;
+	if (eventFrameIx >= playback.renderedFrames + playback.options.bufferFrameCount) {
+		playback.renderLimitReached = !renderUntil(eventFrameIx, playback.renderedFrames, playback.options, playback.state);
+	}
+	if (!playback.renderLimitReached && (msg != 0 || sysex != NULL)) {
+		playback.renderLimitReached = !enqueueEvent(msg, sysex, sysexLength, eventFrameIx, playback.renderedFrames, playback.options, playback.state);
+	}
+	return !playback.renderLimitReached;
+}
+
+// Renders the rest of the source file after the last event, including the decay of the sound if requested.
+static void finishPlayback(Playback &playback) {
+	const Options &options = playback.options;
+	State &state = playback.state;
+	if (!playback.renderLimitReached) {
+		renderUntil(playback.eventFrameIx, playback.renderedFrames, options, state);
+	}
+	flushSilence(MIDI_ENDED, options, state);
+	if (options.sendAllNotesOff) {
+		for (unsigned char channel = 0; channel < 16; channel++) {
+			state.service.playMsg(0x0040B0 | channel); // Release sustain pedal
+			state.service.playMsg(0x007BB0 | channel); // All notes off
+		}
+	}
+	if (state.lastInputFile && options.renderMinFrames > state.renderedFrames) {
+		render(options.renderMinFrames - state.renderedFrames, options, state);
+	}
+	if (options.waitForLA32) {
+		while (state.renderedFrames < options.renderMaxFrames && state.service.hasActivePartials()) {
+			// FIXME: Rendering one sample at a time is very inefficient, but it's important for
+			// some tests to be able to see the precise frame when partials become inactive.
+			// Perhaps we should add a renderWhilePartialsActive() to Synth
+			// or add a getter for "the minimum number of frames remaining with active partials if
+			// no further MIDI is sent". Which would make quite a function name.
+			render(1, options, state);
+		}
+		flushSilence(LA32_INACTIVE, options, state);
+		if (options.waitForReverb) {
+			unsigned int reverbEndFrames = MIN(MAX_REVERB_END_FRAMES, options.bufferFrameCount);
+			while (state.renderedFrames < options.renderMaxFrames && state.service.isActive()) {
+				// Render a healthy number of frames while waiting for reverb to become inactive.
+				// Note that once we've detected inactivity, silent samples will not be written.
+				unsigned int renderLength = reverbEndFrames;
+				if (state.renderedFrames + renderLength > options.renderMaxFrames) {
+					renderLength = options.renderMaxFrames - state.renderedFrames;
+				}
+				render(renderLength, options, state);
+				if (options.reverbEndLevel > 0 && getPeakLevel(renderLength, options, state) < options.reverbEndLevel) {
+					break;
+				}
+			}
+		}
+	}
+	if (!state.service.isActive()) {
+		state.unwrittenSilentFrames = 0;
+	}
+}
+
+// Receives the events of a source file in order along with their time in seconds. The events that carry nothing to play,
+// like metadata, are passed with a zero message and no sysex, as they still advance the time. Returns false to stop reading.
+typedef bool (*SMFEventHandler)(double eventTime, MT32Emu::Bit32u msg, const MT32Emu::Bit8u *sysex, MT32Emu::Bit32u sysexLength, void *context);
+
+static void readSMF(smf_t *smf, const Options &options, SMFEventHandler handleEvent, void *context) {
 	int unterminatedSysexLen = 0;
 	unsigned char *unterminatedSysex = NULL;
-	unsigned long renderedFrames = 0;
 	smf_rewind(smf);
 	for (;;) {
 		smf_event_t *event = smf_get_next_event(smf);
-		unsigned long eventFrameIx;
 
 		if (event == NULL) {
 			break;
@@ -656,22 +1292,13 @@ static void playSMF(smf_t *smf, const Options &options, State &state) {
 
 		assert(event->track->track_number >= 0);
 
-		eventFrameIx = secondsToSamples(event->time_seconds, options.sampleRate);
-		unsigned int renderLength = (eventFrameIx > renderedFrames) ? eventFrameIx - renderedFrames : 1;
-		if (state.renderedFrames + renderLength > options.renderMaxFrames) {
-			renderLength = options.renderMaxFrames - state.renderedFrames;
-		}
-		render(renderLength, options, state);
-		renderedFrames += renderLength;
-		if (state.renderedFrames == options.renderMaxFrames) {
-			break;
-		}
-
+		bool proceed;
 		if (smf_event_is_metadata(event)) {
 			char *decoded = smf_event_decode(event);
 			if (decoded && !options.quiet) {
-				fprintf(stdout, "Metadata: %s\n", decoded);
+				fprintf(messageStream, "Metadata: %s\n", decoded);
 			}
+			proceed = handleEvent(event->time_seconds, 0, NULL, 0, context);
 		} else if (smf_event_is_sysex(event) || smf_event_is_sysex_continuation(event))  {
 			bool unterminated = smf_event_is_unterminated_sysex(event) != 0;
 			bool addUnterminated = unterminated;
@@ -708,8 +1335,10 @@ static void playSMF(smf_t *smf, const Options &options, State &state) {
 				buf = unterminatedSysex;
 				len = unterminatedSysexLen;
 			}
-			if (!unterminated) {
-				state.service.playSysex(buf, len);
+			if (unterminated) {
+				proceed = handleEvent(event->time_seconds, 0, NULL, 0, context);
+			} else {
+				proceed = handleEvent(event->time_seconds, 0, buf, len, context);
 				if (addUnterminated) {
 					delete[] unterminatedSysex;
 					unterminatedSysex = NULL;
@@ -717,6 +1346,7 @@ static void playSMF(smf_t *smf, const Options &options, State &state) {
 				}
 			}
 		} else {
+			MT32Emu::Bit32u msg = 0;
 			if (event->midi_buffer_length > 3) {
 				fprintf(stderr, "Got message with unusual length: %d\n", event->midi_buffer_length);
 				for (int i = 0; i < event->midi_buffer_length; i++) {
@@ -724,238 +1354,911 @@ static void playSMF(smf_t *smf, const Options &options, State &state) {
 				}
 				fprintf(stderr, "\n");
 			} else {
-				MT32Emu::Bit32u msg = 0;
 				for (int i = 0; i < event->midi_buffer_length; i++) {
 					msg |= (event->midi_buffer[i] << (8 * i));
 				}
-				state.service.playMsg(msg);
 			}
+			proceed = handleEvent(event->time_seconds, msg, NULL, 0, context);
 		}
-	}
-	flushSilence(MIDI_ENDED, options, state);
-	if (options.sendAllNotesOff) {
-		for (unsigned char channel = 0; channel < 16; channel++) {
-			state.service.playMsg(0x0040B0 | channel); // Release sustain pedal
-			state.service.playMsg(0x007BB0 | channel); // All notes off
+		if (!proceed) {
+			break;
 		}
 	}
-	if (state.lastInputFile && options.renderMinFrames > state.renderedFrames) {
-		render(options.renderMinFrames - state.renderedFrames, options, state);
-	}
-	if (options.waitForLA32) {
-		while (state.renderedFrames < options.renderMaxFrames && state.service.hasActivePartials()) {
-			// FIXME: Rendering one sample at a time is very inefficient, but it's important for
-			// some tests to be able to see the precise frame when partials become inactive.
-			// Perhaps we should add a renderWhilePartialsActive() to Synth
-			// or add a getter for "the minimum number of frames remaining with active partials if
-			// no further MIDI is sent". Which would make quite a function name.
-			render(1, options, state);
-		}
-		flushSilence(LA32_INACTIVE, options, state);
-		if (options.waitForReverb) {
-			unsigned int reverbEndFrames = MIN(MAX_REVERB_END_FRAMES, options.bufferFrameCount);
-			while (state.renderedFrames < options.renderMaxFrames && state.service.isActive()) {
-				// Render a healthy number of frames while waiting for reverb to become inactive.
-				// Note that once we've detected inactivity, silent samples will not be written.
-				unsigned int renderLength = reverbEndFrames;
-				if (state.renderedFrames + renderLength > options.renderMaxFrames) {
-					renderLength = options.renderMaxFrames - state.renderedFrames;
-				}
-				render(renderLength, options, state);
+	delete[] unterminatedSysex;
+}
+
+static bool playSMFEvent(double eventTime, MT32Emu::Bit32u msg, const MT32Emu::Bit8u *sysex, MT32Emu::Bit32u sysexLength, void *context) {
+	Playback &playback = *static_cast<Playback *>(context);
+	return playEvent(msg, sysex, sysexLength, secondsToSamples(eventTime, playback.options.sampleRate), playback);
+}
+
+static void playSMF(smf_t *smf, const Options &options, State &state) {
+	Playback playback = {options, state, 0, 0, false};
+	readSMF(smf, options, playSMFEvent, &playback);
+	finishPlayback(playback);
+}
+
+// Passes the events of a pre-timed event stream to the handler the same way readSMF() does, with the timestamps converted
+// to seconds. Returns false if the stream is truncated.
+static bool readEventStream(const MT32Emu::Bit8u *fileBuffer, gsize fileBufferLength, SMFEventHandler handleEvent, void *context) {
+	gsize offset = EVENT_STREAM_HEADER_SIZE;
+	while (fileBufferLength - offset >= EVENT_STREAM_RECORD_SIZE) {
+		MT32Emu::Bit32u timestamp = readLE32(fileBuffer + offset);
+		MT32Emu::Bit32u msg = readLE32(fileBuffer + offset + 4);
+		offset += EVENT_STREAM_RECORD_SIZE;
+		const MT32Emu::Bit8u *sysex = NULL;
+		MT32Emu::Bit32u sysexLength = 0;
+		if ((msg & EVENT_STREAM_SYSEX_FLAG) != 0) {
+			sysexLength = msg & ~EVENT_STREAM_SYSEX_FLAG;
+			if (sysexLength > fileBufferLength - offset) {
+				return false;
 			}
+			sysex = fileBuffer + offset;
+			offset = MIN(offset + ((sysexLength + 3) & ~3U), fileBufferLength);
+			msg = 0;
+		}
+		if (!handleEvent(timestamp / double(MT32Emu::SAMPLE_RATE), msg, sysex, sysexLength, context)) {
+			return true;
 		}
 	}
-	if (!state.service.isActive()) {
-		state.unwrittenSilentFrames = 0;
-	}
-	delete[] unterminatedSysex;
+	return offset == fileBufferLength;
 }
 
-static bool playFile(const gchar *inputFilename, const gchar *displayInputFilename, const Options &options, State &state) {
-	MT32Emu::Bit8u *fileBuffer = NULL;
-	gsize fileBufferLength = 0;
-	if (!loadFile(fileBuffer, fileBufferLength, inputFilename, displayInputFilename)) {
-		return false;
-	}
-	if (fileBuffer[0] == 0xF0) {
-		return playSysexFileBuffer(state.service, displayInputFilename, fileBuffer, fileBufferLength);
+// The events are mapped to the output sample rate the same way as those of an SMF file, so the output matches.
+static void playEventStream(const MT32Emu::Bit8u *fileBuffer, gsize fileBufferLength, const gchar *displayFilename, const Options &options, State &state) {
+	Playback playback = {options, state, 0, 0, false};
+	if (!readEventStream(fileBuffer, fileBufferLength, playSMFEvent, &playback)) {
+		fprintf(stderr, "Event stream file '%s' is truncated.\n", displayFilename);
 	}
+	finishPlayback(playback);
+}
+
+static smf_t *loadSMF(const MT32Emu::Bit8u *fileBuffer, gsize fileBufferLength, const gchar *displayFilename, const Options &options) {
 	smf_t *smf = smf_load_from_memory(fileBuffer, int(fileBufferLength));
-	if (smf != NULL) {
-		if (!options.quiet) {
-			char *decoded = smf_decode(smf);
-			fprintf(stdout, "%s.\n", decoded);
-			free(decoded);
+	if (smf == NULL) {
+		fprintf(stderr, "Error parsing SMF file '%s'.\n", displayFilename);
+		return NULL;
+	}
+	if (!options.quiet) {
+		char *decoded = smf_decode(smf);
+		fprintf(messageStream, "%s.\n", decoded);
+		free(decoded);
+	}
+	assert(smf->number_of_tracks >= 1);
+	return smf;
+}
+
+static bool playFile(const InputFile &inputFile, const Options &options, State &state) {
+	if (inputFile.mappedFile == NULL) {
+		return false;
+	}
+	const MT32Emu::Bit8u *fileBuffer = inputFile.fileBuffer;
+	const gsize fileBufferLength = inputFile.fileBufferLength;
+	const gchar *displayInputFilename = inputFile.displayFilename;
+	bool played = true;
+	if (fileBuffer[0] == 0xF0) {
+		played = playSysexFileBuffer(state.service, displayInputFilename, fileBuffer, fileBufferLength);
+	} else if (isEventStreamBuffer(fileBuffer, fileBufferLength)) {
+		if (readLE32(fileBuffer + 4) == EVENT_STREAM_VERSION) {
+			playEventStream(fileBuffer, fileBufferLength, displayInputFilename, options, state);
+		} else {
+			fprintf(stderr, "Unsupported version of event stream file '%s'.\n", displayInputFilename);
+			played = false;
+		}
+	} else {
+		smf_t *smf = loadSMF(fileBuffer, fileBufferLength, displayInputFilename, options);
+		if (smf != NULL) {
+			playSMF(smf, options, state);
+			smf_delete(smf);
+		} else {
+			played = false;
 		}
-		assert(smf->number_of_tracks >= 1);
-		playSMF(smf, options, state);
-		smf_delete(smf);
-		return true;
 	}
-	fprintf(stderr, "Error parsing SMF file '%s'.\n", displayInputFilename);
-	return false;
+	return played;
 }
 
-int main(int argc, char *argv[]) {
-	Options options;
-	MT32Emu::Service service;
-	setlocale(LC_ALL, "");
-	printf("Munt MT32Emu MIDI to Wave Conversion Utility. Version %s\n", VERSION);
-	printf("  Copyright (C) 2009, 2011 Jerome Fisher <re_munt@kingguppy.com>\n");
-	printf("  Copyright (C) 2012-2021 Jerome Fisher, Sergey V. Mikayev\n");
-	printf("Using Munt MT32Emu Library Version %s, libsmf Version %s (with modifications)\n", service.getLibraryVersionString(), smf_get_version());
-	if (!parseOptions(argc, argv, &options)) {
-		return -1;
+static bool writeEventStreamRecord(double eventTime, MT32Emu::Bit32u msg, const MT32Emu::Bit8u *sysex, MT32Emu::Bit32u sysexLength, void *context) {
+	static const unsigned char padding[] = {0, 0, 0};
+	FILE *outputFile = static_cast<FILE *>(context);
+	MT32Emu::Bit32u timestamp = MT32Emu::Bit32u(secondsToSamples(eventTime, MT32Emu::SAMPLE_RATE));
+	if (!writeLE32(outputFile, timestamp) || !writeLE32(outputFile, sysex == NULL ? msg : sysexLength | EVENT_STREAM_SYSEX_FLAG)) {
+		return false;
 	}
-	gchar *outputFilename;
-	gchar *displayOutputFilename;
-	if (options.outputFilename != NULL) {
-		outputFilename = options.outputFilename;
+	if (sysex == NULL) {
+		return true;
+	}
+	size_t paddingLength = (4 - (sysexLength & 3)) & 3;
+	return fwrite(sysex, 1, sysexLength, outputFile) == sysexLength && fwrite(padding, 1, paddingLength, outputFile) == paddingLength;
+}
+
+// Converts the source SMF file to a pre-timed event stream, so that subsequent runs neither parse it nor compute the tempo map.
+static bool writeEventStream(const gchar *inputFilename, const Options &options) {
+	gchar *displayInputFilename = g_filename_display_name(inputFilename);
+	gchar *outputFilename = g_strconcat(inputFilename, EVENT_STREAM_EXTENSION, NULL);
+	gchar *displayOutputFilename = g_filename_display_name(outputFilename);
+	const MT32Emu::Bit8u *fileBuffer = NULL;
+	gsize fileBufferLength = 0;
+	bool written = false;
+	GMappedFile *mappedFile = mapFile(fileBuffer, fileBufferLength, inputFilename, displayInputFilename);
+	smf_t *smf = NULL;
+	if (mappedFile == NULL) {
+		// Already reported.
+	} else if (fileBuffer[0] == 0xF0 || isEventStreamBuffer(fileBuffer, fileBufferLength)) {
+		fprintf(stderr, "Skipping '%s', only SMF files are converted to event streams.\n", displayInputFilename);
 	} else {
-		gchar *lastInputFilename = options.inputFilenames[g_strv_length(options.inputFilenames) - 1];
-		size_t allocLen = strlen(lastInputFilename) + 5;
-		outputFilename = (gchar *)malloc(allocLen);
-		if(outputFilename == NULL) {
-			fprintf(stderr, "Error allocating %lu bytes for destination filename.\n", (unsigned long)allocLen);
-			return -1;
-		}
-		if (options.rawChannelCount > 0) {
-			sprintf(outputFilename, "%s.raw", lastInputFilename);
+		smf = loadSMF(fileBuffer, fileBufferLength, displayInputFilename, options);
+	}
+	if (smf != NULL) {
+		FILE *outputFile = NULL;
+		if (!options.force && g_file_test(outputFilename, G_FILE_TEST_EXISTS)) {
+			fprintf(stderr, "Destination file '%s' exists.\n", displayOutputFilename);
 		} else {
-			sprintf(outputFilename, "%s.wav", lastInputFilename);
+			outputFile = fopen(outputFilename, "wb");
+			if (outputFile == NULL) {
+				fprintf(stderr, "Error opening file '%s' for writing.\n", displayOutputFilename);
+			}
 		}
+		if (outputFile != NULL) {
+			written = fwrite(EVENT_STREAM_SIGNATURE, 1, 4, outputFile) == 4 && writeLE32(outputFile, EVENT_STREAM_VERSION);
+			if (written) {
+				readSMF(smf, options, writeEventStreamRecord, outputFile);
+				written = ferror(outputFile) == 0;
+			}
+			written = fclose(outputFile) == 0 && written;
+			if (!written) {
+				fprintf(stderr, "Error writing event stream file '%s'.\n", displayOutputFilename);
+			} else if (!options.quiet) {
+				fprintf(messageStream, "Written event stream file '%s'.\n", displayOutputFilename);
+			}
+		}
+		smf_delete(smf);
 	}
-	displayOutputFilename = g_filename_display_name(outputFilename);
+	if (mappedFile != NULL) {
+		g_mapped_file_unref(mappedFile);
+	}
+	g_free(displayOutputFilename);
+	g_free(outputFilename);
+	g_free(displayInputFilename);
+	return written;
+}
 
-	service.createContext();
-	gchar *baseDir = options.romDir;
-	if (baseDir == NULL)
-		baseDir = (gchar *)"";
-	gchar pathNameUtf8[2048];
-	g_strlcpy(pathNameUtf8, baseDir, 2048);
-	g_strlcat(pathNameUtf8, "CM32L_CONTROL.ROM", 2048);
-	gchar *pathName = g_locale_from_utf8(pathNameUtf8, strlen(pathNameUtf8), NULL, NULL, NULL);
-	if (service.addROMFile(pathName) != MT32EMU_RC_ADDED_CONTROL_ROM) {
-		g_free(pathName);
-		g_strlcpy(pathNameUtf8, baseDir, 2048);
-		g_strlcat(pathNameUtf8, "MT32_CONTROL.ROM", 2048);
-		pathName = g_locale_from_utf8(pathNameUtf8, strlen(pathNameUtf8), NULL, NULL, NULL);
-		if (service.addROMFile(pathName) != MT32EMU_RC_ADDED_CONTROL_ROM) {
-			fprintf(stderr, "Control ROM not found.\n");
-			return 1;
-		}
-	}
-	g_free(pathName);
-	g_strlcpy(pathNameUtf8, baseDir, 2048);
-	g_strlcat(pathNameUtf8, "CM32L_PCM.ROM", 2048);
-	pathName = g_locale_from_utf8(pathNameUtf8, strlen(pathNameUtf8), NULL, NULL, NULL);
-	if (service.addROMFile(pathName) != MT32EMU_RC_ADDED_PCM_ROM) {
+static gchar *makeOutputFilename(const gchar *inputFilename, const Options &options) {
+	return g_strconcat(inputFilename, options.rawChannelCount > 0 ? ".raw" : ".wav", NULL);
+}
+
+static bool addROMFile(MT32Emu::Service &service, const gchar *baseDir, const char *preferredFilename, const char *fallbackFilename, mt32emu_return_code expectedResult) {
+	const char *romFilenames[] = {preferredFilename, fallbackFilename};
+	for (int i = 0; i < 2; i++) {
+		gchar *pathNameUtf8 = g_strconcat(baseDir, romFilenames[i], NULL);
+		gchar *pathName = g_locale_from_utf8(pathNameUtf8, strlen(pathNameUtf8), NULL, NULL, NULL);
+		bool added = service.addROMFile(pathName) == expectedResult;
 		g_free(pathName);
-		g_strlcpy(pathNameUtf8, baseDir, 2048);
-		g_strlcat(pathNameUtf8, "MT32_PCM.ROM", 2048);
-		pathName = g_locale_from_utf8(pathNameUtf8, strlen(pathNameUtf8), NULL, NULL, NULL);
-		if (service.addROMFile(pathName) != MT32EMU_RC_ADDED_PCM_ROM) {
-			fprintf(stderr, "PCM ROM not found.\n");
-			return 1;
-		}
+		g_free(pathNameUtf8);
+		if (added) return true;
 	}
-	g_free(pathName);
+	return false;
+}
+
+static bool loadROMs(MT32Emu::Service &service, const Options &options) {
+	const gchar *baseDir = options.romDir == NULL ? "" : options.romDir;
+	if (!addROMFile(service, baseDir, "CM32L_CONTROL.ROM", "MT32_CONTROL.ROM", MT32EMU_RC_ADDED_CONTROL_ROM)) {
+		fprintf(stderr, "Control ROM not found.\n");
+		return false;
+	}
+	if (!addROMFile(service, baseDir, "CM32L_PCM.ROM", "MT32_PCM.ROM", MT32EMU_RC_ADDED_PCM_ROM)) {
+		fprintf(stderr, "PCM ROM not found.\n");
+		return false;
+	}
+	return true;
+}
+
+// On success, the sample rate in the options is updated to the actual output sample rate of the synth.
+static bool openSynth(MT32Emu::Service &service, Options &options) {
 	service.setStereoOutputSampleRate(options.sampleRate);
 	service.setSamplerateConversionQuality(options.srcQuality);
 	service.setPartialCount(options.partialCount);
 	service.setAnalogOutputMode(options.analogOutputMode);
 	service.selectRendererType(options.rendererType);
-	if (service.openSynth() == MT32EMU_RC_OK) {
-		service.setDACInputMode(options.dacInputMode);
-		if (!options.niceAmpRamp) {
-			service.setNiceAmpRampEnabled(false);
-		}
-		if (options.nicePanning) {
-			service.setNicePanningEnabled(true);
-		}
-		if (options.nicePartialMixing) {
-			service.setNicePartialMixingEnabled(true);
-		}
-		options.sampleRate = service.getActualStereoOutputSamplerate();
-		printf("Using output sample rate %d Hz\n", options.sampleRate);
-
-		FILE *outputFile;
-		bool outputFileExists = false;
-		if (!options.force) {
-			// FIXME: Lame way of avoiding overwriting an existing file
-			// (since it could theoretically be created between us testing and
-			// opening for writing)
-			if (g_file_test(outputFilename, G_FILE_TEST_EXISTS)) {
-				outputFileExists = true;
+	if (service.openSynth() != MT32EMU_RC_OK) {
+		fprintf(stderr, "Error opening MT32Emu synthesizer.\n");
+		return false;
+	}
+	service.setDACInputMode(options.dacInputMode);
+	if (!options.niceAmpRamp) {
+		service.setNiceAmpRampEnabled(false);
+	}
+	if (options.nicePanning) {
+		service.setNicePanningEnabled(true);
+	}
+	if (options.nicePartialMixing) {
+		service.setNicePartialMixingEnabled(true);
+	}
+	if (options.dither) {
+		service.setOutputDitherEnabled(true);
+	}
+	if (options.partialCullingThreshold > 0.0) {
+		service.setPartialCullingThreshold(float(options.partialCullingThreshold));
+	}
+	if (options.rhythmHitCache) {
+		service.setRhythmHitCacheEnabled(true);
+	}
+	options.sampleRate = service.getActualStereoOutputSamplerate();
+	return true;
+}
+
+// Reads the events of an SMF or event stream source file. Unlike playFile(), sysex files are not accepted.
+static bool readSourceFile(const InputFile &inputFile, const Options &options, SMFEventHandler handleEvent, void *context) {
+	const MT32Emu::Bit8u *fileBuffer = inputFile.fileBuffer;
+	const gsize fileBufferLength = inputFile.fileBufferLength;
+	const gchar *displayInputFilename = inputFile.displayFilename;
+	bool read = false;
+	if (inputFile.mappedFile == NULL) {
+		// Already reported.
+	} else if (fileBuffer[0] == 0xF0) {
+		fprintf(stderr, "Sysex file '%s' cannot be rendered in segments.\n", displayInputFilename);
+	} else if (isEventStreamBuffer(fileBuffer, fileBufferLength)) {
+		if (readLE32(fileBuffer + 4) == EVENT_STREAM_VERSION) {
+			if (!readEventStream(fileBuffer, fileBufferLength, handleEvent, context)) {
+				fprintf(stderr, "Event stream file '%s' is truncated.\n", displayInputFilename);
 			}
+			read = true;
+		} else {
+			fprintf(stderr, "Unsupported version of event stream file '%s'.\n", displayInputFilename);
 		}
-		if (outputFileExists) {
-			fprintf(stderr, "Destination file '%s' exists.\n", displayOutputFilename);
-			outputFile = NULL;
+	} else {
+		smf_t *smf = loadSMF(fileBuffer, fileBufferLength, displayInputFilename, options);
+		if (smf != NULL) {
+			readSMF(smf, options, handleEvent, context);
+			smf_delete(smf);
+			read = true;
+		}
+	}
+	return read;
+}
+
+// A part of the source file rendered through a synth of its own in the segmented mode. The synth fast-forwards through
+// the events before the pre-roll, playing those that change its state at once without rendering and skipping the notes.
+// The pre-roll is rendered as usual but discarded, so that the notes and the reverb sounding at the start of the segment
+// catch up with the sequential rendering. The output is recorded to a temporary file.
+struct Segment {
+	const InputFile *inputFile;
+	unsigned long prerollFrameIx;
+	unsigned long startFrameIx;
+	// ULONG_MAX for the last segment, which is played to the end of the source file.
+	unsigned long endFrameIx;
+	FILE *file;
+	unsigned long writtenFrames;
+};
+
+struct SegmentPlayback {
+	Playback playback;
+	const Segment &segment;
+	OutputWriter *outputWriter;
+	// The block of the output writer to be filled first, while the pre-roll is being discarded; NULL afterwards.
+	OutputBlock *outputBlock;
+};
+
+// Switches from discarding the pre-roll to recording the output once the start of the segment is rendered.
+static void startRecording(SegmentPlayback &segmentPlayback) {
+	Playback &playback = segmentPlayback.playback;
+	State &state = playback.state;
+	playback.renderLimitReached = !renderUntil(segmentPlayback.segment.startFrameIx, playback.renderedFrames, playback.options, state);
+	state.outputWriter = segmentPlayback.outputWriter;
+	state.outputBlock = segmentPlayback.outputBlock;
+	segmentPlayback.outputBlock = NULL;
+	state.unwrittenSilentFrames = 0;
+	state.writtenFrames = 0;
+	// The silence at the start of the output is only trimmed in the first segment.
+	state.firstNoiseEncountered = true;
+}
+
+static bool playSegmentEvent(double eventTime, MT32Emu::Bit32u msg, const MT32Emu::Bit8u *sysex, MT32Emu::Bit32u sysexLength, void *context) {
+	SegmentPlayback &segmentPlayback = *static_cast<SegmentPlayback *>(context);
+	const Segment &segment = segmentPlayback.segment;
+	Playback &playback = segmentPlayback.playback;
+	unsigned long eventFrameIx = secondsToSamples(eventTime, playback.options.sampleRate);
+	if (eventFrameIx < segment.prerollFrameIx) {
+		if (sysex != NULL) {
+			playback.state.service.playSysexNow(sysex, sysexLength);
+		} else if ((msg & 0xF0) >= 0xB0 && (msg & 0xF0) < 0xF0) {
+			// Controllers, programs and pitch bends, as opposed to notes.
+			playback.state.service.playMsgNow(msg);
+		}
+		return true;
+	}
+	if (eventFrameIx >= segment.endFrameIx) {
+		return false;
+	}
+	if (segmentPlayback.outputBlock != NULL && eventFrameIx >= segment.startFrameIx) {
+		startRecording(segmentPlayback);
+		if (playback.renderLimitReached) {
+			return false;
+		}
+	}
+	return playEvent(msg, sysex, sysexLength, eventFrameIx, playback);
+}
+
+static void playSegment(Segment &segment, const Options &options, State &state) {
+	// The pre-roll is discarded the same way as the output of the benchmark.
+	OutputBlock discardedBlock = {NULL, 0};
+	SegmentPlayback segmentPlayback = {{options, state, segment.prerollFrameIx, segment.prerollFrameIx, false}, segment, state.outputWriter, NULL};
+	state.renderedFrames = segment.prerollFrameIx;
+	state.lastInputFile = segment.endFrameIx == ULONG_MAX;
+	if (segment.startFrameIx > 0) {
+		discardedBlock.data = new MT32Emu::Bit8u[state.outputBufferSize];
+		segmentPlayback.outputBlock = state.outputBlock;
+		state.outputWriter = NULL;
+		state.outputBlock = &discardedBlock;
+	}
+	if (readSourceFile(*segment.inputFile, options, playSegmentEvent, &segmentPlayback)) {
+		if (segmentPlayback.outputBlock != NULL) {
+			startRecording(segmentPlayback);
+		}
+		if (state.lastInputFile) {
+			finishPlayback(segmentPlayback.playback);
 		} else {
-			outputFile = fopen(outputFilename, "wb");
+			if (!segmentPlayback.playback.renderLimitReached) {
+				renderUntil(segment.endFrameIx, segmentPlayback.playback.renderedFrames, options, state);
+			}
+			// The silence at the end continues into the next segment, so it is recorded in full.
+			flushSilence(NOISE_DETECTED, options, state);
 		}
+	} else if (segmentPlayback.outputBlock != NULL) {
+		state.outputWriter = segmentPlayback.outputWriter;
+		state.outputBlock = segmentPlayback.outputBlock;
+	}
+	delete[] discardedBlock.data;
+}
 
-		clock_t startTime = clock();
+static bool isRawStreamRequested(const Options &options, const int streamId) {
+	for (int i = 0; i < options.rawChannelCount; i++) {
+		if (options.rawChannelMap[i] == streamId) return true;
+	}
+	return false;
+}
 
-		if (outputFile != NULL) {
-			if (options.rawChannelCount > 0 || writeWAVEHeader(outputFile, options.sampleRate, options.outputSampleFormat)) {
-				State state = {NULL, {NULL, NULL, NULL, NULL, NULL, NULL}, service, outputFile, false, false, 0, 0, 0};
-				state.outputFile = outputFile;
-				if (options.rawChannelCount > 0) {
-					for (int i = 0; i < 6; i++) {
-						if (options.outputSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32) {
-							state.rawSampleBuffer[i] = new float[options.bufferFrameCount];
-						} else {
-							state.rawSampleBuffer[i] = new MT32Emu::Bit16s[options.bufferFrameCount];
-						}
-					}
-				} else {
-					if (options.outputSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32) {
-						state.stereoSampleBuffer = new float[options.bufferFrameCount * 2];
-					} else {
-						state.stereoSampleBuffer = new MT32Emu::Bit16s[options.bufferFrameCount * 2];
-					}
-				}
-				gchar **inputFilename = options.inputFilenames;
-				while (*inputFilename != NULL) {
-					gchar *displayInputFilename = g_filename_display_name(*inputFilename);
-					state.lastInputFile = *(inputFilename + 1) == NULL; // FIXME: This should actually be true if all subsequent files are sysex
-					playFile(*inputFilename, displayInputFilename, options, state);
-					inputFilename++;
-					g_free(displayInputFilename);
-				}
-				if (options.outputSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32) {
-					delete[] static_cast<float *>(state.stereoSampleBuffer);
-					for (int i = 0; i < 6; i++) {
-						delete[] static_cast<float *>(state.rawSampleBuffer[i]);
-					}
-				} else {
-					delete[] static_cast<MT32Emu::Bit16s *>(state.stereoSampleBuffer);
-					for (int i = 0; i < 6; i++) {
-						delete[] static_cast<MT32Emu::Bit16s *>(state.rawSampleBuffer[i]);
-					}
-				}
-				if (options.rawChannelCount == 0 && !fillWAVESizes(outputFile, state.writtenFrames, options.outputSampleFormat)) {
-					fprintf(stderr, "Error writing final sizes to WAVE header\n");
-				}
+// Plays all the input files in sequence through the opened synth, or only the segment unless it is NULL. Unless the output file
+// is NULL, the recorded samples are written to it. Returns the number of frames recorded and sets the number of frames rendered.
+static unsigned long playFiles(MT32Emu::Service &service, const InputFile *inputFiles, FILE *outputFile, FILE * const *teeFiles, const Options &options, unsigned long &renderedFrames, Segment *segment) {
+	OutputWriter outputWriter;
+	TeeWriter teeWriters[MAX_TEE_OUTPUT_COUNT];
+	unsigned int teeWriterCount = 0;
+	OutputBlock discardedBlock = {NULL, 0};
+	State state = {NULL, {NULL}, service, outputFile, NULL, NULL, 0, false, false, 0, 0, 0};
+	const unsigned int channelCount = options.rawChannelCount > 0 ? options.rawChannelCount : 2;
+	const unsigned int sampleSize = options.outputSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32 ? 4 : 2;
+	state.outputBufferSize = options.bufferFrameCount * channelCount * sampleSize;
+	if (outputFile != NULL) {
+		state.outputWriter = &outputWriter;
+		teeWriterCount = startTeeWriters(teeWriters, outputWriter, teeFiles, options, state.outputBufferSize);
+		state.outputBlock = startOutputWriter(outputWriter, outputFile, state.outputBufferSize, teeWriters, teeWriterCount);
+	} else {
+		discardedBlock.data = new MT32Emu::Bit8u[state.outputBufferSize];
+		state.outputBlock = &discardedBlock;
+	}
+	if (options.rawChannelCount > 0) {
+		for (int i = 0; i < RAW_STREAM_ID_COUNT; i++) {
+			// The part streams are only allocated when requested, otherwise each would be rendered needlessly.
+			if (options.rawPartStreams ? !isRawStreamRequested(options, i) : i >= FIRST_PART_RAW_STREAM_ID) continue;
+			if (options.outputSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32) {
+				state.rawSampleBuffer[i] = new float[options.bufferFrameCount];
 			} else {
-				fprintf(stderr, "Error writing WAVE header to '%s'\n", displayOutputFilename);
+				state.rawSampleBuffer[i] = new MT32Emu::Bit16s[options.bufferFrameCount];
 			}
-			fclose(outputFile);
-			printf("Elapsed time: %f sec\n", float(clock() - startTime) / CLOCKS_PER_SEC);
+		}
+	} else {
+		if (options.outputSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32) {
+			state.stereoSampleBuffer = new float[options.bufferFrameCount * 2];
 		} else {
-			fprintf(stderr, "Error opening file '%s' for writing.\n", displayOutputFilename);
+			state.stereoSampleBuffer = new MT32Emu::Bit16s[options.bufferFrameCount * 2];
 		}
+	}
+	if (segment != NULL) {
+		playSegment(*segment, options, state);
 	} else {
-		fprintf(stderr, "Error opening MT32Emu synthesizer.\n");
+		for (const InputFile *inputFile = inputFiles; inputFile->filename != NULL; inputFile++) {
+			state.lastInputFile = (inputFile + 1)->filename == NULL; // FIXME: This should actually be true if all subsequent files are sysex
+			playFile(*inputFile, options, state);
+		}
+	}
+	if (outputFile != NULL) {
+		flushOutputBuffer(state);
+		stopOutputWriter(outputWriter);
+		stopTeeWriters(teeWriters, teeWriterCount);
+	} else {
+		delete[] discardedBlock.data;
+	}
+	if (options.outputSampleFormat == OUTPUT_SAMPLE_FORMAT_IEEE_FLOAT32) {
+		delete[] static_cast<float *>(state.stereoSampleBuffer);
+		for (int i = 0; i < RAW_STREAM_ID_COUNT; i++) {
+			delete[] static_cast<float *>(state.rawSampleBuffer[i]);
+		}
+	} else {
+		delete[] static_cast<MT32Emu::Bit16s *>(state.stereoSampleBuffer);
+		for (int i = 0; i < RAW_STREAM_ID_COUNT; i++) {
+			delete[] static_cast<MT32Emu::Bit16s *>(state.rawSampleBuffer[i]);
+		}
+	}
+	renderedFrames = state.renderedFrames;
+	return state.writtenFrames;
+}
+
+// Renders a segment to its temporary file. Runs on a worker thread of the pool, with a synth of its own.
+static void runSegmentJob(gpointer data, gpointer userData) {
+	Segment &segment = *static_cast<Segment *>(data);
+	Options options = *static_cast<const Options *>(userData);
+	// The metadata of the source file is already reported while looking for its end.
+	options.quiet = true;
+	MT32Emu::Service service;
+	service.createContext();
+	if (loadROMs(service, options) && openSynth(service, options)) {
+		unsigned long renderedFrames;
+		segment.writtenFrames = playFiles(service, NULL, segment.file, NULL, options, renderedFrames, &segment);
 	}
 	service.freeContext();
+}
+
+static bool findEndTime(double eventTime, MT32Emu::Bit32u, const MT32Emu::Bit8u *, MT32Emu::Bit32u, void *context) {
+	double &endTime = *static_cast<double *>(context);
+	endTime = MAX(endTime, eventTime);
+	return true;
+}
+
+static bool copyStream(FILE *sourceFile, FILE *outputFile) {
+	char *buffer = new char[COPY_BUFFER_SIZE];
+	bool copied = true;
+	while (copied) {
+		size_t byteCount = fread(buffer, 1, COPY_BUFFER_SIZE, sourceFile);
+		if (byteCount == 0) {
+			copied = ferror(sourceFile) == 0;
+			break;
+		}
+		copied = fwrite(buffer, 1, byteCount, outputFile) == byteCount;
+	}
+	delete[] buffer;
+	return copied;
+}
+
+// Splits the source file into segments of equal duration, renders them concurrently and concatenates their output.
+// Returns the number of frames recorded.
+static unsigned long playSegments(const InputFile &inputFile, FILE *outputFile, const Options &options) {
+	double endTime = 0;
+	if (!readSourceFile(inputFile, options, findEndTime, &endTime)) {
+		return 0;
+	}
+	const unsigned long endFrameIx = MIN(secondsToSamples(endTime, options.sampleRate), long(options.renderMaxFrames));
+	const unsigned long prerollFrames = secondsToSamples(options.segmentPreroll, options.sampleRate);
+	Segment *segments = new Segment[options.segmentCount];
+	int segmentCount = 0;
+	bool filesCreated = true;
+	for (int i = 0; i < options.segmentCount; i++) {
+		unsigned long startFrameIx = static_cast<unsigned long>(double(endFrameIx) * i / options.segmentCount);
+		// Very short source files are split into fewer segments.
+		if (segmentCount > 0 && startFrameIx == segments[segmentCount - 1].startFrameIx) continue;
+		Segment &segment = segments[segmentCount++];
+		segment.inputFile = &inputFile;
+		segment.prerollFrameIx = startFrameIx > prerollFrames ? startFrameIx - prerollFrames : 0;
+		segment.startFrameIx = startFrameIx;
+		segment.endFrameIx = ULONG_MAX;
+		if (segmentCount > 1) {
+			segments[segmentCount - 2].endFrameIx = startFrameIx;
+		}
+		segment.file = tmpfile();
+		segment.writtenFrames = 0;
+		if (segment.file == NULL) {
+			fprintf(stderr, "Error creating a temporary file for a segment.\n");
+			filesCreated = false;
+			break;
+		}
+	}
+	GThreadPool *pool = NULL;
+	if (filesCreated) {
+		pool = g_thread_pool_new(runSegmentJob, const_cast<Options *>(&options), segmentCount, TRUE, NULL);
+		if (pool == NULL) {
+			fprintf(stderr, "Error creating a pool of %d threads.\n", segmentCount);
+		}
+	}
+	unsigned long writtenFrames = 0;
+	if (pool != NULL) {
+		if (!options.quiet) {
+			fprintf(messageStream, "Rendering %d segments with a pre-roll of %f sec\n", segmentCount, options.segmentPreroll);
+		}
+		for (int i = 0; i < segmentCount; i++) {
+			g_thread_pool_push(pool, &segments[i], NULL);
+		}
+		// Waits for all the segments to be rendered.
+		g_thread_pool_free(pool, FALSE, TRUE);
+		for (int i = 0; i < segmentCount; i++) {
+			rewind(segments[i].file);
+			if (!copyStream(segments[i].file, outputFile)) {
+				fprintf(stderr, "Error copying a rendered segment to the output file\n");
+				break;
+			}
+			writtenFrames += segments[i].writtenFrames;
+		}
+	}
+	for (int i = 0; i < segmentCount; i++) {
+		if (segments[i].file != NULL) {
+			fclose(segments[i].file);
+		}
+	}
+	delete[] segments;
+	return writtenFrames;
+}
+
+// Plays all the input files in sequence through the opened synth recording the output to the opened file.
+// The output is also written to the opened tee files, if any, which may be NULL for those that failed to open.
+static bool record(MT32Emu::Service &service, const InputFile *inputFiles, FILE *outputFile, FILE * const *teeFiles,
+	const gchar *displayOutputFilename, bool writingToStdout, const Options &options)
+{
+	if (options.rawChannelCount == 0 && !writeWAVEHeader(outputFile, options.sampleRate, options.outputSampleFormat)) {
+		fprintf(stderr, "Error writing WAVE header to '%s'\n", displayOutputFilename);
+		return false;
+	}
+	for (int i = 0; teeFiles != NULL && i < options.teeOutputCount; i++) {
+		if (teeFiles[i] == NULL || options.rawChannelCount > 0) continue;
+		if (!writeWAVEHeader(teeFiles[i], options.sampleRate, options.teeOutputSampleFormats[i])) {
+			gchar *displayTeeFilename = g_filename_display_name(options.teeOutputFilenames[i]);
+			fprintf(stderr, "Error writing WAVE header to '%s'\n", displayTeeFilename);
+			g_free(displayTeeFilename);
+		}
+	}
+	unsigned long writtenFrames;
+	if (options.segmentCount > 1) {
+		writtenFrames = playSegments(inputFiles[0], outputFile, options);
+	} else {
+		unsigned long renderedFrames;
+		writtenFrames = playFiles(service, inputFiles, outputFile, teeFiles, options, renderedFrames, NULL);
+	}
+	// Failing to seek in the standard output is expected when it is a pipe.
+	if (options.rawChannelCount == 0 && !fillWAVESizes(outputFile, writtenFrames, options.outputSampleFormat) && !writingToStdout) {
+		fprintf(stderr, "Error writing final sizes to WAVE header\n");
+	}
+	for (int i = 0; teeFiles != NULL && i < options.teeOutputCount; i++) {
+		if (teeFiles[i] == NULL || options.rawChannelCount > 0) continue;
+		if (!fillWAVESizes(teeFiles[i], writtenFrames, options.teeOutputSampleFormats[i]) && teeFiles[i] != stdout) {
+			fprintf(stderr, "Error writing final sizes to WAVE header\n");
+		}
+	}
+	return ferror(outputFile) == 0;
+}
+
+// Makes the path name of the cached output that corresponds to everything the output depends on: the contents of
+// the source files, the ROMs, the versions of the library and this program, and the settings affecting rendering
+// and encoding. Returns NULL if a source file cannot be read, so that the conversion proceeds without the cache.
+static gchar *makeCacheFilename(MT32Emu::Service &service, const InputFile *inputFiles, const Options &options) {
+	mt32emu_rom_info romInfo;
+	service.getROMInfo(&romInfo);
+	GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA256);
+	gchar *settings = g_strdup_printf("%s\n%s\n%s\n%s\n%s\n%d %d %d %d %d %d %u %u %u %d %d %d %d %d %.17g %d %d %d %d %d %d %.17g %d %.17g %d",
+		RENDER_CACHE_VERSION, VERSION, service.getLibraryVersionString(),
+		romInfo.control_rom_sha1_digest == NULL ? "" : romInfo.control_rom_sha1_digest,
+		romInfo.pcm_rom_sha1_digest == NULL ? "" : romInfo.pcm_rom_sha1_digest,
+		options.sampleRate, int(options.outputSampleFormat), int(options.dacInputMode), int(options.analogOutputMode),
+		int(options.rendererType), int(options.srcQuality), options.bufferFrameCount, options.renderMinFrames, options.renderMaxFrames,
+		options.partialCount, options.recordMaxStartSilentFrames, options.recordMaxEndSilentFrames, options.recordMaxLA32EndSilentFrames,
+		int(options.waitForLA32), options.reverbEndLevel, int(options.waitForReverb), int(options.sendAllNotesOff),
+		int(options.niceAmpRamp), int(options.nicePanning), int(options.nicePartialMixing), int(options.dither), options.partialCullingThreshold,
+		options.segmentCount > 1 ? options.segmentCount : 1, options.segmentPreroll, int(options.rhythmHitCache));
+	g_checksum_update(checksum, reinterpret_cast<const guchar *>(settings), strlen(settings));
+	g_free(settings);
+	for (int i = 0; i < options.rawChannelCount; i++) {
+		gchar *rawChannel = g_strdup_printf(" %d", options.rawChannelMap[i]);
+		g_checksum_update(checksum, reinterpret_cast<const guchar *>(rawChannel), strlen(rawChannel));
+		g_free(rawChannel);
+	}
+	bool inputsHashed = true;
+	for (const InputFile *inputFile = inputFiles; inputFile->filename != NULL; inputFile++) {
+		if (inputFile->mappedFile == NULL) {
+			inputsHashed = false;
+			break;
+		}
+		// The length separates the contents of consecutive files.
+		gchar *fileLength = g_strdup_printf("\n%" G_GSIZE_FORMAT "\n", inputFile->fileBufferLength);
+		g_checksum_update(checksum, reinterpret_cast<const guchar *>(fileLength), strlen(fileLength));
+		g_free(fileLength);
+		g_checksum_update(checksum, inputFile->fileBuffer, gssize(inputFile->fileBufferLength));
+	}
+	gchar *cacheFilename = NULL;
+	if (inputsHashed) {
+		gchar *name = g_strconcat(g_checksum_get_string(checksum), options.rawChannelCount > 0 ? ".raw" : ".wav", NULL);
+		cacheFilename = g_build_filename(options.cacheDir, name, NULL);
+		g_free(name);
+	}
+	g_checksum_free(checksum);
+	return cacheFilename;
+}
+
+static bool copyFile(const gchar *sourceFilename, FILE *outputFile) {
+	FILE *sourceFile = g_fopen(sourceFilename, "rb");
+	if (sourceFile == NULL) {
+		return false;
+	}
+	bool copied = copyStream(sourceFile, outputFile);
+	fclose(sourceFile);
+	return copied;
+}
+
+// Renders the output into the cache unless it is already there. Returns the name of the file to copy the output from,
+// or NULL if there is nothing to copy: either rendering failed or the cache file could not be created, in which case
+// the output is recorded to the output file directly.
+static gchar *recordToCache(MT32Emu::Service &service, const InputFile *inputFiles, const gchar *cacheFilename, FILE *outputFile,
+	const gchar *displayOutputFilename, bool writingToStdout, const Options &options)
+{
+	gchar *displayCacheFilename = g_filename_display_name(cacheFilename);
+	gchar *sourceFilename = NULL;
+	if (g_file_test(cacheFilename, G_FILE_TEST_IS_REGULAR)) {
+		if (!options.quiet) {
+			fprintf(messageStream, "Using cached output '%s'.\n", displayCacheFilename);
+		}
+		sourceFilename = g_strdup(cacheFilename);
+	} else {
+		// The output is recorded under a unique temporary name first, so that neither a failed conversion nor a concurrent
+		// job ever leave an incomplete file under the final name.
+		gchar *tempFilename = g_strdup_printf("%s.%08x.tmp", cacheFilename, g_random_int());
+		FILE *cacheFile = g_fopen(tempFilename, "wb");
+		if (cacheFile == NULL) {
+			fprintf(stderr, "Error opening file '%s' for writing, not caching the output.\n", displayCacheFilename);
+			record(service, inputFiles, outputFile, NULL, displayOutputFilename, writingToStdout, options);
+		} else {
+			bool recorded = record(service, inputFiles, cacheFile, NULL, displayCacheFilename, false, options);
+			recorded = fclose(cacheFile) == 0 && recorded;
+			if (!recorded) {
+				fprintf(stderr, "Error writing file '%s'.\n", displayCacheFilename);
+			} else if (g_rename(tempFilename, cacheFilename) == 0) {
+				sourceFilename = g_strdup(cacheFilename);
+			} else {
+				// Most likely, another job has stored the same output meanwhile.
+				sourceFilename = tempFilename;
+				tempFilename = NULL;
+			}
+			if (tempFilename != NULL) {
+				g_remove(tempFilename);
+			}
+		}
+		g_free(tempFilename);
+	}
+	g_free(displayCacheFilename);
+	return sourceFilename;
+}
+
+// Leaves NULL in place of the files that cannot be opened, the other outputs are written regardless.
+static void openTeeFiles(FILE **teeFiles, const Options &options) {
+	for (int i = 0; i < options.teeOutputCount; i++) {
+		const gchar *teeFilename = options.teeOutputFilenames[i];
+		teeFiles[i] = NULL;
+		if (strcmp(teeFilename, STDOUT_FILENAME) == 0) {
+#ifdef _WIN32
+			_setmode(_fileno(stdout), _O_BINARY);
+#endif
+			teeFiles[i] = stdout;
+			continue;
+		}
+		gchar *displayTeeFilename = g_filename_display_name(teeFilename);
+		if (!options.force && g_file_test(teeFilename, G_FILE_TEST_EXISTS)) {
+			fprintf(stderr, "Destination file '%s' exists.\n", displayTeeFilename);
+		} else {
+			teeFiles[i] = fopen(teeFilename, "wb");
+			if (teeFiles[i] == NULL) {
+				fprintf(stderr, "Error opening file '%s' for writing.\n", displayTeeFilename);
+			}
+		}
+		g_free(displayTeeFilename);
+	}
+}
 
-	if(options.outputFilename == NULL && outputFilename != NULL) {
-		free(outputFilename);
+static void closeTeeFiles(FILE **teeFiles, const Options &options) {
+	for (int i = 0; i < options.teeOutputCount; i++) {
+		if (teeFiles[i] == stdout) {
+			fflush(stdout);
+		} else if (teeFiles[i] != NULL) {
+			fclose(teeFiles[i]);
+		}
+	}
+}
+
+// Plays all the input files in sequence through the opened synth recording the output to a single file.
+// With a cache directory set, the output is copied from the cache when the same conversion has been done before.
+static void convert(MT32Emu::Service &service, gchar **inputFilenames, const gchar *outputFilename, const Options &options) {
+	const bool writingToStdout = strcmp(outputFilename, STDOUT_FILENAME) == 0;
+	gchar *displayOutputFilename = g_filename_display_name(outputFilename);
+	FILE *outputFile;
+	bool outputFileExists = false;
+	if (writingToStdout) {
+#ifdef _WIN32
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif
+	} else if (!options.force) {
+		// FIXME: Lame way of avoiding overwriting an existing file
+		// (since it could theoretically be created between us testing and
+		// opening for writing)
+		if (g_file_test(outputFilename, G_FILE_TEST_EXISTS)) {
+			outputFileExists = true;
+		}
+	}
+	if (outputFileExists) {
+		fprintf(stderr, "Destination file '%s' exists.\n", displayOutputFilename);
+		outputFile = NULL;
+	} else {
+		outputFile = writingToStdout ? stdout : fopen(outputFilename, "wb");
+	}
+
+	GTimer *timer = g_timer_new();
+
+	if (outputFile != NULL) {
+		InputFile *inputFiles = mapInputFiles(inputFilenames);
+		gchar *cacheFilename = options.cacheDir == NULL ? NULL : makeCacheFilename(service, inputFiles, options);
+		if (cacheFilename == NULL) {
+			FILE *teeFiles[MAX_TEE_OUTPUT_COUNT];
+			openTeeFiles(teeFiles, options);
+			record(service, inputFiles, outputFile, teeFiles, displayOutputFilename, writingToStdout, options);
+			closeTeeFiles(teeFiles, options);
+		} else {
+			gchar *sourceFilename = recordToCache(service, inputFiles, cacheFilename, outputFile, displayOutputFilename, writingToStdout, options);
+			if (sourceFilename != NULL) {
+				if (!copyFile(sourceFilename, outputFile)) {
+					fprintf(stderr, "Error copying cached output to '%s'\n", displayOutputFilename);
+				}
+				if (strcmp(sourceFilename, cacheFilename) != 0) {
+					g_remove(sourceFilename);
+				}
+				g_free(sourceFilename);
+			}
+			g_free(cacheFilename);
+		}
+		unmapInputFiles(inputFiles);
+		if (writingToStdout) {
+			fflush(outputFile);
+		} else {
+			fclose(outputFile);
+		}
+		fprintf(messageStream, "Elapsed time converting to '%s': %f sec\n", displayOutputFilename, g_timer_elapsed(timer, NULL));
+	} else {
+		fprintf(stderr, "Error opening file '%s' for writing.\n", displayOutputFilename);
 	}
+	g_timer_destroy(timer);
 	g_free(displayOutputFilename);
+}
+
+// Renders all the input files like convert() does but discards the output, then reports the performance
+// along with the render profile collected by the synth.
+static void benchmark(MT32Emu::Service &service, gchar **inputFilenames, const Options &options) {
+	service.setRenderProfilingEnabled(true);
+	fprintf(messageStream, "Benchmarking with renderer type %d, analog output mode %d, sample rate conversion quality %d\n",
+		int(options.rendererType), int(options.analogOutputMode), int(options.srcQuality));
+	GTimer *timer = g_timer_new();
+	unsigned long renderedFrames;
+	InputFile *inputFiles = mapInputFiles(inputFilenames);
+	playFiles(service, inputFiles, NULL, NULL, options, renderedFrames, NULL);
+	unmapInputFiles(inputFiles);
+	double elapsedTime = g_timer_elapsed(timer, NULL);
+	g_timer_destroy(timer);
+	double renderedTime = double(renderedFrames) / options.sampleRate;
+	fprintf(messageStream, "Rendered %lu frames (%f sec) in %f sec, realtime factor: %.2f\n", renderedFrames, renderedTime, elapsedTime,
+		elapsedTime > 0 ? renderedTime / elapsedTime : 0.0);
+	mt32emu_render_profile profile;
+	service.getRenderProfile(&profile);
+	const double nanosPerSecond = 1e9;
+	double otherTime = profile.totalTime - profile.midiEventsTime - profile.partialsTime - profile.reverbTime - profile.analogTime;
+	fprintf(messageStream, "Time spent in MIDI events: %f sec, partials: %f sec, reverb: %f sec, analog: %f sec, other: %f sec\n",
+		profile.midiEventsTime / nanosPerSecond, profile.partialsTime / nanosPerSecond, profile.reverbTime / nanosPerSecond,
+		profile.analogTime / nanosPerSecond, otherTime / nanosPerSecond);
+	fprintf(messageStream, "Active partials: peak %u, average %.2f; render calls: %u, runs: %u, MIDI events: %u\n",
+		profile.maxActivePartialCount, profile.runCount > 0 ? double(profile.totalActivePartialCount) / profile.runCount : 0.0,
+		profile.renderCallCount, profile.runCount, profile.dispatchedEventCount);
+}
+
+// The synth of a conversion worker, reused for all the source files the worker converts. The ROMs are loaded once
+// and stay in the context, while the synth is reopened for each file, which starts it from the power-on state.
+struct ConversionSlot {
+	MT32Emu::Service service;
+	bool romsLoaded;
+};
+
+struct ConversionPool {
+	const Options *options;
+	// The idle slots, a job takes one away for the time of the conversion. There are as many slots as threads in the pool.
+	GAsyncQueue *idleSlots;
+};
+
+// Converts a single input file to an output file named after it using the synth of a slot taken for the time of the job.
+// Runs on a worker thread of the pool, so nothing but the options is shared with the other jobs.
+static void runConversionJob(gpointer data, gpointer userData) {
+	gchar *inputFilenames[] = {static_cast<gchar *>(data), NULL};
+	ConversionPool &conversionPool = *static_cast<ConversionPool *>(userData);
+	Options options = *conversionPool.options;
+	ConversionSlot *slot = static_cast<ConversionSlot *>(g_async_queue_pop(conversionPool.idleSlots));
+	MT32Emu::Service &service = slot->service;
+	if (!slot->romsLoaded) {
+		service.createContext();
+		slot->romsLoaded = loadROMs(service, options);
+	}
+	if (slot->romsLoaded && openSynth(service, options)) {
+		gchar *outputFilename = makeOutputFilename(inputFilenames[0], options);
+		convert(service, inputFilenames, outputFilename, options);
+		g_free(outputFilename);
+		service.closeSynth();
+	}
+	g_async_queue_push(conversionPool.idleSlots, slot);
+}
+
+static void convertInParallel(const Options &options) {
+	ConversionPool conversionPool;
+	conversionPool.options = &options;
+	GThreadPool *pool = g_thread_pool_new(runConversionJob, &conversionPool, options.jobCount, TRUE, NULL);
+	if (pool == NULL) {
+		fprintf(stderr, "Error creating a pool of %d threads.\n", options.jobCount);
+		return;
+	}
+	ConversionSlot *slots = new ConversionSlot[options.jobCount];
+	conversionPool.idleSlots = g_async_queue_new();
+	for (int slotIx = 0; slotIx < options.jobCount; slotIx++) {
+		slots[slotIx].romsLoaded = false;
+		g_async_queue_push(conversionPool.idleSlots, &slots[slotIx]);
+	}
+	for (gchar **inputFilename = options.inputFilenames; *inputFilename != NULL; inputFilename++) {
+		g_thread_pool_push(pool, *inputFilename, NULL);
+	}
+	// Waits for all the queued jobs to finish.
+	g_thread_pool_free(pool, FALSE, TRUE);
+	g_async_queue_unref(conversionPool.idleSlots);
+	for (int slotIx = 0; slotIx < options.jobCount; slotIx++) {
+		slots[slotIx].service.freeContext();
+	}
+	delete[] slots;
+}
+
+int main(int argc, char *argv[]) {
+	Options options;
+	MT32Emu::Service service;
+	setlocale(LC_ALL, "");
+	if (!parseOptions(argc, argv, &options)) {
+		return -1;
+	}
+	if (options.outputFilename != NULL && strcmp(options.outputFilename, STDOUT_FILENAME) == 0) {
+		messageStream = stderr;
+	}
+	for (int i = 0; i < options.teeOutputCount; i++) {
+		if (strcmp(options.teeOutputFilenames[i], STDOUT_FILENAME) == 0) messageStream = stderr;
+	}
+	fprintf(messageStream, "Munt MT32Emu MIDI to Wave Conversion Utility. Version %s\n", VERSION);
+	fprintf(messageStream, "  Copyright (C) 2009, 2011 Jerome Fisher <re_munt@kingguppy.com>\n");
+	fprintf(messageStream, "  Copyright (C) 2012-2021 Jerome Fisher, Sergey V. Mikayev\n");
+	fprintf(messageStream, "Using Munt MT32Emu Library Version %s, libsmf Version %s (with modifications)\n", service.getLibraryVersionString(), smf_get_version());
+	if (options.jobCount > 0) {
+		convertInParallel(options);
+		freeOptions(&options);
+		return 0;
+	}
+	if (options.writeEventStreams) {
+		for (gchar **inputFilename = options.inputFilenames; *inputFilename != NULL; inputFilename++) {
+			writeEventStream(*inputFilename, options);
+		}
+		freeOptions(&options);
+		return 0;
+	}
+	gchar *outputFilename;
+	if (options.outputFilename != NULL) {
+		outputFilename = g_strdup(options.outputFilename);
+	} else {
+		outputFilename = makeOutputFilename(options.inputFilenames[g_strv_length(options.inputFilenames) - 1], options);
+	}
+
+	service.createContext();
+	if (!loadROMs(service, options)) {
+		return 1;
+	}
+	if (openSynth(service, options)) {
+		fprintf(messageStream, "Using output sample rate %d Hz\n", options.sampleRate);
+		if (options.benchmark) {
+			benchmark(service, options.inputFilenames, options);
+		} else {
+			convert(service, options.inputFilenames, outputFilename, options);
+		}
+	}
+	service.freeContext();
+
+	g_free(outputFilename);
 	freeOptions(&options);
 	return 0;
 }
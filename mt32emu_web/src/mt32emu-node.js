@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2021 Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Main thread API of the emulated synth in a web page. The synthesis runs in a dedicated worker, which renders
+// the output ahead into a ring buffer in shared memory, and an AudioWorklet processor plays it back. Shared memory
+// requires the page to be cross-origin isolated, i.e. served with the COOP and COEP headers.
+
+import { RingBuffer, Doorbell } from './ring-buffer.js';
+
+// Frames kept rendered ahead by default, about 46 ms at 44100 Hz.
+const DEFAULT_LATENCY_FRAMES = 2048;
+// Bytes of MIDI data that may be pending at once. A SysEx message longer than that is split up.
+const MIDI_RING_CAPACITY = 65536;
+
+function nextPowerOfTwo(value) {
+	let result = 1;
+	while (result < value) result <<= 1;
+	return result;
+}
+
+export class MT32EmuNode {
+	// Loads the worklet module and starts the rendering worker with the contents of the ROM files given as ArrayBuffers.
+	// The returned promise is rejected if the ROMs aren't recognised or the synth fails to open.
+	static async create(audioContext, controlROM, pcmROM, latencyFrames = DEFAULT_LATENCY_FRAMES) {
+		await audioContext.audioWorklet.addModule(new URL('./mt32emu-worklet.js', import.meta.url));
+		const node = new MT32EmuNode(audioContext, latencyFrames);
+		await node.start(controlROM, pcmROM);
+		return node;
+	}
+
+	constructor(audioContext, latencyFrames) {
+		this.audioContext = audioContext;
+		this.latencyFrames = latencyFrames;
+		// The buffer holds a render quantum in excess of the latency, so that the worker may always complete a block.
+		this.audioRingStorage = RingBuffer.allocate(Float32Array, nextPowerOfTwo(latencyFrames + 128), 2);
+		this.midiRingStorage = RingBuffer.allocate(Uint8Array, MIDI_RING_CAPACITY);
+		this.doorbellStorage = Doorbell.allocate();
+		this.stopFlagStorage = new SharedArrayBuffer(Int32Array.BYTES_PER_ELEMENT);
+
+		this.audioRing = new RingBuffer(Float32Array, this.audioRingStorage);
+		this.midiRing = new RingBuffer(Uint8Array, this.midiRingStorage);
+		this.doorbell = new Doorbell(this.doorbellStorage);
+		this.stopFlag = new Int32Array(this.stopFlagStorage);
+
+		this.worklet = new AudioWorkletNode(audioContext, 'mt32emu-processor', {
+			numberOfInputs: 0,
+			numberOfOutputs: 1,
+			outputChannelCount: [2],
+			processorOptions: { audioRing: this.audioRingStorage, doorbell: this.doorbellStorage }
+		});
+		this.worker = new Worker(new URL('./mt32emu-worker.js', import.meta.url), { type: 'module' });
+	}
+
+	start(controlROM, pcmROM) {
+		return new Promise((resolve, reject) => {
+			this.worker.onmessage = (event) => {
+				if (event.data.type === 'ready') {
+					resolve();
+				} else {
+					this.worker.terminate();
+					reject(new Error(event.data.message));
+				}
+			};
+			this.worker.postMessage({
+				type: 'init',
+				sampleRate: this.audioContext.sampleRate,
+				latencyFrames: this.latencyFrames,
+				controlROM,
+				pcmROM,
+				audioRing: this.audioRingStorage,
+				midiRing: this.midiRingStorage,
+				doorbell: this.doorbellStorage,
+				stopFlag: this.stopFlagStorage
+			});
+		});
+	}
+
+	connect(destination) {
+		return this.worklet.connect(destination);
+	}
+
+	disconnect() {
+		this.worklet.disconnect();
+	}
+
+	// Sends raw MIDI data to the synth, the messages may be split arbitrarily across the invocations.
+	// Returns false if the data didn't fit in the MIDI ring buffer and was dropped partially.
+	sendMIDI(data) {
+		const bytes = data instanceof Uint8Array ? data : new Uint8Array(data);
+		const written = this.midiRing.write(bytes);
+		this.doorbell.ring();
+		return written === bytes.length;
+	}
+
+	// Returns the total number of frames played as silence because the worker failed to render them in time.
+	getUnderrunLength() {
+		return this.audioRing.getUnderrunLength();
+	}
+
+	// Stops the worker and disconnects the worklet, the node cannot be restarted afterwards.
+	close() {
+		Atomics.store(this.stopFlag, 0, 1);
+		this.doorbell.ring();
+		this.worklet.disconnect();
+	}
+}
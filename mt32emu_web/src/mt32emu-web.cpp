@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2021 Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+
+#include <emscripten.h>
+
+#define MT32EMU_API_TYPE 3
+#include <mt32emu.h>
+
+// Thin layer over the C-compatible API, which is awkward to invoke from JavaScript directly, as it passes
+// the report handler interface by value. The functions are invoked by the rendering worker, see mt32emu-worker.js.
+
+// Enough for the SysEx messages a game may send at once, e.g. when uploading custom timbres.
+static const MT32Emu::Bit32u SYSEX_STORAGE_BUFFER_SIZE = 32768;
+
+struct WebSynth {
+	MT32Emu::Service service;
+	MT32Emu::Bit32u blockLength;
+	// Planar output block, the right channel follows the left one.
+	float *outputBlock;
+};
+
+extern "C" {
+
+// Creates a synth that renders the output at the specified sample rate in blocks of the specified number of frames.
+EMSCRIPTEN_KEEPALIVE WebSynth *mt32emu_web_create(double sampleRate, MT32Emu::Bit32u blockLength) {
+	WebSynth *synth = new WebSynth;
+	synth->service.createContext();
+	synth->service.setStereoOutputSampleRate(sampleRate);
+	synth->service.setSamplerateConversionQuality(MT32Emu::SamplerateConversionQuality_GOOD);
+	synth->service.selectRendererType(MT32Emu::RendererType_FLOAT);
+	// Keeps only the reverb memory in use, which matters within the limited memory of a browser tab.
+	synth->service.setReducedMemoryFootprintEnabled(true);
+	synth->service.configureMIDIEventQueueSysexStorage(SYSEX_STORAGE_BUFFER_SIZE);
+	synth->blockLength = blockLength;
+	synth->outputBlock = new float[2 * blockLength];
+	return synth;
+}
+
+EMSCRIPTEN_KEEPALIVE void mt32emu_web_free(WebSynth *synth) {
+	synth->service.freeContext();
+	delete[] synth->outputBlock;
+	delete synth;
+}
+
+// Returns one of MT32EMU_RC_ADDED_CONTROL_ROM, MT32EMU_RC_ADDED_PCM_ROM or an error code.
+EMSCRIPTEN_KEEPALIVE int mt32emu_web_add_rom(WebSynth *synth, const MT32Emu::Bit8u *data, size_t dataSize) {
+	return synth->service.addROMData(data, dataSize);
+}
+
+// Returns MT32EMU_RC_OK on success.
+EMSCRIPTEN_KEEPALIVE int mt32emu_web_open(WebSynth *synth) {
+	return synth->service.openSynth();
+}
+
+// Plays the raw MIDI data as soon as possible, the messages may be split arbitrarily across the invocations.
+EMSCRIPTEN_KEEPALIVE void mt32emu_web_parse_midi(WebSynth *synth, const MT32Emu::Bit8u *data, MT32Emu::Bit32u length) {
+	synth->service.parseStream(data, length);
+}
+
+// Renders the next block and returns the planar output block.
+EMSCRIPTEN_KEEPALIVE float *mt32emu_web_render(WebSynth *synth) {
+	float *outputBlock = synth->outputBlock;
+	synth->service.renderFloatPlanar(outputBlock, outputBlock + synth->blockLength, synth->blockLength);
+	return outputBlock;
+}
+
+} // extern "C"
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2021 Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Rendering thread of an MT32EmuNode. It renders the synth ahead into the audio ring buffer, which the worklet
+// processor drains, and plays the MIDI data from the MIDI ring buffer in between. Thus, the audio rendering thread
+// of the browser only copies the samples, regardless of the synthesis load.
+
+import createMT32EmuModule from './mt32emu.js';
+import { RingBuffer, Doorbell } from './ring-buffer.js';
+
+const MT32EMU_RC_ADDED_CONTROL_ROM = 1;
+const MT32EMU_RC_ADDED_PCM_ROM = 2;
+const MT32EMU_RC_OK = 0;
+
+// Frames rendered per invocation of the synth, matches the render quantum of the Web Audio API.
+const BLOCK_LENGTH = 128;
+// The worker re-checks the ring buffers at least this often in milliseconds, in case a notification is late.
+const IDLE_TIMEOUT = 50;
+
+let module;
+let synth;
+let audioRing;
+let midiRing;
+let doorbell;
+// Set by the main thread to stop the worker, as the render loop never returns to the event loop to receive messages.
+let stopFlag;
+let targetLength;
+
+function addROM(romData) {
+	const dataPtr = module._malloc(romData.byteLength);
+	module.HEAPU8.set(new Uint8Array(romData), dataPtr);
+	const rc = module._mt32emu_web_add_rom(synth, dataPtr, romData.byteLength);
+	module._free(dataPtr);
+	return rc;
+}
+
+function playPendingMIDIData(midiBuffer, midiBufferPtr) {
+	for (let length = midiRing.read(midiBuffer); length > 0; length = midiRing.read(midiBuffer)) {
+		module.HEAPU8.set(midiBuffer.subarray(0, length), midiBufferPtr);
+		module._mt32emu_web_parse_midi(synth, midiBufferPtr, length);
+	}
+}
+
+function renderLoop() {
+	const midiBuffer = new Uint8Array(midiRing.capacity);
+	const midiBufferPtr = module._malloc(midiBuffer.length);
+	while (Atomics.load(stopFlag, 0) === 0) {
+		const doorbellValue = doorbell.peek();
+		playPendingMIDIData(midiBuffer, midiBufferPtr);
+		while (audioRing.getAvailableLength() + BLOCK_LENGTH <= targetLength) {
+			const blockPtr = module._mt32emu_web_render(synth) >> 2;
+			// The heap may be reallocated as the memory grows, so the views are taken anew each time.
+			const left = module.HEAPF32.subarray(blockPtr, blockPtr + BLOCK_LENGTH);
+			const right = module.HEAPF32.subarray(blockPtr + BLOCK_LENGTH, blockPtr + 2 * BLOCK_LENGTH);
+			audioRing.writePlanar(left, right);
+		}
+		doorbell.wait(doorbellValue, IDLE_TIMEOUT);
+	}
+	module._free(midiBufferPtr);
+}
+
+onmessage = async (event) => {
+	const message = event.data;
+	if (message.type !== 'init') return;
+
+	audioRing = new RingBuffer(Float32Array, message.audioRing);
+	midiRing = new RingBuffer(Uint8Array, message.midiRing);
+	doorbell = new Doorbell(message.doorbell);
+	stopFlag = new Int32Array(message.stopFlag);
+	targetLength = Math.min(message.latencyFrames, audioRing.capacity);
+
+	module = await createMT32EmuModule();
+	synth = module._mt32emu_web_create(message.sampleRate, BLOCK_LENGTH);
+	let error = null;
+	if (addROM(message.controlROM) !== MT32EMU_RC_ADDED_CONTROL_ROM || addROM(message.pcmROM) !== MT32EMU_RC_ADDED_PCM_ROM) {
+		error = 'Invalid ROM files';
+	} else if (module._mt32emu_web_open(synth) !== MT32EMU_RC_OK) {
+		error = 'Failed to open synth';
+	}
+	if (error === null) {
+		postMessage({ type: 'ready' });
+		renderLoop();
+	} else {
+		postMessage({ type: 'error', message: error });
+	}
+	module._mt32emu_web_free(synth);
+	close();
+};
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2021 Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Audio rendering side of an MT32EmuNode. It merely copies the frames the rendering worker has put in the ring buffer
+// to the output and wakes the worker up to render more, so it never blocks the audio thread of the browser.
+
+import { RingBuffer, Doorbell } from './ring-buffer.js';
+
+class MT32EmuProcessor extends AudioWorkletProcessor {
+	constructor(options) {
+		super();
+		this.audioRing = new RingBuffer(Float32Array, options.processorOptions.audioRing);
+		this.doorbell = new Doorbell(options.processorOptions.doorbell);
+	}
+
+	process(inputs, outputs) {
+		const output = outputs[0];
+		this.audioRing.readPlanar(output[0], output[1]);
+		this.doorbell.ring();
+		return true;
+	}
+}
+
+registerProcessor('mt32emu-processor', MT32EmuProcessor);
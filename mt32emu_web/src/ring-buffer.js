@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2021 Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Indices of the header fields. The positions count elements and wrap around at 2^32, the buffer is empty when equal.
+// The read position is only modified by the consumer, whereas the write position is only modified by the producer.
+const READ_POSITION = 0;
+const WRITE_POSITION = 1;
+// Total number of elements the consumer requested without the producer having written them in time.
+const UNDERRUN_LENGTH = 2;
+const HEADER_LENGTH = 3;
+
+// Single-producer single-consumer lock-free ring buffer in shared memory, in the same manner with MidiEventQueue
+// of the library. Either side may run on any thread or worklet, as neither of them ever blocks. The capacity is
+// a power of two, in elements, each element consists of the specified number of samples of the typed array.
+export class RingBuffer {
+	// Allocates the shared memory for a ring buffer, which is then passed to the RingBuffer constructor on both sides.
+	static allocate(ArrayType, capacity, elementLength = 1) {
+		if (capacity <= 0 || (capacity & (capacity - 1)) !== 0) throw new RangeError('Capacity must be a power of two');
+		return {
+			header: new SharedArrayBuffer(HEADER_LENGTH * Int32Array.BYTES_PER_ELEMENT),
+			data: new SharedArrayBuffer(capacity * elementLength * ArrayType.BYTES_PER_ELEMENT),
+			elementLength
+		};
+	}
+
+	constructor(ArrayType, storage) {
+		this.header = new Int32Array(storage.header);
+		this.data = new ArrayType(storage.data);
+		this.elementLength = storage.elementLength;
+		this.capacity = this.data.length / this.elementLength;
+		this.mask = this.capacity - 1;
+	}
+
+	getAvailableLength() {
+		return (Atomics.load(this.header, WRITE_POSITION) - Atomics.load(this.header, READ_POSITION)) >>> 0;
+	}
+
+	getFreeLength() {
+		return this.capacity - this.getAvailableLength();
+	}
+
+	getUnderrunLength() {
+		return Atomics.load(this.header, UNDERRUN_LENGTH) >>> 0;
+	}
+
+	// Producer side. Appends up to length elements from the source array, returns the number of elements written.
+	write(source, length = source.length / this.elementLength) {
+		const writePosition = Atomics.load(this.header, WRITE_POSITION) >>> 0;
+		length = Math.min(length, this.getFreeLength());
+		this.copy(length, (start, count, offset) => {
+			this.data.set(source.subarray(offset * this.elementLength, (offset + count) * this.elementLength), start * this.elementLength);
+		}, writePosition);
+		Atomics.store(this.header, WRITE_POSITION, writePosition + length);
+		return length;
+	}
+
+	// Producer side. Appends the planar stereo samples as interleaved elements, returns the number of elements written.
+	writePlanar(left, right, length = left.length) {
+		const writePosition = Atomics.load(this.header, WRITE_POSITION) >>> 0;
+		length = Math.min(length, this.getFreeLength());
+		const data = this.data;
+		for (let i = 0; i < length; i++) {
+			const sampleIx = ((writePosition + i) & this.mask) << 1;
+			data[sampleIx] = left[i];
+			data[sampleIx + 1] = right[i];
+		}
+		Atomics.store(this.header, WRITE_POSITION, writePosition + length);
+		return length;
+	}
+
+	// Consumer side. Takes up to the length of the target array of elements, returns the number of elements read.
+	read(target) {
+		const readPosition = Atomics.load(this.header, READ_POSITION) >>> 0;
+		const length = Math.min(target.length / this.elementLength, this.getAvailableLength());
+		this.copy(length, (start, count, offset) => {
+			target.set(this.data.subarray(start * this.elementLength, (start + count) * this.elementLength), offset * this.elementLength);
+		}, readPosition);
+		Atomics.store(this.header, READ_POSITION, readPosition + length);
+		return length;
+	}
+
+	// Consumer side. Fills the planar stereo arrays with the interleaved elements, the rest is filled with silence
+	// and accounted as an underrun. Returns the number of elements read.
+	readPlanar(left, right) {
+		const readPosition = Atomics.load(this.header, READ_POSITION) >>> 0;
+		const length = Math.min(left.length, this.getAvailableLength());
+		const data = this.data;
+		for (let i = 0; i < length; i++) {
+			const sampleIx = ((readPosition + i) & this.mask) << 1;
+			left[i] = data[sampleIx];
+			right[i] = data[sampleIx + 1];
+		}
+		if (length < left.length) {
+			left.fill(0, length);
+			right.fill(0, length);
+			Atomics.add(this.header, UNDERRUN_LENGTH, left.length - length);
+		}
+		Atomics.store(this.header, READ_POSITION, readPosition + length);
+		return length;
+	}
+
+	// Invokes the action for each contiguous part of the elements starting from the position, at most two of them.
+	copy(length, action, position) {
+		const start = position & this.mask;
+		const firstPartLength = Math.min(length, this.capacity - start);
+		if (firstPartLength > 0) action(start, firstPartLength, 0);
+		if (length > firstPartLength) action(0, length - firstPartLength, firstPartLength);
+	}
+}
+
+// Wakes up the rendering worker whenever either the audio is consumed or MIDI data arrives, similarly
+// to AsyncRenderer::Listener. The counter only changes, so that no notification is missed between the checks.
+export class Doorbell {
+	static allocate() {
+		return new SharedArrayBuffer(Int32Array.BYTES_PER_ELEMENT);
+	}
+
+	constructor(storage) {
+		this.counter = new Int32Array(storage);
+	}
+
+	ring() {
+		Atomics.add(this.counter, 0, 1);
+		Atomics.notify(this.counter, 0);
+	}
+
+	// Returns the counter value to pass to wait() after checking the state the other side updates.
+	peek() {
+		return Atomics.load(this.counter, 0);
+	}
+
+	// Blocks until the doorbell rings after the counter value was peeked or the timeout in milliseconds elapses.
+	// Only allowed in workers.
+	wait(peekedValue, timeout) {
+		Atomics.wait(this.counter, 0, peekedValue, timeout);
+	}
+}
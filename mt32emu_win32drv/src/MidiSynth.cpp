@@ -47,6 +47,15 @@ enum ReverbCompatibilityMode {
 
 static MidiSynth &midiSynth = MidiSynth::getInstance();
 
+// Pins the rendering thread to the CPU core set as RenderingThreadCPUCore in the waveout settings, if any.
+// Synthesis then never migrates between cores nor competes for one with the threads of the MIDI application.
+static void SetRenderingThreadAffinity(HANDLE hThread, int cpuCore) {
+	if (cpuCore < 0) return;
+	if (SetThreadAffinityMask(hThread, DWORD_PTR(1) << cpuCore) == 0) {
+		std::cout << "MT32: Failed to pin rendering thread to CPU core " << cpuCore << std::endl;
+	}
+}
+
 static class SynthEventWin32 {
 private:
 	HANDLE hEvent;
@@ -187,7 +196,7 @@ public:
 		return 0;
 	}
 
-	int Start() {
+	int Start(int cpuCore) {
 		prevPlayPosition = 0;
 		for (UINT i = 0; i < chunks; i++) {
 			if (waveOutWrite(hWaveOut, &WaveHdr[i], sizeof(WAVEHDR)) != MMSYSERR_NOERROR) {
@@ -197,6 +206,7 @@ public:
 		}
 		hThread = (HANDLE)_beginthread(RenderingThread, 16384, this);
 		SetThreadPriority(hThread, THREAD_PRIORITY_TIME_CRITICAL);
+		SetRenderingThreadAffinity(hThread, cpuCore);
 		return 0;
 	}
 
@@ -293,6 +303,321 @@ void WaveOutWin32::RenderingThread(void *) {
 #endif
 }
 
+// Declared locally to avoid depending on uuid.lib and __uuidof().
+static const GUID MT32EMU_CLSID_MMDEVICE_ENUMERATOR = {0xBCDE0395, 0xE52F, 0x467C, {0x8E, 0x3D, 0xC4, 0x57, 0x92, 0x91, 0x69, 0x2E}};
+static const GUID MT32EMU_IID_IMMDEVICE_ENUMERATOR = {0xA95664D2, 0x9614, 0x4F35, {0xA7, 0x46, 0xDE, 0x8D, 0xB6, 0x36, 0x17, 0xE6}};
+static const GUID MT32EMU_IID_IAUDIO_CLIENT = {0x1CB9AD4C, 0xDBFA, 0x4C32, {0xB1, 0x78, 0xC2, 0xF5, 0x68, 0xA7, 0x03, 0xB2}};
+static const GUID MT32EMU_IID_IAUDIO_RENDER_CLIENT = {0xF294ACFC, 0x3146, 0x4483, {0xA7, 0xBF, 0xAD, 0xDC, 0xA7, 0xC2, 0x60, 0xE2}};
+static const GUID MT32EMU_IID_IAUDIO_CLOCK = {0xCD63314F, 0x3FBA, 0x4A1B, {0x81, 0x2C, 0xEF, 0x96, 0x35, 0x87, 0x28, 0xE7}};
+
+#ifndef AUDCLNT_STREAMFLAGS_AUTOCONVERTPCM
+#define AUDCLNT_STREAMFLAGS_AUTOCONVERTPCM 0x80000000
+#endif
+
+#ifndef AUDCLNT_STREAMFLAGS_SRC_DEFAULT_QUALITY
+#define AUDCLNT_STREAMFLAGS_SRC_DEFAULT_QUALITY 0x08000000
+#endif
+
+// Event-driven output to the default audio endpoint via WASAPI, which is available since Windows Vista.
+// Exclusive mode is tried first if enabled, as it bypasses the audio engine and permits periods of a few milliseconds.
+// Otherwise, the shared mode stream relies on the audio engine to convert the sample rate. COM and MMCSS are loaded
+// dynamically, so the driver still loads on older systems and falls back to WinMM there. The stream is opened and
+// released on the rendering thread, that is also registered with MMCSS to get the "Pro Audio" priority.
+static class WASAPIOutputWin32 {
+private:
+	typedef HRESULT (WINAPI *CoInitializeExProc)(LPVOID, DWORD);
+	typedef void (WINAPI *CoUninitializeProc)();
+	typedef HRESULT (WINAPI *CoCreateInstanceProc)(REFCLSID, LPUNKNOWN, DWORD, REFIID, LPVOID *);
+	typedef HANDLE (WINAPI *AvSetMmThreadCharacteristicsProc)(LPCSTR, LPDWORD);
+	typedef BOOL (WINAPI *AvRevertMmThreadCharacteristicsProc)(HANDLE);
+
+	HMODULE hOle32;
+	HMODULE hAvrt;
+	CoInitializeExProc coInitializeEx;
+	CoUninitializeProc coUninitialize;
+	CoCreateInstanceProc coCreateInstance;
+	AvSetMmThreadCharacteristicsProc avSetMmThreadCharacteristics;
+	AvRevertMmThreadCharacteristicsProc avRevertMmThreadCharacteristics;
+
+	IAudioClient *audioClient;
+	IAudioRenderClient *renderClient;
+	IAudioClock *audioClock;
+	UINT64 clockFrequency;
+	UINT32 bufferFrameCount;
+	unsigned int latencyFrames;
+	bool exclusiveStream;
+
+	unsigned int sampleRate;
+	unsigned int requestedBufferSize;
+	bool exclusiveModeEnabled;
+
+	HANDLE hBufferEvent;
+	HANDLE hStreamOpenedEvent;
+	HANDLE hThread;
+	volatile int openResult;
+	volatile bool stopProcessing;
+
+	REFERENCE_TIME FramesToReferenceTime(UINT32 frames) {
+		// REFERENCE_TIME is in 100-nanosecond units
+		return REFERENCE_TIME((10000000.0 * frames) / sampleRate + 0.5);
+	}
+
+	UINT32 ReferenceTimeToFrames(REFERENCE_TIME time) {
+		return UINT32(time * (double)sampleRate / 10000000.0 + 0.5);
+	}
+
+	HRESULT ActivateAudioClient(IMMDevice *device) {
+		return device->Activate(MT32EMU_IID_IAUDIO_CLIENT, CLSCTX_ALL, NULL, (void **)&audioClient);
+	}
+
+	void ReleaseAudioClient() {
+		if (audioClient != NULL) {
+			audioClient->Release();
+			audioClient = NULL;
+		}
+	}
+
+	bool InitExclusiveStream(IMMDevice *device, const WAVEFORMATEX &format) {
+		if (FAILED(ActivateAudioClient(device))) return false;
+		REFERENCE_TIME minimumPeriod;
+		if (FAILED(audioClient->GetDevicePeriod(NULL, &minimumPeriod))
+			|| audioClient->IsFormatSupported(AUDCLNT_SHAREMODE_EXCLUSIVE, &format, NULL) != S_OK)
+		{
+			ReleaseAudioClient();
+			return false;
+		}
+		// Event-driven exclusive streams are double-buffered, thus the period is a half of the requested latency.
+		REFERENCE_TIME period = FramesToReferenceTime(requestedBufferSize / 2);
+		if (period < minimumPeriod) period = minimumPeriod;
+		HRESULT hr = audioClient->Initialize(AUDCLNT_SHAREMODE_EXCLUSIVE, AUDCLNT_STREAMFLAGS_EVENTCALLBACK, period, period, &format, NULL);
+		if (hr == AUDCLNT_E_BUFFER_SIZE_NOT_ALIGNED) {
+			// The client has to be recreated with the period that the device aligns the buffer to.
+			UINT32 alignedFrameCount;
+			hr = audioClient->GetBufferSize(&alignedFrameCount);
+			ReleaseAudioClient();
+			if (FAILED(hr) || FAILED(ActivateAudioClient(device))) return false;
+			period = FramesToReferenceTime(alignedFrameCount);
+			hr = audioClient->Initialize(AUDCLNT_SHAREMODE_EXCLUSIVE, AUDCLNT_STREAMFLAGS_EVENTCALLBACK, period, period, &format, NULL);
+		}
+		if (FAILED(hr)) {
+			ReleaseAudioClient();
+			return false;
+		}
+		return true;
+	}
+
+	bool InitSharedStream(IMMDevice *device, const WAVEFORMATEX &format) {
+		if (FAILED(ActivateAudioClient(device))) return false;
+		DWORD streamFlags = AUDCLNT_STREAMFLAGS_EVENTCALLBACK | AUDCLNT_STREAMFLAGS_AUTOCONVERTPCM | AUDCLNT_STREAMFLAGS_SRC_DEFAULT_QUALITY;
+		if (FAILED(audioClient->Initialize(AUDCLNT_SHAREMODE_SHARED, streamFlags, FramesToReferenceTime(requestedBufferSize), 0, &format, NULL))) {
+			ReleaseAudioClient();
+			return false;
+		}
+		return true;
+	}
+
+	int OpenStream() {
+		IMMDeviceEnumerator *deviceEnumerator = NULL;
+		IMMDevice *device = NULL;
+		if (FAILED(coCreateInstance(MT32EMU_CLSID_MMDEVICE_ENUMERATOR, NULL, CLSCTX_ALL, MT32EMU_IID_IMMDEVICE_ENUMERATOR, (void **)&deviceEnumerator))) {
+			return 2;
+		}
+		HRESULT hr = deviceEnumerator->GetDefaultAudioEndpoint(eRender, eConsole, &device);
+		deviceEnumerator->Release();
+		if (FAILED(hr)) return 2;
+
+		WAVEFORMATEX format = {WAVE_FORMAT_PCM, 2, sampleRate, sampleRate * 4, 4, 16, 0};
+		exclusiveStream = exclusiveModeEnabled && InitExclusiveStream(device, format);
+		bool streamInitialised = exclusiveStream || InitSharedStream(device, format);
+		device->Release();
+		if (!streamInitialised) return 2;
+
+		REFERENCE_TIME streamLatency;
+		if (FAILED(audioClient->GetBufferSize(&bufferFrameCount))
+			|| FAILED(audioClient->GetStreamLatency(&streamLatency))
+			|| FAILED(audioClient->SetEventHandle(hBufferEvent))
+			|| FAILED(audioClient->GetService(MT32EMU_IID_IAUDIO_RENDER_CLIENT, (void **)&renderClient))
+			|| FAILED(audioClient->GetService(MT32EMU_IID_IAUDIO_CLOCK, (void **)&audioClock))
+			|| FAILED(audioClock->GetFrequency(&clockFrequency)))
+		{
+			return 3;
+		}
+		// Rendering goes at most one buffer ahead of the stream, which is in turn delayed by the stream latency.
+		latencyFrames = bufferFrameCount + ReferenceTimeToFrames(streamLatency);
+		std::cout << "MT32: Using WASAPI in " << (exclusiveStream ? "exclusive" : "shared") << " mode, buffer size: "
+			<< bufferFrameCount << " frames, latency: " << latencyFrames << " frames." << std::endl;
+
+		// The buffer must be filled before the stream starts to avoid a glitch.
+		RenderAvailableSpace();
+		if (FAILED(audioClient->Start())) return 4;
+		return 0;
+	}
+
+	void ReleaseStream() {
+		if (audioClock != NULL) {
+			audioClock->Release();
+			audioClock = NULL;
+		}
+		if (renderClient != NULL) {
+			renderClient->Release();
+			renderClient = NULL;
+		}
+		ReleaseAudioClient();
+	}
+
+	void RenderAvailableSpace() {
+		UINT32 framesToRender = bufferFrameCount;
+		if (!exclusiveStream) {
+			// In shared mode, the audio engine consumes the buffer gradually
+			UINT32 paddingFrameCount;
+			if (FAILED(audioClient->GetCurrentPadding(&paddingFrameCount))) return;
+			framesToRender -= paddingFrameCount;
+		}
+		if (framesToRender == 0) return;
+		BYTE *data;
+		if (FAILED(renderClient->GetBuffer(framesToRender, &data))) return;
+		midiSynth.Render((Bit16s *)data, framesToRender);
+		renderClient->ReleaseBuffer(framesToRender, 0);
+	}
+
+	static unsigned __stdcall RenderingThread(void *);
+
+public:
+	int Init(unsigned int bufferSize, unsigned int useSampleRate, bool exclusiveMode, int cpuCore) {
+		hOle32 = LoadLibraryA("ole32.dll");
+		hAvrt = LoadLibraryA("avrt.dll");
+		if (hOle32 == NULL) {
+			FreeLibraries();
+			return 1;
+		}
+		coInitializeEx = (CoInitializeExProc)GetProcAddress(hOle32, "CoInitializeEx");
+		coUninitialize = (CoUninitializeProc)GetProcAddress(hOle32, "CoUninitialize");
+		coCreateInstance = (CoCreateInstanceProc)GetProcAddress(hOle32, "CoCreateInstance");
+		// MMCSS is optional, the thread merely gets the time critical priority without it.
+		avSetMmThreadCharacteristics = NULL;
+		avRevertMmThreadCharacteristics = NULL;
+		if (hAvrt != NULL) {
+			avSetMmThreadCharacteristics = (AvSetMmThreadCharacteristicsProc)GetProcAddress(hAvrt, "AvSetMmThreadCharacteristicsA");
+			avRevertMmThreadCharacteristics = (AvRevertMmThreadCharacteristicsProc)GetProcAddress(hAvrt, "AvRevertMmThreadCharacteristics");
+		}
+		if (coInitializeEx == NULL || coUninitialize == NULL || coCreateInstance == NULL) {
+			FreeLibraries();
+			return 1;
+		}
+
+		audioClient = NULL;
+		renderClient = NULL;
+		audioClock = NULL;
+		sampleRate = useSampleRate;
+		requestedBufferSize = bufferSize;
+		exclusiveModeEnabled = exclusiveMode;
+		stopProcessing = false;
+		openResult = 0;
+		hBufferEvent = CreateEvent(NULL, false, false, NULL);
+		hStreamOpenedEvent = CreateEvent(NULL, false, false, NULL);
+		hThread = (HANDLE)_beginthreadex(NULL, 16384, RenderingThread, this, 0, NULL);
+		if (hThread == NULL) {
+			CloseHandle(hBufferEvent);
+			CloseHandle(hStreamOpenedEvent);
+			FreeLibraries();
+			return 2;
+		}
+		SetThreadPriority(hThread, THREAD_PRIORITY_TIME_CRITICAL);
+		SetRenderingThreadAffinity(hThread, cpuCore);
+		WaitForSingleObject(hStreamOpenedEvent, INFINITE);
+		CloseHandle(hStreamOpenedEvent);
+		if (openResult != 0) {
+			// The thread has already released everything.
+			Close();
+		}
+		return openResult;
+	}
+
+	int Close() {
+		stopProcessing = true;
+		SetEvent(hBufferEvent);
+#ifdef ENABLE_DEBUG_OUTPUT
+		std::cout << "Waiting for rendering thread to die\n";
+#endif
+		WaitForSingleObject(hThread, INFINITE);
+		CloseHandle(hThread);
+		hThread = NULL;
+		CloseHandle(hBufferEvent);
+		hBufferEvent = NULL;
+		FreeLibraries();
+		return 0;
+	}
+
+	void FreeLibraries() {
+		if (hAvrt != NULL) {
+			FreeLibrary(hAvrt);
+			hAvrt = NULL;
+		}
+		if (hOle32 != NULL) {
+			FreeLibrary(hOle32);
+			hOle32 = NULL;
+		}
+	}
+
+	int Pause() {
+		if (FAILED(audioClient->Stop())) {
+			MessageBox(NULL, L"Failed to Pause wave playback", L"MT32", MB_OK | MB_ICONEXCLAMATION);
+			return 9;
+		}
+		return 0;
+	}
+
+	int Resume() {
+		if (FAILED(audioClient->Start())) {
+			MessageBox(NULL, L"Failed to Resume wave playback", L"MT32", MB_OK | MB_ICONEXCLAMATION);
+			return 9;
+		}
+		return 0;
+	}
+
+	unsigned int GetLatencyFrames() {
+		return latencyFrames;
+	}
+
+	// Returns the number of frames played since the stream started. Unlike waveOutGetPosition(), it doesn't wrap around.
+	UINT64 GetPos() {
+		UINT64 position;
+		if (FAILED(audioClock->GetPosition(&position, NULL))) return 0;
+		return UINT64(position * (double)sampleRate / clockFrequency);
+	}
+} wasapiOut;
+
+unsigned __stdcall WASAPIOutputWin32::RenderingThread(void *) {
+	bool comInitialised = SUCCEEDED(wasapiOut.coInitializeEx(NULL, COINIT_MULTITHREADED));
+	int result = comInitialised ? wasapiOut.OpenStream() : 2;
+	wasapiOut.openResult = result;
+	SetEvent(wasapiOut.hStreamOpenedEvent);
+	if (result == 0) {
+		DWORD taskIndex = 0;
+		HANDLE hTask = NULL;
+		if (wasapiOut.avSetMmThreadCharacteristics != NULL) {
+			hTask = wasapiOut.avSetMmThreadCharacteristics("Pro Audio", &taskIndex);
+		}
+		while (!wasapiOut.stopProcessing) {
+			WaitForSingleObject(wasapiOut.hBufferEvent, INFINITE);
+			if (wasapiOut.stopProcessing) break;
+			wasapiOut.RenderAvailableSpace();
+		}
+		wasapiOut.audioClient->Stop();
+		if (hTask != NULL) {
+			wasapiOut.avRevertMmThreadCharacteristics(hTask);
+		}
+	}
+	wasapiOut.ReleaseStream();
+	if (comInitialised) {
+		wasapiOut.coUninitialize();
+	}
+#ifdef ENABLE_DEBUG_OUTPUT
+	std::cout << "Rendering thread stopped\n";
+#endif
+	return 0;
+}
+
 static class : public ReportHandler {
 protected:
 	virtual void onErrorControlROM() {
@@ -404,7 +729,7 @@ unsigned int MidiSynth::MillisToFrames(unsigned int millis) {
 	return UINT(sampleRate * millis / 1000.0f);
 }
 
-void MidiSynth::LoadWaveOutSettings() {
+void MidiSynth::LoadWaveOutSettings(bool allowWASAPI) {
 	HKEY hReg;
 	if (RegOpenKeyA(HKEY_CURRENT_USER, MT32EMU_REGISTRY_PATH, &hReg)) {
 		hReg = NULL;
@@ -422,7 +747,15 @@ void MidiSynth::LoadWaveOutSettings() {
 	chunkSize = MillisToFrames(LoadIntValue(hRegDriver, "ChunkLen", 10));
 	midiLatency = MillisToFrames(LoadIntValue(hRegDriver, "MidiLatency", 0));
 	useRingBuffer = LoadBoolValue(hRegDriver, "UseRingBuffer", false);
+	useWASAPI = allowWASAPI && LoadBoolValue(hRegDriver, "UseWASAPI", false);
+	wasapiExclusiveMode = LoadBoolValue(hRegDriver, "WASAPIExclusiveMode", true);
+	renderingThreadCPUCore = LoadIntValue(hRegDriver, "RenderingThreadCPUCore", -1);
 	RegCloseKey(hRegDriver);
+	if (useWASAPI) {
+		// The buffer size is negotiated with the audio device, and so is the default MIDI latency, see AdvertiseWASAPILatency().
+		std::cout << "MT32: Requesting WASAPI buffer size: " << bufferSize << " frames." << std::endl;
+		return;
+	}
 	if (useRingBuffer) {
 		std::cout << "MT32: Using looped ring buffer, buffer size: " << bufferSize << " frames, min. rendering interval: " << chunkSize <<" frames." << std::endl;
 	} else {
@@ -436,6 +769,11 @@ void MidiSynth::LoadWaveOutSettings() {
 	if ((settingsVersion == 1) || (midiLatency == 0)) midiLatency += bufferSize;
 }
 
+void MidiSynth::AdvertiseWASAPILatency(unsigned int latencyFrames) {
+	// Default MIDI latency equals the latency of the WASAPI stream
+	if ((settingsVersion == 1) || (midiLatency == 0)) midiLatency += latencyFrames;
+}
+
 void MidiSynth::ReloadSettings() {
 	HKEY hReg;
 	if (RegOpenKeyA(HKEY_CURRENT_USER, MT32EMU_REGISTRY_PATH, &hReg)) {
@@ -513,15 +851,19 @@ void MidiSynth::ReloadSettings() {
 	RegCloseKey(hRegProfile);
 	hRegProfile = NULL;
 
-	char pathName[512];
-	lstrcpyA(pathName, romDir);
-	lstrcatA(pathName, controlROMFileName);
+	lstrcpyA(controlROMPathName, romDir);
+	lstrcatA(controlROMPathName, controlROMFileName);
+	lstrcpyA(pcmROMPathName, romDir);
+	lstrcatA(pcmROMPathName, pcmROMFileName);
+}
+
+// The synth references the decoded PCM samples owned by the PCM ROM image,
+// so the images may only be replaced while the synth is closed.
+void MidiSynth::LoadROMImages() {
 	FileStream *controlROMFile = new FileStream;
-	controlROMFile->open(pathName);
-	lstrcpyA(pathName, romDir);
-	lstrcatA(pathName, pcmROMFileName);
+	controlROMFile->open(controlROMPathName);
 	FileStream *pcmROMFile = new FileStream;
-	pcmROMFile->open(pathName);
+	pcmROMFile->open(pcmROMPathName);
 	FreeROMImages();
 	controlROM = ROMImage::makeROMImage(controlROMFile);
 	pcmROM = ROMImage::makeROMImage(pcmROMFile);
@@ -559,6 +901,7 @@ int MidiSynth::Init() {
 	synth = NULL;
 	controlROM = pcmROM = NULL;
 	ReloadSettings();
+	LoadROMImages();
 
 	if (synthEvent.Init()) {
 		return 1;
@@ -572,6 +915,7 @@ int MidiSynth::Init() {
 		return 1;
 	}
 	synth = new Synth(&reportHandler);
+	synth->setMIDIInputCount(MIDI_INPUT_COUNT);
 	synth->selectRendererType(rendererType);
 	if (!synth->open(*controlROM, *pcmROM, partialCount, analogOutputMode)) {
 		synth->close();
@@ -580,11 +924,22 @@ int MidiSynth::Init() {
 	}
 	sampleRate = synth->getStereoOutputSampleRate();
 	sampleRateRatio = SAMPLE_RATE / (double)sampleRate;
-	LoadWaveOutSettings();
-	buffer = new Bit16s[SAMPLES_PER_FRAME * bufferSize];
+	LoadWaveOutSettings(true);
 
 	ApplySettings();
-	FreeROMImages();
+
+	buffer = NULL;
+	if (useWASAPI) {
+		// The stream is started as soon as it is opened
+		renderedFramesCount = 0;
+		if (wasapiOut.Init(bufferSize, sampleRate, wasapiExclusiveMode, renderingThreadCPUCore) == 0) {
+			AdvertiseWASAPILatency(wasapiOut.GetLatencyFrames());
+			return 0;
+		}
+		std::cout << "MT32: Failed to open WASAPI output stream, falling back to WinMM." << std::endl;
+		LoadWaveOutSettings(false);
+	}
+	buffer = new Bit16s[SAMPLES_PER_FRAME * bufferSize];
 
 	UINT wResult = waveOut.Init(buffer, bufferSize, chunkSize, useRingBuffer, sampleRate, audioDeviceName);
 	if (wResult) return wResult;
@@ -593,7 +948,7 @@ int MidiSynth::Init() {
 	synth->render(buffer, bufferSize);
 	renderedFramesCount = bufferSize;
 
-	wResult = waveOut.Start();
+	wResult = waveOut.Start(renderingThreadCPUCore);
 	return wResult;
 }
 
@@ -606,11 +961,12 @@ int MidiSynth::Reset() {
 		return 0;
 	}
 
-	UINT wResult = waveOut.Pause();
+	UINT wResult = useWASAPI ? wasapiOut.Pause() : waveOut.Pause();
 	if (wResult) return wResult;
 
 	synthEvent.Wait();
 	synth->close();
+	LoadROMImages();
 	synth->selectRendererType(rendererType);
 	if (!synth->open(*controlROM, *pcmROM, partialCount, analogOutputMode)) {
 		synth->close();
@@ -619,14 +975,18 @@ int MidiSynth::Reset() {
 		return 1;
 	}
 	ApplySettings();
-	FreeROMImages();
 	synthEvent.Release();
 
-	wResult = waveOut.Resume();
+	wResult = useWASAPI ? wasapiOut.Resume() : waveOut.Resume();
 	return wResult;
 }
 
 Bit32u MidiSynth::getMIDIEventTimestamp() {
+	if (useWASAPI) {
+		// The WASAPI stream position counts the frames played since the start, hence no need to deal with the buffer position
+		UINT64 timestamp = wasapiOut.GetPos() + midiLatency;
+		return Bit32u(timestamp * sampleRateRatio);
+	}
 	// Taking a snapshot to avoid interference with the rendering thread
 	UINT64 renderedFramesCountSnapshot = renderedFramesCount;
 	Bit32u renderPosition = Bit32u(renderedFramesCountSnapshot % bufferSize);
@@ -643,12 +1003,13 @@ Bit32u MidiSynth::getMIDIEventTimestamp() {
 	return Bit32u(timestamp * sampleRateRatio);
 }
 
-void MidiSynth::PlayMIDI(DWORD msg) {
-	synth->playMsg(msg, getMIDIEventTimestamp());
+// Invoked from the client threads without locking; the render thread is never waited for here
+void MidiSynth::PlayMIDI(DWORD inputNum, DWORD msg) {
+	synth->playMsgOnInput(inputNum, msg, getMIDIEventTimestamp());
 }
 
-void MidiSynth::PlaySysex(const Bit8u *bufpos, DWORD len) {
-	synth->playSysex(bufpos, len, getMIDIEventTimestamp());
+void MidiSynth::PlaySysex(DWORD inputNum, const Bit8u *bufpos, DWORD len) {
+	synth->playSysexOnInput(inputNum, bufpos, len, getMIDIEventTimestamp());
 }
 
 void MidiSynth::FreeROMImages() {
@@ -667,8 +1028,12 @@ void MidiSynth::FreeROMImages() {
 }
 
 void MidiSynth::Close() {
-	waveOut.Pause();
-	waveOut.Close();
+	if (useWASAPI) {
+		wasapiOut.Close();
+	} else {
+		waveOut.Pause();
+		waveOut.Close();
+	}
 	synthEvent.Wait();
 	synth->close();
 
@@ -29,6 +29,9 @@ private:
 	unsigned int chunkSize;
 	unsigned int settingsVersion;
 	bool useRingBuffer;
+	bool useWASAPI;
+	bool wasapiExclusiveMode;
+	int renderingThreadCPUCore;
 	bool resetEnabled;
 	char audioDeviceName[MAXPNAMELEN];
 
@@ -57,25 +60,34 @@ private:
 	Synth *synth;
 	const ROMImage *controlROM;
 	const ROMImage *pcmROM;
+	char controlROMPathName[512];
+	char pcmROMPathName[512];
 
 	unsigned int MillisToFrames(unsigned int millis);
-	void LoadWaveOutSettings();
+	void LoadWaveOutSettings(bool allowWASAPI);
 	void ReloadSettings();
+	void LoadROMImages();
 	void ApplySettings();
 
 	MidiSynth();
 
 public:
+	// Each client of the driver enqueues its MIDI events to a separate MIDI input of the synth, which is a lock-free
+	// single-producer single-consumer queue drained by the rendering thread. Hence, the clients neither contend
+	// with each other nor with rendering.
+	static const int MIDI_INPUT_COUNT = 8;
+
 	static MidiSynth &getInstance();
 	int Init();
 	void Close();
 	void FreeROMImages();
 	int Reset();
 	void RenderAvailableSpace();
+	void AdvertiseWASAPILatency(unsigned int latencyFrames);
 	void Render(Bit16s *bufpos, DWORD totalFrames);
 	Bit32u getMIDIEventTimestamp();
-	void PlayMIDI(DWORD msg);
-	void PlaySysex(const Bit8u *bufpos, DWORD len);
+	void PlayMIDI(DWORD inputNum, DWORD msg);
+	void PlaySysex(DWORD inputNum, const Bit8u *bufpos, DWORD len);
 };
 
 }
@@ -15,6 +15,8 @@
 #include <mmddk.h>
 #include <mmreg.h>
 #include <process.h>
+#include <mmdeviceapi.h>
+#include <audioclient.h>
 
 #include <iostream>
 
@@ -18,7 +18,17 @@
 #include "stdafx.h"
 
 #define MAX_DRIVERS 8
-#define MAX_CLIENTS 8 // Per driver
+#define MAX_CLIENTS MT32Emu::MidiSynth::MIDI_INPUT_COUNT // Per driver
+
+// Private message sent to the synth application to inform when MIDI data becomes available in the shared ring buffer
+// of the session specified in wParam. Used since protocol version 2.
+#define WM_APP_DRV_RING_HAS_DATA WM_APP + 2
+
+#define SHARED_RING_BUFFER_NAME_FORMAT "mt32emu_midi_ring_%08X"
+#define SHARED_RING_EVENT_NAME_FORMAT "mt32emu_midi_ring_event_%08X"
+#define SHARED_RING_BUFFER_MAGIC 0x474E4952
+#define SHARED_RING_RECORD_HEADER_LENGTH 16
+#define SHORT_MESSAGE_LENGTH 4
 
 namespace {
 
@@ -51,6 +61,31 @@ void updateNanoCounter() {
 
 using namespace MT32Emu;
 
+/* Since protocol version 2, the synth application allocates a ring buffer in a named shared memory section
+ * for each session, so that the MIDI data is forwarded without waiting until every message is processed.
+ * The layout must match the one used in mt32emu_qt. The section starts with the header below followed by
+ * the data area of the ring buffer. The record format is as follows:
+ * DWORD - record length including the payload padded to a multiple of 4 bytes, 0 marks a wrap to the beginning
+ * DWORD - Sysex length, 0 for short message
+ * DWORD[2] - nanosecond timestamp
+ * data payload:
+ * - either DWORD for short message
+ * - raw Sysex data bytes
+ * The read position is only modified by the synth application and the write position by the driver.
+ * Since protocol version 3, the synth application may also create a named auto-reset event for the session, which is
+ * signalled instead of sending WM_APP_DRV_RING_HAS_DATA, so that the driver never enters the window manager and
+ * the synth application wakes up directly.
+ */
+struct SharedRingBufferHeader {
+	DWORD magic;
+	DWORD size;
+	volatile LONG readPos;
+	volatile LONG writePos;
+	// Set when WM_APP_DRV_RING_HAS_DATA is sent, cleared by the synth application before the data is read
+	volatile LONG notificationPending;
+	DWORD reserved;
+};
+
 static MidiSynth &midiSynth = MidiSynth::getInstance();
 static bool synthOpened = false;
 static HWND hwnd = NULL;
@@ -67,9 +102,84 @@ struct Driver {
 		DWORD_PTR callback;
 		DWORD synth_instance;
 		MidiStreamParser *midiStreamParser;
+		HANDLE ringBufferMapping;
+		SharedRingBufferHeader *ringBuffer;
+		HANDLE ringBufferEvent;
 	} clients[MAX_CLIENTS];
 } drivers[MAX_DRIVERS];
 
+void OpenSharedRingBuffer(Driver::Client &client) {
+	char name[32];
+	wsprintfA(name, SHARED_RING_BUFFER_NAME_FORMAT, client.synth_instance);
+	client.ringBuffer = NULL;
+	client.ringBufferEvent = NULL;
+	client.ringBufferMapping = OpenFileMappingA(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, name);
+	// Older synth applications only support WM_COPYDATA messages
+	if (client.ringBufferMapping == NULL) return;
+	SharedRingBufferHeader *header = (SharedRingBufferHeader *)MapViewOfFile(client.ringBufferMapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, 0);
+	if (header != NULL && header->magic == SHARED_RING_BUFFER_MAGIC && (header->size & 3) == 0) {
+		client.ringBuffer = header;
+		// The synth application may run out of wait slots, the window message is used then
+		wsprintfA(name, SHARED_RING_EVENT_NAME_FORMAT, client.synth_instance);
+		client.ringBufferEvent = OpenEventA(EVENT_MODIFY_STATE, FALSE, name);
+		return;
+	}
+	if (header != NULL) UnmapViewOfFile(header);
+	CloseHandle(client.ringBufferMapping);
+	client.ringBufferMapping = NULL;
+}
+
+void CloseSharedRingBuffer(Driver::Client &client) {
+	if (client.ringBufferEvent != NULL) {
+		CloseHandle(client.ringBufferEvent);
+		client.ringBufferEvent = NULL;
+	}
+	if (client.ringBuffer != NULL) {
+		UnmapViewOfFile(client.ringBuffer);
+		client.ringBuffer = NULL;
+	}
+	if (client.ringBufferMapping != NULL) {
+		CloseHandle(client.ringBufferMapping);
+		client.ringBufferMapping = NULL;
+	}
+}
+
+// Returns false if there isn't enough free space in the ring buffer to write the record.
+bool WriteSharedRingBuffer(SharedRingBufferHeader *header, const LARGE_INTEGER &timestamp, DWORD shortMessage, const Bit8u *sysex, DWORD sysexLength) {
+	const DWORD payloadLength = sysex == NULL ? SHORT_MESSAGE_LENGTH : (sysexLength + 3) & ~3;
+	const DWORD recordLength = SHARED_RING_RECORD_HEADER_LENGTH + payloadLength;
+	const DWORD size = header->size;
+	const DWORD readPos = (DWORD)InterlockedCompareExchange(&header->readPos, 0, 0);
+	const DWORD writePos = (DWORD)header->writePos;
+	DWORD recordPos = writePos;
+	if (sysexLength >= size) return false;
+	if (readPos <= writePos) {
+		if (size - writePos <= recordLength) {
+			// Not enough space till the end of the buffer, need to wrap. The read position must never be reached.
+			if (readPos <= recordLength) return false;
+			recordPos = 0;
+		}
+	} else if (readPos - writePos <= recordLength) {
+		return false;
+	}
+	BYTE *ringData = (BYTE *)(header + 1);
+	DWORD *record = (DWORD *)&ringData[recordPos];
+	record[0] = recordLength;
+	record[1] = sysex == NULL ? 0 : sysexLength;
+	record[2] = timestamp.LowPart;
+	record[3] = (DWORD)timestamp.HighPart;
+	if (sysex == NULL) {
+		record[4] = shortMessage;
+	} else {
+		memcpy(&record[4], sysex, sysexLength);
+	}
+	if (recordPos != writePos) {
+		*(DWORD *)&ringData[writePos] = 0; // Wrap marker
+	}
+	InterlockedExchange(&header->writePos, LONG(recordPos + recordLength));
+	return true;
+}
+
 STDAPI_(LONG) DriverProc(DWORD dwDriverID, HDRVR hdrvr, WORD wMessage, DWORD dwParam1, DWORD dwParam2) {
 	switch(wMessage) {
 	case DRV_LOAD:
@@ -188,23 +298,23 @@ LONG CloseDriver(Driver &driver, UINT uDeviceID, UINT uMsg, DWORD_PTR dwUser, DW
 
 class MidiStreamParserImpl : public MidiStreamParser {
 public:
-	MidiStreamParserImpl(Driver::Client &useClient) : client(useClient) {}
+	MidiStreamParserImpl(Driver::Client &useClient, DWORD useClientNum) : client(useClient), clientNum(useClientNum) {}
 
 protected:
 	virtual void handleShortMessage(const Bit32u message) {
 		if (hwnd == NULL) {
-			midiSynth.PlayMIDI(message);
+			midiSynth.PlayMIDI(clientNum, message);
 		} else {
 			updateNanoCounter();
 			DWORD msg[] = { 0, 0, nanoCounter.LowPart, (DWORD)nanoCounter.HighPart, message }; // 0, short MIDI message indicator, timestamp, data
 			COPYDATASTRUCT cds = { client.synth_instance, sizeof(msg), msg };
-			LRESULT res = SendMessage(hwnd, WM_COPYDATA, NULL, (LPARAM)&cds);
+			LRESULT res = forwardToSynthApp(message, NULL, 0, cds);
 			if (res != 1) {
 				// Synth app was terminated. Fall back to integrated synth
 				hwnd = NULL;
 				if (midiSynth.Init() == 0) {
 					synthOpened = true;
-					midiSynth.PlayMIDI(message);
+					midiSynth.PlayMIDI(clientNum, message);
 				}
 			}
 		}
@@ -212,16 +322,17 @@ protected:
 
 	virtual void handleSysex(const Bit8u stream[], const Bit32u length) {
 		if (hwnd == NULL) {
-			midiSynth.PlaySysex(stream, length);
+			midiSynth.PlaySysex(clientNum, stream, length);
 		} else {
+			updateNanoCounter();
 			COPYDATASTRUCT cds = { client.synth_instance, length, (PVOID)stream };
-			LRESULT res = SendMessage(hwnd, WM_COPYDATA, NULL, (LPARAM)&cds);
+			LRESULT res = forwardToSynthApp(0, stream, length, cds);
 			if (res != 1) {
 				// Synth app was terminated. Fall back to integrated synth
 				hwnd = NULL;
 				if (midiSynth.Init() == 0) {
 					synthOpened = true;
-					midiSynth.PlaySysex(stream, length);
+					midiSynth.PlaySysex(clientNum, stream, length);
 				}
 			}
 		}
@@ -239,6 +350,27 @@ protected:
 
 private:
 	Driver::Client &client;
+	// Each client feeds a separate MIDI input of the integrated synth
+	const DWORD clientNum;
+
+	// Returns 1 if the synth application accepted the MIDI data, the same as for WM_COPYDATA message.
+	LRESULT forwardToSynthApp(DWORD shortMessage, const Bit8u *sysex, DWORD sysexLength, COPYDATASTRUCT &cds) {
+		SharedRingBufferHeader *ringBuffer = client.ringBuffer;
+		if (ringBuffer == NULL) return SendMessage(hwnd, WM_COPYDATA, NULL, (LPARAM)&cds);
+		if (!WriteSharedRingBuffer(ringBuffer, nanoCounter, shortMessage, sysex, sysexLength)) {
+			// The ring buffer is full, let the synth application drain it and retry
+			LRESULT res = SendMessage(hwnd, WM_APP_DRV_RING_HAS_DATA, client.synth_instance, NULL);
+			if (res != 1) return res;
+			if (!WriteSharedRingBuffer(ringBuffer, nanoCounter, shortMessage, sysex, sysexLength)) {
+				// Too long to fit in the ring buffer, yet the preceding data is already processed
+				return SendMessage(hwnd, WM_COPYDATA, NULL, (LPARAM)&cds);
+			}
+		}
+		// Only notify the synth application once until it starts reading, but still detect when it's gone
+		if (InterlockedExchange(&ringBuffer->notificationPending, 1) != 0) return IsWindow(hwnd) ? 1 : 0;
+		if (client.ringBufferEvent != NULL) return SetEvent(client.ringBufferEvent) && IsWindow(hwnd) ? 1 : 0;
+		return SendNotifyMessage(hwnd, WM_APP_DRV_RING_HAS_DATA, client.synth_instance, NULL) ? 1 : 0;
+	}
 };
 
 STDAPI_(DWORD) modMessage(DWORD uDeviceID, DWORD uMsg, DWORD_PTR dwUser, DWORD_PTR dwParam1, DWORD_PTR dwParam2) {
@@ -266,7 +398,7 @@ STDAPI_(DWORD) modMessage(DWORD uDeviceID, DWORD uMsg, DWORD_PTR dwUser, DWORD_P
 					synthOpened = false;
 				}
 				updateNanoCounter();
-				DWORD msg[70] = { 0, (DWORD)-1, 1, nanoCounter.LowPart, (DWORD)nanoCounter.HighPart }; // 0, handshake indicator, version, timestamp, .exe filename of calling application
+				DWORD msg[70] = { 0, (DWORD)-1, 3, nanoCounter.LowPart, (DWORD)nanoCounter.HighPart }; // 0, handshake indicator, version, timestamp, .exe filename of calling application
 				GetModuleFileNameA(GetModuleHandle(NULL), (char *)&msg[5], 255);
 				COPYDATASTRUCT cds = { 0, sizeof(msg), msg };
 				instance = (DWORD)SendMessage(hwnd, WM_COPYDATA, NULL, (LPARAM)&cds);
@@ -279,9 +411,17 @@ STDAPI_(DWORD) modMessage(DWORD uDeviceID, DWORD uMsg, DWORD_PTR dwUser, DWORD_P
 			break;
 		}
 		DWORD res = OpenDriver(driver, uDeviceID, uMsg, dwUser, dwParam1, dwParam2);
-		Driver::Client &client = driver.clients[*(LONG *)dwUser];
+		LONG clientNum = *(LONG *)dwUser;
+		Driver::Client &client = driver.clients[clientNum];
 		client.synth_instance = instance;
-		client.midiStreamParser = new MidiStreamParserImpl(client);
+		client.midiStreamParser = new MidiStreamParserImpl(client, clientNum);
+		if (instance != 0) {
+			OpenSharedRingBuffer(client);
+		} else {
+			client.ringBufferMapping = NULL;
+			client.ringBuffer = NULL;
+			client.ringBufferEvent = NULL;
+		}
 		return res;
 	}
 
@@ -294,6 +434,7 @@ STDAPI_(DWORD) modMessage(DWORD uDeviceID, DWORD uMsg, DWORD_PTR dwUser, DWORD_P
 		} else {
 			SendMessage(hwnd, WM_APP, driver.clients[dwUser].synth_instance, NULL); // end of session message
 		}
+		CloseSharedRingBuffer(driver.clients[dwUser]);
 		delete driver.clients[dwUser].midiStreamParser;
 		return CloseDriver(driver, uDeviceID, uMsg, dwUser, dwParam1, dwParam2);
 